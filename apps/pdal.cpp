@@ -37,8 +37,10 @@
 #include <pdal/Kernel.hpp>
 #include <pdal/PluginManager.hpp>
 #include <pdal/StageFactory.hpp>
+#include <pdal/Trace.hpp>
 #include <pdal/pdal_config.hpp>
 #include <pdal/util/Backtrace.hpp>
+#include <pdal/util/TaskScheduler.hpp>
 
 #include <iomanip>
 #include <iostream>
@@ -88,6 +90,9 @@ private:
     bool m_showJSON;
     std::string m_log;
     bool m_logtiming;
+    bool m_logasync;
+    std::string m_trace;
+    size_t m_taskThreads;
 };
 
 
@@ -290,6 +295,13 @@ void App::addArgs(ProgramArgs& args)
     args.add("log", "Log filename (accepts stderr, stdout, stdlog, devnull"
         " as special cases)", m_log, "stderr");
     args.add("logtiming", "Turn on timing for log messages", m_logtiming);
+    args.add("logasync", "Write log messages from a background thread",
+        m_logasync);
+    args.add("trace", "Filename for a Chrome trace-event (Perfetto) record "
+        "of stage, stream batch, EPT node and compression block timing",
+        m_trace);
+    args.add("task-threads", "Number of threads used by the parallel loops "
+        "within stages (0 for one per core)", m_taskThreads);
     Arg& json = args.add("showjson", "List options or drivers as JSON output",
         m_showJSON);
     json.setHidden();
@@ -327,6 +339,7 @@ int App::execute(StringList& cmdArgs, LogPtr& log)
     }
 
     log = Log::makeLog("PDAL", m_log, m_logtiming);
+    log->setAsynchronous(m_logasync);
     if (m_logLevel != LogLevel::None)
         log->setLevel(m_logLevel);
     else if (m_debug)
@@ -363,7 +376,26 @@ int App::execute(StringList& cmdArgs, LogPtr& log)
             // This shouldn't throw.  If it does, it's something awful, so
             // not cleaning up seems inconsequential.
             log->setLeader("pdal " + m_command);
+            if (m_trace.size())
+                Trace::start();
+            // The scheduler is shared by the whole process, so its
+            // concurrency is set once, before anything runs on it.
+            if (m_taskThreads)
+                TaskScheduler::instance().setConcurrency(m_taskThreads);
             ret = kernel->run(cmdArgs, log);
+            if (m_trace.size())
+            {
+                Trace::stop();
+                try
+                {
+                    Trace::write(m_trace);
+                }
+                catch (const pdal_error& err)
+                {
+                    Utils::printError(err.what());
+                    ret = -1;
+                }
+            }
             delete kernel;
             // IMPORTANT - The kernel must be destroyed before GDAL
             //  drivers are unregistered or GDAL will attempt to destroy
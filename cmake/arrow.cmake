@@ -0,0 +1,20 @@
+#
+# Arrow/Parquet support
+#
+find_package(Arrow QUIET 15.0 REQUIRED)
+set_package_properties(Arrow PROPERTIES
+        TYPE OPTIONAL
+        URL "https://arrow.apache.org"
+        PURPOSE "Arrow and GeoParquet support")
+find_package(Parquet QUIET REQUIRED
+    HINTS ${Arrow_DIR})
+set_package_properties(Parquet PROPERTIES
+        TYPE OPTIONAL
+        URL "https://arrow.apache.org"
+        PURPOSE "GeoParquet support")
+
+if (TARGET arrow_shared)
+    set(ARROW_LIBRARIES arrow_shared parquet_shared)
+else()
+    set(ARROW_LIBRARIES arrow_static parquet_static)
+endif()
@@ -0,0 +1,10 @@
+#
+# Google Benchmark support
+#
+find_package(benchmark QUIET)
+set_package_properties(benchmark PROPERTIES TYPE OPTIONAL
+    PURPOSE "Microbenchmarks (pdal_bench)")
+if (NOT benchmark_FOUND)
+    message(WARNING "Google Benchmark not found; pdal_bench won't be built.")
+    set(WITH_BENCHMARKS FALSE)
+endif()
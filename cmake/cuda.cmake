@@ -0,0 +1,23 @@
+#
+# CUDA support (optional).  Runs the batched neighbor queries of KDIndex and
+# the covariance eigen decomposition of EigenUtils on a GPU when a device is
+# present at run time.
+#
+option(WITH_CUDA
+    "Run neighborhood and covariance kernels on a CUDA device." FALSE)
+if (WITH_CUDA)
+    if (CMAKE_VERSION VERSION_LESS 3.18)
+        message(WARNING "CUDA support requires CMake 3.18 or later.")
+        set(WITH_CUDA FALSE)
+    else()
+        include(CheckLanguage)
+        check_language(CUDA)
+        if (CMAKE_CUDA_COMPILER)
+            enable_language(CUDA)
+            set(PDAL_HAVE_CUDA 1)
+        else()
+            message(WARNING "WITH_CUDA is set but no CUDA compiler was found.")
+            set(WITH_CUDA FALSE)
+        endif()
+    endif()
+endif(WITH_CUDA)
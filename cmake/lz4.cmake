@@ -0,0 +1,22 @@
+#
+# LZ4 support
+#
+option(WITH_LZ4
+    "Build support for compression/decompression with LZ4." TRUE)
+if (WITH_LZ4)
+    find_package(LZ4 QUIET)
+    set_package_properties(LZ4 PROPERTIES TYPE OPTIONAL
+        PURPOSE "Fast compression of intermediate data")
+    if (LZ4_FOUND)
+        mark_as_advanced(CLEAR LZ4_INCLUDE_DIRS)
+        mark_as_advanced(CLEAR LZ4_LIBRARIES)
+        set(PDAL_HAVE_LZ4 1)
+    else()
+        set(LZ4_LIBRARIES "")
+        set(LZ4_INCLUDE_DIRS "")
+        set(WITH_LZ4 FALSE)
+    endif(LZ4_FOUND)
+else()
+        set(LZ4_LIBRARIES "")
+        set(WITH_LZ4 FALSE)
+endif(WITH_LZ4)
@@ -0,0 +1,38 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+# - Find LZ4 (lz4.h, liblz4.a, liblz4.so, and liblz4.so.0)
+# This module defines
+#  LZ4_INCLUDE_DIRS, directory containing headers
+#  LZ4_LIBRARIES, path to liblz4 shared library
+#  LZ4_FOUND, whether lz4 has been found
+
+find_path(LZ4_INCLUDE_DIR NAMES lz4.h
+    PATH_SUFFIXES "include")
+mark_as_advanced(LZ4_INCLUDE_DIR)
+
+find_library(LZ4_LIBRARY NAMES lz4)
+mark_as_advanced(LZ4_LIBRARY)
+
+include(FindPackageHandleStandardArgs)
+find_package_handle_standard_args(LZ4
+    REQUIRED_VARS LZ4_LIBRARY LZ4_INCLUDE_DIR)
+
+if (LZ4_FOUND)
+    set(LZ4_LIBRARIES ${LZ4_LIBRARY})
+    set(LZ4_INCLUDE_DIRS ${LZ4_INCLUDE_DIR})
+endif()
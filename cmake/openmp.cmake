@@ -0,0 +1,14 @@
+#
+# OpenMP support (optional).  Only used to run the vendored Poisson
+# reconstruction on several threads.
+#
+
+find_package(OpenMP QUIET)
+set_package_properties(OpenMP PROPERTIES TYPE OPTIONAL
+    PURPOSE "Multi-threaded Poisson surface reconstruction")
+if (OpenMP_CXX_FOUND)
+    separate_arguments(PDAL_OPENMP_FLAGS UNIX_COMMAND "${OpenMP_CXX_FLAGS}")
+else()
+    set(PDAL_OPENMP_FLAGS "")
+    set(OpenMP_CXX_LIBRARIES "")
+endif()
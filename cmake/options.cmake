@@ -7,6 +7,11 @@ option(WITH_COMPLETION
 add_feature_info("Bash completion" WITH_COMPLETION
     "completion for PDAL command line")
 
+option(BUILD_PLUGIN_ARROW
+    "Choose if Arrow and GeoParquet support should be built" FALSE)
+add_feature_info("Arrow plugin" BUILD_PLUGIN_ARROW
+    "read/write Arrow IPC and GeoParquet files")
+
 option(BUILD_PLUGIN_CPD
     "Choose if the cpd filter should be built" FALSE)
 add_feature_info("CPD plugin" BUILD_PLUGIN_CPD
@@ -110,6 +115,10 @@ option(WITH_TESTS
     "Choose if PDAL unit tests should be built" TRUE)
 add_feature_info("Unit tests" WITH_TESTS "PDAL unit tests")
 
+option(WITH_BENCHMARKS
+    "Choose if PDAL microbenchmarks should be built" FALSE)
+add_feature_info("Benchmarks" WITH_BENCHMARKS "PDAL microbenchmarks")
+
 # Enable CTest and submissions to PDAL dashboard at CDash
 # http://my.cdash.org/index.php?project=PDAL
 option(ENABLE_CTEST
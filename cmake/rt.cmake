@@ -0,0 +1,10 @@
+#
+# POSIX shared memory (shm_open) is in librt on older systems.
+#
+if (UNIX AND NOT APPLE)
+    include(CheckLibraryExists)
+    check_library_exists(rt shm_open "" PDAL_HAVE_RT)
+    if (PDAL_HAVE_RT)
+        set(RT_LIBRARY rt)
+    endif()
+endif()
@@ -338,6 +338,10 @@ void DimBuilder::writeOutput(std::ostream& out)
     out << "\n";
     writeTypes(out);
     out << "\n";
+    writeTraits(out);
+    out << "\n";
+    writeVisit(out);
+    out << "\n";
     writeFooter(out);
 }
 
@@ -504,5 +508,76 @@ void DimBuilder::writeTypes(std::ostream& out)
     out << "}\n";
 }
 
+void DimBuilder::writeTraits(std::ostream& out)
+{
+    out << "/// Compile-time properties of a predefined dimension.  'type' is "
+        "the\n";
+    out << "/// dimension's default storage type and 'value_type' is the "
+        "C++ type\n";
+    out << "/// that holds it.\n";
+    out << "template<Id I>\n";
+    out << "struct Traits\n";
+    out << "{};\n";
+    for (auto& d : m_dims)
+    {
+        std::string type = getTypename(d.m_type);
+
+        out << "\n";
+        out << "template<>\n";
+        out << "struct Traits<Id::" << d.m_name << ">\n";
+        out << "{\n";
+        out << "    static constexpr Type type = Type::" << type << ";\n";
+        out << "    typedef TypeTraits<Type::" << type << ">::value_type "
+            "value_type;\n";
+        out << "};\n";
+    }
+}
+
+void DimBuilder::writeVisit(std::ostream& out)
+{
+    const std::vector<Dimension::Type> types {
+        Dimension::Type::Unsigned8, Dimension::Type::Signed8,
+        Dimension::Type::Unsigned16, Dimension::Type::Signed16,
+        Dimension::Type::Unsigned32, Dimension::Type::Signed32,
+        Dimension::Type::Unsigned64, Dimension::Type::Signed64,
+        Dimension::Type::Float, Dimension::Type::Double
+    };
+
+    out << "/// Call a function object with a value of the C++ type that "
+        "stores a\n";
+    out << "/// dimension type.  The value is zero and only serves to select "
+        "an\n";
+    out << "/// instantiation of the function object's templated call "
+        "operator, so\n";
+    out << "/// a loop over many values switches on the type once rather than "
+        "once\n";
+    out << "/// per value.\n";
+    out << "/// \\param t  Dimension type.\n";
+    out << "/// \\param f  Function object with a member type 'result_type' "
+        "and a\n";
+    out << "///   call operator templated on the value type.\n";
+    out << "/// \\return  The result of the call.  An exception is thrown if "
+        "the type\n";
+    out << "///   is Type::None.\n";
+    out << "template<typename F>\n";
+    out << "typename F::result_type visit(Type t, F&& f)\n";
+    out << "{\n";
+    out << "    switch (t)\n";
+    out << "    {\n";
+    for (Dimension::Type t : types)
+    {
+        std::string type = getTypename(t);
+
+        out << "    case Type::" << type << ":\n";
+        out << "        return f(TypeTraits<Type::" << type <<
+            ">::value_type());\n";
+    }
+    out << "    case Type::None:\n";
+    out << "        break;\n";
+    out << "    }\n";
+    out << "    throw pdal_error(\"Can't visit a dimension with no type.\");\n";
+    out << "}\n";
+}
+
 } // namespace pdal
 
@@ -80,6 +80,8 @@ private:
     void writeNameToId(std::ostream& out);
     void writeIdToName(std::ostream& out);
     void writeTypes(std::ostream& out);
+    void writeTraits(std::ostream& out);
+    void writeVisit(std::ostream& out);
     void validateDimension(const std::string& dimName);
 };
 
@@ -40,6 +40,7 @@
 
 #include <Eigen/Dense>
 
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -77,29 +78,33 @@ void ApproximateCoplanarFilter::addDimensions(PointLayoutPtr layout)
 
 void ApproximateCoplanarFilter::filter(PointView& view)
 {
-    using namespace Eigen;
-
     KD3Index& kdi = view.build3dIndex();
+    const double *coords = kdi.coords().data();
 
-    for (PointId i = 0; i < view.size(); ++i)
+    // Find the k-nearest neighbors and decompose the covariance of their
+    // neighborhoods a block of points at a time.
+    const point_count_t blockSize = 4096;
+    std::vector<CovarianceEigen> eigens;
+    for (PointId begin = 0; begin < view.size(); begin += blockSize)
     {
-        // find the k-nearest neighbors
-        auto ids = kdi.neighbors(i, m_knn);
-
-        // compute covariance of the neighborhood
-        auto B = computeCovariance(view, ids);
-
-        // perform the eigen decomposition
-        SelfAdjointEigenSolver<Matrix3d> solver(B);
-        if (solver.info() != Success)
-            throwError("Cannot perform eigen decomposition.");
-        auto ev = solver.eigenvalues();
-
-        // test eigenvalues to label points that are approximately coplanar
-        if ((ev[1] > m_thresh1 * ev[0]) && (m_thresh2 * ev[1] > ev[2]))
-            view.setField(m_coplanar, i, 1u);
-        else
-            view.setField(m_coplanar, i, 0u);
+        PointId end = (std::min)(begin + blockSize, (PointId)view.size());
+        KDNeighbors nbrs = kdi.knnRange(begin, end, m_knn, 1);
+        computeCovarianceEigen(coords, nbrs, eigens);
+
+        for (PointId i = begin; i < end; ++i)
+        {
+            const CovarianceEigen& e = eigens[i - begin];
+            if (!e.valid)
+                throwError("Cannot perform eigen decomposition.");
+            const Eigen::Vector3d& ev = e.values;
+
+            // test eigenvalues to label points that are approximately
+            // coplanar
+            if ((ev[1] > m_thresh1 * ev[0]) && (m_thresh2 * ev[1] > ev[2]))
+                view.setField(m_coplanar, i, 1u);
+            else
+                view.setField(m_coplanar, i, 0u);
+        }
     }
 }
 
@@ -38,6 +38,7 @@
 #include <pdal/util/ProgramArgs.hpp>
 
 #include "private/DimRange.hpp"
+#include "private/Selection.hpp"
 
 namespace pdal
 {
@@ -51,6 +52,14 @@ static StaticPluginInfo const s_info
 
 CREATE_STATIC_STAGE(AssignFilter, s_info)
 
+namespace
+{
+
+// Number of points whose selections are evaluated together.
+const point_count_t BatchSize = 4096;
+
+} // unnamed namespace
+
 struct AssignRange : public DimRange
 {
     void parse(const std::string& r);
@@ -61,6 +70,10 @@ struct AssignArgs
 {
     std::vector<AssignRange> m_assignments;
     DimRange m_condition;
+
+    // Compiled forms of the condition and of the range of each assignment.
+    std::unique_ptr<Selection> m_conditionSelection;
+    std::vector<Selection> m_selections;
 };
 
 void AssignRange::parse(const std::string& r)
@@ -146,31 +159,85 @@ void AssignFilter::prepared(PointTableRef table)
             throwError("Invalid dimension name in 'assignment' option: '" +
                 r.m_name + "'.");
     }
+
+    m_args->m_conditionSelection.reset();
+    if (m_args->m_condition.m_id != Dimension::Id::Unknown)
+    {
+        m_args->m_conditionSelection.reset(new Selection);
+        m_args->m_conditionSelection->pushRange(m_args->m_condition);
+    }
+    m_args->m_selections.clear();
+    for (auto& r : m_args->m_assignments)
+    {
+        Selection s;
+        s.pushRange(r);
+        m_args->m_selections.push_back(s);
+    }
 }
 
 
 bool AssignFilter::processOne(PointRef& point)
 {
-    if (m_args->m_condition.m_id != Dimension::Id::Unknown)
+    if (m_args->m_conditionSelection &&
+            !m_args->m_conditionSelection->passes(point))
+        return true;
+    for (size_t i = 0; i < m_args->m_assignments.size(); ++i)
+        if (m_args->m_selections[i].passes(point))
+            point.setField(m_args->m_assignments[i].m_id,
+                m_args->m_assignments[i].m_value);
+    return true;
+}
+
+
+// Apply the assignments to the points of a range whose flag in 'active' is
+// set.  Assignments are applied in order, so each one sees the values
+// set by the ones before it.
+void AssignFilter::assign(PointContainer& container, PointId begin,
+    point_count_t count, std::vector<char>& active)
+{
+    std::vector<char> mask;
+    if (m_args->m_conditionSelection)
     {
-        double condVal = point.getFieldAs<double>(m_args->m_condition.m_id);
-        if (!m_args->m_condition.valuePasses(condVal))
-            return true;
+        m_args->m_conditionSelection->run(container, begin, count, mask);
+        for (point_count_t i = 0; i < count; ++i)
+            active[i] = active[i] && mask[i];
     }
-    for (AssignRange& r : m_args->m_assignments)
-        if (r.valuePasses(point.getFieldAs<double>(r.m_id)))
-            point.setField(r.m_id, r.m_value);
-    return true;
+
+    PointRef point(container, begin);
+    for (size_t a = 0; a < m_args->m_assignments.size(); ++a)
+    {
+        const AssignRange& r = m_args->m_assignments[a];
+        m_args->m_selections[a].run(container, begin, count, mask);
+        for (point_count_t i = 0; i < count; ++i)
+            if (active[i] && mask[i])
+            {
+                point.setPointId(begin + i);
+                point.setField(r.m_id, r.m_value);
+            }
+    }
+}
+
+
+// Assignment never filters out points, so skips don't need to be set.
+point_count_t AssignFilter::processBatch(StreamPointTable& table,
+    PointId begin, point_count_t count)
+{
+    std::vector<char> active(count);
+    for (PointId idx : table.activeIds(begin, count))
+        active[idx - begin] = !table.skip(idx);
+    assign(table, begin, count, active);
+    return count;
 }
 
 
 void AssignFilter::filter(PointView& view)
 {
-    PointRef point(view, 0);
-    for (PointId id = 0; id < view.size(); ++id)
+    std::vector<char> active;
+    for (PointId begin = 0; begin < view.size(); begin += BatchSize)
     {
-        point.setPointId(id);
-        processOne(point);
+        point_count_t count = (std::min)(BatchSize, view.size() - begin);
+        active.assign(count, 1);
+        assign(view, begin, count, active);
     }
 }
 
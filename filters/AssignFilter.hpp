@@ -54,7 +54,18 @@ private:
     virtual void addArgs(ProgramArgs& args);
     virtual void prepared(PointTableRef table);
     virtual bool processOne(PointRef& point);
+    virtual point_count_t processBatch(StreamPointTable& table, PointId begin,
+        point_count_t count);
     virtual void filter(PointView& view);
+    void assign(PointContainer& container, PointId begin, point_count_t count,
+        std::vector<char>& active);
+    virtual bool reentrant() const
+        { return true; }
+    virtual bool fusable() const
+        { return true; }
+    // Points are neither added, removed nor reordered.
+    virtual void inputLimit(PointLimit& /*limit*/) const
+        {}
 
     AssignFilter& operator=(const AssignFilter&) = delete;
     AssignFilter(const AssignFilter&) = delete;
@@ -45,6 +45,7 @@
 #include <pdal/util/ProgramArgs.hpp>
 
 #include "private/DimRange.hpp"
+#include "private/GroundTiles.hpp"
 #include "private/Segmentation.hpp"
 #include "private/csf/CSF.h"
 
@@ -80,6 +81,7 @@ struct CSArgs
     int m_iterations;
     std::vector<DimRange> m_ignored;
     StringList m_returns;
+    GroundTiles m_tiles;
 };
 
 CSFilter::CSFilter() : m_args(new CSArgs)
@@ -102,6 +104,7 @@ void CSFilter::addArgs(ProgramArgs& args)
     args.add("ignore", "Ignore values", m_args->m_ignored);
     args.add("returns", "Include last returns?", m_args->m_returns,
              {"last", "only"});
+    m_args->m_tiles.addArgs(args);
 }
 
 void CSFilter::addDimensions(PointLayoutPtr layout)
@@ -210,13 +213,28 @@ PointViewSet CSFilter::run(PointViewPtr view)
     for (PointId i = 0; i < secondView->size(); ++i)
         secondView->setField(Dimension::Id::Classification, i, 1);
 
+    // The cloth reaches about ten cells beyond a point.
+    m_args->m_tiles.classify(firstView, 10 * m_args->m_resolution, log(),
+        [this](PointViewPtr tile, LogPtr log) { classify(tile, log); });
+
+    PointViewPtr outView = view->makeNew();
+    outView->append(*ignoredView);
+    outView->append(*secondView);
+    outView->append(*firstView);
+    viewSet.insert(outView);
+
+    return viewSet;
+}
+
+void CSFilter::classify(PointViewPtr view, LogPtr log)
+{
     csf::PointCloud csfPC;
-    for (PointId i = 0; i < firstView->size(); ++i)
+    for (PointId i = 0; i < view->size(); ++i)
     {
         csf::Point p;
-        p.x = firstView->getFieldAs<double>(Dimension::Id::X, i);
-        p.y = firstView->getFieldAs<double>(Dimension::Id::Y, i);
-        p.z = firstView->getFieldAs<double>(Dimension::Id::Z, i);
+        p.x = view->getFieldAs<double>(Dimension::Id::X, i);
+        p.y = view->getFieldAs<double>(Dimension::Id::Y, i);
+        p.z = view->getFieldAs<double>(Dimension::Id::Z, i);
         csfPC.push_back(p);
     }
 
@@ -227,8 +245,10 @@ PointViewSet CSFilter::run(PointViewPtr view)
     c.params.cloth_resolution = m_args->m_resolution;
     c.params.rigidness = m_args->m_rigid;
     c.params.interations = m_args->m_iterations;
+    // Tiles are already classified concurrently.
+    c.params.threads = m_args->m_tiles.tiled() ? 1 : m_args->m_tiles.threads();
     std::vector<int> groundIdx, offGroundIdx;
-    c.setLog(log());
+    c.setLog(log);
     c.setPointCloud(csfPC);
     try
     {
@@ -240,17 +260,9 @@ PointViewSet CSFilter::run(PointViewPtr view)
     }
 
     for (auto const& i : groundIdx)
-        firstView->setField(Dimension::Id::Classification, i, 2);
+        view->setField(Dimension::Id::Classification, i, 2);
     for (auto const& i : offGroundIdx)
-        firstView->setField(Dimension::Id::Classification, i, 1);
-
-    PointViewPtr outView = view->makeNew();
-    outView->append(*ignoredView);
-    outView->append(*secondView);
-    outView->append(*firstView);
-    viewSet.insert(outView);
-
-    return viewSet;
+        view->setField(Dimension::Id::Classification, i, 1);
 }
 
 } // namespace pdal
@@ -59,6 +59,7 @@ private:
     virtual void prepared(PointTableRef table);
     virtual PointViewSet run(PointViewPtr view);
 
+    void classify(PointViewPtr view, LogPtr log);
     void classifyGround(PointViewPtr, std::vector<double>&);
 };
 
@@ -33,9 +33,13 @@
 
 #include "ChipperFilter.hpp"
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <limits>
 
+#include <pdal/util/TaskScheduler.hpp>
+
 /**
 The objective is to split the region into non-overlapping blocks, each
 containing approximately the same number of points, as specified by the
@@ -60,10 +64,17 @@ This procedure is then recursively applied to the created blocks until
 they contains only one or two partitions.  In the case of one or two
 partitions we are done, and we simply store away the contents of the
 blocks.
+
+Blocks occupy the same range of each array, so the two blocks created by a
+split are processed concurrently when threads are available.  The points
+of each chip are stored in the chip's range of a single point order, and
+the output views are made from it once all the chips are known.
 **/
 
 #include <pdal/util/ProgramArgs.hpp>
 
+#include "private/RadixSort.hpp"
+
 namespace pdal
 {
 
@@ -78,10 +89,27 @@ CREATE_STATIC_STAGE(ChipperFilter, s_info)
 
 std::string ChipperFilter::getName() const { return s_info.name; }
 
+namespace
+{
+
+// Inverse of radix::orderedKey() for doubles.
+double keyValue(uint64_t key)
+{
+    uint64_t u = (key & 0x8000000000000000ull) ?
+        (key & ~0x8000000000000000ull) : ~key;
+    double d;
+    std::memcpy(&d, &u, sizeof(d));
+    return d;
+}
+
+} // unnamed namespace
+
 void ChipperFilter::addArgs(ProgramArgs& args)
 {
     args.add("capacity", "Maximum number of points per cell", m_threshold,
         (PointId) 5000u);
+    args.add("threads", "Number of threads used to sort and split points",
+        m_threads, 1);
 }
 
 
@@ -92,53 +120,74 @@ PointViewSet ChipperFilter::run(PointViewPtr view)
 
     m_inView = view;
     m_partitions.resize(0);
-    m_xvec.resize(0);
-    m_yvec.resize(0);
-    m_spare.resize(view->size());
     m_outViews.clear();
-
-    m_xvec.reserve(view->size());
-    m_yvec.reserve(view->size());
+    m_chips.clear();
 
     load(*view.get(), m_xvec, m_yvec, m_spare);
     partition(m_xvec.size());
-    decideSplit(m_xvec, m_yvec, m_spare, 0, m_partitions.size() - 1);
-    return m_outViews;
+    m_order.resize(view->size());
+    decideSplit(m_xvec, m_yvec, m_spare, 0, m_partitions.size() - 1,
+        (std::max)(m_threads, 1));
+    std::vector<ChipPtRef>().swap(m_xvec.m_vec);
+    std::vector<ChipPtRef>().swap(m_yvec.m_vec);
+    std::vector<ChipPtRef>().swap(m_spare.m_vec);
+
+    // Chips are numbered in the order of a serial traversal of the splits,
+    // which is the order of their ranges.
+    std::sort(m_chips.begin(), m_chips.end());
+    for (const ChipRange& chip : m_chips)
+    {
+        PointViewPtr out = m_inView->makeNew();
+        for (PointId idx = chip.first; idx < chip.second; ++idx)
+            out->appendPoint(*m_inView, m_order[idx]);
+        m_outViews.insert(out);
+    }
+    PointIdList().swap(m_order);
+    m_inView.reset();
+
+    PointViewSet outViews;
+    outViews.swap(m_outViews);
+    return outViews;
 }
 
 
 void ChipperFilter::load(PointView& view, ChipRefList& xvec, ChipRefList& yvec,
     ChipRefList& spare)
 {
-    for (PointId i = 0; i < view.size(); ++i)
-    {
-        ChipPtRef xref;
-
-        xref.m_pos = view.getFieldAs<double>(Dimension::Id::X, i);
-        xref.m_ptindex = i;
-        xvec.push_back(xref);
+    loadSorted(view, Dimension::Id::X, xvec);
+    loadSorted(view, Dimension::Id::Y, yvec);
 
-        ChipPtRef yref;
-
-        yref.m_pos = view.getFieldAs<double>(Dimension::Id::Y, i);
-        yref.m_ptindex = i;
-        yvec.push_back(yref);
-    }
-
-    // Sort xvec and assign other index in yvec to sorted indices in xvec.
-    std::stable_sort(xvec.begin(), xvec.end());
+    // Link each point in yvec to its position in xvec and the reverse.
+    // The spare array maps point IDs to positions in xvec until it's
+    // needed for splitting.
+    spare.resize(view.size());
     for (size_t i = 0; i < xvec.size(); ++i)
+        spare[xvec[i].m_ptindex].m_oindex = i;
+    for (size_t i = 0; i < yvec.size(); ++i)
     {
-        point_count_t idx = xvec[i].m_ptindex;
-        yvec[idx].m_oindex = i;
+        size_t xidx = spare[yvec[i].m_ptindex].m_oindex;
+        yvec[i].m_oindex = xidx;
+        xvec[xidx].m_oindex = i;
     }
+}
 
-    // Sort yvec.
-    std::stable_sort(yvec.begin(), yvec.end());
 
-    // Iterate through the yvector, setting the xvector appropriately.
-    for (size_t i = 0; i < yvec.size(); ++i)
-        xvec[yvec[i].m_oindex].m_oindex = i;
+// Fill a list with the points of a view in ascending order of a dimension.
+// Points with the same value stay in view order.
+void ChipperFilter::loadSorted(PointView& view, Dimension::Id dim,
+    ChipRefList& vec)
+{
+    radix::EntryList entries = radix::makeEntries(view.size(),
+        (unsigned)(std::max)(m_threads, 1), [&view, dim](PointId idx)
+        { return radix::orderedKey(view.getFieldAs<double>(dim, idx)); });
+    radix::sort(entries, (unsigned)(std::max)(m_threads, 1));
+
+    vec.resize(entries.size());
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        vec[i].m_pos = keyValue(entries[i].key);
+        vec[i].m_ptindex = entries[i].id;
+    }
 }
 
 
@@ -182,7 +231,7 @@ void ChipperFilter::partition(point_count_t size)
 
 
 void ChipperFilter::decideSplit(ChipRefList& v1, ChipRefList& v2,
-    ChipRefList& spare, PointId pleft, PointId pright)
+    ChipRefList& spare, PointId pleft, PointId pright, int threads)
 {
     double v1range;
     double v2range;
@@ -194,13 +243,13 @@ void ChipperFilter::decideSplit(ChipRefList& v1, ChipRefList& v2,
     v1range = v1[right].m_pos - v1[left].m_pos;
     v2range = v2[right].m_pos - v2[left].m_pos;
     if (v1range > v2range)
-        split(v1, v2, spare, pleft, pright);
+        split(v1, v2, spare, pleft, pright, threads);
     else
-        split(v2, v1, spare, pleft, pright);
+        split(v2, v1, spare, pleft, pright, threads);
 }
 
 void ChipperFilter::split(ChipRefList& wide, ChipRefList& narrow,
-    ChipRefList& spare, PointId pleft, PointId pright)
+    ChipRefList& spare, PointId pleft, PointId pright, int threads)
 {
     PointId lstart;
     PointId rstart;
@@ -252,18 +301,35 @@ void ChipperFilter::split(ChipRefList& wide, ChipRefList& narrow,
             }
         }
 
-        decideSplit(wide, spare, narrow, pleft, pcenter);
-        decideSplit(wide, spare, narrow, pcenter, pright);
+        // The two blocks occupy separate ranges of the arrays, so they
+        // can be split concurrently.
+        if (threads > 1)
+        {
+            TaskGroup group;
+            group.run([&wide, &spare, &narrow, pleft, pcenter, threads,
+                this]()
+            {
+                decideSplit(wide, spare, narrow, pleft, pcenter, threads / 2);
+            });
+            decideSplit(wide, spare, narrow, pcenter, pright,
+                threads - threads / 2);
+            group.wait();
+        }
+        else
+        {
+            decideSplit(wide, spare, narrow, pleft, pcenter, 1);
+            decideSplit(wide, spare, narrow, pcenter, pright, 1);
+        }
     }
 }
 
 void ChipperFilter::emit(ChipRefList& wide, PointId widemin, PointId widemax)
 {
-    PointViewPtr view = m_inView->makeNew();
-    for (size_t idx = widemin; idx <= widemax; ++idx)
-        view->appendPoint(*m_inView.get(), wide[idx].m_ptindex);
+    for (PointId idx = widemin; idx <= widemax; ++idx)
+        m_order[idx] = wide[idx].m_ptindex;
 
-    m_outViews.insert(view);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_chips.push_back({ widemin, widemax + 1 });
 }
 
 } // namespace pdal
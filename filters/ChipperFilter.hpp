@@ -43,6 +43,7 @@
 
 #include <pdal/Filter.hpp>
 #include <pdal/PointView.hpp>
+#include <mutex>
 #include <vector>
 
 namespace pdal
@@ -121,20 +122,28 @@ private:
 
     void load(PointView& view, ChipRefList& xvec,
         ChipRefList& yvec, ChipRefList& spare);
+    void loadSorted(PointView& view, Dimension::Id dim, ChipRefList& vec);
     void partition(point_count_t size);
     void decideSplit(ChipRefList& v1, ChipRefList& v2,
-        ChipRefList& spare, PointId left, PointId right);
+        ChipRefList& spare, PointId left, PointId right, int threads);
     void split(ChipRefList& wide, ChipRefList& narrow,
-        ChipRefList& spare, PointId left, PointId right);
+        ChipRefList& spare, PointId left, PointId right, int threads);
     void emit(ChipRefList& wide, PointId widemin, PointId widemax);
 
+    // A chip is the range [first, end) of m_order.
+    using ChipRange = std::pair<PointId, PointId>;
+
     PointId m_threshold;
+    int m_threads;
     PointViewPtr m_inView;
     PointViewSet m_outViews;
     PointIdList m_partitions;
     ChipRefList m_xvec;
     ChipRefList m_yvec;
     ChipRefList m_spare;
+    PointIdList m_order;
+    std::vector<ChipRange> m_chips;
+    std::mutex m_mutex;
 
     ChipperFilter& operator=(const ChipperFilter&); // not implemented
     ChipperFilter(const ChipperFilter&); // not implemented
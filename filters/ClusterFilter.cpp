@@ -36,6 +36,7 @@
 
 #include "private/Segmentation.hpp"
 
+#include <algorithm>
 #include <string>
 
 namespace pdal
@@ -62,6 +63,18 @@ void ClusterFilter::addArgs(ProgramArgs& args)
     args.add("max_points", "Max points per cluster", m_maxPoints,
         (std::numeric_limits<uint64_t>::max)());
     args.add("tolerance", "Radius", m_tolerance, 1.0);
+    args.add("threads", "Number of threads used to run this filter",
+        m_threads, 1);
+    args.add("order", "Order in which cluster IDs are assigned: 'point' "
+        "or 'size'", m_order, "point");
+}
+
+void ClusterFilter::initialize()
+{
+    m_order = Utils::tolower(m_order);
+    if (m_order != "point" && m_order != "size")
+        throwError("Invalid 'order' value '" + m_order + "'.  Must be "
+            "'point' or 'size'.");
 }
 
 void ClusterFilter::addDimensions(PointLayoutPtr layout)
@@ -72,7 +85,14 @@ void ClusterFilter::addDimensions(PointLayoutPtr layout)
 void ClusterFilter::filter(PointView& view)
 {
     auto clusters = Segmentation::extractClusters(view, m_minPoints,
-        m_maxPoints, m_tolerance);
+        m_maxPoints, m_tolerance, m_threads);
+
+    // Clusters come in the order of their first point.  The sort is stable,
+    // so clusters of the same size keep that order.
+    if (m_order == "size")
+        std::stable_sort(clusters.begin(), clusters.end(),
+            [](const PointIdList& a, const PointIdList& b)
+            { return a.size() > b.size(); });
 
     uint64_t id = 1;
     for (auto const& c : clusters)
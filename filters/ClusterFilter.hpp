@@ -57,8 +57,11 @@ private:
     uint64_t m_minPoints;
     uint64_t m_maxPoints;
     double m_tolerance;
+    int m_threads;
+    std::string m_order;
 
     virtual void addArgs(ProgramArgs& args);
+    virtual void initialize();
     virtual void addDimensions(PointLayoutPtr layout);
     virtual void filter(PointView& view);
 };
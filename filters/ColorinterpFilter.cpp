@@ -34,6 +34,7 @@
 
 #include "ColorinterpFilter.hpp"
 
+#include <pdal/DimAccessor.hpp>
 #include <pdal/GDALUtils.hpp>
 #include <pdal/PointView.hpp>
 #include <pdal/util/ProgramArgs.hpp>
@@ -41,6 +42,8 @@
 #include <array>
 #include <algorithm>
 #include <cmath>
+#include <limits>
+#include <numeric>
 
 #include "ColorInterpRamps.hpp"
 
@@ -142,7 +145,7 @@ void ColorinterpFilter::prepared(PointTableRef table)
 
 
 /**
-  Read the band data into local vectors.
+  Read the band data into the color lookup table.
 
   \param table  Point table.
 */
@@ -158,9 +161,25 @@ void ColorinterpFilter::ready(PointTableRef table)
     log()->get(LogLevel::Debug) << getName() << " raster connection: " <<
         m_raster->filename() << std::endl;
 
-    m_raster->readBand(m_redBand, 1);
-    m_raster->readBand(m_greenBand, 2);
-    m_raster->readBand(m_blueBand, 3);
+    std::vector<uint8_t> red;
+    std::vector<uint8_t> green;
+    std::vector<uint8_t> blue;
+    m_raster->readBand(red, 1);
+    m_raster->readBand(green, 2);
+    m_raster->readBand(blue, 3);
+
+    // The lookup table holds the colors of the ramp in the order in which
+    // they're applied, so inverting the ramp costs nothing per point.
+    m_lut.resize(red.size());
+    for (size_t i = 0; i < red.size(); ++i)
+    {
+        size_t src = m_invertRamp ? red.size() - 1 - i : i;
+        m_lut[i] = { { red[src], green[src], blue[src] } };
+    }
+    if (m_lut.empty())
+        throwError("Color ramp '" + m_colorramp + "' has no colors.");
+    if (!std::isnan(m_min) && !std::isnan(m_max))
+        m_scale = m_lut.size() / (m_max - m_min);
 }
 
 
@@ -234,25 +253,29 @@ void ColorinterpFilter::filter(PointView& view)
     // compute them.
     else if (std::isnan(m_min) || std::isnan(m_max))
     {
-        stats::Summary summary(Dimension::name(m_interpDim),
-            stats::Summary::NoEnum, false);
+        double minimum = (std::numeric_limits<double>::max)();
+        double maximum = std::numeric_limits<double>::lowest();
+        DimAccessor<double> values(view, m_interpDim);
         for (PointId idx = 0; idx < view.size(); ++idx)
         {
-            double v = view.getFieldAs<double>(m_interpDim, idx);
-            summary.insert(v);
+            double v = values.get(idx);
+            minimum = (std::min)(minimum, v);
+            maximum = (std::max)(maximum, v);
         }
 
         if (std::isnan(m_min))
-            m_min = summary.minimum();
+            m_min = minimum;
         if (std::isnan(m_max))
-            m_max = summary.maximum();
+            m_max = maximum;
     }
+    m_scale = m_lut.size() / (m_max - m_min);
 
-    PointRef point(view, 0);
-    for (PointId idx = 0; idx < view.size(); ++idx)
+    PointIdList ids(BatchSize);
+    for (PointId begin = 0; begin < view.size(); begin += BatchSize)
     {
-        point.setPointId(idx);
-        processOne(point);
+        point_count_t count = (std::min)(BatchSize, view.size() - begin);
+        std::iota(ids.begin(), ids.begin() + count, begin);
+        colorize(view, ids.data(), count);
     }
 }
 
@@ -270,21 +293,71 @@ bool ColorinterpFilter::processOne(PointRef& point)
     double v = point.getFieldAs<double>(m_interpDim);
 
     // Don't color points that aren't in the min/max range.
-    if (v < m_min || v >= m_max)
+    if (!(v >= m_min && v < m_max))
         return true;
 
-    double factor = (v - m_min) / (m_max - m_min);
-    size_t img_width = m_redBand.size();
-    size_t position = size_t(std::floor(factor * img_width));
+    const std::array<uint8_t, 3>& rgb = m_lut[position(v)];
+    point.setField(Dimension::Id::Red, rgb[0]);
+    point.setField(Dimension::Id::Green, rgb[1]);
+    point.setField(Dimension::Id::Blue, rgb[2]);
+    return true;
+}
 
-    if (m_invertRamp)
-        position = (img_width - 1) - position;
 
-    point.setField(Dimension::Id::Red, m_redBand[position]);
-    point.setField(Dimension::Id::Blue, m_blueBand[position]);
-    point.setField(Dimension::Id::Green, m_greenBand[position]);
+point_count_t ColorinterpFilter::processBatch(StreamPointTable& table,
+    PointId begin, point_count_t count)
+{
+    auto ids = table.activeIds(begin, count);
+    PointIdList active;
+    for (PointId idx : ids)
+        if (!table.skip(idx))
+            active.push_back(idx);
+    for (size_t start = 0; start < active.size(); start += BatchSize)
+        colorize(table, active.data() + start,
+            (std::min)((size_t)BatchSize, active.size() - start));
+    return count;
+}
 
-    return true;
+
+// Values are read into a buffer and converted to ramp positions in a loop
+// without branches or calls so that the compiler can vectorize it.  Points
+// outside of the min/max range get the position -1 and aren't colored.
+void ColorinterpFilter::colorize(PointContainer& container,
+    const PointId *ids, size_t count)
+{
+    std::vector<double> values(count);
+    std::vector<int32_t> positions(count);
+
+    PointRef point(container);
+    for (size_t i = 0; i < count; ++i)
+    {
+        point.setPointId(ids[i]);
+        values[i] = point.getFieldAs<double>(m_interpDim);
+    }
+
+    const double lo = m_min;
+    const double hi = m_max;
+    const double scale = m_scale;
+    const double last = (double)(m_lut.size() - 1);
+    for (size_t i = 0; i < count; ++i)
+    {
+        const double v = values[i];
+        double f = (v - lo) * scale;
+        f = f > 0 ? f : 0;
+        f = f < last ? f : last;
+        positions[i] = (v >= lo && v < hi) ? (int32_t)f : -1;
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (positions[i] < 0)
+            continue;
+        const std::array<uint8_t, 3>& rgb = m_lut[positions[i]];
+        point.setPointId(ids[i]);
+        point.setField(Dimension::Id::Red, rgb[0]);
+        point.setField(Dimension::Id::Green, rgb[1]);
+        point.setField(Dimension::Id::Blue, rgb[2]);
+    }
 }
 
 } // namespace pdal
@@ -38,6 +38,8 @@
 #include <pdal/Streamable.hpp>
 #include <filters/StatsFilter.hpp>
 
+#include <algorithm>
+#include <array>
 #include <map>
 
 namespace pdal
@@ -58,6 +60,7 @@ public:
         , m_interpDimString("Z")
         , m_min(0.0)
         , m_max(0.0)
+        , m_scale(0.0)
         , m_rampFilename("/vsimem/colorramp.png")
         , m_invertRamp(false)
         , m_stdDevThreshold(0.0)
@@ -76,17 +79,30 @@ private:
     virtual void ready(PointTableRef table);
     virtual void addDimensions(PointLayoutPtr layout);
     virtual bool processOne(PointRef& point);
+    virtual point_count_t processBatch(StreamPointTable& table,
+        PointId begin, point_count_t count);
+
+    void colorize(PointContainer& container, const PointId *ids,
+        size_t count);
+
+    // Position in the lookup table of a value in [m_min, m_max).
+    size_t position(double v) const
+    {
+        size_t pos = size_t((v - m_min) * m_scale);
+        return (std::min)(pos, m_lut.size() - 1);
+    }
+
+    static const point_count_t BatchSize = 4096;
 
     Dimension::Id m_interpDim;
     std::string m_interpDimString;
     double m_min;
     double m_max;
+    double m_scale;
     std::string m_colorramp;
     std::shared_ptr<gdal::Raster> m_raster;
     std::string m_rampFilename;
-    std::vector<uint8_t> m_redBand;
-    std::vector<uint8_t> m_greenBand;
-    std::vector<uint8_t> m_blueBand;
+    std::vector<std::array<uint8_t, 3>> m_lut;
     bool m_invertRamp;
     double m_stdDevThreshold;
     bool m_useMAD;
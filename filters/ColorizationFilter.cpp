@@ -38,6 +38,7 @@
 #include <pdal/PointView.hpp>
 #include <pdal/util/ProgramArgs.hpp>
 
+#include <algorithm>
 #include <array>
 
 namespace pdal
@@ -198,25 +199,23 @@ void ColorizationFilter::ready(PointTableRef table)
             throwError(m_raster->errorMsg());
         }
     }
+
+    for (const BandInfo& b : m_bands)
+        if (b.m_band > (uint32_t)m_raster->bandCount())
+            throwError("Band " + std::to_string(b.m_band) + " for dimension '" +
+                b.m_name + "' is not in raster '" + m_rasterFilename + "'.");
 }
 
 
 bool ColorizationFilter::processOne(PointRef& point)
 {
-    static std::vector<double> data;
-
     double x = point.getFieldAs<double>(Dimension::Id::X);
     double y = point.getFieldAs<double>(Dimension::Id::Y);
 
-    if (m_raster->read(x, y, data) == gdal::GDALError::None)
+    if (m_raster->read(x, y, m_data) == gdal::GDALError::None)
     {
-        int i(0);
-        for (auto bi = m_bands.begin(); bi != m_bands.end(); ++bi)
-        {
-            BandInfo& b = *bi;
-            point.setField(b.m_dim, data[i] * b.m_scale);
-            ++i;
-        }
+        for (const BandInfo& b : m_bands)
+            point.setField(b.m_dim, m_data[b.m_band - 1] * b.m_scale);
         return true;
     }
     return false;
@@ -225,11 +224,30 @@ bool ColorizationFilter::processOne(PointRef& point)
 
 void ColorizationFilter::filter(PointView& view)
 {
-    PointRef point = view.point(0);
-    for (PointId idx = 0; idx < view.size(); ++idx)
+    const size_t numBands = m_raster->bandCount();
+    std::vector<double> xs;
+    std::vector<double> ys;
+    std::vector<bool> valid;
+    for (PointId begin = 0; begin < view.size(); begin += BatchSize)
     {
-        point.setPointId(idx);
-        processOne(point);
+        const PointId end = (std::min)(begin + BatchSize, view.size());
+        xs.clear();
+        ys.clear();
+        for (PointId idx = begin; idx < end; ++idx)
+        {
+            xs.push_back(view.getFieldAs<double>(Dimension::Id::X, idx));
+            ys.push_back(view.getFieldAs<double>(Dimension::Id::Y, idx));
+        }
+        m_raster->read(xs, ys, m_data, valid);
+
+        for (PointId idx = begin; idx < end; ++idx)
+        {
+            if (!valid[idx - begin])
+                continue;
+            const double *cell = m_data.data() + (idx - begin) * numBands;
+            for (const BandInfo& b : m_bands)
+                view.setField(b.m_dim, idx, cell[b.m_band - 1] * b.m_scale);
+        }
     }
 }
 
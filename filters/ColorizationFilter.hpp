@@ -83,9 +83,12 @@ private:
     virtual bool processOne(PointRef& point);
     virtual void filter(PointView& view);
 
+    static const point_count_t BatchSize = 100000;
+
     StringList m_dimSpec;
     std::string m_rasterFilename;
     std::vector<BandInfo> m_bands;
+    std::vector<double> m_data;
 
     std::unique_ptr<gdal::Raster> m_raster;
 };
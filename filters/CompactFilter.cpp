@@ -0,0 +1,97 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include "CompactFilter.hpp"
+
+namespace pdal
+{
+
+static StaticPluginInfo const s_info
+{
+    "filters.compact",
+    "Copy the points of a view into contiguous storage and free the "
+        "storage of points that no view refers to.",
+    "http://pdal.io/stages/filters.compact.html"
+};
+
+CREATE_STATIC_STAGE(CompactFilter, s_info)
+
+std::string CompactFilter::getName() const
+{
+    return s_info.name;
+}
+
+
+void CompactFilter::addArgs(ProgramArgs& args)
+{
+    args.add("threshold", "Compact a view only if its points take up less "
+        "than this fraction of the table's point storage", m_threshold, 1.0);
+}
+
+
+void CompactFilter::initialize()
+{
+    if (m_threshold < 0 || m_threshold > 1)
+        throwError("Option 'threshold' must be between 0 and 1.");
+}
+
+
+// Views of tables that can't free storage are passed through unchanged.
+PointViewSet CompactFilter::run(PointViewPtr view)
+{
+    PointViewSet viewSet;
+    viewSet.insert(view);
+
+    BasePointTable& table = view->table();
+    if (!table.releasableStorage())
+    {
+        log()->get(LogLevel::Debug) << getName() << ": point table " <<
+            "doesn't support compaction." << std::endl;
+        return viewSet;
+    }
+
+    const std::size_t viewBytes =
+        view->size() * view->layout()->storageSize();
+    if (viewBytes >= m_threshold * table.memoryUsed())
+        return viewSet;
+
+    view->compact();
+    std::size_t freed = table.releaseUnreferenced();
+    PDAL_LOG(log(), LogLevel::Debug) << getName() << ": compacted " <<
+        view->size() << " points and freed " << freed << " bytes." <<
+        std::endl;
+    return viewSet;
+}
+
+} // namespace pdal
@@ -1,5 +1,5 @@
 /******************************************************************************
-* Copyright (c) 2018, Hobu Inc. (info@hobu.co)
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
 *
 * All rights reserved.
 *
@@ -34,38 +34,27 @@
 
 #pragma once
 
-#include <string>
+#include <pdal/Filter.hpp>
 
 namespace pdal
 {
 
-class slpk_error
+class PDAL_DLL CompactFilter : public Filter
 {
 public:
-    slpk_error(const std::string& error) : m_error(error)
+    CompactFilter()
     {}
+    CompactFilter& operator=(const CompactFilter&) = delete;
+    CompactFilter(const CompactFilter&) = delete;
 
-    std::string what() const
-        { return m_error; }
+    std::string getName() const;
 
-    std::string m_error;
-};
-
-class ILeStream;
-
-class SlpkExtractor
-{
-public:
-    SlpkExtractor (const std::string& filename, const std::string& directory) :
-        m_filename(filename), m_directory(directory)
-    {}
-    void extract() const;
-    
 private:
-    std::string m_filename;
-    std::string m_directory;
+    double m_threshold;
 
-    void writeFile(std::string filename, ILeStream& in, size_t count) const;
+    virtual void addArgs(ProgramArgs& args);
+    virtual void initialize();
+    virtual PointViewSet run(PointViewPtr view);
 };
 
 } // namespace pdal
@@ -41,6 +41,7 @@
 #include <pdal/EigenUtils.hpp>
 #include <pdal/KDIndex.hpp>
 #include <pdal/util/ProgramArgs.hpp>
+#include <pdal/util/TaskScheduler.hpp>
 
 #include <Eigen/Dense>
 
@@ -71,6 +72,16 @@ void CovarianceFeaturesFilter::addArgs(ProgramArgs& args)
     args.add("threads", "Number of threads used to run this filter", m_threads, 1);
     args.add("feature_set", "Set of features to be computed", m_featureSet, "Dimensionality");
     args.add("stride", "Compute features on strided neighbors", m_stride, size_t(1));
+    args.add("knn_eps", "Approximation factor of the k-nearest neighbor "
+        "search.  0 finds the exact neighbors", m_eps, 0.0);
+}
+
+void CovarianceFeaturesFilter::initialize()
+{
+    if (m_eps < 0)
+        throwError("Option 'knn_eps' can't be negative.");
+    m_metadata.add("knn_eps", m_eps, "Approximation factor of the k-nearest "
+        "neighbor search");
 }
 
 void CovarianceFeaturesFilter::addDimensions(PointLayoutPtr layout)
@@ -87,39 +98,62 @@ void CovarianceFeaturesFilter::filter(PointView& view)
 
     KD3Index& kdi = view.build3dIndex();
 
-    point_count_t nloops = view.size();
-    std::vector<std::thread> threadList(m_threads);
-    for(int t = 0;t<m_threads;t++)
+    const point_count_t nloops = view.size();
+    const point_count_t threads = (std::max)(1, m_threads);
+    parallelFor(threads, threads, [&](std::size_t t)
     {
-        threadList[t] = std::thread(std::bind(
-                [&](const PointId start, const PointId end)
-                {
-                    for(PointId i = start;i<end;i++)
-                        setDimensionality(view, i, kdi);
-                },
-                t*nloops/m_threads,(t+1)==m_threads?nloops:(t+1)*nloops/m_threads));
-    }
-    for (auto &t: threadList)
-        t.join();
+        const PointId start = t * nloops / threads;
+        const PointId end = (t + 1) * nloops / threads;
+        if (m_stride == 1)
+            setDimensionality(view, start, end, kdi);
+        else
+            for (PointId i = start; i < end; i++)
+                setDimensionality(view, i, kdi);
+    });
 }
 
 void CovarianceFeaturesFilter::setDimensionality(PointView &view, const PointId &id, const KD3Index &kid)
 {
-    using namespace Eigen;
-
     // find the k-nearest neighbors
-    auto ids = kid.neighbors(id, m_knn + 1, m_stride);
+    auto ids = kid.approxNeighbors(id, m_knn + 1, m_eps, m_stride);
 
     // compute covariance of the neighborhood
-    auto B = computeCovariance(view, ids);
+    auto B = computeCovariance(kid.coords().data(), ids.data(), ids.size());
 
     // perform the eigen decomposition
-    SelfAdjointEigenSolver<Matrix3d> solver(B);
-    if (solver.info() != Success)
+    CovarianceEigen e;
+    e.valid = computeEigen3(B, e.values, e.vectors);
+    setFeatures(view, id, e);
+}
+
+// Without a stride, the neighborhoods of a block of points are found and
+// decomposed together, which lets the work run on the GPU when there is
+// one.
+void CovarianceFeaturesFilter::setDimensionality(PointView &view,
+    PointId start, PointId end, const KD3Index &kid)
+{
+    const double *coords = kid.coords().data();
+    const point_count_t blockSize = 4096;
+    std::vector<CovarianceEigen> eigens;
+    for (PointId begin = start; begin < end; begin += blockSize)
+    {
+        PointId last = (std::min)(begin + blockSize, end);
+        KDNeighbors nbrs = kid.knnRange(begin, last, m_knn + 1, 1, m_eps);
+        computeCovarianceEigen(coords, nbrs, eigens);
+        for (PointId i = begin; i < last; ++i)
+            setFeatures(view, i, eigens[i - begin]);
+    }
+}
+
+void CovarianceFeaturesFilter::setFeatures(PointView &view, PointId id,
+    const CovarianceEigen& e)
+{
+    if (!e.valid)
         throwError("Cannot perform eigen decomposition.");
+    const Eigen::Vector3d& ev = e.values;
+    const Eigen::Matrix3d& eigenVectors = e.vectors;
 
     // Extract eigenvalues and eigenvectors in decreasing order (largest eigenvalue first)
-    auto ev = solver.eigenvalues();
     std::vector<double> lambda = {(std::max(ev[2],0.0)),
                                   (std::max(ev[1],0.0)),
                                   (std::max(ev[0],0.0))};
@@ -127,7 +161,6 @@ void CovarianceFeaturesFilter::setDimensionality(PointView &view, const PointId
     if (lambda[0] == 0)
         throwError("Eigenvalues are all 0. Can't compute local features.");
 
-    auto eigenVectors = solver.eigenvectors();
     std::vector<double> v1(3), v2(3), v3(3);
     for (int i=0; i < 3; i++)
     {
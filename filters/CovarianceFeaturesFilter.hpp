@@ -40,6 +40,8 @@
 
 namespace pdal {
 
+struct CovarianceEigen;
+
 class PDAL_DLL CovarianceFeaturesFilter: public Filter
 {
 public:
@@ -56,12 +58,17 @@ private:
     std::string m_featureSet;
     std::map<std::string,Dimension::Id> m_extraDims;
     size_t m_stride;
+    double m_eps;
 
     virtual void addDimensions(PointLayoutPtr layout);
     virtual void addArgs(ProgramArgs &args);
+    virtual void initialize();
     virtual void filter(PointView &view);
 
     void setDimensionality(PointView &view, const PointId &id, const KD3Index &kid);
+    void setDimensionality(PointView &view, PointId start, PointId end,
+        const KD3Index &kid);
+    void setFeatures(PointView &view, PointId id, const CovarianceEigen& e);
 };
 }
 
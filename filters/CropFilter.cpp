@@ -44,8 +44,11 @@
 #include "private/Point.hpp"
 #include "private/pnp/GridPnp.hpp"
 
-#include <sstream>
+#include <algorithm>
+#include <cmath>
 #include <cstdarg>
+#include <limits>
+#include <sstream>
 
 namespace pdal
 {
@@ -78,7 +81,8 @@ CropFilter::ViewGeom::ViewGeom(ViewGeom&& vg) :
 
 std::string CropFilter::getName() const { return s_info.name; }
 
-CropFilter::CropFilter() : m_args(new CropArgs)
+CropFilter::CropFilter() : m_args(new CropArgs), m_cellWidth(0),
+    m_cellHeight(0), m_cols(0), m_rows(0)
 {}
 
 
@@ -127,6 +131,16 @@ void CropFilter::initialize()
 }
 
 
+bool CropFilter::addUsedDims(PointLayoutPtr /*layout*/,
+    Dimension::IdList& dims) const
+{
+    dims.push_back(Dimension::Id::X);
+    dims.push_back(Dimension::Id::Y);
+    dims.push_back(Dimension::Id::Z);
+    return true;
+}
+
+
 void CropFilter::ready(PointTableRef table)
 {
     // If the user didn't provide an SRS, take one from the table.
@@ -145,10 +159,19 @@ void CropFilter::ready(PointTableRef table)
 
 bool CropFilter::processOne(PointRef& point)
 {
-    for (auto& g : m_geoms)
-        for (auto& gridPnp : g.m_gridPnps)
-            if (crop(point, *gridPnp))
+    if (m_parts.size())
+    {
+        double x = point.getFieldAs<double>(Dimension::Id::X);
+        double y = point.getFieldAs<double>(Dimension::Id::Y);
+
+        // A point is outside of any part whose bounds don't contain it.
+        candidateParts(x, y, m_candidates);
+        if (m_args->m_cropOutside && m_candidates.size() < m_parts.size())
+            return true;
+        for (uint32_t p : m_candidates)
+            if (m_args->m_cropOutside != m_parts[p].m_gridPnp->inside(x, y))
                 return true;
+    }
 
     for (auto& box : m_boxes)
         if (box.is3d())
@@ -171,6 +194,20 @@ bool CropFilter::processOne(PointRef& point)
 }
 
 
+point_count_t CropFilter::processBatch(StreamPointTable& table,
+    PointId begin, point_count_t count)
+{
+    PointRef point(table, begin);
+    for (PointId idx : table.activeIds(begin, count))
+    {
+        point.setPointId(idx);
+        if (!CropFilter::processOne(point))
+            table.setSkip(idx);
+    }
+    return count;
+}
+
+
 void CropFilter::spatialReferenceChanged(const SpatialReference& srs)
 {
     transform(srs);
@@ -198,6 +235,7 @@ void CropFilter::transform(const SpatialReference& srs)
             geom.m_gridPnps.push_back(std::move(gridPnp));
         }
     }
+    buildIndex();
 
     // If we don't have any SRS, do nothing.
     if (srs.empty() && m_args->m_assignedSrs.empty())
@@ -227,16 +265,108 @@ void CropFilter::transform(const SpatialReference& srs)
 }
 
 
+void CropFilter::buildIndex()
+{
+    m_parts.clear();
+    m_partBounds.clear();
+    for (size_t i = 0; i < m_geoms.size(); ++i)
+    {
+        ViewGeom& geom = m_geoms[i];
+        std::vector<Polygon> polys = geom.m_poly.polygons();
+        for (size_t j = 0; j < geom.m_gridPnps.size(); ++j)
+        {
+            BOX2D bounds = polys[j].bounds().to2d();
+            m_parts.push_back({ geom.m_gridPnps[j].get(), bounds, i });
+            m_partBounds.grow(bounds);
+        }
+    }
+
+    m_cells.clear();
+    m_large.clear();
+    m_cols = 0;
+    m_rows = 0;
+    if (m_parts.empty())
+        return;
+
+    // Aim for about one cell per part, with square-ish cells.
+    double width = (std::max)(m_partBounds.maxx - m_partBounds.minx,
+        std::numeric_limits<double>::min());
+    double height = (std::max)(m_partBounds.maxy - m_partBounds.miny,
+        std::numeric_limits<double>::min());
+    double n = (double)m_parts.size();
+    m_cols = (size_t)(std::max)(1.0,
+        (std::min)(n, std::ceil(std::sqrt(n * width / height))));
+    m_rows = (size_t)(std::max)(1.0,
+        (std::min)(n, std::ceil(n / (double)m_cols)));
+    m_cellWidth = width / m_cols;
+    m_cellHeight = height / m_rows;
+    m_cells.resize(m_cols * m_rows);
+
+    auto col = [this](double x)
+    {
+        double c = std::floor((x - m_partBounds.minx) / m_cellWidth);
+        return (size_t)(std::min)((std::max)(c, 0.0), (double)(m_cols - 1));
+    };
+    auto row = [this](double y)
+    {
+        double r = std::floor((y - m_partBounds.miny) / m_cellHeight);
+        return (size_t)(std::min)((std::max)(r, 0.0), (double)(m_rows - 1));
+    };
+
+    const size_t maxCells = (std::max)((size_t)16, m_cells.size() / 16);
+    for (uint32_t i = 0; i < m_parts.size(); ++i)
+    {
+        const BOX2D& b = m_parts[i].m_bounds;
+        size_t c0 = col(b.minx);
+        size_t c1 = col(b.maxx);
+        size_t r0 = row(b.miny);
+        size_t r1 = row(b.maxy);
+        if ((c1 - c0 + 1) * (r1 - r0 + 1) > maxCells)
+        {
+            m_large.push_back(i);
+            continue;
+        }
+        for (size_t r = r0; r <= r1; ++r)
+            for (size_t c = c0; c <= c1; ++c)
+                m_cells[r * m_cols + c].push_back(i);
+    }
+}
+
+
+// Find the polygon parts whose bounds contain the position.
+void CropFilter::candidateParts(double x, double y,
+    std::vector<uint32_t>& parts) const
+{
+    parts.clear();
+    if (!m_partBounds.contains(x, y))
+        return;
+
+    size_t c = (size_t)((x - m_partBounds.minx) / m_cellWidth);
+    size_t r = (size_t)((y - m_partBounds.miny) / m_cellHeight);
+    c = (std::min)(c, m_cols - 1);
+    r = (std::min)(r, m_rows - 1);
+    for (uint32_t p : m_cells[r * m_cols + c])
+        if (m_parts[p].m_bounds.contains(x, y))
+            parts.push_back(p);
+    for (uint32_t p : m_large)
+        if (m_parts[p].m_bounds.contains(x, y))
+            parts.push_back(p);
+}
+
+
 PointViewSet CropFilter::run(PointViewPtr view)
 {
     PointViewSet viewSet;
 
     transform(view->spatialReference());
-    for (auto& geom : m_geoms)
+    if (m_geoms.size())
     {
-        PointViewPtr outView = view->makeNew();
-        crop(geom, *view, *outView);
-        viewSet.insert(outView);
+        std::vector<PointViewPtr> outViews;
+        for (size_t i = 0; i < m_geoms.size(); ++i)
+            outViews.push_back(view->makeNew());
+        crop(*view, outViews);
+        for (auto& outView : outViews)
+            viewSet.insert(outView);
     }
 
     for (auto& box : m_boxes)
@@ -308,23 +438,38 @@ void CropFilter::crop(const BOX2D& box, PointView& input, PointView& output)
 }
 
 
-bool CropFilter::crop(const PointRef& point, GridPnp& g)
+// Crop against all the polygons in a single pass over the points.  Each
+// point is only tested against the parts whose bounds contain it.  Output
+// is ordered as if each part were applied to the input in turn.
+void CropFilter::crop(PointView& input, std::vector<PointViewPtr>& outputs)
 {
-    double x = point.getFieldAs<double>(Dimension::Id::X);
-    double y = point.getFieldAs<double>(Dimension::Id::Y);
-    return (m_args->m_cropOutside != g.inside(x, y));
-}
-
+    std::vector<PointIdList> inside(m_parts.size());
+    for (PointId idx = 0; idx < input.size(); ++idx)
+    {
+        double x = input.getFieldAs<double>(Dimension::Id::X, idx);
+        double y = input.getFieldAs<double>(Dimension::Id::Y, idx);
+        candidateParts(x, y, m_candidates);
+        for (uint32_t p : m_candidates)
+            if (m_parts[p].m_gridPnp->inside(x, y))
+                inside[p].push_back(idx);
+    }
 
-void CropFilter::crop(const ViewGeom& g, PointView& input, PointView& output)
-{
-    PointRef point = input.point(0);
-    for (auto& gridPnp : g.m_gridPnps)
+    for (size_t p = 0; p < m_parts.size(); ++p)
     {
+        PointView& output = *outputs[m_parts[p].m_geom];
+        if (!m_args->m_cropOutside)
+        {
+            for (PointId idx : inside[p])
+                output.appendPoint(input, idx);
+            continue;
+        }
+
+        auto it = inside[p].begin();
         for (PointId idx = 0; idx < input.size(); ++idx)
         {
-            point.setPointId(idx);
-            if (crop(point, const_cast<GridPnp&>(*gridPnp)))
+            if (it != inside[p].end() && *it == idx)
+                ++it;
+            else
                 output.appendPoint(input, idx);
         }
     }
@@ -36,10 +36,12 @@
 
 #include <list>
 #include <memory>
+#include <vector>
 
 #include <pdal/Filter.hpp>
 #include <pdal/Polygon.hpp>
 #include <pdal/Streamable.hpp>
+#include <pdal/util/Bounds.hpp>
 
 namespace pdal
 {
@@ -73,29 +75,56 @@ private:
         Polygon m_poly;
         std::vector<std::unique_ptr<GridPnp>> m_gridPnps;
     };
+
+    // A single polygon of one of the crop geometries.
+    struct PolyPart
+    {
+        GridPnp *m_gridPnp;
+        BOX2D m_bounds;
+        size_t m_geom;
+    };
+
     std::unique_ptr<CropArgs> m_args;
     double m_distance2;
     std::vector<ViewGeom> m_geoms;
     std::vector<Bounds> m_boxes;
 
+    // Envelope index over the polygon parts of all crop geometries.
+    // Each grid cell lists the parts whose bounds intersect it.  Parts
+    // that would be entered into too many cells are kept in m_large.
+    std::vector<PolyPart> m_parts;
+    BOX2D m_partBounds;
+    double m_cellWidth;
+    double m_cellHeight;
+    size_t m_cols;
+    size_t m_rows;
+    std::vector<std::vector<uint32_t>> m_cells;
+    std::vector<uint32_t> m_large;
+    std::vector<uint32_t> m_candidates;
+
     void addArgs(ProgramArgs& args);
     virtual void initialize();
 
     virtual void ready(PointTableRef table);
+    virtual bool addUsedDims(PointLayoutPtr layout,
+        Dimension::IdList& dims) const;
     virtual void spatialReferenceChanged(const SpatialReference& srs);
     virtual bool processOne(PointRef& point);
+    virtual point_count_t processBatch(StreamPointTable& table, PointId begin,
+        point_count_t count);
     virtual PointViewSet run(PointViewPtr view);
     bool crop(const PointRef& point, const BOX2D& box);
     bool crop(const PointRef& point, const BOX3D& box);
     void crop(const BOX3D& box, PointView& input, PointView& output);
     void crop(const BOX2D& box, PointView& input, PointView& output);
     void crop(const Bounds& box, PointView& input, PointView& output);
-    bool crop(const PointRef& point, GridPnp& g);
-    void crop(const ViewGeom& g, PointView& input, PointView& output);
+    void crop(PointView& input, std::vector<PointViewPtr>& outputs);
     bool crop(const PointRef& point, const filter::Point& center);
     void crop(const filter::Point& center, PointView& input,
         PointView& output);
     void transform(const SpatialReference& srs);
+    void buildIndex();
+    void candidateParts(double x, double y, std::vector<uint32_t>& parts) const;
 
     CropFilter& operator=(const CropFilter&); // not implemented
     CropFilter(const CropFilter&); // not implemented
@@ -38,9 +38,14 @@
 #include "DBSCANFilter.hpp"
 
 #include <pdal/KDIndex.hpp>
+#include <pdal/util/TaskScheduler.hpp>
 
+#include "private/UnionFind.hpp"
+
+#include <algorithm>
+#include <functional>
 #include <string>
-#include <unordered_set>
+#include <vector>
 
 namespace pdal
 {
@@ -67,6 +72,8 @@ void DBSCANFilter::addArgs(ProgramArgs& args)
     args.add("eps", "Epsilon", m_eps, 1.0);
     args.add("dimensions", "Dimensions to cluster", m_dimStringList,
              {"X", "Y", "Z"});
+    args.add("threads", "Number of threads used to run this filter",
+        m_threads, 1);
 }
 
 void DBSCANFilter::addDimensions(PointLayoutPtr layout)
@@ -93,81 +100,77 @@ void DBSCANFilter::prepared(PointTableRef table)
     }
 }
 
+// A core point has at least min_points neighbors, counting itself.  Core
+// points that are neighbors of each other belong to the same cluster, so
+// the clusters are the sets of a union-find over the core points, which
+// can be joined on all threads.  A border point joins the cluster of its
+// core neighbor whose root (smallest core point ID) is smallest, and the
+// clusters are numbered in the order of their roots.  This is the
+// labeling of the sequential expansion of clusters in point order, for
+// any number of threads.
 void DBSCANFilter::filter(PointView& view)
 {
     // Construct KDFlexIndex for radius search.
     KDFlexIndex kdfi(view, m_dimIdList);
     kdfi.build();
 
-    // First pass through point cloud precomputes neighbor indices and
-    // initializes ClusterID to -2.
-    std::vector<PointIdList> neighbors(view.size());
-    for (PointId idx = 0; idx < view.size(); ++idx)
-    {
-        neighbors[idx] = kdfi.radius(idx, m_eps);
-        view.setField(m_cluster, idx, -2);
-    }
-
-    // Second pass through point cloud performs DBSCAN clustering.
-    int64_t cluster_label = 0;
-    for (PointId idx = 0; idx < view.size(); ++idx)
+    const point_count_t count = view.size();
+    const int threads = (std::max)(1, m_threads);
+    auto runThreads = [count, threads](std::function<void(PointId)> f)
     {
-        // Point has already been labeled, so move on to next.
-        if (view.getFieldAs<int64_t>(m_cluster, idx) != -2)
-            continue;
-
-        // Density of the neighborhood does not meet minimum number of points
-        // constraint, label as noise.
-        if (neighbors[idx].size() < m_minPoints)
+        auto run = [&f](PointId begin, PointId end)
         {
-            view.setField(m_cluster, idx, -1);
-            continue;
-        }
-
-        // Initialize some bookkeeping to track which neighbors have been
-        // considered for addition to the current cluster.
-        std::unordered_set<PointId> neighbors_next(neighbors[idx].begin(),
-                                                   neighbors[idx].end());
-        std::unordered_set<PointId> neighbors_visited;
-        neighbors_visited.insert(idx);
-
-        // Unlabeled point encountered; assign cluster label.
-        view.setField(m_cluster, idx, cluster_label);
+            for (PointId idx = begin; idx < end; ++idx)
+                f(idx);
+        };
+        const point_count_t n = threads;
+        parallelFor(n, n, [&run, count, n](std::size_t t)
+            { run(t * count / n, (t + 1) * count / n); });
+    };
+
+    // First pass finds the core points.
+    std::vector<char> core(count);
+    runThreads([&](PointId idx)
+    {
+        core[idx] = kdfi.radius(idx, m_eps).size() >= m_minPoints;
+    });
 
-        // Consider all neighbors.
-        while (!neighbors_next.empty())
+    // Second pass joins each core point with its core neighbors.
+    UnionFind sets(count);
+    runThreads([&](PointId idx)
+    {
+        if (!core[idx])
+            return;
+        for (PointId q : kdfi.radius(idx, m_eps))
+            if (core[q])
+                sets.unite(idx, q);
+    });
+
+    // Third pass finds the root of the cluster of each point.  Noise
+    // points are left with no root.
+    std::vector<PointId> roots(count, count);
+    runThreads([&](PointId idx)
+    {
+        if (core[idx])
         {
-            // Select first neighbor and move it to the visited set.
-            PointId p = *neighbors_next.begin();
-            neighbors_next.erase(neighbors_next.begin());
-            neighbors_visited.insert(p);
-
-            // Reassign cluster label to neighbor previously marked as noise.
-            if (view.getFieldAs<int64_t>(m_cluster, p) == -1)
-                view.setField(m_cluster, p, cluster_label);
-
-            // Neighbor has already been labeled, so move on to next.
-            if (view.getFieldAs<int64_t>(m_cluster, p) != -2)
-                continue;
-
-            // Assign cluster label to neighbor.
-            view.setField(m_cluster, p, cluster_label);
-
-            // If density of neighbor's neighborhood is sufficient, add it's
-            // neighbors to the set of neighbors to consider if they are not
-            // already.
-            if (neighbors[p].size() >= m_minPoints)
-            {
-                for (PointId q : neighbors[p])
-                {
-                    if (neighbors_visited.count(q) == 0)
-                        neighbors_next.insert(q);
-                }
-            }
+            roots[idx] = sets.find(idx);
+            return;
         }
-
-        cluster_label++;
-    }
+        for (PointId q : kdfi.radius(idx, m_eps))
+            if (core[q])
+                roots[idx] = (std::min)(roots[idx], sets.find(q));
+    });
+
+    // Number the clusters in the order of their roots and label the
+    // points.  Noise is labeled -1.
+    std::vector<int64_t> labels(count);
+    int64_t cluster_label = 0;
+    for (PointId idx = 0; idx < count; ++idx)
+        if (roots[idx] == idx)
+            labels[idx] = cluster_label++;
+    for (PointId idx = 0; idx < count; ++idx)
+        view.setField(m_cluster, idx,
+            roots[idx] == count ? -1 : labels[roots[idx]]);
 }
 
 } // namespace pdal
@@ -56,6 +56,7 @@ public:
 private:
     uint64_t m_minPoints;
     double m_eps;
+    int m_threads;
     Dimension::Id m_cluster;
     StringList m_dimStringList;
     Dimension::IdList m_dimIdList;
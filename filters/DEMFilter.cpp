@@ -34,6 +34,8 @@
 
 #include "DEMFilter.hpp"
 
+#include <algorithm>
+#include <numeric>
 #include <string>
 #include <vector>
 
@@ -59,6 +61,7 @@ struct DEMArgs
     DimRange m_range;
     std::string m_raster;
     int32_t m_band;
+    bool m_interpolate;
 };
 
 
@@ -83,6 +86,9 @@ void DEMFilter::addArgs(ProgramArgs& args)
     args.add("limits", "Dimension limits for filtering", m_args->m_range).setPositional();
     args.add("raster", "GDAL-readable raster to use for DEM", m_args->m_raster).setPositional();
     args.add("band", "Band number to filter (count from 1)", m_args->m_band, 1);
+    args.add("interpolate", "If true, interpolate the DEM bilinearly "
+        "rather than using the value of the cell containing a point",
+        m_args->m_interpolate, false);
 
 }
 
@@ -93,6 +99,9 @@ void DEMFilter::ready(PointTableRef table)
     m_raster.reset(new gdal::Raster(m_args->m_raster));
 
     m_raster->open();
+    if (m_raster->bandCount() && m_args->m_band > m_raster->bandCount())
+        throwError("Band " + std::to_string(m_args->m_band) + " is not in "
+            "raster '" + m_args->m_raster + "'.");
 }
 
 void DEMFilter::prepared(PointTableRef table)
@@ -103,33 +112,29 @@ void DEMFilter::prepared(PointTableRef table)
         throwError("Missing dimension with name '" + m_args->m_range.m_name + "'in input PointView.");
     if (m_args->m_band <= 0)
         throwError("Band must be greater than 0");
-
 }
 
 
 bool DEMFilter::processOne(PointRef& point)
 {
-    static std::vector<double> data;
-
-    double x = point.getFieldAs<double>(Dimension::Id::X);
-    double y = point.getFieldAs<double>(Dimension::Id::Y);
+    m_xs.assign(1, point.getFieldAs<double>(Dimension::Id::X));
+    m_ys.assign(1, point.getFieldAs<double>(Dimension::Id::Y));
     double z = point.getFieldAs<double>(m_args->m_dim);
 
-    bool passes(false);
+    m_raster->read(m_xs, m_ys, m_data, m_valid, m_args->m_interpolate);
+    return m_valid[0] && passes(z, m_data[m_args->m_band - 1]);
+}
 
-    if (m_raster->read(x, y, data) == gdal::GDALError::None)
-    {
-        double v = data[m_args->m_band-1];
-        double lb = v - m_args->m_range.m_lower_bound;
-        double ub = v + m_args->m_range.m_upper_bound;
 
+bool DEMFilter::passes(double z, double v) const
+{
+    double lb = v - m_args->m_range.m_lower_bound;
+    double ub = v + m_args->m_range.m_upper_bound;
 
-        if ( z >= lb && z <= ub)
-            passes = true;
-    }
-    return passes;
+    return (z >= lb && z <= ub);
 }
 
+
 PointViewSet DEMFilter::run(PointViewPtr inView)
 {
     PointViewSet viewSet;
@@ -138,11 +143,17 @@ PointViewSet DEMFilter::run(PointViewPtr inView)
 
     PointViewPtr outView = inView->makeNew();
 
-    for (PointId i = 0; i < inView->size(); ++i)
+    PointIdList ids;
+    std::vector<char> keep;
+    for (PointId begin = 0; begin < inView->size(); begin += BatchSize)
     {
-        PointRef point = inView->point(i);
-        if (processOne(point))
-            outView->appendPoint(*inView, i);
+        const PointId end = (std::min)(begin + BatchSize, inView->size());
+        ids.resize(end - begin);
+        std::iota(ids.begin(), ids.end(), begin);
+        test(*inView, ids, keep);
+        for (size_t i = 0; i < ids.size(); ++i)
+            if (keep[i])
+                outView->appendPoint(*inView, ids[i]);
     }
 
     viewSet.insert(outView);
@@ -150,4 +161,48 @@ PointViewSet DEMFilter::run(PointViewPtr inView)
 }
 
 
+point_count_t DEMFilter::processBatch(StreamPointTable& table,
+    PointId begin, point_count_t count)
+{
+    PointIdList ids;
+    for (PointId idx : table.activeIds(begin, count))
+        if (!table.skip(idx))
+            ids.push_back(idx);
+
+    std::vector<char> keep;
+    test(table, ids, keep);
+    for (size_t i = 0; i < ids.size(); ++i)
+        if (!keep[i])
+            table.setSkip(ids[i]);
+    return count;
+}
+
+
+void DEMFilter::test(PointContainer& container, const PointIdList& ids,
+    std::vector<char>& keep)
+{
+    const size_t numBands = m_raster->bandCount();
+    PointRef point(container);
+    m_xs.resize(ids.size());
+    m_ys.resize(ids.size());
+    for (size_t i = 0; i < ids.size(); ++i)
+    {
+        point.setPointId(ids[i]);
+        m_xs[i] = point.getFieldAs<double>(Dimension::Id::X);
+        m_ys[i] = point.getFieldAs<double>(Dimension::Id::Y);
+    }
+    m_raster->read(m_xs, m_ys, m_data, m_valid, m_args->m_interpolate);
+
+    keep.assign(ids.size(), 0);
+    for (size_t i = 0; i < ids.size(); ++i)
+    {
+        if (!m_valid[i])
+            continue;
+        point.setPointId(ids[i]);
+        double z = point.getFieldAs<double>(m_args->m_dim);
+        keep[i] = passes(z, m_data[i * numBands + m_args->m_band - 1]);
+    }
+}
+
+
 } // namespace pdal
@@ -40,6 +40,7 @@
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace pdal
 {
@@ -61,8 +62,14 @@ public:
 
 private:
 
+    static const point_count_t BatchSize = 100000;
+
     std::unique_ptr<DEMArgs> m_args;
     std::unique_ptr<gdal::Raster> m_raster;
+    std::vector<double> m_data;
+    std::vector<double> m_xs;
+    std::vector<double> m_ys;
+    std::vector<bool> m_valid;
 
     virtual void ready(PointTableRef table);
     virtual void addArgs(ProgramArgs& args);
@@ -70,6 +77,11 @@ private:
     virtual void prepared(PointTableRef table);
     virtual PointViewSet run(PointViewPtr view);
     virtual bool processOne(PointRef& point);
+    virtual point_count_t processBatch(StreamPointTable& table,
+        PointId begin, point_count_t count);
+    void test(PointContainer& container, const PointIdList& ids,
+        std::vector<char>& keep);
+    bool passes(double z, double v) const;
 
     DEMFilter& operator=(const DEMFilter&); // not implemented
     DEMFilter(const DEMFilter&); // not implemented
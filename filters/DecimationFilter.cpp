@@ -35,6 +35,7 @@
 #include "DecimationFilter.hpp"
 
 #include <pdal/PointView.hpp>
+#include <pdal/Reader.hpp>
 #include <pdal/util/ProgramArgs.hpp>
 
 namespace pdal
@@ -60,9 +61,29 @@ void DecimationFilter::addArgs(ProgramArgs& args)
         m_limit, (std::numeric_limits<point_count_t>::max)());
 }
 
+// A reader that reads only the points of the stride has already done the
+// decimation.
+void DecimationFilter::ready(PointTableRef table)
+{
+    m_index = 0;
+    m_strided = false;
+    if (getInputs().size() == 1)
+        if (auto r = dynamic_cast<const Reader *>(getInputs().front()))
+            m_strided = r->strided();
+    if (m_strided)
+        log()->get(LogLevel::Debug) << getName() << ": Reading every " <<
+            m_step << " points." << std::endl;
+}
+
+
 PointViewSet DecimationFilter::run(PointViewPtr inView)
 {
     PointViewSet viewSet;
+    if (m_strided)
+    {
+        viewSet.insert(inView);
+        return viewSet;
+    }
     PointViewPtr outView = inView->makeNew();
     decimate(*inView.get(), *outView.get());
     viewSet.insert(outView);
@@ -70,8 +91,30 @@ PointViewSet DecimationFilter::run(PointViewPtr inView)
 }
 
 
+// No point at or past 'limit' is kept, nor any past those needed to make
+// the number of points read from the output.  Only the points of the
+// stride are kept, so readers that can seek need only read those.
+void DecimationFilter::inputLimit(PointLimit& limit) const
+{
+    const point_count_t all = (std::numeric_limits<point_count_t>::max)();
+    point_count_t first = m_limit;
+    if (m_step && limit.m_first < (all - m_offset) / m_step)
+        first = (std::min)(first, m_offset + limit.m_first * m_step);
+    limit = PointLimit();
+    limit.m_first = first;
+    if (m_step > 1)
+    {
+        limit.m_offset = m_offset;
+        limit.m_step = m_step;
+    }
+}
+
+
 bool DecimationFilter::processOne(PointRef& point)
 {
+    if (m_strided)
+        return true;
+
     bool keep = true;
     if (m_index < m_offset || m_index >= m_limit)
         keep = false;
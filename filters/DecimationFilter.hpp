@@ -54,11 +54,15 @@ private:
     uint32_t m_offset;
     point_count_t m_limit;
     PointId m_index;
+    bool m_strided;
 
     virtual void addArgs(ProgramArgs& args);
-    void ready(PointTableRef table)
-        { m_index = 0; }
+    virtual void ready(PointTableRef table);
     bool processOne(PointRef& point);
+    virtual bool addUsedDims(PointLayoutPtr /*layout*/,
+            Dimension::IdList& /*dims*/) const
+        { return true; }
+    virtual void inputLimit(PointLimit& limit) const;
     PointViewSet run(PointViewPtr view);
     void decimate(PointView& input, PointView& output);
 
@@ -34,7 +34,7 @@
 
 #include <cstddef> // NULL
 #include "DelaunayFilter.hpp"
-#include "private/delaunator.hpp"
+#include "private/DelaunayStrips.hpp"
 
 namespace pdal
 {
@@ -62,6 +62,13 @@ DelaunayFilter::~DelaunayFilter()
 {}
 
 
+void DelaunayFilter::addArgs(ProgramArgs& args)
+{
+    args.add("threads", "Number of threads used to run this filter",
+        m_threads, 1);
+}
+
+
 void DelaunayFilter::filter(PointView& pointView)
 {
     // Returns NULL if the mesh already exists
@@ -77,6 +84,7 @@ void DelaunayFilter::filter(PointView& pointView)
     }
 
     std::vector<double> delaunayPoints;
+    delaunayPoints.reserve(2 * pointView.size());
     for (PointId i = 0; i < pointView.size(); i++)
     {
         delaunayPoints.push_back(
@@ -86,11 +94,13 @@ void DelaunayFilter::filter(PointView& pointView)
     }
 
     // Actually perform the triangulation
-    delaunator::Delaunator triangulation(delaunayPoints);
+    std::vector<std::size_t> triangles =
+        Delaunay::triangulate(delaunayPoints, m_threads);
 
-    for (std::size_t i = 0; i < triangulation.triangles.size(); i += 3)
-        mesh->add(triangulation.triangles[i+2], triangulation.triangles[i+1],
-            triangulation.triangles[i]);
+    // Faces are added with the opposite winding.
+    for (std::size_t i = 0; i < triangles.size(); i += 3)
+        std::swap(triangles[i], triangles[i + 2]);
+    mesh->append(triangles.data(), triangles.size());
 }
 
 } // namespace pdal
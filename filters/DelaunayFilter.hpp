@@ -50,7 +50,10 @@ public:
     std::string getName() const;
 
 private:
+    virtual void addArgs(ProgramArgs& args);
     virtual void filter(PointView& view);
+
+    int m_threads;
 };
 
 } // namespace pdal
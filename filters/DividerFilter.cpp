@@ -33,6 +33,8 @@
 
 #include "DividerFilter.hpp"
 
+#include "private/Partition.hpp"
+
 namespace pdal
 {
 
@@ -87,11 +89,15 @@ void DividerFilter::addArgs(ProgramArgs& args)
     m_cntArg = &args.add("count", "Number of output views", m_size);
     m_capArg = &args.add("capacity", "Maximum number of points in each "
         "output view", m_size);
+    args.add("threads", "Number of threads used to divide points",
+        m_threads, 1);
 }
 
 
 void DividerFilter::initialize()
 {
+    if (m_threads < 1)
+        throwError("Option 'threads' must be at least 1.");
     if (m_cntArg->set() && m_capArg->set())
         throwError("Can't specify both option 'count' and option 'capacity.");
     if (!m_cntArg->set() && !m_capArg->set())
@@ -121,36 +127,18 @@ PointViewSet DividerFilter::run(PointViewPtr inView)
 	m_size = ((inView->size() - 1) / m_size) + 1;
 
 
-    std::vector<PointViewPtr> views;
-    for (point_count_t i = 0; i < m_size; ++i)
-    {
-        PointViewPtr v(inView->makeNew());
-        views.push_back(v);
-        result.insert(v);
-    }
+    const point_count_t limit = ((inView->size() - 1) / m_size) + 1;
+    const point_count_t size = m_size;
+    const bool sequential = (m_mode == Mode::Partition);
+    partition::GroupList groups = partition::byKey(*inView, m_threads,
+        [limit, size, sequential](PointId i)
+        { return (uint64_t)(sequential ? i / limit : i % size); });
 
-    if (m_mode == Mode::Partition)
-    {
-        point_count_t limit = ((inView->size() - 1) / m_size) + 1;
-        unsigned viewNum = 0;
-        for (PointId i = 0; i < inView->size();)
-        {
-            views[viewNum]->appendPoint(*inView, i++);
-            if (i % limit == 0)
-                viewNum++;
-        }
-    }
-    else // RoundRobin
-    {
-        unsigned viewNum = 0;
-        for (PointId i = 0; i < inView->size(); ++i)
-        {
-            views[viewNum]->appendPoint(*inView, i);
-            viewNum++;
-            if (viewNum == m_size)
-                viewNum = 0;
-        }
-    }
+    // Groups come in key order.  Views beyond the last group are empty.
+    for (partition::Group& g : groups)
+        result.insert(g.view);
+    for (point_count_t i = groups.size(); i < m_size; ++i)
+        result.insert(inView->makeNew());
     return result;
 }
 
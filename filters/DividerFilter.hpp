@@ -67,6 +67,7 @@ private:
     Mode m_mode;
     SizeMode m_sizeMode;
     point_count_t m_size;
+    int m_threads;
 
     virtual void addArgs(ProgramArgs& args);
     virtual void initialize();
@@ -40,8 +40,13 @@
 #include "ELMFilter.hpp"
 
 #include <pdal/EigenUtils.hpp>
+#include <pdal/util/TaskScheduler.hpp>
 
-#include <map>
+#include "private/RadixSort.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <string>
 
 namespace pdal
@@ -56,6 +61,12 @@ static StaticPluginInfo const s_info
 
 CREATE_STATIC_STAGE(ELMFilter, s_info)
 
+ELMFilter::ELMFilter() : Filter(), m_count(0), m_nextTrim(0)
+{}
+
+ELMFilter::~ELMFilter()
+{}
+
 std::string ELMFilter::getName() const
 {
     return s_info.name;
@@ -66,6 +77,16 @@ void ELMFilter::addArgs(ProgramArgs& args)
     args.add("cell", "Cell size", m_cell, 10.0);
     args.add("class", "Class to use for noise points", m_class, ClassLabel::LowPoint);
     args.add("threshold", "Threshold value", m_threshold, 1.0);
+    args.add("threads", "Number of threads used to evaluate cells",
+        m_threads, 1);
+    args.add("halo", "Number of preceding points whose cells are kept "
+        "in stream mode", m_halo, point_count_t(100000));
+}
+
+void ELMFilter::initialize()
+{
+    if (m_threads < 1)
+        throwError("Option 'threads' must be at least 1.");
 }
 
 void ELMFilter::addDimensions(PointLayoutPtr layout)
@@ -73,63 +94,112 @@ void ELMFilter::addDimensions(PointLayoutPtr layout)
     layout->registerDim(Dimension::Id::Classification);
 }
 
+void ELMFilter::ready(PointTableRef)
+{
+    m_window.clear();
+    m_count = 0;
+    m_nextTrim = m_halo;
+}
+
+void ELMFilter::done(PointTableRef)
+{
+    m_window.clear();
+}
+
+// Find the elevation below which the points of a cell are noise.  Starting
+// from the lowest point, a point is noise when the next lowest is at least
+// the threshold above it.  The first pair closer than the threshold ends
+// the search, so points that share an elevation are never noise.
+double ELMFilter::cutoff(std::vector<double>& z) const
+{
+    std::sort(z.begin(), z.end());
+    size_t i = 0;
+    while (i + 1 < z.size() && std::fabs(z[i] - z[i + 1]) >= m_threshold)
+        ++i;
+    return i ? z[i] : (std::numeric_limits<double>::lowest)();
+}
+
 void ELMFilter::filter(PointView& view)
 {
+    using namespace Dimension;
+
     if (!view.size())
         return;
 
     BOX2D bounds;
     calculateBounds(view, bounds);
 
-    size_t cols =
-        static_cast<size_t>(((bounds.maxx - bounds.minx) / m_cell) + 1);
     size_t rows =
         static_cast<size_t>(((bounds.maxy - bounds.miny) / m_cell) + 1);
 
-    // Make an initial pass through the input PointView to index elevation
-    // values and PointIds by row and column.
-    std::map<uint32_t, std::multimap<double, PointId>> hash;
-    for (PointId id = 0; id < view.size(); ++id)
-    {
-        double x = view.getFieldAs<double>(Dimension::Id::X, id);
-        double y = view.getFieldAs<double>(Dimension::Id::Y, id);
-        double z = view.getFieldAs<double>(Dimension::Id::Z, id);
-
-        size_t c = static_cast<size_t>(std::floor(x - bounds.minx) / m_cell);
-        size_t r = static_cast<size_t>(std::floor(y - bounds.miny) / m_cell);
-
-        hash[c * rows + r].emplace(z, id);
-    }
+    // Make an initial pass through the input PointView to key points by
+    // row and column, and sort so that the points of each cell are
+    // adjacent.
+    std::vector<double> z(view.size());
+    radix::EntryList entries = radix::makeEntries(view.size(), m_threads,
+        [&](PointId id)
+        {
+            double x = view.getFieldAs<double>(Id::X, id);
+            double y = view.getFieldAs<double>(Id::Y, id);
+            z[id] = view.getFieldAs<double>(Id::Z, id);
 
-    // Count the number of points we classify as noise.
-    point_count_t num(0);
+            size_t c =
+                static_cast<size_t>(std::floor(x - bounds.minx) / m_cell);
+            size_t r =
+                static_cast<size_t>(std::floor(y - bounds.miny) / m_cell);
+            return (uint64_t)(c * rows + r);
+        });
+    radix::sort(entries, m_threads);
 
-    // Make a second pass through the now rasterized PointView to compute the
-    // extended local minimum.
-    for (size_t c = 0; c < cols; ++c)
+    // Find the noise points of the cells in a range of entries that starts
+    // and ends on cell boundaries.
+    auto evaluate = [&](size_t begin, size_t end, PointIdList& noise)
     {
-        for (size_t r = 0; r < rows; ++r)
+        std::vector<double> cellZ;
+        while (begin < end)
         {
-            std::multimap<double, PointId> ids(hash[c * rows + r]);
-
-            if (ids.size() <= 1)
-                continue;
-
-            for (auto it = ids.begin(); it != std::prev(ids.end()); ++it)
+            size_t next = begin + 1;
+            while (next < end && entries[next].key == entries[begin].key)
+                ++next;
+            if (next - begin > 1)
             {
-                // Where the current value is sufficiently close to the next, we
-                // consider that this is not a low outlier and break the current
-                // loop.
-                if (std::fabs(it->first - std::next(it)->first) < m_threshold)
-                    break;
-
-                // Otherwise this point is classified as noise, and we proceed
-                // to the next lowest value.
-                view.setField(Dimension::Id::Classification, it->second,
-                              m_class);
-                ++num;
+                cellZ.clear();
+                for (size_t i = begin; i < next; ++i)
+                    cellZ.push_back(z[entries[i].id]);
+                double low = cutoff(cellZ);
+                for (size_t i = begin; i < next; ++i)
+                    if (z[entries[i].id] < low)
+                        noise.push_back(entries[i].id);
             }
+            begin = next;
         }
+    };
+
+    // Cells are independent, so ranges of them are evaluated in parallel
+    // and the points found to be noise are classified afterward.
+    const size_t numChunks = m_threads;
+    std::vector<size_t> splits { 0 };
+    for (size_t t = 1; t < numChunks; ++t)
+    {
+        size_t pos = (std::max)(splits.back(), entries.size() * t / numChunks);
+        while (pos > 0 && pos < entries.size() &&
+                entries[pos].key == entries[pos - 1].key)
+            ++pos;
+        splits.push_back(pos);
+    }
+    splits.push_back(entries.size());
+
+    std::vector<PointIdList> noise(numChunks);
+    parallelFor(numChunks, numChunks, [&](std::size_t t)
+        { evaluate(splits[t], splits[t + 1], noise[t]); });
+
+    // Count the number of points we classify as noise.
+    point_count_t num(0);
+    for (const PointIdList& ids : noise)
+    {
+        for (PointId id : ids)
+            view.setField(Id::Classification, id, m_class);
+        num += ids.size();
     }
 
     log()->get(LogLevel::Info)
@@ -137,4 +207,89 @@ void ELMFilter::filter(PointView& view)
         << " points as noise by Extended Local Minimum (ELM).\n";
 }
 
+// In stream mode, cells are aligned with the origin rather than with the
+// bounds of the points, and the points of a cell are judged against the
+// points of the cell that have been streamed so far.  Cells are kept until
+// no point has fallen in them for the halo number of points.  When the
+// points of each cell arrive in the same batch, as they do for small or
+// spatially ordered input, a point is judged as in standard mode apart from
+// the alignment of the cells.
+ELMFilter::CellPoints& ELMFilter::addToWindow(PointRef& point)
+{
+    using namespace Dimension;
+
+    Cell c { (int64_t)std::floor(point.getFieldAs<double>(Id::X) / m_cell),
+        (int64_t)std::floor(point.getFieldAs<double>(Id::Y) / m_cell) };
+    CellPoints& cell = m_window[c];
+    cell.z.push_back(point.getFieldAs<double>(Id::Z));
+    cell.last = m_count++;
+    return cell;
+}
+
+// Drop the cells that no point has fallen in for the halo number of points.
+// This is done once per halo's worth of points, so a cell is kept for
+// between one and two halos.
+void ELMFilter::trimWindow()
+{
+    if (m_count < m_nextTrim)
+        return;
+    m_nextTrim = m_count + (std::max)(m_halo, point_count_t(1));
+    for (auto it = m_window.begin(); it != m_window.end();)
+    {
+        if (it->second.last + m_halo < m_count)
+            it = m_window.erase(it);
+        else
+            ++it;
+    }
+}
+
+bool ELMFilter::processOne(PointRef& point)
+{
+    CellPoints& cell = addToWindow(point);
+    if (cell.z.size() > 1)
+    {
+        std::vector<double> z(cell.z);
+        if (point.getFieldAs<double>(Dimension::Id::Z) < cutoff(z))
+            point.setField(Dimension::Id::Classification, m_class);
+    }
+    trimWindow();
+    return true;
+}
+
+// All the points of a batch are added to their cells before any are
+// judged.
+point_count_t ELMFilter::processBatch(StreamPointTable& table,
+    PointId begin, point_count_t count)
+{
+    using namespace Dimension;
+
+    PointRef point(table, begin);
+    std::vector<CellPoints *> cells;
+    for (PointId idx : table.activeIds(begin, count))
+    {
+        point.setPointId(idx);
+        cells.push_back(&addToWindow(point));
+    }
+
+    std::unordered_map<CellPoints *, double> cutoffs;
+    size_t i = 0;
+    for (PointId idx : table.activeIds(begin, count))
+    {
+        CellPoints *cell = cells[i++];
+        if (cell->z.size() < 2)
+            continue;
+        auto it = cutoffs.find(cell);
+        if (it == cutoffs.end())
+        {
+            std::vector<double> z(cell->z);
+            it = cutoffs.emplace(cell, cutoff(z)).first;
+        }
+        point.setPointId(idx);
+        if (point.getFieldAs<double>(Id::Z) < it->second)
+            point.setField(Id::Classification, m_class);
+    }
+    trimWindow();
+    return count;
+}
+
 } // namespace pdal
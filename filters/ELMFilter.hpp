@@ -35,9 +35,12 @@
 #pragma once
 
 #include <pdal/Filter.hpp>
+#include <pdal/Streamable.hpp>
 
 #include <cstdint>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace pdal
 {
@@ -45,23 +48,63 @@ namespace pdal
 class PointLayout;
 class PointView;
 
-class PDAL_DLL ELMFilter : public Filter
+class PDAL_DLL ELMFilter : public Filter, public Streamable
 {
 public:
-    ELMFilter() : Filter()
-    {
-    }
+    ELMFilter();
+    ~ELMFilter();
 
     std::string getName() const;
 
 private:
+    struct Cell
+    {
+        int64_t i;
+        int64_t j;
+
+        bool operator==(const Cell& other) const
+            { return i == other.i && j == other.j; }
+    };
+
+    struct CellHash
+    {
+        size_t operator()(const Cell& c) const
+        {
+            uint64_t h = ((uint64_t)c.i * 73856093) ^
+                ((uint64_t)c.j * 19349663);
+            return (size_t)(h * 0x9E3779B97F4A7C15ULL);
+        }
+    };
+
+    // Elevations of the streamed points in a cell and the sequence number
+    // of the last of them.
+    struct CellPoints
+    {
+        std::vector<double> z;
+        uint64_t last;
+    };
+
     double m_cell;
     double m_threshold;
     uint8_t m_class;
+    int m_threads;
+    point_count_t m_halo;
+    std::unordered_map<Cell, CellPoints, CellHash> m_window;
+    uint64_t m_count;
+    uint64_t m_nextTrim;
 
     virtual void addArgs(ProgramArgs& args);
+    virtual void initialize();
     virtual void addDimensions(PointLayoutPtr layout);
+    virtual void ready(PointTableRef table);
     virtual void filter(PointView& view);
+    virtual bool processOne(PointRef& point);
+    virtual point_count_t processBatch(StreamPointTable& table, PointId begin,
+        point_count_t count);
+    virtual void done(PointTableRef table);
+    double cutoff(std::vector<double>& z) const;
+    CellPoints& addToWindow(PointRef& point);
+    void trimWindow();
 
     ELMFilter& operator=(const ELMFilter&); // not implemented
     ELMFilter(const ELMFilter&);            // not implemented
@@ -40,6 +40,7 @@
 
 #include <Eigen/Dense>
 
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -65,6 +66,17 @@ void EigenvaluesFilter::addArgs(ProgramArgs& args)
 {
     args.add("knn", "k-Nearest neighbors", m_knn, 8);
     args.add("normalize", "Normalize eigenvalues?", m_normalize, false);
+    args.add("knn_eps", "Approximation factor of the k-nearest neighbor "
+        "search.  0 finds the exact neighbors", m_eps, 0.0);
+}
+
+
+void EigenvaluesFilter::initialize()
+{
+    if (m_eps < 0)
+        throwError("Option 'knn_eps' can't be negative.");
+    m_metadata.add("knn_eps", m_eps, "Approximation factor of the k-nearest "
+        "neighbor search");
 }
 
 
@@ -77,33 +89,36 @@ void EigenvaluesFilter::addDimensions(PointLayoutPtr layout)
 
 void EigenvaluesFilter::filter(PointView& view)
 {
-    using namespace Eigen;
-
     KD3Index& kdi = view.build3dIndex();
+    const double *coords = kdi.coords().data();
 
-    for (PointId i = 0; i < view.size(); ++i)
+    // Find the k-nearest neighbors and decompose the covariance of their
+    // neighborhoods a block of points at a time.
+    const point_count_t blockSize = 4096;
+    std::vector<CovarianceEigen> eigens;
+    for (PointId begin = 0; begin < view.size(); begin += blockSize)
     {
-        // find the k-nearest neighbors
-        auto ids = kdi.neighbors(i, m_knn);
-
-        // compute covariance of the neighborhood
-        auto B = computeCovariance(view, ids);
+        PointId end = (std::min)(begin + blockSize, (PointId)view.size());
+        KDNeighbors nbrs = kdi.knnRange(begin, end, m_knn, 1, m_eps);
+        computeCovarianceEigen(coords, nbrs, eigens);
 
-        // perform the eigen decomposition
-        SelfAdjointEigenSolver<Matrix3d> solver(B);
-        if (solver.info() != Success)
-            throwError("Cannot perform eigen decomposition.");
-        auto ev = solver.eigenvalues();
-
-        if (m_normalize)
+        for (PointId i = begin; i < end; ++i)
         {
-            double sum = ev[0] + ev[1] + ev[2];
-            ev /= sum;
+            const CovarianceEigen& e = eigens[i - begin];
+            if (!e.valid)
+                throwError("Cannot perform eigen decomposition.");
+            Eigen::Vector3d ev = e.values;
+
+            if (m_normalize)
+            {
+                double sum = ev[0] + ev[1] + ev[2];
+                ev /= sum;
+            }
+
+            view.setField(m_e0, i, ev[0]);
+            view.setField(m_e1, i, ev[1]);
+            view.setField(m_e2, i, ev[2]);
         }
-
-        view.setField(m_e0, i, ev[0]);
-        view.setField(m_e1, i, ev[1]);
-        view.setField(m_e2, i, ev[2]);
     }
 }
 
@@ -61,9 +61,11 @@ private:
     int m_knn;
     Dimension::Id m_e0, m_e1, m_e2;
     bool m_normalize;
+    double m_eps;
 
     virtual void addDimensions(PointLayoutPtr layout);
     virtual void addArgs(ProgramArgs& args);
+    virtual void initialize();
     virtual void filter(PointView& view);
 };
 
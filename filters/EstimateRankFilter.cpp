@@ -38,6 +38,7 @@
 #include <pdal/KDIndex.hpp>
 #include <pdal/util/ProgramArgs.hpp>
 
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -74,13 +75,17 @@ void EstimateRankFilter::addDimensions(PointLayoutPtr layout)
 void EstimateRankFilter::filter(PointView& view)
 {
     KD3Index& kdi = view.build3dIndex();
+    const double *coords = kdi.coords().data();
 
-    for (PointId i = 0; i < view.size(); ++i)
+    // Find the k-nearest neighbors a block of points at a time.
+    const point_count_t blockSize = 4096;
+    for (PointId begin = 0; begin < view.size(); begin += blockSize)
     {
-        // find the k-nearest neighbors
-        auto ids = kdi.neighbors(i, m_knn);
-
-        view.setField(m_rank, i, computeRank(view, ids, m_thresh));
+        PointId end = (std::min)(begin + blockSize, (PointId)view.size());
+        KDNeighbors nbrs = kdi.knnRange(begin, end, m_knn, 1);
+        for (PointId i = begin; i < end; ++i)
+            view.setField(m_rank, i, computeRank(coords,
+                nbrs.neighbors(i - begin), nbrs.count(i - begin), m_thresh));
     }
 }
 
@@ -34,11 +34,14 @@
 
 #include "FarthestPointSamplingFilter.hpp"
 
-#include <pdal/KDIndex.hpp>
 #include <pdal/util/ProgramArgs.hpp>
+#include <pdal/util/TaskScheduler.hpp>
 
 #include <algorithm>
+#include <cmath>
+#include <functional>
 #include <limits>
+#include <memory>
 #include <numeric>
 #include <string>
 #include <vector>
@@ -51,6 +54,329 @@ static PluginInfo const s_info{"filters.fps", "Farthest point sampling filter",
 
 CREATE_STATIC_STAGE(FarthestPointSamplingFilter, s_info)
 
+namespace
+{
+
+// Below this many points a single thread is faster than several.
+const point_count_t MinThreadedPoints = 65536;
+
+// Maximum number of points in a leaf of the pruning tree.
+const point_count_t LeafSize = 128;
+
+// Distances are lowered a block at a time before searching the block for
+// the farthest point, so that the search reads from cache.
+const point_count_t BlockSize = 1024;
+
+struct Farthest
+{
+    double dist;
+    PointId pos;
+};
+
+// Keeps the distance from each point of a view to the nearest sample and
+// finds the point farthest from all samples.
+//
+// Coordinates are stored by dimension so that lowering the distances
+// vectorizes.  When pruning, points are ordered by a KD-tree whose nodes
+// record the farthest point below them.  A subtree is skipped when the
+// new sample is no closer to its bounds than its farthest point is to
+// the existing samples, since none of its distances can change.
+class FarthestSearch
+{
+public:
+    FarthestSearch(const PointView& view, unsigned threads, bool prune);
+
+    // Add a sample and find the point farthest from all samples.  Ties go
+    // to the point with the lowest ID.
+    Farthest add(PointId id);
+
+private:
+    struct Node
+    {
+        PointId begin;
+        PointId end;
+        double lo[3];
+        double hi[3];
+        Farthest far;
+        // Children, or 0 for a leaf.
+        size_t left;
+        size_t right;
+    };
+
+    void run(size_t count, const std::function<void(size_t)>& f);
+    void lower(PointId begin, PointId end, const double *s);
+    Farthest farthest(PointId begin, PointId end) const;
+    size_t build(PointId begin, PointId end);
+    double lowerBound(const Node& node, const double *s) const;
+    const Farthest& better(const Farthest& a, const Farthest& b) const;
+    void collect(size_t n, int depth, const double *s);
+    void update(size_t n, const double *s);
+    void refresh(size_t n, int depth);
+
+    const PointView& m_view;
+    unsigned m_threads;
+    std::vector<double> m_x;
+    std::vector<double> m_y;
+    std::vector<double> m_z;
+    std::vector<double> m_dists;
+    // Point ID at each position, when pruning.
+    std::vector<PointId> m_ids;
+    std::vector<Node> m_nodes;
+    // Depth of the subtrees that are updated by separate tasks.
+    int m_taskDepth;
+    std::vector<size_t> m_tasks;
+    std::vector<Farthest> m_results;
+};
+
+
+FarthestSearch::FarthestSearch(const PointView& view, unsigned threads,
+        bool prune) : m_view(view), m_threads(threads), m_taskDepth(0)
+{
+    using namespace Dimension;
+
+    const point_count_t np = view.size();
+    if (np < MinThreadedPoints)
+        m_threads = 1;
+
+    m_x.resize(np);
+    m_y.resize(np);
+    m_z.resize(np);
+    for (PointId i = 0; i < np; ++i)
+    {
+        m_x[i] = view.getFieldAs<double>(Id::X, i);
+        m_y[i] = view.getFieldAs<double>(Id::Y, i);
+        m_z[i] = view.getFieldAs<double>(Id::Z, i);
+    }
+    m_dists.assign(np, (std::numeric_limits<double>::infinity)());
+
+    if (prune)
+    {
+        m_ids.resize(np);
+        std::iota(m_ids.begin(), m_ids.end(), 0);
+        build(0, np);
+
+        // Put the coordinates in tree order.
+        std::vector<double> buf(np);
+        for (std::vector<double> *v : { &m_x, &m_y, &m_z })
+        {
+            for (PointId i = 0; i < np; ++i)
+                buf[i] = (*v)[m_ids[i]];
+            v->swap(buf);
+        }
+
+        // Enough subtrees to keep the threads busy.
+        while ((1u << m_taskDepth) < 4 * m_threads)
+            m_taskDepth++;
+        if (m_threads == 1)
+            m_taskDepth = 0;
+    }
+    else
+        m_results.resize(m_threads);
+}
+
+
+void FarthestSearch::run(size_t count, const std::function<void(size_t)>& f)
+{
+    parallelFor(count, m_threads, f);
+}
+
+
+void FarthestSearch::lower(PointId begin, PointId end, const double *s)
+{
+    const double *x = m_x.data();
+    const double *y = m_y.data();
+    const double *z = m_z.data();
+    double *d = m_dists.data();
+    for (PointId i = begin; i < end; ++i)
+    {
+        const double dx = x[i] - s[0];
+        const double dy = y[i] - s[1];
+        const double dz = z[i] - s[2];
+        const double dist = dx * dx + dy * dy + dz * dz;
+        d[i] = dist < d[i] ? dist : d[i];
+    }
+}
+
+
+// Find the farthest point in a range of positions.  Ties go to the lowest
+// position, which is the lowest ID when not pruning.
+Farthest FarthestSearch::farthest(PointId begin, PointId end) const
+{
+    Farthest f { -1.0, begin };
+    for (PointId i = begin; i < end; ++i)
+        if (m_dists[i] > f.dist)
+            f = Farthest { m_dists[i], i };
+    return f;
+}
+
+
+size_t FarthestSearch::build(PointId begin, PointId end)
+{
+    const size_t n = m_nodes.size();
+    m_nodes.push_back(Node());
+    Node node;
+    node.begin = begin;
+    node.end = end;
+    node.far = Farthest { (std::numeric_limits<double>::infinity)(), begin };
+    node.left = 0;
+    node.right = 0;
+
+    const std::vector<double> *coords[3] { &m_x, &m_y, &m_z };
+    for (int dim = 0; dim < 3; ++dim)
+    {
+        const std::vector<double>& c = *coords[dim];
+        node.lo[dim] = (std::numeric_limits<double>::max)();
+        node.hi[dim] = (std::numeric_limits<double>::lowest)();
+        for (PointId i = begin; i < end; ++i)
+        {
+            node.lo[dim] = (std::min)(node.lo[dim], c[m_ids[i]]);
+            node.hi[dim] = (std::max)(node.hi[dim], c[m_ids[i]]);
+        }
+    }
+
+    if (end - begin > LeafSize)
+    {
+        // Split at the median of the widest dimension.
+        int dim = 0;
+        for (int d = 1; d < 3; ++d)
+            if (node.hi[d] - node.lo[d] > node.hi[dim] - node.lo[dim])
+                dim = d;
+        const std::vector<double>& c = *coords[dim];
+        const PointId mid = begin + (end - begin) / 2;
+        std::nth_element(m_ids.begin() + begin, m_ids.begin() + mid,
+            m_ids.begin() + end, [&c](PointId a, PointId b)
+            { return c[a] < c[b]; });
+        node.left = build(begin, mid);
+        node.right = build(mid, end);
+    }
+    m_nodes[n] = node;
+    return n;
+}
+
+
+// Squared distance from a point to the bounds of a node.
+double FarthestSearch::lowerBound(const Node& node, const double *s) const
+{
+    double dist = 0;
+    for (int dim = 0; dim < 3; ++dim)
+    {
+        double gap = 0;
+        if (s[dim] < node.lo[dim])
+            gap = node.lo[dim] - s[dim];
+        else if (s[dim] > node.hi[dim])
+            gap = s[dim] - node.hi[dim];
+        dist += gap * gap;
+    }
+    return dist;
+}
+
+
+const Farthest& FarthestSearch::better(const Farthest& a,
+    const Farthest& b) const
+{
+    if (a.dist != b.dist)
+        return a.dist > b.dist ? a : b;
+    return m_ids[a.pos] < m_ids[b.pos] ? a : b;
+}
+
+
+// Find the subtrees, at the task depth or above, that may need updating.
+void FarthestSearch::collect(size_t n, int depth, const double *s)
+{
+    const Node& node = m_nodes[n];
+    if (lowerBound(node, s) >= node.far.dist)
+        return;
+    if (depth == m_taskDepth || !node.left)
+        m_tasks.push_back(n);
+    else
+    {
+        collect(node.left, depth + 1, s);
+        collect(node.right, depth + 1, s);
+    }
+}
+
+
+void FarthestSearch::update(size_t n, const double *s)
+{
+    Node& node = m_nodes[n];
+    if (lowerBound(node, s) >= node.far.dist)
+        return;
+    if (node.left)
+    {
+        update(node.left, s);
+        update(node.right, s);
+        node.far = better(m_nodes[node.left].far, m_nodes[node.right].far);
+        return;
+    }
+
+    lower(node.begin, node.end, s);
+    Farthest f = farthest(node.begin, node.end);
+    for (PointId i = f.pos + 1; i < node.end; ++i)
+        if (m_dists[i] == f.dist && m_ids[i] < m_ids[f.pos])
+            f.pos = i;
+    node.far = f;
+}
+
+
+// Recompute the farthest points of the nodes above the task depth.
+void FarthestSearch::refresh(size_t n, int depth)
+{
+    Node& node = m_nodes[n];
+    if (depth == m_taskDepth || !node.left)
+        return;
+    refresh(node.left, depth + 1);
+    refresh(node.right, depth + 1);
+    node.far = better(m_nodes[node.left].far, m_nodes[node.right].far);
+}
+
+
+Farthest FarthestSearch::add(PointId id)
+{
+    using namespace Dimension;
+
+    const double s[3] { m_view.getFieldAs<double>(Id::X, id),
+        m_view.getFieldAs<double>(Id::Y, id),
+        m_view.getFieldAs<double>(Id::Z, id) };
+
+    if (m_nodes.size())
+    {
+        m_tasks.clear();
+        collect(0, 0, s);
+        run(m_tasks.size(), [this, &s](size_t t){ update(m_tasks[t], s); });
+        refresh(0, 0);
+        Farthest f = m_nodes[0].far;
+        f.pos = m_ids[f.pos];
+        return f;
+    }
+
+    const point_count_t np = m_dists.size();
+    run(m_threads, [this, &s, np](size_t chunk)
+    {
+        const PointId begin = np * chunk / m_threads;
+        const PointId end = np * (chunk + 1) / m_threads;
+        Farthest f { -1.0, begin };
+        for (PointId b = begin; b < end; b += BlockSize)
+        {
+            const PointId e = (std::min)(b + BlockSize, end);
+            lower(b, e, s);
+            Farthest bf = farthest(b, e);
+            if (bf.dist > f.dist)
+                f = bf;
+        }
+        m_results[chunk] = f;
+    });
+
+    // Chunks are in order, so the first of equally distant points wins.
+    Farthest f = m_results[0];
+    for (const Farthest& r : m_results)
+        if (r.dist > f.dist)
+            f = r;
+    return f;
+}
+
+} // unnamed namespace
+
+
 std::string FarthestPointSamplingFilter::getName() const
 {
     return s_info.name;
@@ -64,6 +390,16 @@ void FarthestPointSamplingFilter::addArgs(ProgramArgs& args)
 {
     args.add("count", "Target number of points after sampling", m_count,
              point_count_t(1000));
+    args.add("threads", "Number of threads used to update distances",
+             m_threads, 1);
+    args.add("prune", "Only update distances in regions where they may "
+             "change", m_prune, false);
+}
+
+void FarthestPointSamplingFilter::initialize()
+{
+    if (m_threads < 1)
+        throwError("Option 'threads' must be at least 1.");
 }
 
 PointViewSet FarthestPointSamplingFilter::run(PointViewPtr inView)
@@ -76,48 +412,27 @@ PointViewSet FarthestPointSamplingFilter::run(PointViewPtr inView)
     // Otherwise, make a new output PointView.
     PointViewPtr outView = inView->makeNew();
 
-    // Construct a KD-tree of the input view.
-    KD3Index& kdi = inView->build3dIndex();
+    FarthestSearch search(*inView, (unsigned)m_threads, m_prune);
 
     // Seed the output view with the first point in the current sorting.
-    PointId seedId(0);
-    outView->appendPoint(*inView, seedId);
-
-    // Compute distances from seedId to all other points.
-    PointIdList indices(inView->size());
-    std::vector<double> sqr_dists(inView->size());
-    kdi.knnSearch(seedId, inView->size(), &indices, &sqr_dists);
-
-    // Sort distances by PointId.
-    std::vector<double> min_dists(inView->size());
-    for (PointId i = 0; i < inView->size(); ++i)
-        min_dists[indices[i]] = sqr_dists[i];
+    PointId idx(0);
+    outView->appendPoint(*inView, idx);
 
     // Proceed until we have m_count points in the output PointView.
     for (PointId i = 1; i < m_count; ++i)
     {
-        // Find the max distance in min_dists, this is the farthest point from
-        // any point currently in the output PointView.
-        auto it = std::max_element(min_dists.begin(), min_dists.end());
+        // Add the last point to the samples and find the point farthest
+        // from any point currently in the output PointView.
+        Farthest f = search.add(idx);
 
         // Record the PointId of the farthest point and add it to the output
         // PointView.
-        PointId idx(it - min_dists.begin());
+        idx = f.pos;
         outView->appendPoint(*inView, idx);
 
-        log()->get(LogLevel::Debug)
+        PDAL_LOG(log(), LogLevel::Debug)
             << "Adding PointId " << idx << " with distance "
-            << std::sqrt(min_dists[idx]) << std::endl;
-
-        // Compute distances from idx to all other points.
-        kdi.knnSearch(idx, inView->size(), &indices, &sqr_dists);
-
-        // Update distances.
-        for (PointId j = 0; j < inView->size(); ++j)
-        {
-            if (sqr_dists[j] < min_dists[indices[j]])
-                min_dists[indices[j]] = sqr_dists[j];
-        }
+            << std::sqrt(f.dist) << std::endl;
     }
 
     viewSet.insert(outView);
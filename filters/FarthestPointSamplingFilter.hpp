@@ -52,8 +52,11 @@ public:
 
 private:
     point_count_t m_count;
+    int m_threads;
+    bool m_prune;
 
     virtual void addArgs(ProgramArgs& args);
+    virtual void initialize();
     virtual PointViewSet run(PointViewPtr view);
 };
 
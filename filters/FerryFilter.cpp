@@ -127,14 +127,12 @@ bool FerryFilter::processOne(PointRef& point)
 }
 
 
+// Each dimension is copied in bulk, in the order given.
 void FerryFilter::filter(PointView& view)
 {
-    PointRef point(view, 0);
-    for (PointId id = 0; id < view.size(); ++id)
-    {
-        point.setPointId(id);
-        processOne(point);
-    }
+    for (const auto& info : m_dims)
+        if (info.m_fromId != Dimension::Id::Unknown)
+            view.copyField(info.m_toId, info.m_fromId);
 }
 
 } // namespace pdal
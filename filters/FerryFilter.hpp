@@ -71,6 +71,11 @@ private:
     virtual void prepared(PointTableRef table);
     virtual bool processOne(PointRef& point);
     virtual void filter(PointView& view);
+    virtual bool fusable() const
+        { return true; }
+    // Points are neither added, removed nor reordered.
+    virtual void inputLimit(PointLimit& /*limit*/) const
+        {}
 
     FerryFilter& operator=(const FerryFilter&) = delete;
     FerryFilter(const FerryFilter&) = delete;
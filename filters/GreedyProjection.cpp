@@ -35,9 +35,13 @@
  *
  */
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <memory>
 
 #include <pdal/KDIndex.hpp>
+#include <pdal/util/TaskScheduler.hpp>
 #include <filters/NormalFilter.hpp>
 
 #include "GreedyProjection.hpp"
@@ -74,6 +78,8 @@ void GreedyProjection::addArgs(ProgramArgs& args)
         maximum_angle_, 2 * M_PI / 3);  // 120 degrees default
     args.add("eps_angle", "Max normal difference angle for triangulation "
         "consideration", eps_angle_, M_PI / 4);
+    args.add("threads", "Number of threads used to triangulate partitions "
+        "of the points", threads_, 1);
 }
 
 
@@ -92,6 +98,8 @@ void GreedyProjection::initialize()
     if (mu_ <= 0)
         throwError("Invalid distance multiplier of '" +
             std::to_string(mu_) + "'.  Must be greater than 0.");
+    if (threads_ < 1)
+        throwError("Option 'threads' must be at least 1.");
 }
 
 Eigen::Vector3d GreedyProjection::getCoord(PointId id)
@@ -128,10 +136,165 @@ void GreedyProjection::filter(PointView& view)
 {
     NormalFilter().doFilter(view);
 
-    KD3Index& tree = view.build3dIndex();
+    mesh_ = view.createMesh(getName());
+    if (threads_ > 1)
+        triangulatePartitions(view);
+    else
+        triangulate(view, view.build3dIndex(), false);
+}
+
+
+// The points are split into a grid of partitions, slabs in X each divided
+// in Y, holding roughly equal numbers of points.  Each partition is
+// triangulated along with the points within the search radius around it,
+// and keeps the triangles whose centroids lie within it.  Since no edge is
+// longer than the search radius, the points of those triangles are all
+// available to the partition.  Triangles near the borders of partitions
+// can differ from those found by triangulating all the points at once.
+void GreedyProjection::triangulatePartitions(PointView& view)
+{
+    using namespace Dimension;
+
+    // Partitions small enough that their neighborhoods can be found up
+    // front, and large enough to be worth triangulating separately.
+    const point_count_t MaxPartitionSize = 65536;
+    const point_count_t MinPartitionSize = 4096;
+
+    const point_count_t n = view.size();
+    point_count_t numParts = (std::max)(point_count_t(threads_ * 4),
+        n / MaxPartitionSize + 1);
+    numParts = (std::min)(numParts, n / MinPartitionSize);
+    if (numParts < 2)
+    {
+        triangulate(view, view.build3dIndex(), false);
+        return;
+    }
+    const size_t slabs = (size_t)std::ceil(std::sqrt((double)numParts));
+
+    // Values that split a list into 'slabs' groups of nearly equal size.
+    auto splitValues = [slabs](std::vector<double> vals)
+    {
+        std::sort(vals.begin(), vals.end());
+        std::vector<double> splits;
+        for (size_t i = 1; i < slabs; ++i)
+            splits.push_back(vals[vals.size() * i / slabs]);
+        return splits;
+    };
+    // Position of the group holding a value.
+    auto group = [](const std::vector<double>& splits, double v)
+    {
+        return (size_t)(std::upper_bound(splits.begin(), splits.end(), v) -
+            splits.begin());
+    };
+
+    std::vector<double> x(n);
+    std::vector<double> y(n);
+    for (PointId id = 0; id < n; ++id)
+    {
+        x[id] = view.getFieldAs<double>(Id::X, id);
+        y[id] = view.getFieldAs<double>(Id::Y, id);
+    }
+
+    const std::vector<double> xSplits = splitValues(x);
+    std::vector<std::vector<double>> slabY(slabs);
+    for (PointId id = 0; id < n; ++id)
+        slabY[group(xSplits, x[id])].push_back(y[id]);
+    std::vector<std::vector<double>> ySplits(slabs);
+    for (size_t s = 0; s < slabs; ++s)
+        if (slabY[s].size())
+            ySplits[s] = splitValues(std::move(slabY[s]));
+
+    // Add each point to the partitions within the search radius of it.
+    const double r = search_radius_;
+    std::vector<PointIdList> partIds(slabs * slabs);
+    for (PointId id = 0; id < n; ++id)
+        for (size_t s = group(xSplits, x[id] - r);
+                s <= group(xSplits, x[id] + r); ++s)
+        {
+            if (ySplits[s].empty())
+                continue;
+            for (size_t t = group(ySplits[s], y[id] - r);
+                    t <= group(ySplits[s], y[id] + r); ++t)
+                partIds[s * slabs + t].push_back(id);
+        }
+
+    struct Partition
+    {
+        PointViewPtr view;
+        std::unique_ptr<GreedyProjection> worker;
+        TriangularMesh mesh;
+    };
+    std::vector<Partition> parts(partIds.size());
+    LogPtr quiet = Log::makeLog(getName(), "devnull");
+    for (size_t p = 0; p < parts.size(); ++p)
+    {
+        Partition& part = parts[p];
+        if (partIds[p].size() < 3)
+            continue;
+        part.view = view.makeNew();
+        for (PointId id : partIds[p])
+            part.view->appendPoint(view, id);
+
+        part.worker.reset(new GreedyProjection);
+        GreedyProjection& w = *part.worker;
+        w.mu_ = mu_;
+        w.search_radius_ = search_radius_;
+        w.nnn_ = nnn_;
+        w.minimum_angle_ = minimum_angle_;
+        w.maximum_angle_ = maximum_angle_;
+        w.eps_angle_ = eps_angle_;
+        w.consistent_ = consistent_;
+        w.consistent_ordering_ = consistent_ordering_;
+        w.setLog(quiet);
+        w.mesh_ = &part.mesh;
+    }
+
+    parallelFor(parts.size(), threads_, [&parts](std::size_t p)
+    {
+        Partition& part = parts[p];
+        if (!part.worker)
+            return;
+        KD3Index tree(*part.view);
+        tree.build(1);
+        part.worker->triangulate(*part.view, tree, true);
+    });
+
+    // Stitch the partitions together, in order, from the triangles whose
+    // centroids are in each.
+    point_count_t numTriangles = 0;
+    for (size_t p = 0; p < parts.size(); ++p)
+    {
+        if (!parts[p].worker)
+            continue;
+        const size_t s = p / slabs;
+        const size_t t = p % slabs;
+        const PointIdList& ids = partIds[p];
+        for (const Triangle& tri : parts[p].mesh)
+        {
+            PointId a = ids[tri.m_a];
+            PointId b = ids[tri.m_b];
+            PointId c = ids[tri.m_c];
+            double cx = (x[a] + x[b] + x[c]) / 3;
+            double cy = (y[a] + y[b] + y[c]) / 3;
+            if (group(xSplits, cx) == s && group(ySplits[s], cy) == t)
+            {
+                mesh_->add(a, b, c);
+                numTriangles++;
+            }
+        }
+    }
+    log()->get(LogLevel::Debug) << "Triangulated " << parts.size() <<
+        " partitions into " << numTriangles << " triangles.\n";
+}
+
 
+// Triangulate the points of a view.  When 'precompute' is set, the
+// neighbors of all the points are found before triangulating rather than
+// as each point is reached.
+void GreedyProjection::triangulate(PointView& view, const KD3Index& tree,
+    bool precompute)
+{
     view_ = &view;
-    mesh_ = view_->createMesh(getName());
     const double sqr_mu = mu_ * mu_;
     const double sqr_max_edge = search_radius_*search_radius_;
 
@@ -141,6 +304,22 @@ void GreedyProjection::filter(PointView& view)
     PointIdList nnIdx(nnn_);
     std::vector<double> sqrDists(nnn_);
 
+    KDNeighbors neighbors;
+    if (precompute)
+        neighbors = tree.knnAll(nnn_, 1);
+    auto knnSearch = [&](PointId idx)
+    {
+        if (precompute)
+        {
+            const PointId *ids = neighbors.neighbors(idx);
+            const double *dists = neighbors.distances(idx);
+            std::copy(ids, ids + nnn_, nnIdx.begin());
+            std::copy(dists, dists + nnn_, sqrDists.begin());
+        }
+        else
+            tree.knnSearch(idx, nnn_, &nnIdx, &sqrDists);
+    };
+
     // current number of connected components
     int part_index = 0;
 
@@ -213,7 +392,7 @@ void GreedyProjection::filter(PointView& view)
       part_[R_] = part_index++;
 
       // creating starting triangle
-      tree.knnSearch(R_, nnn_, &nnIdx, &sqrDists);
+      knnSearch(R_);
 
       double sqr_dist_threshold =
           (std::min)(sqr_max_edge, sqr_mu * sqrDists[1]);
@@ -387,7 +566,7 @@ void GreedyProjection::filter(PointView& view)
         state_[R_] = GP3Type::COMPLETED;
         continue;
       }
-      tree.knnSearch(R_, nnn_, &nnIdx, &sqrDists);
+      knnSearch(R_);
 
 /**
       // Search tree returns indices into the original cloud, but we are working with indices TODO: make that optional!
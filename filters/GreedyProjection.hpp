@@ -47,6 +47,7 @@
 #include <iostream>
 
 #include <pdal/Filter.hpp>
+#include <pdal/KDIndex.hpp>
 #include <Eigen/Dense>
 
 namespace pdal
@@ -155,6 +156,7 @@ namespace pdal
         eps_angle_(M_PI/4), //45 degrees,
         consistent_(false),
         consistent_ordering_ (false),
+        threads_(1),
         angles_ (),
         R_ (),
         state_ (),
@@ -261,6 +263,11 @@ namespace pdal
       */
       bool consistent_ordering_;
 
+      /** \brief Number of threads.  With more than one, partitions of the
+          points are triangulated concurrently.
+      */
+      int threads_;
+
      private:
       /** \brief Struct for storing the angles to nearest neighbors **/
       struct nnAngle
@@ -435,6 +442,9 @@ namespace pdal
       void addDimensions(PointLayoutPtr layout);
       void initialize();
       void filter(PointView& view);
+      void triangulate(PointView& view, const KD3Index& tree,
+          bool precompute);
+      void triangulatePartitions(PointView& view);
       void addTriangle(PointId a, PointId b, PointId c);
       Eigen::Vector3d getCoord(PointId id);
       Eigen::Vector3d getNormalCoord(PointId id);
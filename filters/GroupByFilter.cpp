@@ -36,6 +36,8 @@
 
 #include <pdal/util/ProgramArgs.hpp>
 
+#include "private/Partition.hpp"
+
 namespace pdal
 {
 
@@ -58,6 +60,14 @@ std::string GroupByFilter::getName() const
 void GroupByFilter::addArgs(ProgramArgs& args)
 {
     args.add("dimension", "Dimension containing data to be grouped", m_dimName);
+    args.add("threads", "Number of threads used to group points", m_threads,
+        1);
+}
+
+void GroupByFilter::initialize()
+{
+    if (m_threads < 1)
+        throwError("Option 'threads' must be at least 1.");
 }
 
 void GroupByFilter::prepared(PointTableRef table)
@@ -75,13 +85,17 @@ PointViewSet GroupByFilter::run(PointViewPtr inView)
     if (!inView->size())
         return viewSet;
 
-    for (PointId idx = 0; idx < inView->size(); idx++)
+    PointView& view = *inView;
+    partition::GroupList groups = partition::byKey(view, m_threads,
+        [this, &view](PointId idx)
+        { return view.getFieldAs<uint64_t>(m_dimId, idx); });
+    for (partition::Group& g : groups)
     {
-        uint64_t val = inView->getFieldAs<uint64_t>(m_dimId, idx);
-        PointViewPtr& outView = m_viewMap[val];
-        if (!outView)
-            outView = inView->makeNew();
-        outView->appendPoint(*inView.get(), idx);
+        PointViewPtr& outView = m_viewMap[g.key];
+        if (outView)
+            outView->append(*g.view);
+        else
+            outView = g.view;
     }
 
     // Pull the buffers out of the map and stick them in the standard
@@ -56,8 +56,10 @@ private:
     std::map<uint64_t, PointViewPtr> m_viewMap;
     std::string m_dimName;
     Dimension::Id m_dimId;
+    int m_threads;
 
     virtual void addArgs(ProgramArgs& args);
+    virtual void initialize();
     virtual void prepared(PointTableRef table);
     virtual PointViewSet run(PointViewPtr view);
 
@@ -32,12 +32,14 @@
 #include "HagDelaunayFilter.hpp"
 
 #include <pdal/KDIndex.hpp>
+#include <pdal/util/TaskScheduler.hpp>
 
 #include "private/delaunator.hpp"
 
 #include <string>
 #include <vector>
 #include <cmath>
+#include <algorithm>
 
 namespace pdal
 {
@@ -172,6 +174,8 @@ void HagDelaunayFilter::addArgs(ProgramArgs& args)
     args.add("allow_extrapolation", "Allow extrapolation for points "
         "outside of the local triangulations. [Default: true].",
         m_allowExtrapolation, true);
+    args.add("threads", "Number of threads used to run this filter",
+        m_threads, 1);
 }
 
 
@@ -225,45 +229,55 @@ void HagDelaunayFilter::filter(PointView& view)
     // Find Z difference between non-ground points and the nearest
     // neighbor (2D) in the ground view or between non-ground points and the
     // locally-computed surface (Delaunay triangultion of the neighborhood).
-    for (PointId i = 0; i < ngView->size(); ++i)
+    // Each point is independent of the others, so the points are split
+    // among the threads.
+    auto run = [&](PointId begin, PointId end)
     {
-        PointRef point = ngView->point(i);
-
-        // Non-ground view point for which we're trying to calc HAG
-        double x0 = point.getFieldAs<double>(Id::X);
-        double y0 = point.getFieldAs<double>(Id::Y);
-        double z0 = point.getFieldAs<double>(Id::Z);
-
         PointIdList ids(m_count);
         std::vector<double> sqr_dists(m_count);
-        kdi.knnSearch(x0, y0, m_count, &ids, &sqr_dists);
-
-        // Closest ground point.
-        double x = gView->getFieldAs<double>(Id::X, ids[0]);
-        double y = gView->getFieldAs<double>(Id::Y, ids[0]);
-        double z = gView->getFieldAs<double>(Id::Z, ids[0]);
-
-        double z1;
-        // If the close ground point is at the same X/Y as the non-ground
-        // point, we're done.  Also, if there's only one ground point, we
-        // just use that.
-        if ((x0 == x && y0 == y) || ids.size() == 1)
-        {
-            z1 = z;
-        }
-        // If the non-ground point is outside the bounds of all the
-        // ground points and we're not doing extrapolation, just return
-        // its current Z, which will give a HAG of 0.
-        else if (!gBounds.contains(x0, y0) && !m_allowExtrapolation)
-        {
-            z1 = z0;
-        }
-        else
+        for (PointId i = begin; i < end; ++i)
         {
-            z1 = delaunay_interp_ground(x0, y0, gView, ids);
+            PointRef point = ngView->point(i);
+
+            // Non-ground view point for which we're trying to calc HAG
+            double x0 = point.getFieldAs<double>(Id::X);
+            double y0 = point.getFieldAs<double>(Id::Y);
+            double z0 = point.getFieldAs<double>(Id::Z);
+
+            kdi.knnSearch(x0, y0, m_count, &ids, &sqr_dists);
+
+            // Closest ground point.
+            double x = gView->getFieldAs<double>(Id::X, ids[0]);
+            double y = gView->getFieldAs<double>(Id::Y, ids[0]);
+            double z = gView->getFieldAs<double>(Id::Z, ids[0]);
+
+            double z1;
+            // If the close ground point is at the same X/Y as the non-ground
+            // point, we're done.  Also, if there's only one ground point, we
+            // just use that.
+            if ((x0 == x && y0 == y) || ids.size() == 1)
+            {
+                z1 = z;
+            }
+            // If the non-ground point is outside the bounds of all the
+            // ground points and we're not doing extrapolation, just return
+            // its current Z, which will give a HAG of 0.
+            else if (!gBounds.contains(x0, y0) && !m_allowExtrapolation)
+            {
+                z1 = z0;
+            }
+            else
+            {
+                z1 = delaunay_interp_ground(x0, y0, gView, ids);
+            }
+            ngView->setField(Dimension::Id::HeightAboveGround, i, z0 - z1);
         }
-        ngView->setField(Dimension::Id::HeightAboveGround, i, z0 - z1);
-    }
+    };
+
+    const point_count_t count = ngView->size();
+    const point_count_t threads = (std::max)(1, m_threads);
+    parallelFor(threads, threads, [&run, count, threads](std::size_t t)
+        { run(t * count / threads, (t + 1) * count / threads); });
 }
 
 } // namespace pdal
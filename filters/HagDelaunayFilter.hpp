@@ -64,6 +64,7 @@ private:
 
     bool m_allowExtrapolation;
     point_count_t m_count;
+    int m_threads;
 };
 
 } // namespace pdal
@@ -36,6 +36,9 @@
 
 #include <pdal/GDALUtils.hpp>
 
+#include <algorithm>
+#include <numeric>
+
 namespace pdal
 {
 
@@ -66,6 +69,9 @@ void HagDemFilter::addArgs(ProgramArgs& args)
     args.add("zero_ground", "If true, set HAG of ground-classified points "
         "to 0 rather than comparing Z value to raster DEM",
         m_zeroGround, true);
+    args.add("interpolate", "If true, interpolate the DEM bilinearly "
+        "rather than using the value of the cell containing a point",
+        m_interpolate, false);
 }
 
 
@@ -80,6 +86,9 @@ void HagDemFilter::ready(PointTableRef table)
     gdal::registerDrivers();
     m_raster.reset(new gdal::Raster(m_rasterName));
     m_raster->open();
+    if (m_raster->bandCount() && m_band > m_raster->bandCount())
+        throwError("Band " + std::to_string(m_band) + " is not in raster '" +
+            m_rasterName + "'.");
 }
 
 void HagDemFilter::prepared(PointTableRef table)
@@ -90,18 +99,69 @@ void HagDemFilter::prepared(PointTableRef table)
 
 void HagDemFilter::filter(PointView& view)
 {
-    PointRef point(view, 0);
-    for (PointId i = 0; i < view.size(); ++i)
+    PointIdList ids;
+    for (PointId begin = 0; begin < view.size(); begin += BatchSize)
+    {
+        const PointId end = (std::min)(begin + BatchSize, view.size());
+        ids.resize(end - begin);
+        std::iota(ids.begin(), ids.end(), begin);
+        setHag(view, ids);
+    }
+}
+
+point_count_t HagDemFilter::processBatch(StreamPointTable& table,
+    PointId begin, point_count_t count)
+{
+    PointIdList ids;
+    for (PointId idx : table.activeIds(begin, count))
+        if (!table.skip(idx))
+            ids.push_back(idx);
+    setHag(table, ids);
+    return count;
+}
+
+void HagDemFilter::setHag(PointContainer& container, const PointIdList& ids)
+{
+    using namespace pdal::Dimension;
+
+    const size_t numBands = m_raster->bandCount();
+    PointRef point(container);
+    m_ids.clear();
+    m_xs.clear();
+    m_ys.clear();
+    for (PointId id : ids)
+    {
+        point.setPointId(id);
+
+        // If "zero_ground" option is set, all ground points get HAG of 0
+        if (m_zeroGround && point.getFieldAs<uint8_t>(Id::Classification) ==
+                ClassLabel::Ground)
+        {
+            point.setField(Id::HeightAboveGround, 0);
+            continue;
+        }
+        m_ids.push_back(id);
+        m_xs.push_back(point.getFieldAs<double>(Id::X));
+        m_ys.push_back(point.getFieldAs<double>(Id::Y));
+    }
+    m_raster->read(m_xs, m_ys, m_data, m_valid, m_interpolate);
+
+    // If raster has a point at X, Y of pointcloud point, use it.
+    // Otherwise the HAG value is not set.
+    for (size_t j = 0; j < m_ids.size(); ++j)
     {
-        point.setPointId(i);
-        processOne(point);
+        if (!m_valid[j])
+            continue;
+        point.setPointId(m_ids[j]);
+        double z = point.getFieldAs<double>(Id::Z);
+        double hag = z - m_data[j * numBands + m_band - 1];
+        point.setField(Id::HeightAboveGround, hag);
     }
 }
 
 bool HagDemFilter::processOne(PointRef& point)
 {
     using namespace pdal::Dimension;
-    std::vector<double> data;
 
     // If "zero_ground" option is set, all ground points get HAG of 0
     if (m_zeroGround &&
@@ -111,15 +171,16 @@ bool HagDemFilter::processOne(PointRef& point)
     }
     else
     {
-        double x = point.getFieldAs<double>(Id::X);
-        double y = point.getFieldAs<double>(Id::Y);
+        m_xs.assign(1, point.getFieldAs<double>(Id::X));
+        m_ys.assign(1, point.getFieldAs<double>(Id::Y));
 
         // If raster has a point at X, Y of pointcloud point, use it.
         // Otherwise the HAG value is not set.
-        if (m_raster->read(x, y, data) == gdal::GDALError::None)
+        m_raster->read(m_xs, m_ys, m_data, m_valid, m_interpolate);
+        if (m_valid[0])
         {
             double z = point.getFieldAs<double>(Id::Z);
-            double hag = z - data[m_band - 1];
+            double hag = z - m_data[m_band - 1];
             point.setField(Dimension::Id::HeightAboveGround, hag);
         }
     }
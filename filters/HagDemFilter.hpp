@@ -40,6 +40,7 @@
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace pdal
 {
@@ -65,10 +66,22 @@ private:
     virtual void ready(PointTableRef table);
     virtual void filter(PointView& view);
     virtual bool processOne(PointRef& point);
+    virtual point_count_t processBatch(StreamPointTable& table,
+        PointId begin, point_count_t count);
+
+    void setHag(PointContainer& container, const PointIdList& ids);
+
+    static const point_count_t BatchSize = 100000;
 
     std::unique_ptr<gdal::Raster> m_raster;
     std::string m_rasterName;
+    std::vector<double> m_data;
+    PointIdList m_ids;
+    std::vector<double> m_xs;
+    std::vector<double> m_ys;
+    std::vector<bool> m_valid;
     bool m_zeroGround;
+    bool m_interpolate;
     int32_t m_band;
 };
 
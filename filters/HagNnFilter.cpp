@@ -35,6 +35,8 @@
 #include "HagNnFilter.hpp"
 
 #include <pdal/KDIndex.hpp>
+#include <pdal/PipelineManager.hpp>
+#include <pdal/util/TaskScheduler.hpp>
 
 #include <string>
 #include <vector>
@@ -46,7 +48,7 @@ namespace pdal
 namespace
 {
 
-double neighbor_interp_ground(PointViewPtr gView, const PointIdList& ids,
+double neighbor_interp_ground(const PointView& gView, const PointIdList& ids,
     const std::vector<double>& sqr_dists, double maxDistance2, double zDefault)
 {
     double weights = 0;
@@ -54,7 +56,7 @@ double neighbor_interp_ground(PointViewPtr gView, const PointIdList& ids,
 
     for (size_t j = 0; j < ids.size(); ++j)
     {
-        auto z = gView->getFieldAs<double>(Dimension::Id::Z, ids[j]);
+        auto z = gView.getFieldAs<double>(Dimension::Id::Z, ids[j]);
         double sqr_dist = sqr_dists[j];
         if (maxDistance2 > 0 && sqr_dist > maxDistance2)
             break;
@@ -93,6 +95,28 @@ HagNnFilter::HagNnFilter()
 {}
 
 
+HagNnFilter::~HagNnFilter()
+{}
+
+
+// Without a ground file, the ground points are those of the view, so all of
+// the points must be read before any can be processed.
+bool HagNnFilter::pipelineStreamable() const
+{
+    if (m_groundFile.empty())
+        return false;
+    return Streamable::pipelineStreamable();
+}
+
+
+const Stage *HagNnFilter::findNonstreamable() const
+{
+    if (m_groundFile.empty())
+        return this;
+    return Streamable::findNonstreamable();
+}
+
+
 void HagNnFilter::addArgs(ProgramArgs& args)
 {
     args.add("count", "The number of points to fetch to determine the "
@@ -102,6 +126,11 @@ void HagNnFilter::addArgs(ProgramArgs& args)
         "[Default: None]", m_maxDistance);
     args.add("allow_extrapolation", "If true and count > 1, allow "
         "extrapolation [Default: true].", m_allowExtrapolation, true);
+    args.add("ground", "Point cloud file whose ground-classified points "
+        "are used as the ground, rather than those of the input",
+        m_groundFile);
+    args.add("threads", "Number of threads used to run this filter",
+        m_threads, 1);
 }
 
 
@@ -122,6 +151,101 @@ void HagNnFilter::prepared(PointTableRef table)
 }
 
 
+// The ground file is read, and its ground points indexed, once for all of
+// the views or streamed points.
+void HagNnFilter::ready(PointTableRef)
+{
+    using namespace pdal::Dimension;
+
+    m_groundView.reset();
+    m_groundTable.reset();
+    if (m_groundFile.empty())
+        return;
+
+    m_groundTable.reset(new PointTable);
+    PipelineManager mgr;
+    Stage& reader = mgr.makeReader(m_groundFile, "");
+    reader.prepare(*m_groundTable);
+    if (!m_groundTable->layout()->hasDim(Id::Classification))
+        throwError("Missing Classification dimension in ground file '" +
+            m_groundFile + "'.");
+    PointViewSet viewSet = reader.execute(*m_groundTable);
+
+    m_groundView.reset(new PointView(*m_groundTable));
+    for (const PointViewPtr& v : viewSet)
+        for (PointId i = 0; i < v->size(); ++i)
+            if (v->getFieldAs<uint8_t>(Id::Classification, i) ==
+                ClassLabel::Ground)
+                m_groundView->appendPoint(*v, i);
+    if (m_groundView->size() == 0)
+        throwError("Ground file '" + m_groundFile + "' does not have any "
+            "points classified as ground");
+
+    m_groundView->calculateBounds(m_groundBounds);
+    m_groundView->build2dIndex();
+}
+
+
+// Find the ground height under a non-ground point from the nearest
+// neighbors (2D) in the ground view, or from the locally-computed surface.
+double HagNnFilter::groundZ(const PointView& gView, const KD2Index& kdi,
+    const BOX2D& gBounds, double x0, double y0, double z0) const
+{
+    using namespace pdal::Dimension;
+
+    PointIdList ids(m_count);
+    std::vector<double> sqr_dists(m_count);
+    kdi.knnSearch(x0, y0, m_count, &ids, &sqr_dists);
+
+    // Closest ground point.
+    double x = gView.getFieldAs<double>(Id::X, ids[0]);
+    double y = gView.getFieldAs<double>(Id::Y, ids[0]);
+    double z = gView.getFieldAs<double>(Id::Z, ids[0]);
+
+    // If the close ground point is at the same X/Y as the non-ground
+    // point, we're done.  Also, if there's only one ground point, we
+    // just use that.
+    if ((x0 == x && y0 == y) || ids.size() == 1)
+        return z;
+
+    // If the non-ground point is outside the bounds of all the
+    // ground points and we're not doing extrapolation, just return
+    // its current Z, which will give a HAG of 0.
+    if (!gBounds.contains(x0, y0) && !m_allowExtrapolation)
+        return z0;
+
+    return neighbor_interp_ground(gView, ids, sqr_dists,
+        std::pow(m_maxDistance, 2.0), z0);
+}
+
+
+// Set the HAG of the points of a view, which are all non-ground, on all
+// threads.  Each point only depends on the ground.
+void HagNnFilter::computeHag(PointView& view, PointView& gView,
+    const BOX2D& gBounds)
+{
+    using namespace pdal::Dimension;
+
+    const KD2Index& kdi = gView.build2dIndex();
+    auto run = [&](PointId start, PointId end)
+    {
+        for (PointId i = start; i < end; ++i)
+        {
+            double x0 = view.getFieldAs<double>(Id::X, i);
+            double y0 = view.getFieldAs<double>(Id::Y, i);
+            double z0 = view.getFieldAs<double>(Id::Z, i);
+            double z1 = groundZ(gView, kdi, gBounds, x0, y0, z0);
+            view.setField(Id::HeightAboveGround, i, z0 - z1);
+        }
+    };
+
+    const point_count_t nloops = view.size();
+    const point_count_t threads = (std::max)(1, m_threads);
+    parallelFor(threads, threads, [&run, nloops, threads](std::size_t t)
+        { run(t * nloops / threads, (t + 1) * nloops / threads); });
+}
+
+
 void HagNnFilter::filter(PointView& view)
 {
     using namespace pdal::Dimension;
@@ -141,61 +265,41 @@ void HagNnFilter::filter(PointView& view)
         else
             ngView->appendPoint(view, i);
     }
-    BOX2D gBounds;
-    gView->calculateBounds(gBounds);
+
+    if (m_groundView)
+    {
+        computeHag(*ngView, *m_groundView, m_groundBounds);
+        return;
+    }
 
     // Bail if there weren't any points classified as ground.
     if (gView->size() == 0)
         throwError("Input PointView does not have any points classified "
             "as ground");
 
-    // Build the 2D KD-tree.
-    const KD2Index& kdi = gView->build2dIndex();
+    BOX2D gBounds;
+    gView->calculateBounds(gBounds);
+    computeHag(*ngView, *gView, gBounds);
+}
+
 
-    double maxDistance2 = std::pow(m_maxDistance, 2.0);
-    // Find Z difference between non-ground points and the nearest
-    // neighbor (2D) in the ground view or between non-ground points and the
-    // locally-computed surface.
-    for (PointId i = 0; i < ngView->size(); ++i)
+bool HagNnFilter::processOne(PointRef& point)
+{
+    using namespace pdal::Dimension;
+
+    if (point.getFieldAs<uint8_t>(Id::Classification) == ClassLabel::Ground)
     {
-        PointRef point = ngView->point(i);
-
-        // Non-ground view point for which we're trying to calc HAG
-        double x0 = point.getFieldAs<double>(Id::X);
-        double y0 = point.getFieldAs<double>(Id::Y);
-        double z0 = point.getFieldAs<double>(Id::Z);
-
-        PointIdList ids(m_count);
-        std::vector<double> sqr_dists(m_count);
-        kdi.knnSearch(x0, y0, m_count, &ids, &sqr_dists);
-
-        // Closest ground point.
-        double x = gView->getFieldAs<double>(Id::X, ids[0]);
-        double y = gView->getFieldAs<double>(Id::Y, ids[0]);
-        double z = gView->getFieldAs<double>(Id::Z, ids[0]);
-
-        double z1;
-        // If the close ground point is at the same X/Y as the non-ground
-        // point, we're done.  Also, if there's only one ground point, we
-        // just use that.
-        if ((x0 == x && y0 == y) || ids.size() == 1)
-        {
-            z1 = z;
-        }
-        // If the non-ground point is outside the bounds of all the
-        // ground points and we're not doing extrapolation, just return
-        // its current Z, which will give a HAG of 0.
-        else if (!gBounds.contains(x0, y0) && !m_allowExtrapolation)
-        {
-            z1 = z0;
-        }
-        else
-        {
-            z1 = neighbor_interp_ground(gView, ids, sqr_dists,
-                maxDistance2, z0);
-        }
-        ngView->setField(Dimension::Id::HeightAboveGround, i, z0 - z1);
+        point.setField(Id::HeightAboveGround, 0);
+        return true;
     }
+
+    double x0 = point.getFieldAs<double>(Id::X);
+    double y0 = point.getFieldAs<double>(Id::Y);
+    double z0 = point.getFieldAs<double>(Id::Z);
+    double z1 = groundZ(*m_groundView, m_groundView->build2dIndex(),
+        m_groundBounds, x0, y0, z0);
+    point.setField(Id::HeightAboveGround, z0 - z1);
+    return true;
 }
 
 } // namespace pdal
@@ -35,6 +35,7 @@
 #pragma once
 
 #include <pdal/Filter.hpp>
+#include <pdal/Streamable.hpp>
 
 #include <cstdint>
 #include <memory>
@@ -43,28 +44,44 @@
 namespace pdal
 {
 
+class KD2Index;
 class Options;
 class PointLayout;
+class PointTable;
 class PointView;
 
-class PDAL_DLL HagNnFilter : public Filter
+class PDAL_DLL HagNnFilter : public Filter, public Streamable
 {
 public:
     HagNnFilter();
+    ~HagNnFilter();
     HagNnFilter& operator=(const HagNnFilter&) = delete;
     HagNnFilter(const HagNnFilter&) = delete;
 
     std::string getName() const;
+    virtual bool pipelineStreamable() const;
+    virtual const Stage *findNonstreamable() const;
 
 private:
     virtual void addArgs(ProgramArgs& args);
     virtual void addDimensions(PointLayoutPtr layout);
     virtual void prepared(PointTableRef table);
+    virtual void ready(PointTableRef table);
     virtual void filter(PointView& view);
+    virtual bool processOne(PointRef& point);
+    double groundZ(const PointView& gView, const KD2Index& kdi,
+        const BOX2D& gBounds, double x0, double y0, double z0) const;
+    void computeHag(PointView& view, PointView& gView,
+        const BOX2D& gBounds);
 
     bool m_allowExtrapolation;
     double m_maxDistance;
     point_count_t m_count;
+    std::string m_groundFile;
+    int m_threads;
+    std::unique_ptr<PointTable> m_groundTable;
+    PointViewPtr m_groundView;
+    BOX2D m_groundBounds;
 };
 
 } // namespace pdal
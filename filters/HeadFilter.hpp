@@ -35,11 +35,12 @@
 #pragma once
 
 #include <pdal/Filter.hpp>
+#include <pdal/Streamable.hpp>
 
 namespace pdal
 {
 
-class PDAL_DLL HeadFilter : public Filter
+class PDAL_DLL HeadFilter : public Filter, public Streamable
 {
 public:
     HeadFilter()
@@ -52,6 +53,7 @@ public:
 private:
     point_count_t m_count;
     bool m_invert;
+    point_count_t m_index;
 
     void addArgs(ProgramArgs& args)
     {
@@ -63,6 +65,36 @@ private:
     }
 
 
+    bool addUsedDims(PointLayoutPtr /*layout*/,
+        Dimension::IdList& /*dims*/) const
+    {
+        return true;
+    }
+
+    // Only the first 'count' points are read, so stages before this one
+    // (readers in particular) can stop once they've been produced.
+    void inputLimit(PointLimit& limit) const
+    {
+        const point_count_t all = (std::numeric_limits<point_count_t>::max)();
+        if (m_invert)
+            limit.m_first = (limit.m_first > all - m_count) ?
+                all : limit.m_first + m_count;
+        else
+            limit.m_first = (std::min)(limit.m_first, m_count);
+        limit.m_last = all;
+    }
+
+    void ready(PointTableRef /*table*/)
+    {
+        m_index = 0;
+    }
+
+    bool processOne(PointRef& /*point*/)
+    {
+        bool keep = (m_index++ < m_count);
+        return m_invert ? !keep : keep;
+    }
+
     PointViewSet run(PointViewPtr view)
     {
         if (m_count > view->size())
@@ -34,6 +34,8 @@
 
 #include "HexBinFilter.hpp"
 
+#include <thread>
+
 #include "private/hexer/HexGrid.hpp"
 #include "private/hexer/HexIter.hpp"
 #include <pdal/Polygon.hpp>
@@ -85,6 +87,15 @@ void HexBin::addArgs(ProgramArgs& args)
     args.add("smooth", "Smooth boundary output", m_doSmooth, true);
     args.add("preserve_topology", "Preserve topology when smoothing",
         m_preserve_topology, true);
+    args.add("threads", "Number of threads used to run this filter",
+        m_threads, 1);
+}
+
+
+void HexBin::initialize()
+{
+    if (m_threads < 1)
+        throwError("Option 'threads' must be at least 1.");
 }
 
 
@@ -103,12 +114,45 @@ void HexBin::ready(PointTableRef table)
 
 void HexBin::filter(PointView& view)
 {
+    // Points can only be binned independently once the hexagon size has
+    // been estimated from the sample and the origin has been set, so the
+    // points up to that point are added serially.
     PointRef p(view, 0);
-    for (PointId idx = 0; idx < view.size(); ++idx)
+    PointId idx = 0;
+    for (; idx < view.size(); ++idx)
     {
+        if (m_threads > 1 && m_grid->binnable())
+            break;
         p.setPointId(idx);
         processOne(p);
     }
+    if (idx == view.size())
+        return;
+
+    // Each thread counts the points of its range by hexagon and the
+    // partial counts are then merged into the grid.
+    const PointId begin = idx;
+    const point_count_t count = view.size() - begin;
+    const point_count_t threads = (std::min)((point_count_t)m_threads, count);
+    std::vector<HexGrid::HexCounts> counts(threads);
+    auto run = [this, &view, &counts](point_count_t t, PointId b, PointId e)
+    {
+        HexGrid::HexCounts& c = counts[t];
+        for (PointId i = b; i < e; ++i)
+            m_grid->binPoint(hexer::Point(
+                view.getFieldAs<double>(Dimension::Id::X, i),
+                view.getFieldAs<double>(Dimension::Id::Y, i)), c);
+    };
+
+    std::vector<std::thread> threadList(threads);
+    for (point_count_t t = 0; t < threads; t++)
+        threadList[t] = std::thread(run, t, begin + t * count / threads,
+            begin + (t + 1) * count / threads);
+    for (auto& t : threadList)
+        t.join();
+    for (auto& c : counts)
+        m_grid->addCounts(c);
+    m_count += count;
 }
 
 
@@ -129,7 +173,7 @@ void HexBin::done(PointTableRef table)
     try
     {
         m_grid->findShapes();
-        m_grid->findParentPaths();
+        m_grid->findParentPaths(m_threads);
     }
     catch (hexer::hexer_error& e)
     {
@@ -72,8 +72,10 @@ private:
     bool m_doSmooth;
     point_count_t m_count;
     bool m_preserve_topology;
+    int m_threads;
 
     virtual void addArgs(ProgramArgs& args);
+    virtual void initialize();
     virtual void ready(PointTableRef table);
     virtual void filter(PointView& view);
     virtual bool processOne(PointRef& point);
@@ -34,6 +34,7 @@
 
 #include "IQRFilter.hpp"
 
+#include <limits>
 #include <string>
 #include <vector>
 
@@ -54,11 +55,37 @@ std::string IQRFilter::getName() const
     return s_info.name;
 }
 
+// Quartiles of all the points are needed before any can be filtered, so the
+// filter can only be streamed if they are approximated as points arrive.
+bool IQRFilter::pipelineStreamable() const
+{
+    if (!m_approximate)
+        return false;
+    return Streamable::pipelineStreamable();
+}
+
+const Stage *IQRFilter::findNonstreamable() const
+{
+    if (!m_approximate)
+        return this;
+    return Streamable::findNonstreamable();
+}
+
 void IQRFilter::addArgs(ProgramArgs& args)
 {
     args.add("k", "Number of deviations", m_multiplier, 1.5);
     args.add("dimension", "Dimension on which to calculate statistics",
         m_dimName);
+    args.add("threads", "Number of threads used to find quartiles",
+        m_threads, 1);
+    args.add("approximate", "Estimate quartiles in one pass, allowing "
+        "streaming", m_approximate);
+}
+
+void IQRFilter::initialize()
+{
+    if (m_threads < 1)
+        throwError("Option 'threads' must be at least 1.");
 }
 
 void IQRFilter::prepared(PointTableRef table)
@@ -69,49 +96,83 @@ void IQRFilter::prepared(PointTableRef table)
         throwError("Dimension '" + m_dimName + "' does not exist.");
 }
 
-PointViewSet IQRFilter::run(PointViewPtr view)
+void IQRFilter::ready(PointTableRef table)
 {
-    using namespace Dimension;
+    m_sketch.clear();
+    m_nextUpdate = quantile::nextUpdate(0);
+    m_lowFence = -std::numeric_limits<double>::infinity();
+    m_hiFence = std::numeric_limits<double>::infinity();
+}
 
-    PointViewPtr output = view->makeNew();
+void IQRFilter::setFences(double pc25, double pc75)
+{
+    double iqr = pc75 - pc25;
+    m_lowFence = pc25 - m_multiplier * iqr;
+    m_hiFence = pc75 + m_multiplier * iqr;
+}
 
-    auto quartile = [](std::vector<double> vals, double percent)
+// Points are judged against the quartiles of the points seen so far, and
+// all are kept until enough have been seen to estimate quartiles.
+bool IQRFilter::processOne(PointRef& point)
+{
+    double val = point.getFieldAs<double>(m_dimId);
+    m_sketch.insert(val);
+    point_count_t count = m_sketch.count();
+    if (count && count >= m_nextUpdate)
     {
-        std::nth_element(vals.begin(),
-            vals.begin() + int(vals.size() * percent), vals.end());
+        setFences(m_sketch.value(point_count_t(count * 0.25)),
+            m_sketch.value(point_count_t(count * 0.75)));
+        m_nextUpdate = quantile::nextUpdate(count);
+    }
+    return val > m_lowFence && val < m_hiFence;
+}
 
-        return *(vals.begin() + int(vals.size() * percent));
-    };
+PointViewSet IQRFilter::run(PointViewPtr view)
+{
+    using namespace Dimension;
 
-    std::vector<double> z(view->size());
-    for (PointId j = 0; j < view->size(); ++j)
-        z[j] = view->getFieldAs<double>(m_dimId, j);
+    PointViewPtr output = view->makeNew();
+    PointViewSet viewSet;
+    viewSet.insert(output);
+    if (view->empty())
+        return viewSet;
 
+    double pc25;
+    double pc75;
+    if (m_approximate)
+    {
+        quantile::Sketch sketch;
+        for (PointId j = 0; j < view->size(); ++j)
+            sketch.insert(view->getFieldAs<double>(m_dimId, j));
+        if (sketch.count() == 0)
+            return viewSet;
+        pc25 = sketch.value(point_count_t(sketch.count() * 0.25));
+        pc75 = sketch.value(point_count_t(sketch.count() * 0.75));
+    }
+    else
+    {
+        std::vector<double> z(view->size());
+        for (PointId j = 0; j < view->size(); ++j)
+            z[j] = view->getFieldAs<double>(m_dimId, j);
 
-    double pc25 = quartile(z, 0.25);
+        pc25 = quantile::select(z, size_t(z.size() * 0.25), m_threads);
+        pc75 = quantile::select(z, size_t(z.size() * 0.75), m_threads);
+    }
     log()->get(LogLevel::Debug) << "25th percentile: " << pc25 << std::endl;
-
-    double pc75 = quartile(z, 0.75);
     log()->get(LogLevel::Debug) << "75th percentile: " << pc75 << std::endl;
+    log()->get(LogLevel::Debug) << "IQR: " << pc75 - pc25 << std::endl;
 
-    double iqr = pc75-pc25;
-    log()->get(LogLevel::Debug) << "IQR: " << iqr << std::endl;
-
-    double low_fence = pc25 - m_multiplier * iqr;
-    double hi_fence = pc75 + m_multiplier * iqr;
-
+    setFences(pc25, pc75);
     for (PointId j = 0; j < view->size(); ++j)
     {
         double val = view->getFieldAs<double>(m_dimId, j);
-        if (val > low_fence && val < hi_fence)
+        if (val > m_lowFence && val < m_hiFence)
             output->appendPoint(*view, j);
     }
     log()->get(LogLevel::Debug) << "Cropping " << m_dimName
-                                << " in the range (" << low_fence
-                                << "," << hi_fence << ")" << std::endl;
+                                << " in the range (" << m_lowFence
+                                << "," << m_hiFence << ")" << std::endl;
 
-    PointViewSet viewSet;
-    viewSet.insert(output);
     return viewSet;
 }
 
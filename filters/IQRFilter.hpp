@@ -35,6 +35,9 @@
 #pragma once
 
 #include <pdal/Filter.hpp>
+#include <pdal/Streamable.hpp>
+
+#include "private/Quantile.hpp"
 
 #include <string>
 
@@ -45,22 +48,34 @@ class ProgramArgs;
 class PointTable;
 class PointView;
 
-class PDAL_DLL IQRFilter : public Filter
+class PDAL_DLL IQRFilter : public Filter, public Streamable
 {
 public:
     IQRFilter() : Filter()
     {}
 
     std::string getName() const;
+    virtual bool pipelineStreamable() const;
+    virtual const Stage *findNonstreamable() const;
 
 private:
     double m_multiplier;
     std::string m_dimName;
     Dimension::Id m_dimId;
+    int m_threads;
+    bool m_approximate;
+    quantile::Sketch m_sketch;
+    point_count_t m_nextUpdate;
+    double m_lowFence;
+    double m_hiFence;
 
     virtual void addArgs(ProgramArgs& args);
+    virtual void initialize();
     virtual void prepared(PointTableRef table);
+    virtual void ready(PointTableRef table);
     virtual PointViewSet run(PointViewPtr view);
+    virtual bool processOne(PointRef& point);
+    void setFences(double pc25, double pc75);
 
     IQRFilter& operator=(const IQRFilter&); // not implemented
     IQRFilter(const IQRFilter&); // not implemented
@@ -65,9 +65,16 @@ void InfoFilter::addArgs(ProgramArgs& args)
 }
 
 
-void InfoFilter::parsePointSpec()
+PointIdList InfoFilter::parsePointSpec(std::string spec)
 {
-    auto parseInt = [this](const std::string& s)
+    PointIdList idList;
+
+    auto throwError = [](const std::string& s)
+    {
+        throw pdal_error(s_info.name + ": " + s);
+    };
+
+    auto parseInt = [&throwError](const std::string& s)
     {
         uint32_t i;
 
@@ -76,8 +83,8 @@ void InfoFilter::parsePointSpec()
         return i;
     };
 
-    auto addRange = [this, &parseInt](const std::string& begin,
-        const std::string& end)
+    auto addRange = [&throwError, &parseInt, &idList](
+        const std::string& begin, const std::string& end)
     {
         PointId low = parseInt(begin);
         PointId high = parseInt(end);
@@ -85,22 +92,23 @@ void InfoFilter::parsePointSpec()
             throwError("Invalid range in 'point' option: '" +
             begin + "-" + end);
         while (low <= high)
-            m_idList.push_back(low++);
+            idList.push_back(low++);
     };
 
-    Utils::trim(m_pointSpec);
+    Utils::trim(spec);
 
-    StringList ranges = Utils::split2(m_pointSpec, ',');
+    StringList ranges = Utils::split2(spec, ',');
     for (std::string& s : ranges)
     {
         StringList limits = Utils::split(s, '-');
         if (limits.size() == 1)
-            m_idList.push_back(parseInt(limits[0]));
+            idList.push_back(parseInt(limits[0]));
         else if (limits.size() == 2)
             addRange(limits[0], limits[1]);
         else
             throwError("Invalid point range in 'point' option: " + s);
     }
+    return idList;
 }
 
 
@@ -142,7 +150,7 @@ void InfoFilter::prepared(PointTableRef table)
     m_dims = table.layout()->dimTypes();
     m_pointSize = table.layout()->pointSize();
     if (m_pointSpec.size())
-        parsePointSpec();
+        m_idList = parsePointSpec(m_pointSpec);
     if (m_querySpec.size())
         parseQuerySpec();
 }
@@ -161,26 +169,47 @@ void InfoFilter::ready(PointTableRef)
 }
 
 
+// The bounds of a view are calculated all at once.  Points are only
+// visited when some are to be reported.
 void InfoFilter::filter(PointView& view)
 {
+    BOX3D bounds;
+    view.calculateBounds(bounds);
+    m_bounds.grow(bounds);
+
+    if (m_idCur == m_idList.end() && m_querySpec.empty())
+    {
+        m_count += view.size();
+        return;
+    }
+
     PointRef point(view, 0);
     for (PointId idx = 0; idx < view.size(); ++idx)
     {
         point.setPointId(idx);
-        processOne(point);
+        select(point);
     }
 }
 
 
 bool InfoFilter::processOne(PointRef& point)
+{
+    // Accumulate min/max.
+    m_bounds.grow(point.getFieldAs<double>(Dimension::Id::X),
+        point.getFieldAs<double>(Dimension::Id::Y),
+        point.getFieldAs<double>(Dimension::Id::Z));
+    select(point);
+    return true;
+}
+
+
+// Keep a point if it's one of those requested.
+void InfoFilter::select(PointRef& point)
 {
     double x = point.getFieldAs<double>(Dimension::Id::X);
     double y = point.getFieldAs<double>(Dimension::Id::Y);
     double z = point.getFieldAs<double>(Dimension::Id::Z);
 
-    // Accumulate min/max.
-    m_bounds.grow(x, y, z);
-
     // Create metadata for requsted points.
     // We may get a point list or a query list, but not both.
     if (m_idCur != m_idList.end() && *m_idCur == m_count)
@@ -211,7 +240,6 @@ bool InfoFilter::processOne(PointRef& point)
         }
     }
     m_count++;
-    return true;
 }
 
 
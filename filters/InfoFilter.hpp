@@ -69,6 +69,14 @@ public:
     std::string getName() const;
     BOX3D bounds() const
         { return m_bounds; }
+    /**
+      Parse a list of point IDs and ranges of IDs, like "1-5,10,100-200".
+      Throws pdal_error if the list is invalid.
+
+      \param spec  List to parse.
+      \return  IDs in the list.
+    */
+    static PointIdList parsePointSpec(std::string spec);
 
 private:
     virtual void addArgs(ProgramArgs& args);
@@ -79,7 +87,7 @@ private:
     virtual void done(PointTableRef table);
     virtual void filter(PointView& view);
 
-    void parsePointSpec();
+    void select(PointRef& point);
     void parseQuerySpec();
 
     MetadataNode m_pointRoot;
@@ -33,13 +33,18 @@
  ****************************************************************************/
 
 #include "IterativeClosestPoint.hpp"
+#include "private/VoxelStore.hpp"
 
 #include <pdal/EigenUtils.hpp>
 #include <pdal/KDIndex.hpp>
+#include <pdal/util/TaskScheduler.hpp>
 #include <pdal/util/Utils.hpp>
 
 #include <Eigen/Dense>
 
+#include <cmath>
+#include <functional>
+#include <memory>
 #include <numeric>
 
 namespace pdal
@@ -54,6 +59,107 @@ static StaticPluginInfo const s_info
 
 CREATE_STATIC_STAGE(IterativeClosestPoint, s_info)
 
+namespace
+{
+
+// Sums over the correspondences of a chunk of moving points, from which
+// the rigid transformation between them can be found.
+struct Correspondences
+{
+    Correspondences() : count(0), dist(0), fixedSum(Eigen::Vector3d::Zero()),
+        movingSum(Eigen::Vector3d::Zero()), cross(Eigen::Matrix3d::Zero())
+    {}
+
+    void add(const Eigen::Vector3d& fixed, const Eigen::Vector3d& moving,
+        double d)
+    {
+        count++;
+        dist += d;
+        fixedSum += fixed;
+        movingSum += moving;
+        cross += fixed * moving.transpose();
+    }
+
+    void add(const Correspondences& other)
+    {
+        count += other.count;
+        dist += other.dist;
+        fixedSum += other.fixedSum;
+        movingSum += other.movingSum;
+        cross += other.cross;
+    }
+
+    // Find the rotation and translation that best map the moving points
+    // to the fixed points, as Eigen::umeyama() does without scaling.
+    Eigen::Matrix4d transform() const
+    {
+        const Eigen::Vector3d fixedMean = fixedSum / count;
+        const Eigen::Vector3d movingMean = movingSum / count;
+        const Eigen::Matrix3d sigma =
+            cross / count - fixedMean * movingMean.transpose();
+
+        Eigen::JacobiSVD<Eigen::Matrix3d> svd(sigma,
+            Eigen::ComputeFullU | Eigen::ComputeFullV);
+        Eigen::Vector3d s = Eigen::Vector3d::Ones();
+        if (svd.matrixU().determinant() * svd.matrixV().determinant() < 0)
+            s(2) = -1;
+
+        Eigen::Matrix4d T = Eigen::Matrix4d::Identity();
+        T.topLeftCorner<3, 3>() =
+            svd.matrixU() * s.asDiagonal() * svd.matrixV().transpose();
+        T.topRightCorner<3, 1>() =
+            fixedMean - T.topLeftCorner<3, 3>() * movingMean;
+        return T;
+    }
+
+    point_count_t count;
+    double dist;
+    Eigen::Vector3d fixedSum;
+    Eigen::Vector3d movingSum;
+    Eigen::Matrix3d cross;
+};
+
+// Keep the first point of a view in each voxel of a grid with its origin
+// at 'origin'.  A cell size of 0 keeps all points.
+PointIdList voxelSample(const PointView& view, const Eigen::Vector3d& origin,
+    double cell)
+{
+    using namespace Dimension;
+
+    PointIdList ids;
+    if (cell <= 0)
+    {
+        ids.resize(view.size());
+        std::iota(ids.begin(), ids.end(), 0);
+        return ids;
+    }
+
+    VoxelStore voxels;
+    for (PointId i = 0; i < view.size(); ++i)
+    {
+        int64_t x = (int64_t)std::floor(
+            (view.getFieldAs<double>(Id::X, i) - origin.x()) / cell);
+        int64_t y = (int64_t)std::floor(
+            (view.getFieldAs<double>(Id::Y, i) - origin.y()) / cell);
+        int64_t z = (int64_t)std::floor(
+            (view.getFieldAs<double>(Id::Z, i) - origin.z()) / cell);
+        if (voxels.insert(x, y, z, 0).second)
+            ids.push_back(i);
+    }
+    return ids;
+}
+
+// Split 'count' items into 'chunks' ranges and run a function on each,
+// on the task scheduler.
+void runChunks(point_count_t count, size_t chunks,
+    const std::function<void(PointId, PointId, size_t)>& f)
+{
+    parallelFor(chunks, chunks, [&f, count, chunks](size_t c)
+        { f(count * c / chunks, count * (c + 1) / chunks, c); });
+}
+
+} // unnamed namespace
+
 std::string IterativeClosestPoint::getName() const
 {
     return s_info.name;
@@ -67,9 +173,25 @@ void IterativeClosestPoint::addArgs(ProgramArgs& args)
     args.add("tt", "Translation threshold", m_translation_threshold,
              3e-4 * 3e-4); // 0.0003 meters
     args.add("mse_abs", "Absolute threshold for MSE", m_mse_abs, 1e-12);
+    args.add("mse_rel", "Relative threshold for change in MSE", m_mse_rel,
+             0.0);
     args.add("max_similar",
              "Max number of similar transforms to consider converged",
              m_max_similar, 0);
+    args.add("threads", "Number of threads used to find correspondences",
+             m_threads, 1);
+    args.add("voxel_sizes", "Voxel sizes at which to register in turn, "
+             "from coarse to fine (0 = all points)", m_voxel_sizes);
+}
+
+void IterativeClosestPoint::initialize()
+{
+    if (m_threads < 1)
+        throwError("Option 'threads' must be at least 1.");
+    for (double size : m_voxel_sizes)
+        if (size < 0)
+            throwError("Option 'voxel_sizes' can't contain negative "
+                "values.");
 }
 
 PointViewSet IterativeClosestPoint::run(PointViewPtr view)
@@ -105,127 +227,173 @@ void IterativeClosestPoint::done(PointTableRef _)
 PointViewPtr IterativeClosestPoint::icp(PointViewPtr fixed,
                                         PointViewPtr moving) const
 {
+    using namespace Dimension;
+
     // Compute centroid of fixed PointView such that both the fixed an moving
     // PointViews can be centered.
     PointIdList ids(fixed->size());
     std::iota(ids.begin(), ids.end(), 0);
     auto centroid = computeCentroid(*fixed, ids);
 
-    // Demean the fixed and moving PointViews.
+    // Demean the fixed PointView.  Moving points are demeaned as they're
+    // sampled.
     PointViewPtr tempFixed = demeanPointView(*fixed, centroid.data());
-    PointViewPtr tempMoving = demeanPointView(*moving, centroid.data());
 
     // Initialize the final_transformation to identity. In the future, it would
     // be reasonable to alternately accept an initial guess.
     Eigen::Matrix4d final_transformation = Eigen::Matrix4d::Identity();
 
-    // Construct 3D KD-tree of the centered, fixed PointView to facilitate
-    // nearest neighbor searches in each iteration.
-    KD3Index& kd_fixed = tempFixed->build3dIndex();
+    // Correspondences are found for chunks of the moving points, on separate
+    // threads if requested.
+    const size_t chunks = (size_t)m_threads;
+
+    // Register at each voxel size in turn, starting from the transformation
+    // found at the previous size.
+    std::vector<double> voxel_sizes(m_voxel_sizes);
+    if (voxel_sizes.empty())
+        voxel_sizes.push_back(0);
 
-    // Iterate to the max number of iterations or until converged.
     bool converged(false);
-    double prev_mse(0.0);
-    int num_similar(0);
-    for (int iter = 0; iter < m_max_iters; ++iter)
+    for (double voxel_size : voxel_sizes)
     {
-        // At the beginning of each iteration, transform our centered, moving
-        // PointView by the current final_transformation.
-        PointViewPtr tempMovingTransformed =
-            transform(*tempMoving, final_transformation.data());
-
-        // Create empty lists to hold point correspondences, and initialize MSE
-        // to zero.
-        PointIdList fixed_idx, moving_idx;
-        fixed_idx.reserve(tempMovingTransformed->size());
-        moving_idx.reserve(tempMovingTransformed->size());
-        double mse(0.0);
-
-        // For every point in the centered, moving PointView, find the nearest
-        // neighbor in the centered fixed PointView. Record the indices of each
-        // and update the MSE.
-        for (PointId i = 0; i < tempMovingTransformed->size(); ++i)
+        // Sample the centered, fixed PointView and construct a 3D KD-tree of
+        // the sample to facilitate nearest neighbor searches in each
+        // iteration.
+        PointViewPtr levelFixed = tempFixed;
+        if (voxel_size > 0)
         {
-            // Find the index of the nearest neighbor, and the square distance
-            // between each point.
-            PointRef p = tempMovingTransformed->point(i);
-            PointIdList indices(1);
-            std::vector<double> sqr_dists(1);
-            kd_fixed.knnSearch(p, 1, &indices, &sqr_dists);
-
-            // In the PCL code, there would've been a check that the square
-            // distance did not exceed a threshold value.
-
-            // Store the indices of the correspondence and update the MSE.
-            moving_idx.push_back(i);
-            fixed_idx.push_back(indices[0]);
-            mse += std::sqrt(sqr_dists[0]);
+            levelFixed = tempFixed->makeNew();
+            for (PointId id : voxelSample(*fixed, centroid, voxel_size))
+                levelFixed->appendPoint(*tempFixed, id);
         }
-
-        // Finalize and log the MSE.
-        mse /= moving_idx.size();
-        log()->get(LogLevel::Debug2) << "MSE: " << mse << std::endl;
-
-        // Estimate rigid transformation using Umeyama method, logging the
-        // current translation in X and Y.
-        auto A = pointViewToEigen(*tempFixed, fixed_idx);
-        auto B = pointViewToEigen(*tempMovingTransformed, moving_idx);
-        auto T = Eigen::umeyama(B.transpose(), A.transpose(), false);
-        log()->get(LogLevel::Debug2) << "Current dx: " << T.coeff(0, 3) << ", "
-                                     << "dy: " << T.coeff(1, 3) << std::endl;
-
-        // Update the final_transformation and log the X and Y translations.
-        final_transformation = final_transformation * T;
-        log()->get(LogLevel::Debug2)
-            << "Cumulative dx: " << final_transformation.coeff(0, 3) << ", "
-            << "dy: " << final_transformation.coeff(1, 3) << std::endl;
-
-        bool is_similar = false;
-
-        // Compute and log the rotation and translation of the current
-        // transformation (not cumulative).
-        double cos_angle =
-            0.5 * (T.coeff(0, 0) + T.coeff(1, 1) + T.coeff(2, 2) - 1);
-        double translation_sqr = T.coeff(0, 3) * T.coeff(0, 3) +
-                                 T.coeff(1, 3) * T.coeff(1, 3) +
-                                 T.coeff(2, 3) * T.coeff(2, 3);
-        log()->get(LogLevel::Debug2) << "Rotation: " << cos_angle << std::endl;
-        log()->get(LogLevel::Debug2)
-            << "Translation: " << translation_sqr << std::endl;
-
-        // Check for change in MSE.
-        if (std::fabs(mse - prev_mse) < m_mse_abs)
+        KD3Index& kd_fixed = levelFixed->build3dIndex();
+
+        // Sample and center the moving PointView.
+        PointIdList movingIds = voxelSample(*moving, centroid, voxel_size);
+        std::vector<Eigen::Vector3d> movingPoints;
+        movingPoints.reserve(movingIds.size());
+        for (PointId id : movingIds)
+            movingPoints.emplace_back(
+                moving->getFieldAs<double>(Id::X, id) - centroid.x(),
+                moving->getFieldAs<double>(Id::Y, id) - centroid.y(),
+                moving->getFieldAs<double>(Id::Z, id) - centroid.z());
+
+        log()->get(LogLevel::Debug2) << "Voxel size " << voxel_size << ": "
+            << levelFixed->size() << " fixed and " << movingPoints.size()
+            << " moving points\n";
+
+        // Iterate to the max number of iterations or until converged.
+        converged = false;
+        double prev_mse(0.0);
+        int num_similar(0);
+        for (int iter = 0; iter < m_max_iters; ++iter)
         {
-            if (num_similar >= m_max_similar)
+            // For every point in the centered, moving PointView, transformed
+            // by the current final_transformation, find the nearest neighbor
+            // in the centered fixed PointView.  Accumulate the sums needed to
+            // estimate the transformation and the MSE.
+            const Eigen::Matrix3d R =
+                final_transformation.topLeftCorner<3, 3>();
+            const Eigen::Vector3d t =
+                final_transformation.topRightCorner<3, 1>();
+            std::vector<Correspondences> partials(chunks);
+            runChunks(movingPoints.size(), chunks,
+                [&](PointId begin, PointId end, size_t chunk)
+            {
+                Correspondences& c = partials[chunk];
+                PointIdList indices(1);
+                std::vector<double> sqr_dists(1);
+                for (PointId i = begin; i < end; ++i)
+                {
+                    const Eigen::Vector3d p = R * movingPoints[i] + t;
+                    kd_fixed.knnSearch(p.x(), p.y(), p.z(), 1, &indices,
+                        &sqr_dists);
+
+                    // In the PCL code, there would've been a check that the
+                    // square distance did not exceed a threshold value.
+                    const Eigen::Vector3d q(
+                        levelFixed->getFieldAs<double>(Id::X, indices[0]),
+                        levelFixed->getFieldAs<double>(Id::Y, indices[0]),
+                        levelFixed->getFieldAs<double>(Id::Z, indices[0]));
+                    c.add(q, p, std::sqrt(sqr_dists[0]));
+                }
+            });
+            Correspondences total;
+            for (const Correspondences& c : partials)
+                total.add(c);
+
+            // Finalize and log the MSE.
+            double mse = total.dist / total.count;
+            log()->get(LogLevel::Debug2) << "MSE: " << mse << std::endl;
+
+            // Estimate rigid transformation using Umeyama method, logging the
+            // current translation in X and Y.
+            Eigen::Matrix4d T = total.transform();
+            log()->get(LogLevel::Debug2) << "Current dx: " << T.coeff(0, 3)
+                                         << ", " << "dy: " << T.coeff(1, 3)
+                                         << std::endl;
+
+            // Update the final_transformation and log the X and Y
+            // translations.
+            final_transformation = final_transformation * T;
+            log()->get(LogLevel::Debug2)
+                << "Cumulative dx: " << final_transformation.coeff(0, 3)
+                << ", " << "dy: " << final_transformation.coeff(1, 3)
+                << std::endl;
+
+            bool is_similar = false;
+
+            // Compute and log the rotation and translation of the current
+            // transformation (not cumulative).
+            double cos_angle =
+                0.5 * (T.coeff(0, 0) + T.coeff(1, 1) + T.coeff(2, 2) - 1);
+            double translation_sqr = T.coeff(0, 3) * T.coeff(0, 3) +
+                                     T.coeff(1, 3) * T.coeff(1, 3) +
+                                     T.coeff(2, 3) * T.coeff(2, 3);
+            log()->get(LogLevel::Debug2)
+                << "Rotation: " << cos_angle << std::endl;
+            log()->get(LogLevel::Debug2)
+                << "Translation: " << translation_sqr << std::endl;
+
+            // Check for change in MSE, absolute and relative to the previous
+            // MSE.
+            double mse_change = std::fabs(mse - prev_mse);
+            if (mse_change < m_mse_abs ||
+                (m_mse_rel > 0 && iter > 0 &&
+                    mse_change <= m_mse_rel * prev_mse))
             {
-                converged = true;
-                log()->get(LogLevel::Debug2) << "converged via absolute MSE\n";
-                break;
+                if (num_similar >= m_max_similar)
+                {
+                    converged = true;
+                    log()->get(LogLevel::Debug2)
+                        << "converged via MSE change\n";
+                    break;
+                }
+                is_similar = true;
             }
-            is_similar = true;
-        }
 
-        // If the rotation and translation satisfy the specified thresholds,
-        // mark as converged, and exit the for loop.
-        if ((cos_angle >= m_rotation_threshold) &&
-            (translation_sqr <= m_translation_threshold))
-        {
-            if (num_similar >= m_max_similar)
+            // If the rotation and translation satisfy the specified
+            // thresholds, mark as converged, and exit the for loop.
+            if ((cos_angle >= m_rotation_threshold) &&
+                (translation_sqr <= m_translation_threshold))
             {
-                converged = true;
-                log()->get(LogLevel::Debug2)
-                    << "converged via rotation/translation thresholds\n";
-                break;
+                if (num_similar >= m_max_similar)
+                {
+                    converged = true;
+                    log()->get(LogLevel::Debug2)
+                        << "converged via rotation/translation thresholds\n";
+                    break;
+                }
+                is_similar = true;
             }
-            is_similar = true;
-        }
 
-        if (is_similar)
-            ++num_similar;
-        else
-            num_similar = 0;
+            if (is_similar)
+                ++num_similar;
+            else
+                num_similar = 0;
 
-        prev_mse = mse;
+            prev_mse = mse;
+        }
     }
 
     // Apply the final_transformation to the moving PointView.
@@ -256,16 +424,21 @@ PointViewPtr IterativeClosestPoint::icp(PointViewPtr fixed,
 
     // Compute the MSE one last time, using the unaltered, fixed PointView and
     // the transformed, moving PointView.
-    double mse(0.0);
     KD3Index& kd_fixed_orig = fixed->build3dIndex();
-    for (PointId i = 0; i < moving->size(); ++i)
+    std::vector<double> dists(chunks);
+    runChunks(moving->size(), chunks,
+        [&](PointId begin, PointId end, size_t chunk)
     {
-        PointRef p = moving->point(i);
         PointIdList indices(1);
         std::vector<double> sqr_dists(1);
-        kd_fixed_orig.knnSearch(p, 1, &indices, &sqr_dists);
-        mse += std::sqrt(sqr_dists[0]);
-    }
+        for (PointId i = begin; i < end; ++i)
+        {
+            PointRef p = moving->point(i);
+            kd_fixed_orig.knnSearch(p, 1, &indices, &sqr_dists);
+            dists[chunk] += std::sqrt(sqr_dists[0]);
+        }
+    });
+    double mse = std::accumulate(dists.begin(), dists.end(), 0.0);
     mse /= moving->size();
     log()->get(LogLevel::Debug2) << "MSE: " << mse << std::endl;
 
@@ -36,6 +36,8 @@
 
 #include <pdal/Filter.hpp>
 
+#include <vector>
+
 namespace pdal
 {
 
@@ -53,8 +55,12 @@ private:
     double m_rotation_threshold;
     double m_translation_threshold;
     double m_mse_abs;
+    double m_mse_rel;
+    int m_threads;
+    std::vector<double> m_voxel_sizes;
 
     virtual void addArgs(ProgramArgs& args);
+    virtual void initialize();
     virtual PointViewSet run(PointViewPtr view);
     virtual void done(PointTableRef _);
     PointViewPtr icp(PointViewPtr fixed, PointViewPtr moving) const;
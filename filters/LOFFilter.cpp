@@ -35,7 +35,10 @@
 #include "LOFFilter.hpp"
 
 #include <pdal/KDIndex.hpp>
+#include <pdal/util/TaskScheduler.hpp>
 
+#include <algorithm>
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -59,6 +62,21 @@ std::string LOFFilter::getName() const
 void LOFFilter::addArgs(ProgramArgs& args)
 {
     args.add("minpts", "Minimum number of points", m_minpts, 10);
+    args.add("knn_eps", "Approximation factor of the k-nearest neighbor "
+        "search.  0 finds the exact neighbors", m_eps, 0.0);
+    args.add("cache_neighbors", "Find the neighbors of each point once and "
+        "keep them for all passes, rather than finding them again in each "
+        "pass", m_cacheNeighbors, true);
+    args.add("threads", "Number of threads used to run this filter",
+        m_threads, 1);
+}
+
+void LOFFilter::initialize()
+{
+    if (m_eps < 0)
+        throwError("Option 'knn_eps' can't be negative.");
+    m_metadata.add("knn_eps", m_eps, "Approximation factor of the k-nearest "
+        "neighbor search");
 }
 
 void LOFFilter::addDimensions(PointLayoutPtr layout)
@@ -77,18 +95,56 @@ void LOFFilter::filter(PointView& view)
 
     // Increment the minimum number of points, as knnSearch will be returning
     // the neighbors along with the query point.
-    m_minpts++;
+    const point_count_t k = m_minpts + 1;
+    const point_count_t count = view.size();
+    const int threads = (std::max)(1, m_threads);
+
+    // The neighborhoods are found once and shared by all of the passes,
+    // unless they are to be found again by each pass to save memory.
+    KDNeighbors cached;
+    if (m_cacheNeighbors)
+        cached = index.knnAll(k, threads, m_eps);
+
+    // Call f with the neighborhood of every point.  Points are divided into
+    // a range per thread.  When the neighborhoods aren't cached, each thread
+    // finds those of its points a block at a time.
+    using Visit = std::function<void(PointId, const PointId *,
+        const double *, point_count_t)>;
+    auto forEach = [&](const Visit& f)
+    {
+        auto run = [&](PointId start, PointId end)
+        {
+            const point_count_t blockSize = 4096;
+            for (PointId begin = start; begin < end; begin += blockSize)
+            {
+                PointId last = (std::min)(begin + blockSize, end);
+                KDNeighbors found;
+                if (!m_cacheNeighbors)
+                    found = index.knnRange(begin, last, k, 1, m_eps);
+                const KDNeighbors& nbrs = m_cacheNeighbors ? cached : found;
+                const PointId first = m_cacheNeighbors ? 0 : begin;
+                for (PointId i = begin; i < last; ++i)
+                    f(i, nbrs.neighbors(i - first), nbrs.distances(i - first),
+                        nbrs.count(i - first));
+            }
+        };
+
+        const point_count_t n = threads;
+        parallelFor(n, n, [&run, count, n](std::size_t t)
+            { run(t * count / n, (t + 1) * count / n); });
+    };
+
+    std::vector<double> kdist(count);
+    std::vector<double> lrd(count);
 
     // First pass: Compute the k-distance for each point.
     // The k-distance is the Euclidean distance to k-th nearest neighbor.
     log()->get(LogLevel::Debug) << "Computing k-distances...\n";
-    for (PointId i = 0; i < view.size(); ++i)
+    forEach([&kdist](PointId i, const PointId *, const double *sqr_dists,
+        point_count_t n)
     {
-        PointIdList indices(m_minpts);
-        std::vector<double> sqr_dists(m_minpts);
-        index.knnSearch(i, m_minpts, &indices, &sqr_dists);
-        view.setField(m_kdist, i, std::sqrt(sqr_dists[m_minpts-1]));
-    }
+        kdist[i] = std::sqrt(sqr_dists[n - 1]);
+    });
 
     // Second pass: Compute the local reachability distance for each point.
     // For each neighbor point, the reachability distance is the maximum value
@@ -96,39 +152,35 @@ void LOFFilter::filter(PointView& view)
     // the current point. The lrd is the inverse of the mean of the reachability
     // distances.
     log()->get(LogLevel::Debug) << "Computing lrd...\n";
-    for (PointId i = 0; i < view.size(); ++i)
+    forEach([&kdist, &lrd](PointId i, const PointId *indices,
+        const double *sqr_dists, point_count_t num)
     {
-        PointIdList indices(m_minpts);
-        std::vector<double> sqr_dists(m_minpts);
-        index.knnSearch(i, m_minpts, &indices, &sqr_dists);
         double M1 = 0.0;
         point_count_t n = 0;
-        for (PointId j = 0; j < indices.size(); ++j)
+        for (PointId j = 0; j < num; ++j)
         {
-            double k = view.getFieldAs<double>(m_kdist, indices[j]);
-            double reachdist = (std::max)(k, std::sqrt(sqr_dists[j]));
+            double reachdist = (std::max)(kdist[indices[j]],
+                std::sqrt(sqr_dists[j]));
             M1 += (reachdist - M1) / ++n;
         }
-        view.setField(m_lrd, i, 1.0 / M1);
-    }
+        lrd[i] = 1.0 / M1;
+    });
 
     // Third pass: Compute the local outlier factor for each point.
     // The LOF is the average of the lrd's for a neighborhood of points.
     log()->get(LogLevel::Debug) << "Computing LOF...\n";
-    for (PointId i = 0; i < view.size(); ++i)
+    forEach([this, &view, &kdist, &lrd](PointId i, const PointId *indices,
+        const double *, point_count_t num)
     {
-        double lrdp = view.getFieldAs<double>(m_lrd, i);
-        PointIdList indices(m_minpts);
-        std::vector<double> sqr_dists(m_minpts);
-        index.knnSearch(i, m_minpts, &indices, &sqr_dists);
+        double lrdp = lrd[i];
         double M1 = 0.0;
         point_count_t n = 0;
-        for (auto const& j : indices)
-        {
-            M1 += (view.getFieldAs<double>(m_lrd, j) / lrdp - M1) / ++n;
-        }
+        for (PointId j = 0; j < num; ++j)
+            M1 += (lrd[indices[j]] / lrdp - M1) / ++n;
+        view.setField(m_kdist, i, kdist[i]);
+        view.setField(m_lrd, i, lrdp);
         view.setField(m_lof, i, M1);
-    }
+    });
 }
 
 } // namespace pdal
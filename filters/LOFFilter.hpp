@@ -56,8 +56,12 @@ public:
 private:
     Dimension::Id m_kdist, m_lrd, m_lof;
     int m_minpts;
+    double m_eps;
+    bool m_cacheNeighbors;
+    int m_threads;
 
     virtual void addArgs(ProgramArgs& args);
+    virtual void initialize();
     virtual void addDimensions(PointLayoutPtr layout);
     virtual void filter(PointView& view);
 
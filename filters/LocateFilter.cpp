@@ -35,8 +35,14 @@
 #include "LocateFilter.hpp"
 
 #include <pdal/util/ProgramArgs.hpp>
+#include <pdal/util/TaskScheduler.hpp>
 #include <pdal/util/Utils.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
 namespace pdal
 {
 
@@ -59,6 +65,20 @@ void LocateFilter::addArgs(ProgramArgs& args)
     args.add("dimension", "Dimension in which to locate max", m_dimName);
     args.add("minmax", "Whether to search for the minimum or maximum value",
         m_minmax, "max");
+    args.add("threads", "Number of threads used to search the points",
+        m_threads, 1);
+}
+
+void LocateFilter::initialize()
+{
+    if (Utils::iequals("max", m_minmax))
+        m_max = true;
+    else if (Utils::iequals("min", m_minmax))
+        m_max = false;
+    else
+        throwError("Option 'minmax' must be either 'min' or 'max'.");
+    if (m_threads < 1)
+        throwError("Option 'threads' must be at least 1.");
 }
 
 void LocateFilter::prepared(PointTableRef table)
@@ -69,37 +89,68 @@ void LocateFilter::prepared(PointTableRef table)
         throwError("Invalid dimension '" + m_dimName + "'.");
 }
 
+void LocateFilter::ready(PointTableRef)
+{
+    m_best = std::numeric_limits<double>::quiet_NaN();
+}
+
+// In stream mode a point can't be held back until all points have been
+// seen, so every point that improves on the points before it is passed.
+// The last point passed is the one located.
+bool LocateFilter::processOne(PointRef& point)
+{
+    double val = point.getFieldAs<double>(m_dimId);
+    if (std::isnan(val) || !(std::isnan(m_best) || better(val, m_best)))
+        return false;
+    m_best = val;
+    return true;
+}
+
 PointViewSet LocateFilter::run(PointViewPtr inView)
 {
     PointViewSet viewSet;
     if (!inView->size())
         return viewSet;
 
-    PointId minidx, maxidx;
-    double minval = (std::numeric_limits<double>::max)();
-    double maxval = std::numeric_limits<double>::lowest();
+    // Each thread finds the first extreme point of a contiguous range.
+    // Taking the first of the ranges' extremes among equal values keeps
+    // the point found the same as that of a serial search.
+    struct Extreme
+    {
+        PointId idx;
+        double val;
+        bool found;
+    };
+
+    const point_count_t count = inView->size();
+    const size_t threads =
+        (size_t)(std::min)((point_count_t)m_threads, count);
+    std::vector<Extreme> extremes(threads, Extreme{ 0, 0, false });
 
-    for (PointId idx = 0; idx < inView->size(); idx++)
+    auto search = [&](size_t t)
     {
-        double val = inView->getFieldAs<double>(m_dimId, idx);
-        if (val > maxval)
-        {
-            maxval = val;
-            maxidx = idx;
-        }
-        if (val < minval)
+        Extreme& e = extremes[t];
+        const PointId end = (t + 1) * count / threads;
+        for (PointId idx = t * count / threads; idx < end; ++idx)
         {
-            minval = val;
-            minidx = idx;
+            double val = inView->getFieldAs<double>(m_dimId, idx);
+            if (std::isnan(val))
+                continue;
+            if (!e.found || better(val, e.val))
+                e = Extreme{ idx, val, true };
         }
-    }
+    };
 
-    PointViewPtr outView = inView->makeNew();
+    parallelFor(threads, threads, search);
 
-    if (Utils::iequals("min", m_minmax))
-        outView->appendPoint(*inView.get(), minidx);
-    if (Utils::iequals("max", m_minmax))
-        outView->appendPoint(*inView.get(), maxidx);
+    const Extreme *best = nullptr;
+    for (const Extreme& e : extremes)
+        if (e.found && (!best || better(e.val, best->val)))
+            best = &e;
+
+    PointViewPtr outView = inView->makeNew();
+    if (best)
+        outView->appendPoint(*inView.get(), best->idx);
 
     viewSet.insert(outView);
     return viewSet;
@@ -35,6 +35,7 @@
 #pragma once
 
 #include <pdal/Filter.hpp>
+#include <pdal/Streamable.hpp>
 
 #include <map>
 #include <string>
@@ -45,7 +46,7 @@ namespace pdal
 class PointView;
 class ProgramArgs;
 
-class PDAL_DLL LocateFilter : public Filter
+class PDAL_DLL LocateFilter : public Filter, public Streamable
 {
 public:
     LocateFilter() : Filter()
@@ -57,11 +58,20 @@ private:
     std::string m_dimName;
     Dimension::Id m_dimId;
     std::string m_minmax;
+    bool m_max;
+    int m_threads;
+    double m_best;
 
     virtual void addArgs(ProgramArgs& args);
+    virtual void initialize();
     virtual void prepared(PointTableRef table);
+    virtual void ready(PointTableRef table);
+    virtual bool processOne(PointRef& point);
     virtual PointViewSet run(PointViewPtr view);
 
+    bool better(double val, double best) const
+        { return m_max ? val > best : val < best; }
+
     LocateFilter& operator=(const LocateFilter&); // not implemented
     LocateFilter(const LocateFilter&); // not implemented
 };
@@ -34,6 +34,9 @@
 
 #include "MADFilter.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <string>
 #include <vector>
 
@@ -54,12 +57,38 @@ std::string MADFilter::getName() const
     return s_info.name;
 }
 
+// The median of all the points is needed before any can be filtered, so the
+// filter can only be streamed if it is approximated as points arrive.
+bool MADFilter::pipelineStreamable() const
+{
+    if (!m_approximate)
+        return false;
+    return Streamable::pipelineStreamable();
+}
+
+const Stage *MADFilter::findNonstreamable() const
+{
+    if (!m_approximate)
+        return this;
+    return Streamable::findNonstreamable();
+}
+
 void MADFilter::addArgs(ProgramArgs& args)
 {
     args.add("k", "Number of deviations", m_multiplier, 2.0);
     args.add("dimension", "Dimension on which to calculate statistics",
         m_dimName);
     args.add("mad_multiplier", "MAD threshold multiplier", m_madMultiplier, 1.4862);
+    args.add("threads", "Number of threads used to find medians",
+        m_threads, 1);
+    args.add("approximate", "Estimate medians in one pass, allowing "
+        "streaming", m_approximate);
+}
+
+void MADFilter::initialize()
+{
+    if (m_threads < 1)
+        throwError("Option 'threads' must be at least 1.");
 }
 
 void MADFilter::prepared(PointTableRef table)
@@ -70,34 +99,72 @@ void MADFilter::prepared(PointTableRef table)
         throwError("Dimension '" + m_dimName + "' does not exist.");
 }
 
+void MADFilter::ready(PointTableRef table)
+{
+    m_sketch.clear();
+    m_nextUpdate = quantile::nextUpdate(0);
+    m_median = 0;
+    m_mad = std::numeric_limits<double>::infinity();
+}
+
+// Points are judged against the median and MAD of the points seen so far,
+// and all are kept until enough have been seen to estimate them.
+bool MADFilter::processOne(PointRef& point)
+{
+    double val = point.getFieldAs<double>(m_dimId);
+    m_sketch.insert(val);
+    point_count_t count = m_sketch.count();
+    if (count && count >= m_nextUpdate)
+    {
+        m_median = m_sketch.value(count / 2);
+        m_mad = m_sketch.deviation(m_median, count / 2) * m_madMultiplier;
+        m_nextUpdate = quantile::nextUpdate(count);
+    }
+    return std::fabs(val - m_median) / m_mad < m_multiplier;
+}
+
 PointViewSet MADFilter::run(PointViewPtr view)
 {
     using namespace Dimension;
 
     PointViewPtr output = view->makeNew();
+    PointViewSet viewSet;
+    viewSet.insert(output);
+    if (view->empty())
+        return viewSet;
 
-    auto estimate_median = [](std::vector<double> vals)
+    double median;
+    double mad;
+    if (m_approximate)
     {
-        std::nth_element(vals.begin(), vals.begin()+vals.size()/2, vals.end());
-        return *(vals.begin()+vals.size()/2);
-    };
-
-    std::vector<double> z(view->size());
-    for (PointId j = 0; j < view->size(); ++j)
-        z[j] = view->getFieldAs<double>(m_dimId, j);
-
-    double median = estimate_median(z);
+        quantile::Sketch sketch;
+        for (PointId j = 0; j < view->size(); ++j)
+            sketch.insert(view->getFieldAs<double>(m_dimId, j));
+        if (sketch.count() == 0)
+            return viewSet;
+        median = sketch.value(sketch.count() / 2);
+        mad = sketch.deviation(median, sketch.count() / 2);
+    }
+    else
+    {
+        std::vector<double> z(view->size());
+        for (PointId j = 0; j < view->size(); ++j)
+            z[j] = view->getFieldAs<double>(m_dimId, j);
+
+        median = quantile::select(z, z.size() / 2, m_threads);
+        std::transform(z.begin(), z.end(), z.begin(),
+           [median](double v) { return std::fabs(v - median); });
+        mad = quantile::select(z, z.size() / 2, m_threads);
+    }
+    mad *= m_madMultiplier;
     log()->get(LogLevel::Debug) << getName() <<
         " estimated median value: " << median << std::endl;
-
-    std::transform(z.begin(), z.end(), z.begin(),
-       [median](double v) { return std::fabs(v - median); });
-    double mad = estimate_median(z)*m_madMultiplier;
     log()->get(LogLevel::Debug) << getName() << " mad " << mad << std::endl;
 
     for (PointId j = 0; j < view->size(); ++j)
     {
-        if (z[j]/mad < m_multiplier)
+        double val = view->getFieldAs<double>(m_dimId, j);
+        if (std::fabs(val - median) / mad < m_multiplier)
             output->appendPoint(*view, j);
     }
 
@@ -108,8 +175,6 @@ PointViewSet MADFilter::run(PointViewPtr view)
                                 << " in the range (" << low_fence
                                 << "," << hi_fence << ")" << std::endl;
 
-    PointViewSet viewSet;
-    viewSet.insert(output);
     return viewSet;
 }
 
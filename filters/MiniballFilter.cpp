@@ -41,12 +41,13 @@
 
 #include <pdal/KDIndex.hpp>
 #include <pdal/util/ProgramArgs.hpp>
+#include <pdal/util/TaskScheduler.hpp>
 
 #include "private/miniball/Seb.h"
 
+#include <algorithm>
 #include <cmath>
 #include <string>
-#include <thread>
 #include <vector>
 
 namespace pdal
@@ -75,34 +76,46 @@ void MiniballFilter::addArgs(ProgramArgs& args)
              1);
 }
 
+void MiniballFilter::initialize()
+{
+    if (m_threads < 1)
+        throwError("Option 'threads' must be at least 1.");
+}
+
 void MiniballFilter::addDimensions(PointLayoutPtr layout)
 {
     m_miniball =
         layout->registerOrAssignDim("Miniball", Dimension::Type::Double);
 }
 
+// Each thread takes a range of points and finds their neighbors a block at
+// a time with a batched query, so that the neighbors of all points needn't
+// be held at once.
 void MiniballFilter::filter(PointView& view)
 {
-    KD3Index& kdi = view.build3dIndex();
+    const KD3Index& kdi = view.build3dIndex();
 
-    point_count_t nloops = view.size();
-    std::vector<std::thread> threadList(m_threads);
-    for (int t = 0; t < m_threads; t++)
+    const point_count_t nloops = view.size();
+    const point_count_t blockSize = 4096;
+    auto run = [&](PointId start, PointId end)
     {
-        threadList[t] = std::thread(std::bind(
-            [&](const PointId start, const PointId end) {
-                for (PointId i = start; i < end; i++)
-                    setMiniball(view, i, kdi);
-            },
-            t * nloops / m_threads,
-            (t + 1) == m_threads ? nloops : (t + 1) * nloops / m_threads));
-    }
-    for (auto& t : threadList)
-        t.join();
+        for (PointId begin = start; begin < end; begin += blockSize)
+        {
+            const PointId last = (std::min)(begin + blockSize, end);
+            KDNeighbors nbrs = kdi.knnRange(begin, last, m_knn + 1, 1);
+            for (PointId i = begin; i < last; ++i)
+                setMiniball(view, i, nbrs.neighbors(i - begin),
+                    nbrs.count(i - begin));
+        }
+    };
+
+    const point_count_t threads = (std::max)(1, m_threads);
+    parallelFor(threads, threads, [&run, nloops, threads](std::size_t t)
+        { run(t * nloops / threads, (t + 1) * nloops / threads); });
 }
 
-void MiniballFilter::setMiniball(PointView& view, const PointId& i,
-                                 const KD3Index& kdi)
+void MiniballFilter::setMiniball(PointView& view, PointId i,
+    const PointId *ni, point_count_t count)
 {
     typedef double FT;
     typedef Seb::Point<FT> Point;
@@ -113,13 +126,12 @@ void MiniballFilter::setMiniball(PointView& view, const PointId& i,
     double Y = view.getFieldAs<double>(Dimension::Id::Y, i);
     double Z = view.getFieldAs<double>(Dimension::Id::Z, i);
 
-    // Find k-nearest neighbors of i.
-    auto ni = kdi.neighbors(i, m_knn + 1);
-
     PointVector S;
+    S.reserve(count);
     std::vector<double> coords(3);
-    for (auto const& j : ni)
+    for (point_count_t k = 0; k < count; ++k)
     {
+        const PointId j = ni[k];
         if (j == i)
             continue;
         coords[0] = view.getFieldAs<double>(Dimension::Id::X, j);
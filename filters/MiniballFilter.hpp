@@ -58,10 +58,12 @@ private:
     Dimension::Id m_miniball;
 
     virtual void addArgs(ProgramArgs& args);
+    virtual void initialize();
     virtual void addDimensions(PointLayoutPtr layout);
     virtual void filter(PointView& view);
 
-    void setMiniball(PointView& view, const PointId& i, const KD3Index& kdi);
+    void setMiniball(PointView& view, PointId i, const PointId *ni,
+        point_count_t count);
 };
 
 } // namespace pdal
@@ -75,6 +75,9 @@ void MongoExpressionFilter::prepared(PointTableRef table)
 
     log()->get(LogLevel::Debug) << "Built expression: " << *m_expression <<
         std::endl;
+
+    m_selection.reset(new Selection);
+    m_expression->compile(*m_selection);
 }
 
 PointViewSet MongoExpressionFilter::run(PointViewPtr inView)
@@ -82,13 +85,12 @@ PointViewSet MongoExpressionFilter::run(PointViewPtr inView)
     PointViewSet views;
     PointViewPtr view(inView->makeNew());
 
+    std::vector<char> mask;
+    m_selection->run(*inView, 0, inView->size(), mask);
     for (PointId i(0); i < inView->size(); ++i)
     {
-        PointRef pr(inView->point(i));
-        if (processOne(pr))
-        {
+        if (mask[i])
             view->appendPoint(*inView, i);
-        }
     }
 
     views.insert(view);
@@ -97,7 +99,20 @@ PointViewSet MongoExpressionFilter::run(PointViewPtr inView)
 
 bool MongoExpressionFilter::processOne(PointRef& pr)
 {
-    return m_expression->check(pr);
+    return m_selection->passes(pr);
+}
+
+point_count_t MongoExpressionFilter::processBatch(StreamPointTable& table,
+    PointId begin, point_count_t count)
+{
+    // Only the points that earlier stages kept are evaluated.
+    StreamPointTable::IdRange ids = table.activeIds(begin, count);
+    std::vector<char> mask;
+    m_selection->runIds(table, ids.begin(), ids.size(), mask);
+    for (std::size_t i = 0; i < ids.size(); ++i)
+        if (!mask[i])
+            table.setSkip(ids.begin()[i]);
+    return count;
 }
 
 } // namespace pdal
@@ -42,6 +42,7 @@ namespace pdal
 {
 
 class Expression;
+class Selection;
 
 class PDAL_DLL MongoExpressionFilter : public Filter, public Streamable
 {
@@ -56,9 +57,12 @@ private:
     virtual void addArgs(ProgramArgs& args) override;
     virtual void prepared(PointTableRef table) override;
     virtual PointViewSet run(PointViewPtr view) override;
+    virtual point_count_t processBatch(StreamPointTable& table,
+        PointId begin, point_count_t count) override;
 
     NL::json m_json;
     std::unique_ptr<Expression> m_expression;
+    std::unique_ptr<Selection> m_selection;
 };
 
 } // namespace pdal
@@ -34,12 +34,15 @@
 
 #include "MortonOrderFilter.hpp"
 
+#include <pdal/DimAccessor.hpp>
 #include <pdal/EigenUtils.hpp>
 
 #include <climits>
-#include <iostream>
-#include <limits>
-#include <map>
+#include <cmath>
+#include <utility>
+
+#include "private/RadixSort.hpp"
+#include "private/SpaceCurve.hpp"
 
 namespace pdal
 {
@@ -59,42 +62,39 @@ std::string MortonOrderFilter::getName() const { return s_info.name; }
 void MortonOrderFilter::addArgs(ProgramArgs& args)
 {
     args.add("reverse", "Reverse Morton", m_reverse, false);
+    args.add("curve", "Space-filling curve used to order points: "
+        "'morton' or 'hilbert'", m_curve, "morton");
+    args.add("threads", "Number of threads used to sort", m_threads, 1u);
 }
 
-//This used to be a lambda, but the VS compiler exploded, I guess.
-typedef std::pair<double, double> Coord;
-namespace
-{
-bool less_msb(const int& x, const int& y)
+void MortonOrderFilter::initialize()
 {
-    return x < y && x < (x ^ y);
+    m_curve = Utils::tolower(m_curve);
+    if (m_curve != "morton" && m_curve != "hilbert")
+        throwError("Invalid curve '" + m_curve + "'.  Must be 'morton' "
+            "or 'hilbert'.");
+    if (m_reverse && m_curve == "hilbert")
+        throwError("Option 'reverse' can only be used with the Morton "
+            "curve.");
 }
 
-class CmpZOrder
+namespace
 {
-public:
-    bool operator()(const Coord& c1, const Coord& c2) const
-    {
-        int a[2] = {(int)(c1.first * INT_MAX), (int)(c1.second * INT_MAX)};
-        int b[2] = {(int)(c2.first * INT_MAX), (int)(c2.second * INT_MAX)};
 
-        int j = 0;
-        int x = 0;
+// Make a view of the points of a view in the order of a list of codes.
+PointViewSet sorted(PointViewPtr inView, const radix::EntryList& codes)
+{
+    PointViewPtr outView = inView->makeNew();
+    for (const radix::Entry& e : codes)
+        outView->appendPoint(*inView, e.id);
 
-        for (int k = 0; k < 2; k++)
-        {
-            int y = a[k] ^ b[k];
-            if (less_msb(x, y))
-            {
-                j = k;
-                x = y;
-            }
-        }
-        return (a[j] - b[j]) < 0;
-    };
-};
+    PointViewSet viewSet;
+    viewSet.insert(outView);
+    return viewSet;
 }
 
+} // unnamed namespace
+
 class ReverseZOrder
 {
 public:
@@ -149,72 +149,55 @@ PointViewSet MortonOrderFilter::reverseMorton(PointViewPtr inView)
     const double cell_height = yrange / cell;
 
     // compute reverse morton code for each point
-    std::multimap<uint32_t, PointId> codes;
-    for (PointId idx = 0; idx < inView->size(); idx++)
-    {
-        const double x = inView->getFieldAs<double>(Dimension::Id::X, idx);
-        const int32_t xpos =
-            static_cast<int32_t>(std::floor((x - buffer_bounds.minx) /
-                cell_width));
-
-        const double y = inView->getFieldAs<double>(Dimension::Id::Y, idx);
-        const int32_t ypos =
-            static_cast<int32_t>(std::floor((y - buffer_bounds.miny) /
-                cell_height));
-
-        const uint32_t code = ReverseZOrder::encode_morton(xpos, ypos);
-        const uint32_t reverse = ReverseZOrder::reverse_morton( code );
-
-        codes.insert( std::pair<uint32_t, PointId>(reverse, idx) );
-    }
-
-    // a map is yet order by key so its naturally ordered by lod
-    std::multimap<uint32_t, PointId>::iterator it;
-    PointViewPtr outView = inView->makeNew();
-    for (it = codes.begin(); it != codes.end(); ++it)
-    {
-        outView->appendPoint(*inView, it->second);
-    }
-
-    // build output view
-    PointViewSet viewSet;
-    viewSet.insert(outView);
-
-    return viewSet;
+    DimAccessor<double> xAcc(*inView, Dimension::Id::X);
+    DimAccessor<double> yAcc(*inView, Dimension::Id::Y);
+    radix::EntryList codes = radix::makeEntries(inView->size(), m_threads,
+        [&](PointId idx)
+        {
+            const double x = xAcc.get(idx);
+            const int32_t xpos =
+                static_cast<int32_t>(std::floor((x - buffer_bounds.minx) /
+                    cell_width));
+
+            const double y = yAcc.get(idx);
+            const int32_t ypos =
+                static_cast<int32_t>(std::floor((y - buffer_bounds.miny) /
+                    cell_height));
+
+            const uint32_t code = ReverseZOrder::encode_morton(xpos, ypos);
+            return (uint64_t)ReverseZOrder::reverse_morton(code);
+        });
+
+    // a stable sort keeps points with the same code in input order
+    radix::sort(codes, m_threads);
+    return sorted(inView, codes);
 }
 
-PointViewSet MortonOrderFilter::morton(PointViewPtr inView)
+PointViewSet MortonOrderFilter::curve(PointViewPtr inView)
 {
-    PointViewSet viewSet;
     if (!inView->size())
-        return viewSet;
-    CmpZOrder compare;
-    std::multimap<Coord, PointId, CmpZOrder> sorted(compare);
+        return PointViewSet();
 
     BOX2D buffer_bounds;
     calculateBounds(*inView, buffer_bounds);
-    double xrange = buffer_bounds.maxx - buffer_bounds.minx;
-    double yrange = buffer_bounds.maxy - buffer_bounds.miny;
+    const double xrange = buffer_bounds.maxx - buffer_bounds.minx;
+    const double yrange = buffer_bounds.maxy - buffer_bounds.miny;
 
-    for (PointId idx = 0; idx < inView->size(); idx++)
-    {
-        double xpos = (inView->getFieldAs<double>(Dimension::Id::X, idx) -
-            buffer_bounds.minx) / xrange;
-        double ypos = (inView->getFieldAs<double>(Dimension::Id::Y, idx) -
-            buffer_bounds.miny) / yrange;
-        Coord loc(xpos, ypos);
-        sorted.insert(std::make_pair(loc, idx));
-    }
+    DimAccessor<double> xAcc(*inView, Dimension::Id::X);
+    DimAccessor<double> yAcc(*inView, Dimension::Id::Y);
+    const bool hilbert = (m_curve == "hilbert");
+    radix::EntryList codes = radix::makeEntries(inView->size(), m_threads,
+        [&](PointId idx)
+        {
+            using namespace spacecurve;
 
-    PointViewPtr outView = inView->makeNew();
-    std::multimap<Coord, PointId, CmpZOrder>::iterator pos;
-    for (pos = sorted.begin(); pos != sorted.end(); ++pos)
-    {
-        outView->appendPoint(*inView, pos->second);
-    }
-    viewSet.insert(outView);
+            uint32_t x = gridPos(xAcc.get(idx), buffer_bounds.minx, xrange);
+            uint32_t y = gridPos(yAcc.get(idx), buffer_bounds.miny, yrange);
+            return hilbert ? hilbertCode(x, y) : mortonCode(x, y);
+        });
 
-    return viewSet;
+    radix::sort(codes, m_threads);
+    return sorted(inView, codes);
 }
 
 PointViewSet MortonOrderFilter::run(PointViewPtr inView)
@@ -225,7 +208,7 @@ PointViewSet MortonOrderFilter::run(PointViewPtr inView)
     }
     else
     {
-        return morton( inView );
+        return curve( inView );
     }
 }
 
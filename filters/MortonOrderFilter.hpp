@@ -51,12 +51,15 @@ public:
 
 private:
     virtual void addArgs(ProgramArgs& args);
+    virtual void initialize();
     virtual PointViewSet run(PointViewPtr view);
 
     PointViewSet reverseMorton(PointViewPtr view);
-    PointViewSet morton(PointViewPtr view);
+    PointViewSet curve(PointViewPtr view);
 
     bool m_reverse = false;
+    std::string m_curve;
+    unsigned m_threads = 1;
 };
 
 } // namespace pdal
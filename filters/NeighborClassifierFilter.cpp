@@ -37,10 +37,13 @@
 #include <pdal/PipelineManager.hpp>
 #include <pdal/StageFactory.hpp>
 #include <pdal/util/ProgramArgs.hpp>
+#include <pdal/util/TaskScheduler.hpp>
 
 #include "private/DimRange.hpp"
 
+#include <algorithm>
 #include <iostream>
+#include <memory>
 #include <utility>
 namespace pdal
 {
@@ -68,6 +71,7 @@ void NeighborClassifierFilter::addArgs(ProgramArgs& args)
     args.add("k", "Number of nearest neighbors to consult",
         m_k).setPositional();
     args.add("candidate", "candidate file name", m_candidateFile);
+    args.add("threads", "Number of threads used to count votes", m_threads, 1);
 }
 
 void NeighborClassifierFilter::initialize()
@@ -88,6 +92,9 @@ void NeighborClassifierFilter::initialize()
     if (m_k < 1)
         throwError("Invalid 'k' option: " + std::to_string(m_k) +
             ", must be > 0");
+    if (m_threads < 1)
+        throwError("Invalid 'threads' option: " + std::to_string(m_threads) +
+            ", must be > 0");
 }
 
 
@@ -105,52 +112,63 @@ void NeighborClassifierFilter::prepared(PointTableRef table)
     std::sort(m_domain.begin(), m_domain.end());
 }
 
-void NeighborClassifierFilter::doOneNoDomain(PointRef &point, PointRef &temp,
-    KD3Index &kdi)
+// Find the value that wins the vote of the neighbors of a point.
+// Return true and set 'value' if it differs from the point's value.
+bool NeighborClassifierFilter::doOneNoDomain(PointRef &point, PointRef &temp,
+    const KD3Index &kdi, int& value) const
 {
-    PointIdList iSrc = kdi.neighbors(point, m_k);
+    PointIdList iSrc = kdi.neighbors(point.getFieldAs<double>(Dimension::Id::X),
+        point.getFieldAs<double>(Dimension::Id::Y),
+        point.getFieldAs<double>(Dimension::Id::Z), m_k);
     double thresh = iSrc.size()/2.0;
 
-    // vote NNs
-    using CountMap = std::map<int, unsigned int>;
-    CountMap counts;
-    //std::map<int, unsigned int> counts;
+    // vote NNs.  Sorting the votes puts equal values together.
+    std::vector<int> votes;
+    votes.reserve(iSrc.size());
     for (PointId id : iSrc)
     {
         temp.setPointId(id);
-        counts[temp.getFieldAs<int>(m_dim)]++;
+        votes.push_back(temp.getFieldAs<int>(m_dim));
     }
+    std::sort(votes.begin(), votes.end());
 
-    // pick winner of the vote
-    auto pr = *std::max_element(counts.begin(), counts.end(),
-        [](CountMap::const_reference p1, CountMap::const_reference p2)
-        { return p1.second < p2.second; });
+    // pick winner of the vote.  Ties go to the lowest value.
+    int newclass = 0;
+    size_t count = 0;
+    for (auto it = votes.begin(); it != votes.end();)
+    {
+        auto end = std::upper_bound(it, votes.end(), *it);
+        if ((size_t)(end - it) > count)
+        {
+            newclass = *it;
+            count = end - it;
+        }
+        it = end;
+    }
 
-    // update point
     auto oldclass = point.getFieldAs<double>(m_dim);
-    auto newclass = pr.first;
-    if (pr.second > thresh && oldclass != newclass)
+    if (count > thresh && oldclass != newclass)
     {
-        point.setField(m_dim, newclass);
+        value = newclass;
+        return true;
     }
+    return false;
 }
 
-// update point.  kdi and temp both reference the NN point cloud
+// find the new value of a point.  kdi and temp both reference the NN point
+// cloud
 bool NeighborClassifierFilter::doOne(PointRef& point, PointRef &temp,
-    KD3Index &kdi)
+    const KD3Index &kdi, int& value) const
 {
     if (m_domain.empty())  // No domain, process all points
-        doOneNoDomain(point, temp, kdi);
+        return doOneNoDomain(point, temp, kdi, value);
 
-    for (DimRange& r : m_domain)
+    for (const DimRange& r : m_domain)
     {   // process only points that satisfy a domain condition
         if (r.valuePasses(point.getFieldAs<double>(r.m_id)))
-        {
-            doOneNoDomain(point, temp, kdi);
-            break;
-        }
+            return doOneNoDomain(point, temp, kdi, value);
     }
-    return true;
+    return false;
 }
 
 
@@ -168,29 +186,40 @@ PointViewPtr NeighborClassifierFilter::loadSet(const std::string& filename,
 
 void NeighborClassifierFilter::filter(PointView& view)
 {
-    PointRef point_src(view, 0);
-    if (m_candidateFile.empty())
-    {   // No candidate file so NN comes from src file
-        KD3Index& kdiSrc = view.build3dIndex();
-        PointRef point_nn(view, 0);
-        for (PointId id = 0; id < view.size(); ++id)
-        {
-            point_src.setPointId(id);
-            doOne(point_src, point_nn, kdiSrc);
-        }
-    }
-    else
-    {   // NN comes from candidate file
-        PointTable candTable;
-        PointViewPtr candView = loadSet(m_candidateFile, candTable);
-        KD3Index& kdiCand = candView->build3dIndex();
-        PointRef point_nn(*candView, 0);
-        for (PointId id = 0; id < view.size(); ++id)
+    // NN comes from the candidate file if there is one, otherwise from src
+    // file.
+    PointTable candTable;
+    PointViewPtr candView;
+    if (!m_candidateFile.empty())
+        candView = loadSet(m_candidateFile, candTable);
+    PointView& nnView = candView ? *candView : view;
+    const KD3Index& kdi = nnView.build3dIndex();
+
+    // Votes are counted for chunks of points, on separate threads if
+    // requested.  New values are set once all votes are counted, so votes
+    // always use the original values.
+    typedef std::vector<std::pair<PointId, int>> UpdateList;
+    const size_t chunks = (size_t)m_threads;
+    std::vector<UpdateList> updates(chunks);
+    auto vote = [&](size_t chunk)
+    {
+        PointRef point_src(view, 0);
+        PointRef point_nn(nnView, 0);
+        const PointId end = view.size() * (chunk + 1) / chunks;
+        for (PointId id = view.size() * chunk / chunks; id < end; ++id)
         {
+            int value;
             point_src.setPointId(id);
-            doOne(point_src, point_nn, kdiCand);
+            if (doOne(point_src, point_nn, kdi, value))
+                updates[chunk].emplace_back(id, value);
         }
-    }
+    };
+
+    parallelFor(chunks, chunks, vote);
+
+    for (const UpdateList& list : updates)
+        for (const std::pair<PointId, int>& u : list)
+            view.setField(m_dim, u.first, u.second);
 }
 
 } // namespace pdal
@@ -58,10 +58,12 @@ public:
 private:
     virtual void addArgs(ProgramArgs& args);
     virtual void prepared(PointTableRef table);
-    bool doOne(PointRef& point, PointRef& temp, KD3Index &kdi);
+    bool doOne(PointRef& point, PointRef& temp, const KD3Index &kdi,
+        int& value) const;
     virtual void filter(PointView& view);
     virtual void initialize();
-    void doOneNoDomain(PointRef &point, PointRef& temp, KD3Index &kdi);
+    bool doOneNoDomain(PointRef &point, PointRef& temp, const KD3Index &kdi,
+        int& value) const;
     PointViewPtr loadSet(const std::string &candFileName, PointTable &table);
     NeighborClassifierFilter& operator=(const NeighborClassifierFilter&) = delete;
     NeighborClassifierFilter(const NeighborClassifierFilter&) = delete;
@@ -71,6 +73,7 @@ private:
     Dimension::Id m_dim;
     std::string m_dimName;
     std::string m_candidateFile;
+    int m_threads;
 };
 
 } // namespace pdal
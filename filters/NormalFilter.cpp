@@ -46,9 +46,11 @@
 #include <pdal/EigenUtils.hpp>
 #include <pdal/KDIndex.hpp>
 #include <pdal/util/ProgramArgs.hpp>
+#include <pdal/util/TaskScheduler.hpp>
 
 #include <Eigen/Dense>
 
+#include <atomic>
 #include <string>
 #include <vector>
 
@@ -67,12 +69,14 @@ CREATE_STATIC_STAGE(NormalFilter, s_info)
 struct NormalArgs
 {
     int m_knn;
+    double m_eps;
+    int m_threads;
     filter::Point m_viewpoint;
     bool m_up;
     bool m_refine;
 };
 
-NormalFilter::NormalFilter() : m_args(new NormalArgs), m_count(0) {}
+NormalFilter::NormalFilter() : m_args(new NormalArgs) {}
 
 NormalFilter::~NormalFilter() {}
 
@@ -91,6 +95,10 @@ void NormalFilter::addArgs(ProgramArgs& args)
     args.add("refine",
              "Refine normals using minimum spanning tree propagation?",
              m_args->m_refine, true);
+    args.add("knn_eps", "Approximation factor of the k-nearest neighbor "
+        "search.  0 finds the exact neighbors", m_args->m_eps, 0.0);
+    args.add("threads", "Number of threads used to run this filter",
+        m_args->m_threads, 1);
 }
 
 void NormalFilter::addDimensions(PointLayoutPtr layout)
@@ -112,6 +120,11 @@ void NormalFilter::doFilter(PointView& view, int knn)
 
 void NormalFilter::prepared(PointTableRef table)
 {
+    if (m_args->m_eps < 0)
+        throwError("Option 'knn_eps' can't be negative.");
+    m_metadata.add("knn_eps", m_args->m_eps, "Approximation factor of the "
+        "k-nearest neighbor search");
+
     if (m_args->m_up && m_viewpointArg->set())
     {
         log()->get(LogLevel::Warning)
@@ -124,80 +137,137 @@ void NormalFilter::prepared(PointTableRef table)
     ++m_args->m_knn;
 }
 
-void NormalFilter::compute(PointView& view, KD3Index& kdi)
+bool NormalFilter::reentrant() const
+{
+    return true;
+}
+
+// Compute the normal and curvature of a point from its neighborhood, which
+// includes the point itself.  'coords' holds the packed coordinates of the
+// indexed points.  Returns false if the eigen decomposition fails.
+bool NormalFilter::computeNormal(PointView& view, const double *coords,
+    PointId idx, const PointIdList& neighbors)
+{
+    // Perform eigen decomposition of covariance matrix computed from
+    // neighborhood composed of k-nearest neighbors.
+    auto B = computeCovariance(coords, neighbors.data(), neighbors.size());
+    Vector3d eval;
+    Matrix3d evec;
+    if (!computeEigen3(B, eval, evec))
+        return false;
+
+    // The curvature is computed as the ratio of the first (smallest)
+    // eigenvalue to the sum of all eigenvalues.
+    double sum = eval[0] + eval[1] + eval[2];
+    double curvature = sum ? std::fabs(eval[0] / sum) : 0;
+
+    // The normal is defined by the eigenvector corresponding to the
+    // smallest eigenvalue.
+    Vector3d normal = evec.col(0);
+
+    if (m_viewpointArg->set())
+    {
+        // If a viewpoint has been specified, orient the normals to face the
+        // viewpoint by taking the dot product of the vector connecting the
+        // point with the viewpoint and the normal. Flip the normal, where
+        // the dot product is negative.
+        double dx = m_args->m_viewpoint.x() -
+            view.getFieldAs<double>(Id::X, idx);
+        double dy = m_args->m_viewpoint.y() -
+            view.getFieldAs<double>(Id::Y, idx);
+        double dz = m_args->m_viewpoint.z() -
+            view.getFieldAs<double>(Id::Z, idx);
+        Vector3d vp(dx, dy, dz);
+        if (vp.dot(normal) < 0)
+            normal *= -1.0;
+    }
+    else if (m_args->m_up)
+    {
+        // If normals are expected to be upward facing, invert them when the
+        // Z component is negative.
+        if (normal[2] < 0)
+            normal *= -1.0;
+    }
+
+    // Set the computed normal and curvature dimensions.
+    view.setField(Id::NormalX, idx, normal[0]);
+    view.setField(Id::NormalY, idx, normal[1]);
+    view.setField(Id::NormalZ, idx, normal[2]);
+    view.setField(Id::Curvature, idx, curvature);
+    return true;
+}
+
+// Points are divided into a range per thread.  Each thread finds the
+// neighbors of its points a block at a time and reuses its buffers for
+// every point.  When the normals are to be refined, the neighbors of each
+// point (other than the point itself) are kept in 'graph', 'stride'
+// entries per point.
+void NormalFilter::compute(PointView& view, KD3Index& kdi,
+    PointIdList& graph, point_count_t& stride)
 {
     log()->get(LogLevel::Debug) << "Computing normal vectors\n";
-    for (auto&& p : view)
+
+    const point_count_t nloops = view.size();
+    const point_count_t k = (std::min)(nloops, (point_count_t)m_args->m_knn);
+    stride = k ? k - 1 : 0;
+    if (m_args->m_refine)
+        graph.resize(nloops * stride);
+
+    const double *coords = kdi.coords().data();
+    std::atomic<bool> failed(false);
+    auto run = [&](PointId start, PointId end)
     {
-        // Perform eigen decomposition of covariance matrix computed from
-        // neighborhood composed of k-nearest neighbors.
-        PointIdList neighbors = kdi.neighbors(p.pointId(), m_args->m_knn);
-        auto B = computeCovariance(view, neighbors);
-        SelfAdjointEigenSolver<Matrix3d> solver(B);
-        if (solver.info() != Success)
-            throwError("Cannot perform eigen decomposition.");
-
-        // The curvature is computed as the ratio of the first (smallest)
-        // eigenvalue to the sum of all eigenvalues.
-        auto eval = solver.eigenvalues();
-        double sum = eval[0] + eval[1] + eval[2];
-        double curvature = sum ? std::fabs(eval[0] / sum) : 0;
-
-        // The normal is defined by the eigenvector corresponding to the
-        // smallest eigenvalue.
-        Vector3d normal = solver.eigenvectors().col(0);
-
-        if (m_viewpointArg->set())
-        {
-            // If a viewpoint has been specified, orient the normals to face the
-            // viewpoint by taking the dot product of the vector connecting the
-            // point with the viewpoint and the normal. Flip the normal, where
-            // the dot product is negative.
-            double dx = m_args->m_viewpoint.x() - p.getFieldAs<double>(Id::X);
-            double dy = m_args->m_viewpoint.y() - p.getFieldAs<double>(Id::Y);
-            double dz = m_args->m_viewpoint.z() - p.getFieldAs<double>(Id::Z);
-            Vector3d vp(dx, dy, dz);
-            if (vp.dot(normal) < 0)
-                normal *= -1.0;
-        }
-        else if (m_args->m_up)
+        const point_count_t blockSize = 4096;
+        PointIdList neighbors;
+        for (PointId begin = start; begin < end && !failed; begin += blockSize)
         {
-            // If normals are expected to be upward facing, invert them when the
-            // Z component is negative.
-            if (normal[2] < 0)
-                normal *= -1.0;
+            PointId last = (std::min)(begin + blockSize, end);
+            KDNeighbors nbrs = kdi.knnRange(begin, last, k, 1, m_args->m_eps);
+            for (PointId i = begin; i < last; ++i)
+            {
+                const PointId *ids = nbrs.neighbors(i - begin);
+                neighbors.assign(ids, ids + nbrs.count(i - begin));
+                if (!computeNormal(view, coords, i, neighbors))
+                {
+                    failed = true;
+                    return;
+                }
+                if (m_args->m_refine && stride)
+                    std::copy(neighbors.begin() + 1, neighbors.end(),
+                        graph.begin() + i * stride);
+            }
         }
+    };
 
-        // Set the computed normal and curvature dimensions.
-        p.setField(Id::NormalX, normal[0]);
-        p.setField(Id::NormalY, normal[1]);
-        p.setField(Id::NormalZ, normal[2]);
-        p.setField(Id::Curvature, curvature);
-    }
+    const point_count_t threads = (std::max)(1, m_args->m_threads);
+    parallelFor(threads, threads, [&run, nloops, threads](std::size_t t)
+        { run(t * nloops / threads, (t + 1) * nloops / threads); });
+
+    if (failed)
+        throwError("Cannot perform eigen decomposition.");
 }
 
-void NormalFilter::update(
-    PointView& view, KD3Index& kdi, std::vector<bool> inMST,
-    std::priority_queue<Edge, EdgeList, CompareEdgeWeight> edge_queue,
-    PointId updateIdx)
+void NormalFilter::update(PointView& view, const PointIdList& graph,
+    point_count_t stride, std::vector<bool>& inMST,
+    std::priority_queue<Edge, EdgeList, CompareEdgeWeight>& edge_queue,
+    PointId updateIdx, point_count_t& count)
 {
     // Add the current PointId to the minimum spanning tree.
     inMST[updateIdx] = true;
-    ++m_count;
+    ++count;
 
     // Consider neighbors of the newly added PointId, adding them to
     // the edge queue if they are not already part of the minimum
-    // spanning tree. The first neighbor is the query point which is
-    // already part of the minimum spanning tree and can safely be
-    // skipped.
-    PointIdList neighbors = kdi.neighbors(updateIdx, m_args->m_knn);
-    neighbors.erase(neighbors.begin());
+    // spanning tree.  The neighbors were found when the normals were
+    // computed.
     PointRef p = view.point(updateIdx);
     Vector3d N0(p.getFieldAs<double>(Id::NormalX),
                 p.getFieldAs<double>(Id::NormalY),
                 p.getFieldAs<double>(Id::NormalZ));
-    for (PointId const& neighborIdx : neighbors)
+    auto begin = graph.begin() + updateIdx * stride;
+    for (auto it = begin; it != begin + stride; ++it)
     {
+        PointId neighborIdx = *it;
         if (!inMST[neighborIdx])
         {
             PointRef q = view.point(neighborIdx);
@@ -210,26 +280,30 @@ void NormalFilter::update(
     }
 }
 
-void NormalFilter::refine(PointView& view, KD3Index& kdi)
+// The propagation is sequential, but the neighbor queries it needs are made
+// by compute(), on all threads.
+void NormalFilter::refine(PointView& view, const PointIdList& graph,
+    point_count_t stride)
 {
     log()->get(LogLevel::Debug)
         << "Refining normals using minimum spanning tree\n";
 
     std::priority_queue<Edge, EdgeList, CompareEdgeWeight> edge_queue;
     std::vector<bool> inMST(view.size(), false);
+    point_count_t count(0);
     PointId nextIdx(0);
-    while (m_count < view.size())
+    while (count < view.size())
     {
         // Find the PointId of the next point not currently part of the minimum
         // spanning tree.
         while (inMST[nextIdx])
             ++nextIdx;
 
-        update(view, kdi, inMST, edge_queue, nextIdx);
+        update(view, graph, stride, inMST, edge_queue, nextIdx, count);
 
         // Iterate on the edge queue until empty (or all points have been added
         // to the minimum spanning tree).
-        while (!edge_queue.empty() && (m_count < view.size()))
+        while (!edge_queue.empty() && (count < view.size()))
         {
             // Retrieve the edge with the smallest weight.
             Edge edge(edge_queue.top());
@@ -270,7 +344,7 @@ void NormalFilter::refine(PointView& view, KD3Index& kdi)
                 view.setField(Id::NormalZ, newIdx, normal(2));
             }
 
-            update(view, kdi, inMST, edge_queue, newIdx);
+            update(view, graph, stride, inMST, edge_queue, newIdx, count);
         }
     }
 }
@@ -281,11 +355,13 @@ void NormalFilter::filter(PointView& view)
 
     // Compute the normal/curvature and optionally orient toward viewpoint or
     // positive Z.
-    compute(view, kdi);
+    PointIdList graph;
+    point_count_t stride;
+    compute(view, kdi, graph, stride);
 
     // If requested, refine normals through minimum spanning tree propagation.
     if (m_args->m_refine)
-        refine(view, kdi);
+        refine(view, graph, stride);
 }
 
 } // namespace pdal
@@ -85,20 +85,24 @@ public:
 
 private:
     std::unique_ptr<NormalArgs> m_args;
-    point_count_t m_count;
     Arg* m_viewpointArg;
 
-    void compute(PointView& view, KD3Index& kdi);
-    void refine(PointView& view, KD3Index& kdi);
-    void
-    update(PointView& view, KD3Index& kdi, std::vector<bool> inMST,
-           std::priority_queue<Edge, EdgeList, CompareEdgeWeight> edge_queue,
-           PointId updateIdx);
+    bool computeNormal(PointView& view, const double *coords, PointId idx,
+        const PointIdList& neighbors);
+    void compute(PointView& view, KD3Index& kdi, PointIdList& graph,
+        point_count_t& stride);
+    void refine(PointView& view, const PointIdList& graph,
+        point_count_t stride);
+    void update(PointView& view, const PointIdList& graph,
+        point_count_t stride, std::vector<bool>& inMST,
+        std::priority_queue<Edge, EdgeList, CompareEdgeWeight>& edge_queue,
+        PointId updateIdx, point_count_t& count);
 
     virtual void addArgs(ProgramArgs& args);
     virtual void addDimensions(PointLayoutPtr layout);
     virtual void prepared(PointTableRef table);
     virtual void filter(PointView& view);
+    virtual bool reentrant() const;
 };
 
 } // namespace pdal
@@ -33,7 +33,9 @@
  ****************************************************************************/
 
 #include "OutlierFilter.hpp"
+#include "private/NeighborWindow.hpp"
 
+#include <pdal/GridIndex.hpp>
 #include <pdal/KDIndex.hpp>
 #include <pdal/util/ProgramArgs.hpp>
 #include <pdal/util/Utils.hpp>
@@ -53,11 +55,33 @@ static StaticPluginInfo const s_info
 
 CREATE_STATIC_STAGE(OutlierFilter, s_info)
 
+OutlierFilter::OutlierFilter() : Filter()
+{}
+
+OutlierFilter::~OutlierFilter()
+{}
+
 std::string OutlierFilter::getName() const
 {
     return s_info.name;
 }
 
+// The statistical method needs the distances of all the points before any
+// can be classified, so only the radius method can be streamed.
+bool OutlierFilter::pipelineStreamable() const
+{
+    if (Utils::iequals(m_method, "statistical"))
+        return false;
+    return Streamable::pipelineStreamable();
+}
+
+const Stage *OutlierFilter::findNonstreamable() const
+{
+    if (Utils::iequals(m_method, "statistical"))
+        return this;
+    return Streamable::findNonstreamable();
+}
+
 void OutlierFilter::addArgs(ProgramArgs& args)
 {
     args.add("method", "Method [default: statistical]", m_method,
@@ -67,6 +91,17 @@ void OutlierFilter::addArgs(ProgramArgs& args)
     args.add("mean_k", "Mean number of neighbors", m_meanK, 8);
     args.add("multiplier", "Standard deviation threshold", m_multiplier, 2.0);
     args.add("class", "Class to use for noise points", m_class, ClassLabel::LowPoint);
+    args.add("index", "Index used for radius queries: 'kdtree' or 'grid'",
+        m_index, "kdtree");
+    args.add("halo", "Number of preceding points searched for neighbors "
+        "in stream mode", m_halo, point_count_t(100000));
+}
+
+void OutlierFilter::initialize()
+{
+    if (!Utils::iequals(m_index, "kdtree") && !Utils::iequals(m_index, "grid"))
+        throwError("Invalid index '" + m_index + "'.  Must be 'kdtree' or "
+            "'grid'.");
 }
 
 void OutlierFilter::addDimensions(PointLayoutPtr layout)
@@ -74,22 +109,54 @@ void OutlierFilter::addDimensions(PointLayoutPtr layout)
     layout->registerDim(Dimension::Id::Classification);
 }
 
-Indices OutlierFilter::processRadius(PointViewPtr inView)
+void OutlierFilter::ready(PointTableRef)
 {
-    KD3Index index(*inView);
-    index.build();
+    m_window.reset();
+}
 
+// The window is only needed in stream mode, so it's created when the first
+// point is streamed.
+NeighborWindow& OutlierFilter::window()
+{
+    if (!m_window)
+        m_window.reset(new NeighborWindow(m_radius, m_halo));
+    return *m_window;
+}
+
+Indices OutlierFilter::processRadius(PointViewPtr inView)
+{
     point_count_t np = inView->size();
 
     PointIdList inliers, outliers;
 
-    for (PointId i = 0; i < np; ++i)
+    auto classify = [&](PointId begin,
+        const std::vector<point_count_t>& counts)
     {
-        auto ids = index.radius(i, m_radius);
-        if (ids.size() > size_t(m_minK))
-            inliers.push_back(i);
-        else
-            outliers.push_back(i);
+        for (PointId i = begin; i < begin + counts.size(); ++i)
+        {
+            if (counts[i - begin] > size_t(m_minK))
+                inliers.push_back(i);
+            else
+                outliers.push_back(i);
+        }
+    };
+
+    // Points are queried in blocks to bound the memory used by the results.
+    const point_count_t blockSize = 65536;
+    if (Utils::iequals(m_index, "grid"))
+    {
+        GridIndex index(*inView, m_radius);
+        index.build();
+        for (PointId begin = 0; begin < np; begin += blockSize)
+            classify(begin, index.radiusCountRange(begin, begin + blockSize,
+                m_radius));
+    }
+    else
+    {
+        KD3Index& index = inView->build3dIndex();
+        for (PointId begin = 0; begin < np; begin += blockSize)
+            classify(begin, index.radiusCountRange(begin, begin + blockSize,
+                m_radius));
     }
 
     return Indices{inliers, outliers};
@@ -97,8 +164,7 @@ Indices OutlierFilter::processRadius(PointViewPtr inView)
 
 Indices OutlierFilter::processStatistical(PointViewPtr inView)
 {
-    KD3Index index(*inView);
-    index.build();
+    KD3Index& index = inView->build3dIndex();
 
     point_count_t np = inView->size();
 
@@ -109,20 +175,25 @@ Indices OutlierFilter::processStatistical(PointViewPtr inView)
     // we increase the count by one because the query point itself will
     // be included with a distance of 0
     point_count_t count = m_meanK + 1;
-    PointIdList indices(count);
-    std::vector<double> sqr_dists(count);
-    for (PointId i = 0; i < np; ++i)
-    {
 
-        index.knnSearch(i, count, &indices, &sqr_dists);
-
-        for (size_t j = 1; j < count; ++j)
+    // Points are queried in blocks to bound the memory used by the results.
+    const point_count_t blockSize = 65536;
+    for (PointId begin = 0; begin < np; begin += blockSize)
+    {
+        KDNeighbors nbrs = index.knnRange(begin, begin + blockSize, count);
+        for (PointId i = begin; i < begin + nbrs.size(); ++i)
         {
-            double delta = std::sqrt(sqr_dists[j]) - distances[i];
-            distances[i] += (delta / j);
+            // When there are fewer points than neighbors requested, the
+            // missing neighbors count as a distance of 0.
+            const double *sqrDists = nbrs.distances(i - begin);
+            const size_t found = nbrs.count(i - begin);
+            for (size_t j = 1; j < count; ++j)
+            {
+                double d = (j < found) ? std::sqrt(sqrDists[j]) : 0.0;
+                double delta = d - distances[i];
+                distances[i] += (delta / j);
+            }
         }
-        indices.clear(); indices.resize(count);
-        sqr_dists.clear(); sqr_dists.resize(count);
     }
 
     size_t n(0);
@@ -211,4 +282,61 @@ PointViewSet OutlierFilter::run(PointViewPtr inView)
     return viewSet;
 }
 
+bool OutlierFilter::processOne(PointRef& point)
+{
+    using namespace Dimension;
+
+    if (!Utils::iequals(m_method, "radius"))
+        return true;
+
+    double x = point.getFieldAs<double>(Id::X);
+    double y = point.getFieldAs<double>(Id::Y);
+    double z = point.getFieldAs<double>(Id::Z);
+    NeighborWindow& win = window();
+    win.add(x, y, z);
+    if (win.count(x, y, z) <= size_t(m_minK))
+        point.setField(Id::Classification, m_class);
+    win.trim();
+    return true;
+}
+
+// In stream mode, the neighbors of a point are searched for among the
+// points of its batch and the points kept from earlier batches.  All the
+// points of a batch are added to the window before any are queried.
+// Unlike standard mode, points are classified even if every point turns
+// out to be an outlier.
+point_count_t OutlierFilter::processBatch(StreamPointTable& table,
+    PointId begin, point_count_t count)
+{
+    using namespace Dimension;
+
+    if (!Utils::iequals(m_method, "radius"))
+        return count;
+
+    NeighborWindow& win = window();
+    PointRef point(table, begin);
+    for (PointId idx : table.activeIds(begin, count))
+    {
+        point.setPointId(idx);
+        win.add(point.getFieldAs<double>(Id::X),
+            point.getFieldAs<double>(Id::Y), point.getFieldAs<double>(Id::Z));
+    }
+
+    for (PointId idx : table.activeIds(begin, count))
+    {
+        point.setPointId(idx);
+        point_count_t n = win.count(point.getFieldAs<double>(Id::X),
+            point.getFieldAs<double>(Id::Y), point.getFieldAs<double>(Id::Z));
+        if (n <= size_t(m_minK))
+            point.setField(Id::Classification, m_class);
+    }
+    win.trim();
+    return count;
+}
+
+void OutlierFilter::done(PointTableRef)
+{
+    m_window.reset();
+}
+
 } // namespace pdal
@@ -35,6 +35,7 @@
 #pragma once
 
 #include <pdal/Filter.hpp>
+#include <pdal/Streamable.hpp>
 
 #include <map>
 #include <memory>
@@ -43,6 +44,7 @@
 namespace pdal
 {
 
+class NeighborWindow;
 class Options;
 
 struct Indices
@@ -51,28 +53,41 @@ struct Indices
     PointIdList outliers;
 };
 
-class PDAL_DLL OutlierFilter : public pdal::Filter
+class PDAL_DLL OutlierFilter : public pdal::Filter, public Streamable
 {
 public:
-    OutlierFilter() : Filter()
-    {
-    }
+    OutlierFilter();
+    ~OutlierFilter();
 
     std::string getName() const;
+    virtual bool pipelineStreamable() const;
+    virtual const Stage *findNonstreamable() const;
 
 private:
     std::string m_method;
+    std::string m_index;
     int m_minK;
     double m_radius;
     int m_meanK;
     double m_multiplier;
     uint8_t m_class;
+    point_count_t m_halo;
+    std::unique_ptr<NeighborWindow> m_window;
 
     virtual void addDimensions(PointLayoutPtr layout);
     virtual void addArgs(ProgramArgs& args);
+    virtual void initialize();
+    virtual void ready(PointTableRef table);
     Indices processRadius(PointViewPtr inView);
     Indices processStatistical(PointViewPtr inView);
     virtual PointViewSet run(PointViewPtr view);
+    virtual bool processOne(PointRef& point);
+    virtual point_count_t processBatch(StreamPointTable& table, PointId begin,
+        point_count_t count);
+    virtual void done(PointTableRef table);
+    NeighborWindow& window();
+    virtual bool reentrant() const
+        { return true; }
 
     OutlierFilter& operator=(const OutlierFilter&); // not implemented
     OutlierFilter(const OutlierFilter&);            // not implemented
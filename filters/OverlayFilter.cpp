@@ -34,6 +34,10 @@
 
 #include "OverlayFilter.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
 #include <vector>
 
 #include <pdal/GDALUtils.hpp>
@@ -64,6 +68,8 @@ void OverlayFilter::addArgs(ProgramArgs& args)
     args.add("query", "OGR SQL query to execute on the "
         "datasource to fetch geometry and attributes", m_query);
     args.add("layer", "Datasource layer to use", m_layer);
+    args.add("union", "Merge polygons that share an attribute value before "
+        "testing points", m_union);
 }
 
 
@@ -114,17 +120,135 @@ void OverlayFilter::ready(PointTableRef table)
             throwError("No column name '" + m_column + "' was found.");
     }
 
-    do
+    // When merging, the parts of all features with the same value are
+    // collected into a single multipolygon, in order of first appearance.
+    std::map<int32_t, size_t> groupIndex;
+    std::vector<std::pair<OGRGeometryH, int32_t>> groups;
+    while (feature)
     {
         OGRGeometryH geom = OGR_F_GetGeometryRef(feature.get());
         int32_t fieldVal = OGR_F_GetFieldAsInteger(feature.get(), field_index);
 
-        m_polygons.push_back(
-            { Polygon(geom, table.anySpatialReference()), fieldVal} );
+        if (geom && m_union)
+        {
+            auto it = groupIndex.find(fieldVal);
+            if (it == groupIndex.end())
+            {
+                it = groupIndex.insert({fieldVal, groups.size()}).first;
+                groups.push_back(
+                    { OGR_G_CreateGeometry(wkbMultiPolygon), fieldVal });
+            }
+            OGRGeometryH multi = groups[it->second].first;
+            if (wkbFlatten(OGR_G_GetGeometryType(geom)) == wkbMultiPolygon)
+                for (int i = 0; i < OGR_G_GetGeometryCount(geom); ++i)
+                    OGR_G_AddGeometry(multi, OGR_G_GetGeometryRef(geom, i));
+            else
+                OGR_G_AddGeometry(multi, geom);
+        }
+        else if (geom)
+            m_polygons.push_back(
+                { Polygon(geom, table.anySpatialReference()), fieldVal } );
 
         feature = OGRFeaturePtr(OGR_L_GetNextFeature(m_lyr), featureDeleter);
     }
-    while (feature);
+
+    for (auto& g : groups)
+    {
+        // The cascaded union needs GEOS.  Without it (or if the result
+        // isn't areal) the collection of parts is used as is, which
+        // covers the same points.
+        OGRGeometryH geom = OGR_G_UnionCascaded(g.first);
+        if (geom)
+        {
+            OGRwkbGeometryType t = wkbFlatten(OGR_G_GetGeometryType(geom));
+            if (t != wkbPolygon && t != wkbMultiPolygon)
+            {
+                OGR_G_DestroyGeometry(geom);
+                geom = nullptr;
+            }
+        }
+        try
+        {
+            m_polygons.push_back(
+                { Polygon(geom ? geom : g.first, table.anySpatialReference()),
+                    g.second } );
+        }
+        catch (pdal_error& err)
+        {
+            for (auto& other : groups)
+                OGR_G_DestroyGeometry(other.first);
+            if (geom)
+                OGR_G_DestroyGeometry(geom);
+            throwError(err.what());
+        }
+        if (geom)
+            OGR_G_DestroyGeometry(geom);
+    }
+    for (auto& g : groups)
+        OGR_G_DestroyGeometry(g.first);
+
+    buildIndex();
+}
+
+
+void OverlayFilter::buildIndex()
+{
+    m_bounds.clear();
+    for (auto& poly : m_polygons)
+    {
+        poly.bounds = poly.geom.bounds().to2d();
+        m_bounds.grow(poly.bounds);
+    }
+
+    m_cells.clear();
+    m_large.clear();
+    m_cols = 0;
+    m_rows = 0;
+    if (m_polygons.empty())
+        return;
+
+    // Aim for about one cell per polygon, with square-ish cells.
+    double width = (std::max)(m_bounds.maxx - m_bounds.minx,
+        std::numeric_limits<double>::min());
+    double height = (std::max)(m_bounds.maxy - m_bounds.miny,
+        std::numeric_limits<double>::min());
+    double n = (double)m_polygons.size();
+    m_cols = (size_t)(std::max)(1.0,
+        (std::min)(n, std::ceil(std::sqrt(n * width / height))));
+    m_rows = (size_t)(std::max)(1.0,
+        (std::min)(n, std::ceil(n / (double)m_cols)));
+    m_cellWidth = width / m_cols;
+    m_cellHeight = height / m_rows;
+    m_cells.resize(m_cols * m_rows);
+
+    const size_t maxCells = (std::max)((size_t)16, m_cells.size() / 16);
+    auto col = [this](double x)
+    {
+        double c = std::floor((x - m_bounds.minx) / m_cellWidth);
+        return (size_t)(std::min)((std::max)(c, 0.0), (double)(m_cols - 1));
+    };
+    auto row = [this](double y)
+    {
+        double r = std::floor((y - m_bounds.miny) / m_cellHeight);
+        return (size_t)(std::min)((std::max)(r, 0.0), (double)(m_rows - 1));
+    };
+
+    for (uint32_t i = 0; i < m_polygons.size(); ++i)
+    {
+        const BOX2D& b = m_polygons[i].bounds;
+        size_t c0 = col(b.minx);
+        size_t c1 = col(b.maxx);
+        size_t r0 = row(b.miny);
+        size_t r1 = row(b.maxy);
+        if ((c1 - c0 + 1) * (r1 - r0 + 1) > maxCells)
+        {
+            m_large.push_back(i);
+            continue;
+        }
+        for (size_t r = r0; r <= r1; ++r)
+            for (size_t c = c0; c <= c1; ++c)
+                m_cells[r * m_cols + c].push_back(i);
+    }
 }
 
 
@@ -143,18 +267,50 @@ void OverlayFilter::spatialReferenceChanged(const SpatialReference& srs)
             throwError(err.what());
         }
     }
+    buildIndex();
 }
 
 
 bool OverlayFilter::processOne(PointRef& point)
 {
-    for (const auto& poly : m_polygons)
+    if (m_polygons.empty())
+        return true;
+
+    double x = point.getFieldAs<double>(Dimension::Id::X);
+    double y = point.getFieldAs<double>(Dimension::Id::Y);
+    if (!m_bounds.contains(x, y))
+        return true;
+
+    // When polygons overlap, the last one in the datasource wins, so
+    // candidates are tested from highest index down.
+    auto hit = [this, x, y](uint32_t i)
     {
-        double x = point.getFieldAs<double>(Dimension::Id::X);
-        double y = point.getFieldAs<double>(Dimension::Id::Y);
-        if (poly.geom.contains(x, y))
-            point.setField(m_dim, poly.val);
-    }
+        const PolyVal& poly = m_polygons[i];
+        return poly.bounds.contains(x, y) && poly.geom.contains(x, y);
+    };
+
+    size_t c = (size_t)((x - m_bounds.minx) / m_cellWidth);
+    size_t r = (size_t)((y - m_bounds.miny) / m_cellHeight);
+    c = (std::min)(c, m_cols - 1);
+    r = (std::min)(r, m_rows - 1);
+    const std::vector<uint32_t>& cell = m_cells[r * m_cols + c];
+
+    int64_t best = -1;
+    for (auto it = cell.rbegin(); it != cell.rend(); ++it)
+        if (hit(*it))
+        {
+            best = *it;
+            break;
+        }
+    for (auto it = m_large.rbegin(); it != m_large.rend() && *it > best; ++it)
+        if (hit(*it))
+        {
+            best = *it;
+            break;
+        }
+
+    if (best >= 0)
+        point.setField(m_dim, m_polygons[(size_t)best].val);
     return true;
 }
 
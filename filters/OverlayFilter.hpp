@@ -37,10 +37,12 @@
 #include <pdal/Filter.hpp>
 #include <pdal/Polygon.hpp>
 #include <pdal/Streamable.hpp>
+#include <pdal/util/Bounds.hpp>
 
 #include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 typedef void *OGRLayerH;
 
@@ -64,10 +66,11 @@ class PDAL_DLL OverlayFilter : public Filter, public Streamable
     {
         Polygon geom;
         int32_t val;
+        BOX2D bounds;
     };
 
 public:
-    OverlayFilter() : m_ds(0), m_lyr(0)
+    OverlayFilter() : m_ds(0), m_lyr(0), m_union(false), m_cols(0), m_rows(0)
     {}
 
     std::string getName() const { return "filters.overlay"; }
@@ -81,6 +84,8 @@ private:
     virtual void ready(PointTableRef table);
     virtual void filter(PointView& view);
 
+    void buildIndex();
+
     OverlayFilter& operator=(const OverlayFilter&) = delete;
     OverlayFilter(const OverlayFilter&) = delete;
 
@@ -93,8 +98,20 @@ private:
     std::string m_column;
     std::string m_query;
     std::string m_layer;
+    bool m_union;
     Dimension::Id m_dim;
     std::vector<PolyVal> m_polygons;
+
+    // Polygon index.  Each grid cell lists, in ascending order, the
+    // polygons whose bounds intersect it.  Polygons that would be entered
+    // into too many cells are kept in m_large and tested for every point.
+    BOX2D m_bounds;
+    double m_cellWidth;
+    double m_cellHeight;
+    size_t m_cols;
+    size_t m_rows;
+    std::vector<std::vector<uint32_t>> m_cells;
+    std::vector<uint32_t> m_large;
 };
 
 } // namespace pdal
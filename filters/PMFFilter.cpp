@@ -44,6 +44,7 @@
 #include <pdal/util/ProgramArgs.hpp>
 
 #include "private/DimRange.hpp"
+#include "private/GroundTiles.hpp"
 #include "private/Segmentation.hpp"
 
 namespace pdal
@@ -63,6 +64,7 @@ struct PMFArgs
     double m_maxDistance;
     double m_maxWindowSize;
     double m_slope;
+    GroundTiles m_tiles;
 };
 
 CREATE_STATIC_STAGE(PMFFilter, s_info)
@@ -90,6 +92,7 @@ void PMFFilter::addArgs(ProgramArgs& args)
     args.add("max_window_size", "Maximum window size", m_args->m_maxWindowSize,
              33.0);
     args.add("slope", "Slope", m_args->m_slope, 1.0);
+    m_args->m_tiles.addArgs(args);
 }
 
 void PMFFilter::addDimensions(PointLayoutPtr layout)
@@ -203,8 +206,15 @@ PointViewSet PMFFilter::run(PointViewPtr input)
         inlierView->setField(Dimension::Id::Classification, i,
                              ClassLabel::Unclassified);
 
-    // Run the actual PMF algorithm.
-    processGround(inlierView);
+    // Run the actual PMF algorithm, by tile if requested.
+    m_args->m_tiles.classify(inlierView, m_args->m_maxWindowSize, log(),
+        [this](PointViewPtr tile, LogPtr log)
+        {
+            PMFFilter worker;
+            *worker.m_args = *m_args;
+            worker.setLog(log);
+            worker.processGround(tile);
+        });
 
     // Prepare the output PointView.
     PointViewPtr outView = input->makeNew();
@@ -336,8 +346,8 @@ void PMFFilter::processGround(PointViewPtr view)
             << ", window size = " << wsvec[j] << ")...\n";
 
         int iters = static_cast<int>(0.5 * (wsvec[j] - 1));
-        std::vector<double> me = erodeDiamond(ZImin, rows, cols, iters);
-        std::vector<double> mo = dilateDiamond(me, rows, cols, iters);
+        std::vector<double> me = erodeDiamondFast(ZImin, rows, cols, iters);
+        std::vector<double> mo = dilateDiamondFast(me, rows, cols, iters);
 
         PointIdList groundNewIdx;
         for (auto p_idx : groundIdx)
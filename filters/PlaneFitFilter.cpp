@@ -42,11 +42,11 @@
 #include <pdal/EigenUtils.hpp>
 #include <pdal/KDIndex.hpp>
 #include <pdal/util/ProgramArgs.hpp>
+#include <pdal/util/TaskScheduler.hpp>
 
 #include <Eigen/Dense>
 
 #include <string>
-#include <thread>
 #include <vector>
 
 namespace pdal
@@ -85,20 +85,14 @@ void PlaneFitFilter::filter(PointView& view)
 {
     KD3Index& kdi = view.build3dIndex();
 
-    point_count_t nloops = view.size();
-    std::vector<std::thread> threadList(m_threads);
-    for (int t = 0; t < m_threads; t++)
+    const point_count_t nloops = view.size();
+    const point_count_t threads = (std::max)(1, m_threads);
+    parallelFor(threads, threads, [&](std::size_t t)
     {
-        threadList[t] = std::thread(std::bind(
-            [&](const PointId start, const PointId end) {
-                for (PointId i = start; i < end; i++)
-                    setPlaneFit(view, i, kdi);
-            },
-            t * nloops / m_threads,
-            (t + 1) == m_threads ? nloops : (t + 1) * nloops / m_threads));
-    }
-    for (auto& t : threadList)
-        t.join();
+        const PointId end = (t + 1) * nloops / threads;
+        for (PointId i = t * nloops / threads; i < end; i++)
+            setPlaneFit(view, i, kdi);
+    });
 }
 
 double PlaneFitFilter::absDistance(PointView& view, const PointId& i,
@@ -123,20 +117,20 @@ void PlaneFitFilter::setPlaneFit(PointView& view, const PointId& i,
     // Normal based only on neighbors, so exclude first point.
     PointIdList neighbors(ni.begin() + 1, ni.end());
 
-    // Covariance and normal are based off demeaned coordinates, so we record
-    // the centroid to properly offset the coordinates when computing point to
-    // plance distance.
-    auto centroid = computeCentroid(view, neighbors);
-
-    // Compute covariance of the neighbors.
-    auto B = computeCovariance(view, neighbors);
+    // Compute covariance of the neighbors.  Covariance and normal are based
+    // off demeaned coordinates, so we record the centroid to properly offset
+    // the coordinates when computing point to plance distance.
+    Eigen::Vector3d centroid;
+    auto B = computeCovariance(kdi.coords().data(), neighbors.data(),
+        neighbors.size(), &centroid);
 
     // Perform the eigen decomposition, using the eigenvector of the smallest
     // eigenvalue as the normal.
-    Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> solver(B);
-    if (solver.info() != Eigen::Success)
+    Eigen::Vector3d values;
+    Eigen::Matrix3d vectors;
+    if (!computeEigen3(B, values, vectors))
         throwError("Cannot perform eigen decomposition.");
-    Eigen::Vector3d normal = solver.eigenvectors().col(0);
+    Eigen::Vector3d normal = vectors.col(0);
 
     // Compute point to plane distance of the query point.
     double d = absDistance(view, i, centroid, normal);
@@ -39,6 +39,8 @@
 #include <kazhdan/PoissonRecon.h>
 #include <kazhdan/point_source/PointSource.h>
 
+#include <mutex>
+
 // Note: For testing, download the eagle set here:
 // https://www.cs.jhu.edu/~misha/Code/PoissonRecon/Version8.0/
 // or here:
@@ -169,9 +171,11 @@ public:
         return static_cast<int>(cnt);
     }
 
+    // Polygons are added from all the solver's threads at once.
     virtual void newPolygon(std::vector<int>& poly)
     {
         assert(poly.size() == 3);
+        std::lock_guard<std::mutex> lock(m_mutex);
         m_mesh.add(poly[0], poly[1], poly[2]);
     }
 
@@ -226,6 +230,7 @@ private:
     size_t m_polyIdx;
     size_t m_pointIdx;
     bool m_doColor;
+    std::mutex m_mutex;
 };
 
 static StaticPluginInfo const s_info
@@ -265,6 +270,29 @@ void PoissonFilter::addArgs(ProgramArgs& args)
     args.add("density", "Output density estimates", m_density);
     args.add("depth", "Maximum depth of the octree used for reconstruction",
         m_depth, 8);
+    args.add("full_depth", "Depth up to which the octree is complete, "
+        "whether or not there are points", m_fullDepth, 5);
+    args.add("threads", "Number of threads used to run this filter",
+        m_threads, 1);
+}
+
+
+void PoissonFilter::initialize()
+{
+    if (m_depth < 2)
+        throwError("Option 'depth' must be at least 2.");
+    if (m_fullDepth < 0 || m_fullDepth > m_depth)
+        throwError("Option 'full_depth' must be between 0 and 'depth'.");
+    if (m_threads < 1)
+        throwError("Option 'threads' must be at least 1.");
+#ifndef _OPENMP
+    if (m_threads > 1)
+    {
+        log()->get(LogLevel::Warning) << getName() << ": PDAL was built "
+            "without OpenMP.  Running on a single thread.\n";
+        m_threads = 1;
+    }
+#endif
 }
 
 
@@ -285,6 +313,8 @@ PointViewSet PoissonFilter::run(PointViewPtr view)
     opts.m_density = m_density;
     opts.m_solveDepth = m_depth;
     opts.m_kernelDepth = m_depth - 2;
+    opts.m_fullDepth = m_fullDepth;
+    opts.m_threads = m_threads;
     if (m_doColor)
     {
         opts.m_color = 16;
@@ -295,6 +325,17 @@ PointViewSet PoissonFilter::run(PointViewPtr view)
     recon.execute();
     recon.evaluate();
 
+    m_metadata.addOrUpdate("depth", opts.m_depth, "Maximum depth of the "
+        "octree");
+    m_metadata.addOrUpdate("full_depth", opts.m_fullDepth, "Depth up to "
+        "which the octree is complete");
+    m_metadata.addOrUpdate("solve_depth", opts.m_solveDepth, "Maximum "
+        "depth at which the system is solved");
+    m_metadata.addOrUpdate("kernel_depth", opts.m_kernelDepth, "Depth used "
+        "to estimate point density");
+    m_metadata.addOrUpdate("threads", opts.m_threads, "Number of threads "
+        "used by the reconstruction");
+
     PointViewSet s;
     PointViewPtr outView = view->makeNew();
     s.insert(outView);
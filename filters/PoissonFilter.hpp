@@ -52,10 +52,13 @@ public:
 private:
     bool m_density;
     int m_depth;
+    int m_fullDepth;
+    int m_threads;
     bool m_normalsProvided;
     bool m_doColor;
 
     virtual void addDimensions(PointLayoutPtr layout);
+    virtual void initialize();
     virtual PointViewSet run(PointViewPtr view);
     virtual void addArgs(ProgramArgs& args);
 };
@@ -33,8 +33,12 @@
 ****************************************************************************/
 
 #include "RadialDensityFilter.hpp"
+#include "private/NeighborWindow.hpp"
 
+#include <pdal/GridIndex.hpp>
 #include <pdal/KDIndex.hpp>
+#include <pdal/util/ProgramArgs.hpp>
+#include <pdal/util/Utils.hpp>
 
 #include <string>
 #include <vector>
@@ -51,6 +55,14 @@ static StaticPluginInfo const s_info
 
 CREATE_STATIC_STAGE(RadialDensityFilter, s_info)
 
+RadialDensityFilter::RadialDensityFilter() : Filter()
+{}
+
+
+RadialDensityFilter::~RadialDensityFilter()
+{}
+
+
 std::string RadialDensityFilter::getName() const
 {
     return s_info.name;
@@ -59,6 +71,22 @@ std::string RadialDensityFilter::getName() const
 void RadialDensityFilter::addArgs(ProgramArgs& args)
 {
     args.add("radius", "Radius", m_rad, 1.0);
+    args.add("index", "Index used for radius queries: 'kdtree' or 'grid'",
+        m_index, "kdtree");
+    args.add("halo", "Number of preceding points searched for neighbors "
+        "in stream mode", m_halo, point_count_t(100000));
+    args.add("threads", "Number of threads used to count neighbors",
+        m_threads, 1);
+}
+
+
+void RadialDensityFilter::initialize()
+{
+    if (!Utils::iequals(m_index, "kdtree") && !Utils::iequals(m_index, "grid"))
+        throwError("Invalid index '" + m_index + "'.  Must be 'kdtree' or "
+            "'grid'.");
+    if (m_threads < 1)
+        throwError("Option 'threads' must be at least 1.");
 }
 
 void RadialDensityFilter::addDimensions(PointLayoutPtr layout)
@@ -67,23 +95,98 @@ void RadialDensityFilter::addDimensions(PointLayoutPtr layout)
     m_rdens = layout->registerOrAssignDim("RadialDensity", Type::Double);
 }
 
-void RadialDensityFilter::filter(PointView& view)
+void RadialDensityFilter::ready(PointTableRef)
 {
-    using namespace Dimension;
+    m_window.reset();
+}
 
-    // Build the 3D KD-tree.
-    KD3Index& index = view.build3dIndex();
+// The window is only needed in stream mode, so it's created when the first
+// point is streamed.
+NeighborWindow& RadialDensityFilter::window()
+{
+    if (!m_window)
+        m_window.reset(new NeighborWindow(m_rad, m_halo));
+    return *m_window;
+}
+
+// The number of neighbors (which includes the query point) is normalized by
+// the volume of the search sphere and recorded as the density.
+double RadialDensityFilter::factor() const
+{
+    return 1.0 / ((4.0 / 3.0) * 3.14159 * (m_rad * m_rad * m_rad));
+}
 
-    // Search for neighboring points within the specified radius. The number of
-    // neighbors (which includes the query point) is normalized by the volume
-    // of the search sphere and recorded as the density.
+// Only the number of neighbors of each point is needed, so the neighbors
+// are counted without being collected.
+void RadialDensityFilter::filter(PointView& view)
+{
+    std::vector<point_count_t> counts;
     log()->get(LogLevel::Debug) << "Computing densities...\n";
-    double factor = 1.0 / ((4.0 / 3.0) * 3.14159 * (m_rad * m_rad * m_rad));
+    if (Utils::iequals(m_index, "grid"))
+    {
+        // Build the grid index, with cells the size of the search radius.
+        GridIndex index(view, m_rad);
+        index.build();
+        counts = index.radiusCountRange(0, view.size(), m_rad, m_threads);
+    }
+    else
+    {
+        // Build the 3D KD-tree.
+        KD3Index& index = view.build3dIndex();
+        counts = index.radiusCountRange(0, view.size(), m_rad, m_threads);
+    }
+
+    const double factor = this->factor();
     for (PointId i = 0; i < view.size(); ++i)
+        view.setField(m_rdens, i, counts[i] * factor);
+}
+
+bool RadialDensityFilter::processOne(PointRef& point)
+{
+    using namespace Dimension;
+
+    double x = point.getFieldAs<double>(Id::X);
+    double y = point.getFieldAs<double>(Id::Y);
+    double z = point.getFieldAs<double>(Id::Z);
+    NeighborWindow& win = window();
+    win.add(x, y, z);
+    point.setField(m_rdens, win.count(x, y, z) * factor());
+    win.trim();
+    return true;
+}
+
+// In stream mode, the neighbors of a point are searched for among the
+// points of its batch and the points kept from earlier batches.  All the
+// points of a batch are added to the window before any are queried.
+point_count_t RadialDensityFilter::processBatch(StreamPointTable& table,
+    PointId begin, point_count_t count)
+{
+    using namespace Dimension;
+
+    NeighborWindow& win = window();
+    PointRef point(table, begin);
+    for (PointId idx : table.activeIds(begin, count))
     {
-        PointIdList pts = index.radius(i, m_rad);
-        view.setField(m_rdens, i, pts.size() * factor);
+        point.setPointId(idx);
+        win.add(point.getFieldAs<double>(Id::X),
+            point.getFieldAs<double>(Id::Y), point.getFieldAs<double>(Id::Z));
     }
+
+    const double factor = this->factor();
+    for (PointId idx : table.activeIds(begin, count))
+    {
+        point.setPointId(idx);
+        point_count_t n = win.count(point.getFieldAs<double>(Id::X),
+            point.getFieldAs<double>(Id::Y), point.getFieldAs<double>(Id::Z));
+        point.setField(m_rdens, n * factor);
+    }
+    win.trim();
+    return count;
+}
+
+void RadialDensityFilter::done(PointTableRef)
+{
+    m_window.reset();
 }
 
 } // namespace pdal
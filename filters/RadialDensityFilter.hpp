@@ -35,31 +35,45 @@
 #pragma once
 
 #include <pdal/Filter.hpp>
+#include <pdal/Streamable.hpp>
 
 #include <memory>
 
 namespace pdal
 {
 
+class NeighborWindow;
 class PointLayout;
 class PointView;
 class ProgramArgs;
 
-class PDAL_DLL RadialDensityFilter : public Filter
+class PDAL_DLL RadialDensityFilter : public Filter, public Streamable
 {
 public:
-    RadialDensityFilter() : Filter()
-    {}
+    RadialDensityFilter();
+    ~RadialDensityFilter();
 
     std::string getName() const;
 
 private:
     Dimension::Id m_rdens;
     double m_rad;
+    std::string m_index;
+    point_count_t m_halo;
+    int m_threads;
+    std::unique_ptr<NeighborWindow> m_window;
 
     virtual void addArgs(ProgramArgs& args);
+    virtual void initialize();
     virtual void addDimensions(PointLayoutPtr layout);
+    virtual void ready(PointTableRef table);
     virtual void filter(PointView& view);
+    virtual bool processOne(PointRef& point);
+    virtual point_count_t processBatch(StreamPointTable& table, PointId begin,
+        point_count_t count);
+    virtual void done(PointTableRef table);
+    NeighborWindow& window();
+    double factor() const;
 
     RadialDensityFilter& operator=(const RadialDensityFilter&); // not implemented
     RadialDensityFilter(const RadialDensityFilter&); // not implemented
@@ -34,6 +34,12 @@
 
 #include "RandomizeFilter.hpp"
 
+#include <random>
+
+#include <pdal/util/Random.hpp>
+
+#include "private/RadixSort.hpp"
+
 namespace pdal
 {
 
@@ -51,6 +57,38 @@ std::string RandomizeFilter::getName() const
 void RandomizeFilter::addArgs(ProgramArgs& args)
 {
     m_seedArg = &args.add("seed", "Random number generator seed", m_seed, 0u);
+    args.add("threads", "Number of threads used to shuffle points",
+        m_threads, 1);
+}
+
+
+void RandomizeFilter::initialize()
+{
+    if (m_threads < 1)
+        throwError("Option 'threads' must be at least 1.");
+}
+
+
+// Points are ordered by a hash of the seed and their position in the view,
+// which is a random permutation.  Equal hashes keep their view order, so
+// the order depends on the seed alone and not on the number of threads.
+void RandomizeFilter::filter(PointView& view)
+{
+    if (!m_seedArg->set())
+    {
+        std::random_device rng;
+        m_seed = rng();
+    }
+    Utils::CounterRandom random(m_seed);
+    radix::EntryList entries = radix::makeEntries(view.size(), m_threads,
+        [&random](PointId idx){ return random(idx); });
+    radix::sort(entries, m_threads);
+
+    PointIdList order;
+    order.reserve(entries.size());
+    for (const radix::Entry& e : entries)
+        order.push_back(e.id);
+    view.reorder(order);
 }
 
 } // namespace pdal
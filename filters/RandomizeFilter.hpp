@@ -37,8 +37,6 @@
 
 #include <pdal/Filter.hpp>
 
-#include <random>
-
 namespace pdal
 {
 
@@ -54,18 +52,11 @@ public:
 private:
     Arg* m_seedArg;
     unsigned m_seed;
+    int m_threads;
 
     virtual void addArgs(ProgramArgs& args);
-    virtual void filter(PointView& view)
-    {
-        if (!m_seedArg->set())
-        {
-            std::random_device rng;
-            m_seed = rng();
-        }
-        std::mt19937 mt(m_seed);
-        std::shuffle(view.begin(), view.end(), mt);
-    }
+    virtual void initialize();
+    virtual void filter(PointView& view);
 
     RandomizeFilter& operator=(const RandomizeFilter&); // not implemented
     RandomizeFilter(const RandomizeFilter&);            // not implemented
@@ -38,6 +38,7 @@
 #include <pdal/util/Utils.hpp>
 
 #include "private/DimRange.hpp"
+#include "private/Selection.hpp"
 
 #include <cctype>
 #include <limits>
@@ -89,6 +90,18 @@ void RangeFilter::prepared(PointTableRef table)
                 r.m_name + "'.");
     }
     std::sort(m_ranges.begin(), m_ranges.end());
+
+    m_selection.reset(new Selection);
+    m_selection->pushRanges(m_ranges);
+}
+
+
+bool RangeFilter::addUsedDims(PointLayoutPtr /*layout*/,
+    Dimension::IdList& dims) const
+{
+    for (auto& r : m_ranges)
+        dims.push_back(r.m_id);
+    return true;
 }
 
 
@@ -98,7 +111,21 @@ void RangeFilter::prepared(PointTableRef table)
 // common case.
 bool RangeFilter::processOne(PointRef& point)
 {
-    return DimRange::pointPasses(m_ranges, point);
+    return m_selection->passes(point);
+}
+
+
+point_count_t RangeFilter::processBatch(StreamPointTable& table,
+    PointId begin, point_count_t count)
+{
+    // Only the points that earlier stages kept are evaluated.
+    StreamPointTable::IdRange ids = table.activeIds(begin, count);
+    std::vector<char> mask;
+    m_selection->runIds(table, ids.begin(), ids.size(), mask);
+    for (std::size_t i = 0; i < ids.size(); ++i)
+        if (!mask[i])
+            table.setSkip(ids.begin()[i]);
+    return count;
 }
 
 
@@ -110,12 +137,11 @@ PointViewSet RangeFilter::run(PointViewPtr inView)
 
     PointViewPtr outView = inView->makeNew();
 
+    std::vector<char> mask;
+    m_selection->run(*inView, 0, inView->size(), mask);
     for (PointId i = 0; i < inView->size(); ++i)
-    {
-        PointRef point = inView->point(i);
-        if (processOne(point))
+        if (mask[i])
             outView->appendPoint(*inView, i);
-    }
 
     viewSet.insert(outView);
     return viewSet;
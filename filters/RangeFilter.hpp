@@ -45,6 +45,7 @@ namespace pdal
 {
 
 struct DimRange;
+class Selection;
 
 class PDAL_DLL RangeFilter : public Filter,  public Streamable
 {
@@ -56,11 +57,20 @@ public:
 
 private:
     std::vector<DimRange> m_ranges;
+    std::unique_ptr<Selection> m_selection;
 
     virtual void addArgs(ProgramArgs& args);
     virtual void prepared(PointTableRef table);
+    virtual bool addUsedDims(PointLayoutPtr layout,
+        Dimension::IdList& dims) const;
     virtual bool processOne(PointRef& point);
+    virtual point_count_t processBatch(StreamPointTable& table, PointId begin,
+        point_count_t count);
     virtual PointViewSet run(PointViewPtr view);
+    virtual bool reentrant() const
+        { return true; }
+    virtual bool fusable() const
+        { return true; }
 
     RangeFilter& operator=(const RangeFilter&) = delete;
     RangeFilter(const RangeFilter&) = delete;
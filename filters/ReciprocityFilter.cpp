@@ -41,9 +41,10 @@
 
 #include <pdal/KDIndex.hpp>
 #include <pdal/util/ProgramArgs.hpp>
+#include <pdal/util/TaskScheduler.hpp>
 
+#include <algorithm>
 #include <string>
-#include <thread>
 #include <vector>
 
 namespace pdal
@@ -71,55 +72,63 @@ void ReciprocityFilter::addArgs(ProgramArgs& args)
              1);
 }
 
+void ReciprocityFilter::initialize()
+{
+    if (m_threads < 1)
+        throwError("Option 'threads' must be at least 1.");
+}
+
 void ReciprocityFilter::addDimensions(PointLayoutPtr layout)
 {
     m_reciprocity =
         layout->registerOrAssignDim("Reciprocity", Dimension::Type::Double);
 }
 
+// The neighbors of every point are found once with a batched query, so
+// the neighborhoods of a point's neighbors are looked up rather than
+// searched for again.
 void ReciprocityFilter::filter(PointView& view)
 {
     KD3Index& kdi = view.build3dIndex();
+    const KDNeighbors nbrs = kdi.knnAll(m_knn + 1, m_threads);
 
-    point_count_t nloops = view.size();
-    std::vector<std::thread> threadList(m_threads);
-    for (int t = 0; t < m_threads; t++)
+    const point_count_t nloops = view.size();
+    const point_count_t threads = (std::max)(1, m_threads);
+    parallelFor(threads, threads, [&](std::size_t t)
     {
-        threadList[t] = std::thread(std::bind(
-            [&](const PointId start, const PointId end) {
-                for (PointId i = start; i < end; i++)
-                    setReciprocity(view, i, kdi);
-            },
-            t * nloops / m_threads,
-            (t + 1) == m_threads ? nloops : (t + 1) * nloops / m_threads));
-    }
-    for (auto& t : threadList)
-        t.join();
+        const PointId end = (t + 1) * nloops / threads;
+        for (PointId i = t * nloops / threads; i < end; i++)
+            setReciprocity(view, i, nbrs);
+    });
 }
 
 void ReciprocityFilter::setReciprocity(PointView& view, const PointId& i,
-                                       const KD3Index& kdi)
+                                       const KDNeighbors& nbrs)
 {
-    // Find k-nearest neighbors of i.
-    auto ni = kdi.neighbors(i, m_knn + 1);
+    // The k-nearest neighbors of i.
+    const PointId *ni = nbrs.neighbors(i);
+    const PointId *niEnd = ni + nbrs.count(i);
 
     // Initialize number of unidirectional neighbors to 0.
     point_count_t uni(0);
 
     // Visit each neighbor of i, finding its k-nearest neighbors. If i is
     // not a nearest neighbor of one of its neighbors, increment uni.
-    for (auto const& j : ni)
+    for (const PointId *it = ni; it != niEnd; ++it)
     {
+        const PointId j = *it;
+
         // The query point itself will always show up as a neighbor and can
         // be skipped.
         if (j == i)
             continue;
 
-        // Find k-nearest neighbors of j.
-        auto nj = kdi.neighbors(j, m_knn + 1);
+        // The k-nearest neighbors of j.
+        const PointId *nj = nbrs.neighbors(j);
+        const PointId *njEnd = nj + nbrs.count(j);
 
         // If i is not a neighbor of j, increment uni.
-        if (std::find(nj.begin(), nj.end(), i) == nj.end())
+        if (std::find(nj, njEnd, i) == njEnd)
             ++uni;
     }
 
@@ -46,6 +46,7 @@ namespace pdal
 class Options;
 class PointLayout;
 class PointView;
+struct KDNeighbors;
 
 class PDAL_DLL ReciprocityFilter : public Filter
 {
@@ -64,10 +65,11 @@ private:
 
     virtual void addDimensions(PointLayoutPtr layout);
     virtual void addArgs(ProgramArgs& args);
+    virtual void initialize();
     virtual void filter(PointView& view);
 
     void setReciprocity(PointView& view, const PointId& i,
-                        const KD3Index& kdi);
+                        const KDNeighbors& nbrs);
 };
 
 } // namespace pdal
@@ -33,12 +33,12 @@
 ****************************************************************************/
 
 #include "ReprojectionFilter.hpp"
+#include "TransformationFilter.hpp"
 
 #include <pdal/PointView.hpp>
 #include <pdal/private/SrsTransform.hpp>
 #include <pdal/util/ProgramArgs.hpp>
-
-//#include <memory>
+#include <pdal/util/TaskScheduler.hpp>
 
 namespace pdal
 {
@@ -52,9 +52,18 @@ static StaticPluginInfo const s_info
 
 CREATE_STATIC_STAGE(ReprojectionFilter, s_info)
 
+namespace
+{
+
+// Number of points passed to the transformation in a single call.
+const point_count_t BatchSize = 4096;
+
+} // unnamed namespace
+
 std::string ReprojectionFilter::getName() const { return s_info.name; }
 
-ReprojectionFilter::ReprojectionFilter() : m_inferInputSRS(true)
+ReprojectionFilter::ReprojectionFilter() : m_inferInputSRS(true),
+    m_threads(1), m_pretransform(nullptr)
 {}
 
 
@@ -68,6 +77,8 @@ void ReprojectionFilter::addArgs(ProgramArgs& args)
     args.add("in_srs", "Input spatial reference", m_inSRS);
     args.add("in_axis_ordering", "Axis ordering override for in_srs", m_inAxisOrderingArg, {} );
     args.add("out_axis_ordering", "Axis ordering override for out_srs", m_outAxisOrderingArg, {} );
+    args.add("threads", "Number of threads used to run this filter",
+        m_threads, 1);
 }
 
 
@@ -75,6 +86,8 @@ void ReprojectionFilter::initialize()
 {
     m_inferInputSRS = m_inSRS.empty();
     setSpatialReference(m_outSRS);
+    if (m_threads < 1)
+        throwError("Option 'threads' must be at least 1.");
 }
 
 
@@ -133,6 +146,22 @@ void ReprojectionFilter::prepared(PointTableRef table)
         check(m_outAxisOrdering);
     }
 
+    // A transformation that immediately precedes this filter is applied
+    // while reprojecting, which saves a pass over the points.  Only done
+    // when X, Y and Z are stored as doubles, so that skipping the store of
+    // the intermediate values doesn't change results.
+    m_pretransform = nullptr;
+    PointLayoutPtr layout(table.layout());
+    if (getInputs().size() == 1 &&
+        layout->dimType(Dimension::Id::X) == Dimension::Type::Double &&
+        layout->dimType(Dimension::Id::Y) == Dimension::Type::Double &&
+        layout->dimType(Dimension::Id::Z) == Dimension::Type::Double)
+    {
+        m_pretransform =
+            dynamic_cast<TransformationFilter *>(getInputs().front());
+        if (m_pretransform)
+            m_pretransform->fuseInto(*this);
+    }
 }
 
 void ReprojectionFilter::createTransform(const SpatialReference& srsSRS)
@@ -146,16 +175,20 @@ void ReprojectionFilter::createTransform(const SpatialReference& srsSRS)
     }
 
 
-    // If either vector is empty, GDAL's default ordering is used.
-    if (m_inAxisOrdering.size() || m_outAxisOrdering.size())
+    m_transforms.clear();
+    for (int i = 0; i < m_threads; ++i)
     {
+        // If either vector is empty, GDAL's default ordering is used.
+        if (m_inAxisOrdering.size() || m_outAxisOrdering.size())
+        {
 
-        m_transform.reset(new SrsTransform(m_inSRS,
-                                           m_inAxisOrdering,
-                                           m_outSRS,
-                                           m_outAxisOrdering));
-    } else {
-        m_transform.reset(new SrsTransform(m_inSRS, m_outSRS));
+            m_transforms.emplace_back(new SrsTransform(m_inSRS,
+                                               m_inAxisOrdering,
+                                               m_outSRS,
+                                               m_outAxisOrdering));
+        } else {
+            m_transforms.emplace_back(new SrsTransform(m_inSRS, m_outSRS));
+        }
     }
 }
 
@@ -167,13 +200,11 @@ PointViewSet ReprojectionFilter::run(PointViewPtr view)
 
     createTransform(view->spatialReference());
 
-    PointRef point(*view, 0);
+    std::vector<char> ok(view->size(), 1);
+    transformPoints(*view, 0, view->size(), ok.data());
     for (PointId id = 0; id < view->size(); ++id)
-    {
-        point.setPointId(id);
-        if (processOne(point))
+        if (ok[id])
             outView->appendPoint(*view, id);
-    }
 
     viewSet.insert(outView);
     return viewSet;
@@ -186,7 +217,9 @@ bool ReprojectionFilter::processOne(PointRef& point)
     double y(point.getFieldAs<double>(Dimension::Id::Y));
     double z(point.getFieldAs<double>(Dimension::Id::Z));
 
-    bool ok = m_transform->transform(x, y, z);
+    if (m_pretransform && m_pretransform->fused())
+        m_pretransform->matrix().apply(&x, &y, &z, 1);
+    bool ok = m_transforms[0]->transform(x, y, z);
     if (ok)
     {
         point.setField(Dimension::Id::X, x);
@@ -196,4 +229,97 @@ bool ReprojectionFilter::processOne(PointRef& point)
     return ok;
 }
 
+
+point_count_t ReprojectionFilter::processBatch(StreamPointTable& table,
+    PointId begin, point_count_t count)
+{
+    StreamPointTable::IdRange ids = table.activeIds(begin, count);
+    std::vector<char> ok(count);
+    for (PointId idx : ids)
+        ok[idx - begin] = 1;
+
+    transformPoints(table, begin, begin + count, ok.data());
+    for (PointId idx : ids)
+        if (!ok[idx - begin])
+            table.setSkip(idx);
+    return count;
+}
+
+
+// Transform the points in [begin, end) whose flag in 'ok' is set, splitting
+// the range among the threads.  The flag of any point that can't be
+// transformed is cleared.  'ok' is indexed from 'begin'.
+void ReprojectionFilter::transformPoints(PointContainer& container,
+    PointId begin, PointId end, char *ok)
+{
+    const point_count_t count = end - begin;
+    const point_count_t threads = (std::min)((point_count_t)m_threads,
+        (std::max)((point_count_t)1, count / BatchSize));
+
+    // Each range has its own transform, since a transform can't be used
+    // from several threads at once.
+    parallelFor(threads, threads, [&](std::size_t t)
+    {
+        PointId b = begin + t * count / threads;
+        PointId e = begin + (t + 1) * count / threads;
+        transformRange(*m_transforms[t], container, b, e, ok + (b - begin));
+    });
+}
+
+
+// Transform the points of the range BatchSize at a time so that the
+// per-call overhead of the coordinate transformation is amortized.
+void ReprojectionFilter::transformRange(SrsTransform& transform,
+    PointContainer& container, PointId begin, PointId end, char *ok)
+{
+    std::vector<PointId> ids;
+    std::vector<double> x;
+    std::vector<double> y;
+    std::vector<double> z;
+    std::vector<int> success;
+    ids.reserve(BatchSize);
+    x.reserve(BatchSize);
+    y.reserve(BatchSize);
+    z.reserve(BatchSize);
+
+    PointRef point(container, begin);
+    PointId idx = begin;
+    while (idx < end)
+    {
+        ids.clear();
+        x.clear();
+        y.clear();
+        z.clear();
+        for (; idx < end && ids.size() < BatchSize; ++idx)
+        {
+            if (!ok[idx - begin])
+                continue;
+            point.setPointId(idx);
+            ids.push_back(idx);
+            x.push_back(point.getFieldAs<double>(Dimension::Id::X));
+            y.push_back(point.getFieldAs<double>(Dimension::Id::Y));
+            z.push_back(point.getFieldAs<double>(Dimension::Id::Z));
+        }
+        if (ids.empty())
+            break;
+
+        if (m_pretransform && m_pretransform->fused())
+            m_pretransform->matrix().apply(x.data(), y.data(), z.data(),
+                x.size());
+        transform.transform(x, y, z, success);
+        for (size_t i = 0; i < ids.size(); ++i)
+        {
+            if (!success[i])
+            {
+                ok[ids[i] - begin] = 0;
+                continue;
+            }
+            point.setPointId(ids[i]);
+            point.setField(Dimension::Id::X, x[i]);
+            point.setField(Dimension::Id::Y, y[i]);
+            point.setField(Dimension::Id::Z, z[i]);
+        }
+    }
+}
+
 } // namespace pdal
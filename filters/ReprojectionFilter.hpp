@@ -38,11 +38,13 @@
 #include <pdal/Streamable.hpp>
 
 #include <memory>
+#include <vector>
 
 namespace pdal
 {
 
 class SrsTransform;
+class TransformationFilter;
 
 class PDAL_DLL ReprojectionFilter : public Filter, public Streamable
 {
@@ -60,19 +62,29 @@ private:
     virtual void initialize();
     virtual PointViewSet run(PointViewPtr view);
     virtual bool processOne(PointRef& point);
+    virtual point_count_t processBatch(StreamPointTable& table, PointId begin,
+        point_count_t count);
     virtual void spatialReferenceChanged(const SpatialReference& srs);
     virtual void prepared(PointTableRef table);
 
     void createTransform(const SpatialReference& srs);
+    void transformPoints(PointContainer& container, PointId begin,
+        PointId end, char *ok);
+    void transformRange(SrsTransform& transform, PointContainer& container,
+        PointId begin, PointId end, char *ok);
 
     SpatialReference m_inSRS;
     SpatialReference m_outSRS;
     bool m_inferInputSRS;
-    std::unique_ptr<SrsTransform> m_transform;
+    int m_threads;
+    // One transform per thread, as transformations aren't thread-safe.
+    std::vector<std::unique_ptr<SrsTransform>> m_transforms;
     std::vector<std::string> m_inAxisOrderingArg;
     std::vector<std::string> m_outAxisOrderingArg;
     std::vector<int> m_inAxisOrdering;
     std::vector<int> m_outAxisOrdering;
+    // Transformation applied before reprojecting, if fused.
+    TransformationFilter *m_pretransform;
 };
 
 } // namespace pdal
@@ -36,6 +36,9 @@
 
 #include <pdal/util/ProgramArgs.hpp>
 
+#include <algorithm>
+#include <iterator>
+
 namespace pdal
 {
 
@@ -58,24 +61,8 @@ void ReturnsFilter::addArgs(ProgramArgs& args)
              m_returnsString, {"last"});
 }
 
-void ReturnsFilter::prepared(PointTableRef table)
+void ReturnsFilter::initialize()
 {
-    const PointLayoutPtr layout(table.layout());
-    if (!layout->hasDim(Dimension::Id::ReturnNumber) ||
-        !layout->hasDim(Dimension::Id::NumberOfReturns))
-    {
-        log()->get(LogLevel::Warning)
-            << "Could not find ReturnNumber or "
-               "NumberOfReturns. Proceeding with all returns.\n";
-    }
-}
-
-PointViewSet ReturnsFilter::run(PointViewPtr inView)
-{
-    PointViewSet viewSet;
-    if (!inView->size())
-        return viewSet;
-
     m_outputTypes = 0;
     for (auto& r : m_returnsString)
     {
@@ -91,63 +78,102 @@ PointViewSet ReturnsFilter::run(PointViewPtr inView)
         else
             throwError("Invalid output type: '" + r + "'.");
     }
+}
 
-    PointViewPtr firstView = inView->makeNew();
-    PointViewPtr intermediateView = inView->makeNew();
-    PointViewPtr lastView = inView->makeNew();
-    PointViewPtr onlyView = inView->makeNew();
-
-    for (PointId idx = 0; idx < inView->size(); idx++)
+void ReturnsFilter::prepared(PointTableRef table)
+{
+    const PointLayoutPtr layout(table.layout());
+    if (!layout->hasDim(Dimension::Id::ReturnNumber) ||
+        !layout->hasDim(Dimension::Id::NumberOfReturns))
     {
-        PointRef p = inView->point(idx);
-        uint8_t rn = p.getFieldAs<uint8_t>(Dimension::Id::ReturnNumber);
-        uint8_t nr = p.getFieldAs<uint8_t>(Dimension::Id::NumberOfReturns);
-        if ((m_outputTypes & returnFirst) && (rn == 1) && (nr > 1))
-            firstView->appendPoint(*inView.get(), idx);
-        if ((m_outputTypes & returnIntermediate) && (rn > 1) && (rn < nr) &&
-            (nr > 2))
-            intermediateView->appendPoint(*inView.get(), idx);
-        if ((m_outputTypes & returnLast) && (rn == nr) && (nr > 1))
-            lastView->appendPoint(*inView.get(), idx);
-        if ((m_outputTypes & returnOnly) && (nr == 1))
-            onlyView->appendPoint(*inView.get(), idx);
+        log()->get(LogLevel::Warning)
+            << "Could not find ReturnNumber or "
+               "NumberOfReturns. Proceeding with all returns.\n";
     }
+}
 
-    if (m_outputTypes & returnFirst)
-    {
-        if (firstView->size())
-            viewSet.insert(firstView);
-        else
-            log()->get(LogLevel::Warning)
-                << "Requested returns group 'first' is empty\n";
-    }
+void ReturnsFilter::ready(PointTableRef table)
+{
+    std::fill(std::begin(m_counts), std::end(m_counts), 0);
+}
 
-    if (m_outputTypes & returnIntermediate)
-    {
-        if (intermediateView->size())
-            viewSet.insert(intermediateView);
-        else
-            log()->get(LogLevel::Warning)
-                << "Requested returns group 'intermediate' is empty\n";
-    }
+namespace
+{
+
+const int returnTypes[] = { ReturnsFilter::returnFirst,
+    ReturnsFilter::returnIntermediate, ReturnsFilter::returnLast,
+    ReturnsFilter::returnOnly };
+const char *returnNames[] = { "first", "intermediate", "last", "only" };
+
+} // unnamed namespace
+
+// Get the position of a point's return type in returnTypes, or -1 if it has
+// none.
+int ReturnsFilter::returnType(PointRef& p) const
+{
+    uint8_t rn = p.getFieldAs<uint8_t>(Dimension::Id::ReturnNumber);
+    uint8_t nr = p.getFieldAs<uint8_t>(Dimension::Id::NumberOfReturns);
+    if ((rn == 1) && (nr > 1))
+        return 0;
+    if ((rn > 1) && (rn < nr) && (nr > 2))
+        return 1;
+    if ((rn == nr) && (nr > 1))
+        return 2;
+    if (nr == 1)
+        return 3;
+    return -1;
+}
+
+void ReturnsFilter::warnEmpty(const point_count_t *counts)
+{
+    for (int i = 0; i < 4; ++i)
+        if ((m_outputTypes & returnTypes[i]) && !counts[i])
+            log()->get(LogLevel::Warning) << "Requested returns group '" <<
+                returnNames[i] << "' is empty\n";
+}
+
+// In stream mode the points of all the requested groups are passed on
+// together, as with several bounds in filters.crop.
+bool ReturnsFilter::processOne(PointRef& point)
+{
+    int i = returnType(point);
+    if (i < 0 || !(m_outputTypes & returnTypes[i]))
+        return false;
+    m_counts[i]++;
+    return true;
+}
+
+void ReturnsFilter::done(PointTableRef table)
+{
+    warnEmpty(m_counts);
+}
+
+PointViewSet ReturnsFilter::run(PointViewPtr inView)
+{
+    PointViewSet viewSet;
+    if (!inView->size())
+        return viewSet;
+
+    PointViewPtr views[4];
+    for (PointViewPtr& v : views)
+        v = inView->makeNew();
 
-    if (m_outputTypes & returnLast)
+    for (PointId idx = 0; idx < inView->size(); idx++)
     {
-        if (lastView->size())
-            viewSet.insert(lastView);
-        else
-            log()->get(LogLevel::Warning)
-                << "Requested returns group 'last' is empty\n";
+        PointRef p = inView->point(idx);
+        int i = returnType(p);
+        if (i >= 0 && (m_outputTypes & returnTypes[i]))
+            views[i]->appendPoint(*inView.get(), idx);
     }
 
-    if (m_outputTypes & returnOnly)
+    point_count_t counts[4];
+    for (int i = 0; i < 4; ++i)
     {
-        if (onlyView->size())
-            viewSet.insert(onlyView);
-        else
-            log()->get(LogLevel::Warning)
-                << "Requested returns group 'only' is empty\n";
+        counts[i] = views[i]->size();
+        if ((m_outputTypes & returnTypes[i]) && counts[i])
+            viewSet.insert(views[i]);
     }
+    warnEmpty(counts);
 
     return viewSet;
 }
@@ -35,6 +35,7 @@
 #pragma once
 
 #include <pdal/Filter.hpp>
+#include <pdal/Streamable.hpp>
 
 #include <string>
 
@@ -44,7 +45,7 @@ namespace pdal
 class PointView;
 class ProgramArgs;
 
-class PDAL_DLL ReturnsFilter : public Filter
+class PDAL_DLL ReturnsFilter : public Filter, public Streamable
 {
 public:
     ReturnsFilter() {}
@@ -59,10 +60,17 @@ public:
 private:
     StringList m_returnsString;
     int m_outputTypes;
+    point_count_t m_counts[4];
 
     virtual void addArgs(ProgramArgs& args);
+    virtual void initialize();
     virtual void prepared(PointTableRef table);
+    virtual void ready(PointTableRef table);
     virtual PointViewSet run(PointViewPtr view);
+    virtual bool processOne(PointRef& point);
+    virtual void done(PointTableRef table);
+    int returnType(PointRef& point) const;
+    void warnEmpty(const point_count_t *counts);
 
     ReturnsFilter& operator=(const ReturnsFilter&) = delete; // not implemented
     ReturnsFilter(const ReturnsFilter&) = delete;            // not implemented
@@ -45,6 +45,7 @@
 #include <pdal/util/ProgramArgs.hpp>
 
 #include "private/DimRange.hpp"
+#include "private/GroundTiles.hpp"
 #include "private/Segmentation.hpp"
 
 #include <Eigen/Dense>
@@ -91,6 +92,7 @@ struct SMRArgs
     std::vector<DimRange> m_ignored;
     StringList m_returns;
     StringList m_classbits;
+    GroundTiles m_tiles;
 };
 
 SMRFilter::SMRFilter() : m_args(new SMRArgs) {}
@@ -116,6 +118,7 @@ void SMRFilter::addArgs(ProgramArgs& args)
              {"last", "only"});
     args.add("classbits", "Ignore synthetic|keypoint|withheld classification bits?",
              m_args->m_classbits, {""});
+    m_args->m_tiles.addArgs(args);
 }
 
 void SMRFilter::addDimensions(PointLayoutPtr layout)
@@ -165,6 +168,8 @@ void SMRFilter::ready(PointTableRef table)
 
     if (!FileUtils::directoryExists(m_args->m_dir))
         throwError("Output directory '" + m_args->m_dir + "' does not exist");
+    if (m_args->m_tiles.tiled())
+        throwError("Option 'dir' can't be used with 'tile_size'.");
 }
 
 PointViewSet SMRFilter::run(PointViewPtr view)
@@ -236,21 +241,45 @@ PointViewSet SMRFilter::run(PointViewPtr view)
         throwError("No returns to process.");
     }
 
+    // Classify remaining points, by tile if requested. Each tile is handled
+    // by a filter of its own, as the raster state is per filter.
+    m_args->m_tiles.classify(inlierView, m_args->m_window, log(),
+        [this](PointViewPtr tile, LogPtr log)
+        {
+            SMRFilter worker;
+            *worker.m_args = *m_args;
+            worker.setLog(log);
+            worker.classify(tile);
+        });
+
+    PointViewPtr outView = view->makeNew();
+    // ignoredView is appended to the output untouched.
+    outView->append(*ignoredView);
+    // inlierView is appended to the output, the only PointView whose
+    // classifications may have been altered.
+    outView->append(*inlierView);
+    viewSet.insert(outView);
+
+    return viewSet;
+}
+
+void SMRFilter::classify(PointViewPtr view)
+{
     // Classify remaining points with value of 1. SMRF processing will mark
     // ground returns as 2.
-    for (PointId i = 0; i < inlierView->size(); ++i)
-        inlierView->setField(Id::Classification, i, ClassLabel::Unclassified);
+    for (PointId i = 0; i < view->size(); ++i)
+        view->setField(Id::Classification, i, ClassLabel::Unclassified);
 
-    m_srs = inlierView->spatialReference();
+    m_srs = view->spatialReference();
 
-    calculateBounds(*inlierView, m_bounds);
+    calculateBounds(*view, m_bounds);
     m_cols = static_cast<int>(
         ((m_bounds.maxx - m_bounds.minx) / m_args->m_cell) + 1);
     m_rows = static_cast<int>(
         ((m_bounds.maxy - m_bounds.miny) / m_args->m_cell) + 1);
 
     // Create raster of minimum Z values per element.
-    std::vector<double> ZImin = createZImin(inlierView);
+    std::vector<double> ZImin = createZImin(view);
 
     // Create raster mask of pixels containing low outlier points.
     std::vector<int> Low = createLowMask(ZImin);
@@ -270,21 +299,11 @@ PointViewSet SMRFilter::run(PointViewPtr view)
     // original ZImin (not ZInet), however the net cut mask will still force
     // interpolation at these pixels.
     std::vector<double> ZIpro =
-        createZIpro(inlierView, ZImin, Low, isNetCell, Obj);
+        createZIpro(view, ZImin, Low, isNetCell, Obj);
 
     // Classify ground returns by comparing elevation values to the provisional
     // DEM.
-    classifyGround(inlierView, ZIpro);
-
-    PointViewPtr outView = view->makeNew();
-    // ignoredView is appended to the output untouched.
-    outView->append(*ignoredView);
-    // inlierView is appended to the output, the only PointView whose
-    // classifications may have been altered.
-    outView->append(*inlierView);
-    viewSet.insert(outView);
-
-    return viewSet;
+    classifyGround(view, ZIpro);
 }
 
 void SMRFilter::classifyGround(PointViewPtr view, std::vector<double>& ZIpro)
@@ -512,9 +531,9 @@ std::vector<double> SMRFilter::createZInet(std::vector<double> const& ZImin,
     {
         int v = ceil<int>(m_args->m_cut / m_args->m_cell);
         std::vector<double> bigErode =
-            erodeDiamond(ZImin, m_rows, m_cols, 2 * v);
+            erodeDiamondFast(ZImin, m_rows, m_cols, 2 * v);
         std::vector<double> bigOpen =
-            dilateDiamond(bigErode, m_rows, m_cols, 2 * v);
+            dilateDiamondFast(bigErode, m_rows, m_cols, 2 * v);
         for (auto c = 0; c < m_cols; ++c)
         {
             for (auto r = 0; r < m_rows; ++r)
@@ -658,9 +677,9 @@ std::vector<int> SMRFilter::progressiveFilter(std::vector<double> const& ZImin,
         // "On the first iteration, the minimum surface (ZImin) is opened using
         // a disk-shaped structuring element with a radius of one pixel."
         std::vector<double> curErosion =
-            erodeDiamond(prevErosion, m_rows, m_cols, 1);
+            erodeDiamondFast(prevErosion, m_rows, m_cols, 1);
         std::vector<double> curOpening =
-            dilateDiamond(curErosion, m_rows, m_cols, radius);
+            dilateDiamondFast(curErosion, m_rows, m_cols, radius);
         prevErosion = curErosion;
 
         // "An elevation threshold is then calculated, where the value is equal
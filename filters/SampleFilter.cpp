@@ -33,12 +33,15 @@
  ****************************************************************************/
 
 #include "SampleFilter.hpp"
+#include "private/PoissonGrid.hpp"
 
-#include <pdal/KDIndex.hpp>
 #include <pdal/util/ProgramArgs.hpp>
+#include <pdal/util/TaskScheduler.hpp>
 #include <pdal/util/Utils.hpp>
 
+#include <algorithm>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace pdal
@@ -59,9 +62,22 @@ std::string SampleFilter::getName() const
 }
 
 
+SampleFilter::SampleFilter()
+{}
+
+
+SampleFilter::~SampleFilter()
+{}
+
+
 void SampleFilter::addArgs(ProgramArgs& args)
 {
     args.add("radius", "Radius", m_radius, 1.0);
+    args.add("threads", "Number of threads used to sample points",
+        m_threads, 1);
+    args.add("evict_after", "Forget samples in regions that haven't been "
+        "approached within this many points (0 = never)", m_evictAfter,
+        (uint64_t)0);
 }
 
 
@@ -71,6 +87,35 @@ void SampleFilter::addDimensions(PointLayoutPtr layout)
 }
 
 
+void SampleFilter::initialize()
+{
+    if (m_radius <= 0)
+        throwError("Option 'radius' must be greater than 0.");
+    if (m_threads < 1)
+        throwError("Option 'threads' must be at least 1.");
+}
+
+
+void SampleFilter::ready(PointTableRef)
+{
+    m_grid.reset(new PoissonGrid(m_radius, m_evictAfter));
+}
+
+
+bool SampleFilter::processOne(PointRef& point)
+{
+    return m_grid->insert(point.getFieldAs<double>(Dimension::Id::X),
+        point.getFieldAs<double>(Dimension::Id::Y),
+        point.getFieldAs<double>(Dimension::Id::Z));
+}
+
+
+void SampleFilter::done(PointTableRef)
+{
+    m_grid.reset();
+}
+
+
 PointViewSet SampleFilter::run(PointViewPtr inView)
 {
     point_count_t np = inView->size();
@@ -82,28 +127,25 @@ PointViewSet SampleFilter::run(PointViewPtr inView)
         return viewSet;
     PointViewPtr outView = inView->makeNew();
 
-    // Build the 3D KD-tree.
-    KD3Index& index = inView->build3dIndex();
-
-    // All points are marked as kept (1) by default. As they are masked by
-    // neighbors within the user-specified radius, their value is changed to 0.
-    std::vector<int> keep(np, 1);
-
-    // We are able to subsample in a single pass over the shuffled indices.
-    for (PointId i = 0; i < np; ++i)
+    if (m_threads > 1)
     {
-        // If a point is masked, it is forever masked, and cannot be part of the
-        // sampled cloud. Otherwise, the current index is appended to the output
-        // PointView.
-        if (keep[i] == 0)
-            continue;
-        outView->appendPoint(*inView, i);
-
-        // We now proceed to mask all neighbors within m_radius of the kept
-        // point.
-        auto ids = index.radius(i, m_radius);
-        for (auto const& id : ids)
-            keep[id] = 0;
+        std::vector<char> keep(np, 0);
+        samplePhased(*inView, keep);
+        for (PointId i = 0; i < np; ++i)
+            if (keep[i])
+                outView->appendPoint(*inView, i);
+    }
+    else
+    {
+        // Each view is sampled on its own.  A point is kept if no point
+        // kept before it is within m_radius, so we are able to subsample
+        // in a single pass in the order of the points.
+        PoissonGrid grid(m_radius, m_evictAfter);
+        for (PointId i = 0; i < np; ++i)
+            if (grid.insert(inView->getFieldAs<double>(Dimension::Id::X, i),
+                    inView->getFieldAs<double>(Dimension::Id::Y, i),
+                    inView->getFieldAs<double>(Dimension::Id::Z, i)))
+                outView->appendPoint(*inView, i);
     }
 
     // Simply calculate the percentage of retained points.
@@ -116,4 +158,52 @@ PointViewSet SampleFilter::run(PointViewPtr inView)
     return viewSet;
 }
 
+
+// Sample the tiles of the grid one phase at a time.  Tiles of a phase
+// don't interact, so they're spread across threads, and the points of
+// each tile are sampled in their order in the view.  The result depends
+// on the phases, but not on the number of threads.
+void SampleFilter::samplePhased(const PointView& view, std::vector<char>& keep)
+{
+    using namespace Dimension;
+
+    typedef std::vector<PointId> IdList;
+    typedef std::unordered_map<PoissonGrid::Cell, IdList,
+        PoissonGrid::CellHash> TileMap;
+
+    PoissonGrid grid(m_radius);
+    TileMap tiles;
+    for (PointId i = 0; i < view.size(); ++i)
+    {
+        PoissonGrid::Cell c = grid.cell(view.getFieldAs<double>(Id::X, i),
+            view.getFieldAs<double>(Id::Y, i),
+            view.getFieldAs<double>(Id::Z, i));
+        grid.reserve(c);
+        tiles[PoissonGrid::tile(c)].push_back(i);
+    }
+
+    std::vector<const IdList *> phases[8];
+    for (auto& t : tiles)
+        phases[PoissonGrid::phase(t.first)].push_back(&t.second);
+
+    for (const std::vector<const IdList *>& phase : phases)
+    {
+        parallelFor(phase.size(), (size_t)m_threads, [&](std::size_t t)
+        {
+            for (PointId i : *phase[t])
+            {
+                double x = view.getFieldAs<double>(Id::X, i);
+                double y = view.getFieldAs<double>(Id::Y, i);
+                double z = view.getFieldAs<double>(Id::Z, i);
+                PoissonGrid::Cell c = grid.cell(x, y, z);
+                if (grid.isClear(x, y, z, c))
+                {
+                    grid.add(x, y, z, c);
+                    keep[i] = 1;
+                }
+            }
+        });
+    }
+}
+
 } // namespace pdal
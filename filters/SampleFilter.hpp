@@ -35,19 +35,23 @@
 #pragma once
 
 #include <pdal/Filter.hpp>
+#include <pdal/Streamable.hpp>
 
+#include <memory>
 #include <string>
+#include <vector>
 
 namespace pdal
 {
 
 class Options;
+class PoissonGrid;
 
-class PDAL_DLL SampleFilter : public pdal::Filter
+class PDAL_DLL SampleFilter : public Filter, public Streamable
 {
 public:
-    SampleFilter() : Filter()
-    {}
+    SampleFilter();
+    ~SampleFilter();
     SampleFilter& operator=(const SampleFilter&) = delete;
     SampleFilter(const SampleFilter&) = delete;
 
@@ -55,10 +59,18 @@ public:
 
 private:
     double m_radius;
+    int m_threads;
+    uint64_t m_evictAfter;
+    std::unique_ptr<PoissonGrid> m_grid;
 
     virtual void addDimensions(PointLayoutPtr layout);
     virtual void addArgs(ProgramArgs& args);
+    virtual void initialize();
+    virtual void ready(PointTableRef table);
+    virtual bool processOne(PointRef& point);
+    virtual void done(PointTableRef table);
     virtual PointViewSet run(PointViewPtr view);
+    void samplePhased(const PointView& view, std::vector<char>& keep);
 };
 
 } // namespace pdal
@@ -67,6 +67,13 @@ void SeparateScanLineFilter::prepared(PointTableRef table)
         throwError("Layout does not contains EdgeOfFlightLine dimension.");
 }
 
+// A stream is a single view, so in stream mode points aren't split and all
+// are passed on.  This lets pipelines that use the filter be streamed.
+bool SeparateScanLineFilter::processOne(PointRef&)
+{
+    return true;
+}
+
 PointViewSet SeparateScanLineFilter::run(PointViewPtr inView)
 {
     PointViewSet result;
@@ -35,6 +35,7 @@
 #pragma once
 
 #include <pdal/Filter.hpp>
+#include <pdal/Streamable.hpp>
 
 namespace pdal
 {
@@ -42,7 +43,7 @@ namespace pdal
 class PointView;
 class ProgramArgs;
 
-class PDAL_DLL SeparateScanLineFilter : public Filter
+class PDAL_DLL SeparateScanLineFilter : public Filter, public Streamable
 {
 public:
     SeparateScanLineFilter();
@@ -57,6 +58,7 @@ private:
     virtual void addArgs(ProgramArgs& args);
     virtual void prepared(PointTableRef table);
     virtual PointViewSet run(PointViewPtr view);
+    virtual bool processOne(PointRef& point);
 };
 
 } // namespace pdal
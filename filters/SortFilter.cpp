@@ -34,6 +34,10 @@
 
 #include "SortFilter.hpp"
 
+#include <pdal/DimAccessor.hpp>
+
+#include "private/RadixSort.hpp"
+
 namespace pdal
 {
 
@@ -54,6 +58,7 @@ void SortFilter::addArgs(ProgramArgs& args)
         setPositional();
     args.add("order", "Sort order ASC(ending) or DESC(ending)", m_order,
         SortOrder::ASC);
+    args.add("threads", "Number of threads used to sort", m_threads, 1u);
 }
 
 void SortFilter::prepared(PointTableRef table)
@@ -63,15 +68,73 @@ void SortFilter::prepared(PointTableRef table)
         throwError("Dimension '" + m_dimName + "' not found.");
 }
 
+namespace
+{
+
+template<typename T>
+radix::EntryList sortEntries(const PointView& view, Dimension::Id dim,
+    unsigned threads, bool descending)
+{
+    DimAccessor<T> acc(view, dim);
+    const uint64_t flip = descending ? ~0ull : 0;
+    return radix::makeEntries(view.size(), threads,
+        [&acc, flip](PointId idx)
+            { return radix::orderedKey(acc.get(idx)) ^ flip; });
+}
+
+} // unnamed namespace
+
+// The dimension's values are mapped to integer keys that sort in the same
+// order, so the points can be ordered with a radix sort rather than by
+// comparing values through the view.
 void SortFilter::filter(PointView& view)
 {
-    auto cmp = [this](const PointRef& p1, const PointRef& p2)
+    const bool desc = (m_order == SortOrder::DESC);
+
+    radix::EntryList entries;
+    switch (view.layout()->dimType(m_dim))
     {
-        bool result = p1.compare(m_dim, p2);
-        return (m_order == SortOrder::ASC) ? result : !result;
-    };
+    case Dimension::Type::Float:
+        entries = sortEntries<float>(view, m_dim, m_threads, desc);
+        break;
+    case Dimension::Type::Double:
+        entries = sortEntries<double>(view, m_dim, m_threads, desc);
+        break;
+    case Dimension::Type::Signed8:
+        entries = sortEntries<int8_t>(view, m_dim, m_threads, desc);
+        break;
+    case Dimension::Type::Signed16:
+        entries = sortEntries<int16_t>(view, m_dim, m_threads, desc);
+        break;
+    case Dimension::Type::Signed32:
+        entries = sortEntries<int32_t>(view, m_dim, m_threads, desc);
+        break;
+    case Dimension::Type::Signed64:
+        entries = sortEntries<int64_t>(view, m_dim, m_threads, desc);
+        break;
+    case Dimension::Type::Unsigned8:
+        entries = sortEntries<uint8_t>(view, m_dim, m_threads, desc);
+        break;
+    case Dimension::Type::Unsigned16:
+        entries = sortEntries<uint16_t>(view, m_dim, m_threads, desc);
+        break;
+    case Dimension::Type::Unsigned32:
+        entries = sortEntries<uint32_t>(view, m_dim, m_threads, desc);
+        break;
+    case Dimension::Type::Unsigned64:
+        entries = sortEntries<uint64_t>(view, m_dim, m_threads, desc);
+        break;
+    case Dimension::Type::None:
+    default:
+        return;
+    }
+    radix::sort(entries, m_threads);
 
-    std::stable_sort(view.begin(), view.end(), cmp);
+    PointIdList order;
+    order.reserve(entries.size());
+    for (const radix::Entry& e : entries)
+        order.push_back(e.id);
+    view.reorder(order);
 }
 
 std::istream& operator >> (std::istream& in, SortOrder& order)
@@ -67,6 +67,9 @@ private:
     // Sort order.
     SortOrder m_order;
 
+    // Number of threads used to compute keys and sort.
+    unsigned m_threads;
+
     virtual void addArgs(ProgramArgs& args);
     virtual void prepared(PointTableRef table);
     virtual void filter(PointView& view);
@@ -34,11 +34,15 @@
 
 #include "SplitterFilter.hpp"
 
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include <limits>
 
 #include <pdal/util/ProgramArgs.hpp>
+#include <pdal/util/TaskScheduler.hpp>
+
+#include "private/Partition.hpp"
 
 namespace pdal
 {
@@ -66,11 +70,15 @@ void SplitterFilter::addArgs(ProgramArgs& args)
         std::numeric_limits<double>::quiet_NaN());
     args.add("buffer", "Size of buffer (overlap) to include around each tile.",
         m_buffer, 0.0);
+    args.add("threads", "Number of threads used to split points", m_threads,
+        1);
 }
 
 
 void SplitterFilter::initialize()
 {
+    if (m_threads < 1)
+        throwError("Option 'threads' must be at least 1.");
     if (m_buffer >= m_length / 2)
     {
         std::stringstream oss;
@@ -94,28 +102,54 @@ PointViewSet SplitterFilter::run(PointViewPtr inView)
     if (!inView->size())
         return viewSet;
 
-    auto addPoint = [this, &inView](PointRef& point, int xpos, int ypos) {
-        Coord loc(xpos, ypos);
-        PointViewPtr& outView = m_viewMap[loc];
-        if (!outView)
-            outView = inView->makeNew();
-        outView->appendPoint(*inView.get(), point.pointId());
-    };
-
     // Use the location of the first point as the origin, unless specified.
     // (!= test == isnan(), which doesn't exist on windows)
     if (m_xOrigin != m_xOrigin)
         setOrigin(inView->getFieldAs<double>(Dimension::Id::X, 0), m_yOrigin);
     if (m_yOrigin != m_yOrigin)
         setOrigin(m_xOrigin, inView->getFieldAs<double>(Dimension::Id::Y, 0));
+
     // Overlay a grid of squares on the points (m_length sides).  Each square
-    // corresponds to a new point buffer.  Place the points falling in the
-    // each square in the corresponding point buffer.
-    PointRef point(*inView, 0);
-    for (PointId idx = 0; idx < inView->size(); idx++)
+    // corresponds to a new point buffer.  Find the squares that each point
+    // falls in, in blocks of points on all threads, keyed by the square's
+    // position.
+    const unsigned threads = (unsigned)(std::min)((point_count_t)m_threads,
+        inView->size());
+    std::vector<radix::EntryList> blocks(threads);
+    auto findSquares = [this, &inView, &blocks, threads](unsigned t)
     {
-        point.setPointId(idx);
-        processPoint(point, addPoint);
+        radix::EntryList& entries = blocks[t];
+        auto addPoint = [&entries](PointRef& point, int xpos, int ypos)
+        {
+            uint64_t key = ((uint64_t)(uint32_t)xpos << 32) | (uint32_t)ypos;
+            entries.push_back({ key, point.pointId() });
+        };
+
+        const PointId end = inView->size() * (t + 1) / threads;
+        PointRef point(*inView, 0);
+        for (PointId idx = inView->size() * t / threads; idx < end; idx++)
+        {
+            point.setPointId(idx);
+            processPoint(point, addPoint);
+        }
+    };
+
+    parallelFor(threads, threads, findSquares);
+
+    radix::EntryList entries;
+    for (radix::EntryList& block : blocks)
+        entries.insert(entries.end(), block.begin(), block.end());
+
+    // Place the points falling in each square in the corresponding point
+    // buffer.
+    for (partition::Group& g : partition::split(*inView, entries, threads))
+    {
+        Coord loc((int)(int32_t)(g.key >> 32), (int)(int32_t)g.key);
+        PointViewPtr& outView = m_viewMap[loc];
+        if (outView)
+            outView->append(*g.view);
+        else
+            outView = g.view;
     }
 
     // Pull the buffers out of the map and stick them in the standard
@@ -69,6 +69,7 @@ private:
     double m_xOrigin;
     double m_yOrigin;
     double m_buffer;
+    int m_threads;
     std::map<Coord, PointViewPtr, CoordCompare> m_viewMap;
 
     virtual void addArgs(ProgramArgs& args);
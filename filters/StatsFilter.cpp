@@ -34,13 +34,17 @@
 
 #include "StatsFilter.hpp"
 
+#include <algorithm>
 #include <cmath>
+#include <functional>
 #include <unordered_map>
 
+#include <pdal/DimAccessor.hpp>
 #include <pdal/Options.hpp>
 #include <pdal/Polygon.hpp>
 #include <pdal/PDALUtils.hpp>
 #include <pdal/util/ProgramArgs.hpp>
+#include <pdal/util/TaskScheduler.hpp>
 
 namespace pdal
 {
@@ -59,6 +63,219 @@ std::string StatsFilter::getName() const { return s_info.name; }
 namespace stats
 {
 
+// Size the sketch for the requested rank error using the empirical
+// error of KLL sketches, about 2.3 / k^0.94.
+QuantileSketch::QuantileSketch(double error) : m_size(0), m_maxSize(0),
+    m_count(0)
+{
+    error = (std::min)((std::max)(error, 1e-5), .5);
+    double k = std::ceil(std::pow(2.296 / error, 1 / 0.9445));
+    m_k = (size_t)(std::min)((std::max)(k, 8.0), 65536.0);
+    addLevel();
+}
+
+
+// Capacity of a compactor.  Lower levels are smaller by a factor of 2/3 so
+// that most of the space is used by the values with the largest weights.
+size_t QuantileSketch::capacity(size_t level) const
+{
+    size_t depth = m_levels.size() - 1 - level;
+    return (std::max)((size_t)2,
+        (size_t)std::ceil(m_k * std::pow(2.0 / 3.0, (double)depth)));
+}
+
+
+void QuantileSketch::addLevel()
+{
+    m_levels.emplace_back();
+    m_offsets.push_back(false);
+    m_maxSize = 0;
+    for (size_t level = 0; level < m_levels.size(); ++level)
+        m_maxSize += capacity(level);
+}
+
+
+void QuantileSketch::insert(double value)
+{
+    if (std::isnan(value))
+        return;
+    m_levels[0].push_back(value);
+    m_count++;
+    if (++m_size >= m_maxSize)
+        compress();
+}
+
+
+// Compact the lowest full compactor until the sketch fits.  Compaction
+// halves the number of values of a compactor and doubles their weight, so
+// the total weight is unchanged.  The offset alternates so that the
+// promoted values aren't consistently the smaller or larger ones.
+void QuantileSketch::compress()
+{
+    while (m_size >= m_maxSize)
+    {
+        for (size_t level = 0; level < m_levels.size(); ++level)
+        {
+            if (m_levels[level].size() < capacity(level))
+                continue;
+            if (level + 1 == m_levels.size())
+                addLevel();
+
+            std::vector<double>& values = m_levels[level];
+            std::vector<double>& next = m_levels[level + 1];
+            std::sort(values.begin(), values.end());
+
+            // With an odd number of values, the smallest stays behind.
+            size_t start = values.size() % 2;
+            size_t offset = m_offsets[level] ? 1 : 0;
+            m_offsets[level] = !m_offsets[level];
+            for (size_t i = start + offset; i < values.size(); i += 2)
+                next.push_back(values[i]);
+            m_size -= (values.size() - start) / 2;
+            values.resize(start);
+            break;
+        }
+    }
+}
+
+
+void QuantileSketch::merge(const QuantileSketch& other)
+{
+    m_k = (std::min)(m_k, other.m_k);
+    while (m_levels.size() < other.m_levels.size())
+        addLevel();
+    for (size_t level = 0; level < other.m_levels.size(); ++level)
+    {
+        const std::vector<double>& values = other.m_levels[level];
+        m_levels[level].insert(m_levels[level].end(), values.begin(),
+            values.end());
+        m_size += values.size();
+    }
+    m_count += other.m_count;
+
+    // Capacities depend on k and on the number of levels.
+    m_maxSize = 0;
+    for (size_t level = 0; level < m_levels.size(); ++level)
+        m_maxSize += capacity(level);
+    compress();
+}
+
+
+QuantileSketch::WeightedValues QuantileSketch::weightedValues() const
+{
+    WeightedValues values;
+    values.reserve(m_size);
+    for (size_t level = 0; level < m_levels.size(); ++level)
+        for (double v : m_levels[level])
+            values.push_back({ v, (point_count_t)1 << level });
+    return values;
+}
+
+
+// The value at which the cumulative weight first exceeds q * total.  For
+// unit weights and q = .5 this is the value at position total / 2 of the
+// sorted values, matching the exact median.
+double QuantileSketch::weightedQuantile(WeightedValues& values,
+    point_count_t total, double q)
+{
+    if (values.empty())
+        return 0;
+    std::sort(values.begin(), values.end());
+    double target = q * total;
+    point_count_t cumulative = 0;
+    for (auto& v : values)
+    {
+        cumulative += v.second;
+        if (cumulative > target)
+            return v.first;
+    }
+    return values.back().first;
+}
+
+
+double QuantileSketch::quantile(double q) const
+{
+    WeightedValues values = weightedValues();
+    return weightedQuantile(values, m_count, q);
+}
+
+
+double QuantileSketch::medianAbsoluteDeviation(double median) const
+{
+    WeightedValues values = weightedValues();
+    for (auto& v : values)
+        v.first = std::fabs(v.first - median);
+    return weightedQuantile(values, m_count, .5);
+}
+
+
+FrequentValues::FrequentValues(size_t capacity) :
+    m_capacity((std::max)(capacity, (size_t)1))
+{}
+
+
+void FrequentValues::insert(double value)
+{
+    auto it = m_counts.find(value);
+    if (it != m_counts.end())
+    {
+        it->second++;
+        return;
+    }
+    if (m_counts.size() < m_capacity)
+    {
+        m_counts[value] = 1;
+        return;
+    }
+
+    // No room: count the value against every tracked value.
+    for (auto it = m_counts.begin(); it != m_counts.end();)
+        if (--it->second == 0)
+            it = m_counts.erase(it);
+        else
+            ++it;
+}
+
+
+void FrequentValues::merge(const FrequentValues& other)
+{
+    for (auto& c : other.m_counts)
+        m_counts[c.first] += c.second;
+    if (m_counts.size() <= m_capacity)
+        return;
+
+    // Subtract the (capacity + 1)th largest count from all the counts.
+    std::vector<point_count_t> counts;
+    for (auto& c : m_counts)
+        counts.push_back(c.second);
+    std::nth_element(counts.begin(), counts.begin() + m_capacity,
+        counts.end(), std::greater<point_count_t>());
+    point_count_t cut = counts[m_capacity];
+    for (auto it = m_counts.begin(); it != m_counts.end();)
+        if (it->second <= cut)
+            it = m_counts.erase(it);
+        else
+        {
+            it->second -= cut;
+            ++it;
+        }
+}
+
+
+// The smallest of the values with the highest count.
+double FrequentValues::mode() const
+{
+    double mode = 0;
+    point_count_t best = 0;
+    for (auto& c : m_counts)
+        if (c.second > best)
+        {
+            best = c.second;
+            mode = c.first;
+        }
+    return mode;
+}
+
 
 void Summary::extractMetadata(MetadataNode &m)
 {
@@ -98,6 +315,7 @@ void Summary::extractMetadata(MetadataNode &m)
         computeGlobalStats();
         m.add("median", m_median);
         m.add("mad", m_mad);
+        m.add("mode", m_mode);
     }
     else if (m_enumerate == Count)
     {
@@ -112,7 +330,18 @@ void Summary::extractMetadata(MetadataNode &m)
 
 void Summary::computeGlobalStats()
 {
-    auto compute_median = [](std::vector<double> vals)
+    if (m_cnt == 0)
+        return;
+
+    if (m_globalError > 0)
+    {
+        m_median = m_sketch.quantile(.5);
+        m_mad = m_sketch.medianAbsoluteDeviation(m_median);
+        m_mode = m_frequent.mode();
+        return;
+    }
+
+    auto compute_median = [](std::vector<double>& vals)
     {
         std::nth_element(vals.begin(), vals.begin()+vals.size()/2, vals.end());
 
@@ -120,12 +349,67 @@ void Summary::computeGlobalStats()
     };
 
     // TODO add quantiles
-    m_median = compute_median(m_data);
-    std::transform(m_data.begin(), m_data.end(), m_data.begin(),
+    std::vector<double> vals(m_data);
+    m_median = compute_median(vals);
+    std::transform(vals.begin(), vals.end(), vals.begin(),
        [this](double v) { return std::fabs(v - this->m_median); });
-    m_mad = compute_median(m_data);
+    m_mad = compute_median(vals);
 
+    point_count_t best = 0;
+    for (auto& v : m_values)
+        if (v.second > best)
+        {
+            best = v.second;
+            m_mode = v.first;
+        }
+}
 
+
+// Combine the statistics of another set of values of the same dimension,
+// as if they had been inserted into this summary.  Moments are combined
+// with the pairwise formulas of Chan et al. and Pebay.
+void Summary::merge(const Summary& other)
+{
+    if (other.m_cnt == 0)
+        return;
+    if (m_cnt == 0)
+    {
+        *this = other;
+        return;
+    }
+
+    const double na = (double)m_cnt;
+    const double nb = (double)other.m_cnt;
+    const double n = na + nb;
+    const double delta = other.M1 - M1;
+    const double delta2 = delta * delta;
+
+    double m1 = M1 + delta * nb / n;
+    double m2 = M2 + other.M2 + delta2 * na * nb / n;
+    if (m_advanced)
+    {
+        double m3 = M3 + other.M3 +
+            delta2 * delta * na * nb * (na - nb) / (n * n) +
+            3 * delta * (na * other.M2 - nb * M2) / n;
+        double m4 = M4 + other.M4 +
+            delta2 * delta2 * na * nb * (na * na - na * nb + nb * nb) /
+                (n * n * n) +
+            6 * delta2 * (na * na * other.M2 + nb * nb * M2) / (n * n) +
+            4 * delta * (na * other.M3 - nb * M3) / n;
+        M3 = m3;
+        M4 = m4;
+    }
+    M1 = m1;
+    M2 = m2;
+
+    m_cnt += other.m_cnt;
+    m_min = (std::min)(m_min, other.m_min);
+    m_max = (std::max)(m_max, other.m_max);
+    for (auto& v : other.m_values)
+        m_values[v.first] += v.second;
+    m_data.insert(m_data.end(), other.m_data.begin(), other.m_data.end());
+    m_sketch.merge(other.m_sketch);
+    m_frequent.merge(other.m_frequent);
 }
 
 
@@ -145,14 +429,30 @@ bool StatsFilter::processOne(PointRef& point)
 }
 
 
+// Each dimension's summary is independent of the others, so large views
+// are summarized a dimension per task.  The values of each dimension are
+// still inserted in point order, so the results are the same as in stream
+// mode.
 void StatsFilter::filter(PointView& view)
 {
-    PointRef point(view, 0);
-    for (PointId idx = 0; idx < view.size(); ++idx)
+    auto summarize = [&view](Dimension::Id id, Summary& s)
     {
-        point.setPointId(idx);
-        processOne(point);
+        DimAccessor<double>(view, id).forEach(
+            [&s](PointId, double d){ s.insert(d); });
+    };
+
+    if (m_stats.size() == 1 || view.size() < (1 << 20))
+    {
+        for (auto& p : m_stats)
+            summarize(p.first, p.second);
+        return;
     }
+
+    std::vector<std::pair<const Dimension::Id, Summary> *> stats;
+    for (auto& p : m_stats)
+        stats.push_back(&p);
+    parallelFor(stats.size(), 0, [&summarize, &stats](std::size_t i)
+        { summarize(stats[i]->first, stats[i]->second); });
 }
 
 
@@ -170,6 +470,8 @@ void StatsFilter::addArgs(ProgramArgs& args)
         m_enums);
     args.add("global", "Dimensions to compute global stats (median, mad, mode)",
         m_global);
+    args.add("global_error", "Relative rank error of approximate global "
+        "stats.  Zero computes exact global stats.", m_globalError, 0.0);
     args.add("count", "Dimensions whose values should be counted", m_counts);
     args.add("advanced", "Calculate skewness and kurtosis", m_advanced);
 }
@@ -177,6 +479,10 @@ void StatsFilter::addArgs(ProgramArgs& args)
 
 void StatsFilter::prepared(PointTableRef table)
 {
+    if (m_globalError < 0 || m_globalError >= 1)
+        throwError("Option 'global_error' must be at least 0 and less "
+            "than 1.");
+
     PointLayoutPtr layout(table.layout());
     std::unordered_map<std::string, Summary::EnumType> dims;
 
@@ -235,7 +541,7 @@ void StatsFilter::prepared(PointTableRef table)
     // Create the summary objects.
     for (auto& dv : dims)
         m_stats.insert(std::make_pair(layout->findDim(dv.first),
-            Summary(dv.first, dv.second, m_advanced)));
+            Summary(dv.first, dv.second, m_advanced, m_globalError)));
 }
 
 
@@ -37,11 +37,66 @@
 #include <pdal/Filter.hpp>
 #include <pdal/Streamable.hpp>
 
+#include <cmath>
+#include <map>
+#include <vector>
+
 namespace pdal
 {
 namespace stats
 {
 
+// Mergeable approximate quantile summary (a KLL sketch).  Values are held
+// in compactors whose values carry weights of increasing powers of two.
+// When a compactor fills, it is sorted and every other value is promoted
+// to the next compactor.  Ranks are accurate to about 'error' * count.
+class PDAL_DLL QuantileSketch
+{
+public:
+    QuantileSketch(double error = .01);
+
+    void insert(double value);
+    void merge(const QuantileSketch& other);
+    point_count_t count() const
+        { return m_count; }
+    double quantile(double q) const;
+    double medianAbsoluteDeviation(double median) const;
+
+private:
+    typedef std::vector<std::pair<double, point_count_t>> WeightedValues;
+
+    size_t capacity(size_t level) const;
+    void addLevel();
+    void compress();
+    WeightedValues weightedValues() const;
+    static double weightedQuantile(WeightedValues& values,
+        point_count_t total, double q);
+
+    size_t m_k;
+    size_t m_size;
+    size_t m_maxSize;
+    point_count_t m_count;
+    std::vector<std::vector<double>> m_levels;
+    std::vector<bool> m_offsets;
+};
+
+// Mergeable summary of the most frequent values (Misra-Gries).  Any value
+// that occurs more than count / (capacity + 1) times is kept, with its count
+// underestimated by no more than that.
+class PDAL_DLL FrequentValues
+{
+public:
+    FrequentValues(size_t capacity = 100);
+
+    void insert(double value);
+    void merge(const FrequentValues& other);
+    double mode() const;
+
+private:
+    size_t m_capacity;
+    std::map<double, point_count_t> m_counts;
+};
+
 class PDAL_DLL Summary
 {
 public:
@@ -57,8 +112,14 @@ typedef std::map<double, point_count_t> EnumMap;
 typedef std::vector<double> DataVector;
 
 public:
-    Summary(std::string name, EnumType enumerate, bool advanced = true) :
-        m_name(name), m_enumerate(enumerate), m_advanced(advanced)
+    // A non-zero globalError computes global statistics from sketches
+    // with that relative rank error instead of from all the values.
+    Summary(std::string name, EnumType enumerate, bool advanced = true,
+            double globalError = 0) :
+        m_name(name), m_enumerate(enumerate), m_advanced(advanced),
+        m_globalError(globalError),
+        m_sketch(globalError > 0 ? globalError : .01),
+        m_frequent(globalError > 0 ? (size_t)std::ceil(1 / globalError) : 1)
     { reset(); }
 
     double minimum() const
@@ -130,6 +191,8 @@ public:
         { return m_median; }
     double mad() const
         { return m_mad; }
+    double mode() const
+        { return m_mode; }
     point_count_t count() const
         { return m_cnt; }
     std::string name() const
@@ -139,6 +202,7 @@ public:
 
     void extractMetadata(MetadataNode &m);
     void computeGlobalStats();
+    void merge(const Summary& other);
 
     void reset()
     {
@@ -147,6 +211,7 @@ public:
         m_cnt = 0;
         m_median = 0.0;
         m_mad = 0.0;
+        m_mode = 0.0;
         M1 = M2 = M3 = M4 = 0.0;
     }
 
@@ -156,9 +221,14 @@ public:
         m_min = (std::min)(m_min, value);
         m_max = (std::max)(m_max, value);
 
-        if (m_enumerate != NoEnum)
+        if (m_enumerate == Global && m_globalError > 0)
+        {
+            m_sketch.insert(value);
+            m_frequent.insert(value);
+        }
+        else if (m_enumerate != NoEnum)
             m_values[value]++;
-        if (m_enumerate == Global)
+        if (m_enumerate == Global && m_globalError == 0)
         {
             if (m_data.capacity() - m_data.size() < 10000)
                 m_data.reserve(m_data.capacity() + m_cnt);
@@ -196,12 +266,16 @@ private:
     std::string m_name;
     EnumType m_enumerate;
     bool m_advanced;
+    double m_globalError;
     double m_max;
     double m_min;
     double m_mad;
     double m_median;
+    double m_mode;
     EnumMap m_values;
     DataVector m_data;
+    QuantileSketch m_sketch;
+    FrequentValues m_frequent;
     point_count_t m_cnt;
     double M1, M2, M3, M4;
 };
@@ -235,6 +309,7 @@ private:
     StringList m_enums;
     StringList m_counts;
     StringList m_global;
+    double m_globalError;
     bool m_advanced;
     std::map<Dimension::Id, stats::Summary> m_stats;
 };
@@ -37,7 +37,10 @@
 #include <pdal/Filter.hpp>
 #include <pdal/Streamable.hpp>
 
+#include <algorithm>
 #include <functional>
+#include <numeric>
+#include <vector>
 
 namespace pdal
 {
@@ -55,9 +58,50 @@ public:
     void setCallback(CallbackFunc cb)
         { m_callback = cb; }
 
+    /**
+      Function called with a batch of points.
+
+      \param container  Table or view holding the points.
+      \param ids  IDs of the points of the batch in \a container, in
+        order.
+      \param keep  Flags, one per entry of \a ids, that are set on entry.
+        Clear a point's flag to filter it out in stream mode.  The flags
+        are ignored in standard mode, where points are never filtered out.
+    */
+    typedef std::function<void(PointContainer& container,
+        const PointIdList& ids, std::vector<char>& keep)> BatchCallbackFunc;
+
+    /**
+      Set a function to be called with batches of points rather than with
+      each point.  When set, it's used instead of the function set with
+      setCallback(), except for points that a caller hands to the filter
+      one at a time.
+
+      \param cb  Function to call.
+    */
+    void setBatchCallback(BatchCallbackFunc cb)
+        { m_batchCallback = cb; }
+
 private:
+    static const point_count_t BatchSize = 65536;
+
     virtual void filter(PointView& view)
     {
+        if (m_batchCallback)
+        {
+            PointIdList ids;
+            std::vector<char> keep;
+            for (PointId begin = 0; begin < view.size(); begin += BatchSize)
+            {
+                PointId end = (std::min)(begin + BatchSize, view.size());
+                ids.resize(end - begin);
+                std::iota(ids.begin(), ids.end(), begin);
+                keep.assign(ids.size(), 1);
+                m_batchCallback(view, ids, keep);
+            }
+            return;
+        }
+
         PointRef p(view, 0);
         for (PointId idx = 0; idx < view.size(); ++idx)
         {
@@ -73,7 +117,26 @@ private:
         return false;
     }
 
+    virtual point_count_t processBatch(StreamPointTable& table,
+        PointId begin, point_count_t count)
+    {
+        if (!m_batchCallback)
+            return Streamable::processBatch(table, begin, count);
+
+        PointIdList ids;
+        for (PointId idx : table.activeIds(begin, count))
+            if (!table.skip(idx))
+                ids.push_back(idx);
+        std::vector<char> keep(ids.size(), 1);
+        m_batchCallback(table, ids, keep);
+        for (size_t i = 0; i < ids.size(); ++i)
+            if (!keep[i])
+                table.setSkip(ids[i]);
+        return count;
+    }
+
     CallbackFunc m_callback;
+    BatchCallbackFunc m_batchCallback;
 
     StreamCallbackFilter&
         operator=(const StreamCallbackFilter&); // not implemented
@@ -62,6 +62,21 @@ private:
             "at the end to drop.", m_invert);
     }
 
+    bool addUsedDims(PointLayoutPtr /*layout*/,
+        Dimension::IdList& /*dims*/) const
+    {
+        return true;
+    }
+
+    // Only the last 'count' points are read, so readers that can seek
+    // (LAS, BPF) can skip to them.
+    void inputLimit(PointLimit& limit) const
+    {
+        limit = PointLimit();
+        if (!m_invert)
+            limit.m_last = m_count;
+    }
+
     PointViewSet run(PointViewPtr view)
     {
         if (m_count > view->size())
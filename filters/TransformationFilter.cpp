@@ -34,8 +34,11 @@
 
 #include "TransformationFilter.hpp"
 #include <pdal/util/FileUtils.hpp>
+#include <pdal/util/TaskScheduler.hpp>
 
 
+#include <algorithm>
+#include <functional>
 #include <sstream>
 
 namespace pdal
@@ -120,7 +123,42 @@ std::ostream& operator<<(std::ostream& out,
 }
 
 
-TransformationFilter::TransformationFilter() : m_matrix(new Transform)
+namespace
+{
+
+// Number of points transformed together.  The coordinates of a batch
+// stay in cache between being loaded, transformed and stored.
+const point_count_t BatchSize = 4096;
+
+} // unnamed namespace
+
+
+// The loop is written over plain arrays so that the compiler can
+// vectorize it.  The arithmetic is done in the same order for every
+// point so results don't depend on how points are batched.
+void TransformationFilter::Transform::apply(double *x, double *y, double *z,
+    size_t count) const
+{
+    const double m0 = m_vals[0], m1 = m_vals[1], m2 = m_vals[2],
+        m3 = m_vals[3];
+    const double m4 = m_vals[4], m5 = m_vals[5], m6 = m_vals[6],
+        m7 = m_vals[7];
+    const double m8 = m_vals[8], m9 = m_vals[9], m10 = m_vals[10],
+        m11 = m_vals[11];
+    for (size_t i = 0; i < count; ++i)
+    {
+        const double xi = x[i];
+        const double yi = y[i];
+        const double zi = z[i];
+        x[i] = xi * m0 + yi * m1 + zi * m2 + m3;
+        y[i] = xi * m4 + yi * m5 + zi * m6 + m7;
+        z[i] = xi * m8 + yi * m9 + zi * m10 + m11;
+    }
+}
+
+
+TransformationFilter::TransformationFilter() : m_matrix(new Transform),
+    m_threads(1), m_fuseInto(nullptr)
 {}
 
 
@@ -135,6 +173,8 @@ void TransformationFilter::addArgs(ProgramArgs& args)
     args.add("matrix", "Transformation matrix", *m_matrix).setPositional();
     args.add("override_srs", "Spatial reference to apply to data.",
         m_overrideSrs);
+    args.add("threads", "Number of threads used to run this filter",
+        m_threads, 1);
 }
 
 
@@ -142,6 +182,8 @@ void TransformationFilter::initialize()
 {
     if (! m_overrideSrs.empty())
         setSpatialReference(m_overrideSrs);
+    if (m_threads < 1)
+        throwError("Option 'threads' must be at least 1.");
 }
 
 
@@ -155,23 +197,62 @@ void TransformationFilter::doFilter(PointView& view,
 
 bool TransformationFilter::processOne(PointRef& point)
 {
-    Transform& matrix = *m_matrix;
+    if (fused())
+        return true;
 
     double x = point.getFieldAs<double>(Dimension::Id::X);
     double y = point.getFieldAs<double>(Dimension::Id::Y);
     double z = point.getFieldAs<double>(Dimension::Id::Z);
 
-    point.setField(Dimension::Id::X,
-        x * matrix[0] + y * matrix[1] + z * matrix[2] + matrix[3]);
-
-    point.setField(Dimension::Id::Y,
-        x * matrix[4] + y * matrix[5] + z * matrix[6] + matrix[7]);
+    m_matrix->apply(&x, &y, &z, 1);
 
-    point.setField(Dimension::Id::Z,
-        x * matrix[8] + y * matrix[9] + z * matrix[10] + matrix[11]);
+    point.setField(Dimension::Id::X, x);
+    point.setField(Dimension::Id::Y, y);
+    point.setField(Dimension::Id::Z, z);
     return true;
 }
 
+
+// Points that have been skipped are transformed too.  Their values are
+// never read and this keeps the batches contiguous.
+point_count_t TransformationFilter::processBatch(StreamPointTable& table,
+    PointId begin, point_count_t count)
+{
+    if (!fused())
+        transformRange(table, begin, begin + count);
+    return count;
+}
+
+
+void TransformationFilter::transformRange(PointContainer& container,
+    PointId begin, PointId end) const
+{
+    std::vector<double> x(BatchSize);
+    std::vector<double> y(BatchSize);
+    std::vector<double> z(BatchSize);
+
+    PointRef point(container, begin);
+    for (PointId start = begin; start < end; start += BatchSize)
+    {
+        const size_t count = (size_t)(std::min)(BatchSize, end - start);
+        for (size_t i = 0; i < count; ++i)
+        {
+            point.setPointId(start + i);
+            x[i] = point.getFieldAs<double>(Dimension::Id::X);
+            y[i] = point.getFieldAs<double>(Dimension::Id::Y);
+            z[i] = point.getFieldAs<double>(Dimension::Id::Z);
+        }
+        m_matrix->apply(x.data(), y.data(), z.data(), count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            point.setPointId(start + i);
+            point.setField(Dimension::Id::X, x[i]);
+            point.setField(Dimension::Id::Y, y[i]);
+            point.setField(Dimension::Id::Z, z[i]);
+        }
+    }
+}
+
 void TransformationFilter::spatialReferenceChanged(const SpatialReference& srs)
 {
     if (!srs.empty() && !m_overrideSrs.empty())
@@ -185,13 +266,17 @@ void TransformationFilter::filter(PointView& view)
     if (!view.spatialReference().empty() && !m_overrideSrs.empty())
         log()->get(LogLevel::Warning) << getName() <<
             ": overriding input spatial reference." << std::endl;
+    if (fused())
+        return;
 
-    PointRef point(view, 0);
-    for (PointId idx = 0; idx < view.size(); ++idx)
-    {
-        point.setPointId(idx);
-        processOne(point);
-    }
+    const point_count_t count = view.size();
+    const point_count_t threads = (std::min)((point_count_t)m_threads,
+        (std::max)((point_count_t)1, count / BatchSize));
+    parallelFor(threads, threads, [this, &view, count, threads](std::size_t t)
+        {
+            transformRange(view, t * count / threads,
+                (t + 1) * count / threads);
+        });
     view.invalidateProducts();
 }
 
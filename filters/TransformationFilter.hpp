@@ -57,15 +57,45 @@ public:
     std::string getName() const override;
     void doFilter(PointView& view, const Transform& matrix);
 
+    /**
+      Have the stage that reads this filter's output apply the
+      transformation instead of this filter.  The transformation is only
+      handed off when that stage is the only one reading the output.
+
+      \param consumer  Stage that will apply the transformation.
+    */
+    void fuseInto(const Stage& consumer)
+        { m_fuseInto = &consumer; }
+    /**
+      Determine whether the transformation is applied by the stage that
+      reads this filter's output.  Only valid during execute().
+    */
+    bool fused() const
+        { return m_fuseInto && soleConsumer() == m_fuseInto; }
+    const Transform& matrix() const
+        { return *m_matrix; }
+
 private:
     virtual void addArgs(ProgramArgs& args) override;
     virtual void initialize() override;
     virtual bool processOne(PointRef& point) override;
+    virtual point_count_t processBatch(StreamPointTable& table, PointId begin,
+        point_count_t count) override;
     virtual void filter(PointView& view) override;
+    void transformRange(PointContainer& container, PointId begin,
+        PointId end) const;
     virtual void spatialReferenceChanged(const SpatialReference& srs) override;
+    // Transforming with several threads is left to filter().
+    virtual bool fusable() const override
+        { return m_threads == 1; }
+    // Points are neither added, removed nor reordered.
+    virtual void inputLimit(PointLimit& /*limit*/) const override
+        {}
 
     std::unique_ptr<Transform> m_matrix;
     SpatialReference m_overrideSrs;
+    int m_threads;
+    const Stage *m_fuseInto;
 };
 
 class TransformationFilter::Transform
@@ -85,6 +115,16 @@ public:
     PDAL_DLL double& operator[](size_t off)
         { return m_vals[off]; }
 
+    /**
+      Transform points in place.
+
+      \param x  X coordinates of the points.
+      \param y  Y coordinates of the points.
+      \param z  Z coordinates of the points.
+      \param count  Number of points.
+    */
+    PDAL_DLL void apply(double *x, double *y, double *z, size_t count) const;
+
 private:
     ArrayType m_vals;
 
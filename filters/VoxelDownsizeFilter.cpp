@@ -58,9 +58,11 @@ std::istream& operator>>(std::istream& in, VoxelDownsizeFilter::Mode& mode)
         mode = VoxelDownsizeFilter::Mode::Center;
     else if (s == "first")
         mode = VoxelDownsizeFilter::Mode::First;
+    else if (s == "centroid")
+        mode = VoxelDownsizeFilter::Mode::Centroid;
     else
         throw pdal_error("filters.voxeldownsize: Invalid 'mode' option '" +
-            s + "'. " "Valid options are 'center' and 'first'");
+            s + "'. " "Valid options are 'center', 'first' and 'centroid'");
     return in;
 }
 
@@ -76,6 +78,9 @@ std::ostream& operator<<(std::ostream& out,
     case VoxelDownsizeFilter::Mode::First:
         out << "first";
         break;
+    case VoxelDownsizeFilter::Mode::Centroid:
+        out << "centroid";
+        break;
     }
     return out;
 }
@@ -93,24 +98,54 @@ std::string VoxelDownsizeFilter::getName() const
 void VoxelDownsizeFilter::addArgs(ProgramArgs& args)
 {
     args.add("cell", "Cell size", m_cell, 0.001);
-    args.add("mode", "Method for downsizing : center / first",
+    args.add("mode", "Method for downsizing : center / first / centroid",
         m_mode, Mode::Center);
+    args.add("evict_after", "Forget voxels in regions that haven't received "
+        "a point within this many points (0 = never)", m_evictAfter,
+        (uint64_t)0);
 }
 
 
 void VoxelDownsizeFilter::ready(PointTableRef)
-{ m_populatedVoxels.clear(); }
+{
+    m_voxels = VoxelStore(m_evictAfter);
+    m_originSet = false;
+    m_voxelCount = 0;
+}
 
 
 PointViewSet VoxelDownsizeFilter::run(PointViewPtr view)
 {
     PointViewPtr output = view->makeNew();
     PointRef point(*view);
+    const uint32_t first = m_voxelCount;
     for (PointId id = 0; id < view->size(); ++id)
     {
         point.setPointId(id);
-        if (voxelize(point))
+        if (m_mode != Mode::Centroid)
+        {
+            if (voxelize(point))
+                output->appendPoint(*view, id);
+            continue;
+        }
+
+        // Points of voxels retained from a previous view are dropped.
+        int64_t voxel[3];
+        std::pair<uint32_t, bool> v = findVoxel(point, voxel);
+        if (v.second)
+        {
+            m_centroids.push_back({ output->size(), 0, 0, 0, 0 });
             output->appendPoint(*view, id);
+        }
+        uint32_t slot = v.first - first;
+        if (slot < m_centroids.size())
+            addToCentroid(point, m_centroids[slot]);
+    }
+
+    if (m_mode == Mode::Centroid)
+    {
+        PointRef outPoint(*output);
+        moveToCentroids(outPoint);
     }
 
     PointViewSet viewSet;
@@ -119,7 +154,42 @@ PointViewSet VoxelDownsizeFilter::run(PointViewPtr view)
 }
 
 
-bool VoxelDownsizeFilter::voxelize(PointRef& point)
+// In centroid mode, each retained point is moved to the centroid of the
+// points of its voxel in the batch.  Points of the voxel in later batches
+// can no longer change the retained point and are dropped.  For data
+// ordered in time most points of a voxel arrive together, so this is
+// usually close to the centroid of all the points in the voxel.
+point_count_t VoxelDownsizeFilter::processBatch(StreamPointTable& table,
+    PointId begin, point_count_t count)
+{
+    if (m_mode != Mode::Centroid)
+        return Streamable::processBatch(table, begin, count);
+
+    PointRef point(table, begin);
+    const uint32_t first = m_voxelCount;
+    for (PointId idx : table.activeIds(begin, count))
+    {
+        point.setPointId(idx);
+        int64_t voxel[3];
+        std::pair<uint32_t, bool> v = findVoxel(point, voxel);
+        if (v.second)
+            m_centroids.push_back({ idx, 0, 0, 0, 0 });
+        else
+            table.setSkip(idx);
+        uint32_t slot = v.first - first;
+        if (slot < m_centroids.size())
+            addToCentroid(point, m_centroids[slot]);
+    }
+    moveToCentroids(point);
+    return count;
+}
+
+
+// Find the voxel of a point, adding it if it's new.  Returns the sequence
+// number of the voxel and whether it was added.  Sequence numbers wrap,
+// which is harmless since they're only compared with recent ones.
+std::pair<uint32_t, bool> VoxelDownsizeFilter::findVoxel(PointRef& point,
+    int64_t *voxel)
 {
     /*
      * Calculate the voxel coordinates for the incoming point.
@@ -128,11 +198,12 @@ bool VoxelDownsizeFilter::voxelize(PointRef& point)
     double x = point.getFieldAs<double>(Dimension::Id::X);
     double y = point.getFieldAs<double>(Dimension::Id::Y);
     double z = point.getFieldAs<double>(Dimension::Id::Z);
-    if (m_populatedVoxels.empty())
+    if (!m_originSet)
     {
         m_originX = x - (m_cell / 2);
         m_originY = y - (m_cell / 2);
         m_originZ = z - (m_cell / 2);
+        m_originSet = true;
     }
 
     // Offset by origin.
@@ -140,22 +211,55 @@ bool VoxelDownsizeFilter::voxelize(PointRef& point)
     y -= m_originY;
     z -= m_originZ;
 
-    Voxel v = std::make_tuple((int)(std::floor(x / m_cell)),
-        (int)(std::floor(y / m_cell)), (int)(std::floor(z / m_cell)));
+    voxel[0] = (int64_t)std::floor(x / m_cell);
+    voxel[1] = (int64_t)std::floor(y / m_cell);
+    voxel[2] = (int64_t)std::floor(z / m_cell);
+    std::pair<uint32_t, bool> v = m_voxels.insert(voxel[0], voxel[1],
+        voxel[2], m_voxelCount);
+    if (v.second)
+        m_voxelCount++;
+    return v;
+}
+
 
-    auto inserted = m_populatedVoxels.insert(v).second;
+bool VoxelDownsizeFilter::voxelize(PointRef& point)
+{
+    int64_t v[3];
+    bool inserted = findVoxel(point, v).second;
     if ((m_mode == Mode::Center) && inserted)
     {
-        point.setField(Dimension::Id::X,
-            (std::get<0>(v) + 0.5) * m_cell + m_originX);
-        point.setField(Dimension::Id::Y,
-            (std::get<1>(v) + 0.5) * m_cell + m_originY);
-        point.setField(Dimension::Id::Z,
-            (std::get<2>(v) + 0.5) * m_cell + m_originZ);
+        point.setField(Dimension::Id::X, (v[0] + 0.5) * m_cell + m_originX);
+        point.setField(Dimension::Id::Y, (v[1] + 0.5) * m_cell + m_originY);
+        point.setField(Dimension::Id::Z, (v[2] + 0.5) * m_cell + m_originZ);
     }
     return inserted;
 }
 
+
+void VoxelDownsizeFilter::addToCentroid(PointRef& point, Centroid& c)
+{
+    c.m_x += point.getFieldAs<double>(Dimension::Id::X);
+    c.m_y += point.getFieldAs<double>(Dimension::Id::Y);
+    c.m_z += point.getFieldAs<double>(Dimension::Id::Z);
+    c.m_count++;
+}
+
+
+// Move each retained point to the centroid of its voxel and start over
+// with the next view or batch.
+void VoxelDownsizeFilter::moveToCentroids(PointRef& point)
+{
+    for (const Centroid& c : m_centroids)
+    {
+        point.setPointId(c.m_id);
+        point.setField(Dimension::Id::X, c.m_x / c.m_count);
+        point.setField(Dimension::Id::Y, c.m_y / c.m_count);
+        point.setField(Dimension::Id::Z, c.m_z / c.m_count);
+    }
+    m_centroids.clear();
+}
+
+
 bool VoxelDownsizeFilter::processOne(PointRef& point)
 {
     return voxelize(point);
@@ -39,6 +39,8 @@
 #include <pdal/Filter.hpp>
 #include <pdal/Streamable.hpp>
 
+#include "private/VoxelStore.hpp"
+
 namespace pdal
 {
 
@@ -47,11 +49,21 @@ class PointView;
 
 class PDAL_DLL VoxelDownsizeFilter : public Filter, public Streamable
 {
-    using Voxel = std::tuple<int, int, int>;
     enum class Mode
     {
         First,
-        Center
+        Center,
+        Centroid
+    };
+
+    // Running sum of the points of a voxel, for centroid mode.
+    struct Centroid
+    {
+        PointId m_id;
+        double m_x;
+        double m_y;
+        double m_z;
+        point_count_t m_count;
     };
 public:
     VoxelDownsizeFilter();
@@ -65,14 +77,25 @@ private:
     virtual PointViewSet run(PointViewPtr view) override;
     virtual void ready(PointTableRef) override;
     virtual bool processOne(PointRef& point) override;
+    virtual point_count_t processBatch(StreamPointTable& table, PointId begin,
+        point_count_t count) override;
 
+    std::pair<uint32_t, bool> findVoxel(PointRef& point, int64_t *voxel);
     bool voxelize(PointRef& point);
+    void addToCentroid(PointRef& point, Centroid& c);
+    void moveToCentroids(PointRef& point);
 
     double m_cell;
     double m_originX;
     double m_originY;
     double m_originZ;
-    std::set<Voxel> m_populatedVoxels;
+    bool m_originSet;
+    VoxelStore m_voxels;
+    uint64_t m_evictAfter;
+    // Number of voxels found so far, used to tell the voxels found in
+    // the current view or batch from those found before.
+    uint32_t m_voxelCount;
+    std::vector<Centroid> m_centroids;
     Mode m_mode;
 
     friend std::istream& operator>>(std::istream& in,
@@ -0,0 +1,361 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#include "DelaunayStrips.hpp"
+#include "delaunator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <unordered_map>
+
+#include <pdal/util/TaskScheduler.hpp>
+
+namespace pdal
+{
+namespace Delaunay
+{
+
+namespace
+{
+
+// Below this many points per strip, splitting isn't worth it.
+const std::size_t MinStripPoints = 1000;
+
+using delaunator::INVALID_INDEX;
+
+std::size_t nextHalfedge(std::size_t e)
+{
+    return (e % 3 == 2) ? e - 2 : e + 1;
+}
+
+struct Strip
+{
+    std::vector<std::size_t> ids;        // Points in the strip.
+    double lo;                           // Largest X of the strip to the left.
+    double hi;                           // Smallest X of the strip to the right.
+    std::vector<std::size_t> triangles;  // Triangles known to be final.
+    std::vector<std::size_t> edges;      // Final triangle edges on the
+                                         //   border of the final region.
+    std::vector<std::size_t> shared;     // Points to triangulate again.
+};
+
+// A triangle is final when its circumcircle lies strictly between the
+// strips on either side, since no point of another strip can then be
+// in the circle.
+bool inStrip(const double *a, const double *b, const double *c,
+    double lo, double hi)
+{
+    const double dx = b[0] - a[0];
+    const double dy = b[1] - a[1];
+    const double ex = c[0] - a[0];
+    const double ey = c[1] - a[1];
+    const double bl = dx * dx + dy * dy;
+    const double cl = ex * ex + ey * ey;
+    const double d = 0.5 / (dx * ey - dy * ex);
+    const double x = (ey * bl - dy * cl) * d;
+    const double y = (dx * cl - ex * bl) * d;
+    const double r = std::sqrt(x * x + y * y);
+    const double cx = a[0] + x;
+    if (!std::isfinite(cx) || !std::isfinite(r))
+        return false;
+
+    const double tol = 1e-9 * (std::fabs(cx) + r);
+    return cx - r - tol > lo && cx + r + tol < hi;
+}
+
+void triangulateStrip(const std::vector<double>& coords, Strip& s)
+{
+    const std::size_t n = s.ids.size();
+    std::vector<double> local;
+    local.reserve(2 * n);
+    for (std::size_t id : s.ids)
+    {
+        local.push_back(coords[2 * id]);
+        local.push_back(coords[2 * id + 1]);
+    }
+
+    // Delaunator needs at least two distinct points and throws if the points
+    // are collinear.  Such a strip is handed over whole.
+    bool distinct = false;
+    for (std::size_t i = 1; i < n && !distinct; ++i)
+        distinct = local[2 * i] != local[0] || local[2 * i + 1] != local[1];
+    std::unique_ptr<delaunator::Delaunator> d;
+    if (n >= 3 && distinct)
+    {
+        try
+        {
+            d.reset(new delaunator::Delaunator(local));
+        }
+        catch (const std::runtime_error&)
+        {}
+    }
+    if (!d)
+    {
+        s.shared = s.ids;
+        return;
+    }
+
+    const std::vector<std::size_t>& tris = d->triangles;
+    const std::vector<std::size_t>& half = d->halfedges;
+    const std::size_t ntri = tris.size() / 3;
+
+    std::vector<char> final(ntri);
+    for (std::size_t t = 0; t < ntri; ++t)
+        final[t] = inStrip(local.data() + 2 * tris[3 * t],
+            local.data() + 2 * tris[3 * t + 1],
+            local.data() + 2 * tris[3 * t + 2], s.lo, s.hi);
+
+    std::vector<char> keep(n);
+    for (std::size_t t = 0; t < ntri; ++t)
+    {
+        if (!final[t])
+        {
+            for (std::size_t e = 3 * t; e < 3 * t + 3; ++e)
+                keep[tris[e]] = 1;
+            continue;
+        }
+        for (std::size_t e = 3 * t; e < 3 * t + 3; ++e)
+        {
+            s.triangles.push_back(s.ids[tris[e]]);
+            const std::size_t o = half[e];
+            if (o == INVALID_INDEX || !final[o / 3])
+            {
+                s.edges.push_back(s.ids[tris[e]]);
+                s.edges.push_back(s.ids[tris[nextHalfedge(e)]]);
+            }
+        }
+    }
+
+    // Points on the hull of the strip may connect to points of the strips
+    // on either side even if all their triangles are final.
+    std::size_t h = d->hull_start;
+    do
+    {
+        keep[h] = 1;
+        h = d->hull_next[h];
+    } while (h != d->hull_start);
+
+    for (std::size_t i = 0; i < n; ++i)
+        if (keep[i])
+            s.shared.push_back(s.ids[i]);
+}
+
+// Split the points into strips by X.  Points with the same X always end up
+// in the same strip so that the X ranges of the strips don't overlap.
+std::vector<Strip> split(const std::vector<double>& coords, int count)
+{
+    const std::size_t n = coords.size() / 2;
+    std::vector<std::size_t> order(n);
+    for (std::size_t i = 0; i < n; ++i)
+        order[i] = i;
+
+    auto xLess = [&coords](std::size_t a, std::size_t b)
+        { return coords[2 * a] < coords[2 * b]; };
+
+    std::vector<std::size_t> pos;
+    for (int i = 1; i < count; ++i)
+        pos.push_back(i * n / count);
+
+    // Place each split position by halving the set of positions, which
+    // leaves every strip's points between its split positions.
+    struct Range
+    {
+        std::size_t begin;
+        std::size_t end;
+        std::size_t posBegin;
+        std::size_t posEnd;
+    };
+    std::vector<Range> ranges { { 0, n, 0, pos.size() } };
+    while (ranges.size())
+    {
+        Range r = ranges.back();
+        ranges.pop_back();
+        if (r.posBegin == r.posEnd)
+            continue;
+        std::size_t mid = (r.posBegin + r.posEnd) / 2;
+        std::nth_element(order.begin() + r.begin, order.begin() + pos[mid],
+            order.begin() + r.end, xLess);
+        ranges.push_back({ r.begin, pos[mid], r.posBegin, mid });
+        ranges.push_back({ pos[mid] + 1, r.end, mid + 1, r.posEnd });
+    }
+
+    // Move the points with the same X as the split point into the strip
+    // to the right.
+    std::vector<Strip> strips;
+    std::size_t begin = 0;
+    pos.push_back(n);
+    for (std::size_t p : pos)
+    {
+        std::size_t end = p;
+        if (p < n)
+        {
+            const double x = coords[2 * order[p]];
+            end = std::partition(order.begin() + begin, order.begin() + p,
+                [&coords, x](std::size_t i){ return coords[2 * i] < x; }) -
+                order.begin();
+        }
+        if (end == begin)
+            continue;
+        Strip s;
+        s.ids.assign(order.begin() + begin, order.begin() + end);
+        strips.push_back(std::move(s));
+        begin = end;
+    }
+
+    for (std::size_t i = 0; i < strips.size(); ++i)
+    {
+        Strip& s = strips[i];
+        s.lo = -(std::numeric_limits<double>::max)();
+        s.hi = (std::numeric_limits<double>::max)();
+        if (i > 0)
+        {
+            const std::vector<std::size_t>& ids = strips[i - 1].ids;
+            s.lo = coords[2 * *std::max_element(ids.begin(), ids.end(),
+                xLess)];
+        }
+        if (i + 1 < strips.size())
+        {
+            const std::vector<std::size_t>& ids = strips[i + 1].ids;
+            s.hi = coords[2 * *std::min_element(ids.begin(), ids.end(),
+                xLess)];
+        }
+    }
+    return strips;
+}
+
+// Triangulate the points that aren't surrounded by final triangles and
+// add the triangles outside of the final region to 'out'.  Returns false
+// if a border edge of the final region isn't in the triangulation.
+bool stitch(const std::vector<double>& coords,
+    const std::vector<Strip>& strips, std::vector<std::size_t>& out)
+{
+    std::vector<std::size_t> shared;
+    for (const Strip& s : strips)
+        shared.insert(shared.end(), s.shared.begin(), s.shared.end());
+    std::sort(shared.begin(), shared.end());
+
+    std::unordered_map<std::size_t, std::size_t> localId;
+    std::vector<double> local;
+    local.reserve(2 * shared.size());
+    for (std::size_t i = 0; i < shared.size(); ++i)
+    {
+        localId[shared[i]] = i;
+        local.push_back(coords[2 * shared[i]]);
+        local.push_back(coords[2 * shared[i] + 1]);
+    }
+    delaunator::Delaunator d(local);
+    const std::vector<std::size_t>& tris = d.triangles;
+    const std::vector<std::size_t>& half = d.halfedges;
+
+    const uint64_t m = shared.size();
+    std::unordered_map<uint64_t, std::size_t> edges;
+    edges.reserve(tris.size());
+    for (std::size_t e = 0; e < tris.size(); ++e)
+        edges[tris[e] * m + tris[nextHalfedge(e)]] = e;
+
+    // Block the border edges and flood the final region from them.
+    std::vector<char> blocked(tris.size());
+    std::vector<std::size_t> stack;
+    for (const Strip& s : strips)
+        for (std::size_t i = 0; i < s.edges.size(); i += 2)
+        {
+            auto a = localId.find(s.edges[i]);
+            auto b = localId.find(s.edges[i + 1]);
+            if (a == localId.end() || b == localId.end())
+                return false;
+            auto ei = edges.find(a->second * m + b->second);
+            if (ei == edges.end())
+                return false;
+            const std::size_t e = ei->second;
+            blocked[e] = 1;
+            if (half[e] != INVALID_INDEX)
+                blocked[half[e]] = 1;
+            stack.push_back(e / 3);
+        }
+
+    std::vector<char> inFinal(tris.size() / 3);
+    while (stack.size())
+    {
+        const std::size_t t = stack.back();
+        stack.pop_back();
+        if (inFinal[t])
+            continue;
+        inFinal[t] = 1;
+        for (std::size_t e = 3 * t; e < 3 * t + 3; ++e)
+            if (!blocked[e] && half[e] != INVALID_INDEX)
+                stack.push_back(half[e] / 3);
+    }
+
+    for (std::size_t t = 0; t < inFinal.size(); ++t)
+        if (!inFinal[t])
+            for (std::size_t e = 3 * t; e < 3 * t + 3; ++e)
+                out.push_back(shared[tris[e]]);
+    return true;
+}
+
+} // unnamed namespace
+
+
+std::vector<std::size_t> triangulate(const std::vector<double>& coords,
+    int strips)
+{
+    const std::size_t n = coords.size() / 2;
+    if (strips > 1 && n >= strips * MinStripPoints)
+    {
+        std::vector<Strip> stripList = split(coords, strips);
+
+        parallelFor(stripList.size(), stripList.size(),
+            [&coords, &stripList](std::size_t i)
+            { triangulateStrip(coords, stripList[i]); });
+
+        std::vector<std::size_t> out;
+        for (Strip& s : stripList)
+        {
+            out.insert(out.end(), s.triangles.begin(), s.triangles.end());
+            std::vector<std::size_t>().swap(s.triangles);
+        }
+        if (stitch(coords, stripList, out))
+            return out;
+    }
+
+    delaunator::Delaunator d(coords);
+    return std::move(d.triangles);
+}
+
+} // namespace Delaunay
+} // namespace pdal
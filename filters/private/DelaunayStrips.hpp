@@ -0,0 +1,65 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace pdal
+{
+namespace Delaunay
+{
+
+/**
+  Compute the 2D Delaunay triangulation of a set of points.
+
+  The points are split by X into (at most) \a strips strips of similar size
+  that are triangulated on their own threads.  Triangles whose circumcircle
+  is well inside their strip are triangles of the full triangulation.  The
+  points of the remaining triangles and the hulls of the strips are then
+  triangulated together to fill the gaps between the strips.  If the
+  stitching can't be done (degenerate input), the points are triangulated
+  on a single thread.
+
+  \param coords  X and Y of each point, one after the other.
+  \param strips  Number of strips (and threads).
+  \return  Indices of the vertices of each triangle, three per triangle,
+    oriented as delaunator orients them.
+*/
+std::vector<std::size_t> triangulate(const std::vector<double>& coords,
+    int strips);
+
+} // namespace Delaunay
+} // namespace pdal
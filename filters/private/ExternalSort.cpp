@@ -0,0 +1,353 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include "ExternalSort.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <queue>
+#include <random>
+#include <sstream>
+#include <utility>
+
+#include <arbiter/arbiter.hpp>
+
+#include <pdal/util/FileUtils.hpp>
+
+namespace pdal
+{
+
+namespace
+{
+
+// Maximum number of runs merged at once, which bounds the number of open
+// files.  More runs are merged in several passes.
+const std::size_t MaxMergeWidth = 64;
+
+// Number of bytes of records written to a run file at once.
+const std::size_t WriteBlockSize = 1 << 20;
+
+uint64_t recordKey(const char *rec)
+{
+    uint64_t key;
+    std::memcpy(&key, rec, sizeof(key));
+    return key;
+}
+
+} // unnamed namespace
+
+
+// Sorted records in a temporary file.
+struct ExternalSort::Run
+{
+    Run(const std::string& file) : m_file(file), m_count(0), m_left(0),
+        m_pos(0), m_end(0)
+    {}
+
+    ~Run()
+        { FileUtils::deleteFile(m_file); }
+
+    // Open the file and read its first block of records.
+    void open(std::size_t blockRecords, std::size_t recordSize)
+    {
+        m_in.open(m_file, std::ios::in | std::ios::binary);
+        if (!m_in)
+            throw pdal_error("Unable to open temporary file '" + m_file +
+                "'.");
+        m_block.resize(blockRecords * recordSize);
+        m_left = m_count;
+        fill(recordSize);
+    }
+
+    // Read the next block of records.  Returns false when the run is
+    // exhausted.
+    bool fill(std::size_t recordSize)
+    {
+        point_count_t count = (std::min)(m_left,
+            (point_count_t)(m_block.size() / recordSize));
+        m_pos = 0;
+        m_end = count * recordSize;
+        if (count == 0)
+            return false;
+        m_in.read(m_block.data(), m_end);
+        if (!m_in)
+            throw pdal_error("Unable to read temporary file '" + m_file +
+                "'.");
+        m_left -= count;
+        return true;
+    }
+
+    // Move to the next record.  Returns false when the run is exhausted.
+    bool advance(std::size_t recordSize)
+    {
+        m_pos += recordSize;
+        return m_pos < m_end || fill(recordSize);
+    }
+
+    const char *record() const
+        { return m_block.data() + m_pos; }
+
+    std::string m_file;
+    point_count_t m_count;
+    std::ifstream m_in;
+    std::vector<char> m_block;
+    point_count_t m_left;
+    std::size_t m_pos;
+    std::size_t m_end;
+};
+
+
+// K-way merge of runs.  Ties are broken by the position of the run in the
+// list, which keeps the merge stable as long as the runs are listed in the
+// order their points were added.
+class ExternalSort::Merger
+{
+public:
+    Merger(RunList runs, std::size_t recordSize, uint64_t memory) :
+        m_runs(std::move(runs)), m_recordSize(recordSize), m_last(-1)
+    {
+        const uint64_t blockRecords = (std::max)((uint64_t)1,
+            memory / m_runs.size() / m_recordSize);
+        for (std::size_t i = 0; i < m_runs.size(); ++i)
+        {
+            Run& run = *m_runs[i];
+            run.open((std::size_t)(std::min)(blockRecords,
+                (std::max)((uint64_t)run.m_count, (uint64_t)1)),
+                m_recordSize);
+            if (run.m_end)
+                m_heap.push({ recordKey(run.record()), i });
+        }
+    }
+
+    // Get the next record in key order, or null when all runs are
+    // exhausted.  The record is valid until the next call.
+    const char *next()
+    {
+        if (m_last >= 0)
+        {
+            Run& run = *m_runs[m_last];
+            if (run.advance(m_recordSize))
+                m_heap.push({ recordKey(run.record()), (std::size_t)m_last });
+            else
+                m_runs[m_last].reset();
+            m_last = -1;
+        }
+        if (m_heap.empty())
+            return nullptr;
+        m_last = (int)m_heap.top().second;
+        m_heap.pop();
+        return m_runs[m_last]->record();
+    }
+
+private:
+    using HeapEntry = std::pair<uint64_t, std::size_t>;
+
+    RunList m_runs;
+    std::size_t m_recordSize;
+    int m_last;
+    std::priority_queue<HeapEntry, std::vector<HeapEntry>,
+        std::greater<HeapEntry>> m_heap;
+};
+
+
+ExternalSort::ExternalSort(PointLayoutPtr layout, uint64_t memory,
+        const std::string& tempDir) :
+    m_dims(layout->dimTypes()),
+    m_recordSize(sizeof(uint64_t) + layout->pointSize()), m_memory(memory),
+    m_runCount(0), m_merging(false), m_pos(0)
+{
+    // Each point held takes its record and the entry and scratch space
+    // used to sort it.
+    m_capacity = (std::max)((uint64_t)1,
+        memory / (m_recordSize + 2 * sizeof(radix::Entry)));
+
+    // Temporary files are named uniquely so that several sorts may share
+    // a directory.
+    std::random_device rd;
+    std::ostringstream oss;
+    oss << (tempDir.empty() ? arbiter::getTempPath() : tempDir) <<
+        "/pdal-sort-" << std::hex << rd() << rd() << "-";
+    m_tempPrefix = oss.str();
+}
+
+
+ExternalSort::~ExternalSort()
+{}
+
+
+void ExternalSort::add(const PointRef& point, uint64_t key)
+{
+    if (m_merging)
+        throw pdal_error("Can't add points to a sort whose points are "
+            "being retrieved.");
+
+    // Grow the buffer in steps, but never beyond the run's capacity.
+    const std::size_t pos = m_data.size();
+    if (pos + m_recordSize > m_data.capacity())
+        m_data.reserve((std::min)((std::max)(m_data.capacity() * 2,
+            1024 * m_recordSize), m_capacity * m_recordSize));
+    m_data.resize(pos + m_recordSize);
+
+    char *rec = m_data.data() + pos;
+    std::memcpy(rec, &key, sizeof(key));
+    point.getPackedData(m_dims, rec + sizeof(key));
+
+    if (m_data.size() / m_recordSize >= m_capacity)
+        spill();
+}
+
+
+std::unique_ptr<ExternalSort::Run> ExternalSort::createRun()
+{
+    return std::unique_ptr<Run>(
+        new Run(m_tempPrefix + std::to_string(m_runCount++)));
+}
+
+
+// Sort the records held in memory and write them to a new run.
+void ExternalSort::spill()
+{
+    const point_count_t count = m_data.size() / m_recordSize;
+    if (count == 0)
+        return;
+
+    const char *data = m_data.data();
+    const std::size_t recordSize = m_recordSize;
+    radix::EntryList entries = radix::makeEntries(count, 1,
+        [data, recordSize](PointId idx)
+            { return recordKey(data + idx * recordSize); });
+    radix::sort(entries);
+
+    std::unique_ptr<Run> run(createRun());
+    std::ofstream out(run->m_file, std::ios::out | std::ios::binary);
+    std::vector<char> block;
+    block.reserve(WriteBlockSize + m_recordSize);
+    for (const radix::Entry& e : entries)
+    {
+        const char *rec = data + e.id * m_recordSize;
+        block.insert(block.end(), rec, rec + m_recordSize);
+        if (block.size() >= WriteBlockSize)
+        {
+            out.write(block.data(), block.size());
+            block.clear();
+        }
+    }
+    out.write(block.data(), block.size());
+    if (!out)
+        throw pdal_error("Unable to write temporary file '" + run->m_file +
+            "'.");
+    run->m_count = count;
+    m_runs.push_back(std::move(run));
+    m_data.clear();
+}
+
+
+// Prepare to retrieve points.  Points that fit in memory are sorted in
+// place.  Otherwise the last run is written and runs are merged until few
+// enough remain to be merged at once.
+void ExternalSort::finish()
+{
+    m_merging = true;
+    if (m_runs.empty())
+    {
+        const char *data = m_data.data();
+        const std::size_t recordSize = m_recordSize;
+        m_sorted = radix::makeEntries(m_data.size() / m_recordSize, 1,
+            [data, recordSize](PointId idx)
+                { return recordKey(data + idx * recordSize); });
+        radix::sort(m_sorted);
+        return;
+    }
+
+    spill();
+    std::vector<char>().swap(m_data);
+
+    while (m_runs.size() > MaxMergeWidth)
+    {
+        RunList merged;
+        for (std::size_t i = 0; i < m_runs.size(); i += MaxMergeWidth)
+        {
+            std::size_t end = (std::min)(i + MaxMergeWidth, m_runs.size());
+            RunList group;
+            for (std::size_t j = i; j < end; ++j)
+                group.push_back(std::move(m_runs[j]));
+
+            std::unique_ptr<Run> run(createRun());
+            std::ofstream out(run->m_file, std::ios::out | std::ios::binary);
+            std::vector<char> block;
+            block.reserve(WriteBlockSize + m_recordSize);
+            Merger merger(std::move(group), m_recordSize, m_memory / 2);
+            while (const char *rec = merger.next())
+            {
+                block.insert(block.end(), rec, rec + m_recordSize);
+                if (block.size() >= WriteBlockSize)
+                {
+                    out.write(block.data(), block.size());
+                    block.clear();
+                }
+                run->m_count++;
+            }
+            out.write(block.data(), block.size());
+            if (!out)
+                throw pdal_error("Unable to write temporary file '" +
+                    run->m_file + "'.");
+            merged.push_back(std::move(run));
+        }
+        m_runs = std::move(merged);
+    }
+    m_merger.reset(new Merger(std::move(m_runs), m_recordSize, m_memory));
+}
+
+
+bool ExternalSort::next(PointRef& point)
+{
+    if (!m_merging)
+        finish();
+
+    const char *rec;
+    if (m_merger)
+        rec = m_merger->next();
+    else if (m_pos < m_sorted.size())
+        rec = m_data.data() + m_sorted[m_pos++].id * m_recordSize;
+    else
+        rec = nullptr;
+
+    if (!rec)
+        return false;
+    point.setPackedData(m_dims, rec + sizeof(uint64_t));
+    return true;
+}
+
+} // namespace pdal
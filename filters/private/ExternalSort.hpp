@@ -0,0 +1,125 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <pdal/PointLayout.hpp>
+#include <pdal/PointRef.hpp>
+
+#include "RadixSort.hpp"
+
+namespace pdal
+{
+
+/**
+  Sort of points by key whose size isn't limited by the available memory.
+
+  Points are added with their sort keys.  When the points held reach the
+  memory limit, they're sorted and written to a temporary file as a run.
+  Once all points have been added, the runs are merged and the points are
+  returned in key order.  Points with equal keys are returned in the order
+  in which they were added.  No files are written if all points fit in
+  memory.
+*/
+class PDAL_DLL ExternalSort
+{
+public:
+    /**
+      Create a sort.
+
+      \param layout  Layout of the points to sort.
+      \param memory  Approximate number of bytes used to hold points.
+      \param tempDir  Directory for temporary files.  If empty, the
+        system temporary directory is used.
+    */
+    ExternalSort(PointLayoutPtr layout, uint64_t memory,
+        const std::string& tempDir = "");
+    ~ExternalSort();
+
+    /**
+      Add a point.
+
+      \param point  Point to add.
+      \param key  Sort key of the point.
+    */
+    void add(const PointRef& point, uint64_t key);
+
+    /**
+      Get the next point in key order.  No points may be added once this
+      has been called.
+
+      \param point  Point to fill with the data of the next point.
+      \return  Whether a point was available.
+    */
+    bool next(PointRef& point);
+
+    /**
+      Get the number of runs written to temporary files.
+
+      \return  Number of runs.
+    */
+    std::size_t runCount() const
+        { return m_runCount; }
+
+private:
+    struct Run;
+    class Merger;
+    using RunList = std::vector<std::unique_ptr<Run>>;
+
+    void spill();
+    void finish();
+    std::unique_ptr<Run> createRun();
+
+    DimTypeList m_dims;
+    std::size_t m_recordSize;
+    uint64_t m_memory;
+    point_count_t m_capacity;
+    std::string m_tempPrefix;
+    std::size_t m_runCount;
+    bool m_merging;
+
+    // Records, each a key followed by packed point data, of the run
+    // being assembled.
+    std::vector<char> m_data;
+    radix::EntryList m_sorted;
+    std::size_t m_pos;
+    RunList m_runs;
+    std::unique_ptr<Merger> m_merger;
+};
+
+} // namespace pdal
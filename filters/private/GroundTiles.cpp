@@ -0,0 +1,177 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include "GroundTiles.hpp"
+
+#include <pdal/PointView.hpp>
+#include <pdal/util/Bounds.hpp>
+#include <pdal/util/ProgramArgs.hpp>
+#include <pdal/util/TaskScheduler.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace pdal
+{
+
+namespace
+{
+
+// Index of the tile holding a coordinate, clamped to the tiles that exist.
+int tileIndex(double v, double min, double size, int count)
+{
+    int i = (int)std::floor((v - min) / size);
+    return (std::min)((std::max)(i, 0), count - 1);
+}
+
+} // unnamed namespace
+
+GroundTiles::GroundTiles() : m_tileSize(0.0), m_buffer(0.0), m_threads(1),
+    m_bufferArg(nullptr)
+{}
+
+
+void GroundTiles::addArgs(ProgramArgs& args)
+{
+    args.add("tile_size", "Size of the tiles classified separately. "
+        "Zero classifies the view as a whole", m_tileSize, 0.0);
+    m_bufferArg = &args.add("buffer", "Width of the buffer classified "
+        "around each tile", m_buffer);
+    args.add("threads", "Number of threads used to classify tiles",
+        m_threads, 1);
+}
+
+
+void GroundTiles::classify(PointViewPtr view, double reach, LogPtr log,
+    Classifier classifier) const
+{
+    using namespace Dimension;
+
+    if (!tiled())
+    {
+        classifier(view, log);
+        return;
+    }
+
+    const double buffer = (std::max)(0.0, m_bufferArg && m_bufferArg->set() ?
+        m_buffer : reach);
+
+    BOX2D bounds;
+    view->calculateBounds(bounds);
+    const int cols = (int)((bounds.maxx - bounds.minx) / m_tileSize) + 1;
+    const int rows = (int)((bounds.maxy - bounds.miny) / m_tileSize) + 1;
+
+    // Each point of the view belongs to the core of one tile and to the
+    // buffered extent of every tile within 'buffer' of it.
+    std::vector<PointIdList> members((size_t)rows * cols);
+    for (PointId i = 0; i < view->size(); ++i)
+    {
+        double x = view->getFieldAs<double>(Id::X, i);
+        double y = view->getFieldAs<double>(Id::Y, i);
+        int c0 = tileIndex(x - buffer, bounds.minx, m_tileSize, cols);
+        int c1 = tileIndex(x + buffer, bounds.minx, m_tileSize, cols);
+        int r0 = tileIndex(y - buffer, bounds.miny, m_tileSize, rows);
+        int r1 = tileIndex(y + buffer, bounds.miny, m_tileSize, rows);
+        for (int c = c0; c <= c1; ++c)
+            for (int r = r0; r <= r1; ++r)
+                members[(size_t)c * rows + r].push_back(i);
+    }
+
+    const int threads = this->threads();
+    const SpatialReference srs = view->spatialReference();
+
+    // Tiles are copied to tables of their own, so that the classifiers
+    // don't interfere with each other or see the points of the rest of the
+    // view.  The classification of the points in each tile's core is saved
+    // and only written to the view once all tiles are done.
+    std::vector<std::vector<uint8_t>> results(members.size());
+    auto inCore = [&](double x, double y, int c, int r)
+    {
+        return tileIndex(x, bounds.minx, m_tileSize, cols) == c &&
+            tileIndex(y, bounds.miny, m_tileSize, rows) == r;
+    };
+    auto run = [&](int c, int r)
+    {
+        const PointIdList& ids = members[(size_t)c * rows + r];
+
+        PointTable table;
+        table.layout()->registerDims({Id::X, Id::Y, Id::Z,
+            Id::Classification});
+        table.finalize();
+        PointViewPtr tile(new PointView(table, srs));
+
+        bool hasCore = false;
+        for (PointId i = 0; i < ids.size(); ++i)
+        {
+            PointId id = ids[i];
+            double x = view->getFieldAs<double>(Id::X, id);
+            double y = view->getFieldAs<double>(Id::Y, id);
+            hasCore = hasCore || inCore(x, y, c, r);
+            tile->setField(Id::X, i, x);
+            tile->setField(Id::Y, i, y);
+            tile->setField(Id::Z, i, view->getFieldAs<double>(Id::Z, id));
+            tile->setField(Id::Classification, i,
+                view->getFieldAs<uint8_t>(Id::Classification, id));
+        }
+        if (!hasCore)
+            return;
+
+        classifier(tile, threads == 1 ? log : Log::makeLog("", "devnull"));
+
+        std::vector<uint8_t>& result = results[(size_t)c * rows + r];
+        result.resize(ids.size());
+        for (PointId i = 0; i < ids.size(); ++i)
+            result[i] = tile->getFieldAs<uint8_t>(Id::Classification, i);
+    };
+
+    parallelFor((size_t)cols * rows, threads, [&run, rows](std::size_t t)
+        { run((int)(t / rows), (int)(t % rows)); });
+
+    for (int c = 0; c < cols; ++c)
+        for (int r = 0; r < rows; ++r)
+        {
+            const PointIdList& ids = members[(size_t)c * rows + r];
+            const std::vector<uint8_t>& result =
+                results[(size_t)c * rows + r];
+            for (PointId i = 0; i < result.size(); ++i)
+            {
+                PointId id = ids[i];
+                if (inCore(view->getFieldAs<double>(Id::X, id),
+                        view->getFieldAs<double>(Id::Y, id), c, r))
+                    view->setField(Id::Classification, id, result[i]);
+            }
+        }
+}
+
+} // namespace pdal
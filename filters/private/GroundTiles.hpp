@@ -0,0 +1,108 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+
+#include <pdal/Log.hpp>
+#include <pdal/pdal_types.hpp>
+
+namespace pdal
+{
+
+class Arg;
+class PointView;
+class ProgramArgs;
+typedef std::shared_ptr<PointView> PointViewPtr;
+
+/**
+  Tiled execution of the ground classification filters.  The extent of a
+  view is split into square tiles, each tile is classified together with
+  the points in a buffer around it, and only the classification of the
+  points in the tile itself is kept.  As long as the buffer covers the
+  reach of the filter, results have no seams at the tile edges.
+*/
+class PDAL_DLL GroundTiles
+{
+public:
+    /**
+      Classify the points of a tile, held in a view of its own with the X,
+      Y, Z and Classification dimensions.
+    */
+    typedef std::function<void(PointViewPtr, LogPtr)> Classifier;
+
+    GroundTiles();
+
+    /**
+      Add the 'tile_size', 'buffer' and 'threads' options.
+    */
+    void addArgs(ProgramArgs& args);
+
+    /**
+      Whether views are classified by tile.
+    */
+    bool tiled() const
+        { return m_tileSize > 0.0; }
+
+    /**
+      Number of threads requested.
+    */
+    int threads() const
+        { return (std::max)(1, m_threads); }
+
+    /**
+      Classify the points of a view.  When no tile size was set, the view
+      is passed to the classifier as is.  Otherwise tiles are classified on
+      up to 'threads' threads and the Classification of the points of each
+      tile's core is set in the view.
+
+      \param view  View to classify.
+      \param reach  Buffer used when the 'buffer' option wasn't set.
+      \param log  Log passed to the classifier when running on one thread.
+        Concurrent tiles are not logged.
+      \param classifier  Function to classify a tile.
+    */
+    void classify(PointViewPtr view, double reach, LogPtr log,
+        Classifier classifier) const;
+
+private:
+    double m_tileSize;
+    double m_buffer;
+    int m_threads;
+    Arg *m_bufferArg;
+};
+
+} // namespace pdal
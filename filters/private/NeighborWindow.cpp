@@ -0,0 +1,111 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include "NeighborWindow.hpp"
+
+#include <cmath>
+
+#include <pdal/pdal_types.hpp>
+
+namespace pdal
+{
+
+NeighborWindow::NeighborWindow(double radius, point_count_t halo) :
+    m_radius(radius), m_halo(halo), m_first(0)
+{
+    if (!(radius > 0) || !std::isfinite(radius))
+        throw pdal_error("NeighborWindow: radius must be positive.");
+}
+
+
+NeighborWindow::Cell NeighborWindow::cell(double x, double y, double z) const
+{
+    return Cell { (std::int64_t)std::floor(x / m_radius),
+        (std::int64_t)std::floor(y / m_radius),
+        (std::int64_t)std::floor(z / m_radius) };
+}
+
+
+void NeighborWindow::add(double x, double y, double z)
+{
+    m_cells[cell(x, y, z)].push_back(m_first + m_points.size());
+    m_points.push_back(Point { x, y, z });
+}
+
+
+point_count_t NeighborWindow::count(double x, double y, double z) const
+{
+    const Cell c = cell(x, y, z);
+    const double r2 = m_radius * m_radius;
+
+    // Cells are the size of the radius, so the neighbors are in the cell
+    // of the location and those next to it.
+    point_count_t cnt = 0;
+    for (std::int64_t i = c.i - 1; i <= c.i + 1; ++i)
+        for (std::int64_t j = c.j - 1; j <= c.j + 1; ++j)
+            for (std::int64_t k = c.k - 1; k <= c.k + 1; ++k)
+            {
+                auto it = m_cells.find(Cell { i, j, k });
+                if (it == m_cells.end())
+                    continue;
+                for (std::uint64_t seq : it->second)
+                {
+                    const Point& p = m_points[seq - m_first];
+                    double dx = x - p.x;
+                    double dy = y - p.y;
+                    double dz = z - p.z;
+                    if (dx * dx + dy * dy + dz * dz < r2)
+                        cnt++;
+                }
+            }
+    return cnt;
+}
+
+
+void NeighborWindow::trim()
+{
+    // Points leave in the order they arrived, so the oldest point is at the
+    // front of its cell's list.
+    while (m_points.size() > m_halo)
+    {
+        const Point& p = m_points.front();
+        auto it = m_cells.find(cell(p.x, p.y, p.z));
+        it->second.pop_front();
+        if (it->second.empty())
+            m_cells.erase(it);
+        m_points.pop_front();
+        m_first++;
+    }
+}
+
+} // namespace pdal
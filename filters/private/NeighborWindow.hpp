@@ -0,0 +1,129 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+
+#include <pdal/pdal_types.hpp>
+
+namespace pdal
+{
+
+/**
+  Index of the most recent points of a stream, used to find the neighbors
+  of streamed points within a fixed radius.  Points are held in 3D cells
+  the size of the radius.  Points are added as they arrive and the oldest
+  are dropped by trim() once more than the halo size have been kept, so
+  memory use is bounded by the halo and the number of points added between
+  calls to trim().
+*/
+class PDAL_DLL NeighborWindow
+{
+public:
+    /**
+      Create a window.
+
+      \param radius  Search radius.
+      \param halo  Number of points kept after trim().
+    */
+    NeighborWindow(double radius, point_count_t halo);
+
+    /**
+      Add a point to the window.
+    */
+    void add(double x, double y, double z);
+
+    /**
+      Count the points in the window that are within the radius of a
+      location.  As with KD3Index, a point is in the radius when its square
+      distance is less than the square of the radius.  A point in the window
+      at the location itself is counted.
+    */
+    point_count_t count(double x, double y, double z) const;
+
+    /**
+      Drop the oldest points so that no more than the halo size are kept.
+    */
+    void trim();
+
+    /**
+      Number of points in the window.
+    */
+    point_count_t size() const
+        { return m_points.size(); }
+
+private:
+    struct Point
+    {
+        double x;
+        double y;
+        double z;
+    };
+
+    struct Cell
+    {
+        std::int64_t i;
+        std::int64_t j;
+        std::int64_t k;
+
+        bool operator==(const Cell& other) const
+            { return i == other.i && j == other.j && k == other.k; }
+    };
+
+    struct CellHash
+    {
+        std::size_t operator()(const Cell& c) const
+        {
+            std::uint64_t h = ((std::uint64_t)c.i * 73856093) ^
+                ((std::uint64_t)c.j * 19349663) ^
+                ((std::uint64_t)c.k * 83492791);
+            return (std::size_t)(h * 0x9E3779B97F4A7C15ULL);
+        }
+    };
+
+    Cell cell(double x, double y, double z) const;
+
+    double m_radius;
+    point_count_t m_halo;
+    // Points in arrival order.  m_first is the sequence number of the
+    // oldest.
+    std::deque<Point> m_points;
+    std::uint64_t m_first;
+    // Sequence numbers of the points in each cell, oldest first.
+    std::unordered_map<Cell, std::deque<std::uint64_t>, CellHash> m_cells;
+};
+
+} // namespace pdal
@@ -0,0 +1,121 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include "Partition.hpp"
+
+#include <algorithm>
+
+#include <pdal/util/TaskScheduler.hpp>
+
+namespace pdal
+{
+namespace partition
+{
+
+GroupList split(PointView& view, const radix::EntryList& entries,
+    unsigned threads)
+{
+    // Sort the positions of the entries rather than the entries
+    // themselves, so that the first entry of each group is known.
+    radix::EntryList order(entries.size());
+    for (size_t i = 0; i < entries.size(); ++i)
+        order[i] = { entries[i].key, i };
+    radix::sort(order, threads);
+
+    // Find the range of each group in the sorted list, and put groups in
+    // the order of their first entries.
+    struct Range
+    {
+        size_t begin;
+        size_t end;
+    };
+    std::vector<Range> ranges;
+    for (size_t i = 0; i < order.size();)
+    {
+        size_t end = i + 1;
+        while (end < order.size() && order[end].key == order[i].key)
+            end++;
+        ranges.push_back({ i, end });
+        i = end;
+    }
+    std::sort(ranges.begin(), ranges.end(),
+        [&order](const Range& a, const Range& b)
+        { return order[a.begin].id < order[b.begin].id; });
+
+    // Views are made in order, since their IDs set their order in a
+    // PointViewSet.
+    GroupList groups;
+    groups.reserve(ranges.size());
+    for (const Range& r : ranges)
+        groups.push_back({ order[r.begin].key, view.makeNew() });
+
+    auto fill = [&](size_t first, size_t last)
+    {
+        for (size_t g = first; g < last; ++g)
+        {
+            PointView& out = *groups[g].view;
+            for (size_t i = ranges[g].begin; i < ranges[g].end; ++i)
+                out.appendPoint(view, entries[order[i].id].id);
+        }
+    };
+
+    if (threads <= 1 || groups.size() < 2)
+        fill(0, groups.size());
+    else
+    {
+        // Divide the groups among the threads by their number of points.
+        std::vector<size_t> bounds { 0 };
+        size_t done = 0;
+        for (unsigned t = 1; t <= threads && bounds.back() < groups.size();
+            ++t)
+        {
+            const size_t target = entries.size() * t / threads;
+            size_t last = bounds.back();
+            while (last < groups.size() &&
+                (done < target || last == bounds.back()))
+            {
+                done += ranges[last].end - ranges[last].begin;
+                last++;
+            }
+            if (t == threads)
+                last = groups.size();
+            bounds.push_back(last);
+        }
+        parallelFor(bounds.size() - 1, threads, [&fill, &bounds](size_t i)
+            { fill(bounds[i], bounds[i + 1]); });
+    }
+    return groups;
+}
+
+} // namespace partition
+} // namespace pdal
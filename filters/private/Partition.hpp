@@ -0,0 +1,91 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <vector>
+
+#include <pdal/PointView.hpp>
+
+#include "RadixSort.hpp"
+
+namespace pdal
+{
+namespace partition
+{
+
+/**
+  A group of points with the same key.
+*/
+struct Group
+{
+    uint64_t key;
+    PointViewPtr view;
+};
+using GroupList = std::vector<Group>;
+
+/**
+  Split points of a view into groups by key.  The entries are sorted by
+  key with a stable radix sort, so that the points of each group are
+  adjacent in a single list, from which the view of each group is filled.
+  A point can be in several groups if it has several entries.
+
+  \param view  View holding the points.
+  \param entries  Keys and IDs of the points.  A group's points are added
+    to its view in the order of their entries.
+  \param threads  Number of threads used to sort entries and fill views.
+  \return  Groups, in the order of their first entries.
+*/
+PDAL_DLL GroupList split(PointView& view, const radix::EntryList& entries,
+    unsigned threads);
+
+/**
+  Split the points of a view into groups by key.
+
+  \param view  View whose points are split.
+  \param threads  Number of threads used to compute keys, sort and fill
+    views.
+  \param key  Function returning the key of a point, given its ID.  It's
+    called concurrently when \a threads is greater than one.
+  \return  Groups, in the order of their first points.  The points of a
+    group are in the order of the view.
+*/
+template<typename KEYFUNC>
+GroupList byKey(PointView& view, unsigned threads, KEYFUNC key)
+{
+    return split(view, radix::makeEntries(view.size(), threads, key),
+        threads);
+}
+
+} // namespace partition
+} // namespace pdal
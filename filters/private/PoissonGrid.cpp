@@ -0,0 +1,214 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include "PoissonGrid.hpp"
+
+#include <cmath>
+
+#include <pdal/pdal_types.hpp>
+
+namespace pdal
+{
+
+namespace
+{
+
+// A sample closer than the radius can be at most this many cells away
+// along an axis, since the radius spans sqrt(3) cells.
+const int Reach = 2;
+
+// Cell indices must fit comfortably in 64 bits.
+const double MaxCell = 4.0e18;
+
+// Squared distance, in cells, along one axis from a position at fraction
+// 'f' of the way across its cell to the nearest face of the cell 'd'
+// cells away.
+inline double gap2(double f, int d)
+{
+    double g = 0;
+    if (d < 0)
+        g = f + (-d - 1);
+    else if (d > 0)
+        g = d - f;
+    return g * g;
+}
+
+} // unnamed namespace
+
+
+PoissonGrid::Tile::Tile() : m_lastUse(0)
+{
+    m_slots.fill(0);
+}
+
+
+PoissonGrid::PoissonGrid(double radius, uint64_t evictAge) :
+    m_radius2(radius * radius), m_cellSize(radius / std::sqrt(3.0)),
+    m_evictAge(evictAge), m_tick(0)
+{}
+
+
+PoissonGrid::Cell PoissonGrid::cell(double x, double y, double z) const
+{
+    double fx = std::floor(x / m_cellSize);
+    double fy = std::floor(y / m_cellSize);
+    double fz = std::floor(z / m_cellSize);
+    // Written to also reject NaN.
+    if (!(std::abs(fx) < MaxCell && std::abs(fy) < MaxCell &&
+            std::abs(fz) < MaxCell))
+        throw pdal_error("Sample position out of range.  Increase the "
+            "radius.");
+    return Cell { (int64_t)fx, (int64_t)fy, (int64_t)fz };
+}
+
+
+void PoissonGrid::reserve(const Cell& c)
+{
+    m_tiles[tile(c)];
+}
+
+
+bool PoissonGrid::isClear(double x, double y, double z, const Cell& c)
+{
+    // Position within the cell, as a fraction of the cell size.
+    const double fx = x / m_cellSize - c.x;
+    const double fy = y / m_cellSize - c.y;
+    const double fz = z / m_cellSize - c.z;
+    // The radius squared, in cells, with a little slack for rounding in
+    // the fractions above.  Cells farther away can't hold a sample closer
+    // than the radius.
+    const double limit = 3.0 + 1e-9;
+
+    Cell lastKey { 0, 0, 0 };
+    Tile *last = nullptr;
+    bool haveLast = false;
+    for (int dx = -Reach; dx <= Reach; ++dx)
+    {
+        const double gx = gap2(fx, dx);
+        for (int dy = -Reach; dy <= Reach; ++dy)
+        {
+            const double gy = gx + gap2(fy, dy);
+            if (gy >= limit)
+                continue;
+            for (int dz = -Reach; dz <= Reach; ++dz)
+            {
+                if (gy + gap2(fz, dz) >= limit)
+                    continue;
+
+                const Cell n { c.x + dx, c.y + dy, c.z + dz };
+                const Cell key = tile(n);
+                // Neighboring cells are usually in the same tile.
+                if (!haveLast || !(key == lastKey))
+                {
+                    auto it = m_tiles.find(key);
+                    last = (it == m_tiles.end()) ? nullptr : &it->second;
+                    lastKey = key;
+                    haveLast = true;
+                    if (last && m_evictAge)
+                        last->m_lastUse = m_tick;
+                }
+                if (!last)
+                    continue;
+
+                const uint8_t s = last->m_slots[slot(n)];
+                if (!s)
+                    continue;
+                const std::array<double, 3>& p = last->m_points[s - 1];
+                const double ex = p[0] - x;
+                const double ey = p[1] - y;
+                const double ez = p[2] - z;
+                if (ex * ex + ey * ey + ez * ez < m_radius2)
+                    return false;
+            }
+        }
+    }
+    return true;
+}
+
+
+void PoissonGrid::add(double x, double y, double z, const Cell& c)
+{
+    // Don't modify the table of tiles if the tile exists, so that
+    // samples can be added to reserved tiles concurrently.
+    const Cell key = tile(c);
+    auto it = m_tiles.find(key);
+    if (it == m_tiles.end())
+        it = m_tiles.emplace(key, Tile()).first;
+    Tile& t = it->second;
+    if (m_evictAge)
+        t.m_lastUse = m_tick;
+
+    // Two samples in a cell are closer than the radius, so the slot is
+    // only ever taken because of rounding at the edge of a cell.  The
+    // first sample is kept.
+    uint8_t& s = t.m_slots[slot(c)];
+    if (s)
+        return;
+    t.m_points.push_back({ { x, y, z } });
+    s = (uint8_t)t.m_points.size();
+}
+
+
+bool PoissonGrid::insert(double x, double y, double z)
+{
+    m_tick++;
+    if (m_evictAge && m_tick % m_evictAge == 0)
+        evict();
+
+    const Cell c = cell(x, y, z);
+    if (!isClear(x, y, z, c))
+        return false;
+    add(x, y, z, c);
+    return true;
+}
+
+
+void PoissonGrid::evict()
+{
+    for (auto it = m_tiles.begin(); it != m_tiles.end();)
+    {
+        if (m_tick - it->second.m_lastUse > m_evictAge)
+            it = m_tiles.erase(it);
+        else
+            ++it;
+    }
+}
+
+
+void PoissonGrid::clear()
+{
+    m_tiles.clear();
+    m_tick = 0;
+}
+
+} // namespace pdal
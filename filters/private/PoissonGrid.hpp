@@ -0,0 +1,185 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace pdal
+{
+
+/**
+  The accepted samples of a Poisson-disk sampling, for finding whether a
+  new position is at least some radius from all of them.
+
+  Space is divided into cubic cells whose diagonal is the radius, so that
+  a cell holds at most one sample and only the cells within two of the
+  cell of a position need to be checked.  Cells are grouped into tiles of
+  TileSize cells on a side, found by hashing the tile indices, and each
+  tile keeps a compact table of its cells.
+
+  Tiles are assigned to one of eight phases by the parity of their
+  indices.  Tiles of the same phase are separated by at least a full tile,
+  so positions in different tiles of a phase can be checked and added
+  concurrently, provided every tile has been created beforehand with
+  reserve().
+
+  When data arrives spatially ordered, tiles that haven't been used for a
+  while won't be used again.  If an eviction age is set, tiles that
+  haven't been used within that many calls to insert() are discarded.
+*/
+class PoissonGrid
+{
+public:
+    /// Number of cells along each side of a tile.
+    static const int TileBits = 2;
+    static const int TileSize = 1 << TileBits;
+
+    struct Cell
+    {
+        int64_t x;
+        int64_t y;
+        int64_t z;
+
+        bool operator==(const Cell& other) const
+            { return x == other.x && y == other.y && z == other.z; }
+    };
+
+    struct CellHash
+    {
+        size_t operator()(const Cell& c) const
+        {
+            uint64_t h = (uint64_t)c.x * 0x9E3779B97F4A7C15ULL ^
+                (uint64_t)c.y * 0xC2B2AE3D27D4EB4FULL ^
+                (uint64_t)c.z * 0x165667B19E3779F9ULL;
+            return (size_t)(h ^ (h >> 29));
+        }
+    };
+
+    /**
+      \param radius  Minimum distance between samples.
+      \param evictAge  Number of insertions after which a tile that hasn't
+        been used is discarded.  0 disables eviction.
+    */
+    PoissonGrid(double radius, uint64_t evictAge = 0);
+
+    /**
+      Find the cell containing a position.  Throws pdal_error if the
+      position is too far from the origin for the radius.
+    */
+    Cell cell(double x, double y, double z) const;
+
+    /// Indices of the tile containing a cell.
+    static Cell tile(const Cell& c)
+    {
+        // Arithmetic shift rounds toward negative infinity.
+        return Cell { c.x >> TileBits, c.y >> TileBits, c.z >> TileBits };
+    }
+
+    /// Phase, from 0 to 7, of a tile.
+    static int phase(const Cell& tile)
+    {
+        return (int)((tile.x & 1) | ((tile.y & 1) << 1) |
+            ((tile.z & 1) << 2));
+    }
+
+    /// Create the tile holding a cell if it doesn't exist.
+    void reserve(const Cell& c);
+
+    /**
+      Determine if no sample lies closer than the radius to a position.
+
+      \param x  X coordinate of the position.
+      \param y  Y coordinate of the position.
+      \param z  Z coordinate of the position.
+      \param c  Cell containing the position.
+    */
+    bool isClear(double x, double y, double z, const Cell& c);
+
+    /**
+      Add a sample.  The sample should have been checked with isClear().
+
+      \param x  X coordinate of the sample.
+      \param y  Y coordinate of the sample.
+      \param z  Z coordinate of the sample.
+      \param c  Cell containing the sample.
+    */
+    void add(double x, double y, double z, const Cell& c);
+
+    /**
+      Add a sample if no sample lies closer than the radius.
+
+      \return  Whether the sample was added.
+    */
+    bool insert(double x, double y, double z);
+
+    /// Remove all samples.
+    void clear();
+
+    /// Number of tiles in the grid.
+    size_t tileCount() const
+        { return m_tiles.size(); }
+
+private:
+    struct Tile
+    {
+        Tile();
+
+        // One plus the position in m_points of the sample in each cell,
+        // or 0 if the cell is empty.
+        std::array<uint8_t, TileSize * TileSize * TileSize> m_slots;
+        std::vector<std::array<double, 3>> m_points;
+        uint64_t m_lastUse;
+    };
+
+    static size_t slot(const Cell& c)
+    {
+        const int64_t mask = TileSize - 1;
+        return (size_t)((c.x & mask) | ((c.y & mask) << TileBits) |
+            ((c.z & mask) << (2 * TileBits)));
+    }
+
+    void evict();
+
+    std::unordered_map<Cell, Tile, CellHash> m_tiles;
+    double m_radius2;
+    double m_cellSize;
+    uint64_t m_evictAge;
+    uint64_t m_tick;
+};
+
+} // namespace pdal
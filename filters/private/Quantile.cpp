@@ -0,0 +1,258 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include "Quantile.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+
+#include <pdal/util/TaskScheduler.hpp>
+
+namespace pdal
+{
+namespace quantile
+{
+
+namespace
+{
+
+// Below this many values a single thread is faster.
+const size_t MinThreadedSelect = 1 << 20;
+
+// Number of values sampled to bound the search.
+const size_t SampleSize = 1 << 14;
+
+// Positions in the sorted sample on either side of the position sought.
+// Sampled values this far away bound the position with overwhelming
+// probability.
+const size_t SampleMargin = 256;
+
+} // unnamed namespace
+
+
+double select(std::vector<double>& vals, size_t rank, unsigned threads)
+{
+    const size_t n = vals.size();
+    if (threads > 1 && n >= MinThreadedSelect)
+    {
+        std::vector<double> sample(SampleSize);
+        for (size_t i = 0; i < SampleSize; ++i)
+            sample[i] = vals[i * (n / SampleSize)];
+        std::sort(sample.begin(), sample.end());
+
+        const size_t pos = (size_t)((double)rank / n * SampleSize);
+        const double lo = pos < SampleMargin ?
+            (std::numeric_limits<double>::lowest)() :
+            sample[pos - SampleMargin];
+        const double hi = pos + SampleMargin >= SampleSize ?
+            (std::numeric_limits<double>::max)() :
+            sample[pos + SampleMargin];
+
+        // Count the values below the bounds and gather those within.
+        std::vector<size_t> below(threads);
+        std::vector<size_t> above(threads);
+        std::vector<std::vector<double>> within(threads);
+        parallelFor(threads, threads, [&](std::size_t t)
+        {
+            const size_t end = n * (t + 1) / threads;
+            for (size_t i = n * t / threads; i < end; ++i)
+            {
+                const double v = vals[i];
+                if (v < lo)
+                    below[t]++;
+                else if (v > hi)
+                    above[t]++;
+                else if (v == v)
+                    within[t].push_back(v);
+            }
+        });
+
+        size_t numBelow = 0;
+        size_t numWithin = 0;
+        size_t numAbove = 0;
+        for (unsigned t = 0; t < threads; ++t)
+        {
+            numBelow += below[t];
+            numWithin += within[t].size();
+            numAbove += above[t];
+        }
+
+        // If there are no NaNs and the position is within the bounds, the
+        // value is found among the gathered values.  Otherwise fall back to
+        // searching all of them.
+        if (numBelow + numWithin + numAbove == n && rank >= numBelow &&
+            rank < numBelow + numWithin)
+        {
+            std::vector<double> middle;
+            middle.reserve(numWithin);
+            for (const std::vector<double>& w : within)
+                middle.insert(middle.end(), w.begin(), w.end());
+            std::nth_element(middle.begin(),
+                middle.begin() + (rank - numBelow), middle.end());
+            return middle[rank - numBelow];
+        }
+    }
+
+    std::nth_element(vals.begin(), vals.begin() + rank, vals.end());
+    return vals[rank];
+}
+
+
+Sketch::Sketch(size_t capacity) : m_capacity((std::max)(capacity, (size_t)2)),
+    m_count(0)
+{}
+
+
+void Sketch::insert(double v)
+{
+    if (std::isnan(v))
+        return;
+    if (m_levels.empty())
+    {
+        m_levels.emplace_back();
+        m_levels[0].reserve(m_capacity);
+        m_odd.push_back(false);
+    }
+    m_levels[0].push_back(v);
+    m_count++;
+    if (m_levels[0].size() >= m_capacity)
+        compact(0);
+}
+
+
+void Sketch::merge(const Sketch& other)
+{
+    for (size_t level = 0; level < other.m_levels.size(); ++level)
+    {
+        if (level >= m_levels.size())
+        {
+            m_levels.emplace_back();
+            m_odd.push_back(false);
+        }
+        const std::vector<double>& src = other.m_levels[level];
+        m_levels[level].insert(m_levels[level].end(), src.begin(), src.end());
+    }
+    m_count += other.m_count;
+    for (size_t level = 0; level < m_levels.size(); ++level)
+        if (m_levels[level].size() >= m_capacity)
+            compact(level);
+}
+
+
+void Sketch::clear()
+{
+    m_levels.clear();
+    m_odd.clear();
+    m_count = 0;
+}
+
+
+// Move every other value of a level, in sorted order, to the next level,
+// where each stands for twice as many values.
+void Sketch::compact(size_t level)
+{
+    if (level + 1 >= m_levels.size())
+    {
+        m_levels.emplace_back();
+        m_odd.push_back(false);
+    }
+
+    std::vector<double>& src = m_levels[level];
+    std::sort(src.begin(), src.end());
+
+    // Keep the largest value here if there's an odd number of them.
+    double leftover = 0;
+    const bool hasLeftover = src.size() % 2;
+    if (hasLeftover)
+    {
+        leftover = src.back();
+        src.pop_back();
+    }
+
+    std::vector<double>& dst = m_levels[level + 1];
+    for (size_t i = m_odd[level] ? 1 : 0; i < src.size(); i += 2)
+        dst.push_back(src[i]);
+    m_odd[level] = !m_odd[level];
+
+    src.clear();
+    if (hasLeftover)
+        src.push_back(leftover);
+
+    if (dst.size() >= m_capacity)
+        compact(level + 1);
+}
+
+
+Sketch::ItemList Sketch::items() const
+{
+    ItemList items;
+    for (size_t level = 0; level < m_levels.size(); ++level)
+        for (double v : m_levels[level])
+            items.emplace_back(v, uint64_t(1) << level);
+    return items;
+}
+
+
+double Sketch::select(ItemList& items, uint64_t rank)
+{
+    std::sort(items.begin(), items.end());
+    uint64_t cumulative = 0;
+    for (const std::pair<double, uint64_t>& item : items)
+    {
+        cumulative += item.second;
+        if (cumulative > rank)
+            return item.first;
+    }
+    return items.back().first;
+}
+
+
+double Sketch::value(uint64_t rank) const
+{
+    ItemList list = items();
+    return select(list, rank);
+}
+
+
+double Sketch::deviation(double center, uint64_t rank) const
+{
+    ItemList list = items();
+    for (std::pair<double, uint64_t>& item : list)
+        item.first = std::fabs(item.first - center);
+    return select(list, rank);
+}
+
+} // namespace quantile
+} // namespace pdal
@@ -0,0 +1,147 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace pdal
+{
+namespace quantile
+{
+
+/**
+  Find the value that would be at a position if values were sorted.  The
+  values are reordered as with std::nth_element().
+
+  With more than one thread, the values near the position are found from
+  an evenly spaced sample, counted and gathered in parallel, and only
+  those are searched.  The result is always exact.
+
+  \param vals  Values to search.
+  \param rank  Position (0-based) of the value to find.  Must be less than
+    the number of values.
+  \param threads  Number of threads to use.
+  \return  Value at the position.
+*/
+double select(std::vector<double>& vals, size_t rank, unsigned threads);
+
+/**
+  Get the count of values at which streamed estimates should next be
+  updated.  Nothing is estimated before a minimum count.  Updates are then
+  made as the count doubles, and at a fixed interval once that is reached,
+  so the cost of estimating is spread over the values.
+
+  \param count  Current count of values.
+  \return  Count of values at which to update estimates.
+*/
+inline uint64_t nextUpdate(uint64_t count)
+{
+    const uint64_t MinCount = 100;
+    const uint64_t MaxInterval = 4096;
+
+    if (count < MinCount)
+        return MinCount;
+    return count + (count < MaxInterval ? count : MaxInterval);
+}
+
+/**
+  A one-pass sketch of a set of values from which values at positions
+  can be estimated.
+
+  Values are kept in levels, each level's values standing for twice as
+  many values as those in the level below.  When a level fills, its values
+  are sorted and every other one is moved up a level.  The error in the
+  rank of an estimate grows with the logarithm of the number of values
+  over the capacity and shrinks with the capacity.  Estimates are exact
+  until more values than the capacity have been inserted.
+*/
+class Sketch
+{
+public:
+    /**
+      \param capacity  Number of values in a level.
+    */
+    explicit Sketch(size_t capacity = 4096);
+
+    /// Add a value.  NaN is ignored.
+    void insert(double v);
+
+    /// Add the values of another sketch.
+    void merge(const Sketch& other);
+
+    /// Remove all values.
+    void clear();
+
+    /// Number of values inserted.
+    uint64_t count() const
+        { return m_count; }
+
+    /**
+      Estimate the value at a position, were inserted values sorted.
+      The sketch must not be empty.
+
+      \param rank  Position (0-based) of the value.
+    */
+    double value(uint64_t rank) const;
+
+    /**
+      Estimate the value at a position, were the absolute differences of
+      inserted values from a center sorted.  The sketch must not be empty.
+
+      \param center  Value from which to measure differences.
+      \param rank  Position (0-based) of the difference.
+    */
+    double deviation(double center, uint64_t rank) const;
+
+private:
+    // Values and the number of inserted values each stands for.
+    typedef std::vector<std::pair<double, uint64_t>> ItemList;
+
+    void compact(size_t level);
+    ItemList items() const;
+    static double select(ItemList& items, uint64_t rank);
+
+    size_t m_capacity;
+    uint64_t m_count;
+    std::vector<std::vector<double>> m_levels;
+    // Whether to keep odd rather than even values at the next compaction
+    // of each level.  Alternating keeps errors from accumulating.
+    std::vector<bool> m_odd;
+};
+
+} // namespace quantile
+} // namespace pdal
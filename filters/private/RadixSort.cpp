@@ -0,0 +1,127 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include "RadixSort.hpp"
+
+#include <algorithm>
+#include <array>
+#include <functional>
+
+namespace pdal
+{
+namespace radix
+{
+
+namespace
+{
+
+// Below this size a single thread sorts faster than a pool.
+const std::size_t MinThreadedSort = 65536;
+
+} // unnamed namespace
+
+void sort(EntryList& entries, unsigned threads)
+{
+    const std::size_t size = entries.size();
+    if (size < 2)
+        return;
+
+    // Bits that differ between any key and the first are the only ones
+    // that need sorting.
+    const uint64_t first = entries[0].key;
+    uint64_t diff = 0;
+    for (const Entry& e : entries)
+        diff |= e.key ^ first;
+    if (diff == 0)
+        return;
+
+    if (size < MinThreadedSort)
+        threads = 1;
+    threads = (std::max)(threads, 1u);
+
+    // Each thread handles a fixed range of positions in every pass.
+    auto chunkBegin = [size, threads](unsigned chunk)
+        { return size * chunk / threads; };
+    auto run = [threads](const std::function<void(unsigned)>& f)
+    {
+        parallelFor(threads, threads,
+            [&f](std::size_t chunk){ f((unsigned)chunk); });
+    };
+
+    EntryList buf(size);
+    EntryList *src = &entries;
+    EntryList *dst = &buf;
+    std::vector<std::array<std::size_t, 256>> counts(threads);
+    for (int shift = 0; shift < 64; shift += 8)
+    {
+        if (((diff >> shift) & 0xff) == 0)
+            continue;
+
+        run([&](unsigned chunk)
+        {
+            std::array<std::size_t, 256>& count = counts[chunk];
+            count.fill(0);
+            const std::size_t end = chunkBegin(chunk + 1);
+            for (std::size_t i = chunkBegin(chunk); i < end; ++i)
+                count[((*src)[i].key >> shift) & 0xff]++;
+        });
+
+        // Turn the counts into starting positions, ordered by digit and
+        // then by chunk so that the sort is stable.
+        std::size_t pos = 0;
+        for (std::size_t digit = 0; digit < 256; ++digit)
+            for (unsigned chunk = 0; chunk < threads; ++chunk)
+            {
+                std::size_t n = counts[chunk][digit];
+                counts[chunk][digit] = pos;
+                pos += n;
+            }
+
+        run([&](unsigned chunk)
+        {
+            std::array<std::size_t, 256>& offset = counts[chunk];
+            const std::size_t end = chunkBegin(chunk + 1);
+            for (std::size_t i = chunkBegin(chunk); i < end; ++i)
+            {
+                const Entry& e = (*src)[i];
+                (*dst)[offset[(e.key >> shift) & 0xff]++] = e;
+            }
+        });
+        std::swap(src, dst);
+    }
+    if (src != &entries)
+        entries.swap(buf);
+}
+
+} // namespace radix
+} // namespace pdal
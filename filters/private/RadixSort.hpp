@@ -0,0 +1,139 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include <pdal/pdal_types.hpp>
+#include <pdal/util/TaskScheduler.hpp>
+
+namespace pdal
+{
+namespace radix
+{
+
+/**
+  Sort key of a point and the point's ID.
+*/
+struct Entry
+{
+    uint64_t key;
+    PointId id;
+};
+using EntryList = std::vector<Entry>;
+
+/**
+  Map a signed integer to an unsigned integer that sorts in the same order.
+*/
+template<typename T>
+typename std::enable_if<std::is_integral<T>::value &&
+    std::is_signed<T>::value, uint64_t>::type
+orderedKey(T t)
+{
+    return static_cast<uint64_t>(static_cast<int64_t>(t)) ^
+        0x8000000000000000ull;
+}
+
+/**
+  Map an unsigned integer to itself.
+*/
+template<typename T>
+typename std::enable_if<std::is_integral<T>::value &&
+    std::is_unsigned<T>::value, uint64_t>::type
+orderedKey(T t)
+{
+    return static_cast<uint64_t>(t);
+}
+
+/**
+  Map a floating-point value to an unsigned integer that sorts in the same
+  order.  Positive values have the sign bit set and negative values have
+  all their bits inverted.  Negative zero is treated as zero.
+*/
+template<typename T>
+typename std::enable_if<std::is_floating_point<T>::value, uint64_t>::type
+orderedKey(T t)
+{
+    double d = (t == 0) ? 0.0 : static_cast<double>(t);
+    uint64_t u;
+    std::memcpy(&u, &d, sizeof(u));
+    return (u & 0x8000000000000000ull) ? ~u : (u | 0x8000000000000000ull);
+}
+
+/**
+  Compute the sort keys of a range of points.
+
+  \param count  Number of points.  Entries are created for the IDs
+    [0, count).
+  \param threads  Number of threads used to compute keys.
+  \param key  Function returning the sort key of a point, given its ID.
+    It's called concurrently when \a threads is greater than one.
+  \return  List of entries in ID order.
+*/
+template<typename KEYFUNC>
+EntryList makeEntries(point_count_t count, unsigned threads, KEYFUNC key)
+{
+    EntryList entries(count);
+    auto fill = [&entries, &key](PointId begin, PointId end)
+    {
+        for (PointId idx = begin; idx < end; ++idx)
+            entries[idx] = { key(idx), idx };
+    };
+
+    if (threads <= 1 || count < 2 * threads)
+    {
+        fill(0, count);
+        return entries;
+    }
+
+    parallelFor(threads, threads, [&fill, count, threads](std::size_t t)
+        { fill(count * t / threads, count * (t + 1) / threads); });
+    return entries;
+}
+
+/**
+  Stable sort of entries by key, using a least-significant-digit radix
+  sort.  Passes for bytes that are the same in all keys are skipped.
+
+  \param entries  Entries to sort.
+  \param threads  Number of threads used to sort.
+*/
+PDAL_DLL void sort(EntryList& entries, unsigned threads = 1);
+
+} // namespace radix
+} // namespace pdal
@@ -38,10 +38,13 @@
 #include <pdal/PointView.hpp>
 #include <pdal/Stage.hpp>
 #include <pdal/pdal_types.hpp>
+#include <pdal/util/TaskScheduler.hpp>
 
 #include "DimRange.hpp"
 #include "Segmentation.hpp"
+#include "UnionFind.hpp"
 
+#include <algorithm>
 #include <vector>
 
 namespace pdal
@@ -50,63 +53,65 @@ namespace pdal
 namespace Segmentation
 {
 
+// Points within the tolerance of each other are joined in a union-find,
+// on all threads.  The root of each set is its smallest point ID, so the
+// clusters come out in the order of their first point whatever the number
+// of threads.
 std::vector<PointIdList> extractClusters(PointView& view, uint64_t min_points,
-                                         uint64_t max_points, double tolerance)
+    uint64_t max_points, double tolerance, int threads)
 {
     // Index the incoming PointView for subsequent radius searches.
-    KD3Index kdi(view);
-    kdi.build();
+    KD3Index& kdi = view.build3dIndex();
 
-    // Create variables to track PointIds that have already been added to
-    // clusters and to build the list of cluster indices.
-    PointIdList processed(view.size(), 0);
-    std::vector<PointIdList> clusters;
-
-    for (PointId i = 0; i < view.size(); ++i)
+    const point_count_t count = view.size();
+    UnionFind sets(count);
+    auto run = [&kdi, &sets, tolerance](PointId start, PointId end)
     {
-        // Points can only belong to a single cluster.
-        if (processed[i])
-            continue;
-
-        // Initialize list of indices belonging to current cluster, marking the
-        // seed point as processed.
-        PointIdList seed_queue;
-        size_t sq_idx = 0;
-        seed_queue.push_back(i);
-        processed[i] = 1;
-
-        // Check each point in the cluster for additional neighbors within the
-        // given tolerance, remembering that the list can grow if we add points
-        // to the cluster.
-        while (sq_idx < seed_queue.size())
+        const point_count_t blockSize = 4096;
+        for (PointId begin = start; begin < end; begin += blockSize)
         {
-            // Find neighbors of the next cluster point.
-            PointId j = seed_queue[sq_idx];
-            PointIdList ids = kdi.radius(j, tolerance);
-
-            // The case where the only neighbor is the query point.
-            if (ids.size() == 1)
+            PointId last = (std::min)(begin + blockSize, end);
+            KDNeighbors nbrs = kdi.radiusRange(begin, last, tolerance, 1);
+            for (PointId i = begin; i < last; ++i)
             {
-                sq_idx++;
-                continue;
+                // Neighbors are found both ways, so each pair is joined
+                // only from its smaller ID.
+                const PointId *ids = nbrs.neighbors(i - begin);
+                for (std::size_t k = 0; k < nbrs.count(i - begin); ++k)
+                    if (ids[k] > i)
+                        sets.unite(i, ids[k]);
             }
+        }
+    };
 
-            // Skip neighbors that already belong to a cluster and add the rest
-            // to this cluster.
-            for (auto const& k : ids)
-            {
-                if (processed[k])
-                    continue;
-                seed_queue.push_back(k);
-                processed[k] = 1;
-            }
+    const point_count_t n = (std::max)(1, threads);
+    parallelFor(n, n, [&run, count, n](std::size_t t)
+        { run(t * count / n, (t + 1) * count / n); });
 
-            sq_idx++;
-        }
+    // Gather the points of each set, in point order, and keep the clusters
+    // that are within the min/max number of points.
+    std::vector<PointId> roots(count);
+    PointIdList sizes(count, 0);
+    for (PointId i = 0; i < count; ++i)
+    {
+        roots[i] = sets.find(i);
+        sizes[roots[i]]++;
+    }
 
-        // Keep clusters that are within the min/max number of points.
-        if (seed_queue.size() >= min_points && seed_queue.size() <= max_points)
-            clusters.push_back(seed_queue);
+    std::vector<PointIdList> clusters;
+    PointIdList slots(count, 0);
+    for (PointId i = 0; i < count; ++i)
+    {
+        PointId r = roots[i];
+        if (sizes[r] < min_points || sizes[r] > max_points)
+            continue;
+        if (r == i)
+        {
+            slots[r] = clusters.size();
+            clusters.emplace_back();
+            clusters.back().reserve(sizes[r]);
+        }
+        clusters[slots[r]].push_back(i);
     }
 
     return clusters;
@@ -52,21 +52,24 @@ namespace Segmentation
 /**
   Extract clusters of points from input PointView.
 
-  For each point, find neighbors within a given tolerance (Euclidean distance).
-  If a neighbor already belongs to another cluster, skip it. Otherwise, add it
-  to the current cluster. Recursively visit newly added cluster points, looking
-  for neighbors to add to the cluster.
+  Points within a given tolerance (Euclidean distance) of each other belong
+  to the same cluster, as do the points they can be reached from through
+  such neighbors.  Neighbors are found and joined on several threads.
 
   \param[in] view the input PointView.
   \param[in] min_points the minimum number of points in a cluster.
   \param[in] max_points the maximum number of points in a cluster.
   \param[in] tolerance the tolerance for adding points to a cluster.
-  \returns a vector of clusters (themselves vectors of PointIds).
+  \param[in] threads the number of threads used to find the clusters.
+  \returns a vector of clusters (themselves vectors of PointIds), ordered
+    by their first point.  The points of a cluster are in point order.
+    The result doesn't depend on the number of threads.
 */
 PDAL_DLL std::vector<PointIdList> extractClusters(PointView& view,
                                                   uint64_t min_points,
                                                   uint64_t max_points,
-                                                  double tolerance);
+                                                  double tolerance,
+                                                  int threads = 1);
 
 PDAL_DLL void ignoreDimRange(DimRange dr, PointViewPtr input, PointViewPtr keep,
                              PointViewPtr ignore);
@@ -0,0 +1,384 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#include "Selection.hpp"
+
+#include <algorithm>
+#include <functional>
+
+#include <pdal/pdal_types.hpp>
+
+#include "DimRange.hpp"
+
+namespace pdal
+{
+
+namespace
+{
+
+// Number of points evaluated together.  Small enough that the columns and
+// the mask stack stay in cache.
+const std::size_t ChunkSize = 1024;
+
+template<typename Op>
+void compare(const double *v, double value, char *out, std::size_t len,
+    Op op)
+{
+    for (std::size_t i = 0; i < len; ++i)
+        out[i] = op(v[i], value);
+}
+
+template<typename Op>
+void compare(const double *v, const double *v2, char *out, std::size_t len,
+    Op op)
+{
+    for (std::size_t i = 0; i < len; ++i)
+        out[i] = op(v[i], v2[i]);
+}
+
+// NaN fails both tests, so never passes a range that isn't negated.
+template<typename LowerOp, typename UpperOp>
+void range(const double *v, double lower, double upper, bool negate,
+    char *out, std::size_t len, LowerOp lowerOp, UpperOp upperOp)
+{
+    for (std::size_t i = 0; i < len; ++i)
+        out[i] = (lowerOp(v[i], lower) && upperOp(v[i], upper)) != negate;
+}
+
+} // unnamed namespace
+
+
+Selection::Selection() : m_depth(0), m_maxDepth(0)
+{}
+
+
+std::size_t Selection::column(Dimension::Id dim)
+{
+    auto it = std::find(m_dims.begin(), m_dims.end(), dim);
+    if (it != m_dims.end())
+        return it - m_dims.begin();
+    m_dims.push_back(dim);
+    return m_dims.size() - 1;
+}
+
+
+void Selection::push(const Instruction& in, int depthChange)
+{
+    m_program.push_back(in);
+    m_depth += depthChange;
+    m_maxDepth = (std::max)(m_maxDepth, m_depth);
+}
+
+
+void Selection::pushCompare(Dimension::Id dim, Compare op, double value)
+{
+    Instruction in {};
+    in.m_code = Code::Compare;
+    in.m_compare = op;
+    in.m_col = column(dim);
+    in.m_lower = value;
+    push(in, 1);
+}
+
+
+void Selection::pushCompare(Dimension::Id dim, Compare op,
+    Dimension::Id other)
+{
+    Instruction in {};
+    in.m_code = Code::CompareDim;
+    in.m_compare = op;
+    in.m_col = column(dim);
+    in.m_col2 = column(other);
+    push(in, 1);
+}
+
+
+void Selection::pushRange(const DimRange& range)
+{
+    Instruction in {};
+    in.m_code = Code::Range;
+    in.m_col = column(range.m_id);
+    in.m_lower = range.m_lower_bound;
+    in.m_upper = range.m_upper_bound;
+    in.m_inclusiveLower = range.m_inclusive_lower_bound;
+    in.m_inclusiveUpper = range.m_inclusive_upper_bound;
+    in.m_negate = range.m_negate;
+    push(in, 1);
+}
+
+
+void Selection::pushRanges(const std::vector<DimRange>& ranges)
+{
+    std::size_t groups = 0;
+    auto it = ranges.begin();
+    while (it != ranges.end())
+    {
+        auto end = it;
+        while (end != ranges.end() && end->m_id == it->m_id)
+            pushRange(*end++);
+        pushOr(end - it);
+        groups++;
+        it = end;
+    }
+    pushAnd(groups);
+}
+
+
+void Selection::pushAnd(std::size_t count)
+{
+    if ((int)count > m_depth)
+        throw pdal_error("Selection: not enough operands for AND.");
+    Instruction in {};
+    in.m_code = Code::And;
+    in.m_count = count;
+    push(in, 1 - (int)count);
+}
+
+
+void Selection::pushOr(std::size_t count)
+{
+    if ((int)count > m_depth)
+        throw pdal_error("Selection: not enough operands for OR.");
+    Instruction in {};
+    in.m_code = Code::Or;
+    in.m_count = count;
+    push(in, 1 - (int)count);
+}
+
+
+void Selection::pushNot()
+{
+    if (m_depth < 1)
+        throw pdal_error("Selection: no operand for NOT.");
+    Instruction in {};
+    in.m_code = Code::Not;
+    push(in, 0);
+}
+
+
+void Selection::validate() const
+{
+    if (m_depth != 1)
+        throw pdal_error("Selection: program doesn't produce a single "
+            "result.");
+}
+
+
+// Execute an instruction on 'len' points.  Columns and stack entries are
+// 'stride' values apart.  Returns the new number of entries on the stack.
+std::size_t Selection::execute(const Instruction& in, const double *cols,
+    char *stack, std::size_t top, std::size_t len, std::size_t stride) const
+{
+    switch (in.m_code)
+    {
+    case Code::Compare:
+    case Code::CompareDim:
+    {
+        const double *v = cols + in.m_col * stride;
+        char *out = stack + top * stride;
+        if (in.m_code == Code::CompareDim)
+        {
+            const double *v2 = cols + in.m_col2 * stride;
+            switch (in.m_compare)
+            {
+            case Compare::Eq:
+                compare(v, v2, out, len, std::equal_to<double>());
+                break;
+            case Compare::Ne:
+                compare(v, v2, out, len, std::not_equal_to<double>());
+                break;
+            case Compare::Gt:
+                compare(v, v2, out, len, std::greater<double>());
+                break;
+            case Compare::Gte:
+                compare(v, v2, out, len, std::greater_equal<double>());
+                break;
+            case Compare::Lt:
+                compare(v, v2, out, len, std::less<double>());
+                break;
+            case Compare::Lte:
+                compare(v, v2, out, len, std::less_equal<double>());
+                break;
+            }
+        }
+        else
+        {
+            const double k = in.m_lower;
+            switch (in.m_compare)
+            {
+            case Compare::Eq:
+                compare(v, k, out, len, std::equal_to<double>());
+                break;
+            case Compare::Ne:
+                compare(v, k, out, len, std::not_equal_to<double>());
+                break;
+            case Compare::Gt:
+                compare(v, k, out, len, std::greater<double>());
+                break;
+            case Compare::Gte:
+                compare(v, k, out, len, std::greater_equal<double>());
+                break;
+            case Compare::Lt:
+                compare(v, k, out, len, std::less<double>());
+                break;
+            case Compare::Lte:
+                compare(v, k, out, len, std::less_equal<double>());
+                break;
+            }
+        }
+        return top + 1;
+    }
+    case Code::Range:
+    {
+        const double *v = cols + in.m_col * stride;
+        char *out = stack + top * stride;
+        if (in.m_inclusiveLower && in.m_inclusiveUpper)
+            range(v, in.m_lower, in.m_upper, in.m_negate, out, len,
+                std::greater_equal<double>(), std::less_equal<double>());
+        else if (in.m_inclusiveLower)
+            range(v, in.m_lower, in.m_upper, in.m_negate, out, len,
+                std::greater_equal<double>(), std::less<double>());
+        else if (in.m_inclusiveUpper)
+            range(v, in.m_lower, in.m_upper, in.m_negate, out, len,
+                std::greater<double>(), std::less_equal<double>());
+        else
+            range(v, in.m_lower, in.m_upper, in.m_negate, out, len,
+                std::greater<double>(), std::less<double>());
+        return top + 1;
+    }
+    case Code::And:
+    case Code::Or:
+    {
+        const bool isAnd = (in.m_code == Code::And);
+        if (in.m_count == 0)
+        {
+            std::fill(stack + top * stride, stack + top * stride + len,
+                (char)isAnd);
+            return top + 1;
+        }
+        top -= in.m_count;
+        char *out = stack + top * stride;
+        for (std::size_t k = 1; k < in.m_count; ++k)
+        {
+            const char *src = out + k * stride;
+            if (isAnd)
+                for (std::size_t i = 0; i < len; ++i)
+                    out[i] &= src[i];
+            else
+                for (std::size_t i = 0; i < len; ++i)
+                    out[i] |= src[i];
+        }
+        return top + 1;
+    }
+    case Code::Not:
+    {
+        char *out = stack + (top - 1) * stride;
+        for (std::size_t i = 0; i < len; ++i)
+            out[i] = !out[i];
+        return top;
+    }
+    }
+    return top;
+}
+
+
+void Selection::run(PointContainer& container, PointId begin,
+    point_count_t count, std::vector<char>& mask) const
+{
+    evaluate(container, count,
+        [begin](std::size_t i){ return begin + i; }, mask);
+}
+
+
+void Selection::runIds(PointContainer& container, const PointId *ids,
+    std::size_t count, std::vector<char>& mask) const
+{
+    evaluate(container, count, [ids](std::size_t i){ return ids[i]; }, mask);
+}
+
+
+// Evaluate the program for 'count' points, the ID of the i'th of which is
+// idAt(i).
+template<typename IdFunc>
+void Selection::evaluate(PointContainer& container, std::size_t count,
+    IdFunc idAt, std::vector<char>& mask) const
+{
+    validate();
+    mask.resize(count);
+    if (count == 0)
+        return;
+
+    std::vector<double> cols(m_dims.size() * ChunkSize);
+    std::vector<char> stack(m_maxDepth * ChunkSize);
+    PointRef point(container, 0);
+    for (std::size_t start = 0; start < count; start += ChunkSize)
+    {
+        const std::size_t len = (std::min)((std::size_t)ChunkSize,
+            count - start);
+
+        // Gather the columns for this chunk.
+        for (std::size_t c = 0; c < m_dims.size(); ++c)
+        {
+            double *col = cols.data() + c * ChunkSize;
+            const Dimension::Id dim = m_dims[c];
+            for (std::size_t i = 0; i < len; ++i)
+            {
+                point.setPointId(idAt(start + i));
+                col[i] = point.getFieldAs<double>(dim);
+            }
+        }
+
+        std::size_t top = 0;
+        for (const Instruction& in : m_program)
+            top = execute(in, cols.data(), stack.data(), top, len, ChunkSize);
+        std::copy(stack.begin(), stack.begin() + len, mask.begin() + start);
+    }
+}
+
+
+bool Selection::passes(const PointRef& point) const
+{
+    validate();
+    std::vector<double> cols(m_dims.size());
+    std::vector<char> stack(m_maxDepth);
+    for (std::size_t c = 0; c < m_dims.size(); ++c)
+        cols[c] = point.getFieldAs<double>(m_dims[c]);
+
+    std::size_t top = 0;
+    for (const Instruction& in : m_program)
+        top = execute(in, cols.data(), stack.data(), top, 1, 1);
+    return stack[0];
+}
+
+} // namespace pdal
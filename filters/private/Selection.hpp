@@ -0,0 +1,159 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <pdal/Dimension.hpp>
+#include <pdal/PointContainer.hpp>
+#include <pdal/PointRef.hpp>
+
+namespace pdal
+{
+
+struct DimRange;
+
+/**
+  A point selection compiled to a flat program.
+
+  Each instruction works on whole columns of dimension values and pushes
+  a mask onto an evaluation stack, so expressions are evaluated a batch of
+  points at a time with tight loops that the compiler can vectorize,
+  rather than by walking an object tree for every point.  A complete
+  program leaves exactly one mask on the stack: the points that pass.
+*/
+class Selection
+{
+public:
+    enum class Compare
+    {
+        Eq,
+        Ne,
+        Gt,
+        Gte,
+        Lt,
+        Lte
+    };
+
+    Selection();
+
+    /// Push the result of comparing a dimension with a constant.
+    void pushCompare(Dimension::Id dim, Compare op, double value);
+    /// Push the result of comparing a dimension with another dimension.
+    void pushCompare(Dimension::Id dim, Compare op, Dimension::Id other);
+    /// Push the result of testing a dimension against a range.
+    void pushRange(const DimRange& range);
+    /// Push the result of a sorted list of ranges: ORed for ranges of
+    /// the same dimension, ANDed across dimensions (see DimRange).
+    void pushRanges(const std::vector<DimRange>& ranges);
+    /// Replace the top \a count results by their AND (true if none).
+    void pushAnd(std::size_t count);
+    /// Replace the top \a count results by their OR (false if none).
+    void pushOr(std::size_t count);
+    /// Negate the top result.
+    void pushNot();
+
+    /// Dimensions read by the program.
+    const Dimension::IdList& dims() const
+        { return m_dims; }
+
+    /**
+      Evaluate the selection for a range of points.
+
+      \param container  Container holding the points.
+      \param begin  ID of the first point.
+      \param count  Number of points.
+      \param mask  Set to non-zero for each point that passes.
+    */
+    void run(PointContainer& container, PointId begin, point_count_t count,
+        std::vector<char>& mask) const;
+
+    /**
+      Evaluate the selection for a list of points.
+
+      \param container  Container holding the points.
+      \param ids  IDs of the points.
+      \param count  Number of IDs.
+      \param mask  Set to non-zero for each point that passes.
+    */
+    void runIds(PointContainer& container, const PointId *ids,
+        std::size_t count, std::vector<char>& mask) const;
+
+    /// Evaluate the selection for a single point.
+    bool passes(const PointRef& point) const;
+
+private:
+    enum class Code
+    {
+        Compare,
+        CompareDim,
+        Range,
+        And,
+        Or,
+        Not
+    };
+
+    struct Instruction
+    {
+        Code m_code;
+        Compare m_compare;
+        std::size_t m_col;
+        std::size_t m_col2;
+        double m_lower;
+        double m_upper;
+        bool m_inclusiveLower;
+        bool m_inclusiveUpper;
+        bool m_negate;
+        std::size_t m_count;
+    };
+
+    std::size_t column(Dimension::Id dim);
+    void push(const Instruction& in, int depthChange);
+    void validate() const;
+    template<typename IdFunc>
+    void evaluate(PointContainer& container, std::size_t count,
+        IdFunc idAt, std::vector<char>& mask) const;
+    std::size_t execute(const Instruction& in, const double *cols,
+        char *stack, std::size_t top, std::size_t len,
+        std::size_t stride) const;
+
+    std::vector<Instruction> m_program;
+    Dimension::IdList m_dims;
+    int m_depth;
+    int m_maxDepth;
+};
+
+} // namespace pdal
@@ -0,0 +1,117 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <climits>
+#include <cstdint>
+#include <utility>
+
+namespace pdal
+{
+namespace spacecurve
+{
+
+/**
+  Scale a position within a range to a grid coordinate in [0, INT_MAX].
+  Positions outside the range are clamped to it.
+
+  \param v  Position.
+  \param min  Start of the range.
+  \param range  Length of the range.
+  \return  Grid coordinate.
+*/
+inline uint32_t gridPos(double v, double min, double range)
+{
+    if (!(range > 0))
+        return 0;
+    const double f = (v - min) / range;
+    if (f <= 0)
+        return 0;
+    if (f >= 1)
+        return INT_MAX;
+    return (uint32_t)(int)(f * INT_MAX);
+}
+
+// Spread the low 32 bits of a value to the even bits of the result.
+inline uint64_t spread(uint64_t x)
+{
+    x &= 0xffffffffull;
+    x = (x | (x << 16)) & 0x0000ffff0000ffffull;
+    x = (x | (x <<  8)) & 0x00ff00ff00ff00ffull;
+    x = (x | (x <<  4)) & 0x0f0f0f0f0f0f0f0full;
+    x = (x | (x <<  2)) & 0x3333333333333333ull;
+    x = (x | (x <<  1)) & 0x5555555555555555ull;
+    return x;
+}
+
+/**
+  Position of a grid cell on the Z-order curve.  At each bit level X is
+  more significant than Y.
+*/
+inline uint64_t mortonCode(uint32_t x, uint32_t y)
+{
+    return (spread(x) << 1) | spread(y);
+}
+
+/**
+  Position of a grid cell on the Hilbert curve through a grid of
+  2^31 x 2^31 cells.
+*/
+inline uint64_t hilbertCode(uint32_t x, uint32_t y)
+{
+    const uint32_t n = 1u << 31;
+    uint64_t d = 0;
+    for (uint32_t s = n / 2; s > 0; s /= 2)
+    {
+        uint32_t rx = (x & s) ? 1 : 0;
+        uint32_t ry = (y & s) ? 1 : 0;
+        d += (uint64_t)s * s * ((3 * rx) ^ ry);
+
+        // Rotate the quadrant so that the curve inside it has the
+        // standard orientation.
+        if (ry == 0)
+        {
+            if (rx == 1)
+            {
+                x = n - 1 - x;
+                y = n - 1 - y;
+            }
+            std::swap(x, y);
+        }
+    }
+    return d;
+}
+
+} // namespace spacecurve
+} // namespace pdal
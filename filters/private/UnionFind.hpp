@@ -0,0 +1,109 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <utility>
+#include <vector>
+
+#include <pdal/pdal_types.hpp>
+
+namespace pdal
+{
+
+/**
+  Disjoint sets of point IDs that can be joined from several threads at
+  once.  A set is only ever linked below a set with a smaller root, so
+  once all joins are done the root of every set is its smallest point ID,
+  whatever the order in which the joins were made.
+*/
+class UnionFind
+{
+public:
+    /**
+      Create \a size sets, each holding one point.
+    */
+    UnionFind(point_count_t size) : m_parent(size)
+    {
+        for (PointId i = 0; i < size; ++i)
+            m_parent[i].store(i, std::memory_order_relaxed);
+    }
+
+    /**
+      Find the root of the set holding a point.  Paths are halved as they
+      are walked.
+    */
+    PointId find(PointId i)
+    {
+        PointId parent = m_parent[i].load(std::memory_order_relaxed);
+        while (parent != i)
+        {
+            PointId grandparent =
+                m_parent[parent].load(std::memory_order_relaxed);
+            // Losing the race only means the path isn't shortened.
+            m_parent[i].compare_exchange_weak(parent, grandparent,
+                std::memory_order_relaxed);
+            i = grandparent;
+            parent = m_parent[i].load(std::memory_order_relaxed);
+        }
+        return i;
+    }
+
+    /**
+      Join the sets holding two points.
+    */
+    void unite(PointId a, PointId b)
+    {
+        while (true)
+        {
+            a = find(a);
+            b = find(b);
+            if (a == b)
+                return;
+            if (a < b)
+                std::swap(a, b);
+            // Link the larger root below the smaller one, unless another
+            // thread has linked it first, in which case try again.
+            PointId expected = a;
+            if (m_parent[a].compare_exchange_strong(expected, b,
+                    std::memory_order_relaxed))
+                return;
+        }
+    }
+
+private:
+    std::vector<std::atomic<PointId>> m_parent;
+};
+
+} // namespace pdal
@@ -0,0 +1,173 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#include "VoxelStore.hpp"
+
+#include <limits>
+
+#include <pdal/pdal_types.hpp>
+
+namespace pdal
+{
+
+namespace
+{
+
+const uint32_t EmptyKey = (std::numeric_limits<uint32_t>::max)();
+
+// Bucket indices are packed in 21 bits each.
+const int64_t MaxBucket = (int64_t(1) << 20) - 1;
+const int64_t MinBucket = -(int64_t(1) << 20);
+
+inline uint32_t hashKey(uint32_t k)
+{
+    k ^= k >> 16;
+    k *= 0x7feb352d;
+    k ^= k >> 15;
+    k *= 0x846ca68b;
+    k ^= k >> 16;
+    return k;
+}
+
+} // unnamed namespace
+
+
+VoxelStore::Bucket::Bucket() : m_keys(16, EmptyKey), m_values(16), m_size(0),
+    m_lastUse(0)
+{}
+
+
+VoxelStore::VoxelStore(uint64_t evictAge) : m_evictAge(evictAge), m_tick(0),
+    m_size(0), m_lastKey(0), m_last(nullptr)
+{}
+
+
+std::pair<uint32_t, bool> VoxelStore::insert(int64_t x, int64_t y, int64_t z,
+    uint32_t value)
+{
+    // Arithmetic shift rounds toward negative infinity, so voxels with
+    // negative indices land in the proper bucket.
+    int64_t bx = x >> BucketBits;
+    int64_t by = y >> BucketBits;
+    int64_t bz = z >> BucketBits;
+    if (bx < MinBucket || bx > MaxBucket || by < MinBucket ||
+            by > MaxBucket || bz < MinBucket || bz > MaxBucket)
+        throw pdal_error("Voxel index out of range.  Increase the cell "
+            "size.");
+    const uint64_t mask = (uint64_t(1) << 21) - 1;
+    uint64_t bucketKey = ((uint64_t)bx & mask) |
+        (((uint64_t)by & mask) << 21) | (((uint64_t)bz & mask) << 42);
+
+    m_tick++;
+    if (m_evictAge && m_tick % m_evictAge == 0)
+        evict();
+
+    if (!m_last || bucketKey != m_lastKey)
+    {
+        m_last = &m_buckets[bucketKey];
+        m_lastKey = bucketKey;
+    }
+    Bucket& b = *m_last;
+    b.m_lastUse = m_tick;
+
+    const uint32_t local = (uint32_t)(x & (BucketSize - 1)) |
+        ((uint32_t)(y & (BucketSize - 1)) << BucketBits) |
+        ((uint32_t)(z & (BucketSize - 1)) << (2 * BucketBits));
+
+    // Keep the load factor at or below one half.
+    if ((b.m_size + 1) * 2 > b.m_keys.size())
+        grow(b);
+
+    const size_t slotMask = b.m_keys.size() - 1;
+    size_t slot = hashKey(local) & slotMask;
+    while (b.m_keys[slot] != EmptyKey)
+    {
+        if (b.m_keys[slot] == local)
+            return std::make_pair(b.m_values[slot], false);
+        slot = (slot + 1) & slotMask;
+    }
+    b.m_keys[slot] = local;
+    b.m_values[slot] = value;
+    b.m_size++;
+    m_size++;
+    return std::make_pair(value, true);
+}
+
+
+void VoxelStore::grow(Bucket& b)
+{
+    std::vector<uint32_t> keys(b.m_keys.size() * 2, EmptyKey);
+    std::vector<uint32_t> values(keys.size());
+    const size_t slotMask = keys.size() - 1;
+    for (size_t i = 0; i < b.m_keys.size(); ++i)
+    {
+        uint32_t key = b.m_keys[i];
+        if (key == EmptyKey)
+            continue;
+        size_t slot = hashKey(key) & slotMask;
+        while (keys[slot] != EmptyKey)
+            slot = (slot + 1) & slotMask;
+        keys[slot] = key;
+        values[slot] = b.m_values[i];
+    }
+    b.m_keys.swap(keys);
+    b.m_values.swap(values);
+}
+
+
+void VoxelStore::evict()
+{
+    for (auto it = m_buckets.begin(); it != m_buckets.end();)
+    {
+        if (m_tick - it->second.m_lastUse > m_evictAge)
+        {
+            m_size -= it->second.m_size;
+            it = m_buckets.erase(it);
+        }
+        else
+            ++it;
+    }
+    m_last = nullptr;
+}
+
+
+void VoxelStore::clear()
+{
+    m_buckets.clear();
+    m_tick = 0;
+    m_size = 0;
+    m_last = nullptr;
+}
+
+} // namespace pdal
@@ -0,0 +1,122 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace pdal
+{
+
+/**
+  A set of occupied voxels, each with a 32-bit value.
+
+  Voxels are grouped into cubic buckets of BucketSize voxels on a side.
+  The buckets are found by a 64-bit key that packs the bucket indices
+  and each bucket keeps its voxels in an open-addressing table keyed by
+  the packed 32-bit position of the voxel within the bucket.  This takes
+  far less memory than a node-based set of index tuples.
+
+  When data arrives ordered in time, as from a mobile scanner, buckets
+  that haven't been touched for a while won't be touched again.  If an
+  eviction age is set, buckets that haven't received a voxel within that
+  many calls to insert() are discarded, so that memory is bounded by the
+  area covered recently rather than by the whole run.
+*/
+class VoxelStore
+{
+public:
+    /// Number of voxels along each side of a bucket.
+    static const int BucketBits = 8;
+    static const int BucketSize = 1 << BucketBits;
+
+    /**
+      \param evictAge  Number of insertions after which a bucket that
+        hasn't been touched is discarded.  0 disables eviction.
+    */
+    VoxelStore(uint64_t evictAge = 0);
+
+    /**
+      Find a voxel, adding it with the provided value if it isn't present.
+      Throws pdal_error if the voxel is too far from voxel (0, 0, 0).
+
+      \param x  X index of the voxel.
+      \param y  Y index of the voxel.
+      \param z  Z index of the voxel.
+      \param value  Value to store if the voxel is added.
+      \return  The value stored for the voxel and whether it was added.
+    */
+    std::pair<uint32_t, bool> insert(int64_t x, int64_t y, int64_t z,
+        uint32_t value);
+
+    /// Remove all voxels.
+    void clear();
+
+    /// Number of voxels in the store.
+    size_t size() const
+        { return m_size; }
+
+    /// Number of buckets in the store.
+    size_t bucketCount() const
+        { return m_buckets.size(); }
+
+private:
+    struct Bucket
+    {
+        Bucket();
+
+        std::vector<uint32_t> m_keys;
+        std::vector<uint32_t> m_values;
+        uint32_t m_size;
+        uint64_t m_lastUse;
+    };
+
+    void grow(Bucket& b);
+    void evict();
+
+    std::unordered_map<uint64_t, Bucket> m_buckets;
+    uint64_t m_evictAge;
+    uint64_t m_tick;
+    size_t m_size;
+    // The bucket of the last insertion.  Consecutive points usually fall
+    // in the same bucket, so this saves most lookups.
+    uint64_t m_lastKey;
+    Bucket *m_last;
+};
+
+} // namespace pdal
@@ -34,6 +34,7 @@ CSF::CSF(int index) {
     params.cloth_resolution = 1;
     params.rigidness        = 3;
     params.interations      = 500;
+    params.threads          = 1;
 
     this->index = index;
 }
@@ -45,6 +46,7 @@ CSF::CSF() {
     params.cloth_resolution = 1;
     params.rigidness        = 3;
     params.interations      = 500;
+    params.threads          = 1;
 
     this->index = 0;
 }
@@ -154,7 +156,8 @@ void CSF::do_filtering(std::vector<int>& groundIndexes,
         0.3,
         9999,
         params.rigidness,
-        params.time_step
+        params.time_step,
+        params.threads
     );
 
     log->get(pdal::LogLevel::Debug) << "[" << this->index << "] Rasterizing..." << endl;
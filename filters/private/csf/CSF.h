@@ -50,6 +50,7 @@ struct Params {
     double cloth_resolution;
     int rigidness;
     int interations;
+    int threads;
 };
 
 #ifdef _CSF_DLL_EXPORT_
@@ -27,10 +27,12 @@ Cloth::Cloth(const Vec3& _origin_pos,
              double      _smoothThreshold,
              double      _heightThreshold,
              int         rigidness,
-             double      time_step)
+             double      time_step,
+             int         _threads)
     : constraint_iterations(rigidness),
     smoothThreshold(_smoothThreshold),
     heightThreshold(_heightThreshold),
+    threads(_threads > 1 ? _threads : 1),
     origin_pos(_origin_pos),
     step_x(_step_x),
     step_y(_step_y),
@@ -97,13 +99,32 @@ Cloth::Cloth(const Vec3& _origin_pos,
 
 double Cloth::timeStep() {
     int particleCount = static_cast<int>(particles.size());
-    #pragma omp parallel for
-    for (int i = 0; i < particleCount; i++) {
-        particles[i].timeStep();
-    }
-    #pragma omp parallel for
-    for (int j = 0; j < particleCount; j++) {
-        particles[j].satisfyConstraintSelf(constraint_iterations);
+    parallelFor(particleCount, [this](int begin, int end) {
+        for (int i = begin; i < end; i++)
+            particles[i].timeStep();
+    });
+
+    if (threads == 1) {
+        for (int j = 0; j < particleCount; j++) {
+            particles[j].satisfyConstraintSelf(constraint_iterations);
+        }
+    } else {
+        // Satisfying the constraints of a particle moves the particles up
+        // to two cells away, so particles five cells apart in both
+        // directions never touch the same neighbor.
+        for (int cy = 0; cy < 5; cy++) {
+            for (int cx = 0; cx < 5; cx++) {
+                int nx = (num_particles_width - cx + 4) / 5;
+                int ny = (num_particles_height - cy + 4) / 5;
+                if (nx <= 0 || ny <= 0)
+                    continue;
+                parallelFor(nx * ny, [this, cx, cy, nx](int begin, int end) {
+                    for (int k = begin; k < end; k++)
+                        getParticle(cx + 5 * (k % nx), cy + 5 * (k / nx))->
+                            satisfyConstraintSelf(constraint_iterations);
+                });
+            }
+        }
     }
     double maxDiff = 0;
 
@@ -128,15 +149,16 @@ void Cloth::addForce(const Vec3 direction) {
 
 void Cloth::terrCollision() {
     int particleCount = static_cast<int>(particles.size());
-    #pragma omp parallel for
-    for (int i = 0; i < particleCount; i++) {
-        Vec3 v = particles[i].getPos();
+    parallelFor(particleCount, [this](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            Vec3 v = particles[i].getPos();
 
-        if (v.f[1] < heightvals[i]) {
-            particles[i].offsetPos(Vec3(0, heightvals[i] - v.f[1], 0));
-            particles[i].makeUnmovable();
+            if (v.f[1] < heightvals[i]) {
+                particles[i].offsetPos(Vec3(0, heightvals[i] - v.f[1], 0));
+                particles[i].makeUnmovable();
+            }
         }
-    }
+    });
     saveToFile("collision-notes.txt");
 }
 
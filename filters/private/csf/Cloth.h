@@ -57,6 +57,8 @@
 #include <queue>
 #include <cmath>
 #include <list>
+#include <memory>
+#include <pdal/util/TaskScheduler.hpp>
 using namespace std;
 
 #include "Vec3.h"
@@ -86,6 +88,9 @@ private:
     double smoothThreshold;
     double heightThreshold;
 
+    // number of ranges that parallelFor() runs at once
+    int threads;
+
 public:
 
     Vec3 origin_pos;
@@ -121,6 +126,24 @@ public:
         return &particles[index];
     }
 
+    /* Call f(begin, end) over ranges covering [0, count), one range per
+     * thread, on the task scheduler and wait for all of them to finish.
+     * Short ranges are run on the calling thread, where waking the workers
+     * costs more than the work itself. */
+    template <typename F>
+    void parallelFor(int count, F f) {
+        if (threads == 1 || count < threads * 4096) {
+            f(0, count);
+            return;
+        }
+        const int n = threads;
+        pdal::parallelFor(n, n, [&f, count, n](std::size_t t) {
+            int begin = static_cast<int>((long long)count * t / n);
+            int end = static_cast<int>((long long)count * (t + 1) / n);
+            f(begin, end);
+        });
+    }
+
 public:
 
     /* This is a important constructor for the entire system of
@@ -133,12 +156,15 @@ public:
           double      smoothThreshold,
           double      heightThreshold,
           int         rigidness,
-          double      time_step);
+          double      time_step,
+          int         threads = 1);
 
     /* this is an important methods where the time is progressed one
      * time step for the entire cloth.  This includes calling
      * satisfyConstraint() for every constraint, and calling
-     * timeStep() for all particles
+     * timeStep() for all particles.  With more than one thread, the
+     * constraints of particles five cells apart are satisfied together,
+     * in 25 colored passes over the cloth.
      */
     double timeStep();
 
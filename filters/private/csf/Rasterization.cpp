@@ -20,6 +20,16 @@
 
 
 double Rasterization::findHeightValByScanline(Particle *p, Cloth& cloth) {
+    double height = findHeightValInLines(p, cloth);
+
+    if (height > MIN_INF)
+        return height;
+
+    return findHeightValByNeighbor(p, cloth);
+}
+
+
+double Rasterization::findHeightValInLines(Particle *p, Cloth& cloth) {
     int xpos = p->pos_x;
     int ypos = p->pos_y;
 
@@ -51,7 +61,7 @@ double Rasterization::findHeightValByScanline(Particle *p, Cloth& cloth) {
             return crresHeight;
     }
 
-    return findHeightValByNeighbor(p, cloth);
+    return MIN_INF;
 }
 
 
@@ -130,15 +140,24 @@ void Rasterization::RasterTerrian(Cloth          & cloth,
     }
     heightVal.resize(cloth.getSize());
 
-    #pragma omp parallel for
-    for (int i = 0; i < cloth.getSize(); i++) {
-        Particle *pcur          = cloth.getParticle1d(i);
-        double    nearestHeight = pcur->nearestPointHeight;
-
-        if (nearestHeight > MIN_INF) {
-            heightVal[i] = nearestHeight;
-        } else {
-            heightVal[i] = findHeightValByScanline(pcur, cloth);
+    // The scanline search only reads the cloth and runs on all threads.
+    // The search through neighbors marks particles as visited, so the
+    // particles left for it are handled afterwards, in order.
+    cloth.parallelFor(cloth.getSize(), [&cloth, &heightVal](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            Particle *pcur          = cloth.getParticle1d(i);
+            double    nearestHeight = pcur->nearestPointHeight;
+
+            if (nearestHeight > MIN_INF) {
+                heightVal[i] = nearestHeight;
+            } else {
+                heightVal[i] = findHeightValInLines(pcur, cloth);
+            }
         }
+    });
+
+    for (int i = 0; i < cloth.getSize(); i++) {
+        if (!(heightVal[i] > MIN_INF))
+            heightVal[i] = findHeightValByNeighbor(cloth.getParticle1d(i), cloth);
     }
 }
@@ -35,6 +35,9 @@ public:
     // the heightval are set as its neighbor's
     double static findHeightValByNeighbor(Particle *p, Cloth& cloth);
     double static findHeightValByScanline(Particle *p, Cloth& cloth);
+    // the heightval of the nearest particle in the same row or column that
+    // has one, or MIN_INF.  Only reads the cloth, so it can run concurrently.
+    double static findHeightValInLines(Particle *p, Cloth& cloth);
 
     void static   RasterTerrian(Cloth          & cloth,
                                 csf::PointCloud& pc,
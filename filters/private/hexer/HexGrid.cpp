@@ -36,6 +36,8 @@
 #include <cmath>
 #include <algorithm>
 
+#include <pdal/util/TaskScheduler.hpp>
+
 #include "HexGrid.hpp"
 #include "HexIter.hpp"
 #include "Mathpair.hpp"
@@ -83,6 +85,32 @@ void HexGrid::addPoint(Point p)
 
     Hexagon *h = findHexagon(p);
     h->increment();
+    checkDense(h);
+}
+
+// Add counts of points binned with binPoint().  The dense hexagons and
+// possible roots that result don't depend on the order in which counts
+// are added, so partial counts can be merged in any order.
+void HexGrid::addCounts(const HexCounts& counts)
+{
+    for (auto it = counts.begin(); it != counts.end(); ++it)
+    {
+        int x = (int32_t)(uint32_t)(it->first & 0xFFFFFFFF);
+        int y = (int32_t)(uint32_t)(it->first >> 32);
+        Hexagon *h = getHexagon(x, y);
+        h->setCount(h->count() + it->second);
+        checkDense(h);
+    }
+}
+
+void HexGrid::setOrigin(Point p)
+{
+    if (m_hexes.empty())
+        findHexagon(p);
+}
+
+void HexGrid::checkDense(Hexagon *h)
+{
     if (!h->dense())
     {
         if (dense(h))
@@ -180,8 +208,6 @@ void HexGrid::markNeighborBelow(Hexagon *h)
 //
 Hexagon *HexGrid::findHexagon(Point p)
 {
-    int x, y;
-
     if (m_hexes.empty())
     {
         m_origin = p;
@@ -191,6 +217,13 @@ Hexagon *HexGrid::findHexagon(Point p)
         HexMap::iterator it = m_hexes.insert(hexpair).first;
         return &it->second;
     }
+    return getHexagon(hexCoord(p));
+}
+
+// Compute the grid position of a point.  The origin must have been set.
+Coord HexGrid::hexCoord(Point p) const
+{
+    int x, y;
 
     // Offset by the origin.
     p -= m_origin;
@@ -250,7 +283,7 @@ Hexagon *HexGrid::findHexagon(Point p)
             }
         }
     }
-    return getHexagon(x, y);
+    return Coord(x, y);
 }
 
 // Get the hexagon at position x, y.  If it doesn't exist, create it.
@@ -269,6 +302,15 @@ Hexagon *HexGrid::getHexagon(int x, int y)
     return hex_p;
 }
 
+// Get the hexagon at position x, y.  Returns NULL if it doesn't exist.
+// Doesn't modify the map, so it can be called from several threads.
+Hexagon *HexGrid::existingHexagon(int x, int y) const
+{
+    HexMap::const_iterator it = m_hexes.find(Hexagon::key(x, y));
+    return it == m_hexes.end() ? nullptr :
+        const_cast<Hexagon *>(&it->second);
+}
+
 /**
 // Walk the outside of the hexagons to make a path.  Hexagon sides are labeled:
 //
@@ -294,13 +336,34 @@ void HexGrid::findShapes()
     }
 }
 
-void HexGrid::findParentPaths()
+// Finding the parent of a path only reads the grid and sets the parent
+// of the path itself, so the searches are split among the threads.
+void HexGrid::findParentPaths(int threads)
 {
+    const size_t count = m_paths.size();
+    const size_t numThreads = (std::min)(count,
+        (size_t)(std::max)(threads, 1));
+    if (numThreads <= 1)
+    {
+        for (size_t i = 0; i < count; ++i)
+            findParentPath(m_paths[i]);
+    }
+    else
+    {
+        auto run = [this](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
+                findParentPath(m_paths[i]);
+        };
+        pdal::parallelFor(numThreads, numThreads,
+            [&run, count, numThreads](size_t t)
+            { run(t * count / numThreads, (t + 1) * count / numThreads); });
+    }
+
     std::vector<Path *> roots;
     for (size_t i = 0; i < m_paths.size(); ++i)
     {
         Path *p = m_paths[i];
-        findParentPath(p);
         // Either add the path to the root list or the parent's list of
         // children.
         !p->parent() ?  roots.push_back(p) : p->parent()->addChild(p);
@@ -317,9 +380,12 @@ void HexGrid::findParentPath(Path *p)
 {
     Segment s = p->rootSegment();
     Hexagon *h = s.hex();
-    int y = h->y();
-    while (y >= m_miny)
+    int x = h->x();
+    for (int y = h->y(); y >= m_miny; h = existingHexagon(x, --y))
     {
+        // Hexagons that don't exist aren't on any path.
+        if (!h)
+            continue;
         HexPathMap::iterator it = m_hex_paths.find(h);
         if (it != m_hex_paths.end())
         {
@@ -333,7 +399,6 @@ void HexGrid::findParentPath(Path *p)
                p->setParent(parentPath);
             }
         }
-        h = getHexagon(h->x(), --y);
     }
 }
 
@@ -68,7 +68,7 @@ public:
 
     // Exported for testing.
     PDAL_DLL void findShapes();
-    PDAL_DLL void findParentPaths();
+    PDAL_DLL void findParentPaths(int threads = 1);
     PDAL_DLL void toWKT(std::ostream&) const;
     PDAL_DLL void addDenseHexagon(int x, int y);
 
@@ -78,6 +78,19 @@ public:
     void addPoint(Point p);
     void processSample();
 
+    /// Per-hexagon point counts keyed by Hexagon::key().
+    typedef std::unordered_map<uint64_t, int> HexCounts;
+    /// Whether the hexagon size and the origin are fixed, so that points
+    /// can be binned independently with binPoint().
+    bool binnable() const
+        { return m_width > 0 && !m_hexes.empty(); }
+    void binPoint(Point p, HexCounts& counts) const
+        { Coord c = hexCoord(p); counts[Hexagon::key(c.m_x, c.m_y)]++; }
+    void addCounts(const HexCounts& counts);
+    /// Set the origin of the grid without adding a point, so that points
+    /// can be binned once the hexagon size is known.
+    void setOrigin(Point p);
+
     void extractShapes();
     void dumpInfo();
     void drawHexagons();
@@ -107,6 +120,9 @@ public:
 private:
     void initialize(double height);
     Hexagon *findHexagon(Point p);
+    Coord hexCoord(Point p) const;
+    Hexagon *existingHexagon(int x, int y) const;
+    void checkDense(Hexagon *h);
     void findShape(Hexagon *hex);
     void findHole(Hexagon *hex);
     void cleanPossibleRoot(Segment s, Path *p);
@@ -90,6 +90,20 @@ inline std::string typeToString(ComparisonType c)
     }
 }
 
+inline Selection::Compare toSelectionCompare(ComparisonType c)
+{
+    switch (c)
+    {
+        case ComparisonType::eq: return Selection::Compare::Eq;
+        case ComparisonType::gt: return Selection::Compare::Gt;
+        case ComparisonType::gte: return Selection::Compare::Gte;
+        case ComparisonType::lt: return Selection::Compare::Lt;
+        case ComparisonType::lte: return Selection::Compare::Lte;
+        case ComparisonType::ne: return Selection::Compare::Ne;
+        default: throw pdal_error("Invalid single comparison type");
+    }
+}
+
 inline bool isSingle(ComparisonType co)
 {
     return co != ComparisonType::in && co != ComparisonType::nin;
@@ -142,6 +156,16 @@ public:
             return Dimension::name(m_id);
     }
 
+    // Push the comparison of a dimension with this operand.
+    void compile(Selection& selection, Dimension::Id dimId,
+        Selection::Compare co) const
+    {
+        if (m_id == Dimension::Id::Unknown)
+            selection.pushCompare(dimId, co, m_value);
+        else
+            selection.pushCompare(dimId, co, m_id);
+    }
+
 private:
     double m_value = 0;
     Dimension::Id m_id = Dimension::Id::Unknown;
@@ -176,6 +200,11 @@ public:
         return compare(pr.getFieldAs<double>(m_dimId), m_operand.get(pr));
     }
 
+    virtual void compile(Selection& selection) const override
+    {
+        m_operand.compile(selection, m_dimId, toSelectionCompare(type()));
+    }
+
     virtual std::string toString(std::string pre) const override
     {
         std::ostringstream ss;
@@ -282,6 +311,15 @@ public:
         return ss.str();
     }
 
+    virtual void compile(Selection& selection) const override
+    {
+        for (const auto& op : m_operands)
+            op.compile(selection, m_dimId, Selection::Compare::Eq);
+        selection.pushOr(m_operands.size());
+        if (type() == ComparisonType::nin)
+            selection.pushNot();
+    }
+
 protected:
     const Operands m_operands;
 };
@@ -59,6 +59,11 @@ public:
         return m_root.toString("");
     }
 
+    void compile(Selection& selection) const
+    {
+        m_root.compile(selection);
+    }
+
 private:
     void build(LogicGate& gate, const NL::json& json);
 
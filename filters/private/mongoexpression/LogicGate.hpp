@@ -117,6 +117,13 @@ public:
         return true;
     }
 
+    virtual void compile(Selection& selection) const override
+    {
+        for (const auto& f : m_filters)
+            f->compile(selection);
+        selection.pushAnd(m_filters.size());
+    }
+
 protected:
     virtual LogicalOperator type() const override
     {
@@ -141,6 +148,14 @@ public:
         return !(*m_filters.at(0))(pr);
     }
 
+    virtual void compile(Selection& selection) const override
+    {
+        if (m_filters.size() != 1)
+            throw pdal_error("Logical NOT requires a single expression");
+        m_filters.front()->compile(selection);
+        selection.pushNot();
+    }
+
 private:
     virtual LogicalOperator type() const override
     {
@@ -161,6 +176,13 @@ public:
         return false;
     }
 
+    virtual void compile(Selection& selection) const override
+    {
+        for (const auto& f : m_filters)
+            f->compile(selection);
+        selection.pushOr(m_filters.size());
+    }
+
 protected:
     virtual LogicalOperator type() const override
     {
@@ -177,6 +199,12 @@ public:
         return !LogicalOr::operator()(pr);
     }
 
+    virtual void compile(Selection& selection) const override
+    {
+        LogicalOr::compile(selection);
+        selection.pushNot();
+    }
+
 protected:
     virtual LogicalOperator type() const override
     {
@@ -39,6 +39,8 @@
 #include <pdal/PointLayout.hpp>
 #include <pdal/PointRef.hpp>
 
+#include "../Selection.hpp"
+
 namespace pdal
 {
 
@@ -54,6 +56,9 @@ class Filterable : public Loggable
 {
 public:
     virtual bool operator()(const PointRef& pr) const = 0;
+
+    // Append the expression to a compiled selection.
+    virtual void compile(Selection& selection) const = 0;
 };
 
 class Comparable : public Loggable
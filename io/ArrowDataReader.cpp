@@ -0,0 +1,220 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <cstring>
+
+#include "ArrowDataReader.hpp"
+
+namespace pdal
+{
+
+static StaticPluginInfo const s_info
+{
+    "readers.arrowdata",
+    "Read points from Arrow C data interface arrays.",
+    "http://pdal.io/stages/readers.arrowdata.html",
+    {}
+};
+
+CREATE_STATIC_STAGE(ArrowDataReader, s_info)
+
+std::string ArrowDataReader::getName() const { return s_info.name; }
+
+namespace
+{
+
+// Whether an element of an array is null.  Arrays without nulls needn't
+// have a validity bitmap.
+bool isNull(const ArrowArray& array, int64_t idx)
+{
+    const uint8_t *bits = static_cast<const uint8_t *>(array.buffers[0]);
+    if (array.null_count == 0 || !bits)
+        return false;
+    return !(bits[idx / 8] & (1 << (idx % 8)));
+}
+
+// Whether two schemas have children with the same names and formats.
+bool sameFields(const ArrowSchema& s1, const ArrowSchema& s2)
+{
+    if (s1.n_children != s2.n_children)
+        return false;
+    for (int64_t i = 0; i < s1.n_children; ++i)
+    {
+        const ArrowSchema& c1 = *s1.children[i];
+        const ArrowSchema& c2 = *s2.children[i];
+        if (strcmp(c1.format, c2.format) != 0 ||
+                strcmp(c1.name ? c1.name : "", c2.name ? c2.name : "") != 0)
+            return false;
+    }
+    return true;
+}
+
+} // unnamed namespace
+
+
+ArrowDataReader::ArrowDataReader() : m_batch(0), m_row(0)
+{
+    m_schema.release = nullptr;
+}
+
+
+ArrowDataReader::~ArrowDataReader()
+{
+    if (m_schema.release)
+        m_schema.release(&m_schema);
+    for (ArrowArray& array : m_arrays)
+        if (array.release)
+            array.release(&array);
+}
+
+
+void ArrowDataReader::addBatch(ArrowSchema *schema, ArrowArray *array)
+{
+    ArrowSchema s = *schema;
+    ArrowArray a = *array;
+    schema->release = nullptr;
+    array->release = nullptr;
+
+    // Release the structures if they can't be used.
+    auto release = [&s, &a]()
+    {
+        if (s.release)
+            s.release(&s);
+        if (a.release)
+            a.release(&a);
+    };
+
+    if (strcmp(s.format, "+s") != 0 || a.n_children != s.n_children)
+    {
+        release();
+        throwError("Points must be provided as a struct array.");
+    }
+    if (m_schema.release)
+    {
+        bool same = sameFields(m_schema, s);
+        s.release(&s);
+        if (!same)
+        {
+            a.release(&a);
+            throwError("Schema of batch doesn't match the schema of the "
+                "first batch.");
+        }
+    }
+    else
+        m_schema = s;
+    m_arrays.push_back(a);
+}
+
+
+void ArrowDataReader::addDimensions(PointLayoutPtr layout)
+{
+    if (!m_schema.release)
+        throwError("Points can't be read without calling addBatch().");
+
+    m_columns.clear();
+    for (int64_t i = 0; i < m_schema.n_children; ++i)
+    {
+        const ArrowSchema& child = *m_schema.children[i];
+        std::string name(child.name ? child.name : "");
+        Dimension::Type type = arrowdata::type(child.format);
+        if (type == Dimension::Type::None)
+        {
+            log()->get(LogLevel::Debug) << getName() << ": Skipping array '" <<
+                name << "' of format '" << child.format << "'." << std::endl;
+            continue;
+        }
+        m_columns.emplace_back(name, type, i);
+        m_columns.back().m_id = layout->registerOrAssignDim(name, type);
+    }
+}
+
+
+void ArrowDataReader::ready(PointTableRef)
+{
+    m_batch = 0;
+    m_row = 0;
+}
+
+
+point_count_t ArrowDataReader::read(PointViewPtr view, point_count_t count)
+{
+    PointId idx = view->size();
+    point_count_t cnt = 0;
+
+    PointRef point(*view);
+    while (cnt < count)
+    {
+        point.setPointId(idx);
+        if (!processOne(point))
+            break;
+        cnt++;
+        idx++;
+    }
+    return cnt;
+}
+
+
+bool ArrowDataReader::processOne(PointRef& point)
+{
+    const uint64_t zero = 0;
+
+    while (m_batch < m_arrays.size() && m_row == m_arrays[m_batch].length)
+    {
+        m_batch++;
+        m_row = 0;
+    }
+    if (m_batch == m_arrays.size())
+        return false;
+
+    // The offset of a struct array applies to its children.
+    const ArrowArray& array = m_arrays[m_batch];
+    const int64_t row = array.offset + m_row++;
+    const bool nullPoint = isNull(array, row);
+    for (const Column& c : m_columns)
+    {
+        const ArrowArray& child = *array.children[c.m_child];
+        const int64_t idx = child.offset + row;
+        if (nullPoint || isNull(child, idx))
+            point.setField(c.m_id, c.m_type, &zero);
+        else
+        {
+            const char *values = static_cast<const char *>(child.buffers[1]);
+            point.setField(c.m_id, c.m_type,
+                values + idx * Dimension::size(c.m_type));
+        }
+    }
+    return true;
+}
+
+} // namespace pdal
@@ -0,0 +1,100 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <pdal/ArrowData.hpp>
+#include <pdal/Reader.hpp>
+#include <pdal/Streamable.hpp>
+
+namespace pdal
+{
+
+/**
+  Reads points from arrays exported through the Arrow C data interface,
+  such as those made by arrowdata::exportView().  Each array must be a
+  struct array whose children are arrays of fixed-size numbers.  Each child
+  is read into the dimension with the child's name.
+*/
+class PDAL_DLL ArrowDataReader : public Reader, public Streamable
+{
+    struct Column
+    {
+        std::string m_name;
+        Dimension::Type m_type;
+        Dimension::Id m_id;
+        int64_t m_child;  // Index of the child array.
+
+        Column(const std::string& name, Dimension::Type type,
+                int64_t child) :
+            m_name(name), m_type(type), m_id(Dimension::Id::Unknown),
+            m_child(child)
+        {}
+    };
+
+public:
+    ArrowDataReader();
+    ~ArrowDataReader();
+
+    std::string getName() const;
+
+    /**
+      Add a batch of points to be read.  The reader takes ownership of the
+      schema and array: they're moved to the reader and their release
+      callbacks are set to nullptr.  The reader releases them when it's
+      destroyed.  Batches are read in the order they were added and must
+      all have the schema of the first batch.
+
+      \param schema  Schema of the array.
+      \param array  Struct array of points.
+    */
+    void addBatch(ArrowSchema *schema, ArrowArray *array);
+
+private:
+    virtual void addDimensions(PointLayoutPtr layout);
+    virtual void ready(PointTableRef table);
+    virtual point_count_t read(PointViewPtr view, point_count_t count);
+    virtual bool processOne(PointRef& point);
+
+    ArrowSchema m_schema;
+    std::vector<ArrowArray> m_arrays;
+    std::vector<Column> m_columns;
+    size_t m_batch;  // Index of the array being read.
+    int64_t m_row;  // Index of the next point of the array.
+
+    ArrowDataReader(const ArrowDataReader&) = delete;
+    ArrowDataReader& operator=(const ArrowDataReader&) = delete;
+};
+
+} // namespace pdal
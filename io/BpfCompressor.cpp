@@ -34,18 +34,69 @@
 
 #include "BpfCompressor.hpp"
 
+#ifdef PDAL_HAVE_ZLIB
+#include <pdal/compression/DeflateCompression.hpp>
+#endif
+#ifdef PDAL_HAVE_LZ4
+#include <pdal/compression/Lz4Compression.hpp>
+#endif
+
 namespace pdal
 {
 
+Compressor *BpfCompressor::makeCompressor(BpfCompression type, BlockCb cb)
+{
+    try
+    {
+        switch (type)
+        {
 #ifdef PDAL_HAVE_ZLIB
+        case BpfCompression::Zlib:
+            return new DeflateCompressor(cb);
+#endif
+#ifdef PDAL_HAVE_LZ4
+        case BpfCompression::Lz4:
+            return new Lz4Compressor(cb);
+#endif
+        default:
+            throw error("Unsupported BPF compression type.");
+        }
+    }
+    catch (const compression_error& err)
+    {
+        throw error("Could not initialize BPF compressor: " +
+            std::string(err.what()));
+    }
+}
+
+
+std::vector<char> BpfCompressor::compressBlock(BpfCompression type,
+    const char *buf, size_t size)
+{
+    std::vector<char> out;
+    std::unique_ptr<Compressor> compressor(makeCompressor(type,
+        [&out](char *b, size_t s){ out.insert(out.end(), b, b + s); }));
+    try
+    {
+        compressor->compress(buf, size);
+        compressor->done();
+    }
+    catch (const compression_error& err)
+    {
+        throw error(err.what());
+    }
+    return out;
+}
+
+
 void BpfCompressor::startBlock()
 {
-    // Initialize the stream.
-    m_strm.zalloc = Z_NULL;
-    m_strm.zfree = Z_NULL;
-    m_strm.opaque = Z_NULL;
-    if (deflateInit(&m_strm, Z_DEFAULT_COMPRESSION) != Z_OK)
-        throw error("Could not initialize BPF compressor.");
+    auto cb = [this](char *buf, size_t size)
+    {
+        m_out.put(buf, size);
+        m_compressedSize += size;
+    };
+    m_compressor.reset(makeCompressor(m_type, cb));
 
     m_rawSize = 0;
     m_compressedSize = 0;
@@ -75,19 +126,15 @@ void BpfCompressor::compress()
 
     m_rawSize += rawWritten;
 
-    // Deflate the data in the buffer and write it to the output stream.
-    m_strm.avail_in = rawWritten;
-    m_strm.next_in = (unsigned char *)m_inbuf.data();
-    m_strm.avail_out = CHUNKSIZE;
-    m_strm.next_out = m_tmpbuf;
-    while (m_strm.avail_in)
+    // Compress the data in the buffer.  The compressor writes to the
+    // output stream.
+    try
     {
-        int ret = ::deflate(&m_strm, Z_NO_FLUSH);
-        size_t written = CHUNKSIZE - m_strm.avail_out;
-        m_compressedSize += written;
-        m_out.put(m_tmpbuf, written);
-        m_strm.avail_out = CHUNKSIZE;
-        m_strm.next_out = m_tmpbuf;
+        m_compressor->compress(m_inbuf.data(), rawWritten);
+    }
+    catch (const compression_error& err)
+    {
+        throw error(err.what());
     }
 
     // All data has been written.  Reinitialize input buffer's streambuf and
@@ -102,20 +149,17 @@ void BpfCompressor::finish()
     // Pop our special stream so that we can write the the file.
     delete m_out.popStream();
 
-    // Deflate and write the result to the output file.
-    int ret = Z_OK;
-    while (ret == Z_OK)
+    // Flush the compressor and write the result to the output file.
+    try
+    {
+        m_compressor->done();
+    }
+    catch (const compression_error& err)
     {
-        ret = ::deflate(&m_strm, Z_FINISH);
-        size_t written = CHUNKSIZE - m_strm.avail_out;
-        m_compressedSize += written;
-        m_out.put(m_tmpbuf, written);
-        m_strm.avail_out = CHUNKSIZE;
-        m_strm.next_out = m_tmpbuf;
+        throw error("Couldn't close BPF compression stream: " +
+            std::string(err.what()));
     }
-    if (ret != Z_STREAM_END)
-        throw error("Couldn't close BPF compression stream.");
-    deflateEnd(&m_strm);
+    m_compressor.reset();
 
     // Mark our position so that we can get back here.
     OStreamMarker blockEnd(m_out);
@@ -128,16 +172,4 @@ void BpfCompressor::finish()
     blockEnd.rewind();
 }
 
-#else
-
-void BpfCompressor::startBlock()
-{}
-void BpfCompressor::compress()
-{}
-void BpfCompressor::finish()
-{}
-
-#endif // PDAL_HAVE_ZLIB
-
 } // namespace pdal
-
@@ -34,16 +34,16 @@
 
 #pragma once
 
+#include <memory>
 #include <stdexcept>
 #include <ostream>
 
 #include <pdal/pdal_features.hpp>
+#include <pdal/compression/Compression.hpp>
 #include <pdal/util/Charbuf.hpp>
 #include <pdal/util/OStream.hpp>
 
-#ifdef PDAL_HAVE_ZLIB
-#include <zlib.h>
-#endif // PDAL_HAVE_ZLIB
+#include "BpfHeader.hpp"
 
 namespace pdal
 {
@@ -57,34 +57,31 @@ public:
         {}
     };
 
-#ifdef PDAL_HAVE_ZLIB
-    BpfCompressor(OLeStream& out, size_t maxSize) :
-        m_out(out), m_inbuf(maxSize), m_blockStart(out), m_rawSize(0),
-        m_compressedSize(0)
+    BpfCompressor(OLeStream& out, size_t maxSize,
+            BpfCompression type = BpfCompression::Zlib) :
+        m_out(out), m_type(type), m_inbuf(maxSize), m_blockStart(out),
+        m_rawSize(0), m_compressedSize(0)
     {}
-#else
-    BpfCompressor(OLeStream&, size_t)
-    {}
-#endif // PDAL_HAVE_ZLIB
 
     void startBlock();
     void finish();
     void compress();
 
+    // Compress a complete block at once.
+    static std::vector<char> compressBlock(BpfCompression type,
+        const char *buf, size_t size);
+
 private:
-    static const int CHUNKSIZE = 1000000;
+    static Compressor *makeCompressor(BpfCompression type, BlockCb cb);
 
-#ifdef PDAL_HAVE_ZLIB
     OLeStream& m_out;
+    BpfCompression m_type;
     Charbuf m_charbuf;
     std::vector<char> m_inbuf;
-    z_stream m_strm;
-    unsigned char m_tmpbuf[CHUNKSIZE];
+    std::unique_ptr<Compressor> m_compressor;
     OStreamMarker m_blockStart;
     size_t m_rawSize;
     size_t m_compressedSize;
-#endif // PDAL_HAVE_ZLIB
 };
 
 } // namespace pdal
-
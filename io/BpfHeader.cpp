@@ -365,6 +365,11 @@ bool BpfUlemFile::write(OLeStream& stream)
     stream.put("FILE", 4);
     stream << m_len;
     stream.put(m_filename, 32);
+    if (m_filespec.empty())
+    {
+        stream.put(m_buf.data(), m_buf.size());
+        return true;
+    }
 
     std::ifstream in(m_filespec, std::ios::binary);
     uint32_t len = m_len;
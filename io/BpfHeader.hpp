@@ -114,7 +114,8 @@ enum class BpfCompression
     None,
     QuickLZ,
     FastLZ,
-    Zlib
+    Zlib,
+    Lz4     // PDAL extension - not part of the BPF specification.
 };
 
 struct BpfDimension
@@ -226,6 +227,13 @@ struct BpfUlemFile
         m_len(len), m_filename(filename), m_filespec(filespec)
     {}
 
+    // A file whose contents are held in memory rather than read from disk.
+    BpfUlemFile(const std::string& filename,
+            const std::vector<uint8_t>& buf) :
+        m_len((uint32_t)buf.size()), m_filename(filename),
+        m_buf(buf.begin(), buf.end())
+    {}
+
     bool read(ILeStream& stream);
     bool write(OLeStream& stream);
 };
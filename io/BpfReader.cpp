@@ -36,12 +36,19 @@
 
 #include <climits>
 
+#include <pdal/GDALUtils.hpp>
 #include <pdal/Options.hpp>
 #include <pdal/pdal_features.hpp>
+#include <pdal/PDALUtils.hpp>
+#include <pdal/util/ProgramArgs.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
 #ifdef PDAL_HAVE_ZLIB
 #include <zlib.h>
 #endif
+#ifdef PDAL_HAVE_LZ4
+#include <pdal/compression/Lz4Compression.hpp>
+#endif
 
 namespace pdal
 {
@@ -60,6 +67,21 @@ CREATE_STATIC_STAGE(BpfReader, s_info)
 
 std::string BpfReader::getName() const { return s_info.name; }
 
+namespace
+{
+
+const double LOWEST = (std::numeric_limits<double>::lowest)();
+const double HIGHEST = (std::numeric_limits<double>::max)();
+
+// Number of points of a query read together before they're filtered.
+const point_count_t BATCH_SIZE = 65536;
+
+// Name of the bundled file that holds the chunk bounds index written by
+// writers.bpf.
+const std::string CHUNK_BOUNDS_FILENAME = "pdal_chunk_bounds";
+
+} // unnamed namespace
+
 QuickInfo BpfReader::inspect()
 {
     QuickInfo qi;
@@ -92,6 +114,21 @@ QuickInfo BpfReader::inspect()
 }
 
 
+void BpfReader::addArgs(ProgramArgs& args)
+{
+    args.add("threads", "Number of threads used to decompress blocks",
+        m_threads, 1);
+    args.add("read_ahead", "Number of blocks of uncompressed point data "
+        "read ahead of decoding.  0 reads points synchronously", m_readAhead,
+        4);
+    args.add("bounds", "Bounds of points to read.  Chunks of a file with "
+        "a chunk bounds index that don't overlap are skipped", m_bounds);
+    args.add("polygon", "Bounding polygon(s) of points to read",
+        m_polys).setErrorText("Invalid polygon specification. "
+            "Must be valid GeoJSON/WKT");
+}
+
+
 // When the stage is intialized, the schema needs to be populated with the
 // dimensions in order to allow subsequent stages to be aware of or append to
 // the dimensions in the PointView.
@@ -123,10 +160,20 @@ void BpfReader::initialize()
         throwError(err.what());
     }
 #ifndef PDAL_HAVE_ZLIB
-    if (m_header.m_compression)
+    if (m_header.m_compression == Utils::toNative(BpfCompression::Zlib))
         throwError("Can't read compressed BPF. PDAL wasn't built with "
             "Zlib support.");
 #endif
+#ifndef PDAL_HAVE_LZ4
+    if (m_header.m_compression == Utils::toNative(BpfCompression::Lz4))
+        throwError("Can't read LZ4 compressed BPF. PDAL wasn't built with "
+            "LZ4 support.");
+#endif
+    if (m_header.m_compression &&
+        m_header.m_compression != Utils::toNative(BpfCompression::Zlib) &&
+        m_header.m_compression != Utils::toNative(BpfCompression::Lz4))
+        throwError("Unsupported BPF compression type " +
+            std::to_string(m_header.m_compression) + ".");
 
     std::string code;
     if (m_header.m_coordType == static_cast<int>(BpfCoordType::Cartesian))
@@ -172,6 +219,7 @@ void BpfReader::initialize()
     }
 
     setSpatialReference(code);
+    prepareQuery();
 
     if (m_header.m_version >= 3)
     {
@@ -226,8 +274,23 @@ bool BpfReader::readUlemData()
 bool BpfReader::readUlemFiles()
 {
     BpfUlemFile file;
+    m_chunks.clear();
     while (file.read(m_stream))
     {
+        if (file.m_filename == CHUNK_BOUNDS_FILENAME)
+        {
+            try
+            {
+                m_chunks = LasChunkIndex::parseChunkBounds(file.m_buf.data(),
+                    file.m_buf.size());
+            }
+            catch (const LasChunkIndex::error& err)
+            {
+                log()->get(LogLevel::Warning) << getName() << ": " <<
+                    err.what() << " Ignoring chunk bounds." << std::endl;
+            }
+            continue;
+        }
         MetadataNode m = m_metadata.add("bundled_file");
         m.addEncoded(file.m_filename,
             (const unsigned char *)file.m_buf.data(), file.m_len);
@@ -245,7 +308,7 @@ bool BpfReader::readHeaderExtraData()
         std::streampos size = m_header.m_len - m_stream.position();
         std::vector<uint8_t> buf(size);
         m_stream.get(buf);
-        m_metadata.addEncoded("header_data", buf.data(), buf.size());
+        m_metadata.addEncoded("header_data", std::move(buf));
     }
     return (bool)m_stream;
 }
@@ -273,26 +336,178 @@ void BpfReader::ready(PointTableRef)
     m_stream.seek(m_header.m_len);
     m_index = 0;
     m_start = m_stream.position();
-#ifdef PDAL_HAVE_ZLIB
+    if (m_query)
+        selectRanges();
     if (m_header.m_compression)
     {
         m_deflateBuf.resize(numPoints() * m_dims.size() * sizeof(float));
-        size_t index = 0;
-        size_t bytesRead = 0;
-        do
-        {
-            bytesRead = readBlock(m_deflateBuf, index);
-            index += bytesRead;
-        } while (bytesRead > 0 && index < m_deflateBuf.size());
+        readBlocks();
         m_charbuf.initialize(m_deflateBuf.data(), m_deflateBuf.size(), m_start);
         m_stream.pushStream(new std::istream(&m_charbuf));
     }
-#endif // PDAL_HAVE_ZLIB
+    else if (m_readAhead > 0 && !Utils::isRemote(m_filename))
+    {
+        m_async.reset(new AsyncReader(m_readAhead));
+        if (!m_async->open(m_filename))
+        {
+            log()->get(LogLevel::Debug) << getName() << ": " <<
+                m_async->error() << " Reading points synchronously." <<
+                std::endl;
+            m_async.reset();
+        }
+    }
+    // Points are read from the current index, so skipping only requires
+    // moving it.  The points of a query are those of the selected ranges.
+    m_step = 1;
+    if (!m_query)
+    {
+        if (readStride(numPoints()))
+        {
+            const PointLimit& limit = pointLimit();
+            m_step = limit.m_step;
+            m_strideEnd = (std::min)(numPoints(), limit.m_first);
+            m_index = (std::min)(limit.m_offset, m_strideEnd);
+        }
+        else
+            m_index = pointsToSkip(numPoints());
+    }
+}
+
+
+// Transform the query bounds and polygons to the SRS of the file.
+void BpfReader::prepareQuery()
+{
+    const SpatialReference& boundsSrs = m_bounds.spatialReference();
+    m_query = m_bounds.to2d().valid() || m_polys.size();
+    if (!m_query)
+        return;
+
+    if (m_bounds.is3d())
+        m_queryBounds = m_bounds.to3d();
+    else if (m_bounds.to2d().valid())
+    {
+        BOX2D box = m_bounds.to2d();
+        m_queryBounds = BOX3D(box.minx, box.miny, LOWEST,
+            box.maxx, box.maxy, HIGHEST);
+    }
+    else
+        m_queryBounds = BOX3D(LOWEST, LOWEST, LOWEST,
+            HIGHEST, HIGHEST, HIGHEST);
+    if (boundsSrs.valid())
+        gdal::reprojectBounds(m_queryBounds,
+            boundsSrs.getWKT(), getSpatialReference().getWKT());
+
+    std::vector<Polygon> exploded;
+    for (Polygon& poly : m_polys)
+    {
+        if (!poly.valid())
+            throwError("Geometrically invalid polyon in option 'polygon'.");
+        poly.transform(getSpatialReference());
+
+        std::vector<Polygon> polys = poly.polygons();
+        exploded.insert(exploded.end(),
+            std::make_move_iterator(polys.begin()),
+            std::make_move_iterator(polys.end()));
+    }
+    m_polys = std::move(exploded);
+}
+
+
+// Determine the ranges of points to read: those not in a chunk of the
+// chunk bounds index that lies outside the query.  Without an index,
+// all points are read and filtered.
+void BpfReader::selectRanges()
+{
+    std::vector<PointRange> skipped;
+    for (const LasChunkIndex::Chunk& c : m_chunks)
+    {
+        bool overlaps = c.m_bounds.overlaps(m_queryBounds);
+        if (overlaps && m_polys.size())
+        {
+            overlaps = false;
+            for (const Polygon& poly : m_polys)
+                if (!poly.disjoint(c.m_bounds))
+                {
+                    overlaps = true;
+                    break;
+                }
+        }
+        if (!overlaps)
+            skipped.push_back({ c.m_first, c.m_first + c.m_count });
+    }
+    std::sort(skipped.begin(), skipped.end());
+
+    m_ranges.clear();
+    PointId pos = 0;
+    for (const PointRange& r : skipped)
+    {
+        if (r.first > pos)
+            m_ranges.push_back({ pos, (std::min)(r.first, numPoints()) });
+        pos = (std::max)(pos, r.second);
+        if (pos >= numPoints())
+            break;
+    }
+    if (pos < numPoints())
+        m_ranges.push_back({ pos, numPoints() });
+    m_curRange = 0;
+
+    point_count_t selected = 0;
+    for (const PointRange& r : m_ranges)
+        selected += r.second - r.first;
+    log()->get(LogLevel::Debug) << getName() << ": Chunk bounds index has " <<
+        m_chunks.size() << " chunks.  Reading " << selected << " of " <<
+        numPoints() << " points." << std::endl;
+}
+
+
+// Return the number of points left in the current range, moving to the
+// start of the next range once the current one has been read.  Returns 0
+// when all ranges have been read.
+point_count_t BpfReader::rangeRemaining()
+{
+    while (m_curRange < m_ranges.size())
+    {
+        const PointRange& r = m_ranges[m_curRange];
+        if (m_index < r.first)
+            m_index = r.first;
+        if (m_index < r.second)
+            return r.second - m_index;
+        m_curRange++;
+    }
+    return 0;
+}
+
+
+// Determine whether any of the points [first, end) are in a selected range.
+bool BpfReader::rangeSelected(PointId first, PointId end) const
+{
+    for (const PointRange& r : m_ranges)
+        if (r.first < end && first < r.second)
+            return true;
+    return false;
+}
+
+
+bool BpfReader::passesFilter(PointRef& point) const
+{
+    double x = point.getFieldAs<double>(Dimension::Id::X);
+    double y = point.getFieldAs<double>(Dimension::Id::Y);
+    double z = point.getFieldAs<double>(Dimension::Id::Z);
+
+    if (!m_queryBounds.contains(x, y, z))
+        return false;
+    if (m_polys.empty())
+        return true;
+    for (const Polygon& poly : m_polys)
+        if (poly.contains(x, y))
+            return true;
+    return false;
 }
 
 
 void BpfReader::done(PointTableRef)
 {
+    m_async.reset();
     if (auto s = m_stream.popStream())
         delete s;
     m_stream.close();
@@ -302,9 +517,28 @@ void BpfReader::done(PointTableRef)
 
 bool BpfReader::processOne(PointRef& point)
 {
-    if (eof() || m_index >= m_count)
-        return false;
+    if (m_step > 1)
+        return nextStridePoint(point);
+    if (!m_query)
+    {
+        if (eof() || m_index >= m_count)
+            return false;
+        readOne(point);
+        return true;
+    }
+
+    while (rangeRemaining())
+    {
+        readOne(point);
+        if (passesFilter(point))
+            return true;
+    }
+    return false;
+}
 
+
+void BpfReader::readOne(PointRef& point)
+{
     switch (m_header.m_pointFormat)
     {
     case BpfFormat::PointMajor:
@@ -317,11 +551,93 @@ bool BpfReader::processOne(PointRef& point)
         readByteMajor(point);
         break;
     }
+}
+
+
+point_count_t BpfReader::read(PointViewPtr view, point_count_t count)
+{
+    if (m_query)
+        return readQuery(view, count);
+    if (m_step > 1)
+        return readStrided(view, count);
+
+    PointId id = view->size();
+    point_count_t numRead = readPoints(view, count);
+    if (m_cb)
+        for (; id < view->size(); ++id)
+            m_cb(*view, id);
+    return numRead;
+}
+
+
+// Read the points of the query's ranges, keeping those that pass the
+// query filter.  Points are read into a temporary view so that those
+// that don't pass can be dropped.
+point_count_t BpfReader::readQuery(PointViewPtr view, point_count_t count)
+{
+    PointViewPtr tmp = view->makeNew();
+    PointRef point(*tmp, 0);
+
+    point_count_t numRead = 0;
+    while (numRead < count)
+    {
+        point_count_t n = (std::min)(rangeRemaining(), BATCH_SIZE);
+        if (!n)
+            break;
+
+        PointId idx = tmp->size();
+        if (!readPoints(tmp, n))
+            break;
+        for (; idx < tmp->size() && numRead < count; ++idx)
+        {
+            point.setPointId(idx);
+            if (!passesFilter(point))
+                continue;
+            PointId id = view->size();
+            view->appendPoint(*tmp, idx);
+            numRead++;
+            if (m_cb)
+                m_cb(*view, id);
+        }
+    }
+    return numRead;
+}
+
+
+// Read the next point of the stride.  Points are read at the current
+// index, so moving to the one after it only requires moving the index.
+bool BpfReader::nextStridePoint(PointRef& point)
+{
+    if (m_index >= m_strideEnd)
+        return false;
+    readOne(point);
+    m_index = (std::min)(m_index + m_step - 1, m_strideEnd);
     return true;
 }
 
 
-point_count_t BpfReader::read(PointViewPtr data, point_count_t count)
+// Read up to 'count' points of the stride.
+point_count_t BpfReader::readStrided(PointViewPtr view, point_count_t count)
+{
+    PointRef point(*view, 0);
+
+    point_count_t numRead = 0;
+    while (numRead < count)
+    {
+        PointId id = view->size();
+        point.setPointId(id);
+        if (!nextStridePoint(point))
+            break;
+        numRead++;
+        if (m_cb)
+            m_cb(*view, id);
+    }
+    return numRead;
+}
+
+
+// Read up to 'count' points starting at the current point.
+point_count_t BpfReader::readPoints(PointViewPtr data, point_count_t count)
 {
     switch (m_header.m_pointFormat)
     {
@@ -371,37 +687,56 @@ void BpfReader::readPointMajor(PointRef& point)
 }
 
 
+// Determine whether a dimension can be skipped because it isn't used
+// downstream.  X, Y and Z are always read since the header transform
+// applies to all three.
+bool BpfReader::skipDim(size_t d) const
+{
+    Dimension::Id id = m_dims[d].m_id;
+    if (id == Dimension::Id::X || id == Dimension::Id::Y ||
+        id == Dimension::Id::Z)
+        return false;
+    return !dimRequired(id);
+}
+
+
 point_count_t BpfReader::readPointMajor(PointViewPtr view, point_count_t count)
 {
     PointId nextId = view->size();
     PointId idx = m_index;
     point_count_t numRead = 0;
-    seekPointMajor(idx);
-    while (numRead < count && idx < numPoints())
+    auto readPoints = [&](point_count_t n)
     {
-        for (size_t d = 0; d < m_dims.size(); ++d)
+        for (; n; --n)
         {
-            float f;
+            for (size_t d = 0; d < m_dims.size(); ++d)
+            {
+                float f;
 
-            m_stream >> f;
-            view->setField(m_dims[d].m_id, nextId, f + m_dims[d].m_offset);
-        }
+                m_stream >> f;
+                if (!skipDim(d))
+                    view->setField(m_dims[d].m_id, nextId,
+                        f + m_dims[d].m_offset);
+            }
 
-        // Transformation only applies to X, Y and Z
-        double x = view->getFieldAs<double>(Dimension::Id::X, nextId);
-        double y = view->getFieldAs<double>(Dimension::Id::Y, nextId);
-        double z = view->getFieldAs<double>(Dimension::Id::Z, nextId);
-        m_header.m_xform.apply(x, y, z);
-        view->setField(Dimension::Id::X, nextId, x);
-        view->setField(Dimension::Id::Y, nextId, y);
-        view->setField(Dimension::Id::Z, nextId, z);
-        if (m_cb)
-            m_cb(*view, nextId);
+            // Transformation only applies to X, Y and Z
+            double x = view->getFieldAs<double>(Dimension::Id::X, nextId);
+            double y = view->getFieldAs<double>(Dimension::Id::Y, nextId);
+            double z = view->getFieldAs<double>(Dimension::Id::Z, nextId);
+            m_header.m_xform.apply(x, y, z);
+            view->setField(Dimension::Id::X, nextId, x);
+            view->setField(Dimension::Id::Y, nextId, y);
+            view->setField(Dimension::Id::Z, nextId, z);
+
+            idx++;
+            numRead++;
+            nextId++;
+        }
+    };
 
-        idx++;
-        numRead++;
-        nextId++;
-    }
+    const size_t pointSize = sizeof(float) * m_dims.size();
+    count = (std::min)(count, numPoints() - (std::min)(idx, numPoints()));
+    readRecords(idx * pointSize, count, pointSize, readPoints);
     m_index = idx;
     return numRead;
 }
@@ -409,7 +744,6 @@ point_count_t BpfReader::readPointMajor(PointViewPtr view, point_count_t count)
 
 BpfReader::~BpfReader()
 {
-#ifdef PDAL_HAVE_ZLIB
     if (m_header.m_compression)
     {
         for( auto& stream: m_streams )
@@ -417,21 +751,20 @@ BpfReader::~BpfReader()
             delete stream->popStream();
         }
     }
-#endif
 }
 
 void BpfReader::readDimMajor(PointRef& point)
 {
+    // The streams only need to be positioned when they're opened or when
+    // points have been skipped.
+    bool seek = m_streams.empty() || m_streamIndex != m_index;
     if (m_streams.empty())
     {
         for (std::size_t dim(0); dim < m_dims.size(); ++dim)
         {
-            std::streamoff offset = sizeof(float) * dim * numPoints();
-
             m_streams.emplace_back(new ILeStream());
             m_streams.back()->open(m_filename);
 
-#ifdef PDAL_HAVE_ZLIB
             if (m_header.m_compression)
             {
                 m_charbufs.emplace_back(new Charbuf());
@@ -441,11 +774,15 @@ void BpfReader::readDimMajor(PointRef& point)
                 m_streams.back()->pushStream(
                         new std::istream(m_charbufs.back().get()));
             }
-#endif // PDAL_HAVE_ZLIB
-
-            m_streams.back()->seek(m_start + offset);
         }
     }
+    if (seek)
+        for (std::size_t dim(0); dim < m_dims.size(); ++dim)
+        {
+            std::streamoff offset =
+                sizeof(float) * (dim * numPoints() + m_index);
+            m_streams[dim]->seek(m_start + offset);
+        }
 
     double x(0), y(0), z(0);
     float f(0);
@@ -471,6 +808,7 @@ void BpfReader::readDimMajor(PointRef& point)
     point.setField(Dimension::Id::Y, y);
     point.setField(Dimension::Id::Z, z);
     m_index++;
+    m_streamIndex = m_index;
 }
 
 
@@ -479,19 +817,27 @@ point_count_t BpfReader::readDimMajor(PointViewPtr data, point_count_t count)
     PointId idx(0);
     PointId startId = data->size();
     point_count_t numRead = 0;
+    count = (std::min)(count, numPoints() - (std::min)(m_index, numPoints()));
     for (size_t d = 0; d < m_dims.size(); ++d)
     {
+        if (skipDim(d))
+            continue;
         idx = m_index;
         PointId nextId = startId;
         numRead = 0;
-        seekDimMajor(d, idx);
-        for (; numRead < count && idx < numPoints(); idx++, numRead++, nextId++)
+        auto readDim = [&](point_count_t n)
         {
-            float f;
+            for (; n; --n, idx++, numRead++, nextId++)
+            {
+                float f;
 
-            m_stream >> f;
-            data->setField(m_dims[d].m_id, nextId, f + m_dims[d].m_offset);
-        }
+                m_stream >> f;
+                data->setField(m_dims[d].m_id, nextId,
+                    f + m_dims[d].m_offset);
+            }
+        };
+        readRecords(sizeof(float) * (d * numPoints() + idx), count,
+            sizeof(float), readDim);
     }
     m_index = idx;
 
@@ -505,9 +851,6 @@ point_count_t BpfReader::readDimMajor(PointViewPtr data, point_count_t count)
         data->setField(Dimension::Id::X, idx, x);
         data->setField(Dimension::Id::Y, idx, y);
         data->setField(Dimension::Id::Z, idx, z);
-
-        if (m_cb)
-            m_cb(*data, idx);
     }
 
     return numRead;
@@ -566,34 +909,38 @@ point_count_t BpfReader::readByteMajor(PointViewPtr data, point_count_t count)
         float f;
         uint32_t u32;
     };
-    std::unique_ptr<union uu[]> uArr(
-        new uu[(std::min)(count, numPoints() - m_index)]);
+    count = (std::min)(count, numPoints() - (std::min)(m_index, numPoints()));
+    std::unique_ptr<union uu[]> uArr(new uu[count]);
 
     for (size_t d = 0; d < m_dims.size(); ++d)
     {
+        if (skipDim(d))
+            continue;
         for (size_t b = 0; b < sizeof(float); ++b)
         {
             idx = m_index;
             numRead = 0;
             PointId nextId = startId;
-            seekByteMajor(d, b, idx);
-
-            for (;numRead < count && idx < numPoints();
-                idx++, numRead++, nextId++)
+            auto readBytes = [&](point_count_t n)
             {
-                union uu& u = *(uArr.get() + numRead);
-
-                if (b == 0)
-                    u.u32 = 0;
-                uint8_t u8;
-                m_stream >> u8;
-                u.u32 |= ((uint32_t)u8 << (b * CHAR_BIT));
-                if (b == 3)
+                for (; n; --n, idx++, numRead++, nextId++)
                 {
-                    u.f += static_cast<float>(m_dims[d].m_offset);
-                    data->setField(m_dims[d].m_id, nextId, u.f);
+                    union uu& u = *(uArr.get() + numRead);
+
+                    if (b == 0)
+                        u.u32 = 0;
+                    uint8_t u8;
+                    m_stream >> u8;
+                    u.u32 |= ((uint32_t)u8 << (b * CHAR_BIT));
+                    if (b == 3)
+                    {
+                        u.f += static_cast<float>(m_dims[d].m_offset);
+                        data->setField(m_dims[d].m_id, nextId, u.f);
+                    }
                 }
-            }
+            };
+            readRecords((d * numPoints() * sizeof(float)) +
+                (b * numPoints()) + idx, count, 1, readBytes);
         }
     }
     m_index = idx;
@@ -608,26 +955,72 @@ point_count_t BpfReader::readByteMajor(PointViewPtr data, point_count_t count)
         data->setField(Dimension::Id::X, idx, x);
         data->setField(Dimension::Id::Y, idx, y);
         data->setField(Dimension::Id::Z, idx, z);
-
-        if (m_cb)
-            m_cb(*data, idx);
     }
 
     return numRead;
 }
 
 
-void BpfReader::seekPointMajor(PointId ptIdx)
+// Read 'count' consecutive records of 'unit' bytes that start 'offset'
+// bytes into the point data.  'fn' is called to decode the records
+// available at the stream's position, possibly more than once.  When
+// the file is read ahead, records are decoded from blocks already read
+// while the following blocks are read.
+void BpfReader::readRecords(std::streamoff offset, point_count_t count,
+    size_t unit, const std::function<void(point_count_t)>& fn)
 {
-    std::streamoff offset = ptIdx * sizeof(float) * m_dims.size();
-    m_stream.seek(m_start + offset);
+    if (!m_async)
+    {
+        m_stream.seek(m_start + offset);
+        fn(count);
+        return;
+    }
+
+    // Blocks hold whole records.
+    const size_t blockSize =
+        unit * (std::max)((size_t)1, (size_t)(1 << 20) / unit);
+    m_async->request((uint64_t)m_start + offset, count * unit, blockSize);
+    while (count)
+    {
+        std::vector<char> buf;
+        try
+        {
+            buf = m_async->next();
+        }
+        catch (const std::runtime_error& err)
+        {
+            m_async->clear();
+            throwError(err.what());
+        }
+
+        // A short block means the file is truncated.
+        point_count_t n = (std::min)(count, (point_count_t)(buf.size() / unit));
+        if (n == 0)
+            break;
+
+        Charbuf charbuf(buf);
+        std::istream in(&charbuf);
+        m_stream.pushStream(&in);
+        try
+        {
+            fn(n);
+        }
+        catch (...)
+        {
+            m_stream.popStream();
+            m_async->clear();
+            throw;
+        }
+        m_stream.popStream();
+        count -= n;
+    }
+    m_async->clear();
 }
 
 
-void BpfReader::seekDimMajor(size_t dimIdx, PointId ptIdx)
+void BpfReader::seekPointMajor(PointId ptIdx)
 {
-    std::streamoff offset = ((sizeof(float) * dimIdx * numPoints()) +
-        (sizeof(float) * ptIdx));
+    std::streamoff offset = ptIdx * sizeof(float) * m_dims.size();
     m_stream.seek(m_start + offset);
 }
 
@@ -642,25 +1035,103 @@ void BpfReader::seekByteMajor(size_t dimIdx, size_t byteIdx, PointId ptIdx)
 }
 
 
-#ifdef PDAL_HAVE_ZLIB
-size_t BpfReader::readBlock(std::vector<char>& outBuf, size_t index)
+// Read the compressed blocks that follow the header and decompress them
+// into the deflate buffer.  Blocks are independent (in dimension-major
+// files there's one per dimension), so they're decompressed concurrently
+// when more than one thread is requested.  Blocks of point-major data
+// that hold no points of a query's ranges are skipped.
+void BpfReader::readBlocks()
 {
-    uint32_t finalBytes;
-    uint32_t compressBytes;
+    const size_t pointSize = sizeof(float) * m_dims.size();
+
+    std::unique_ptr<ThreadPool> pool;
+    if (m_threads > 1)
+        pool.reset(new ThreadPool(m_threads, m_threads, false));
+
+    size_t index = 0;
+    while (index < m_deflateBuf.size())
+    {
+        uint32_t finalBytes;
+        uint32_t compressBytes;
+
+        m_stream >> finalBytes;
+        m_stream >> compressBytes;
+        if (!m_stream || finalBytes == 0 ||
+                finalBytes > m_deflateBuf.size() - index)
+            break;
+
+        if (m_query && m_header.m_pointFormat == BpfFormat::PointMajor &&
+            !rangeSelected(index / pointSize,
+                (index + finalBytes + pointSize - 1) / pointSize))
+        {
+            m_stream.seek(m_stream.position() + (std::streamoff)compressBytes);
+            index += finalBytes;
+            continue;
+        }
+
+        // Fill the input bytes from the stream.
+        std::shared_ptr<std::vector<char>> in(
+            new std::vector<char>(compressBytes));
+        m_stream.get(*in);
+
+        char *out = m_deflateBuf.data() + index;
+        auto decode = [this, in, out, finalBytes]()
+        {
+            decompress(in->data(), (uint32_t)in->size(), out, finalBytes);
+        };
+        if (pool)
+            pool->add(decode);
+        else
+            decode();
+        index += finalBytes;
+    }
+    if (pool)
+        pool->join();
+}
+
 
-    m_stream >> finalBytes;
-    m_stream >> compressBytes;
+int BpfReader::decompress(char *buf, uint32_t insize,
+    char *outbuf, uint32_t outsize)
+{
+#ifdef PDAL_HAVE_ZLIB
+    if (m_header.m_compression == Utils::toNative(BpfCompression::Zlib))
+        return inflate(buf, insize, outbuf, outsize);
+#endif
+#ifdef PDAL_HAVE_LZ4
+    if (m_header.m_compression == Utils::toNative(BpfCompression::Lz4))
+        return lz4Decompress(buf, insize, outbuf, outsize);
+#endif
+    return -1;
+}
 
-    std::vector<char> in(compressBytes);
 
-    // Fill the input bytes from the stream.
-    m_stream.get(in);
-    int ret = inflate(in.data(), compressBytes,
-        outBuf.data() + index, finalBytes);
-    return (ret ? 0 : finalBytes);
+#ifdef PDAL_HAVE_LZ4
+int BpfReader::lz4Decompress(char *buf, uint32_t insize,
+    char *outbuf, uint32_t outsize)
+{
+    uint32_t written = 0;
+    try
+    {
+        Lz4Decompressor dec([&outbuf, &written, outsize](char *b, size_t size)
+        {
+            if (size > outsize - written)
+                throw compression_error("Block larger than expected.");
+            std::copy(b, b + size, outbuf + written);
+            written += size;
+        });
+        dec.decompress(buf, insize);
+        dec.done();
+    }
+    catch (const compression_error&)
+    {
+        return -1;
+    }
+    return written == outsize ? 0 : -1;
 }
+#endif // PDAL_HAVE_LZ4
 
 
+#ifdef PDAL_HAVE_ZLIB
 int BpfReader::inflate(char *buf, uint32_t insize,
     char *outbuf, uint32_t outsize)
 {
@@ -39,13 +39,17 @@
 
 #include <vector>
 
+#include <pdal/Polygon.hpp>
 #include <pdal/Reader.hpp>
+#include <pdal/SrsBounds.hpp>
 #include <pdal/Streamable.hpp>
+#include <pdal/util/AsyncReader.hpp>
 #include <pdal/util/Charbuf.hpp>
 #include <pdal/util/IStream.hpp>
 #include <pdal/pdal_export.hpp>
 
 #include "BpfHeader.hpp"
+#include "LasChunkIndex.hpp"
 
 #include <vector>
 
@@ -75,16 +79,41 @@ private:
     std::streampos m_start;
     /// Index of the next point to read.
     point_count_t m_index;
+    /// Distance between the points read when the stage that follows asks
+    /// for a stride.
+    point_count_t m_step;
+    /// Index past the last point of the stride.
+    PointId m_strideEnd;
     /// Buffer for deflated data.
     std::vector<char> m_deflateBuf;
     /// Streambuf for deflated data.
     Charbuf m_charbuf;
+    /// Number of threads used to decompress blocks.
+    int m_threads;
+    /// Number of blocks of uncompressed points read ahead.
+    int m_readAhead;
+    /// Reads blocks of uncompressed points ahead of decoding.
+    std::unique_ptr<AsyncReader> m_async;
+
+    // Spatial query.  Ranges are [first, end) point indexes to read.
+    using PointRange = std::pair<PointId, PointId>;
+    SrsBounds m_bounds;
+    std::vector<Polygon> m_polys;
+    BOX3D m_queryBounds;
+    bool m_query;
+    /// Extents of chunks of points, from the file's chunk bounds index.
+    LasChunkIndex::ChunkList m_chunks;
+    std::vector<PointRange> m_ranges;
+    size_t m_curRange;
 
     // For dimension-major point-at-a-time usage.
     std::vector<std::unique_ptr<ILeStream>> m_streams;
     std::vector<std::unique_ptr<Charbuf>> m_charbufs;
+    /// Index of the point at which the dimension streams are positioned.
+    PointId m_streamIndex;
 
     virtual QuickInfo inspect();
+    virtual void addArgs(ProgramArgs& args);
     virtual void initialize();
     virtual void addDimensions(PointLayoutPtr Layout);
     virtual void ready(PointTableRef table);
@@ -96,19 +125,35 @@ private:
     bool readUlemFiles();
     bool readHeaderExtraData();
     bool readPolarData();
+    bool skipDim(size_t d) const;
+    void prepareQuery();
+    void selectRanges();
+    point_count_t rangeRemaining();
+    bool passesFilter(PointRef& point) const;
+    bool rangeSelected(PointId first, PointId end) const;
+    void readOne(PointRef& point);
+    point_count_t readPoints(PointViewPtr view, point_count_t count);
+    point_count_t readQuery(PointViewPtr view, point_count_t count);
+    bool nextStridePoint(PointRef& point);
+    point_count_t readStrided(PointViewPtr view, point_count_t count);
     void readPointMajor(PointRef& point);
     point_count_t readPointMajor(PointViewPtr data, point_count_t count);
     void readDimMajor(PointRef& point);
     point_count_t readDimMajor(PointViewPtr data, point_count_t count);
     void readByteMajor(PointRef& point);
     point_count_t readByteMajor(PointViewPtr data, point_count_t count);
-    size_t readBlock(std::vector<char>& outBuf, size_t index);
+    void readBlocks();
     bool eof();
+    int decompress(char *inbuf, uint32_t insize, char *outbuf,
+        uint32_t outsize);
     int inflate(char *inbuf, uint32_t insize, char *outbuf, uint32_t outsize);
+    int lz4Decompress(char *inbuf, uint32_t insize, char *outbuf,
+        uint32_t outsize);
 
     void seekPointMajor(PointId ptIdx);
-    void seekDimMajor(size_t dimIdx, PointId ptIdx);
     void seekByteMajor(size_t dimIdx, size_t byteIdx, PointId ptIdx);
+    void readRecords(std::streamoff offset, point_count_t count, size_t unit,
+        const std::function<void(point_count_t)>& fn);
 };
 
 } // namespace pdal
@@ -41,6 +41,8 @@
 #include <pdal/util/ProgramArgs.hpp>
 
 #include "BpfCompressor.hpp"
+#include <pdal/util/Inserter.hpp>
+#include <pdal/util/TaskScheduler.hpp>
 #include <pdal/util/Utils.hpp>
 #include <pdal/util/ProgramArgs.hpp>
 
@@ -61,6 +63,18 @@ CREATE_STATIC_STAGE(BpfWriter, s_info)
 
 std::string BpfWriter::getName() const { return s_info.name; }
 
+namespace
+{
+
+// Points per entry of the chunk bounds index.  This matches the size of
+// the compressed blocks of point-major data.
+const point_count_t CHUNK_SIZE = 10000;
+
+// Name of the bundled file that holds the chunk bounds index.
+const std::string CHUNK_BOUNDS_FILENAME = "pdal_chunk_bounds";
+
+} // unnamed namespace
+
 std::istream& operator>>(std::istream& in, BpfWriter::CoordId& id)
 {
     std::string s;
@@ -84,7 +98,10 @@ std::ostream& operator<<(std::ostream& out, const BpfWriter::CoordId& id)
 void BpfWriter::addArgs(ProgramArgs& args)
 {
     args.add("filename", "Output filename", m_filename).setPositional();
-    args.add("compression", "Output compression", m_compression);
+    args.add("compression", "Output compression: 'none', 'zlib' or 'lz4'",
+        m_compression, "none");
+    args.add("threads", "Number of threads used to compress "
+        "dimension-major data", m_threads, 1);
     args.add("header_data", "Base64-encoded header data", m_extraDataSpec);
     args.add("format", "Output format", m_header.m_pointFormat,
         BpfFormat::DimMajor);
@@ -92,6 +109,8 @@ void BpfWriter::addArgs(ProgramArgs& args)
     args.add("bundledfile", "List of files to bundle in output",
         m_bundledFilesSpec);
     args.add("output_dims", "Output dimensions", m_outputDims);
+    args.add("chunk_bounds", "Write the extents of each chunk of points "
+        "so that readers can skip chunks", m_writeChunkBounds);
     m_scaling.addArgs(args);
 }
 
@@ -101,13 +120,30 @@ void BpfWriter::initialize()
     m_header.m_coordId = m_coordId.m_val;
     m_header.m_coordType = Utils::toNative(m_header.m_coordId ?
         BpfCoordType::UTM : BpfCoordType::Cartesian);
+    // 'true' and 'false' are accepted for compatibility with the old
+    // boolean form of the option.
+    std::string compression = Utils::tolower(m_compression);
+    BpfCompression type;
+    if (compression == "none" || compression == "false")
+        type = BpfCompression::None;
+    else if (compression == "zlib" || compression == "true")
+        type = BpfCompression::Zlib;
+    else if (compression == "lz4")
+        type = BpfCompression::Lz4;
+    else
+        throwError("Invalid compression '" + m_compression + "'.  Must be "
+            "'none', 'zlib' or 'lz4'.");
 #ifndef PDAL_HAVE_ZLIB
-    if (m_compression)
+    if (type == BpfCompression::Zlib)
         throwError("Can't write compressed BPF. PDAL wasn't built with "
             "Zlib support.");
 #endif
-    m_header.m_compression = Utils::toNative(
-            m_compression ? BpfCompression::Zlib : BpfCompression::None);
+#ifndef PDAL_HAVE_LZ4
+    if (type == BpfCompression::Lz4)
+        throwError("Can't write LZ4 compressed BPF. PDAL wasn't built with "
+            "LZ4 support.");
+#endif
+    m_header.m_compression = Utils::toNative(type);
     m_extraData = Utils::base64_decode(m_extraDataSpec);
 
     for (auto file : m_bundledFilesSpec)
@@ -162,29 +198,25 @@ void BpfWriter::readyFile(const std::string& filename,
         if (m_header.trySetSpatialReference(srs))
             m_header.m_coordType = Utils::toNative(BpfCoordType::UTM);
     }
+}
 
-    // We will re-write the header and dimensions to account for the point
-    // count and dimension min/max.
-    try
-    {
-        m_header.write(m_stream);
-    }
-    catch (const BpfHeader::error& err)
-    {
-        throwError(err.what());
-    }
-    m_header.writeDimensions(m_stream, m_dims);
-    for (auto& file : m_bundledFiles)
-        file.write(m_stream);
-    m_stream.put((const char *)m_extraData.data(), m_extraData.size());
-
-    if (m_stream.position() > (std::numeric_limits<int32_t>::max)())
-        throwError("Data too large.  BPF only supports 2^32 - 1 bytes.");
-    m_header.m_len = static_cast<int32_t>(m_stream.position());
 
-    m_header.m_xform.m_vals[0] = m_scaling.m_xXform.m_scale.m_val;
-    m_header.m_xform.m_vals[5] = m_scaling.m_yXform.m_scale.m_val;
-    m_header.m_xform.m_vals[10] = m_scaling.m_zXform.m_scale.m_val;
+// Files only differ in their points, so a file writer only needs this
+// writer's configuration.
+FlexWriter *BpfWriter::makeFileWriter() const
+{
+    BpfWriter *w = new BpfWriter;
+    LogPtr l = log();
+    w->setLog(l);
+    w->m_header = m_header;
+    w->m_dims = m_dims;
+    w->m_extraData = m_extraData;
+    w->m_bundledFiles = m_bundledFiles;
+    w->m_threads = m_threads;
+    w->m_coordId = m_coordId;
+    w->m_scaling = m_scaling;
+    w->m_writeChunkBounds = m_writeChunkBounds;
+    return w;
 }
 
 
@@ -225,9 +257,86 @@ void BpfWriter::loadBpfDimensions(PointLayoutPtr layout)
 }
 
 
+// The header is written once the views of a file are known, since the
+// size of the chunk bounds index depends on the number of points.
 void BpfWriter::prerunFile(const PointViewSet& pvSet)
 {
     m_scaling.setAutoXForm(pvSet);
+
+    m_chunks.clear();
+    if (m_writeChunkBounds)
+    {
+        point_count_t count = 0;
+        for (const PointViewPtr& v : pvSet)
+            count += v->size();
+        for (PointId first = 0; first < count; first += CHUNK_SIZE)
+            m_chunks.push_back({ first, (std::min)(CHUNK_SIZE, count - first),
+                BOX3D() });
+    }
+    writeHeader();
+}
+
+
+void BpfWriter::writeHeader()
+{
+    // We will re-write the header and dimensions to account for the point
+    // count and dimension min/max.
+    try
+    {
+        m_header.write(m_stream);
+    }
+    catch (const BpfHeader::error& err)
+    {
+        throwError(err.what());
+    }
+    m_header.writeDimensions(m_stream, m_dims);
+    for (auto& file : m_bundledFiles)
+        file.write(m_stream);
+
+    // The chunk bounds index is a bundled file, rewritten with the actual
+    // bounds once the points are written.
+    if (m_writeChunkBounds)
+    {
+        m_chunkBoundsPos = m_stream.position();
+        BpfUlemFile index(CHUNK_BOUNDS_FILENAME,
+            LasChunkIndex::chunkBoundsData(m_chunks));
+        index.write(m_stream);
+    }
+    m_stream.put((const char *)m_extraData.data(), m_extraData.size());
+
+    if (m_stream.position() > (std::numeric_limits<int32_t>::max)())
+        throwError("Data too large.  BPF only supports 2^32 - 1 bytes.");
+    m_header.m_len = static_cast<int32_t>(m_stream.position());
+
+    m_header.m_xform.m_vals[0] = m_scaling.m_xXform.m_scale.m_val;
+    m_header.m_xform.m_vals[5] = m_scaling.m_yXform.m_scale.m_val;
+    m_header.m_xform.m_vals[10] = m_scaling.m_zXform.m_scale.m_val;
+}
+
+
+// Grow the bounds of the chunks that hold the points of a view.  The
+// bounds are those of the coordinates as they're read back, after
+// conversion to float.
+void BpfWriter::addChunkBounds(const PointView* data)
+{
+    auto readBack = [](double d, const XForm& xform, double offset)
+    {
+        float f = (float)(d / xform.m_scale.m_val - offset);
+        return (f + offset) * xform.m_scale.m_val;
+    };
+
+    for (PointId idx = 0; idx < data->size(); ++idx)
+    {
+        double x = readBack(data->getFieldAs<double>(Dimension::Id::X, idx),
+            m_scaling.m_xXform, m_dims[0].m_offset);
+        double y = readBack(data->getFieldAs<double>(Dimension::Id::Y, idx),
+            m_scaling.m_yXform, m_dims[1].m_offset);
+        double z = readBack(data->getFieldAs<double>(Dimension::Id::Z, idx),
+            m_scaling.m_zXform, m_dims[2].m_offset);
+        size_t chunk = (size_t)((m_header.m_numPts + idx) / CHUNK_SIZE);
+        if (chunk < m_chunks.size())
+            m_chunks[chunk].m_bounds.grow(x, y, z);
+    }
 }
 
 
@@ -240,6 +349,8 @@ void BpfWriter::writeView(const PointViewPtr dataShared)
     m_dims[0].m_offset = m_scaling.m_xXform.m_offset.m_val;
     m_dims[1].m_offset = m_scaling.m_yXform.m_offset.m_val;
     m_dims[2].m_offset = m_scaling.m_zXform.m_offset.m_val;
+    if (m_writeChunkBounds)
+        addChunkBounds(data);
 
     try
     {
@@ -277,7 +388,8 @@ void BpfWriter::writePointMajor(const PointView* data)
     // For compression we're going to write to a buffer so that it can be
     // compressed before it's written to the file stream.
     BpfCompressor compressor(m_stream,
-        blockpoints * sizeof(float) * m_dims.size());
+        blockpoints * sizeof(float) * m_dims.size(),
+        (BpfCompression)m_header.m_compression);
     PointId idx = 0;
     while (idx < data->size())
     {
@@ -304,22 +416,52 @@ void BpfWriter::writePointMajor(const PointView* data)
 
 void BpfWriter::writeDimMajor(const PointView* data)
 {
-    // We're going to pretend for now that we only ever have one point buffer.
-    BpfCompressor compressor(m_stream, data->size() * sizeof(float));
+    if (m_header.m_compression)
+    {
+        writeCompressedDimMajor(data);
+        return;
+    }
 
     for (auto & bpfDim : m_dims)
     {
-        if (m_header.m_compression)
-            compressor.startBlock();
         for (PointId idx = 0; idx < data->size(); ++idx)
         {
             double d = getAdjustedValue(data, bpfDim, idx);
             m_stream << (float)d;
         }
-        if (m_header.m_compression)
+    }
+}
+
+
+// Each dimension is compressed as its own block, so dimensions are gathered
+// and compressed concurrently, one per thread, and then written in order.
+void BpfWriter::writeCompressedDimMajor(const PointView* data)
+{
+    const BpfCompression type = (BpfCompression)m_header.m_compression;
+    const size_t rawSize = data->size() * sizeof(float);
+    const size_t numBlocks =
+        (std::min)((size_t)(std::max)(m_threads, 1), m_dims.size());
+    std::vector<std::vector<char>> bufs(numBlocks);
+
+    for (size_t first = 0; first < m_dims.size(); first += numBlocks)
+    {
+        const size_t used = (std::min)(numBlocks, m_dims.size() - first);
+        parallelFor(used, numBlocks, [&](std::size_t i)
         {
-            compressor.compress();
-            compressor.finish();
+            BpfDimension& bpfDim = m_dims[first + i];
+            std::vector<char> raw(rawSize);
+            LeInserter inserter(raw.data(), raw.size());
+            for (PointId idx = 0; idx < data->size(); ++idx)
+                inserter << (float)getAdjustedValue(data, bpfDim, idx);
+            bufs[i] = BpfCompressor::compressBlock(type, raw.data(),
+                raw.size());
+        });
+
+        for (size_t i = 0; i < used; ++i)
+        {
+            m_stream << (uint32_t)rawSize << (uint32_t)bufs[i].size();
+            m_stream.put(bufs[i].data(), bufs[i].size());
+            std::vector<char>().swap(bufs[i]);
         }
     }
 }
@@ -335,7 +477,8 @@ void BpfWriter::writeByteMajor(const PointView* data)
 
     // We're going to pretend for now that we only ever have one point buffer.
     BpfCompressor compressor(m_stream,
-        data->size() * sizeof(float) * m_dims.size());
+        data->size() * sizeof(float) * m_dims.size(),
+        (BpfCompression)m_header.m_compression);
 
     if (m_header.m_compression)
         compressor.startBlock();
@@ -390,6 +533,13 @@ void BpfWriter::doneFile()
         throwError(err.what());
     }
     m_header.writeDimensions(m_stream, m_dims);
+    if (m_writeChunkBounds)
+    {
+        m_stream.seek(m_chunkBoundsPos);
+        BpfUlemFile index(CHUNK_BOUNDS_FILENAME,
+            LasChunkIndex::chunkBoundsData(m_chunks));
+        index.write(m_stream);
+    }
     m_stream.close();
     getMetadata().addList("filename", m_curFilename);
 }
@@ -38,6 +38,7 @@
 #pragma once
 
 #include "BpfHeader.hpp"
+#include "LasChunkIndex.hpp"
 
 #include <pdal/pdal_export.hpp>
 #include <pdal/FlexWriter.hpp>
@@ -69,11 +70,15 @@ private:
     BpfDimensionList m_dims;
     std::vector<uint8_t> m_extraData;
     std::vector<BpfUlemFile> m_bundledFiles;
-    bool m_compression;
+    std::string m_compression;
+    int m_threads;
     CoordId m_coordId;
     std::string m_extraDataSpec;
     StringList m_bundledFilesSpec;
     std::string m_curFilename;
+    bool m_writeChunkBounds;
+    LasChunkIndex::ChunkList m_chunks;
+    std::streampos m_chunkBoundsPos;
 
     virtual void addArgs(ProgramArgs& args);
     virtual void initialize();
@@ -81,14 +86,18 @@ private:
     virtual void readyFile(const std::string& filename,
         const SpatialReference& srs);
     void prerunFile(const PointViewSet& pvSet);
+    void writeHeader();
     virtual void writeView(const PointViewPtr data);
     virtual void doneFile();
+    virtual FlexWriter *makeFileWriter() const;
 
     double getAdjustedValue(const PointView* data, BpfDimension& bpfDim,
         PointId idx);
     void loadBpfDimensions(PointLayoutPtr layout);
+    void addChunkBounds(const PointView* data);
     void writePointMajor(const PointView* data);
     void writeDimMajor(const PointView* data);
+    void writeCompressedDimMajor(const PointView* data);
     void writeByteMajor(const PointView* data);
     void writeCompressedBlock(char *buf, size_t size);
 };
@@ -0,0 +1,918 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include "CopcReader.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+
+#include <arbiter/arbiter.hpp>
+#include <nlohmann/json.hpp>
+
+#include <pdal/GDALUtils.hpp>
+#include <pdal/Polygon.hpp>
+#include <pdal/SrsBounds.hpp>
+#include <pdal/compression/LazPerfVlrCompression.hpp>
+#include <pdal/util/Extractor.hpp>
+#include <pdal/util/FileUtils.hpp>
+#include <pdal/util/IStream.hpp>
+#include <pdal/util/OStream.hpp>
+#include <pdal/util/ThreadPool.hpp>
+
+#include "LasVLR.hpp"
+#include "private/EptSupport.hpp"
+
+namespace pdal
+{
+
+namespace
+{
+
+const StaticPluginInfo s_info
+{
+    "readers.copc",
+    "Cloud-optimized point cloud (COPC) reader.",
+    "http://pdal.io/stages/readers.copc.html",
+    {}
+};
+
+const char COPC_USER_ID[] = "copc";
+const uint16_t COPC_INFO_RECORD_ID = 1;
+const size_t COPC_INFO_SIZE = 160;
+const size_t HIERARCHY_ENTRY_SIZE = 32;
+
+// The header of a LAS 1.4 file is 375 bytes.  The EVLR count is at byte 243
+// and the point count at byte 247.
+const size_t LAS14_HEADER_SIZE = 375;
+const size_t EVLR_COUNT_POS = 243;
+const size_t POINT_COUNT_POS = 247;
+
+const double LOWEST = (std::numeric_limits<double>::lowest)();
+const double HIGHEST = (std::numeric_limits<double>::max)();
+
+} // unnamed namespace
+
+CREATE_STATIC_STAGE(CopcReader, s_info)
+
+std::string CopcReader::getName() const { return s_info.name; }
+
+struct CopcReader::Args
+{
+public:
+    SrsBounds m_bounds;
+    std::size_t m_threads = 0;
+    double m_resolution = 0;
+    std::vector<Polygon> m_polys;
+
+    NL::json m_query;
+    NL::json m_headers;
+};
+
+struct CopcReader::NodeBuffer
+{
+    NodeBuffer(PointLayout& layout) : table(layout), view(table) { }
+    VectorPointTable table;
+    PointView view;
+};
+
+
+CopcReader::CopcReader() : m_args(new CopcReader::Args), m_spacing(0),
+    m_rootPageOffset(0), m_rootPageSize(0), m_depthEnd(0),
+    m_userLayout(nullptr), m_pointId(0)
+{}
+
+
+CopcReader::~CopcReader()
+{}
+
+
+void CopcReader::addArgs(ProgramArgs& args)
+{
+    args.add("bounds", "Bounds to fetch", m_args->m_bounds);
+    args.add("threads", "Number of worker threads", m_args->m_threads);
+    args.add("resolution", "Resolution limit", m_args->m_resolution);
+    args.add("polygon", "Bounding polygon(s) to crop requests",
+        m_args->m_polys).setErrorText("Invalid polygon specification. "
+            "Must be valid GeoJSON/WKT");
+    args.add("header", "Header fields to forward with HTTP requests",
+        m_args->m_headers);
+    args.add("query", "Query parameters to forward with HTTP requests",
+        m_args->m_query);
+}
+
+
+std::vector<char> CopcReader::fetch(uint64_t offset, uint64_t size) const
+{
+    std::vector<char> buf;
+
+    if (m_arbiter->isLocal(m_filename))
+    {
+        const std::string path(
+            arbiter::expandTilde(arbiter::stripProtocol(m_filename)));
+        std::istream *in = FileUtils::openFile(path);
+        if (!in)
+            throw pdal_error("Unable to open '" + m_filename + "'.");
+        buf.resize(size);
+        in->seekg(offset);
+        in->read(buf.data(), size);
+        bool ok = (in->gcount() == (std::streamsize)size);
+        FileUtils::closeFile(in);
+        if (!ok)
+            throw pdal_error("Unable to read " + std::to_string(size) +
+                " bytes at offset " + std::to_string(offset) + " from '" +
+                m_filename + "'.");
+    }
+    else
+    {
+        if (size == 0)
+            return buf;
+        StringMap headers(m_headers);
+        headers["Range"] = "bytes=" + std::to_string(offset) + "-" +
+            std::to_string(offset + size - 1);
+        buf = m_arbiter->getBinary(m_filename, headers, m_query);
+        if (buf.size() != size)
+            throw pdal_error("Range request for " + std::to_string(size) +
+                " bytes at offset " + std::to_string(offset) + " of '" +
+                m_filename + "' returned " + std::to_string(buf.size()) +
+                " bytes.");
+    }
+    return buf;
+}
+
+
+void CopcReader::initialize()
+{
+#if !defined(PDAL_HAVE_LASZIP) || !defined(PDAL_HAVE_LAZPERF)
+    throwError("Reading COPC requires PDAL to be built with both LASzip "
+        "and LAZperf support.");
+#endif
+
+    auto& debug(log()->get(LogLevel::Debug));
+
+    if (m_filename.empty())
+        throwError("Missing input filename");
+
+    initializeHttpForwards();
+
+    m_arbiter.reset(new arbiter::Arbiter());
+
+    const std::size_t threads((std::max)(m_args->m_threads, size_t(4)));
+    if (threads > 100)
+    {
+        log()->get(LogLevel::Warning) << "Using a large thread count: " <<
+            threads << " threads" << std::endl;
+    }
+    m_pool.reset(new ThreadPool(threads, 1));
+
+    try
+    {
+        readHeader();
+    }
+    catch (const std::exception& e)
+    {
+        throwError(e.what());
+    }
+    setSpatialReference(m_header.srs());
+
+    // Transform query bounds to match point source SRS.
+    SrsBounds& bounds = m_args->m_bounds;
+    const SpatialReference& boundsSrs = bounds.spatialReference();
+    if (!m_header.srs().valid() && boundsSrs.valid())
+        throwError("Can't use bounds with SRS with data source that has "
+            "no SRS.");
+    if (bounds.is3d())
+        m_queryBounds = bounds.to3d();
+    else if (bounds.to2d().valid())
+    {
+        BOX2D box = bounds.to2d();
+        m_queryBounds = BOX3D(box.minx, box.miny, LOWEST,
+            box.maxx, box.maxy, HIGHEST);
+    }
+    else
+        m_queryBounds = BOX3D(LOWEST, LOWEST, LOWEST,
+            HIGHEST, HIGHEST, HIGHEST);
+    if (boundsSrs.valid())
+        gdal::reprojectBounds(m_queryBounds,
+            boundsSrs.getWKT(), getSpatialReference().getWKT());
+
+    // Transform polygons to point source SRS.
+    std::vector<Polygon> exploded;
+    for (Polygon& poly : m_args->m_polys)
+    {
+        if (!poly.valid())
+            throwError("Geometrically invalid polyon in option 'polygon'.");
+        poly.transform(getSpatialReference());
+
+        std::vector<Polygon> polys = poly.polygons();
+        exploded.insert(exploded.end(),
+            std::make_move_iterator(polys.begin()),
+            std::make_move_iterator(polys.end()));
+    }
+    m_args->m_polys = std::move(exploded);
+
+    // Figure out our max depth.  The spacing of the root node is the
+    // distance between its points.
+    m_depthEnd = 0;
+    const double queryResolution(m_args->m_resolution);
+    if (queryResolution)
+    {
+        double currentResolution = m_spacing;
+
+        debug << "Root resolution: " << currentResolution << std::endl;
+
+        // To select the current resolution level, we need depthEnd to be one
+        // beyond it - this is a non-inclusive parameter.
+        ++m_depthEnd;
+
+        while (currentResolution > queryResolution)
+        {
+            currentResolution /= 2;
+            ++m_depthEnd;
+        }
+
+        debug << "Query resolution:  " << queryResolution << "\n";
+        debug << "Actual resolution: " << currentResolution << "\n";
+        debug << "Depth end: " << m_depthEnd << "\n";
+    }
+
+    debug << "Query bounds: " << m_queryBounds << "\n";
+    debug << "Threads: " << m_pool->numThreads() << std::endl;
+}
+
+
+void CopcReader::initializeHttpForwards()
+{
+    const auto remap([&](StringMap& map, NL::json obj, std::string type)
+    {
+        if (obj.is_null())
+            return;
+
+        if (!obj.is_object())
+            throwError("Invalid " + type + " parameters: expected object");
+
+        for (const auto& entry : obj.items())
+        {
+            if (!entry.value().is_string())
+                throwError("Invalid " + type + " parameters: "
+                    "expected string->string mapping");
+            map[entry.key()] = entry.value().get<std::string>();
+        }
+    });
+
+    remap(m_headers, m_args->m_headers, "header");
+    remap(m_query, m_args->m_query, "query");
+}
+
+
+// Read the LAS header and VLRs.  The EVLRs hold the hierarchy, which is read
+// a page at a time as it's needed, so they're skipped.
+void CopcReader::readHeader()
+{
+    std::vector<char> buf = fetch(0, LAS14_HEADER_SIZE);
+
+    uint32_t pointOffset;
+    LeExtractor extractor(buf.data() + 96, sizeof(pointOffset));
+    extractor >> pointOffset;
+    if (buf[24] != 1 || buf[25] != 4 || pointOffset < LAS14_HEADER_SIZE)
+        throw pdal_error("'" + m_filename + "' is not a LAS 1.4 file.");
+
+    buf = fetch(0, pointOffset);
+    std::fill(buf.begin() + EVLR_COUNT_POS,
+        buf.begin() + EVLR_COUNT_POS + sizeof(uint32_t), 0);
+
+    std::istringstream iss(std::string(buf.data(), buf.size()));
+    ILeStream in(&iss);
+    m_header.setLog(log());
+    in >> m_header;
+
+    if (!m_header.compressed() || m_header.pointFormat() < 6 ||
+            m_header.pointFormat() > 8)
+        throw pdal_error("'" + m_filename + "' is not a COPC file: "
+            "points must be compressed with LAS point format 6, 7 or 8.");
+
+    const LasVLR *vlr = m_header.findVlr(COPC_USER_ID, COPC_INFO_RECORD_ID);
+    if (!vlr || vlr->dataLen() < COPC_INFO_SIZE)
+        throw pdal_error("'" + m_filename + "' is not a COPC file: "
+            "missing COPC info VLR.");
+
+    double center[3];
+    double halfSize;
+    LeExtractor info(vlr->data(), vlr->dataLen());
+    info >> center[0] >> center[1] >> center[2] >> halfSize >> m_spacing >>
+        m_rootPageOffset >> m_rootPageSize;
+    m_cube = BOX3D(center[0] - halfSize, center[1] - halfSize,
+        center[2] - halfSize, center[0] + halfSize, center[1] + halfSize,
+        center[2] + halfSize);
+
+    vlr = m_header.findVlr(LASZIP_USER_ID, LASZIP_RECORD_ID);
+    if (!vlr)
+        throw pdal_error("LAZ file missing required laszip VLR.");
+
+    // Each node is decompressed as if it were a file with a single chunk.
+    // Build the header and VLR of that file.
+    LasVLR lazVlr(*vlr);
+    LasHeader nodeHeader;
+    nodeHeader.setVersionMinor(4);
+    nodeHeader.setPointFormat(m_header.pointFormat());
+    nodeHeader.setPointLen(m_header.pointLen());
+    nodeHeader.setCompressed(true);
+    nodeHeader.setVlrCount(1);
+
+    std::ostringstream oss;
+    OLeStream out(&oss);
+    out << nodeHeader;
+    nodeHeader.setVlrOffset((uint16_t)oss.tellp());
+    lazVlr.write(out, 0);
+    nodeHeader.setPointOffset((uint32_t)oss.tellp());
+    out.seek(0);
+    out << nodeHeader;
+    m_nodePrefix = oss.str();
+
+    readExtraBytesVlr();
+}
+
+
+void CopcReader::readExtraBytesVlr()
+{
+    const LasVLR *vlr = m_header.findVlr(SPEC_USER_ID,
+        EXTRA_BYTES_RECORD_ID);
+    if (!vlr)
+        return;
+    const char *pos = vlr->data();
+    size_t size = vlr->dataLen();
+    if (size % sizeof(ExtraBytesSpec) != 0)
+    {
+        log()->get(LogLevel::Warning) << "Bad size for extra bytes VLR.  "
+            "Ignoring.";
+        return;
+    }
+    size /= sizeof(ExtraBytesSpec);
+    while (size--)
+    {
+        ExtraBytesIf eb;
+        eb.readFrom(pos);
+        for (auto& ed : eb.toExtraDims())
+            m_extraDims.push_back(std::move(ed));
+        pos += sizeof(ExtraBytesSpec);
+    }
+}
+
+
+QuickInfo CopcReader::inspect()
+{
+    QuickInfo qi;
+
+    try
+    {
+        initialize();
+
+        qi.m_bounds = m_header.getBounds();
+        qi.m_srs = m_header.srs();
+        qi.m_pointCount = m_header.pointCount();
+
+        PointLayout layout;
+        addDimensions(&layout);
+        for (auto& id : layout.dims())
+            qi.m_dimNames.push_back(layout.dimName(id));
+
+        // If we've passed a spatial query, determine an upper bound on the
+        // point count.
+        if (!m_queryBounds.contains(m_cube) || m_args->m_polys.size() ||
+                m_depthEnd)
+        {
+            log()->get(LogLevel::Debug) <<
+                "Determining overlapping point count" << std::endl;
+
+            overlaps();
+
+            qi.m_pointCount = 0;
+            for (const auto& p : m_overlaps)
+                qi.m_pointCount += p.second.m_pointCount;
+        }
+    }
+    catch (std::exception& e)
+    {
+        throwError(e.what());
+    }
+
+    qi.m_valid = true;
+
+    return qi;
+}
+
+
+void CopcReader::addDimensions(PointLayoutPtr layout)
+{
+    using namespace Dimension;
+
+    layout->registerDim(Id::X, Type::Double);
+    layout->registerDim(Id::Y, Type::Double);
+    layout->registerDim(Id::Z, Type::Double);
+    layout->registerDim(Id::Intensity, Type::Unsigned16);
+    layout->registerDim(Id::ReturnNumber, Type::Unsigned8);
+    layout->registerDim(Id::NumberOfReturns, Type::Unsigned8);
+    layout->registerDim(Id::ScanDirectionFlag, Type::Unsigned8);
+    layout->registerDim(Id::EdgeOfFlightLine, Type::Unsigned8);
+    layout->registerDim(Id::Classification, Type::Unsigned8);
+    layout->registerDim(Id::ScanAngleRank, Type::Float);
+    layout->registerDim(Id::UserData, Type::Unsigned8);
+    layout->registerDim(Id::PointSourceId, Type::Unsigned16);
+    layout->registerDim(Id::GpsTime, Type::Double);
+    if (m_header.hasColor())
+    {
+        layout->registerDim(Id::Red, Type::Unsigned16);
+        layout->registerDim(Id::Green, Type::Unsigned16);
+        layout->registerDim(Id::Blue, Type::Unsigned16);
+    }
+    if (m_header.hasInfrared())
+        layout->registerDim(Id::Infrared);
+    layout->registerDim(Id::ScanChannel);
+    layout->registerDim(Id::ClassFlags);
+
+    for (auto& dim : m_extraDims)
+    {
+        Dimension::Type type = dim.m_dimType.m_type;
+        if (type == Dimension::Type::None)
+            continue;
+        if (dim.m_dimType.m_xform.nonstandard())
+            type = Dimension::Type::Double;
+        dim.m_dimType.m_id = layout->registerOrAssignDim(dim.m_name, type);
+    }
+}
+
+
+void CopcReader::ready(PointTableRef table)
+{
+    m_userLayout = table.layout();
+
+    // Determine all overlapping nodes we'll need to fetch.
+    try
+    {
+        overlaps();
+    }
+    catch (std::exception& e)
+    {
+        throwError(e.what());
+    }
+
+    point_count_t overlapPoints(0);
+    for (const auto& p : m_overlaps)
+        overlapPoints += p.second.m_pointCount;
+
+    log()->get(LogLevel::Debug) << "Overlap nodes: " << m_overlaps.size() <<
+        std::endl;
+    log()->get(LogLevel::Debug) << "Overlap points: " << overlapPoints <<
+        std::endl;
+
+    m_currentNodeBuffer.reset();
+    m_upcomingNodeBuffers.clear();
+    m_streamError.clear();
+    m_pointId = 0;
+}
+
+
+CopcReader::Page CopcReader::loadPage(uint64_t offset, uint64_t size) const
+{
+    std::vector<char> buf = fetch(offset, size);
+
+    Page page;
+    LeExtractor in(buf.data(), buf.size());
+    for (size_t i = 0; i < buf.size() / HIERARCHY_ENTRY_SIZE; ++i)
+    {
+        int32_t d, x, y, z;
+        Entry entry;
+
+        in >> d >> x >> y >> z >> entry.m_offset >> entry.m_byteSize >>
+            entry.m_pointCount;
+        Key key;
+        key.d = d;
+        key.x = x;
+        key.y = y;
+        key.z = z;
+        page[key] = entry;
+    }
+    return page;
+}
+
+
+void CopcReader::overlaps()
+{
+    // Traverse the hierarchy from the root page.  Child pages are fetched
+    // in our thread pool.
+    m_overlaps.clear();
+
+    Key key;
+    key.b = m_cube;
+    const Page root = loadPage(m_rootPageOffset, m_rootPageSize);
+    overlaps(root, key);
+    m_pool->await();
+    if (m_pool->errors().size())
+        throw pdal_error(m_pool->errors().front());
+
+    m_overlapIt = m_overlaps.begin();
+}
+
+
+void CopcReader::overlaps(const Page& page, const Key& key)
+{
+    // If this key doesn't overlap our query we can skip.
+    if (!key.b.overlaps(m_queryBounds))
+        return;
+
+    // Check the box of the key against our query polygon(s).  If it doesn't
+    // overlap, we can skip.
+    for (auto& p : m_args->m_polys)
+        if (p.disjoint(key.b))
+            return;
+
+    if (m_depthEnd && key.d >= m_depthEnd)
+        return;
+
+    auto it = page.find(key);
+    if (it == page.end())
+        return;
+
+    const Entry& entry = it->second;
+    if (entry.m_pointCount == -1)
+    {
+        // The entry locates a hierarchy page whose root is this key.
+        m_pool->add([this, key, entry]()
+        {
+            const Page subPage(loadPage(entry.m_offset, entry.m_byteSize));
+            overlaps(subPage, key);
+        });
+    }
+    else
+    {
+        if (entry.m_pointCount > 0)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_overlaps[key] = entry;
+        }
+
+        for (uint64_t dir(0); dir < 8; ++dir)
+            overlaps(page, key.bisect(dir));
+    }
+}
+
+
+bool CopcReader::passesFilter(double x, double y, double z) const
+{
+    if (!m_queryBounds.contains(x, y, z))
+        return false;
+
+    if (m_args->m_polys.empty())
+        return true;
+
+    for (Polygon& poly : m_args->m_polys)
+        if (poly.contains(x, y))
+            return true;
+    return false;
+}
+
+
+PointViewSet CopcReader::run(PointViewPtr view)
+{
+    uint64_t nodeId(1);
+
+    for (const auto& entry : m_overlaps)
+    {
+        log()->get(LogLevel::Debug) << "Data " << nodeId++ << "/" <<
+            m_overlaps.size() << ": " << entry.first.toString() << std::endl;
+
+        const Entry& e(entry.second);
+        m_pool->add([this, &view, &e]()
+        {
+            NodeBuffer nodeBuffer(*view->table().layout());
+            readNode(nodeBuffer.view, e);
+            copyPoints(*view, nodeBuffer.view);
+        });
+    }
+
+    m_pool->await();
+    if (m_pool->errors().size())
+        throwError(m_pool->errors().front());
+    log()->get(LogLevel::Debug) << "Done reading!" << std::endl;
+
+    PointViewSet views;
+    views.insert(view);
+    return views;
+}
+
+
+void CopcReader::copyPoints(PointView& dst, PointView& src) const
+{
+    const PointLayout& layout(*src.table().layout());
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (PointId idx = 0; idx < src.size(); ++idx)
+    {
+        // Copy through the views since quantized dimensions aren't stored
+        // as their nominal type.
+        const PointId dstId(dst.size());
+        char buf[sizeof(double)];
+        for (const auto& id : layout.dims())
+        {
+            const Dimension::Type type(layout.dimType(id));
+            src.getField(buf, id, type, idx);
+            dst.setField(id, type, dstId, buf);
+        }
+    }
+}
+
+
+#if defined(PDAL_HAVE_LASZIP) && defined(PDAL_HAVE_LAZPERF)
+
+void CopcReader::readNode(PointView& view, const Entry& entry) const
+{
+    std::vector<char> chunk = fetch(entry.m_offset, entry.m_byteSize);
+
+    // Wrap the chunk as a LAZ file with a single chunk so that LASzip
+    // can decompress it.
+    std::ostringstream oss;
+    oss << m_nodePrefix;
+    OLeStream out(&oss);
+    out << (int64_t)(m_nodePrefix.size() + sizeof(int64_t) + chunk.size());
+    out.put(chunk.data(), chunk.size());
+    writeLazChunkTable(oss, { (uint32_t)chunk.size() },
+        { (uint32_t)entry.m_pointCount });
+
+    // Patch the point count in the LAS 1.4 header.
+    std::string data = oss.str();
+    LeInserter count(&data[POINT_COUNT_POS], sizeof(uint64_t));
+    count << (uint64_t)entry.m_pointCount;
+
+    std::istringstream iss(data);
+    laszip_POINTER laszip;
+    laszip_point *p;
+    laszip_BOOL compressed;
+
+    auto handle = [&laszip](laszip_I32 result)
+    {
+        if (result)
+        {
+            char *buf;
+            laszip_get_error(laszip, &buf);
+            throw pdal_error(buf);
+        }
+    };
+
+    if (laszip_create(&laszip))
+        throw pdal_error("Unable to create LASzip decompressor.");
+    try
+    {
+        handle(laszip_open_reader_stream(laszip, iss, &compressed));
+        handle(laszip_get_point_pointer(laszip, &p));
+
+        const LasHeader& h = m_header;
+        PointRef point(view);
+        for (int32_t i = 0; i < entry.m_pointCount; ++i)
+        {
+            handle(laszip_read_point(laszip));
+            if (!passesFilter(p->X * h.scaleX() + h.offsetX(),
+                    p->Y * h.scaleY() + h.offsetY(),
+                    p->Z * h.scaleZ() + h.offsetZ()))
+                continue;
+            point.setPointId(view.size());
+            loadPoint(point, *p);
+        }
+        handle(laszip_close_reader(laszip));
+    }
+    catch (...)
+    {
+        laszip_destroy(laszip);
+        throw;
+    }
+    laszip_destroy(laszip);
+}
+
+
+void CopcReader::loadPoint(PointRef& point, laszip_point& p) const
+{
+    const LasHeader& h = m_header;
+
+    double x = p.X * h.scaleX() + h.offsetX();
+    double y = p.Y * h.scaleY() + h.offsetY();
+    double z = p.Z * h.scaleZ() + h.offsetZ();
+
+    point.setField(Dimension::Id::X, x);
+    point.setField(Dimension::Id::Y, y);
+    point.setField(Dimension::Id::Z, z);
+    point.setField(Dimension::Id::Intensity, p.intensity);
+    point.setField(Dimension::Id::ReturnNumber, p.extended_return_number);
+    point.setField(Dimension::Id::NumberOfReturns,
+        p.extended_number_of_returns);
+    point.setField(Dimension::Id::ClassFlags, p.extended_classification_flags);
+    point.setField(Dimension::Id::ScanChannel, p.extended_scanner_channel);
+    point.setField(Dimension::Id::ScanDirectionFlag, p.scan_direction_flag);
+    point.setField(Dimension::Id::EdgeOfFlightLine, p.edge_of_flight_line);
+    point.setField(Dimension::Id::Classification, p.extended_classification);
+    point.setField(Dimension::Id::ScanAngleRank, p.extended_scan_angle * .006);
+    point.setField(Dimension::Id::UserData, p.user_data);
+    point.setField(Dimension::Id::PointSourceId, p.point_source_ID);
+    point.setField(Dimension::Id::GpsTime, p.gps_time);
+
+    if (h.hasColor())
+    {
+        point.setField(Dimension::Id::Red, p.rgb[0]);
+        point.setField(Dimension::Id::Green, p.rgb[1]);
+        point.setField(Dimension::Id::Blue, p.rgb[2]);
+    }
+
+    if (h.hasInfrared())
+        point.setField(Dimension::Id::Infrared, p.rgb[3]);
+
+    if (m_extraDims.size())
+    {
+        LeExtractor istream((const char *)p.extra_bytes, p.num_extra_bytes);
+        for (auto& dim : m_extraDims)
+        {
+            // Dimension type of None is undefined and unprocessed
+            if (dim.m_dimType.m_type == Dimension::Type::None)
+            {
+                istream.skip(dim.m_size);
+                continue;
+            }
+
+            Everything e = Utils::extractDim(istream, dim.m_dimType.m_type);
+            if (dim.m_dimType.m_xform.nonstandard())
+            {
+                double d = Utils::toDouble(e, dim.m_dimType.m_type);
+                d = d * dim.m_dimType.m_xform.m_scale.m_val +
+                    dim.m_dimType.m_xform.m_offset.m_val;
+                point.setField(dim.m_dimType.m_id, d);
+            }
+            else
+                point.setField(dim.m_dimType.m_id, dim.m_dimType.m_type, &e);
+        }
+    }
+}
+
+#else
+
+void CopcReader::readNode(PointView&, const Entry&) const
+{}
+
+
+void CopcReader::loadPoint(PointRef&, laszip_point&) const
+{}
+
+#endif // PDAL_HAVE_LASZIP && PDAL_HAVE_LAZPERF
+
+
+void CopcReader::load()
+{
+    // Asynchronously trigger the fetching of a lookahead buffer of nodes.
+    while (m_upcomingNodeBuffers.size() < m_pool->numThreads() &&
+        m_overlapIt != m_overlaps.end())
+    {
+        const Entry entry(m_overlapIt->second);
+        ++m_overlapIt;
+
+        // Insert an empty placeholder node to keep track of the outstanding
+        // nodes that are currently being fetched.
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_upcomingNodeBuffers.emplace_front();
+        auto& loadingBuffer = m_upcomingNodeBuffers.front();
+        lock.unlock();
+
+        m_pool->add([this, &loadingBuffer, entry]()
+        {
+            std::unique_ptr<NodeBuffer> nodeBuffer(
+                new NodeBuffer(*m_userLayout));
+
+            std::string err;
+            try
+            {
+                readNode(nodeBuffer->view, entry);
+            }
+            catch (const std::exception& e)
+            {
+                err = e.what();
+            }
+
+            // Even a failed node must be marked as loaded so that the
+            // consumer isn't left waiting for it.
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (err.size() && m_streamError.empty())
+                m_streamError = err;
+            loadingBuffer = std::move(nodeBuffer);
+            lock.unlock();
+
+            // A node has been populated - notify our consumer thread.
+            m_cv.notify_one();
+        });
+    }
+}
+
+
+CopcReader::NodeBufferIt CopcReader::findBuffer()
+{
+    return std::find_if(
+        m_upcomingNodeBuffers.begin(),
+        m_upcomingNodeBuffers.end(),
+        [](const std::unique_ptr<NodeBuffer>& n)
+            { return static_cast<bool>(n); });
+}
+
+
+bool CopcReader::next()
+{
+    // Asynchronously trigger the loading of some nodes.
+    load();
+
+    // Now wait for a node to be populated, or for there to be no outstanding
+    // nodes left, in which case we're all done.
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cv.wait(lock, [this]()
+    {
+        return m_upcomingNodeBuffers.empty() ||
+            findBuffer() != m_upcomingNodeBuffers.end();
+    });
+
+    if (m_streamError.size())
+        throwError(m_streamError);
+
+    const auto it = findBuffer();
+    if (it == m_upcomingNodeBuffers.end())
+        return false;
+
+    m_pointId = 0;
+    m_currentNodeBuffer = std::move(*it);
+    m_upcomingNodeBuffers.erase(it);
+
+    return true;
+}
+
+
+bool CopcReader::processOne(PointRef& point)
+{
+    while (!m_currentNodeBuffer)
+    {
+        if (!next())
+            return false;
+
+        // A node that overlaps the query may contain no points that pass it.
+        if (m_currentNodeBuffer->view.empty())
+            m_currentNodeBuffer.reset();
+    }
+
+    auto& sourceView(m_currentNodeBuffer->view);
+    const auto& layout(*m_currentNodeBuffer->table.layout());
+
+    // Copy through the view rather than the raw point record, since
+    // quantized dimensions aren't stored as their nominal type.
+    char buf[sizeof(double)];
+    for (const auto& id : layout.dims())
+    {
+        const Dimension::Type type(layout.dimType(id));
+        sourceView.getField(buf, id, type, m_pointId);
+        point.setField(id, type, buf);
+    }
+
+    if (++m_pointId == sourceView.size())
+        m_currentNodeBuffer.reset();
+
+    return true;
+}
+
+
+void CopcReader::done(PointTableRef)
+{
+    m_currentNodeBuffer.reset();
+    m_upcomingNodeBuffers.clear();
+    m_overlaps.clear();
+}
+
+} // namespace pdal
@@ -0,0 +1,163 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <condition_variable>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <pdal/pdal_features.hpp>
+#include <pdal/Reader.hpp>
+#include <pdal/Streamable.hpp>
+#include <pdal/util/Bounds.hpp>
+
+#ifdef PDAL_HAVE_LASZIP
+#include <laszip/laszip_api.h>
+#else
+struct laszip_point;
+#endif
+
+#include "LasHeader.hpp"
+#include "LasUtils.hpp"
+
+namespace pdal
+{
+
+namespace arbiter
+{
+    class Arbiter;
+}
+
+class Key;
+class ThreadPool;
+
+// Reads a cloud-optimized point cloud (COPC) file.  Only the hierarchy pages
+// and the point chunks that overlap the query are fetched, using range
+// requests when the file is remote.
+class PDAL_DLL CopcReader : public Reader, public Streamable
+{
+public:
+    CopcReader();
+    virtual ~CopcReader();
+    std::string getName() const override;
+
+private:
+    // The location of a node's chunk, or of a hierarchy page when the
+    // point count is -1.
+    struct Entry
+    {
+        uint64_t m_offset;
+        int32_t m_byteSize;
+        int32_t m_pointCount;
+    };
+    typedef std::map<Key, Entry> Page;
+    typedef std::map<Key, Entry> Overlaps;
+
+    virtual void addArgs(ProgramArgs& args) override;
+    virtual void initialize() override;
+    virtual QuickInfo inspect() override;
+    virtual void addDimensions(PointLayoutPtr layout) override;
+    virtual void ready(PointTableRef table) override;
+    virtual PointViewSet run(PointViewPtr view) override;
+    virtual void done(PointTableRef table) override;
+
+    void initializeHttpForwards();
+    void readHeader();
+    void readExtraBytesVlr();
+
+    // Aggregate all nodes overlapping our query from a walk through the
+    // hierarchy, fetching hierarchy pages as they're needed.
+    void overlaps();
+    void overlaps(const Page& page, const Key& key);
+    Page loadPage(uint64_t offset, uint64_t size) const;
+    bool passesFilter(double x, double y, double z) const;
+
+    // Decompress the points of a node that pass the query into 'view'.
+    void readNode(PointView& view, const Entry& entry) const;
+    void loadPoint(PointRef& point, laszip_point& p) const;
+    void copyPoints(PointView& dst, PointView& src) const;
+
+    // Fetch 'size' bytes at 'offset' - a range request for remote files.
+    std::vector<char> fetch(uint64_t offset, uint64_t size) const;
+
+    // For streaming operation.
+    struct NodeBuffer;
+    using NodeBufferList = std::list<std::unique_ptr<NodeBuffer>>;
+    using NodeBufferIt = NodeBufferList::iterator;
+
+    virtual bool processOne(PointRef& point) override;
+    void load();    // Asynchronously fetch nodes for streaming use.
+    bool next();    // Acquire an already-fetched node for processing.
+    NodeBufferIt findBuffer();  // Find a fully acquired node.
+
+    std::unique_ptr<arbiter::Arbiter> m_arbiter;
+
+    struct Args;
+    std::unique_ptr<Args> m_args;
+
+    LasHeader m_header;
+    std::vector<ExtraDim> m_extraDims;
+    std::string m_nodePrefix;   // LAS header and laszip VLR for one node.
+    BOX3D m_cube;
+    double m_spacing;
+    uint64_t m_rootPageOffset;
+    uint64_t m_rootPageSize;
+
+    BOX3D m_queryBounds;
+    uint64_t m_depthEnd;    // Zero indicates selection of all depths.
+    std::unique_ptr<ThreadPool> m_pool;
+
+    using StringMap = std::map<std::string, std::string>;
+    StringMap m_headers;
+    StringMap m_query;
+
+    mutable std::mutex m_mutex;
+    mutable std::condition_variable m_cv;
+
+    Overlaps m_overlaps;
+
+    // The below are for streaming operation only.
+    PointLayout *m_userLayout;
+    NodeBufferList m_upcomingNodeBuffers;
+    std::unique_ptr<NodeBuffer> m_currentNodeBuffer;
+    Overlaps::const_iterator m_overlapIt;
+    PointId m_pointId;
+    std::string m_streamError;
+};
+
+} // namespace pdal
@@ -0,0 +1,612 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include "CopcWriter.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <future>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <thread>
+#include <unordered_set>
+
+#include <pdal/pdal_features.hpp>
+#include <pdal/PDALUtils.hpp>
+#include <pdal/PointView.hpp>
+#include <pdal/compression/LazPerfVlrCompression.hpp>
+#include <pdal/util/Extractor.hpp>
+#include <pdal/util/Inserter.hpp>
+#include <pdal/util/OStream.hpp>
+#include <pdal/util/ProgramArgs.hpp>
+#include <pdal/util/ThreadPool.hpp>
+
+#ifdef PDAL_HAVE_LASZIP
+#include <laszip/laszip_api.h>
+#endif
+
+#include "LasHeader.hpp"
+#include "LasSummaryData.hpp"
+#include "LasVLR.hpp"
+
+namespace pdal
+{
+
+static StaticPluginInfo const s_info
+{
+    "writers.copc",
+    "Cloud-optimized point cloud (COPC) writer.",
+    "http://pdal.io/stages/writers.copc.html",
+    {}
+};
+
+CREATE_STATIC_STAGE(CopcWriter, s_info)
+
+std::string CopcWriter::getName() const { return s_info.name; }
+
+namespace
+{
+
+const char COPC_USER_ID[] = "copc";
+const uint16_t COPC_INFO_RECORD_ID = 1;
+const uint16_t COPC_HIERARCHY_RECORD_ID = 1000;
+const size_t COPC_INFO_SIZE = 160;
+const size_t HIERARCHY_ENTRY_SIZE = 32;
+const size_t VLR_HEADER_SIZE = 54;
+const size_t EVLR_HEADER_SIZE = 60;
+
+// A node keeps at most one point from each cell of a grid of this many cells
+// on a side.  The rest of its points are passed to its children.
+const int GRID_SIZE = 128;
+
+// Nodes at this depth keep all their points.  Stops the subdivision of
+// clusters of coincident points.
+const uint64_t MAX_DEPTH = 24;
+
+} // unnamed namespace
+
+
+CopcWriter::CopcWriter() : m_pointFormat(6), m_pointLen(0),
+    m_gpsTimeMin(0), m_gpsTimeMax(0)
+{}
+
+
+CopcWriter::~CopcWriter()
+{}
+
+
+void CopcWriter::addArgs(ProgramArgs& args)
+{
+    XForm::XFormComponent autoOffset;
+    autoOffset.m_auto = true;
+
+    args.add("filename", "Output filename", m_filename).setPositional();
+    args.add("threads", "Number of threads used to build and compress the "
+        "octree", m_threads,
+        (int)(std::max)(1U, std::thread::hardware_concurrency()));
+    args.add("max_node_points", "Maximum number of points in an octree node "
+        "that isn't at the maximum depth", m_maxNodePoints,
+        (point_count_t)100000);
+    args.add("scale_x", "X scale factor", m_scaling.m_xXform.m_scale,
+        XForm::XFormComponent(.01));
+    args.add("scale_y", "Y scale factor", m_scaling.m_yXform.m_scale,
+        XForm::XFormComponent(.01));
+    args.add("scale_z", "Z scale factor", m_scaling.m_zXform.m_scale,
+        XForm::XFormComponent(.01));
+    args.add("offset_x", "X offset", m_scaling.m_xXform.m_offset, autoOffset);
+    args.add("offset_y", "Y offset", m_scaling.m_yXform.m_offset, autoOffset);
+    args.add("offset_z", "Z offset", m_scaling.m_zXform.m_offset, autoOffset);
+}
+
+
+void CopcWriter::initialize()
+{
+#if !defined(PDAL_HAVE_LASZIP) || !defined(PDAL_HAVE_LAZPERF)
+    throwError("Writing COPC requires PDAL to be built with both LASzip "
+        "and LAZperf support.");
+#endif
+    if (m_scaling.m_xXform.m_scale.m_auto ||
+        m_scaling.m_yXform.m_scale.m_auto ||
+        m_scaling.m_zXform.m_scale.m_auto)
+        throwError("Automatic scale factors aren't supported.");
+    if (m_maxNodePoints == 0)
+        throwError("Option 'max_node_points' must be greater than 0.");
+    m_threads = (std::max)(m_threads, 1);
+}
+
+
+void CopcWriter::prepared(PointTableRef table)
+{
+    PointLayoutPtr layout(table.layout());
+
+    // COPC requires point format 6, 7 or 8.
+    bool hasColor = layout->hasDim(Dimension::Id::Red) &&
+        layout->hasDim(Dimension::Id::Green) &&
+        layout->hasDim(Dimension::Id::Blue);
+    if (hasColor && layout->hasDim(Dimension::Id::Infrared))
+        m_pointFormat = 8;
+    else if (hasColor)
+        m_pointFormat = 7;
+    else
+        m_pointFormat = 6;
+
+    LasHeader header;
+    m_pointLen = header.basePointLen(m_pointFormat);
+}
+
+
+void CopcWriter::write(const PointViewPtr view)
+{
+    m_views.push_back(view);
+}
+
+
+// Select the points kept by a node and pass the rest to its children.
+// Children are built as separate tasks on the pool.
+void CopcWriter::buildNode(const PointView& view, const Key& key,
+    std::vector<PointId>& ids, ThreadPool& pool)
+{
+    using namespace Dimension;
+
+    std::vector<PointId> kept;
+    std::vector<PointId> children[8];
+
+    if (ids.size() <= m_maxNodePoints || key.d >= MAX_DEPTH)
+        kept.swap(ids);
+    else
+    {
+        const BOX3D& b = key.b;
+        const double sizeX = (b.maxx - b.minx) / GRID_SIZE;
+        const double sizeY = (b.maxy - b.miny) / GRID_SIZE;
+        const double sizeZ = (b.maxz - b.minz) / GRID_SIZE;
+        const double midX = b.minx + (b.maxx - b.minx) / 2;
+        const double midY = b.miny + (b.maxy - b.miny) / 2;
+        const double midZ = b.minz + (b.maxz - b.minz) / 2;
+
+        auto cell = [](double pos, double size) -> uint64_t
+        {
+            return (uint64_t)Utils::clamp((int)(pos / size), 0, GRID_SIZE - 1);
+        };
+
+        std::unordered_set<uint64_t> cells;
+        for (PointId id : ids)
+        {
+            double x = view.getFieldAs<double>(Id::X, id);
+            double y = view.getFieldAs<double>(Id::Y, id);
+            double z = view.getFieldAs<double>(Id::Z, id);
+
+            uint64_t c = (cell(x - b.minx, sizeX) * GRID_SIZE +
+                cell(y - b.miny, sizeY)) * GRID_SIZE + cell(z - b.minz, sizeZ);
+            if (kept.size() < m_maxNodePoints && cells.insert(c).second)
+                kept.push_back(id);
+            else
+            {
+                // Same octant numbering as Key::bisect().
+                int dir = (x >= midX ? 1 : 0) | (y >= midY ? 2 : 0) |
+                    (z >= midZ ? 4 : 0);
+                children[dir].push_back(id);
+            }
+        }
+        std::vector<PointId>().swap(ids);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_hierarchy[key].swap(kept);
+    }
+
+    for (int dir = 0; dir < 8; ++dir)
+    {
+        if (children[dir].empty())
+            continue;
+
+        Key child = key.bisect(dir);
+        std::shared_ptr<std::vector<PointId>> childIds(
+            new std::vector<PointId>);
+        childIds->swap(children[dir]);
+        pool.add([this, &view, child, childIds, &pool]()
+            { buildNode(view, child, *childIds, pool); });
+    }
+}
+
+
+void CopcWriter::summarize(const PointView& view, LasSummaryData& summary)
+{
+    using namespace Dimension;
+
+    m_gpsTimeMin = (std::numeric_limits<double>::max)();
+    m_gpsTimeMax = (std::numeric_limits<double>::lowest)();
+    for (PointId id = 0; id < view.size(); ++id)
+    {
+        int returnNumber = 1;
+        if (view.hasDim(Id::ReturnNumber))
+            returnNumber = view.getFieldAs<int>(Id::ReturnNumber, id);
+        summary.addPoint(view.getFieldAs<double>(Id::X, id),
+            view.getFieldAs<double>(Id::Y, id),
+            view.getFieldAs<double>(Id::Z, id), returnNumber);
+
+        double t = view.getFieldAs<double>(Id::GpsTime, id);
+        m_gpsTimeMin = (std::min)(m_gpsTimeMin, t);
+        m_gpsTimeMax = (std::max)(m_gpsTimeMax, t);
+    }
+    if (view.empty())
+        m_gpsTimeMin = m_gpsTimeMax = 0;
+}
+
+
+#ifdef PDAL_HAVE_LASZIP
+
+namespace
+{
+
+// Variable-sized chunks.
+const laszip_U32 VARIABLE_CHUNK_SIZE = (std::numeric_limits<uint32_t>::max)();
+
+struct Laszip
+{
+    Laszip() : m_laszip(nullptr)
+    {
+        if (laszip_create(&m_laszip))
+            throw pdal_error("Unable to create LASzip compressor.");
+    }
+
+    ~Laszip()
+        { laszip_destroy(m_laszip); }
+
+    void handle(laszip_I32 result)
+    {
+        if (result)
+        {
+            char *buf;
+            laszip_get_error(m_laszip, &buf);
+            throw pdal_error(buf);
+        }
+    }
+
+    laszip_POINTER m_laszip;
+};
+
+} // unnamed namespace
+
+
+std::vector<uint8_t> CopcWriter::lazVlrData() const
+{
+    Laszip z;
+    z.handle(laszip_set_chunk_size(z.m_laszip, VARIABLE_CHUNK_SIZE));
+    z.handle(laszip_set_point_type_and_size(z.m_laszip, m_pointFormat,
+        m_pointLen));
+
+    laszip_U8 *data;
+    laszip_U32 size;
+    z.handle(laszip_create_laszip_vlr(z.m_laszip, &data, &size));
+
+    // A VLR has 54 header bytes that we skip in order to get to the payload.
+    return std::vector<uint8_t>(data + VLR_HEADER_SIZE, data + size);
+}
+
+
+// Compress the points of a node into a single LAZ chunk.  LASzip writes
+// the offset of its chunk table, the chunk and the chunk table to the
+// stream.  Only the chunk is returned.
+std::string CopcWriter::compressNode(PointView& view,
+    const std::vector<PointId>& ids) const
+{
+    using namespace Dimension;
+
+    std::ostringstream ss;
+    {
+        Laszip z;
+        z.handle(laszip_set_chunk_size(z.m_laszip, VARIABLE_CHUNK_SIZE));
+        z.handle(laszip_set_point_type_and_size(z.m_laszip, m_pointFormat,
+            m_pointLen));
+        z.handle(laszip_open_writer_stream(z.m_laszip, ss, true, true));
+
+        auto converter = [this](double d, Id dim) -> int32_t
+        {
+            int32_t i(0);
+
+            if (!Utils::numericCast(d, i))
+                throwError("Unable to convert scaled value (" +
+                    Utils::toString(d) + ") to int32 for dimension '" +
+                    Dimension::name(dim) + "'.");
+            return i;
+        };
+
+        const bool hasClassFlags = view.hasDim(Id::ClassFlags);
+        laszip_point_struct p;
+        memset(&p, 0, sizeof(p));
+        for (PointId id : ids)
+        {
+            PointRef point(view, id);
+
+            p.X = converter(m_scaling.m_xXform.toScaled(
+                point.getFieldAs<double>(Id::X)), Id::X);
+            p.Y = converter(m_scaling.m_yXform.toScaled(
+                point.getFieldAs<double>(Id::Y)), Id::Y);
+            p.Z = converter(m_scaling.m_zXform.toScaled(
+                point.getFieldAs<double>(Id::Z)), Id::Z);
+
+            uint8_t returnNumber = 1;
+            uint8_t numberOfReturns = 1;
+            if (point.hasDim(Id::ReturnNumber))
+                returnNumber = point.getFieldAs<uint8_t>(Id::ReturnNumber);
+            if (point.hasDim(Id::NumberOfReturns))
+                numberOfReturns =
+                    point.getFieldAs<uint8_t>(Id::NumberOfReturns);
+
+            uint8_t classification =
+                point.getFieldAs<uint8_t>(Id::Classification);
+            uint8_t classFlags = hasClassFlags ?
+                point.getFieldAs<uint8_t>(Id::ClassFlags) :
+                classification >> 5;
+
+            p.intensity = point.getFieldAs<uint16_t>(Id::Intensity);
+            p.scan_direction_flag =
+                point.getFieldAs<uint8_t>(Id::ScanDirectionFlag);
+            p.edge_of_flight_line =
+                point.getFieldAs<uint8_t>(Id::EdgeOfFlightLine);
+            p.synthetic_flag = classFlags & 0x1;
+            p.keypoint_flag = (classFlags >> 1) & 0x1;
+            p.withheld_flag = (classFlags >> 2) & 0x1;
+            p.user_data = point.getFieldAs<uint8_t>(Id::UserData);
+            p.point_source_ID = point.getFieldAs<uint16_t>(Id::PointSourceId);
+            p.classification = (classification & 0x1F) | (classFlags << 5);
+            p.scan_angle_rank = point.getFieldAs<int8_t>(Id::ScanAngleRank);
+            p.number_of_returns = (std::min)((uint8_t)7, numberOfReturns);
+            p.return_number = (std::min)((uint8_t)7, returnNumber);
+            p.extended_scan_angle = static_cast<laszip_I16>(std::round(
+                point.getFieldAs<float>(Id::ScanAngleRank) / .006f));
+            p.extended_point_type = 1;
+            p.extended_scanner_channel =
+                point.getFieldAs<uint8_t>(Id::ScanChannel);
+            p.extended_classification_flags = classFlags;
+            p.extended_classification = classification;
+            p.extended_return_number = returnNumber;
+            p.extended_number_of_returns = numberOfReturns;
+            p.gps_time = point.getFieldAs<double>(Id::GpsTime);
+            if (m_pointFormat >= 7)
+            {
+                p.rgb[0] = point.getFieldAs<uint16_t>(Id::Red);
+                p.rgb[1] = point.getFieldAs<uint16_t>(Id::Green);
+                p.rgb[2] = point.getFieldAs<uint16_t>(Id::Blue);
+            }
+            if (m_pointFormat == 8)
+                p.rgb[3] = point.getFieldAs<uint16_t>(Id::Infrared);
+
+            z.handle(laszip_set_point(z.m_laszip, &p));
+            z.handle(laszip_write_point(z.m_laszip));
+        }
+        z.handle(laszip_close_writer(z.m_laszip));
+    }
+
+    std::string data = ss.str();
+    int64_t tableOffset;
+    LeExtractor in(data.data(), data.size());
+    in >> tableOffset;
+    if (tableOffset < (int64_t)sizeof(int64_t) ||
+            tableOffset > (int64_t)data.size())
+        throwError("Invalid LAZ chunk written by LASzip.");
+    return data.substr(sizeof(int64_t), (size_t)tableOffset - sizeof(int64_t));
+}
+
+#else
+
+std::vector<uint8_t> CopcWriter::lazVlrData() const
+{
+    return std::vector<uint8_t>();
+}
+
+
+std::string CopcWriter::compressNode(PointView&,
+    const std::vector<PointId>&) const
+{
+    return std::string();
+}
+
+#endif // PDAL_HAVE_LASZIP
+
+
+void CopcWriter::done(PointTableRef table)
+{
+#if defined(PDAL_HAVE_LASZIP) && defined(PDAL_HAVE_LAZPERF)
+    PointViewPtr view(new PointView(table));
+    for (const PointViewPtr& v : m_views)
+        view->append(*v);
+    m_views.clear();
+
+    SpatialReference srs(getSpatialReference());
+    if (srs.empty())
+        srs = view->spatialReference();
+
+    // The octree is a cube around the bounds of the data.
+    BOX3D bounds;
+    view->calculateBounds(bounds);
+    if (view->empty())
+        bounds.clear();
+    double center[3] = { bounds.minx + (bounds.maxx - bounds.minx) / 2,
+        bounds.miny + (bounds.maxy - bounds.miny) / 2,
+        bounds.minz + (bounds.maxz - bounds.minz) / 2 };
+    double halfSize = (std::max)({ bounds.maxx - bounds.minx,
+        bounds.maxy - bounds.miny, bounds.maxz - bounds.minz }) / 2;
+    if (halfSize <= 0)
+        halfSize = 1;
+
+    XForm *xforms[3] = { &m_scaling.m_xXform, &m_scaling.m_yXform,
+        &m_scaling.m_zXform };
+    for (int i = 0; i < 3; ++i)
+        if (xforms[i]->m_offset.m_auto)
+            xforms[i]->m_offset.m_val = std::round(center[i]);
+
+    Key root;
+    root.b = BOX3D(center[0] - halfSize, center[1] - halfSize,
+        center[2] - halfSize, center[0] + halfSize, center[1] + halfSize,
+        center[2] + halfSize);
+
+    // Build the octree.
+    m_hierarchy.clear();
+    {
+        std::vector<PointId> ids(view->size());
+        for (PointId id = 0; id < view->size(); ++id)
+            ids[id] = id;
+
+        ThreadPool pool(m_threads, -1, false);
+        pool.add([this, &view, &root, &ids, &pool]()
+            { buildNode(*view, root, ids, pool); });
+        pool.await();
+        pool.join();
+        if (pool.errors().size())
+            throwError(pool.errors().front());
+    }
+
+    LasSummaryData summary;
+    summarize(*view, summary);
+
+    LasHeader header;
+    header.setVersionMinor(4);
+    header.setPointFormat(m_pointFormat);
+    header.setPointLen(m_pointLen);
+    header.setCompressed(true);
+    header.setGlobalEncoding(1 << 4);  // WKT
+    try
+    {
+        header.setScaling(m_scaling);
+        header.setSummary(summary);
+    }
+    catch (const LasHeader::error& err)
+    {
+        throwError(err.what());
+    }
+
+    // The COPC info VLR must be first.  It's filled in at the end.
+    std::vector<LasVLR> vlrs;
+    std::vector<uint8_t> info(COPC_INFO_SIZE);
+    vlrs.emplace_back(COPC_USER_ID, COPC_INFO_RECORD_ID, "COPC info", info);
+    std::vector<uint8_t> lazData(lazVlrData());
+    vlrs.emplace_back(LASZIP_USER_ID, LASZIP_RECORD_ID, "http://laszip.org",
+        lazData);
+    std::string wkt = srs.getWKT1();
+    if (wkt.size())
+    {
+        // The spec requires a NULL at the end of the WKT.
+        std::vector<uint8_t> wktData(wkt.begin(), wkt.end());
+        wktData.push_back(0);
+        vlrs.emplace_back(TRANSFORM_USER_ID, WKT_RECORD_ID,
+            "OGC Transformation Record", wktData);
+    }
+    header.setVlrCount(vlrs.size());
+    header.setEVlrCount(1);
+
+    std::ostream *ostream = Utils::createFile(m_filename, true);
+    if (!ostream)
+        throwError("Couldn't open '" + m_filename + "' for output.");
+    OLeStream out(ostream);
+
+    out << header;
+    header.setVlrOffset((uint16_t)ostream->tellp());
+    for (LasVLR& vlr : vlrs)
+        vlr.write(out, 0);
+    header.setPointOffset((uint32_t)ostream->tellp());
+
+    // Placeholder for the chunk table offset.
+    out << (int64_t)0;
+
+    // Compress the nodes, at most 'threads' at a time, and write the chunks
+    // in hierarchy order.
+    std::vector<uint8_t> hierarchy(m_hierarchy.size() * HIERARCHY_ENTRY_SIZE);
+    LeInserter entries((char *)hierarchy.data(), hierarchy.size());
+    std::vector<uint32_t> chunkSizes;
+    std::vector<uint32_t> chunkCounts;
+    std::deque<std::future<std::string>> pending;
+    std::deque<Hierarchy::const_iterator> pendingNodes;
+
+    auto writeChunk = [&]()
+    {
+        std::string chunk = pending.front().get();
+        const Key& key = pendingNodes.front()->first;
+        uint32_t count = (uint32_t)pendingNodes.front()->second.size();
+        pending.pop_front();
+        pendingNodes.pop_front();
+
+        entries << (int32_t)key.d << (int32_t)key.x << (int32_t)key.y <<
+            (int32_t)key.z << (uint64_t)ostream->tellp() <<
+            (int32_t)chunk.size() << (int32_t)count;
+        out.put(chunk.data(), chunk.size());
+        chunkSizes.push_back((uint32_t)chunk.size());
+        chunkCounts.push_back(count);
+    };
+
+    for (auto it = m_hierarchy.cbegin(); it != m_hierarchy.cend(); ++it)
+    {
+        if ((int)pending.size() >= m_threads)
+            writeChunk();
+        pending.push_back(std::async(std::launch::async,
+            &CopcWriter::compressNode, this, std::ref(*view),
+            std::cref(it->second)));
+        pendingNodes.push_back(it);
+    }
+    while (pending.size())
+        writeChunk();
+
+    uint64_t chunkTableOffset = (uint64_t)ostream->tellp();
+    writeLazChunkTable(*ostream, chunkSizes, chunkCounts);
+
+    uint64_t evlrOffset = (uint64_t)ostream->tellp();
+    uint64_t hierarchySize = hierarchy.size();
+    ExtLasVLR hierarchyVlr(COPC_USER_ID, COPC_HIERARCHY_RECORD_ID,
+        "EPT hierarchy", hierarchy);
+    out << hierarchyVlr;
+    header.setEVlrOffset(evlrOffset);
+
+    out.seek(header.pointOffset());
+    out << chunkTableOffset;
+
+    // Fill in the COPC info VLR.
+    out.seek(header.vlrOffset() + VLR_HEADER_SIZE);
+    out << center[0] << center[1] << center[2] << halfSize <<
+        (2 * halfSize / GRID_SIZE) << (evlrOffset + EVLR_HEADER_SIZE) <<
+        hierarchySize << m_gpsTimeMin << m_gpsTimeMax;
+    for (int i = 0; i < 11; ++i)
+        out << (uint64_t)0;
+
+    out.seek(0);
+    out << header;
+
+    Utils::closeFile(ostream);
+    getMetadata().addList("filename", m_filename);
+    m_hierarchy.clear();
+#endif
+}
+
+} // namespace pdal
@@ -0,0 +1,94 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include <pdal/Scaling.hpp>
+#include <pdal/Writer.hpp>
+
+#include "private/EptSupport.hpp"
+
+namespace pdal
+{
+
+class LasSummaryData;
+class ThreadPool;
+
+// Writes a cloud-optimized point cloud (COPC) file: a LAS 1.4 file whose
+// points are stored as one LAZ chunk per octree node, along with a
+// hierarchy EVLR that locates each node's chunk in the file.
+class PDAL_DLL CopcWriter : public Writer
+{
+public:
+    CopcWriter();
+    ~CopcWriter();
+
+    std::string getName() const;
+
+private:
+    typedef std::map<Key, std::vector<PointId>> Hierarchy;
+
+    virtual void addArgs(ProgramArgs& args);
+    virtual void initialize();
+    virtual void prepared(PointTableRef table);
+    virtual void write(const PointViewPtr view);
+    virtual void done(PointTableRef table);
+
+    void buildNode(const PointView& view, const Key& key,
+        std::vector<PointId>& ids, ThreadPool& pool);
+    std::vector<uint8_t> lazVlrData() const;
+    std::string compressNode(PointView& view,
+        const std::vector<PointId>& ids) const;
+    void summarize(const PointView& view, LasSummaryData& summary);
+
+    std::string m_filename;
+    Scaling m_scaling;
+    int m_threads;
+    point_count_t m_maxNodePoints;
+    uint8_t m_pointFormat;
+    uint16_t m_pointLen;
+    std::vector<PointViewPtr> m_views;
+    Hierarchy m_hierarchy;
+    std::mutex m_mutex;
+    double m_gpsTimeMin;
+    double m_gpsTimeMax;
+
+    CopcWriter& operator=(const CopcWriter&); // not implemented
+    CopcWriter(const CopcWriter&); // not implemented
+};
+
+} // namespace pdal
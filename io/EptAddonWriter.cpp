@@ -34,11 +34,21 @@
 
 #include "EptAddonWriter.hpp"
 
+#include <algorithm>
 #include <cassert>
 
 #include <arbiter/arbiter.hpp>
 #include <nlohmann/json.hpp>
 
+#include <pdal/pdal_features.hpp>
+#ifdef PDAL_HAVE_LZ4
+#include <pdal/compression/Lz4Compression.hpp>
+#endif
+#ifdef PDAL_HAVE_ZSTD
+#include <pdal/compression/ZstdCompression.hpp>
+#endif
+#include <pdal/util/ThreadPool.hpp>
+
 #include "private/EptSupport.hpp"
 
 namespace pdal
@@ -61,6 +71,7 @@ struct EptAddonWriter::Args
 {
     NL::json m_addons;
     std::size_t m_numThreads;
+    std::string m_dataType;
 };
 
 EptAddonWriter::EptAddonWriter() : m_args(new Args)
@@ -76,6 +87,8 @@ void EptAddonWriter::addArgs(ProgramArgs& args)
     args.add("addons", "Mapping of output locations to their dimension names",
             m_args->m_addons).setPositional();
     args.add("threads", "Number of worker threads", m_args->m_numThreads);
+    args.add("data_type", "Encoding of addon data: 'binary', 'zstandard' "
+            "or 'lz4'", m_args->m_dataType, "binary");
 }
 
 void EptAddonWriter::addDimensions(PointLayoutPtr layout)
@@ -90,13 +103,34 @@ void EptAddonWriter::prepared(PointTableRef table)
 {
     m_arbiter.reset(new arbiter::Arbiter());
 
+    EptInfo::DataType dataType(EptInfo::DataType::Binary);
+    if (m_args->m_dataType == "zstandard")
+    {
+#ifndef PDAL_HAVE_ZSTD
+        throwError("Cannot write Zstandard addons.  "
+            "PDAL must be configured with WITH_ZSTD=On");
+#endif
+        dataType = EptInfo::DataType::Zstandard;
+    }
+    else if (m_args->m_dataType == "lz4")
+    {
+#ifndef PDAL_HAVE_LZ4
+        throwError("Cannot write LZ4 addons.  "
+            "PDAL must be configured with WITH_LZ4=On");
+#endif
+        dataType = EptInfo::DataType::Lz4;
+    }
+    else if (m_args->m_dataType != "binary")
+        throwError("Invalid data_type '" + m_args->m_dataType + "'.  Must be "
+            "'binary', 'zstandard' or 'lz4'.");
+
     const std::size_t threads(std::max<std::size_t>(m_args->m_numThreads, 4));
     if (threads > 100)
     {
         log()->get(LogLevel::Warning) << "Using a large thread count: " <<
             threads << " threads" << std::endl;
     }
-    m_pool.reset(new Pool(threads));
+    m_pool.reset(new ThreadPool(threads, 1));
 
     const PointLayout& layout(*table.layout());
     for (auto it : m_args->m_addons.items())
@@ -110,7 +144,7 @@ void EptAddonWriter::prepared(PointTableRef table)
         const Dimension::Id id(layout.findDim(dimName));
         if (id == Dimension::Id::Unknown)
             throwError("Cannot find dimension '" + dimName + "'.");
-        m_addons.emplace_back(new Addon(layout, endpoint, id));
+        m_addons.emplace_back(new Addon(layout, endpoint, id, dataType));
     }
 }
 
@@ -144,33 +178,106 @@ void EptAddonWriter::ready(PointTableRef table)
 
 void EptAddonWriter::write(const PointViewPtr view)
 {
-    for (const auto& addon : m_addons)
+    // Node IDs assigned by the EPT reader are indices into the hierarchy.
+    std::vector<Key> keys;
+    keys.reserve(m_hierarchy.size());
+    for (const auto& p : m_hierarchy)
+        keys.push_back(p.first);
+
+    // Create an addon buffer for each node we're going to write.
+    std::vector<std::vector<std::vector<char>>> buffers(m_addons.size());
+    for (std::size_t a(0); a < m_addons.size(); ++a)
     {
-        log()->get(LogLevel::Debug) << "Writing addon dimension " <<
-            addon->name() << " to " << addon->ep().prefixedRoot() << std::endl;
+        const uint64_t size(m_addons[a]->size());
+        buffers[a].reserve(m_hierarchy.size());
+        for (const auto& p : m_hierarchy)
+            buffers[a].emplace_back(p.second * size, 0);
+    }
 
-        writeOne(view, *addon);
+    // Fill in our buffers with the data from the view.  Each point has its
+    // own place in the buffers, so ranges of the view are filled in
+    // parallel.
+    const point_count_t chunk(
+        std::max<point_count_t>(view->size() / m_pool->numThreads() + 1,
+            65536));
+    for (PointId begin(0); begin < view->size(); begin += chunk)
+    {
+        const PointId end(std::min<PointId>(begin + chunk, view->size()));
+        m_pool->add([this, &view, &buffers, begin, end]()
+        {
+            fill(*view, begin, end, buffers);
+        });
+    }
+    m_pool->await();
 
-        log()->get(LogLevel::Debug) << "\tWritten" << std::endl;
+    std::vector<arbiter::Endpoint> dataEps;
+    std::vector<arbiter::Endpoint> hierEps;
+    for (const auto& addon : m_addons)
+    {
+        const arbiter::Endpoint& ep(addon->ep());
+        dataEps.push_back(ep.getSubEndpoint("ept-data"));
+        hierEps.push_back(ep.getSubEndpoint("ept-hierarchy"));
+
+        if (ep.isLocal())
+        {
+            arbiter::mkdirp(dataEps.back().root());
+            arbiter::mkdirp(hierEps.back().root());
+        }
     }
-}
 
-void EptAddonWriter::writeOne(const PointViewPtr view, const Addon& addon) const
-{
-    std::vector<std::vector<char>> buffers;
-    buffers.reserve(m_hierarchy.size());
+    // Write the dimension data of every node of every addon.
+    for (std::size_t a(0); a < m_addons.size(); ++a)
+    {
+        const Addon& addon(*m_addons[a]);
+        log()->get(LogLevel::Debug) << "Writing addon dimension " <<
+            addon.name() << " to " << addon.ep().prefixedRoot() << std::endl;
 
-    // Create an addon buffer for each node we're going to write.
-    for (const auto& p : m_hierarchy)
+        for (std::size_t nodeId(0); nodeId < keys.size(); ++nodeId)
+        {
+            std::vector<char>& buffer(buffers[a][nodeId]);
+            const arbiter::Endpoint& dataEp(dataEps[a]);
+            const Key& key(keys[nodeId]);
+            m_pool->add([this, &addon, &dataEp, &key, &buffer]()
+            {
+                writeOne(addon, dataEp, key, buffer);
+            });
+        }
+    }
+
+    // Write the hierarchy and top-level metadata of each addon.
+    for (std::size_t a(0); a < m_addons.size(); ++a)
     {
-        buffers.emplace_back(p.second * addon.size(), 0);
+        const Addon& addon(*m_addons[a]);
+
+        NL::json h;
+        Key key;
+        key.b = m_info->bounds();
+        writeHierarchy(h, key, hierEps[a]);
+        hierEps[a].put(key.toString() + ".json", h.dump());
+
+        NL::json meta;
+        meta["type"] = getTypeString(addon.type());
+        meta["size"] = addon.size();
+        meta["version"] = "1.0.0";
+        meta["dataType"] = m_args->m_dataType;
+
+        addon.ep().put("ept-addon.json", meta.dump());
     }
 
-    // Fill in our buffers with the data from the view.
-    PointRef pr(*view);
+    m_pool->await();
+    if (m_pool->errors().size())
+        throwError(m_pool->errors().front());
+
+    log()->get(LogLevel::Debug) << "\tWritten" << std::endl;
+}
+
+void EptAddonWriter::fill(PointView& view, PointId begin, PointId end,
+        std::vector<std::vector<std::vector<char>>>& buffers) const
+{
+    PointRef pr(view);
     uint64_t nodeId(0);
     uint64_t pointId(0);
-    for (uint64_t i(0); i < view->size(); ++i)
+    for (PointId i(begin); i < end; ++i)
     {
         pr.setPointId(i);
         nodeId = pr.getFieldAs<uint64_t>(m_nodeIdDim);
@@ -182,55 +289,54 @@ void EptAddonWriter::writeOne(const PointViewPtr view, const Addon& addon) const
         nodeId -= 1;
         pointId = pr.getFieldAs<uint64_t>(m_pointIdDim);
 
-        auto& buffer(buffers.at(nodeId));
-        assert(pointId * addon.size() + addon.size() <= buffer.size());
-        char* dst = buffer.data() + pointId * addon.size();
-        pr.getField(dst, addon.id(), addon.type());
+        for (std::size_t a(0); a < m_addons.size(); ++a)
+        {
+            const Addon& addon(*m_addons[a]);
+            auto& buffer(buffers[a].at(nodeId));
+            assert(pointId * addon.size() + addon.size() <= buffer.size());
+            char* dst = buffer.data() + pointId * addon.size();
+            pr.getField(dst, addon.id(), addon.type());
+        }
     }
+}
 
-    const arbiter::Endpoint& ep(addon.ep());
-    const arbiter::Endpoint dataEp(ep.getSubEndpoint("ept-data"));
-    const arbiter::Endpoint hierEp(ep.getSubEndpoint("ept-hierarchy"));
-
-    if (ep.isLocal())
+void EptAddonWriter::writeOne(const Addon& addon,
+        const arbiter::Endpoint& dataEp, const Key& key,
+        std::vector<char>& buffer) const
+{
+    std::string filename(key.toString() + ".bin");
+#ifdef PDAL_HAVE_ZSTD
+    if (addon.dataType() == EptInfo::DataType::Zstandard)
     {
-        arbiter::mkdirp(dataEp.root());
-        arbiter::mkdirp(hierEp.root());
+        std::vector<char> compressed;
+        ZstdCompressor comp([&compressed](char *pos, std::size_t size)
+        {
+            compressed.insert(compressed.end(), pos, pos + size);
+        });
+        comp.compress(buffer.data(), buffer.size());
+        comp.done();
+        buffer.swap(compressed);
+        filename = key.toString() + ".zst";
     }
-
-    // Write the binary dimension data for the addon.
-    nodeId = 0;
-    for (const auto& p : m_hierarchy)
+#endif
+#ifdef PDAL_HAVE_LZ4
+    if (addon.dataType() == EptInfo::DataType::Lz4)
     {
-        const Key key(p.first);
-
-        m_pool->add([&dataEp, &buffers, key, nodeId]()
+        std::vector<char> compressed;
+        Lz4Compressor comp([&compressed](char *pos, std::size_t size)
         {
-            dataEp.put(key.toString() + ".bin", buffers.at(nodeId));
+            compressed.insert(compressed.end(), pos, pos + size);
         });
-
-        ++nodeId;
+        comp.compress(buffer.data(), buffer.size());
+        comp.done();
+        buffer.swap(compressed);
+        filename = key.toString() + ".lz4";
     }
+#endif
+    dataEp.put(filename, buffer);
 
-    m_pool->await();
-
-    // Write the addon hierarchy data.
-    NL::json h;
-    Key key;
-    key.b = m_info->bounds();
-    writeHierarchy(h, key, hierEp);
-    hierEp.put(key.toString() + ".json", h.dump());
-
-    m_pool->await();
-
-    // Write the top-level addon metadata.
-    NL::json meta;
-    meta["type"] = getTypeString(addon.type());
-    meta["size"] = addon.size();
-    meta["version"] = "1.0.0";
-    meta["dataType"] = "binary";
-
-    ep.put("ept-addon.json", meta.dump());
+    // Release the memory of the node as soon as it's written.
+    std::vector<char>().swap(buffer);
 }
 
 void EptAddonWriter::writeHierarchy(NL::json& curr, const Key& key,
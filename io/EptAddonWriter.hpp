@@ -52,7 +52,7 @@ namespace arbiter
 class Addon;
 class EptInfo;
 class Key;
-class Pool;
+class ThreadPool;
 
 class PDAL_DLL EptAddonWriter : public Writer
 {
@@ -72,7 +72,10 @@ private:
     virtual void ready(PointTableRef table) override;
     virtual void write(const PointViewPtr view) override;
 
-    void writeOne(const PointViewPtr view, const Addon& addon) const;
+    void fill(PointView& view, PointId begin, PointId end,
+            std::vector<std::vector<std::vector<char>>>& buffers) const;
+    void writeOne(const Addon& addon, const arbiter::Endpoint& dataEp,
+            const Key& key, std::vector<char>& buffer) const;
     void writeHierarchy(NL::json& hier, const Key& key,
             const arbiter::Endpoint& hierEp) const;
     std::string getTypeString(Dimension::Type t) const;
@@ -81,7 +84,7 @@ private:
     Dimension::Id m_pointIdDim = Dimension::Id::Unknown;
 
     std::unique_ptr<arbiter::Arbiter> m_arbiter;
-    std::unique_ptr<Pool> m_pool;
+    std::unique_ptr<ThreadPool> m_pool;
     std::unique_ptr<EptInfo> m_info;
     std::vector<std::unique_ptr<Addon>> m_addons;
     std::map<Key, uint64_t> m_hierarchy;
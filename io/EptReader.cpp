@@ -35,8 +35,10 @@
 #include "EptReader.hpp"
 
 #include <limits>
+#include <thread>
 
 #include "private/EptSupport.hpp"
+#include "private/EptTuner.hpp"
 
 #include "LasReader.hpp"
 
@@ -45,8 +47,15 @@
 
 #include <pdal/GDALUtils.hpp>
 #include <pdal/SrsBounds.hpp>
+#include <pdal/private/FileCache.hpp>
+#include <pdal/compression/DeltaCompression.hpp>
+#ifdef PDAL_HAVE_LZ4
+#include <pdal/compression/Lz4Compression.hpp>
+#endif
 #include <pdal/compression/ZstdCompression.hpp>
 #include <pdal/util/Algorithm.hpp>
+#include <pdal/util/FileUtils.hpp>
+#include <pdal/util/ThreadPool.hpp>
 #include "../filters/CropFilter.hpp"
 
 namespace pdal
@@ -136,9 +145,17 @@ public:
     EptBounds m_bounds;
     std::string m_origin;
     std::size_t m_threads = 0;
+    std::size_t m_maxThreads = 0;
+    uint64_t m_bufferSize;
     double m_resolution = 0;
+    bool m_progressive = false;
+    point_count_t m_pointBudget = 0;
+    double m_timeBudget = 0;
     std::vector<Polygon> m_polys;
     NL::json m_addons;
+    std::string m_cacheDir;
+    uint64_t m_cacheSize;
+    bool m_quantize = false;
 
     NL::json m_query;
     NL::json m_headers;
@@ -158,7 +175,17 @@ void EptReader::addArgs(ProgramArgs& args)
     args.add("bounds", "Bounds to fetch", m_args->m_bounds);
     args.add("origin", "Origin of source file to fetch", m_args->m_origin);
     args.add("threads", "Number of worker threads", m_args->m_threads);
+    args.add("max_threads", "Maximum number of nodes to fetch concurrently",
+        m_args->m_maxThreads);
+    args.add("buffer_size", "Memory in megabytes for nodes read ahead in "
+        "streaming mode", m_args->m_bufferSize, (uint64_t)256);
     args.add("resolution", "Resolution limit", m_args->m_resolution);
+    args.add("progressive", "Read coarse-to-fine, producing a view for each "
+        "depth", m_args->m_progressive);
+    args.add("point_budget", "Stop before a depth that would exceed this "
+        "number of points", m_args->m_pointBudget);
+    args.add("time_budget", "Stop before a depth started after this many "
+        "seconds", m_args->m_timeBudget);
     args.add("addons", "Mapping of addon dimensions to their output directory",
         m_args->m_addons);
     args.add("polygon", "Bounding polygon(s) to crop requests",
@@ -170,29 +197,67 @@ void EptReader::addArgs(ProgramArgs& args)
         m_args->m_query);
     args.add("ogr", "OGR filter geometries",
         m_args->m_ogr);
+    args.add("cache_dir", "Directory in which to cache fetched hierarchy "
+        "and point data", m_args->m_cacheDir);
+    args.add("cache_size", "Maximum size of the cache in megabytes",
+        m_args->m_cacheSize, (uint64_t)1024);
+    args.add("quantize", "Store X, Y and Z as integers scaled by the "
+        "schema's scale and offset", m_args->m_quantize);
 }
 
 
 std::string EptReader::get(const std::string path) const
 {
+    std::vector<char> data;
+    if (m_cache && m_cache->get(cacheKey(path), data))
+        return std::string(data.data(), data.size());
+
+    std::string s;
     if (m_ep->isLocal())
-        return m_ep->get(path);
+        s = m_ep->get(path);
     else
-        return m_ep->get(path, m_headers, m_query);
+        s = m_ep->get(path, m_headers, m_query);
+
+    if (m_cache)
+        m_cache->put(cacheKey(path), std::vector<char>(s.begin(), s.end()));
+    return s;
 }
 
 
 std::vector<char> EptReader::getBinary(const std::string path) const
 {
+    std::vector<char> data;
+    if (m_cache && m_cache->get(cacheKey(path), data))
+        return data;
+
     if (m_ep->isLocal())
-        return m_ep->getBinary(path);
+        data = m_ep->getBinary(path);
     else
-        return m_ep->getBinary(path, m_headers, m_query);
+        data = m_ep->getBinary(path, m_headers, m_query);
+
+    if (m_cache)
+        m_cache->put(cacheKey(path), data);
+    return data;
 }
 
 
 arbiter::LocalHandle EptReader::getLocalHandle(const std::string path) const
 {
+    // A cached file can be read in place.  If it can't be cached, fall back
+    // to having arbiter download it.
+    if (m_cache)
+    {
+        const std::string key(cacheKey(path));
+        std::string file = m_cache->file(key);
+        if (file.empty())
+        {
+            m_cache->put(key, m_ep->getBinary(path, m_headers, m_query));
+            file = m_cache->file(key);
+        }
+        if (file.size())
+            return arbiter::LocalHandle(file, false);
+    }
+
     if (m_ep->isLocal())
         return m_ep->getLocalHandle(path);
     else
@@ -200,6 +265,59 @@ arbiter::LocalHandle EptReader::getLocalHandle(const std::string path) const
 }
 
 
+std::string EptReader::getInfo()
+{
+    if (!m_args->m_cacheDir.empty())
+    {
+        if (m_ep->isLocal())
+            log()->get(LogLevel::Debug) << "Not caching local EPT resources." <<
+                std::endl;
+        else
+            m_cache.reset(new FileCache(m_args->m_cacheDir,
+                m_args->m_cacheSize * 1024 * 1024, ".ept"));
+    }
+    if (!m_cache)
+        return get("ept.json");
+
+    // Cache entries are keyed by the version of the dataset, taken from
+    // the ETag of ept.json when the server provides it and from the content
+    // of ept.json otherwise.  ept.json is always fetched so that a dataset
+    // that has been rebuilt in place is never read from stale entries.
+    std::string data;
+    std::string version;
+    const std::string type(m_ep->type());
+    if (type == "http" || type == "https")
+    {
+        arbiter::http::Response res(m_ep->httpGet("ept.json", m_headers,
+            m_query));
+        if (!res.ok())
+            throw ept_error("Couldn't fetch '" +
+                m_ep->prefixedFullPath("ept.json") + "': HTTP status " +
+                std::to_string(res.code()) + ".");
+        data = res.str();
+        for (auto& h : res.headers())
+            if (Utils::iequals(h.first, "etag"))
+                version = h.second;
+    }
+    else
+    {
+        data = m_ep->get("ept.json", m_headers, m_query);
+    }
+    if (version.empty())
+        version = arbiter::crypto::encodeAsHex(arbiter::crypto::sha256(data));
+    m_cacheVersion = version;
+    log()->get(LogLevel::Debug) << "Caching in '" << m_args->m_cacheDir <<
+        "' with version " << m_cacheVersion << std::endl;
+    return data;
+}
+
+
+std::string EptReader::cacheKey(const std::string& path) const
+{
+    return m_ep->prefixedFullPath(path) + "\n" + m_cacheVersion;
+}
+
+
 void EptReader::initialize()
 {
     m_root = m_filename;
@@ -225,18 +343,26 @@ void EptReader::initialize()
     m_arbiter.reset(new arbiter::Arbiter());
     m_ep.reset(new arbiter::Endpoint(m_arbiter->getEndpoint(m_root)));
 
+    // The pool has enough threads for the largest number of concurrent
+    // fetches.  The tuner decides how many of them are used.
     const std::size_t threads((std::max)(m_args->m_threads, size_t(4)));
-    if (threads > 100)
+    const std::size_t maxThreads(m_args->m_maxThreads ?
+        (std::max)(m_args->m_maxThreads, threads) :
+        (std::max)(threads, size_t(64)));
+    if (maxThreads > 100)
     {
         log()->get(LogLevel::Warning) << "Using a large thread count: " <<
-            threads << " threads" << std::endl;
+            maxThreads << " threads" << std::endl;
     }
-    m_pool.reset(new Pool(threads));
+    m_pool.reset(new ThreadPool(maxThreads, 1));
+    m_tuner.reset(new EptTuner(threads, maxThreads,
+        m_args->m_bufferSize * 1024 * 1024,
+        std::thread::hardware_concurrency()));
 
     debug << "Endpoint: " << m_ep->prefixedRoot() << std::endl;
     try
     {
-        m_info.reset(new EptInfo(parse(get("ept.json"))));
+        m_info.reset(new EptInfo(parse(getInfo())));
     }
     catch (std::exception& e)
     {
@@ -313,7 +439,8 @@ void EptReader::initialize()
     }
 
     debug << "Query bounds: " << m_queryBounds << "\n";
-    debug << "Threads: " << m_pool->size() << std::endl;
+    debug << "Threads: " << threads << " - " << m_pool->numThreads() <<
+        std::endl;
 }
 
 
@@ -508,6 +635,11 @@ void EptReader::addDimensions(PointLayoutPtr layout)
             else if (dt.m_id == D::Z)
                 m_xyzTransforms[2] = dt.m_xform;
         }
+
+        if (m_args->m_quantize && dim.count("scale") &&
+            (dt.m_id == D::X || dt.m_id == D::Y || dt.m_id == D::Z))
+            layout->quantizeDim(dt.m_id, dt.m_xform.m_scale.m_val,
+                dt.m_xform.m_offset.m_val);
     }
 
     try
@@ -529,9 +661,31 @@ void EptReader::addDimensions(PointLayoutPtr layout)
                 const NL::json addonInfo(
                     NL::json::parse(ep.get(addonFilename)));
                 const Dimension::Type type(getRemoteType(addonInfo));
+                const std::string dataType(
+                    addonInfo.value("dataType", "binary"));
+                EptInfo::DataType dt(EptInfo::DataType::Binary);
+                if (dataType == "zstandard")
+                {
+#ifndef PDAL_HAVE_ZSTD
+                    throwError("Cannot read Zstandard addon '" + dimName +
+                        "'.  PDAL must be configured with WITH_ZSTD=On");
+#endif
+                    dt = EptInfo::DataType::Zstandard;
+                }
+                else if (dataType == "lz4")
+                {
+#ifndef PDAL_HAVE_LZ4
+                    throwError("Cannot read LZ4 addon '" + dimName +
+                        "'.  PDAL must be configured with WITH_LZ4=On");
+#endif
+                    dt = EptInfo::DataType::Lz4;
+                }
+                else if (dataType != "binary")
+                    throwError("Unrecognized dataType '" + dataType +
+                        "' for addon '" + dimName + "'.");
                 const Dimension::Id id(
                     layout->registerOrAssignDim(dimName, type));
-                m_addons.emplace_back(new Addon(*layout, ep, id));
+                m_addons.emplace_back(new Addon(*layout, ep, id, dt));
             }
             catch (NL::json::parse_error&)
             {
@@ -555,13 +709,27 @@ void EptReader::addDimensions(PointLayoutPtr layout)
 void EptReader::ready(PointTableRef table)
 {
     m_userLayout = table.layout();
+    m_pointSize = m_userLayout->pointSize();
 
     // These may not exist, in general they are only needed to track point
     // origins and ordering for an EPT writer.
     m_nodeIdDim = table.layout()->findDim("EptNodeId");
     m_pointIdDim = table.layout()->findDim("EptPointId");
 
+    // Only dimensions and addons used downstream are read.
+    m_readDimTypes.clear();
+    for (const DimType& dt : m_dimTypes)
+        if (dt.m_id != Dimension::Id::X && dt.m_id != Dimension::Id::Y &&
+            dt.m_id != Dimension::Id::Z && dimRequired(dt.m_id))
+            m_readDimTypes.push_back(dt);
+    m_readAddons.clear();
+    for (auto& addon : m_addons)
+        if (dimRequired(addon->id()))
+            m_readAddons.push_back(addon.get());
+
     m_overlaps.clear();
+    m_insideKeys.clear();
+    m_start = std::chrono::steady_clock::now();
 
     // Determine all overlapping data files we'll need to fetch.
     try
@@ -573,6 +741,37 @@ void EptReader::ready(PointTableRef table)
         throwError(e.what());
     }
 
+    // Drop the depths beyond the point budget.  The first depth is always
+    // read.  Node point counts include points outside of the query, so this
+    // may stop short of the budget.
+    if (m_args->m_pointBudget)
+    {
+        point_count_t total(0);
+        auto it = m_overlaps.begin();
+        while (it != m_overlaps.end())
+        {
+            const uint64_t depth(it->first.d);
+            point_count_t count(0);
+            auto end = it;
+            for (; end != m_overlaps.end() && end->first.d == depth; ++end)
+                count += end->second;
+
+            if (it != m_overlaps.begin() &&
+                total + count > m_args->m_pointBudget)
+            {
+                log()->get(LogLevel::Debug) << "Point budget reached " <<
+                    "before depth " << depth << std::endl;
+                m_overlaps.erase(it, m_overlaps.end());
+                break;
+            }
+            total += count;
+            it = end;
+        }
+        m_overlapIt = m_overlaps.begin();
+    }
+    if (m_overlaps.size())
+        m_loadDepth = m_overlaps.begin()->first.d;
+
     point_count_t overlapPoints(0);
 
     // Convert the key/overlap map to JSON for output as metadata.
@@ -587,6 +786,7 @@ void EptReader::ready(PointTableRef table)
         std::endl;
     log()->get(LogLevel::Debug) << "Overlap points: " << overlapPoints <<
         std::endl;
+    setProgressTotal(overlapPoints);
 
     if (overlapPoints > 1e8)
     {
@@ -613,7 +813,7 @@ void EptReader::overlaps()
         NL::json j;
         try
         {
-            j = NL::json::parse(get(file));
+            j = NL::json::parse(&ep == m_ep.get() ? get(file) : ep.get(file));
         }
         catch (NL::json::parse_error&)
         {
@@ -639,7 +839,7 @@ void EptReader::overlaps()
         m_pool->await();
     }
 
-    for (auto& addon : m_addons)
+    for (Addon *addon : m_readAddons)
     {
         // Next, determine the overlapping nodes from each addon dimension.
         const NL::json root = parseEndpoint(addon->ep(), file);
@@ -652,19 +852,35 @@ void EptReader::overlaps()
 
 void EptReader::overlaps(const arbiter::Endpoint& ep,
         std::map<Key, uint64_t>& target, const NL::json& hier,
-        const Key& key)
+        const Key& key, bool inside)
 {
     // If this key doesn't overlap our query
     // we can skip
     if (!key.b.overlaps(m_queryBounds))
         return;
 
-    // Check the box of the key against our
-    // query polygon(s). If it doesn't overlap,
-    // we can skip
-    for (auto& p: m_args->m_polys)
-        if (p.disjoint(key.b))
+    // Check the box of the key against our query polygon(s).  If it
+    // doesn't overlap any of them, we can skip it.  If it lies inside one,
+    // so do its descendants, and neither they nor their points need to be
+    // tested again.
+    if (!inside && m_args->m_polys.size())
+    {
+        const Polygon box(key.b.to2d());
+        bool overlap(false);
+        for (const Polygon& p : m_args->m_polys)
+        {
+            if (p.disjoint(box))
+                continue;
+            overlap = true;
+            if (p.contains(box))
+            {
+                inside = true;
+                break;
+            }
+        }
+        if (!overlap)
             return;
+    }
 
     if (m_depthEnd && key.d >= m_depthEnd) return;
 
@@ -681,11 +897,13 @@ void EptReader::overlaps(const arbiter::Endpoint& ep,
 
         // If the hierarchy points value here is -1, then we need to fetch the
         // hierarchy subtree corresponding to this root.
-        m_pool->add([this, &ep, &target, key]()
+        m_pool->add([this, &ep, &target, key, inside]()
         {
-            const auto subRoot(parse(ep.get(
-                            "ept-hierarchy/" + key.toString() + ".json")));
-            overlaps(ep, target, subRoot, key);
+            const std::string file(
+                "ept-hierarchy/" + key.toString() + ".json");
+            const auto subRoot(parse(&ep == m_ep.get() ?
+                get(file) : ep.get(file)));
+            overlaps(ep, target, subRoot, key, inside);
         });
     }
     else
@@ -694,10 +912,12 @@ void EptReader::overlaps(const arbiter::Endpoint& ep,
             //ABELL we could probably use a local mutex to lock the target map.
             std::lock_guard<std::mutex> lock(m_mutex);
             target[key] = static_cast<uint64_t>(numPoints);
+            if (inside && &target == &m_overlaps)
+                m_insideKeys.insert(key);
         }
 
         for (uint64_t dir(0); dir < 8; ++dir)
-            overlaps(ep, target, hier, key.bisect(dir));
+            overlaps(ep, target, hier, key.bisect(dir), inside);
     }
 }
 
@@ -708,37 +928,77 @@ PointViewSet EptReader::run(PointViewPtr view)
         throwError("Cannot read Zstandard dataType: "
             "PDAL must be configured with WITH_ZSTD=On");
 #endif
+#ifndef PDAL_HAVE_LZ4
+    if (m_info->dataType() == EptInfo::DataType::Lz4)
+        throwError("Cannot read LZ4 dataType: "
+            "PDAL must be configured with WITH_LZ4=On");
+#endif
 
     // Start these at 1 to differentiate from points added by other stages,
     // which will be ignored by the EPT writer.
     uint64_t nodeId(1);
 
+    PointViewSet views;
+    views.insert(view);
+    PointViewPtr current(view);
+    const bool depthOrdered(m_args->m_progressive || m_args->m_timeBudget);
+
     for (const auto& entry : m_overlaps)
     {
         const Key& key(entry.first);
 
-        log()->get(LogLevel::Debug) << "Data " << nodeId << "/" <<
+        // Finish each depth before starting the next when reading
+        // progressively or against a time budget.
+        if (depthOrdered && key.d != m_loadDepth)
+        {
+            m_pool->await();
+            if (outOfTime())
+            {
+                log()->get(LogLevel::Debug) << "Time budget reached " <<
+                    "before depth " << key.d << std::endl;
+                break;
+            }
+            m_loadDepth = key.d;
+            if (m_args->m_progressive)
+            {
+                current = view->makeNew();
+                views.insert(current);
+            }
+        }
+
+        PDAL_LOG(log(), LogLevel::Debug) << "Data " << nodeId << "/" <<
             m_overlaps.size() << ": " << key.toString() << std::endl;
 
-        m_pool->add([this, &view, &key, nodeId]()
+        m_tuner->acquire();
+        m_pool->add([this, current, &entry, nodeId]()
         {
+            PointView& view(*current);
+            const Key& key(entry.first);
+            EptNodeTimer timer(*m_tuner, entry.second * m_pointSize);
             PointId startId(0);
 
             if (m_info->dataType() == EptInfo::DataType::Laszip)
-                startId = readLaszip(*view, key, nodeId);
+                startId = readLaszip(view, key, nodeId, timer);
             else if (m_info->dataType() == EptInfo::DataType::Binary)
-                startId = readBinary(*view, key, nodeId);
+                startId = readBinary(view, key, nodeId, timer);
+            else if (m_info->dataType() == EptInfo::DataType::Delta)
+                startId = readDelta(view, key, nodeId, timer);
 #ifdef PDAL_HAVE_ZSTD
             else if (m_info->dataType() == EptInfo::DataType::Zstandard)
-                startId = readZstandard(*view, key, nodeId);
+                startId = readZstandard(view, key, nodeId, timer);
+#endif
+#ifdef PDAL_HAVE_LZ4
+            else if (m_info->dataType() == EptInfo::DataType::Lz4)
+                startId = readLz4(view, key, nodeId, timer);
 #endif
             else
                 throw ept_error("Unrecognized EPT dataType");
 
             // Read addon information after the native data, we'll possibly
             // overwrite attributes.
-            for (const auto& addon : m_addons)
-                readAddon(*view, key, *addon, startId);
+            for (const Addon *addon : m_readAddons)
+                readAddon(view, key, *addon, timer, startId);
+            addProgress(entry.second);
         });
 
         ++nodeId;
@@ -747,19 +1007,39 @@ PointViewSet EptReader::run(PointViewPtr view)
     m_pool->await();
     log()->get(LogLevel::Debug) << "Done reading!" << std::endl;
 
-    PointViewSet views;
-    views.insert(view);
     return views;
 }
 
 
+bool EptReader::outOfTime() const
+{
+    if (!m_args->m_timeBudget)
+        return false;
+
+    const std::chrono::duration<double> elapsed(
+        std::chrono::steady_clock::now() - m_start);
+    return elapsed.count() >= m_args->m_timeBudget;
+}
+
+
+void EptReader::done(PointTableRef)
+{
+    // Report how fetching was tuned, which is useful in choosing the
+    // threads, max_threads and buffer_size options.
+    m_tuner->dump(m_metadata.add("fetch"));
+}
+
+
 PointId EptReader::readLaszip(PointView& dst, const Key& key,
-        const uint64_t nodeId) const
+        const uint64_t nodeId, EptNodeTimer& timer) const
 {
     // If the file is remote (HTTP, S3, Dropbox, etc.), getLocalHandle will
     // download the file and `localPath` will return the location of the
     // downloaded file in a temporary directory.  Otherwise it's a no-op.
+    timer.fetchStart();
     auto handle(getLocalHandle("ept-data/" + key.toString() + ".laz"));
+    timer.fetchEnd();
+    addProgress(0, FileUtils::fileSize(handle.localPath()));
 
     PointTable table;
 
@@ -778,6 +1058,9 @@ PointId EptReader::readLaszip(PointView& dst, const Key& key,
 
     PointId pointId(0);
 
+    // Points of nodes inside the query polygons needn't be tested.
+    const bool polyTest(!m_insideKeys.count(key));
+
     lock.lock();
     const PointId startId(dst.size());
     for (auto& src : views)
@@ -786,7 +1069,7 @@ PointId EptReader::readLaszip(PointView& dst, const Key& key,
         for (uint64_t i(0); i < src->size(); ++i)
         {
             pr.setPointId(i);
-            process(dst, pr, nodeId, pointId);
+            process(dst, pr, nodeId, pointId, polyTest);
             ++pointId;
         }
     }
@@ -794,36 +1077,63 @@ PointId EptReader::readLaszip(PointView& dst, const Key& key,
     return startId;
 }
 
-PointId EptReader::processPackedData(PointView& dst, const uint64_t nodeId,
-    char* data, const uint64_t size) const
+PointId EptReader::processPackedData(PointView& dst, const Key& key,
+    const uint64_t nodeId, char* data, const uint64_t size) const
 {
     ShallowPointTable table(*m_remoteLayout, data, size);
     PointRef pr(table);
 
+    // Points of nodes inside the query polygons needn't be tested.
+    const bool polyTest(!m_insideKeys.count(key));
+
     std::lock_guard<std::mutex> lock(m_mutex);
 
     const PointId startId(dst.size());
     for (PointId pointId(0); pointId < table.numPoints(); ++pointId)
     {
         pr.setPointId(pointId);
-        process(dst, pr, nodeId, pointId);
+        process(dst, pr, nodeId, pointId, polyTest);
     }
 
     return startId;
 }
 
 PointId EptReader::readBinary(PointView& dst, const Key& key,
-        const uint64_t nodeId) const
+        const uint64_t nodeId, EptNodeTimer& timer) const
 {
+    timer.fetchStart();
     auto data(getBinary("ept-data/" + key.toString() + ".bin"));
-    return processPackedData(dst, nodeId, data.data(), data.size());
+    timer.fetchEnd();
+    addProgress(0, data.size());
+    return processPackedData(dst, key, nodeId, data.data(), data.size());
+}
+
+PointId EptReader::readDelta(PointView& dst, const Key& key,
+        const uint64_t nodeId, EptNodeTimer& timer) const
+{
+    timer.fetchStart();
+    auto compressed(getBinary("ept-data/" + key.toString() + ".dlt"));
+    timer.fetchEnd();
+    addProgress(0, compressed.size());
+    std::vector<char> data;
+    DeltaDecompressor dec([&data](char* pos, std::size_t size)
+    {
+        data.insert(data.end(), pos, pos + size);
+    }, m_dimTypes);
+
+    dec.decompress(compressed.data(), compressed.size());
+    dec.done();
+    return processPackedData(dst, key, nodeId, data.data(), data.size());
 }
 
 #ifdef PDAL_HAVE_ZSTD
 uint64_t EptReader::readZstandard(PointView& dst, const Key& key,
-        const uint64_t nodeId) const
+        const uint64_t nodeId, EptNodeTimer& timer) const
 {
-    auto compressed(m_ep->getBinary("ept-data/" + key.toString() + ".zst"));
+    timer.fetchStart();
+    auto compressed(getBinary("ept-data/" + key.toString() + ".zst"));
+    timer.fetchEnd();
+    addProgress(0, compressed.size());
     std::vector<char> data;
     pdal::ZstdDecompressor dec([&data](char* pos, std::size_t size)
     {
@@ -831,12 +1141,32 @@ uint64_t EptReader::readZstandard(PointView& dst, const Key& key,
     });
 
     dec.decompress(compressed.data(), compressed.size());
-    return processPackedData(dst, nodeId, data.data(), data.size());
+    return processPackedData(dst, key, nodeId, data.data(), data.size());
+}
+#endif
+
+#ifdef PDAL_HAVE_LZ4
+PointId EptReader::readLz4(PointView& dst, const Key& key,
+        const uint64_t nodeId, EptNodeTimer& timer) const
+{
+    timer.fetchStart();
+    auto compressed(getBinary("ept-data/" + key.toString() + ".lz4"));
+    timer.fetchEnd();
+    addProgress(0, compressed.size());
+    std::vector<char> data;
+    pdal::Lz4Decompressor dec([&data](char* pos, std::size_t size)
+    {
+        data.insert(data.end(), pos, pos + size);
+    });
+
+    dec.decompress(compressed.data(), compressed.size());
+    dec.done();
+    return processPackedData(dst, key, nodeId, data.data(), data.size());
 }
 #endif
 
 void EptReader::process(PointView& dst, PointRef& pr, const uint64_t nodeId,
-        const PointId pointId) const
+        const PointId pointId, bool polyTest) const
 {
     using D = Dimension::Id;
 
@@ -852,9 +1182,9 @@ void EptReader::process(PointView& dst, PointRef& pr, const uint64_t nodeId,
     const bool selected = m_queryOriginId == -1 ||
         pr.getFieldAs<int64_t>(D::OriginId) == m_queryOriginId;
 
-    auto passesPolyFilter = [this](double x, double y)
+    auto passesPolyFilter = [this, polyTest](double x, double y)
     {
-        if (m_args->m_polys.empty())
+        if (!polyTest || m_args->m_polys.empty())
             return true;
 
         for (Polygon& poly : m_args->m_polys)
@@ -869,15 +1199,12 @@ void EptReader::process(PointView& dst, PointRef& pr, const uint64_t nodeId,
         dst.setField(Dimension::Id::Y, dstId, y);
         dst.setField(Dimension::Id::Z, dstId, z);
 
-        for (const DimType& dt : m_dimTypes)
+        for (const DimType& dt : m_readDimTypes)
         {
-            if (dt.m_id != D::X && dt.m_id != D::Y && dt.m_id != D::Z)
-            {
-                const double d = pr.getFieldAs<double>(dt.m_id) *
-                    dt.m_xform.m_scale.m_val + dt.m_xform.m_offset.m_val;
+            const double d = pr.getFieldAs<double>(dt.m_id) *
+                dt.m_xform.m_scale.m_val + dt.m_xform.m_offset.m_val;
 
-                dst.setField(dt.m_id, dstId, d);
-            }
+            dst.setField(dt.m_id, dstId, d);
         }
 
         dst.setField(m_nodeIdDim, dstId, nodeId);
@@ -887,7 +1214,7 @@ void EptReader::process(PointView& dst, PointRef& pr, const uint64_t nodeId,
 
 
 void EptReader::readAddon(PointView& dst, const Key& key, const Addon& addon,
-    const PointId pointId) const
+    EptNodeTimer& timer, const PointId pointId) const
 {
     PointId np(addon.points(key));
     if (!np)
@@ -917,8 +1244,34 @@ void EptReader::readAddon(PointView& dst, const Key& key, const Addon& addon,
     if (np != m_overlaps.at(key))
         throwError("Invalid addon hierarchy");
 
-    const auto data(addon.ep().getBinary(
-                "ept-data/" + key.toString() + ".bin"));
+    timer.fetchStart();
+    auto data(addon.ep().getBinary(addon.dataFile(key)));
+    timer.fetchEnd();
+#ifdef PDAL_HAVE_ZSTD
+    if (addon.dataType() == EptInfo::DataType::Zstandard)
+    {
+        std::vector<char> decompressed;
+        pdal::ZstdDecompressor dec([&decompressed](char* pos, std::size_t size)
+        {
+            decompressed.insert(decompressed.end(), pos, pos + size);
+        });
+        dec.decompress(data.data(), data.size());
+        data.swap(decompressed);
+    }
+#endif
+#ifdef PDAL_HAVE_LZ4
+    if (addon.dataType() == EptInfo::DataType::Lz4)
+    {
+        std::vector<char> decompressed;
+        pdal::Lz4Decompressor dec([&decompressed](char* pos, std::size_t size)
+        {
+            decompressed.insert(decompressed.end(), pos, pos + size);
+        });
+        dec.decompress(data.data(), data.size());
+        dec.done();
+        data.swap(decompressed);
+    }
+#endif
     const size_t dimSize(Dimension::size(addon.type()));
 
     if (np * dimSize != data.size())
@@ -957,16 +1310,37 @@ void EptReader::load()
 {
     // Asynchronously trigger the fetching and point-view execution of
     // a lookahead buffer of nodes.
+    const bool depthOrdered(m_args->m_progressive || m_args->m_timeBudget);
     while (
-        m_upcomingNodeBuffers.size() < m_pool->size() &&
+        m_upcomingNodeBuffers.size() < m_tuner->readAhead() &&
         m_overlapIt != m_overlaps.end())
     {
+        // When reading progressively or against a time budget, a depth is
+        // started only once every node of the previous depth has been
+        // handed over, so points arrive coarse-to-fine.
+        if (depthOrdered && m_overlapIt->first.d != m_loadDepth)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_upcomingNodeBuffers.size())
+                break;
+            if (outOfTime())
+            {
+                log()->get(LogLevel::Debug) << "Time budget reached " <<
+                    "before depth " << m_overlapIt->first.d << std::endl;
+                m_overlapIt = m_overlaps.end();
+                break;
+            }
+            m_loadDepth = m_overlapIt->first.d;
+        }
+
         const auto nodeId(m_nodeId++);
         const auto key(m_overlapIt->first);
+        const auto points(m_overlapIt->second);
+        const auto bytes(points * m_pointSize);
         ++m_overlapIt;
 
-        log()->get(LogLevel::Debug) << nodeId << "/" << m_overlaps.size() <<
-            std::endl;
+        PDAL_LOG(log(), LogLevel::Debug) << nodeId << "/" <<
+            m_overlaps.size() << std::endl;
 
         // Insert an empty placeholder node to keep track of the outstanding
         // nodes that are currently being fetched/executed.
@@ -975,24 +1349,38 @@ void EptReader::load()
         auto& loadingBuffer = m_upcomingNodeBuffers.front();
         lock.unlock();
 
-        m_pool->add([this, &loadingBuffer, nodeId, key]()
+        m_tuner->acquire();
+        m_pool->add([this, &loadingBuffer, nodeId, key, points, bytes]()
         {
             std::unique_ptr<NodeBuffer> nodeBuffer(
                 new NodeBuffer(*m_userLayout));
+            std::unique_ptr<EptNodeTimer> timer(
+                new EptNodeTimer(*m_tuner, bytes));
 
             if (m_info->dataType() == EptInfo::DataType::Laszip)
-                readLaszip(nodeBuffer->view, key, nodeId);
+                readLaszip(nodeBuffer->view, key, nodeId, *timer);
 #ifdef PDAL_HAVE_ZSTD
             else if (m_info->dataType() == EptInfo::DataType::Zstandard)
-                readZstandard(nodeBuffer->view, key, nodeId);
+                readZstandard(nodeBuffer->view, key, nodeId, *timer);
+#endif
+#ifdef PDAL_HAVE_LZ4
+            else if (m_info->dataType() == EptInfo::DataType::Lz4)
+                readLz4(nodeBuffer->view, key, nodeId, *timer);
 #endif
             else if (m_info->dataType() == EptInfo::DataType::Binary)
-                readBinary(nodeBuffer->view, key, nodeId);
+                readBinary(nodeBuffer->view, key, nodeId, *timer);
+            else if (m_info->dataType() == EptInfo::DataType::Delta)
+                readDelta(nodeBuffer->view, key, nodeId, *timer);
             else
                 throw ept_error("Unrecognized EPT dataType");
 
-            for (const auto& addon : m_addons)
-                readAddon(nodeBuffer->view, key, *addon);
+            for (const Addon *addon : m_readAddons)
+                readAddon(nodeBuffer->view, key, *addon, *timer);
+            addProgress(points);
+
+            // Record the node before handing it over so that the consumer
+            // sees the updated read-ahead.
+            timer.reset();
 
             std::unique_lock<std::mutex> lock(m_mutex);
             loadingBuffer = std::move(nodeBuffer);
@@ -1056,12 +1444,14 @@ bool EptReader::processOne(PointRef& point)
     auto& sourceView(m_currentNodeBuffer->view);
     const auto& layout(*m_currentNodeBuffer->table.layout());
 
+    // Copy through the view rather than the raw point record, since
+    // quantized dimensions aren't stored as their nominal type.
+    char buf[sizeof(double)];
     for (const auto& id : layout.dims())
     {
-        point.setField(
-            id,
-            layout.dimType(id),
-            sourceView.getPoint(m_pointId) + layout.dimOffset(id));
+        const Dimension::Type type(layout.dimType(id));
+        sourceView.getField(buf, id, type, m_pointId);
+        point.setField(id, type, buf);
     }
 
     if (++m_pointId == sourceView.size()) m_currentNodeBuffer.reset();
@@ -35,11 +35,13 @@
 #pragma once
 
 #include <array>
+#include <chrono>
 #include <condition_variable>
 #include <list>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -60,10 +62,13 @@ namespace arbiter
 }
 
 class Addon;
+class FileCache;
 class EptInfo;
+class EptNodeTimer;
+class EptTuner;
 class FixedPointLayout;
 class Key;
-class Pool;
+class ThreadPool;
 class VectorPointTable;
 
 class PDAL_DLL EptReader : public Reader, public Streamable
@@ -83,6 +88,7 @@ private:
     virtual void addDimensions(PointLayoutPtr layout) override;
     virtual void ready(PointTableRef table) override;
     virtual PointViewSet run(PointViewPtr view) override;
+    virtual void done(PointTableRef table) override;
 
     // Users may supply header and query parameters to be forwarded with remote
     // requests, deconstruct their JSON into our member maps.
@@ -97,20 +103,31 @@ private:
     // points from a walk through the hierarchy.  Each of these keys will be
     // downloaded during the 'read' section.
     void overlaps();
+    // If 'inside' is set, the key is known to lie inside a query polygon.
     void overlaps(const arbiter::Endpoint& ep, std::map<Key, uint64_t>& target,
-            const NL::json& current, const Key& key);
-
-    PointId readLaszip(PointView& view, const Key& key, uint64_t nodeId) const;
-    PointId readBinary(PointView& view, const Key& key, uint64_t nodeId) const;
-    PointId readZstandard(PointView& view, const Key& key, uint64_t nodeId)
-        const;
-    PointId processPackedData(PointView& view, uint64_t nodeId, char* data,
-        uint64_t size) const;
+            const NL::json& current, const Key& key, bool inside = false);
+
+    // Fetching is timed through 'timer' so that the tuner can separate
+    // fetch time from decode time.
+    PointId readLaszip(PointView& view, const Key& key, uint64_t nodeId,
+        EptNodeTimer& timer) const;
+    PointId readBinary(PointView& view, const Key& key, uint64_t nodeId,
+        EptNodeTimer& timer) const;
+    PointId readDelta(PointView& view, const Key& key, uint64_t nodeId,
+        EptNodeTimer& timer) const;
+    PointId readLz4(PointView& view, const Key& key, uint64_t nodeId,
+        EptNodeTimer& timer) const;
+    PointId readZstandard(PointView& view, const Key& key, uint64_t nodeId,
+        EptNodeTimer& timer) const;
+    PointId processPackedData(PointView& view, const Key& key,
+        uint64_t nodeId, char* data, uint64_t size) const;
+    // Points are tested against the query polygons only if 'polyTest' is
+    // set.
     void process(PointView& view, PointRef& pr, uint64_t nodeId,
-        PointId pointId) const;
+        PointId pointId, bool polyTest) const;
 
     void readAddon(PointView& dst, const Key& key, const Addon& addon,
-        PointId startId = 0) const;
+        EptNodeTimer& timer, PointId startId = 0) const;
 
     // To allow testing of hidden getRemoteType() and getCoercedType().
     static Dimension::Type getRemoteTypeTest(const NL::json& dimInfo);
@@ -126,16 +143,26 @@ private:
     bool next();    // Acquire an already-fetched node for processing.
     NodeBufferIt findBuffer();  // Find a fully acquired node.
 
-    // Data fetching - these forward user-specified query/header params.
+    // Data fetching - these forward user-specified query/header params and
+    // go through the local cache when one is in use.
     std::string get(std::string path) const;
     std::vector<char> getBinary(std::string path) const;
     arbiter::LocalHandle getLocalHandle(std::string path) const;
 
+    // Fetch ept.json, setting the version used to key cache entries.
+    std::string getInfo();
+    std::string cacheKey(const std::string& path) const;
+
+    // Whether the time budget has been used up.
+    bool outOfTime() const;
+
     std::string m_root;
 
     std::unique_ptr<arbiter::Arbiter> m_arbiter;
     std::unique_ptr<arbiter::Endpoint> m_ep;
     std::unique_ptr<EptInfo> m_info;
+    std::unique_ptr<FileCache> m_cache;
+    std::string m_cacheVersion;
 
     struct Args;
 
@@ -143,8 +170,11 @@ private:
 
     BOX3D m_queryBounds;
     int64_t m_queryOriginId = -1;
-    std::unique_ptr<Pool> m_pool;
+    std::unique_ptr<ThreadPool> m_pool;
+    std::unique_ptr<EptTuner> m_tuner;
+    point_count_t m_pointSize = 0;
     std::vector<std::unique_ptr<Addon>> m_addons;
+    std::vector<Addon *> m_readAddons;
 
     using StringMap = std::map<std::string, std::string>;
     StringMap m_headers;
@@ -155,11 +185,18 @@ private:
 
     using Overlaps = std::map<Key, uint64_t>;
     Overlaps m_overlaps;
+    std::set<Key> m_insideKeys; // Overlaps inside a query polygon.
     uint64_t m_depthEnd = 0;    // Zero indicates selection of all depths.
     uint64_t m_hierarchyStep = 0;
 
+    // Reading starts at m_start.  m_loadDepth is the depth currently being
+    // read when reading coarse-to-fine.
+    std::chrono::steady_clock::time_point m_start;
+    uint64_t m_loadDepth = 0;
+
     std::unique_ptr<FixedPointLayout> m_remoteLayout;
     DimTypeList m_dimTypes;
+    DimTypeList m_readDimTypes;
     std::array<XForm, 3> m_xyzTransforms;
 
     Dimension::Id m_nodeIdDim = Dimension::Id::Unknown;
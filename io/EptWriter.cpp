@@ -0,0 +1,988 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include "EptWriter.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <unordered_set>
+
+#include <arbiter/arbiter.hpp>
+#include <nlohmann/json.hpp>
+
+#include <pdal/pdal_features.hpp>
+#include <pdal/PointView.hpp>
+#include <pdal/Scaling.hpp>
+#include <pdal/util/FileUtils.hpp>
+#include <pdal/util/ProgramArgs.hpp>
+#include <pdal/util/ThreadPool.hpp>
+#include <pdal/compression/DeltaCompression.hpp>
+
+#ifdef PDAL_HAVE_LZ4
+#include <pdal/compression/Lz4Compression.hpp>
+#endif
+#ifdef PDAL_HAVE_ZSTD
+#include <pdal/compression/ZstdCompression.hpp>
+#endif
+
+#include "BufferReader.hpp"
+#include "LasWriter.hpp"
+
+namespace pdal
+{
+
+static StaticPluginInfo const s_info
+{
+    "writers.ept",
+    "Entwine Point Tile (EPT) writer.",
+    "http://pdal.io/stages/writers.ept.html",
+    {}
+};
+
+CREATE_STATIC_STAGE(EptWriter, s_info)
+
+std::string EptWriter::getName() const { return s_info.name; }
+
+namespace
+{
+
+// Nodes at this depth keep all their points.  Stops the subdivision of
+// clusters of coincident points.
+const uint64_t MAX_DEPTH = 24;
+
+// Number of records read at a time when partitioning a file.
+const point_count_t PARTITION_BLOCK = 65536;
+
+// X, Y and Z are held as doubles at the start of each record until nodes
+// are written.
+const size_t XYZ_SIZE = 3 * sizeof(double);
+
+std::string typeString(Dimension::Type t)
+{
+    switch (Dimension::base(t))
+    {
+    case Dimension::BaseType::Signed:
+        return "signed";
+    case Dimension::BaseType::Unsigned:
+        return "unsigned";
+    case Dimension::BaseType::Floating:
+        return "float";
+    default:
+        return std::string();
+    }
+}
+
+} // unnamed namespace
+
+
+struct EptWriter::Args
+{
+    std::string m_filename;
+    std::string m_dataType;
+    int m_threads;
+    uint64_t m_memory;
+    point_count_t m_maxNodePoints;
+    uint64_t m_span;
+    uint64_t m_hierarchyStep;
+    std::string m_tempDir;
+    Scaling m_scaling;
+};
+
+
+struct EptWriter::Branch
+{
+    Key m_key;
+    std::string m_keptFile;
+    std::unique_ptr<Branch> m_children[8];
+};
+
+
+EptWriter::EptWriter() : m_args(new Args), m_restSize(0), m_recordSize(0),
+    m_memory(0), m_count(0), m_tempCount(0)
+{}
+
+
+EptWriter::~EptWriter()
+{}
+
+
+void EptWriter::addArgs(ProgramArgs& args)
+{
+    XForm::XFormComponent autoOffset;
+    autoOffset.m_auto = true;
+
+    args.add("filename", "Output directory", m_args->m_filename).
+        setPositional();
+    args.add("data_type", "Encoding of node data: 'laszip', 'binary', "
+        "'zstandard', 'lz4' or 'delta'", m_args->m_dataType, "laszip");
+    args.add("threads", "Number of threads used to build and write the "
+        "octree", m_args->m_threads,
+        (int)(std::max)(1U, std::thread::hardware_concurrency()));
+    args.add("memory", "Memory in megabytes used to hold points while "
+        "building the octree", m_args->m_memory, (uint64_t)1024);
+    args.add("max_node_points", "Maximum number of points in an octree node "
+        "that isn't at the maximum depth", m_args->m_maxNodePoints,
+        (point_count_t)100000);
+    args.add("span", "Number of grid cells along each side of a node",
+        m_args->m_span, (uint64_t)128);
+    args.add("hierarchy_step", "Depth interval at which the hierarchy is "
+        "split into separate files.  0 writes a single file",
+        m_args->m_hierarchyStep);
+    args.add("temp_dir", "Directory for temporary files",
+        m_args->m_tempDir);
+    args.add("scale_x", "X scale factor", m_args->m_scaling.m_xXform.m_scale,
+        XForm::XFormComponent(.01));
+    args.add("scale_y", "Y scale factor", m_args->m_scaling.m_yXform.m_scale,
+        XForm::XFormComponent(.01));
+    args.add("scale_z", "Z scale factor", m_args->m_scaling.m_zXform.m_scale,
+        XForm::XFormComponent(.01));
+    args.add("offset_x", "X offset", m_args->m_scaling.m_xXform.m_offset,
+        autoOffset);
+    args.add("offset_y", "Y offset", m_args->m_scaling.m_yXform.m_offset,
+        autoOffset);
+    args.add("offset_z", "Z offset", m_args->m_scaling.m_zXform.m_offset,
+        autoOffset);
+}
+
+
+void EptWriter::initialize()
+{
+    std::string& type = m_args->m_dataType;
+    type = Utils::tolower(type);
+    if (type != "laszip" && type != "binary" && type != "zstandard" &&
+            type != "lz4" && type != "delta")
+        throwError("Invalid data_type '" + type + "'.  Must be 'laszip', "
+            "'binary', 'zstandard', 'lz4' or 'delta'.");
+#if !defined(PDAL_HAVE_LASZIP) && !defined(PDAL_HAVE_LAZPERF)
+    if (type == "laszip")
+        throwError("Writing 'laszip' data requires PDAL to be built with "
+            "LASzip or LAZperf support.");
+#endif
+#ifndef PDAL_HAVE_ZSTD
+    if (type == "zstandard")
+        throwError("Writing 'zstandard' data requires PDAL to be built with "
+            "Zstandard support.");
+#endif
+#ifndef PDAL_HAVE_LZ4
+    if (type == "lz4")
+        throwError("Writing 'lz4' data requires PDAL to be built with "
+            "LZ4 support.");
+#endif
+
+    const Scaling& s = m_args->m_scaling;
+    if (s.m_xXform.m_scale.m_auto || s.m_yXform.m_scale.m_auto ||
+        s.m_zXform.m_scale.m_auto)
+        throwError("Automatic scale factors aren't supported.");
+    if (m_args->m_maxNodePoints == 0)
+        throwError("Option 'max_node_points' must be greater than 0.");
+    if (m_args->m_span < 2)
+        throwError("Option 'span' must be at least 2.");
+    if (m_args->m_memory == 0)
+        throwError("Option 'memory' must be greater than 0.");
+    m_args->m_threads = (std::max)(m_args->m_threads, 1);
+    m_memory = m_args->m_memory * 1024 * 1024;
+
+    std::string root = m_args->m_filename;
+    if (Utils::startsWith(root, "ept://"))
+        root = root.substr(6);
+    if (Utils::endsWith(root, "ept.json"))
+        root = root.substr(0, root.size() - 8);
+    if (root.empty())
+        throwError("Missing output filename.");
+
+    m_arbiter.reset(new arbiter::Arbiter());
+    m_ep.reset(new arbiter::Endpoint(
+        m_arbiter->getEndpoint(arbiter::expandTilde(root))));
+
+    if (m_args->m_tempDir.empty())
+        m_args->m_tempDir = arbiter::getTempPath();
+
+    // Temporary files are named uniquely so that several writers may share
+    // a directory.
+    std::random_device rd;
+    std::ostringstream oss;
+    oss << m_args->m_tempDir << "/ept-" << std::hex << rd() << rd() << "-";
+    m_tempPrefix = oss.str();
+}
+
+
+void EptWriter::prepared(PointTableRef table)
+{
+    using namespace Dimension;
+
+    PointLayoutPtr layout(table.layout());
+    m_dims.clear();
+    m_restSize = 0;
+    for (Id id : layout->dims())
+    {
+        if (id == Id::X || id == Id::Y || id == Id::Z)
+            continue;
+
+        // These are added by readers.ept to track the origin of each point.
+        const std::string name = layout->dimName(id);
+        if (name == "EptNodeId" || name == "EptPointId")
+            continue;
+
+        DimType dt(id, layout->dimType(id));
+        m_dims.push_back(dt);
+        m_restSize += Dimension::size(dt.m_type);
+    }
+    m_recordSize = XYZ_SIZE + m_restSize;
+}
+
+
+void EptWriter::ready(PointTableRef table)
+{
+    m_buffer.clear();
+    m_input = Part();
+    m_count = 0;
+    m_bounds.clear();
+    m_hierarchy.clear();
+    m_srs = getSpatialReference();
+    if (m_srs.empty())
+        m_srs = table.anySpatialReference();
+
+    m_dimNames.clear();
+    for (const DimType& dt : m_dims)
+        m_dimNames.push_back(table.layout()->dimName(dt.m_id));
+}
+
+
+void EptWriter::spatialReferenceChanged(const SpatialReference& srs)
+{
+    if (getSpatialReference().empty())
+        m_srs = srs;
+}
+
+
+void EptWriter::write(const PointViewPtr view)
+{
+    if (getSpatialReference().empty() && m_srs.empty())
+        m_srs = view->spatialReference();
+
+    PointRef point(*view);
+    for (PointId idx = 0; idx < view->size(); ++idx)
+    {
+        point.setPointId(idx);
+        addPoint(point);
+    }
+}
+
+
+bool EptWriter::processOne(PointRef& point)
+{
+    addPoint(point);
+    return true;
+}
+
+
+// Pack a point into the input buffer, spilling it to the input file when
+// it holds half the memory allowance.
+void EptWriter::addPoint(PointRef& point)
+{
+    using namespace Dimension;
+
+    const double xyz[3] = { point.getFieldAs<double>(Id::X),
+        point.getFieldAs<double>(Id::Y), point.getFieldAs<double>(Id::Z) };
+    m_bounds.grow(xyz[0], xyz[1], xyz[2]);
+
+    size_t pos = m_buffer.size();
+    m_buffer.resize(pos + m_recordSize);
+    char *p = m_buffer.data() + pos;
+    memcpy(p, xyz, XYZ_SIZE);
+    p += XYZ_SIZE;
+    for (const DimType& dt : m_dims)
+    {
+        point.getField(p, dt.m_id, dt.m_type);
+        p += Dimension::size(dt.m_type);
+    }
+    m_count++;
+
+    if (m_buffer.size() >= m_memory / 2)
+        flush();
+}
+
+
+void EptWriter::flush()
+{
+    if (m_buffer.empty())
+        return;
+
+    if (m_input.m_file.empty())
+        m_input.m_file = tempFile("input");
+
+    std::ofstream out(m_input.m_file,
+        std::ios::out | std::ios::binary | std::ios::app);
+    out.write(m_buffer.data(), m_buffer.size());
+    if (!out)
+        throwError("Unable to write temporary file '" + m_input.m_file +
+            "'.");
+    m_input.m_count += m_buffer.size() / m_recordSize;
+    std::vector<char>().swap(m_buffer);
+}
+
+
+std::string EptWriter::tempFile(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_tempPrefix + std::to_string(m_tempCount++) + "-" + name;
+}
+
+
+// Read the records of a part held in a file into memory.
+void EptWriter::load(Part& part) const
+{
+    if (part.m_file.empty())
+        return;
+
+    part.m_data.resize(part.m_count * m_recordSize);
+    std::ifstream in(part.m_file, std::ios::in | std::ios::binary);
+    in.read(part.m_data.data(), part.m_data.size());
+    if (!in)
+        throwError("Unable to read temporary file '" + part.m_file + "'.");
+    in.close();
+    FileUtils::deleteFile(part.m_file);
+    part.m_file.clear();
+}
+
+
+// Split the records of a part among the octants of its key.  Parts in
+// memory are split into memory and parts in files into files.
+void EptWriter::partition(Part& part, const Key& key, Part *children) const
+{
+    const BOX3D& b = key.b;
+    const double mid[3] = { b.minx + (b.maxx - b.minx) / 2,
+        b.miny + (b.maxy - b.miny) / 2, b.minz + (b.maxz - b.minz) / 2 };
+
+    // Same octant numbering as Key::bisect().
+    auto octant = [&mid](const char *rec)
+    {
+        double xyz[3];
+        memcpy(xyz, rec, XYZ_SIZE);
+        return (xyz[0] >= mid[0] ? 1 : 0) | (xyz[1] >= mid[1] ? 2 : 0) |
+            (xyz[2] >= mid[2] ? 4 : 0);
+    };
+
+    if (part.m_file.empty())
+    {
+        for (size_t pos = 0; pos < part.m_data.size(); pos += m_recordSize)
+        {
+            const char *rec = part.m_data.data() + pos;
+            Part& child = children[octant(rec)];
+            child.m_data.insert(child.m_data.end(), rec, rec + m_recordSize);
+            child.m_count++;
+        }
+        std::vector<char>().swap(part.m_data);
+        return;
+    }
+
+    std::ifstream in(part.m_file, std::ios::in | std::ios::binary);
+    std::unique_ptr<std::ofstream> outs[8];
+    std::vector<char> block(PARTITION_BLOCK * m_recordSize);
+    point_count_t remaining = part.m_count;
+    while (remaining)
+    {
+        point_count_t count = (std::min)(remaining, PARTITION_BLOCK);
+        in.read(block.data(), count * m_recordSize);
+        if (!in)
+            throwError("Unable to read temporary file '" + part.m_file +
+                "'.");
+        for (point_count_t i = 0; i < count; ++i)
+        {
+            const char *rec = block.data() + i * m_recordSize;
+            int dir = octant(rec);
+            Part& child = children[dir];
+            if (!outs[dir])
+            {
+                child.m_file = const_cast<EptWriter *>(this)->tempFile(
+                    key.bisect(dir).toString());
+                outs[dir].reset(new std::ofstream(child.m_file,
+                    std::ios::out | std::ios::binary | std::ios::trunc));
+            }
+            outs[dir]->write(rec, m_recordSize);
+            child.m_count++;
+        }
+        remaining -= count;
+    }
+    in.close();
+    for (int dir = 0; dir < 8; ++dir)
+        if (outs[dir] && !*outs[dir])
+            throwError("Unable to write temporary file '" +
+                children[dir].m_file + "'.");
+    FileUtils::deleteFile(part.m_file);
+    part.m_file.clear();
+}
+
+
+// Split parts that don't fit in a thread's share of memory.  Each part that
+// fits is indexed as a task on the pool.  'branch' records the structure so
+// that nodes above the indexed parts can be filled afterwards.
+void EptWriter::plan(const Key& key, Part& part, Branch& branch)
+{
+    branch.m_key = key;
+
+    // The root of the whole octree is written directly.
+    if (key.d)
+        branch.m_keptFile = tempFile(key.toString() + "-kept");
+
+    const uint64_t taskMemory = m_memory / m_args->m_threads;
+    if (part.m_count * m_recordSize <= taskMemory || key.d >= MAX_DEPTH)
+    {
+        std::shared_ptr<Part> p(new Part);
+        std::swap(*p, part);
+        std::string keptFile = branch.m_keptFile;
+        m_pool->add([this, key, p, keptFile]()
+            { index(key, *p, keptFile); });
+        return;
+    }
+
+    Part children[8];
+    partition(part, key, children);
+    for (int dir = 0; dir < 8; ++dir)
+    {
+        if (!children[dir].m_count)
+            continue;
+        branch.m_children[dir].reset(new Branch);
+        plan(key.bisect(dir), children[dir], *branch.m_children[dir]);
+    }
+}
+
+
+// Build the octree of a part that fits in memory.  The points kept by the
+// part's root are saved to 'keptFile' for the nodes above to choose from.
+// If there is no 'keptFile', the root is written as a node.
+void EptWriter::index(const Key& key, Part& part, std::string keptFile)
+{
+    load(part);
+
+    std::vector<char> kept;
+    indexNode(key, part.m_data, kept, keptFile.size());
+    if (keptFile.empty())
+        return;
+
+    std::ofstream out(keptFile, std::ios::out | std::ios::binary |
+        std::ios::trunc);
+    out.write(kept.data(), kept.size());
+    if (!out)
+        throwError("Unable to write temporary file '" + keptFile + "'.");
+}
+
+
+// Select the points kept by a node and pass the rest to its children.  The
+// points kept by the root of a part are returned in 'kept'.  Other nodes
+// are written.
+void EptWriter::indexNode(const Key& key, std::vector<char>& data,
+    std::vector<char>& kept, bool root)
+{
+    std::vector<char> rest;
+    select(key, data, kept, &rest);
+    std::vector<char>().swap(data);
+
+    if (!root)
+    {
+        writeNode(key, kept);
+        std::vector<char>().swap(kept);
+    }
+    if (rest.empty())
+        return;
+
+    Part children[8];
+    Part part;
+    part.m_data.swap(rest);
+    part.m_count = part.m_data.size() / m_recordSize;
+    partition(part, key, children);
+    for (int dir = 0; dir < 8; ++dir)
+    {
+        if (!children[dir].m_count)
+            continue;
+        std::vector<char> childKept;
+        indexNode(key.bisect(dir), children[dir].m_data, childKept, false);
+    }
+}
+
+
+// Keep at most one point from each cell of a span*span*span grid, up to
+// 'max_node_points'.  Nodes with no more than 'max_node_points' points or at
+// the maximum depth keep everything.  Points not kept are appended to 'rest'.
+void EptWriter::select(const Key& key, std::vector<char>& data,
+    std::vector<char>& kept, std::vector<char> *rest) const
+{
+    const point_count_t count = data.size() / m_recordSize;
+    if (count <= m_args->m_maxNodePoints || key.d >= MAX_DEPTH)
+    {
+        kept.swap(data);
+        return;
+    }
+
+    const int span = (int)m_args->m_span;
+    const BOX3D& b = key.b;
+    const double size[3] = { (b.maxx - b.minx) / span,
+        (b.maxy - b.miny) / span, (b.maxz - b.minz) / span };
+    const double min[3] = { b.minx, b.miny, b.minz };
+
+    std::unordered_set<uint64_t> cells;
+    for (size_t pos = 0; pos < data.size(); pos += m_recordSize)
+    {
+        const char *rec = data.data() + pos;
+        double xyz[3];
+        memcpy(xyz, rec, XYZ_SIZE);
+
+        uint64_t c = 0;
+        for (int i = 0; i < 3; ++i)
+            c = c * span +
+                Utils::clamp((int)((xyz[i] - min[i]) / size[i]), 0, span - 1);
+
+        std::vector<char>& dest =
+            (kept.size() < m_args->m_maxNodePoints * m_recordSize &&
+                cells.insert(c).second) ? kept : *rest;
+        dest.insert(dest.end(), rec, rec + m_recordSize);
+    }
+}
+
+
+// Fill a node above the indexed parts by choosing points from those kept
+// by the roots of its children.  Points that aren't chosen are written as
+// the children's nodes.  No child is left without a point.
+void EptWriter::lift(Branch& branch)
+{
+    const Key& key = branch.m_key;
+
+    std::vector<char> childData[8];
+    point_count_t total = 0;
+    for (int dir = 0; dir < 8; ++dir)
+    {
+        Branch *child = branch.m_children[dir].get();
+        if (!child)
+            continue;
+        Part part;
+        part.m_file = child->m_keptFile;
+        part.m_count = FileUtils::fileSize(part.m_file) / m_recordSize;
+        load(part);
+        childData[dir].swap(part.m_data);
+        total += part.m_count;
+    }
+
+    std::vector<char> kept;
+    std::vector<char> rest[8];
+    const bool all = total <= m_args->m_maxNodePoints || key.d >= MAX_DEPTH;
+    const int span = (int)m_args->m_span;
+    const BOX3D& b = key.b;
+    const double size[3] = { (b.maxx - b.minx) / span,
+        (b.maxy - b.miny) / span, (b.maxz - b.minz) / span };
+    const double min[3] = { b.minx, b.miny, b.minz };
+    std::unordered_set<uint64_t> cells;
+
+    for (int dir = 0; dir < 8; ++dir)
+    {
+        std::vector<char>& data = childData[dir];
+        point_count_t remaining = data.size() / m_recordSize;
+        for (size_t pos = 0; pos < data.size(); pos += m_recordSize)
+        {
+            const char *rec = data.data() + pos;
+            bool take = false;
+            if (remaining > 1 &&
+                kept.size() < m_args->m_maxNodePoints * m_recordSize)
+            {
+                if (all)
+                    take = true;
+                else
+                {
+                    double xyz[3];
+                    memcpy(xyz, rec, XYZ_SIZE);
+                    uint64_t c = 0;
+                    for (int i = 0; i < 3; ++i)
+                        c = c * span + Utils::clamp(
+                            (int)((xyz[i] - min[i]) / size[i]), 0, span - 1);
+                    take = cells.insert(c).second;
+                }
+            }
+            std::vector<char>& dest = take ? kept : rest[dir];
+            dest.insert(dest.end(), rec, rec + m_recordSize);
+            if (take)
+                remaining--;
+        }
+        std::vector<char>().swap(data);
+    }
+
+    for (int dir = 0; dir < 8; ++dir)
+        if (branch.m_children[dir])
+            writeNode(branch.m_children[dir]->m_key, rest[dir]);
+
+    if (branch.m_keptFile.empty())
+    {
+        writeNode(key, kept);
+        return;
+    }
+    std::ofstream out(branch.m_keptFile, std::ios::out | std::ios::binary |
+        std::ios::trunc);
+    out.write(kept.data(), kept.size());
+    if (!out)
+        throwError("Unable to write temporary file '" + branch.m_keptFile +
+            "'.");
+}
+
+
+void EptWriter::writeNode(const Key& key, const std::vector<char>& data)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_hierarchy[key] = data.size() / m_recordSize;
+    }
+
+    const arbiter::Endpoint dataEp(m_ep->getSubEndpoint("ept-data"));
+    const std::string& type = m_args->m_dataType;
+    if (type == "binary")
+        dataEp.put(key.toString() + ".bin", packNode(data));
+#ifdef PDAL_HAVE_ZSTD
+    else if (type == "zstandard")
+    {
+        std::vector<char> packed(packNode(data));
+        std::vector<char> compressed;
+        ZstdCompressor comp([&compressed](char *buf, size_t size)
+            { compressed.insert(compressed.end(), buf, buf + size); });
+        comp.compress(packed.data(), packed.size());
+        comp.done();
+        dataEp.put(key.toString() + ".zst", compressed);
+    }
+#endif
+#ifdef PDAL_HAVE_LZ4
+    else if (type == "lz4")
+    {
+        std::vector<char> packed(packNode(data));
+        std::vector<char> compressed;
+        Lz4Compressor comp([&compressed](char *buf, size_t size)
+            { compressed.insert(compressed.end(), buf, buf + size); });
+        comp.compress(packed.data(), packed.size());
+        comp.done();
+        dataEp.put(key.toString() + ".lz4", compressed);
+    }
+#endif
+    else if (type == "delta")
+    {
+        DimTypeList dims {
+            { Dimension::Id::X, Dimension::Type::Signed32 },
+            { Dimension::Id::Y, Dimension::Type::Signed32 },
+            { Dimension::Id::Z, Dimension::Type::Signed32 } };
+        dims.insert(dims.end(), m_dims.begin(), m_dims.end());
+
+        std::vector<char> packed(packNode(data));
+        std::vector<char> compressed;
+        DeltaCompressor comp([&compressed](char *buf, size_t size)
+            { compressed.insert(compressed.end(), buf, buf + size); }, dims);
+        comp.compress(packed.data(), packed.size());
+        comp.done();
+        dataEp.put(key.toString() + ".dlt", compressed);
+    }
+    else
+        writeLaszip(key, data);
+}
+
+
+// Convert records to the EPT binary schema: X, Y and Z as scaled 32-bit
+// integers followed by the other dimensions.
+std::vector<char> EptWriter::packNode(const std::vector<char>& data) const
+{
+    const size_t packedSize = 3 * sizeof(int32_t) + m_restSize;
+    std::vector<char> packed(data.size() / m_recordSize * packedSize);
+    char *out = packed.data();
+    for (size_t pos = 0; pos < data.size(); pos += m_recordSize)
+    {
+        const char *rec = data.data() + pos;
+        double xyz[3];
+        memcpy(xyz, rec, XYZ_SIZE);
+        for (int i = 0; i < 3; ++i)
+        {
+            int32_t v;
+            if (!Utils::numericCast(m_xforms[i].toScaled(xyz[i]), v))
+                throwError("Unable to convert scaled value (" +
+                    Utils::toString(xyz[i]) + ") to int32 for dimension '" +
+                    std::string(i == 0 ? "X" : i == 1 ? "Y" : "Z") + "'.");
+            memcpy(out, &v, sizeof(v));
+            out += sizeof(v);
+        }
+        memcpy(out, rec + XYZ_SIZE, m_restSize);
+        out += m_restSize;
+    }
+    return packed;
+}
+
+
+// Write a node as a LAS 1.4 file with LasWriter.  Dimensions that don't
+// belong to the point format are written as extra bytes.
+void EptWriter::writeLaszip(const Key& key, const std::vector<char>& data)
+    const
+{
+    using namespace Dimension;
+
+    PointTable table;
+    PointLayoutPtr layout(table.layout());
+    layout->registerDim(Id::X, Type::Double);
+    layout->registerDim(Id::Y, Type::Double);
+    layout->registerDim(Id::Z, Type::Double);
+    std::vector<Id> ids;
+    for (size_t i = 0; i < m_dims.size(); ++i)
+        ids.push_back(layout->registerOrAssignDim(m_dimNames[i],
+            m_dims[i].m_type));
+
+    PointViewPtr view(new PointView(table));
+    PointId idx = 0;
+    for (size_t pos = 0; pos < data.size(); pos += m_recordSize, ++idx)
+    {
+        const char *rec = data.data() + pos;
+        double xyz[3];
+        memcpy(xyz, rec, XYZ_SIZE);
+        view->setField(Id::X, idx, xyz[0]);
+        view->setField(Id::Y, idx, xyz[1]);
+        view->setField(Id::Z, idx, xyz[2]);
+        const char *p = rec + XYZ_SIZE;
+        for (size_t i = 0; i < m_dims.size(); ++i)
+        {
+            view->setField(ids[i], m_dims[i].m_type, idx, p);
+            p += Dimension::size(m_dims[i].m_type);
+        }
+    }
+
+    int format = 6;
+    if (layout->hasDim(Id::Red) && layout->hasDim(Id::Green) &&
+        layout->hasDim(Id::Blue))
+        format = layout->hasDim(Id::Infrared) ? 8 : 7;
+
+    const arbiter::Endpoint dataEp(m_ep->getSubEndpoint("ept-data"));
+    const std::string name(key.toString() + ".laz");
+    std::string filename = dataEp.isLocal() ?
+        dataEp.fullPath(name) :
+        const_cast<EptWriter *>(this)->tempFile(name);
+
+    Options options;
+    options.add("filename", filename);
+    options.add("minor_version", 4);
+    options.add("dataformat_id", format);
+    options.add("compression", "true");
+    options.add("extra_dims", "all");
+    options.add("scale_x", m_xforms[0].m_scale.m_val);
+    options.add("scale_y", m_xforms[1].m_scale.m_val);
+    options.add("scale_z", m_xforms[2].m_scale.m_val);
+    options.add("offset_x", m_xforms[0].m_offset.m_val);
+    options.add("offset_y", m_xforms[1].m_offset.m_val);
+    options.add("offset_z", m_xforms[2].m_offset.m_val);
+
+    BufferReader reader;
+    reader.addView(view);
+    LasWriter writer;
+    writer.setInput(reader);
+    writer.setOptions(options);
+    writer.prepare(table);
+    writer.execute(table);
+
+    if (!dataEp.isLocal())
+    {
+        std::ifstream in(filename, std::ios::in | std::ios::binary);
+        std::vector<char> buf((std::istreambuf_iterator<char>(in)),
+            std::istreambuf_iterator<char>());
+        in.close();
+        FileUtils::deleteFile(filename);
+        dataEp.put(name, buf);
+    }
+}
+
+
+// Write the hierarchy as the EPT reader expects: a map of node keys to
+// point counts, with subtrees every 'hierarchy_step' levels moved to their
+// own files and marked with a count of -1.
+void EptWriter::writeHierarchy(NL::json& curr, const Key& key)
+{
+    auto it = m_hierarchy.find(key);
+    if (it == m_hierarchy.end())
+        return;
+
+    const std::string keyName(key.toString());
+    const uint64_t step = m_args->m_hierarchyStep;
+    if (step && key.d && (key.d % step == 0))
+    {
+        curr[keyName] = -1;
+
+        NL::json next {{ keyName, it->second }};
+        for (uint64_t dir(0); dir < 8; ++dir)
+            writeHierarchy(next, key.bisect(dir));
+        m_ep->put("ept-hierarchy/" + keyName + ".json", next.dump());
+    }
+    else
+    {
+        curr[keyName] = it->second;
+        for (uint64_t dir(0); dir < 8; ++dir)
+            writeHierarchy(curr, key.bisect(dir));
+    }
+}
+
+
+void EptWriter::writeInfo(const BOX3D& cube)
+{
+    auto box = [](const BOX3D& b)
+    {
+        return NL::json::array({ b.minx, b.miny, b.minz,
+            b.maxx, b.maxy, b.maxz });
+    };
+
+    NL::json schema = NL::json::array();
+    const char *xyz[3] = { "X", "Y", "Z" };
+    for (int i = 0; i < 3; ++i)
+        schema.push_back({ { "name", xyz[i] }, { "type", "signed" },
+            { "size", 4 }, { "scale", m_xforms[i].m_scale.m_val },
+            { "offset", m_xforms[i].m_offset.m_val } });
+    for (size_t i = 0; i < m_dims.size(); ++i)
+        schema.push_back({ { "name", m_dimNames[i] },
+            { "type", typeString(m_dims[i].m_type) },
+            { "size", Dimension::size(m_dims[i].m_type) } });
+
+    NL::json info;
+    info["version"] = "1.0.0";
+    info["bounds"] = box(cube);
+    info["boundsConforming"] = box(m_bounds);
+    info["dataType"] = m_args->m_dataType;
+    info["hierarchyType"] = "json";
+    info["points"] = m_count;
+    info["span"] = m_args->m_span;
+    info["schema"] = schema;
+
+    NL::json srs = NL::json::object();
+    if (!m_srs.empty())
+    {
+        srs["wkt"] = m_srs.getWKT();
+        std::string epsg = m_srs.identifyHorizontalEPSG();
+        if (epsg.size())
+        {
+            srs["authority"] = "EPSG";
+            srs["horizontal"] = epsg;
+        }
+    }
+    info["srs"] = srs;
+
+    m_ep->put("ept.json", info.dump(2));
+}
+
+
+void EptWriter::done(PointTableRef)
+{
+    if (m_count == 0)
+        throwError("No points to write.");
+
+    // Once anything has been spilled, everything is.
+    if (m_input.m_file.size())
+        flush();
+    else
+    {
+        m_input.m_data.swap(m_buffer);
+        m_input.m_count = m_count;
+    }
+
+    // The octree is a cube around the bounds of the data.
+    const BOX3D& b = m_bounds;
+    const double center[3] = { b.minx + (b.maxx - b.minx) / 2,
+        b.miny + (b.maxy - b.miny) / 2, b.minz + (b.maxz - b.minz) / 2 };
+    double halfSize = (std::max)({ b.maxx - b.minx, b.maxy - b.miny,
+        b.maxz - b.minz }) / 2;
+    if (halfSize <= 0)
+        halfSize = 1;
+    Key root;
+    root.b = BOX3D(center[0] - halfSize, center[1] - halfSize,
+        center[2] - halfSize, center[0] + halfSize, center[1] + halfSize,
+        center[2] + halfSize);
+
+    m_xforms[0] = m_args->m_scaling.m_xXform;
+    m_xforms[1] = m_args->m_scaling.m_yXform;
+    m_xforms[2] = m_args->m_scaling.m_zXform;
+    for (int i = 0; i < 3; ++i)
+        if (m_xforms[i].m_offset.m_auto)
+            m_xforms[i].m_offset.m_val = std::round(center[i]);
+
+    if (m_ep->isLocal())
+    {
+        arbiter::mkdirp(m_ep->getSubEndpoint("ept-data").root());
+        arbiter::mkdirp(m_ep->getSubEndpoint("ept-hierarchy").root());
+    }
+
+    auto checkErrors = [this]()
+    {
+        m_pool->await();
+        if (m_pool->errors().size())
+            throwError(m_pool->errors().front());
+    };
+
+    // Split the input into parts that fit in memory and index them.
+    m_pool.reset(new ThreadPool(m_args->m_threads, -1, false));
+    Branch tree;
+    plan(root, m_input, tree);
+    checkErrors();
+
+    // Fill the nodes above the parts, deepest first.  Nodes at a depth are
+    // independent of each other.
+    std::vector<std::vector<Branch *>> levels;
+    std::function<void(Branch&)> collect = [&](Branch& branch)
+    {
+        bool leaf = true;
+        for (auto& child : branch.m_children)
+            if (child)
+            {
+                leaf = false;
+                collect(*child);
+            }
+        if (leaf)
+            return;
+        if (levels.size() <= branch.m_key.d)
+            levels.resize(branch.m_key.d + 1);
+        levels[branch.m_key.d].push_back(&branch);
+    };
+    collect(tree);
+    for (auto it = levels.rbegin(); it != levels.rend(); ++it)
+    {
+        for (Branch *branch : *it)
+            m_pool->add([this, branch](){ lift(*branch); });
+        checkErrors();
+    }
+    m_pool->join();
+
+    NL::json hierarchy;
+    writeHierarchy(hierarchy, root);
+    m_ep->put("ept-hierarchy/" + root.toString() + ".json", hierarchy.dump());
+    writeInfo(root.b);
+
+    getMetadata().addList("filename", m_ep->prefixedRoot());
+    m_hierarchy.clear();
+    m_input = Part();
+}
+
+} // namespace pdal
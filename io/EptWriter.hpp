@@ -0,0 +1,147 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <pdal/JsonFwd.hpp>
+#include <pdal/Streamable.hpp>
+#include <pdal/Writer.hpp>
+#include <pdal/util/Bounds.hpp>
+
+#include "private/EptSupport.hpp"
+
+namespace pdal
+{
+
+namespace arbiter
+{
+    class Arbiter;
+    class Endpoint;
+}
+
+class ThreadPool;
+
+// Builds an Entwine Point Tile (EPT) dataset from its input.  Points are
+// spilled to temporary files as they arrive.  When the input doesn't fit
+// in memory, the files are partitioned into octants until each part does.
+// Parts are then indexed in parallel, each into an octree whose nodes keep
+// at most one point per cell of a span*span*span grid.  Finally the nodes
+// above the parts take their points from the roots of the parts below them.
+class PDAL_DLL EptWriter : public Writer, public Streamable
+{
+public:
+    EptWriter();
+    ~EptWriter();
+
+    std::string getName() const;
+
+private:
+    // Points in some number of packed records, held in memory or in a
+    // temporary file.
+    struct Part
+    {
+        Part() : m_count(0)
+        {}
+
+        std::string m_file;
+        std::vector<char> m_data;
+        point_count_t m_count;
+    };
+
+    // An octree node above the parts that fit in memory.
+    struct Branch;
+
+    struct Args;
+    std::unique_ptr<Args> m_args;
+
+    virtual void addArgs(ProgramArgs& args);
+    virtual void initialize();
+    virtual void prepared(PointTableRef table);
+    virtual void ready(PointTableRef table);
+    virtual void write(const PointViewPtr view);
+    virtual bool processOne(PointRef& point);
+    virtual void spatialReferenceChanged(const SpatialReference& srs);
+    virtual void done(PointTableRef table);
+
+    void addPoint(PointRef& point);
+    void flush();
+    std::string tempFile(const std::string& name);
+    void load(Part& part) const;
+    void partition(Part& part, const Key& key, Part *children) const;
+    void plan(const Key& key, Part& part, Branch& branch);
+    void index(const Key& key, Part& part, std::string keptFile);
+    void indexNode(const Key& key, std::vector<char>& data,
+        std::vector<char>& kept, bool root);
+    void select(const Key& key, std::vector<char>& data,
+        std::vector<char>& kept, std::vector<char> *rest) const;
+    void lift(Branch& branch);
+    void writeNode(const Key& key, const std::vector<char>& data);
+    std::vector<char> packNode(const std::vector<char>& data) const;
+    void writeLaszip(const Key& key, const std::vector<char>& data) const;
+    void writeHierarchy(NL::json& curr, const Key& key);
+    void writeInfo(const BOX3D& cube);
+
+    std::unique_ptr<arbiter::Arbiter> m_arbiter;
+    std::unique_ptr<arbiter::Endpoint> m_ep;
+    std::unique_ptr<ThreadPool> m_pool;
+
+    // Dimensions other than X, Y and Z, in record order.
+    DimTypeList m_dims;
+    StringList m_dimNames;
+    size_t m_restSize;
+    size_t m_recordSize;
+
+    uint64_t m_memory;
+    std::vector<char> m_buffer;
+    Part m_input;
+    point_count_t m_count;
+    BOX3D m_bounds;
+    SpatialReference m_srs;
+    XForm m_xforms[3];
+    std::string m_tempPrefix;
+    uint64_t m_tempCount;
+
+    std::map<Key, point_count_t> m_hierarchy;
+    std::mutex m_mutex;
+
+    EptWriter& operator=(const EptWriter&); // not implemented
+    EptWriter(const EptWriter&); // not implemented
+};
+
+} // namespace pdal
@@ -37,8 +37,12 @@
 #include <pdal/Options.hpp>
 #include <pdal/PointView.hpp>
 #include <pdal/util/ProgramArgs.hpp>
+#include <pdal/util/Random.hpp>
+#include <pdal/util/TaskScheduler.hpp>
 
+#include <cmath>
 #include <ctime>
+#include <functional>
 
 namespace pdal
 {
@@ -54,6 +58,264 @@ CREATE_STATIC_STAGE(FauxReader, s_info)
 
 std::string FauxReader::getName() const { return s_info.name; }
 
+namespace faux
+{
+
+namespace
+{
+
+const double Pi = 3.14159265358979323846;
+
+// Run 'fn' over the range [0, count) split across threads.
+void forRange(point_count_t count, int threads,
+    const std::function<void(point_count_t, point_count_t)>& fn)
+{
+    point_count_t n = (std::min)((point_count_t)threads, count);
+    if (n <= 1)
+    {
+        fn(0, count);
+        return;
+    }
+
+    parallelFor(n, n, [&fn, count, n](std::size_t t)
+        { fn(t * count / n, (t + 1) * count / n); });
+}
+
+} // unnamed namespace
+
+// A synthetic airborne scan of a ground surface with trees.  Pulses are
+// laid out in serpentine scan lines across the bounds.  Pulses that hit a
+// tree produce several returns from the crown down to the ground.
+//
+// Random values come from a hash of the seed and the pulse (or tree cell)
+// number rather than from a generator with state, so any pulse can be
+// generated on its own.
+class Terrain
+{
+public:
+    struct Pulse
+    {
+        double x;
+        double y;
+        double ground;
+        double canopy;      // Height of vegetation above the ground.
+        double angle;
+        int returns;
+    };
+
+    Terrain(const BOX3D& bounds, uint32_t seed, int maxReturns,
+        point_count_t count);
+
+    Pulse pulse(point_count_t n) const;
+    void setPoint(PointRef& point, const Pulse& p, point_count_t n,
+        int ret) const;
+
+private:
+    // Random value in [0, 1) for a counter and a stream of values
+    // associated with that counter.
+    double unit(uint64_t counter, uint64_t stream) const
+        { return m_random.unit(counter, stream); }
+
+    double groundHeight(double x, double y) const;
+    double canopyHeight(double x, double y) const;
+    int numReturns(double canopy, double u) const;
+
+    BOX3D m_bounds;
+    Utils::CounterRandom m_random;
+    int m_maxReturns;
+    double m_width;
+    double m_height;
+    double m_range;
+    double m_phase[4];
+    double m_cellSize;
+    int64_t m_cellsX;
+    int64_t m_cellsY;
+    point_count_t m_perLine;
+    point_count_t m_lines;
+};
+
+
+Terrain::Terrain(const BOX3D& bounds, uint32_t seed, int maxReturns,
+        point_count_t count) :
+    m_bounds(bounds), m_random(seed), m_maxReturns(maxReturns)
+{
+    // Tree cells are hashed with the top bit set so that they don't share
+    // values with pulses.
+    const uint64_t TreeFlag = 1ULL << 55;
+    const uint64_t SampleFlag = 1ULL << 54;
+
+    m_width = (std::max)(m_bounds.maxx - m_bounds.minx, 0.0);
+    m_height = (std::max)(m_bounds.maxy - m_bounds.miny, 0.0);
+    m_range = (std::max)(m_bounds.maxz - m_bounds.minz, 0.0);
+    for (size_t i = 0; i < 4; ++i)
+        m_phase[i] = unit(TreeFlag - 1, i);
+
+    // About 40 trees across the longer side of the bounds.
+    m_cellSize = (std::max)(m_width, m_height) / 40;
+    m_cellsX = m_cellSize ? (int64_t)std::ceil(m_width / m_cellSize) : 0;
+    m_cellsY = m_cellSize ? (int64_t)std::ceil(m_height / m_cellSize) : 0;
+
+    // Estimate the number of pulses needed to produce 'count' points by
+    // sampling the canopy, and size the scan lines so that the pulses
+    // cover the bounds evenly.
+    const int Samples = 1024;
+    double returns = 0;
+    for (int i = 0; i < Samples; ++i)
+    {
+        double x = m_bounds.minx + m_width * unit(SampleFlag | i, 0);
+        double y = m_bounds.miny + m_height * unit(SampleFlag | i, 1);
+        double canopy = canopyHeight(x, y);
+        if (canopy > 0 && m_maxReturns > 1)
+            returns += (2 + m_maxReturns) / 2.0;
+        else
+            returns += 1;
+    }
+    double pulses = (std::max)(std::ceil(count * Samples / returns), 1.0);
+    if (m_width > 0 && m_height > 0)
+        m_lines = (point_count_t)(std::max)(
+            std::round(std::sqrt(pulses * m_height / m_width)), 1.0);
+    else if (m_height > 0)
+        m_lines = (point_count_t)pulses;
+    else
+        m_lines = 1;
+    m_perLine = (point_count_t)std::ceil(pulses / m_lines);
+}
+
+
+// The ground is a sum of waves filling the lower 60% of the Z range.
+double Terrain::groundHeight(double x, double y) const
+{
+    double u = m_width ? (x - m_bounds.minx) / m_width : 0;
+    double v = m_height ? (y - m_bounds.miny) / m_height : 0;
+
+    double g = .5 +
+        .25 * std::sin(2 * Pi * (1.3 * u + m_phase[0])) *
+            std::cos(2 * Pi * (.9 * v + m_phase[1])) +
+        .15 * std::sin(2 * Pi * (2.7 * u + 3.1 * v + m_phase[2])) +
+        .1 * std::sin(2 * Pi * (7 * u - 5 * v + m_phase[3]));
+    return m_bounds.minz + .6 * m_range * g;
+}
+
+
+// Each tree cell holds a tree about half the time.  Crowns are paraboloids
+// up to 35% of the Z range tall that may overhang neighboring cells.
+double Terrain::canopyHeight(double x, double y) const
+{
+    const uint64_t TreeFlag = 1ULL << 55;
+
+    if (!m_cellSize)
+        return 0;
+
+    int64_t cx = (int64_t)std::floor((x - m_bounds.minx) / m_cellSize);
+    int64_t cy = (int64_t)std::floor((y - m_bounds.miny) / m_cellSize);
+    double canopy = 0;
+    for (int64_t j = cy - 1; j <= cy + 1; ++j)
+        for (int64_t i = cx - 1; i <= cx + 1; ++i)
+        {
+            if (i < -1 || i > m_cellsX || j < -1 || j > m_cellsY)
+                continue;
+            uint64_t cell = TreeFlag | (uint64_t)((j + 1) * (m_cellsX + 2) +
+                (i + 1));
+            if (unit(cell, 0) >= .55)
+                continue;
+            double tx = m_bounds.minx +
+                m_cellSize * (i + .2 + .6 * unit(cell, 1));
+            double ty = m_bounds.miny +
+                m_cellSize * (j + .2 + .6 * unit(cell, 2));
+            double radius = m_cellSize * (.35 + .25 * unit(cell, 3));
+            double height = m_range * (.15 + .2 * unit(cell, 4));
+            double d2 = ((x - tx) * (x - tx) + (y - ty) * (y - ty)) /
+                (radius * radius);
+            if (d2 < 1)
+                canopy = (std::max)(canopy, height * (1 - d2));
+        }
+    return canopy;
+}
+
+
+int Terrain::numReturns(double canopy, double u) const
+{
+    if (canopy <= 0 || m_maxReturns == 1)
+        return 1;
+    return (std::min)(2 + (int)(u * (m_maxReturns - 1)), m_maxReturns);
+}
+
+
+Terrain::Pulse Terrain::pulse(point_count_t n) const
+{
+    Pulse p;
+
+    // Alternate lines are scanned in opposite directions.  Once all lines
+    // have been scanned, scanning starts over as if from another pass.
+    point_count_t line = n / m_perLine;
+    point_count_t col = n % m_perLine;
+    if (line % 2)
+        col = m_perLine - 1 - col;
+    line %= m_lines;
+
+    p.x = m_bounds.minx +
+        m_width * (col + .25 + .5 * unit(n, 0)) / m_perLine;
+    p.y = m_bounds.miny +
+        m_height * (line + .4 + .2 * unit(n, 1)) / m_lines;
+    p.angle = -30 + 60 * (col + .5) / m_perLine;
+    p.ground = groundHeight(p.x, p.y);
+    p.canopy = canopyHeight(p.x, p.y);
+    p.returns = numReturns(p.canopy, unit(n, 2));
+    return p;
+}
+
+
+// Set the point for return 'ret' (starting at 1) of pulse 'n'.  Returns are
+// ordered from the top of the canopy down.  The last return of a pulse
+// that passes through vegetation is the ground.
+void Terrain::setPoint(PointRef& point, const Pulse& p, point_count_t n,
+    int ret) const
+{
+    double z;
+    int cls;
+    double intensity;
+
+    double u = unit(n, 3 + 2 * ret);
+    double v = unit(n, 4 + 2 * ret);
+    bool ground = (ret == p.returns && (p.canopy <= 0 || p.returns > 1));
+    if (ground)
+    {
+        z = p.ground + .001 * m_range * (u - .5);
+        cls = 2;
+        intensity = 300 + 500 * v;
+    }
+    else
+    {
+        double frac = p.returns > 1 ? (ret - 1) / (p.returns - 1.0) : 0;
+        double height = p.canopy * (1 - frac) * (.95 + .05 * u);
+        z = p.ground + height;
+        cls = (height < .4 * p.canopy) ? 3 : 5;
+        intensity = 50 + 250 * v;
+    }
+
+    point.setField(Dimension::Id::X, p.x);
+    point.setField(Dimension::Id::Y, p.y);
+    point.setField(Dimension::Id::Z, z);
+    // 100kHz pulse rate.
+    point.setField(Dimension::Id::GpsTime, n * 1e-5);
+    point.setField(Dimension::Id::ReturnNumber, ret);
+    point.setField(Dimension::Id::NumberOfReturns, p.returns);
+    point.setField(Dimension::Id::Classification, cls);
+    point.setField(Dimension::Id::Intensity, intensity);
+    point.setField(Dimension::Id::ScanAngleRank, p.angle);
+}
+
+} // namespace faux
+
+
+FauxReader::FauxReader()
+{}
+
+
+FauxReader::~FauxReader()
+{}
+
+
 void FauxReader::addArgs(ProgramArgs& args)
 {
     args.add("bounds", "X/Y/Z limits", m_bounds, BOX3D(0, 0, 0, 1, 1, 1));
@@ -65,6 +327,10 @@ void FauxReader::addArgs(ProgramArgs& args)
     args.add("stdev_z", "Z standard deviation", m_stdev_z, 1.0);
     args.add("mode", "Point creation mode", m_mode);
     args.add("number_of_returns", "Max number of returns", m_numReturns);
+    m_seedArg = &args.add("seed", "Random number generator seed",
+        m_startSeed);
+    args.add("threads", "Number of threads used to generate points",
+        m_threads, 1);
 }
 
 
@@ -74,6 +340,8 @@ void FauxReader::initialize()
         throwError("Argument 'count' needs a value and none was provided.");
     if (m_numReturns > 10)
         throwError("Option 'number_of_returns' must be in the range [0,10].");
+    if (m_threads < 1)
+        throwError("Option 'threads' must be at least 1.");
     if (m_mode == Mode::Grid)
     {
         m_bounds.minx = ceil(m_bounds.minx);
@@ -134,34 +402,44 @@ void FauxReader::addDimensions(PointLayoutPtr layout)
         Dimension::Id::Z, Dimension::Id::OffsetTime };
 
     layout->registerDims(ids);
-    if (m_numReturns > 0)
+    if (m_numReturns > 0 || m_mode == Mode::Terrain)
     {
         layout->registerDim(Dimension::Id::ReturnNumber);
         layout->registerDim(Dimension::Id::NumberOfReturns);
     }
+    if (m_mode == Mode::Terrain)
+    {
+        layout->registerDim(Dimension::Id::GpsTime);
+        layout->registerDim(Dimension::Id::Classification);
+        layout->registerDim(Dimension::Id::Intensity);
+        layout->registerDim(Dimension::Id::ScanAngleRank);
+    }
 }
 
 
 void FauxReader::ready(PointTableRef /*table*/)
 {
-    m_returnNum = 1;
-    m_time = 0;
-    m_seed = (uint32_t)std::time(NULL);
+    m_seed = m_seedArg->set() ? m_startSeed : (uint32_t)std::time(NULL);
     m_index = 0;
+    m_pulse = 0;
+    m_return = 1;
+    if (m_mode == Mode::Terrain)
+        m_terrain.reset(new faux::Terrain(m_bounds, m_seed,
+            m_numReturns ? m_numReturns : 4, m_count));
 }
 
 
 #pragma warning (push)
 #pragma warning (disable: 4244)
-bool FauxReader::processOne(PointRef& point)
+// Set the point with the given index.  Uniform and normal values use three
+// seeds per point, starting at the seed provided.
+void FauxReader::generate(PointRef& point, point_count_t index) const
 {
     double x(0);
     double y(0);
     double z(0);
 
-    if (m_index >= m_count)
-        return false;
-
+    uint32_t seed = m_seed + (uint32_t)(3 * index);
     switch (m_mode)
     {
     case Mode::Random:
@@ -175,73 +453,203 @@ bool FauxReader::processOne(PointRef& point)
         z = m_bounds.minz;
         break;
     case Mode::Ramp:
-        x = m_bounds.minx + m_delX * m_index;
-        y = m_bounds.miny + m_delY * m_index;
-        z = m_bounds.minz + m_delZ * m_index;
+        x = m_bounds.minx + m_delX * index;
+        y = m_bounds.miny + m_delY * index;
+        z = m_bounds.minz + m_delZ * index;
         break;
     case Mode::Uniform:
-        x = Utils::uniform(m_bounds.minx, m_bounds.maxx, m_seed++);
-        y = Utils::uniform(m_bounds.miny, m_bounds.maxy, m_seed++);
-        z = Utils::uniform(m_bounds.minz, m_bounds.maxz, m_seed++);
+        x = Utils::uniform(m_bounds.minx, m_bounds.maxx, seed);
+        y = Utils::uniform(m_bounds.miny, m_bounds.maxy, seed + 1);
+        z = Utils::uniform(m_bounds.minz, m_bounds.maxz, seed + 2);
         break;
     case Mode::Normal:
-        x = Utils::normal(m_mean_x, m_stdev_x, m_seed++);
-        y = Utils::normal(m_mean_y, m_stdev_y, m_seed++);
-        z = Utils::normal(m_mean_z, m_stdev_z, m_seed++);
+        x = Utils::normal(m_mean_x, m_stdev_x, seed);
+        y = Utils::normal(m_mean_y, m_stdev_y, seed + 1);
+        z = Utils::normal(m_mean_z, m_stdev_z, seed + 2);
         break;
     case Mode::Grid:
     {
         if (m_delX)
-            x = m_index % (point_count_t)m_delX;
+            x = index % (point_count_t)m_delX;
 
         if (m_delY)
         {
             if (m_delX)
-                y = (m_index / (point_count_t)m_delX) % (point_count_t)m_delY;
+                y = (index / (point_count_t)m_delX) % (point_count_t)m_delY;
             else
-                y = m_index % (point_count_t)m_delY;
+                y = index % (point_count_t)m_delY;
         }
 
         if (m_delZ)
         {
             if (m_delX && m_delY)
-                z = m_index / (point_count_t)(m_delX * m_delY);
+                z = index / (point_count_t)(m_delX * m_delY);
             else if (m_delX)
-                z = m_index / (point_count_t)m_delX;
+                z = index / (point_count_t)m_delX;
             else if (m_delY)
-                z = m_index / (point_count_t)m_delY;
+                z = index / (point_count_t)m_delY;
         }
         break;
     }
+    case Mode::Terrain:
+        break;
     }
 
     point.setField(Dimension::Id::X, x);
     point.setField(Dimension::Id::Y, y);
     point.setField(Dimension::Id::Z, z);
-    point.setField(Dimension::Id::OffsetTime, m_time++);
+    point.setField(Dimension::Id::OffsetTime, index);
     if (m_numReturns > 0)
     {
-        point.setField(Dimension::Id::ReturnNumber, m_returnNum);
+        point.setField(Dimension::Id::ReturnNumber,
+            (index % m_numReturns) + 1);
         point.setField(Dimension::Id::NumberOfReturns, m_numReturns);
-        m_returnNum = (m_returnNum % m_numReturns) + 1;
     }
+}
+#pragma warning (pop)
+
+
+bool FauxReader::processOne(PointRef& point)
+{
+    if (m_index >= m_count)
+        return false;
+
+    if (m_mode == Mode::Terrain)
+    {
+        faux::Terrain::Pulse p = m_terrain->pulse(m_pulse);
+        m_terrain->setPoint(point, p, m_pulse, m_return);
+        point.setField(Dimension::Id::OffsetTime, m_index);
+        if (m_return++ == p.returns)
+        {
+            m_pulse++;
+            m_return = 1;
+        }
+    }
+    else
+        generate(point, m_index);
     m_index++;
     return true;
 }
-#pragma warning (pop)
 
 
 point_count_t FauxReader::read(PointViewPtr view, point_count_t count)
 {
-    for (PointId idx = 0; idx < count; ++idx)
+    count = (std::min)(count, m_count - m_index);
+    PointId start = view->size();
+
+    if (m_mode == Mode::Terrain)
+        count = readTerrain(view, count);
+    // Random mode uses the C library generator, which can't be shared
+    // between threads.
+    else if (m_threads == 1 || m_mode == Mode::Random)
     {
-        PointRef point = view->point(idx);
-        if (!processOne(point))
-            break;
-        if (m_cb)
-            m_cb(*view, idx);
+        PointRef point(*view, start);
+        for (PointId idx = start; idx < start + count; ++idx)
+        {
+            point.setPointId(idx);
+            processOne(point);
+        }
     }
+    else
+    {
+        // Add the points up front so that threads only set existing points.
+        for (PointId idx = start; idx < start + count; ++idx)
+            view->setField(Dimension::Id::X, idx, 0.0);
+        faux::forRange(count, m_threads,
+            [this, &view, start](point_count_t begin, point_count_t end)
+            {
+                PointRef point(*view, start);
+                for (point_count_t i = begin; i < end; ++i)
+                {
+                    point.setPointId(start + i);
+                    generate(point, m_index + i);
+                }
+            });
+        m_index += count;
+    }
+
+    if (m_cb)
+        for (PointId idx = start; idx < start + count; ++idx)
+            m_cb(*view, idx);
     return count;
 }
 
+
+point_count_t FauxReader::readTerrain(PointViewPtr view, point_count_t count)
+{
+    using Pulse = faux::Terrain::Pulse;
+
+    // Limits the memory used to hold pulses.
+    const point_count_t ChunkPulses = 1 << 20;
+
+    PointId start = view->size();
+    point_count_t cnt = 0;
+    std::vector<Pulse> pulses;
+    std::vector<point_count_t> firstPoint;
+    while (cnt < count)
+    {
+        // Every pulse has at least one return, so this many pulses is
+        // always enough.
+        point_count_t numPulses = (std::min)(count - cnt, ChunkPulses);
+        pulses.resize(numPulses);
+        faux::forRange(numPulses, m_threads,
+            [this, &pulses](point_count_t begin, point_count_t end)
+            {
+                for (point_count_t i = begin; i < end; ++i)
+                    pulses[i] = m_terrain->pulse(m_pulse + i);
+            });
+
+        // Find the first point of each pulse.  The first pulse may have
+        // been partly read already.
+        firstPoint.clear();
+        point_count_t points = 0;
+        for (point_count_t i = 0; i < numPulses && cnt + points < count; ++i)
+        {
+            firstPoint.push_back(points);
+            points += pulses[i].returns - (i ? 0 : m_return - 1);
+        }
+        points = (std::min)(points, count - cnt);
+
+        PointId first = start + cnt;
+        for (PointId idx = first; idx < first + points; ++idx)
+            view->setField(Dimension::Id::X, idx, 0.0);
+        faux::forRange(firstPoint.size(), m_threads,
+            [this, &view, &pulses, &firstPoint, first, points]
+            (point_count_t begin, point_count_t end)
+            {
+                PointRef point(*view, first);
+                for (point_count_t i = begin; i < end; ++i)
+                {
+                    int ret = i ? 1 : m_return;
+                    for (point_count_t p = firstPoint[i];
+                        p < points && ret <= pulses[i].returns; ++p, ++ret)
+                    {
+                        point.setPointId(first + p);
+                        m_terrain->setPoint(point, pulses[i], m_pulse + i,
+                            ret);
+                        point.setField(Dimension::Id::OffsetTime,
+                            m_index + p);
+                    }
+                }
+            });
+
+        // Save where the last pulse left off.
+        point_count_t last = firstPoint.size() - 1;
+        int ret = (int)(points - firstPoint[last]) + (last ? 1 : m_return);
+        if (ret > pulses[last].returns)
+        {
+            m_pulse += last + 1;
+            m_return = 1;
+        }
+        else
+        {
+            m_pulse += last;
+            m_return = ret;
+        }
+        m_index += points;
+        cnt += points;
+    }
+    return cnt;
+}
+
 } // namespace pdal
@@ -40,6 +40,11 @@
 namespace pdal
 {
 
+namespace faux
+{
+class Terrain;
+}
+
 enum class Mode
 {
     Constant,
@@ -47,7 +52,8 @@ enum class Mode
     Ramp,
     Uniform,
     Normal,
-    Grid
+    Grid,
+    Terrain
 };
 
 inline std::istream& operator>>(std::istream& in, Mode& m)
@@ -68,6 +74,8 @@ inline std::istream& operator>>(std::istream& in, Mode& m)
         m = Mode::Normal;
     else if (s == "grid")
         m = Mode::Grid;
+    else if (s == "terrain")
+        m = Mode::Terrain;
     else
         in.setstate(std::ios::failbit);
     return in;
@@ -79,16 +87,25 @@ inline std::ostream& operator<<(std::ostream& out, const Mode& m)
     {
     case Mode::Constant:
         out << "Constant";
+        break;
     case Mode::Random:
         out << "Random";
+        break;
     case Mode::Ramp:
         out << "Ramp";
+        break;
     case Mode::Uniform:
         out << "Uniform";
+        break;
     case Mode::Normal:
         out << "Normal";
+        break;
     case Mode::Grid:
         out << "Grid";
+        break;
+    case Mode::Terrain:
+        out << "Terrain";
+        break;
     }
     return out;
 }
@@ -114,9 +131,14 @@ inline std::ostream& operator<<(std::ostream& out, const Mode& m)
 //     given bounding box
 //   - "normal" generates points that are normally distributed with a given
 //     mean and standard deviation in each of the XYZ dimensions
+//   - "terrain" generates airborne lidar-like returns from a synthetic
+//     ground surface with trees, scanned in serpentine lines
 // In all these modes, however, the Time field is always set to the point
 // number.
 //
+// Each point is a function of its index, so points can be generated by
+// several threads and the output doesn't depend on the number of threads.
+//
 // ReturnNumber and NumberOfReturns are not included by default, but can be
 // activated by passing a numeric value as "number_of_returns" to the
 // reader constructor.
@@ -124,8 +146,8 @@ inline std::ostream& operator<<(std::ostream& out, const Mode& m)
 class PDAL_DLL FauxReader : public Reader, public Streamable
 {
 public:
-    FauxReader()
-    {}
+    FauxReader();
+    ~FauxReader();
 
     std::string getName() const;
 
@@ -141,11 +163,15 @@ private:
     double m_delX;
     double m_delY;
     double m_delZ;
-    uint64_t m_time;
     int m_numReturns;
-    int m_returnNum;
     point_count_t m_index;
     uint32_t m_seed;
+    uint32_t m_startSeed;
+    Arg *m_seedArg;
+    int m_threads;
+    std::unique_ptr<faux::Terrain> m_terrain;
+    point_count_t m_pulse;
+    int m_return;
 
     virtual void addArgs(ProgramArgs& args);
     virtual void initialize();
@@ -153,6 +179,8 @@ private:
     virtual void ready(PointTableRef table);
     virtual bool processOne(PointRef& point);
     virtual point_count_t read(PointViewPtr view, point_count_t count);
+    void generate(PointRef& point, point_count_t index) const;
+    point_count_t readTerrain(PointViewPtr view, point_count_t count);
     virtual bool eof()
         { return false; }
 
@@ -34,7 +34,9 @@
 
 #include "GDALReader.hpp"
 
+#include <cmath>
 #include <sstream>
+#include <thread>
 
 #include <pdal/GDALUtils.hpp>
 #include <pdal/PointView.hpp>
@@ -53,6 +55,15 @@ static StaticPluginInfo const s_info
 
 CREATE_STATIC_STAGE(GDALReader, s_info)
 
+namespace
+{
+
+// Largest number of cells read at once.  Blocks bigger than this are read
+// in parts.
+const int64_t MaxBlockCells = 1024 * 1024;
+
+} // unnamed namespace
+
 
 std::string GDALReader::getName() const
 {
@@ -72,6 +83,9 @@ GDALReader::~GDALReader()
 
 void GDALReader::initialize()
 {
+    if (m_threads < 1)
+        throwError("Option 'threads' must be at least 1.");
+
     gdal::registerDrivers();
 
     m_raster.reset(new gdal::Raster(m_filename));
@@ -126,6 +140,7 @@ void GDALReader::addDimensions(PointLayoutPtr layout)
 {
     layout->registerDim(pdal::Dimension::Id::X);
     layout->registerDim(pdal::Dimension::Id::Y);
+    m_bandIds.clear();
 
     std::vector<std::string> dimNames;
     if (m_header.size())
@@ -152,6 +167,10 @@ void GDALReader::addArgs(ProgramArgs& args)
         "raster bands to dimension id", m_header);
     args.add("memorycopy", "Load the given raster file "
         "entirely to memory", m_useMemoryCopy, false).setHidden();
+    args.add("threads", "Number of threads used to read raster blocks",
+        m_threads, 1);
+    args.add("skip_nodata", "Don't create points for cells whose bands "
+        "all hold no data", m_skipNoData, false);
 }
 
 
@@ -171,9 +190,122 @@ void GDALReader::ready(PointTableRef table)
                 "copy.  Using standard interface.";
     }
 
+    // GDAL datasets can't be shared between threads, so each thread reads
+    // with its own handle.  A memory copy can't be reopened.
+    m_threadRasters.clear();
+    if (!m_useMemoryCopy)
+        for (int i = 1; i < m_threads; ++i)
+        {
+            std::unique_ptr<gdal::Raster> r(new gdal::Raster(m_filename));
+            if (r->open() == gdal::GDALError::CantOpen)
+                throwError("Couldn't open raster file '" + m_filename + "'.");
+            m_threadRasters.push_back(std::move(r));
+        }
+
+    // Read the raster by its natural blocks, taken from the first band.
+    m_blockWidth = m_raster->blockWidth(1);
+    m_blockHeight = m_raster->blockHeight(1);
+    if (m_blockWidth <= 0 || m_blockHeight <= 0)
+    {
+        m_blockWidth = m_width;
+        m_blockHeight = 1;
+    }
+    m_blockWidth = (std::min)(m_blockWidth, (std::max)(m_width, 1));
+    if ((int64_t)m_blockWidth * m_blockHeight > MaxBlockCells)
+        m_blockHeight = (int)(std::max)((int64_t)1,
+            MaxBlockCells / m_blockWidth);
+    m_blockHeight = (std::min)(m_blockHeight, (std::max)(m_height, 1));
+    m_blockCount = (m_width && m_height) ?
+        (size_t)((m_width + m_blockWidth - 1) / m_blockWidth) *
+        ((m_height + m_blockHeight - 1) / m_blockHeight) : 0;
+
+    m_noData.assign(m_raster->bandCount(), 0);
+    m_hasNoData.assign(m_raster->bandCount(), false);
+    for (int b = 0; b < m_raster->bandCount(); ++b)
+        m_hasNoData[b] = m_raster->noData(b + 1, m_noData[b]);
+
     m_index = 0;
-    m_row = 0;
-    m_col = 0;
+    m_nextBlock = 0;
+    m_blocks.clear();
+    m_blockIdx = 0;
+    m_cellIdx = 0;
+}
+
+
+// Read the next blocks of the raster, one for each raster handle.
+void GDALReader::readBlocks()
+{
+    std::vector<gdal::Raster *> rasters { m_raster.get() };
+    for (auto& r : m_threadRasters)
+        rasters.push_back(r.get());
+
+    size_t count = (std::min)(rasters.size(), m_blockCount - m_nextBlock);
+    m_blocks.resize(count);
+    std::vector<std::string> errors(count);
+    auto readOne = [this, &rasters, &errors](size_t i)
+    {
+        try
+        {
+            readBlock(*rasters[i], m_nextBlock + i, m_blocks[i]);
+        }
+        catch (const pdal_error& err)
+        {
+            errors[i] = err.what();
+        }
+    };
+
+    if (count == 1)
+        readOne(0);
+    else
+    {
+        std::vector<std::thread> pool;
+        for (size_t i = 0; i < count; ++i)
+            pool.emplace_back(readOne, i);
+        for (std::thread& t : pool)
+            t.join();
+    }
+    for (const std::string& err : errors)
+        if (err.size())
+            throw pdal_error(err);
+
+    m_nextBlock += count;
+    m_blockIdx = 0;
+    m_cellIdx = 0;
+}
+
+
+void GDALReader::readBlock(gdal::Raster& raster, size_t blockNum,
+    Block& block)
+{
+    const size_t blocksAcross = (m_width + m_blockWidth - 1) / m_blockWidth;
+    block.m_column = (int)(blockNum % blocksAcross) * m_blockWidth;
+    block.m_row = (int)(blockNum / blocksAcross) * m_blockHeight;
+    block.m_width = (std::min)(m_blockWidth, m_width - block.m_column);
+    block.m_height = (std::min)(m_blockHeight, m_height - block.m_row);
+    if (raster.readWindow(block.m_column, block.m_row, block.m_width,
+            block.m_height, block.m_data) != gdal::GDALError::None)
+        throwError(raster.errorMsg());
+
+    // Skip cells where every band holds no data.
+    const size_t numBands = m_noData.size();
+    const size_t numCells = (size_t)block.m_width * block.m_height;
+    block.m_cells.clear();
+    block.m_cells.reserve(numCells);
+    const double *v = block.m_data.data();
+    for (size_t cell = 0; cell < numCells; ++cell, v += numBands)
+    {
+        if (m_skipNoData && numBands)
+        {
+            size_t b = 0;
+            for (; b < numBands; ++b)
+                if (!m_hasNoData[b] || (v[b] != m_noData[b] &&
+                    !(std::isnan(v[b]) && std::isnan(m_noData[b]))))
+                    break;
+            if (b == numBands)
+                continue;
+        }
+        block.m_cells.push_back((uint32_t)cell);
+    }
 }
 
 
@@ -196,32 +328,33 @@ point_count_t GDALReader::read(PointViewPtr view, point_count_t numPts)
 
 bool GDALReader::processOne(PointRef& point)
 {
-    std::array<double, 2> coords;
-    if (m_row == m_height)
-        return false; // done
+    while (m_blockIdx == m_blocks.size() ||
+        m_cellIdx == m_blocks[m_blockIdx].m_cells.size())
+    {
+        if (m_blockIdx < m_blocks.size())
+        {
+            m_blockIdx++;
+            m_cellIdx = 0;
+        }
+        else if (m_nextBlock < m_blockCount)
+            readBlocks();
+        else
+            return false; // done
+    }
 
-    m_raster->pixelToCoord(m_col, m_row, coords);
-    double x = coords[0];
-    double y = coords[1];
-    point.setField(Dimension::Id::X, x);
-    point.setField(Dimension::Id::Y, y);
+    const Block& block = m_blocks[m_blockIdx];
+    const uint32_t cell = block.m_cells[m_cellIdx++];
 
-    std::vector<double> data;
-    if (m_raster->read(x, y, data) != gdal::GDALError::None)
-        return false;
+    std::array<double, 2> coords;
+    m_raster->pixelToCoord(block.m_column + (int)(cell % block.m_width),
+        block.m_row + (int)(cell / block.m_width), coords);
+    point.setField(Dimension::Id::X, coords[0]);
+    point.setField(Dimension::Id::Y, coords[1]);
 
-    for (int b = 0; b < m_raster->bandCount(); ++b)
-    {
-        Dimension::Id id = m_bandIds[b];
-        double v = data[b];
-        point.setField(id, v);
-    }
-    m_col++;
-    if (m_col == m_width)
-    {
-        m_col = 0;
-        m_row++;
-    }
+    const double *data = block.m_data.data() + (size_t)cell * m_bandIds.size();
+    for (size_t b = 0; b < m_bandIds.size(); ++b)
+        point.setField(m_bandIds[b], data[b]);
+    m_index++;
 
     return true;
 }
@@ -230,6 +363,8 @@ bool GDALReader::processOne(PointRef& point)
 void GDALReader::done(PointTableRef table)
 {
     m_raster->close();
+    m_threadRasters.clear();
+    m_blocks.clear();
 }
 
 } // namespace pdal
@@ -67,16 +67,44 @@ private:
     virtual QuickInfo inspect();
     virtual void addArgs(ProgramArgs& args);
 
+    // A window of the raster, usually one of its blocks.
+    struct Block
+    {
+        int m_column;
+        int m_row;
+        int m_width;
+        int m_height;
+        // Band values of the cells of the block.
+        std::vector<double> m_data;
+        // Index of the cells of the block that become points.
+        std::vector<uint32_t> m_cells;
+    };
+
+    void readBlocks();
+    void readBlock(gdal::Raster& raster, size_t blockNum, Block& block);
+
     std::unique_ptr<gdal::Raster> m_raster;
+    // Additional handles to the raster, for reading on several threads.
+    std::vector<std::unique_ptr<gdal::Raster>> m_threadRasters;
     std::vector<Dimension::Type> m_bandTypes;
     std::vector<Dimension::Id> m_bandIds;
     std::string m_header;
     int m_width;
     int m_height;
     bool m_useMemoryCopy;
+    int m_threads;
+    bool m_skipNoData;
     point_count_t m_index;
-    int m_row;
-    int m_col;
+
+    int m_blockWidth;
+    int m_blockHeight;
+    size_t m_blockCount;
+    size_t m_nextBlock;
+    std::vector<Block> m_blocks;
+    size_t m_blockIdx;
+    size_t m_cellIdx;
+    std::vector<double> m_noData;
+    std::vector<bool> m_hasNoData;
 
     BOX3D m_bounds;
     StringList m_dimNames;
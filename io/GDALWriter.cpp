@@ -54,6 +54,15 @@ static StaticPluginInfo const s_info
 
 CREATE_STATIC_STAGE(GDALWriter, s_info)
 
+namespace
+{
+
+// Raster bands in the order in which they're written.
+const std::vector<std::string> bandNames
+    { "min", "max", "mean", "idw", "count", "stdev" };
+
+} // unnamed namespace
+
 std::string GDALWriter::getName() const
 {
     return s_info.name;
@@ -89,6 +98,11 @@ void GDALWriter::addArgs(ProgramArgs& args)
         m_width);
     m_heightArg = &args.add("height", "Number of cells in the Y direction.",
         m_height);
+    args.add("threads", "Number of threads used to bin points", m_threads, 1);
+    args.add("tile_height", "Number of rows binned and written at a time. "
+        "If 0, the whole raster is held in memory.", m_tileHeight);
+    args.add("overviews", "How overviews are built ('aggregate', "
+        "'resample' or 'none')", m_overviews);
 }
 
 
@@ -121,6 +135,21 @@ void GDALWriter::initialize()
     if (!m_radiusArg->set())
         m_radius = m_edgeLength * sqrt(2.0);
 
+    if (m_threads < 1)
+        throwError("Option 'threads' must be at least 1.");
+
+    // Cloud-optimized GeoTIFFs get overviews aggregated from the grid
+    // unless they're written in tiles.
+    if (m_overviews.empty())
+        m_overviews = (Utils::iequals(m_drivername, "COG") && !m_tileHeight) ?
+            "aggregate" : "none";
+    if (m_overviews != "aggregate" && m_overviews != "resample" &&
+        m_overviews != "none")
+        throwError("Invalid value for option 'overviews': '" +
+            m_overviews + "'.");
+    if (m_overviews == "aggregate" && m_tileHeight)
+        throwError("Can't aggregate overviews when 'tile_height' is set.");
+
     int args = 0;
     if (m_xOriginArg->set())
         args |= 1;
@@ -172,7 +201,12 @@ void GDALWriter::readyFile(const std::string& filename,
     m_outputFilename = filename;
     m_srs = srs;
     m_grid.reset();
-    if (m_fixedGrid)
+    m_xs.clear();
+    m_ys.clear();
+    m_zs.clear();
+    m_tileBounds.clear();
+    // When writing tiles, the grid is created once all points are known.
+    if (m_fixedGrid && !m_tileHeight)
         createGrid(m_bounds.to2d());
 }
 
@@ -203,10 +237,12 @@ void GDALWriter::createGrid(BOX2D bounds)
     m_origin = { bounds.minx, bounds.miny };
     Cell c = cell(bounds.maxx, bounds.maxy);
 
+    // When writing tiles, rows are held by the grid as they're needed.
     try
     {
         m_grid.reset(new GDALGrid(c.x + 1, c.y + 1, m_edgeLength,
-            m_radius, m_outputTypes, m_windowSize, m_power));
+            m_radius, m_outputTypes, m_windowSize, m_power,
+            0, m_tileHeight ? 0 : c.y + 1));
     }
     catch (GDALGrid::error& err)
     {
@@ -253,7 +289,7 @@ void GDALWriter::writeView(const PointViewPtr view)
     // When we're running in standard mode, it's better to get the bounds and
     // expand once, rather than have to do this for every point, since an
     // expansion causes data to move.
-    if (!m_fixedGrid)
+    if (!m_fixedGrid && !m_tileHeight)
     {
         BOX2D bounds;
         calculateBounds(*view, bounds);
@@ -263,6 +299,23 @@ void GDALWriter::writeView(const PointViewPtr view)
             expandGrid(bounds);
     }
 
+    if (m_threads > 1 && !m_tileHeight)
+    {
+        std::vector<double> xs(view->size());
+        std::vector<double> ys(view->size());
+        std::vector<double> zs(view->size());
+        for (PointId idx = 0; idx < view->size(); ++idx)
+        {
+            xs[idx] = view->getFieldAs<double>(Dimension::Id::X, idx) -
+                m_origin.x;
+            ys[idx] = view->getFieldAs<double>(Dimension::Id::Y, idx) -
+                m_origin.y;
+            zs[idx] = view->getFieldAs<double>(m_interpDim, idx);
+        }
+        m_grid->addPoints(xs, ys, zs, m_threads);
+        return;
+    }
+
     PointRef point(*view, 0);
     for (PointId idx = 0; idx < view->size(); ++idx)
     {
@@ -278,6 +331,16 @@ bool GDALWriter::processOne(PointRef& point)
     double y = point.getFieldAs<double>(Dimension::Id::Y);
     double z = point.getFieldAs<double>(m_interpDim);
 
+    // When writing tiles, points are binned once they've all been read.
+    if (m_tileHeight)
+    {
+        m_xs.push_back(x);
+        m_ys.push_back(y);
+        m_zs.push_back(z);
+        m_tileBounds.grow(x, y);
+        return true;
+    }
+
     if (m_expandByPoint)
     {
         Cell c = cell(x, y);
@@ -297,6 +360,9 @@ bool GDALWriter::processOne(PointRef& point)
 
 void GDALWriter::doneFile()
 {
+    if (m_tileHeight && (m_fixedGrid || m_xs.size()))
+        createGrid(m_fixedGrid ? m_bounds.to2d() : m_tileBounds);
+
     if (!m_grid)
         throw pdal_error("Unable to write GDAL data with no points "
             "for output.");
@@ -311,40 +377,159 @@ void GDALWriter::doneFile()
     pixelToPos[5] = -m_edgeLength;
     gdal::Raster raster(m_outputFilename, m_drivername, m_srs, pixelToPos);
 
-    m_grid->finalize();
-
     gdal::GDALError err = raster.open(m_grid->width(), m_grid->height(),
         m_grid->numBands(), m_dataType, m_noData, m_options);
 
     if (err != gdal::GDALError::None)
         throwError(raster.errorMsg());
-    int bandNum = 1;
 
-    // Perhaps the grid should return an iterator, which would work as well.
-    double *src;
-    src = m_grid->data("min");
+    if (m_tileHeight)
+        writeTiles(raster);
+    else
+    {
+        m_grid->finalize(m_threads);
+        writeRows(raster, 0, m_grid->height());
+    }
+    writeOverviews(raster);
+
+    if (raster.flush() != gdal::GDALError::None)
+        throwError(raster.errorMsg());
+
+    getMetadata().addList("filename", m_filename);
+}
+
+
+// Bin, finalize and write the grid a strip of rows at a time.  A strip
+// holds extra rows on each side so that cells can be filled from
+// neighbors in other strips.  Points are binned into every strip whose
+// rows they can reach, in the order in which they were read, so the
+// raster is the same as when the whole grid is held in memory.
+void GDALWriter::writeTiles(gdal::Raster& raster)
+{
+    size_t height = m_grid->height();
+
+    // Strips are written as whole blocks.
+    size_t blockHeight = (size_t)(std::max)(raster.blockHeight(1), 1);
+    size_t tileHeight =
+        ((m_tileHeight + blockHeight - 1) / blockHeight) * blockHeight;
+
+    // Sort the points by the row in which they fall, keeping points in
+    // the same row in order.  Points a long way from the grid are put in
+    // the first or last bucket.  The extra rows of reach cover rounding.
+    long reach = (long)std::ceil(m_radius / m_edgeLength) + 2;
+    long lastBucket = (long)height + (2 * reach) + 1;
+    auto bucket = [this, height, reach, lastBucket](double y)
+    {
+        double row = height - ((y - m_origin.y) / m_edgeLength) - 1 +
+            reach + 1;
+        row = (std::max)(0.0, (std::min)(row, (double)lastBucket));
+        return (size_t)row;
+    };
+
+    std::vector<size_t> offsets(lastBucket + 2);
+    for (double y : m_ys)
+        offsets[bucket(y) + 1]++;
+    for (size_t i = 1; i < offsets.size(); ++i)
+        offsets[i] += offsets[i - 1];
+    std::vector<PointId> ids(m_ys.size());
+    std::vector<size_t> pos(offsets);
+    for (PointId idx = 0; idx < m_ys.size(); ++idx)
+        ids[pos[bucket(m_ys[idx])]++] = idx;
+
+    std::vector<double> xs;
+    std::vector<double> ys;
+    std::vector<double> zs;
+    for (size_t first = 0; first < height; first += tileHeight)
+    {
+        size_t last = (std::min)(height, first + tileHeight);
+        size_t heldFirst = first > m_windowSize ? first - m_windowSize : 0;
+        size_t heldLast = (std::min)(height, last + m_windowSize);
+
+        // Points in buckets for rows heldFirst - reach through
+        // heldLast + reach - 1 can reach the held rows.
+        auto begin = ids.begin() + offsets[heldFirst + 1];
+        auto end = ids.begin() + offsets[heldLast + (2 * reach) + 1];
+        std::vector<PointId> tileIds(begin, end);
+        std::sort(tileIds.begin(), tileIds.end());
+
+        xs.resize(tileIds.size());
+        ys.resize(tileIds.size());
+        zs.resize(tileIds.size());
+        for (size_t i = 0; i < tileIds.size(); ++i)
+        {
+            PointId idx = tileIds[i];
+            xs[i] = m_xs[idx] - m_origin.x;
+            ys[i] = m_ys[idx] - m_origin.y;
+            zs[i] = m_zs[idx];
+        }
+
+        m_grid->setRows(heldFirst, heldLast - heldFirst);
+        m_grid->addPoints(xs, ys, zs, m_threads);
+        m_grid->finalize(m_threads);
+        writeRows(raster, first, last - first);
+    }
+}
+
+
+void GDALWriter::writeRows(gdal::Raster& raster, size_t firstRow,
+    size_t numRows)
+{
+    // Band names are set when the first rows are written.
     double srcNoData = std::numeric_limits<double>::quiet_NaN();
-    if (src && err == gdal::GDALError::None)
-        err = raster.writeBand(src, srcNoData, bandNum++, "min");
-    src = m_grid->data("max");
-    if (src && err == gdal::GDALError::None)
-        err = raster.writeBand(src, srcNoData, bandNum++, "max");
-    src = m_grid->data("mean");
-    if (src && err == gdal::GDALError::None)
-        err = raster.writeBand(src, srcNoData, bandNum++, "mean");
-    src = m_grid->data("idw");
-    if (src && err == gdal::GDALError::None)
-        err = raster.writeBand(src, srcNoData, bandNum++, "idw");
-    src = m_grid->data("count");
-    if (src && err == gdal::GDALError::None)
-        err = raster.writeBand(src, srcNoData, bandNum++, "count");
-    src = m_grid->data("stdev");
-    if (src && err == gdal::GDALError::None)
-        err = raster.writeBand(src, srcNoData, bandNum++, "stdev");
+    size_t offset = (firstRow - m_grid->firstRow()) * m_grid->width();
+    int bandNum = 1;
+    gdal::GDALError err = gdal::GDALError::None;
+    for (const std::string& name : bandNames)
+    {
+        double *src = m_grid->data(name);
+        if (src && err == gdal::GDALError::None)
+            err = raster.writeBandRows(src + offset, srcNoData, bandNum++,
+                (int)firstRow, (int)numRows, firstRow == 0 ? name : "");
+    }
+    if (err != gdal::GDALError::None)
+        throwError(raster.errorMsg());
+}
+
+
+// Overviews are built until an overview fits in a 256 cell square.
+void GDALWriter::writeOverviews(gdal::Raster& raster)
+{
+    if (m_overviews == "none")
+        return;
+
+    size_t size = (std::max)(m_grid->width(), m_grid->height());
+    std::vector<int> factors;
+    for (size_t factor = 2; (size + factor / 2 - 1) / (factor / 2) > 256;
+            factor *= 2)
+        factors.push_back((int)factor);
+
+    gdal::GDALError err = raster.buildOverviews(
+        m_overviews == "resample" ? "AVERAGE" : "NONE", factors);
     if (err != gdal::GDALError::None)
         throwError(raster.errorMsg());
+    if (m_overviews == "resample")
+        return;
 
-    getMetadata().addList("filename", m_filename);
+    // Aggregated overviews are computed from the cells of the grid
+    // rather than from the values written to the raster.
+    double srcNoData = std::numeric_limits<double>::quiet_NaN();
+    std::vector<double> data;
+    for (size_t level = 0; level < factors.size(); ++level)
+    {
+        size_t factor = (size_t)factors[level];
+        int height = (int)((m_grid->height() + factor - 1) / factor);
+        int bandNum = 1;
+        for (const std::string& name : bandNames)
+        {
+            if (!m_grid->data(name))
+                continue;
+            m_grid->overview(name, factor, data, m_threads);
+            err = raster.writeBandRows(data.data(), srcNoData, bandNum++,
+                0, height, "", (int)level + 1);
+            if (err != gdal::GDALError::None)
+                throwError(raster.errorMsg());
+        }
+    }
 }
 
 } // namespace pdal
@@ -44,6 +44,10 @@ namespace pdal
 {
 
 class GDALGrid;
+namespace gdal
+{
+    class Raster;
+}
 
 class PDAL_DLL GDALWriter : public FlexWriter, public Streamable
 {
@@ -75,6 +79,9 @@ private:
     virtual void doneFile();
     void createGrid(BOX2D bounds);
     void expandGrid(BOX2D bounds);
+    void writeTiles(gdal::Raster& raster);
+    void writeRows(gdal::Raster& raster, size_t firstRow, size_t numRows);
+    void writeOverviews(gdal::Raster& raster);
     Cell cell(double x, double y);
     long width() const;
     long height() const;
@@ -107,6 +114,13 @@ private:
     Dimension::Type m_dataType;
     bool m_expandByPoint;
     bool m_fixedGrid;
+    int m_threads;
+    size_t m_tileHeight;
+    std::string m_overviews;
+    std::vector<double> m_xs;
+    std::vector<double> m_ys;
+    std::vector<double> m_zs;
+    BOX2D m_tileBounds;
 };
 
 }
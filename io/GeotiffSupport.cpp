@@ -34,6 +34,7 @@
 
 #include "GeotiffSupport.hpp"
 
+#include <mutex>
 #include <sstream>
 
 #include <geo_normalize.h>
@@ -57,6 +58,12 @@ namespace pdal
 namespace
 {
 
+// Translating between GeoTIFF keys and WKT looks up shared tables that
+// aren't thread-safe, so only one translation is made at a time.  The
+// simple tags and GTIF handles of a context belong to it alone and need
+// no lock.
+std::mutex s_geotiffMutex;
+
 struct GeotiffCtx
 {
 public:
@@ -142,6 +149,7 @@ GeotiffSrs::GeotiffSrs(const std::vector<uint8_t>& directoryRec,
         throw Geotiff::error("Couldn't create Geotiff tags from "
             "Geotiff definition.");
 
+    std::lock_guard<std::mutex> lock(s_geotiffMutex);
     GTIFDefn sGTIFDefn;
     if (GTIFGetDefn(ctx.gtiff, &sGTIFDefn))
     {
@@ -191,8 +199,11 @@ GeotiffTags::GeotiffTags(const SpatialReference& srs)
     ctx.gtiff = GTIFNewSimpleTags(ctx.tiff);
 
     // Set tiff tags from WKT
-    if (!GTIFSetFromOGISDefn(ctx.gtiff, srs.getWKT().c_str()))
-        throw Geotiff::error("Could not set m_gtiff from WKT");
+    {
+        std::lock_guard<std::mutex> lock(s_geotiffMutex);
+        if (!GTIFSetFromOGISDefn(ctx.gtiff, srs.getWKT().c_str()))
+            throw Geotiff::error("Could not set m_gtiff from WKT");
+    }
     GTIFWriteKeys(ctx.gtiff);
 
     auto sizeFromType = [](int type, int count) -> size_t
@@ -34,11 +34,16 @@
 
 #include "GltfWriter.hpp"
 
+#include <array>
+#include <cmath>
+#include <cstring>
 #include <iostream>
+#include <unordered_map>
 #include <nlohmann/json.hpp>
 
 #include <pdal/PointView.hpp>
 #include <pdal/util/FileUtils.hpp>
+#include <pdal/util/Inserter.hpp>
 #include <pdal/util/OStream.hpp>
 
 namespace pdal
@@ -49,6 +54,33 @@ namespace
     const size_t HeaderSize = 12;
     const size_t JsonChunkDataSize = 5000;
     const size_t ChunkHeaderSize = 8;
+
+    // glTF component type codes.
+    const int ByteType = 5120;
+    const int UnsignedShortType = 5123;
+    const int UnsignedIntType = 5125;
+    const int FloatType = 5126;
+
+    // Largest quantized position value.
+    const double PositionScale = 65535.0;
+
+    // Vertices are identified by the bits of their position and normal so
+    // that points with the same values share a vertex.
+    using VertexKey = std::array<uint32_t, 6>;
+
+    struct VertexHash
+    {
+        size_t operator()(const VertexKey& k) const
+        {
+            size_t h = 0;
+            for (uint32_t v : k)
+                h = h * 1000003 ^ v;
+            return h;
+        }
+    };
+
+    size_t pad4(size_t size)
+        { return (size + 3) & ~(size_t)3; }
 }
 
 struct GltfWriter::ViewData
@@ -57,9 +89,12 @@ struct GltfWriter::ViewData
     size_t m_indexOffset;
     size_t m_indexByteLength;
     size_t m_indexCount;
+    int m_indexType;
     size_t m_vertexOffset;
     size_t m_vertexByteLength;
     size_t m_vertexCount;
+    size_t m_normalOffset;
+    size_t m_normalByteLength;
 };
 
 static StaticPluginInfo const s_info
@@ -85,6 +120,8 @@ void GltfWriter::addArgs(ProgramArgs& args)
     args.add("alpha", "Alpha factor [0-1]", m_alpha, 1.0);
     args.add("double_sided", "Whether the material should be applied to "
         "both sides of the faces.", m_doubleSided);
+    args.add("quantize", "Store positions and normals as integers "
+        "(KHR_mesh_quantization)", m_quantize);
 }
 
 
@@ -112,35 +149,157 @@ void GltfWriter::write(const PointViewPtr v)
         return;
     }
 
-    OLeStream& out = *m_stream;
+    const bool hasNormals = v->hasDim(Dimension::Id::NormalX) &&
+        v->hasDim(Dimension::Id::NormalY) &&
+        v->hasDim(Dimension::Id::NormalZ);
+
+    // Only points used by the mesh become vertices, and points with the
+    // same position and normal share one.  Vertices are numbered in the
+    // order the faces first use them so that consecutive faces fetch
+    // nearby vertex data.
+    const uint32_t Unassigned = (std::numeric_limits<uint32_t>::max)();
+    std::vector<uint32_t> remap(v->size(), Unassigned);
+    std::unordered_map<VertexKey, uint32_t, VertexHash> unique;
+    std::vector<float> positions;
+    std::vector<float> normals;
+    std::vector<uint32_t> indices;
+    indices.reserve(mesh->size() * 3);
 
     ViewData vd;
-    vd.m_indexCount = mesh->size() * 3;
-    vd.m_vertexCount = v->size();
+    auto vertex = [&](PointId id)
+    {
+        if (id >= v->size())
+            throwError("Mesh references a point that isn't in the view.");
+        uint32_t& r = remap[id];
+        if (r != Unassigned)
+            return r;
+
+        float f[6] {};
+        f[0] = v->getFieldAs<float>(Dimension::Id::X, id);
+        f[1] = v->getFieldAs<float>(Dimension::Id::Y, id);
+        f[2] = v->getFieldAs<float>(Dimension::Id::Z, id);
+        if (hasNormals)
+        {
+            f[3] = v->getFieldAs<float>(Dimension::Id::NormalX, id);
+            f[4] = v->getFieldAs<float>(Dimension::Id::NormalY, id);
+            f[5] = v->getFieldAs<float>(Dimension::Id::NormalZ, id);
+        }
+
+        VertexKey key;
+        std::memcpy(key.data(), f, sizeof(f));
+        auto it = unique.insert({ key, (uint32_t)unique.size() });
+        if (it.second)
+        {
+            positions.insert(positions.end(), f, f + 3);
+            if (hasNormals)
+                normals.insert(normals.end(), f + 3, f + 6);
+            vd.m_bounds.grow(f[0], f[1], f[2]);
+        }
+        r = it.first->second;
+        return r;
+    };
+
+    mesh->forEach([&](PointId ia, PointId ib, PointId ic)
+    {
+        uint32_t a = vertex(ia);
+        uint32_t b = vertex(ib);
+        uint32_t c = vertex(ic);
+
+        // Faces whose vertices were merged have no area.
+        if (a == b || b == c || a == c)
+            return;
+        indices.push_back(a);
+        indices.push_back(b);
+        indices.push_back(c);
+    });
+    remap.clear();
+
+    vd.m_vertexCount = positions.size() / 3;
+    vd.m_indexCount = indices.size();
+    // 65535 is reserved as the primitive restart value.
+    vd.m_indexType = vd.m_vertexCount < 65535 ? UnsignedShortType :
+        UnsignedIntType;
     vd.m_indexOffset = m_binSize;
-    vd.m_indexByteLength = vd.m_indexCount * sizeof(uint32_t);
-    vd.m_vertexOffset = vd.m_indexOffset + vd.m_indexByteLength;
-    vd.m_vertexByteLength = v->size() * sizeof(float) * 3;  // 3 for X,Y,Z
+    vd.m_indexByteLength = pad4(vd.m_indexCount *
+        (vd.m_indexType == UnsignedShortType ? sizeof(uint16_t) :
+            sizeof(uint32_t)));
 
-    m_binSize += vd.m_indexByteLength + vd.m_vertexByteLength;
-    m_totalSize = static_cast<size_t>(out.position()) + m_binSize;
+    // Quantized attributes are padded to four bytes per element as
+    // vertex attribute strides must be multiples of four.
+    vd.m_vertexOffset = vd.m_indexOffset + vd.m_indexByteLength;
+    vd.m_vertexByteLength = vd.m_vertexCount *
+        (m_quantize ? 4 * sizeof(uint16_t) : 3 * sizeof(float));
+    vd.m_normalOffset = vd.m_vertexOffset + vd.m_vertexByteLength;
+    vd.m_normalByteLength = !hasNormals ? 0 : vd.m_vertexCount *
+        (m_quantize ? 4 * sizeof(int8_t) : 3 * sizeof(float));
+
+    m_binSize = vd.m_normalOffset + vd.m_normalByteLength;
+    m_totalSize = static_cast<size_t>(m_stream->position()) + m_binSize;
     if (m_totalSize > (std::numeric_limits<uint32_t>::max)())
         throwError("Data too large for file.");
 
-    for (const Triangle& t : *mesh)
-        out << (uint32_t)t.m_a << (uint32_t)t.m_b << (uint32_t)t.m_c;
+    writeView(vd, indices, positions, normals);
+    m_viewData.push_back(vd);
+}
+
 
-    for (PointId i = 0; i < v->size(); ++i)
+// Write the binary data of a view with a single write.
+void GltfWriter::writeView(const ViewData& vd,
+    const std::vector<uint32_t>& indices, const std::vector<float>& positions,
+    const std::vector<float>& normals)
+{
+    std::vector<char> buf(m_binSize - vd.m_indexOffset);
+    LeInserter ins(buf.data(), buf.size());
+
+    if (vd.m_indexType == UnsignedShortType)
+        for (uint32_t i : indices)
+            ins << (uint16_t)i;
+    else
+        for (uint32_t i : indices)
+            ins << i;
+
+    ins.seek(vd.m_vertexOffset - vd.m_indexOffset);
+    if (m_quantize)
     {
-        float x = v->getFieldAs<float>(Dimension::Id::X, i);
-        float y = v->getFieldAs<float>(Dimension::Id::Y, i);
-        float z = v->getFieldAs<float>(Dimension::Id::Z, i);
+        // Positions are stored relative to the minimum of the bounds and
+        // scaled so that the bounds span the range of uint16_t.  The
+        // node's matrix undoes the scaling.
+        const BOX3D& b = vd.m_bounds;
+        const double min[3] { b.minx, b.miny, b.minz };
+        const double extent[3]
+            { b.maxx - b.minx, b.maxy - b.miny, b.maxz - b.minz };
+        for (size_t i = 0; i < positions.size(); i += 3)
+        {
+            for (size_t d = 0; d < 3; ++d)
+            {
+                double q = extent[d] > 0 ?
+                    (positions[i + d] - min[d]) / extent[d] * PositionScale :
+                    0;
+                ins << (uint16_t)std::lround(q);
+            }
+            ins << (uint16_t)0;
+        }
 
-        vd.m_bounds.grow(x, y, z);
-        out << x << y << z;
+        // Normals are normalized bytes.
+        for (size_t i = 0; i < normals.size(); i += 3)
+        {
+            double len = std::sqrt(normals[i] * normals[i] +
+                normals[i + 1] * normals[i + 1] +
+                normals[i + 2] * normals[i + 2]);
+            for (size_t d = 0; d < 3; ++d)
+                ins << (int8_t)(len > 0 ?
+                    std::lround(normals[i + d] / len * 127.0) : 0);
+            ins << (int8_t)0;
+        }
     }
-
-    m_viewData.push_back(vd);
+    else
+    {
+        for (float f : positions)
+            ins << f;
+        for (float f : normals)
+            ins << f;
+    }
+    m_stream->put(buf.data(), buf.size());
 }
 
 
@@ -178,9 +337,23 @@ void GltfWriter::writeJsonChunk()
         }
     );
 
+    if (m_quantize)
+    {
+        j["extensionsUsed"].push_back("KHR_mesh_quantization");
+        j["extensionsRequired"].push_back("KHR_mesh_quantization");
+    }
+
+    NL::json scene;
+    scene["nodes"] = NL::json::array();
+    j["scenes"].push_back(scene);
+
     int bufferViewCount = 0;
+    int accessorCount = 0;
     for (const ViewData& vd : m_viewData)
     {
+        const BOX3D& b = vd.m_bounds;
+        NL::json attributes;
+
         j["bufferViews"].push_back(
             {
                 { "buffer", 0 },
@@ -189,59 +362,110 @@ void GltfWriter::writeJsonChunk()
                 { "target", 34963 }      // Vertex indices code
             }
         );
-        j["bufferViews"].push_back(
-            {
-                { "buffer", 0 },
-                { "byteOffset", vd.m_vertexOffset },
-                { "byteLength", vd.m_vertexByteLength },
-                { "target", 34962 }      // Vertices code
-            }
-        );
         j["accessors"].push_back(
             {
                 { "bufferView", bufferViewCount++ },
-                { "componentType", 5125 },      // unsigned int code
+                { "componentType", vd.m_indexType },
                 { "type", "SCALAR" },
                 { "count", vd.m_indexCount }
             }
         );
-        const BOX3D& b = vd.m_bounds;
-        j["accessors"].push_back(
+        int indices = accessorCount++;
+
+        NL::json positionView
+            {
+                { "buffer", 0 },
+                { "byteOffset", vd.m_vertexOffset },
+                { "byteLength", vd.m_vertexByteLength },
+                { "target", 34962 }      // Vertices code
+            };
+        NL::json position
             {
                 { "bufferView", bufferViewCount++ },
-                { "componentType", 5126 },      // float code
                 { "type", "VEC3" },
-                { "count", vd.m_vertexCount },
-                { "min", { b.minx, b.miny, b.minz } },
-                { "max", { b.maxx, b.maxy, b.maxz } }
-            }
-        );
-    }
+                { "count", vd.m_vertexCount }
+            };
+        if (m_quantize)
+        {
+            auto qmax = [](double extent) { return extent > 0 ? 65535 : 0; };
 
-    NL::json mesh;
-    mesh["primitives"].push_back(
+            positionView["byteStride"] = 4 * sizeof(uint16_t);
+            position["componentType"] = UnsignedShortType;
+            position["min"] = { 0, 0, 0 };
+            position["max"] = { qmax(b.maxx - b.minx), qmax(b.maxy - b.miny),
+                qmax(b.maxz - b.minz) };
+        }
+        else
         {
-            { "attributes", {{"POSITION", 1}} },
-            { "indices", 0 },
-            { "material", 0 }
+            position["componentType"] = FloatType;
+            position["min"] = { b.minx, b.miny, b.minz };
+            position["max"] = { b.maxx, b.maxy, b.maxz };
         }
-    );
+        j["bufferViews"].push_back(positionView);
+        j["accessors"].push_back(position);
+        attributes["POSITION"] = accessorCount++;
 
-    j["meshes"].push_back(mesh);
-    j["scene"] = 0;
-
-    j["nodes"].push_back(
+        if (vd.m_normalByteLength)
         {
-            { "mesh", 0 },
-            { "matrix", { 1, 0, 0, 0, 0, 0, -1, 0, 0, 1, 0, 0, 0, 0, 0, 1 } }
+            NL::json normalView
+                {
+                    { "buffer", 0 },
+                    { "byteOffset", vd.m_normalOffset },
+                    { "byteLength", vd.m_normalByteLength },
+                    { "target", 34962 }      // Vertices code
+                };
+            NL::json normal
+                {
+                    { "bufferView", bufferViewCount++ },
+                    { "type", "VEC3" },
+                    { "count", vd.m_vertexCount }
+                };
+            if (m_quantize)
+            {
+                normalView["byteStride"] = 4 * sizeof(int8_t);
+                normal["componentType"] = ByteType;
+                normal["normalized"] = true;
+            }
+            else
+                normal["componentType"] = FloatType;
+            j["bufferViews"].push_back(normalView);
+            j["accessors"].push_back(normal);
+            attributes["NORMAL"] = accessorCount++;
         }
-    );
 
-    j["scenes"].push_back(
+        NL::json mesh;
+        mesh["primitives"].push_back(
+            {
+                { "attributes", attributes },
+                { "indices", indices },
+                { "material", 0 }
+            }
+        );
+        j["meshes"].push_back(mesh);
+
+        // The matrix rotates Z up to the Y up of glTF.  Quantized
+        // positions are also scaled and offset back to their values.
+        std::vector<double> matrix
+            { 1, 0, 0, 0, 0, 0, -1, 0, 0, 1, 0, 0, 0, 0, 0, 1 };
+        if (m_quantize)
         {
-            { "nodes", { 0 } }
+            auto scale = [](double extent)
+                { return extent > 0 ? extent / PositionScale : 1.0; };
+
+            matrix = { scale(b.maxx - b.minx), 0, 0, 0,
+                0, 0, -scale(b.maxy - b.miny), 0,
+                0, scale(b.maxz - b.minz), 0, 0,
+                b.minx, b.minz, -b.miny, 1 };
         }
-    );
+        j["scenes"][0]["nodes"].push_back(j["nodes"].size());
+        j["nodes"].push_back(
+            {
+                { "mesh", j["meshes"].size() - 1 },
+                { "matrix", matrix }
+            }
+        );
+    }
+    j["scene"] = 0;
 
     // This seems very crude.  But I'm not sure we can do much else at this
     // point.
@@ -65,6 +65,8 @@ private:
     void writeGltfHeader();
     void writeJsonChunk();
     void writeBinHeader();
+    void writeView(const ViewData& vd, const std::vector<uint32_t>& indices,
+        const std::vector<float>& positions, const std::vector<float>& normals);
 
     std::string m_filename;
     std::unique_ptr<OLeStream> m_stream;
@@ -79,6 +81,7 @@ private:
     double m_blue;
     double m_alpha;
     bool m_doubleSided;
+    bool m_quantize;
 };
 
 } // namespace pdal
@@ -39,6 +39,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstring>
 
 namespace pdal
 {
@@ -137,21 +138,50 @@ void Ilvis2Reader::initialize(PointTableRef)
 }
 
 
+namespace
+{
+
+bool convertField(const textparse::Field& f, double& d)
+{
+    return textparse::toDouble(f.m_begin, f.m_end, d);
+}
+
+
+bool convertField(const textparse::Field& f, unsigned& u)
+{
+    return textparse::toUnsigned(f.m_begin, f.m_end, u);
+}
+
+} // unnamed namespace
+
+
 template <typename T>
-T convert(const StringList& s, const std::string& name, size_t fieldno)
+T convert(const textparse::FieldList& s, const std::string& name,
+    size_t fieldno)
 {
     T output;
-    if (!Utils::fromString(s[fieldno], output))
+    if (!convertField(s[fieldno], output))
         throw Ilvis2Reader::error("Unable to convert " + name +
-            ", " + s[fieldno] + ", to double");
+            ", " + std::string(s[fieldno].m_begin, s[fieldno].m_end) +
+            ", to double");
 
     return output;
 }
 
 
-void Ilvis2Reader::readPoint(PointRef& point, StringList s,
-    std::string pointMap)
+void Ilvis2Reader::readPoint(PointRef& point, bool high)
 {
+    const textparse::FieldList& s = m_fields;
+
+    double lonLow =
+        Utils::normalizeLongitude(convert<double>(s, "LONGITUDE_LOW", 6));
+    double latLow = convert<double>(s, "LATITUDE_LOW", 7);
+    double elevLow = convert<double>(s, "ELEVATION_LOW", 8);
+    double lonHigh =
+        Utils::normalizeLongitude(convert<double>(s, "LONGITUDE_HIGH", 9));
+    double latHigh = convert<double>(s, "LATITUDE_HIGH", 10);
+    double elevHigh = convert<double>(s, "ELEVATION_HIGH", 11);
+
     point.setField(pdal::Dimension::Id::LvisLfid,
         convert<unsigned>(s, "LVIS_LFID", 0));
     point.setField(pdal::Dimension::Id::ShotNumber,
@@ -164,33 +194,36 @@ void Ilvis2Reader::readPoint(PointRef& point, StringList s,
         convert<double>(s, "LATITUDE_CENTROID", 4));
     point.setField(pdal::Dimension::Id::ElevationCentroid,
         convert<double>(s, "ELEVATION_CENTROID", 5));
-    point.setField(pdal::Dimension::Id::LongitudeLow,
-        Utils::normalizeLongitude(convert<double>(s, "LONGITUDE_LOW", 6)));
-    point.setField(pdal::Dimension::Id::LatitudeLow,
-        convert<double>(s, "LATITUDE_LOW", 7));
-    point.setField(pdal::Dimension::Id::ElevationLow,
-        convert<double>(s, "ELEVATION_LOW", 8));
-    point.setField(pdal::Dimension::Id::LongitudeHigh,
-        Utils::normalizeLongitude(convert<double>(s, "LONGITUDE_HIGH", 9)));
-    point.setField(pdal::Dimension::Id::LatitudeHigh,
-        convert<double>(s, "LATITUDE_HIGH", 10));
-    point.setField(pdal::Dimension::Id::ElevationHigh,
-        convert<double>(s, "ELEVATION_HIGH", 11));
-
-    double x, y, z;
-    pdal::Dimension::Id xd, yd, zd;
-
-    xd = m_layout->findDim("LONGITUDE_" + pointMap);
-    yd = m_layout->findDim("LATITUDE_" + pointMap);
-    zd = m_layout->findDim("ELEVATION_" + pointMap);
-
-    x = point.getFieldAs<double>(xd);
-    y = point.getFieldAs<double>(yd);
-    z = point.getFieldAs<double>(zd);
-
-    point.setField(pdal::Dimension::Id::X, x);
-    point.setField(pdal::Dimension::Id::Y, y);
-    point.setField(pdal::Dimension::Id::Z, z);
+    point.setField(pdal::Dimension::Id::LongitudeLow, lonLow);
+    point.setField(pdal::Dimension::Id::LatitudeLow, latLow);
+    point.setField(pdal::Dimension::Id::ElevationLow, elevLow);
+    point.setField(pdal::Dimension::Id::LongitudeHigh, lonHigh);
+    point.setField(pdal::Dimension::Id::LatitudeHigh, latHigh);
+    point.setField(pdal::Dimension::Id::ElevationHigh, elevHigh);
+
+    point.setField(pdal::Dimension::Id::X, high ? lonHigh : lonLow);
+    point.setField(pdal::Dimension::Id::Y, high ? latHigh : latLow);
+    point.setField(pdal::Dimension::Id::Z, high ? elevHigh : elevLow);
+}
+
+
+// Find the next line of text, reading another block of lines if needed.
+bool Ilvis2Reader::nextLine(const char *& begin, const char *& end)
+{
+    textparse::Chunk& c = m_chunks[0];
+    while (m_pos >= c.m_end)
+    {
+        if (!m_lines->next(m_chunks))
+            return false;
+        m_pos = c.m_begin;
+    }
+    begin = m_pos;
+    end = (const char *)std::memchr(m_pos, '\n', c.m_end - m_pos);
+    if (!end)
+        end = c.m_end;
+    m_pos = end + 1;
+    m_lineNum++;
+    return true;
 }
 
 
@@ -213,19 +246,24 @@ void Ilvis2Reader::ready(PointTableRef table)
 
     m_lineNum = 0;
     m_stream.reset(new std::ifstream(m_filename));
-    m_layout = table.layout();
     m_resample = false;
     for (size_t i = 0; i < HeaderSize; ++i)
     {
         std::getline(*m_stream, line);
         m_lineNum++;
     }
+    m_lines.reset(new textparse::LineReader(*m_stream));
+    m_chunks.assign(1, textparse::Chunk());
+    m_chunks[0].m_begin = nullptr;
+    m_chunks[0].m_end = nullptr;
+    m_pos = nullptr;
 }
 
 
 bool Ilvis2Reader::processOne(PointRef& point)
 {
-    std::string line;
+    const char *begin;
+    const char *end;
 
 // Format:
 // LVIS_LFID SHOTNUMBER TIME LONGITUDE_CENTROID LATITUDE_CENTROID ELEVATION_CENTROID LONGITUDE_LOW LATITUDE_LOW ELEVATION_LOW LONGITUDE_HIGH LATITUDE_HIGH ELEVATION_HIGH
@@ -236,14 +274,14 @@ bool Ilvis2Reader::processOne(PointRef& point)
         // an "ALL" mapping and the high and low elevations are different.
         if (m_resample)
         {
-            readPoint(point, m_fields, "HIGH");
+            readPoint(point, true);
             m_resample = false;
             return true;
         }
 
-        if (!std::getline(*m_stream, line))
+        if (!nextLine(begin, end))
             return false;
-        m_fields = Utils::split2(line, ' ');
+        textparse::splitFields(begin, end, ' ', m_fields);
         if (m_fields.size() != 12)
             throwError("Invalid format for line " +
                 Utils::toString(m_lineNum) + ".  Expected 12 fields, got " +
@@ -255,7 +293,7 @@ bool Ilvis2Reader::processOne(PointRef& point)
         // write LOW point if specified, or for ALL
         if (m_mapping == IlvisMapping::LOW || m_mapping == IlvisMapping::ALL)
         {
-            readPoint(point, m_fields, "LOW");
+            readPoint(point, false);
             // If we have ALL mapping and the high elevation is different
             // from that of the low elevation, we'll a second point with the
             // high elevation.
@@ -263,7 +301,7 @@ bool Ilvis2Reader::processOne(PointRef& point)
                 m_resample = true;
         }
         else if (m_mapping == IlvisMapping::HIGH)
-            readPoint(point, m_fields, "HIGH");
+            readPoint(point, true);
     }
     catch (const error& err)
     {
@@ -295,6 +333,7 @@ point_count_t Ilvis2Reader::read(PointViewPtr view, point_count_t count)
 
 void Ilvis2Reader::done(PointTableRef table)
 {
+    m_lines.reset();
     m_stream.reset();
 }
 
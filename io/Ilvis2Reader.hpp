@@ -39,6 +39,8 @@
 #include <pdal/util/IStream.hpp>
 #include <map>
 
+#include "private/TextParse.hpp"
+
 #ifndef PDAL_HAVE_LIBXML2
 namespace pdal
 {
@@ -79,10 +81,12 @@ public:
 private:
     std::unique_ptr<std::ifstream> m_stream;
     IlvisMapping m_mapping;
-    StringList m_fields;
+    std::unique_ptr<textparse::LineReader> m_lines;
+    textparse::ChunkList m_chunks;
+    const char *m_pos;
+    textparse::FieldList m_fields;
     size_t m_lineNum;
     bool m_resample;
-    PointLayoutPtr m_layout;
     std::string m_metadataFile;
     Ilvis2MetadataReader m_mdReader;
 
@@ -94,7 +98,8 @@ private:
     virtual point_count_t read(PointViewPtr view, point_count_t count);
     virtual void done(PointTableRef table);
 
-    virtual void readPoint(PointRef& point, StringList s, std::string pointMap);
+    void readPoint(PointRef& point, bool high);
+    bool nextLine(const char *& begin, const char *& end);
 };
 
 std::ostream& operator<<(std::ostream& out,
@@ -0,0 +1,316 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include "LasChunkIndex.hpp"
+
+#include <algorithm>
+#include <limits>
+
+#include <pdal/util/Extractor.hpp>
+#include <pdal/util/Inserter.hpp>
+
+namespace pdal
+{
+
+namespace LasChunkIndex
+{
+
+namespace
+{
+
+const uint32_t ChunkBoundsVersion = 1;
+const size_t ChunkBoundsEntrySize = sizeof(uint64_t) + 6 * sizeof(double);
+
+const double LOWEST = (std::numeric_limits<double>::lowest)();
+const double HIGHEST = (std::numeric_limits<double>::max)();
+
+// Extractor that makes sure the data it is asked for exists.
+class CheckedExtractor : public LeExtractor
+{
+public:
+    CheckedExtractor(const char *buf, size_t size, const std::string& what) :
+        LeExtractor(buf, size), m_size(size), m_what(what)
+    {}
+
+    void need(size_t bytes)
+    {
+        if (position() + bytes > m_size)
+            throw error("Invalid " + m_what + ": unexpected end of data.");
+    }
+
+    void signature(const std::string& expected)
+    {
+        std::string sig;
+
+        need(expected.size());
+        get(sig, expected.size());
+        if (sig != expected)
+            throw error("Invalid " + m_what + ": expected signature '" +
+                expected + "'.");
+    }
+
+private:
+    size_t m_size;
+    std::string m_what;
+};
+
+} // unnamed namespace
+
+
+ChunkList parseChunkBounds(const char *data, size_t size)
+{
+    CheckedExtractor in(data, size, "PDAL chunk bounds VLR");
+    uint32_t version;
+
+    in.need(sizeof(version));
+    in >> version;
+    if (version != ChunkBoundsVersion)
+        throw error("Unsupported PDAL chunk bounds VLR version " +
+            std::to_string(version) + ".");
+
+    ChunkList chunks;
+    PointId first = 0;
+    while (in.position() < size)
+    {
+        Chunk c;
+        BOX3D& b = c.m_bounds;
+
+        in.need(ChunkBoundsEntrySize);
+        in >> c.m_count >> b.minx >> b.miny >> b.minz >>
+            b.maxx >> b.maxy >> b.maxz;
+        c.m_first = first;
+        first += c.m_count;
+        chunks.push_back(c);
+    }
+    return chunks;
+}
+
+
+std::vector<uint8_t> chunkBoundsData(const ChunkList& chunks)
+{
+    std::vector<uint8_t> data(sizeof(uint32_t) +
+        chunks.size() * ChunkBoundsEntrySize);
+    LeInserter out(data.data(), data.size());
+
+    out << ChunkBoundsVersion;
+    for (const Chunk& c : chunks)
+    {
+        const BOX3D& b = c.m_bounds;
+        out << (uint64_t)c.m_count << b.minx << b.miny << b.minz <<
+            b.maxx << b.maxy << b.maxz;
+    }
+    return data;
+}
+
+
+// The LAX format is that written by LAStools' lasindex: a quadtree header
+// followed by the point-index intervals of each quadtree cell.
+ChunkList parseLax(const char *data, size_t size)
+{
+    CheckedExtractor in(data, size, "LAX index");
+    uint32_t version;
+
+    in.signature("LASX");
+    in.need(sizeof(version));
+    in >> version;
+
+    // Quadtree.
+    uint32_t type;
+    uint32_t levels;
+    uint32_t levelIndex;
+    uint32_t implicitLevels;
+    float minx, maxx, miny, maxy;
+
+    in.signature("LASS");
+    in.need(sizeof(type));
+    in >> type;
+    if (type != 0)
+        throw error("Unsupported LAX spatial index type " +
+            std::to_string(type) + ".");
+    in.signature("LASQ");
+    in.need(4 * sizeof(uint32_t) + 4 * sizeof(float));
+    in >> version >> levels >> levelIndex >> implicitLevels >>
+        minx >> maxx >> miny >> maxy;
+    if (levelIndex != 0 || implicitLevels != 0)
+        throw error("Tiled LAX indexes aren't supported.");
+    if (levels > 30)
+        throw error("Invalid LAX index: too many quadtree levels.");
+
+    // Cell numbers start with the root, followed by the four cells of
+    // level 1, the 16 cells of level 2 and so on.
+    std::vector<uint64_t> levelOffset(levels + 2);
+    for (uint32_t l = 0; l <= levels; ++l)
+        levelOffset[l + 1] = levelOffset[l] + ((uint64_t)1 << (2 * l));
+
+    auto cellBounds = [&](uint32_t cell)
+    {
+        uint32_t level = 0;
+        while (level < levels && cell >= levelOffset[level + 1])
+            level++;
+        uint64_t index = cell - levelOffset[level];
+
+        double cminx = minx, cmaxx = maxx, cminy = miny, cmaxy = maxy;
+        for (uint32_t l = level; l > 0; --l)
+        {
+            uint64_t quad = (index >> (2 * (l - 1))) & 3;
+            double midx = (cminx + cmaxx) / 2;
+            double midy = (cminy + cmaxy) / 2;
+            if (quad & 1)
+                cminx = midx;
+            else
+                cmaxx = midx;
+            if (quad & 2)
+                cminy = midy;
+            else
+                cmaxy = midy;
+        }
+
+        // The quadtree is computed in single precision, so allow a
+        // little slop at the cell edges.
+        double slop = (std::max)(cmaxx - cminx, cmaxy - cminy) * 1e-4;
+        return BOX3D(cminx - slop, cminy - slop, LOWEST,
+            cmaxx + slop, cmaxy + slop, HIGHEST);
+    };
+
+    // Intervals.
+    uint32_t numCells;
+    in.signature("LASV");
+    in.need(2 * sizeof(uint32_t));
+    in >> version >> numCells;
+
+    ChunkList chunks;
+    for (uint32_t i = 0; i < numCells; ++i)
+    {
+        int32_t cell;
+        uint32_t numIntervals;
+        uint32_t numPoints;
+
+        in.need(3 * sizeof(uint32_t));
+        in >> cell >> numIntervals >> numPoints;
+        BOX3D bounds = cellBounds((uint32_t)cell);
+
+        in.need((size_t)numIntervals * 2 * sizeof(uint32_t));
+        for (uint32_t j = 0; j < numIntervals; ++j)
+        {
+            uint32_t start, end;
+
+            in >> start >> end;
+            if (end < start)
+                throw error("Invalid LAX index: bad point interval.");
+            chunks.push_back({ start, (point_count_t)end - start + 1,
+                bounds });
+        }
+    }
+    return chunks;
+}
+
+
+// The COPC info VLR locates the root hierarchy page.  Each page entry is
+// either a data node, whose points make up one chunk, or a reference to a
+// child page.  Chunks are stored in the point data in the order of their
+// file offsets.
+ChunkList parseCopc(const char *info, size_t size, const FileReader& read)
+{
+    CheckedExtractor in(info, size, "COPC info VLR");
+    double centerx, centery, centerz, halfsize, spacing;
+    uint64_t rootOffset, rootSize;
+
+    in.need(5 * sizeof(double) + 2 * sizeof(uint64_t));
+    in >> centerx >> centery >> centerz >> halfsize >> spacing >>
+        rootOffset >> rootSize;
+
+    struct Node
+    {
+        uint64_t m_offset;
+        point_count_t m_count;
+        BOX3D m_bounds;
+    };
+    std::vector<Node> nodes;
+    std::vector<std::pair<uint64_t, uint64_t>> pages { { rootOffset,
+        rootSize } };
+
+    // Limiting the number of pages protects against reference loops.
+    size_t maxPages = 1000000;
+    while (pages.size())
+    {
+        if (!maxPages--)
+            throw error("Invalid COPC hierarchy: too many pages.");
+        auto page = pages.back();
+        pages.pop_back();
+
+        std::vector<char> buf = read(page.first, page.second);
+        CheckedExtractor entry(buf.data(), buf.size(), "COPC hierarchy page");
+        while (entry.position() < buf.size())
+        {
+            int32_t d, x, y, z;
+            uint64_t offset;
+            int32_t byteSize;
+            int32_t pointCount;
+
+            entry.need(4 * sizeof(int32_t) + sizeof(uint64_t) +
+                2 * sizeof(int32_t));
+            entry >> d >> x >> y >> z >> offset >> byteSize >> pointCount;
+            if (d < 0 || d > 30)
+                throw error("Invalid COPC hierarchy: bad node depth.");
+
+            if (pointCount == -1)
+                pages.push_back({ offset, (uint64_t)byteSize });
+            else if (pointCount > 0)
+            {
+                double side = 2 * halfsize / ((uint64_t)1 << d);
+                double minx = centerx - halfsize + x * side;
+                double miny = centery - halfsize + y * side;
+                double minz = centerz - halfsize + z * side;
+                nodes.push_back({ offset, (point_count_t)pointCount,
+                    BOX3D(minx, miny, minz,
+                        minx + side, miny + side, minz + side) });
+            }
+        }
+    }
+
+    std::sort(nodes.begin(), nodes.end(),
+        [](const Node& a, const Node& b){ return a.m_offset < b.m_offset; });
+
+    ChunkList chunks;
+    PointId first = 0;
+    for (const Node& n : nodes)
+    {
+        chunks.push_back({ first, n.m_count, n.m_bounds });
+        first += n.m_count;
+    }
+    return chunks;
+}
+
+} // namespace LasChunkIndex
+
+} // namespace pdal
@@ -0,0 +1,85 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <vector>
+
+#include <pdal/pdal_types.hpp>
+#include <pdal/util/Bounds.hpp>
+
+namespace pdal
+{
+
+// Reading of the spatial indexes of LAS files.  An index divides the points
+// of a file into ranges of consecutive points with known extents so that
+// a reader can skip ranges that don't overlap a query.
+namespace LasChunkIndex
+{
+
+struct error : public std::runtime_error
+{
+    error(const std::string& err) : std::runtime_error(err)
+    {}
+};
+
+struct Chunk
+{
+    PointId m_first;
+    point_count_t m_count;
+    BOX3D m_bounds;
+};
+using ChunkList = std::vector<Chunk>;
+
+// Function to read 'size' bytes at absolute file position 'offset'.
+using FileReader =
+    std::function<std::vector<char>(uint64_t offset, uint64_t size)>;
+
+// PDAL chunk bounds VLR. Each entry is the point count of a chunk,
+// followed by its minimum and maximum X, Y and Z.
+ChunkList parseChunkBounds(const char *data, size_t size);
+std::vector<uint8_t> chunkBoundsData(const ChunkList& chunks);
+
+// LAStools LAX index, from a .lax file or LAStools EVLR.  Only the 2D
+// extents of a cell are known.
+ChunkList parseLax(const char *data, size_t size);
+
+// COPC hierarchy, located by the COPC info VLR.
+ChunkList parseCopc(const char *info, size_t size, const FileReader& read);
+
+} // namespace LasChunkIndex
+
+} // namespace pdal
@@ -40,6 +40,7 @@
 #include <string.h>
 
 #include <pdal/pdal_features.hpp>
+#include <pdal/GDALUtils.hpp>
 #include <pdal/Metadata.hpp>
 #include <pdal/PointView.hpp>
 #include <pdal/QuickInfo.hpp>
@@ -63,14 +64,122 @@ struct invalid_stream : public std::runtime_error
         {}
 };
 
+const double LOWEST = (std::numeric_limits<double>::lowest)();
+const double HIGHEST = (std::numeric_limits<double>::max)();
+
+// COPC and LAStools VLRs that locate a spatial index.
+const char COPC_USER_ID[] = "copc";
+const uint16_t COPC_INFO_RECORD_ID = 1;
+const char LASTOOLS_USER_ID[] = "LAStools";
+const uint16_t LAX_RECORD_ID = 30;
+
+// Number of points decoded together by loadPoints().  Small enough that
+// the field arrays stay in cache.
+const point_count_t BATCH_SIZE = 4096;
+
+// Number of points between progress reports when points aren't otherwise
+// read in blocks.
+const point_count_t PROGRESS_SIZE = 65536;
+
+// Gaps between the points of a stride shorter than this many bytes are
+// read through rather than seeked over.
+const size_t SEEK_SIZE = 65536;
+
+// Extract one field of 'count' consecutive point records.
+template<typename T>
+void extractField(const char *pos, size_t pointLen, point_count_t count,
+    std::vector<T>& vals)
+{
+    vals.resize(count);
+    for (point_count_t i = 0; i < count; ++i)
+    {
+        LeExtractor in(pos, sizeof(T));
+        in >> vals[i];
+        pos += pointLen;
+    }
+}
+
+// Stores the values of a field for a batch of points added to a view.
+// Values are copied directly into the packed point data when the type of
+// the field matches that of the dimension, or when the scaled integers of a
+// coordinate are stored with the same scale and offset.  Otherwise they're
+// set with PointView::setField(), which also adds the points to tables that
+// don't store packed points.
+class BatchSink
+{
+public:
+    BatchSink(PointView& view, point_count_t count) : m_view(view),
+        m_first(view.size()), m_count(count)
+    {
+        // The points of a compressed table move as its blocks are evicted.
+        if (view.table().packedPoints())
+        {
+            m_points.resize(count);
+            for (point_count_t i = 0; i < count; ++i)
+                m_points[i] = view.getOrAddPoint(m_first + i);
+        }
+    }
+
+    template<typename T>
+    void set(Dimension::Id id, const std::vector<T>& vals)
+    {
+        PointLayoutPtr layout = m_view.layout();
+        if (m_points.size() && layout->hasDim(id) &&
+            layout->dimType(id) == Dimension::typeOf<T>() &&
+            !layout->dimDetail(id)->quantized())
+        {
+            const size_t offset = layout->dimOffset(id);
+            for (point_count_t i = 0; i < m_count; ++i)
+                std::memcpy(m_points[i] + offset, &vals[i], sizeof(T));
+        }
+        else
+        {
+            for (point_count_t i = 0; i < m_count; ++i)
+                m_view.setField(id, m_first + i, vals[i]);
+        }
+    }
+
+    // Store coordinates from the scaled integers of a file.  'doubles' is
+    // used as scratch space.
+    void setScaled(Dimension::Id id, const std::vector<int32_t>& ints,
+        double scale, double offset, std::vector<double>& doubles)
+    {
+        PointLayoutPtr layout = m_view.layout();
+        const Dimension::Detail *d = layout->dimDetail(id);
+        if (m_points.size() && d->quantized() && d->scale() == scale &&
+            d->quantOffset() == offset)
+        {
+            const size_t pos = d->offset();
+            for (point_count_t i = 0; i < m_count; ++i)
+                std::memcpy(m_points[i] + pos, &ints[i], sizeof(int32_t));
+            return;
+        }
+        for (point_count_t i = 0; i < m_count; ++i)
+            doubles[i] = ints[i] * scale + offset;
+        set(id, doubles);
+    }
+
+private:
+    PointView& m_view;
+    PointId m_first;
+    point_count_t m_count;
+    std::vector<char *> m_points;
+};
+
 } // unnamed namespace
 
-LasReader::LasReader() : m_decompressor(nullptr), m_index(0)
+LasReader::LasReader() : m_decompressor(nullptr), m_chunkPos(0),
+    m_nextChunk(0), m_curChunk(0), m_chunkSkip(0), m_mapPoints(0),
+    m_aheadPos(0), m_index(0), m_step(1), m_strideEnd(0), m_query(false),
+    m_curRange(0)
 {}
 
 
 LasReader::~LasReader()
 {
+    unmapPoints();
+    // Wait for any outstanding chunk decompression.
+    m_chunkQueue.clear();
 #ifdef PDAL_HAVE_LAZPERF
     delete m_decompressor;
 #endif
@@ -85,6 +194,20 @@ void LasReader::addArgs(ProgramArgs& args)
     args.add("use_eb_vlr", "Use extra bytes VLR for 1.0 - 1.3 files",
         m_useEbVlr);
     args.add("ignore_vlr", "VLR userid/recordid to ignore", m_ignoreVLROption);
+    args.add("threads", "Number of threads used to decompress LAZ chunks",
+        m_threads, 1);
+    args.add("use_mmap", "Memory-map the point data of uncompressed files",
+        m_useMmap);
+    args.add("read_ahead", "Number of blocks of uncompressed point data "
+        "read ahead of decoding.  0 reads points synchronously", m_readAhead,
+        4);
+    args.add("quantize", "Store X, Y and Z as integers scaled by the file's "
+        "scale and offset", m_quantize);
+    args.add("bounds", "Bounds of points to read.  Chunks of a file with "
+        "a spatial index that don't overlap are skipped", m_bounds);
+    args.add("polygon", "Bounding polygon(s) of points to read",
+        m_polys).setErrorText("Invalid polygon specification. "
+            "Must be valid GeoJSON/WKT");
 }
 
 
@@ -216,7 +339,10 @@ void LasReader::initializeLocal(PointTableRef table, MetadataNode& m)
     if (m_header.versionAtLeast(1, 4) || m_useEbVlr)
         readExtraBytesVlr();
     setSrs(m);
-    MetadataNode forward = table.privateMetadata("lasforward");
+    prepareQuery();
+    // Forward-only metadata goes to a detached node when it isn't wanted.
+    MetadataNode forward = table.forwardMetadata() ?
+        table.privateMetadata("lasforward") : MetadataNode("lasforward");
     extractHeaderMetadata(forward, m);
     extractVlrMetadata(forward, m);
 
@@ -251,6 +377,10 @@ void LasReader::ready(PointTableRef table)
             laszip_BOOL compressed;
 
             handleLaszip(laszip_create(&m_laszip));
+#ifdef laszip_DECOMPRESS_SELECTIVE_ALL
+            handleLaszip(laszip_decompress_selective(m_laszip,
+                selectedLayers()));
+#endif
             handleLaszip(laszip_open_reader_stream(m_laszip, *stream,
                 &compressed));
             handleLaszip(laszip_get_point_pointer(m_laszip, &m_laszipPoint));
@@ -269,6 +399,32 @@ void LasReader::ready(PointTableRef table)
             m_decompressor = new LazPerfVlrDecompressor(*stream,
                 vlr->data(), m_header.pointOffset());
             m_decompressorBuf.resize(m_decompressor->pointSize());
+
+            m_chunkQueue.clear();
+            m_chunkDecompressor.reset();
+            m_chunkBuf.clear();
+            m_chunkPos = 0;
+            m_nextChunk = 0;
+            m_curChunk = 0;
+            m_chunkSkip = 0;
+            if (m_threads > 1)
+            {
+                try
+                {
+                    m_chunkDecompressor.reset(new LazPerfVlrChunkDecompressor(
+                        *stream, vlr->data(), m_header.pointOffset(),
+                        getNumPoints()));
+                }
+                catch (const pdal_error& err)
+                {
+                    log()->get(LogLevel::Warning) << getName() << ": " <<
+                        err.what() << " Decompressing with a single "
+                        "thread." << std::endl;
+                }
+                // Reading the chunk table moved the stream.
+                stream->clear();
+                stream->seekg(m_header.pointOffset() + sizeof(int64_t));
+            }
         }
 #endif
 
@@ -278,7 +434,433 @@ void LasReader::ready(PointTableRef table)
 #endif
     }
     else
+    {
         stream->seekg(m_header.pointOffset());
+        if (m_useMmap)
+            mapPoints();
+        if (!m_map.addr() && m_readAhead > 0 && !Utils::isRemote(m_filename))
+        {
+            m_async.reset(new AsyncReader(m_readAhead));
+            if (m_async->open(m_filename))
+                readAheadFrom(0);
+            else
+            {
+                log()->get(LogLevel::Debug) << getName() << ": " <<
+                    m_async->error() << " Reading points from the stream." <<
+                    std::endl;
+                m_async.reset();
+            }
+        }
+    }
+    m_step = 1;
+    if (m_query)
+        selectRanges();
+    else
+    {
+        if (readStride(getNumPoints()))
+            startStride();
+        else if (point_count_t skip = pointsToSkip(getNumPoints()))
+            seekPoint(skip);
+
+        // The points of a query are filtered as they're read, so the
+        // number read isn't known in advance.
+        if (m_step > 1)
+            setProgressTotal((m_strideEnd - m_index + m_step - 1) / m_step);
+        else
+            setProgressTotal((std::min)(m_count, getNumPoints() - m_index));
+    }
+}
+
+
+// Transform the query bounds and polygons to the SRS of the file.
+void LasReader::prepareQuery()
+{
+    const SpatialReference& boundsSrs = m_bounds.spatialReference();
+    m_query = m_bounds.to2d().valid() || m_polys.size();
+    if (!m_query)
+        return;
+
+    if (getSpatialReference().empty() && boundsSrs.valid())
+        throwError("Can't use bounds with SRS with data source that has "
+            "no SRS.");
+    if (m_bounds.is3d())
+        m_queryBounds = m_bounds.to3d();
+    else if (m_bounds.to2d().valid())
+    {
+        BOX2D box = m_bounds.to2d();
+        m_queryBounds = BOX3D(box.minx, box.miny, LOWEST,
+            box.maxx, box.maxy, HIGHEST);
+    }
+    else
+        m_queryBounds = BOX3D(LOWEST, LOWEST, LOWEST,
+            HIGHEST, HIGHEST, HIGHEST);
+    if (boundsSrs.valid())
+        gdal::reprojectBounds(m_queryBounds,
+            boundsSrs.getWKT(), getSpatialReference().getWKT());
+
+    std::vector<Polygon> exploded;
+    for (Polygon& poly : m_polys)
+    {
+        if (!poly.valid())
+            throwError("Geometrically invalid polyon in option 'polygon'.");
+        poly.transform(getSpatialReference());
+
+        std::vector<Polygon> polys = poly.polygons();
+        exploded.insert(exploded.end(),
+            std::make_move_iterator(polys.begin()),
+            std::make_move_iterator(polys.end()));
+    }
+    m_polys = std::move(exploded);
+}
+
+
+// Read the extents of chunks of points from the first spatial index
+// found: a PDAL chunk bounds VLR, a LAStools index VLR, a COPC hierarchy
+// or a LAX file alongside the input.
+LasChunkIndex::ChunkList LasReader::readChunkIndex()
+{
+    using namespace LasChunkIndex;
+
+    const LasVLR *vlr = m_header.findVlr(PDAL_USER_ID,
+        PDAL_CHUNK_BOUNDS_RECORD_ID);
+    if (vlr)
+        return parseChunkBounds(vlr->data(), vlr->dataLen());
+
+    vlr = m_header.findVlr(LASTOOLS_USER_ID, LAX_RECORD_ID);
+    if (vlr)
+        return parseLax(vlr->data(), vlr->dataLen());
+
+    vlr = m_header.findVlr(COPC_USER_ID, COPC_INFO_RECORD_ID);
+    if (vlr)
+    {
+        std::unique_ptr<LasStreamIf> s(openStream());
+        if (!s->m_istream || !*s->m_istream)
+            throw error("Unable to open stream for '" + m_filename + "'.");
+        auto read = [&s](uint64_t offset, uint64_t size)
+        {
+            std::vector<char> buf(size);
+            s->m_istream->seekg(offset);
+            s->m_istream->read(buf.data(), size);
+            if (s->m_istream->gcount() != (std::streamsize)size)
+                throw error("Unable to read COPC hierarchy.");
+            return buf;
+        };
+        return parseCopc(vlr->data(), vlr->dataLen(), read);
+    }
+
+    std::string laxFilename = m_filename.substr(0,
+        m_filename.size() - FileUtils::extension(m_filename).size()) + ".lax";
+    if (FileUtils::fileExists(laxFilename))
+    {
+        std::string data = FileUtils::readFileIntoString(laxFilename);
+        return parseLax(data.data(), data.size());
+    }
+    return ChunkList();
+}
+
+
+// Determine the ranges of points to read: those not in a chunk of the
+// spatial index that lies outside the query.
+void LasReader::selectRanges()
+{
+    LasChunkIndex::ChunkList chunks;
+    try
+    {
+        chunks = readChunkIndex();
+    }
+    catch (const LasChunkIndex::error& err)
+    {
+        log()->get(LogLevel::Warning) << getName() << ": " << err.what() <<
+            " Ignoring spatial index." << std::endl;
+    }
+
+    const point_count_t numPoints = getNumPoints();
+    std::vector<PointRange> skipped;
+    for (const LasChunkIndex::Chunk& c : chunks)
+    {
+        bool overlaps = c.m_bounds.overlaps(m_queryBounds);
+        if (overlaps && m_polys.size())
+        {
+            overlaps = false;
+            for (const Polygon& poly : m_polys)
+                if (!poly.disjoint(c.m_bounds))
+                {
+                    overlaps = true;
+                    break;
+                }
+        }
+        if (!overlaps)
+            skipped.push_back({ c.m_first, c.m_first + c.m_count });
+    }
+    std::sort(skipped.begin(), skipped.end());
+
+    m_ranges.clear();
+    PointId pos = 0;
+    for (const PointRange& r : skipped)
+    {
+        if (r.first > pos)
+            m_ranges.push_back({ pos, (std::min)(r.first, numPoints) });
+        pos = (std::max)(pos, r.second);
+        if (pos >= numPoints)
+            break;
+    }
+    if (pos < numPoints)
+        m_ranges.push_back({ pos, numPoints });
+    m_curRange = 0;
+
+    point_count_t selected = 0;
+    for (const PointRange& r : m_ranges)
+        selected += r.second - r.first;
+    log()->get(LogLevel::Debug) << getName() << ": Spatial index has " <<
+        chunks.size() << " chunks.  Reading " << selected << " of " <<
+        numPoints << " points." << std::endl;
+}
+
+
+// Return the number of points left in the current range, seeking to the
+// start of the next range once the current one has been read.  Returns 0
+// when all ranges have been read.
+point_count_t LasReader::rangeRemaining()
+{
+    while (m_curRange < m_ranges.size())
+    {
+        const PointRange& r = m_ranges[m_curRange];
+        if (m_index < r.first)
+            seekPoint(r.first);
+        if (m_index < r.second)
+            return r.second - m_index;
+        m_curRange++;
+    }
+    return 0;
+}
+
+
+// Position the reader so that the next point read is 'idx'.
+void LasReader::seekPoint(PointId idx)
+{
+    if (m_header.compressed())
+    {
+#ifdef PDAL_HAVE_LASZIP
+        if (m_compression == "LASZIP")
+            handleLaszip(laszip_seek_point(m_laszip, idx));
+#endif
+
+#ifdef PDAL_HAVE_LAZPERF
+        if (m_compression == "LAZPERF")
+        {
+            if (m_chunkDecompressor)
+            {
+                const uint64_t chunkSize = m_chunkDecompressor->chunkSize();
+                const size_t pointSize = m_chunkDecompressor->pointSize();
+                const size_t chunk = (size_t)(idx / chunkSize);
+                const size_t skip = (idx - chunk * chunkSize) * pointSize;
+
+                if (chunk == m_curChunk && m_chunkBuf.size())
+                    m_chunkPos = skip;
+                else
+                {
+                    // Queued chunks are consecutive.  Keep any queued
+                    // chunks from the target on.
+                    size_t front = m_nextChunk - m_chunkQueue.size();
+                    if (chunk >= front && chunk < m_nextChunk)
+                        while (front++ < chunk)
+                            m_chunkQueue.pop_front();
+                    else
+                    {
+                        m_chunkQueue.clear();
+                        m_nextChunk = chunk;
+                    }
+                    m_chunkBuf.clear();
+                    m_chunkPos = 0;
+                    m_chunkSkip = skip;
+                }
+            }
+            else
+            {
+                // Points can only be decompressed in order.
+                for (; m_index < idx; ++m_index)
+                    m_decompressor->decompress(m_decompressorBuf.data());
+            }
+        }
+#endif
+    }
+    else if (m_async)
+        readAheadFrom(idx);
+    else if (!m_map.addr())
+    {
+        std::istream *stream(m_streamIf->m_istream);
+        stream->clear();
+        stream->seekg(m_header.pointOffset() + idx * m_header.pointLen());
+    }
+    m_index = idx;
+}
+
+
+// Read only the points of the stride asked for by the stage that follows.
+void LasReader::startStride()
+{
+    const PointLimit& limit = pointLimit();
+    m_step = limit.m_step;
+    m_strideEnd = (std::min)(getNumPoints(), limit.m_first);
+    if (limit.m_offset < m_strideEnd)
+        skipPoints(limit.m_offset);
+    else
+        m_index = m_strideEnd;
+}
+
+
+// Move past 'count' points without unpacking them.  LASzip data can only
+// be decompressed in order, so the points are decompressed and dropped.
+void LasReader::skipPoints(point_count_t count)
+{
+    if (!count)
+        return;
+
+    const size_t pointLen = m_header.pointLen();
+#ifdef PDAL_HAVE_LASZIP
+    if (m_header.compressed() && m_compression == "LASZIP")
+    {
+        for (point_count_t i = 0; i < count; ++i)
+            handleLaszip(laszip_read_point(m_laszip));
+        m_index += count;
+        return;
+    }
+#endif
+    if (!m_header.compressed() && !m_map.addr() &&
+        count * pointLen < SEEK_SIZE)
+    {
+        m_batchBuf.resize(count * pointLen);
+        point_count_t numRead = 0;
+        try
+        {
+            numRead = readFileBlock(m_batchBuf, count);
+        }
+        catch (invalid_stream&)
+        {}
+        // A short read means the file is truncated.
+        m_index = (numRead < count) ? getNumPoints() : m_index + count;
+        return;
+    }
+    seekPoint(m_index + count);
+}
+
+
+// Read the next point of the stride and move to the one after it.
+bool LasReader::nextStridePoint(PointRef& point)
+{
+    if (m_index >= m_strideEnd || !readOne(point))
+        return false;
+    skipPoints((std::min)(m_step - 1,
+        m_strideEnd - (std::min)(m_index, m_strideEnd)));
+    return true;
+}
+
+
+bool LasReader::passesFilter(PointRef& point) const
+{
+    double x = point.getFieldAs<double>(Dimension::Id::X);
+    double y = point.getFieldAs<double>(Dimension::Id::Y);
+    double z = point.getFieldAs<double>(Dimension::Id::Z);
+
+    if (!m_queryBounds.contains(x, y, z))
+        return false;
+    if (m_polys.empty())
+        return true;
+    for (const Polygon& poly : m_polys)
+        if (poly.contains(x, y))
+            return true;
+    return false;
+}
+
+
+#if defined(PDAL_HAVE_LASZIP) && defined(laszip_DECOMPRESS_SELECTIVE_ALL)
+// Determine the layers of LAS 1.4 compressed points that must be
+// decompressed to provide the dimensions required downstream.  Return
+// numbers and X/Y are always decompressed.
+uint32_t LasReader::selectedLayers() const
+{
+    using namespace Dimension;
+
+    uint32_t layers = laszip_DECOMPRESS_SELECTIVE_CHANNEL_RETURNS_XY;
+    auto select = [this, &layers](const IdList& ids, uint32_t layer)
+    {
+        for (Id id : ids)
+            if (dimRequired(id))
+            {
+                layers |= layer;
+                break;
+            }
+    };
+
+    if (m_query)
+        layers |= laszip_DECOMPRESS_SELECTIVE_Z;
+    select({ Id::Z }, laszip_DECOMPRESS_SELECTIVE_Z);
+    select({ Id::Classification }, laszip_DECOMPRESS_SELECTIVE_CLASSIFICATION);
+    select({ Id::ClassFlags, Id::ScanDirectionFlag, Id::EdgeOfFlightLine },
+        laszip_DECOMPRESS_SELECTIVE_FLAGS);
+    select({ Id::Intensity }, laszip_DECOMPRESS_SELECTIVE_INTENSITY);
+    select({ Id::ScanAngleRank }, laszip_DECOMPRESS_SELECTIVE_SCAN_ANGLE);
+    select({ Id::UserData }, laszip_DECOMPRESS_SELECTIVE_USER_DATA);
+    select({ Id::PointSourceId }, laszip_DECOMPRESS_SELECTIVE_POINT_SOURCE);
+    select({ Id::GpsTime }, laszip_DECOMPRESS_SELECTIVE_GPS_TIME);
+    select({ Id::Red, Id::Green, Id::Blue }, laszip_DECOMPRESS_SELECTIVE_RGB);
+    select({ Id::Infrared }, laszip_DECOMPRESS_SELECTIVE_NIR);
+
+    IdList extraIds;
+    for (auto& dim : m_extraDims)
+        extraIds.push_back(dim.m_dimType.m_id);
+    select(extraIds, laszip_DECOMPRESS_SELECTIVE_EXTRA_BYTES);
+    return layers;
+}
+#endif
+
+
+// Map the point records of an uncompressed file.  If the mapping fails
+// points are read from the stream.
+void LasReader::mapPoints()
+{
+    unmapPoints();
+    m_map = FileUtils::mapFile(m_filename, true,
+        fileOffset() + m_header.pointOffset());
+    if (!m_map.addr())
+    {
+        log()->get(LogLevel::Warning) << getName() << ": Unable to map '" <<
+            m_filename << "': " << m_map.what() << " Reading points from "
+            "the stream." << std::endl;
+        return;
+    }
+
+    // The header may claim more points than the file holds.
+    m_mapPoints = (std::min)(getNumPoints(),
+        (point_count_t)(m_map.size() / m_header.pointLen()));
+}
+
+
+void LasReader::unmapPoints()
+{
+    if (m_map.addr())
+        m_map = FileUtils::unmapFile(m_map);
+    m_mapPoints = 0;
+}
+
+
+// Decode up to 'count' points directly from the mapped point records into
+// consecutive point IDs starting at that of 'point'.
+point_count_t LasReader::readMapped(PointRef& point, point_count_t count)
+{
+    size_t pointLen = m_header.pointLen();
+    count = (std::min)(count, m_mapPoints - (std::min)(m_index, m_mapPoints));
+
+    char *pos = static_cast<char *>(m_map.addr()) + m_index * pointLen;
+    PointId id = point.pointId();
+    for (PointId idx = id; idx < id + count; ++idx)
+    {
+        point.setPointId(idx);
+        loadPoint(point, pos, pointLen);
+        pos += pointLen;
+    }
+    m_index += count;
+    return count;
 }
 
 
@@ -506,8 +1088,11 @@ void LasReader::extractVlrMetadata(MetadataNode& forward, MetadataNode& m)
         name << "vlr_" << i++;
         MetadataNode vlrNode(name.str());
 
+        // VLR data is encoded only if it's read.
+        const uint8_t *data = (const uint8_t *)vlr.data();
         vlrNode.addEncoded("data",
-            (const uint8_t *)vlr.data(), vlr.dataLen(), vlr.description());
+            std::vector<uint8_t>(data, data + vlr.dataLen()),
+            vlr.description());
         vlrNode.add("user_id", vlr.userId(),
             "User ID of the record or pre-defined value from the "
             "specification.");
@@ -570,10 +1155,35 @@ void LasReader::addDimensions(PointLayoutPtr layout)
             type = Dimension::Type::Double;
         dim.m_dimType.m_id = layout->registerOrAssignDim(dim.m_name, type);
     }
+
+    if (m_quantize)
+    {
+        layout->quantizeDim(Id::X, m_header.scaleX(), m_header.offsetX());
+        layout->quantizeDim(Id::Y, m_header.scaleY(), m_header.offsetY());
+        layout->quantizeDim(Id::Z, m_header.scaleZ(), m_header.offsetZ());
+    }
 }
 
 
 bool LasReader::processOne(PointRef& point)
+{
+    if (m_step > 1)
+        return nextStridePoint(point);
+    if (!m_query)
+        return readOne(point);
+
+    while (rangeRemaining())
+    {
+        if (!readOne(point))
+            return false;
+        if (passesFilter(point))
+            return true;
+    }
+    return false;
+}
+
+
+bool LasReader::readOne(PointRef& point)
 {
     if (m_index >= getNumPoints())
         return false;
@@ -593,8 +1203,16 @@ bool LasReader::processOne(PointRef& point)
 #ifdef PDAL_HAVE_LAZPERF
         if (m_compression == "LAZPERF")
         {
-            m_decompressor->decompress(m_decompressorBuf.data());
-            loadPoint(point, m_decompressorBuf.data(), pointLen);
+            if (m_chunkDecompressor)
+            {
+                point_count_t one = 1;
+                loadPoint(point, nextChunkPoints(one), pointLen);
+            }
+            else
+            {
+                m_decompressor->decompress(m_decompressorBuf.data());
+                loadPoint(point, m_decompressorBuf.data(), pointLen);
+            }
         }
 #endif
 #if !defined(PDAL_HAVE_LAZPERF) && !defined(PDAL_HAVE_LASZIP)
@@ -602,11 +1220,19 @@ bool LasReader::processOne(PointRef& point)
             "LAZperf decompression library.");
 #endif
     } // compression
+    else if (m_map.addr())
+        return readMapped(point, 1) == 1;
     else
     {
         std::vector<char> buf(m_header.pointLen());
 
-        m_streamIf->m_istream->read(buf.data(), pointLen);
+        if (m_async)
+        {
+            if (readAhead(buf.data(), 1) != 1)
+                return false;
+        }
+        else
+            m_streamIf->m_istream->read(buf.data(), pointLen);
         loadPoint(point, buf.data(), pointLen);
     }
     m_index++;
@@ -614,7 +1240,195 @@ bool LasReader::processOne(PointRef& point)
 }
 
 
+#ifdef PDAL_HAVE_LAZPERF
+// Return the next decompressed points.  Up to 'threads' chunks are
+// decompressed ahead of the point being read, each on its own thread and
+// stream.  Points are always returned in file order.  On return, 'count'
+// is limited to the number of points left in the current chunk.
+char *LasReader::nextChunkPoints(point_count_t& count)
+{
+    if (m_chunkPos >= m_chunkBuf.size())
+    {
+        while (m_chunkQueue.size() < (size_t)m_threads &&
+            m_nextChunk < m_chunkDecompressor->chunkCount() &&
+            chunkWanted(m_nextChunk))
+        {
+            size_t chunk = m_nextChunk++;
+            auto decompress = [this, chunk]()
+            {
+                std::unique_ptr<LasStreamIf> s(openStream());
+                if (!s->m_istream || !*s->m_istream)
+                    throw pdal_error("Unable to open stream for '" +
+                        m_filename + "'.");
+                std::vector<char> buf;
+                m_chunkDecompressor->decompress(chunk, *s->m_istream, buf);
+                return buf;
+            };
+            m_chunkQueue.push_back(std::async(std::launch::async,
+                decompress));
+        }
+        if (m_chunkQueue.empty())
+            throwError("Unexpected end of compressed point data.");
+        m_curChunk = m_nextChunk - m_chunkQueue.size();
+        m_chunkBuf = m_chunkQueue.front().get();
+        m_chunkQueue.pop_front();
+        m_chunkPos = m_chunkSkip;
+        m_chunkSkip = 0;
+    }
+    const size_t pointSize = m_chunkDecompressor->pointSize();
+    count = (std::min)(count,
+        (point_count_t)((m_chunkBuf.size() - m_chunkPos) / pointSize));
+    char *pos = m_chunkBuf.data() + m_chunkPos;
+    m_chunkPos += count * pointSize;
+    return pos;
+}
+
+
+// Chunks that hold no points of the query's ranges aren't decompressed
+// ahead of time.
+bool LasReader::chunkWanted(size_t chunk) const
+{
+    if (!m_query)
+        return true;
+
+    const uint64_t chunkSize = m_chunkDecompressor->chunkSize();
+    const PointId begin = chunk * chunkSize;
+    const PointId end = begin + chunkSize;
+
+    // Find the first range that ends after the chunk begins.
+    auto it = std::upper_bound(m_ranges.begin(), m_ranges.end(), begin,
+        [](PointId idx, const PointRange& r){ return idx < r.second; });
+    return it != m_ranges.end() && it->first < end;
+}
+#endif
+
+
+// Uncompressed points are read into a buffer in one block rather than one
+// at a time.  The points of each batch are counted toward progress by the
+// caller, so only their bytes are reported here.
+point_count_t LasReader::processBatch(StreamPointTable& table, PointId begin,
+    point_count_t count)
+{
+    size_t pointLen = m_header.pointLen();
+    if (m_header.compressed() || m_query || m_step > 1)
+    {
+        point_count_t numRead = Streamable::processBatch(table, begin, count);
+        addProgress(0, numRead * pointLen);
+        return numRead;
+    }
+
+    if (m_index >= getNumPoints())
+        return 0;
+    count = (std::min)(count, getNumPoints() - m_index);
+
+    if (m_map.addr())
+    {
+        PointRef point(table, begin);
+        point_count_t numRead = readMapped(point, count);
+        addProgress(0, numRead * pointLen);
+        return numRead;
+    }
+
+    m_batchBuf.resize(count * pointLen);
+    point_count_t numRead = 0;
+    try
+    {
+        numRead = readFileBlock(m_batchBuf, count);
+    }
+    catch (invalid_stream&)
+    {}
+
+    PointRef point(table, begin);
+    char *pos = m_batchBuf.data();
+    for (PointId idx = begin; idx < begin + numRead; ++idx)
+    {
+        point.setPointId(idx);
+        loadPoint(point, pos, pointLen);
+        pos += pointLen;
+    }
+    m_index += numRead;
+    addProgress(0, numRead * pointLen);
+    return numRead;
+}
+
+
 point_count_t LasReader::read(PointViewPtr view, point_count_t count)
+{
+    if (m_query)
+        return readQuery(view, count);
+    if (m_step > 1)
+        return readStrided(view, count);
+
+    PointId id = view->size();
+    point_count_t numRead = readPoints(*view, count);
+    if (m_cb)
+        for (; id < view->size(); ++id)
+            m_cb(*view, id);
+    return numRead;
+}
+
+
+// Read the points of the query's ranges, keeping those that pass the
+// query filter.  Points are read into a temporary view so that those
+// that don't pass can be dropped.
+point_count_t LasReader::readQuery(PointViewPtr view, point_count_t count)
+{
+    PointViewPtr tmp = view->makeNew();
+    PointRef point(*tmp, 0);
+
+    point_count_t numRead = 0;
+    while (numRead < count)
+    {
+        point_count_t n = (std::min)(rangeRemaining(), BATCH_SIZE);
+        if (!n)
+            break;
+
+        PointId idx = tmp->size();
+        if (!readPoints(*tmp, n))
+            break;
+        for (; idx < tmp->size() && numRead < count; ++idx)
+        {
+            point.setPointId(idx);
+            if (!passesFilter(point))
+                continue;
+            PointId id = view->size();
+            view->appendPoint(*tmp, idx);
+            numRead++;
+            if (m_cb)
+                m_cb(*view, id);
+        }
+    }
+    return numRead;
+}
+
+
+// Read up to 'count' points of the stride.  The points between them are
+// never unpacked.
+point_count_t LasReader::readStrided(PointViewPtr view, point_count_t count)
+{
+    const size_t pointLen = m_header.pointLen();
+    PointRef point(*view, 0);
+
+    point_count_t numRead = 0;
+    while (numRead < count)
+    {
+        PointId id = view->size();
+        point.setPointId(id);
+        if (!nextStridePoint(point))
+            break;
+        numRead++;
+        if (m_cb)
+            m_cb(*view, id);
+        if (numRead % PROGRESS_SIZE == 0)
+            addProgress(PROGRESS_SIZE, PROGRESS_SIZE * pointLen);
+    }
+    addProgress(numRead % PROGRESS_SIZE, (numRead % PROGRESS_SIZE) * pointLen);
+    return numRead;
+}
+
+
+// Read up to 'count' points starting at the current point.
+point_count_t LasReader::readPoints(PointView& view, point_count_t count)
 {
     size_t pointLen = m_header.pointLen();
     count = (std::min)(count, getNumPoints() - m_index);
@@ -622,23 +1436,66 @@ point_count_t LasReader::read(PointViewPtr view, point_count_t count)
     PointId i = 0;
     if (m_header.compressed())
     {
+#ifdef PDAL_HAVE_LAZPERF
+        if (m_compression == "LAZPERF")
+        {
+            // Decompressed points are decoded in batches.
+            while (i < count)
+            {
+                point_count_t n = count - i;
+                char *pos;
+                if (m_chunkDecompressor)
+                    pos = nextChunkPoints(n);
+                else
+                {
+                    n = (std::min)(n, BATCH_SIZE);
+                    m_batchBuf.resize(n * pointLen);
+                    for (point_count_t k = 0; k < n; ++k)
+                        m_decompressor->decompress(
+                            m_batchBuf.data() + k * pointLen);
+                    pos = m_batchBuf.data();
+                }
+                loadPoints(view, pos, n);
+                addProgress(n, n * pointLen);
+                i += n;
+            }
+        }
+#endif
 #if defined(PDAL_HAVE_LAZPERF) || defined(PDAL_HAVE_LASZIP)
-        if (m_compression == "LASZIP" || m_compression == "LAZPERF")
+        if (m_compression == "LASZIP")
         {
+            // readOne() advances the point index.
+            PointRef point(view, view.size());
             for (i = 0; i < count; i++)
             {
-                PointRef point = view->point(i);
-                PointId id = view->size();
-                processOne(point);
-                if (m_cb)
-                    m_cb(*view, id);
+                point.setPointId(view.size());
+                if (!readOne(point))
+                    break;
+                if ((i + 1) % PROGRESS_SIZE == 0)
+                    addProgress(PROGRESS_SIZE, PROGRESS_SIZE * pointLen);
             }
+            addProgress(i % PROGRESS_SIZE, (i % PROGRESS_SIZE) * pointLen);
+            return (point_count_t)i;
         }
 #else
         throwError("Can't read compressed file without LASzip or "
             "LAZperf decompression library.");
 #endif
     }
+    else if (m_map.addr())
+    {
+        // Map-backed reads decode straight from the file pages.
+        count = (std::min)(count,
+            m_mapPoints - (std::min)(m_index, m_mapPoints));
+        char *pos = static_cast<char *>(m_map.addr()) + m_index * pointLen;
+        for (; i < count; i += PROGRESS_SIZE)
+        {
+            point_count_t n = (std::min)(count - i, PROGRESS_SIZE);
+            loadPoints(view, pos + i * pointLen, n);
+            addProgress(n, n * pointLen);
+        }
+        i = count;
+    }
     else
     {
         point_count_t remaining = count;
@@ -652,17 +1509,9 @@ point_count_t LasReader::read(PointViewPtr view, point_count_t count)
             {
                 point_count_t blockPoints = readFileBlock(buf, remaining);
                 remaining -= blockPoints;
-                char *pos = buf.data();
-                while (blockPoints--)
-                {
-                    PointId id = view->size();
-                    PointRef point = view->point(id);
-                    loadPoint(point, pos, pointLen);
-                    if (m_cb)
-                        m_cb(*view, id);
-                    pos += pointLen;
-                    i++;
-                }
+                loadPoints(view, buf.data(), blockPoints);
+                addProgress(blockPoints, blockPoints * pointLen);
+                i += blockPoints;
             } while (remaining);
         }
         catch (std::out_of_range&)
@@ -684,6 +1533,13 @@ point_count_t LasReader::readFileBlock(std::vector<char>& buf,
     point_count_t blockpoints = buf.size() / ptLen;
 
     blockpoints = (std::min)(maxpoints, blockpoints);
+    if (m_async)
+    {
+        blockpoints = readAhead(buf.data(), blockpoints);
+        if (blockpoints == 0)
+            throw invalid_stream("stream is done");
+        return blockpoints;
+    }
     if (stream->eof())
         throw invalid_stream("stream is done");
 
@@ -699,6 +1555,61 @@ point_count_t LasReader::readFileBlock(std::vector<char>& buf,
 }
 
 
+// Restart reading ahead at point 'idx'.  The point records are requested
+// in blocks of whole points so that the blocks being read are followed by
+// those needed next.
+void LasReader::readAheadFrom(PointId idx)
+{
+    const size_t ptLen = m_header.pointLen();
+    const size_t blockSize =
+        ptLen * (std::max)((size_t)1, (size_t)(1 << 20) / ptLen);
+
+    m_async->clear();
+    m_aheadBuf.clear();
+    m_aheadPos = 0;
+    if (idx < getNumPoints())
+        m_async->request(fileOffset() + m_header.pointOffset() + idx * ptLen,
+            (getNumPoints() - idx) * ptLen, blockSize);
+}
+
+
+// Copy up to 'count' points that have been read ahead into 'buf'.  Fewer
+// points are copied only if the file is truncated.
+point_count_t LasReader::readAhead(char *buf, point_count_t count)
+{
+    const size_t ptLen = m_header.pointLen();
+    point_count_t numRead = 0;
+
+    while (numRead < count)
+    {
+        if (m_aheadPos >= m_aheadBuf.size())
+        {
+            try
+            {
+                m_aheadBuf = m_async->next();
+            }
+            catch (const std::runtime_error& err)
+            {
+                throwError(err.what());
+            }
+            m_aheadPos = 0;
+            if (m_aheadBuf.size() < ptLen)
+                break;
+        }
+        point_count_t n = (std::min)(count - numRead,
+            (point_count_t)((m_aheadBuf.size() - m_aheadPos) / ptLen));
+        if (n == 0)
+            break;
+        std::copy(m_aheadBuf.data() + m_aheadPos,
+            m_aheadBuf.data() + m_aheadPos + n * ptLen, buf);
+        m_aheadPos += n * ptLen;
+        buf += n * ptLen;
+        numRead += n;
+    }
+    return numRead;
+}
+
+
 #ifdef PDAL_HAVE_LASZIP
 void LasReader::loadPoint(PointRef& point, laszip_point& p)
 {
@@ -940,6 +1851,220 @@ void LasReader::loadPointV14(PointRef& point, char *buf, size_t bufsize)
 }
 
 
+// Decode 'count' consecutive point records into new points at the end of
+// 'view'.  Each field is decoded for a batch of points at a time, which lets
+// the compiler vectorize the scaling of coordinates and the unpacking of
+// bit fields.
+void LasReader::loadPoints(PointView& view, const char *buf,
+    point_count_t count)
+{
+    using namespace Dimension;
+
+    const LasHeader& h = m_header;
+    const size_t pointLen = h.pointLen();
+    const bool v14 = h.has14Format();
+
+    const Id coordIds[] = { Id::X, Id::Y, Id::Z };
+    const double scales[] = { h.scaleX(), h.scaleY(), h.scaleZ() };
+    const double offsets[] = { h.offsetX(), h.offsetY(), h.offsetZ() };
+
+    std::vector<int32_t> ints;
+    std::vector<double> doubles;
+    std::vector<float> floats;
+    std::vector<uint16_t> shorts;
+    std::vector<uint8_t> bytes;
+    std::vector<uint8_t> fields;
+    std::vector<int16_t> angles;
+    std::vector<int8_t> angleRanks;
+
+    // Unpack the bits selected by 'mask' at 'shift' from 'bytes'.
+    auto unpack = [&bytes, &fields](int shift, uint8_t mask)
+    {
+        fields.resize(bytes.size());
+        for (size_t i = 0; i < bytes.size(); ++i)
+            fields[i] = (bytes[i] >> shift) & mask;
+    };
+
+    // Fields not used downstream aren't decoded.
+    auto need = [this](std::initializer_list<Id> ids)
+    {
+        for (Id id : ids)
+            if (dimRequired(id))
+                return true;
+        return false;
+    };
+
+    while (count)
+    {
+        const point_count_t n = (std::min)(count, BATCH_SIZE);
+        const PointId first = view.size();
+        BatchSink sink(view, n);
+
+        doubles.resize(n);
+        for (int dim = 0; dim < 3; ++dim)
+        {
+            // Coordinates are always needed to apply a spatial query.
+            if (!m_query && !need({ coordIds[dim] }))
+                continue;
+            extractField(buf + dim * sizeof(int32_t), pointLen, n, ints);
+            sink.setScaled(coordIds[dim], ints, scales[dim], offsets[dim],
+                doubles);
+        }
+
+        if (need({ Id::Intensity }))
+        {
+            extractField(buf + 12, pointLen, n, shorts);
+            sink.set(Id::Intensity, shorts);
+        }
+
+        // Unpack the bit fields in the byte at 'offset' whose dimensions
+        // are required.
+        struct BitField
+        {
+            Id id;
+            int shift;
+            uint8_t mask;
+        };
+        auto unpackAll = [&](size_t offset, std::initializer_list<BitField> bits)
+        {
+            bool extracted = false;
+            for (const BitField& b : bits)
+            {
+                if (!need({ b.id }))
+                    continue;
+                if (!extracted)
+                    extractField(buf + offset, pointLen, n, bytes);
+                extracted = true;
+                unpack(b.shift, b.mask);
+                sink.set(b.id, fields);
+            }
+        };
+
+        size_t pos;
+        if (v14)
+        {
+            unpackAll(14, { { Id::ReturnNumber, 0, 0x0F },
+                { Id::NumberOfReturns, 4, 0x0F } });
+            unpackAll(15, { { Id::ClassFlags, 0, 0x0F },
+                { Id::ScanChannel, 4, 0x03 },
+                { Id::ScanDirectionFlag, 6, 0x01 },
+                { Id::EdgeOfFlightLine, 7, 0x01 } });
+
+            if (need({ Id::Classification }))
+            {
+                extractField(buf + 16, pointLen, n, bytes);
+                sink.set(Id::Classification, bytes);
+            }
+            if (need({ Id::UserData }))
+            {
+                extractField(buf + 17, pointLen, n, bytes);
+                sink.set(Id::UserData, bytes);
+            }
+
+            if (need({ Id::ScanAngleRank }))
+            {
+                extractField(buf + 18, pointLen, n, angles);
+                floats.resize(n);
+                for (point_count_t i = 0; i < n; ++i)
+                    floats[i] = (float)(angles[i] * .006);
+                sink.set(Id::ScanAngleRank, floats);
+            }
+
+            if (need({ Id::PointSourceId }))
+            {
+                extractField(buf + 20, pointLen, n, shorts);
+                sink.set(Id::PointSourceId, shorts);
+            }
+            if (need({ Id::GpsTime }))
+            {
+                extractField(buf + 22, pointLen, n, doubles);
+                sink.set(Id::GpsTime, doubles);
+            }
+            pos = 30;
+        }
+        else
+        {
+            unpackAll(14, { { Id::ReturnNumber, 0, 0x07 },
+                { Id::NumberOfReturns, 3, 0x07 },
+                { Id::ScanDirectionFlag, 6, 0x01 },
+                { Id::EdgeOfFlightLine, 7, 0x01 } });
+
+            if (need({ Id::Classification }))
+            {
+                extractField(buf + 15, pointLen, n, bytes);
+                sink.set(Id::Classification, bytes);
+            }
+
+            if (need({ Id::ScanAngleRank }))
+            {
+                extractField(buf + 16, pointLen, n, angleRanks);
+                floats.resize(n);
+                for (point_count_t i = 0; i < n; ++i)
+                    floats[i] = angleRanks[i];
+                sink.set(Id::ScanAngleRank, floats);
+            }
+
+            if (need({ Id::UserData }))
+            {
+                extractField(buf + 17, pointLen, n, bytes);
+                sink.set(Id::UserData, bytes);
+            }
+            if (need({ Id::PointSourceId }))
+            {
+                extractField(buf + 18, pointLen, n, shorts);
+                sink.set(Id::PointSourceId, shorts);
+            }
+            pos = 20;
+            if (h.hasTime())
+            {
+                if (need({ Id::GpsTime }))
+                {
+                    extractField(buf + pos, pointLen, n, doubles);
+                    sink.set(Id::GpsTime, doubles);
+                }
+                pos += sizeof(double);
+            }
+        }
+
+        if (h.hasColor())
+        {
+            const Id colorIds[] = { Id::Red, Id::Green, Id::Blue };
+            for (const Id& id : colorIds)
+            {
+                if (need({ id }))
+                {
+                    extractField(buf + pos, pointLen, n, shorts);
+                    sink.set(id, shorts);
+                }
+                pos += sizeof(uint16_t);
+            }
+        }
+
+        if (h.hasInfrared() && need({ Id::Infrared }))
+        {
+            extractField(buf + pos, pointLen, n, shorts);
+            sink.set(Id::Infrared, shorts);
+        }
+
+        if (m_extraDims.size())
+        {
+            const size_t baseLen = m_header.basePointLen();
+            PointRef point(view);
+            for (point_count_t i = 0; i < n; ++i)
+            {
+                LeExtractor istream(buf + i * pointLen + baseLen,
+                    pointLen - baseLen);
+                point.setPointId(first + i);
+                loadExtraDims(istream, point);
+            }
+        }
+
+        buf += n * pointLen;
+        count -= n;
+    }
+}
+
+
 void LasReader::loadExtraDims(LeExtractor& istream, PointRef& point)
 {
     for (auto& dim : m_extraDims)
@@ -950,6 +2075,11 @@ void LasReader::loadExtraDims(LeExtractor& istream, PointRef& point)
             istream.skip(dim.m_size);
             continue;
         }
+        if (!dimRequired(dim.m_dimType.m_id))
+        {
+            istream.skip(Dimension::size(dim.m_dimType.m_type));
+            continue;
+        }
 
         Everything e = Utils::extractDim(istream, dim.m_dimType.m_type);
         if (dim.m_dimType.m_xform.nonstandard())
@@ -974,6 +2104,12 @@ void LasReader::done(PointTableRef)
         handleLaszip(laszip_destroy(m_laszip));
     }
 #endif
+    m_chunkQueue.clear();
+    m_chunkDecompressor.reset();
+    m_chunkBuf.clear();
+    m_async.reset();
+    m_aheadBuf.clear();
+    unmapPoints();
     m_streamIf.reset();
 }
 
@@ -34,11 +34,18 @@
 
 #pragma once
 
+#include <deque>
+#include <future>
+
 #include <pdal/pdal_export.hpp>
 #include <pdal/pdal_features.hpp>
 #include <pdal/PDALUtils.hpp>
+#include <pdal/Polygon.hpp>
 #include <pdal/Reader.hpp>
+#include <pdal/SrsBounds.hpp>
 #include <pdal/Streamable.hpp>
+#include <pdal/util/AsyncReader.hpp>
+#include <pdal/util/FileUtils.hpp>
 
 #ifdef PDAL_HAVE_LASZIP
 #include <laszip/laszip_api.h>
@@ -48,6 +55,7 @@ using laszip_point_struct = void *;
 struct laszip_point;
 #endif
 
+#include "LasChunkIndex.hpp"
 #include "LasError.hpp"
 #include "LasHeader.hpp"
 #include "LasUtils.hpp"
@@ -60,6 +68,7 @@ class LasHeader;
 class LeExtractor;
 class PointDimensions;
 class LazPerfVlrDecompressor;
+class LazPerfVlrChunkDecompressor;
 
 class PDAL_DLL LasReader : public Reader, public Streamable
 {
@@ -84,6 +93,9 @@ protected:
     };
 
     friend class NitfReader;
+    FRIEND_TEST(LasReaderTest, batchDecode);
+    FRIEND_TEST(LasReaderTest, chunkQuery);
+    friend class LasDecodeBench;
 public:
     LasReader();
     ~LasReader();
@@ -110,6 +122,16 @@ protected:
         }
     }
 
+    // Open an additional, independent stream on the file.  Used to
+    // decompress chunks in parallel.
+    virtual LasStreamIf *openStream()
+        { return new LasStreamIf(m_filename); }
+
+    // Offset of the LAS data within the file.  Used when mapping the
+    // point data.
+    virtual uint64_t fileOffset() const
+        { return 0; }
+
     std::unique_ptr<LasStreamIf> m_streamIf;
 
 private:
@@ -121,7 +143,37 @@ private:
 
     LazPerfVlrDecompressor *m_decompressor;
     std::vector<char> m_decompressorBuf;
+    std::unique_ptr<LazPerfVlrChunkDecompressor> m_chunkDecompressor;
+    std::deque<std::future<std::vector<char>>> m_chunkQueue;
+    std::vector<char> m_chunkBuf;
+    size_t m_chunkPos;
+    size_t m_nextChunk;
+    size_t m_curChunk;
+    size_t m_chunkSkip;
+    int m_threads;
+    std::vector<char> m_batchBuf;
+    FileUtils::MapContext m_map;
+    point_count_t m_mapPoints;
+    bool m_useMmap;
+    int m_readAhead;
+    std::unique_ptr<AsyncReader> m_async;
+    std::vector<char> m_aheadBuf;
+    size_t m_aheadPos;
+    bool m_quantize;
     point_count_t m_index;
+    // Only the points at m_index + k * m_step before m_strideEnd are
+    // read when the stage that follows asks for a stride.
+    point_count_t m_step;
+    PointId m_strideEnd;
+
+    // Spatial query.  Ranges are [first, end) point indexes to read.
+    using PointRange = std::pair<PointId, PointId>;
+    SrsBounds m_bounds;
+    std::vector<Polygon> m_polys;
+    BOX3D m_queryBounds;
+    bool m_query;
+    std::vector<PointRange> m_ranges;
+    size_t m_curRange;
     StringList m_extraDimSpec;
     std::vector<ExtraDim> m_extraDims;
     IgnoreVLRList m_ignoreVLRs;
@@ -138,9 +190,15 @@ private:
     virtual void ready(PointTableRef table);
     virtual point_count_t read(PointViewPtr view, point_count_t count);
     virtual bool processOne(PointRef& point);
+    virtual point_count_t processBatch(StreamPointTable& table, PointId begin,
+        point_count_t count);
     virtual void done(PointTableRef table);
     virtual bool eof()
-        { return m_index >= getNumPoints(); }
+    {
+        if (m_query)
+            return m_curRange >= m_ranges.size();
+        return m_index >= (m_step > 1 ? m_strideEnd : getNumPoints());
+    }
 
     void handleCompressionOption();
     void setSrs(MetadataNode& m);
@@ -150,12 +208,34 @@ private:
     void loadPoint(PointRef& point, laszip_point& p);
     void loadPointV10(PointRef& point, laszip_point& p);
     void loadPointV14(PointRef& point, laszip_point& p);
+    uint32_t selectedLayers() const;
     void loadPoint(PointRef& point, char *buf, size_t bufsize);
     void loadPointV10(PointRef& point, char *buf, size_t bufsize);
     void loadPointV14(PointRef& point, char *buf, size_t bufsize);
+    void loadPoints(PointView& view, const char *buf, point_count_t count);
     void loadExtraDims(LeExtractor& istream, PointRef& data);
+    char *nextChunkPoints(point_count_t& count);
+    bool chunkWanted(size_t chunk) const;
+    void prepareQuery();
+    LasChunkIndex::ChunkList readChunkIndex();
+    void selectRanges();
+    point_count_t rangeRemaining();
+    void seekPoint(PointId idx);
+    void startStride();
+    void skipPoints(point_count_t count);
+    bool nextStridePoint(PointRef& point);
+    point_count_t readStrided(PointViewPtr view, point_count_t count);
+    bool passesFilter(PointRef& point) const;
+    bool readOne(PointRef& point);
+    point_count_t readPoints(PointView& view, point_count_t count);
+    point_count_t readQuery(PointViewPtr view, point_count_t count);
+    void mapPoints();
+    void unmapPoints();
+    point_count_t readMapped(PointRef& point, point_count_t count);
     point_count_t readFileBlock(std::vector<char>& buf,
         point_count_t maxPoints);
+    void readAheadFrom(PointId idx);
+    point_count_t readAhead(char *buf, point_count_t count);
     void handleLaszip(int result);
 
     LasReader& operator=(const LasReader&); // not implemented
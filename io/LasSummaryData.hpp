@@ -56,6 +56,7 @@ public:
     LasSummaryData();
 
     void addPoint(double x, double y, double z, int returnNumber);
+    void merge(const LasSummaryData& other);
     point_count_t getTotalNumPoints() const
         { return m_totalNumPoints; }
     BOX3D getBounds() const;
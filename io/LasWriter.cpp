@@ -57,17 +57,22 @@
 #include <vector>
 
 #include <pdal/pdal_features.hpp>
+#include <pdal/DimAccessor.hpp>
 #include <pdal/DimUtil.hpp>
 #include <pdal/PDALUtils.hpp>
 #include <pdal/PointView.hpp>
 #include <pdal/util/Algorithm.hpp>
+#include <pdal/util/Extractor.hpp>
 #include <pdal/util/FileUtils.hpp>
 #include <pdal/util/Inserter.hpp>
 #include <pdal/util/OStream.hpp>
 #include <pdal/util/Utils.hpp>
 #include <pdal/util/ProgramArgs.hpp>
+#include <pdal/util/TaskScheduler.hpp>
 
 #include "GeotiffSupport.hpp"
+#include "../filters/private/RadixSort.hpp"
+#include "../filters/private/SpaceCurve.hpp"
 
 namespace pdal
 {
@@ -84,10 +89,15 @@ static StaticPluginInfo const s_info
 
 CREATE_STATIC_STAGE(LasWriter, s_info)
 
+// Default LASzip chunk size.  Uncompressed output uses it for the chunks
+// of the chunk bounds VLR.
+static const point_count_t LAZ_CHUNK_SIZE = 50000;
+
 std::string LasWriter::getName() const { return s_info.name; }
 
 LasWriter::LasWriter() : m_compressor(nullptr), m_ostream(NULL),
-    m_compression(LasCompression::None), m_srsCnt(0)
+    m_compression(LasCompression::None), m_srsCnt(0),
+    m_chunkSize(LAZ_CHUNK_SIZE)
 {}
 
 
@@ -146,6 +156,14 @@ void LasWriter::addArgs(ProgramArgs& args)
     args.add("offset_y", "Y offset", m_offsetY);
     args.add("offset_z", "Z offset", m_offsetZ);
     args.add("vlrs", "List of VLRs to set", m_userVLRs);
+    args.add("threads", "Number of threads used to encode points and "
+        "compress LAZ chunks",
+        m_threads, 1);
+    m_chunkBoundsArg = &args.add("chunk_bounds", "Write the extents of "
+        "each chunk of points to a VLR so that readers can skip chunks",
+        m_writeChunkBounds);
+    args.add("order", "Order of points in the output: 'none', 'morton', "
+        "'hilbert' or 'gpstime'", m_order, "none");
 }
 
 void LasWriter::initialize()
@@ -178,6 +196,11 @@ void LasWriter::initialize()
     {
         throwError(err.what());
     }
+    m_order = Utils::tolower(m_order);
+    if (m_order != "none" && m_order != "morton" && m_order != "hilbert" &&
+        m_order != "gpstime")
+        throwError("Invalid order '" + m_order + "'.  Must be 'none', "
+            "'morton', 'hilbert' or 'gpstime'.");
     fillForwardList();
 }
 
@@ -229,6 +252,45 @@ void LasWriter::prepared(PointTableRef table)
             "(" << Dimension::interpretationName(dim.m_dimType.m_type) <<
             ") " << " to LAS extra bytes." << std::endl;
     }
+
+    if (m_order == "gpstime" && !layout->hasDim(Dimension::Id::GpsTime))
+        throwError("Option 'order' is 'gpstime' but points have no "
+            "GpsTime dimension.");
+}
+
+
+// Ordering points needs all of a view's points, so it can't be done when
+// streaming.
+bool LasWriter::pipelineStreamable() const
+{
+    if (m_order != "none")
+        return false;
+    return Streamable::pipelineStreamable();
+}
+
+
+const Stage *LasWriter::findNonstreamable() const
+{
+    if (m_order != "none")
+        return this;
+    return Streamable::findNonstreamable();
+}
+
+
+// The dimensions written depend on the point format, which isn't known
+// until the file is written when it is forwarded.
+bool LasWriter::addUsedDims(PointLayoutPtr /*layout*/,
+    Dimension::IdList& dims) const
+{
+    if (m_forwards.count("dataformat_id"))
+        return false;
+
+    Dimension::IdList ids = m_lasHeader.usedDims();
+    dims.insert(dims.end(), ids.begin(), ids.end());
+    dims.push_back(Dimension::Id::ClassFlags);
+    for (auto& dim : m_extraDims)
+        dims.push_back(dim.m_dimType.m_id);
+    return true;
 }
 
 
@@ -330,6 +392,17 @@ void LasWriter::prepOutput(std::ostream *outStream, const SpatialReference& srs)
     // Spatial reference can potentially change for multiple output files.
     addSpatialRefVlrs();
 
+    // Spatially ordered points make chunk bounds tight, so write them
+    // unless the user said otherwise.
+    if ((m_order == "morton" || m_order == "hilbert") &&
+        !m_chunkBoundsArg->set())
+        m_writeChunkBounds = m_lasHeader.versionAtLeast(1, 4);
+    if (m_writeChunkBounds && !m_lasHeader.versionAtLeast(1, 4))
+        throwError("Option 'chunk_bounds' requires LAS version 1.4 "
+            "output.");
+    m_chunks.clear();
+    m_chunkSize = LAZ_CHUNK_SIZE;
+
     m_summaryData.reset(new LasSummaryData());
     m_ostream = outStream;
     if (m_lasHeader.compressed())
@@ -726,7 +799,8 @@ void LasWriter::readyLazPerfCompression()
 
     delete m_compressor;
     m_compressor = new LazPerfVlrCompressor(*m_ostream, schema,
-        zipvlr.chunk_size);
+        zipvlr.chunk_size, m_threads);
+    m_chunkSize = zipvlr.chunk_size;
 #endif
 }
 
@@ -783,6 +857,53 @@ bool LasWriter::processOne(PointRef& point)
 }
 
 
+// This is only called in stream mode.  Points other than the first are
+// packed into a single buffer and written together.
+point_count_t LasWriter::processBatch(StreamPointTable& table, PointId begin,
+    point_count_t count)
+{
+    // The LASzip API only handles individual points.
+    if (m_compression == LasCompression::LasZip)
+        return Streamable::processBatch(table, begin, count);
+
+    PointRef point(table, begin);
+    StreamPointTable::IdRange ids = table.activeIds(begin, count);
+    const PointId *it = ids.begin();
+
+    // The first point may set automatic offsets, so handle it separately.
+    for (; m_firstPoint && it != ids.end(); ++it)
+    {
+        point.setPointId(*it);
+        if (!LasWriter::processOne(point))
+            table.setSkip(*it);
+    }
+
+    const size_t pointLen = m_lasHeader.pointLen();
+    const size_t remaining = ids.end() - it;
+    if (m_pointBuf.size() < remaining * pointLen)
+        m_pointBuf.resize(remaining * pointLen);
+    LeInserter ostream(m_pointBuf.data(), m_pointBuf.size());
+    point_count_t filled = 0;
+    for (; it != ids.end(); ++it)
+    {
+        const PointId idx = *it;
+        point.setPointId(idx);
+        if (fillPointBuf(point, ostream))
+            filled++;
+        else
+            table.setSkip(idx);
+    }
+
+    if (m_writeChunkBounds)
+        addChunkBounds(m_pointBuf.data(), filled);
+    if (m_compression == LasCompression::LazPerf)
+        writeLazPerfBuf(m_pointBuf.data(), pointLen, filled);
+    else
+        m_ostream->write(m_pointBuf.data(), filled * pointLen);
+    return count;
+}
+
+
 // This is separated from processOne so that we're sure when processOne is
 // called we know we're in stream mode.
 bool LasWriter::processPoint(PointRef& point)
@@ -797,6 +918,8 @@ bool LasWriter::processPoint(PointRef& point)
         LeInserter ostream(m_pointBuf.data(), m_pointBuf.size());
         if (!fillPointBuf(point, ostream))
             return false;
+        if (m_writeChunkBounds)
+            addChunkBounds(m_pointBuf.data(), 1);
         writeLazPerfBuf(m_pointBuf.data(), m_lasHeader.pointLen(), 1);
     }
     else
@@ -804,6 +927,8 @@ bool LasWriter::processPoint(PointRef& point)
         LeInserter ostream(m_pointBuf.data(), m_pointBuf.size());
         if (!fillPointBuf(point, ostream))
             return false;
+        if (m_writeChunkBounds)
+            addChunkBounds(m_pointBuf.data(), 1);
         m_ostream->write(m_pointBuf.data(), m_lasHeader.pointLen());
     }
     return true;
@@ -816,8 +941,54 @@ void LasWriter::prerunFile(const PointViewSet& pvSet)
 }
 
 
-void LasWriter::writeView(const PointViewPtr view)
+// Make a copy of a view with its points in the order requested by the
+// 'order' option.  The sort is stable, so points with the same key stay
+// in input order.
+PointViewPtr LasWriter::ordered(PointViewPtr view)
 {
+    const unsigned threads = (unsigned)(std::max)(m_threads, 1);
+    radix::EntryList codes;
+    if (m_order == "gpstime")
+    {
+        DimAccessor<double> tAcc(*view, Dimension::Id::GpsTime);
+        codes = radix::makeEntries(view->size(), threads,
+            [&](PointId idx)
+            { return radix::orderedKey(tAcc.get(idx)); });
+    }
+    else
+    {
+        BOX2D bounds;
+        view->calculateBounds(bounds);
+        const double xrange = bounds.maxx - bounds.minx;
+        const double yrange = bounds.maxy - bounds.miny;
+
+        DimAccessor<double> xAcc(*view, Dimension::Id::X);
+        DimAccessor<double> yAcc(*view, Dimension::Id::Y);
+        const bool hilbert = (m_order == "hilbert");
+        codes = radix::makeEntries(view->size(), threads,
+            [&](PointId idx)
+            {
+                using namespace spacecurve;
+
+                uint32_t x = gridPos(xAcc.get(idx), bounds.minx, xrange);
+                uint32_t y = gridPos(yAcc.get(idx), bounds.miny, yrange);
+                return hilbert ? hilbertCode(x, y) : mortonCode(x, y);
+            });
+    }
+    radix::sort(codes, threads);
+
+    PointViewPtr outView = view->makeNew();
+    for (const radix::Entry& e : codes)
+        outView->appendPoint(*view, e.id);
+    return outView;
+}
+
+
+void LasWriter::writeView(const PointViewPtr inView)
+{
+    const PointViewPtr view =
+        (m_order == "none" || inView->size() < 2) ? inView : ordered(inView);
+
     Utils::writeProgress(m_progressFd, "READYVIEW",
         std::to_string(view->size()));
 
@@ -836,24 +1007,49 @@ void LasWriter::writeView(const PointViewPtr view)
     }
     else
     {
-        // Make a buffer of at most a meg.
-        m_pointBuf.resize((std::min)((point_count_t)1000000,
-                    pointLen * view->size()));
+        // Encode blocks of at most a meg, one per thread, then write
+        // (or compress) the blocks in order.
+        const point_count_t blockSize =
+            (std::max)((point_count_t)1, 1000000 / pointLen);
+        const size_t numBlocks = (size_t)(std::max)(m_threads, 1);
+        std::vector<std::vector<char>> bufs(numBlocks);
+        std::vector<std::unique_ptr<LasSummaryData>> summaries(numBlocks);
+        std::vector<point_count_t> filled(numBlocks);
+        std::vector<PointId> starts(numBlocks);
+        std::vector<point_count_t> counts(numBlocks);
 
         const PointView& viewRef(*view.get());
 
-        point_count_t remaining = view->size();
         PointId idx = 0;
-        while (remaining)
+        while (idx < view->size())
         {
-            point_count_t filled = fillWriteBuf(viewRef, idx, m_pointBuf);
-            idx += filled;
-            remaining -= filled;
-
-            if (m_compression == LasCompression::LazPerf)
-                writeLazPerfBuf(m_pointBuf.data(), pointLen, filled);
-            else
-                m_ostream->write(m_pointBuf.data(), filled * pointLen);
+            size_t used = 0;
+            for (; used < numBlocks && idx < view->size(); ++used)
+            {
+                point_count_t count = (std::min)(blockSize,
+                    view->size() - idx);
+                bufs[used].resize(count * pointLen);
+                summaries[used].reset(new LasSummaryData());
+                starts[used] = idx;
+                counts[used] = count;
+                idx += count;
+            }
+            parallelFor(used, numBlocks, [&](std::size_t i)
+            {
+                filled[i] = fillWriteBuf(viewRef, starts[i], counts[i],
+                    bufs[i].data(), *summaries[i]);
+            });
+
+            for (size_t i = 0; i < used; ++i)
+            {
+                m_summaryData->merge(*summaries[i]);
+                if (m_writeChunkBounds)
+                    addChunkBounds(bufs[i].data(), filled[i]);
+                if (m_compression == LasCompression::LazPerf)
+                    writeLazPerfBuf(bufs[i].data(), pointLen, filled[i]);
+                else
+                    m_ostream->write(bufs[i].data(), filled[i] * pointLen);
+            }
         }
     }
     Utils::writeProgress(m_progressFd, "DONEVIEW",
@@ -987,6 +1183,8 @@ bool LasWriter::writeLasZipBuf(PointRef& point)
     p.num_extra_bytes = m_extraByteLen;
 
     m_summaryData->addPoint(xOrig, yOrig, zOrig, returnNumber);
+    if (m_writeChunkBounds)
+        addChunkPoint(p.X, p.Y, p.Z);
 
     handleLaszip(laszip_set_point(m_laszip, &p));
     handleLaszip(laszip_write_point(m_laszip));
@@ -995,6 +1193,61 @@ bool LasWriter::writeLasZipBuf(PointRef& point)
 }
 
 
+// Track the extents of each chunk of points written.  'buf' holds 'count'
+// point records, which always start with the scaled X, Y and Z.
+void LasWriter::addChunkBounds(const char *buf, point_count_t count)
+{
+    const size_t pointLen = m_lasHeader.pointLen();
+    for (point_count_t i = 0; i < count; ++i)
+    {
+        int32_t x, y, z;
+
+        LeExtractor in(buf, 3 * sizeof(int32_t));
+        in >> x >> y >> z;
+        addChunkPoint(x, y, z);
+        buf += pointLen;
+    }
+}
+
+
+// Chunk bounds are kept in scaled units until the file is finished,
+// since the scaling of the first point may not be final.
+void LasWriter::addChunkPoint(int32_t x, int32_t y, int32_t z)
+{
+    if (m_chunks.empty() || m_chunks.back().m_count == m_chunkSize)
+    {
+        PointId first = m_chunks.empty() ? 0 :
+            m_chunks.back().m_first + m_chunks.back().m_count;
+        m_chunks.push_back({ first, 0, BOX3D() });
+    }
+    LasChunkIndex::Chunk& chunk = m_chunks.back();
+    chunk.m_bounds.grow(x, y, z);
+    chunk.m_count++;
+}
+
+
+void LasWriter::writeChunkBoundsVlr(OLeStream& out)
+{
+    auto unscale = [](const XForm& xform, double& v)
+        { v = v * xform.m_scale.m_val + xform.m_offset.m_val; };
+
+    for (LasChunkIndex::Chunk& chunk : m_chunks)
+    {
+        BOX3D& b = chunk.m_bounds;
+        unscale(m_scaling.m_xXform, b.minx);
+        unscale(m_scaling.m_xXform, b.maxx);
+        unscale(m_scaling.m_yXform, b.miny);
+        unscale(m_scaling.m_yXform, b.maxy);
+        unscale(m_scaling.m_zXform, b.minz);
+        unscale(m_scaling.m_zXform, b.maxz);
+    }
+    std::vector<uint8_t> data = LasChunkIndex::chunkBoundsData(m_chunks);
+    out << ExtLasVLR(PDAL_USER_ID, PDAL_CHUNK_BOUNDS_RECORD_ID,
+        "PDAL chunk bounds", data);
+    m_lasHeader.setEVlrCount(m_eVlrs.size() + 1);
+}
+
+
 void LasWriter::writeLazPerfBuf(char *pos, size_t pointLen,
     point_count_t numPts)
 {
@@ -1008,16 +1261,17 @@ void LasWriter::writeLazPerfBuf(char *pos, size_t pointLen,
 }
 
 
-bool LasWriter::fillPointBuf(PointRef& point, LeInserter& ostream)
+// Fetch the return number and number of returns of a point.  Returns false
+// if the point should be discarded.
+bool LasWriter::getReturns(PointRef& point, uint8_t& returnNumber,
+    uint8_t& numberOfReturns)
 {
-    bool has14Format = m_lasHeader.has14Format();
     static const size_t maxReturnCount = m_lasHeader.maxReturnCount();
 
-    // we always write the base fields
     using namespace Dimension;
 
-    uint8_t returnNumber(1);
-    uint8_t numberOfReturns(1);
+    returnNumber = 1;
+    numberOfReturns = 1;
     if (point.hasDim(Id::ReturnNumber))
         returnNumber = point.getFieldAs<uint8_t>(Id::ReturnNumber);
     if (point.hasDim(Id::NumberOfReturns))
@@ -1032,16 +1286,35 @@ bool LasWriter::fillPointBuf(PointRef& point, LeInserter& ostream)
             numberOfReturns = maxReturnCount;
         }
     }
+    return true;
+}
+
+
+void LasWriter::throwScaleError(double d, Dimension::Id dim)
+{
+    throwError("Unable to convert scaled value (" +
+        Utils::toString(d) + ") to "
+        "int32 for dimension '" + Dimension::name(dim) +
+        "' when writing LAS/LAZ file " + m_curFilename + ".");
+}
+
+
+bool LasWriter::fillPointBuf(PointRef& point, LeInserter& ostream)
+{
+    // we always write the base fields
+    using namespace Dimension;
+
+    uint8_t returnNumber;
+    uint8_t numberOfReturns;
+    if (!getReturns(point, returnNumber, numberOfReturns))
+        return false;
 
     auto converter = [this](double d, Dimension::Id dim) -> int32_t
     {
         int32_t i(0);
 
         if (!Utils::numericCast(d, i))
-            throwError("Unable to convert scaled value (" +
-                Utils::toString(d) + ") to "
-                "int32 for dimension '" + Dimension::name(dim) +
-                "' when writing LAS/LAZ file " + m_curFilename + ".");
+            throwScaleError(d, dim);
         return i;
     };
 
@@ -1056,6 +1329,21 @@ bool LasWriter::fillPointBuf(PointRef& point, LeInserter& ostream)
     ostream << converter(y, Id::Y);
     ostream << converter(z, Id::Z);
 
+    fillPointFields(point, ostream, returnNumber, numberOfReturns);
+
+    m_summaryData->addPoint(xOrig, yOrig, zOrig, returnNumber);
+    return true;
+}
+
+
+// Write the fields of a point that follow X, Y and Z.
+void LasWriter::fillPointFields(PointRef& point, LeInserter& ostream,
+    uint8_t returnNumber, uint8_t numberOfReturns)
+{
+    bool has14Format = m_lasHeader.has14Format();
+
+    using namespace Dimension;
+
     ostream << point.getFieldAs<uint16_t>(Id::Intensity);
 
     uint8_t scanChannel = point.getFieldAs<uint8_t>(Id::ScanChannel);
@@ -1121,27 +1409,111 @@ bool LasWriter::fillPointBuf(PointRef& point, LeInserter& ostream)
         point.getField((char *)&e, dim.m_dimType.m_id, dim.m_dimType.m_type);
         Utils::insertDim(ostream, dim.m_dimType.m_type, e);
     }
+}
 
-    m_summaryData->addPoint(xOrig, yOrig, zOrig, returnNumber);
-    return true;
+
+// Scale, round and range-check a column of coordinate values.  The loop
+// has no branches or calls so that the compiler can vectorize it.
+void LasWriter::scaleColumn(const std::vector<double>& in,
+    const XForm& xform, Dimension::Id dim, std::vector<int32_t>& out)
+{
+    const double offset = xform.m_offset.m_val;
+    const double scale = xform.m_scale.m_val;
+    const double lo = (double)std::numeric_limits<int32_t>::lowest();
+    const double hi = (double)(std::numeric_limits<int32_t>::max)();
+
+    bool ok = true;
+    for (size_t i = 0; i < in.size(); ++i)
+    {
+        double d = Utils::sround((in[i] - offset) / scale);
+        bool inRange = (d >= lo && d <= hi);
+        ok &= inRange;
+        out[i] = inRange ? static_cast<int32_t>(d) : 0;
+    }
+    if (ok)
+        return;
+
+    for (size_t i = 0; i < in.size(); ++i)
+    {
+        double d = xform.toScaled(in[i]);
+        int32_t val;
+        if (!Utils::numericCast(d, val))
+            throwScaleError(d, dim);
+    }
 }
 
 
+// Encode points of a view starting at startId into a buffer, which must be
+// large enough to hold count points.  Summary data for the encoded points
+// is added to 'summary' so that blocks can be encoded concurrently.
 point_count_t LasWriter::fillWriteBuf(const PointView& view,
-    PointId startId, std::vector<char>& buf)
+    PointId startId, point_count_t count, char *buf, LasSummaryData& summary)
 {
-    point_count_t blocksize = buf.size() / m_lasHeader.pointLen();
-    blocksize = (std::min)(blocksize, view.size() - startId);
-    PointId lastId = startId + blocksize;
+    using namespace Dimension;
+
+    PointRef point = (const_cast<PointView&>(view)).point(startId);
 
-    LeInserter ostream(buf.data(), buf.size());
-    PointRef point = (const_cast<PointView&>(view)).point(0);
-    for (PointId idx = startId; idx < lastId; idx++)
+    std::vector<PointId> ids;
+    std::vector<uint8_t> returnNumbers;
+    std::vector<uint8_t> numbersOfReturns;
+    ids.reserve(count);
+    returnNumbers.reserve(count);
+    numbersOfReturns.reserve(count);
+    for (PointId idx = startId; idx < startId + count; ++idx)
     {
+        uint8_t returnNumber;
+        uint8_t numberOfReturns;
+
         point.setPointId(idx);
-        fillPointBuf(point, ostream);
+        if (getReturns(point, returnNumber, numberOfReturns))
+        {
+            ids.push_back(idx);
+            returnNumbers.push_back(returnNumber);
+            numbersOfReturns.push_back(numberOfReturns);
+        }
+    }
+
+    const size_t filled = ids.size();
+
+    // Coordinates stored as integers with the scale and offset of the
+    // output (see PointLayout::quantizeDim()) are copied without being
+    // scaled again.
+    auto coords = [&view, &ids, filled, this](Id id, const XForm& xform,
+        std::vector<double>& d, std::vector<int32_t>& out)
+    {
+        d.resize(filled);
+        out.resize(filled);
+        const Dimension::Detail *dd = view.layout()->dimDetail(id);
+        if (dd->quantized() && dd->scale() == xform.m_scale.m_val &&
+            dd->quantOffset() == xform.m_offset.m_val)
+        {
+            for (size_t i = 0; i < filled; ++i)
+            {
+                out[i] = view.getQuantized(id, ids[i]);
+                d[i] = dd->fromStored(out[i]);
+            }
+            return;
+        }
+        for (size_t i = 0; i < filled; ++i)
+            d[i] = view.getFieldAs<double>(id, ids[i]);
+        scaleColumn(d, xform, id, out);
+    };
+
+    std::vector<double> x, y, z;
+    std::vector<int32_t> xi, yi, zi;
+    coords(Id::X, m_scaling.m_xXform, x, xi);
+    coords(Id::Y, m_scaling.m_yXform, y, yi);
+    coords(Id::Z, m_scaling.m_zXform, z, zi);
+
+    LeInserter ostream(buf, filled * m_lasHeader.pointLen());
+    for (size_t i = 0; i < filled; ++i)
+    {
+        point.setPointId(ids[i]);
+        ostream << xi[i] << yi[i] << zi[i];
+        fillPointFields(point, ostream, returnNumbers[i], numbersOfReturns[i]);
+        summary.addPoint(x[i], y[i], z[i], returnNumbers[i]);
     }
-    return blocksize;
+    return filled;
 }
 
 
@@ -1150,8 +1522,9 @@ void LasWriter::doneFile()
     finishOutput();
     Utils::writeProgress(m_progressFd, "DONEFILE", m_curFilename);
     getMetadata().addList("filename", m_curFilename);
-    delete m_ostream;
+    std::ostream *out = m_ostream;
     m_ostream = NULL;
+    Utils::closeFile(out);
 }
 
 
@@ -1175,6 +1548,8 @@ void LasWriter::finishOutput()
         ExtLasVLR evlr = *vi;
         out << evlr;
     }
+    if (m_writeChunkBounds)
+        writeChunkBoundsVlr(out);
 
     // Reset the offset/scale since it may have been auto-computed
     try
@@ -39,6 +39,7 @@
 #include <pdal/Streamable.hpp>
 
 #include "HeaderVal.hpp"
+#include "LasChunkIndex.hpp"
 #include "LasError.hpp"
 #include "LasHeader.hpp"
 #include "LasUtils.hpp"
@@ -101,6 +102,7 @@ private:
     std::set<std::string> m_forwards;
     bool m_forwardVlrs = false;
     LasCompression m_compression;
+    int m_threads;
     std::vector<char> m_pointBuf;
     SpatialReference m_aSrs;
     int m_srsCnt;
@@ -129,10 +131,19 @@ private:
     bool m_writePDALMetadata;
     std::vector<ExtLasVLR> m_userVLRs;
     bool m_firstPoint;
+    bool m_writeChunkBounds;
+    Arg *m_chunkBoundsArg;
+    std::string m_order;
+    point_count_t m_chunkSize;
+    LasChunkIndex::ChunkList m_chunks;
 
     virtual void addArgs(ProgramArgs& args);
     virtual void initialize();
     virtual void prepared(PointTableRef table);
+    virtual bool pipelineStreamable() const;
+    virtual const Stage *findNonstreamable() const;
+    virtual bool addUsedDims(PointLayoutPtr layout,
+        Dimension::IdList& dims) const;
     virtual void readyTable(PointTableRef table);
     virtual void readyFile(const std::string& filename,
         const SpatialReference& srs);
@@ -140,7 +151,10 @@ private:
         { return m_aSrs.valid(); }
     void prerunFile(const PointViewSet& pvSet);
     virtual void writeView(const PointViewPtr view);
+    PointViewPtr ordered(PointViewPtr view);
     virtual bool processOne(PointRef& point);
+    virtual point_count_t processBatch(StreamPointTable& table, PointId begin,
+        point_count_t count);
     void spatialReferenceChanged(const SpatialReference& srs);
     virtual void doneFile();
 
@@ -152,11 +166,21 @@ private:
         const MetadataNode& base);
     void handleHeaderForwards(MetadataNode& forward);
     void fillHeader();
+    bool getReturns(PointRef& point, uint8_t& returnNumber,
+        uint8_t& numberOfReturns);
+    void throwScaleError(double d, Dimension::Id dim);
     bool fillPointBuf(PointRef& point, LeInserter& ostream);
+    void fillPointFields(PointRef& point, LeInserter& ostream,
+        uint8_t returnNumber, uint8_t numberOfReturns);
+    void scaleColumn(const std::vector<double>& in, const XForm& xform,
+        Dimension::Id dim, std::vector<int32_t>& out);
     point_count_t fillWriteBuf(const PointView& view, PointId startId,
-        std::vector<char>& buf);
+        point_count_t count, char *buf, LasSummaryData& summary);
     bool writeLasZipBuf(PointRef& point);
     void writeLazPerfBuf(char *data, size_t pointLen, point_count_t numPts);
+    void addChunkBounds(const char *buf, point_count_t count);
+    void addChunkPoint(int32_t x, int32_t y, int32_t z);
+    void writeChunkBoundsVlr(OLeStream& out);
     void addForwardVlrs();
     void addMetadataVlr(MetadataNode& forward);
     void addPipelineVlr();
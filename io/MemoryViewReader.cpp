@@ -32,6 +32,10 @@
 * OF SUCH DAMAGE.
 ****************************************************************************/
 
+#include <cstring>
+
+#include <pdal/PointTable.hpp>
+
 #include "MemoryViewReader.hpp"
 
 namespace pdal
@@ -166,9 +170,129 @@ void MemoryViewReader::prepared(PointTableRef)
 
 void MemoryViewReader::ready(PointTableRef)
 {
-    if (!m_incrementer)
-        throwError("Points cannot be read without calling setIncrementer().");
+    if (!m_incrementer && !m_columnIncrementer)
+        throwError("Points cannot be read without calling setIncrementer() "
+            "or setColumnIncrementer().");
+    if (m_columnIncrementer && m_fields.empty())
+        throwError("Can't read columns without any fields.");
     m_index = 0;
+    m_batchSize = 0;
+    m_batchPos = 0;
+}
+
+
+bool MemoryViewReader::nextBatch()
+{
+    m_columns.clear();
+    m_batchSize = m_columnIncrementer(m_index, m_columns);
+    m_batchPos = 0;
+    if (m_batchSize && m_columns.size() != m_fields.size())
+        throwError("Column incrementer provided " +
+            std::to_string(m_columns.size()) + " columns for " +
+            std::to_string(m_fields.size()) + " fields.");
+    return m_batchSize != 0;
+}
+
+
+namespace
+{
+
+// Copy a column of values of type S to the array storing dimension
+// values of type T.
+template<typename T>
+struct ColumnConvert
+{
+    typedef bool result_type;
+
+    T *m_dst;
+    const char *m_src;
+    point_count_t m_count;
+
+    ColumnConvert(T *dst, const char *src, point_count_t count) :
+        m_dst(dst), m_src(src), m_count(count)
+    {}
+
+    template<typename S>
+    bool operator()(S)
+    {
+        if (std::is_same<S, T>::value)
+        {
+            std::memcpy(m_dst, m_src, m_count * sizeof(T));
+            return true;
+        }
+
+        bool ok = true;
+        for (point_count_t i = 0; i < m_count; ++i)
+        {
+            S s;
+            std::memcpy(&s, m_src + i * sizeof(S), sizeof(S));
+            ok &= Utils::numericCast(s, m_dst[i]);
+        }
+        return ok;
+    }
+};
+
+// Find the storage type of a dimension and copy a column into it.
+struct ColumnCopy
+{
+    typedef bool result_type;
+
+    BasePointTable& m_table;
+    Dimension::Id m_id;
+    Dimension::Type m_srcType;
+    const char *m_src;
+    PointId m_first;
+    point_count_t m_count;
+
+    ColumnCopy(BasePointTable& table, Dimension::Id id,
+            Dimension::Type srcType, const char *src, PointId first,
+            point_count_t count) :
+        m_table(table), m_id(id), m_srcType(srcType), m_src(src),
+        m_first(first), m_count(count)
+    {}
+
+    template<typename T>
+    bool operator()(T)
+    {
+        T *dst;
+        try
+        {
+            dst = m_table.dimensionData<T>(m_id) + m_first;
+        }
+        catch (const pdal_error&)
+        {
+            return false;
+        }
+        return Dimension::visit(m_srcType,
+            ColumnConvert<T>(dst, m_src, m_count));
+    }
+};
+
+} // unnamed namespace
+
+
+void MemoryViewReader::readColumn(PointView& view, const FullField& f,
+    const char *src, PointId start, point_count_t count)
+{
+    BasePointTable& table = view.table();
+    if (table.columnData())
+    {
+        // Points were just appended, so they're normally consecutive in
+        // the table.
+        const PointId first = view.tableIndex(start);
+        if (view.tableIndex(start + count - 1) == first + count - 1)
+        {
+            const Dimension::Type type = view.layout()->dimType(f.m_id);
+            if (Dimension::visit(type, ColumnCopy(table, f.m_id, f.m_type,
+                    src, first, count)))
+                return;
+        }
+    }
+
+    // Values that don't fit the storage type are reported by setField().
+    const size_t size = Dimension::size(f.m_type);
+    for (point_count_t i = 0; i < count; ++i)
+        view.setField(f.m_id, f.m_type, start + i, src + i * size);
 }
 
 
@@ -178,37 +302,94 @@ point_count_t MemoryViewReader::read(PointViewPtr v, point_count_t numPts)
     point_count_t cnt = 0;
 
     PointRef point(*v);
+    if (!m_columnIncrementer)
+    {
+        while (cnt < numPts)
+        {
+            point.setPointId(idx);
+            if (!processOne(point))
+                break;
+            cnt++;
+            idx++;
+        }
+        return cnt;
+    }
+
     while (cnt < numPts)
     {
-        point.setPointId(idx);
-        if (!processOne(point))
+        if (m_batchPos == m_batchSize && !nextBatch())
             break;
-        cnt++;
-        idx++;
+        const point_count_t count =
+            (std::min)(numPts - cnt, m_batchSize - m_batchPos);
+
+        // Setting the first field appends the points.
+        const FullField& f0 = m_fields.front();
+        const size_t size0 = Dimension::size(f0.m_type);
+        const char *src0 = m_columns.front() + m_batchPos * size0;
+        for (point_count_t i = 0; i < count; ++i)
+            v->setField(f0.m_id, f0.m_type, idx + i, src0 + i * size0);
+
+        for (size_t i = 1; i < m_fields.size(); ++i)
+        {
+            const FullField& f = m_fields[i];
+            const char *src = m_columns[i] +
+                m_batchPos * Dimension::size(f.m_type);
+            readColumn(*v, f, src, idx, count);
+        }
+
+        if (m_shape.valid())
+            for (point_count_t i = 0; i < count; ++i)
+            {
+                point.setPointId(idx + i);
+                setShapeXYZ(point, m_index + i);
+            }
+
+        m_batchPos += count;
+        m_index += count;
+        cnt += count;
+        idx += count;
     }
     return cnt;
 }
 
 
-bool MemoryViewReader::processOne(PointRef& point)
+void MemoryViewReader::setShapeXYZ(PointRef& point, PointId index)
 {
-    char *base = m_incrementer(m_index);
-    if (!base)
-        return false;
+    point.setField(Dimension::Id::X, (index % m_xIter) / m_xDiv);
+    point.setField(Dimension::Id::Y, (index % m_yIter) / m_yDiv);
+    point.setField(Dimension::Id::Z, (index % m_zIter) / m_zDiv);
+}
 
-    for (const FullField& f : m_fields)
-        point.setField(f.m_id, f.m_type, (void *)(base + f.m_offset));
 
-    if (m_shape.valid())
+bool MemoryViewReader::processOne(PointRef& point)
+{
+    if (m_columnIncrementer)
     {
-        point.setField(Dimension::Id::X, (m_index % m_xIter) / m_xDiv);
-        point.setField(Dimension::Id::Y, (m_index % m_yIter) / m_yDiv);
-        point.setField(Dimension::Id::Z, (m_index % m_zIter) / m_zDiv);
+        if (m_batchPos == m_batchSize && !nextBatch())
+            return false;
+        for (size_t i = 0; i < m_fields.size(); ++i)
+        {
+            const FullField& f = m_fields[i];
+            point.setField(f.m_id, f.m_type, (void *)(m_columns[i] +
+                m_batchPos * Dimension::size(f.m_type)));
+        }
+        m_batchPos++;
+    }
+    else
+    {
+        char *base = m_incrementer(m_index);
+        if (!base)
+            return false;
+
+        for (const FullField& f : m_fields)
+            point.setField(f.m_id, f.m_type, (void *)(base + f.m_offset));
     }
 
+    if (m_shape.valid())
+        setShapeXYZ(point, m_index);
+
     m_index++;
     return true;
 }
 
 } // namespace pdal
-
@@ -96,7 +96,9 @@ public:
         Dimension::Type m_type;
         size_t m_offset;
     };
-    using PointIncrementer = std::function<char *(PointId)>; 
+    using PointIncrementer = std::function<char *(PointId)>;
+    using ColumnIncrementer =
+        std::function<point_count_t(PointId, std::vector<char *>&)>;
 
 private:
     struct FullField : public Field
@@ -133,6 +135,24 @@ public:
         m_incrementer = inc;
     }
 
+    /**
+      Set a function that provides points in batches of columns, one
+      column (array of values) per field.  Field offsets are ignored when
+      reading columns.  Values of fields whose type matches the storage
+      type of their dimension are block-copied into a ColumnPointTable.
+
+      \param inc  A function that is called by MemoryViewReader with the
+        ID of the first point of the next batch and a vector to fill with
+        a pointer to the values of each field, in the order the fields
+        were pushed.  The function should return the number of points in
+        the batch, or 0 if there are no more points to read.  The column
+        pointers must remain valid until the function is called again.
+    */
+    void setColumnIncrementer(ColumnIncrementer inc)
+    {
+        m_columnIncrementer = inc;
+    }
+
 private:
     /**
     */
@@ -182,8 +202,17 @@ private:
     */
     virtual bool processOne(PointRef& point);
 
+    bool nextBatch();
+    void readColumn(PointView& view, const FullField& f, const char *src,
+        PointId start, point_count_t count);
+    void setShapeXYZ(PointRef& point, PointId index);
+
 private:
     PointIncrementer m_incrementer;
+    ColumnIncrementer m_columnIncrementer;
+    std::vector<char *> m_columns;
+    point_count_t m_batchSize;
+    point_count_t m_batchPos;
     std::vector<FullField> m_fields;
     bool m_prepared;
     PointId m_index;
@@ -0,0 +1,294 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#include "MultiReader.hpp"
+
+#include <mutex>
+#include <thread>
+
+#include <pdal/PointTable.hpp>
+#include <pdal/PointView.hpp>
+#include <pdal/util/FileUtils.hpp>
+#include <pdal/util/ProgramArgs.hpp>
+
+#include "private/MemberQueue.hpp"
+
+namespace pdal
+{
+
+static StaticPluginInfo const s_info
+{
+    "readers.multi",
+    "Read a set of files as one point cloud.",
+    "http://pdal.io/stages/readers.multi.html",
+    {}
+};
+
+CREATE_STATIC_STAGE(MultiReader, s_info)
+
+std::string MultiReader::getName() const { return s_info.name; }
+
+
+MultiReader::MultiReader() : m_queue(new MemberQueue), m_layout(nullptr)
+{}
+
+
+MultiReader::~MultiReader()
+{}
+
+
+void MultiReader::addArgs(ProgramArgs& args)
+{
+    args.add("files", "List of files to read", m_fileList);
+    args.add("threads", "Number of files to read at once", m_threads, 1);
+    args.add("view_per_file", "Put the points of each file in a point view "
+        "of its own", m_viewPerFile, false);
+}
+
+
+// Create the reader of a file.
+Stage *MultiReader::createMember(const std::string& filename)
+{
+    std::string driver = m_factory.inferReaderDriver(filename);
+    Stage *reader = driver.size() ? m_factory.createStage(driver) : nullptr;
+    if (!reader)
+        throwError("Unable to create reader for file '" + filename + "'.");
+    Options readerOptions;
+    readerOptions.add("filename", filename);
+    reader->setOptions(readerOptions);
+    return reader;
+}
+
+
+// Find the files and inspect them, several at once, to find the
+// dimensions of the output.
+void MultiReader::initialize()
+{
+    if (m_threads < 1)
+        throwError("Option 'threads' must be at least 1.");
+
+    m_files = m_fileList;
+    if (m_filename.size())
+    {
+        StringList globbed = FileUtils::glob(m_filename);
+        if (globbed.empty())
+            throwError("No files match '" + m_filename + "'.");
+        m_files.insert(m_files.end(), globbed.begin(), globbed.end());
+    }
+    if (m_files.empty())
+        throwError("No files to read.  Set 'filename' or 'files'.");
+
+    std::vector<Stage *> stages;
+    for (const std::string& filename : m_files)
+        stages.push_back(createMember(filename));
+
+    // Inspection only provides dimension names, so dimensions that aren't
+    // standard PDAL dimensions are read as doubles.  Files whose readers
+    // can't be inspected are prepared to find their dimensions.
+    typedef std::vector<std::pair<std::string, Dimension::Type>> DimList;
+    std::vector<DimList> fileDims(m_files.size());
+    m_infos.assign(m_files.size(), QuickInfo());
+    std::vector<std::string> errors(m_files.size());
+    size_t next = 0;
+    std::mutex lock;
+    auto inspectFiles = [&]()
+    {
+        while (true)
+        {
+            size_t i;
+            {
+                std::lock_guard<std::mutex> l(lock);
+                if (next == m_files.size())
+                    return;
+                i = next++;
+            }
+            try
+            {
+                QuickInfo& qi = m_infos[i];
+                qi = stages[i]->preview();
+                if (qi.valid())
+                    for (const std::string& name : qi.m_dimNames)
+                    {
+                        Dimension::Id id = Dimension::id(name);
+                        fileDims[i].emplace_back(name,
+                            id == Dimension::Id::Unknown ?
+                            Dimension::Type::Double :
+                            Dimension::defaultType(id));
+                    }
+                else
+                {
+                    PointTable table;
+                    stages[i]->prepare(table);
+                    PointLayoutPtr layout = table.layout();
+                    for (Dimension::Id id : layout->dims())
+                        fileDims[i].emplace_back(layout->dimName(id),
+                            layout->dimType(id));
+                    qi.m_srs = stages[i]->getSpatialReference();
+                }
+            }
+            catch (const std::exception& err)
+            {
+                errors[i] = err.what();
+            }
+        }
+    };
+
+    const size_t threads = (std::min)((size_t)m_threads, m_files.size());
+    if (threads == 1)
+        inspectFiles();
+    else
+    {
+        std::vector<std::thread> pool;
+        for (size_t t = 0; t < threads; ++t)
+            pool.emplace_back(inspectFiles);
+        for (std::thread& t : pool)
+            t.join();
+    }
+
+    // The output has every dimension found in any of the files.
+    m_dims.clear();
+    for (size_t i = 0; i < m_files.size(); ++i)
+    {
+        if (errors[i].size())
+            throwError("Unable to inspect '" + m_files[i] + "': " +
+                errors[i]);
+        for (auto& d : fileDims[i])
+        {
+            auto it = std::find_if(m_dims.begin(), m_dims.end(),
+                [&d](const std::pair<std::string, Dimension::Type>& e)
+                { return Utils::iequals(e.first, d.first); });
+            if (it == m_dims.end())
+                m_dims.push_back(d);
+        }
+    }
+
+    if (getSpatialReference().empty())
+    {
+        for (const QuickInfo& qi : m_infos)
+            if (!qi.m_srs.empty())
+            {
+                setSpatialReference(qi.m_srs);
+                break;
+            }
+    }
+    for (const QuickInfo& qi : m_infos)
+        if (!qi.m_srs.empty() && qi.m_srs != getSpatialReference())
+        {
+            log()->get(LogLevel::Warning) << "Files to read don't all "
+                "have the same spatial reference." << std::endl;
+            break;
+        }
+}
+
+
+QuickInfo MultiReader::inspect()
+{
+    QuickInfo qi;
+
+    initialize();
+    for (const QuickInfo& info : m_infos)
+    {
+        qi.m_pointCount += info.m_pointCount;
+        qi.m_bounds.grow(info.m_bounds);
+    }
+    for (auto& d : m_dims)
+        qi.m_dimNames.push_back(d.first);
+    qi.m_srs = getSpatialReference();
+    qi.m_valid = true;
+
+    return qi;
+}
+
+
+void MultiReader::addDimensions(PointLayoutPtr layout)
+{
+    for (auto& d : m_dims)
+        layout->registerOrAssignDim(d.first, d.second);
+}
+
+
+void MultiReader::ready(PointTableRef table)
+{
+    m_queue->stop();
+    m_layout = table.layout();
+}
+
+
+// Read the files on loader threads, in order.
+void MultiReader::startLoading()
+{
+    m_queue->start(m_files.size(), m_threads,
+        [this](size_t i){ return createMember(m_files[i]); }, m_layout);
+}
+
+
+PointViewSet MultiReader::run(PointViewPtr view)
+{
+    PointViewSet viewSet;
+
+    startLoading();
+    bool first = true;
+    while (MemberQueue::MemberPtr member = m_queue->next())
+    {
+        if (m_viewPerFile && !first)
+        {
+            viewSet.insert(view);
+            view.reset(new PointView(view->table(),
+                view->spatialReference()));
+        }
+        member->copy(*view);
+        first = false;
+    }
+    viewSet.insert(view);
+    m_queue->stop();
+
+    return viewSet;
+}
+
+
+bool MultiReader::processOne(PointRef& point)
+{
+    if (!m_queue->started())
+        startLoading();
+    return m_queue->copyNext(point);
+}
+
+
+void MultiReader::done(PointTableRef table)
+{
+    m_queue->stop();
+}
+
+} // namespace pdal
@@ -0,0 +1,85 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#pragma once
+
+#include <pdal/Reader.hpp>
+#include <pdal/StageFactory.hpp>
+#include <pdal/Streamable.hpp>
+
+namespace pdal
+{
+
+class MemberQueue;
+
+// Reads a set of files, named by a glob pattern or a list, as one point
+// cloud.  Files are read on several threads.
+class PDAL_DLL MultiReader : public Reader, public Streamable
+{
+public:
+    MultiReader();
+    ~MultiReader();
+
+    std::string getName() const;
+
+private:
+    virtual void addArgs(ProgramArgs& args);
+    virtual void initialize();
+    virtual QuickInfo inspect();
+    virtual void addDimensions(PointLayoutPtr layout);
+    virtual void ready(PointTableRef table);
+    virtual PointViewSet run(PointViewPtr view);
+    virtual bool processOne(PointRef& point);
+    virtual void done(PointTableRef table);
+
+    Stage *createMember(const std::string& filename);
+    void startLoading();
+
+    StringList m_fileList;
+    int m_threads;
+    bool m_viewPerFile;
+
+    // Files to read and what was learned about them by inspection.
+    StringList m_files;
+    std::vector<QuickInfo> m_infos;
+    // Dimensions of all the files.
+    std::vector<std::pair<std::string, Dimension::Type>> m_dims;
+
+    StageFactory m_factory;
+    std::unique_ptr<MemberQueue> m_queue;
+    PointLayoutPtr m_layout;
+};
+
+} // namespace pdal
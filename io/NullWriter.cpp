@@ -1,6 +1,8 @@
 
 #include "NullWriter.hpp"
 
+#include <numeric>
+
 namespace pdal
 {
 
@@ -16,4 +18,170 @@ CREATE_STATIC_STAGE(NullWriter, s_info)
 
 std::string NullWriter::getName() const { return s_info.name; }
 
+
+NullWriter::NullWriter() : m_benchmark(false), m_touch(false),
+    m_pointSize(0), m_count(0), m_checksum(0), m_batches(0), m_minRate(0),
+    m_maxRate(0)
+{}
+
+
+void NullWriter::addArgs(ProgramArgs& args)
+{
+    args.add("benchmark", "Report the number of points written and "
+        "the rate at which they arrived", m_benchmark);
+    args.add("touch", "Read every byte of each point.  Implies "
+        "'benchmark'", m_touch);
+}
+
+
+void NullWriter::initialize()
+{
+    m_benchmark |= m_touch;
+
+    // In standard mode upstream stages have run by the time this stage is
+    // readied, so the total time is measured from when the pipeline is
+    // prepared.
+    m_start = Clock::now();
+}
+
+
+void NullWriter::ready(PointTableRef table)
+{
+    PointLayoutPtr layout = table.layout();
+    m_pointSize = layout->pointSize();
+    m_dims = layout->dimTypes();
+    m_buf.resize(m_pointSize);
+    m_count = 0;
+    m_checksum = 0;
+    m_batches = 0;
+    m_minRate = 0;
+    m_maxRate = 0;
+    m_last = Clock::now();
+}
+
+
+// Return the seconds since the last call and reset the time.
+double NullWriter::lap()
+{
+    Clock::time_point now = Clock::now();
+    double secs = std::chrono::duration<double>(now - m_last).count();
+    m_last = now;
+    return secs;
+}
+
+
+// Copy the point's data and fold it into a checksum so that the read
+// can't be skipped.
+void NullWriter::touch(const PointRef& point)
+{
+    point.getPackedData(m_dims, m_buf.data());
+    m_checksum = std::accumulate(m_buf.begin(), m_buf.end(), m_checksum,
+        [](uint64_t sum, char c){ return sum + (uint8_t)c; });
+}
+
+
+void NullWriter::write(const PointViewPtr view)
+{
+    if (!m_benchmark)
+        return;
+
+    if (m_touch)
+    {
+        PointRef point(*view, 0);
+        for (PointId idx = 0; idx < view->size(); ++idx)
+        {
+            point.setPointId(idx);
+            touch(point);
+        }
+    }
+    m_count += view->size();
+
+    double secs = lap();
+    MetadataNode m = getMetadata().addList("view");
+    m.add("points", view->size());
+    m.add("seconds", secs);
+    if (secs > 0)
+        m.add("points_per_second", view->size() / secs);
+    log()->get(LogLevel::Debug) << getName() << ": view of " <<
+        view->size() << " points in " << secs << " seconds." << std::endl;
+}
+
+
+bool NullWriter::processOne(PointRef& point)
+{
+    if (m_touch)
+        touch(point);
+    m_count++;
+    return true;
+}
+
+
+point_count_t NullWriter::processBatch(StreamPointTable& table,
+    PointId begin, point_count_t count)
+{
+    if (!m_benchmark)
+        return count;
+
+    StreamPointTable::IdRange ids = table.activeIds(begin, count);
+    if (m_touch)
+    {
+        PointRef point(table, begin);
+        for (PointId idx : ids)
+        {
+            point.setPointId(idx);
+            touch(point);
+        }
+    }
+    m_count += ids.size();
+
+    // Batch times include the time taken by upstream stages to produce
+    // the batch.
+    double secs = lap();
+    if (secs > 0 && ids.size())
+    {
+        double rate = ids.size() / secs;
+        m_minRate = m_batches ? (std::min)(m_minRate, rate) : rate;
+        m_maxRate = m_batches ? (std::max)(m_maxRate, rate) : rate;
+    }
+    m_batches++;
+    return count;
+}
+
+
+void NullWriter::done(PointTableRef /*table*/)
+{
+    if (!m_benchmark)
+        return;
+
+    double secs =
+        std::chrono::duration<double>(Clock::now() - m_start).count();
+    MetadataNode m = getMetadata();
+    m.add("points", m_count);
+    m.add("point_size", m_pointSize);
+    m.add("bytes", m_count * m_pointSize);
+    m.add("seconds", secs);
+    if (secs > 0)
+    {
+        m.add("points_per_second", m_count / secs);
+        m.add("bytes_per_second", m_count * m_pointSize / secs);
+    }
+    if (m_batches)
+    {
+        m.add("batches", m_batches);
+        m.add("min_batch_points_per_second", m_minRate);
+        m.add("max_batch_points_per_second", m_maxRate);
+    }
+    if (m_touch)
+        m.add("checksum", m_checksum);
+
+    LogPtr l(log());
+    l->get(LogLevel::Info) << getName() << ": " << m_count << " points (" <<
+        m_count * m_pointSize << " bytes) in " << secs << " seconds." <<
+        std::endl;
+    if (secs > 0)
+        l->get(LogLevel::Info) << getName() << ": " << m_count / secs <<
+            " points/sec, " << m_count * m_pointSize / secs <<
+            " bytes/sec." << std::endl;
+}
+
 }
@@ -32,20 +32,54 @@
 * OF SUCH DAMAGE.
 ****************************************************************************/
 
+
 #pragma once
 
+#include <chrono>
+
+#include <pdal/Streamable.hpp>
 #include <pdal/Writer.hpp>
 
 namespace pdal
 {
 
-class PDAL_DLL NullWriter : public Writer
+class PDAL_DLL NullWriter : public Writer, public Streamable
 {
 public:
+    NullWriter();
+
     std::string getName() const;
+
 private:
-    virtual void write(const PointViewPtr /*view*/)
-        {}
+    typedef std::chrono::steady_clock Clock;
+
+    virtual void addArgs(ProgramArgs& args);
+    virtual void initialize();
+    virtual void ready(PointTableRef table);
+    virtual void write(const PointViewPtr view);
+    virtual bool processOne(PointRef& point);
+    virtual point_count_t processBatch(StreamPointTable& table,
+        PointId begin, point_count_t count);
+    virtual void done(PointTableRef table);
+    virtual bool addUsedDims(PointLayoutPtr /*layout*/,
+            Dimension::IdList& /*dims*/) const
+        { return !m_touch; }
+
+    void touch(const PointRef& point);
+    double lap();
+
+    bool m_benchmark;
+    bool m_touch;
+    DimTypeList m_dims;
+    std::vector<char> m_buf;
+    std::size_t m_pointSize;
+    point_count_t m_count;
+    uint64_t m_checksum;
+    Clock::time_point m_start;
+    Clock::time_point m_last;
+    std::size_t m_batches;
+    double m_minRate;
+    double m_maxRate;
 };
 
 } // namespace pdal
@@ -34,6 +34,7 @@
 
 #define _USE_MATH_DEFINES
 #include "OptechReader.hpp"
+#include "private/FixedRecordFile.hpp"
 
 #include <cmath>
 #include <cstring>
@@ -71,15 +72,17 @@ OptechReader::OptechReader()
     : Reader()
     , m_header()
     , m_boresightMatrix(georeference::createIdentityMatrix())
-    , m_istream()
-    , m_buffer()
-    , m_extractor(m_buffer.data(), 0)
+    , m_pulseIndex(0)
     , m_recordIndex(0)
     , m_returnIndex(0)
     , m_pulse()
 {}
 
 
+OptechReader::~OptechReader()
+{}
+
+
 const CsdHeader& OptechReader::getHeader() const { return m_header; }
 
 
@@ -142,11 +145,17 @@ void OptechReader::addDimensions(PointLayoutPtr layout)
 
 void OptechReader::ready(PointTableRef)
 {
-    m_istream.reset(new IStream(m_filename));
-    if (!*m_istream)
-        throwError("Unable to open " + m_filename + " for reading.");
-
-    m_istream->seek(m_header.headerSize);
+    try
+    {
+        m_file.reset(new FixedRecordFile(m_filename, m_header.headerSize,
+            NumBytesInRecord));
+    }
+    catch (const pdal_error& err)
+    {
+        throwError(err.what());
+    }
+    m_pulses.clear();
+    m_pulseIndex = 0;
     m_recordIndex = 0;
     m_returnIndex = 0;
     m_pulse = CsdPulse();
@@ -163,22 +172,19 @@ point_count_t OptechReader::read(PointViewPtr data,
     {
         if (m_returnIndex == 0)
         {
-            if (!m_extractor.good())
+            if (m_pulseIndex == m_pulses.size())
             {
                 if (m_recordIndex >= m_header.numRecords)
                 {
                     break;
                 }
-                m_recordIndex += fillBuffer();
+                size_t numRecords = fillBuffer();
+                if (numRecords == 0)
+                    throwError("Unexpected end of file.");
+                m_recordIndex += numRecords;
             }
 
-            m_extractor >> m_pulse.gpsTime >> m_pulse.returnCount >>
-                m_pulse.range[0] >> m_pulse.range[1] >> m_pulse.range[2] >>
-                m_pulse.range[3] >> m_pulse.intensity[0] >>
-                m_pulse.intensity[1] >> m_pulse.intensity[2] >>
-                m_pulse.intensity[3] >> m_pulse.scanAngle >> m_pulse.roll >>
-                m_pulse.pitch >> m_pulse.heading >> m_pulse.latitude >>
-                m_pulse.longitude >> m_pulse.elevation;
+            m_pulse = m_pulses[m_pulseIndex++];
 
             if (m_pulse.returnCount == 0)
             {
@@ -247,22 +253,41 @@ point_count_t OptechReader::read(PointViewPtr data,
 }
 
 
+// Decode a block of records, one field at a time, into the pulses.
 size_t OptechReader::fillBuffer()
 {
     size_t numRecords = (std::min)(m_header.numRecords - m_recordIndex,
         MaxNumRecordsInBuffer);
-
-    buffer_size_t bufferSize = NumBytesInRecord * numRecords;
-    m_buffer.resize(bufferSize);
-    m_istream->get(m_buffer);
-    m_extractor = LeExtractor(m_buffer.data(), m_buffer.size());
+    numRecords = m_file->load(m_recordIndex, numRecords);
+
+    m_pulses.resize(numRecords);
+    m_pulseIndex = 0;
+    if (numRecords == 0)
+        return 0;
+
+    CsdPulse *p = m_pulses.data();
+    const size_t stride = sizeof(CsdPulse);
+    m_file->decode(0, &p->gpsTime, stride);
+    m_file->decode(8, &p->returnCount, stride);
+    for (size_t i = 0; i < MaximumNumberOfReturns; ++i)
+    {
+        m_file->decode(9 + i * sizeof(float), &p->range[i], stride);
+        m_file->decode(25 + i * sizeof(uint16_t), &p->intensity[i], stride);
+    }
+    m_file->decode(33, &p->scanAngle, stride);
+    m_file->decode(37, &p->roll, stride);
+    m_file->decode(41, &p->pitch, stride);
+    m_file->decode(45, &p->heading, stride);
+    m_file->decode(49, &p->latitude, stride);
+    m_file->decode(57, &p->longitude, stride);
+    m_file->decode(65, &p->elevation, stride);
     return numRecords;
 }
 
 
 void OptechReader::done(PointTableRef)
 {
-    m_istream.reset();
+    m_file.reset();
 }
 
 } // namespace pdal
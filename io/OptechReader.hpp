@@ -47,6 +47,7 @@
 namespace pdal
 {
 
+class FixedRecordFile;
 
 class PDAL_DLL OptechReader : public Reader
 {
@@ -59,13 +60,11 @@ public:
     static const size_t MaxNumRecordsInBuffer = BufferSize / NumBytesInRecord;
 
     OptechReader();
+    ~OptechReader();
 
     const CsdHeader& getHeader() const;
 
 private:
-    typedef std::vector<char> buffer_t;
-    typedef buffer_t::size_type buffer_size_t;
-
     virtual void initialize();
     virtual void addDimensions(PointLayoutPtr layout);
     virtual void ready(PointTableRef table);
@@ -75,9 +74,9 @@ private:
 
     CsdHeader m_header;
     georeference::RotationMatrix m_boresightMatrix;
-    std::unique_ptr<IStream> m_istream;
-    buffer_t m_buffer;
-    LeExtractor m_extractor;
+    std::unique_ptr<FixedRecordFile> m_file;
+    std::vector<CsdPulse> m_pulses;
+    size_t m_pulseIndex;
     size_t m_recordIndex;
     size_t m_returnIndex;
     CsdPulse m_pulse;
@@ -33,6 +33,8 @@
  * OF SUCH DAMAGE.
  ****************************************************************************/
 
+#include <iomanip>
+
 #include "PcdHeader.hpp"
 
 namespace pdal
@@ -289,7 +291,8 @@ std::ostream& operator<<(std::ostream& out, PcdHeader& header)
         out << " " << i.m_count;
     out << std::endl;
 
-    out << "WIDTH " << header.m_width << std::endl;
+    out << "WIDTH " << std::left << std::setw(header.m_countWidth) <<
+        header.m_width << std::endl;
 
     out << "HEIGHT " << header.m_height << std::endl;
 
@@ -304,7 +307,8 @@ std::ostream& operator<<(std::ostream& out, PcdHeader& header)
             << orient.z() << std::endl;
     }
 
-    out << "POINTS " << header.m_pointCount << std::endl;
+    out << "POINTS " << std::left << std::setw(header.m_countWidth) <<
+        header.m_pointCount << std::endl;
 
     out << "DATA " << header.m_dataStorage << std::endl;
 
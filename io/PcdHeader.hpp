@@ -97,7 +97,8 @@ struct PcdHeader
 {
     PcdHeader()
         : m_version(PcdVersion::PCD_V6), m_width(1), m_height(0),
-          m_pointCount(0), m_origin(0, 0, 0, 0), m_orientation(1, 0, 0, 0)
+          m_pointCount(0), m_origin(0, 0, 0, 0), m_orientation(1, 0, 0, 0),
+          m_countWidth(0)
     {
     }
 
@@ -113,6 +114,9 @@ struct PcdHeader
     PcdDataStorage m_dataStorage;
     std::istream::pos_type m_dataOffset;
     size_t m_numLines;
+    // Minimum width of the WIDTH and POINTS values when written, so that a
+    // header can be rewritten in place once the point count is known.
+    size_t m_countWidth;
 };
 std::istream& operator>>(std::istream& in, PcdHeader& header);
 std::ostream& operator<<(std::ostream& out, PcdHeader& header);
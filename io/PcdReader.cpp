@@ -32,11 +32,19 @@
  * OF SUCH DAMAGE.
  ****************************************************************************/
 
+#include <cstring>
+#include <functional>
+
 #include <pdal/PDALUtils.hpp>
 #include <pdal/util/Algorithm.hpp>
+#include <pdal/util/IStream.hpp>
+#include <pdal/util/ProgramArgs.hpp>
+#include <pdal/util/TaskScheduler.hpp>
 
 #include "PcdHeader.hpp"
 #include "PcdReader.hpp"
+#include "private/Endian.hpp"
+#include "private/Lzf.hpp"
 
 namespace pdal
 {
@@ -51,11 +59,113 @@ static StaticPluginInfo const s_info
 
 CREATE_STATIC_STAGE(PcdReader, s_info)
 
+namespace
+{
+
+// Number of points decoded at once from binary data.
+const size_t ChunkSize = 65536;
+
+// Size of the reads of compressed data.
+const size_t InputSize = 1 << 20;
+
+// Run 'fn' over the range [0, count) split across threads.
+void forRange(size_t count, int threads,
+    const std::function<void(size_t, size_t)>& fn)
+{
+    size_t n = (std::min)((size_t)threads, count);
+    if (n <= 1)
+    {
+        fn(0, count);
+        return;
+    }
+
+    try
+    {
+        parallelFor(n, n, [&fn, n, count](size_t t)
+            { fn(t * count / n, (t + 1) * count / n); });
+    }
+    catch (const std::exception& err)
+    {
+        throw LzfDecoder::error(err.what());
+    }
+}
+
+} // unnamed namespace
+
+// The compressed data of a field.  Compressed PCD data is a single LZF
+// stream holding the values of each field in turn.  Each field has its own
+// decoder, started from a copy of the state of a decoder that was run to
+// the start of the field's data, so that the fields of a point can be
+// decoded together.
+struct PcdReader::Column
+{
+    Column() : m_pos(0), m_end(0), m_offset(0), m_dataEnd(0), m_width(0),
+        m_size(0)
+    {}
+
+    LzfDecoder m_decoder;
+    std::vector<char> m_input;
+    size_t m_pos;
+    size_t m_end;
+    // File position of the next compressed data to read.
+    uint64_t m_offset;
+    // File position of the end of the compressed data.
+    uint64_t m_dataEnd;
+    // Bytes per point in the column and bytes of the field's first value.
+    size_t m_width;
+    size_t m_size;
+
+    // Decode the next 'size' bytes of the column.
+    void read(std::istream& in, std::mutex& lock, char *out, size_t size)
+    {
+        char *end = out + size;
+        while (out < end)
+        {
+            if (m_pos == m_end)
+            {
+                size_t count = (size_t)(std::min)((uint64_t)InputSize,
+                    m_dataEnd - m_offset);
+                if (!count)
+                    throw LzfDecoder::error("Compressed data ends early.");
+                m_input.resize(count);
+                std::lock_guard<std::mutex> l(lock);
+                in.clear();
+                in.seekg(m_offset);
+                in.read(m_input.data(), count);
+                if ((size_t)in.gcount() != count)
+                    throw LzfDecoder::error("Compressed data ends early.");
+                m_offset += count;
+                m_pos = 0;
+                m_end = count;
+            }
+            const char *pos = m_input.data() + m_pos;
+            m_decoder.decode(pos, m_input.data() + m_end, out, end);
+            m_pos = pos - m_input.data();
+        }
+    }
+};
+
+
+PcdReader::PcdReader() : Reader(), m_istreamPtr(nullptr)
+{}
+
+
+PcdReader::~PcdReader()
+{}
+
+
 std::string PcdReader::getName() const
 {
     return s_info.name;
 }
 
+
+void PcdReader::addArgs(ProgramArgs& args)
+{
+    args.add("threads", "Number of threads used to decompress "
+        "binary_compressed data", m_threads, 1);
+}
+
 QuickInfo PcdReader::inspect()
 {
     QuickInfo qi;
@@ -73,6 +183,8 @@ QuickInfo PcdReader::inspect()
 void PcdReader::ready(PointTableRef table)
 {
     m_index = 0;
+    m_chunkPos = 0;
+    m_chunkCount = 0;
     switch (m_header.m_dataStorage)
     {
     case PcdDataStorage::ASCII:
@@ -85,11 +197,14 @@ void PcdReader::ready(PointTableRef table)
         m_istreamPtr = Utils::openFile(m_filename, true);
         if (!m_istreamPtr)
             throwError("Unable to open binary PCD file '" + m_filename + "'.");
-        m_stream = ILeStream(m_istreamPtr);
-        m_stream.seek(m_header.m_dataOffset);
+        m_istreamPtr->seekg(m_header.m_dataOffset);
         break;
     case PcdDataStorage::COMPRESSED:
-        throwError("Binary compressed PCD is not supported at this time.");
+        m_istreamPtr = Utils::openFile(m_filename, true);
+        if (!m_istreamPtr)
+            throwError("Unable to open binary compressed PCD file '" +
+                m_filename + "'.");
+        initColumns();
         break;
     case PcdDataStorage::unknown:
     default:
@@ -100,6 +215,8 @@ void PcdReader::ready(PointTableRef table)
 void PcdReader::addDimensions(PointLayoutPtr layout)
 {
     m_dims.clear();
+    m_rowDims.clear();
+    m_packedDims.clear();
     for (auto i : m_header.m_fields)
     {
         Dimension::BaseType base = Dimension::BaseType::None;
@@ -111,6 +228,11 @@ void PcdReader::addDimensions(PointLayoutPtr layout)
             base = Dimension::BaseType::Floating;
         Dimension::Type t =
             static_cast<Dimension::Type>(unsigned(base) | i.m_size);
+        if (m_header.m_dataStorage != PcdDataStorage::ASCII &&
+            (Dimension::size(t) != i.m_size || i.m_count < 1))
+            throwError("Invalid size or count for field '" + i.m_label +
+                "'.");
+        const Dimension::Type fileType = t;
         Utils::trim(i.m_label);
         i.m_label = Utils::toupper(i.m_label);
         if (i.m_label == "X" || i.m_label == "Y" || i.m_label == "Z")
@@ -120,6 +242,13 @@ void PcdReader::addDimensions(PointLayoutPtr layout)
             throwError("Duplicate dimension '" + i.m_label +
                        "' detected in input file '" + m_filename + "'.");
         m_dims.push_back(id);
+
+        // Only the first value of a field with a count greater than one
+        // is kept.
+        m_packedDims.emplace_back(id, fileType);
+        m_rowDims.emplace_back(id, fileType);
+        for (uint32_t j = 1; j < i.m_count; ++j)
+            m_rowDims.emplace_back(Dimension::Id::Unknown, fileType);
     }
 }
 
@@ -153,11 +282,148 @@ bool PcdReader::fillFields()
     }
 }
 
+// Read points from a binary file in chunks, in host byte order.
+void PcdReader::readBinaryChunk()
+{
+    size_t rowSize = 0;
+    for (const DimType& dim : m_rowDims)
+        rowSize += Dimension::size(dim.m_type);
+
+    size_t count = (size_t)(std::min)((point_count_t)ChunkSize,
+        m_header.m_pointCount - m_index);
+    m_chunk.resize(count * rowSize);
+    m_istreamPtr->read(m_chunk.data(), m_chunk.size());
+    count = (size_t)m_istreamPtr->gcount() / rowSize;
+    if (needsSwap(true))
+        swapRecords(m_chunk.data(), count, m_rowDims);
+    m_chunkPos = 0;
+    m_chunkCount = count;
+}
+
+
+// Set up a decoder for each field's column of compressed data.  The
+// compressed data is preceded by its size and the size of the data once
+// decompressed.
+void PcdReader::initColumns()
+{
+    ILeStream in(m_istreamPtr);
+    in.seek(m_header.m_dataOffset);
+    uint32_t compressedSize;
+    uint32_t size;
+    in >> compressedSize >> size;
+    if (!in.good())
+        throwError("Unable to read binary compressed PCD data sizes.");
+
+    uint64_t pointSize = 0;
+    for (const PcdField& f : m_header.m_fields)
+        pointSize += f.m_size * f.m_count;
+    if (pointSize * m_header.m_pointCount != size)
+        throwError("Size of binary compressed PCD data doesn't match the "
+            "point count and fields of the header.");
+
+    Column c;
+    c.m_offset = (uint64_t)m_header.m_dataOffset + 8;
+    c.m_dataEnd = c.m_offset + compressedSize;
+
+    // Run a decoder through the data, discarding the output, and copy it
+    // as each column's data starts.
+    std::vector<char> discard(InputSize);
+    m_columns.clear();
+    uint64_t columnStart = 0;
+    uint64_t decoded = 0;
+    try
+    {
+        for (const PcdField& f : m_header.m_fields)
+        {
+            while (decoded < columnStart)
+            {
+                size_t count = (size_t)(std::min)((uint64_t)discard.size(),
+                    columnStart - decoded);
+                c.read(*m_istreamPtr, m_streamLock, discard.data(), count);
+                decoded += count;
+            }
+            std::unique_ptr<Column> col(new Column(c));
+            col->m_offset -= (col->m_end - col->m_pos);
+            col->m_pos = 0;
+            col->m_end = 0;
+            col->m_input.clear();
+            col->m_width = f.m_size * f.m_count;
+            col->m_size = f.m_size;
+            m_columns.push_back(std::move(col));
+            columnStart += m_header.m_pointCount * f.m_size * f.m_count;
+        }
+    }
+    catch (const LzfDecoder::error& err)
+    {
+        throwError(err.what());
+    }
+}
+
+
+// Decode the next chunk of points from each column and transpose them to
+// packed points, in host byte order.
+void PcdReader::readCompressedChunk()
+{
+    const size_t count = (size_t)(std::min)((point_count_t)ChunkSize,
+        m_header.m_pointCount - m_index);
+
+    std::vector<std::vector<char>> columns(m_columns.size());
+    std::vector<size_t> offsets;
+    size_t packedSize = 0;
+    for (auto& col : m_columns)
+    {
+        offsets.push_back(packedSize);
+        packedSize += col->m_size;
+    }
+
+    try
+    {
+        forRange(m_columns.size(), m_threads, [&](size_t begin, size_t end)
+        {
+            for (size_t c = begin; c < end; ++c)
+            {
+                Column& col = *m_columns[c];
+                columns[c].resize(count * col.m_width);
+                col.read(*m_istreamPtr, m_streamLock, columns[c].data(),
+                    columns[c].size());
+            }
+        });
+    }
+    catch (const LzfDecoder::error& err)
+    {
+        throwError(err.what());
+    }
+
+    m_chunk.resize(count * packedSize);
+    forRange(count, m_threads, [&](size_t begin, size_t end)
+    {
+        for (size_t c = 0; c < m_columns.size(); ++c)
+        {
+            const Column& col = *m_columns[c];
+            const char *src = columns[c].data() + begin * col.m_width;
+            char *dst = m_chunk.data() + begin * packedSize + offsets[c];
+            for (size_t i = begin; i < end; ++i)
+            {
+                std::memcpy(dst, src, col.m_size);
+                src += col.m_width;
+                dst += packedSize;
+            }
+        }
+        if (needsSwap(true))
+            swapRecords(m_chunk.data() + begin * packedSize, end - begin,
+                m_packedDims);
+    });
+    m_chunkPos = 0;
+    m_chunkCount = count;
+}
+
+
 bool PcdReader::processOne(PointRef& point)
 {
     switch (m_header.m_dataStorage)
     {
     case PcdDataStorage::ASCII:
+    {
         if (!fillFields())
             return false;
 
@@ -175,43 +441,30 @@ bool PcdReader::processOne(PointRef& point)
             point.setField(m_dims[i], d);
         }
         return true;
+    }
     case PcdDataStorage::BINARY:
-        if (!m_stream.good())
-            return false;
-
+    case PcdDataStorage::COMPRESSED:
+    {
         if ((m_index >= m_count) ||
             (m_index >= (point_count_t)m_header.m_pointCount))
             return false;
 
-        for (auto const& i : m_header.m_fields)
+        const bool binary = (m_header.m_dataStorage == PcdDataStorage::BINARY);
+        if (m_chunkPos == m_chunkCount)
         {
-            switch (i.m_type)
-            {
-            case PcdFieldType::I:
-                int32_t ival;
-                m_stream >> ival;
-                point.setField(i.m_id, ival);
-                break;
-            case PcdFieldType::F:
-                float fval;
-                m_stream >> fval;
-                point.setField(i.m_id, fval);
-                break;
-            case PcdFieldType::U:
-                uint32_t uval;
-                m_stream >> uval;
-                point.setField(i.m_id, uval);
-                break;
-            case PcdFieldType::unknown:
-            default:
-                throwError("Unsupported field type.");
-            }
+            if (binary)
+                readBinaryChunk();
+            else
+                readCompressedChunk();
+            if (!m_chunkCount)
+                return false;
         }
+        const DimTypeList& dims = binary ? m_rowDims : m_packedDims;
+        const size_t size = m_chunk.size() / m_chunkCount;
+        point.setPackedData(dims, m_chunk.data() + m_chunkPos++ * size);
         m_index++;
         return true;
-    case PcdDataStorage::COMPRESSED:
-        throwError("Binary compressed PCD is not supported at this time.");
-        return false;
+    }
     case PcdDataStorage::unknown:
     default:
         throwError("Unrecognized data storage.");
@@ -239,6 +492,8 @@ void PcdReader::initialize()
 {
     if (m_filename.empty())
         throwError("Can't read PCD file without filename.");
+    if (m_threads < 1)
+        throwError("Option 'threads' must be at least 1.");
 
     m_istreamPtr = Utils::openFile(m_filename, false);
     if (!m_istreamPtr)
@@ -260,8 +515,10 @@ void PcdReader::initialize()
 
 void PcdReader::done(PointTableRef table)
 {
-    m_stream.close();
+    m_columns.clear();
+    std::vector<char>().swap(m_chunk);
     Utils::closeFile(m_istreamPtr);
+    m_istreamPtr = nullptr;
 }
 
 } // namespace pdal
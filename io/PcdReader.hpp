@@ -34,9 +34,11 @@
 
 #pragma once
 
+#include <mutex>
+
+#include <pdal/DimType.hpp>
 #include <pdal/Reader.hpp>
 #include <pdal/Streamable.hpp>
-#include <pdal/util/IStream.hpp>
 
 #include "PcdHeader.hpp"
 
@@ -48,10 +50,13 @@ class PDAL_DLL PcdReader : public Reader, public Streamable
 public:
     std::string getName() const;
 
-    PcdReader() : Reader()
-    {}
+    PcdReader();
+    ~PcdReader();
 
 private:
+    struct Column;
+
+    virtual void addArgs(ProgramArgs& args);
     virtual QuickInfo inspect();
     virtual void initialize();
     virtual void addDimensions(PointLayoutPtr layout);
@@ -60,14 +65,28 @@ private:
     virtual void done(PointTableRef table);
     virtual bool processOne(PointRef& point);
     bool fillFields();
+    void readBinaryChunk();
+    void initColumns();
+    void readCompressedChunk();
 
     PcdHeader m_header;
     std::istream* m_istreamPtr;
-    ILeStream m_stream;
     Dimension::IdList m_dims;
     StringList m_fields;
     point_count_t m_index;
     size_t m_line;
+    int m_threads;
+
+    // Layout of a point in a binary file, with an entry for each value of
+    // fields with a count greater than one.
+    DimTypeList m_rowDims;
+    // Layout of the first value of each field, packed.
+    DimTypeList m_packedDims;
+    std::vector<char> m_chunk;
+    size_t m_chunkPos;
+    size_t m_chunkCount;
+    std::vector<std::unique_ptr<Column>> m_columns;
+    std::mutex m_streamLock;
 };
 
 } // namespace pdal
@@ -35,9 +35,16 @@
 #include "PcdWriter.hpp"
 #include "PcdHeader.hpp"
 
+#include <cstring>
+#include <limits>
+
 #include <pdal/PDALUtils.hpp>
 #include <pdal/util/OStream.hpp>
 #include <pdal/util/ProgramArgs.hpp>
+#include <pdal/util/TaskScheduler.hpp>
+
+#include "private/Endian.hpp"
+#include "private/Lzf.hpp"
 
 namespace pdal
 {
@@ -52,6 +59,42 @@ static StaticPluginInfo const s_info
 
 CREATE_STATIC_STAGE(PcdWriter, s_info)
 
+namespace
+{
+
+// Number of points packed before being written or compressed.
+const size_t ChunkSize = 65536;
+
+// Width of the point count in a header written before the count is known.
+const size_t CountWidth = 20;
+
+Dimension::Type dimType(const PcdField& field)
+{
+    Dimension::BaseType base = Dimension::BaseType::None;
+    switch (field.m_type)
+    {
+    case PcdFieldType::I:
+        base = Dimension::BaseType::Signed;
+        break;
+    case PcdFieldType::U:
+        base = Dimension::BaseType::Unsigned;
+        break;
+    case PcdFieldType::F:
+        base = Dimension::BaseType::Floating;
+        break;
+    case PcdFieldType::unknown:
+    default:
+        return Dimension::Type::None;
+    }
+    Dimension::Type t =
+        static_cast<Dimension::Type>(unsigned(base) | field.m_size);
+    if (Dimension::size(t) != field.m_size)
+        return Dimension::Type::None;
+    return t;
+}
+
+} // unnamed namespace
+
 std::string PcdWriter::getName() const
 {
     return s_info.name;
@@ -68,11 +111,24 @@ void PcdWriter::addArgs(ProgramArgs& args)
     args.add("order", "Dimension order", m_dimOrder);
     args.add("precision", "ASCII precision", m_precision,
              static_cast<uint32_t>(2));
+    args.add("threads", "Number of threads used to compress data",
+        m_threads, 1);
 }
 
 void PcdWriter::initialize(PointTableRef table)
 {
-    m_ostream = Utils::createFile(m_filename, false);
+    if (m_compression_string == "ascii")
+        m_header.m_dataStorage = PcdDataStorage::ASCII;
+    else if (m_compression_string == "binary")
+        m_header.m_dataStorage = PcdDataStorage::BINARY;
+    else if (m_compression_string == "compressed")
+        m_header.m_dataStorage = PcdDataStorage::COMPRESSED;
+    else
+        throwError("Unrecognized compression string");
+    if (m_threads < 1)
+        throwError("Option 'threads' must be at least 1.");
+
+    m_ostream = Utils::createFile(m_filename, true);
     if (!m_ostream)
         throwError("Couldn't open '" + m_filename + "' for output.");
 }
@@ -236,75 +292,171 @@ void PcdWriter::ready(PointTableRef table)
                 m_dims.push_back(ds);
         }
     }
-}
 
-void PcdWriter::write(const PointViewPtr view)
-{
     m_header.m_version = PcdVersion::PCD_V7;
     m_header.m_height = 1;
-    if (m_compression_string == "ascii")
-        m_header.m_dataStorage = PcdDataStorage::ASCII;
-    else if (m_compression_string == "binary")
-        m_header.m_dataStorage = PcdDataStorage::BINARY;
-    else if (m_compression_string == "compressed")
-        m_header.m_dataStorage = PcdDataStorage::COMPRESSED;
-    else
-        throwError("Unrecognized compression string");
-
+    m_header.m_fields.clear();
+    m_packedDims.clear();
+    m_pointSize = 0;
     for (auto di = m_dims.begin(); di != m_dims.end(); ++di)
     {
         m_header.m_fields.push_back(di->m_field);
-    }
+        if (m_header.m_dataStorage == PcdDataStorage::ASCII)
+            continue;
 
-    m_header.m_width = view->size();
-    m_header.m_pointCount = view->size();
+        Dimension::Type t = dimType(di->m_field);
+        if (t == Dimension::Type::None)
+            throwError("Invalid type for dimension '" + di->m_field.m_label +
+                "'.");
+        m_packedDims.emplace_back(di->m_field.m_id, t);
+        m_pointSize += di->m_field.m_size;
+    }
+    m_columns.assign(m_dims.size(), std::vector<char>());
+    m_chunk.clear();
+    m_count = 0;
 
+    // When streaming, the point count isn't known until all points are
+    // written.  Leave room to rewrite the header when done.
+    m_header.m_width = pointCount();
+    m_header.m_pointCount = pointCount();
+    m_header.m_countWidth = pointCount() ? 0 : CountWidth;
     *m_ostream << m_header;
+}
 
-    PointRef point(*view, 0);
 
+void PcdWriter::write(const PointViewPtr view)
+{
+    PointRef point(*view, 0);
     for (PointId idx = 0; idx < view->size(); ++idx)
     {
         point.setPointId(idx);
-        if (m_compression_string == "ascii")
-        {
-            for (auto di = m_dims.begin(); di != m_dims.end(); ++di)
-                *m_ostream << std::fixed << std::setprecision(di->m_precision)
-                           << point.getFieldAs<float>(di->m_field.m_id) << " ";
-            *m_ostream << "\n";
-        }
-        else if (m_compression_string == "binary")
+        processOne(point);
+    }
+}
+
+
+bool PcdWriter::processOne(PointRef& point)
+{
+    if (m_header.m_dataStorage == PcdDataStorage::ASCII)
+    {
+        for (auto di = m_dims.begin(); di != m_dims.end(); ++di)
+            *m_ostream << std::fixed << std::setprecision(di->m_precision)
+                       << point.getFieldAs<float>(di->m_field.m_id) << " ";
+        *m_ostream << "\n";
+    }
+    else
+    {
+        size_t pos = m_chunk.size();
+        m_chunk.resize(pos + m_pointSize);
+        point.getPackedData(m_packedDims, m_chunk.data() + pos);
+        if (m_chunk.size() == ChunkSize * m_pointSize)
+            writeChunk();
+    }
+    m_count++;
+    return true;
+}
+
+
+// Write the packed points that have been collected, or compress them by
+// field when writing compressed data.  PCD binary data is little-endian.
+void PcdWriter::writeChunk()
+{
+    const size_t count = m_chunk.size() / m_pointSize;
+    if (!count)
+        return;
+    if (needsSwap(true))
+        swapRecords(m_chunk.data(), count, m_packedDims);
+
+    if (m_header.m_dataStorage == PcdDataStorage::BINARY)
+    {
+        m_ostream->write(m_chunk.data(), m_chunk.size());
+        m_chunk.clear();
+        return;
+    }
+
+    // Compressed data holds all the values of each field in turn.  Each
+    // field's chunk is compressed as its own LZF stream, which can be
+    // concatenated with the field's previous data.
+    std::vector<size_t> offsets;
+    size_t offset = 0;
+    for (const DimType& dim : m_packedDims)
+    {
+        offsets.push_back(offset);
+        offset += Dimension::size(dim.m_type);
+    }
+
+    auto compress = [this, count, &offsets](size_t begin, size_t end)
+    {
+        std::vector<char> column;
+        for (size_t c = begin; c < end; ++c)
         {
-            OLeStream out(m_ostream);
-            for (auto di = m_dims.begin(); di != m_dims.end(); ++di)
+            const size_t size = Dimension::size(m_packedDims[c].m_type);
+            column.resize(count * size);
+            const char *src = m_chunk.data() + offsets[c];
+            char *dst = column.data();
+            for (size_t i = 0; i < count; ++i)
             {
-                if (di->m_field.m_type == PcdFieldType::F && di->m_field.m_size == 8)
-                    out << point.getFieldAs<double>(di->m_field.m_id);
-                else if (di->m_field.m_type == PcdFieldType::F && di->m_field.m_size == 4)
-                    out << point.getFieldAs<float>(di->m_field.m_id);
-                else if (di->m_field.m_type == PcdFieldType::U && di->m_field.m_size == 8)
-                    out << point.getFieldAs<uint64_t>(di->m_field.m_id);
-                else if (di->m_field.m_type == PcdFieldType::U && di->m_field.m_size == 4)
-                    out << point.getFieldAs<uint32_t>(di->m_field.m_id);
-                else if (di->m_field.m_type == PcdFieldType::U && di->m_field.m_size == 2)
-                    out << point.getFieldAs<uint16_t>(di->m_field.m_id);
-                else if (di->m_field.m_type == PcdFieldType::I && di->m_field.m_size == 1)
-                    out << point.getFieldAs<uint8_t>(di->m_field.m_id);
-                else if (di->m_field.m_type == PcdFieldType::I && di->m_field.m_size == 8)
-                    out << point.getFieldAs<int64_t>(di->m_field.m_id);
-                else if (di->m_field.m_type == PcdFieldType::I && di->m_field.m_size == 4)
-                    out << point.getFieldAs<int32_t>(di->m_field.m_id);
-                else if (di->m_field.m_type == PcdFieldType::I && di->m_field.m_size == 2)
-                    out << point.getFieldAs<int16_t>(di->m_field.m_id);
-                else if (di->m_field.m_type == PcdFieldType::I && di->m_field.m_size == 1)
-                    out << point.getFieldAs<int8_t>(di->m_field.m_id);
+                std::memcpy(dst, src, size);
+                src += m_pointSize;
+                dst += size;
             }
+            lzfCompress(column.data(), column.size(), m_columns[c]);
         }
+    };
+
+    const size_t numColumns = m_packedDims.size();
+    const size_t threads = (std::min)((size_t)m_threads, numColumns);
+    if (threads <= 1)
+        compress(0, numColumns);
+    else
+        parallelFor(threads, threads, [&compress, numColumns, threads](
+                size_t t)
+            {
+                compress(t * numColumns / threads,
+                    (t + 1) * numColumns / threads);
+            });
+    m_chunk.clear();
+}
+
+
+// Write the compressed data of all the fields, preceded by the size of the
+// compressed data and the size of the data once decompressed.  PCL limits
+// both to 32 bits.
+void PcdWriter::writeCompressed()
+{
+    uint64_t compressedSize = 0;
+    for (const std::vector<char>& column : m_columns)
+        compressedSize += column.size();
+    const uint64_t size = (uint64_t)m_count * m_pointSize;
+    if (compressedSize > (std::numeric_limits<uint32_t>::max)() ||
+        size > (std::numeric_limits<uint32_t>::max)())
+        throwError("Too much data for a binary compressed PCD file.");
+
+    OLeStream out(m_ostream);
+    out << (uint32_t)compressedSize << (uint32_t)size;
+    for (std::vector<char>& column : m_columns)
+    {
+        m_ostream->write(column.data(), column.size());
+        std::vector<char>().swap(column);
     }
 }
 
+
 void PcdWriter::done(PointTableRef table)
 {
+    if (m_header.m_dataStorage != PcdDataStorage::ASCII)
+        writeChunk();
+    if (m_header.m_dataStorage == PcdDataStorage::COMPRESSED)
+        writeCompressed();
+
+    if (m_header.m_countWidth)
+    {
+        m_header.m_width = m_count;
+        m_header.m_pointCount = m_count;
+        m_ostream->seekp(0);
+        *m_ostream << m_header;
+    }
+
     Utils::closeFile(m_ostream);
     m_ostream = nullptr;
     getMetadata().addList("filename", m_filename);
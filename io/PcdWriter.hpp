@@ -36,12 +36,14 @@
 
 #include "PcdHeader.hpp"
 
+#include <pdal/DimType.hpp>
+#include <pdal/Streamable.hpp>
 #include <pdal/Writer.hpp>
 
 namespace pdal
 {
 
-class PDAL_DLL PcdWriter : public Writer
+class PDAL_DLL PcdWriter : public Writer, public Streamable
 {
     struct DimSpec
     {
@@ -56,12 +58,13 @@ class PDAL_DLL PcdWriter : public Writer
         }
         PcdField m_field;
         uint32_t m_precision;
+    int m_threads;
     };
 
 public:
     std::string getName() const;
 
-    PcdWriter()
+    PcdWriter() : m_ostream(nullptr), m_count(0)
     {}
 
 private:
@@ -69,10 +72,13 @@ private:
     virtual void initialize(PointTableRef table);
     virtual void ready(PointTableRef table);
     virtual void write(const PointViewPtr view);
+    virtual bool processOne(PointRef& point);
     virtual void done(PointTableRef table);
 
     DimSpec extractDim(std::string dim, PointTableRef table);
     bool findDim(Dimension::Id id, DimSpec& ds);
+    void writeChunk();
+    void writeCompressed();
 
     PcdHeader m_header;
     std::ostream* m_ostream;
@@ -81,12 +87,22 @@ private:
     bool m_writeAllDims;
     std::string m_dimOrder;
     uint32_t m_precision;
+    int m_threads;
 
     std::vector<DimSpec> m_dims;
     DimSpec m_xDim;
     DimSpec m_yDim;
     DimSpec m_zDim;
 
+    // Layout of a point in binary data.
+    DimTypeList m_packedDims;
+    size_t m_pointSize;
+    // Packed points not yet written.
+    std::vector<char> m_chunk;
+    // Compressed data of each field, written once all points are seen.
+    std::vector<std::vector<char>> m_columns;
+    point_count_t m_count;
+
     PcdWriter& operator=(const PcdWriter&); // not implemented
     PcdWriter(const PcdWriter&);            // not implemented
 };
@@ -34,11 +34,14 @@
 
 #include "PlyReader.hpp"
 
+#include <algorithm>
+#include <cstring>
 #include <sstream>
 
 #include <pdal/PDALUtils.hpp>
 #include <pdal/PointView.hpp>
-#include <pdal/util/IStream.hpp>
+
+#include "private/PlySupport.hpp"
 
 namespace pdal
 {
@@ -54,10 +57,76 @@ static StaticPluginInfo const s_info
 CREATE_STATIC_STAGE(PlyReader, s_info)
 
 
-PlyReader::PlyReader() : m_vertexElt(nullptr)
+PlyReader::PlyReader() : m_vertexElt(nullptr), m_chunk(nullptr),
+    m_chunkCount(0)
 {}
 
 
+void PlyReader::DataBuffer::reset(std::istream *stream, bool swap)
+{
+    m_stream = stream;
+    m_swap = swap;
+    m_pos = 0;
+    m_end = 0;
+    if (m_stream)
+        m_buf.resize(ply::BlockSize);
+    else
+        std::vector<char>().swap(m_buf);
+}
+
+
+// Get a pointer to the next 'size' bytes of data, or nullptr if the data
+// ends first.  The pointer is valid until the next call.
+char *PlyReader::DataBuffer::get(size_t size)
+{
+    if (m_end - m_pos < size)
+    {
+        // Move the unused data to the front of the buffer and fill the rest.
+        std::copy(m_buf.begin() + m_pos, m_buf.begin() + m_end,
+            m_buf.begin());
+        m_end -= m_pos;
+        m_pos = 0;
+        if (m_buf.size() < size)
+            m_buf.resize(size);
+        m_stream->read(m_buf.data() + m_end, m_buf.size() - m_end);
+        m_end += static_cast<size_t>(m_stream->gcount());
+        if (m_end < size)
+            return nullptr;
+    }
+    char *p = m_buf.data() + m_pos;
+    m_pos += size;
+    return p;
+}
+
+
+// Get the next value of the given type, in host byte order.
+bool PlyReader::DataBuffer::get(Dimension::Type type, Everything& e)
+{
+    const size_t size = Dimension::size(type);
+    char *p = get(size);
+    if (!p)
+        return false;
+    std::memcpy(&e, p, size);
+    if (m_swap)
+        std::reverse(reinterpret_cast<char *>(&e),
+            reinterpret_cast<char *>(&e) + size);
+    return true;
+}
+
+
+void PlyReader::DataBuffer::skip(size_t size)
+{
+    if (size <= m_end - m_pos)
+    {
+        m_pos += size;
+        return;
+    }
+    m_stream->seekg(size - (m_end - m_pos), std::ios_base::cur);
+    m_pos = 0;
+    m_end = 0;
+}
+
+
 std::string PlyReader::readLine()
 {
     m_line.clear();
@@ -277,8 +346,20 @@ void PlyReader::extractHeader()
     m_dataPos = m_stream->tellg();
 
     for (Element& elt : m_elements)
+    {
         if (elt.m_name == "vertex")
             m_vertexElt = &elt;
+        for (auto& prop : elt.m_properties)
+        {
+            auto sprop = dynamic_cast<SimpleProperty *>(prop.get());
+            if (!sprop)
+            {
+                elt.m_recordSize = 0;
+                break;
+            }
+            elt.m_recordSize += Dimension::size(sprop->m_type);
+        }
+    }
     if (!m_vertexElt)
         throwError("Can't read PLY file without a 'vertex' element.");
 }
@@ -321,12 +402,14 @@ void PlyReader::addDimensions(PointLayoutPtr layout)
     {
         if (elt.m_name == "vertex")
         {
+            elt.m_dims.clear();
             for (auto& prop : elt.m_properties)
             {
                 auto vprop = static_cast<SimpleProperty *>(prop.get());
                 layout->registerOrAssignDim(vprop->m_name, vprop->m_type);
                 vprop->setDim(
                     layout->registerOrAssignDim(vprop->m_name, vprop->m_type));
+                elt.m_dims.emplace_back(vprop->m_dim, vprop->m_type);
             }
             return;
         }
@@ -337,67 +420,55 @@ void PlyReader::addDimensions(PointLayoutPtr layout)
 
 bool PlyReader::readProperty(Property *prop, PointRef& point)
 {
+    if (m_format != Format::Ascii)
+        return prop->readBinary(m_data, point);
+
     if (!m_stream->good())
         return false;
-    prop->read(m_stream, m_format, point);
+    prop->readText(m_stream, point);
     return true;
 }
 
 
-void PlyReader::SimpleProperty::read(std::istream *stream,
-    PlyReader::Format format, PointRef& point)
+void PlyReader::SimpleProperty::readText(std::istream *stream,
+    PointRef& point)
 {
-    if (format == Format::Ascii)
-    {
-        double d;
-        *stream >> d;
-        point.setField(m_dim, d);
-    }
-    else if (format == Format::BinaryLe)
-    {
-        ILeStream in(stream);
-        Everything e = Utils::extractDim(in, m_type);
-        point.setField(m_dim, m_type, &e);
-    }
-    else if (format == Format::BinaryBe)
-    {
-        IBeStream in(stream);
-        Everything e = Utils::extractDim(in, m_type);
-        point.setField(m_dim, m_type, &e);
-    }
+    double d;
+    *stream >> d;
+    point.setField(m_dim, d);
+}
+
+
+bool PlyReader::SimpleProperty::readBinary(DataBuffer& data, PointRef& point)
+{
+    Everything e;
+    if (!data.get(m_type, e))
+        return false;
+    point.setField(m_dim, m_type, &e);
+    return true;
 }
 
 
 // Right now we don't support list properties for point data.  We just
 // read the data and throw it away.
-void PlyReader::ListProperty::read(std::istream *stream,
-    PlyReader::Format format, PointRef& point)
+void PlyReader::ListProperty::readText(std::istream *stream, PointRef& point)
 {
-    if (format == Format::Ascii)
-    {
-        size_t cnt;
-        *stream >> cnt;
+    size_t cnt;
+    *stream >> cnt;
 
-        double d;
-        while (cnt--)
-            *stream >> d;
-    }
-    else if (format == Format::BinaryLe)
-    {
-        ILeStream istream(stream);
-        Everything e = Utils::extractDim(istream, m_countType);
-        size_t cnt = (size_t)Utils::toDouble(e, m_countType);
-        cnt *= Dimension::size(m_listType);
-        istream.seek(cnt, std::ios_base::cur);
-    }
-    else if (format == Format::BinaryBe)
-    {
-        IBeStream istream(stream);
-        Everything e = Utils::extractDim(istream, m_countType);
-        size_t cnt = (size_t)Utils::toDouble(e, m_countType);
-        cnt *= Dimension::size(m_listType);
-        istream.seek(cnt, std::ios_base::cur);
-    }
+    double d;
+    while (cnt--)
+        *stream >> d;
+}
+
+
+bool PlyReader::ListProperty::readBinary(DataBuffer& data, PointRef& point)
+{
+    Everything e;
+    if (!data.get(m_countType, e))
+        return false;
+    size_t cnt = (size_t)Utils::toDouble(e, m_countType);
+    return data.get(cnt * Dimension::size(m_listType)) != nullptr;
 }
 
 
@@ -410,11 +481,25 @@ void PlyReader::readElement(Element& elt, PointRef& point)
 }
 
 
+// Move past the data of an element that isn't loaded.  Binary records of a
+// fixed size don't need to be read at all.
+void PlyReader::skipElement(Element& elt, PointRef& point)
+{
+    if (m_format != Format::Ascii && elt.m_recordSize)
+        m_data.skip(elt.m_count * elt.m_recordSize);
+    else
+        for (PointId idx = 0; idx < elt.m_count; ++idx)
+            readElement(elt, point);
+}
+
+
 void PlyReader::ready(PointTableRef table)
 {
     m_stream = Utils::openFile(m_filename, true);
     if (m_stream)
         m_stream->seekg(m_dataPos);
+    if (m_format != Format::Ascii)
+        m_data.reset(m_stream, needsSwap(m_format == Format::BinaryLe));
     for (Element& elt : m_elements)
     {
         if (&elt == m_vertexElt)
@@ -423,31 +508,141 @@ void PlyReader::ready(PointTableRef table)
         // We read an element into point 0.  Since the element's properties
         // weren't registered as dimensions, we'll try to write the data
         // to a NULL dimension, which is a noop.
-        // This essentially just gets us to the vertex element.
-        // In binary mode, this is all silliness, since we should be able
-        // to seek right where we want to go, but in text mode, you've got
-        // to go through the data.
+        // This essentially just gets us to the vertex element.  In text
+        // mode you've got to go through the data.
         PointRef point(table, 0);
-        for (PointId idx = 0; idx < elt.m_count; ++idx)
-            readElement(elt, point);
+        skipElement(elt, point);
     }
     m_index = 0;
+    m_chunk = nullptr;
+    m_chunkCount = 0;
+}
+
+
+// Read as many vertex records as fit in a block and put them in host byte
+// order.
+void PlyReader::readVertexChunk()
+{
+    const size_t recordSize = m_vertexElt->m_recordSize;
+    const size_t count = (std::min)(m_vertexElt->m_count - m_index,
+        (std::max)(ply::BlockSize / recordSize, (size_t)1));
+
+    m_chunk = m_data.get(count * recordSize);
+    if (!m_chunk)
+        throwError("Error reading data for point/element " +
+            std::to_string(m_index) + ".");
+    if (m_data.swap())
+        swapRecords(m_chunk, count, m_vertexElt->m_dims);
+    m_chunkCount = count;
 }
 
 
 bool PlyReader::processOne(PointRef& point)
 {
-    if (m_index < m_vertexElt->m_count)
+    if (m_index >= m_vertexElt->m_count)
+        return false;
+
+    // Binary vertices with no list properties are read in blocks and
+    // copied to the point as packed records.
+    if (m_format != Format::Ascii && m_vertexElt->m_recordSize)
     {
+        if (!m_chunkCount)
+            readVertexChunk();
+        point.setPackedData(m_vertexElt->m_dims, m_chunk);
+        m_chunk += m_vertexElt->m_recordSize;
+        m_chunkCount--;
+    }
+    else
         readElement(*m_vertexElt, point);
-        m_index++;
-        return true;
+    m_index++;
+    return true;
+}
+
+
+bool PlyReader::readIndices(ListProperty *prop, std::vector<PointId>& indices)
+{
+    indices.clear();
+    if (m_format == Format::Ascii)
+    {
+        size_t cnt;
+        *m_stream >> cnt;
+        while (*m_stream && cnt--)
+        {
+            double d;
+            *m_stream >> d;
+            if (d < 0)
+                return false;
+            indices.push_back((PointId)d);
+        }
+        return (bool)*m_stream;
+    }
+
+    Everything e;
+    if (!m_data.get(prop->m_countType, e))
+        return false;
+    size_t cnt = (size_t)Utils::toDouble(e, prop->m_countType);
+    while (cnt--)
+    {
+        if (!m_data.get(prop->m_listType, e))
+            return false;
+        double d = Utils::toDouble(e, prop->m_listType);
+        if (d < 0)
+            return false;
+        indices.push_back((PointId)d);
+    }
+    return true;
+}
+
+
+// Load the 'face' element, if there is one, as a mesh.  Faces with more
+// than three vertices are split into triangle fans.
+void PlyReader::readFaces(PointViewPtr view)
+{
+    auto vi = std::find_if(m_elements.begin(), m_elements.end(),
+        [this](const Element& elt){ return &elt == m_vertexElt; });
+    auto fi = std::find_if(vi, m_elements.end(),
+        [](const Element& elt){ return elt.m_name == "face"; });
+    if (fi == m_elements.end())
+        return;
+
+    ListProperty *indexProp = nullptr;
+    for (auto& prop : fi->m_properties)
+        if (prop->m_name == "vertex_indices" || prop->m_name == "vertex_index")
+            indexProp = dynamic_cast<ListProperty *>(prop.get());
+    if (!indexProp)
+        return;
+
+    // Faces aren't points, so the values of any other face properties
+    // are discarded, as are elements between the vertices and faces.
+    PointRef point(*view, 0);
+    for (auto ei = std::next(vi); ei != fi; ++ei)
+        skipElement(*ei, point);
+
+    TriangularMesh *mesh = view->createMesh(getName());
+    std::vector<PointId> indices;
+    for (size_t idx = 0; idx < fi->m_count; ++idx)
+    {
+        for (auto& prop : fi->m_properties)
+        {
+            bool ok = (prop.get() == indexProp) ?
+                readIndices(indexProp, indices) :
+                readProperty(prop.get(), point);
+            if (!ok)
+                throwError("Error reading data for face " +
+                    std::to_string(idx) + ".");
+        }
+        for (PointId i : indices)
+            if (i >= view->size())
+                throwError("Invalid vertex index " + std::to_string(i) +
+                    " in face " + std::to_string(idx) + ".");
+        for (size_t i = 2; i < indices.size(); ++i)
+            mesh->add(indices[0], indices[i - 1], indices[i]);
     }
-    return false;
 }
 
 
-// We're just reading the vertex element here.
+// We're reading the vertex element and, if all the vertices are read,
+// the faces.
 point_count_t PlyReader::read(PointViewPtr view, point_count_t num)
 {
     point_count_t cnt(0);
@@ -459,12 +654,15 @@ point_count_t PlyReader::read(PointViewPtr view, point_count_t num)
         processOne(point);
         cnt++;
     }
+    if (cnt == m_vertexElt->m_count)
+        readFaces(view);
     return cnt;
 }
 
 
 void PlyReader::done(PointTableRef table)
 {
+    m_data.reset(nullptr, false);
     Utils::closeFile(m_stream);
 }
 
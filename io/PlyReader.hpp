@@ -37,6 +37,7 @@
 #include <string>
 #include <stack>
 
+#include <pdal/DimType.hpp>
 #include <pdal/Dimension.hpp>
 #include <pdal/Reader.hpp>
 #include <pdal/StageFactory.hpp>
@@ -62,6 +63,29 @@ private:
         BinaryBe
     };
 
+    // Buffered access to binary element data.  Data is read from the
+    // stream in large blocks and handed out from memory.
+    class DataBuffer
+    {
+    public:
+        DataBuffer() : m_stream(nullptr), m_pos(0), m_end(0), m_swap(false)
+        {}
+
+        void reset(std::istream *stream, bool swap);
+        char *get(size_t size);
+        bool get(Dimension::Type type, Everything& e);
+        void skip(size_t size);
+        bool swap() const
+            { return m_swap; }
+
+    private:
+        std::istream *m_stream;
+        std::vector<char> m_buf;
+        size_t m_pos;
+        size_t m_end;
+        bool m_swap;
+    };
+
     struct Property
     {
         Property(const std::string& name) : m_name(name)
@@ -73,8 +97,8 @@ private:
 
         virtual void setDim(Dimension::Id id)
         {}
-        virtual void read(std::istream *stream, PlyReader::Format format,
-            PointRef& point) = 0;
+        virtual void readText(std::istream *stream, PointRef& point) = 0;
+        virtual bool readBinary(DataBuffer& data, PointRef& point) = 0;
     };
 
     struct SimpleProperty : public Property
@@ -86,8 +110,8 @@ private:
         Dimension::Type m_type;
         Dimension::Id m_dim;
 
-        virtual void read(std::istream *stream, PlyReader::Format format,
-            PointRef& point) override;
+        virtual void readText(std::istream *stream, PointRef& point) override;
+        virtual bool readBinary(DataBuffer& data, PointRef& point) override;
         virtual void setDim(Dimension::Id id) override
         { m_dim = id; }
     };
@@ -102,19 +126,24 @@ private:
         Dimension::Type m_countType;
         Dimension::Type m_listType;
 
-        virtual void read(std::istream *stream, PlyReader::Format format,
-            PointRef& point) override;
+        virtual void readText(std::istream *stream, PointRef& point) override;
+        virtual bool readBinary(DataBuffer& data, PointRef& point) override;
     };
 
     struct Element
     {
         Element(const std::string name, size_t count) :
-            m_name(name), m_count(count)
+            m_name(name), m_count(count), m_recordSize(0)
         {}
 
         std::string m_name;
         size_t m_count;
         std::vector<std::unique_ptr<Property>> m_properties;
+        // Size of each record if the element has no list properties,
+        // otherwise 0.
+        size_t m_recordSize;
+        // Dimensions and types of the properties of a fixed-size record.
+        DimTypeList m_dims;
     };
 
     Format m_format;
@@ -126,6 +155,9 @@ private:
     std::vector<Element> m_elements;
     PointId m_index;
     Element *m_vertexElt;
+    DataBuffer m_data;
+    char *m_chunk;
+    size_t m_chunkCount;
 
     virtual void initialize();
     virtual void addDimensions(PointLayoutPtr layout);
@@ -146,7 +178,11 @@ private:
     bool extractElement();
     void extractHeader();
     void readElement(Element& elt, PointRef& point);
+    void skipElement(Element& elt, PointRef& point);
     bool readProperty(Property *prop, PointRef& point);
+    void readVertexChunk();
+    bool readIndices(ListProperty *prop, std::vector<PointId>& indices);
+    void readFaces(PointViewPtr view);
 };
 
 } // namespace pdal
@@ -34,12 +34,14 @@
 
 #include "PlyWriter.hpp"
 
+#include <cstring>
 #include <limits>
 #include <sstream>
 
-#include <pdal/util/OStream.hpp>
 #include <pdal/util/ProgramArgs.hpp>
 
+#include "private/PlySupport.hpp"
+
 namespace pdal
 {
 
@@ -231,71 +233,54 @@ void writeTextVal<uint8_t>(std::ostream& out, PointRef& point,
 void PlyWriter::writeValue(PointRef& point, Dimension::Id dim,
     Dimension::Type type)
 {
-    if (m_format == Format::Ascii)
+    if (Dimension::base(type) == Dimension::BaseType::Floating)
     {
-        if (Dimension::base(type) == Dimension::BaseType::Floating)
+        if (m_precisionArg->set())
         {
-            if (m_precisionArg->set())
-            {
-                *m_stream << std::fixed;
-                m_stream->precision(m_precision);
-            }
-
-            if (type == Dimension::Type::Float)
-                writeTextVal<float>(*m_stream, point, dim);
-            else
-                writeTextVal<double>(*m_stream, point, dim);
-
-            if (m_precisionArg->set())
-                m_stream->unsetf(std::ios_base::fixed);
+            *m_stream << std::fixed;
+            m_stream->precision(m_precision);
         }
+
+        if (type == Dimension::Type::Float)
+            writeTextVal<float>(*m_stream, point, dim);
         else
-        {
-            switch (type)
-            {
-            case Dimension::Type::Unsigned8:
-                writeTextVal<uint8_t>(*m_stream, point, dim);
-                break;
-            case Dimension::Type::Unsigned16:
-                writeTextVal<uint16_t>(*m_stream, point, dim);
-                break;
-            case Dimension::Type::Unsigned32:
-                writeTextVal<uint32_t>(*m_stream, point, dim);
-                break;
-            case Dimension::Type::Unsigned64:
-                writeTextVal<uint64_t>(*m_stream, point, dim);
-                break;
-            case Dimension::Type::Signed8:
-                writeTextVal<int8_t>(*m_stream, point, dim);
-                break;
-            case Dimension::Type::Signed16:
-                writeTextVal<int16_t>(*m_stream, point, dim);
-                break;
-            case Dimension::Type::Signed32:
-                writeTextVal<int32_t>(*m_stream, point, dim);
-                break;
-            case Dimension::Type::Signed64:
-                writeTextVal<int64_t>(*m_stream, point, dim);
-                break;
-            default:
-                throwError("Internal error: invalid type found writing "
-                    "output.");
-            }
-        }
-    }
-    else if (m_format == Format::BinaryLe)
-    {
-        OLeStream out(m_stream);
-        Everything e;
-        point.getField((char *)&e, dim, type);
-        Utils::insertDim(out, type, e);
+            writeTextVal<double>(*m_stream, point, dim);
+
+        if (m_precisionArg->set())
+            m_stream->unsetf(std::ios_base::fixed);
     }
-    else if (m_format == Format::BinaryBe)
+    else
     {
-        OBeStream out(m_stream);
-        Everything e;
-        point.getField((char *)&e, dim, type);
-        Utils::insertDim(out, type, e);
+        switch (type)
+        {
+        case Dimension::Type::Unsigned8:
+            writeTextVal<uint8_t>(*m_stream, point, dim);
+            break;
+        case Dimension::Type::Unsigned16:
+            writeTextVal<uint16_t>(*m_stream, point, dim);
+            break;
+        case Dimension::Type::Unsigned32:
+            writeTextVal<uint32_t>(*m_stream, point, dim);
+            break;
+        case Dimension::Type::Unsigned64:
+            writeTextVal<uint64_t>(*m_stream, point, dim);
+            break;
+        case Dimension::Type::Signed8:
+            writeTextVal<int8_t>(*m_stream, point, dim);
+            break;
+        case Dimension::Type::Signed16:
+            writeTextVal<int16_t>(*m_stream, point, dim);
+            break;
+        case Dimension::Type::Signed32:
+            writeTextVal<int32_t>(*m_stream, point, dim);
+            break;
+        case Dimension::Type::Signed64:
+            writeTextVal<int64_t>(*m_stream, point, dim);
+            break;
+        default:
+            throwError("Internal error: invalid type found writing "
+                "output.");
+        }
     }
 }
 
@@ -306,38 +291,92 @@ void PlyWriter::writePoint(PointRef& point, PointLayoutPtr layout)
     {
         writeValue(point, it->m_id, it->m_type);
         ++it;
-        if (m_format == Format::Ascii && it != m_dims.end())
+        if (it != m_dims.end())
             *m_stream << " ";
     }
-    if (m_format == Format::Ascii)
-        *m_stream << std::endl;
+    *m_stream << "\n";
 }
 
 
 void PlyWriter::writeTriangle(const Triangle& t, size_t offset)
 {
-    if (m_format == Format::Ascii)
-    {
-        *m_stream << "3 " << (t.m_a + offset) << " " <<
-            (t.m_b + offset) << " " << (t.m_c + offset) << std::endl;
-    }
-    else if (m_format == Format::BinaryLe)
+    *m_stream << "3 " << (t.m_a + offset) << " " <<
+        (t.m_b + offset) << " " << (t.m_c + offset) << "\n";
+}
+
+
+// Binary points are packed into blocks of records, which are put in the
+// file's byte order and written at once.
+void PlyWriter::writeBinaryPoints()
+{
+    size_t recordSize = 0;
+    for (const DimType& dim : m_dims)
+        recordSize += Dimension::size(dim.m_type);
+    if (!recordSize)
+        return;
+
+    const bool swap = needsSwap(m_format == Format::BinaryLe);
+    const size_t blockCount = (std::max)(ply::BlockSize / recordSize,
+        (size_t)1);
+    std::vector<char> buf(blockCount * recordSize);
+    for (auto& v : m_views)
     {
-        OLeStream out(m_stream);
-        unsigned char count = 3;
-        uint32_t a = (uint32_t)(t.m_a + offset);
-        uint32_t b = (uint32_t)(t.m_b + offset);
-        uint32_t c = (uint32_t)(t.m_c + offset);
-        out << count << a << b << c;
+        PointRef point(*v, 0);
+        for (PointId start = 0; start < v->size(); start += blockCount)
+        {
+            const size_t count = (std::min)(blockCount, v->size() - start);
+            char *pos = buf.data();
+            for (PointId idx = start; idx < start + count; ++idx)
+            {
+                point.setPointId(idx);
+                point.getPackedData(m_dims, pos);
+                pos += recordSize;
+            }
+            if (swap)
+                swapRecords(buf.data(), count, m_dims);
+            m_stream->write(buf.data(), count * recordSize);
+        }
     }
-    else if (m_format == Format::BinaryBe)
+}
+
+
+// Binary faces are written in blocks like points.  Each face record is a
+// one-byte vertex count followed by three 32-bit vertex indices.
+void PlyWriter::writeBinaryFaces()
+{
+    using namespace Dimension;
+
+    const DimTypeList faceDims { { Id::Unknown, Type::Unsigned8 },
+        { Id::Unknown, Type::Unsigned32 }, { Id::Unknown, Type::Unsigned32 },
+        { Id::Unknown, Type::Unsigned32 } };
+    const size_t recordSize = 13;
+
+    const bool swap = needsSwap(m_format == Format::BinaryLe);
+    const size_t blockCount = ply::BlockSize / recordSize;
+    std::vector<char> buf(blockCount * recordSize);
+    std::vector<uint32_t> indices(blockCount * 3);
+    PointId offset = 0;
+    for (auto& v : m_views)
     {
-        OBeStream out(m_stream);
-        unsigned char count = 3;
-        uint32_t a = (uint32_t)(t.m_a + offset);
-        uint32_t b = (uint32_t)(t.m_b + offset);
-        uint32_t c = (uint32_t)(t.m_c + offset);
-        out << count << a << b << c;
+        TriangularMesh *mesh = v->mesh();
+        const size_t size = mesh ? mesh->size() : 0;
+        for (size_t start = 0; start < size; start += blockCount)
+        {
+            const size_t count = (std::min)(blockCount, size - start);
+            mesh->copyIndices(start, count, indices.data(), offset);
+            char *pos = buf.data();
+            for (size_t i = 0; i < count; ++i)
+            {
+                *pos = 3;
+                std::memcpy(pos + 1, indices.data() + i * 3,
+                    3 * sizeof(uint32_t));
+                pos += recordSize;
+            }
+            if (swap)
+                swapRecords(buf.data(), count, faceDims);
+            m_stream->write(buf.data(), count * recordSize);
+        }
+        offset += v->size();
     }
 }
 
@@ -346,32 +385,37 @@ void PlyWriter::writeTriangle(const Triangle& t, size_t offset)
 // point views to be written.
 void PlyWriter::done(PointTableRef table)
 {
-    for (auto& v : m_views)
+    if (m_format == Format::Ascii)
     {
-        PointRef point(*v, 0);
-        for (PointId idx = 0; idx < v->size(); ++idx)
+        for (auto& v : m_views)
         {
-            point.setPointId(idx);
-            writePoint(point, table.layout());
+            PointRef point(*v, 0);
+            for (PointId idx = 0; idx < v->size(); ++idx)
+            {
+                point.setPointId(idx);
+                writePoint(point, table.layout());
+            }
         }
-    }
-    if (m_faces)
-    {
-        PointId offset = 0;
-        for (auto& v : m_views)
+        if (m_faces)
         {
-            TriangularMesh *mesh = v->mesh();
-            if (mesh)
+            PointId offset = 0;
+            for (auto& v : m_views)
             {
-                for (size_t id = 0; id < mesh->size(); ++id)
-                {
-                    const Triangle& t = (*mesh)[id];
-                    writeTriangle(t, offset);
-                }
+                TriangularMesh *mesh = v->mesh();
+                if (mesh)
+                    mesh->forEach([this, offset](PointId a, PointId b,
+                            PointId c)
+                        { writeTriangle(Triangle(a, b, c), offset); });
+                offset += v->size();
             }
-            offset += v->size();
         }
     }
+    else
+    {
+        writeBinaryPoints();
+        if (m_faces)
+            writeBinaryFaces();
+    }
     Utils::closeFile(m_stream);
     m_stream = nullptr;
     getMetadata().addList("filename", m_filename);
@@ -66,6 +66,8 @@ private:
     void writeValue(PointRef& point, Dimension::Id dim, Dimension::Type type);
     void writePoint(PointRef& point, PointLayoutPtr layout);
     void writeTriangle(const Triangle& t, size_t offset);
+    void writeBinaryPoints();
+    void writeBinaryFaces();
 
     std::ostream *m_stream;
     std::string m_filename;
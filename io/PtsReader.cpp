@@ -34,8 +34,10 @@
 
 #include <pdal/PDALUtils.hpp>
 #include <pdal/util/Algorithm.hpp>
+#include <pdal/util/ProgramArgs.hpp>
 
 #include "PtsReader.hpp"
+#include "private/TextParse.hpp"
 
 namespace pdal
 {
@@ -52,8 +54,18 @@ CREATE_STATIC_STAGE(PtsReader, s_info)
 
 std::string PtsReader::getName() const { return s_info.name; }
 
+void PtsReader::addArgs(ProgramArgs& args)
+{
+    args.add("threads", "Number of threads used to parse points",
+        m_threads, 1);
+}
+
+
 void PtsReader::initialize(PointTableRef table)
 {
+    if (m_threads < 1)
+        throwError("Option 'threads' must be at least 1.");
+
     m_istream = Utils::openFile(m_filename);
     if (!m_istream)
         throwError("Unable to open file '" + m_filename + "'.");
@@ -122,54 +134,67 @@ void PtsReader::ready(PointTableRef table)
 }
 
 
+// Text is read in blocks that are split into chunks of whole lines.
+// Each chunk is parsed on its own thread, then the points and errors are
+// added in order, so the result is the same as reading one line at a time.
 point_count_t PtsReader::read(PointViewPtr view, point_count_t numPts)
 {
     PointId idx = view->size();
+    PointRef point(*view, idx);
 
     point_count_t cnt = 0;
     size_t line = 1;
 
-    // Continue reading while count less than max points and count less than 
+    // Continue reading while count less than max points and count less than
     // the expected point count.
-    while (m_istream->good() && cnt < numPts && cnt < m_PointCount)
+    numPts = (std::min)(numPts, m_PointCount);
+    textparse::LineReader lines(*m_istream);
+    textparse::ChunkList chunks((size_t)m_threads);
+    const size_t numDims = m_dims.size();
+    while (cnt < numPts && lines.next(chunks))
     {
-        std::string buf;
-        StringList fields;
-
-        std::getline(*m_istream, buf);
-        line++;
-        if (buf.empty())
-            continue;
-
-        fields = Utils::split2(buf, m_separator);
-        if (fields.size() != m_dims.size())
+        textparse::parseChunks(chunks, numDims, m_separator);
+        for (textparse::Chunk& c : chunks)
         {
-            log()->get(LogLevel::Error) << "Line " << line <<
-               " in '" << m_filename << "' contains " << fields.size() <<
-               " fields when " << m_dims.size() << " were expected.  "
-               "Ignoring." << std::endl;
-            continue;
-        }
-
-        double d;
-        for (size_t i = 0; i < fields.size(); ++i)
-        {
-            if (!Utils::fromString(fields[i], d))
+            // Once the last point has been read, no more lines are read,
+            // so errors in lines after it aren't reported.
+            bool last = (c.m_points >= numPts - cnt);
+            point_count_t count = (std::min)(c.m_points, numPts - cnt);
+            for (const textparse::Chunk::Error& err : c.m_errors)
             {
-                log()->get(LogLevel::Error) << "Can't convert "
-                    "field '" << fields[i] << "' to numeric value on line " <<
-                    line << " in '" << m_filename << "'.  Setting to 0." <<
-                    std::endl;
-                d = 0;
+                if (last && err.m_point >= count)
+                    break;
+                if (err.m_fieldCount != numDims)
+                    log()->get(LogLevel::Error) << "Line " <<
+                        (line + err.m_line) << " in '" << m_filename <<
+                        "' contains " << err.m_fieldCount << " fields when " <<
+                        numDims << " were expected.  Ignoring." << std::endl;
+                else
+                    log()->get(LogLevel::Error) << "Can't convert "
+                        "field '" << err.m_field << "' to numeric value "
+                        "on line " << (line + err.m_line) << " in '" <<
+                        m_filename << "'.  Setting to 0." << std::endl;
             }
-            if (i == 3) // Intensity field in PTS is -2048 to 2047, we map to 0 4095
+
+            const double *d = c.m_values.data();
+            for (point_count_t i = 0; i < count; ++i)
             {
-                d += 2048;
+                point.setPointId(idx++);
+                for (size_t dim = 0; dim < numDims; ++dim)
+                {
+                    double v = *d++;
+                    // Intensity field in PTS is -2048 to 2047, we map to
+                    // 0 4095
+                    if (dim == 3)
+                        v += 2048;
+                    point.setField(m_dims[dim], v);
+                }
             }
-            view->setField(m_dims[i], idx, d);
+            cnt += count;
+            line += c.m_lines;
+            if (cnt == numPts)
+                break;
         }
-        cnt++;
-        idx++;
     }
 
     if(cnt < m_PointCount)
@@ -44,11 +44,14 @@ namespace pdal
 class PDAL_DLL PtsReader : public Reader
 {
 public:
-    PtsReader() : m_separator(' '), m_PointCount(0), m_istream(NULL)
+    PtsReader() : m_separator(' '), m_PointCount(0), m_istream(NULL),
+        m_threads(1)
     {}
     std::string getName() const;
 
 private:
+    virtual void addArgs(ProgramArgs& args);
+
     /**
       Initialize the reader by opening the file and reading the header line
       for the point count.
@@ -95,6 +98,7 @@ private:
     std::istream *m_istream;
     StringList m_dimNames;
     Dimension::IdList m_dims;
+    int m_threads;
 };
 
 } // namespace pdal
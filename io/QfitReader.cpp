@@ -165,9 +165,9 @@ Word #       Content
 */
 
 #include "QfitReader.hpp"
+#include "private/FixedRecordFile.hpp"
 
 #include <pdal/PointView.hpp>
-#include <pdal/util/Extractor.hpp>
 #include <pdal/util/portable_endian.hpp>
 #include <pdal/util/ProgramArgs.hpp>
 
@@ -196,7 +196,10 @@ QfitReader::QfitReader()
     , m_format(QFIT_Format_Unknown)
     , m_size(0)
     , m_littleEndian(false)
-    , m_istream()
+{}
+
+
+QfitReader::~QfitReader()
 {}
 
 
@@ -315,84 +318,93 @@ void QfitReader::ready(PointTableRef)
         throwError("Error calculating file point count.  File size is "
             "inconsistent with point size.");
     m_index = 0;
-    m_istream.reset(new IStream(m_filename));
-    m_istream->seek(m_offset);
+    try
+    {
+        m_file.reset(new FixedRecordFile(m_filename, m_offset, m_size,
+            !m_littleEndian));
+    }
+    catch (const pdal_error& err)
+    {
+        throwError(err.what());
+    }
 }
 
 
+// Records are decoded a block at a time into an array for each word.
 point_count_t QfitReader::read(PointViewPtr data, point_count_t count)
 {
-    if (!m_istream->good())
-        throwError("Corrupted file/file read error.");
-    if (m_istream->stream()->eof())
-        throwError("End of file detected.");
+    const point_count_t BlockSize = 4096;
 
     count = (std::min)(m_numPoints - m_index, count);
-    std::vector<char> buf(m_size);
+
+    // GPS time is really a GPS offset from the start of the GPS day
+    // encoded in this odd way: 153320100 = 15 hours 33 minutes
+    // 20 seconds 100 milliseconds.
+    // Not sure why we have that AND the other offset time.  For now
+    // we drop it, so the last word of the record isn't decoded.
+    m_words.resize(m_size / sizeof(int32_t) - 1);
+
     PointId nextId = data->size();
     point_count_t numRead = 0;
-    while (count--)
+    while (numRead < count)
     {
-        m_istream->get(buf);
-        SwitchableExtractor extractor(buf.data(), m_size, m_littleEndian);
-
-        // always read the base fields
-        {
-            int32_t time, y, xi, z, start_pulse, reflected_pulse, scan_angle,
-                pitch, roll;
-            extractor >> time >> y >> xi >> z >> start_pulse >>
-                reflected_pulse >> scan_angle >> pitch >> roll;
-            double x = xi / 1000000.0;
-            if (m_flip_x && x > 180)
-                x -= 360;
-
-            data->setField(Dimension::Id::OffsetTime, nextId, time);
-            data->setField(Dimension::Id::Y, nextId, y / 1000000.0);
-            data->setField(Dimension::Id::X, nextId, x);
-            data->setField(Dimension::Id::Z, nextId, z * m_scale_z);
-            data->setField(Dimension::Id::StartPulse, nextId, start_pulse);
-            data->setField(Dimension::Id::ReflectedPulse, nextId,
-                reflected_pulse);
-            data->setField(Dimension::Id::Azimuth, nextId,
-                scan_angle / 1000.0);
-            data->setField(Dimension::Id::Pitch, nextId, pitch / 1000.0);
-            data->setField(Dimension::Id::Roll, nextId, roll / 1000.0);
-        }
-
-        if (m_format == QFIT_Format_12)
-        {
-            int32_t pdop, pulse_width;
-            extractor >> pdop >> pulse_width;
-            data->setField(Dimension::Id::Pdop, nextId, pdop / 10.0);
-            data->setField(Dimension::Id::PulseWidth, nextId, pulse_width);
-        }
-        else if (m_format == QFIT_Format_14)
+        point_count_t n = m_file->load(m_index + numRead,
+            (std::min)(count - numRead, BlockSize));
+        if (n == 0)
+            throwError("End of file detected.");
+        for (size_t w = 0; w < m_words.size(); ++w)
+            m_file->decode(w * sizeof(int32_t), m_words[w]);
+
+        for (point_count_t i = 0; i < n; ++i)
         {
-            int32_t passive_signal, passive_y, passive_x, passive_z;
-            extractor >> passive_signal >> passive_y >> passive_x >> passive_z;
-            double x = passive_x / 1000000.0;
-            if (m_flip_x && x > 180)
-                x -= 360;
-            data->setField(Dimension::Id::PassiveSignal, nextId, passive_signal);
-            data->setField(Dimension::Id::PassiveY, nextId,
-                passive_y / 1000000.0);
-            data->setField(Dimension::Id::PassiveX, nextId, x);
-            data->setField(Dimension::Id::PassiveZ, nextId,
-                passive_z * m_scale_z);
+            auto word = [this, i](size_t w) { return m_words[w][i]; };
+
+            // always read the base fields
+            {
+                double x = word(2) / 1000000.0;
+                if (m_flip_x && x > 180)
+                    x -= 360;
+
+                data->setField(Dimension::Id::OffsetTime, nextId, word(0));
+                data->setField(Dimension::Id::Y, nextId,
+                    word(1) / 1000000.0);
+                data->setField(Dimension::Id::X, nextId, x);
+                data->setField(Dimension::Id::Z, nextId, word(3) * m_scale_z);
+                data->setField(Dimension::Id::StartPulse, nextId, word(4));
+                data->setField(Dimension::Id::ReflectedPulse, nextId,
+                    word(5));
+                data->setField(Dimension::Id::Azimuth, nextId,
+                    word(6) / 1000.0);
+                data->setField(Dimension::Id::Pitch, nextId,
+                    word(7) / 1000.0);
+                data->setField(Dimension::Id::Roll, nextId,
+                    word(8) / 1000.0);
+            }
+
+            if (m_format == QFIT_Format_12)
+            {
+                data->setField(Dimension::Id::Pdop, nextId, word(9) / 10.0);
+                data->setField(Dimension::Id::PulseWidth, nextId, word(10));
+            }
+            else if (m_format == QFIT_Format_14)
+            {
+                double x = word(11) / 1000000.0;
+                if (m_flip_x && x > 180)
+                    x -= 360;
+                data->setField(Dimension::Id::PassiveSignal, nextId,
+                    word(9));
+                data->setField(Dimension::Id::PassiveY, nextId,
+                    word(10) / 1000000.0);
+                data->setField(Dimension::Id::PassiveX, nextId, x);
+                data->setField(Dimension::Id::PassiveZ, nextId,
+                    word(12) * m_scale_z);
+            }
+
+            if (m_cb)
+                m_cb(*data, nextId);
+            nextId++;
         }
-        // GPS time is really a GPS offset from the start of the GPS day
-        // encoded in this odd way: 153320100 = 15 hours 33 minutes
-        // 20 seconds 100 milliseconds.
-        // Not sure why we have that AND the other offset time.  For now
-        // we'll just extract this time and drop it.
-        int32_t gpstime;
-        extractor >> gpstime;
-
-        if (m_cb)
-            m_cb(*data, nextId);
-
-        numRead++;
-        nextId++;
+        numRead += n;
     }
     m_index += numRead;
 
@@ -402,7 +414,7 @@ point_count_t QfitReader::read(PointViewPtr data, point_count_t count)
 
 void QfitReader::done(PointTableRef)
 {
-    m_istream.reset();
+    m_file.reset();
 }
 
 } // namespace pdal
@@ -44,6 +44,8 @@
 namespace pdal
 {
 
+class FixedRecordFile;
+
 enum QFIT_Format_Type
 {
     QFIT_Format_10 = 10,
@@ -56,6 +58,7 @@ class PDAL_DLL QfitReader : public pdal::Reader
 {
 public:
     QfitReader();
+    ~QfitReader();
 
     std::string getName() const;
 
@@ -68,8 +71,9 @@ private:
     double m_scale_z;
     bool m_littleEndian;
     point_count_t m_numPoints;
-    std::unique_ptr<IStream> m_istream;
+    std::unique_ptr<FixedRecordFile> m_file;
     point_count_t m_index;
+    std::vector<std::vector<int32_t>> m_words;
 
     virtual void addArgs(ProgramArgs& args);
     virtual void initialize();
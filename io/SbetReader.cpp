@@ -34,6 +34,7 @@
 
 #include "SbetReader.hpp"
 #include "SbetCommon.hpp"
+#include "private/FixedRecordFile.hpp"
 
 #include <pdal/PointRef.hpp>
 #include <pdal/util/FileUtils.hpp>
@@ -56,6 +57,15 @@ CREATE_STATIC_STAGE(SbetReader, s_info)
 
 std::string SbetReader::getName() const { return s_info.name; }
 
+
+SbetReader::SbetReader() : Reader()
+{}
+
+
+SbetReader::~SbetReader()
+{}
+
+
 void SbetReader::addArgs(ProgramArgs& args)
 {
     args.add("angles_as_degrees", "Convert all angles to degrees", m_anglesAsDegrees, true);
@@ -73,51 +83,71 @@ void SbetReader::ready(PointTableRef)
     size_t pointSize = sbet::fileDimensions().size() * sizeof(double);
     if (fileSize % pointSize != 0)
         throwError("Invalid file size.");
-    m_numPts = fileSize / pointSize;
+    try
+    {
+        m_file.reset(new FixedRecordFile(m_filename, 0, pointSize));
+    }
+    catch (const pdal_error& err)
+    {
+        throwError(err.what());
+    }
+    m_numPts = m_file->numRecords();
     m_index = 0;
-    m_stream.reset(new ILeStream(m_filename));
     m_dims = sbet::fileDimensions();
-    seek(m_index);
+}
+
+
+double SbetReader::convert(Dimension::Id dim, double d) const
+{
+    if (m_anglesAsDegrees && sbet::isAngularDimension(dim))
+        d = d * 180.0 / M_PI;
+    return d;
 }
 
 
 bool SbetReader::processOne(PointRef& point)
 {
-    auto radiansToDegrees = [](double radians) {
-        return radians * 180.0 / M_PI;
-    };
-    for (auto di = m_dims.begin(); di != m_dims.end(); ++di)
+    if (m_file->load(m_index, 1) != 1)
+        return false;
+    for (size_t i = 0; i < m_dims.size(); ++i)
     {
         double d;
-        *m_stream >> d;
-        Dimension::Id dim = *di;
-        if (m_anglesAsDegrees && sbet::isAngularDimension(dim)) {
-            d = radiansToDegrees(d);
-        }
-        point.setField(dim, d);
+        m_file->decode(i * sizeof(double), &d);
+        point.setField(m_dims[i], convert(m_dims[i], d));
     }
-    return (m_stream->good());
+    m_index++;
+    return true;
 }
 
 
+// Records are decoded a block at a time, one dimension after another.
 point_count_t SbetReader::read(PointViewPtr view, point_count_t count)
 {
+    const point_count_t BlockSize = 4096;
+
     PointId nextId = view->size();
-    PointId idx = m_index;
     point_count_t numRead = 0;
-    seek(idx);
-    while (numRead < count && idx < m_numPts)
+    while (numRead < count)
     {
-        PointRef point = view->point(nextId);
-        processOne(point);
+        point_count_t n = m_file->load(m_index,
+            (std::min)(count - numRead, BlockSize));
+        if (n == 0)
+            break;
+        for (size_t i = 0; i < m_dims.size(); ++i)
+        {
+            Dimension::Id dim = m_dims[i];
+            m_file->decode(i * sizeof(double), m_values);
+            for (point_count_t j = 0; j < n; ++j)
+                view->setField(dim, nextId + j, convert(dim, m_values[j]));
+        }
         if (m_cb)
-            m_cb(*view, nextId);
+            for (point_count_t j = 0; j < n; ++j)
+                m_cb(*view, nextId + j);
 
-        idx++;
-        nextId++;
-        numRead++;
+        m_index += n;
+        nextId += n;
+        numRead += n;
     }
-    m_index = idx;
     return numRead;
 }
 
@@ -128,9 +158,9 @@ bool SbetReader::eof()
 }
 
 
-void SbetReader::seek(PointId idx)
+void SbetReader::done(PointTableRef)
 {
-    m_stream->seek(idx * sizeof(double) * sbet::fileDimensions().size());
+    m_file.reset();
 }
 
 } // namespace pdal
@@ -37,26 +37,28 @@
 #include <pdal/PointView.hpp>
 #include <pdal/Reader.hpp>
 #include <pdal/Streamable.hpp>
-#include <pdal/util/IStream.hpp>
 #include <pdal/util/ProgramArgs.hpp>
 
 namespace pdal
 {
 
+class FixedRecordFile;
+
 class PDAL_DLL SbetReader : public Reader, public Streamable
 {
 public:
-    SbetReader() : Reader()
-        {}
+    SbetReader();
+    ~SbetReader();
 
     std::string getName() const;
 
 private:
-    std::unique_ptr<ILeStream> m_stream;
+    std::unique_ptr<FixedRecordFile> m_file;
     // Number of points in the file.
     point_count_t m_numPts;
     point_count_t m_index;
     Dimension::IdList m_dims;
+    std::vector<double> m_values;
     bool m_anglesAsDegrees;
 
     virtual bool processOne(PointRef& point);
@@ -65,8 +67,9 @@ private:
     virtual void ready(PointTableRef table);
     virtual point_count_t read(PointViewPtr view, point_count_t count);
     virtual bool eof();
+    virtual void done(PointTableRef table);
 
-    void seek(PointId idx);
+    double convert(Dimension::Id dim, double d) const;
 };
 
 } // namespace pdal
@@ -0,0 +1,187 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <nlohmann/json.hpp>
+
+#include "ShmReader.hpp"
+#include "private/ShmRing.hpp"
+
+namespace pdal
+{
+
+static StaticPluginInfo const s_info
+{
+    "readers.shm",
+    "Read points from a shared memory ring buffer written by writers.shm.",
+    "http://pdal.io/stages/readers.shm.html"
+};
+
+CREATE_STATIC_STAGE(ShmReader, s_info)
+
+std::string ShmReader::getName() const { return s_info.name; }
+
+
+ShmReader::ShmReader() : m_ring(new ShmRing)
+{}
+
+
+ShmReader::~ShmReader()
+{}
+
+
+void ShmReader::addArgs(ProgramArgs& args)
+{
+    args.add("name", "Name of the shared memory segment", m_name);
+    args.add("timeout", "Seconds to wait for the writer to create the "
+        "segment or provide points (0 waits forever)", m_timeout, 0.0);
+}
+
+
+// The segment is created when the writer is prepared, so preparing the
+// reader waits for the writer.
+void ShmReader::initialize()
+{
+    if (m_name.empty())
+        throwError("Option 'name' can't be empty.");
+    if (m_name[0] != '/')
+        m_name = "/" + m_name;
+
+    NL::json schema;
+    try
+    {
+        m_ring->open(m_name, m_timeout);
+        schema = NL::json::parse(m_ring->schema());
+        m_schema.clear();
+        for (const NL::json& dim : schema.at("dimensions"))
+        {
+            std::string name = dim.at("name").get<std::string>();
+            Dimension::Type type =
+                Dimension::type(dim.at("type").get<std::string>());
+            if (type == Dimension::Type::None)
+                throw pdal_error("Invalid type for dimension '" + name +
+                    "' in shared memory '" + m_name + "'.");
+            m_schema.emplace_back(name, type);
+        }
+    }
+    catch (const NL::json::exception& err)
+    {
+        throwError("Invalid schema in shared memory '" + m_name + "': " +
+            err.what());
+    }
+    catch (const pdal_error& err)
+    {
+        throwError(err.what());
+    }
+    setSpatialReference(schema.value("srs", ""));
+}
+
+
+void ShmReader::addDimensions(PointLayoutPtr layout)
+{
+    m_dims.clear();
+    for (auto& d : m_schema)
+        m_dims.emplace_back(layout->registerOrAssignDim(d.first, d.second),
+            d.second);
+}
+
+
+void ShmReader::ready(PointTableRef)
+{
+    m_pointSize = m_ring->pointSize();
+    m_slot = nullptr;
+    m_slotCount = 0;
+    m_slotPos = 0;
+}
+
+
+point_count_t ShmReader::read(PointViewPtr view, point_count_t count)
+{
+    PointId idx = view->size();
+    point_count_t cnt = 0;
+
+    PointRef point(*view);
+    while (cnt < count)
+    {
+        point.setPointId(idx);
+        if (!processOne(point))
+            break;
+        cnt++;
+        idx++;
+    }
+    return cnt;
+}
+
+
+bool ShmReader::processOne(PointRef& point)
+{
+    try
+    {
+        if (m_slot && m_slotPos == m_slotCount)
+        {
+            m_ring->release();
+            m_slot = nullptr;
+        }
+        while (!m_slot)
+        {
+            m_slot = m_ring->acquireRead(m_slotCount, m_timeout);
+            if (!m_slot)
+                return false;
+            m_slotPos = 0;
+            if (m_slotCount == 0)
+            {
+                m_ring->release();
+                m_slot = nullptr;
+            }
+        }
+    }
+    catch (const pdal_error& err)
+    {
+        throwError(err.what());
+    }
+
+    point.setPackedData(m_dims, m_slot + m_slotPos * m_pointSize);
+    m_slotPos++;
+    return true;
+}
+
+
+void ShmReader::done(PointTableRef)
+{
+    if (m_slot)
+        m_ring->release();
+    m_slot = nullptr;
+    m_ring->close();
+}
+
+} // namespace pdal
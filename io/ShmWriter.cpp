@@ -0,0 +1,168 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <nlohmann/json.hpp>
+
+#include "ShmWriter.hpp"
+#include "private/ShmRing.hpp"
+
+namespace pdal
+{
+
+static StaticPluginInfo const s_info
+{
+    "writers.shm",
+    "Write points to a shared memory ring buffer read by readers.shm.",
+    "http://pdal.io/stages/writers.shm.html"
+};
+
+CREATE_STATIC_STAGE(ShmWriter, s_info)
+
+std::string ShmWriter::getName() const { return s_info.name; }
+
+
+ShmWriter::ShmWriter() : m_ring(new ShmRing)
+{}
+
+
+ShmWriter::~ShmWriter()
+{}
+
+
+void ShmWriter::addArgs(ProgramArgs& args)
+{
+    args.add("name", "Name of the shared memory segment", m_name);
+    args.add("batch_size", "Number of points in each slot of the ring",
+        m_batchSize, point_count_t(16384));
+    args.add("slots", "Number of slots in the ring", m_slots, size_t(4));
+    args.add("timeout", "Seconds to wait for the reader to free a slot "
+        "(0 waits forever)", m_timeout, 0.0);
+}
+
+
+void ShmWriter::initialize()
+{
+    if (m_name.empty())
+        throwError("Option 'name' can't be empty.");
+    if (m_name[0] != '/')
+        m_name = "/" + m_name;
+    if (m_batchSize == 0)
+        throwError("Option 'batch_size' must be greater than 0.");
+    if (m_slots < 2)
+        throwError("Option 'slots' must be at least 2.");
+}
+
+
+void ShmWriter::ready(PointTableRef table)
+{
+    PointLayoutPtr layout = table.layout();
+    m_dims = layout->dimTypes();
+    m_pointSize = layout->pointSize();
+
+    NL::json schema;
+    NL::json dims = NL::json::array();
+    for (const DimType& d : m_dims)
+        dims.push_back({ { "name", layout->dimName(d.m_id) },
+            { "type", Dimension::interpretationName(d.m_type) } });
+    schema["dimensions"] = dims;
+    schema["srs"] = table.anySpatialReference().getWKT();
+
+    try
+    {
+        m_ring->create(m_name, schema.dump(), m_pointSize, m_batchSize,
+            m_slots);
+    }
+    catch (const pdal_error& err)
+    {
+        throwError(err.what());
+    }
+    m_slot = nullptr;
+    m_slotCount = 0;
+}
+
+
+void ShmWriter::publish()
+{
+    m_ring->publish(m_slotCount);
+    m_slot = nullptr;
+    m_slotCount = 0;
+}
+
+
+bool ShmWriter::processOne(PointRef& point)
+{
+    try
+    {
+        if (!m_slot)
+            m_slot = m_ring->acquireWrite(m_timeout);
+        point.getPackedData(m_dims, m_slot + m_slotCount * m_pointSize);
+        if (++m_slotCount == m_batchSize)
+            publish();
+    }
+    catch (const pdal_error& err)
+    {
+        throwError(err.what());
+    }
+    return true;
+}
+
+
+void ShmWriter::write(const PointViewPtr view)
+{
+    PointRef point(*view, 0);
+    for (PointId idx = 0; idx < view->size(); ++idx)
+    {
+        point.setPointId(idx);
+        processOne(point);
+    }
+}
+
+
+void ShmWriter::done(PointTableRef)
+{
+    try
+    {
+        if (m_slotCount)
+            publish();
+        m_ring->finish(m_timeout);
+    }
+    catch (const pdal_error& err)
+    {
+        m_ring->close();
+        throwError(err.what());
+    }
+    m_ring->close();
+}
+
+} // namespace pdal
@@ -34,8 +34,11 @@
 
 #include "TIndexReader.hpp"
 #include <pdal/GDALUtils.hpp>
+#include <pdal/PointTable.hpp>
 #include <pdal/util/ProgramArgs.hpp>
 
+#include "private/MemberQueue.hpp"
+
 namespace pdal
 {
 
@@ -51,6 +54,15 @@ CREATE_STATIC_STAGE(TIndexReader, s_info)
 
 std::string TIndexReader::getName() const { return s_info.name; }
 
+TIndexReader::TIndexReader() : m_dataset(NULL), m_layer(NULL),
+    m_queue(new MemberQueue), m_layout(nullptr)
+{}
+
+
+TIndexReader::~TIndexReader()
+{}
+
+
 TIndexReader::FieldIndexes TIndexReader::getFields()
 {
     FieldIndexes indexes;
@@ -125,6 +137,8 @@ void TIndexReader::addArgs(ProgramArgs& args)
         "with lyr_name", m_attributeFilter);
     args.add("dialect", "OGR SQL dialect to use when querying tile "
         "index layer", m_dialect, "OGRSQL");
+    args.add("threads", "Number of member files to read at once", m_threads,
+        1);
 }
 
 
@@ -138,6 +152,8 @@ void TIndexReader::addDimensions(PointLayoutPtr layout)
 
 void TIndexReader::initialize()
 {
+    if (m_threads < 1)
+        throwError("Option 'threads' must be at least 1.");
     if (!m_bounds.empty())
         m_wkt = m_bounds.toWKT();
     m_out_ref.reset(new gdal::SpatialRef());
@@ -207,53 +223,12 @@ void TIndexReader::initialize()
                 "' for OGR datasource '" + m_filename + "'");
     }
 
-    Options cropOptions;
-    if (m_wkt.size())
-        cropOptions.add("polygon", m_wkt);
-
-    for (auto f : getFiles())
+    m_files = getFiles();
+    for (auto f : m_files)
     {
         log()->get(LogLevel::Debug) << "Adding file " << f.m_filename <<
             " to merge filter" << std::endl;
-
-        std::string driver = m_factory.inferReaderDriver(f.m_filename);
-        Stage *reader = m_factory.createStage(driver);
-        if (!reader)
-            throwError("Unable to create reader for file '" + f.m_filename +
-                "'.");
-        Options readerOptions;
-        readerOptions.add("filename", f.m_filename);
-        reader->setOptions(readerOptions);
-        Stage *premerge = reader;
-
-        if (m_tgtSrsString != f.m_srs &&
-            (m_tgtSrsString.size() && f.m_srs.size()))
-        {
-            Stage *repro = m_factory.createStage("filters.reprojection");
-            repro->setInput(*reader);
-            Options reproOptions;
-            reproOptions.add("out_srs", m_tgtSrsString);
-            reproOptions.add("in_srs", f.m_srs);
-            log()->get(LogLevel::Debug2) << "Repro = "
-                                         << m_tgtSrsString << "/"
-                                         << f.m_srs << "!\n";
-            repro->setOptions(reproOptions);
-            premerge = repro;
-        }
-
-        // WKT is set even if we're using a bounding box for filtering, so
-        // can be used as a test here.
-        if (!m_wkt.empty())
-        {
-            Stage *crop = m_factory.createStage("filters.crop");
-            crop->setOptions(cropOptions);
-            crop->setInput(*premerge);
-            log()->get(LogLevel::Debug3) << "Cropping data with wkt '"
-                                         << m_wkt << "'" << std::endl;
-            premerge = crop;
-        }
-
-        m_merge.setInput(*premerge);
+        m_merge.setInput(*createMember(f));
     }
 
     if (m_sql.size())
@@ -270,21 +245,101 @@ void TIndexReader::initialize()
     m_dataset = 0;
 }
 
+// Create the stages that read a member file, reproject its points to the
+// output SRS and crop them to the query polygon.
+Stage *TIndexReader::createMember(const FileInfo& f)
+{
+    std::string driver = m_factory.inferReaderDriver(f.m_filename);
+    Stage *reader = m_factory.createStage(driver);
+    if (!reader)
+        throwError("Unable to create reader for file '" + f.m_filename +
+            "'.");
+    Options readerOptions;
+    readerOptions.add("filename", f.m_filename);
+    reader->setOptions(readerOptions);
+    Stage *premerge = reader;
+
+    if (m_tgtSrsString != f.m_srs &&
+        (m_tgtSrsString.size() && f.m_srs.size()))
+    {
+        Stage *repro = m_factory.createStage("filters.reprojection");
+        repro->setInput(*reader);
+        Options reproOptions;
+        reproOptions.add("out_srs", m_tgtSrsString);
+        reproOptions.add("in_srs", f.m_srs);
+        log()->get(LogLevel::Debug2) << "Repro = "
+                                     << m_tgtSrsString << "/"
+                                     << f.m_srs << "!\n";
+        repro->setOptions(reproOptions);
+        premerge = repro;
+    }
+
+    // WKT is set even if we're using a bounding box for filtering, so
+    // can be used as a test here.
+    if (!m_wkt.empty())
+    {
+        Stage *crop = m_factory.createStage("filters.crop");
+        Options cropOptions;
+        cropOptions.add("polygon", m_wkt);
+        crop->setOptions(cropOptions);
+        crop->setInput(*premerge);
+        log()->get(LogLevel::Debug3) << "Cropping data with wkt '"
+                                     << m_wkt << "'" << std::endl;
+        premerge = crop;
+    }
+    return premerge;
+}
+
+
 void TIndexReader::prepared(PointTableRef table)
 {
     m_merge.prepare(table);
 }
 
+
 void TIndexReader::ready(PointTableRef table)
 {
-    m_pvSet = m_merge.execute(table);
+    m_queue->stop();
+    m_layout = table.layout();
 }
 
 
-PointViewSet TIndexReader::run(PointViewPtr)
+PointViewSet TIndexReader::run(PointViewPtr view)
 {
-    return m_pvSet;
+    if (m_threads == 1)
+        return m_merge.execute(view->table());
+
+    startLoading();
+    PointRef point(*view, view->size());
+    while (processOne(point))
+        point.setPointId(view->size());
+    m_queue->stop();
+
+    PointViewSet viewSet;
+    viewSet.insert(view);
+    return viewSet;
+}
+
+
+bool TIndexReader::processOne(PointRef& point)
+{
+    if (!m_queue->started())
+        startLoading();
+    return m_queue->copyNext(point);
 }
 
-} // namespace pdal
 
+void TIndexReader::done(PointTableRef table)
+{
+    m_queue->stop();
+}
+
+
+// Read member files on loader threads, in order.
+void TIndexReader::startLoading()
+{
+    m_queue->start(m_files.size(), m_threads,
+        [this](size_t i){ return createMember(m_files[i]); }, m_layout);
+}
+
+} // namespace pdal
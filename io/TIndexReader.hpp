@@ -37,14 +37,16 @@
 #include <pdal/PointView.hpp>
 #include <pdal/Reader.hpp>
 #include <pdal/StageFactory.hpp>
+#include <pdal/Streamable.hpp>
 #include <filters/MergeFilter.hpp>
 
 namespace pdal
 {
 
 namespace gdal { class SpatialRef; }
+class MemberQueue;
 
-class PDAL_DLL TIndexReader : public Reader
+class PDAL_DLL TIndexReader : public Reader, public Streamable
 {
     struct FileInfo
     {
@@ -64,8 +66,8 @@ class PDAL_DLL TIndexReader : public Reader
     };
 
 public:
-    TIndexReader() : m_dataset(NULL) , m_layer(NULL)
-        {}
+    TIndexReader();
+    ~TIndexReader();
 
     std::string getName() const;
 
@@ -76,6 +78,11 @@ private:
     virtual void prepared(PointTableRef table);
     virtual void ready(PointTableRef table);
     virtual PointViewSet run(PointViewPtr view);
+    virtual bool processOne(PointRef& point);
+    virtual void done(PointTableRef table);
+
+    Stage *createMember(const FileInfo& f);
+    void startLoading();
 
     std::string m_layerName;
     std::string m_driverName;
@@ -88,6 +95,7 @@ private:
     std::string m_dialect;
     BOX2D m_bounds;
     std::string m_sql;
+    int m_threads;
 
     std::unique_ptr<gdal::SpatialRef> m_out_ref;
     void *m_dataset;
@@ -95,7 +103,11 @@ private:
 
     StageFactory m_factory;
     MergeFilter m_merge;
-    PointViewSet m_pvSet;
+
+    // Member files read on several threads or in stream mode.
+    std::vector<FileInfo> m_files;
+    std::unique_ptr<MemberQueue> m_queue;
+    PointLayoutPtr m_layout;
 
     std::vector<FileInfo> getFiles();
     FieldIndexes getFields();
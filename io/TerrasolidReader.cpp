@@ -33,6 +33,7 @@
 ****************************************************************************/
 
 #include "TerrasolidReader.hpp"
+#include "private/FixedRecordFile.hpp"
 
 #include <pdal/PointView.hpp>
 #include <pdal/util/Extractor.hpp>
@@ -54,6 +55,16 @@ CREATE_STATIC_STAGE(TerrasolidReader, s_info)
 
 std::string TerrasolidReader::getName() const { return s_info.name; }
 
+
+TerrasolidReader::TerrasolidReader() : pdal::Reader(),
+    m_format(TERRASOLID_Format_Unknown)
+{}
+
+
+TerrasolidReader::~TerrasolidReader()
+{}
+
+
 void TerrasolidReader::initialize()
 {
     ILeStream stream(m_filename);
@@ -133,20 +144,41 @@ void TerrasolidReader::addDimensions(PointLayoutPtr layout)
 
 void TerrasolidReader::ready(PointTableRef)
 {
-    m_istream.reset(new IStream(m_filename));
-    // Skip to the beginning of points.
-    m_istream->seek(56);
+    // Points start after the 56 byte header.
+    try
+    {
+        m_file.reset(new FixedRecordFile(m_filename, 56, m_size));
+    }
+    catch (const pdal_error& err)
+    {
+        throwError(err.what());
+    }
     m_index = 0;
 }
 
 
+void TerrasolidReader::setReturns(PointView& view, PointId id, int echo)
+{
+    switch (echo)
+    {
+    case 0: // only echo
+        view.setField(Dimension::Id::ReturnNumber, id, 1);
+        view.setField(Dimension::Id::NumberOfReturns, id, 1);
+        break;
+    case 1: // first of many echos
+        view.setField(Dimension::Id::ReturnNumber, id, 1);
+        break;
+    default: // intermediate echo or last of many echos
+        break;
+    }
+}
+
+
 point_count_t TerrasolidReader::read(PointViewPtr view, point_count_t count)
 {
-    count = (std::min)(count, getNumPoints() - m_index);
+    const point_count_t BlockSize = 4096;
 
-    std::vector<char> buf(m_size * count);
-    m_istream->get(buf);
-    LeExtractor extractor(buf.data(), buf.size());
+    count = (std::min)(count, getNumPoints() - m_index);
 
     // See https://www.terrasolid.com/download/tscan.pdf
     // This spec is awful, but it's something.
@@ -155,114 +187,122 @@ point_count_t TerrasolidReader::read(PointViewPtr view, point_count_t count)
     // says.
     // Also modified the fetch of time/color based on header flag (rather
     // than just not write the data into the buffer).
+    //
+    // Records are decoded a block at a time into an array for each field.
+    // Format 1 records hold a code, line and echo, then X, Y and Z.
+    // Format 2 records hold X, Y and Z, then code, echo, flag, mark, line
+    // and intensity.  Time and color follow either.
+    std::vector<int32_t> x, y, z;
+    std::vector<uint8_t> classification, echo8, flag, mark, line8;
+    std::vector<uint16_t> echo16, line16, intensity;
+    std::vector<uint32_t> time;
+    std::vector<uint8_t> red, green, blue, alpha;
+    const size_t timeOffset = (m_format == TERRASOLID_Format_1) ? 16 : 20;
+    const size_t colorOffset = timeOffset + (m_haveTime ? 4 : 0);
+
     PointId nextId = view->size();
-    while (!eof())
+    point_count_t numRead = 0;
+    while (numRead < count)
     {
+        point_count_t n = m_file->load(m_index,
+            (std::min)(count - numRead, BlockSize));
+        if (n == 0)
+            throwError("Unexpected end of file.");
+
         if (m_format == TERRASOLID_Format_1)
         {
-            uint8_t classification, flight_line, echo_int, x, y, z;
-
-            extractor >> classification >> flight_line >> echo_int >> x >> y >>
-                z;
-
-            view->setField(Dimension::Id::Classification, nextId,
-                          classification);
-            view->setField(Dimension::Id::PointSourceId, nextId, flight_line);
-            switch (echo_int)
-            {
-            case 0: // only echo
-                view->setField(Dimension::Id::ReturnNumber, nextId, 1);
-                view->setField(Dimension::Id::NumberOfReturns, nextId, 1);
-                break;
-            case 1: // first of many echos
-                view->setField(Dimension::Id::ReturnNumber, nextId, 1);
-                break;
-            default: // intermediate echo or last of many echos
-                break;
-            }
-            view->setField(Dimension::Id::X, nextId,
-                          (x - m_header->OrgX) / m_header->Units);
-            view->setField(Dimension::Id::Y, nextId,
-                          (y - m_header->OrgY) / m_header->Units);
-            view->setField(Dimension::Id::Z, nextId,
-                          (z - m_header->OrgZ) / m_header->Units);
+            m_file->decode(0, classification);
+            m_file->decode(1, line8);
+            m_file->decode(2, echo16);
+            m_file->decode(4, x);
+            m_file->decode(8, y);
+            m_file->decode(12, z);
         }
-
-        if (m_format == TERRASOLID_Format_2)
+        else
         {
-            int32_t x, y, z;
-            uint8_t classification, echo_int, flag, mark;
-            uint16_t flight_line, intensity;
-
-            extractor >> x >> y >> z >> classification >> echo_int >> flag >>
-                mark >> flight_line >> intensity;
+            m_file->decode(0, x);
+            m_file->decode(4, y);
+            m_file->decode(8, z);
+            m_file->decode(12, classification);
+            m_file->decode(13, echo8);
+            m_file->decode(14, flag);
+            m_file->decode(15, mark);
+            m_file->decode(16, line16);
+            m_file->decode(18, intensity);
+        }
+        if (m_haveTime)
+            m_file->decode(timeOffset, time);
+        if (m_haveColor)
+        {
+            m_file->decode(colorOffset, red);
+            m_file->decode(colorOffset + 1, green);
+            m_file->decode(colorOffset + 2, blue);
+            m_file->decode(colorOffset + 3, alpha);
+        }
 
+        for (point_count_t i = 0; i < n; ++i)
+        {
             view->setField(Dimension::Id::X, nextId,
-                          (x - m_header->OrgX) / m_header->Units);
+                          (x[i] - m_header->OrgX) / m_header->Units);
             view->setField(Dimension::Id::Y, nextId,
-                          (y - m_header->OrgY) / m_header->Units);
+                          (y[i] - m_header->OrgY) / m_header->Units);
             view->setField(Dimension::Id::Z, nextId,
-                          (z - m_header->OrgZ) / m_header->Units);
+                          (z[i] - m_header->OrgZ) / m_header->Units);
             view->setField(Dimension::Id::Classification, nextId,
-                          classification);
-            switch (echo_int)
+                          classification[i]);
+            if (m_format == TERRASOLID_Format_1)
             {
-            case 0: // only echo
-                view->setField(Dimension::Id::ReturnNumber, nextId, 1);
-                view->setField(Dimension::Id::NumberOfReturns, nextId, 1);
-                break;
-            case 1: // first of many echos
-                view->setField(Dimension::Id::ReturnNumber, nextId, 1);
-                break;
-            default: // intermediate echo or last of many echos
-                break;
+                view->setField(Dimension::Id::PointSourceId, nextId,
+                    line8[i]);
+                setReturns(*view, nextId, echo16[i]);
+            }
+            else
+            {
+                setReturns(*view, nextId, echo8[i]);
+                view->setField(Dimension::Id::Flag, nextId, flag[i]);
+                view->setField(Dimension::Id::Mark, nextId, mark[i]);
+                view->setField(Dimension::Id::PointSourceId, nextId,
+                    line16[i]);
+                view->setField(Dimension::Id::Intensity, nextId,
+                    intensity[i]);
             }
-            view->setField(Dimension::Id::Flag, nextId, flag);
-            view->setField(Dimension::Id::Mark, nextId, mark);
-            view->setField(Dimension::Id::PointSourceId, nextId, flight_line);
-            view->setField(Dimension::Id::Intensity, nextId, intensity);
-        }
-
-        if (m_haveTime)
-        {
-            uint32_t t;
-
-            extractor >> t;
 
-            if (m_index == 0)
-                m_baseTime = t;
-            t -= m_baseTime; // Offset from the beginning of the read.
-            // instead of GPS week.
-            t /= 5; // 5000ths of a second to milliseconds
-            view->setField(Dimension::Id::OffsetTime, nextId, t);
-        }
+            if (m_haveTime)
+            {
+                uint32_t t = time[i];
+
+                if (m_index == 0)
+                    m_baseTime = t;
+                t -= m_baseTime; // Offset from the beginning of the read.
+                // instead of GPS week.
+                t /= 5; // 5000ths of a second to milliseconds
+                view->setField(Dimension::Id::OffsetTime, nextId, t);
+            }
 
-        if (m_haveColor)
-        {
-            uint8_t red, green, blue, alpha;
+            if (m_haveColor)
+            {
+                view->setField(Dimension::Id::Red, nextId, red[i]);
+                view->setField(Dimension::Id::Green, nextId, green[i]);
+                view->setField(Dimension::Id::Blue, nextId, blue[i]);
+                view->setField(Dimension::Id::Alpha, nextId, alpha[i]);
+            }
 
-            extractor >> red >> green >> blue >> alpha;
+            if (m_cb)
+                m_cb(*view, nextId);
 
-            view->setField(Dimension::Id::Red, nextId, red);
-            view->setField(Dimension::Id::Green, nextId, green);
-            view->setField(Dimension::Id::Blue, nextId, blue);
-            view->setField(Dimension::Id::Alpha, nextId, alpha);
+            nextId++;
+            m_index++;
         }
-
-        if (m_cb)
-            m_cb(*view, nextId);
-
-        nextId++;
-        m_index++;
+        numRead += n;
     }
 
-    return count;
+    return numRead;
 }
 
 
 void TerrasolidReader::done(PointTableRef)
 {
-    m_istream.reset();
+    m_file.reset();
 }
 
 } // namespace pdal
@@ -81,12 +81,13 @@ struct TerraSolidHeader
 
 typedef std::unique_ptr<TerraSolidHeader> TerraSolidHeaderPtr;
 
+class FixedRecordFile;
+
 class PDAL_DLL TerrasolidReader : public pdal::Reader
 {
 public:
-    TerrasolidReader() : pdal::Reader(),
-        m_format(TERRASOLID_Format_Unknown)
-    {}
+    TerrasolidReader();
+    ~TerrasolidReader();
     std::string getName() const;
 
     point_count_t getNumPoints() const
@@ -105,7 +106,7 @@ private:
     bool m_haveColor;
     bool m_haveTime;
     uint32_t m_baseTime;
-    std::unique_ptr<IStream> m_istream;
+    std::unique_ptr<FixedRecordFile> m_file;
     point_count_t m_index;
 
     virtual void initialize();
@@ -113,6 +114,7 @@ private:
     virtual void ready(PointTableRef table);
     virtual point_count_t read(PointViewPtr view, point_count_t count);
     virtual void done(PointTableRef table);
+    void setReturns(PointView& view, PointId id, int echo);
     virtual bool eof()
         { return m_index >= getNumPoints(); }
 
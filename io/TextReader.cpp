@@ -174,6 +174,9 @@ void TextReader::parseUnquotedHeader(const std::string& header)
 
 void TextReader::initialize(PointTableRef table)
 {
+    if (m_threads < 1)
+        throwError("Option 'threads' must be at least 1.");
+
     m_istream = Utils::openFile(m_filename, false);
     if (!m_istream)
         throwError("Unable to open text file '" + m_filename + "'.");
@@ -217,6 +220,8 @@ void TextReader::addArgs(ProgramArgs& args)
     args.add("header", "Use this string as the header line.", m_header);
     args.add("skip", "Skip this number of lines before attempting to "
         "read the header.", m_skip);
+    args.add("threads", "Number of threads used to parse points",
+        m_threads, 1);
 }
 
 
@@ -248,18 +253,55 @@ void TextReader::ready(PointTableRef table)
 }
 
 
+// Text is read in blocks that are split into chunks of whole lines.
+// Each chunk is parsed on its own thread, then the points and errors are
+// added in order, so the result is the same as reading one line at a time.
 point_count_t TextReader::read(PointViewPtr view, point_count_t numPts)
 {
     PointId idx = view->size();
     point_count_t cnt = 0;
     PointRef point(*view, idx);
-    while (cnt < numPts)
+
+    textparse::LineReader lines(*m_istream);
+    textparse::ChunkList chunks((size_t)(std::max)(m_threads, 1));
+    size_t numDims = m_dims.size();
+    while (cnt < numPts && lines.next(chunks))
     {
-        point.setPointId(idx);
-        if (!processOne(point))
-            break;
-        cnt++;
-        idx++;
+        textparse::parseChunks(chunks, numDims, m_separator);
+        for (textparse::Chunk& c : chunks)
+        {
+            // Once the last point has been read, no more lines are read,
+            // so errors in lines after it aren't reported.
+            bool last = (c.m_points >= numPts - cnt);
+            point_count_t count = (std::min)(c.m_points, numPts - cnt);
+            for (const textparse::Chunk::Error& err : c.m_errors)
+            {
+                if (last && err.m_point >= count)
+                    break;
+                if (err.m_fieldCount != numDims)
+                    log()->get(LogLevel::Error) << "Line " <<
+                        (m_line + err.m_line) << " in '" << m_filename <<
+                        "' contains " << err.m_fieldCount << " fields when " <<
+                        numDims << " were expected.  Ignoring." << std::endl;
+                else
+                    log()->get(LogLevel::Error) << "Can't convert "
+                        "field '" << err.m_field << "' to numeric value "
+                        "on line " << (m_line + err.m_line) << " in '" <<
+                        m_filename << "'.  Setting to 0." << std::endl;
+            }
+
+            const double *d = c.m_values.data();
+            for (point_count_t i = 0; i < count; ++i)
+            {
+                point.setPointId(idx++);
+                for (size_t dim = 0; dim < numDims; ++dim)
+                    point.setField(m_dims[dim], *d++);
+            }
+            cnt += count;
+            m_line += c.m_lines;
+            if (cnt == numPts)
+                break;
+        }
     }
     return cnt;
 }
@@ -273,12 +315,13 @@ bool TextReader::processOne(PointRef& point)
     double d;
     for (size_t i = 0; i < m_fields.size(); ++i)
     {
-        if (!Utils::fromString(m_fields[i], d))
+        const textparse::Field& f = m_fields[i];
+        if (!textparse::fieldToDouble(f.m_begin, f.m_end, d))
         {
             log()->get(LogLevel::Error) << "Can't convert "
-                "field '" << m_fields[i] << "' to numeric value on line " <<
-                m_line << " in '" << m_filename << "'.  Setting to 0." <<
-                std::endl;
+                "field '" << textparse::fieldText(f.m_begin, f.m_end) <<
+                "' to numeric value on line " << m_line << " in '" <<
+                m_filename << "'.  Setting to 0." << std::endl;
             d = 0;
         }
         point.setField(m_dims[i], d);
@@ -294,19 +337,12 @@ bool TextReader::fillFields()
         if (!m_istream->good())
             return false;
 
-        std::string buf;
-
-        std::getline(*m_istream, buf);
+        std::getline(*m_istream, m_buf);
         m_line++;
-        if (buf.empty())
+        if (m_buf.empty())
             continue;
-        if (m_separator != ' ')
-        {
-            Utils::remove(buf, ' ');
-            m_fields = Utils::split(buf, m_separator);
-        }
-        else
-            m_fields = Utils::split2(buf, m_separator);
+        textparse::splitFields(m_buf.data(), m_buf.data() + m_buf.size(),
+            m_separator, m_fields);
         if (m_fields.size() != m_dims.size())
         {
             log()->get(LogLevel::Error) << "Line " << m_line <<
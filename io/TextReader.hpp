@@ -35,10 +35,13 @@
 #pragma once
 
 #include <istream>
+#include <vector>
 
 #include <pdal/Reader.hpp>
 #include <pdal/Streamable.hpp>
 
+#include "private/TextParse.hpp"
+
 namespace pdal
 {
 
@@ -111,6 +114,11 @@ private:
     */
     virtual bool processOne(PointRef& point);
 
+    /**
+      Read lines until one with the expected number of fields is found.
+
+      \return  False if no such line could be read.
+    */
     bool fillFields();
 
     /**
@@ -148,10 +156,12 @@ private:
     std::istream *m_istream;
     StringList m_dimNames;
     Dimension::IdList m_dims;
-    StringList m_fields;
+    std::string m_buf;
+    textparse::FieldList m_fields;
     size_t m_line;
     std::string m_header;
     size_t m_skip;
+    int m_threads;
 };
 
 } // namespace pdal
@@ -37,9 +37,20 @@
 #include <pdal/pdal_export.hpp>
 #include <pdal/PDALUtils.hpp>
 #include <pdal/PointView.hpp>
+#include <pdal/private/MultipartOutStream.hpp>
 #include <pdal/util/Algorithm.hpp>
 #include <pdal/util/ProgramArgs.hpp>
-
+#include <pdal/util/TaskScheduler.hpp>
+#include <pdal/pdal_features.hpp>
+#ifdef PDAL_HAVE_ZLIB
+#include <pdal/compression/DeflateCompression.hpp>
+#endif
+#ifdef PDAL_HAVE_ZSTD
+#include <pdal/compression/ZstdCompression.hpp>
+#endif
+
+#include <cmath>
+#include <cstdio>
 #include <iostream>
 
 namespace pdal
@@ -55,6 +66,62 @@ static StaticPluginInfo const s_info
 
 CREATE_STATIC_STAGE(TextWriter, s_info)
 
+namespace
+{
+
+// Formatted text is collected in a buffer of about this size before being
+// handed to the output stream or compressor.
+const size_t BufferSize = 1 << 20;
+
+// Number of points formatted by each thread in a pass when threads > 1.
+const PointId ChunkSize = 1 << 16;
+
+// Append 'v' to 's' as an ostream set to std::fixed with the given
+// precision would write it.
+void appendFixed(std::string& s, double v, size_t precision)
+{
+    // Most dimensions hold integral values, which don't need a general
+    // floating-point conversion.  Negative zero takes the slow path so
+    // that its sign is kept.
+    if (v == std::trunc(v) && std::abs(v) < 1e15 &&
+        !(v == 0 && std::signbit(v)))
+    {
+        char digits[24];
+        char *end = digits + sizeof(digits);
+        char *pos = end;
+        uint64_t u = static_cast<uint64_t>(std::abs(v));
+        do
+        {
+            *--pos = static_cast<char>('0' + u % 10);
+            u /= 10;
+        } while (u);
+        if (v < 0)
+            *--pos = '-';
+        s.append(pos, end);
+        if (precision)
+        {
+            s += '.';
+            s.append(precision, '0');
+        }
+        return;
+    }
+
+    char buf[64];
+    const int prec = static_cast<int>(precision);
+    const int len = std::snprintf(buf, sizeof(buf), "%.*f", prec, v);
+    if (len < static_cast<int>(sizeof(buf)))
+    {
+        s.append(buf, len);
+        return;
+    }
+    size_t start = s.size();
+    s.resize(start + len + 1);
+    std::snprintf(&s[start], len + 1, "%.*f", prec, v);
+    s.resize(start + len);
+}
+
+} // unnamed namespace
+
 std::string TextWriter::getName() const { return s_info.name; }
 
 std::istream& operator >> (std::istream& in, TextWriter::OutputType& type)
@@ -90,7 +157,13 @@ struct FileStreamDeleter
         if (ptr)
         {
             ptr->flush();
-            Utils::closeFile(ptr);
+            // Upload failures are reported by writeFooter().
+            try
+            {
+                Utils::closeFile(ptr);
+            }
+            catch (const pdal_error&)
+            {}
         }
     }
 };
@@ -110,15 +183,49 @@ void TextWriter::addArgs(ProgramArgs& args)
     args.add("quote_header", "Whether a header should be quoted",
         m_quoteHeader, true);
     args.add("precision", "Output precision", m_precision, 3);
+    args.add("compression", "Compress output: 'none', 'gzip' or 'zstd'",
+        m_compression, "none");
+    args.add("threads", "Number of threads used to format points",
+        m_threads, 1);
 }
 
 
 void TextWriter::initialize(PointTableRef table)
 {
+    if (m_threads < 1)
+        throwError("Option 'threads' must be at least 1.");
+
+    m_compression = Utils::tolower(m_compression);
+    if (m_compression != "none" && m_compression != "gzip" &&
+        m_compression != "zstd")
+        throwError("Invalid compression '" + m_compression + "'.  Must be "
+            "'none', 'gzip' or 'zstd'.");
+#ifndef PDAL_HAVE_ZLIB
+    if (m_compression == "gzip")
+        throwError("Can't write gzip output.  PDAL must be configured "
+            "with WITH_ZLIB=On");
+#endif
+#ifndef PDAL_HAVE_ZSTD
+    if (m_compression == "zstd")
+        throwError("Can't write zstd output.  PDAL must be configured "
+            "with WITH_ZSTD=On");
+#endif
+
     m_stream = FileStreamPtr(Utils::createFile(m_filename, true),
         FileStreamDeleter());
     if (!m_stream)
         throwError("Couldn't open '" + m_filename + "' for output.");
+
+    auto cb = [this](char *buf, size_t size)
+        { m_stream->write(buf, size); };
+#ifdef PDAL_HAVE_ZLIB
+    if (m_compression == "gzip")
+        m_compressor.reset(new DeflateCompressor(cb, true));
+#endif
+#ifdef PDAL_HAVE_ZSTD
+    if (m_compression == "zstd")
+        m_compressor.reset(new ZstdCompressor(cb));
+#endif
 }
 
 
@@ -166,9 +273,37 @@ bool TextWriter::findDim(Dimension::Id id, DimSpec& ds)
 }
 
 
+// Only the listed dimensions are needed if we're not writing all of them.
+bool TextWriter::addUsedDims(PointLayoutPtr layout,
+    Dimension::IdList& dims) const
+{
+    if (m_dimOrder.empty() || m_writeAllDims)
+        return false;
+
+    StringList dimNames = Utils::split2(m_dimOrder, ',');
+    for (std::string dim : dimNames)
+    {
+        Utils::trim(dim);
+        StringList s = Utils::split(dim, ':');
+        Dimension::Id id = s.size() ? layout->findDim(s[0]) :
+            Dimension::Id::Unknown;
+        if (id != Dimension::Id::Unknown)
+            dims.push_back(id);
+    }
+    if (m_outputType == OutputType::GEOJSON)
+    {
+        dims.push_back(Dimension::Id::X);
+        dims.push_back(Dimension::Id::Y);
+        dims.push_back(Dimension::Id::Z);
+    }
+    return true;
+}
+
+
 void TextWriter::ready(PointTableRef table)
 {
-    *m_stream << std::fixed;
+    m_buf.clear();
+    m_buf.reserve(BufferSize + BufferSize / 8);
 
     m_xDim = { Dimension::Id::X, static_cast<size_t>(m_precision),
         table.layout()->dimName(Dimension::Id::X) };
@@ -228,10 +363,20 @@ void TextWriter::writeFooter()
 {
     if (m_outputType == OutputType::GEOJSON)
     {
-        *m_stream << "]}";
+        m_buf += "]}";
         if (m_callback.size())
-            *m_stream  <<")";
+            m_buf += ")";
     }
+    flush(true);
+    if (m_compressor)
+        m_compressor->done();
+    m_compressor.reset();
+
+    // Complete a remote upload where failure can be reported.
+    MultipartOutStream *mos =
+        dynamic_cast<MultipartOutStream *>(m_stream.get());
+    if (mos)
+        mos->finish();
     m_stream.reset();
 }
 
@@ -239,9 +384,8 @@ void TextWriter::writeFooter()
 void TextWriter::writeGeoJSONHeader()
 {
     if (m_callback.size())
-        *m_stream << m_callback <<"(";
-    *m_stream << "{ \"type\": \"FeatureCollection\", \"features\": [";
-    *m_stream << ",";
+        m_buf += m_callback + "(";
+    m_buf += "{ \"type\": \"FeatureCollection\", \"features\": [";
 }
 
 
@@ -251,88 +395,147 @@ void TextWriter::writeCSVHeader(PointTableRef table)
     for (auto di = m_dims.begin(); di != m_dims.end(); ++di)
     {
         if (di != m_dims.begin())
-            *m_stream << m_delimiter;
+            m_buf += m_delimiter;
 
         if (m_quoteHeader)
-            *m_stream << "\"" << layout->dimName(di->id) << "\"";
+            m_buf += "\"" + layout->dimName(di->id) + "\"";
         else
-            *m_stream << layout->dimName(di->id);
+            m_buf += layout->dimName(di->id);
     }
-    *m_stream << m_newline;
+    m_buf += m_newline;
 }
 
 
-void TextWriter::processOneCSV(PointRef& point)
+void TextWriter::formatCSV(PointRef& point, std::string& out) const
 {
     for (auto di = m_dims.begin(); di != m_dims.end(); ++di)
     {
         if (di != m_dims.begin())
-            *m_stream << m_delimiter;
-        m_stream->precision(di->precision);
-        *m_stream << point.getFieldAs<double>(di->id);
+            out += m_delimiter;
+        appendFixed(out, point.getFieldAs<double>(di->id), di->precision);
     }
-    *m_stream << m_newline;
+    out += m_newline;
 }
 
-void TextWriter::processOneGeoJSON(PointRef& point)
+
+// The index is the position of the point in the output, which determines
+// whether a separator precedes the feature.
+void TextWriter::formatGeoJSON(PointRef& point, PointId idx,
+    std::string& out) const
 {
-    if (m_idx)
-        *m_stream << ",";
-    *m_stream << "{ \"type\":\"Feature\",\"geometry\": "
+    if (idx)
+        out += ",";
+    out += "{ \"type\":\"Feature\",\"geometry\": "
         "{ \"type\": \"Point\", \"coordinates\": [";
 
-    m_stream->precision(m_xDim.precision);
-    *m_stream << point.getFieldAs<double>(Dimension::Id::X) << ",";
-    m_stream->precision(m_yDim.precision);
-    *m_stream << point.getFieldAs<double>(Dimension::Id::Y) << ",";
-    m_stream->precision(m_zDim.precision);
-    *m_stream << point.getFieldAs<double>(Dimension::Id::Z) << "]},";
+    appendFixed(out, point.getFieldAs<double>(Dimension::Id::X),
+        m_xDim.precision);
+    out += ",";
+    appendFixed(out, point.getFieldAs<double>(Dimension::Id::Y),
+        m_yDim.precision);
+    out += ",";
+    appendFixed(out, point.getFieldAs<double>(Dimension::Id::Z),
+        m_zDim.precision);
+    out += "]},";
 
-    *m_stream << "\"properties\": {";
+    out += "\"properties\": {";
 
     for (auto di = m_dims.begin(); di != m_dims.end(); ++di)
     {
         if (di != m_dims.begin())
-            *m_stream << ",";
+            out += ",";
 
-        *m_stream << "\"" << di->name << "\":";
-        *m_stream << "\"";
-        m_stream->precision(di->precision);
-        *m_stream << point.getFieldAs<double>(di->id);
-        *m_stream <<"\"";
+        out += "\"" + di->name + "\":\"";
+        appendFixed(out, point.getFieldAs<double>(di->id), di->precision);
+        out += "\"";
     }
-    *m_stream << "}"; // end properties
-    *m_stream << "}"; // end feature
+    out += "}"; // end properties
+    out += "}"; // end feature
 }
 
 
-bool TextWriter::processOne(PointRef& point)
+void TextWriter::format(PointRef& point, PointId idx, std::string& out) const
 {
     if (m_outputType == OutputType::CSV)
-        processOneCSV(point);
+        formatCSV(point, out);
+    else
+        formatGeoJSON(point, idx, out);
+}
+
+
+// Write the buffered text once enough has accumulated, or unconditionally
+// if 'force' is set.
+void TextWriter::flush(bool force)
+{
+    if (m_buf.size() < BufferSize && !force)
+        return;
+    output(m_buf);
+    m_buf.clear();
+}
+
+
+void TextWriter::output(const std::string& buf)
+{
+    if (buf.empty())
+        return;
+    if (m_compressor)
+        m_compressor->compress(buf.data(), buf.size());
     else
-        processOneGeoJSON(point);
-    m_idx++;
+        m_stream->write(buf.data(), buf.size());
+}
+
+
+bool TextWriter::processOne(PointRef& point)
+{
+    format(point, m_idx++, m_buf);
+    flush(false);
     return true;
 }
 
 
 void TextWriter::write(const PointViewPtr view)
 {
-    PointRef point(*view, 0);
+    const PointId count = view->size();
 
-    if (m_outputType == OutputType::CSV)
-        for (PointId idx = 0; idx < view->size(); ++idx)
-        {
-            point.setPointId(idx);
-            processOneCSV(point);
-        }
-    else if (m_outputType == OutputType::GEOJSON)
-        for (PointId idx = 0; idx < view->size(); ++idx)
+    if (m_threads == 1)
+    {
+        PointRef point(*view, 0);
+        for (PointId idx = 0; idx < count; ++idx)
         {
             point.setPointId(idx);
-            processOneGeoJSON(point);
+            format(point, m_idx + idx, m_buf);
+            flush(false);
         }
+        m_idx += count;
+        return;
+    }
+
+    // Each thread formats a chunk of consecutive points into its own
+    // buffer.  The buffers are then written in order, so the output is
+    // the same as that of a single thread.
+    flush(true);
+    std::vector<std::string> bufs(m_threads);
+    const PointId passSize = ChunkSize * m_threads;
+    for (PointId passStart = 0; passStart < count; passStart += passSize)
+    {
+        parallelFor(m_threads, m_threads,
+            [this, &view, &bufs, passStart, count](size_t t)
+            {
+                PointId begin = (std::min)(passStart + t * ChunkSize, count);
+                PointId end = (std::min)(begin + ChunkSize, count);
+                std::string& buf = bufs[t];
+                buf.clear();
+                PointRef point(*view, 0);
+                for (PointId idx = begin; idx < end; ++idx)
+                {
+                    point.setPointId(idx);
+                    format(point, m_idx + idx, buf);
+                }
+            });
+        for (const std::string& buf : bufs)
+            output(buf);
+    }
+    m_idx += count;
 }
 
 
@@ -36,6 +36,7 @@
 
 #include <pdal/Streamable.hpp>
 #include <pdal/Writer.hpp>
+#include <pdal/compression/Compression.hpp>
 
 namespace pdal
 {
@@ -71,6 +72,8 @@ private:
     virtual void addArgs(ProgramArgs& args);
     virtual void initialize(PointTableRef table);
     virtual void ready(PointTableRef table);
+    virtual bool addUsedDims(PointLayoutPtr layout,
+        Dimension::IdList& dims) const;
     virtual void write(const PointViewPtr view);
     virtual void done(PointTableRef table);
     virtual bool processOne(PointRef& point);
@@ -79,8 +82,11 @@ private:
     void writeFooter();
     void writeGeoJSONHeader();
     void writeCSVHeader(PointTableRef table);
-    void processOneCSV(PointRef& point);
-    void processOneGeoJSON(PointRef& point);
+    void format(PointRef& point, PointId idx, std::string& out) const;
+    void formatCSV(PointRef& point, std::string& out) const;
+    void formatGeoJSON(PointRef& point, PointId idx, std::string& out) const;
+    void flush(bool force);
+    void output(const std::string& buf);
 
     DimSpec extractDim(std::string dim, PointTableRef table);
     bool findDim(Dimension::Id id, DimSpec& ds);
@@ -96,9 +102,13 @@ private:
     bool m_quoteHeader;
     bool m_packRgb;
     int m_precision;
+    std::string m_compression;
+    int m_threads;
     PointId m_idx;
 
     FileStreamPtr m_stream;
+    std::unique_ptr<Compressor> m_compressor;
+    std::string m_buf;
     std::vector<DimSpec> m_dims;
     DimSpec m_xDim;
     DimSpec m_yDim;
@@ -0,0 +1,89 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+
+#include <pdal/DimType.hpp>
+
+namespace pdal
+{
+
+// Determine whether binary data in the given byte order must have its
+// bytes swapped to be used on this host.
+inline bool needsSwap(bool littleEndian)
+{
+    const uint16_t one = 1;
+    const bool hostLittleEndian =
+        *reinterpret_cast<const unsigned char *>(&one) == 1;
+    return littleEndian != hostLittleEndian;
+}
+
+template<size_t N>
+void swapField(char *p, size_t count, size_t stride)
+{
+    for (size_t i = 0; i < count; ++i, p += stride)
+        std::reverse(p, p + N);
+}
+
+// Reverse the byte order of every field of 'count' packed records laid out
+// as described by 'dims'.  Each field is handled across all the records at
+// once so that the loops can be unrolled and vectorized.
+inline void swapRecords(char *buf, size_t count, const DimTypeList& dims)
+{
+    size_t stride = 0;
+    for (const DimType& dim : dims)
+        stride += Dimension::size(dim.m_type);
+
+    for (const DimType& dim : dims)
+    {
+        switch (Dimension::size(dim.m_type))
+        {
+        case 2:
+            swapField<2>(buf, count, stride);
+            break;
+        case 4:
+            swapField<4>(buf, count, stride);
+            break;
+        case 8:
+            swapField<8>(buf, count, stride);
+            break;
+        }
+        buf += Dimension::size(dim.m_type);
+    }
+}
+
+} // namespace pdal
@@ -108,66 +108,15 @@ EptInfo::EptInfo(const NL::json& info) : m_info(info)
         m_dataType = DataType::Binary;
     else if (dt == "zstandard")
         m_dataType = DataType::Zstandard;
+    else if (dt == "delta")
+        m_dataType = DataType::Delta;
+    else if (dt == "lz4")
+        m_dataType = DataType::Lz4;
     else
         throw ept_error("Unrecognized EPT dataType: " + dt);
 }
 
 
-void Pool::work()
-{
-    while (true)
-    {
-        std::unique_lock<std::mutex> lock(m_mutex);
-        m_consumeCv.wait(lock, [this]()
-        {
-            return m_tasks.size() || !m_running;
-        });
-
-        if (m_tasks.size())
-        {
-            ++m_outstanding;
-            auto task(std::move(m_tasks.front()));
-            m_tasks.pop();
-
-            lock.unlock();
-
-            // Notify add(), which may be waiting for a spot in the queue.
-            m_produceCv.notify_all();
-
-            std::string err;
-            try
-            {
-                task();
-            }
-            catch (std::exception& e)
-            {
-                err = e.what();
-            }
-            catch (...)
-            {
-                err = "Unknown error";
-            }
-
-            lock.lock();
-            --m_outstanding;
-            if (err.size())
-            {
-                if (m_verbose)
-                    std::cout << "Exception in pool task: " << err << std::endl;
-                m_errors.push_back(err);
-            }
-            lock.unlock();
-
-            // Notify await(), which may be waiting for a running task.
-            m_produceCv.notify_all();
-        }
-        else if (!m_running)
-        {
-            return;
-        }
-    }
-}
-
 void FixedPointLayout::registerFixedDim(const Dimension::Id id,
     const Dimension::Type type)
 {
@@ -34,10 +34,6 @@
 
 #pragma once
 
-#include <condition_variable>
-
-#include <queue>
-#include <thread>
 #include <vector>
 
 #include <nlohmann/json.hpp>
@@ -189,41 +185,6 @@ inline bool operator<(const Key& a, const Key& b)
 
 using EptHierarchy = std::map<Key, uint64_t>;
 
-class PDAL_DLL Addon
-{
-public:
-    Addon(const PointLayout& layout, const arbiter::Endpoint& ep,
-            Dimension::Id id)
-        : m_ep(ep)
-        , m_id(id)
-        , m_type(layout.dimType(m_id))
-        , m_size(layout.dimSize(m_id))
-        , m_name(layout.dimName(m_id))
-    { }
-
-    const arbiter::Endpoint& ep() const { return m_ep; }
-    Dimension::Id id() const { return m_id; }
-    Dimension::Type type() const { return m_type; }
-    uint64_t size() const { return m_size; }
-    const std::string& name() const { return m_name; }
-
-    EptHierarchy& hierarchy() { return m_hierarchy; }
-    uint64_t points(const Key& key) const
-    {
-        return m_hierarchy.count(key) ? m_hierarchy.at(key) : 0;
-    }
-
-private:
-    const arbiter::Endpoint m_ep;
-
-    const Dimension::Id m_id = Dimension::Id::Unknown;
-    const Dimension::Type m_type = Dimension::Type::None;
-    const uint64_t m_size = 0;
-    const std::string m_name;
-
-    EptHierarchy m_hierarchy;
-};
-
 class PDAL_DLL EptInfo
 {
 public:
@@ -231,7 +192,9 @@ public:
     {
         Laszip,
         Binary,
-        Zstandard
+        Zstandard,
+        Delta,
+        Lz4
     };
 
     EptInfo(const NL::json& info);
@@ -279,6 +242,57 @@ private:
 };
 
 
+class PDAL_DLL Addon
+{
+public:
+    Addon(const PointLayout& layout, const arbiter::Endpoint& ep,
+            Dimension::Id id,
+            EptInfo::DataType dataType = EptInfo::DataType::Binary)
+        : m_ep(ep)
+        , m_id(id)
+        , m_type(layout.dimType(m_id))
+        , m_size(layout.dimSize(m_id))
+        , m_name(layout.dimName(m_id))
+        , m_dataType(dataType)
+    { }
+
+    const arbiter::Endpoint& ep() const { return m_ep; }
+    Dimension::Id id() const { return m_id; }
+    Dimension::Type type() const { return m_type; }
+    uint64_t size() const { return m_size; }
+    const std::string& name() const { return m_name; }
+    EptInfo::DataType dataType() const { return m_dataType; }
+
+    // Name of the file holding the addon data of a node.
+    std::string dataFile(const Key& key) const
+    {
+        const char *ext = ".bin";
+        if (m_dataType == EptInfo::DataType::Zstandard)
+            ext = ".zst";
+        else if (m_dataType == EptInfo::DataType::Lz4)
+            ext = ".lz4";
+        return "ept-data/" + key.toString() + ext;
+    }
+
+    EptHierarchy& hierarchy() { return m_hierarchy; }
+    uint64_t points(const Key& key) const
+    {
+        return m_hierarchy.count(key) ? m_hierarchy.at(key) : 0;
+    }
+
+private:
+    const arbiter::Endpoint m_ep;
+
+    const Dimension::Id m_id = Dimension::Id::Unknown;
+    const Dimension::Type m_type = Dimension::Type::None;
+    const uint64_t m_size = 0;
+    const std::string m_name;
+    const EptInfo::DataType m_dataType = EptInfo::DataType::Binary;
+
+    EptHierarchy m_hierarchy;
+};
+
+
 class FixedPointLayout : public PointLayout
 {
     // The default PointLayout class may reorder dimension entries for packing
@@ -401,129 +415,5 @@ protected:
     std::size_t m_size;
 };
 
-class PDAL_DLL Pool
-{
-public:
-    // After numThreads tasks are actively running, and queueSize tasks have
-    // been enqueued to wait for an available worker thread, subsequent calls
-    // to Pool::add will block until an enqueued task has been popped from the
-    // queue.
-    Pool(
-            std::size_t numThreads,
-            std::size_t queueSize = 1,
-            bool verbose = true)
-        : m_verbose(verbose)
-        , m_numThreads(std::max<std::size_t>(numThreads, 1))
-        , m_queueSize(std::max<std::size_t>(queueSize, 1))
-    {
-        go();
-    }
-
-    ~Pool() { join(); }
-
-    // Start worker threads.
-    void go()
-    {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        if (m_running) return;
-        m_running = true;
-
-        for (std::size_t i(0); i < m_numThreads; ++i)
-        {
-            m_threads.emplace_back([this]() { work(); });
-        }
-    }
-
-    // Disallow the addition of new tasks and wait for all currently running
-    // tasks to complete.
-    void join()
-    {
-        std::unique_lock<std::mutex> lock(m_mutex);
-        if (!m_running) return;
-        m_running = false;
-        lock.unlock();
-
-        m_consumeCv.notify_all();
-        for (auto& t : m_threads) t.join();
-        m_threads.clear();
-    }
-
-    // Wait for all current tasks to complete.  As opposed to join, tasks may
-    // continue to be added while a thread is await()-ing the queue to empty.
-    void await()
-    {
-        std::unique_lock<std::mutex> lock(m_mutex);
-        m_produceCv.wait(lock, [this]()
-        {
-            return !m_outstanding && m_tasks.empty();
-        });
-    }
-
-    // Join and restart.
-    void cycle() { join(); go(); }
-
-    // Change the number of threads.  Current threads will be joined.
-    void resize(const std::size_t numThreads)
-    {
-        join();
-        m_numThreads = numThreads;
-        go();
-    }
-
-    // Not thread-safe, pool should be joined before calling.
-    const std::vector<std::string>& errors() const { return m_errors; }
-
-    // Add a threaded task, blocking until a thread is available.  If join() is
-    // called, add() may not be called again until go() is called and completes.
-    void add(std::function<void()> task)
-    {
-        std::unique_lock<std::mutex> lock(m_mutex);
-        if (!m_running)
-        {
-            throw ept_error("Attempted to add a task to a stopped Pool");
-        }
-
-        m_produceCv.wait(lock, [this]()
-        {
-            return m_tasks.size() < m_queueSize;
-        });
-
-        m_tasks.emplace(task);
-
-        // Notify worker that a task is available.
-        lock.unlock();
-        m_consumeCv.notify_all();
-    }
-
-
-    std::size_t size() const { return m_numThreads; }
-    std::size_t numThreads() const { return m_numThreads; }
-
-private:
-    // Worker thread function.  Wait for a task and run it - or if stop() is
-    // called, complete any outstanding task and return.
-    void work();
-
-    bool m_verbose;
-    std::size_t m_numThreads;
-    std::size_t m_queueSize;
-    std::vector<std::thread> m_threads;
-    std::queue<std::function<void()>> m_tasks;
-
-    std::vector<std::string> m_errors;
-    std::mutex m_errorMutex;
-
-    std::size_t m_outstanding = 0;
-    bool m_running = false;
-
-    mutable std::mutex m_mutex;
-    std::condition_variable m_produceCv;
-    std::condition_variable m_consumeCv;
-
-    // Disable copy/assignment.
-    Pool(const Pool& other);
-    Pool& operator=(const Pool& other);
-};
-
 } // namespace pdal
 
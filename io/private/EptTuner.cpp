@@ -0,0 +1,189 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include "EptTuner.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include <pdal/Trace.hpp>
+
+namespace pdal
+{
+
+namespace
+{
+
+// Weight of the most recent node in the moving averages.
+const double alpha = 0.2;
+
+} // unnamed namespace
+
+
+EptNodeTimer::EptNodeTimer(EptTuner& tuner, uint64_t bytes) : m_tuner(tuner),
+    m_bytes(bytes), m_start(Clock::now()), m_fetch(Clock::duration::zero()),
+    m_decoding(false)
+{}
+
+
+EptNodeTimer::~EptNodeTimer()
+{
+    using Seconds = std::chrono::duration<double>;
+
+    const Clock::time_point end = Clock::now();
+    if (Trace::enabled())
+    {
+        if (m_decoding)
+            Trace::record("ept", "decode", m_decodeStart, end);
+        Trace::record("ept", "node", m_start, end);
+    }
+
+    const Clock::duration total = end - m_start;
+    const double fetch = std::chrono::duration_cast<Seconds>(m_fetch).count();
+    const double decode =
+        std::chrono::duration_cast<Seconds>(total - m_fetch).count();
+    m_tuner.record(fetch, decode, m_bytes);
+}
+
+
+void EptNodeTimer::fetchStart()
+{
+    m_fetchStart = Clock::now();
+    if (m_decoding && Trace::enabled())
+        Trace::record("ept", "decode", m_decodeStart, m_fetchStart);
+    m_decoding = false;
+}
+
+
+void EptNodeTimer::fetchEnd()
+{
+    m_decodeStart = Clock::now();
+    m_decoding = true;
+    m_fetch += m_decodeStart - m_fetchStart;
+    if (Trace::enabled())
+        Trace::record("ept", "fetch", m_fetchStart, m_decodeStart);
+}
+
+
+EptTuner::EptTuner(size_t initial, size_t maximum, uint64_t budget,
+        size_t cores) :
+    m_maximum((std::max)(maximum, (size_t)1)), m_budget(budget),
+    m_cores((std::max)(cores, (size_t)1)),
+    m_window((std::min)((std::max)(initial, (size_t)1), m_maximum)),
+    m_readAhead(m_window), m_peak(m_window), m_inFlight(0), m_nodes(0),
+    m_fetchTotal(0), m_decodeTotal(0), m_fetch(0), m_decode(0), m_bytes(0)
+{}
+
+
+void EptTuner::acquire()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cv.wait(lock, [this](){ return m_inFlight < m_window; });
+    m_inFlight++;
+}
+
+
+size_t EptTuner::window() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_window;
+}
+
+
+size_t EptTuner::readAhead() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_readAhead;
+}
+
+
+void EptTuner::record(double fetch, double decode, uint64_t bytes)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    if (m_inFlight)
+        m_inFlight--;
+
+    m_fetchTotal += fetch;
+    m_decodeTotal += decode;
+    if (m_nodes++ == 0)
+    {
+        m_fetch = fetch;
+        m_decode = decode;
+        m_bytes = (double)bytes;
+    }
+    else
+    {
+        m_fetch = alpha * fetch + (1 - alpha) * m_fetch;
+        m_decode = alpha * decode + (1 - alpha) * m_decode;
+        m_bytes = alpha * bytes + (1 - alpha) * m_bytes;
+    }
+
+    // Each node spends m_fetch waiting and m_decode working.  To keep every
+    // core decoding, (m_fetch + m_decode) / m_decode nodes per core need to
+    // be in flight.
+    const double decodeTime = (std::max)(m_decode, 1e-6);
+    const double ideal = std::ceil(m_cores * (m_fetch + decodeTime) /
+        decodeTime);
+    m_window = (size_t)(std::min)(ideal, (double)m_maximum);
+    m_window = (std::max)(m_window, (size_t)1);
+
+    // Buffered nodes must fit in the memory budget.
+    size_t fits = m_maximum;
+    if (m_bytes >= 1)
+        fits = (size_t)(std::min)(m_budget / m_bytes, (double)m_maximum);
+    m_readAhead = (std::max)((std::min)(m_window, fits), (size_t)1);
+
+    m_peak = (std::max)(m_peak, m_window);
+    lock.unlock();
+    m_cv.notify_all();
+}
+
+
+void EptTuner::dump(MetadataNode m) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m.add("nodes", m_nodes);
+    if (m_nodes)
+    {
+        m.add("mean_fetch_ms", m_fetchTotal * 1000 / m_nodes);
+        m.add("mean_decode_ms", m_decodeTotal * 1000 / m_nodes);
+    }
+    m.add("concurrency", m_window);
+    m.add("peak_concurrency", m_peak);
+    m.add("max_concurrency", m_maximum);
+    m.add("read_ahead", m_readAhead);
+}
+
+} // namespace pdal
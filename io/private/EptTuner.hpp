@@ -0,0 +1,117 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+#include <pdal/Metadata.hpp>
+#include <pdal/pdal_internal.hpp>
+
+namespace pdal
+{
+
+// Chooses the number of EPT nodes to fetch concurrently, and in streaming
+// mode the number of nodes to read ahead, from the observed time to fetch
+// and decode nodes.  When fetching dominates, more nodes are kept in flight
+// so that decoding doesn't wait on the network.  When decoding dominates,
+// fewer are used.  Read-ahead is further limited so that buffered nodes fit
+// in a memory budget.
+class PDAL_DLL EptTuner
+{
+    friend class EptNodeTimer;
+
+public:
+    EptTuner(size_t initial, size_t maximum, uint64_t budget, size_t cores);
+
+    // Block until fewer than window() nodes are in flight, then take a slot.
+    void acquire();
+    // Number of nodes to fetch concurrently.
+    size_t window() const;
+    // Number of nodes to buffer ahead of the consumer in streaming mode.
+    size_t readAhead() const;
+    void dump(MetadataNode m) const;
+
+private:
+    void record(double fetch, double decode, uint64_t bytes);
+
+    const size_t m_maximum;
+    const uint64_t m_budget;
+    const size_t m_cores;
+
+    size_t m_window;
+    size_t m_readAhead;
+    size_t m_peak;
+    size_t m_inFlight;
+
+    uint64_t m_nodes;
+    double m_fetchTotal;
+    double m_decodeTotal;
+    // Moving averages of per-node values.
+    double m_fetch;
+    double m_decode;
+    double m_bytes;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+};
+
+// Times the fetch and decode of a single node and records the result with
+// the tuner when destroyed.  The node's slot, taken with
+// EptTuner::acquire(), is released at the same time.  When tracing is on,
+// the node and its fetches and decodes are recorded as trace events.
+class PDAL_DLL EptNodeTimer
+{
+public:
+    EptNodeTimer(EptTuner& tuner, uint64_t bytes);
+    ~EptNodeTimer();
+
+    void fetchStart();
+    void fetchEnd();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    EptTuner& m_tuner;
+    uint64_t m_bytes;
+    Clock::time_point m_start;
+    Clock::time_point m_fetchStart;
+    Clock::time_point m_decodeStart;
+    Clock::duration m_fetch;
+    bool m_decoding;
+};
+
+} // namespace pdal
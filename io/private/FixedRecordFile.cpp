@@ -0,0 +1,101 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <istream>
+
+#include <pdal/util/portable_endian.hpp>
+
+#include "FixedRecordFile.hpp"
+
+namespace pdal
+{
+
+FixedRecordFile::FixedRecordFile(const std::string& filename,
+        uint64_t offset, size_t recordSize, bool bigEndian) :
+    m_filename(filename), m_offset(offset), m_recordSize(recordSize),
+    m_numRecords(0), m_stream(nullptr), m_records(nullptr), m_count(0)
+{
+    const bool littleHost = (htole16(1) == 1);
+    m_swap = (bigEndian == littleHost);
+
+    if (!FileUtils::fileExists(m_filename))
+        throw pdal_error("Unable to open file '" + m_filename + "'.");
+    uintmax_t size = FileUtils::fileSize(m_filename);
+    if (size > m_offset && m_recordSize)
+        m_numRecords = (size - m_offset) / m_recordSize;
+    if (m_numRecords == 0)
+        return;
+
+    // Fall back to reading the records if they can't be mapped.
+    m_map = FileUtils::mapFile(m_filename, true, m_offset,
+        m_numRecords * m_recordSize);
+    if (!m_map.addr())
+    {
+        m_stream = FileUtils::openFile(m_filename);
+        if (!m_stream)
+            throw pdal_error("Unable to open file '" + m_filename + "'.");
+    }
+}
+
+
+FixedRecordFile::~FixedRecordFile()
+{
+    if (m_map.addr())
+        FileUtils::unmapFile(m_map);
+    if (m_stream)
+        FileUtils::closeFile(m_stream);
+}
+
+
+point_count_t FixedRecordFile::load(point_count_t first, point_count_t count)
+{
+    m_count = (std::min)(count, m_numRecords - (std::min)(first, m_numRecords));
+    if (m_map.addr())
+    {
+        m_records = static_cast<const char *>(m_map.addr()) +
+            first * m_recordSize;
+        return m_count;
+    }
+
+    m_buf.resize(m_count * m_recordSize);
+    m_stream->clear();
+    m_stream->seekg(m_offset + first * m_recordSize);
+    m_stream->read(m_buf.data(), m_buf.size());
+    if (!m_stream->good() && m_count)
+        throw pdal_error("Error reading records from '" + m_filename + "'.");
+    m_records = m_buf.data();
+    return m_count;
+}
+
+} // namespace pdal
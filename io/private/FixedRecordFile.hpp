@@ -0,0 +1,115 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <pdal/pdal_types.hpp>
+#include <pdal/util/FileUtils.hpp>
+
+namespace pdal
+{
+
+// Reads the fixed-size records of a binary file.  The records are mapped
+// into memory when possible and read from a stream otherwise.  A block of
+// records is loaded and then each field is decoded for all records of the
+// block in a single loop, swapping bytes if the file's byte order differs
+// from the machine's.  Errors are reported by throwing pdal_error.
+class FixedRecordFile
+{
+public:
+    // Open the records of 'filename' that start at 'offset'.  Trailing
+    // bytes that don't make a complete record are ignored.
+    FixedRecordFile(const std::string& filename, uint64_t offset,
+        size_t recordSize, bool bigEndian = false);
+    ~FixedRecordFile();
+
+    point_count_t numRecords() const
+        { return m_numRecords; }
+    bool mapped() const
+        { return m_map.addr() != nullptr; }
+
+    // Load records for decoding.
+    // \param first  Index of the first record to load.
+    // \param count  Number of records to load.
+    // \return  Number of records loaded, which is less than 'count' at the
+    //   end of the file.
+    point_count_t load(point_count_t first, point_count_t count);
+
+    // Decode a field of each loaded record.
+    // \param offset  Offset of the field in the record.
+    // \param out  Location of the value for the first loaded record.
+    // \param stride  Distance in bytes between the locations of values of
+    //   consecutive records, which allows decoding into an array of structs.
+    template<typename T>
+    void decode(size_t offset, T *out, size_t stride = sizeof(T)) const
+    {
+        const char *pos = m_records + offset;
+        char *dst = reinterpret_cast<char *>(out);
+        for (point_count_t i = 0; i < m_count; ++i)
+        {
+            std::memcpy(dst, pos, sizeof(T));
+            if (m_swap)
+                std::reverse(dst, dst + sizeof(T));
+            pos += m_recordSize;
+            dst += stride;
+        }
+    }
+
+    // Decode a field of each loaded record.
+    template<typename T>
+    void decode(size_t offset, std::vector<T>& out) const
+    {
+        out.resize(m_count);
+        decode(offset, out.data());
+    }
+
+private:
+    std::string m_filename;
+    uint64_t m_offset;
+    size_t m_recordSize;
+    bool m_swap;
+    point_count_t m_numRecords;
+    FileUtils::MapContext m_map;
+    std::istream *m_stream;
+    std::vector<char> m_buf;
+    const char *m_records;
+    point_count_t m_count;
+};
+
+} // namespace pdal
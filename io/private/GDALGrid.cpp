@@ -36,13 +36,40 @@
 
 #include <algorithm>
 #include <cmath>
+#include <functional>
 #include <limits>
 #include <iostream>
 #include <pdal/pdal_types.hpp>
+#include <pdal/util/TaskScheduler.hpp>
 
 namespace pdal
 {
 
+namespace
+{
+
+// Split rows \c begin through \c end - 1 into ranges and call \c f for
+// each range, on the task scheduler.
+void forRows(size_t begin, size_t end, int threads,
+    std::function<void(size_t, size_t)> f)
+{
+    size_t count = end - begin;
+    size_t numThreads = (std::min)((size_t)(std::max)(threads, 1), count);
+    if (numThreads <= 1)
+    {
+        f(begin, end);
+        return;
+    }
+
+    parallelFor(numThreads, numThreads, [&f, begin, count, numThreads](size_t t)
+        {
+            f(begin + (t * count / numThreads),
+                begin + ((t + 1) * count / numThreads));
+        });
+}
+
+} // unnamed namespace
+
 //ABELL - In the beginning this data needed to be contiguous, as it was passed
 //  directly to GDAL to write.  Since we started supporting various data types
 //  in GDAL output, we end up copying/casting data to a block for output,
@@ -53,7 +80,16 @@ namespace pdal
 
 GDALGrid::GDALGrid(size_t width, size_t height, double edgeLength,
         double radius, int outputTypes, size_t windowSize, double power) :
-    m_width(width), m_height(height), m_windowSize(windowSize),
+    GDALGrid(width, height, edgeLength, radius, outputTypes, windowSize,
+        power, 0, height)
+{}
+
+
+GDALGrid::GDALGrid(size_t width, size_t height, double edgeLength,
+        double radius, int outputTypes, size_t windowSize, double power,
+        size_t firstRow, size_t numRows) :
+    m_width(width), m_height(height), m_firstRow(firstRow),
+    m_numRows(numRows), m_windowSize(windowSize),
     m_edgeLength(edgeLength), m_radius(radius), m_power(power), m_outputTypes(outputTypes)
 {
     if (width > (size_t)(std::numeric_limits<int>::max)() ||
@@ -65,7 +101,21 @@ GDALGrid::GDALGrid(size_t width, size_t height, double edgeLength,
             "Try setting bounds or increasing resolution.";
         throw error(oss.str());
     }
-    size_t size(width * height);
+    setRows(firstRow, numRows);
+}
+
+
+void GDALGrid::setRows(size_t firstRow, size_t numRows)
+{
+    m_firstRow = (std::min)(firstRow, m_height);
+    m_numRows = (std::min)(numRows, m_height - m_firstRow);
+    allocate();
+}
+
+
+void GDALGrid::allocate()
+{
+    size_t size(m_width * m_numRows);
 
     m_count.reset(new DataVec(size));
     if (m_outputTypes & statMin)
@@ -100,6 +150,8 @@ void GDALGrid::expand(size_t width, size_t height, size_t xshift, size_t yshift)
     if (m_width + xshift > width || m_height + yshift > height)
         throw error("Can't shift existing grid outside of new grid "
             "during expansion.");
+    if (m_firstRow != 0 || m_numRows != m_height)
+        throw error("Can't expand a grid that holds only some rows.");
     if (width == m_width && height == m_height)
         return;
 
@@ -141,6 +193,7 @@ void GDALGrid::expand(size_t width, size_t height, size_t xshift, size_t yshift)
         moveVec(m_stdDev, 0);
     m_width = width;
     m_height = height;
+    m_numRows = height;
 }
 
 
@@ -212,10 +265,16 @@ void GDALGrid::addPoint(double x, double y, double z)
     //       <--- | v
     //         <- v
 
-    updateFirstQuadrant(x, y, z);
-    updateSecondQuadrant(x, y, z);
-    updateThirdQuadrant(x, y, z);
-    updateFourthQuadrant(x, y, z);
+    addPoint(x, y, z, (int)m_firstRow, (int)(m_firstRow + m_numRows));
+}
+
+
+void GDALGrid::addPoint(double x, double y, double z, int jLow, int jHigh)
+{
+    updateFirstQuadrant(x, y, z, jLow, jHigh);
+    updateSecondQuadrant(x, y, z, jLow, jHigh);
+    updateThirdQuadrant(x, y, z, jLow, jHigh);
+    updateFourthQuadrant(x, y, z, jLow, jHigh);
 
     int iOrigin = horizontalIndex(x);
     int jOrigin = verticalIndex(y);
@@ -224,13 +283,39 @@ void GDALGrid::addPoint(double x, double y, double z)
     // it just be counted?
     double d = distance(iOrigin, jOrigin, x, y);
     if (d < m_radius &&
-        iOrigin >= 0 && jOrigin >= 0 &&
-        iOrigin < (int)m_width && jOrigin < (int)m_height)
+        iOrigin >= 0 && jOrigin >= jLow &&
+        iOrigin < (int)m_width && jOrigin < jHigh)
         update(iOrigin, jOrigin, z, d);
 }
 
 
-void GDALGrid::updateFirstQuadrant(double x, double y, double z)
+void GDALGrid::addPoints(const std::vector<double>& x,
+    const std::vector<double>& y, const std::vector<double>& z, int threads)
+{
+    // A point can only reach cells this many rows from its own row.  The
+    // extra rows cover the rounding in verticalIndex().
+    double reach = std::ceil(m_radius / m_edgeLength) + 2;
+
+    // Each thread visits every point, but only updates cells in its own
+    // rows.  A cell is only ever updated by one thread and it sees the
+    // points in order, so the results are the same as adding the points
+    // one at a time.
+    forRows(m_firstRow, m_firstRow + m_numRows, threads,
+        [&](size_t jLow, size_t jHigh)
+    {
+        for (size_t i = 0; i < x.size(); ++i)
+        {
+            double row = m_height - (y[i] / m_edgeLength) - 1;
+            if (row + reach < jLow || row - reach >= jHigh)
+                continue;
+            addPoint(x[i], y[i], z[i], (int)jLow, (int)jHigh);
+        }
+    });
+}
+
+
+void GDALGrid::updateFirstQuadrant(double x, double y, double z,
+    int jLow, int jHigh)
 {
     int i, j;
     int iStart;
@@ -238,12 +323,12 @@ void GDALGrid::updateFirstQuadrant(double x, double y, double z)
     int jOrigin = verticalIndex(y);
 
     i = iStart = (std::max)(0, iOrigin + 1);
-    j = (std::min)(jOrigin, int(m_height - 1));
+    j = (std::min)(jOrigin, jHigh - 1);
 
     if (iStart >= (int)m_width)
         return;
 
-    while (j >= 0)
+    while (j >= jLow)
     {
         double d = distance(i, j, x, y);
         if (d < m_radius)
@@ -264,7 +349,8 @@ void GDALGrid::updateFirstQuadrant(double x, double y, double z)
 }
 
 
-void GDALGrid::updateSecondQuadrant(double x, double y, double z)
+void GDALGrid::updateSecondQuadrant(double x, double y, double z,
+    int jLow, int jHigh)
 {
     int i, j;
     int jStart;
@@ -272,9 +358,9 @@ void GDALGrid::updateSecondQuadrant(double x, double y, double z)
     int jOrigin = verticalIndex(y);
 
     i = (std::min)(iOrigin, int(m_width - 1));
-    j = jStart = (std::min)(jOrigin - 1, int(m_height - 1));
+    j = jStart = (std::min)(jOrigin - 1, jHigh - 1);
 
-    if (jStart < 0)
+    if (jStart < jLow)
         return;
 
     while (i >= 0)
@@ -284,11 +370,11 @@ void GDALGrid::updateSecondQuadrant(double x, double y, double z)
         {
             update(i, j, z, d);
             j--;
-            if (j >= 0)
+            if (j >= jLow)
                 continue;
         }
 
-        // Either d >= m_radius or we've hit the end of a column (j < 0),
+        // Either d >= m_radius or we've hit the end of a column (j < jLow),
         // so move to the next column.
         if (j == jStart)
             break;
@@ -298,7 +384,8 @@ void GDALGrid::updateSecondQuadrant(double x, double y, double z)
 }
 
 
-void GDALGrid::updateThirdQuadrant(double x, double y, double z)
+void GDALGrid::updateThirdQuadrant(double x, double y, double z,
+    int jLow, int jHigh)
 {
     int i, j;
     int iStart;
@@ -306,12 +393,12 @@ void GDALGrid::updateThirdQuadrant(double x, double y, double z)
     int jOrigin = verticalIndex(y);
 
     i = iStart = (std::min)(iOrigin - 1, int(m_width - 1));
-    j = (std::max)(jOrigin, 0);
+    j = (std::max)(jOrigin, jLow);
 
     if (iStart < 0)
         return;
 
-    while (j < (int)m_height)
+    while (j < jHigh)
     {
         double d = distance(i, j, x, y);
         if (d < m_radius)
@@ -332,7 +419,8 @@ void GDALGrid::updateThirdQuadrant(double x, double y, double z)
 }
 
 
-void GDALGrid::updateFourthQuadrant(double x, double y, double z)
+void GDALGrid::updateFourthQuadrant(double x, double y, double z,
+    int jLow, int jHigh)
 {
 
     int i, j;
@@ -341,9 +429,9 @@ void GDALGrid::updateFourthQuadrant(double x, double y, double z)
     int jOrigin = verticalIndex(y);
 
     i = (std::max)(iOrigin, 0);
-    j = jStart = (std::max)(jOrigin + 1, 0);
+    j = jStart = (std::max)(jOrigin + 1, jLow);
 
-    if (jStart >= (int)m_height)
+    if (jStart >= jHigh)
         return;
 
     while (i < (int)m_width)
@@ -353,12 +441,12 @@ void GDALGrid::updateFourthQuadrant(double x, double y, double z)
         {
             update(i, j, z, d);
             j++;
-            if (j < (int)m_height)
+            if (j < jHigh)
                 continue;
         }
 
 
-        // Either d >= m_radius or we've hit the end of a column (j == m_height)
+        // Either d >= m_radius or we've hit the end of a column (j == jHigh)
         // so move to the next row.
         if (j == jStart)
             break;
@@ -433,29 +521,157 @@ void GDALGrid::update(size_t i, size_t j, double val, double dist)
     }
 }
 
-void GDALGrid::finalize()
+void GDALGrid::finalize(int threads)
+{
+    // Window filling reads finished values from neighboring rows, so
+    // all rows must be finished before any are filled.
+    size_t end = m_firstRow + m_numRows;
+    forRows(m_firstRow, end, threads, [this](size_t jBegin, size_t jEnd)
+        { finalizeRows(jBegin, jEnd); });
+    forRows(m_firstRow, end, threads, [this](size_t jBegin, size_t jEnd)
+        { fillRows(jBegin, jEnd); });
+}
+
+
+void GDALGrid::overview(const std::string& name, size_t factor,
+    std::vector<double>& out, int threads) const
+{
+    const DataVec *src = nullptr;
+    if (name == "min")
+        src = m_min.get();
+    else if (name == "max")
+        src = m_max.get();
+    else if (name == "mean")
+        src = m_mean.get();
+    else if (name == "idw")
+        src = m_idw.get();
+    else if (name == "stdev")
+        src = m_stdDev.get();
+    else if (name == "count")
+        src = m_count.get();
+    if (!src || m_numRows != m_height)
+        throw error("Can't compute overview of band '" + name + "'.");
+
+    // Overviews are sized the way GDAL sizes them.
+    size_t width = (m_width + factor - 1) / factor;
+    size_t height = (m_height + factor - 1) / factor;
+    out.resize(width * height);
+
+    forRows(0, height, threads, [&](size_t jBegin, size_t jEnd)
+    {
+        for (size_t oj = jBegin; oj < jEnd; ++oj)
+            for (size_t oi = 0; oi < width; ++oi)
+            {
+                // Cells with points are combined.  Cells without points
+                // were either filled from their neighbors or have no data.
+                // They're averaged only if no cell in the square has points.
+                double count = 0;
+                double val = 0;
+                double m2 = 0;
+                double filled = 0;
+                double filledCount = 0;
+                bool first = true;
+
+                size_t rowEnd = (std::min)((oj + 1) * factor, m_height);
+                size_t colEnd = (std::min)((oi + 1) * factor, m_width);
+                for (size_t j = oj * factor; j < rowEnd; ++j)
+                    for (size_t i = oi * factor; i < colEnd; ++i)
+                    {
+                        size_t idx = index(i, j);
+                        double v = (*src)[idx];
+                        if (empty(idx))
+                        {
+                            if (!std::isnan(v))
+                            {
+                                filled += v;
+                                filledCount++;
+                            }
+                            continue;
+                        }
+
+                        double n = (*m_count)[idx];
+                        if (src == m_count.get())
+                            val += n;
+                        else if (src == m_min.get())
+                            val = first ? v : (std::min)(val, v);
+                        else if (src == m_max.get())
+                            val = first ? v : (std::max)(val, v);
+                        else if (src == m_idw.get())
+                        {
+                            val += v;
+                            count++;
+                        }
+                        else
+                        {
+                            // Combine means and sums of squared deviations.
+                            // See
+                            // https://en.wikipedia.org/wiki/Algorithms_for_calculating_variance
+                            double mean = (*m_mean)[idx];
+                            double delta = mean - val;
+                            double total = count + n;
+                            val = first ? mean : val + (delta * n / total);
+                            if (m_stdDev)
+                            {
+                                double sd = (*m_stdDev)[idx];
+                                m2 += (sd * sd * n) +
+                                    (delta * delta * count * n / total);
+                            }
+                            count = total;
+                        }
+                        first = false;
+                    }
+
+                double& dst = out[(oj * width) + oi];
+                if (src == m_count.get())
+                    dst = val;
+                else if (!first)
+                {
+                    if (src == m_idw.get())
+                        dst = val / count;
+                    else if (src == m_stdDev.get())
+                        dst = sqrt(m2 / count);
+                    else
+                        dst = val;
+                }
+                else if (filledCount)
+                    dst = filled / filledCount;
+                else
+                    dst = std::numeric_limits<double>::quiet_NaN();
+            }
+    });
+}
+
+
+void GDALGrid::finalizeRows(size_t jBegin, size_t jEnd)
 {
     // See
     // https://en.wikipedia.org/wiki/Algorithms_for_calculating_variance
     // https://en.wikipedia.org/wiki/Inverse_distance_weighting
+    size_t begin = index(0, jBegin);
+    size_t end = index(0, jEnd);
+
     if (m_stdDev)
-        for (size_t i = 0; i < m_count->size(); ++i)
+        for (size_t i = begin; i < end; ++i)
             if (!empty(i))
                 (*m_stdDev)[i] = sqrt((*m_stdDev)[i] / (*m_count)[i]);
 
     if (m_idw)
-        for (size_t i = 0; i < m_count->size(); ++i)
+        for (size_t i = begin; i < end; ++i)
             if (!empty(i))
             {
                 double& distSum = (*m_idwDist)[i];
                 if (!std::isnan(distSum))
                     (*m_idw)[i] /= distSum;
             }
+}
+
 
+void GDALGrid::fillRows(size_t jBegin, size_t jEnd)
+{
     if (m_windowSize > 0)
-        windowFill();
+        windowFillRows(jBegin, jEnd);
     else
-        for (size_t i = 0; i < m_count->size(); ++i)
+        for (size_t i = index(0, jBegin); i < index(0, jEnd); ++i)
             if (empty(i))
                 fillNodata(i);
 }
@@ -480,8 +696,9 @@ void GDALGrid::windowFill(size_t dstI, size_t dstJ)
 {
     size_t istart = dstI > m_windowSize ? dstI - m_windowSize : (size_t)0;
     size_t iend = (std::min)(width(), dstI + m_windowSize + 1);
-    size_t jstart = dstJ > m_windowSize ? dstJ - m_windowSize : (size_t)0;
-    size_t jend = (std::min)(height(), dstJ + m_windowSize + 1);
+    size_t jstart = dstJ > m_firstRow + m_windowSize ?
+        dstJ - m_windowSize : m_firstRow;
+    size_t jend = (std::min)(m_firstRow + m_numRows, dstJ + m_windowSize + 1);
 
     double distSum = 0;
     size_t dstIdx = index(dstI, dstJ);
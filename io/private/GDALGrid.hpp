@@ -64,19 +64,43 @@ public:
     PDAL_DLL GDALGrid(size_t width, size_t height,
         double edgeLength, double radius, int outputTypes, size_t windowSize, double power);
 
+    // Create a grid that only holds cells for \c numRows rows starting
+    // at \c firstRow.  Points still locate cells in the full grid, but
+    // only the held cells are updated.
+    PDAL_DLL GDALGrid(size_t width, size_t height,
+        double edgeLength, double radius, int outputTypes, size_t windowSize,
+        double power, size_t firstRow, size_t numRows);
+
     void expand(size_t width, size_t height, size_t xshift, size_t yshift);
 
+    // Discard the data in the grid and hold cells for \c numRows rows
+    // starting at \c firstRow.
+    void setRows(size_t firstRow, size_t numRows);
+
     // Get the number of bands represented by this grid.
     int numBands() const;
 
     // Return a pointer to the data in a raster band, row-major ordered.
+    // The data starts with the first held row.
     double *data(const std::string& name);
 
     // Add a point to the raster grid.
     void addPoint(double x, double y, double z);
 
+    // Add points to the raster grid.  Each thread updates a separate
+    // set of rows, so the result doesn't depend on the number of threads.
+    void addPoints(const std::vector<double>& x, const std::vector<double>& y,
+        const std::vector<double>& z, int threads);
+
     // Compute final values after all points have been added.
-    void finalize();
+    void finalize(int threads = 1);
+
+    // Compute an overview of a finished raster band in which each cell
+    // summarizes a square of \c factor by \c factor cells of the band.
+    // Statistics are combined from the points binned in the cells.  All
+    // rows must be held.
+    void overview(const std::string& name, size_t factor,
+        std::vector<double>& out, int threads) const;
 
     size_t width() const
         { return m_width; }
@@ -84,9 +108,19 @@ public:
     size_t height() const
         { return m_height; }
 
+    // First row for which cells are held.
+    size_t firstRow() const
+        { return m_firstRow; }
+
+    // Number of rows for which cells are held.
+    size_t numRows() const
+        { return m_numRows; }
+
 private:
     size_t m_width;
     size_t m_height;
+    size_t m_firstRow;
+    size_t m_numRows;
     size_t m_windowSize;
     double m_edgeLength;
     double m_radius;
@@ -106,7 +140,10 @@ private:
 
     // Find an index into the actual storage given a grid coordinate.
     size_t index(size_t i, size_t j) const
-        { return (j * m_width) + i; }
+        { return ((j - m_firstRow) * m_width) + i; }
+
+    // Allocate storage for the held rows.
+    void allocate();
 
     // Determine if a cell i, j has no associated points.
     bool empty(size_t i, size_t j) const
@@ -143,11 +180,19 @@ private:
         return sqrt(pow(x1 - x, 2) + pow(y1 - y, 2));
     }
 
-    // Update cells in the Nth quadrant about point at (x, y, z)
-    void updateFirstQuadrant(double x, double y, double z);
-    void updateSecondQuadrant(double x, double y, double z);
-    void updateThirdQuadrant(double x, double y, double z);
-    void updateFourthQuadrant(double x, double y, double z);
+    // Add a point to the cells in rows \c jLow through \c jHigh - 1.
+    void addPoint(double x, double y, double z, int jLow, int jHigh);
+
+    // Update cells in rows \c jLow through \c jHigh - 1 in the Nth
+    // quadrant about point at (x, y, z)
+    void updateFirstQuadrant(double x, double y, double z,
+        int jLow, int jHigh);
+    void updateSecondQuadrant(double x, double y, double z,
+        int jLow, int jHigh);
+    void updateThirdQuadrant(double x, double y, double z,
+        int jLow, int jHigh);
+    void updateFourthQuadrant(double x, double y, double z,
+        int jLow, int jHigh);
 
     // Update cell at i, j with value at a distance.
     void update(size_t i, size_t j, double val, double dist);
@@ -155,12 +200,22 @@ private:
     // Fill cell at index \c i with the nondata value.
     void fillNodata(size_t i);
 
-    // Fill an empty cell with a value inverse-distance averaged from
-    // surrounding cells.
-    void windowFill()
+    // Compute the standard deviation and IDW values of cells in rows
+    // \c jBegin through \c jEnd - 1.
+    void finalizeRows(size_t jBegin, size_t jEnd);
+
+    // Fill empty cells in rows \c jBegin through \c jEnd - 1, either
+    // from surrounding cells or with the nodata value.
+    void fillRows(size_t jBegin, size_t jEnd);
+
+    // Fill empty cells in rows \c jBegin through \c jEnd - 1 with values
+    // inverse-distance averaged from surrounding cells.  Only non-empty
+    // cells are read and only empty cells are written, so rows can be
+    // filled in any order.
+    void windowFillRows(size_t jBegin, size_t jEnd)
     {
         for (size_t i = 0; i < width(); ++i)
-            for (size_t j = 0; j < height(); ++j)
+            for (size_t j = jBegin; j < jEnd; ++j)
                 if (empty(i, j))
                     windowFill(i, j);
     }
@@ -0,0 +1,288 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include "Lzf.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace pdal
+{
+
+namespace
+{
+
+const size_t MaxLiteral = 32;
+const size_t MaxOffset = 8192;
+const size_t MaxMatch = 264;
+const int HashBits = 14;
+
+inline uint32_t hash(const unsigned char *p)
+{
+    uint32_t v = (p[0] << 16) | (p[1] << 8) | p[2];
+    return (v * 2654435761u) >> (32 - HashBits);
+}
+
+} // unnamed namespace
+
+LzfDecoder::LzfDecoder() : m_total(0), m_literal(0), m_matchLen(0),
+    m_matchDist(0), m_headerLen(0)
+{}
+
+
+// Add decoded data to the history window.
+void LzfDecoder::put(const char *p, size_t size)
+{
+    while (size)
+    {
+        const size_t pos = m_total & (WindowSize - 1);
+        const size_t n = (std::min)(size, WindowSize - pos);
+        std::memcpy(m_window + pos, p, n);
+        m_total += n;
+        p += n;
+        size -= n;
+    }
+}
+
+
+void LzfDecoder::decode(const char *& in, const char *inEnd, char *& out,
+    char *outEnd)
+{
+    // References are resolved against the output of this call where
+    // possible.  The window, which holds the history from earlier calls, is
+    // brought up to date at the end.
+    char *start = out;
+    while (out < outEnd)
+    {
+        // Decode whole instructions directly while there's room for the
+        // largest one in both buffers.
+        while (!m_literal && !m_matchLen && !m_headerLen &&
+            inEnd - in >= 3 + (ptrdiff_t)MaxLiteral &&
+            outEnd - out >= (ptrdiff_t)MaxMatch)
+        {
+            const size_t ctrl = (unsigned char)*in++;
+            if (ctrl < MaxLiteral)
+            {
+                const size_t n = ctrl + 1;
+                std::memcpy(out, in, n);
+                in += n;
+                out += n;
+                continue;
+            }
+            size_t len = ctrl >> 5;
+            if (len == 7)
+                len += (unsigned char)*in++;
+            len += 2;
+            const size_t dist = ((ctrl & 0x1f) << 8) +
+                (unsigned char)*in++ + 1;
+            if (dist > (size_t)(out - start))
+            {
+                // The reference reaches into the window.
+                if (dist > m_total + (out - start))
+                    throw error("Invalid LZF back-reference.");
+                m_matchLen = len;
+                m_matchDist = dist;
+                break;
+            }
+            const char *src = out - dist;
+            if (dist >= len)
+                std::memcpy(out, src, len);
+            else
+                for (size_t i = 0; i < len; ++i)
+                    out[i] = src[i];
+            out += len;
+        }
+        if (out == outEnd)
+            break;
+
+        if (m_literal)
+        {
+            size_t n = (std::min)({ m_literal, (size_t)(inEnd - in),
+                (size_t)(outEnd - out) });
+            if (!n)
+                break;
+            std::memcpy(out, in, n);
+            m_literal -= n;
+            in += n;
+            out += n;
+        }
+        else if (m_matchLen)
+        {
+            const size_t n = (std::min)(m_matchLen, (size_t)(outEnd - out));
+            const size_t produced = out - start;
+            if (m_matchDist <= produced)
+            {
+                const char *src = out - m_matchDist;
+                if (m_matchDist >= n)
+                    std::memcpy(out, src, n);
+                else
+                    for (size_t i = 0; i < n; ++i)
+                        out[i] = src[i];
+            }
+            else
+            {
+                for (size_t i = 0; i < n; ++i)
+                {
+                    const size_t pos = produced + i;
+                    out[i] = (pos >= m_matchDist) ?
+                        start[pos - m_matchDist] :
+                        m_window[(m_total + pos - m_matchDist) &
+                            (WindowSize - 1)];
+                }
+            }
+            m_matchLen -= n;
+            out += n;
+        }
+        else
+        {
+            // Collect the instruction header, which may be split across
+            // calls.
+            if (in == inEnd)
+                break;
+            m_header[m_headerLen++] = (unsigned char)*in++;
+
+            const size_t ctrl = m_header[0];
+            if (ctrl < MaxLiteral)
+            {
+                m_literal = ctrl + 1;
+                m_headerLen = 0;
+                continue;
+            }
+            size_t len = ctrl >> 5;
+            const size_t headerLen = (len == 7) ? 3 : 2;
+            if (m_headerLen < headerLen)
+                continue;
+            if (len == 7)
+                len += m_header[1];
+            const size_t dist = ((ctrl & 0x1f) << 8) +
+                m_header[headerLen - 1] + 1;
+            if (dist > m_total + (out - start))
+                throw error("Invalid LZF back-reference.");
+            m_matchLen = len + 2;
+            m_matchDist = dist;
+            m_headerLen = 0;
+        }
+    }
+
+    size_t produced = out - start;
+    if (produced > WindowSize)
+    {
+        m_total += produced - WindowSize;
+        produced = WindowSize;
+    }
+    put(out - produced, produced);
+}
+
+
+void lzfCompress(const char *in, size_t size, std::vector<char>& out)
+{
+    const unsigned char *data = reinterpret_cast<const unsigned char *>(in);
+
+    // Positions (plus one, so that zero means empty) of recent three-byte
+    // sequences, by hash.
+    std::vector<size_t> table(1 << HashBits, 0);
+
+    out.reserve(out.size() + size + size / MaxLiteral + 1);
+
+    // Reserve a control byte for the literal run being collected.
+    size_t ctrlPos = out.size();
+    size_t literal = 0;
+    out.push_back(0);
+
+    auto addLiteral = [&](unsigned char c)
+    {
+        out.push_back((char)c);
+        if (++literal == MaxLiteral)
+        {
+            out[ctrlPos] = (char)(MaxLiteral - 1);
+            ctrlPos = out.size();
+            literal = 0;
+            out.push_back(0);
+        }
+    };
+
+    size_t pos = 0;
+    while (pos + 2 < size)
+    {
+        const uint32_t h = hash(data + pos);
+        const size_t ref = table[h];
+        table[h] = pos + 1;
+
+        if (ref && pos - (ref - 1) <= MaxOffset &&
+            std::equal(data + ref - 1, data + ref + 2, data + pos))
+        {
+            const size_t start = ref - 1;
+            const size_t maxLen = (std::min)(MaxMatch, size - pos);
+            size_t len = 3;
+            while (len < maxLen && data[start + len] == data[pos + len])
+                len++;
+
+            // Finish the literal run, or drop its unused control byte.
+            if (literal)
+                out[ctrlPos] = (char)(literal - 1);
+            else
+                out.pop_back();
+
+            const size_t off = pos - start - 1;
+            const size_t code = len - 2;
+            if (code < 7)
+                out.push_back((char)((off >> 8) + (code << 5)));
+            else
+            {
+                out.push_back((char)((off >> 8) + (7 << 5)));
+                out.push_back((char)(code - 7));
+            }
+            out.push_back((char)(off & 0xff));
+
+            ctrlPos = out.size();
+            literal = 0;
+            out.push_back(0);
+
+            pos += len;
+            if (pos + 2 < size)
+                table[hash(data + pos - 1)] = pos;
+        }
+        else
+            addLiteral(data[pos++]);
+    }
+    while (pos < size)
+        addLiteral(data[pos++]);
+
+    if (literal)
+        out[ctrlPos] = (char)(literal - 1);
+    else
+        out.pop_back();
+}
+
+} // namespace pdal
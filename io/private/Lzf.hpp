@@ -0,0 +1,90 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace pdal
+{
+
+// LZF is the compression used for PCD 'binary_compressed' data.  A stream
+// is a sequence of instructions, each either a run of literal bytes or a
+// reference to bytes already decoded.  A reference reaches at most 8K back,
+// so a decoder only needs that much history.
+
+// Incremental LZF decoder.  All of the decoder's state is held in the
+// object, so a copy made at some point in a stream can later resume
+// decoding from that point.
+class LzfDecoder
+{
+public:
+    struct error : public std::runtime_error
+    {
+        error(const std::string& err) : std::runtime_error(err)
+        {}
+    };
+
+    LzfDecoder();
+
+    // Decode data from [in, inEnd) into [out, outEnd).  Decoding stops when
+    // either the input is used up or the output is full.  Both pointers are
+    // advanced past the data used and produced.
+    void decode(const char *& in, const char *inEnd, char *& out,
+        char *outEnd);
+
+private:
+    static const size_t WindowSize = 8192;
+
+    void put(const char *p, size_t size);
+
+    uint64_t m_total;
+    size_t m_literal;
+    size_t m_matchLen;
+    size_t m_matchDist;
+    unsigned char m_header[3];
+    size_t m_headerLen;
+    char m_window[WindowSize];
+};
+
+// Compress 'size' bytes at 'in' as a self-contained LZF stream and append
+// it to 'out'.  Self-contained streams can be concatenated to form a
+// stream that decodes to the concatenated data.
+void lzfCompress(const char *in, size_t size, std::vector<char>& out);
+
+} // namespace pdal
@@ -0,0 +1,204 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#include "MemberQueue.hpp"
+
+#include <pdal/Stage.hpp>
+
+namespace pdal
+{
+
+bool MemberQueue::Member::copyNext(PointRef& point)
+{
+    while (m_viewIdx < m_views.size() &&
+        m_pointIdx == m_views[m_viewIdx]->size())
+    {
+        m_viewIdx++;
+        m_pointIdx = 0;
+    }
+    if (m_viewIdx == m_views.size())
+        return false;
+
+    PointRef src(*m_views[m_viewIdx], m_pointIdx++);
+    src.getPackedData(m_srcDims, m_buf.data());
+    point.setPackedData(m_dstDims, m_buf.data());
+    return true;
+}
+
+
+void MemberQueue::Member::copy(PointView& view)
+{
+    PointRef point(view, view.size());
+    while (copyNext(point))
+        point.setPointId(view.size());
+}
+
+
+MemberQueue::MemberQueue() : m_count(0), m_threads(1), m_layout(nullptr),
+    m_started(false), m_nextLoad(0), m_nextMember(0), m_stop(false)
+{}
+
+
+MemberQueue::~MemberQueue()
+{
+    stop();
+}
+
+
+void MemberQueue::start(size_t count, int threads, CreateFunc create,
+    PointLayoutPtr layout)
+{
+    stop();
+    m_count = count;
+    m_threads = (std::max)(threads, 1);
+    m_create = create;
+    m_layout = layout;
+    m_members.clear();
+    m_members.resize(count);
+    m_nextLoad = 0;
+    m_nextMember = 0;
+    m_stop = false;
+    m_started = true;
+    size_t loaders = (std::min)((size_t)m_threads, count);
+    for (size_t i = 0; i < loaders; ++i)
+        m_loaders.emplace_back(&MemberQueue::load, this);
+}
+
+
+void MemberQueue::stop()
+{
+    {
+        std::lock_guard<std::mutex> l(m_lock);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    for (std::thread& t : m_loaders)
+        t.join();
+    m_loaders.clear();
+    m_members.clear();
+    m_member.reset();
+    m_started = false;
+}
+
+
+void MemberQueue::load()
+{
+    std::unique_lock<std::mutex> l(m_lock);
+    while (true)
+    {
+        m_cv.wait(l, [this]()
+        {
+            return m_stop || m_nextLoad == m_count ||
+                m_nextLoad < m_nextMember + (size_t)m_threads;
+        });
+        if (m_stop || m_nextLoad == m_count)
+            return;
+
+        const size_t i = m_nextLoad++;
+        MemberPtr m(new Member);
+        Stage *s = nullptr;
+        try
+        {
+            s = m_create(i);
+        }
+        catch (const std::exception& err)
+        {
+            m->m_error = err.what();
+        }
+        l.unlock();
+
+        if (s)
+        {
+            try
+            {
+                s->prepare(m->m_table);
+                PointViewSet views = s->execute(m->m_table);
+                m->m_views.assign(views.begin(), views.end());
+            }
+            catch (const std::exception& err)
+            {
+                m->m_error = err.what();
+            }
+        }
+
+        l.lock();
+        m_members[i] = std::move(m);
+        m_cv.notify_all();
+    }
+}
+
+
+MemberQueue::MemberPtr MemberQueue::next()
+{
+    MemberPtr m;
+    {
+        std::unique_lock<std::mutex> l(m_lock);
+        if (m_nextMember == m_count)
+            return m;
+        m_cv.wait(l, [this](){ return (bool)m_members[m_nextMember]; });
+        m = std::move(m_members[m_nextMember++]);
+    }
+    m_cv.notify_all();
+
+    if (m->m_error.size())
+        throw pdal_error(m->m_error);
+
+    PointLayoutPtr layout = m->m_table.layout();
+    for (Dimension::Id id : layout->dims())
+    {
+        Dimension::Type type = layout->dimType(id);
+        m->m_srcDims.emplace_back(id, type);
+        m->m_dstDims.emplace_back(m_layout->findDim(layout->dimName(id)),
+            type);
+    }
+    m->m_buf.resize(layout->pointSize());
+    return m;
+}
+
+
+bool MemberQueue::copyNext(PointRef& point)
+{
+    while (!m_member || !m_member->copyNext(point))
+    {
+        // Drop the finished member before waiting for the next one.
+        m_member.reset();
+        m_member = next();
+        if (!m_member)
+            return false;
+    }
+    return true;
+}
+
+} // namespace pdal
@@ -0,0 +1,137 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <pdal/DimType.hpp>
+#include <pdal/PointTable.hpp>
+#include <pdal/PointView.hpp>
+
+namespace pdal
+{
+
+class Stage;
+
+// Reads the member files of a reader that reads several files.  Each member
+// is read by its own pipeline into its own point table on a loader thread,
+// since a point table can't be added to from several threads.  Members are
+// handed out in order, and loaders stay no more than 'threads' members
+// ahead of the last member handed out.
+class MemberQueue
+{
+public:
+    class Member
+    {
+        friend class MemberQueue;
+
+    public:
+        // Copy the next point of the member to 'point'.
+        // \return  Whether there was a point to copy.
+        bool copyNext(PointRef& point);
+
+        // Append the points of the member to a view.
+        void copy(PointView& view);
+
+        const std::vector<PointViewPtr>& views() const
+            { return m_views; }
+
+    private:
+        PointTable m_table;
+        std::vector<PointViewPtr> m_views;
+        std::string m_error;
+
+        // Dimensions of the member and the matching dimensions of the output.
+        DimTypeList m_srcDims;
+        DimTypeList m_dstDims;
+        std::vector<char> m_buf;
+        size_t m_viewIdx = 0;
+        PointId m_pointIdx = 0;
+    };
+    typedef std::unique_ptr<Member> MemberPtr;
+
+    // Create the pipeline that reads a member and return its last stage.
+    // Called with the queue locked.
+    typedef std::function<Stage *(size_t)> CreateFunc;
+
+    MemberQueue();
+    ~MemberQueue();
+
+    // Start reading 'count' members.  Points are copied to dimensions of
+    // 'layout' with the same names.
+    void start(size_t count, int threads, CreateFunc create,
+        PointLayoutPtr layout);
+
+    // Stop reading and drop any members that have been read.
+    void stop();
+
+    bool started() const
+        { return m_started; }
+
+    // Get the next member, waiting for it to be read.
+    // \return  The member or null if all members have been handed out.
+    MemberPtr next();
+
+    // Copy the next point of the members, in order, to 'point'.
+    // \return  Whether there was a point to copy.
+    bool copyNext(PointRef& point);
+
+private:
+    void load();
+
+    size_t m_count;
+    int m_threads;
+    CreateFunc m_create;
+    PointLayoutPtr m_layout;
+    bool m_started;
+
+    std::vector<MemberPtr> m_members;
+    std::vector<std::thread> m_loaders;
+    std::mutex m_lock;
+    std::condition_variable m_cv;
+    size_t m_nextLoad;
+    size_t m_nextMember;
+    bool m_stop;
+    MemberPtr m_member;
+};
+
+} // namespace pdal
@@ -0,0 +1,413 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <thread>
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <pdal/pdal_types.hpp>
+
+#include "ShmRing.hpp"
+
+namespace pdal
+{
+
+namespace
+{
+
+const uint32_t Magic = 0x4d485350;   // "PSHM"
+const uint32_t Version = 1;
+const size_t Align = 64;
+
+size_t align(size_t size)
+{
+    return (size + Align - 1) / Align * Align;
+}
+
+std::string errorText()
+{
+    return std::strerror(errno);
+}
+
+// Locks a process-shared mutex for the life of the object.
+class Lock
+{
+public:
+    Lock(pthread_mutex_t *mutex) : m_mutex(mutex)
+        { pthread_mutex_lock(m_mutex); }
+    ~Lock()
+        { pthread_mutex_unlock(m_mutex); }
+
+private:
+    pthread_mutex_t *m_mutex;
+};
+
+// Waits on a condition until a deadline.  A timeout of 0 waits forever.
+class Waiter
+{
+public:
+    Waiter(double timeout) : m_forever(timeout <= 0)
+    {
+        clock_gettime(CLOCK_REALTIME, &m_deadline);
+        double secs = m_deadline.tv_sec + m_deadline.tv_nsec / 1e9 + timeout;
+        m_deadline.tv_sec = (time_t)secs;
+        m_deadline.tv_nsec = (long)((secs - m_deadline.tv_sec) * 1e9);
+    }
+
+    // \return  False if the deadline passed.
+    bool wait(pthread_cond_t *cond, pthread_mutex_t *mutex)
+    {
+        if (m_forever)
+            return pthread_cond_wait(cond, mutex) == 0;
+        return pthread_cond_timedwait(cond, mutex, &m_deadline) != ETIMEDOUT;
+    }
+
+private:
+    bool m_forever;
+    timespec m_deadline;
+};
+
+} // unnamed namespace
+
+
+struct ShmRing::Header
+{
+    std::atomic<uint32_t> m_magic;
+    uint32_t m_version;
+    uint64_t m_size;
+    uint64_t m_schemaSize;
+    uint64_t m_pointSize;
+    uint64_t m_slotPoints;
+    uint64_t m_slots;
+    uint64_t m_slotSize;
+    uint64_t m_written;     // Number of slots published.
+    uint64_t m_read;        // Number of slots released.
+    uint32_t m_done;
+    pthread_mutex_t m_mutex;
+    pthread_cond_t m_notEmpty;
+    pthread_cond_t m_notFull;
+};
+
+
+ShmRing::ShmRing() : m_fd(-1), m_base(nullptr), m_size(0), m_creator(false)
+{}
+
+
+ShmRing::~ShmRing()
+{
+    close();
+}
+
+
+ShmRing::Header *ShmRing::header() const
+{
+    return reinterpret_cast<Header *>(m_base);
+}
+
+
+// Each slot starts with the number of points it holds.
+char *ShmRing::slot(uint64_t num) const
+{
+    const Header *h = header();
+    return m_base + align(sizeof(Header)) + align(h->m_schemaSize) +
+        (num % h->m_slots) * h->m_slotSize;
+}
+
+
+void ShmRing::create(const std::string& name, const std::string& schema,
+    size_t pointSize, point_count_t slotPoints, size_t slots)
+{
+    close();
+
+    m_name = name;
+    shm_unlink(m_name.c_str());
+    m_fd = shm_open(m_name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (m_fd < 0)
+        throw pdal_error("Unable to create shared memory '" + m_name +
+            "': " + errorText() + ".");
+    m_creator = true;
+
+    const size_t slotSize = align(Align + pointSize * slotPoints);
+    m_size = align(sizeof(Header)) + align(schema.size()) + slots * slotSize;
+    if (ftruncate(m_fd, m_size) != 0)
+    {
+        std::string err = errorText();
+        close();
+        throw pdal_error("Unable to size shared memory '" + name + "': " +
+            err + ".");
+    }
+    void *base = mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+        m_fd, 0);
+    if (base == MAP_FAILED)
+    {
+        std::string err = errorText();
+        m_size = 0;
+        close();
+        throw pdal_error("Unable to map shared memory '" + name + "': " +
+            err + ".");
+    }
+    m_base = static_cast<char *>(base);
+
+    Header *h = new (m_base) Header;
+    h->m_version = Version;
+    h->m_size = m_size;
+    h->m_schemaSize = schema.size();
+    h->m_pointSize = pointSize;
+    h->m_slotPoints = slotPoints;
+    h->m_slots = slots;
+    h->m_slotSize = slotSize;
+    h->m_written = 0;
+    h->m_read = 0;
+    h->m_done = 0;
+
+    pthread_mutexattr_t mattr;
+    pthread_mutexattr_init(&mattr);
+    int err = pthread_mutexattr_setpshared(&mattr, PTHREAD_PROCESS_SHARED);
+    if (!err)
+        err = pthread_mutex_init(&h->m_mutex, &mattr);
+    pthread_mutexattr_destroy(&mattr);
+
+    pthread_condattr_t cattr;
+    pthread_condattr_init(&cattr);
+    if (!err)
+        err = pthread_condattr_setpshared(&cattr, PTHREAD_PROCESS_SHARED);
+    if (!err)
+        err = pthread_cond_init(&h->m_notEmpty, &cattr);
+    if (!err)
+        err = pthread_cond_init(&h->m_notFull, &cattr);
+    pthread_condattr_destroy(&cattr);
+    if (err)
+    {
+        close();
+        throw pdal_error("Unable to initialize shared memory '" + name +
+            "': " + std::strerror(err) + ".");
+    }
+
+    std::memcpy(m_base + align(sizeof(Header)), schema.data(), schema.size());
+
+    // Readers wait for the magic number before using the segment.
+    h->m_magic.store(Magic, std::memory_order_release);
+}
+
+
+void ShmRing::open(const std::string& name, double timeout)
+{
+    using Clock = std::chrono::steady_clock;
+
+    close();
+
+    m_name = name;
+    const Clock::time_point start = Clock::now();
+    auto expired = [start, timeout]()
+    {
+        return timeout > 0 && std::chrono::duration<double>(
+            Clock::now() - start).count() > timeout;
+    };
+    auto pause = []()
+        { std::this_thread::sleep_for(std::chrono::milliseconds(10)); };
+
+    // The segment exists once the writer is prepared.
+    while ((m_fd = shm_open(m_name.c_str(), O_RDWR, 0)) < 0)
+    {
+        if (errno != ENOENT)
+            throw pdal_error("Unable to open shared memory '" + m_name +
+                "': " + errorText() + ".");
+        if (expired())
+            throw pdal_error("Timed out waiting for shared memory '" +
+                m_name + "' to be created.");
+        pause();
+    }
+
+    struct stat st;
+    while (true)
+    {
+        if (fstat(m_fd, &st) != 0)
+        {
+            std::string err = errorText();
+            close();
+            throw pdal_error("Unable to open shared memory '" + name +
+                "': " + err + ".");
+        }
+        if ((size_t)st.st_size >= sizeof(Header))
+        {
+            void *base = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE,
+                MAP_SHARED, m_fd, 0);
+            if (base == MAP_FAILED)
+            {
+                std::string err = errorText();
+                close();
+                throw pdal_error("Unable to map shared memory '" + name +
+                    "': " + err + ".");
+            }
+            m_base = static_cast<char *>(base);
+            m_size = st.st_size;
+            if (header()->m_magic.load(std::memory_order_acquire) == Magic)
+                break;
+            munmap(m_base, m_size);
+            m_base = nullptr;
+            m_size = 0;
+        }
+        if (expired())
+        {
+            close();
+            throw pdal_error("Timed out waiting for shared memory '" + name +
+                "' to be initialized.");
+        }
+        pause();
+    }
+
+    if (header()->m_version != Version || header()->m_size != m_size)
+    {
+        close();
+        throw pdal_error("Shared memory '" + name + "' wasn't created "
+            "by a compatible writer.");
+    }
+}
+
+
+void ShmRing::close()
+{
+    if (m_base)
+        munmap(m_base, m_size);
+    if (m_fd >= 0)
+        ::close(m_fd);
+    if (m_creator)
+        shm_unlink(m_name.c_str());
+    m_base = nullptr;
+    m_size = 0;
+    m_fd = -1;
+    m_creator = false;
+}
+
+
+std::string ShmRing::schema() const
+{
+    return std::string(m_base + align(sizeof(Header)), header()->m_schemaSize);
+}
+
+
+size_t ShmRing::pointSize() const
+{
+    return header()->m_pointSize;
+}
+
+
+point_count_t ShmRing::slotPoints() const
+{
+    return header()->m_slotPoints;
+}
+
+
+char *ShmRing::acquireWrite(double timeout)
+{
+    Header *h = header();
+    Waiter waiter(timeout);
+
+    Lock lock(&h->m_mutex);
+    while (h->m_written - h->m_read == h->m_slots)
+        if (!waiter.wait(&h->m_notFull, &h->m_mutex))
+            throw pdal_error("Timed out waiting for a reader of shared "
+                "memory '" + m_name + "'.");
+    return slot(h->m_written) + Align;
+}
+
+
+void ShmRing::publish(point_count_t count)
+{
+    Header *h = header();
+
+    Lock lock(&h->m_mutex);
+    uint64_t cnt = count;
+    std::memcpy(slot(h->m_written), &cnt, sizeof(cnt));
+    h->m_written++;
+    pthread_cond_signal(&h->m_notEmpty);
+}
+
+
+void ShmRing::finish(double timeout)
+{
+    Header *h = header();
+    Waiter waiter(timeout);
+
+    Lock lock(&h->m_mutex);
+    h->m_done = 1;
+    pthread_cond_broadcast(&h->m_notEmpty);
+    while (h->m_read != h->m_written)
+        if (!waiter.wait(&h->m_notFull, &h->m_mutex))
+            throw pdal_error("Timed out waiting for a reader of shared "
+                "memory '" + m_name + "'.");
+}
+
+
+const char *ShmRing::acquireRead(point_count_t& count, double timeout)
+{
+    Header *h = header();
+    Waiter waiter(timeout);
+
+    Lock lock(&h->m_mutex);
+    while (h->m_read == h->m_written && !h->m_done)
+        if (!waiter.wait(&h->m_notEmpty, &h->m_mutex))
+            throw pdal_error("Timed out waiting for a writer of shared "
+                "memory '" + m_name + "'.");
+    if (h->m_read == h->m_written)
+        return nullptr;
+
+    uint64_t cnt;
+    const char *s = slot(h->m_read);
+    std::memcpy(&cnt, s, sizeof(cnt));
+    count = cnt;
+    return s + Align;
+}
+
+
+void ShmRing::release()
+{
+    Header *h = header();
+
+    Lock lock(&h->m_mutex);
+    h->m_read++;
+    pthread_cond_signal(&h->m_notFull);
+}
+
+} // namespace pdal
@@ -0,0 +1,102 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <string>
+
+#include <pdal/pdal_types.hpp>
+
+namespace pdal
+{
+
+// A ring of slots of packed point data in a named POSIX shared memory
+// segment, written by one process and read by another.  The segment also
+// holds a schema describing the points.  The writer waits for the reader
+// to release a slot when all slots are full, and the reader waits for the
+// writer to publish a slot when all slots are empty.  Waits give up after
+// a timeout in seconds, unless the timeout is 0.  Errors are reported by
+// throwing pdal_error.
+class ShmRing
+{
+public:
+    ShmRing();
+    ~ShmRing();
+
+    // Create the segment, replacing any segment with the same name.
+    void create(const std::string& name, const std::string& schema,
+        size_t pointSize, point_count_t slotPoints, size_t slots);
+
+    // Open a segment, waiting for it to be created.
+    void open(const std::string& name, double timeout);
+
+    // Unmap the segment.  The creator also removes its name.
+    void close();
+
+    std::string schema() const;
+    size_t pointSize() const;
+    point_count_t slotPoints() const;
+
+    // Get the buffer of the next slot to write, waiting for a free slot.
+    char *acquireWrite(double timeout);
+
+    // Make the acquired slot, holding 'count' points, available to read.
+    void publish(point_count_t count);
+
+    // Mark the end of the points and wait for the reader to release all
+    // published slots.
+    void finish(double timeout);
+
+    // Get the buffer of the next slot to read, waiting for a slot to be
+    // published.
+    // \return  Slot buffer, or nullptr if there are no more points.
+    const char *acquireRead(point_count_t& count, double timeout);
+
+    // Make the slot last read available to write.
+    void release();
+
+private:
+    struct Header;
+
+    Header *header() const;
+    char *slot(uint64_t num) const;
+
+    std::string m_name;
+    int m_fd;
+    char *m_base;
+    size_t m_size;
+    bool m_creator;
+};
+
+} // namespace pdal
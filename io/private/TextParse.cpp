@@ -0,0 +1,308 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+#include <pdal/util/Algorithm.hpp>
+#include <pdal/util/TaskScheduler.hpp>
+
+#include "TextParse.hpp"
+
+namespace pdal
+{
+namespace textparse
+{
+
+void splitFields(const char *begin, const char *end, char separator,
+    FieldList& fields)
+{
+    fields.clear();
+    if (separator == ' ')
+    {
+        // Runs of spaces separate fields.
+        const char *pos = begin;
+        while (pos < end)
+        {
+            while (pos < end && *pos == ' ')
+                pos++;
+            if (pos == end)
+                break;
+            const char *fieldBegin = pos;
+            while (pos < end && *pos != ' ')
+                pos++;
+            fields.push_back({ fieldBegin, pos });
+        }
+        return;
+    }
+
+    // Spaces are ignored, so a line of only spaces has no fields.
+    if (std::all_of(begin, end, [](char c){ return c == ' '; }))
+        return;
+
+    const char *pos = begin;
+    while (true)
+    {
+        const char *sep = std::find(pos, end, separator);
+        const char *fieldBegin = pos;
+        const char *fieldEnd = sep;
+        while (fieldBegin < fieldEnd && *fieldBegin == ' ')
+            fieldBegin++;
+        while (fieldEnd > fieldBegin && fieldEnd[-1] == ' ')
+            fieldEnd--;
+        fields.push_back({ fieldBegin, fieldEnd });
+        if (sep == end)
+            break;
+        pos = sep + 1;
+    }
+}
+
+
+bool toDouble(const char *begin, const char *end, double& d)
+{
+    const char *pos = begin;
+    while (pos < end && std::isspace((unsigned char)*pos))
+        pos++;
+
+    const char *start = pos;
+    if (pos < end && (*pos == '+' || *pos == '-'))
+        pos++;
+    bool digits = false;
+    while (pos < end && std::isdigit((unsigned char)*pos))
+    {
+        pos++;
+        digits = true;
+    }
+    if (pos < end && *pos == '.')
+    {
+        pos++;
+        while (pos < end && std::isdigit((unsigned char)*pos))
+        {
+            pos++;
+            digits = true;
+        }
+    }
+    if (digits && pos < end && (*pos == 'e' || *pos == 'E'))
+    {
+        pos++;
+        if (pos < end && (*pos == '+' || *pos == '-'))
+            pos++;
+        while (pos < end && std::isdigit((unsigned char)*pos))
+            pos++;
+    }
+    if (pos == start)
+        return false;
+
+    // The text is followed by a newline or a null, so strtod() stops
+    // at the end of the number unless it's something like hexadecimal.
+    // In that case convert a copy of only the part we scanned.
+    char *numEnd;
+    d = std::strtod(start, &numEnd);
+    if (numEnd != pos)
+    {
+        std::string s(start, pos);
+        d = std::strtod(s.data(), &numEnd);
+        if (numEnd != s.data() + s.size())
+            return false;
+    }
+    return d != HUGE_VAL && d != -HUGE_VAL;
+}
+
+
+bool fieldToDouble(const char *begin, const char *end, double& d)
+{
+    if (!std::memchr(begin, ' ', end - begin))
+        return toDouble(begin, end, d);
+    std::string s(fieldText(begin, end));
+    return toDouble(s.data(), s.data() + s.size(), d);
+}
+
+
+bool toUnsigned(const char *begin, const char *end, unsigned& u)
+{
+    const char *pos = begin;
+    while (pos < end && std::isspace((unsigned char)*pos))
+        pos++;
+
+    bool negative = false;
+    if (pos < end && (*pos == '+' || *pos == '-'))
+        negative = (*pos++ == '-');
+    if (pos == end || !std::isdigit((unsigned char)*pos))
+        return false;
+
+    const uint64_t max = (std::numeric_limits<unsigned>::max)();
+    uint64_t v = 0;
+    while (pos < end && std::isdigit((unsigned char)*pos))
+    {
+        v = v * 10 + (uint64_t)(*pos++ - '0');
+        if (v > max)
+            return false;
+    }
+
+    // As with operator>>, a negative value wraps.
+    u = negative ? (unsigned)(0 - (unsigned)v) : (unsigned)v;
+    return true;
+}
+
+
+std::string fieldText(const char *begin, const char *end)
+{
+    std::string s(begin, end);
+    Utils::remove(s, ' ');
+    return s;
+}
+
+
+void parseChunk(Chunk& chunk, size_t numDims, char separator)
+{
+    chunk.m_values.clear();
+    chunk.m_errors.clear();
+    chunk.m_points = 0;
+    chunk.m_lines = 0;
+
+    FieldList fields;
+    const char *pos = chunk.m_begin;
+    while (pos < chunk.m_end)
+    {
+        const char *eol =
+            (const char *)std::memchr(pos, '\n', chunk.m_end - pos);
+        if (!eol)
+            eol = chunk.m_end;
+        const char *begin = pos;
+        pos = eol + 1;
+        chunk.m_lines++;
+
+        if (begin == eol)
+            continue;
+        splitFields(begin, eol, separator, fields);
+        if (fields.size() != numDims)
+        {
+            chunk.m_errors.push_back(
+                { chunk.m_lines, chunk.m_points, "", fields.size() });
+            continue;
+        }
+        for (const Field& f : fields)
+        {
+            double d;
+            if (!fieldToDouble(f.m_begin, f.m_end, d))
+            {
+                chunk.m_errors.push_back({ chunk.m_lines, chunk.m_points,
+                    fieldText(f.m_begin, f.m_end), numDims });
+                d = 0;
+            }
+            chunk.m_values.push_back(d);
+        }
+        chunk.m_points++;
+    }
+}
+
+
+void parseChunks(ChunkList& chunks, size_t numDims, char separator)
+{
+    if (chunks.size() == 1)
+    {
+        parseChunk(chunks[0], numDims, separator);
+        return;
+    }
+
+    parallelFor(chunks.size(), chunks.size(),
+        [&chunks, numDims, separator](std::size_t i)
+        { parseChunk(chunks[i], numDims, separator); });
+}
+
+
+bool LineReader::next(ChunkList& chunks)
+{
+    const size_t numChunks = chunks.size();
+
+    // Keep the text after the last newline handed out.
+    size_t leftover = m_size - m_used;
+    std::copy(m_buf.begin() + m_used, m_buf.begin() + m_size, m_buf.begin());
+    m_size = leftover;
+    m_used = 0;
+
+    size_t dataSize = 0;
+    while (!m_eof)
+    {
+        size_t want = ChunkSize * numChunks;
+        m_buf.resize(m_size + want + 1);
+        m_in.read(m_buf.data() + m_size, want);
+        m_size += (size_t)m_in.gcount();
+        m_eof = !m_in.good();
+
+        // Only hand out complete lines unless there's no more text.
+        dataSize = m_size;
+        while (dataSize && m_buf[dataSize - 1] != '\n')
+            dataSize--;
+        if (dataSize)
+            break;
+    }
+    if (m_eof)
+        dataSize = m_size;
+    if (dataSize == 0)
+        return false;
+
+    // The null makes sure that conversions stop at the end of the text.
+    if (m_buf.size() <= m_size)
+        m_buf.resize(m_size + 1);
+    m_buf[m_size] = '\0';
+    m_used = dataSize;
+
+    // Split the text into chunks that end with a newline.
+    const char *begin = m_buf.data();
+    const char *end = begin + dataSize;
+    const char *pos = begin;
+    for (size_t t = 0; t < numChunks; ++t)
+    {
+        Chunk& c = chunks[t];
+        c.m_begin = pos;
+        pos = begin + (std::max)((size_t)(pos - begin),
+            (t + 1) * dataSize / numChunks);
+        if (pos < end && pos > begin && pos[-1] != '\n')
+        {
+            const char *nl = (const char *)
+                std::memchr(pos, '\n', end - pos);
+            pos = nl ? nl + 1 : end;
+        }
+        c.m_end = pos;
+    }
+    return true;
+}
+
+} // namespace textparse
+} // namespace pdal
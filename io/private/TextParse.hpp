@@ -0,0 +1,142 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <istream>
+#include <string>
+#include <vector>
+
+#include <pdal/pdal_types.hpp>
+
+namespace pdal
+{
+namespace textparse
+{
+
+// Text is parsed in place from large blocks of whole lines.  Fields are
+// found without copying and numbers are converted the way
+// Utils::fromString() converts them, so readers that used to split lines
+// into strings report the same values and errors.
+
+// Bytes of text parsed by each thread at a time.
+const size_t ChunkSize = 1 << 22;
+
+// Position of a field in a line of text.
+struct Field
+{
+    const char *m_begin;
+    const char *m_end;
+};
+typedef std::vector<Field> FieldList;
+
+// Find the fields of the line [begin, end), which excludes the newline.
+// When the separator is a space, runs of spaces separate fields.
+// Otherwise spaces surrounding fields are skipped and a line of only
+// spaces has no fields.
+void splitFields(const char *begin, const char *end, char separator,
+    FieldList& fields);
+
+// Convert text to a double the way Utils::fromString() does: leading
+// whitespace is skipped, the longest prefix that looks like a decimal
+// number is converted and anything after it is ignored.  The text must be
+// followed by a character that can't continue a number, such as a newline
+// or a null.
+bool toDouble(const char *begin, const char *end, double& d);
+
+// Convert a field to a double, ignoring any spaces in it.
+bool fieldToDouble(const char *begin, const char *end, double& d);
+
+// Convert text to an unsigned value the way Utils::fromString() does.
+bool toUnsigned(const char *begin, const char *end, unsigned& u);
+
+// Get the text of a field with any spaces removed.
+std::string fieldText(const char *begin, const char *end);
+
+// A range of whole lines and the points parsed from them.
+struct Chunk
+{
+    const char *m_begin;
+    const char *m_end;
+    std::vector<double> m_values;
+    point_count_t m_points;
+    size_t m_lines;
+
+    // A line with the wrong number of fields, or a field that couldn't
+    // be converted.  Lines are numbered from one within the chunk.
+    struct Error
+    {
+        size_t m_line;
+        point_count_t m_point;
+        std::string m_field;
+        size_t m_fieldCount;
+    };
+    std::vector<Error> m_errors;
+};
+typedef std::vector<Chunk> ChunkList;
+
+// Parse the lines of a chunk into 'numDims' values per point, noting
+// errors as they would be reported if the lines were read one at a time.
+// Empty lines and lines with the wrong number of fields yield no point.
+// Fields that can't be converted are set to 0.
+void parseChunk(Chunk& chunk, size_t numDims, char separator);
+
+// Parse chunks, each on its own thread if there's more than one.
+void parseChunks(ChunkList& chunks, size_t numDims, char separator);
+
+// Reads text in large blocks and splits each into chunks of whole lines.
+// Text that follows the last newline of a block is kept for the next one.
+class LineReader
+{
+public:
+    LineReader(std::istream& in) : m_in(in), m_size(0), m_used(0),
+        m_eof(false)
+    {}
+
+    // Read the next block of text and split it into chunks.  The chunks
+    // remain valid until the next call.
+    // \return  False if there's no more text.
+    bool next(ChunkList& chunks);
+
+private:
+    std::istream& m_in;
+    std::vector<char> m_buf;
+    size_t m_size;
+    size_t m_used;
+    bool m_eof;
+};
+
+} // namespace textparse
+} // namespace pdal
@@ -0,0 +1,376 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include "BenchmarkKernel.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <sstream>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+#include <pdal/PDALUtils.hpp>
+#include <pdal/Stage.hpp>
+#include <pdal/pdal_config.hpp>
+#include <pdal/util/FileUtils.hpp>
+
+namespace pdal
+{
+
+static StaticPluginInfo const s_info
+{
+    "kernels.benchmark",
+    "Benchmark Kernel",
+    "http://pdal.io/apps/benchmark.html"
+};
+
+CREATE_STATIC_KERNEL(BenchmarkKernel, s_info)
+
+std::string BenchmarkKernel::getName() const { return s_info.name; }
+
+namespace
+{
+
+// Nearest-rank percentile of a sorted list.
+double percentile(const std::vector<double>& sorted, double pct)
+{
+    if (sorted.empty())
+        return 0;
+    size_t rank = (size_t)std::ceil(pct / 100 * sorted.size());
+    if (rank > 0)
+        rank--;
+    return sorted[(std::min)(rank, sorted.size() - 1)];
+}
+
+
+NL::json summarize(std::vector<double> vals)
+{
+    std::sort(vals.begin(), vals.end());
+
+    NL::json j;
+    j["min"] = vals.empty() ? 0 : vals.front();
+    j["max"] = vals.empty() ? 0 : vals.back();
+    j["mean"] = vals.empty() ? 0 :
+        std::accumulate(vals.begin(), vals.end(), 0.0) / vals.size();
+    j["p50"] = percentile(vals, 50);
+    j["p90"] = percentile(vals, 90);
+    j["p99"] = percentile(vals, 99);
+    return j;
+}
+
+
+std::string modeName(ExecMode mode)
+{
+    return mode == ExecMode::Stream ? "stream" : "standard";
+}
+
+} // unnamed namespace
+
+
+BenchmarkKernel::BenchmarkKernel() : m_count(0), m_runs(0), m_warmup(0),
+    m_threads(0)
+{}
+
+
+void BenchmarkKernel::addSwitches(ProgramArgs& args)
+{
+    args.add("input,i", "Pipeline to benchmark.  If not provided, a canned "
+        "pipeline is run over generated data.", m_inputFile).
+        setOptionalPositional();
+    args.add("canned", "Canned pipeline to run when no input is provided "
+        "('read', 'filter' or 'las')", m_canned, "filter");
+    args.add("count", "Number of points generated for canned pipelines",
+        m_count, (point_count_t)1000000);
+    args.add("distribution", "Distribution of generated points "
+        "(uniform / normal / ramp)", m_distribution, "uniform");
+    args.add("mode", "Execution mode ('standard', 'stream' or 'both')",
+        m_mode, "both");
+    args.add("runs,n", "Number of timed runs in each mode", m_runs, 5);
+    args.add("warmup", "Number of untimed runs in each mode before timing",
+        m_warmup, 1);
+    args.add("threads", "Number of threads used to run the pipeline",
+        m_threads);
+    args.add("output,o", "Filename for the JSON report.  Written to "
+        "standard output if not provided.", m_outputFile);
+    args.add("scratch", "File written by the 'las' canned pipeline",
+        m_scratchFile, "pdal_benchmark.las");
+}
+
+
+void BenchmarkKernel::validateSwitches(ProgramArgs& args)
+{
+    if (m_runs < 1)
+        throw pdal_error("Option 'runs' must be at least 1.");
+    if (m_warmup < 0)
+        throw pdal_error("Option 'warmup' can't be negative.");
+    m_mode = Utils::tolower(m_mode);
+    if (m_mode != "standard" && m_mode != "stream" && m_mode != "both")
+        throw pdal_error("Invalid mode '" + m_mode + "'.  Must be 'standard', "
+            "'stream' or 'both'.");
+    m_canned = Utils::tolower(m_canned);
+    if (m_canned != "read" && m_canned != "filter" && m_canned != "las")
+        throw pdal_error("Invalid canned pipeline '" + m_canned + "'.  Must "
+            "be 'read', 'filter' or 'las'.");
+    m_distribution = Utils::tolower(m_distribution);
+    if (m_distribution != "uniform" && m_distribution != "normal" &&
+        m_distribution != "ramp")
+        throw pdal_error("Invalid distribution '" + m_distribution + "'.  "
+            "Must be 'uniform', 'normal' or 'ramp'.");
+}
+
+
+// Generated data is seeded so that every run, and every release, sees
+// the same points.
+std::string BenchmarkKernel::cannedPipeline() const
+{
+    NL::json reader;
+    reader["type"] = "readers.faux";
+    reader["count"] = m_count;
+    reader["mode"] = m_distribution;
+    reader["seed"] = 42;
+    reader["number_of_returns"] = 3;
+    if (m_distribution == "normal")
+    {
+        reader["mean_x"] = 500;
+        reader["mean_y"] = 500;
+        reader["mean_z"] = 50;
+        reader["stdev_x"] = 100;
+        reader["stdev_y"] = 100;
+        reader["stdev_z"] = 10;
+    }
+    else
+        reader["bounds"] = "([0, 1000], [0, 1000], [0, 100])";
+
+    NL::json pipeline = NL::json::array();
+    pipeline.push_back(reader);
+    if (m_canned == "filter")
+    {
+        pipeline.push_back({ {"type", "filters.range"},
+            {"limits", "Z[0:50]"} });
+        pipeline.push_back({ {"type", "filters.transformation"},
+            {"matrix", "1 0 0 100  0 1 0 100  0 0 1 0  0 0 0 1"} });
+    }
+    if (m_canned == "las")
+        pipeline.push_back({ {"type", "writers.las"},
+            {"filename", m_scratchFile},
+            {"scale_x", .01}, {"scale_y", .01}, {"scale_z", .01} });
+    else
+        pipeline.push_back({ {"type", "writers.null"} });
+    return pipeline.dump();
+}
+
+
+BenchmarkKernel::Run BenchmarkKernel::runOnce(const std::string& pipeline,
+    ExecMode mode)
+{
+    PipelineManager mgr;
+    mgr.setLog(m_log);
+    mgr.stageOptions() = m_manager.stageOptions();
+
+    std::istringstream in(pipeline);
+    mgr.readPipeline(in);
+    if (m_threads)
+        mgr.setThreads(m_threads);
+    mgr.setProfiling(true);
+
+    Run run;
+    run.m_mode = mgr.execute(mode).m_mode;
+    if (run.m_mode != mode)
+        return run;
+
+    MetadataNode profile = mgr.getProfile();
+    run.m_wall = profile.findChild("wall_time").value<double>();
+    run.m_cpu = profile.findChild("cpu_time").value<double>();
+    run.m_points = profile.findChild("points").value<point_count_t>();
+    for (Stage *s : mgr.stages())
+    {
+        StageProfile *sp = s->profile();
+        if (!sp)
+            continue;
+
+        double cpu = 0;
+        for (auto phase : { StageProfile::Phase::Ready,
+                StageProfile::Phase::Run, StageProfile::Phase::ProcessOne,
+                StageProfile::Phase::Done })
+            cpu += sp->timing(phase).m_cpu;
+        run.m_stages.push_back({ s->getName(), s->tag(), sp->wallTime(),
+            cpu, sp->pointsIn(), sp->pointsOut(), sp->peakMemory() });
+    }
+    return run;
+}
+
+
+NL::json BenchmarkKernel::benchmark(const std::string& pipeline,
+    ExecMode mode)
+{
+    NL::json result;
+    result["mode"] = modeName(mode);
+
+    for (int i = 0; i < m_warmup; ++i)
+        if (runOnce(pipeline, mode).m_mode != mode)
+        {
+            result["executed"] = false;
+            return result;
+        }
+
+    std::vector<Run> runs;
+    for (int i = 0; i < m_runs; ++i)
+    {
+        runs.push_back(runOnce(pipeline, mode));
+        if (runs.back().m_mode != mode)
+        {
+            result["executed"] = false;
+            return result;
+        }
+    }
+    result["executed"] = true;
+    result["points"] = runs.front().m_points;
+
+    std::vector<double> wall;
+    std::vector<double> cpu;
+    std::vector<double> rate;
+    for (const Run& r : runs)
+    {
+        wall.push_back(r.m_wall);
+        cpu.push_back(r.m_cpu);
+        rate.push_back(r.m_wall > 0 ? r.m_points / r.m_wall : 0.0);
+    }
+    result["wall_time"] = summarize(wall);
+    result["cpu_time"] = summarize(cpu);
+    result["points_per_second"] = summarize(rate);
+    result["run_wall_times"] = wall;
+    // The process' high-water mark, including any earlier runs.
+    result["peak_rss"] = peakRss();
+
+    NL::json stages = NL::json::array();
+    for (size_t i = 0; i < runs.front().m_stages.size(); ++i)
+    {
+        const StageRun& first = runs.front().m_stages[i];
+        std::vector<double> stageWall;
+        std::vector<double> stageCpu;
+        std::size_t peak = 0;
+        for (const Run& r : runs)
+        {
+            stageWall.push_back(r.m_stages[i].m_wall);
+            stageCpu.push_back(r.m_stages[i].m_cpu);
+            peak = (std::max)(peak, r.m_stages[i].m_peakMemory);
+        }
+
+        NL::json stage;
+        stage["name"] = first.m_name;
+        stage["tag"] = first.m_tag;
+        stage["wall_time"] = summarize(stageWall);
+        stage["cpu_time"] = summarize(stageCpu);
+        stage["points_in"] = first.m_pointsIn;
+        stage["points_out"] = first.m_pointsOut;
+        stage["peak_table_memory"] = peak;
+        stages.push_back(stage);
+    }
+    result["stages"] = stages;
+    return result;
+}
+
+
+int BenchmarkKernel::execute()
+{
+    std::string pipeline;
+    NL::json root;
+    if (m_inputFile.size())
+    {
+        if (!FileUtils::fileExists(m_inputFile))
+            throw pdal_error("file not found: " + m_inputFile);
+        pipeline = FileUtils::readFileIntoString(m_inputFile);
+        root["pipeline"] = m_inputFile;
+    }
+    else
+    {
+        pipeline = cannedPipeline();
+        root["pipeline"] = m_canned;
+        root["count"] = m_count;
+        root["distribution"] = m_distribution;
+    }
+    root["runs"] = m_runs;
+    root["warmup"] = m_warmup;
+    root["threads"] = m_threads;
+    root["pdal_version"] = Config::fullVersionString();
+
+    // Stream mode runs first since it normally uses less memory and peak
+    // RSS never decreases.
+    NL::json modes = NL::json::array();
+    if (m_mode == "stream" || m_mode == "both")
+        modes.push_back(benchmark(pipeline, ExecMode::Stream));
+    if (m_mode == "standard" || m_mode == "both")
+        modes.push_back(benchmark(pipeline, ExecMode::Standard));
+    root["modes"] = modes;
+
+    if (m_inputFile.empty() && m_canned == "las")
+        FileUtils::deleteFile(m_scratchFile);
+
+    if (m_outputFile.empty())
+        std::cout << root.dump(4) << "\n";
+    else
+    {
+        std::ostream *out = Utils::createFile(m_outputFile, false);
+        if (!out)
+            throw pdal_error("Can't open file '" + m_outputFile +
+                "' for benchmark output.");
+        *out << root.dump(4) << "\n";
+        Utils::closeFile(out);
+    }
+    return 0;
+}
+
+
+// Peak resident set size of the process in bytes, or 0 if it isn't
+// available.
+std::size_t BenchmarkKernel::peakRss()
+{
+#ifdef _WIN32
+    return 0;
+#else
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#ifdef __APPLE__
+    return (std::size_t)usage.ru_maxrss;
+#else
+    return (std::size_t)usage.ru_maxrss * 1024;
+#endif
+#endif
+}
+
+} // namespace pdal
@@ -0,0 +1,95 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <pdal/Kernel.hpp>
+#include <pdal/PipelineManager.hpp>
+
+#include <nlohmann/json.hpp>
+
+namespace pdal
+{
+
+class PDAL_DLL BenchmarkKernel : public Kernel
+{
+public:
+    BenchmarkKernel();
+    std::string getName() const;
+    int execute();
+
+private:
+    struct StageRun
+    {
+        std::string m_name;
+        std::string m_tag;
+        double m_wall;
+        double m_cpu;
+        point_count_t m_pointsIn;
+        point_count_t m_pointsOut;
+        std::size_t m_peakMemory;
+    };
+
+    struct Run
+    {
+        Run() : m_mode(ExecMode::None), m_wall(0), m_cpu(0), m_points(0)
+        {}
+
+        ExecMode m_mode;
+        double m_wall;
+        double m_cpu;
+        point_count_t m_points;
+        std::vector<StageRun> m_stages;
+    };
+
+    void addSwitches(ProgramArgs& args);
+    void validateSwitches(ProgramArgs& args);
+    std::string cannedPipeline() const;
+    NL::json benchmark(const std::string& pipeline, ExecMode mode);
+    Run runOnce(const std::string& pipeline, ExecMode mode);
+    static std::size_t peakRss();
+
+    std::string m_inputFile;
+    std::string m_canned;
+    point_count_t m_count;
+    std::string m_distribution;
+    std::string m_mode;
+    int m_runs;
+    int m_warmup;
+    std::size_t m_threads;
+    std::string m_outputFile;
+    std::string m_scratchFile;
+};
+
+} // namespace pdal
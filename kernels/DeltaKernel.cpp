@@ -36,6 +36,7 @@
 
 #include <pdal/Stage.hpp>
 #include <pdal/PDALUtils.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
 namespace pdal
 {
@@ -51,7 +52,8 @@ CREATE_STATIC_KERNEL(DeltaKernel, s_info)
 
 std::string DeltaKernel::getName() const { return s_info.name; }
 
-DeltaKernel::DeltaKernel() : m_detail(false), m_allDims(false)
+DeltaKernel::DeltaKernel() : m_detail(false), m_allDims(false),
+    m_threads(1)
 {}
 
 
@@ -65,6 +67,8 @@ void DeltaKernel::addSwitches(ProgramArgs& args)
     args.add("detail", "Output deltas per-point", m_detail);
     args.add("alldims", "Compute diffs for all dimensions (not just X,Y,Z)",
         m_allDims);
+    args.add("threads", "Number of threads used to find nearest neighbors",
+        m_threads, (size_t)1);
 }
 
 
@@ -81,6 +85,9 @@ PointViewPtr DeltaKernel::loadSet(const std::string& filename,
 
 int DeltaKernel::execute()
 {
+    if (m_threads < 1)
+        throw pdal_error("Option 'threads' must be at least 1.");
+
     PointTable srcTable;
     PointTable candTable;
     DimIndexMap dims;
@@ -140,27 +147,71 @@ int DeltaKernel::execute()
 }
 
 
+// Split the source points into chunks that can be processed in parallel.
+std::size_t DeltaKernel::numChunks(point_count_t count) const
+{
+    std::size_t chunks = (m_threads > 1) ? m_threads * 4 : 1;
+    return (std::max)((point_count_t)1, (std::min)((point_count_t)chunks,
+        count));
+}
+
+
+void DeltaKernel::runChunks(std::size_t numChunks,
+    const std::function<void(std::size_t)>& f)
+{
+    if (m_threads > 1 && numChunks > 1)
+    {
+        ThreadPool pool(m_threads, -1, false);
+        for (std::size_t c = 0; c < numChunks; ++c)
+            pool.add([&f, c](){ f(c); });
+        pool.join();
+        if (pool.errors().size())
+            throw pdal_error(pool.errors().front());
+    }
+    else
+    {
+        for (std::size_t c = 0; c < numChunks; ++c)
+            f(c);
+    }
+}
+
+
 MetadataNode DeltaKernel::dump(PointViewPtr& srcView, PointViewPtr& candView,
     KD3Index& index, DimIndexMap& dims)
 {
     MetadataNode root;
 
-    for (PointId id = 0; id < srcView->size(); ++id)
+    // Each chunk accumulates into its own copy of the statistics, which
+    // are merged once all the points have been processed.
+    const point_count_t count = srcView->size();
+    const std::size_t chunks = numChunks(count);
+    std::vector<DimIndexMap> chunkDims(chunks, dims);
+    runChunks(chunks, [&](std::size_t c)
     {
-        PointRef point = srcView->point(id);
-        PointId candId = index.neighbor(point);
-
-        // It may be faster to put in a special case to avoid having to
-        // fetch X, Y and Z, more than once but this is simpler and
-        // I'm thinking in most cases it will make no practical difference.
-        for (auto di = dims.begin(); di != dims.end(); ++di)
+        DimIndexMap& cdims = chunkDims[c];
+        const PointId first = count * c / chunks;
+        const PointId last = count * (c + 1) / chunks;
+        for (PointId id = first; id < last; ++id)
         {
-            DimIndex& d = di->second;
-            double sv = srcView->getFieldAs<double>(d.m_srcId, id);
-            double cv = candView->getFieldAs<double>(d.m_candId, candId);
-            accumulate(d, sv - cv);
+            PointRef point = srcView->point(id);
+            PointId candId = index.neighbor(point);
+
+            // It may be faster to put in a special case to avoid having to
+            // fetch X, Y and Z, more than once but this is simpler and
+            // I'm thinking in most cases it will make no practical
+            // difference.
+            for (auto di = cdims.begin(); di != cdims.end(); ++di)
+            {
+                DimIndex& d = di->second;
+                double sv = srcView->getFieldAs<double>(d.m_srcId, id);
+                double cv = candView->getFieldAs<double>(d.m_candId, candId);
+                accumulate(d, sv - cv);
+            }
         }
-    }
+    });
+    for (DimIndexMap& cdims : chunkDims)
+        for (auto& dpair : cdims)
+            merge(dims[dpair.first], dpair.second);
 
     root.add("source", m_sourceFile);
     root.add("candidate", m_candidateFile);
@@ -186,15 +237,41 @@ void DeltaKernel::accumulate(DimIndex& d, double v)
 }
 
 
+void DeltaKernel::merge(DimIndex& d, const DimIndex& other)
+{
+    if (!other.m_cnt)
+        return;
+    point_count_t cnt = d.m_cnt + other.m_cnt;
+    d.m_min = std::min(other.m_min, d.m_min);
+    d.m_max = std::max(other.m_max, d.m_max);
+    d.m_avg += (other.m_avg - d.m_avg) * other.m_cnt / cnt;
+    d.m_cnt = cnt;
+}
+
+
 MetadataNode DeltaKernel::dumpDetail(PointViewPtr& srcView,
     PointViewPtr& candView, KD3Index& index, DimIndexMap& dims)
 {
     MetadataNode root;
 
-    for (PointId id = 0; id < srcView->size(); ++id)
+    // Find the neighbors in parallel.  The output is written in point
+    // order.
+    const point_count_t count = srcView->size();
+    const std::size_t chunks = numChunks(count);
+    PointIdList candIds(count);
+    runChunks(chunks, [&](std::size_t c)
+    {
+        const PointId last = count * (c + 1) / chunks;
+        for (PointId id = count * c / chunks; id < last; ++id)
+        {
+            PointRef point = srcView->point(id);
+            candIds[id] = index.neighbor(point);
+        }
+    });
+
+    for (PointId id = 0; id < count; ++id)
     {
-        PointRef point = srcView->point(id);
-        PointId candId = index.neighbor(point);
+        PointId candId = candIds[id];
 
         MetadataNode delta = root.add("delta");
         delta.add("i", id);
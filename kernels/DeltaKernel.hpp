@@ -34,6 +34,7 @@
 
 #pragma once
 
+#include <functional>
 #include <map>
 
 #include <pdal/KDIndex.hpp>
@@ -77,6 +78,10 @@ private:
     MetadataNode dumpDetail(PointViewPtr& srcView, PointViewPtr& candView,
         KD3Index& index, DimIndexMap& dims);
     void accumulate(DimIndex& d, double v);
+    void merge(DimIndex& d, const DimIndex& other);
+    std::size_t numChunks(point_count_t count) const;
+    void runChunks(std::size_t numChunks,
+        const std::function<void(std::size_t)>& f);
 
     std::string m_sourceFile;
     std::string m_candidateFile;
@@ -87,6 +92,7 @@ private:
 
     bool m_detail;
     bool m_allDims;
+    std::size_t m_threads;
 };
 
 } // namespace pdal
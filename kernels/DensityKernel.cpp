@@ -34,11 +34,17 @@
 
 #include "DensityKernel.hpp"
 
+#include <cmath>
+#include <mutex>
+
 #include "../filters/HexBinFilter.hpp"
+#include "../filters/StreamCallbackFilter.hpp"
+#include "../filters/private/hexer/HexGrid.hpp"
 #include "private/density/OGR.hpp"
 
 #include <pdal/GDALUtils.hpp>
 #include <pdal/util/FileUtils.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
 namespace pdal
 {
@@ -56,8 +62,8 @@ std::string DensityKernel::getName() const { return s_info.name; }
 
 void DensityKernel::addSwitches(ProgramArgs& args)
 {
-    args.add("input,i", "input point cloud file name", m_inputFile).
-        setPositional();
+    args.add("input,i", "input point cloud file name or glob pattern",
+        m_inputFile).setPositional();
     args.add("output,o", "output vector data source", m_outputFile).
         setPositional();
     args.add("ogrdriver,f", "OGR driver name to use ", m_driverName,
@@ -70,6 +76,8 @@ void DensityKernel::addSwitches(ProgramArgs& args)
     args.add("hole_cull_area_tolerance", "Tolerance area to "
             "apply to holes before cull", m_cullArea);
     args.add("smooth", "Smooth boundary output", m_doSmooth, true);
+    args.add("threads", "Number of input files to read concurrently",
+        m_threads, (size_t)1);
 }
 
 
@@ -79,33 +87,147 @@ void DensityKernel::outputDensity(pdal::SpatialReference const& reference)
     if (!hexbin)
         throw pdal::pdal_error("unable to fetch filters.hexbin stage!");
 
-    hexer::HexGrid* grid = hexbin->grid();
+    outputDensity(hexbin->grid(), reference);
+}
+
 
+void DensityKernel::outputDensity(hexer::HexGrid *grid,
+    pdal::SpatialReference const& reference)
+{
     OGR writer(m_outputFile, reference.getWKT(), m_driverName, m_layerName);
     writer.writeDensity(grid);
 }
 
 
-int DensityKernel::execute()
+// Pass the X/Y position of the points of a file to a function, reading
+// at most 'count' points if it's non-zero.  Points are streamed when the
+// reader supports it.  Returns the SRS of the file.
+SpatialReference DensityKernel::readFile(const std::string& filename,
+    point_count_t count, std::function<void(double, double)> f)
 {
-    gdal::registerDrivers();
+    PipelineManager manager;
+    manager.setLog(m_log);
+    manager.commonOptions() = m_manager.commonOptions();
+    manager.stageOptions() = m_manager.stageOptions();
+
+    Stage& reader = manager.makeReader(filename, "");
+    if (count)
+    {
+        Options opts;
+        opts.add("count", count);
+        reader.addOptions(opts);
+    }
+
+    if (reader.pipelineStreamable())
+    {
+        StreamCallbackFilter cb;
+        cb.setInput(reader);
+        cb.setCallback([&f](PointRef& point)
+        {
+            f(point.getFieldAs<double>(Dimension::Id::X),
+                point.getFieldAs<double>(Dimension::Id::Y));
+            return true;
+        });
+
+        FixedPointTable table(10000);
+        cb.prepare(table);
+        cb.execute(table);
+        return table.anySpatialReference();
+    }
 
-    if (m_inputFile == "STDIN" ||
-        (FileUtils::extension(m_inputFile) == ".xml" ||
-        FileUtils::extension(m_inputFile) == ".json"))
+    PointTable table;
+    reader.prepare(table);
+    for (const PointViewPtr& view : reader.execute(table))
+        for (PointId idx = 0; idx < view->size(); ++idx)
+            f(view->getFieldAs<double>(Dimension::Id::X, idx),
+                view->getFieldAs<double>(Dimension::Id::Y, idx));
+    return table.anySpatialReference();
+}
+
+
+// Bin the points of a set of files into a single hexagon grid.  The grid
+// size and origin are fixed from a sample of the first file, after which
+// each file is binned by a separate task into its own counts, which are
+// merged into the grid as the tasks finish.
+void DensityKernel::executeFiles(const StringList& files)
+{
+    std::vector<hexer::Point> sample;
+    const point_count_t sampleSize = (m_edgeLength == 0.0) ?
+        (std::max)(m_sampleSize, 1U) : 1;
+    SpatialReference srs = readFile(files.front(), sampleSize,
+        [&sample](double x, double y){ sample.emplace_back(x, y); });
+    if (sample.empty())
+        throw pdal_error("No points in input file '" + files.front() + "'.");
+
+    double height;
+    if (m_edgeLength == 0.0)
     {
-        m_manager.readPipeline(m_inputFile);
+        hexer::HexGrid sampleGrid(m_density);
+        sampleGrid.setSampleSize((unsigned)sample.size());
+        for (const hexer::Point& p : sample)
+            sampleGrid.addPoint(p);
+        sampleGrid.processSample();
+        height = sampleGrid.height();
     }
     else
+        height = m_edgeLength * sqrt(3);
+
+    hexer::HexGrid grid(height, m_density);
+    grid.setOrigin(sample.front());
+
+    std::mutex mutex;
+    ThreadPool pool(m_threads, -1, false);
+    for (const std::string& filename : files)
+        pool.add([this, &filename, &grid, &mutex]()
+        {
+            hexer::HexGrid::HexCounts counts;
+            readFile(filename, 0, [&grid, &counts](double x, double y)
+                { grid.binPoint(hexer::Point(x, y), counts); });
+
+            std::lock_guard<std::mutex> lock(mutex);
+            grid.addCounts(counts);
+            m_log->get(LogLevel::Info) << "Binned file '" << filename <<
+                "'." << std::endl;
+        });
+    pool.join();
+    if (pool.errors().size())
+        throw pdal_error(pool.errors().front());
+
+    outputDensity(&grid, srs);
+}
+
+
+int DensityKernel::execute()
+{
+    gdal::registerDrivers();
+
+    if (m_threads < 1)
+        throw pdal_error("Option 'threads' must be at least 1.");
+
+    if (m_inputFile != "STDIN" &&
+        FileUtils::extension(m_inputFile) != ".xml" &&
+        FileUtils::extension(m_inputFile) != ".json")
     {
-        m_manager.makeReader(m_inputFile, "");
+        StringList files { m_inputFile };
+        if (m_inputFile.find_first_of("*?") != std::string::npos)
+        {
+            files = FileUtils::glob(m_inputFile);
+            if (files.empty())
+                throw pdal_error("No input files match '" + m_inputFile +
+                    "'.");
+        }
+        executeFiles(files);
+        return 0;
     }
+
+    m_manager.readPipeline(m_inputFile);
     Options options;
     options.add("sample_size", m_sampleSize);
     options.add("threshold", m_density);
     options.add("edge_length", m_edgeLength);
     options.add("hole_cull_area_tolerance", m_cullArea);
     options.add("smooth", m_doSmooth);
+    options.add("threads", m_threads);
     m_hexbinStage = &(m_manager.makeFilter("filters.hexbin",
         *m_manager.getStage(), options));
     m_manager.execute();
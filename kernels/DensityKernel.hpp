@@ -35,9 +35,15 @@
 #pragma once
 
 
+#include <functional>
+
 #include <pdal/Kernel.hpp>
 #include <pdal/PipelineManager.hpp>
 
+namespace hexer
+{
+    class HexGrid;
+}
 
 namespace pdal
 {
@@ -59,9 +65,15 @@ private:
     double m_edgeLength;
     double m_cullArea;
     bool m_doSmooth;
+    size_t m_threads;
 
     virtual void addSwitches(ProgramArgs& args);
     void outputDensity(pdal::SpatialReference const& ref);
+    void outputDensity(hexer::HexGrid *grid,
+        pdal::SpatialReference const& ref);
+    void executeFiles(const StringList& files);
+    SpatialReference readFile(const std::string& filename,
+        point_count_t count, std::function<void(double, double)> f);
 };
 
 } // namespace pdal
@@ -0,0 +1,531 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include "DispatchKernel.hpp"
+
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <thread>
+
+#include <arbiter/arbiter.hpp>
+#include <nlohmann/json.hpp>
+
+#include <pdal/PDALUtils.hpp>
+#include <pdal/PipelineWriter.hpp>
+#include <pdal/Writer.hpp>
+#include <pdal/util/FileUtils.hpp>
+
+#include "private/TileIndexQuery.hpp"
+#include "private/WorkerProcess.hpp"
+
+namespace pdal
+{
+
+static StaticPluginInfo const s_info
+{
+    "kernels.dispatch",
+    "Dispatch Kernel",
+    "http://pdal.io/apps/dispatch.html"
+};
+
+CREATE_STATIC_KERNEL(DispatchKernel, s_info)
+
+std::string DispatchKernel::getName() const
+{
+    return s_info.name;
+}
+
+namespace
+{
+
+// Stage tag of the range filter added before the writer to trim the
+// buffer from each unit's output.
+const std::string TrimTag = "dispatch_trim";
+
+// Write a number so that it reads back as the same double.
+std::string exact(double d)
+{
+    std::ostringstream oss;
+    oss.precision(std::numeric_limits<double>::max_digits10);
+    oss << d;
+    return oss.str();
+}
+
+// The options of a stage as set in the pipeline.
+Options stageOptions(const Stage& stage)
+{
+    PipelineWriter::TagMap tags { { &stage, stage.tag() } };
+    MetadataNode root;
+    stage.serialize(root, tags);
+
+    Options options;
+    for (const MetadataNode& n : root.findChild("pipeline").children())
+        if (n.name() != "type" && n.name() != "tag")
+            options.add(n.name(), n.value());
+    return options;
+}
+
+// A string that changes when a file changes, or an empty string if the
+// file isn't local.
+std::string fileIdentity(const std::string& filename)
+{
+    if (Utils::isRemote(filename) || !FileUtils::fileExists(filename))
+        return std::string();
+    return std::to_string(FileUtils::fileSize(filename)) + " " +
+        std::to_string(FileUtils::lastWriteTime(filename));
+}
+
+} // unnamed namespace
+
+
+DispatchKernel::DispatchKernel() : m_length(0), m_buffer(0), m_retries(2),
+    m_incremental(false), m_hashPos(std::string::npos), m_total(0),
+    m_done(0), m_failed(0), m_running(0)
+{}
+
+
+void DispatchKernel::addSwitches(ProgramArgs& args)
+{
+    args.add("pipeline,p", "Pipeline filename", m_pipelineFile).
+        setPositional();
+    args.add("output,o", "Output filename template.  The '#' is replaced "
+        "with the column and row of each cell", m_outputFile).
+        setPositional();
+    args.add("worker", "Command that starts a worker, such as "
+        "'ssh node1 pdal serve'.  The filename of the pipeline run by the "
+        "workers is appended.  Repeat to start more workers",
+        m_workers, StringList({ "pdal serve" }));
+    args.add("length", "Edge length of the cells into which the extent is "
+        "divided", m_length);
+    args.add("buffer", "Size of the buffer read around each cell",
+        m_buffer);
+    args.add("origin_x", "Origin in X axis for cells", m_xOrigin,
+        std::numeric_limits<double>::quiet_NaN());
+    args.add("origin_y", "Origin in Y axis for cells", m_yOrigin,
+        std::numeric_limits<double>::quiet_NaN());
+    args.add("bounds", "Extent to process.  Defaults to the extent of the "
+        "pipeline's readers", m_bounds);
+    args.add("retries", "Number of times a failed cell is run again",
+        m_retries, 2);
+    args.add("work_pipeline", "Filename of the pipeline written for the "
+        "workers.  Must be readable by all workers.  Defaults to the "
+        "pipeline filename with '.dispatch.json' appended",
+        m_workPipelineFile);
+    args.add("incremental", "Only run the cells whose inputs, job or "
+        "pipeline changed since they last succeeded, or whose output is "
+        "missing", m_incremental);
+    args.add("state", "File in which the inputs of the cells that succeed "
+        "are recorded.  Defaults to the pipeline filename with "
+        "'.dispatch.state' appended", m_stateFile);
+}
+
+
+void DispatchKernel::validateSwitches(ProgramArgs&)
+{
+    m_hashPos = Writer::handleFilenameTemplate(m_outputFile);
+    if (m_hashPos == std::string::npos)
+        throw pdal_error("Output filename must contain a single '#' "
+            "template placeholder.");
+    if (m_length <= 0)
+        throw pdal_error("Option 'length' must be positive.");
+    if (m_buffer < 0)
+        throw pdal_error("Option 'buffer' can't be negative.");
+    if (m_retries < 0)
+        throw pdal_error("Option 'retries' can't be negative.");
+    if (m_workers.empty())
+        throw pdal_error("At least one 'worker' must be given.");
+    if (m_workPipelineFile.empty())
+        m_workPipelineFile = m_pipelineFile + ".dispatch.json";
+    if (m_stateFile.empty())
+        m_stateFile = m_pipelineFile + ".dispatch.state";
+}
+
+
+// Each cell is sent as a 'pdal serve' job to the first free worker, with
+// one job outstanding per worker so that faster workers take more cells.
+// The result of each cell is written to standard output as a line of JSON
+// once the cell is done or has failed every attempt.
+int DispatchKernel::execute()
+{
+    if (!FileUtils::fileExists(m_pipelineFile))
+        throw pdal_error("file not found: " + m_pipelineFile);
+    preparePipeline();
+    makeUnits();
+    readState();
+    if (m_incremental)
+        skipUnchanged();
+
+    m_log->get(LogLevel::Info) << "Dispatching " << m_total << " cells to " <<
+        m_workers.size() << " workers." << std::endl;
+    std::vector<std::thread> threads;
+    for (size_t w = 0; w < m_workers.size(); ++w)
+        threads.emplace_back(&DispatchKernel::runWorker, this, w);
+    for (std::thread& t : threads)
+        t.join();
+
+    // Cells that remain were left by workers that failed.
+    for (Unit& unit : m_units)
+    {
+        NL::json result;
+        result["id"] = unit.m_id;
+        result["status"] = "error";
+        result["error"] = "No worker was available.";
+        result["attempts"] = unit.m_attempts;
+        std::cout << result.dump() << std::endl;
+        m_failed++;
+    }
+    writeState();
+
+    if (m_failed)
+    {
+        m_log->get(LogLevel::Error) << m_failed << " of " << m_total <<
+            " cells failed." << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+
+// Write the pipeline that the workers run: the user's pipeline with a
+// range filter before the writer that keeps only the points of a cell.
+// Each job sets the bounds of the readers, the filter's limits and the
+// writer's filename.
+void DispatchKernel::preparePipeline()
+{
+    m_manager.readPipeline(m_pipelineFile);
+
+    if (m_manager.leaves().size() != 1)
+        throw pdal_error("Pipeline must end with a single writer.");
+    Stage *writer = m_manager.getStage();
+    if (!dynamic_cast<Writer *>(writer))
+        throw pdal_error("Pipeline must end with a writer.");
+    if (writer->tag().empty())
+        writer->setTag("dispatch_writer");
+    m_writerTag = writer->tag();
+
+    BOX2D extent;
+    for (Stage *reader : m_manager.roots())
+    {
+        const std::string name = reader->getName();
+        if (name != "readers.ept" && name != "readers.copc" &&
+                name != "readers.tindex")
+            throw pdal_error("Can't dispatch pipeline with reader '" + name +
+                "'.  Readers must be readers.ept, readers.copc or "
+                "readers.tindex.");
+        if (reader->tag().empty())
+            reader->setTag("dispatch_reader" +
+                std::to_string(m_readerTags.size() + 1));
+        m_readerTags.push_back(reader->tag());
+
+        if (m_bounds.empty())
+        {
+            QuickInfo qi = reader->preview();
+            if (!qi.valid() || qi.m_bounds.empty())
+                throw pdal_error("Can't determine the extent of '" +
+                    reader->tag() + "'.  Use option 'bounds'.");
+            extent.grow(qi.m_bounds.to2d());
+        }
+    }
+    if (m_bounds.empty())
+        m_bounds = extent;
+
+    Stage& trim = m_manager.addFilter("filters.range");
+    trim.setTag(TrimTag);
+    trim.getInputs() = writer->getInputs();
+    writer->getInputs().clear();
+    writer->setInput(trim);
+
+    PipelineWriter::writePipeline(writer, m_workPipelineFile);
+}
+
+
+// Divide the extent into cells.  A cell's readers read the cell and the
+// buffer around it, so that filters that look at neighboring points see
+// the same neighbors at the edges of cells as elsewhere, and the buffer is
+// trimmed before points are written.  Cells include their lower edges but
+// not their upper edges, so every point is written by exactly one cell.
+// A cell depends on the member files of tile indexes that intersect it,
+// including its buffer, and on the whole of other datasets.
+void DispatchKernel::makeUnits()
+{
+    std::vector<std::unique_ptr<TileIndexQuery>> indexes;
+    NL::json datasets = NL::json::object();
+    for (Stage *reader : m_manager.roots())
+    {
+        Options options = stageOptions(*reader);
+        if (reader->getName() == "readers.tindex")
+            indexes.emplace_back(new TileIndexQuery(options));
+        else
+            for (const std::string& f : options.getValues("filename"))
+                datasets[f] = fileIdentity(f);
+    }
+    const std::string pipeline =
+        FileUtils::readFileIntoString(m_workPipelineFile);
+
+    const double xOrigin = std::isnan(m_xOrigin) ? m_bounds.minx : m_xOrigin;
+    const double yOrigin = std::isnan(m_yOrigin) ? m_bounds.miny : m_yOrigin;
+    const int64_t col0 = (int64_t)std::floor((m_bounds.minx - xOrigin) /
+        m_length);
+    const int64_t col1 = (int64_t)std::floor((m_bounds.maxx - xOrigin) /
+        m_length);
+    const int64_t row0 = (int64_t)std::floor((m_bounds.miny - yOrigin) /
+        m_length);
+    const int64_t row1 = (int64_t)std::floor((m_bounds.maxy - yOrigin) /
+        m_length);
+
+    for (int64_t row = row0; row <= row1; ++row)
+        for (int64_t col = col0; col <= col1; ++col)
+        {
+            const double x0 = xOrigin + col * m_length;
+            const double x1 = xOrigin + (col + 1) * m_length;
+            const double y0 = yOrigin + row * m_length;
+            const double y1 = yOrigin + (row + 1) * m_length;
+
+            Unit unit;
+            unit.m_id = std::to_string(col) + "_" + std::to_string(row);
+            unit.m_output = m_outputFile.substr(0, m_hashPos) + unit.m_id +
+                m_outputFile.substr(m_hashPos + 1);
+            unit.m_attempts = 0;
+
+            NL::json options;
+            const BOX2D buffered(x0 - m_buffer, y0 - m_buffer,
+                x1 + m_buffer, y1 + m_buffer);
+            const std::string bounds = "([" + exact(buffered.minx) + ", " +
+                exact(buffered.maxx) + "], [" + exact(buffered.miny) + ", " +
+                exact(buffered.maxy) + "])";
+            for (const std::string& tag : m_readerTags)
+                options["stage." + tag]["bounds"] = bounds;
+            options["stage." + TrimTag]["limits"] = "X[" + exact(x0) + ":" +
+                exact(x1) + "),Y[" + exact(y0) + ":" + exact(y1) + ")";
+            options["stage." + m_writerTag]["filename"] = unit.m_output;
+
+            NL::json job;
+            job["id"] = unit.m_id;
+            job["options"] = options;
+            unit.m_job = job.dump();
+
+            NL::json inputs(datasets);
+            for (auto& index : indexes)
+                for (auto& tile : index->query(buffered))
+                    inputs[tile.first] = tile.second;
+            bool known = true;
+            for (auto& input : inputs)
+                known = known && input.get<std::string>().size();
+            if (known)
+                unit.m_signature = arbiter::crypto::encodeAsHex(
+                    arbiter::crypto::sha256(pipeline + "\n" + unit.m_job +
+                    "\n" + inputs.dump()));
+            m_units.push_back(unit);
+        }
+    m_total = m_units.size();
+}
+
+
+// Run cells on a worker until none remain.  A worker that exits is
+// started again, but one that exits twice in a row without finishing
+// a cell is given up on.
+void DispatchKernel::runWorker(size_t worker)
+{
+    const std::string command = m_workers[worker] + " \"" +
+        m_workPipelineFile + "\"";
+    std::unique_ptr<WorkerProcess> process;
+    int failures = 0;
+
+    Unit unit;
+    while (nextUnit(unit))
+    {
+        std::string reply;
+        bool replied = false;
+        try
+        {
+            if (!process)
+                process.reset(new WorkerProcess(command));
+            replied = process->request(unit.m_job, reply);
+        }
+        catch (const pdal_error& err)
+        {
+            reply = err.what();
+        }
+        if (replied)
+            failures = 0;
+        else
+        {
+            process.reset();
+            failures++;
+        }
+        finishUnit(unit, replied, reply, worker);
+        if (failures > 1)
+        {
+            m_log->get(LogLevel::Error) << "Worker " << worker << " ('" <<
+                m_workers[worker] << "') failed.  Not using it again." <<
+                std::endl;
+            break;
+        }
+    }
+}
+
+
+// Take the next cell to run.  When there are none but cells are running,
+// wait, since a cell that fails is queued again.
+bool DispatchKernel::nextUnit(Unit& unit)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cv.wait(lock, [this](){ return m_units.size() || !m_running; });
+    if (m_units.empty())
+        return false;
+    unit = m_units.front();
+    m_units.pop_front();
+    m_running++;
+    return true;
+}
+
+
+void DispatchKernel::readState()
+{
+    if (!FileUtils::fileExists(m_stateFile))
+        return;
+    try
+    {
+        NL::json state =
+            NL::json::parse(FileUtils::readFileIntoString(m_stateFile));
+        m_state = state.at("cells").get<std::map<std::string, std::string>>();
+    }
+    catch (const NL::json::exception& err)
+    {
+        throw pdal_error("Invalid dispatch state file '" + m_stateFile +
+            "': " + err.what());
+    }
+}
+
+
+void DispatchKernel::writeState()
+{
+    NL::json state;
+    state["cells"] = m_state;
+    std::ostream *out = FileUtils::createFile(m_stateFile, false);
+    if (!out)
+        throw pdal_error("Can't write dispatch state file '" +
+            m_stateFile + "'.");
+    *out << state.dump(1) << std::endl;
+    FileUtils::closeFile(out);
+}
+
+
+// Remove the cells that succeeded with the same signature when last run
+// and whose output still exists.  Outputs that aren't local files can't
+// be checked, so their cells are always run.
+void DispatchKernel::skipUnchanged()
+{
+    size_t unchanged = 0;
+    std::deque<Unit> units;
+    for (Unit& unit : m_units)
+    {
+        auto it = m_state.find(unit.m_id);
+        if (unit.m_signature.size() && it != m_state.end() &&
+                it->second == unit.m_signature &&
+                FileUtils::fileExists(unit.m_output))
+        {
+            NL::json result;
+            result["id"] = unit.m_id;
+            result["status"] = "unchanged";
+            std::cout << result.dump() << std::endl;
+            unchanged++;
+        }
+        else
+            units.push_back(unit);
+    }
+    m_units.swap(units);
+    m_total = m_units.size();
+    m_log->get(LogLevel::Info) << unchanged << " cells are unchanged." <<
+        std::endl;
+}
+
+
+void DispatchKernel::finishUnit(Unit& unit, bool replied,
+    const std::string& reply, size_t worker)
+{
+    NL::json result;
+    std::string error;
+    if (!replied)
+        error = reply.size() ? reply : "Worker exited.";
+    else
+    {
+        try
+        {
+            result = NL::json::parse(reply);
+            if (result.value("status", "") != "ok")
+                error = result.value("error", "Unknown error.");
+        }
+        catch (const NL::json::exception&)
+        {
+            result = NL::json();
+            error = "Invalid reply from worker: " + reply;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_running--;
+    unit.m_attempts++;
+    if (error.size() && unit.m_attempts <= m_retries)
+    {
+        m_log->get(LogLevel::Warning) << "Cell " << unit.m_id <<
+            " failed on worker " << worker << ": " << error <<
+            "  Retrying." << std::endl;
+        m_units.push_back(unit);
+    }
+    else
+    {
+        m_done++;
+        if (error.size())
+            m_failed++;
+        if (error.empty() && unit.m_signature.size())
+            m_state[unit.m_id] = unit.m_signature;
+        else
+            m_state.erase(unit.m_id);
+        result["id"] = unit.m_id;
+        result["status"] = error.empty() ? "ok" : "error";
+        if (error.size())
+            result["error"] = error;
+        result["worker"] = worker;
+        result["attempts"] = unit.m_attempts;
+        std::cout << result.dump() << std::endl;
+        m_log->get(LogLevel::Info) << "Finished " << m_done << " of " <<
+            m_total << " cells." << std::endl;
+    }
+    m_cv.notify_all();
+}
+
+} // namespace pdal
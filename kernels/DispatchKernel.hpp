@@ -0,0 +1,106 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+
+#include <pdal/Kernel.hpp>
+#include <pdal/util/Bounds.hpp>
+
+namespace pdal
+{
+
+class PDAL_DLL DispatchKernel : public Kernel
+{
+public:
+    std::string getName() const;
+    int execute();
+    DispatchKernel();
+
+private:
+    // A cell of the partition and the job that processes it.  The
+    // signature is a hash of the job, the worker pipeline and the files
+    // that the cell reads, or empty if the files can't be identified.
+    struct Unit
+    {
+        std::string m_id;
+        std::string m_job;
+        std::string m_output;
+        std::string m_signature;
+        int m_attempts;
+    };
+
+    void addSwitches(ProgramArgs& args);
+    void validateSwitches(ProgramArgs& args);
+    void preparePipeline();
+    void makeUnits();
+    void readState();
+    void writeState();
+    void skipUnchanged();
+    void runWorker(size_t worker);
+    bool nextUnit(Unit& unit);
+    void finishUnit(Unit& unit, bool replied, const std::string& reply,
+        size_t worker);
+
+    std::string m_pipelineFile;
+    std::string m_workPipelineFile;
+    StringList m_workers;
+    double m_length;
+    double m_buffer;
+    double m_xOrigin;
+    double m_yOrigin;
+    BOX2D m_bounds;
+    int m_retries;
+    std::string m_stateFile;
+    bool m_incremental;
+
+    std::vector<std::string> m_readerTags;
+    std::string m_writerTag;
+    std::string m_outputFile;
+    std::string::size_type m_hashPos;
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<Unit> m_units;
+    std::map<std::string, std::string> m_state;
+    size_t m_total;
+    size_t m_done;
+    size_t m_failed;
+    size_t m_running;
+};
+
+} // namespace pdal
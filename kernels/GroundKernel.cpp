@@ -35,16 +35,25 @@
 
 #include "GroundKernel.hpp"
 
+#include <filters/StreamCallbackFilter.hpp>
+#include <io/BufferReader.hpp>
 #include <pdal/Options.hpp>
 #include <pdal/PointTable.hpp>
 #include <pdal/PointView.hpp>
+#include <pdal/Reader.hpp>
 #include <pdal/Stage.hpp>
 #include <pdal/StageFactory.hpp>
+#include <pdal/Streamable.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
+#include <cmath>
+#include <functional>
 #include <memory>
 #include <string>
 #include <vector>
 
+#include "private/TileRouter.hpp"
+
 namespace pdal
 {
 
@@ -65,7 +74,8 @@ std::string GroundKernel::getName() const
 GroundKernel::GroundKernel()
     : Kernel(), m_inputFile(""), m_outputFile(""), m_maxWindowSize(33),
       m_slope(1), m_maxDistance(2.5), m_initialDistance(0.15), m_cellSize(1),
-      m_extract(false), m_reset(false), m_denoise(false)
+      m_extract(false), m_reset(false), m_denoise(false), m_tileSize(0),
+      m_buffer(0), m_threads(1), m_bufferArg(nullptr)
 {
 }
 
@@ -87,12 +97,26 @@ void GroundKernel::addSwitches(ProgramArgs& args)
     args.add("threshold", "Elevation threshold?", m_threshold, 0.5);
     args.add("cut", "Cut net size?", m_cut, 0.0);
     args.add("ignore", "A range query to ignore when processing", m_ignored);
+    args.add("tile_size", "Size of the tiles classified separately",
+        m_tileSize, 0.0);
+    m_bufferArg = &args.add("buffer", "Width of the buffer classified around "
+        "each tile", m_buffer);
+    args.add("threads", "Number of threads used to classify tiles",
+        m_threads, 1);
 }
 
-int GroundKernel::execute()
+void GroundKernel::validateSwitches(ProgramArgs&)
 {
-    PointTable table;
+    if (m_threads < 1)
+        throw pdal_error("Option 'threads' must be at least 1.");
+}
 
+
+// Add the stages that classify ground to a pipeline.  When 'tiled' is
+// set, the ground filter classifies its input by tile itself.
+Stage& GroundKernel::addFilters(PipelineManager& manager, Stage& reader,
+    bool tiled)
+{
     Options assignOptions;
     assignOptions.add("assignment", "Classification[:]=0");
 
@@ -109,32 +133,318 @@ int GroundKernel::execute()
         groundOptions.add("returns", s);
     for(DimRange& r: m_ignored)
         groundOptions.add("ignore", r);
+    if (tiled)
+    {
+        groundOptions.add("tile_size", m_tileSize);
+        if (m_bufferArg->set())
+            groundOptions.add("buffer", m_buffer);
+        groundOptions.add("threads", m_threads);
+    }
 
     Options rangeOptions;
     rangeOptions.add("limits", "Classification[2:2]");
 
-    Stage& readerStage(makeReader(m_inputFile, ""));
-
-    Stage* assignStage = &readerStage;
+    Stage* assignStage = &reader;
     if (m_reset)
-        assignStage = &makeFilter("filters.assign", readerStage, assignOptions);
+        assignStage = &manager.makeFilter("filters.assign", reader,
+            assignOptions);
 
     Stage* outlierStage = assignStage;
     if (m_denoise)
-        outlierStage = &makeFilter("filters.outlier", *assignStage, outlierOptions);
-
-    Stage& groundStage = makeFilter("filters.smrf", *outlierStage, groundOptions);
+        outlierStage = &manager.makeFilter("filters.outlier", *assignStage,
+            outlierOptions);
 
+    Stage& groundStage = manager.makeFilter("filters.smrf", *outlierStage,
+        groundOptions);
 
     Stage* rangeStage = &groundStage;
     if (m_extract)
-        rangeStage = &makeFilter("filters.range", groundStage, rangeOptions);
+        rangeStage = &manager.makeFilter("filters.range", groundStage,
+            rangeOptions);
+    return *rangeStage;
+}
+
+
+int GroundKernel::execute()
+{
+    Stage& readerStage(makeReader(m_inputFile, ""));
+    if (m_tileSize > 0 && readerStage.pipelineStreamable())
+    {
+        classifyTiles(readerStage);
+        return 0;
+    }
 
-    Stage& writer(makeWriter(m_outputFile, *rangeStage, ""));
+    PointTable table;
+    Stage& last = addFilters(m_manager, readerStage, true);
+    Stage& writer(makeWriter(m_outputFile, last, ""));
     writer.prepare(table);
     writer.execute(table);
 
     return 0;
 }
 
+
+namespace
+{
+
+using Coord = TileRouter::Coord;
+
+// Maximum number of tile spill files held open at once.
+const size_t MaxOpenTiles = 256;
+
+// Points of a classified tile.  The view refers to the table, so they're
+// kept together.
+struct Tile
+{
+    std::unique_ptr<PointTable> m_table;
+    PointViewPtr m_view;
+};
+
+// Reader that streams the points of classified tiles, a batch of tiles at
+// a time.  A batch is requested when the points of the previous batch have
+// all been read.
+class TileReader : public Reader, public Streamable
+{
+public:
+    using BatchFunc = std::function<std::vector<Tile>()>;
+
+    TileReader(const TileRouter& router, const SpatialReference& srs,
+            BatchFunc nextBatch) :
+        m_router(router), m_srs(srs), m_nextBatch(nextBatch), m_pos(0),
+        m_idx(0)
+    {}
+
+    std::string getName() const
+        { return "readers.groundtiles"; }
+
+private:
+    virtual void addDimensions(PointLayoutPtr layout)
+        { m_router.registerDims(layout); }
+
+    virtual void ready(PointTableRef table)
+    {
+        setSpatialReference(m_srs);
+        PointLayoutPtr layout = table.layout();
+        m_dims = layout->dimTypes();
+        for (const DimType& dt : m_dims)
+            m_names.push_back(layout->dimName(dt.m_id));
+    }
+
+    // Move to the next point, fetching a batch of tiles once the points of
+    // the current batch have all been read.  Returns false at the end.
+    bool nextPoint()
+    {
+        while (m_pos == m_batch.size() ||
+            m_idx == m_batch[m_pos].m_view->size())
+        {
+            if (m_pos == m_batch.size())
+            {
+                m_batch = m_nextBatch();
+                m_pos = 0;
+                if (m_batch.empty())
+                    return false;
+            }
+            else
+                m_pos++;
+            m_idx = 0;
+
+            // Dimensions of the tile's table are found by name.
+            if (m_pos < m_batch.size())
+            {
+                PointLayoutPtr layout = m_batch[m_pos].m_table->layout();
+                m_ids.clear();
+                for (const std::string& name : m_names)
+                    m_ids.push_back(layout->findDim(name));
+            }
+        }
+        return true;
+    }
+
+    virtual bool processOne(PointRef& point)
+    {
+        if (!nextPoint())
+            return false;
+
+        const PointView& view = *m_batch[m_pos].m_view;
+        char buf[sizeof(double)];
+        for (size_t i = 0; i < m_dims.size(); ++i)
+        {
+            view.getField(buf, m_ids[i], m_dims[i].m_type, m_idx);
+            point.setField(m_dims[i].m_id, m_dims[i].m_type, buf);
+        }
+        m_idx++;
+        return true;
+    }
+
+    virtual point_count_t read(PointViewPtr view, point_count_t count)
+    {
+        PointId idx = view->size();
+        point_count_t cnt = 0;
+        PointRef point(*view, idx);
+        while (cnt < count)
+        {
+            point.setPointId(idx);
+            if (!processOne(point))
+                break;
+            idx++;
+            cnt++;
+        }
+        return cnt;
+    }
+
+    const TileRouter& m_router;
+    SpatialReference m_srs;
+    BatchFunc m_nextBatch;
+    std::vector<Tile> m_batch;
+    size_t m_pos;
+    PointId m_idx;
+    DimTypeList m_dims;
+    StringList m_names;
+    std::vector<Dimension::Id> m_ids;
+};
+
+} // unnamed namespace
+
+
+// Classify the input by tile without loading it.  Points are streamed from
+// the reader to temporary files for the buffered extent of every tile they
+// fall in.  Batches of tiles are then classified in parallel, each by a
+// pipeline of its own, and the points of each tile's core are streamed to
+// the writer.
+void GroundKernel::classifyTiles(Stage& reader)
+{
+    using namespace Dimension;
+
+    const double buffer = (std::max)(0.0,
+        m_bufferArg->set() ? m_buffer : m_maxWindowSize);
+
+    // Tiles are laid out from the minimum of the bounds the reader reports
+    // without reading the points, or else from the first point.
+    QuickInfo qi = reader.preview();
+    bool haveOrigin = qi.valid() && qi.m_bounds.valid();
+    double xOrigin = haveOrigin ? qi.m_bounds.minx : 0.0;
+    double yOrigin = haveOrigin ? qi.m_bounds.miny : 0.0;
+    auto tileOf = [&](double x, double y)
+    {
+        return Coord((int)std::floor((x - xOrigin) / m_tileSize),
+            (int)std::floor((y - yOrigin) / m_tileSize));
+    };
+
+    std::unique_ptr<TileRouter> router;
+    std::unique_ptr<TileRouter::Buffer> tileBuffer;
+    StreamCallbackFilter f;
+    f.setInput(reader);
+    f.setCallback([&](PointRef& point)
+    {
+        double x = point.getFieldAs<double>(Id::X);
+        double y = point.getFieldAs<double>(Id::Y);
+        if (!haveOrigin)
+        {
+            xOrigin = x;
+            yOrigin = y;
+            haveOrigin = true;
+        }
+        Coord lo = tileOf(x - buffer, y - buffer);
+        Coord hi = tileOf(x + buffer, y + buffer);
+        for (int c = lo.first; c <= hi.first; ++c)
+            for (int r = lo.second; r <= hi.second; ++r)
+                tileBuffer->add(point, Coord(c, r));
+        return true;
+    });
+
+    FixedPointTable table(10000);
+    table.layout()->registerDim(Id::Classification);
+    f.prepare(table);
+
+    std::string prefix =
+        FileUtils::getDirectory(FileUtils::toAbsolutePath(m_outputFile)) +
+        "/" + FileUtils::stem(m_outputFile) + "_ground_";
+    router.reset(new TileRouter(table.layout(), prefix, MaxOpenTiles));
+    tileBuffer.reset(new TileRouter::Buffer(*router, table.layout()));
+    f.execute(table);
+    tileBuffer->flush();
+
+    const SpatialReference srs(table.anySpatialReference());
+    const TileRouter::Tiles tiles = router->close();
+    m_log->get(LogLevel::Debug) << "Classifying " << tiles.size() <<
+        " tiles." << std::endl;
+
+    // Classify the buffered extent of a tile and keep the points of its
+    // core.  Tiles with no points in their core are skipped.
+    auto classify = [&](const std::pair<Coord, std::string>& tile)
+    {
+        Tile t;
+        t.m_table.reset(new PointTable);
+        PointTable& tileTable = *t.m_table;
+        router->registerDims(tileTable.layout());
+
+        PipelineManager manager;
+        manager.setLog(m_log);
+        manager.stageOptions() = m_manager.stageOptions();
+
+        BufferReader r;
+        r.setSpatialReference(srs);
+        Stage& last = addFilters(manager, r, false);
+        last.prepare(tileTable);
+        tileTable.finalize();
+
+        PointViewPtr view = router->load(tileTable, tile.second);
+        t.m_view = view->makeNew();
+        auto inCore = [&](const PointView& v, PointId i)
+        {
+            return tileOf(v.getFieldAs<double>(Id::X, i),
+                v.getFieldAs<double>(Id::Y, i)) == tile.first;
+        };
+
+        bool hasCore = false;
+        for (PointId i = 0; i < view->size() && !hasCore; ++i)
+            hasCore = inCore(*view, i);
+        if (!hasCore)
+            return t;
+
+        r.addView(view);
+        for (const PointViewPtr& v : last.execute(tileTable))
+            for (PointId i = 0; i < v->size(); ++i)
+                if (inCore(*v, i))
+                    t.m_view->appendPoint(*v, i);
+        return t;
+    };
+
+    ThreadPool pool(m_threads, -1, false);
+    size_t next = 0;
+    TileReader tileReader(*router, srs, [&]()
+    {
+        const size_t count = (std::min)(tiles.size() - next,
+            (size_t)m_threads);
+        std::vector<Tile> batch(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            const std::pair<Coord, std::string>& tile = tiles[next + i];
+            Tile& t = batch[i];
+            pool.add([&classify, &tile, &t]() { t = classify(tile); });
+        }
+        pool.await();
+        if (pool.errors().size())
+            throw pdal_error(pool.errors().front());
+        next += count;
+        return batch;
+    });
+
+    Stage& writer(makeWriter(m_outputFile, tileReader, ""));
+    if (writer.pipelineStreamable())
+    {
+        FixedPointTable outTable(10000);
+        writer.prepare(outTable);
+        writer.execute(outTable);
+    }
+    else
+    {
+        PointTable outTable;
+        writer.prepare(outTable);
+        writer.execute(outTable);
+    }
+    pool.join();
+    router->remove();
+}
+
 } // namespace pdal
@@ -46,6 +46,7 @@ namespace pdal
 {
 
 class Options;
+class PipelineManager;
 class Stage;
 
 class PDAL_DLL GroundKernel : public Kernel
@@ -57,6 +58,9 @@ public:
 
 private:
     virtual void addSwitches(ProgramArgs& args);
+    virtual void validateSwitches(ProgramArgs& args);
+    Stage& addFilters(PipelineManager& manager, Stage& reader, bool tiled);
+    void classifyTiles(Stage& reader);
 
     std::string m_inputFile;
     std::string m_outputFile;
@@ -75,6 +79,10 @@ private:
     double m_cut;
     std::string m_dir;
     std::vector<DimRange> m_ignored;
+    double m_tileSize;
+    double m_buffer;
+    int m_threads;
+    Arg *m_bufferArg;
 
 };
 
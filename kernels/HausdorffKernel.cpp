@@ -64,6 +64,8 @@ void HausdorffKernel::addSwitches(ProgramArgs& args)
     Arg& candidate = args.add("candidate", "Candidate filename",
                               m_candidateFile);
     candidate.setPositional();
+    args.add("threads", "Number of threads used to find nearest neighbors",
+        m_threads, (size_t)1);
 }
 
 
@@ -80,13 +82,17 @@ PointViewPtr HausdorffKernel::loadSet(const std::string& filename,
 
 int HausdorffKernel::execute()
 {
+    if (m_threads < 1)
+        throw pdal_error("Option 'threads' must be at least 1.");
+
     PointTable srcTable;
     PointViewPtr srcView = loadSet(m_sourceFile, srcTable);
 
     PointTable candTable;
     PointViewPtr candView = loadSet(m_candidateFile, candTable);
 
-    double hausdorff = Utils::computeHausdorff(srcView, candView);
+    double hausdorff = Utils::computeHausdorff(srcView, candView,
+        (unsigned)m_threads);
 
     MetadataNode root;
     root.add("filenames", m_sourceFile);
@@ -55,6 +55,7 @@ private:
 
     std::string m_sourceFile;
     std::string m_candidateFile;
+    size_t m_threads;
 };
 
 } // namespace pdal
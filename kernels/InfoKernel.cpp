@@ -35,15 +35,18 @@
 #include "InfoKernel.hpp"
 
 #include <algorithm>
+#include <mutex>
 
 #include <pdal/pdal_config.hpp>
 #include <pdal/pdal_features.hpp>
 
 #include <filters/InfoFilter.hpp>
+#include <pdal/FileInspector.hpp>
 #include <pdal/KDIndex.hpp>
 #include <pdal/PipelineWriter.hpp>
 #include <pdal/PDALUtils.hpp>
 #include <pdal/StageFactory.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
 namespace pdal
 {
@@ -61,8 +64,7 @@ std::string InfoKernel::getName() const { return s_info.name; }
 
 InfoKernel::InfoKernel() : m_showStats(false), m_showSchema(false),
     m_showAll(false), m_showMetadata(false), m_boundary(false),
-    m_showSummary(false), m_needPoints(false), m_statsStage(nullptr),
-    m_hexbinStage(nullptr), m_infoStage(nullptr), m_reader(nullptr)
+    m_showSummary(false), m_needPoints(false), m_threads(1)
 {}
 
 
@@ -123,12 +125,17 @@ void InfoKernel::validateSwitches(ProgramArgs& args)
         throw pdal_error("'enumerate' option requires 'stats' option.");
     if (!m_showStats && m_dimensions.size())
         throw pdal_error("'dimensions' option requires 'stats' option.");
+    if (m_threads < 1)
+        throw pdal_error("Option 'threads' must be at least 1.");
+    if (!m_showSummary && m_cacheFile.size())
+        throw pdal_error("'cache' option requires 'summary' option.");
 }
 
 
 void InfoKernel::addSwitches(ProgramArgs& args)
 {
-    args.add("input,i", "Input file name", m_inputFile).setOptionalPositional();
+    args.add("input,i", "Input file name or glob pattern", m_inputFile).
+        setOptionalPositional();
     args.add("all", "Dump statistics, schema and metadata", m_showAll);
     args.add("point,p", "Point to dump\n--point=\"1-5,10,100-200\" (0 indexed)",
         m_pointIndexes);
@@ -149,6 +156,11 @@ void InfoKernel::addSwitches(ProgramArgs& args)
     args.add("pipeline-serialization", "Output filename for pipeline "
         "serialization", m_pipelineFile);
     args.add("summary", "Dump summary of the info", m_showSummary);
+    args.add("threads", "Number of files to process concurrently when "
+        "the input is a pattern matching several files", m_threads,
+        (size_t)1);
+    args.add("cache", "File in which to cache summaries of unchanged files",
+        m_cacheFile);
     args.add("metadata", "Dump file metadata info", m_showMetadata);
     args.add("stdin,s", "Read a pipeline file from standard input", m_usestdin);
 }
@@ -185,26 +197,108 @@ MetadataNode InfoKernel::dumpSummary(const QuickInfo& qi)
     return summary;
 }
 
-void InfoKernel::makeReader(const std::string& filename)
+
+MetadataNode InfoKernel::runSummaries(const StringList& filenames)
+{
+    FileInspector inspector;
+    inspector.setThreads(m_threads);
+    inspector.setCacheFile(m_cacheFile);
+    inspector.setDriver(m_driverOverride);
+    inspector.setOptions(m_manager.commonOptions(), m_manager.stageOptions());
+
+    MetadataNode root;
+    for (const FileInspector::Result& r : inspector.inspect(filenames))
+    {
+        MetadataNode file = root.addList("files");
+        file.add("filename", r.m_filename);
+        if (r.valid())
+            file.add(dumpSummary(r.m_info).clone("summary"));
+        else
+            file.add("error", r.m_error);
+    }
+    root.add("pdal_version", Config::fullVersionString());
+    return root;
+}
+
+
+// Run the requested functions on each of a set of files, several files
+// at a time.  Each file gets its own pipeline.  The results are reported
+// in the order of the files.
+MetadataNode InfoKernel::runFiles(const StringList& filenames)
+{
+    std::vector<MetadataNode> results(filenames.size());
+    std::vector<std::string> errors(filenames.size());
+
+    ThreadPool pool(m_threads, -1, false);
+    for (size_t i = 0; i < filenames.size(); ++i)
+        pool.add([this, &filenames, &results, &errors, i]()
+        {
+            PipelineManager manager;
+            manager.setLog(m_log);
+            manager.commonOptions() = m_manager.commonOptions();
+            manager.stageOptions() = m_manager.stageOptions();
+            try
+            {
+                results[i] = run(manager, filenames[i]);
+            }
+            catch (const std::exception& err)
+            {
+                errors[i] = err.what();
+            }
+        });
+    pool.join();
+
+    MetadataNode root;
+    for (size_t i = 0; i < filenames.size(); ++i)
+    {
+        if (errors[i].size())
+        {
+            MetadataNode file = root.addList("files");
+            file.add("filename", filenames[i]);
+            file.add("error", errors[i]);
+        }
+        else
+            root.addList(results[i].clone("files"));
+    }
+    root.add("pdal_version", Config::fullVersionString());
+    return root;
+}
+
+
+void InfoKernel::makeReader(PipelineManager& manager, Stages& stages,
+    const std::string& filename)
 {
     Options rOps;
     if (!m_needPoints)
         rOps.add("count", 0);
-    m_reader = &(m_manager.makeReader(filename, m_driverOverride, rOps));
+    stages.m_reader = &(manager.makeReader(filename, m_driverOverride, rOps));
 }
 
 
-void InfoKernel::makePipeline()
+void InfoKernel::makePipeline(PipelineManager& manager, Stages& stages)
 {
-    Stage *stage = m_reader;
+    Stage *stage = stages.m_reader;
+
+    // When only listed points are reported, nothing past the last of them
+    // is read.  A head filter limits the points that the reader reads.
+    if (m_pointIndexes.size() && !m_showStats && !m_boundary)
+    {
+        PointIdList ids = InfoFilter::parsePointSpec(m_pointIndexes);
+        if (ids.size())
+        {
+            Options hOps;
+            hOps.add("count", *std::max_element(ids.begin(), ids.end()) + 1);
+            stage = &manager.makeFilter("filters.head", *stage, hOps);
+        }
+    }
 
     Options iOps;
     if (m_queryPoint.size())
         iOps.add("query", m_queryPoint);
     if (m_pointIndexes.size())
         iOps.add("point", m_pointIndexes);
-    stage = m_infoStage =
-        &(m_manager.makeFilter("filters.info", *stage, iOps));
+    stage = stages.m_info =
+        &(manager.makeFilter("filters.info", *stage, iOps));
 
     if (m_showStats)
     {
@@ -213,22 +307,30 @@ void InfoKernel::makePipeline()
             filterOptions.add({"dimensions", m_dimensions});
         if (m_enumerate.size())
             filterOptions.add({"enumerate", m_enumerate});
-        stage = m_statsStage =
-            &m_manager.makeFilter("filters.stats", *stage, filterOptions);
+        stage = stages.m_stats =
+            &manager.makeFilter("filters.stats", *stage, filterOptions);
     }
     if (m_boundary)
-        m_hexbinStage = &m_manager.makeFilter("filters.hexbin", *stage);
+        stages.m_hexbin = &manager.makeFilter("filters.hexbin", *stage);
 }
 
 
 MetadataNode InfoKernel::run(const std::string& filename)
+{
+    return run(m_manager, filename);
+}
+
+
+MetadataNode InfoKernel::run(PipelineManager& manager,
+    const std::string& filename)
 {
     MetadataNode root;
+    Stages stages;
 
-    makeReader(filename);
+    makeReader(manager, stages, filename);
     if (m_showSummary)
     {
-        QuickInfo qi = m_manager.getStage()->preview();
+        QuickInfo qi = manager.getStage()->preview();
         if (!qi.valid())
             throw pdal_error("No summary data available for '" +
                 filename + "'.");
@@ -236,12 +338,12 @@ MetadataNode InfoKernel::run(const std::string& filename)
     }
     else
     {
-        makePipeline();
+        makePipeline(manager, stages);
         if (m_needPoints || m_showMetadata)
-            m_manager.execute(ExecMode::PreferStream);
+            manager.execute(ExecMode::PreferStream);
         else
-            m_manager.prepare();
-        dump(root);
+            manager.prepare();
+        dump(manager, stages, root);
     }
     root.add("filename", filename);
     root.add("pdal_version", Config::fullVersionString());
@@ -249,8 +351,13 @@ MetadataNode InfoKernel::run(const std::string& filename)
     std::time_t now
     = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
     std::stringstream t;
-    t << std::put_time( std::localtime( &now ), "%FT%T%z" );
-    root.add("reader", m_reader->getName());
+    {
+        // localtime() isn't reentrant and files may be run concurrently.
+        static std::mutex timeMutex;
+        std::lock_guard<std::mutex> lock(timeMutex);
+        t << std::put_time( std::localtime( &now ), "%FT%T%z" );
+    }
+    root.add("reader", stages.m_reader->getName());
     root.add("now", t.str());
     
     if (pdal::FileUtils::fileExists(filename) &&
@@ -261,17 +368,18 @@ MetadataNode InfoKernel::run(const std::string& filename)
 }
 
 
-void InfoKernel::dump(MetadataNode& root)
+void InfoKernel::dump(PipelineManager& manager, Stages& stages,
+    MetadataNode& root)
 {
     if (m_pipelineFile.size() > 0)
-        PipelineWriter::writePipeline(m_manager.getStage(), m_pipelineFile);
+        PipelineWriter::writePipeline(manager.getStage(), m_pipelineFile);
 
     // Reader stage.
     if (m_showMetadata)
-        root.add(m_reader->getMetadata().clone("metadata"));
+        root.add(stages.m_reader->getMetadata().clone("metadata"));
 
     // Info stage.
-    auto info = dynamic_cast<InfoFilter *>(m_infoStage);
+    auto info = dynamic_cast<InfoFilter *>(stages.m_info);
     MetadataNode node = info->getMetadata();
     MetadataNode points = node.findChild("points");
     if (points)
@@ -282,12 +390,12 @@ void InfoKernel::dump(MetadataNode& root)
 
     // Stats stage.
     if (m_showStats)
-        root.add(m_statsStage->getMetadata().clone("stats"));
+        root.add(stages.m_stats->getMetadata().clone("stats"));
 
     // Hexbin stage.
-    if (m_hexbinStage)
+    if (stages.m_hexbin)
     {
-        MetadataNode node = m_hexbinStage->getMetadata();
+        MetadataNode node = stages.m_hexbin->getMetadata();
         if (node.findChild("error"))
         {
             std::string poly = info->bounds().to2d().toWKT();
@@ -297,7 +405,7 @@ void InfoKernel::dump(MetadataNode& root)
             root.add(m);
         }
         else
-            root.add(m_hexbinStage->getMetadata().clone("boundary"));
+            root.add(stages.m_hexbin->getMetadata().clone("boundary"));
     }
 }
 
@@ -305,7 +413,25 @@ void InfoKernel::dump(MetadataNode& root)
 int InfoKernel::execute()
 {
     std::string filename = (m_usestdin ? std::string("STDIN") : m_inputFile);
-    MetadataNode root = run(filename);
+
+    MetadataNode root;
+    if (!m_usestdin && filename.find_first_of("*?[") != std::string::npos)
+    {
+        StringList filenames = FileUtils::glob(filename);
+        if (filenames.empty())
+            throw pdal_error("No files match '" + filename + "'.");
+        if (m_showSummary)
+            root = runSummaries(filenames);
+        else if (filenames.size() == 1)
+            root = run(filenames.front());
+        else if (m_pipelineFile.size())
+            throw pdal_error("'pipeline-serialization' option requires "
+                "a single input file.");
+        else
+            root = runFiles(filenames);
+    }
+    else
+        root = run(filename);
     Utils::toJSON(root, std::cout);
 
     return 0;
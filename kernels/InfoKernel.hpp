@@ -63,12 +63,29 @@ public:
     inline void doComputeBoundary(bool value) { m_boundary = value; }
 
 private:
+    // Stages of the pipeline run for one input.
+    struct Stages
+    {
+        Stage *m_reader;
+        Stage *m_info;
+        Stage *m_stats;
+        Stage *m_hexbin;
+
+        Stages() : m_reader(nullptr), m_info(nullptr), m_stats(nullptr),
+            m_hexbin(nullptr)
+        {}
+    };
+
     void addSwitches(ProgramArgs& args);
     void validateSwitches(ProgramArgs& args);
-    void makeReader(const std::string& filename);
-    void makePipeline();
-    void dump(MetadataNode& root);
+    void makeReader(PipelineManager& manager, Stages& stages,
+        const std::string& filename);
+    void makePipeline(PipelineManager& manager, Stages& stages);
+    void dump(PipelineManager& manager, Stages& stages, MetadataNode& root);
     MetadataNode dumpSummary(const QuickInfo& qi);
+    MetadataNode runSummaries(const StringList& filenames);
+    MetadataNode run(PipelineManager& manager, const std::string& filename);
+    MetadataNode runFiles(const StringList& filenames);
 
     std::string m_inputFile;
     bool m_showStats;
@@ -84,11 +101,8 @@ private:
     bool m_showSummary;
     bool m_needPoints;
     bool m_usestdin;
-
-    Stage *m_statsStage;
-    Stage *m_hexbinStage;
-    Stage *m_infoStage;
-    Stage *m_reader;
+    size_t m_threads;
+    std::string m_cacheFile;
 
     MetadataNode m_tree;
 };
@@ -34,8 +34,16 @@
 
 #include "MergeKernel.hpp"
 
+#include <queue>
+
 #include <filters/MergeFilter.hpp>
+#include <filters/StreamCallbackFilter.hpp>
+#include <pdal/Reader.hpp>
 #include <pdal/StageFactory.hpp>
+#include <pdal/StageWrapper.hpp>
+#include <pdal/Streamable.hpp>
+
+#include "private/SortKey.hpp"
 
 namespace pdal
 {
@@ -55,9 +63,19 @@ std::string MergeKernel::getName() const
 }
 
 
+MergeKernel::MergeKernel() : m_sorted(false)
+{}
+
+
 void MergeKernel::addSwitches(ProgramArgs& args)
 {
     args.add("files,f", "input/output files", m_files).setPositional();
+    args.add("sorted", "Inputs are each sorted.  Points are merged so that "
+        "the output is sorted as well", m_sorted);
+    args.add("dimension,d", "Dimension by which the inputs are sorted.  If "
+        "not given, inputs are taken to be in Morton order", m_dimName);
+    args.add("order", "Sort order of a dimension: ASC(ending) or "
+        "DESC(ending)", m_order, "ASC");
 }
 
 
@@ -67,12 +85,21 @@ void MergeKernel::validateSwitches(ProgramArgs& args)
         throw pdal_error("Must specify an input and output file.");
     m_outputFile = m_files.back();
     m_files.resize(m_files.size() - 1);
+
+    m_order = Utils::toupper(m_order);
+    if (m_order != "ASC" && m_order != "DESC")
+        throw pdal_error("Invalid order '" + m_order + "'.  Must be 'ASC' "
+            "or 'DESC'.");
 }
 
 
 int MergeKernel::execute()
 {
-    PointTable table;
+    if (m_sorted)
+    {
+        mergeSorted();
+        return 0;
+    }
 
     MergeFilter filter;
 
@@ -83,9 +110,232 @@ int MergeKernel::execute()
     }
 
     Stage& writer = makeWriter(m_outputFile, filter, "");
+
+    // When every stage can stream, the inputs are copied to the output a
+    // batch of points at a time rather than being loaded.
+    if (writer.pipelineStreamable())
+    {
+        FixedPointTable table(10000);
+        writer.prepare(table);
+        writer.execute(table);
+    }
+    else
+    {
+        PointTable table;
+        writer.prepare(table);
+        writer.execute(table);
+    }
+    return 0;
+}
+
+
+namespace
+{
+
+// Stream table that shares the layout of the table points are written
+// through and holds the next point of each input.
+class HeadTable : public StreamPointTable
+{
+public:
+    HeadTable(PointLayout& layout, point_count_t capacity) :
+        StreamPointTable(layout, capacity),
+        m_buf(pointsToBytes(capacity + 1))
+    {}
+
+    virtual void finalize()
+    {}
+
+protected:
+    virtual void reset()
+        {}
+
+    virtual char *getPoint(PointId idx)
+        { return m_buf.data() + pointsToBytes(idx); }
+
+private:
+    std::vector<char> m_buf;
+};
+
+
+// Reader that streams the points of inputs that are each in key order as
+// a single sequence in key order.  The next point of each input is held
+// and the one with the lowest key is returned.  Ties go to the earlier
+// input.
+class SortedMergeReader : public Reader, public Streamable
+{
+public:
+    SortedMergeReader(const std::vector<Streamable *>& inputs,
+            const StringList& files, const SortKey& key) :
+        m_inputs(inputs), m_files(files), m_key(key)
+    {}
+
+    std::string getName() const
+        { return "readers.sortedmerge"; }
+
+private:
+    virtual void ready(PointTableRef table)
+    {
+        m_heads.reset(new HeadTable(*table.layout(), m_inputs.size()));
+        m_dims = table.layout()->dimTypes();
+        m_buf.resize(table.layout()->pointSize());
+        m_keys.assign(m_inputs.size(), 0);
+
+        SpatialReference srs;
+        for (size_t i = 0; i < m_inputs.size(); ++i)
+        {
+            Streamable& input = *m_inputs[i];
+            StreamableWrapper::ready(input, table);
+
+            const SpatialReference& inSrs = input.getSpatialReference();
+            if (srs.empty())
+                srs = inSrs;
+            else if (!inSrs.empty() && inSrs != srs)
+                log()->get(LogLevel::Warning) << getName() << ": merging "
+                    "points with inconsistent spatial references." <<
+                    std::endl;
+            advance(i);
+        }
+        setSpatialReference(srs);
+    }
+
+    virtual void done(PointTableRef table)
+    {
+        for (Streamable *input : m_inputs)
+            StreamableWrapper::done(*input, table);
+    }
+
+    // Read the next point of an input.
+    void advance(size_t i)
+    {
+        PointRef head(*m_heads, i);
+        if (!StreamableWrapper::processOne(*m_inputs[i], head))
+            return;
+
+        uint64_t key = m_key(head);
+        if (key < m_keys[i])
+            throwError("Points of '" + m_files[i] + "' aren't in the "
+                "sort order.");
+        m_keys[i] = key;
+        m_queue.push({ key, i });
+    }
+
+    virtual bool processOne(PointRef& point)
+    {
+        if (m_queue.empty())
+            return false;
+
+        size_t i = m_queue.top().second;
+        m_queue.pop();
+        PointRef head(*m_heads, i);
+        head.getPackedData(m_dims, m_buf.data());
+        point.setPackedData(m_dims, m_buf.data());
+        advance(i);
+        return true;
+    }
+
+    virtual point_count_t read(PointViewPtr view, point_count_t count)
+    {
+        PointId idx = view->size();
+        point_count_t cnt = 0;
+        PointRef point(*view, idx);
+        while (cnt < count)
+        {
+            point.setPointId(idx);
+            if (!processOne(point))
+                break;
+            idx++;
+            cnt++;
+        }
+        return cnt;
+    }
+
+    using QueueEntry = std::pair<uint64_t, size_t>;
+
+    std::vector<Streamable *> m_inputs;
+    StringList m_files;
+    SortKey m_key;
+    std::unique_ptr<HeadTable> m_heads;
+    DimTypeList m_dims;
+    std::vector<char> m_buf;
+    std::vector<uint64_t> m_keys;
+    std::priority_queue<QueueEntry, std::vector<QueueEntry>,
+        std::greater<QueueEntry>> m_queue;
+};
+
+} // unnamed namespace
+
+
+// Bounds of all the inputs, over which Morton codes are computed.  The
+// bounds reported by a reader are used when it can provide them without
+// reading the points.  Otherwise they're found by streaming the input once.
+BOX2D MergeKernel::mergeBounds(const std::vector<Stage *>& readers)
+{
+    BOX2D bounds;
+    for (size_t i = 0; i < readers.size(); ++i)
+    {
+        QuickInfo qi = readers[i]->preview();
+        if (qi.valid() && qi.m_bounds.valid())
+        {
+            bounds.grow(qi.m_bounds.to2d());
+            continue;
+        }
+
+        Stage& boundsReader = makeReader(m_files[i], m_driverOverride);
+        StreamCallbackFilter f;
+        f.setInput(boundsReader);
+        f.setCallback([&bounds](PointRef& point)
+        {
+            bounds.grow(point.getFieldAs<double>(Dimension::Id::X),
+                point.getFieldAs<double>(Dimension::Id::Y));
+            return true;
+        });
+
+        FixedPointTable table(10000);
+        f.prepare(table);
+        f.execute(table);
+    }
+    return bounds;
+}
+
+
+// Inputs that are each sorted are merged in a single streaming pass that
+// holds one point of each input, so the output is sorted as well.
+void MergeKernel::mergeSorted()
+{
+    std::vector<Stage *> readers;
+    std::vector<Streamable *> inputs;
+    for (const std::string& file : m_files)
+    {
+        Stage& reader = makeReader(file, m_driverOverride);
+        Streamable *input = dynamic_cast<Streamable *>(&reader);
+        if (!input)
+            throw pdal_error("Reader for '" + file + "' doesn't support "
+                "streaming, which is required with 'sorted'.");
+        readers.push_back(&reader);
+        inputs.push_back(input);
+    }
+
+    BOX2D bounds;
+    if (m_dimName.empty())
+        bounds = mergeBounds(readers);
+
+    FixedPointTable table(10000);
+    for (Stage *reader : readers)
+        reader->prepare(table);
+
+    SortKey key;
+    if (m_dimName.empty())
+        key = mortonKey(bounds);
+    else
+        key = dimensionKey(table.layout(), m_dimName, m_order == "DESC");
+
+    SortedMergeReader merged(inputs, m_files, key);
+    Stage& writer = makeWriter(m_outputFile, merged, "");
+    if (!writer.pipelineStreamable())
+        throw pdal_error("Writer for '" + m_outputFile + "' doesn't support "
+            "streaming, which is required with 'sorted'.");
     writer.prepare(table);
     writer.execute(table);
-    return 0;
 }
 
 } // namespace pdal
@@ -35,6 +35,7 @@
 #pragma once
 
 #include <pdal/Kernel.hpp>
+#include <pdal/util/Bounds.hpp>
 
 namespace pdal
 {
@@ -44,13 +45,19 @@ class PDAL_DLL MergeKernel : public Kernel
 public:
     std::string getName() const;
     int execute();
+    MergeKernel();
 
 private:
     void addSwitches(ProgramArgs& args);
     void validateSwitches(ProgramArgs& args);
+    void mergeSorted();
+    BOX2D mergeBounds(const std::vector<Stage *>& readers);
 
     StringList m_files;
     std::string m_outputFile;
+    bool m_sorted;
+    std::string m_dimName;
+    std::string m_order;
 };
 
 } // namespace pdal
@@ -57,7 +57,9 @@ CREATE_STATIC_KERNEL(PipelineKernel, s_info)
 
 std::string PipelineKernel::getName() const { return s_info.name; }
 
-PipelineKernel::PipelineKernel() : m_validate(false), m_progressFd(-1)
+PipelineKernel::PipelineKernel() : m_validate(false), m_progressFd(-1),
+    m_progressInterval(0), m_threads(0), m_memoryBudget(0), m_cacheSize(0),
+    m_noCache(false)
 {}
 
 
@@ -99,6 +101,8 @@ void PipelineKernel::addSwitches(ProgramArgs& args)
         "information.  The file/FIFO must exist.  PDAL will not create "
         "the progress file.",
         m_progressFile);
+    args.add("progress_interval", "Seconds between structured progress "
+        "reports written to the progress file", m_progressInterval);
     args.add("pointcloudschema", "dump PointCloudSchema XML output",
         m_PointCloudSchemaOutput).setHidden();
     args.add("stdin,s", "Read pipeline from standard input", m_usestdin);
@@ -106,6 +110,20 @@ void PipelineKernel::addSwitches(ProgramArgs& args)
         m_stream);
     args.add("nostream", "Run in standard mode.", m_noStream);
     args.add("metadata", "Metadata filename", m_metadataFile);
+    args.add("profile", "Filename for a JSON report of the time spent and "
+        "points handled by each stage", m_profileFile);
+    args.add("threads", "Number of threads used to run point views through "
+        "re-entrant stages in standard mode or groups of stages in stream "
+        "mode.  Overrides a pipeline's 'threads' value.", m_threads);
+    args.add("memory_budget", "Fail if the memory held by the pipeline's "
+        "stages exceeds this number of bytes", m_memoryBudget);
+    args.add("cache", "Directory in which to cache the output of stages "
+        "run in standard mode.  Defaults to the value of PDAL_CACHE_DIR.",
+        m_cacheDir);
+    args.add("cache_size", "Maximum size of the stage cache in megabytes",
+        m_cacheSize, size_t(4096));
+    args.add("no-cache", "Don't load or store cached stage output",
+        m_noCache);
 }
 
 
@@ -117,6 +135,7 @@ int PipelineKernel::execute()
     {
         m_progressFd = Utils::openProgress(m_progressFile);
         m_manager.setProgressFd(m_progressFd);
+        m_manager.setProgressInterval(m_progressInterval);
     }
 
     if (m_validate)
@@ -144,6 +163,17 @@ int PipelineKernel::execute()
     }
 
     m_manager.readPipeline(m_inputFile);
+    if (m_threads)
+        m_manager.setThreads(m_threads);
+    if (m_profileFile.size())
+        m_manager.setProfiling(true);
+    if (m_memoryBudget)
+        m_manager.setMemoryBudget(m_memoryBudget);
+    if (m_cacheDir.empty())
+        Utils::getenv("PDAL_CACHE_DIR", m_cacheDir);
+    if (m_cacheDir.size() && !m_noCache)
+        m_manager.setCache(m_cacheDir,
+            (uint64_t)m_cacheSize * 1024 * 1024);
     if (m_manager.execute(m_mode).m_mode == ExecMode::None)
         throw pdal_error("Couldn't run pipeline in requested execution mode.");
 
@@ -156,6 +186,15 @@ int PipelineKernel::execute()
         Utils::toJSON(m_manager.getMetadata(), *out);
         Utils::closeFile(out);
     }
+    if (m_profileFile.size())
+    {
+        std::ostream *out = Utils::createFile(m_profileFile, false);
+        if (!out)
+            throw pdal_error("Can't open file '" + m_profileFile +
+                "' for profile output.");
+        Utils::toJSON(m_manager.getProfile(), *out);
+        Utils::closeFile(out);
+    }
     if (m_pipelineFile.size())
         PipelineWriter::writePipeline(m_manager.getStage(), m_pipelineFile);
 
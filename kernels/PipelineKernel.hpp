@@ -57,13 +57,20 @@ private:
     std::string m_inputFile;
     std::string m_pipelineFile;
     std::string m_metadataFile;
+    std::string m_profileFile;
     bool m_validate;
     std::string m_PointCloudSchemaOutput;
     std::string m_progressFile;
     int m_progressFd;
+    double m_progressInterval;
     bool m_usestdin;
     bool m_stream;
     bool m_noStream;
+    size_t m_threads;
+    size_t m_memoryBudget;
+    std::string m_cacheDir;
+    size_t m_cacheSize;
+    bool m_noCache;
     ExecMode m_mode;
 };
 
@@ -0,0 +1,219 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#include "ServeKernel.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+
+#include <nlohmann/json.hpp>
+
+#include <pdal/util/FileUtils.hpp>
+#include <pdal/util/ThreadPool.hpp>
+
+namespace pdal
+{
+
+static StaticPluginInfo const s_info
+{
+    "kernels.serve",
+    "Serve Kernel",
+    "http://pdal.io/apps/serve.html"
+};
+
+CREATE_STATIC_KERNEL(ServeKernel, s_info)
+
+std::string ServeKernel::getName() const
+{
+    return s_info.name;
+}
+
+
+ServeKernel::ServeKernel() : m_threads(1), m_stream(false),
+    m_noStream(false), m_mode(ExecMode::PreferStream)
+{}
+
+
+void ServeKernel::addSwitches(ProgramArgs& args)
+{
+    args.add("pipeline,p", "Pipeline filename", m_pipelineFile).
+        setPositional();
+    args.add("jobs", "File of jobs, one JSON object per line.  Jobs are "
+        "read from standard input if not given", m_jobsFile);
+    args.add("threads", "Number of jobs run at once", m_threads, 1);
+    args.add("stream", "Run in stream mode.  Error if not streamable.",
+        m_stream);
+    args.add("nostream", "Run in standard mode.", m_noStream);
+}
+
+
+void ServeKernel::validateSwitches(ProgramArgs&)
+{
+    if (m_threads < 1)
+        throw pdal_error("Option 'threads' must be at least 1.");
+    if (m_stream && m_noStream)
+        throw pdal_error("Can't execute with 'stream' and 'nostream' options");
+    if (m_stream)
+        m_mode = ExecMode::Stream;
+    else if (m_noStream)
+        m_mode = ExecMode::Standard;
+}
+
+
+// Jobs are read a line at a time and run as they arrive.  Plugins, GDAL
+// and PROJ are loaded and initialized by the first job and stay that way
+// for later jobs, as do the transforms between spatial references.  The
+// result of each job is written to standard output as a line of JSON once
+// the job is done, so results of concurrent jobs may be out of order.
+int ServeKernel::execute()
+{
+    if (!FileUtils::fileExists(m_pipelineFile))
+        throw pdal_error("file not found: " + m_pipelineFile);
+    m_pipeline = FileUtils::readFileIntoString(m_pipelineFile);
+
+    // Read the pipeline once here so that a bad pipeline is reported
+    // rather than failing every job.
+    {
+        PipelineManager manager;
+        std::istringstream in(m_pipeline);
+        manager.readPipeline(in);
+    }
+
+    std::istream *jobs = &std::cin;
+    if (m_jobsFile.size())
+    {
+        jobs = Utils::openFile(m_jobsFile);
+        if (!jobs)
+            throw pdal_error("Can't open jobs file '" + m_jobsFile + "'.");
+    }
+
+    std::mutex outMutex;
+    ThreadPool pool(m_threads, -1, false);
+    std::string line;
+    size_t lineNum = 0;
+    while (std::getline(*jobs, line))
+    {
+        lineNum++;
+        Utils::trim(line);
+        if (line.empty())
+            continue;
+        pool.add([this, line, lineNum, &outMutex]()
+        {
+            std::string result = runJob(line, lineNum);
+            std::lock_guard<std::mutex> lock(outMutex);
+            std::cout << result << std::endl;
+        });
+    }
+    pool.join();
+    if (jobs != &std::cin)
+        Utils::closeFile(jobs);
+    return 0;
+}
+
+
+// Run a job and return its result.  A job is a JSON object with an
+// optional "id" and optional "options": stage options keyed by stage name
+// or "stage.<tag>", as on the command line.  For example:
+//   {"id": "t1", "options": {"readers.las": {"filename": "t1.las"}}}
+std::string ServeKernel::runJob(const std::string& line, size_t lineNum)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    NL::json result;
+    result["id"] = lineNum;
+    try
+    {
+        NL::json job = NL::json::parse(line);
+        if (!job.is_object())
+            throw pdal_error("Job must be a JSON object.");
+        if (job.count("id"))
+            result["id"] = job["id"];
+
+        PipelineManager manager;
+        manager.setLog(m_log);
+        manager.commonOptions() = m_manager.commonOptions();
+        manager.stageOptions() = m_manager.stageOptions();
+
+        if (job.count("options"))
+        {
+            const NL::json& options = job["options"];
+            if (!options.is_object())
+                throw pdal_error("Job 'options' must be a JSON object.");
+            for (auto& stage : options.items())
+            {
+                if (!stage.value().is_object())
+                    throw pdal_error("Options for '" + stage.key() + "' "
+                        "must be a JSON object.");
+                Options& opts = manager.stageOptions()[stage.key()];
+                for (auto& opt : stage.value().items())
+                {
+                    opts.remove(Option(opt.key(), ""));
+                    NL::json values = opt.value();
+                    if (!values.is_array())
+                        values = NL::json::array({ values });
+                    for (const NL::json& v : values)
+                        opts.add(opt.key(), v.is_string() ?
+                            v.get<std::string>() : v.dump());
+                }
+            }
+        }
+
+        std::istringstream in(m_pipeline);
+        manager.readPipeline(in);
+        PipelineManager::ExecResult r = manager.execute(m_mode);
+        if (r.m_mode == ExecMode::None)
+            throw pdal_error("Couldn't run pipeline in requested "
+                "execution mode.");
+        result["status"] = "ok";
+        result["stream"] = (r.m_mode == ExecMode::Stream);
+        // Points are only counted in standard mode.
+        if (r.m_mode == ExecMode::Standard)
+            result["points"] = r.m_count;
+    }
+    catch (const std::exception& err)
+    {
+        result["status"] = "error";
+        result["error"] = err.what();
+    }
+
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    result["seconds"] = elapsed.count();
+    return result.dump();
+}
+
+} // namespace pdal
@@ -34,7 +34,13 @@
 
 #include "SortKernel.hpp"
 
+#include <pdal/Reader.hpp>
 #include <pdal/Stage.hpp>
+#include <pdal/Streamable.hpp>
+#include <filters/StreamCallbackFilter.hpp>
+
+#include "../filters/private/ExternalSort.hpp"
+#include "private/SortKey.hpp"
 
 namespace pdal
 {
@@ -54,7 +60,8 @@ std::string SortKernel::getName() const
 }
 
 
-SortKernel::SortKernel() : m_bCompress(false), m_bForwardMetadata(false)
+SortKernel::SortKernel() : m_bCompress(false), m_bForwardMetadata(false),
+    m_memoryLimit(0)
 {}
 
 
@@ -67,20 +74,58 @@ void SortKernel::addSwitches(ProgramArgs& args)
     args.add("metadata,m",
         "Forward metadata (VLRs, header entries, etc) from previous stages",
         m_bForwardMetadata);
+    args.add("dimension,d", "Dimension on which to sort.  If not given, "
+        "points are sorted in Morton order", m_dimName);
+    args.add("order", "Sort order of a dimension: ASC(ending) or "
+        "DESC(ending)", m_order, "ASC");
+    args.add("memory_limit", "Memory in megabytes used to hold points.  "
+        "When given, points beyond the limit are sorted in temporary files "
+        "and merged", m_memoryLimit);
+    args.add("tmp_dir", "Directory for temporary files", m_tmpDir);
 }
 
 
-int SortKernel::execute()
+void SortKernel::validateSwitches(ProgramArgs&)
 {
-    Stage& readerStage = makeReader(m_inputFile, m_driverOverride);
-    Stage& sortStage = makeFilter("filters.mortonorder", readerStage);
+    m_order = Utils::toupper(m_order);
+    if (m_order != "ASC" && m_order != "DESC")
+        throw pdal_error("Invalid order '" + m_order + "'.  Must be 'ASC' "
+            "or 'DESC'.");
+}
+
 
+Options SortKernel::writerOptions() const
+{
     Options writerOptions;
     if (m_bCompress)
         writerOptions.add("compression", true);
     if (m_bForwardMetadata)
         writerOptions.add("forward_metadata", true);
-    Stage& writer = makeWriter(m_outputFile, sortStage, "", writerOptions);
+    return writerOptions;
+}
+
+
+int SortKernel::execute()
+{
+    if (m_memoryLimit)
+    {
+        externalSort();
+        return 0;
+    }
+
+    Stage& readerStage = makeReader(m_inputFile, m_driverOverride);
+    Stage *sortStage;
+    if (m_dimName.empty())
+        sortStage = &makeFilter("filters.mortonorder", readerStage);
+    else
+    {
+        Options sortOptions;
+        sortOptions.add("dimension", m_dimName);
+        sortOptions.add("order", m_order);
+        sortStage = &makeFilter("filters.sort", readerStage, sortOptions);
+    }
+
+    Stage& writer = makeWriter(m_outputFile, *sortStage, "", writerOptions());
 
     PointTable table;
     writer.prepare(table);
@@ -89,4 +134,125 @@ int SortKernel::execute()
     return 0;
 }
 
+
+namespace
+{
+
+// Reader that streams the points of an external sort in key order.
+class SortedReader : public Reader, public Streamable
+{
+public:
+    SortedReader(ExternalSort& sort, const SpatialReference& srs) :
+        m_sort(sort), m_srs(srs)
+    {}
+
+    std::string getName() const
+        { return "readers.sorted"; }
+
+private:
+    virtual void ready(PointTableRef)
+        { setSpatialReference(m_srs); }
+
+    virtual bool processOne(PointRef& point)
+        { return m_sort.next(point); }
+
+    virtual point_count_t read(PointViewPtr view, point_count_t count)
+    {
+        PointId idx = view->size();
+        point_count_t cnt = 0;
+        PointRef point(*view, idx);
+        while (cnt < count)
+        {
+            point.setPointId(idx);
+            if (!m_sort.next(point))
+                break;
+            idx++;
+            cnt++;
+        }
+        return cnt;
+    }
+
+    ExternalSort& m_sort;
+    SpatialReference m_srs;
+};
+
+} // unnamed namespace
+
+
+// Bounds used to compute Morton codes.  The bounds reported by the reader
+// are used when it can provide them without reading the points.
+// Otherwise they're found by streaming the input once.
+BOX2D SortKernel::sortBounds(Stage& reader)
+{
+    QuickInfo qi = reader.preview();
+    if (qi.valid() && qi.m_bounds.valid())
+        return qi.m_bounds.to2d();
+
+    BOX2D bounds;
+    Stage& boundsReader = makeReader(m_inputFile, m_driverOverride);
+    StreamCallbackFilter f;
+    f.setInput(boundsReader);
+    f.setCallback([&bounds](PointRef& point)
+    {
+        bounds.grow(point.getFieldAs<double>(Dimension::Id::X),
+            point.getFieldAs<double>(Dimension::Id::Y));
+        return true;
+    });
+
+    FixedPointTable table(10000);
+    f.prepare(table);
+    f.execute(table);
+    return bounds;
+}
+
+
+// Points are streamed from the reader into runs of the external sort and
+// then streamed from the merge of the runs to the writer.  Both pipelines
+// share a table so that reader metadata forwarded to the writer is kept.
+void SortKernel::externalSort()
+{
+    Stage& reader = makeReader(m_inputFile, m_driverOverride);
+    if (!reader.pipelineStreamable())
+        throw pdal_error("Reader for '" + m_inputFile + "' doesn't support "
+            "streaming, which is required with 'memory_limit'.");
+
+    BOX2D bounds;
+    if (m_dimName.empty())
+        bounds = sortBounds(reader);
+
+    SortKey key;
+    std::unique_ptr<ExternalSort> sort;
+
+    StreamCallbackFilter spill;
+    spill.setInput(reader);
+    spill.setCallback([&sort, &key](PointRef& point)
+    {
+        sort->add(point, key(point));
+        return true;
+    });
+
+    FixedPointTable table(10000);
+    spill.prepare(table);
+
+    PointLayoutPtr layout(table.layout());
+    if (m_dimName.empty())
+        key = mortonKey(bounds);
+    else
+        key = dimensionKey(layout, m_dimName, m_order == "DESC");
+
+    sort.reset(new ExternalSort(layout, m_memoryLimit * 1024 * 1024,
+        m_tmpDir));
+    spill.execute(table);
+    m_log->get(LogLevel::Debug) << "Sorted points in " << sort->runCount() <<
+        " temporary runs." << std::endl;
+
+    SortedReader sorted(*sort, reader.getSpatialReference());
+    Stage& writer = makeWriter(m_outputFile, sorted, "", writerOptions());
+    if (!writer.pipelineStreamable())
+        throw pdal_error("Writer for '" + m_outputFile + "' doesn't support "
+            "streaming, which is required with 'memory_limit'.");
+    writer.prepare(table);
+    writer.execute(table);
+}
+
 } // namespace pdal
@@ -48,11 +48,19 @@ public:
 
 private:
     void addSwitches(ProgramArgs& args);
+    void validateSwitches(ProgramArgs& args);
+    Options writerOptions() const;
+    void externalSort();
+    BOX2D sortBounds(Stage& reader);
 
     std::string m_inputFile;
     std::string m_outputFile;
     bool m_bCompress;
     bool m_bForwardMetadata;
+    std::string m_dimName;
+    std::string m_order;
+    uint64_t m_memoryLimit;
+    std::string m_tmpDir;
 };
 
 } // namespace pdal
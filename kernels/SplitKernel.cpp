@@ -34,10 +34,19 @@
 
 #include "SplitKernel.hpp"
 
+#include <cmath>
+#include <memory>
+
 #include <io/BufferReader.hpp>
+#include <filters/SplitterFilter.hpp>
+#include <filters/StreamCallbackFilter.hpp>
 #include <pdal/StageFactory.hpp>
+#include <pdal/util/FileUtils.hpp>
+#include <pdal/util/ThreadPool.hpp>
 #include <pdal/util/Utils.hpp>
 
+#include "private/TileRouter.hpp"
+
 namespace pdal
 {
 
@@ -66,6 +75,10 @@ void SplitKernel::addSwitches(ProgramArgs& args)
         std::numeric_limits<double>::quiet_NaN());
     args.add("origin_y", "Origin in Y axis for splitter cells", m_yOrigin,
         std::numeric_limits<double>::quiet_NaN());
+    args.add("threads", "Number of threads used to write output files "
+        "when splitting by length", m_threads, 1);
+    args.add("max_open_files", "Maximum number of temporary files held "
+        "open at once when splitting by length", m_maxOpenFiles, 256);
 }
 
 
@@ -75,6 +88,10 @@ void SplitKernel::validateSwitches(ProgramArgs& args)
         throw pdal_error("Can't specify both length and capacity.");
     if (!m_length && !m_capacity)
         m_capacity = 100000;
+    if (m_threads < 1)
+        throw pdal_error("Option 'threads' must be at least 1.");
+    if (m_maxOpenFiles < 1)
+        throw pdal_error("Option 'max_open_files' must be at least 1.");
     if (m_outputFile.back() == Utils::dirSeparator)
         m_outputFile += m_inputFile;
 }
@@ -94,11 +111,98 @@ std::string makeFilename(const std::string& s, int i)
 }
 
 
-int SplitKernel::execute()
+// Split by length without loading the input.  Points are streamed from
+// the reader and routed to temporary files for the cells they fall in.
+// The output files are then written from the temporary files in parallel.
+void SplitKernel::splitStreaming(Stage& reader)
 {
-    PointTable table;
+    FixedPointTable table(10000);
+
+    SplitterFilter splitter;
+    Options opts;
+    opts.add("length", m_length);
+    splitter.setOptions(opts);
+    splitter.prepare(table);
+
+    std::unique_ptr<TileRouter> router;
+    std::unique_ptr<TileRouter::Buffer> buffer;
+    auto adder = [&buffer](PointRef& point, int xpos, int ypos)
+        { buffer->add(point, TileRouter::Coord(xpos, ypos)); };
+
+    // Use the location of the first point as the origin, unless specified.
+    bool first(true);
+    StreamCallbackFilter f;
+    f.setInput(reader);
+    f.setCallback([&](PointRef& point)
+    {
+        if (first)
+        {
+            if (std::isnan(m_xOrigin))
+                m_xOrigin = point.getFieldAs<double>(Dimension::Id::X);
+            if (std::isnan(m_yOrigin))
+                m_yOrigin = point.getFieldAs<double>(Dimension::Id::Y);
+            splitter.setOrigin(m_xOrigin, m_yOrigin);
+            first = false;
+        }
+        splitter.processPoint(point, adder);
+        return true;
+    });
+    f.prepare(table);
 
+    std::string prefix =
+        FileUtils::getDirectory(FileUtils::toAbsolutePath(m_outputFile)) +
+        "/" + FileUtils::stem(m_outputFile) + "_split_";
+    router.reset(new TileRouter(table.layout(), prefix,
+        (size_t)m_maxOpenFiles));
+    buffer.reset(new TileRouter::Buffer(*router, table.layout()));
+    f.execute(table);
+    buffer->flush();
+
+    // Cells are numbered in the order of their first point, as when the
+    // input is split in memory.
+    const SpatialReference srs(table.anySpatialReference());
+    TileRouter::Tiles tiles = router->close();
+    ThreadPool pool(m_threads, -1, false);
+    for (size_t i = 0; i < tiles.size(); ++i)
+    {
+        std::string spillFilename(tiles[i].second);
+        std::string filename = makeFilename(m_outputFile, (int)i + 1);
+        pool.add([this, spillFilename, filename, &router, &srs]()
+        {
+            PointTable t;
+            router->registerDims(t.layout());
+            t.finalize();
+            PointViewPtr view = router->load(t, spillFilename);
+
+            PipelineManager manager;
+            manager.setLog(m_log);
+            manager.stageOptions() = m_manager.stageOptions();
+
+            BufferReader r;
+            r.addView(view);
+            r.setSpatialReference(srs);
+            Stage& w = manager.makeWriter(filename, "", r);
+            w.prepare(t);
+            w.execute(t);
+        });
+    }
+    pool.join();
+    router->remove();
+    if (pool.errors().size())
+        throw pdal_error(pool.errors().front());
+}
+
+
+int SplitKernel::execute()
+{
     Stage& reader = makeReader(m_inputFile, m_driverOverride);
+    if (m_length && reader.pipelineStreamable())
+    {
+        splitStreaming(reader);
+        return 0;
+    }
+
+    PointTable table;
 
     Options filterOpts;
     std::string driver = (m_length ? "filters.splitter" : "filters.chipper");
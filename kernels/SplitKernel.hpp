@@ -48,6 +48,7 @@ public:
 private:
     void addSwitches(ProgramArgs& args);
     void validateSwitches(ProgramArgs& args);
+    void splitStreaming(Stage& reader);
 
     std::string m_inputFile;
     std::string m_outputFile;
@@ -55,6 +56,8 @@ private:
     double m_length;
     double m_xOrigin;
     double m_yOrigin;
+    int m_threads;
+    int m_maxOpenFiles;
 };
 
 } // namespace pdal
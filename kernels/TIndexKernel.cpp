@@ -34,13 +34,18 @@
 
 #include "TIndexKernel.hpp"
 
+#include <condition_variable>
+#include <deque>
 #include <memory>
+#include <mutex>
 #include <vector>
 
+#include <pdal/FileInspector.hpp>
 #include <pdal/GDALUtils.hpp>
 #include <pdal/PDALUtils.hpp>
 #include <pdal/StageFactory.hpp>
 #include <pdal/util/FileUtils.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
 #include "../io/LasWriter.hpp"
 
@@ -56,6 +61,9 @@ void setDate(OGRFeatureH feature, const tm& tyme, int fieldNumber)
         tyme.tm_min, tyme.tm_sec, 100);
 }
 
+// Number of features inserted into the index per transaction.
+const int FeaturesPerTransaction = 1000;
+
 
 } // anonymous namespace
 
@@ -100,6 +108,10 @@ void TIndexKernel::addSubSwitches(ProgramArgs& args,
             m_filespec).setOptionalPositional();
         args.add("fast_boundary", "Use extent instead of exact boundary",
             m_fastBoundary);
+        args.add("threads", "Number of files to inspect concurrently",
+            m_threads, (size_t)1);
+        args.add("cache", "File in which to cache the extents of unchanged "
+            "files when using 'fast_boundary'", m_cacheFile);
         args.add("lyr_name", "OGR layer name to write into datasource",
             m_layerName);
         args.add("tindex_name", "Tile index column name", m_tileIndexColumnName,
@@ -193,34 +205,66 @@ StringList readSTDIN()
 }
 
 
-bool TIndexKernel::isFileIndexed(const FieldIndexes& indexes,
-    const FileInfo& fileInfo)
+// Read the filename, modification time and size of every file in the
+// index at once rather than querying the layer for each file.
+TIndexKernel::IndexEntries TIndexKernel::readIndex(const FieldIndexes& indexes)
 {
-    std::ostringstream qstring;
+    IndexEntries entries;
 
-    qstring << Utils::toupper(m_tileIndexColumnName) << "=" <<
-        "'" << fileInfo.m_filename << "'";
-    std::string query = qstring.str();
-    OGRErr err = OGR_L_SetAttributeFilter(m_layer, query.c_str());
-    if (err != OGRERR_NONE)
+    OGR_L_ResetReading(m_layer);
+    while (OGRFeatureH feature = OGR_L_GetNextFeature(m_layer))
     {
-        std::ostringstream oss;
-        oss << "Unable to set attribute filter for file '" <<
-             fileInfo.m_filename << "'";
-        throw pdal_error(oss.str());
+        IndexEntry entry {};
+        entry.m_fid = OGR_F_GetFID(feature);
+        if (indexes.m_mtime >= 0)
+        {
+            int *t = entry.m_mtime;
+            int tz;
+            OGR_F_GetFieldAsDateTime(feature, indexes.m_mtime,
+                t, t + 1, t + 2, t + 3, t + 4, t + 5, &tz);
+        }
+        entry.m_size = (indexes.m_size >= 0) ?
+            OGR_F_GetFieldAsInteger64(feature, indexes.m_size) : -1;
+        entries[OGR_F_GetFieldAsString(feature, indexes.m_filename)] = entry;
+        OGR_F_Destroy(feature);
     }
-
-    bool output(false);
     OGR_L_ResetReading(m_layer);
-    auto hFeat = OGR_L_GetNextFeature(m_layer);
-    if( hFeat )
+    return entries;
+}
+
+
+// Determine whether a file is in the index with its current modification
+// time and size.  A file in the index that has changed is removed from it
+// so that it can be indexed again.
+bool TIndexKernel::isFileCurrent(const FieldIndexes& indexes,
+    const IndexEntries& entries, const std::string& filename)
+{
+    auto it = entries.find(filename);
+    if (it == entries.end())
+        return false;
+    const IndexEntry& entry = it->second;
+
+    struct tm ctime, mtime;
+    FileUtils::fileTimes(filename, &ctime, &mtime);
+    int t[6] = { mtime.tm_year + 1900, mtime.tm_mon + 1, mtime.tm_mday,
+        mtime.tm_hour, mtime.tm_min, mtime.tm_sec };
+    // Some drivers (shapefile) only store the date.
+    int compare = indexes.m_mtimeIsDate ? 3 : 6;
+    bool current = (indexes.m_mtime < 0) ||
+        std::equal(t, t + compare, entry.m_mtime);
+    if (entry.m_size >= 0)
+        current = current &&
+            (uintmax_t)entry.m_size == FileUtils::fileSize(filename);
+
+    if (!current)
     {
-        OGR_F_Destroy(hFeat);
-        output = true;
+        m_log->get(LogLevel::Info) << "Reindexing changed file " <<
+            filename << std::endl;
+        if (OGR_L_DeleteFeature(m_layer, entry.m_fid) != OGRERR_NONE)
+            throw pdal_error("Unable to remove changed file '" + filename +
+                "' from the index.");
     }
-    OGR_L_ResetReading(m_layer);
-    OGR_L_SetAttributeFilter(m_layer, NULL);
-    return output;
+    return current;
 }
 
 
@@ -269,27 +313,131 @@ void TIndexKernel::createFile()
 
     FieldIndexes indexes = getFields();
 
+    // Features are only written from this thread, in transactions where
+    // the driver supports them.
+    int pending(0);
+    bool transaction(false);
+    auto index = [this, &indexes, &pending, &transaction](FileInfo& info)
+    {
+        if (!transaction)
+            transaction = (OGR_L_StartTransaction(m_layer) == OGRERR_NONE);
+        if (createFeature(indexes, info))
+            m_log->get(LogLevel::Info) << "Indexed file " <<
+                info.m_filename << std::endl;
+        else
+            m_log->get(LogLevel::Error) << "Failed to create feature "
+                "for file '" << info.m_filename << "'" << std::endl;
+        if (transaction && ++pending == FeaturesPerTransaction)
+        {
+            OGR_L_CommitTransaction(m_layer);
+            transaction = false;
+            pending = 0;
+        }
+    };
+
+    // Only files not already in the index or changed since they were
+    // indexed need to be inspected.
+    IndexEntries entries = readIndex(indexes);
     size_t filecount(0);
-    StageFactory factory(false);
+    StringList files;
     for (auto f : m_files)
     {
         //ABELL - Not sure why we need to get absolute path here.
         f = FileUtils::toAbsolutePath(f);
-        FileInfo info;
-        if (getFileInfo(factory, f, info))
+        if (isFileCurrent(indexes, entries, f))
+            filecount++;
+        else
+            files.push_back(f);
+    }
+
+    if (m_fastBoundary)
+    {
+        // The inspection can be done in parallel since it only reads
+        // file headers.
+        FileInspector inspector;
+        inspector.setThreads(m_threads);
+        inspector.setCacheFile(m_cacheFile);
+        inspector.setOptions(m_manager.commonOptions(),
+            m_manager.stageOptions());
+        for (const FileInspector::Result& r : inspector.inspect(files))
         {
+            FileInfo info;
+            if (!r.m_error.empty() || !fastBoundary(r.m_info, info))
+            {
+                auto& out = m_log->get(LogLevel::Error);
+                out << "Skipping file '" << r.m_filename <<
+                    "': can't compute boundary.";
+                if (r.m_error.size())
+                    out << " " << r.m_error;
+                out << std::endl;
+                continue;
+            }
+            FileUtils::fileTimes(r.m_filename, &info.m_ctime, &info.m_mtime);
+            info.m_size = FileUtils::fileSize(r.m_filename);
+            info.m_filename = r.m_filename;
             filecount++;
-            if (!isFileIndexed(indexes, info))
+            index(info);
+        }
+    }
+    else
+    {
+        // Compute exact boundaries on a pool of threads and hand them
+        // back to this thread to be written as they complete.
+        std::mutex mutex;
+        std::condition_variable ready;
+        std::deque<FileInfo> done;
+        size_t remaining(files.size());
+
+        StageFactory factory(false);
+        ThreadPool pool(m_threads);
+        for (const std::string& f : files)
+            pool.add([this, &factory, &f, &mutex, &ready, &done, &remaining]()
             {
-                if (createFeature(indexes, info))
-                    m_log->get(LogLevel::Info) << "Indexed file " << f <<
-                    std::endl;
-                else
-                    m_log->get(LogLevel::Error) << "Failed to create feature "
-                        "for file '" << f << "'" << std::endl;
+                FileInfo info;
+                bool ok(false);
+                try
+                {
+                    ok = getFileInfo(factory, f, info);
+                }
+                catch (const std::exception& err)
+                {
+                    m_log->get(LogLevel::Error) << "Skipping file '" << f <<
+                        "': " << err.what() << std::endl;
+                }
+                catch (...)
+                {
+                    m_log->get(LogLevel::Error) << "Skipping file '" << f <<
+                        "': unknown error." << std::endl;
+                }
+
+                std::lock_guard<std::mutex> lock(mutex);
+                if (ok)
+                    done.push_back(info);
+                remaining--;
+                ready.notify_one();
+            });
+
+        std::unique_lock<std::mutex> lock(mutex);
+        while (remaining || done.size())
+        {
+            ready.wait(lock, [&done, &remaining]()
+                { return done.size() || !remaining; });
+            while (done.size())
+            {
+                FileInfo info = done.front();
+                done.pop_front();
+                lock.unlock();
+                filecount++;
+                index(info);
+                lock.lock();
             }
         }
+        lock.unlock();
+        pool.join();
     }
+    if (transaction)
+        OGR_L_CommitTransaction(m_layer);
+
     if (!filecount)
         throw pdal_error("Couldn't index any files.");
     OGR_DS_Destroy(m_dataset);
@@ -430,6 +578,11 @@ bool TIndexKernel::createFeature(const FieldIndexes& indexes,
     OGR_F_SetFieldString(hFeature, indexes.m_filename,
         fileInfo.m_filename.c_str());
 
+    // Set the file size into the feature.
+    if (indexes.m_size >= 0)
+        OGR_F_SetFieldInteger64(hFeature, indexes.m_size,
+            (GIntBig)fileInfo.m_size);
+
     // Set the SRS into the feature.
     // We override if m_assignSrsString is set
     if (fileInfo.m_srs.empty() || m_overrideASrs)
@@ -493,9 +646,8 @@ bool TIndexKernel::createFeature(const FieldIndexes& indexes,
 }
 
 
-bool TIndexKernel::fastBoundary(Stage& reader, FileInfo& fileInfo)
+bool TIndexKernel::fastBoundary(const QuickInfo& qi, FileInfo& fileInfo)
 {
-    QuickInfo qi = reader.preview();
     if (!qi.valid())
         return false;
 
@@ -554,13 +706,14 @@ bool TIndexKernel::getFileInfo(StageFactory& factory,
     {
         fast = true;
     }
-    if (fast && !fastBoundary(reader, fileInfo))
+    if (fast && !fastBoundary(reader.preview(), fileInfo))
     {
         m_log->get(LogLevel::Error) << "Skipping file '" << filename <<
             "': can't compute boundary." << std::endl;
         return false;
     }
     FileUtils::fileTimes(filename, &fileInfo.m_ctime, &fileInfo.m_mtime);
+    fileInfo.m_size = FileUtils::fileSize(filename);
     fileInfo.m_filename = filename;
 
     return true;
@@ -647,6 +800,10 @@ void TIndexKernel::createFields()
     hFieldDefn = OGR_Fld_Create("created", OFTDateTime);
     OGR_L_CreateField(m_layer, hFieldDefn, TRUE);
     OGR_Fld_Destroy(hFieldDefn);
+
+    hFieldDefn = OGR_Fld_Create("size", OFTInteger64);
+    OGR_L_CreateField(m_layer, hFieldDefn, TRUE);
+    OGR_Fld_Destroy(hFieldDefn);
 }
 
 
@@ -678,6 +835,11 @@ TIndexKernel::FieldIndexes TIndexKernel::getFields()
 
     indexes.m_ctime = OGR_FD_GetFieldIndex(fDefn, "created");
     indexes.m_mtime = OGR_FD_GetFieldIndex(fDefn, "modified");
+    // Indexes created by older versions have no size field.
+    indexes.m_size = OGR_FD_GetFieldIndex(fDefn, "size");
+    indexes.m_mtimeIsDate = (indexes.m_mtime >= 0) &&
+        OGR_Fld_GetType(OGR_FD_GetFieldDefn(fDefn, indexes.m_mtime)) ==
+            OFTDate;
 
 //     /* Load in memory existing file names in SHP */
 //     int nExistingFiles = (int)OGR_L_GetFeatureCount(m_layer, FALSE);
@@ -34,6 +34,8 @@
 
 #pragma once
 
+#include <map>
+
 #include <pdal/Stage.hpp>
 #include <pdal/SubcommandKernel.hpp>
 #include <pdal/util/FileUtils.hpp>
@@ -58,6 +60,7 @@ class PDAL_DLL TIndexKernel : public SubcommandKernel
         std::string m_boundary;
         struct tm m_ctime;
         struct tm m_mtime;
+        uintmax_t m_size;
     };
 
     struct FieldIndexes
@@ -66,7 +69,18 @@ class PDAL_DLL TIndexKernel : public SubcommandKernel
         int m_srs;
         int m_ctime;
         int m_mtime;
+        int m_size;
+        bool m_mtimeIsDate;
+    };
+
+    // A file already in the index.
+    struct IndexEntry
+    {
+        long long m_fid;
+        int m_mtime[6];
+        long long m_size;
     };
+    using IndexEntries = std::map<std::string, IndexEntry>;
 
 public:
     std::string getName() const;
@@ -93,10 +107,12 @@ private:
     gdal::Geometry prepareGeometry(const std::string& wkt,
         const gdal::SpatialRef& inSrs, const gdal::SpatialRef& outSrs);
     void createFields();
-    bool fastBoundary(Stage& reader, FileInfo& fileInfo);
+    bool fastBoundary(const QuickInfo& qi, FileInfo& fileInfo);
     bool slowBoundary(Stage& hexer, FileInfo& fileInfo);
 
-    bool isFileIndexed( const FieldIndexes& indexes, const FileInfo& fileInfo);
+    IndexEntries readIndex(const FieldIndexes& indexes);
+    bool isFileCurrent(const FieldIndexes& indexes,
+        const IndexEntries& entries, const std::string& filename);
 
     std::string m_idxFilename;
     std::string m_filespec;
@@ -114,6 +130,8 @@ private:
     std::string m_tgtSrsString;
     std::string m_assignSrsString;
     bool m_fastBoundary;
+    size_t m_threads;
+    std::string m_cacheFile;
     bool m_usestdin;
     bool m_overrideASrs;
 };
@@ -34,10 +34,15 @@
 
 #include "TileKernel.hpp"
 
+#include <io/BufferReader.hpp>
+#include <pdal/PointView.hpp>
 #include <pdal/StageFactory.hpp>
 #include <pdal/StageWrapper.hpp>
 #include <pdal/Writer.hpp>
 #include <pdal/util/FileUtils.hpp>
+#include <pdal/util/ThreadPool.hpp>
+
+#include "private/TileRouter.hpp"
 
 namespace pdal
 {
@@ -75,6 +80,13 @@ void TileKernel::addSwitches(ProgramArgs& args)
         m_buffer);
     args.add("out_srs", "Output SRS to which points will be reprojected",
         m_outSrs);
+    args.add("threads", "Number of threads used to read input files and "
+        "write tiles.  More than one splits tiling into two passes through "
+        "temporary spill files", m_threads, 1);
+    args.add("max_open_files", "Maximum number of spill files held open "
+        "at once when using multiple threads", m_maxOpenFiles, 256);
+    args.add("spill_dir", "Directory for temporary spill files.  Defaults "
+        "to the output directory", m_spillDir);
 }
 
 
@@ -84,6 +96,10 @@ void TileKernel::validateSwitches(ProgramArgs& args)
     if (m_hashPos == std::string::npos)
         throw pdal_error("Output filename must contain a single '#' "
             "template placeholder.");
+    if (m_threads < 1)
+        throw pdal_error("Option 'threads' must be at least 1.");
+    if (m_maxOpenFiles < 1)
+        throw pdal_error("Option 'max_open_files' must be at least 1.");
 }
 
 
@@ -107,6 +123,12 @@ int TileKernel::execute()
     m_splitter.prepare(m_table);
 
     m_table.finalize();
+    if (m_threads > 1)
+    {
+        setOrigin(readers);
+        processParallel(readers);
+        return 0;
+    }
     process(readers);
     StageWrapper::done(m_splitter, m_table);
     for (auto&& wp : m_writers)
@@ -309,4 +331,180 @@ void TileKernel::adder(PointRef& point, int xpos, int ypos)
     StreamableWrapper::processOne(*sw, point);
 }
 
+
+// Set the origin to the first point of the first file, as process() does,
+// before the files are read in parallel.
+void TileKernel::setOrigin(const Readers& readers)
+{
+    StageWrapper::ready(m_splitter, m_table);
+    if (std::isnan(m_xOrigin) || std::isnan(m_yOrigin))
+    {
+        Streamable& r = *(readers.begin()->second);
+        PointRef point(m_table, 0);
+
+        StreamableWrapper::ready(r, m_table);
+        bool found = StreamableWrapper::processOne(r, point);
+        if (found && m_repro)
+        {
+            StreamableWrapper::spatialReferenceChanged(*m_repro,
+                r.getSpatialReference());
+            found = StreamableWrapper::processOne(*m_repro, point);
+            StreamableWrapper::done(*m_repro, m_table);
+        }
+        StreamableWrapper::done(r, m_table);
+        if (found)
+        {
+            if (std::isnan(m_xOrigin))
+                m_xOrigin = point.getFieldAs<double>(Dimension::Id::X);
+            if (std::isnan(m_yOrigin))
+                m_yOrigin = point.getFieldAs<double>(Dimension::Id::Y);
+        }
+    }
+    m_splitter.setOrigin(m_xOrigin, m_yOrigin);
+}
+
+
+// Tile in two passes.  First, the input files are read on separate threads
+// and their points are appended to a spill file per tile.  Then each tile
+// is read back and written on its own thread.  Neither pass needs more
+// than a bounded number of open files.
+void TileKernel::processParallel(const Readers& readers)
+{
+    // Without reprojection, the output SRS is that of the inputs.
+    SpatialReference srs(m_outSrs);
+    for (auto it = readers.begin(); srs.empty() && it != readers.end(); ++it)
+        srs = it->second->getSpatialReference();
+
+    std::string dir(m_spillDir);
+    if (dir.empty())
+        dir = FileUtils::getDirectory(FileUtils::toAbsolutePath(m_outputFile));
+    std::string prefix = dir + "/" +
+        FileUtils::stem(m_outputFile.substr(0, m_hashPos)) + "tile_";
+    TileRouter router(m_table.layout(), prefix, (size_t)m_maxOpenFiles);
+
+    ThreadPool pool(m_threads, -1, false);
+    for (auto& rp : readers)
+    {
+        const std::string& filename = rp.first;
+        pool.add([this, &filename, &router]()
+            { spillFile(filename, router); });
+    }
+    pool.await();
+
+    TileRouter::Tiles tiles = router.close();
+    if (pool.errors().empty())
+        for (auto& tile : tiles)
+        {
+            Coord loc(tile.first);
+            std::string spillFilename(tile.second);
+            pool.add([this, loc, spillFilename, &router, &srs]()
+                { writeTile(loc, spillFilename, router, srs); });
+        }
+    pool.join();
+
+    router.remove();
+    if (pool.errors().size())
+        throw pdal_error(pool.errors().front());
+}
+
+
+// Read a file, reprojecting if necessary, and route its points to the
+// spill files of the tiles they fall in.  Points are packed with the
+// dimensions of the layout of all inputs so that they can be read back
+// in writeTile().
+void TileKernel::spillFile(const std::string& filename, TileRouter& router)
+{
+    PipelineManager manager;
+    manager.setLog(m_log);
+    manager.stageOptions() = m_manager.stageOptions();
+
+    FixedPointTable table(m_table.capacity());
+    Streamable *r = dynamic_cast<Streamable *>(
+        &manager.makeReader(filename, ""));
+    if (!r)
+        throw pdal_error("Driver for input file '" + filename + "' is not "
+            "streamable.");
+    r->prepare(table);
+
+    Streamable *repro(nullptr);
+    if (m_repro)
+    {
+        Options opts;
+        opts.add("out_srs", m_outSrs);
+        repro = dynamic_cast<Streamable *>(
+            &manager.makeFilter("filters.reprojection", opts));
+        repro->prepare(table);
+    }
+
+    // Match the dimensions of this file to the dimensions of all inputs.
+    router.registerDims(table.layout());
+    table.finalize();
+
+    TileRouter::Buffer buffer(router, table.layout());
+    auto adder = [&buffer](PointRef& point, int xpos, int ypos)
+        { buffer.add(point, Coord(xpos, ypos)); };
+
+    StreamableWrapper::ready(*r, table);
+    if (repro)
+    {
+        StreamableWrapper::ready(*repro, table);
+        StreamableWrapper::spatialReferenceChanged(*repro,
+            r->getSpatialReference());
+    }
+
+    PointRef point(table, 0);
+    bool finished(false);
+    while (!finished)
+    {
+        PointId count(0);
+        for (; count < table.capacity(); ++count)
+        {
+            point.setPointId(count);
+            if (!StreamableWrapper::processOne(*r, point))
+            {
+                finished = true;
+                break;
+            }
+        }
+        for (PointId idx = 0; idx < count; ++idx)
+        {
+            point.setPointId(idx);
+            if (repro && !StreamableWrapper::processOne(*repro, point))
+                continue;
+            m_splitter.processPoint(point, adder);
+        }
+    }
+    StreamableWrapper::done(*r, table);
+    if (repro)
+        StreamableWrapper::done(*repro, table);
+
+    buffer.flush();
+}
+
+
+// Load the points of a tile from its spill file and write the tile.
+void TileKernel::writeTile(const Coord& loc, const std::string& spillFilename,
+    const TileRouter& router, const SpatialReference& srs)
+{
+    std::string filename(m_outputFile);
+    filename.replace(m_hashPos, 1,
+        std::to_string(loc.first) + "_" + std::to_string(loc.second));
+
+    PointTable table;
+    router.registerDims(table.layout());
+    table.finalize();
+    PointViewPtr view = router.load(table, spillFilename);
+
+    PipelineManager manager;
+    manager.setLog(m_log);
+    manager.stageOptions() = m_manager.stageOptions();
+
+    BufferReader reader;
+    reader.addView(view);
+    reader.setSpatialReference(srs);
+    Stage& w = manager.makeWriter(filename, "", reader);
+    w.prepare(table);
+    w.execute(table);
+}
+
 } // namespace pdal
@@ -42,6 +42,8 @@
 namespace pdal
 {
 
+class TileRouter;
+
 class PDAL_DLL TileKernel : public Kernel
 {
     using Coord = std::pair<int, int>;
@@ -59,6 +61,11 @@ private:
     void process(const Readers& readers);
     void checkReaders(const Readers& readers);
     void adder(PointRef& point, int xpos, int ypos);
+    void setOrigin(const Readers& readers);
+    void processParallel(const Readers& readers);
+    void spillFile(const std::string& filename, TileRouter& router);
+    void writeTile(const Coord& loc, const std::string& spillFilename,
+        const TileRouter& router, const SpatialReference& srs);
 
     std::string m_inputFile;
     std::string m_outputFile;
@@ -72,6 +79,9 @@ private:
     Streamable *m_repro;
     SpatialReference m_outSrs;
     std::string::size_type m_hashPos;
+    int m_threads;
+    int m_maxOpenFiles;
+    std::string m_spillDir;
 };
 
 } // namespace pdal
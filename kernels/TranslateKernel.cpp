@@ -43,8 +43,10 @@
 #include <pdal/PipelineReaderJSON.hpp>
 #include <pdal/Writer.hpp>
 #include <pdal/util/FileUtils.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -89,6 +91,8 @@ void TranslateKernel::addSwitches(ProgramArgs& args)
     args.add("writer,w", "Writer type", m_writerType);
     args.add("nostream", "Run in standard mode", m_noStream);
     args.add("stream", "Run in stream mode.  Error if not possible.", m_stream);
+    args.add("threads", "Number of input files to translate at once when "
+        "the input is a glob pattern", m_threads, 1);
 }
 
 
@@ -103,13 +107,17 @@ void TranslateKernel::validateSwitches(ProgramArgs&)
         m_mode = ExecMode::Standard;
     else
         m_mode = ExecMode::PreferStream;
+
+    if (m_threads < 1)
+        throw pdal_error("Option 'threads' must be at least 1.");
 }
 
 
 /*
   Build a pipeline from a JSON filter specification.
 */
-void TranslateKernel::makeJSONPipeline()
+void TranslateKernel::makeJSONPipeline(PipelineManager& manager,
+    const std::string& input, const std::string& output)
 {
     std::string json;
 
@@ -119,9 +127,9 @@ void TranslateKernel::makeJSONPipeline()
     if (json.empty())
         json = m_filterJSON;
     std::stringstream in(json);
-    m_manager.readPipeline(in);
+    manager.readPipeline(in);
 
-    std::vector<Stage *> roots = m_manager.roots();
+    std::vector<Stage *> roots = manager.roots();
     if (roots.size() > 1)
         throw pdal_error("Can't process pipeline with more than one root.");
 
@@ -130,31 +138,31 @@ void TranslateKernel::makeJSONPipeline()
         r = dynamic_cast<Reader *>(roots[0]);
     if (r)
     {
-        StageCreationOptions ops { m_inputFile, m_readerType, nullptr,
+        StageCreationOptions ops { input, m_readerType, nullptr,
             Options(), r->tag() };
-        m_manager.replace(r, &m_manager.makeReader(ops));
+        manager.replace(r, &manager.makeReader(ops));
     }
     else
     {
-        r = &m_manager.makeReader(m_inputFile, m_readerType);
+        r = &manager.makeReader(input, m_readerType);
         if (roots.size())
             roots[0]->setInput(*r);
     }
 
-    std::vector<Stage *> leaves = m_manager.leaves();
+    std::vector<Stage *> leaves = manager.leaves();
     if (leaves.size() != 1)
         throw pdal_error("Can't process pipeline with more than one "
             "terminal stage.");
 
     Stage *w = dynamic_cast<Writer *>(leaves[0]);
     if (w)
-        m_manager.replace(w, &m_manager.makeWriter(m_outputFile, m_writerType));
+        manager.replace(w, &manager.makeWriter(output, m_writerType));
     else
     {
         // We know we have a leaf because we added a reader.
-        StageCreationOptions ops { m_outputFile, m_writerType, leaves[0],
+        StageCreationOptions ops { output, m_writerType, leaves[0],
             Options(), "" };  // These last two args just keep compiler quiet.
-        m_manager.makeWriter(ops);
+        manager.makeWriter(ops);
     }
 }
 
@@ -162,12 +170,13 @@ void TranslateKernel::makeJSONPipeline()
 /*
   Build a pipeline from filters specified as command-line arguments.
 */
-void TranslateKernel::makeArgPipeline()
+void TranslateKernel::makeArgPipeline(PipelineManager& manager,
+    const std::string& input, const std::string& output)
 {
     std::string readerType(m_readerType);
     if (!readerType.empty() && !Utils::startsWith(readerType, "readers."))
         readerType.insert(0, "readers.");
-    Stage& reader = m_manager.makeReader(m_inputFile, readerType);
+    Stage& reader = manager.makeReader(input, readerType);
     Stage* stage = &reader;
 
     // add each filter provided on the command-line,
@@ -179,13 +188,92 @@ void TranslateKernel::makeArgPipeline()
         if (!Utils::startsWith(f, "filters."))
             filter_name.insert(0, "filters.");
 
-        Stage& filter = m_manager.makeFilter(filter_name, *stage);
+        Stage& filter = manager.makeFilter(filter_name, *stage);
         stage = &filter;
     }
     std::string writerType(m_writerType);
     if (!writerType.empty() && !Utils::startsWith(writerType, "writers."))
         writerType.insert(0, "writers.");
-    m_manager.makeWriter(m_outputFile, writerType, *stage);
+    manager.makeWriter(output, writerType, *stage);
+}
+
+
+void TranslateKernel::makePipeline(PipelineManager& manager,
+    const std::string& input, const std::string& output)
+{
+    if (!m_filterJSON.empty())
+        makeJSONPipeline(manager, input, output);
+    else
+        makeArgPipeline(manager, input, output);
+}
+
+
+/*
+  Translate each input file to the output template, replacing the '#' in
+  the template with the input's stem.  Files are run on a pool of
+  pipelines sharing this process's plugins and SRS transforms.  A failed
+  file is reported but doesn't stop the others.
+*/
+int TranslateKernel::executeBatch(const StringList& inputs)
+{
+    if (m_outputFile.find('#') == std::string::npos)
+        throw pdal_error("Output filename must contain a '#' placeholder "
+            "when translating multiple input files.");
+    if (m_pipelineOutputFile.size() || m_metadataFile.size())
+        throw pdal_error("Can't use 'pipeline' or 'metadata' options when "
+            "translating multiple input files.");
+
+    std::mutex mutex;
+    StringList failures;
+    size_t done(0);
+
+    ThreadPool pool(m_threads, -1, false);
+    for (const std::string& input : inputs)
+    {
+        std::string output(m_outputFile);
+        output.replace(output.find('#'), 1, FileUtils::stem(input));
+
+        pool.add([this, input, output, &mutex, &failures, &done, &inputs]()
+        {
+            std::string err;
+            try
+            {
+                PipelineManager manager;
+                manager.setLog(m_log);
+                manager.stageOptions() = m_manager.stageOptions();
+                makePipeline(manager, input, output);
+                if (manager.execute(m_mode).m_mode == ExecMode::None)
+                    err = "Couldn't run translation pipeline in requested "
+                        "execution mode.";
+            }
+            catch (const std::exception& e)
+            {
+                err = e.what();
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            done++;
+            if (err.size())
+            {
+                failures.push_back(input + ": " + err);
+                m_log->get(LogLevel::Error) << input << ": " << err <<
+                    std::endl;
+            }
+            else
+                m_log->get(LogLevel::Info) << "Translated '" << input <<
+                    "' to '" << output << "' (" << done << " of " <<
+                    inputs.size() << ")." << std::endl;
+        });
+    }
+    pool.join();
+
+    if (failures.size())
+    {
+        m_log->get(LogLevel::Error) << failures.size() << " of " <<
+            inputs.size() << " files failed to translate." << std::endl;
+        return 1;
+    }
+    return 0;
 }
 
 
@@ -196,6 +284,17 @@ int TranslateKernel::execute()
     if (m_filterJSON.size() && m_filterType.size())
         throw pdal_error("Cannot set both --filter options and --json options");
 
+    if (m_inputFile.find_first_of("*?") != std::string::npos)
+    {
+        StringList inputs = FileUtils::glob(m_inputFile);
+        if (inputs.empty())
+            throw pdal_error("No input files match '" + m_inputFile + "'.");
+        if (inputs.size() > 1 ||
+            m_outputFile.find('#') != std::string::npos)
+            return executeBatch(inputs);
+        m_inputFile = inputs.front();
+    }
+
     if (m_metadataFile.size())
     {
         if (m_pipelineOutputFile.size())
@@ -210,10 +309,7 @@ int TranslateKernel::execute()
         }
     }
 
-    if (!m_filterJSON.empty())
-        makeJSONPipeline();
-    else
-        makeArgPipeline();
+    makePipeline(m_manager, m_inputFile, m_outputFile);
 
     // If we write pipeline output, we don't run, and therefore don't write
     if (m_pipelineOutputFile.size() > 0)
@@ -55,8 +55,13 @@ public:
 private:
     virtual void addSwitches(ProgramArgs& args);
     virtual void validateSwitches(ProgramArgs& args);
-    void makeJSONPipeline();
-    void makeArgPipeline();
+    void makeJSONPipeline(PipelineManager& manager, const std::string& input,
+        const std::string& output);
+    void makeArgPipeline(PipelineManager& manager, const std::string& input,
+        const std::string& output);
+    void makePipeline(PipelineManager& manager, const std::string& input,
+        const std::string& output);
+    int executeBatch(const StringList& inputs);
 
     std::string m_inputFile;
     std::string m_outputFile;
@@ -69,6 +74,7 @@ private:
     bool m_noStream;
     bool m_stream;
     ExecMode m_mode;
+    int m_threads;
 };
 
 } // namespace pdal
@@ -0,0 +1,87 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include "SortKey.hpp"
+
+#include "../../filters/private/RadixSort.hpp"
+#include "../../filters/private/SpaceCurve.hpp"
+
+namespace pdal
+{
+
+SortKey mortonKey(const BOX2D& bounds)
+{
+    const double xrange = bounds.maxx - bounds.minx;
+    const double yrange = bounds.maxy - bounds.miny;
+    return [bounds, xrange, yrange](PointRef& point)
+    {
+        using namespace spacecurve;
+
+        return mortonCode(
+            gridPos(point.getFieldAs<double>(Dimension::Id::X),
+                bounds.minx, xrange),
+            gridPos(point.getFieldAs<double>(Dimension::Id::Y),
+                bounds.miny, yrange));
+    };
+}
+
+
+SortKey dimensionKey(const PointLayoutPtr layout, const std::string& dimName,
+    bool descending)
+{
+    Dimension::Id dim = layout->findDim(dimName);
+    if (dim == Dimension::Id::Unknown)
+        throw pdal_error("Dimension '" + dimName + "' not found.");
+    const uint64_t flip = descending ? ~0ull : 0;
+    switch (Dimension::base(layout->dimType(dim)))
+    {
+    case Dimension::BaseType::Signed:
+        return [dim, flip](PointRef& point)
+        {
+            return radix::orderedKey(point.getFieldAs<int64_t>(dim)) ^ flip;
+        };
+    case Dimension::BaseType::Unsigned:
+        return [dim, flip](PointRef& point)
+        {
+            return radix::orderedKey(point.getFieldAs<uint64_t>(dim)) ^ flip;
+        };
+    default:
+        return [dim, flip](PointRef& point)
+        {
+            return radix::orderedKey(point.getFieldAs<double>(dim)) ^ flip;
+        };
+    }
+}
+
+} // namespace pdal
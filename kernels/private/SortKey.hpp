@@ -0,0 +1,71 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#include <pdal/PointLayout.hpp>
+#include <pdal/PointRef.hpp>
+#include <pdal/util/Bounds.hpp>
+
+namespace pdal
+{
+
+/**
+  Key of a point in a sort order.  Keys are compared as unsigned integers,
+  so points are in order when their keys don't decrease.
+*/
+using SortKey = std::function<uint64_t(PointRef&)>;
+
+/**
+  Make the key of the Morton order of points.
+
+  \param bounds  Bounds over which the Morton grid is laid.
+*/
+SortKey mortonKey(const BOX2D& bounds);
+
+/**
+  Make the key of the order of points by the values of a dimension.
+
+  \param layout  Layout of the points.
+  \param dimName  Name of the dimension.
+  \param descending  Whether points are ordered by descending value.
+*/
+SortKey dimensionKey(const PointLayoutPtr layout, const std::string& dimName,
+    bool descending);
+
+} // namespace pdal
@@ -0,0 +1,164 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include "TileIndexQuery.hpp"
+
+#include <sstream>
+
+#include <pdal/GDALUtils.hpp>
+#include <pdal/PDALUtils.hpp>
+#include <pdal/util/FileUtils.hpp>
+
+namespace pdal
+{
+
+namespace
+{
+
+std::string optionValue(const Options& options, const std::string& name,
+    const std::string& def)
+{
+    StringList values = options.getValues(name);
+    return values.empty() ? def : values.front();
+}
+
+} // unnamed namespace
+
+
+// Defaults are those of readers.tindex.
+TileIndexQuery::TileIndexQuery(const Options& options) :
+    m_filename(optionValue(options, "filename", "")),
+    m_filterSrs(optionValue(options, "filter_srs", "EPSG:4326")),
+    m_outSrs(optionValue(options, "t_srs", "EPSG:4326")), m_sql(false),
+    m_dataset(nullptr), m_layer(nullptr)
+{
+    const std::string layerName(optionValue(options, "lyr_name", "pdal"));
+    const std::string column(optionValue(options, "tindex_name",
+        "location"));
+    const std::string sql(optionValue(options, "sql", ""));
+    const std::string dialect(optionValue(options, "dialect", "OGRSQL"));
+    const std::string where(optionValue(options, "where", ""));
+
+    gdal::registerDrivers();
+    m_dataset = OGROpen(m_filename.c_str(), FALSE, NULL);
+    if (!m_dataset)
+        throw pdal_error("Unable to open tile index '" + m_filename + "'.");
+
+    if (sql.size())
+    {
+        m_layer = OGR_DS_ExecuteSQL(m_dataset, sql.c_str(), nullptr,
+            dialect.c_str());
+        m_sql = true;
+    }
+    else
+        m_layer = OGR_DS_GetLayerByName(m_dataset, layerName.c_str());
+    if (!m_layer)
+    {
+        close();
+        throw pdal_error("Unable to open layer '" + layerName +
+            "' of tile index '" + m_filename + "'.");
+    }
+
+    if (m_outSrs.empty())
+    {
+        gdal::SpatialRef layerRef;
+        layerRef.setFromLayer(m_layer);
+        m_outSrs = layerRef.wkt();
+    }
+
+    if (where.size() &&
+            OGR_L_SetAttributeFilter(m_layer, where.c_str()) != OGRERR_NONE)
+    {
+        close();
+        throw pdal_error("Unable to set attribute filter '" + where +
+            "' on tile index '" + m_filename + "'.");
+    }
+
+    void *fDefn = OGR_L_GetLayerDefn(m_layer);
+    m_location = OGR_FD_GetFieldIndex(fDefn, column.c_str());
+    m_modified = OGR_FD_GetFieldIndex(fDefn, "modified");
+    m_size = OGR_FD_GetFieldIndex(fDefn, "size");
+    if (m_location < 0)
+    {
+        close();
+        throw pdal_error("Unable to find field '" + column +
+            "' in tile index '" + m_filename + "'.");
+    }
+}
+
+
+TileIndexQuery::~TileIndexQuery()
+{
+    close();
+}
+
+
+void TileIndexQuery::close()
+{
+    // A layer made by OGR_DS_ExecuteSQL must be released explicitly.
+    if (m_layer && m_sql)
+        OGR_DS_ReleaseResultSet(m_dataset, m_layer);
+    if (m_dataset)
+        OGR_DS_Destroy(m_dataset);
+    m_layer = nullptr;
+    m_dataset = nullptr;
+}
+
+
+std::map<std::string, std::string> TileIndexQuery::query(const BOX2D& bounds)
+{
+    gdal::SpatialRef filterRef(m_filterSrs);
+    gdal::Geometry g(bounds.toWKT(), filterRef);
+    g.transform(gdal::SpatialRef(m_outSrs));
+    OGR_L_SetSpatialFilter(m_layer, g.get());
+
+    std::map<std::string, std::string> tiles;
+    OGR_L_ResetReading(m_layer);
+    while (OGRFeatureH feature = OGR_L_GetNextFeature(m_layer))
+    {
+        const std::string location =
+            OGR_F_GetFieldAsString(feature, m_location);
+        std::ostringstream oss;
+        if (!Utils::isRemote(location) && FileUtils::fileExists(location))
+            oss << FileUtils::fileSize(location) << " " <<
+                FileUtils::lastWriteTime(location);
+        else if (m_modified >= 0 && m_size >= 0)
+            oss << OGR_F_GetFieldAsString(feature, m_size) << " " <<
+                OGR_F_GetFieldAsString(feature, m_modified);
+        tiles[location] = oss.str();
+        OGR_F_Destroy(feature);
+    }
+    return tiles;
+}
+
+} // namespace pdal
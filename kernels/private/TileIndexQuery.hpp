@@ -0,0 +1,90 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <map>
+#include <string>
+
+#include <pdal/Options.hpp>
+#include <pdal/util/Bounds.hpp>
+
+namespace pdal
+{
+
+/**
+  Finds the member files of a tile index that a readers.tindex stage reads
+  for given bounds, without reading them.  The index is queried as the
+  reader queries it.
+*/
+class TileIndexQuery
+{
+public:
+    /**
+      Open a tile index.
+
+      \param options  Options of the readers.tindex stage that reads the
+        index.
+    */
+    TileIndexQuery(const Options& options);
+    ~TileIndexQuery();
+
+    /**
+      Find the member files whose boundaries intersect bounds.
+
+      \param bounds  Bounds, in the SRS of the reader's 'filter_srs'.
+      \return  A map from the location of each member file to a string that
+        changes when the file changes: its size and modification time if
+        it's a local file, otherwise the size and modification time
+        recorded in the index.  The string is empty if neither is known.
+    */
+    std::map<std::string, std::string> query(const BOX2D& bounds);
+
+private:
+    void close();
+
+    std::string m_filename;
+    std::string m_filterSrs;
+    std::string m_outSrs;
+    bool m_sql;
+    void *m_dataset;
+    void *m_layer;
+    int m_location;
+    int m_modified;
+    int m_size;
+
+    TileIndexQuery(const TileIndexQuery&) = delete;
+    TileIndexQuery& operator=(const TileIndexQuery&) = delete;
+};
+
+} // namespace pdal
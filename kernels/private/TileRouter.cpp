@@ -0,0 +1,244 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include "TileRouter.hpp"
+
+#include <pdal/util/FileUtils.hpp>
+
+namespace pdal
+{
+
+namespace
+{
+
+// Bytes of points buffered per tile before they're appended to the tile's
+// spill file.
+const size_t SpillBufferSize = 1 << 20;
+
+} // unnamed namespace
+
+
+TileRouter::TileRouter(const PointLayoutPtr layout, const std::string& prefix,
+        size_t maxOpen) : m_dims(layout->dimTypes()), m_recordSize(0),
+    m_prefix(prefix), m_maxOpen(maxOpen)
+{
+    for (const DimType& dt : m_dims)
+    {
+        m_names.push_back(layout->dimName(dt.m_id));
+        m_recordSize += Dimension::size(dt.m_type);
+    }
+}
+
+
+TileRouter::~TileRouter()
+{
+    try
+    {
+        remove();
+    }
+    catch (...)
+    {}
+}
+
+
+// Find the file of a tile, adding the tile if it's new.  The caller must
+// hold the mutex.
+TileRouter::File& TileRouter::file(const Coord& loc)
+{
+    File& f = m_files[loc];
+    if (f.m_filename.empty())
+    {
+        f.m_filename = m_prefix + std::to_string(loc.first) + "_" +
+            std::to_string(loc.second) + ".spill";
+        m_order.push_back(loc);
+    }
+    return f;
+}
+
+
+// Note a tile when a buffer first sees it so that tiles are ordered by
+// their first point rather than by when their buffers are flushed.
+void TileRouter::addTile(const Coord& loc)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    file(loc);
+}
+
+
+void TileRouter::append(const Coord& loc, const char *data, size_t size)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    File& f = file(loc);
+    if (!f.m_stream)
+    {
+        if (m_lru.size() >= m_maxOpen)
+        {
+            m_files[m_lru.back()].m_stream.reset();
+            m_lru.pop_back();
+        }
+        // Truncate on first open, append after that.
+        std::ios::openmode mode = std::ios::binary | std::ios::out |
+            (f.m_opened ? std::ios::app : std::ios::trunc);
+        f.m_stream.reset(new std::ofstream(f.m_filename, mode));
+        if (!f.m_stream->good())
+            throw pdal_error("Couldn't open spill file '" +
+                f.m_filename + "'.");
+        f.m_opened = true;
+        m_lru.push_front(loc);
+        f.m_pos = m_lru.begin();
+    }
+    else if (f.m_pos != m_lru.begin())
+        m_lru.splice(m_lru.begin(), m_lru, f.m_pos);
+    f.m_stream->write(data, size);
+    if (!f.m_stream->good())
+        throw pdal_error("Couldn't write spill file '" +
+            f.m_filename + "'.");
+}
+
+
+TileRouter::Tiles TileRouter::close()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_lru.clear();
+    Tiles tiles;
+    for (const Coord& loc : m_order)
+    {
+        File& f = m_files[loc];
+        f.m_stream.reset();
+        tiles.push_back({ loc, f.m_filename });
+    }
+    return tiles;
+}
+
+
+void TileRouter::remove()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_lru.clear();
+    for (auto& fp : m_files)
+    {
+        fp.second.m_stream.reset();
+        if (fp.second.m_opened)
+            FileUtils::deleteFile(fp.second.m_filename);
+    }
+    m_files.clear();
+    m_order.clear();
+}
+
+
+void TileRouter::registerDims(PointLayoutPtr layout) const
+{
+    for (size_t i = 0; i < m_dims.size(); ++i)
+        layout->registerOrAssignDim(m_names[i], m_dims[i].m_type);
+}
+
+
+PointViewPtr TileRouter::load(PointTableRef table,
+    const std::string& filename) const
+{
+    PointLayoutPtr layout = table.layout();
+    std::vector<Dimension::Id> ids;
+    for (const std::string& name : m_names)
+        ids.push_back(layout->findDim(name));
+
+    PointViewPtr view(new PointView(table));
+    std::ifstream in(filename, std::ios::binary);
+    std::vector<char> record(m_recordSize);
+    PointId idx(0);
+    while (in.read(record.data(), record.size()))
+    {
+        const char *pos = record.data();
+        for (size_t i = 0; i < m_dims.size(); ++i)
+        {
+            view->setField(ids[i], m_dims[i].m_type, idx, pos);
+            pos += Dimension::size(m_dims[i].m_type);
+        }
+        idx++;
+    }
+    return view;
+}
+
+
+TileRouter::Buffer::Buffer(TileRouter& router, const PointLayoutPtr layout) :
+    m_router(router), m_record(router.m_recordSize)
+{
+    for (size_t i = 0; i < router.m_dims.size(); ++i)
+        m_ids.push_back(layout->findDim(router.m_names[i]));
+}
+
+
+void TileRouter::Buffer::add(PointRef& point, const Coord& loc)
+{
+    const DimTypeList& dims = m_router.m_dims;
+    char *pos = m_record.data();
+    for (size_t i = 0; i < dims.size(); ++i)
+    {
+        // Dimensions not in the point's layout are packed as zero.
+        if (m_ids[i] == Dimension::Id::Unknown)
+            std::fill(pos, pos + Dimension::size(dims[i].m_type), 0);
+        else
+            point.getField(pos, m_ids[i], dims[i].m_type);
+        pos += Dimension::size(dims[i].m_type);
+    }
+
+    auto it = m_buffers.find(loc);
+    if (it == m_buffers.end())
+    {
+        m_router.addTile(loc);
+        it = m_buffers.insert({ loc, std::vector<char>() }).first;
+    }
+    std::vector<char>& buf = it->second;
+    buf.insert(buf.end(), m_record.data(), pos);
+    if (buf.size() >= SpillBufferSize)
+    {
+        m_router.append(loc, buf.data(), buf.size());
+        buf.clear();
+    }
+}
+
+
+void TileRouter::Buffer::flush()
+{
+    for (auto& bp : m_buffers)
+        if (bp.second.size())
+        {
+            m_router.append(bp.first, bp.second.data(), bp.second.size());
+            bp.second.clear();
+        }
+}
+
+} // namespace pdal
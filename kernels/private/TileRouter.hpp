@@ -0,0 +1,142 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <fstream>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <pdal/PointView.hpp>
+
+namespace pdal
+{
+
+/**
+  Routes points to per-tile spill files of packed points and loads the
+  points of a tile back once all the points have been routed.  Points are
+  packed with the dimensions of a layout, matched by name, so points from
+  inputs with different layouts can be routed to the same tiles.  At most
+  a fixed number of spill files are held open; the least recently used is
+  closed to make room for another.  Routing may be done from several
+  threads, each with its own Buffer.
+*/
+class TileRouter
+{
+public:
+    using Coord = std::pair<int, int>;
+    /// Tiles and their spill files, in the order the tiles were first seen.
+    using Tiles = std::vector<std::pair<Coord, std::string>>;
+
+    /**
+      Buffer of packed points for each tile, appended to the spill files
+      as the buffers fill.  Not thread-safe: use one per thread.
+    */
+    class Buffer
+    {
+    public:
+        /**
+          \param router  Router to which points are written.
+          \param layout  Layout of the points that will be added.
+        */
+        Buffer(TileRouter& router, const PointLayoutPtr layout);
+
+        void add(PointRef& point, const Coord& loc);
+        void flush();
+
+    private:
+        TileRouter& m_router;
+        std::vector<Dimension::Id> m_ids;
+        std::vector<char> m_record;
+        std::map<Coord, std::vector<char>> m_buffers;
+    };
+
+    /**
+      \param layout  Layout whose dimensions are written for each point.
+      \param prefix  Prefix of the spill filenames.
+      \param maxOpen  Maximum number of spill files held open at once.
+    */
+    TileRouter(const PointLayoutPtr layout, const std::string& prefix,
+        size_t maxOpen);
+    ~TileRouter();
+
+    /// Close the spill files and return them.
+    Tiles close();
+
+    /// Register the dimensions of the packed points in a layout.
+    void registerDims(PointLayoutPtr layout) const;
+
+    /**
+      Load the points of a spill file into a new view.
+
+      \param table  Table whose layout has had registerDims() applied.
+      \param filename  Spill file.
+    */
+    PointViewPtr load(PointTableRef table, const std::string& filename) const;
+
+    /// Delete the spill files.
+    void remove();
+
+private:
+    struct File
+    {
+        File() : m_opened(false)
+        {}
+
+        std::string m_filename;
+        std::unique_ptr<std::ofstream> m_stream;
+        std::list<Coord>::iterator m_pos;
+        bool m_opened;
+    };
+
+    File& file(const Coord& loc);
+    void addTile(const Coord& loc);
+    void append(const Coord& loc, const char *data, size_t size);
+
+    DimTypeList m_dims;
+    StringList m_names;
+    size_t m_recordSize;
+    std::string m_prefix;
+    size_t m_maxOpen;
+    std::mutex m_mutex;
+    std::map<Coord, File> m_files;
+    std::vector<Coord> m_order;
+    std::list<Coord> m_lru;
+};
+
+} // namespace pdal
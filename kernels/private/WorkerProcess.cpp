@@ -0,0 +1,178 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include "WorkerProcess.hpp"
+
+#ifndef _WIN32
+#include <csignal>
+#include <fcntl.h>
+#include <mutex>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include <pdal/pdal_types.hpp>
+
+namespace pdal
+{
+
+#ifdef _WIN32
+
+WorkerProcess::WorkerProcess(const std::string&) :
+    m_pid(-1), m_in(nullptr), m_out(nullptr)
+{
+    throw pdal_error("Starting worker processes isn't supported on "
+        "Windows.");
+}
+
+
+WorkerProcess::~WorkerProcess()
+{}
+
+
+bool WorkerProcess::request(const std::string&, std::string&)
+{
+    return false;
+}
+
+
+void WorkerProcess::stop()
+{}
+
+#else
+
+WorkerProcess::WorkerProcess(const std::string& command) :
+    m_pid(-1), m_in(nullptr), m_out(nullptr)
+{
+    // A worker that exits would otherwise kill us with SIGPIPE when we
+    // write its next request.
+    std::signal(SIGPIPE, SIG_IGN);
+
+    // Our ends of the pipes must not be inherited by workers started
+    // later, or those workers would hold this worker's input open.  Pipes
+    // are created and marked one worker at a time so that a worker started
+    // from another thread can't inherit them in between.
+    static std::mutex startMutex;
+    std::lock_guard<std::mutex> lock(startMutex);
+
+    int toChild[2];
+    int fromChild[2];
+    if (pipe(toChild) != 0)
+        throw pdal_error("Can't create pipe to worker '" + command + "'.");
+    if (pipe(fromChild) != 0)
+    {
+        close(toChild[0]);
+        close(toChild[1]);
+        throw pdal_error("Can't create pipe from worker '" + command + "'.");
+    }
+
+    pid_t pid = fork();
+    if (pid < 0)
+    {
+        close(toChild[0]);
+        close(toChild[1]);
+        close(fromChild[0]);
+        close(fromChild[1]);
+        throw pdal_error("Can't start worker '" + command + "'.");
+    }
+    if (pid == 0)
+    {
+        dup2(toChild[0], STDIN_FILENO);
+        dup2(fromChild[1], STDOUT_FILENO);
+        close(toChild[0]);
+        close(toChild[1]);
+        close(fromChild[0]);
+        close(fromChild[1]);
+        execl("/bin/sh", "sh", "-c", command.c_str(), (char *)nullptr);
+        _exit(127);
+    }
+
+    close(toChild[0]);
+    close(fromChild[1]);
+    fcntl(toChild[1], F_SETFD, FD_CLOEXEC);
+    fcntl(fromChild[0], F_SETFD, FD_CLOEXEC);
+    m_pid = (int)pid;
+    m_in = fdopen(toChild[1], "w");
+    m_out = fdopen(fromChild[0], "r");
+    if (!m_in || !m_out)
+    {
+        stop();
+        throw pdal_error("Can't open pipes of worker '" + command + "'.");
+    }
+}
+
+
+WorkerProcess::~WorkerProcess()
+{
+    stop();
+}
+
+
+bool WorkerProcess::request(const std::string& request, std::string& reply)
+{
+    if (!m_in || !m_out)
+        return false;
+    if (std::fputs(request.c_str(), m_in) < 0 ||
+            std::fputc('\n', m_in) == EOF || std::fflush(m_in) != 0)
+        return false;
+
+    reply.clear();
+    int c;
+    while ((c = std::fgetc(m_out)) != EOF && c != '\n')
+        reply += (char)c;
+    return c == '\n';
+}
+
+
+void WorkerProcess::stop()
+{
+    // Closing the worker's input tells it that there are no more
+    // requests.
+    if (m_in)
+        std::fclose(m_in);
+    if (m_out)
+        std::fclose(m_out);
+    m_in = nullptr;
+    m_out = nullptr;
+    if (m_pid > 0)
+    {
+        int status;
+        waitpid((pid_t)m_pid, &status, 0);
+    }
+    m_pid = -1;
+}
+
+#endif
+
+} // namespace pdal
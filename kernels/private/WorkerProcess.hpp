@@ -0,0 +1,84 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <cstdio>
+#include <string>
+
+namespace pdal
+{
+
+/**
+  A child process, started through the shell, that answers each line
+  written to its standard input with a line on its standard output, as
+  'pdal serve' does.  The command may start the process on another host
+  (through ssh, for example).  Not supported on Windows.
+*/
+class WorkerProcess
+{
+public:
+    /**
+      Start a worker.
+
+      \param command  Shell command that starts the worker.
+    */
+    WorkerProcess(const std::string& command);
+
+    /**
+      Close the worker's input and wait for it to exit.
+    */
+    ~WorkerProcess();
+
+    /**
+      Send a request and wait for the reply.
+
+      \param request  Request, without a trailing newline.
+      \param reply  Reply, without the trailing newline.
+      \return  Whether a reply was read.  If not, the worker has exited
+        or closed its output.
+    */
+    bool request(const std::string& request, std::string& reply);
+
+private:
+    void stop();
+
+    int m_pid;
+    std::FILE *m_in;
+    std::FILE *m_out;
+
+    WorkerProcess(const WorkerProcess&) = delete;
+    WorkerProcess& operator=(const WorkerProcess&) = delete;
+};
+
+} // namespace pdal
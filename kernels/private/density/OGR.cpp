@@ -51,6 +51,9 @@ namespace pdal
 namespace
 {
 
+// Number of features written per transaction.
+const int FeaturesPerTransaction = 1000;
+
 void collectPath(hexer::Path* path, OGRGeometryH polygon)
 {
     OGRGeometryH ring = OGR_G_CreateGeometry(wkbLinearRing);
@@ -217,9 +220,14 @@ void OGR::writeBoundary(hexer::HexGrid *grid)
 
 void OGR::writeDensity(hexer::HexGrid *grid)
 {
+    // Features are written in transactions of FeaturesPerTransaction
+    // where the driver supports them.
     int counter(0);
+    bool transaction(false);
     for (hexer::HexIter iter = grid->hexBegin(); iter != grid->hexEnd(); ++iter)
     {
+        if (!transaction)
+            transaction = (OGR_L_StartTransaction(m_layer) == OGRERR_NONE);
 
         hexer::HexInfo hi = *iter;
         OGRGeometryH polygon = collectHexagon(hi, grid);
@@ -243,6 +251,25 @@ void OGR::writeDensity(hexer::HexGrid *grid)
         }
         OGR_F_Destroy( hFeature );
         counter++;
+        if (transaction && counter % FeaturesPerTransaction == 0)
+        {
+            commit();
+            transaction = false;
+        }
+    }
+    if (transaction)
+        commit();
+}
+
+
+void OGR::commit()
+{
+    if (OGR_L_CommitTransaction(m_layer) != OGRERR_NONE)
+    {
+        std::ostringstream oss;
+        oss << "Unable to commit density features with error '"
+            << CPLGetLastErrorMsg() << "'";
+        throw pdal::pdal_error(oss.str());
     }
 }
 
@@ -69,6 +69,7 @@ private:
     std::string m_layerName;
 
     void createLayer();
+    void commit();
 };
 
 } // namespace pdal
@@ -0,0 +1,370 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <array>
+
+#include <pdal/ArrowData.hpp>
+#include <pdal/PointTable.hpp>
+
+namespace pdal
+{
+namespace arrowdata
+{
+
+namespace
+{
+
+// Storage of an exported schema.  The schema and each of its children
+// hold a reference to the storage so that children can be moved out of
+// the schema and released separately, as the interface allows.
+struct SchemaData
+{
+    std::vector<std::string> m_names;
+    std::vector<ArrowSchema> m_children;
+    std::vector<ArrowSchema *> m_childPtrs;
+};
+using SchemaDataPtr = std::shared_ptr<SchemaData>;
+
+// Storage of an exported array, shared as with SchemaData.
+struct ArrayData
+{
+    PointViewPtr m_view;  // Owner of the columns that aren't copied.
+    std::vector<std::vector<char>> m_columns;  // Copied values.
+    std::vector<std::array<const void *, 2>> m_childBuffers;
+    std::vector<ArrowArray> m_children;
+    std::vector<ArrowArray *> m_childPtrs;
+    const void *m_buffers[1];
+};
+using ArrayDataPtr = std::shared_ptr<ArrayData>;
+
+void releaseChildSchema(ArrowSchema *schema)
+{
+    delete static_cast<SchemaDataPtr *>(schema->private_data);
+    schema->release = nullptr;
+}
+
+void releaseSchema(ArrowSchema *schema)
+{
+    SchemaDataPtr *data = static_cast<SchemaDataPtr *>(schema->private_data);
+    for (ArrowSchema *child : (*data)->m_childPtrs)
+        if (child->release)
+            child->release(child);
+    delete data;
+    schema->release = nullptr;
+}
+
+void releaseChildArray(ArrowArray *array)
+{
+    delete static_cast<ArrayDataPtr *>(array->private_data);
+    array->release = nullptr;
+}
+
+void releaseArray(ArrowArray *array)
+{
+    ArrayDataPtr *data = static_cast<ArrayDataPtr *>(array->private_data);
+    for (ArrowArray *child : (*data)->m_childPtrs)
+        if (child->release)
+            child->release(child);
+    delete data;
+    array->release = nullptr;
+}
+
+void exportSchema(const PointLayout& layout, ArrowSchema *schema)
+{
+    const Dimension::IdList& dims = layout.dims();
+
+    SchemaDataPtr data(new SchemaData);
+    // All names are added before their pointers are taken.
+    for (Dimension::Id id : dims)
+        data->m_names.push_back(layout.dimName(id));
+    data->m_children.resize(dims.size());
+    for (size_t i = 0; i < dims.size(); ++i)
+    {
+        ArrowSchema& child = data->m_children[i];
+        child.format = format(layout.dimType(dims[i]));
+        child.name = data->m_names[i].c_str();
+        child.metadata = nullptr;
+        child.flags = 0;
+        child.n_children = 0;
+        child.children = nullptr;
+        child.dictionary = nullptr;
+        child.release = releaseChildSchema;
+        child.private_data = new SchemaDataPtr(data);
+        data->m_childPtrs.push_back(&child);
+    }
+
+    schema->format = "+s";
+    schema->name = "";
+    schema->metadata = nullptr;
+    schema->flags = 0;
+    schema->n_children = (int64_t)dims.size();
+    schema->children = data->m_childPtrs.data();
+    schema->dictionary = nullptr;
+    schema->release = releaseSchema;
+    schema->private_data = new SchemaDataPtr(data);
+}
+
+// Fill an array with children whose values are the columns.
+void exportArray(ArrayDataPtr data, const std::vector<const void *>& columns,
+    point_count_t count, ArrowArray *array)
+{
+    data->m_childBuffers.resize(columns.size());
+    data->m_children.resize(columns.size());
+    for (size_t i = 0; i < columns.size(); ++i)
+    {
+        data->m_childBuffers[i] = {{ nullptr, columns[i] }};
+
+        ArrowArray& child = data->m_children[i];
+        child.length = (int64_t)count;
+        child.null_count = 0;
+        child.offset = 0;
+        child.n_buffers = 2;
+        child.n_children = 0;
+        child.buffers = data->m_childBuffers[i].data();
+        child.children = nullptr;
+        child.dictionary = nullptr;
+        child.release = releaseChildArray;
+        child.private_data = new ArrayDataPtr(data);
+        data->m_childPtrs.push_back(&child);
+    }
+    data->m_buffers[0] = nullptr;
+
+    array->length = (int64_t)count;
+    array->null_count = 0;
+    array->offset = 0;
+    array->n_buffers = 1;
+    array->n_children = (int64_t)columns.size();
+    array->buffers = data->m_buffers;
+    array->children = data->m_childPtrs.data();
+    array->dictionary = nullptr;
+    array->release = releaseArray;
+    array->private_data = new ArrayDataPtr(data);
+}
+
+// Get a pointer to the storage of a dimension of a column table, or
+// nullptr if the dimension isn't stored as its own type.
+struct ColumnData
+{
+    typedef const char *result_type;
+
+    BasePointTable& m_table;
+    Dimension::Id m_id;
+
+    ColumnData(BasePointTable& table, Dimension::Id id) :
+        m_table(table), m_id(id)
+    {}
+
+    template<typename T>
+    const char *operator()(T)
+    {
+        try
+        {
+            return reinterpret_cast<const char *>(
+                m_table.dimensionData<T>(m_id));
+        }
+        catch (const pdal_error&)
+        {
+            return nullptr;
+        }
+    }
+};
+
+bool consecutive(const PointView& view)
+{
+    const PointId base = view.tableIndex(0);
+    for (PointId idx = 1; idx < view.size(); ++idx)
+        if (view.tableIndex(idx) != base + idx)
+            return false;
+    return true;
+}
+
+// Value buffers must not be null, even when there are no values.
+const uint64_t NoValues = 0;
+
+} // unnamed namespace
+
+
+const char *format(Dimension::Type type)
+{
+    using Type = Dimension::Type;
+
+    switch (type)
+    {
+    case Type::Signed8:
+        return "c";
+    case Type::Unsigned8:
+        return "C";
+    case Type::Signed16:
+        return "s";
+    case Type::Unsigned16:
+        return "S";
+    case Type::Signed32:
+        return "i";
+    case Type::Unsigned32:
+        return "I";
+    case Type::Signed64:
+        return "l";
+    case Type::Unsigned64:
+        return "L";
+    case Type::Float:
+        return "f";
+    case Type::Double:
+        return "g";
+    default:
+        return nullptr;
+    }
+}
+
+
+Dimension::Type type(const char *format)
+{
+    using Type = Dimension::Type;
+
+    if (!format || !format[0] || format[1])
+        return Type::None;
+    switch (format[0])
+    {
+    case 'c':
+        return Type::Signed8;
+    case 'C':
+        return Type::Unsigned8;
+    case 's':
+        return Type::Signed16;
+    case 'S':
+        return Type::Unsigned16;
+    case 'i':
+        return Type::Signed32;
+    case 'I':
+        return Type::Unsigned32;
+    case 'l':
+        return Type::Signed64;
+    case 'L':
+        return Type::Unsigned64;
+    case 'f':
+        return Type::Float;
+    case 'g':
+        return Type::Double;
+    default:
+        return Type::None;
+    }
+}
+
+
+void exportView(PointViewPtr view, ArrowSchema *schema, ArrowArray *array)
+{
+    PointLayoutPtr layout = view->layout();
+    const Dimension::IdList& dims = layout->dims();
+    const point_count_t count = view->size();
+
+    ArrayDataPtr data(new ArrayData);
+    std::vector<const void *> columns(dims.size(), nullptr);
+
+    BasePointTable& table = view->table();
+    if (table.columnData() && count && consecutive(*view))
+    {
+        const PointId base = view->tableIndex(0);
+        for (size_t i = 0; i < dims.size(); ++i)
+        {
+            Dimension::Type type = layout->dimType(dims[i]);
+            const char *column =
+                Dimension::visit(type, ColumnData(table, dims[i]));
+            if (column)
+                columns[i] = column + base * Dimension::size(type);
+        }
+        data->m_view = view;
+    }
+
+    data->m_columns.resize(dims.size());
+    for (size_t i = 0; i < dims.size(); ++i)
+    {
+        if (columns[i])
+            continue;
+        if (!count)
+        {
+            columns[i] = &NoValues;
+            continue;
+        }
+
+        Dimension::Type type = layout->dimType(dims[i]);
+        const size_t size = Dimension::size(type);
+        std::vector<char>& values = data->m_columns[i];
+        values.resize(count * size);
+        for (PointId idx = 0; idx < count; ++idx)
+            view->getField(values.data() + idx * size, dims[i], type, idx);
+        columns[i] = values.data();
+    }
+
+    exportSchema(*layout, schema);
+    exportArray(data, columns, count, array);
+}
+
+
+void exportTable(StreamPointTable& table, ArrowSchema *schema,
+    ArrowArray *array)
+{
+    PointLayoutPtr layout = table.layout();
+    const Dimension::IdList& dims = layout->dims();
+
+    std::vector<PointId> ids;
+    for (PointId idx = 0; idx < table.numPoints(); ++idx)
+        if (!table.skip(idx))
+            ids.push_back(idx);
+
+    ArrayDataPtr data(new ArrayData);
+    std::vector<const void *> columns(dims.size(), &NoValues);
+    data->m_columns.resize(dims.size());
+    if (ids.size())
+        for (size_t i = 0; i < dims.size(); ++i)
+        {
+            Dimension::Type type = layout->dimType(dims[i]);
+            const size_t size = Dimension::size(type);
+            std::vector<char>& values = data->m_columns[i];
+            values.resize(ids.size() * size);
+
+            char *pos = values.data();
+            for (PointId idx : ids)
+            {
+                PointRef point(table, idx);
+                point.getField(pos, dims[i], type);
+                pos += size;
+            }
+            columns[i] = values.data();
+        }
+
+    exportSchema(*layout, schema);
+    exportArray(data, columns, ids.size(), array);
+}
+
+} // namespace arrowdata
+} // namespace pdal
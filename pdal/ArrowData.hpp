@@ -0,0 +1,148 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+
+#include <pdal/PointView.hpp>
+
+// Structures of the Arrow C data interface.  They're defined here, as by
+// every producer and consumer of the interface, so that no Arrow library
+// is needed.  See https://arrow.apache.org/docs/format/CDataInterface.html
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+extern "C"
+{
+
+struct ArrowSchema
+{
+    // Array type description
+    const char *format;
+    const char *name;
+    const char *metadata;
+    int64_t flags;
+    int64_t n_children;
+    struct ArrowSchema **children;
+    struct ArrowSchema *dictionary;
+
+    // Release callback
+    void (*release)(struct ArrowSchema *);
+    // Opaque producer-specific data
+    void *private_data;
+};
+
+struct ArrowArray
+{
+    // Array data description
+    int64_t length;
+    int64_t null_count;
+    int64_t offset;
+    int64_t n_buffers;
+    int64_t n_children;
+    const void **buffers;
+    struct ArrowArray **children;
+    struct ArrowArray *dictionary;
+
+    // Release callback
+    void (*release)(struct ArrowArray *);
+    // Opaque producer-specific data
+    void *private_data;
+};
+
+} // extern "C"
+
+#endif  // ARROW_C_DATA_INTERFACE
+
+namespace pdal
+{
+
+class StreamPointTable;
+
+namespace arrowdata
+{
+
+/**
+  Get the Arrow C data interface format string of a dimension type.
+
+  \param type  Dimension type.
+  \return  Format string, or nullptr for Type::None.
+*/
+PDAL_DLL const char *format(Dimension::Type type);
+
+/**
+  Get the dimension type of an Arrow C data interface format string.
+
+  \param format  Format string.
+  \return  Dimension type, or Type::None if the format isn't a fixed-size
+    number.
+*/
+PDAL_DLL Dimension::Type type(const char *format);
+
+/**
+  Export the points of a view as an Arrow struct array with one child
+  array per dimension.  When the view's table is a ColumnPointTable and
+  the view's points are consecutive in the table, the child arrays refer
+  to the table's columns and no point data is copied.  The view is kept
+  alive until the array is released.  Otherwise the values are copied.
+
+  The caller owns the exported structures and must call their release
+  callbacks.
+
+  \param view  View to export.
+  \param schema  Schema to fill.
+  \param array  Array to fill.
+*/
+PDAL_DLL void exportView(PointViewPtr view, ArrowSchema *schema,
+    ArrowArray *array);
+
+/**
+  Export the points of a stream table that haven't been skipped as an
+  Arrow struct array.  The values are copied, since a stream table's
+  storage is reused for the next batch of points.
+
+  \param table  Table to export.
+  \param schema  Schema to fill.
+  \param array  Array to fill.
+*/
+PDAL_DLL void exportTable(StreamPointTable& table, ArrowSchema *schema,
+    ArrowArray *array);
+
+} // namespace arrowdata
+} // namespace pdal
@@ -34,6 +34,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <memory>
 
 namespace pdal
@@ -44,6 +45,14 @@ class Artifact
 public:
     virtual ~Artifact()  // Need to make sure we have a virt. func. tbl.
     {}
+
+    /**
+      Get the number of bytes of memory held by the artifact that aren't
+      otherwise charged to a memory account.  The memory is charged to the
+      active account when the artifact is stored.
+    */
+    virtual std::size_t memoryUsed() const
+        { return 0; }
 };
 
 using ArtifactPtr = std::shared_ptr<Artifact>;
@@ -40,6 +40,7 @@
 #include <vector>
 
 #include <pdal/Artifact.hpp>
+#include <pdal/MemoryAccount.hpp>
 
 namespace pdal
 {
@@ -53,7 +54,10 @@ public:
 
     bool put(const std::string& name, ArtifactPtr artifact)
     {
-        return m_storage.insert(std::make_pair(name, artifact)).second;
+        if (!m_storage.insert(std::make_pair(name, artifact)).second)
+            return false;
+        charge(name, artifact);
+        return true;
     }
 
     template <typename T>
@@ -66,6 +70,7 @@ public:
         if (!std::dynamic_pointer_cast<T>(it->second))
             return false;
         it->second = art;
+        charge(name, art);
         return true;
     }
 
@@ -79,6 +84,7 @@ public:
 
     bool erase(const std::string& name)
     {
+        m_charges.erase(name);
         return m_storage.erase(name);
     }
 
@@ -108,7 +114,16 @@ public:
         return art;
     }
 private:
+    // Charge an artifact's memory to the active account.
+    void charge(const std::string& name, const ArtifactPtr& artifact)
+    {
+        std::size_t bytes = artifact ? artifact->memoryUsed() : 0;
+        if (bytes || m_charges.count(name))
+            m_charges[name].set(bytes);
+    }
+
     std::map<std::string, ArtifactPtr> m_storage;
+    std::map<std::string, MemoryCharge> m_charges;
 };
 
 } // namespace pdal
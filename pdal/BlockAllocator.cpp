@@ -0,0 +1,250 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <pdal/BlockAllocator.hpp>
+#include <pdal/util/Utils.hpp>
+
+namespace pdal
+{
+
+namespace
+{
+
+void throwAllocError(std::size_t size)
+{
+    throw pdal_error("Unable to allocate " + std::to_string(size) +
+        " bytes for point storage.");
+}
+
+} // unnamed namespace
+
+
+BlockAllocator::~BlockAllocator()
+{}
+
+
+char *HeapBlockAllocator::allocate(std::size_t size)
+{
+    char *buf = new (std::nothrow) char[size];
+    if (!buf)
+        throwAllocError(size);
+    memset(buf, 0, size);
+    return buf;
+}
+
+
+void HeapBlockAllocator::deallocate(char *buf, std::size_t /*size*/)
+{
+    delete [] buf;
+}
+
+
+#ifndef _WIN32
+
+char *MappedBlockAllocator::allocate(std::size_t size)
+{
+    if (!m_hugePages)
+    {
+        void *buf = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (buf == MAP_FAILED)
+            throwAllocError(size);
+        return static_cast<char *>(buf);
+    }
+
+    // Map extra space so that the block can start on a huge page boundary
+    // and unmap the unused ends.
+    std::size_t mapSize = size + HugePageSize;
+    void *buf = mmap(nullptr, mapSize, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (buf == MAP_FAILED)
+        throwAllocError(size);
+
+    char *start = static_cast<char *>(buf);
+    uintptr_t addr = reinterpret_cast<uintptr_t>(start);
+    char *aligned = start + (HugePageSize - addr % HugePageSize) % HugePageSize;
+    if (aligned > start)
+        munmap(start, aligned - start);
+    char *end = start + mapSize;
+    char *alignedEnd = aligned + size;
+    long pageSize = sysconf(_SC_PAGESIZE);
+    alignedEnd += (pageSize - (uintptr_t)alignedEnd % pageSize) % pageSize;
+    if (end > alignedEnd)
+        munmap(alignedEnd, end - alignedEnd);
+#ifdef MADV_HUGEPAGE
+    madvise(aligned, size, MADV_HUGEPAGE);
+#endif
+    return aligned;
+}
+
+
+void MappedBlockAllocator::deallocate(char *buf, std::size_t size)
+{
+    munmap(buf, size);
+}
+
+
+FileBlockAllocator::FileBlockAllocator(const std::string& dir,
+        std::size_t residentLimit) :
+    m_fd(-1), m_fileSize(0), m_residentLimit(residentLimit), m_resident(0)
+{
+    std::string path(dir);
+    if (path.empty() && Utils::getenv("TMPDIR", path) != 0)
+        path.clear();
+    if (path.empty())
+        path = "/tmp";
+
+    std::string filename = path + "/pdal_points_XXXXXX";
+    std::vector<char> buf(filename.begin(), filename.end());
+    buf.push_back('\0');
+    m_fd = mkstemp(buf.data());
+    if (m_fd < 0)
+        throw pdal_error("Unable to create point storage scratch file in "
+            "directory '" + path + "'.");
+    unlink(buf.data());
+}
+
+
+FileBlockAllocator::~FileBlockAllocator()
+{
+    if (m_fd >= 0)
+        close(m_fd);
+}
+
+
+char *FileBlockAllocator::allocate(std::size_t size)
+{
+    // File offsets must be page-aligned.
+    std::size_t pageSize = (std::size_t)sysconf(_SC_PAGESIZE);
+    std::size_t mapSize = ((size + pageSize - 1) / pageSize) * pageSize;
+
+    std::size_t offset = m_fileSize;
+    if (ftruncate(m_fd, (off_t)(offset + mapSize)) != 0)
+        throwAllocError(size);
+    m_fileSize += mapSize;
+
+    void *buf = mmap(nullptr, mapSize, PROT_READ | PROT_WRITE, MAP_SHARED,
+        m_fd, (off_t)offset);
+    if (buf == MAP_FAILED)
+        throwAllocError(size);
+    madvise(buf, mapSize, MADV_SEQUENTIAL);
+
+    m_residentBlocks.push_back({ static_cast<char *>(buf), mapSize, offset });
+    m_resident += mapSize;
+    while (m_residentLimit && m_resident > m_residentLimit &&
+        m_residentBlocks.size() > 1)
+    {
+        release(m_residentBlocks.front());
+        m_residentBlocks.pop_front();
+    }
+    return static_cast<char *>(buf);
+}
+
+
+// Write a block to the file and drop its pages from memory.  The mapping
+// remains valid and pages are read back in when touched.
+void FileBlockAllocator::release(const Block& block)
+{
+    msync(block.m_buf, block.m_size, MS_SYNC);
+    madvise(block.m_buf, block.m_size, MADV_DONTNEED);
+#ifdef POSIX_FADV_DONTNEED
+    posix_fadvise(m_fd, (off_t)block.m_offset, (off_t)block.m_size,
+        POSIX_FADV_DONTNEED);
+#endif
+    m_resident -= block.m_size;
+}
+
+
+void FileBlockAllocator::deallocate(char *buf, std::size_t size)
+{
+    for (auto it = m_residentBlocks.begin(); it != m_residentBlocks.end(); ++it)
+        if (it->m_buf == buf)
+        {
+            m_resident -= it->m_size;
+            m_residentBlocks.erase(it);
+            break;
+        }
+    munmap(buf, size);
+}
+
+#else
+
+char *MappedBlockAllocator::allocate(std::size_t size)
+{
+    return HeapBlockAllocator().allocate(size);
+}
+
+
+void MappedBlockAllocator::deallocate(char *buf, std::size_t size)
+{
+    HeapBlockAllocator().deallocate(buf, size);
+}
+
+
+
+FileBlockAllocator::FileBlockAllocator(const std::string& /*dir*/,
+        std::size_t residentLimit) :
+    m_fd(-1), m_fileSize(0), m_residentLimit(residentLimit), m_resident(0)
+{}
+
+
+FileBlockAllocator::~FileBlockAllocator()
+{}
+
+
+char *FileBlockAllocator::allocate(std::size_t size)
+{
+    return HeapBlockAllocator().allocate(size);
+}
+
+
+void FileBlockAllocator::deallocate(char *buf, std::size_t size)
+{
+    HeapBlockAllocator().deallocate(buf, size);
+}
+
+#endif
+
+} // namespace pdal
@@ -0,0 +1,161 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <string>
+
+#include <pdal/pdal_internal.hpp>
+
+namespace pdal
+{
+
+/**
+  Source of the memory blocks that store point data in a PointTable.
+  Blocks must be zero-filled.
+*/
+class PDAL_DLL BlockAllocator
+{
+public:
+    virtual ~BlockAllocator();
+
+    /**
+      Allocate a zero-filled block of memory.  Throws pdal_error if the
+      memory can't be allocated.
+
+      \param size  Size of the block in bytes.
+      \return  Pointer to the block.
+    */
+    virtual char *allocate(std::size_t size) = 0;
+
+    /**
+      Release a block returned by allocate().
+
+      \param buf  Pointer to the block.
+      \param size  Size of the block as passed to allocate().
+    */
+    virtual void deallocate(char *buf, std::size_t size) = 0;
+
+    /**
+      Determine whether blocks are backed by a file rather than memory.
+      Memory of file-backed blocks isn't charged to memory accounts.
+
+      \return  Whether blocks are backed by a file.
+    */
+    virtual bool fileBacked() const
+        { return false; }
+};
+typedef std::shared_ptr<BlockAllocator> BlockAllocatorPtr;
+
+/**
+  Allocates blocks from the heap.  This is the default allocator.
+*/
+class PDAL_DLL HeapBlockAllocator : public BlockAllocator
+{
+public:
+    virtual char *allocate(std::size_t size);
+    virtual void deallocate(char *buf, std::size_t size);
+};
+
+/**
+  Maps blocks of anonymous memory.  Pages aren't touched when a block is
+  allocated, so on NUMA systems each page is placed on the node of the
+  thread that first writes to it.  When huge pages are requested, blocks
+  are aligned and the kernel is advised to back them with transparent huge
+  pages, reducing TLB misses when accessing large tables.  Falls back to
+  heap allocation where memory mapping isn't available.
+*/
+class PDAL_DLL MappedBlockAllocator : public BlockAllocator
+{
+public:
+    MappedBlockAllocator(bool hugePages = false) : m_hugePages(hugePages)
+    {}
+
+    virtual char *allocate(std::size_t size);
+    virtual void deallocate(char *buf, std::size_t size);
+
+    static const std::size_t HugePageSize = 2 * 1024 * 1024;
+
+private:
+    bool m_hugePages;
+};
+
+/**
+  Maps blocks from a scratch file so that point storage isn't limited by
+  the available memory.  The scratch file is unlinked as soon as it's
+  created and so is removed when the allocator is destroyed, even on abnormal
+  exit.  Blocks are advised for sequential access.  When the size of the
+  blocks allocated exceeds the resident limit, the oldest blocks are
+  written to the file and released from memory.  They're read back when
+  accessed.  Falls back to heap allocation where memory mapping isn't
+  available.
+*/
+class PDAL_DLL FileBlockAllocator : public BlockAllocator
+{
+public:
+    /**
+      \param dir  Directory in which to create the scratch file.  If empty,
+        the directory named by TMPDIR, or /tmp, is used.
+      \param residentLimit  Maximum number of bytes of allocated blocks to
+        keep in memory.  Zero means no limit.
+    */
+    FileBlockAllocator(const std::string& dir = "",
+        std::size_t residentLimit = 0);
+    virtual ~FileBlockAllocator();
+
+    virtual char *allocate(std::size_t size);
+    virtual void deallocate(char *buf, std::size_t size);
+    virtual bool fileBacked() const
+        { return true; }
+
+private:
+    struct Block
+    {
+        char *m_buf;
+        std::size_t m_size;
+        std::size_t m_offset;
+    };
+
+    void release(const Block& block);
+
+    int m_fd;
+    std::size_t m_fileSize;
+    std::size_t m_residentLimit;
+    std::size_t m_resident;
+    std::deque<Block> m_residentBlocks;
+};
+
+} // namespace pdal
@@ -104,6 +104,14 @@ size_t DbReader::dimOffset(Dimension::Id id) const
 
 void DbReader::writeField(PointView& view, const char *pos, const DimType& dim,
     PointId idx)
+{
+    PointRef point(view, idx);
+    writeField(point, pos, dim);
+}
+
+
+void DbReader::writeField(PointRef& point, const char *pos,
+    const DimType& dim)
 {
     using namespace Dimension;
 
@@ -114,10 +122,10 @@ void DbReader::writeField(PointView& view, const char *pos, const DimType& dim,
         memcpy(&e, pos, Dimension::size(dim.m_type));
         double d = Utils::toDouble(e, dim.m_type);
         d = (d * dim.m_xform.m_scale.m_val) + dim.m_xform.m_offset.m_val;
-        view.setField(dim.m_id, idx, d);
+        point.setField(dim.m_id, d);
     }
     else
-        view.setField(dim.m_id, dim.m_type, idx, pos);
+        point.setField(dim.m_id, dim.m_type, pos);
 }
 
 
@@ -126,10 +134,20 @@ void DbReader::writeField(PointView& view, const char *pos, const DimType& dim,
 /// \param[in] idx  Index of point to write.
 /// \param[in] buf  Pointer to packed DB point data.
 void DbReader::writePoint(PointView& view, PointId idx, const char *buf)
+{
+    PointRef point(view, idx);
+    writePoint(point, buf);
+}
+
+
+/// Write a point's packed data into a point reference.
+/// \param[in] point  Point to write to.
+/// \param[in] buf  Pointer to packed DB point data.
+void DbReader::writePoint(PointRef& point, const char *buf)
 {
     for (auto di = m_dims.begin(); di != m_dims.end(); ++di)
     {
-        writeField(view, buf, di->m_dimType, idx);
+        writeField(point, buf, di->m_dimType);
         buf += Dimension::size(di->m_dimType.m_type);
     }
 }
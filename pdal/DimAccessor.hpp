@@ -0,0 +1,188 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <cstring>
+
+#include <pdal/PointView.hpp>
+
+namespace pdal
+{
+
+/**
+  Accessor for the values of one dimension of the points in a view.
+
+  The dimension's offset and storage type are resolved once, when the
+  accessor is created.  When the requested type matches the storage type,
+  access is a direct load or store of the value in the point's packed data.
+  Otherwise, and for tables that don't store packed points that stay in
+  place (see BasePointTable::packedPoints()), access falls back to
+  PointView::getFieldAs() and PointView::setField().  forEach()
+  loads values of any other storage type from the packed data with a loop
+  instantiated for that type, so the type is only examined once.
+
+  An accessor is only valid while the view and its layout are unchanged.
+*/
+template<typename T>
+class DimAccessor
+{
+public:
+    /**
+      Create an accessor.
+
+      \param view  View containing the points to access.
+      \param id  ID of the dimension to access.
+    */
+    DimAccessor(const PointView& view, Dimension::Id id) :
+        m_view(const_cast<PointView&>(view)), m_id(id), m_offset(0),
+        m_type(Dimension::Type::None), m_direct(false)
+    {
+        PointLayoutPtr layout = view.layout();
+        if (layout->hasDim(id) &&
+            view.table().packedPoints() &&
+            !layout->dimDetail(id)->quantized())
+        {
+            m_offset = layout->dimOffset(id);
+            m_type = layout->dimType(id);
+            m_direct = (m_type == Dimension::typeOf<T>());
+        }
+    }
+
+    /**
+      Get the value of the dimension for a point.
+
+      \param idx  ID of the point in the view.
+      \return  Value of the dimension.
+    */
+    T get(PointId idx) const
+    {
+        if (!m_direct)
+            return m_view.getFieldAs<T>(m_id, idx);
+        T t;
+        std::memcpy(&t, m_view.getPoint(idx) + m_offset, sizeof(T));
+        return t;
+    }
+
+    /**
+      Set the value of the dimension for a point.
+
+      \param idx  ID of the point in the view.
+      \param val  Value to set.
+    */
+    void set(PointId idx, T val) const
+    {
+        if (!m_direct || idx >= m_view.size())
+            m_view.setField(m_id, idx, val);
+        else
+        {
+            m_view.detach();
+            std::memcpy(m_view.getPoint(idx) + m_offset, &val, sizeof(T));
+        }
+    }
+
+    /**
+      Call a function with the value of the dimension for each point of
+      the view, in order.
+
+      \param f  Function called with the ID of a point and its value.
+    */
+    template<typename FUNC>
+    void forEach(FUNC f) const
+    {
+        const point_count_t size = m_view.size();
+        if (m_direct)
+        {
+            for (PointId idx = 0; idx < size; ++idx)
+            {
+                T t;
+                std::memcpy(&t, m_view.getPoint(idx) + m_offset, sizeof(T));
+                f(idx, t);
+            }
+        }
+        else if (m_type != Dimension::Type::None)
+            Dimension::visit(m_type, StoredLoop<FUNC>(*this, f));
+        else
+        {
+            for (PointId idx = 0; idx < size; ++idx)
+                f(idx, m_view.getFieldAs<T>(m_id, idx));
+        }
+    }
+
+    /**
+      Determine whether values are loaded and stored directly.
+
+      \return  Whether access doesn't require type conversion.
+    */
+    bool direct() const
+        { return m_direct; }
+
+private:
+    // Loop over packed values stored as type S, converting each to T.
+    template<typename FUNC>
+    struct StoredLoop
+    {
+        typedef void result_type;
+
+        StoredLoop(const DimAccessor& acc, FUNC& f) : m_acc(acc), m_f(f)
+        {}
+
+        template<typename S>
+        void operator()(S) const
+        {
+            const point_count_t size = m_acc.m_view.size();
+            for (PointId idx = 0; idx < size; ++idx)
+            {
+                S s;
+                T t;
+                std::memcpy(&s, m_acc.m_view.getPoint(idx) + m_acc.m_offset,
+                    sizeof(S));
+                // Let getFieldAs() report values that don't convert.
+                if (!Utils::numericCast(s, t))
+                    t = m_acc.m_view.getFieldAs<T>(m_acc.m_id, idx);
+                m_f(idx, t);
+            }
+        }
+
+        const DimAccessor& m_acc;
+        FUNC& m_f;
+    };
+
+    PointView& m_view;
+    Dimension::Id m_id;
+    std::size_t m_offset;
+    Dimension::Type m_type;
+    bool m_direct;
+};
+
+} // namespace pdal
@@ -34,7 +34,12 @@
 
 #pragma once
 
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
 #include <pdal/Dimension.hpp>
+#include <pdal/pdal_types.hpp>
 
 namespace pdal
 {
@@ -44,7 +49,8 @@ namespace Dimension
 class Detail
 {
 public:
-    Detail() : m_id(Id::Unknown), m_offset(-1), m_type(Type::None)
+    Detail() : m_id(Id::Unknown), m_offset(-1), m_type(Type::None),
+        m_scale(0), m_quantOffset(0)
     {}
     //NOTE - This is strange, but for some reason things run faster with
     // this NOOP virtual dtor.  Perhaps it has something to do with
@@ -71,10 +77,43 @@ public:
     BaseType base() const
         { return Dimension::base(m_type); }
 
+    // A quantized dimension of type double is stored as a 32-bit integer
+    // (value - offset) / scale.  A scale of 0 turns quantization off.
+    void setQuantization(double scale, double offset)
+    {
+        m_scale = scale;
+        m_quantOffset = offset;
+    }
+    bool quantized() const
+        { return m_scale != 0; }
+    double scale() const
+        { return m_scale; }
+    double quantOffset() const
+        { return m_quantOffset; }
+    // Size of the value as stored in a point table.
+    size_t storageSize() const
+        { return quantized() ? sizeof(int32_t) : size(); }
+
+    int32_t toStored(double d) const
+    {
+        const double v = std::round((d - m_quantOffset) / m_scale);
+        if (!(v >= (double)(std::numeric_limits<int32_t>::lowest)() &&
+                v <= (double)(std::numeric_limits<int32_t>::max)()))
+            throw pdal_error("Value " + std::to_string(d) + " of dimension '" +
+                Dimension::name(m_id) + "' can't be stored with scale " +
+                std::to_string(m_scale) + " and offset " +
+                std::to_string(m_quantOffset) + ".");
+        return static_cast<int32_t>(v);
+    }
+    double fromStored(int32_t i) const
+        { return i * m_scale + m_quantOffset; }
+
 private:
     Id m_id;
     int m_offset;
     Type m_type;
+    double m_scale;
+    double m_quantOffset;
 };
 typedef std::vector<Detail> DetailList;
 
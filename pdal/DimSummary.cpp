@@ -0,0 +1,96 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/DimSummary.hpp>
+
+#include <pdal/DimAccessor.hpp>
+#include <pdal/PointView.hpp>
+#include <pdal/util/TaskScheduler.hpp>
+
+namespace pdal
+{
+
+namespace
+{
+
+// Views smaller than this are summarized on the calling thread, as are
+// the points of each range.
+const point_count_t MinRangeSize = 1 << 20;
+
+} // unnamed namespace
+
+DimSummaryList summarizeDims(const PointView& view,
+    const Dimension::IdList& dims, unsigned threads)
+{
+    const point_count_t size = view.size();
+    if (threads == 0)
+        threads = (unsigned)TaskScheduler::instance().concurrency();
+    const point_count_t ranges = (std::max)(point_count_t(1),
+        (std::min)(point_count_t(threads), size / MinRangeSize));
+
+    std::vector<DimAccessor<double>> accessors;
+    for (Dimension::Id id : dims)
+        accessors.emplace_back(view, id);
+
+    auto summarize = [&accessors](PointId begin, PointId end,
+        DimSummaryList& out)
+    {
+        out.resize(accessors.size());
+        for (PointId idx = begin; idx < end; ++idx)
+            for (std::size_t d = 0; d < accessors.size(); ++d)
+                out[d].add(accessors[d].get(idx));
+    };
+
+    DimSummaryList result;
+    if (ranges == 1)
+    {
+        summarize(0, size, result);
+        return result;
+    }
+
+    std::vector<DimSummaryList> partials(ranges);
+    parallelFor(ranges, ranges, [&summarize, &partials, size, ranges](
+            std::size_t r)
+        {
+            summarize(size * r / ranges, size * (r + 1) / ranges,
+                partials[r]);
+        });
+
+    result = partials[0];
+    for (point_count_t r = 1; r < ranges; ++r)
+        for (std::size_t d = 0; d < result.size(); ++d)
+            result[d].merge(partials[r][d]);
+    return result;
+}
+
+} // namespace pdal
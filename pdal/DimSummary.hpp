@@ -0,0 +1,107 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <limits>
+#include <vector>
+
+#include <pdal/pdal_internal.hpp>
+#include <pdal/Dimension.hpp>
+
+namespace pdal
+{
+
+class PointView;
+
+/**
+  Minimum, maximum, sum, sum of squares and count of the values of a
+  dimension.  As with BOX3D::grow(), NaN values don't affect the minimum
+  and maximum.
+*/
+struct PDAL_DLL DimSummary
+{
+    DimSummary() : minimum((std::numeric_limits<double>::max)()),
+        maximum((std::numeric_limits<double>::lowest)()), sum(0), sumSq(0),
+        count(0)
+    {}
+
+    void add(double v)
+    {
+        if (v < minimum)
+            minimum = v;
+        if (v > maximum)
+            maximum = v;
+        sum += v;
+        sumSq += v * v;
+        count++;
+    }
+
+    void merge(const DimSummary& other)
+    {
+        if (other.minimum < minimum)
+            minimum = other.minimum;
+        if (other.maximum > maximum)
+            maximum = other.maximum;
+        sum += other.sum;
+        sumSq += other.sumSq;
+        count += other.count;
+    }
+
+    double mean() const
+        { return sum / count; }
+
+    double minimum;
+    double maximum;
+    double sum;
+    double sumSq;
+    point_count_t count;
+};
+using DimSummaryList = std::vector<DimSummary>;
+
+/**
+  Summarize the values of dimensions of the points in a view.  Large views
+  are divided into ranges of points that are summarized on separate
+  threads, and the partial summaries are merged in point order.
+
+  \param view  View containing the points.
+  \param dims  Dimensions to summarize.  Dimensions that the view doesn't
+    have read as 0, as with PointView::getFieldAs().
+  \param threads  Maximum number of threads used.  When 0, one thread per
+    core is used.
+  \return  Summary of each dimension, in the order of \a dims.
+*/
+PDAL_DLL DimSummaryList summarizeDims(const PointView& view,
+    const Dimension::IdList& dims, unsigned threads = 0);
+
+} // namespace pdal
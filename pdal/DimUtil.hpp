@@ -103,6 +103,60 @@ inline BaseType base(Type t)
     return BaseType(Utils::toNative(t) & 0xFF00);
 }
 
+/// Get the dimension type that stores values of a C++ type.
+/// \return  Dimension type, or Type::None if there is no matching type.
+template<typename T>
+constexpr Type typeOf()
+    { return Type::None; }
+
+template<> constexpr Type typeOf<int8_t>()
+    { return Type::Signed8; }
+template<> constexpr Type typeOf<int16_t>()
+    { return Type::Signed16; }
+template<> constexpr Type typeOf<int32_t>()
+    { return Type::Signed32; }
+template<> constexpr Type typeOf<int64_t>()
+    { return Type::Signed64; }
+template<> constexpr Type typeOf<uint8_t>()
+    { return Type::Unsigned8; }
+template<> constexpr Type typeOf<uint16_t>()
+    { return Type::Unsigned16; }
+template<> constexpr Type typeOf<uint32_t>()
+    { return Type::Unsigned32; }
+template<> constexpr Type typeOf<uint64_t>()
+    { return Type::Unsigned64; }
+template<> constexpr Type typeOf<float>()
+    { return Type::Float; }
+template<> constexpr Type typeOf<double>()
+    { return Type::Double; }
+
+/// The C++ type that stores values of a dimension type.  This is the
+/// inverse of typeOf().  There is no value_type for Type::None.
+template<Type T>
+struct TypeTraits
+{};
+
+template<> struct TypeTraits<Type::Signed8>
+    { typedef int8_t value_type; };
+template<> struct TypeTraits<Type::Signed16>
+    { typedef int16_t value_type; };
+template<> struct TypeTraits<Type::Signed32>
+    { typedef int32_t value_type; };
+template<> struct TypeTraits<Type::Signed64>
+    { typedef int64_t value_type; };
+template<> struct TypeTraits<Type::Unsigned8>
+    { typedef uint8_t value_type; };
+template<> struct TypeTraits<Type::Unsigned16>
+    { typedef uint16_t value_type; };
+template<> struct TypeTraits<Type::Unsigned32>
+    { typedef uint32_t value_type; };
+template<> struct TypeTraits<Type::Unsigned64>
+    { typedef uint64_t value_type; };
+template<> struct TypeTraits<Type::Float>
+    { typedef float value_type; };
+template<> struct TypeTraits<Type::Double>
+    { typedef double value_type; };
+
 static const int COUNT = (std::numeric_limits<uint16_t>::max)();
 static const int PROPRIETARY = 0xF000;
 
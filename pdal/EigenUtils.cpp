@@ -34,43 +34,228 @@
 
 #include <pdal/EigenUtils.hpp>
 #include <pdal/GDALUtils.hpp>
+#include <pdal/Gpu.hpp>
+#include <pdal/KDIndex.hpp>
 #include <pdal/PointView.hpp>
 #include <pdal/SpatialReference.hpp>
 #include <pdal/util/Bounds.hpp>
+#include <pdal/util/TaskScheduler.hpp>
 #include <pdal/util/Utils.hpp>
 
+#include <algorithm>
 #include <cfloat>
+#include <cmath>
 #include <numeric>
 #include <vector>
 
 namespace pdal
 {
 
-#pragma warning (push)
-#pragma warning (disable: 4244)
+namespace
+{
 
-void calculateBounds(const PointView& view, BOX2D& output)
+// Rasters smaller than this are processed on the calling thread.
+const size_t MinThreadedCells = 1 << 16;
+
+struct Raster
 {
-    for (PointId idx = 0; idx < view.size(); idx++)
+    Raster(size_t rows, size_t cols, double fill) :
+        m_rows(rows), m_cols(cols), m_data(rows * cols, fill)
+    {}
+
+    double& at(size_t row, size_t col)
+        { return m_data[col * m_rows + row]; }
+
+    size_t m_rows;
+    size_t m_cols;
+    std::vector<double> m_data;
+};
+
+// Replace each value of a line by the extreme of the values at offsets
+// [lo, hi] from it, using the van Herk/Gil-Werman block scheme: three
+// comparisons per value whatever the width of the window.  Positions off
+// the line contribute 'identity'.
+template<typename Op>
+class SlidingExtreme
+{
+public:
+    SlidingExtreme(int lo, int hi, double identity, Op op) :
+        m_lo(lo), m_width(hi - lo + 1), m_identity(identity), m_op(op)
+    {}
+
+    void operator()(std::vector<double>& line)
     {
-        double x = view.getFieldAs<double>(Dimension::Id::X, idx);
-        double y = view.getFieldAs<double>(Dimension::Id::Y, idx);
+        const size_t n = line.size();
+        const size_t w = (size_t)m_width;
+        const size_t m = n + w - 1;
+
+        m_x.resize(m);
+        for (size_t s = 0; s < m; ++s)
+        {
+            const ptrdiff_t src = (ptrdiff_t)s + m_lo;
+            m_x[s] = (src >= 0 && src < (ptrdiff_t)n) ? line[src] : m_identity;
+        }
 
-        output.grow(x, y);
+        // Running extremes from the start (g) and to the end (h) of each
+        // block of w values.
+        m_g.resize(m);
+        m_h.resize(m);
+        for (size_t s = 0; s < m; ++s)
+            m_g[s] = (s % w == 0) ? m_x[s] : m_op(m_g[s - 1], m_x[s]);
+        for (size_t s = m; s-- > 0;)
+            m_h[s] = (s % w == w - 1 || s == m - 1) ?
+                m_x[s] : m_op(m_h[s + 1], m_x[s]);
+
+        for (size_t t = 0; t < n; ++t)
+            line[t] = m_op(m_h[t], m_g[t + w - 1]);
     }
+
+private:
+    int m_lo;
+    int m_width;
+    double m_identity;
+    Op m_op;
+    std::vector<double> m_x;
+    std::vector<double> m_g;
+    std::vector<double> m_h;
+};
+
+// Apply a sliding extreme over offsets [lo, hi] along every line of the
+// raster running in the direction (dRow, dCol), where dRow is 0 or 1.
+// Lines are independent, so they are split into ranges among threads.
+template<typename Op>
+void linePass(Raster& raster, int dRow, int dCol, int lo, int hi,
+    double identity, Op op, unsigned threads)
+{
+    const ptrdiff_t rows = (ptrdiff_t)raster.m_rows;
+    const ptrdiff_t cols = (ptrdiff_t)raster.m_cols;
+
+    // A line starts at each cell whose predecessor is off the raster.  When
+    // lines run down the columns only the first row and the edge columns
+    // hold starts, so stop scanning a column at its first non-start.
+    std::vector<std::pair<ptrdiff_t, ptrdiff_t>> starts;
+    for (ptrdiff_t c = 0; c < cols; ++c)
+        for (ptrdiff_t r = 0; r < rows; ++r)
+        {
+            const ptrdiff_t pr = r - dRow;
+            const ptrdiff_t pc = c - dCol;
+            if (pr < 0 || pc < 0 || pc >= cols)
+                starts.emplace_back(r, c);
+            else if (dRow == 1)
+                break;
+        }
+
+    auto run = [&](size_t begin, size_t end)
+    {
+        SlidingExtreme<Op> extreme(lo, hi, identity, op);
+        std::vector<double> line;
+        for (size_t i = begin; i < end; ++i)
+        {
+            line.clear();
+            ptrdiff_t r = starts[i].first;
+            ptrdiff_t c = starts[i].second;
+            for (; r < rows && c >= 0 && c < cols; r += dRow, c += dCol)
+                line.push_back(raster.at(r, c));
+            extreme(line);
+            r = starts[i].first;
+            c = starts[i].second;
+            for (double v : line)
+            {
+                raster.at(r, c) = v;
+                r += dRow;
+                c += dCol;
+            }
+        }
+    };
+
+    if (threads == 0)
+        threads = (unsigned)TaskScheduler::instance().concurrency();
+    if (raster.m_data.size() < MinThreadedCells)
+        threads = 1;
+    const size_t ranges = (std::min)((size_t)threads, starts.size());
+    parallelFor(ranges, ranges, [&run, &starts, ranges](size_t i)
+        {
+            run(starts.size() * i / ranges, starts.size() * (i + 1) / ranges);
+        });
+}
+
+// The diamond of a given radius (the cells within that many 4-connected
+// steps) splits into the cells an even and an odd number of diagonal steps
+// away.  Each set is a square on the lattice spanned by the diagonals
+// (1, 1) and (1, -1), so it separates into two diagonal line passes.  The
+// raster is padded by the radius so that the squares are never clipped
+// where the diamond itself is not.
+template<typename Op>
+std::vector<double> diamond(const std::vector<double>& data, size_t rows,
+    size_t cols, int radius, double identity, Op op, unsigned threads)
+{
+    if (radius <= 0 || data.empty())
+        return data;
+
+    const size_t pad = (size_t)radius;
+    Raster even(rows + 2 * pad, cols + 2 * pad, identity);
+    for (size_t c = 0; c < cols; ++c)
+        for (size_t r = 0; r < rows; ++r)
+            even.at(r + pad, c + pad) = data[c * rows + r];
+    Raster odd(even);
+
+    const int half = radius / 2;
+    linePass(even, 1, 1, -half, half, identity, op, threads);
+    linePass(even, 1, -1, -half, half, identity, op, threads);
+
+    // The odd cells are one row below the square spanning diagonal steps
+    // in [-(radius + 1) / 2, (radius - 1) / 2].
+    const int lo = -(radius + 1) / 2;
+    const int hi = (radius - 1) / 2;
+    linePass(odd, 1, 1, lo, hi, identity, op, threads);
+    linePass(odd, 1, -1, lo, hi, identity, op, threads);
+
+    std::vector<double> out(data.size());
+    for (size_t c = 0; c < cols; ++c)
+        for (size_t r = 0; r < rows; ++r)
+            out[c * rows + r] = op(even.at(r + pad, c + pad),
+                odd.at(r + pad + 1, c + pad));
+    return out;
 }
 
+template<typename Op>
+std::vector<double> square(const std::vector<double>& data, size_t rows,
+    size_t cols, int radius, double identity, Op op, unsigned threads)
+{
+    if (radius <= 0 || data.empty())
+        return data;
+
+    Raster raster(rows, cols, identity);
+    raster.m_data = data;
+    linePass(raster, 1, 0, -radius, radius, identity, op, threads);
+    linePass(raster, 0, 1, -radius, radius, identity, op, threads);
+    return raster.m_data;
+}
 
-void calculateBounds(const PointView& view, BOX3D& output)
+double maxOf(double a, double b)
 {
-    for (PointId idx = 0; idx < view.size(); idx++)
-    {
-        double x = view.getFieldAs<double>(Dimension::Id::X, idx);
-        double y = view.getFieldAs<double>(Dimension::Id::Y, idx);
-        double z = view.getFieldAs<double>(Dimension::Id::Z, idx);
+    return a > b ? a : b;
+}
 
-        output.grow(x, y, z);
-    }
+double minOf(double a, double b)
+{
+    return a < b ? a : b;
+}
+
+} // unnamed namespace
+
+#pragma warning (push)
+#pragma warning (disable: 4244)
+
+void calculateBounds(const PointView& view, BOX2D& output)
+{
+    view.calculateBounds(output);
+}
+
+
+void calculateBounds(const PointView& view, BOX3D& output)
+{
+    view.calculateBounds(output);
 }
 
 PointViewPtr demeanPointView(const PointView& view)
@@ -211,6 +396,169 @@ Eigen::Matrix3d computeCovariance(const PointView& view,
     return A * A.transpose() / (ids.size()-1);
 }
 
+Eigen::Matrix3d computeCovariance(const double *coords, const PointId *ids,
+    point_count_t count, Eigen::Vector3d *centroid)
+{
+    double mx(0.0), my(0.0), mz(0.0);
+    for (point_count_t i = 0; i < count; ++i)
+    {
+        const double *p = coords + ids[i] * 3;
+        mx += p[0];
+        my += p[1];
+        mz += p[2];
+    }
+    if (count)
+    {
+        mx /= count;
+        my /= count;
+        mz /= count;
+    }
+
+    // Sum the products of the demeaned coordinates.  Only the six distinct
+    // entries of the symmetric matrix are computed.
+    double xx(0.0), xy(0.0), xz(0.0), yy(0.0), yz(0.0), zz(0.0);
+    for (point_count_t i = 0; i < count; ++i)
+    {
+        const double *p = coords + ids[i] * 3;
+        double dx = p[0] - mx;
+        double dy = p[1] - my;
+        double dz = p[2] - mz;
+        xx += dx * dx;
+        xy += dx * dy;
+        xz += dx * dz;
+        yy += dy * dy;
+        yz += dy * dz;
+        zz += dz * dz;
+    }
+
+    // A single point has no spread.
+    const double n = (count > 1) ? (double)(count - 1) : 1.0;
+    Eigen::Matrix3d B;
+    B << xx / n, xy / n, xz / n,
+         xy / n, yy / n, yz / n,
+         xz / n, yz / n, zz / n;
+    if (centroid)
+        *centroid << mx, my, mz;
+    return B;
+}
+
+bool computeEigen3(const Eigen::Matrix3d& A, Eigen::Vector3d& values,
+    Eigen::Matrix3d& vectors)
+{
+    double a[3][3];
+    for (int r = 0; r < 3; ++r)
+        for (int c = r; c < 3; ++c)
+            a[r][c] = a[c][r] = A(r, c);
+    double v[3][3] = { { 1, 0, 0 }, { 0, 1, 0 }, { 0, 0, 1 } };
+
+    for (int r = 0; r < 3; ++r)
+        for (int c = r; c < 3; ++c)
+            if (!std::isfinite(a[r][c]))
+                return false;
+
+    // Each sweep zeroes each of the off-diagonal entries in turn.  The
+    // entries converge to zero quadratically, so a handful of sweeps are
+    // needed.  The rotation that zeroes a[p][q] is that of Numerical
+    // Recipes' jacobi().
+    static const int pairs[3][2] = { { 0, 1 }, { 0, 2 }, { 1, 2 } };
+    for (int sweep = 0; sweep < 32; ++sweep)
+    {
+        const double off = a[0][1] * a[0][1] + a[0][2] * a[0][2] +
+            a[1][2] * a[1][2];
+        const double diag = a[0][0] * a[0][0] + a[1][1] * a[1][1] +
+            a[2][2] * a[2][2];
+        if (off <= DBL_EPSILON * DBL_EPSILON * diag)
+            break;
+
+        for (auto& pair : pairs)
+        {
+            const int p = pair[0];
+            const int q = pair[1];
+            const int r = 3 - p - q;
+            const double apq = a[p][q];
+            if (apq == 0.0)
+                continue;
+
+            const double theta = (a[q][q] - a[p][p]) / (2.0 * apq);
+            double t = 1.0 / (std::fabs(theta) + std::sqrt(theta * theta + 1.0));
+            if (theta < 0.0)
+                t = -t;
+            const double c = 1.0 / std::sqrt(t * t + 1.0);
+            const double s = t * c;
+
+            a[p][p] -= t * apq;
+            a[q][q] += t * apq;
+            a[p][q] = a[q][p] = 0.0;
+            const double arp = a[r][p];
+            const double arq = a[r][q];
+            a[r][p] = a[p][r] = c * arp - s * arq;
+            a[r][q] = a[q][r] = s * arp + c * arq;
+            for (int k = 0; k < 3; ++k)
+            {
+                const double vkp = v[k][p];
+                const double vkq = v[k][q];
+                v[k][p] = c * vkp - s * vkq;
+                v[k][q] = s * vkp + c * vkq;
+            }
+        }
+    }
+
+    // Sort the eigenvalues, and their eigenvectors, in increasing order.
+    int order[3] = { 0, 1, 2 };
+    if (a[order[1]][order[1]] < a[order[0]][order[0]])
+        std::swap(order[0], order[1]);
+    if (a[order[2]][order[2]] < a[order[1]][order[1]])
+        std::swap(order[1], order[2]);
+    if (a[order[1]][order[1]] < a[order[0]][order[0]])
+        std::swap(order[0], order[1]);
+    for (int i = 0; i < 3; ++i)
+    {
+        values[i] = a[order[i]][order[i]];
+        for (int k = 0; k < 3; ++k)
+            vectors(k, i) = v[k][order[i]];
+    }
+    return true;
+}
+
+void computeCovarianceEigen(const double *coords, const KDNeighbors& nbrs,
+    std::vector<CovarianceEigen>& out, point_count_t skip)
+{
+    if (nbrs.size() >= gpu::MinBatch &&
+        gpu::covarianceEigen(coords, nbrs, skip, out))
+        return;
+
+    out.resize(nbrs.size());
+    for (std::size_t i = 0; i < nbrs.size(); ++i)
+    {
+        CovarianceEigen& e = out[i];
+        const point_count_t count = nbrs.count(i);
+        const point_count_t first = (std::min)(skip, count);
+        Eigen::Matrix3d B = computeCovariance(coords,
+            nbrs.neighbors(i) + first, count - first, &e.centroid);
+        e.valid = computeEigen3(B, e.values, e.vectors);
+    }
+}
+
+uint8_t computeRank(const double *coords, const PointId *ids,
+    point_count_t count, double threshold)
+{
+    Eigen::Matrix3d B = computeCovariance(coords, ids, count);
+    Eigen::Vector3d values;
+    Eigen::Matrix3d vectors;
+    computeEigen3(B, values, vectors);
+
+    // The singular values of a covariance matrix are its eigenvalues.  As
+    // in Eigen's JacobiSVD::rank(), those less than the threshold times
+    // the largest aren't counted.
+    const Eigen::Vector3d sv = values.cwiseAbs();
+    const double limit = (std::max)(sv.maxCoeff() * threshold, DBL_MIN);
+    uint8_t rank = 0;
+    for (int i = 0; i < 3; ++i)
+        if (sv[i] >= limit)
+            rank++;
+    return rank;
+}
+
 uint8_t computeRank(const PointView& view, const PointIdList& ids,
     double threshold)
 {
@@ -349,6 +697,34 @@ std::vector<double> erodeDiamond(std::vector<double> data, size_t rows, size_t c
     return data;
 }
 
+std::vector<double> dilateDiamondFast(const std::vector<double>& data,
+    size_t rows, size_t cols, int radius, unsigned threads)
+{
+    return diamond(data, rows, cols, radius,
+        std::numeric_limits<double>::lowest(), maxOf, threads);
+}
+
+std::vector<double> erodeDiamondFast(const std::vector<double>& data,
+    size_t rows, size_t cols, int radius, unsigned threads)
+{
+    return diamond(data, rows, cols, radius,
+        (std::numeric_limits<double>::max)(), minOf, threads);
+}
+
+std::vector<double> dilateSquare(const std::vector<double>& data,
+    size_t rows, size_t cols, int radius, unsigned threads)
+{
+    return square(data, rows, cols, radius,
+        std::numeric_limits<double>::lowest(), maxOf, threads);
+}
+
+std::vector<double> erodeSquare(const std::vector<double>& data,
+    size_t rows, size_t cols, int radius, unsigned threads)
+{
+    return square(data, rows, cols, radius,
+        (std::numeric_limits<double>::max)(), minOf, threads);
+}
+
 Eigen::MatrixXd pointViewToEigen(const PointView& view)
 {
     Eigen::MatrixXd matrix(view.size(), 3);
@@ -56,6 +56,7 @@ namespace pdal
 class BOX2D;
 class PointView;
 class SpatialReference;
+struct KDNeighbors;
 
 typedef std::shared_ptr<PointView> PointViewPtr;
 
@@ -127,6 +128,76 @@ PDAL_DLL Eigen::Vector3d computeCentroid(const PointView& view,
 PDAL_DLL Eigen::Matrix3d computeCovariance(const PointView& view,
     const PointIdList& ids);
 
+/**
+  Compute the covariance matrix of a neighborhood of points.
+
+  The coordinates are read from a packed array, three values (X, Y, Z) per
+  point, such as the one held by a KD3Index.
+
+  \code
+  KD3Index& kdi = view.build3dIndex();
+  auto ids = kdi.neighbors(0, 8);
+  auto cov = computeCovariance(kdi.coords().data(), ids.data(), ids.size());
+  \endcode
+
+  \param coords packed XYZ coordinates of the points, indexed by PointId.
+  \param ids PointIds of the points of the neighborhood.
+  \param count number of points in the neighborhood.
+  \param centroid if not null, set to the centroid of the neighborhood.
+  \return the covariance matrix of the XYZ dimensions.
+*/
+PDAL_DLL Eigen::Matrix3d computeCovariance(const double *coords,
+    const PointId *ids, point_count_t count,
+    Eigen::Vector3d *centroid = nullptr);
+
+/**
+  Compute the eigenvalues and eigenvectors of a symmetric 3x3 matrix.
+
+  The matrix is diagonalized by cyclic Jacobi rotations, which is faster
+  than Eigen's general SelfAdjointEigenSolver for 3x3 matrices and accurate
+  to machine precision.  A matrix that is already diagonal, as is the
+  covariance of points on an axis-aligned plane, has exactly the unit axes
+  as eigenvectors.
+
+  \param A the symmetric matrix.  Only the upper triangle is read.
+  \param values set to the eigenvalues, in increasing order.
+  \param vectors set to the unit eigenvectors, as columns in the order of
+    the eigenvalues.
+  \return false if the matrix holds values that aren't finite.
+*/
+PDAL_DLL bool computeEigen3(const Eigen::Matrix3d& A, Eigen::Vector3d& values,
+    Eigen::Matrix3d& vectors);
+
+/**
+  Eigen decomposition of the covariance of a neighborhood of points.
+*/
+struct CovarianceEigen
+{
+    Eigen::Vector3d centroid;   ///< Centroid of the neighborhood.
+    Eigen::Vector3d values;     ///< Eigenvalues, in increasing order.
+    Eigen::Matrix3d vectors;    ///< Unit eigenvectors, as columns.
+    bool valid;                 ///< False if the decomposition failed.
+};
+
+/**
+  Compute the eigen decomposition of the covariance of a batch of
+  neighborhoods, such as a block of neighborhoods found by
+  KD3Index::knnRange().
+
+  \param coords packed XYZ coordinates of the points, indexed by PointId.
+  \param nbrs the neighborhoods.
+  \param out resized to and filled with one result per neighborhood.
+  \param skip number of leading neighbors of each neighborhood to leave
+    out.  k-nearest neighbor queries return the query point first, so a
+    skip of 1 leaves it out.
+
+  Large batches are computed on the GPU when the coordinates are those of
+  an index whose points have been copied there.  See pdal/Gpu.hpp.
+*/
+PDAL_DLL void computeCovarianceEigen(const double *coords,
+    const KDNeighbors& nbrs, std::vector<CovarianceEigen>& out,
+    point_count_t skip = 0);
+
 /**
   Compute the rank of a collection of points.
 
@@ -159,6 +230,23 @@ PDAL_DLL Eigen::Matrix3d computeCovariance(const PointView& view,
 PDAL_DLL uint8_t computeRank(const PointView& view,
         const PointIdList& ids, double threshold);
 
+/**
+  Compute the rank of a neighborhood of points.
+
+  The coordinates are read from a packed array, as by the overload of
+  computeCovariance() that takes one.  The rank is estimated as by the
+  overload that takes a PointView, from the eigenvalues of the covariance
+  computed by computeEigen3().
+
+  \param coords packed XYZ coordinates of the points, indexed by PointId.
+  \param ids PointIds of the points of the neighborhood.
+  \param count number of points in the neighborhood.
+  \param threshold relative threshold of the nonzero singular values.
+  \return the estimated rank.
+*/
+PDAL_DLL uint8_t computeRank(const double *coords, const PointId *ids,
+    point_count_t count, double threshold);
+
 /**
   Find local minimum elevations by extended local minimum.
 
@@ -218,6 +306,83 @@ PDAL_DLL std::vector<double> erodeDiamond(std::vector<double> data,
                                           size_t rows, size_t cols,
                                           int iterations);
 
+/**
+  Perform a morphological dilation of the input raster with a diamond.
+
+  Produces the same result as dilateDiamond(data, rows, cols, radius) for
+  rasters without NaN cells, but in time independent of the radius.  The
+  diamond is split into two squares on the diagonal lattice, each of which
+  is applied as a pair of van Herk/Gil-Werman passes along the diagonals.
+  The input and output rasters are stored in column major order.
+
+  \param data the input raster.
+  \param rows the number of rows.
+  \param cols the number of cols.
+  \param radius the radius of the diamond, in cells.
+  \param threads the maximum number of threads used for each pass.  When 0,
+         one thread per hardware thread is used.
+  \return the morphological dilation of the input raster.
+*/
+PDAL_DLL std::vector<double> dilateDiamondFast(const std::vector<double>& data,
+                                               size_t rows, size_t cols,
+                                               int radius,
+                                               unsigned threads = 0);
+
+/**
+  Perform a morphological erosion of the input raster with a diamond.
+
+  Produces the same result as erodeDiamond(data, rows, cols, radius) for
+  rasters without NaN cells, but in time independent of the radius.  The
+  input and output rasters are stored in column major order.
+
+  \param data the input raster.
+  \param rows the number of rows.
+  \param cols the number of cols.
+  \param radius the radius of the diamond, in cells.
+  \param threads the maximum number of threads used for each pass.  When 0,
+         one thread per hardware thread is used.
+  \return the morphological erosion of the input raster.
+*/
+PDAL_DLL std::vector<double> erodeDiamondFast(const std::vector<double>& data,
+                                              size_t rows, size_t cols,
+                                              int radius,
+                                              unsigned threads = 0);
+
+/**
+  Perform a morphological dilation of the input raster with a square.
+
+  The square structuring element has sides of 2 * radius + 1 cells and is
+  applied as a van Herk/Gil-Werman pass along the columns followed by one
+  along the rows.  The input and output rasters are stored in column major
+  order.
+
+  \param data the input raster.
+  \param rows the number of rows.
+  \param cols the number of cols.
+  \param radius half the side of the square, in cells.
+  \param threads the maximum number of threads used for each pass.  When 0,
+         one thread per hardware thread is used.
+  \return the morphological dilation of the input raster.
+*/
+PDAL_DLL std::vector<double> dilateSquare(const std::vector<double>& data,
+                                          size_t rows, size_t cols,
+                                          int radius, unsigned threads = 0);
+
+/**
+  Perform a morphological erosion of the input raster with a square.
+
+  \param data the input raster.
+  \param rows the number of rows.
+  \param cols the number of cols.
+  \param radius half the side of the square, in cells.
+  \param threads the maximum number of threads used for each pass.  When 0,
+         one thread per hardware thread is used.
+  \return the morphological erosion of the input raster.
+*/
+PDAL_DLL std::vector<double> erodeSquare(const std::vector<double>& data,
+                                         size_t rows, size_t cols,
+                                         int radius, unsigned threads = 0);
+
 /**
   Converts a PointView into an Eigen::MatrixXd.
 
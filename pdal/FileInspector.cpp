@@ -0,0 +1,196 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <ctime>
+
+#include <nlohmann/json.hpp>
+
+#include <pdal/FileInspector.hpp>
+#include <pdal/PipelineManager.hpp>
+#include <pdal/Stage.hpp>
+#include <pdal/util/FileUtils.hpp>
+#include <pdal/util/ThreadPool.hpp>
+
+namespace pdal
+{
+
+FileInspector::FileInspector() : m_threads(1)
+{}
+
+
+FileInspector::Results FileInspector::inspect(const StringList& filenames)
+{
+    Results results(filenames.size());
+
+    if (m_cacheFile.size())
+        readCache();
+
+    // The queue is bounded so that no more than m_threads files are being
+    // opened at once.
+    ThreadPool pool(m_threads, m_threads);
+    for (size_t i = 0; i < filenames.size(); ++i)
+    {
+        Result& result = results[i];
+        result.m_filename = filenames[i];
+
+        auto it = m_cache.find(result.m_filename);
+        if (it != m_cache.end() &&
+            it->second.m_stamp == fileStamp(result.m_filename))
+        {
+            result.m_info = it->second.m_info;
+            result.m_cached = true;
+            continue;
+        }
+        pool.add([this, &result](){ inspectFile(result); });
+    }
+    pool.join();
+
+    if (m_cacheFile.size())
+    {
+        for (const Result& r : results)
+        {
+            if (r.m_cached || !r.valid())
+                continue;
+            std::string stamp = fileStamp(r.m_filename);
+            if (stamp.size())
+                m_cache[r.m_filename] = { stamp, r.m_info };
+        }
+        writeCache();
+    }
+    return results;
+}
+
+
+void FileInspector::inspectFile(Result& result)
+{
+    try
+    {
+        PipelineManager manager;
+        manager.commonOptions() = m_commonOptions;
+        manager.stageOptions() = m_stageOptions;
+
+        Stage& reader = manager.makeReader(result.m_filename, m_driver);
+        result.m_info = reader.preview();
+        if (!result.m_info.valid())
+            result.m_error = "No summary data available for '" +
+                result.m_filename + "'.";
+    }
+    catch (const std::exception& err)
+    {
+        result.m_error = err.what();
+    }
+}
+
+
+// Size and modification time of a local file, or an empty string if
+// the file can't be found (a remote file, for instance).
+std::string FileInspector::fileStamp(const std::string& filename)
+{
+    if (!FileUtils::fileExists(filename) || FileUtils::isDirectory(filename))
+        return std::string();
+
+    struct tm modTime;
+    FileUtils::fileTimes(filename, nullptr, &modTime);
+
+    char buf[64];
+    std::strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%S", &modTime);
+    return std::to_string(FileUtils::fileSize(filename)) + "/" + buf;
+}
+
+
+void FileInspector::readCache()
+{
+    m_cache.clear();
+    if (!FileUtils::fileExists(m_cacheFile))
+        return;
+
+    NL::json j;
+    try
+    {
+        j = NL::json::parse(FileUtils::readFileIntoString(m_cacheFile));
+        for (auto& it : j.at("files").items())
+        {
+            const NL::json& f = it.value();
+            CacheEntry entry;
+            QuickInfo& qi = entry.m_info;
+
+            entry.m_stamp = f.at("stamp").get<std::string>();
+            qi.m_pointCount = f.at("num_points").get<point_count_t>();
+            std::vector<double> b = f.at("bounds").get<std::vector<double>>();
+            if (b.size() != 6)
+                continue;
+            qi.m_bounds = BOX3D(b[0], b[1], b[2], b[3], b[4], b[5]);
+            qi.m_srs = SpatialReference(f.at("srs").get<std::string>());
+            qi.m_dimNames = f.at("dimensions").get<StringList>();
+            qi.m_valid = true;
+            m_cache[it.key()] = entry;
+        }
+    }
+    catch (const std::exception&)
+    {
+        // A damaged or outdated cache means everything gets inspected.
+        m_cache.clear();
+    }
+}
+
+
+void FileInspector::writeCache()
+{
+    NL::json files = NL::json::object();
+    for (auto& it : m_cache)
+    {
+        const QuickInfo& qi = it.second.m_info;
+        const BOX3D& b = qi.m_bounds;
+
+        files[it.first] = {
+            { "stamp", it.second.m_stamp },
+            { "num_points", qi.m_pointCount },
+            { "bounds", { b.minx, b.miny, b.minz, b.maxx, b.maxy, b.maxz } },
+            { "srs", qi.m_srs.getWKT() },
+            { "dimensions", qi.m_dimNames }
+        };
+    }
+    NL::json j { { "files", files } };
+
+    // Write to a temporary file and rename so that a concurrent reader
+    // of the cache never sees a partial file.
+    std::string tmpFile = m_cacheFile + ".tmp";
+    std::ostream *out = FileUtils::createFile(tmpFile, false);
+    if (!out)
+        throw pdal_error("Unable to create cache file '" + m_cacheFile + "'.");
+    *out << j.dump(1);
+    FileUtils::closeFile(out);
+    FileUtils::renameFile(m_cacheFile, tmpFile);
+}
+
+} // namespace pdal
@@ -0,0 +1,143 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <pdal/Options.hpp>
+#include <pdal/QuickInfo.hpp>
+#include <pdal/pdal_export.hpp>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace pdal
+{
+
+/**
+  A FileInspector runs the header-only inspection (Stage::preview()) of
+  the reader for each of a list of files on a pool of threads.
+
+  The number of threads also limits the number of files that are open at
+  once. When a cache file is set, results are stored in it keyed by
+  file path, size and modification time so that a later run against the
+  same collection only opens the files that have changed.
+*/
+class PDAL_DLL FileInspector
+{
+public:
+    struct Result
+    {
+        std::string m_filename;
+        QuickInfo m_info;
+        std::string m_error;   // Empty if the inspection succeeded.
+        bool m_cached;         // True if the result was read from the cache.
+
+        Result() : m_cached(false)
+        {}
+
+        bool valid() const
+            { return m_error.empty() && m_info.valid(); }
+    };
+    using Results = std::vector<Result>;
+
+    FileInspector();
+
+    /**
+      Set the number of files to inspect concurrently.
+
+      \param threads  Number of threads.
+    */
+    void setThreads(size_t threads)
+        { m_threads = threads; }
+
+    /**
+      Set the name of a file used to cache inspection results between
+      runs. The file is created if it doesn't exist.
+
+      \param filename  Cache filename.
+    */
+    void setCacheFile(const std::string& filename)
+        { m_cacheFile = filename; }
+
+    /**
+      Set the driver used to read every file. By default the driver is
+      inferred from each filename.
+
+      \param driver  Reader driver name.
+    */
+    void setDriver(const std::string& driver)
+        { m_driver = driver; }
+
+    /**
+      Set options passed to every reader, as with
+      PipelineManager::commonOptions() and PipelineManager::stageOptions().
+
+      \param common  Options for all stages.
+      \param stage  Options by stage name.
+    */
+    void setOptions(const Options& common, const OptionsMap& stage)
+    {
+        m_commonOptions = common;
+        m_stageOptions = stage;
+    }
+
+    /**
+      Inspect a list of files.
+
+      \param filenames  Names of files to inspect.
+      \return  A result for each file, in the order of \c filenames.
+    */
+    Results inspect(const StringList& filenames);
+
+private:
+    struct CacheEntry
+    {
+        std::string m_stamp;
+        QuickInfo m_info;
+    };
+
+    void inspectFile(Result& result);
+    void readCache();
+    void writeCache();
+    static std::string fileStamp(const std::string& filename);
+
+    size_t m_threads;
+    std::string m_cacheFile;
+    std::string m_driver;
+    Options m_commonOptions;
+    OptionsMap m_stageOptions;
+    std::map<std::string, CacheEntry> m_cache;
+};
+
+} // namespace pdal
@@ -33,6 +33,10 @@
 
 #pragma once
 
+#include <map>
+#include <memory>
+#include <mutex>
+
 #include <pdal/PDALUtils.hpp>
 #include <pdal/Scaling.hpp>
 #include <pdal/Writer.hpp>
@@ -43,7 +47,7 @@ namespace pdal
 class PDAL_DLL FlexWriter : public Writer
 {
 protected:
-    FlexWriter() : m_filenum(1)
+    FlexWriter() : m_filenum(1), m_concurrent(false)
     {}
 
     std::string m_filename;
@@ -61,6 +65,24 @@ protected:
         }
     }
 
+    /**
+      Make a writer that writes the file for a point view independently of
+      this writer and of any other writer made by this function.  Writers
+      that can be made this way write the files of separate point views
+      concurrently when the filename is a template and the pipeline is
+      run with more than one thread.  The writer made must have the
+      configuration of this writer, as set by initialize() and prepared(),
+      and is only used to call readyFile(), prerunFile(), writeView() and
+      doneFile() for a single file.  Metadata that it adds is added to this
+      writer's metadata, in the order of the files, once all views are
+      written.
+
+      \return  New writer, or nullptr if files must be written one at a
+        time.
+    */
+    virtual FlexWriter *makeFileWriter() const
+        { return nullptr; }
+
 private:
     std::string::size_type m_hashPos;
 
@@ -113,9 +135,27 @@ private:
         // If the output is a consolidation of all views, call
         // prerun with all views.
         if (m_hashPos == std::string::npos)
+        {
             prerunFile(views);
+            return;
+        }
+
+        // Files are numbered in the order of the non-empty views, even if
+        // they're written concurrently.
+        m_files.clear();
+        for (const PointViewPtr& v : views)
+            if (v->size())
+                m_files[v->id()].m_filename = generateFilename();
+        m_concurrent = std::unique_ptr<FlexWriter>(makeFileWriter()) !=
+            nullptr;
     }
 
+    // Writing files concurrently is left to Stage::execute(), which only
+    // runs views at the same time for re-entrant stages.  This is called
+    // after prerun().
+    virtual bool reentrant() const final
+        { return m_concurrent; }
+
     // This essentially moves ready() and done() into write(), which means
     // that they get executed once for each view.  The check for m_hashPos
     // is a test to see if the filename specification is a template.  If it's
@@ -123,23 +163,52 @@ private:
     // and done() functions in this class.
     virtual void write(const PointViewPtr view) final
     {
-        if (m_hashPos != std::string::npos)
+        if (m_hashPos == std::string::npos)
         {
-            if (view->size() == 0)
-                return;
-            // Ready the file - we're writing each view separately.
-            readyFile(generateFilename(), view->spatialReference());
-            prerunFile({view});
+            writeView(view);
+            return;
+        }
+        if (view->size() == 0)
+            return;
+
+        // Ready the file - we're writing each view separately.
+        FlexWriter *writer = this;
+        std::unique_ptr<FlexWriter> fileWriter;
+        if (m_concurrent)
+        {
+            fileWriter.reset(makeFileWriter());
+            writer = fileWriter.get();
+        }
+        writer->readyFile(fileFor(view).m_filename,
+            view->spatialReference());
+        writer->prerunFile({view});
+        writer->writeView(view);
+        writer->doneFile();
+        if (fileWriter)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_files[view->id()].m_writer = std::move(fileWriter);
         }
-        writeView(view);
-        if (m_hashPos != std::string::npos)
-            doneFile();
     }
 
     virtual void done(PointTableRef table) final
     {
         if (m_hashPos == std::string::npos)
             doneFile();
+
+        // Gather the metadata of the writers that wrote files concurrently.
+        MetadataNode m = getMetadata();
+        for (auto& f : m_files)
+            if (f.second.m_writer)
+                for (MetadataNode& n :
+                        f.second.m_writer->getMetadata().children())
+                {
+                    if (n.kind() == MetadataType::Array)
+                        m.addList(n);
+                    else
+                        m.add(n);
+                }
+        m_files.clear();
         doneTable(table);
     }
 
@@ -159,7 +228,24 @@ private:
     virtual void doneFile()
     {}
 
+    // A file written for a point view when the filename is a template.
+    struct File
+    {
+        std::string m_filename;
+        std::unique_ptr<FlexWriter> m_writer;
+    };
+
+    File& fileFor(const PointViewPtr& view)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_files[view->id()];
+    }
+
     size_t m_filenum;
+    bool m_concurrent;
+    // Files by the ID of the view written to them.
+    std::map<int, File> m_files;
+    std::mutex m_mutex;
 
     FlexWriter& operator=(const FlexWriter&); // not implemented
     FlexWriter(const FlexWriter&); // not implemented
@@ -38,7 +38,10 @@
 #include <pdal/util/Algorithm.hpp>
 #include <pdal/util/Utils.hpp>
 
+#include <algorithm>
+#include <cmath>
 #include <functional>
+#include <limits>
 #include <map>
 
 #include "GDALUtils.hpp"
@@ -480,15 +483,24 @@ GDALError Raster::open(int width, int height, int numBands,
         return GDALError::DriverNotFound;
     }
 
-    std::string item;
-    const char *itemp = driver->GetMetadataItem(GDAL_DCAP_CREATE);
-    if (itemp)
-        item = itemp;
-    if (item != "YES")
+    auto hasCapability = [driver](const char *capability)
+    {
+        const char *itemp = driver->GetMetadataItem(capability);
+        return itemp && std::string(itemp) == "YES";
+    };
+
+    // Drivers that can only copy rasters (COG, for example) get a copy
+    // of an in-memory raster when the raster is flushed.
+    m_copyDriver = nullptr;
+    if (!hasCapability(GDAL_DCAP_CREATE))
     {
-        m_errorMsg = "Requested driver '" + m_drivername + "' does not "
-            "support file creation.";
-        return GDALError::InvalidDriver;
+        if (!hasCapability(GDAL_DCAP_CREATECOPY))
+        {
+            m_errorMsg = "Requested driver '" + m_drivername + "' does not "
+                "support file creation.";
+            return GDALError::InvalidDriver;
+        }
+        m_copyDriver = driver;
     }
 
     GDALError error = validateType(type, driver);
@@ -505,11 +517,23 @@ GDALError Raster::open(int width, int height, int numBands,
         }
         opts.push_back(options[i].data());
     }
+    if (m_copyDriver)
+    {
+        m_copyOptions = options;
+        opts.clear();
+        driver = GetGDALDriverManager()->GetDriverByName("MEM");
+        if (!driver)
+        {
+            m_errorMsg = "Driver 'MEM' not found.";
+            return GDALError::DriverNotFound;
+        }
+    }
     opts.push_back("INTERLEAVE=BAND");
     opts.push_back(NULL);
 
-    m_ds = driver->Create(m_filename.data(), m_width, m_height, m_numBands,
-        toGdalType(type), const_cast<char **>(opts.data()));
+    m_ds = driver->Create(m_copyDriver ? "" : m_filename.data(), m_width,
+        m_height, m_numBands, toGdalType(type),
+        const_cast<char **>(opts.data()));
     if (m_ds == NULL)
     {
         m_errorMsg = "Unable to open GDAL datasource '" + m_filename + "'.";
@@ -608,6 +632,23 @@ GDALError Raster::wake()
     m_height = m_ds->GetRasterYSize();
     m_numBands = m_ds->GetRasterCount();
 
+    // Cached tiles match the blocks of the first band, unless the blocks are
+    // so big that reading one for a single cell would be wasteful.
+    m_tiles.clear();
+    m_tileWidth = 256;
+    m_tileHeight = 256;
+    if (m_numBands > 0)
+    {
+        int xBlockSize, yBlockSize;
+        m_ds->GetRasterBand(1)->GetBlockSize(&xBlockSize, &yBlockSize);
+        if (xBlockSize > 0 && yBlockSize > 0 &&
+            (int64_t)xBlockSize * yBlockSize <= 1024 * 1024)
+        {
+            m_tileWidth = xBlockSize;
+            m_tileHeight = yBlockSize;
+        }
+    }
+
     if (computePDALDimensionTypes() == GDALError::InvalidBand)
         error = GDALError::InvalidBand;
     return error;
@@ -764,8 +805,6 @@ GDALError Raster::read(double x, double y, std::vector<double>& data)
     int32_t line(0);
     data.resize(m_numBands);
 
-    std::array<double, 2> pix = { {0.0, 0.0} };
-
     // No data at this x,y if we can't compute a pixel/line location
     // for it.
     if (!getPixelAndLinePosition(x, y, pixel, line))
@@ -774,21 +813,286 @@ GDALError Raster::read(double x, double y, std::vector<double>& data)
         return GDALError::NoData;
     }
 
-    for (int i=0; i < m_numBands; ++i)
+    const Tile& t = tile(pixel, line);
+    if (!t.m_valid)
+    {
+        m_errorMsg = "Unable to read block for raster '" + m_filename + "'.";
+        return GDALError::CantReadBlock;
+    }
+    const double *cell = t.m_data.data() + ((size_t)(line % m_tileHeight) *
+        t.m_width + (pixel % m_tileWidth)) * m_numBands;
+    std::copy(cell, cell + m_numBands, data.begin());
+
+    return GDALError::None;
+}
+
+
+GDALError Raster::read(const std::vector<double>& xs,
+    const std::vector<double>& ys, std::vector<double>& data,
+    std::vector<bool>& valid, bool interpolate)
+{
+    const size_t count = (std::min)(xs.size(), ys.size());
+    data.resize(count * m_numBands);
+    valid.assign(count, false);
+
+    if (!m_ds)
+    {
+        m_errorMsg = "Raster not open.";
+        return GDALError::NotOpen;
+    }
+    if (interpolate)
+    {
+        this->interpolate(xs, ys, data, valid);
+        return GDALError::None;
+    }
+
+    struct Position
+    {
+        uint64_t tile;
+        size_t idx;
+        int32_t pixel;
+        int32_t line;
+    };
+
+    // Sort the positions in the raster by tile.
+    std::vector<Position> positions;
+    positions.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        Position p;
+        if (!getPixelAndLinePosition(xs[i], ys[i], p.pixel, p.line))
+            continue;
+        p.tile = ((uint64_t)(p.line / m_tileHeight) << 32) |
+            (uint32_t)(p.pixel / m_tileWidth);
+        p.idx = i;
+        positions.push_back(p);
+    }
+    std::sort(positions.begin(), positions.end(),
+        [](const Position& a, const Position& b)
+        { return a.tile < b.tile || (a.tile == b.tile && a.idx < b.idx); });
+
+    const Tile *t = nullptr;
+    for (size_t i = 0; i < positions.size(); ++i)
+    {
+        const Position& p = positions[i];
+        if (i == 0 || p.tile != positions[i - 1].tile)
+            t = &tile(p.pixel, p.line);
+        if (!t->m_valid)
+            continue;
+        const double *cell = t->m_data.data() +
+            ((size_t)(p.line % m_tileHeight) * t->m_width +
+            (p.pixel % m_tileWidth)) * m_numBands;
+        std::copy(cell, cell + m_numBands, data.begin() + p.idx * m_numBands);
+        valid[p.idx] = true;
+    }
+    return GDALError::None;
+}
+
+
+// The four cells around a position are those whose centers surround it.
+// Near the edge of the raster the cells are clamped to the raster, which
+// amounts to using the nearest edge cell in that direction.  Positions are
+// handled in order of the tile of their first cell, so the tiles that the
+// cells of neighboring positions share are usually the current one.  The
+// corner values are gathered first and then combined in a separate loop.
+void Raster::interpolate(const std::vector<double>& xs,
+    const std::vector<double>& ys, std::vector<double>& data,
+    std::vector<bool>& valid)
+{
+    struct Position
+    {
+        uint64_t tile;
+        size_t idx;
+        int32_t pixel;
+        int32_t line;
+        double tx;
+        double ty;
+    };
+
+    const size_t count = (std::min)(xs.size(), ys.size());
+    std::vector<Position> positions;
+    positions.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        int32_t pixel;
+        int32_t line;
+        if (!getPixelAndLinePosition(xs[i], ys[i], pixel, line))
+            continue;
+
+        // Position relative to the cell centers.
+        const double fx = m_inverseTransform[0] +
+            m_inverseTransform[1] * xs[i] + m_inverseTransform[2] * ys[i] -
+            .5;
+        const double fy = m_inverseTransform[3] +
+            m_inverseTransform[4] * xs[i] + m_inverseTransform[5] * ys[i] -
+            .5;
+        Position p;
+        p.pixel = (int32_t)std::floor(fx);
+        p.line = (int32_t)std::floor(fy);
+        p.tx = fx - p.pixel;
+        p.ty = fy - p.line;
+        const int32_t col = (std::max)(p.pixel, 0) / m_tileWidth;
+        const int32_t row = (std::max)(p.line, 0) / m_tileHeight;
+        p.tile = ((uint64_t)row << 32) | (uint32_t)col;
+        p.idx = i;
+        positions.push_back(p);
+    }
+    std::sort(positions.begin(), positions.end(),
+        [](const Position& a, const Position& b)
+        { return a.tile < b.tile || (a.tile == b.tile && a.idx < b.idx); });
+
+    // Corner values of each position, four per band: upper left, upper
+    // right, lower left, lower right.
+    const size_t numBands = m_numBands;
+    std::vector<double> corners(positions.size() * numBands * 4);
+    std::vector<char> read(positions.size());
+    const Tile *t = nullptr;
+    uint64_t tileKey = (std::numeric_limits<uint64_t>::max)();
+    auto cell = [&](int32_t pixel, int32_t line) -> const double *
+    {
+        pixel = (std::min)((std::max)(pixel, 0), m_width - 1);
+        line = (std::min)((std::max)(line, 0), m_height - 1);
+        const uint64_t key = ((uint64_t)(line / m_tileHeight) << 32) |
+            (uint32_t)(pixel / m_tileWidth);
+        if (key != tileKey)
+        {
+            t = &tile(pixel, line);
+            tileKey = key;
+        }
+        if (!t->m_valid)
+            return nullptr;
+        return t->m_data.data() + ((size_t)(line % m_tileHeight) *
+            t->m_width + (pixel % m_tileWidth)) * numBands;
+    };
+
+    for (size_t i = 0; i < positions.size(); ++i)
     {
-        GDALRasterBandH b = GDALGetRasterBand(m_ds, i + 1);
-        if (GDALRasterIO(b, GF_Read, pixel, line, 1, 1,
-            &pix[0], 1, 1, GDT_Float64, 0, 0) == CE_None)
+        const Position& p = positions[i];
+        double *out = corners.data() + i * numBands * 4;
+        bool ok = true;
+        for (int c = 0; c < 4 && ok; ++c)
         {
-            // we read a pixel put its values in our vector
-            data[i] = pix[0];
+            const double *v = cell(p.pixel + (c & 1), p.line + (c >> 1));
+            if (!v)
+                ok = false;
+            else
+                for (size_t b = 0; b < numBands; ++b)
+                    out[b * 4 + c] = v[b];
         }
+        read[i] = ok;
     }
 
+    std::vector<double> noData(numBands);
+    std::vector<char> hasNoData(numBands);
+    for (size_t b = 0; b < numBands; ++b)
+    {
+        int has = 0;
+        noData[b] = m_ds->GetRasterBand((int)b + 1)->GetNoDataValue(&has);
+        hasNoData[b] = has;
+    }
+
+    for (size_t i = 0; i < positions.size(); ++i)
+    {
+        if (!read[i])
+            continue;
+        const Position& p = positions[i];
+        const double w[4] { (1 - p.tx) * (1 - p.ty), p.tx * (1 - p.ty),
+            (1 - p.tx) * p.ty, p.tx * p.ty };
+        const double *in = corners.data() + i * numBands * 4;
+        double *out = data.data() + p.idx * numBands;
+        for (size_t b = 0; b < numBands; ++b)
+        {
+            const double *v = in + b * 4;
+            double sum = 0;
+            double weight = 0;
+            for (int c = 0; c < 4; ++c)
+            {
+                const double wc =
+                    (hasNoData[b] && v[c] == noData[b]) ? 0 : w[c];
+                sum += wc * (wc ? v[c] : 0);
+                weight += wc;
+            }
+            // When every cell with weight lacks data, the position has no
+            // data in this band.
+            out[b] = weight > 0 ? sum / weight : noData[b];
+        }
+        valid[p.idx] = true;
+    }
+}
+
+
+GDALError Raster::readWindow(int column, int row, int width, int height,
+    std::vector<double>& data)
+{
+    if (!m_ds)
+    {
+        m_errorMsg = "Raster not open.";
+        return GDALError::NotOpen;
+    }
+
+    data.resize((size_t)width * height * m_numBands);
+    const GSpacing cellSpace = sizeof(double) * m_numBands;
+    if (m_ds->RasterIO(GF_Read, column, row, width, height, data.data(),
+        width, height, GDT_Float64, m_numBands, nullptr, cellSpace,
+        cellSpace * width, sizeof(double), nullptr) != CE_None)
+    {
+        m_errorMsg = "Unable to read block for raster '" + m_filename + "'.";
+        return GDALError::CantReadBlock;
+    }
     return GDALError::None;
 }
 
 
+void Raster::setCacheSize(size_t bytes)
+{
+    m_cacheSize = bytes;
+    m_tiles.clear();
+}
+
+
+/**
+  Get the tile containing a cell, reading it if it isn't in the cache.
+  The least recently used tile is dropped when the cache is full.
+  \param pixel  Column of the cell.
+  \param line  Row of the cell.
+  \return  The tile, which remains valid until the next call.
+*/
+const Raster::Tile& Raster::tile(int32_t pixel, int32_t line)
+{
+    const int32_t col = pixel / m_tileWidth;
+    const int32_t row = line / m_tileHeight;
+    const uint64_t key = ((uint64_t)row << 32) | (uint32_t)col;
+
+    auto it = m_tiles.find(key);
+    if (it != m_tiles.end())
+    {
+        it->second.m_lastUse = ++m_tileUse;
+        return it->second;
+    }
+
+    const size_t tileBytes = (size_t)m_tileWidth * m_tileHeight *
+        (std::max)(m_numBands, 1) * sizeof(double);
+    const size_t maxTiles = (std::max)((size_t)1, m_cacheSize / tileBytes);
+    while (m_tiles.size() >= maxTiles)
+        m_tiles.erase(std::min_element(m_tiles.begin(), m_tiles.end(),
+            [](const std::pair<const uint64_t, Tile>& a,
+                const std::pair<const uint64_t, Tile>& b)
+            { return a.second.m_lastUse < b.second.m_lastUse; }));
+
+    const int x = col * m_tileWidth;
+    const int y = row * m_tileHeight;
+    const int width = (std::min)(m_tileWidth, m_width - x);
+    const int height = (std::min)(m_tileHeight, m_height - y);
+
+    Tile& t = m_tiles[key];
+    t.m_width = width;
+    t.m_lastUse = ++m_tileUse;
+    t.m_valid = (readWindow(x, y, width, height, t.m_data) ==
+        GDALError::None);
+    return t;
+}
+
+
 /**
   Get the spatial reference associated with a raster.
   \return  Associated spatial reference.
@@ -819,7 +1123,62 @@ void Raster::close()
 {
     GDALClose(m_ds);
     m_ds = nullptr;
+    m_copyDriver = nullptr;
     m_types.clear();
+    m_tiles.clear();
+}
+
+
+/**
+  Write a raster held in memory to its file.
+  \return  Error code, or GDALError::None.
+*/
+GDALError Raster::flush()
+{
+    if (!m_ds || !m_copyDriver)
+        return GDALError::None;
+
+    std::vector<const char *> opts;
+    for (const std::string& o : m_copyOptions)
+        opts.push_back(o.data());
+    opts.push_back(NULL);
+
+    GDALDataset *ds = m_copyDriver->CreateCopy(m_filename.data(), m_ds,
+        FALSE, const_cast<char **>(opts.data()), nullptr, nullptr);
+    m_copyDriver = nullptr;
+    if (!ds)
+    {
+        m_errorMsg = "Unable to write GDAL datasource '" + m_filename +
+            "': " + CPLGetLastErrorMsg();
+        return GDALError::CantCreate;
+    }
+    GDALClose(ds);
+    return GDALError::None;
+}
+
+
+/**
+  Add overviews to a raster opened for writing.
+  \param resampling  Resampling method, or "NONE" to only create the
+    overviews.
+  \param factors  Reduction factor of each overview.
+  \return  Error code, or GDALError::None.
+*/
+GDALError Raster::buildOverviews(const std::string& resampling,
+    const std::vector<int>& factors)
+{
+    std::vector<int> levels(factors);
+    if (!m_ds || levels.empty())
+        return GDALError::None;
+
+    if (m_ds->BuildOverviews(resampling.data(), (int)levels.size(),
+        levels.data(), 0, nullptr, nullptr, nullptr) != CE_None)
+    {
+        m_errorMsg = "Unable to build overviews for raster '" +
+            m_filename + "': " + CPLGetLastErrorMsg();
+        return GDALError::CantCreate;
+    }
+    return GDALError::None;
 }
 
 
@@ -34,10 +34,12 @@
 
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <functional>
 #include <mutex>
 #include <sstream>
+#include <unordered_map>
 #include <vector>
 
 #include <pdal/pdal_internal.hpp>
@@ -352,9 +354,11 @@ private:
       \param dstNoData  The no data value to be used when writing the band.
       \param bandNum  Band number (1-indexed).
       \param name  Name of the raster band.
+      \param overview  Overview of the band to use (1-indexed) or 0 to
+        use the band itself.
     */
     Band(GDALDataset *ds, int bandNum, double dstNoData = -9999.0,
-            const std::string& name = "") :
+            const std::string& name = "", int overview = 0) :
         m_ds(ds), m_bandNum(bandNum), m_dstNoData(dstNoData),
         m_xBlockSize(0), m_yBlockSize(0)
     {
@@ -371,6 +375,13 @@ private:
             m_band->SetOffset(m_band->GetOffset(NULL) - .00001);
         }
 
+        if (overview > 0)
+        {
+            m_band = m_band->GetOverview(overview - 1);
+            if (!m_band)
+                throw InvalidBand();
+        }
+
         int xTotalSize = m_band->GetXSize();
         int yTotalSize = m_band->GetYSize();
 
@@ -458,6 +469,33 @@ private:
         }
     }
 
+    /*
+      Write linearized data pointed to by \c data into rows of the band.
+      Whole blocks are written, so \c firstRow must be the first row of
+      a block and the rows must fill their last block unless they run to
+      the bottom of the band.
+
+      \param si  Iterator to the first cell of \c firstRow.
+      \param srcNoData  No data value in the source data.
+      \param firstRow  First row to write.
+      \param numRows  Number of rows to write.
+    */
+    template <typename SOURCE_ITER>
+    void write(SOURCE_ITER si, ITER_VAL<SOURCE_ITER> srcNoData,
+        size_t firstRow, size_t numRows)
+    {
+        size_t endRow = (std::min)(firstRow + numRows, m_yTotalSize);
+        if (firstRow % m_yBlockSize ||
+            (endRow % m_yBlockSize && endRow != m_yTotalSize))
+            throw CantWriteBlock("Rows to write don't align with the "
+                "blocks of the raster.");
+
+        size_t yEnd = (endRow + m_yBlockSize - 1) / m_yBlockSize;
+        for (size_t y = firstRow / m_yBlockSize; y < yEnd; ++y)
+            for (size_t x = 0; x < m_xBlockCnt; ++x)
+                writeBlock(x, y, si, srcNoData, firstRow);
+    }
+
     /*
       Write linearized data pointed to by \c data into the band.
 
@@ -466,9 +504,7 @@ private:
     template <typename SOURCE_ITER>
     void write(SOURCE_ITER si, ITER_VAL<SOURCE_ITER> srcNoData)
     {
-        for (size_t y = 0; y < m_yBlockCnt; ++y)
-            for (size_t x = 0; x < m_xBlockCnt; ++x)
-                writeBlock(x, y, si, srcNoData);
+        write(si, srcNoData, 0, m_yTotalSize);
     }
 
     T getNoData() const
@@ -487,7 +523,7 @@ private:
 
     template <typename SOURCE_ITER>
     void writeBlock(size_t x, size_t y, SOURCE_ITER sourceBegin,
-        ITER_VAL<SOURCE_ITER> srcNoData)
+        ITER_VAL<SOURCE_ITER> srcNoData, size_t sourceRow = 0)
     {
         size_t xWidth = 0;
         if (x == m_xBlockCnt - 1)
@@ -508,7 +544,8 @@ private:
         for (size_t row = 0; row < yHeight; ++row)
         {
             // Find the offset location in the source container.
-            size_t wholeRowElts = m_xTotalSize * ((y * m_yBlockSize) + row);
+            size_t wholeRowElts =
+                m_xTotalSize * ((y * m_yBlockSize) + row - sourceRow);
             size_t partialRowElts = m_xBlockSize * x;
 
             auto si = sourceBegin + (wholeRowElts + partialRowElts);
@@ -615,10 +652,33 @@ public:
         double noData, StringList options = StringList());
 
     /**
-      Close the raster and deallocate the underlying dataset.
+      Close the raster and deallocate the underlying dataset.  A raster
+      opened for writing with a driver that can only copy rasters isn't
+      written unless flush() was called.
     */
     void close();
 
+    /**
+      Write the raster to its file.  Rasters opened for writing with drivers
+      that can only copy rasters (COG, for example) are held in memory
+      until they're flushed.  Other rasters are written as data is added.
+
+      \return  Error code or GDALError::None.
+    */
+    GDALError flush();
+
+    /**
+      Add overviews to all bands of a raster opened for writing.
+
+      \param resampling  GDAL resampling method used to compute the
+        overviews from the raster's data or "NONE" to leave the overviews
+        to be written with writeBandRows().
+      \param factors  Reduction factor of each overview.
+      \return  Error code or GDALError::None.
+    */
+    GDALError buildOverviews(const std::string& resampling,
+        const std::vector<int>& factors);
+
     /**
       Read an entire raster band (layer) into a vector.
 
@@ -666,50 +726,73 @@ public:
     template<typename SOURCE_ITER>
     GDALError writeBand(SOURCE_ITER si, ITER_VAL<SOURCE_ITER> srcNoData,
         int nBand, const std::string& name = "")
+    {
+        return writeBandRows(si, srcNoData, nBand, 0, m_height, name);
+    }
+
+    /**
+      Write rows of a raster band.  Data is written a block at a time, so
+      \a firstRow must be a multiple of blockHeight() and \a numRows must
+      be as well, unless the rows run to the bottom of the raster.
+
+      \param data  Linearized raster data to be written, starting with the
+        first cell of \a firstRow.
+      \param noData  No-data value in the source data.
+      \param nBand  Band number to write.
+      \param firstRow  First row to write.
+      \param numRows  Number of rows to write.
+      \param name  Name of the raster band.
+      \param overview  Overview of the band to write (1-indexed) or 0 to
+        write the band itself.  Rows are rows of the overview.
+    */
+    template<typename SOURCE_ITER>
+    GDALError writeBandRows(SOURCE_ITER si, ITER_VAL<SOURCE_ITER> srcNoData,
+        int nBand, int firstRow, int numRows, const std::string& name = "",
+        int overview = 0)
     {
         try
         {
             switch(m_bandType)
             {
             case Dimension::Type::Unsigned8:
-                Band<uint8_t>(m_ds, nBand, m_dstNoData, name).
-                    write(si, srcNoData);
+                Band<uint8_t>(m_ds, nBand, m_dstNoData, name, overview).
+                    write(si, srcNoData, firstRow, numRows);
                 break;
             case Dimension::Type::Signed8:
-                Band<int8_t>(m_ds, nBand, m_dstNoData, name).
-                    write(si, srcNoData);
+                Band<int8_t>(m_ds, nBand, m_dstNoData, name, overview).
+                    write(si, srcNoData, firstRow, numRows);
                 break;
             case Dimension::Type::Unsigned16:
-                Band<uint16_t>(m_ds, nBand, m_dstNoData, name).
-                    write(si, srcNoData);
+                Band<uint16_t>(m_ds, nBand, m_dstNoData, name, overview).
+                    write(si, srcNoData, firstRow, numRows);
                 break;
             case Dimension::Type::Signed16:
-                Band<int16_t>(m_ds, nBand, m_dstNoData, name).
-                    write(si, srcNoData);
+                Band<int16_t>(m_ds, nBand, m_dstNoData, name, overview).
+                    write(si, srcNoData, firstRow, numRows);
                 break;
             case Dimension::Type::Unsigned32:
-                Band<uint32_t>(m_ds, nBand, m_dstNoData, name).
-                    write(si, srcNoData);
+                Band<uint32_t>(m_ds, nBand, m_dstNoData, name, overview).
+                    write(si, srcNoData, firstRow, numRows);
                 break;
             case Dimension::Type::Signed32:
-                Band<int32_t>(m_ds, nBand, m_dstNoData, name).
-                    write(si, srcNoData);
+                Band<int32_t>(m_ds, nBand, m_dstNoData, name, overview).
+                    write(si, srcNoData, firstRow, numRows);
                 break;
             case Dimension::Type::Unsigned64:
-                Band<uint64_t>(m_ds, nBand, m_dstNoData, name).
-                    write(si, srcNoData);
+                Band<uint64_t>(m_ds, nBand, m_dstNoData, name, overview).
+                    write(si, srcNoData, firstRow, numRows);
                 break;
             case Dimension::Type::Signed64:
-                Band<int64_t>(m_ds, nBand, m_dstNoData, name).
-                    write(si, srcNoData);
+                Band<int64_t>(m_ds, nBand, m_dstNoData, name, overview).
+                    write(si, srcNoData, firstRow, numRows);
                 break;
             case Dimension::Type::Float:
-                Band<float>(m_ds, nBand, m_dstNoData, name).
-                    write(si, srcNoData);
+                Band<float>(m_ds, nBand, m_dstNoData, name, overview).
+                    write(si, srcNoData, firstRow, numRows);
                 break;
             case Dimension::Type::Double:
-                Band<double>(m_ds, nBand, m_dstNoData, name).
-                    write(si, srcNoData);
+                Band<double>(m_ds, nBand, m_dstNoData, name, overview).
+                    write(si, srcNoData, firstRow, numRows);
                 break;
             case Dimension::Type::None:
                 throw CantWriteBlock();
@@ -741,6 +824,8 @@ public:
     /**
       Read the data for each band at x/y into a vector of doubles.  x and y
       are transformed to the basis of the raster before the data is fetched.
+      Cells are read a tile at a time and recently used tiles are cached
+      (see setCacheSize()).
 
       \param x  X position to read
       \param y  Y position to read
@@ -748,6 +833,38 @@ public:
     */
     GDALError read(double x, double y, std::vector<double>& data);
 
+    /**
+      Read the data for each band at a set of positions.  The positions are
+      grouped by tile so that each tile is fetched once, whatever the order
+      of the positions.  Reading many positions in one call, rather than
+      one at a time, keeps a tile from being fetched again after it has
+      been evicted from the cache.
+
+      \param xs  X positions to read.
+      \param ys  Y positions to read.  Must be the same size as \a xs.
+      \param data  Vector in which to store data.  The values of the bands
+        at position \c i start at \c data[i * bandCount()].
+      \param valid  Set to true for each position whose data was read and
+        false for positions outside of the raster or in tiles that couldn't
+        be read.
+      \param interpolate  When true, the values are bilinearly interpolated
+        from the centers of the four cells nearest each position.  Cells
+        holding a band's no-data value are left out of its interpolation.
+        Otherwise the values of the cell containing the position are read.
+      \return  Error code or GDALError::None.
+    */
+    GDALError read(const std::vector<double>& xs,
+        const std::vector<double>& ys, std::vector<double>& data,
+        std::vector<bool>& valid, bool interpolate = false);
+
+    /**
+      Set the maximum size of the tile cache used by read().  At least one
+      tile is always cached.
+
+      \param bytes  Maximum number of bytes of cell data to keep in memory.
+    */
+    void setCacheSize(size_t bytes);
+
     /**
       Get a vector of dimensions that map to the bands of a raster.
     */
@@ -797,6 +914,69 @@ public:
     int height() const
         { return m_height; }
 
+    /**
+      Get the number of rows in a block of a band of an open raster.
+
+      \param nBand  Band number.  Band numbers start at 1.
+      \return  The number of rows in a block or 0 if the band isn't valid.
+    */
+    int blockHeight(int nBand) const
+    {
+        GDALRasterBand *band = m_ds ? m_ds->GetRasterBand(nBand) : nullptr;
+        if (!band)
+            return 0;
+        int xBlockSize, yBlockSize;
+        band->GetBlockSize(&xBlockSize, &yBlockSize);
+        return yBlockSize;
+    }
+
+    /**
+      Get the number of columns in a block of a band of an open raster.
+
+      \param nBand  Band number.  Band numbers start at 1.
+      \return  The number of columns in a block or 0 if the band isn't valid.
+    */
+    int blockWidth(int nBand) const
+    {
+        GDALRasterBand *band = m_ds ? m_ds->GetRasterBand(nBand) : nullptr;
+        if (!band)
+            return 0;
+        int xBlockSize, yBlockSize;
+        band->GetBlockSize(&xBlockSize, &yBlockSize);
+        return xBlockSize;
+    }
+
+    /**
+      Get the no data value of a band of an open raster.
+
+      \param nBand  Band number.  Band numbers start at 1.
+      \param[out] value  The band's no data value.
+      \return  Whether the band has a no data value.
+    */
+    bool noData(int nBand, double& value) const
+    {
+        GDALRasterBand *band = m_ds ? m_ds->GetRasterBand(nBand) : nullptr;
+        if (!band)
+            return false;
+        int success;
+        value = band->GetNoDataValue(&success);
+        return success;
+    }
+
+    /**
+      Read the data for each band in a window of the raster.
+
+      \param column  First column of the window.
+      \param row  First row of the window.
+      \param width  Width of the window in cells.
+      \param height  Height of the window in cells.
+      \param data  Vector in which to store data.  The values of the bands
+        of a cell are next to each other and cells are in row order.
+      \return  Error code or GDALError::None.
+    */
+    GDALError readWindow(int column, int row, int width, int height,
+        std::vector<double>& data);
+
     std::string const& filename() { return m_filename; }
 
     void statistics(int nBand, double* minimum, double* maximum, double* mean,
@@ -845,6 +1025,8 @@ private:
     GDALDataset *m_ds;
     Dimension::Type m_bandType;
     double m_dstNoData;
+    GDALDriver *m_copyDriver = nullptr;
+    StringList m_copyOptions;
 
     GDALError wake();
 
@@ -852,10 +1034,30 @@ private:
     mutable std::vector<pdal::Dimension::Type> m_types;
     std::vector<std::array<double, 2>> m_block_sizes;
 
+    // Cells of a tile of the raster, with the values of all bands of a
+    // cell next to each other.
+    struct Tile
+    {
+        std::vector<double> m_data;
+        int m_width;
+        uint64_t m_lastUse;
+        bool m_valid;
+    };
+
+    size_t m_cacheSize = 64 * 1024 * 1024;
+    int m_tileWidth = 0;
+    int m_tileHeight = 0;
+    uint64_t m_tileUse = 0;
+    std::unordered_map<uint64_t, Tile> m_tiles;
+
     GDALError validateType(Dimension::Type& type, GDALDriver *driver);
     bool getPixelAndLinePosition(double x, double y,
         int32_t& pixel, int32_t& line);
     GDALError computePDALDimensionTypes();
+    const Tile& tile(int32_t pixel, int32_t line);
+    void interpolate(const std::vector<double>& xs,
+        const std::vector<double>& ys, std::vector<double>& data,
+        std::vector<bool>& valid);
 };
 
 
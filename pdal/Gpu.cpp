@@ -0,0 +1,245 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/Gpu.hpp>
+
+#include <pdal/pdal_features.hpp>
+#include <pdal/EigenUtils.hpp>
+#include <pdal/KDIndex.hpp>
+
+#ifdef PDAL_HAVE_CUDA
+
+#include <atomic>
+#include <map>
+#include <mutex>
+
+#include "private/GpuKernels.hpp"
+
+namespace pdal
+{
+namespace gpu
+{
+
+class PointSet
+{
+public:
+    PointSet(const double *coords, int dim, cuda::Points *pts) :
+        m_coords(coords), m_dim(dim), m_pts(pts)
+    {}
+    ~PointSet();
+
+    const double *m_coords;
+    int m_dim;
+    cuda::Points *m_pts;
+};
+
+namespace
+{
+
+// Points on the GPU, by the address of their coordinates on the host.
+std::mutex s_registryLock;
+std::map<const double *, std::weak_ptr<PointSet>> s_registry;
+
+std::atomic<bool> s_enabled(true);
+
+bool devicePresent()
+{
+    static const bool s_present = []()
+    {
+        std::string val;
+        Utils::getenv("PDAL_GPU", val);
+        return !Utils::iequals(val, "off") && cuda::deviceCount() > 0;
+    }();
+    return s_present;
+}
+
+} // unnamed namespace
+
+PointSet::~PointSet()
+{
+    {
+        std::lock_guard<std::mutex> lock(s_registryLock);
+        auto it = s_registry.find(m_coords);
+        if (it != s_registry.end() && it->second.expired())
+            s_registry.erase(it);
+    }
+    cuda::release(m_pts);
+}
+
+bool enabled()
+{
+    return s_enabled && devicePresent();
+}
+
+void setEnabled(bool on)
+{
+    s_enabled = on;
+}
+
+std::shared_ptr<PointSet> upload(const double *coords, point_count_t count,
+    int dim)
+{
+    if (!enabled())
+        return nullptr;
+    cuda::Points *pts = cuda::upload(coords, count, dim);
+    if (!pts)
+        return nullptr;
+
+    std::shared_ptr<PointSet> set(new PointSet(coords, dim, pts));
+    std::lock_guard<std::mutex> lock(s_registryLock);
+    s_registry[coords] = set;
+    return set;
+}
+
+bool knn(const PointSet& pts, PointId begin, PointId end, point_count_t k,
+    KDNeighbors& out)
+{
+    if (!enabled() || k > MaxK || end <= begin)
+        return false;
+
+    const std::size_t count = end - begin;
+    KDNeighbors nbrs;
+    nbrs.ids.resize(count * k);
+    nbrs.sqrDists.resize(count * k);
+    if (!cuda::knn(pts.m_pts, begin, end, k, nbrs.ids.data(),
+            nbrs.sqrDists.data()))
+        return false;
+
+    // Every query point has k neighbors.
+    nbrs.offsets.resize(count + 1);
+    for (std::size_t i = 0; i <= count; ++i)
+        nbrs.offsets[i] = i * k;
+    out = std::move(nbrs);
+    return true;
+}
+
+bool radiusCount(const PointSet& pts, PointId begin, PointId end, double r,
+    std::vector<point_count_t>& counts)
+{
+    if (!enabled() || end <= begin)
+        return false;
+
+    std::vector<point_count_t> found(end - begin);
+    if (!cuda::radiusCount(pts.m_pts, begin, end, r, found.data()))
+        return false;
+    counts = std::move(found);
+    return true;
+}
+
+bool covarianceEigen(const double *coords, const KDNeighbors& nbrs,
+    point_count_t skip, std::vector<CovarianceEigen>& out)
+{
+    if (!enabled() || nbrs.size() == 0)
+        return false;
+
+    std::shared_ptr<PointSet> pts;
+    {
+        std::lock_guard<std::mutex> lock(s_registryLock);
+        auto it = s_registry.find(coords);
+        if (it != s_registry.end())
+            pts = it->second.lock();
+    }
+    if (!pts || pts->m_dim != 3)
+        return false;
+
+    const std::size_t count = nbrs.size();
+    std::vector<double> results(count * 15);
+    std::vector<uint8_t> valid(count);
+    if (!cuda::covarianceEigen(pts->m_pts, nbrs.offsets.data(), count,
+            nbrs.ids.data(), skip, results.data(), valid.data()))
+        return false;
+
+    out.resize(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const double *r = results.data() + i * 15;
+        CovarianceEigen& e = out[i];
+        e.centroid = Eigen::Vector3d(r[0], r[1], r[2]);
+        e.values = Eigen::Vector3d(r[3], r[4], r[5]);
+        for (int c = 0; c < 3; ++c)
+            for (int k = 0; k < 3; ++k)
+                e.vectors(k, c) = r[6 + c * 3 + k];
+        e.valid = valid[i];
+    }
+    return true;
+}
+
+} // namespace gpu
+} // namespace pdal
+
+#else // PDAL_HAVE_CUDA
+
+// Without CUDA all work is done on the CPU.
+
+namespace pdal
+{
+namespace gpu
+{
+
+class PointSet
+{};
+
+bool enabled()
+{
+    return false;
+}
+
+void setEnabled(bool)
+{}
+
+std::shared_ptr<PointSet> upload(const double *, point_count_t, int)
+{
+    return nullptr;
+}
+
+bool knn(const PointSet&, PointId, PointId, point_count_t, KDNeighbors&)
+{
+    return false;
+}
+
+bool radiusCount(const PointSet&, PointId, PointId, double,
+    std::vector<point_count_t>&)
+{
+    return false;
+}
+
+bool covarianceEigen(const double *, const KDNeighbors&, point_count_t,
+    std::vector<CovarianceEigen>&)
+{
+    return false;
+}
+
+} // namespace gpu
+} // namespace pdal
+
+#endif // PDAL_HAVE_CUDA
@@ -0,0 +1,147 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <pdal/pdal_internal.hpp>
+
+namespace pdal
+{
+
+struct KDNeighbors;
+struct CovarianceEigen;
+
+/**
+  Optional GPU backend for the batched neighbor queries of KDIndex and the
+  covariance eigen decomposition of EigenUtils.
+
+  The backend is available when PDAL is built with CUDA (WITH_CUDA) and a
+  device is present at run time.  Setting the environment variable
+  PDAL_GPU to "off" disables it.  Every function returns false when the
+  work wasn't done on the GPU, in which case the caller does it on the CPU.
+*/
+namespace gpu
+{
+
+/// Smallest number of queries in a batch that's run on the GPU.  Smaller
+/// batches don't make up for the cost of the transfers.
+static const point_count_t MinBatch = 1024;
+
+/// Largest k of a k-nearest neighbor query run on the GPU.
+static const point_count_t MaxK = 64;
+
+/**
+  Whether work is run on the GPU.
+
+  \return  true if the backend is built, a device is present and the
+    backend hasn't been disabled.
+*/
+PDAL_DLL bool enabled();
+
+/**
+  Enable or disable the GPU backend.  Disabling it runs all work on the
+  CPU.  Enabling it has no effect when there is no device.
+
+  \param on  Whether the backend is used.
+*/
+PDAL_DLL void setEnabled(bool on);
+
+/**
+  Points copied to the GPU along with a grid used to find neighbors.
+  Opaque outside of the backend.
+*/
+class PointSet;
+
+/**
+  Copy a set of points to the GPU.  The copy is registered under the
+  address of \a coords so that covarianceEigen() can use it until it's
+  destroyed, so \a coords must outlive it.
+
+  \param coords  Packed coordinates of the points, \a dim values per point.
+  \param count  Number of points.
+  \param dim  Number of coordinates of each point (2 or 3).
+  \return  The points on the GPU, or null if they couldn't be copied.
+*/
+PDAL_DLL std::shared_ptr<PointSet> upload(const double *coords,
+    point_count_t count, int dim);
+
+/**
+  Find the k nearest neighbors of the points in [begin, end), as
+  KDIndex::knnRange().  Neighbors at the same distance from a query point
+  may be listed in a different order than by the CPU search.
+
+  \param pts  Points to search.
+  \param begin  ID of the first query point.
+  \param end  ID one past the last query point.
+  \param k  Number of neighbors to find.  No more than the number of
+    points.
+  \param out  Set to the neighbors of each query point.
+  \return  false if the query wasn't run on the GPU.
+*/
+PDAL_DLL bool knn(const PointSet& pts, PointId begin, PointId end,
+    point_count_t k, KDNeighbors& out);
+
+/**
+  Count the neighbors within a radius of the points in [begin, end), as
+  KDIndex::radiusCountRange().
+
+  \param pts  Points to search.
+  \param begin  ID of the first query point.
+  \param end  ID one past the last query point.
+  \param r  Search radius.
+  \param counts  Set to the number of neighbors of each query point.
+  \return  false if the query wasn't run on the GPU.
+*/
+PDAL_DLL bool radiusCount(const PointSet& pts, PointId begin, PointId end,
+    double r, std::vector<point_count_t>& counts);
+
+/**
+  Compute the eigen decomposition of the covariance of a batch of
+  neighborhoods, as pdal::computeCovarianceEigen().  This is only done
+  when \a coords are the coordinates of 3D points that have been uploaded.
+
+  \param coords  Packed XYZ coordinates of the points.
+  \param nbrs  The neighborhoods.
+  \param skip  Number of leading neighbors of each neighborhood to leave
+    out.
+  \param out  Set to one result per neighborhood.
+  \return  false if the computation wasn't run on the GPU.
+*/
+PDAL_DLL bool covarianceEigen(const double *coords, const KDNeighbors& nbrs,
+    point_count_t skip, std::vector<CovarianceEigen>& out);
+
+} // namespace gpu
+} // namespace pdal
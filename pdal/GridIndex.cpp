@@ -0,0 +1,340 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <pdal/DimAccessor.hpp>
+#include <pdal/GridIndex.hpp>
+#include <pdal/util/TaskScheduler.hpp>
+
+namespace pdal
+{
+
+GridIndex::GridIndex(const PointView& view, double cellSize) :
+    m_view(view), m_cellSize(cellSize), m_minx(0), m_miny(0), m_minz(0),
+    m_shift(63)
+{
+    if (!view.hasDim(Dimension::Id::X))
+        throw pdal_error("GridIndex: point view missing 'X' dimension.");
+    if (!view.hasDim(Dimension::Id::Y))
+        throw pdal_error("GridIndex: point view missing 'Y' dimension.");
+    if (!view.hasDim(Dimension::Id::Z))
+        throw pdal_error("GridIndex: point view missing 'Z' dimension.");
+    if (!(cellSize > 0) || !std::isfinite(cellSize))
+        throw pdal_error("GridIndex: cell size must be positive.");
+}
+
+
+void GridIndex::build()
+{
+    const point_count_t count = m_view.size();
+
+    m_coords.resize(count * 3);
+    DimAccessor<double>(m_view, Dimension::Id::X).forEach(
+        [this](PointId idx, double d){ m_coords[idx * 3] = d; });
+    DimAccessor<double>(m_view, Dimension::Id::Y).forEach(
+        [this](PointId idx, double d){ m_coords[idx * 3 + 1] = d; });
+    DimAccessor<double>(m_view, Dimension::Id::Z).forEach(
+        [this](PointId idx, double d){ m_coords[idx * 3 + 2] = d; });
+
+    m_minx = m_miny = m_minz = (std::numeric_limits<double>::max)();
+    for (PointId idx = 0; idx < count; ++idx)
+    {
+        m_minx = (std::min)(m_minx, m_coords[idx * 3]);
+        m_miny = (std::min)(m_miny, m_coords[idx * 3 + 1]);
+        m_minz = (std::min)(m_minz, m_coords[idx * 3 + 2]);
+    }
+
+    // Use a power of two buckets, at least as many as there are points.
+    int bits = 1;
+    while (bits < 62 && ((point_count_t)1 << bits) < count)
+        bits++;
+    m_shift = 64 - bits;
+    const std::size_t numBuckets = (std::size_t)1 << bits;
+
+    // Counting sort of the points by bucket.
+    std::vector<std::uint64_t> buckets(count);
+    m_start.assign(numBuckets + 1, 0);
+    for (PointId idx = 0; idx < count; ++idx)
+    {
+        const double *pt = m_coords.data() + idx * 3;
+        std::uint64_t b = bucket(cell(pt[0], m_minx), cell(pt[1], m_miny),
+            cell(pt[2], m_minz));
+        buckets[idx] = b;
+        m_start[b + 1]++;
+    }
+    for (std::size_t b = 0; b < numBuckets; ++b)
+        m_start[b + 1] += m_start[b];
+
+    std::vector<std::size_t> pos(m_start.begin(), m_start.end() - 1);
+    m_ids.resize(count);
+    m_sorted.resize(count * 3);
+    for (PointId idx = 0; idx < count; ++idx)
+    {
+        std::size_t p = pos[buckets[idx]]++;
+        m_ids[p] = idx;
+        std::copy(m_coords.begin() + idx * 3, m_coords.begin() + idx * 3 + 3,
+            m_sorted.begin() + p * 3);
+    }
+}
+
+
+std::int64_t GridIndex::cell(double v, double min) const
+{
+    return (std::int64_t)std::floor((v - min) / m_cellSize);
+}
+
+
+std::uint64_t GridIndex::bucket(std::int64_t i, std::int64_t j,
+    std::int64_t k) const
+{
+    std::uint64_t h = ((std::uint64_t)i * 73856093) ^
+        ((std::uint64_t)j * 19349663) ^ ((std::uint64_t)k * 83492791);
+    return (h * 0x9E3779B97F4A7C15ULL) >> m_shift;
+}
+
+
+// Cells that overlap the query may share a bucket, so each bucket is
+// listed once.
+void GridIndex::findBuckets(const double *pt, double r,
+    std::vector<std::uint64_t>& visited) const
+{
+    visited.clear();
+
+    const std::int64_t i0 = cell(pt[0] - r, m_minx);
+    const std::int64_t i1 = cell(pt[0] + r, m_minx);
+    const std::int64_t j0 = cell(pt[1] - r, m_miny);
+    const std::int64_t j1 = cell(pt[1] + r, m_miny);
+    const std::int64_t k0 = cell(pt[2] - r, m_minz);
+    const std::int64_t k1 = cell(pt[2] + r, m_minz);
+    const std::size_t numBuckets = m_start.size() - 1;
+
+    const double numCells = double(i1 - i0 + 1) * double(j1 - j0 + 1) *
+        double(k1 - k0 + 1);
+    if (numCells >= numBuckets)
+    {
+        for (std::uint64_t b = 0; b < numBuckets; ++b)
+            visited.push_back(b);
+    }
+    else
+    {
+        for (std::int64_t i = i0; i <= i1; ++i)
+            for (std::int64_t j = j0; j <= j1; ++j)
+                for (std::int64_t k = k0; k <= k1; ++k)
+                    visited.push_back(bucket(i, j, k));
+        std::sort(visited.begin(), visited.end());
+        visited.erase(std::unique(visited.begin(), visited.end()),
+            visited.end());
+    }
+}
+
+
+// As with KD3Index, a point is in the radius when its square distance is
+// less than the square of the radius.
+void GridIndex::search(const double *pt, double r, MatchList& matches,
+    std::vector<std::uint64_t>& visited) const
+{
+    matches.clear();
+    if (m_ids.empty())
+        return;
+    findBuckets(pt, r, visited);
+
+    const double r2 = r * r;
+    for (std::uint64_t b : visited)
+    {
+        for (std::size_t p = m_start[b]; p < m_start[b + 1]; ++p)
+        {
+            const double *q = m_sorted.data() + p * 3;
+            double dx = pt[0] - q[0];
+            double dy = pt[1] - q[1];
+            double dz = pt[2] - q[2];
+            double d2 = dx * dx + dy * dy + dz * dz;
+            if (d2 < r2)
+                matches.push_back(std::make_pair(d2, m_ids[p]));
+        }
+    }
+    std::sort(matches.begin(), matches.end());
+}
+
+
+point_count_t GridIndex::count(const double *pt, double r,
+    std::vector<std::uint64_t>& visited) const
+{
+    if (m_ids.empty())
+        return 0;
+    findBuckets(pt, r, visited);
+
+    const double r2 = r * r;
+    point_count_t n = 0;
+    for (std::uint64_t b : visited)
+    {
+        for (std::size_t p = m_start[b]; p < m_start[b + 1]; ++p)
+        {
+            const double *q = m_sorted.data() + p * 3;
+            double dx = pt[0] - q[0];
+            double dy = pt[1] - q[1];
+            double dz = pt[2] - q[2];
+            n += (dx * dx + dy * dy + dz * dz < r2);
+        }
+    }
+    return n;
+}
+
+
+PointIdList GridIndex::radius(double x, double y, double z, double r) const
+{
+    double pt[3] { x, y, z };
+    MatchList matches;
+    std::vector<std::uint64_t> visited;
+
+    search(pt, r, matches, visited);
+
+    PointIdList output;
+    output.reserve(matches.size());
+    for (auto& m : matches)
+        output.push_back(m.second);
+    return output;
+}
+
+
+PointIdList GridIndex::radius(PointId idx, double r) const
+{
+    const double *pt = m_coords.data() + idx * 3;
+    return radius(pt[0], pt[1], pt[2], r);
+}
+
+
+PointIdList GridIndex::radius(PointRef& point, double r) const
+{
+    double x = point.getFieldAs<double>(Dimension::Id::X);
+    double y = point.getFieldAs<double>(Dimension::Id::Y);
+    double z = point.getFieldAs<double>(Dimension::Id::Z);
+
+    return radius(x, y, z, r);
+}
+
+
+KDNeighbors GridIndex::radiusRange(PointId begin, PointId end, double r,
+    unsigned threads) const
+{
+    struct Chunk
+    {
+        std::vector<std::size_t> counts;
+        PointIdList ids;
+        std::vector<double> sqrDists;
+    };
+
+    end = (std::min)(end, (PointId)m_coords.size() / 3);
+    begin = (std::min)(begin, end);
+    if (threads == 0)
+        threads = (unsigned)TaskScheduler::instance().concurrency();
+
+    const point_count_t total = end - begin;
+    std::size_t numChunks = (threads > 1) ? threads * 4 : 1;
+    numChunks = (std::max)((point_count_t)1,
+        (std::min)((point_count_t)numChunks, total));
+    std::vector<Chunk> chunks(numChunks);
+
+    auto run = [this, &chunks, begin, total, numChunks, r](std::size_t c)
+    {
+        Chunk& chunk = chunks[c];
+        MatchList matches;
+        std::vector<std::uint64_t> visited;
+        const PointId first = begin + total * c / numChunks;
+        const PointId last = begin + total * (c + 1) / numChunks;
+        chunk.counts.reserve(last - first);
+        for (PointId idx = first; idx < last; ++idx)
+        {
+            search(m_coords.data() + idx * 3, r, matches, visited);
+            for (auto& m : matches)
+            {
+                chunk.ids.push_back(m.second);
+                chunk.sqrDists.push_back(m.first);
+            }
+            chunk.counts.push_back(matches.size());
+        }
+    };
+
+    parallelFor(numChunks, threads, run);
+
+    KDNeighbors out;
+    std::size_t numIds = 0;
+    for (Chunk& chunk : chunks)
+        numIds += chunk.ids.size();
+    out.offsets.reserve(total + 1);
+    out.ids.reserve(numIds);
+    out.sqrDists.reserve(numIds);
+    out.offsets.push_back(0);
+    for (Chunk& chunk : chunks)
+    {
+        for (std::size_t count : chunk.counts)
+            out.offsets.push_back(out.offsets.back() + count);
+        out.ids.insert(out.ids.end(), chunk.ids.begin(), chunk.ids.end());
+        out.sqrDists.insert(out.sqrDists.end(), chunk.sqrDists.begin(),
+            chunk.sqrDists.end());
+        chunk = Chunk();
+    }
+    return out;
+}
+
+
+std::vector<point_count_t> GridIndex::radiusCountRange(PointId begin,
+    PointId end, double r, unsigned threads) const
+{
+    end = (std::min)(end, (PointId)m_coords.size() / 3);
+    begin = (std::min)(begin, end);
+    if (threads == 0)
+        threads = (unsigned)TaskScheduler::instance().concurrency();
+
+    const point_count_t total = end - begin;
+    std::vector<point_count_t> counts(total);
+    std::size_t numChunks = (threads > 1) ? threads * 4 : 1;
+    numChunks = (std::max)((point_count_t)1,
+        (std::min)((point_count_t)numChunks, total));
+
+    auto run = [this, &counts, begin, total, numChunks, r](std::size_t c)
+    {
+        std::vector<std::uint64_t> visited;
+        const PointId first = begin + total * c / numChunks;
+        const PointId last = begin + total * (c + 1) / numChunks;
+        for (PointId idx = first; idx < last; ++idx)
+            counts[idx - begin] = count(m_coords.data() + idx * 3, r, visited);
+    };
+
+    parallelFor(numChunks, threads, run);
+    return counts;
+}
+
+} // namespace pdal
@@ -0,0 +1,173 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <pdal/KDIndex.hpp>
+#include <pdal/PointView.hpp>
+
+namespace pdal
+{
+
+/**
+  Uniform grid index of the XYZ positions of the points in a view, for
+  fixed-radius queries.
+
+  Space is divided into cubic cells that are hashed into buckets.  The
+  points are counting-sorted by bucket, so each bucket's points and their
+  coordinates are contiguous.  A radius query only visits the buckets of
+  the cells that overlap the query's bounding cube.  Queries are fastest
+  when the cell size is about the query radius.
+
+  The query interface follows that of KD3Index.
+*/
+class PDAL_DLL GridIndex
+{
+public:
+    /**
+      Create an index.
+
+      \param view  View containing the points to index.
+      \param cellSize  Edge length of a grid cell.
+    */
+    GridIndex(const PointView& view, double cellSize);
+
+    /**
+      Build the index.
+    */
+    void build();
+
+    /**
+      Find the points within a radius of a location.
+
+      \param x  X coordinate of the location.
+      \param y  Y coordinate of the location.
+      \param z  Z coordinate of the location.
+      \param r  Search radius.
+      \return  IDs of the points in the radius, nearest first.
+    */
+    PointIdList radius(double x, double y, double z, double r) const;
+
+    /**
+      Find the points within a radius of a point in the view.
+
+      \param idx  ID of the point.
+      \param r  Search radius.
+      \return  IDs of the points in the radius, nearest first.  The point
+        itself is included.
+    */
+    PointIdList radius(PointId idx, double r) const;
+
+    /**
+      Find the points within a radius of a point.
+
+      \param point  Point at the center of the search.
+      \param r  Search radius.
+      \return  IDs of the points in the radius, nearest first.
+    */
+    PointIdList radius(PointRef& point, double r) const;
+
+    /**
+      Find the neighbors within a radius of every indexed point.
+
+      \param r  Search radius.
+      \param threads  Number of threads used to run the queries.  When 0,
+        one thread per core is used.
+      \return  Neighbors of each point, in point order.
+    */
+    KDNeighbors radiusAll(double r, unsigned threads = 0) const
+        { return radiusRange(0, m_view.size(), r, threads); }
+
+    /**
+      Find the neighbors within a radius of the points in [begin, end).
+
+      \param begin  ID of the first query point.
+      \param end  ID one past the last query point.
+      \param r  Search radius.
+      \param threads  Number of threads used to run the queries.  When 0,
+        one thread per core is used.
+      \return  Neighbors of each point, in point order.
+    */
+    KDNeighbors radiusRange(PointId begin, PointId end, double r,
+        unsigned threads = 0) const;
+
+    /**
+      Count the neighbors within a radius of the points in [begin, end)
+      without collecting them.  The counts include the query point itself.
+
+      \param begin  ID of the first query point.
+      \param end  ID one past the last query point.
+      \param r  Search radius.
+      \param threads  Number of threads used to run the queries.  When 0,
+        one thread per core is used.
+      \return  Number of neighbors of each point, in point order.
+    */
+    std::vector<point_count_t> radiusCountRange(PointId begin, PointId end,
+        double r, unsigned threads = 0) const;
+
+private:
+    typedef std::vector<std::pair<double, PointId>> MatchList;
+
+    const PointView& m_view;
+    double m_cellSize;
+    double m_minx;
+    double m_miny;
+    double m_minz;
+    int m_shift;
+    // Coordinates of the points, in point order.
+    std::vector<double> m_coords;
+    // Index of the first entry of each bucket in m_ids and m_sorted.
+    std::vector<std::size_t> m_start;
+    // IDs of the points, in bucket order.
+    PointIdList m_ids;
+    // Coordinates of the points, in bucket order.
+    std::vector<double> m_sorted;
+
+    std::int64_t cell(double v, double min) const;
+    std::uint64_t bucket(std::int64_t i, std::int64_t j,
+        std::int64_t k) const;
+    void findBuckets(const double *pt, double r,
+        std::vector<std::uint64_t>& visited) const;
+    void search(const double *pt, double r, MatchList& matches,
+        std::vector<std::uint64_t>& visited) const;
+    point_count_t count(const double *pt, double r,
+        std::vector<std::uint64_t>& visited) const;
+
+    GridIndex(const GridIndex&);
+    GridIndex& operator=(const GridIndex&);
+};
+
+} // namespace pdal
@@ -34,12 +34,21 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <list>
 #include <memory>
+#include <mutex>
 
 #include <nanoflann/nanoflann.hpp>
 
+#include <pdal/ArtifactManager.hpp>
+#include <pdal/DimAccessor.hpp>
 #include <pdal/EigenUtils.hpp>
+#include <pdal/Gpu.hpp>
 #include <pdal/PointView.hpp>
+#include <pdal/util/TaskScheduler.hpp>
 
 namespace nanoflann
 {
@@ -53,11 +62,266 @@ namespace nanoflann
 namespace pdal
 {
 
+/**
+  Neighbors of a sequence of query points, stored in compressed sparse row
+  layout.  The neighbors of the i'th query point are ids[offsets[i]]
+  through ids[offsets[i + 1] - 1], nearest first.  sqrDists holds the
+  square distance of each neighbor from its query point.
+*/
+struct KDNeighbors
+{
+    std::vector<std::size_t> offsets;
+    PointIdList ids;
+    std::vector<double> sqrDists;
+
+    /// Number of query points.
+    std::size_t size() const
+        { return offsets.empty() ? 0 : offsets.size() - 1; }
+
+    /// Number of neighbors of query point \a i.
+    std::size_t count(std::size_t i) const
+        { return offsets[i + 1] - offsets[i]; }
+
+    /// Neighbors of query point \a i.
+    const PointId *neighbors(std::size_t i) const
+        { return ids.data() + offsets[i]; }
+
+    /// Square distances of the neighbors of query point \a i.
+    const double *distances(std::size_t i) const
+        { return sqrDists.data() + offsets[i]; }
+};
+
+/**
+  Packed coordinates of a set of points and a KD-tree over them.  A tree
+  isn't changed once it's built, so it can be shared by the indexes of
+  views that hold the same points.
+*/
+template<int DIM>
+class KDTree
+{
+public:
+    typedef nanoflann::KDTreeSingleIndexAdaptor<nanoflann::L2_Simple_Adaptor<
+        double, KDTree, double>, KDTree, -1, std::size_t> nanoflann_tree_t;
+
+    /**
+      Build a tree.
+
+      \param coords  Coordinates of the points, DIM values per point.
+      \param threads  Number of threads used to build the tree.
+    */
+    KDTree(std::vector<double>&& coords, unsigned threads) :
+        m_coords(std::move(coords))
+    {
+        m_tree.reset(new nanoflann_tree_t(DIM, *this,
+            nanoflann::KDTreeSingleIndexAdaptorParams(100, threads)));
+        m_tree->buildIndex();
+        m_memory.set(m_coords.capacity() * sizeof(double) +
+            m_tree->usedMemory());
+    }
+
+    const std::vector<double>& coords() const
+        { return m_coords; }
+
+    const nanoflann_tree_t& tree() const
+        { return *m_tree; }
+
+    /**
+      Copy of the points on the GPU, made on first use.
+
+      \return  The points on the GPU, or null if the GPU backend isn't
+        enabled or the points couldn't be copied.
+    */
+    const gpu::PointSet *gpuPoints() const
+    {
+        if (!gpu::enabled())
+            return nullptr;
+        std::call_once(m_gpuOnce, [this]()
+            {
+                m_gpuPoints = gpu::upload(m_coords.data(),
+                    kdtree_get_point_count(), DIM);
+            });
+        return m_gpuPoints.get();
+    }
+
+    std::size_t kdtree_get_point_count() const
+        { return m_coords.size() / DIM; }
+
+    double kdtree_get_pt(const PointId idx, int dim) const
+    {
+        if (idx >= kdtree_get_point_count())
+            return 0.0;
+        if (dim < 0 || dim >= DIM)
+            throw pdal_error("kdtree_get_pt: Request for invalid dimension "
+                "from nanoflann");
+        return m_coords[idx * DIM + dim];
+    }
+
+    // nanoflann hands us a vector that represents the position of p1.  We
+    // fetch the position of p2 and and compute the square distance.
+    double kdtree_distance(const double *p1, const PointId idx,
+        size_t /*numDims*/) const
+    {
+        const double *p2 = m_coords.data() + idx * DIM;
+        double result(0.0);
+        for (int i = 0; i < DIM; ++i)
+        {
+            double d = p1[i] - p2[i];
+            result += d * d;
+        }
+        return result;
+    }
+
+    template <class BBOX> bool kdtree_get_bbox(BBOX& bb) const
+    {
+        for (int i = 0; i < DIM; ++i)
+        {
+            bb[i].low = 0.0;
+            bb[i].high = 0.0;
+        }
+        if (m_coords.empty())
+            return true;
+
+        for (int i = 0; i < DIM; ++i)
+        {
+            bb[i].low = (std::numeric_limits<double>::max)();
+            bb[i].high = (std::numeric_limits<double>::lowest)();
+        }
+        for (auto it = m_coords.begin(); it != m_coords.end(); it += DIM)
+            for (int i = 0; i < DIM; ++i)
+            {
+                bb[i].low = (std::min)(bb[i].low, it[i]);
+                bb[i].high = (std::max)(bb[i].high, it[i]);
+            }
+        return true;
+    }
+
+private:
+    std::vector<double> m_coords;
+    std::unique_ptr<nanoflann_tree_t> m_tree;
+    MemoryCharge m_memory;
+    // The GPU copy is registered under the address of the coordinates, so
+    // it must be destroyed first.
+    mutable std::once_flag m_gpuOnce;
+    mutable std::shared_ptr<gpu::PointSet> m_gpuPoints;
+
+    KDTree(const KDTree&);
+    KDTree& operator=(const KDTree&);
+};
+
+/**
+  Cache of the KD-trees built for the views of a point table.
+
+  Trees are keyed by the coordinates of the points they index, so a view
+  whose points have the same positions as those of an earlier view, in
+  the same order, shares its tree.  Because the key is the content, a
+  tree is never reused after the points have been moved.  The cache is
+  stored with the table's artifacts and refers to the most recently used
+  MaxEntries trees without owning them, so a tree is freed with the
+  indexes of the views that use it.  The coordinates are only compared
+  with those of a tree whose hash matches, which costs less than building
+  a tree.
+*/
+template<int DIM>
+class KDTreeCache : public Artifact
+{
+public:
+    typedef std::shared_ptr<const KDTree<DIM>> TreePtr;
+
+    /// Number of trees referred to by the cache.
+    static const std::size_t MaxEntries = 4;
+
+    /**
+      Get the cache of a point table, creating it if necessary.
+
+      \param table  Table whose cache should be returned.
+      \return  The table's cache.
+    */
+    static KDTreeCache& get(BasePointTable& table)
+    {
+        static std::mutex mutex;
+        const std::string name(DIM == 2 ? "pdal.kdtree2d" : "pdal.kdtree3d");
+
+        std::lock_guard<std::mutex> lock(mutex);
+        ArtifactManager& mgr = table.artifactManager();
+        std::shared_ptr<KDTreeCache> cache = mgr.get<KDTreeCache>(name);
+        if (!cache)
+        {
+            cache.reset(new KDTreeCache);
+            mgr.replaceOrPut(name, cache);
+        }
+        return *cache;
+    }
+
+    /**
+      Find the tree built over a set of coordinates.
+
+      \param coords  Coordinates of the points, DIM values per point.
+      \return  The tree, or null if it isn't in the cache.
+    */
+    TreePtr find(const std::vector<double>& coords)
+    {
+        const std::uint64_t h = hash(coords);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto it = m_entries.begin(); it != m_entries.end();)
+        {
+            TreePtr tree = it->second.lock();
+            if (!tree)
+            {
+                it = m_entries.erase(it);
+                continue;
+            }
+            if (it->first == h && tree->coords() == coords)
+            {
+                m_entries.splice(m_entries.begin(), m_entries, it);
+                return tree;
+            }
+            ++it;
+        }
+        return TreePtr();
+    }
+
+    /**
+      Add a tree to the cache, forgetting the least recently used tree if
+      the cache is full.  The cache doesn't keep the tree alive.
+
+      \param tree  Tree to add.
+    */
+    void insert(TreePtr tree)
+    {
+        const std::uint64_t h = hash(tree->coords());
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_entries.emplace_front(h, tree);
+        if (m_entries.size() > MaxEntries)
+            m_entries.pop_back();
+    }
+
+private:
+    std::mutex m_mutex;
+    std::list<std::pair<std::uint64_t, std::weak_ptr<const KDTree<DIM>>>>
+        m_entries;
+
+    static std::uint64_t hash(const std::vector<double>& coords)
+    {
+        std::uint64_t h = 14695981039346656037ULL;
+        for (double d : coords)
+        {
+            std::uint64_t v;
+            std::memcpy(&v, &d, sizeof(v));
+            h = (h ^ v) * 1099511628211ULL;
+        }
+        return h;
+    }
+};
+
 template<int DIM>
 class PDAL_DLL KDIndex
 {
 protected:
-    KDIndex(const PointView& buf) : m_buf(buf)
+    KDIndex(const PointView& buf) : m_buf(buf), m_x(buf, Dimension::Id::X),
+        m_y(buf, Dimension::Id::Y), m_z(buf, Dimension::Id::Z),
+        m_index(nullptr)
     {}
 
     ~KDIndex()
@@ -65,28 +329,261 @@ protected:
 
 public:
     std::size_t kdtree_get_point_count() const
-        { return m_buf.size(); }
+        { return m_tree ? m_tree->kdtree_get_point_count() : 0; }
+
+    /**
+      Coordinates of the indexed points, DIM values per point, in point
+      order.  Only valid once the index has been built.
+    */
+    const std::vector<double>& coords() const
+        { return m_tree->coords(); }
+
+    /**
+      Build the index.
+
+      The coordinates of the points are copied into a packed array so that
+      building and searching the tree don't go through the point view.
+      Large trees are built with several threads, each building a subtree.
+
+      \param threads  Number of threads used to build the tree.  When 0,
+        one thread per core is used for views of at least MinThreadedBuild
+        points.
+    */
+    void build(unsigned threads = 0)
+    {
+        std::vector<double> coords = gatherCoords();
+        setTree(typename KDTreeCache<DIM>::TreePtr(
+            new KDTree<DIM>(std::move(coords), buildThreads(threads))));
+    }
 
-    double kdtree_get_pt(const PointId idx, int dim) const;
-    double kdtree_distance(const double *p1, const PointId p2_idx,
-        size_t /*numDims*/) const;
-    template <class BBOX> bool kdtree_get_bbox(BBOX& bb) const;
-    void build()
+    /**
+      Build the index, sharing a tree from a cache when one has been built
+      over points with the same positions.  A newly built tree is added to
+      the cache.
+
+      \param cache  Cache of trees.
+    */
+    void build(KDTreeCache<DIM>& cache)
     {
-        m_index.reset(new my_kd_tree_t(DIM, *this,
-            nanoflann::KDTreeSingleIndexAdaptorParams(100)));
-        m_index->buildIndex();
+        std::vector<double> coords = gatherCoords();
+        typename KDTreeCache<DIM>::TreePtr tree = cache.find(coords);
+        if (!tree)
+        {
+            tree.reset(new KDTree<DIM>(std::move(coords), buildThreads(0)));
+            cache.insert(tree);
+        }
+        setTree(tree);
     }
 
+    /// Smallest view whose index is built with more than one thread by
+    /// default.
+    static const PointId MinThreadedBuild = 100000;
+
+    /**
+      Find the k nearest neighbors of every indexed point.  The neighbors
+      include the query point itself.
+
+      \param k  Number of neighbors to find.
+      \param threads  Number of threads used to run the queries.  When 0,
+        one thread per core is used.
+      \param eps  Approximation factor.  When greater than 0, the search
+        skips parts of the tree that can't hold a point whose squared
+        distance is less than 1 / (1 + eps) of that of the farthest
+        neighbor found so far.  This is faster, but some of the true
+        nearest neighbors may be missed.
+      \return  Neighbors of each point, in point order.
+    */
+    KDNeighbors knnAll(point_count_t k, unsigned threads = 0,
+            double eps = 0) const
+        { return knnRange(0, kdtree_get_point_count(), k, threads, eps); }
+
+    /**
+      Find the k nearest neighbors of the indexed points in [begin, end).
+
+      \param begin  ID of the first query point.
+      \param end  ID one past the last query point.
+      \param k  Number of neighbors to find.
+      \param threads  Number of threads used to run the queries.  When 0,
+        one thread per core is used.
+      \param eps  Approximation factor.  See knnAll().
+      \return  Neighbors of each point, in point order.
+
+      Large batches of queries are run on the GPU when the GPU backend is
+      enabled (see pdal/Gpu.hpp).  That search is exact.
+    */
+    KDNeighbors knnRange(PointId begin, PointId end, point_count_t k,
+        unsigned threads = 0, double eps = 0) const;
+
+    /**
+      Find the neighbors within a radius of every indexed point.  The
+      neighbors include the query point itself.
+
+      \param r  Search radius.
+      \param threads  Number of threads used to run the queries.  When 0,
+        one thread per core is used.
+      \return  Neighbors of each point, in point order.
+    */
+    KDNeighbors radiusAll(double r, unsigned threads = 0) const
+        { return radiusRange(0, kdtree_get_point_count(), r, threads); }
+
+    /**
+      Find the neighbors within a radius of the indexed points in
+      [begin, end).
+
+      \param begin  ID of the first query point.
+      \param end  ID one past the last query point.
+      \param r  Search radius.
+      \param threads  Number of threads used to run the queries.  When 0,
+        one thread per core is used.
+      \return  Neighbors of each point, in point order.
+    */
+    KDNeighbors radiusRange(PointId begin, PointId end, double r,
+        unsigned threads = 0) const;
+
+    /**
+      Count the neighbors within a radius of the indexed points in
+      [begin, end) without collecting them.  The counts include the query
+      point itself.
+
+      \param begin  ID of the first query point.
+      \param end  ID one past the last query point.
+      \param r  Search radius.
+      \param threads  Number of threads used to run the queries.  When 0,
+        one thread per core is used.
+      \return  Number of neighbors of each point, in point order.
+
+      Large batches of queries are run on the GPU when the GPU backend is
+      enabled (see pdal/Gpu.hpp).
+    */
+    std::vector<point_count_t> radiusCountRange(PointId begin, PointId end,
+        double r, unsigned threads = 0) const;
+
+    /**
+      Find the largest squared distance from a query point to its nearest
+      indexed point (the square of the directed Hausdorff distance from the
+      query points to the indexed points).  The search for the nearest
+      neighbor of a query point stops as soon as an indexed point closer
+      than the largest distance found so far is found, since such a query
+      point can't raise the maximum.
+
+      \param coords  Query points, DIM values per point.
+      \param threads  Number of threads used to run the queries.  When 0,
+        one thread per core is used.
+      \return  Largest squared distance, or lowest() when there are no
+        query or indexed points.
+    */
+    double maxNearestSqrDist(const std::vector<double>& coords,
+        unsigned threads = 0) const;
+
 protected:
     const PointView& m_buf;
+    DimAccessor<double> m_x;
+    DimAccessor<double> m_y;
+    DimAccessor<double> m_z;
 
-    typedef nanoflann::KDTreeSingleIndexAdaptor<nanoflann::L2_Simple_Adaptor<
-        double, KDIndex, double>, KDIndex, -1, std::size_t> my_kd_tree_t;
-
-    std::unique_ptr<my_kd_tree_t> m_index;
+    // Tree and coordinates of the indexed points, possibly shared with
+    // other indexes.
+    std::shared_ptr<const KDTree<DIM>> m_tree;
+    const typename KDTree<DIM>::nanoflann_tree_t *m_index;
 
 private:
+    std::vector<double> gatherCoords() const
+    {
+        std::vector<double> coords(m_buf.size() * DIM);
+        m_x.forEach([&coords](PointId idx, double d)
+            { coords[idx * DIM] = d; });
+        m_y.forEach([&coords](PointId idx, double d)
+            { coords[idx * DIM + 1] = d; });
+        if (DIM > 2)
+            m_z.forEach([&coords](PointId idx, double d)
+                { coords[idx * DIM + 2] = d; });
+        return coords;
+    }
+
+    unsigned buildThreads(unsigned threads) const
+    {
+        if (threads == 0)
+            threads = (m_buf.size() < MinThreadedBuild) ? 1 :
+                (unsigned)TaskScheduler::instance().concurrency();
+        return threads;
+    }
+
+    // The points on the GPU if the queries of the points in [begin, end)
+    // should be run there, null otherwise.
+    const gpu::PointSet *gpuPoints(PointId begin, PointId end) const
+    {
+        if (end < begin + gpu::MinBatch)
+            return nullptr;
+        return m_tree->gpuPoints();
+    }
+
+    void setTree(std::shared_ptr<const KDTree<DIM>> tree)
+    {
+        m_tree = tree;
+        m_index = &m_tree->tree();
+    }
+
+    // Results of the queries run by one task of a bulk query.
+    struct QueryChunk
+    {
+        std::vector<std::size_t> counts;
+        PointIdList ids;
+        std::vector<double> sqrDists;
+        std::vector<std::pair<std::size_t, double>> matches;
+    };
+
+    template<typename QUERY>
+    KDNeighbors query(PointId begin, PointId end, unsigned threads,
+        QUERY q) const;
+
+    // Nanoflann result set that tracks the nearest point but stops the
+    // search once a point closer than a bound has been found.
+    class BoundedResultSet
+    {
+    public:
+        BoundedResultSet(double bound) : m_bound(bound),
+            m_dist((std::numeric_limits<double>::max)())
+        {}
+
+        bool full() const
+            { return true; }
+        void addPoint(double dist, std::size_t)
+            { m_dist = (std::min)(m_dist, dist); }
+        // Returning a negative distance prunes the rest of the tree.
+        double worstDist() const
+            { return m_dist < m_bound ? -1.0 : m_dist; }
+        double dist() const
+            { return m_dist; }
+
+    private:
+        double m_bound;
+        double m_dist;
+    };
+
+    // Nanoflann result set that counts the points within a radius.
+    class CountResultSet
+    {
+    public:
+        CountResultSet(double sqrRadius) : m_sqrRadius(sqrRadius), m_count(0)
+        {}
+
+        bool full() const
+            { return true; }
+        void addPoint(double dist, std::size_t)
+        {
+            if (dist < m_sqrRadius)
+                m_count++;
+        }
+        double worstDist() const
+            { return m_sqrRadius; }
+        point_count_t count() const
+            { return m_count; }
+
+    private:
+        double m_sqrRadius;
+        point_count_t m_count;
+    };
+
     KDIndex(const KDIndex&);
     KDIndex& operator=(KDIndex&);
 };
@@ -256,6 +753,33 @@ public:
 
     PointIdList neighbors(double x, double y, double z,
         point_count_t k, size_t stride=1) const
+    {
+        return approxNeighbors(x, y, z, k, 0, stride);
+    }
+
+    PointIdList neighbors(PointId idx, point_count_t k, size_t stride=1) const
+    {
+        double x = m_buf.getFieldAs<double>(Dimension::Id::X, idx);
+        double y = m_buf.getFieldAs<double>(Dimension::Id::Y, idx);
+        double z = m_buf.getFieldAs<double>(Dimension::Id::Z, idx);
+
+        return neighbors(x, y, z, k, stride);
+    }
+
+    PointIdList neighbors(PointRef &point, point_count_t k,
+        size_t stride=1) const
+    {
+        double x = point.getFieldAs<double>(Dimension::Id::X);
+        double y = point.getFieldAs<double>(Dimension::Id::Y);
+        double z = point.getFieldAs<double>(Dimension::Id::Z);
+
+        return neighbors(x, y, z, k, stride);
+    }
+
+    // Like neighbors(), but a non-zero eps makes the search approximate.
+    // See knnAll().
+    PointIdList approxNeighbors(double x, double y, double z,
+        point_count_t k, double eps, size_t stride=1) const
     {
         // Account for input buffer size smaller than requested number of
         // neighbors, then determine the number of neighbors to extract based
@@ -277,7 +801,8 @@ public:
         // neighbor at the given stride.
         nanoflann::KNNResultSet<double, PointId, point_count_t> resultSet(k2);
         resultSet.init(&output[0], &out_dist_sqr[0]);
-        m_index->findNeighbors(resultSet, &pt[0], nanoflann::SearchParams());
+        m_index->findNeighbors(resultSet, &pt[0],
+            nanoflann::SearchParams(32, (float)eps));
 
         // Perform the downsampling if a stride is provided.
         if (stride > 1)
@@ -289,23 +814,14 @@ public:
         return output;
     }
 
-    PointIdList neighbors(PointId idx, point_count_t k, size_t stride=1) const
+    PointIdList approxNeighbors(PointId idx, point_count_t k, double eps,
+        size_t stride=1) const
     {
         double x = m_buf.getFieldAs<double>(Dimension::Id::X, idx);
         double y = m_buf.getFieldAs<double>(Dimension::Id::Y, idx);
         double z = m_buf.getFieldAs<double>(Dimension::Id::Z, idx);
 
-        return neighbors(x, y, z, k, stride);
-    }
-
-    PointIdList neighbors(PointRef &point, point_count_t k,
-        size_t stride=1) const
-    {
-        double x = point.getFieldAs<double>(Dimension::Id::X);
-        double y = point.getFieldAs<double>(Dimension::Id::Y);
-        double z = point.getFieldAs<double>(Dimension::Id::Z);
-
-        return neighbors(x, y, z, k, stride);
+        return approxNeighbors(x, y, z, k, eps, stride);
     }
 
     void knnSearch(double x, double y, double z, point_count_t k,
@@ -503,128 +1019,195 @@ private:
     KDFlexIndex& operator=(KDFlexIndex&);
 };
 
-template<>
-inline
-double KDIndex<2>::kdtree_get_pt(const PointId idx, int dim) const
+// Split the query points into chunks, run the queries of each chunk as a
+// task and concatenate the per-chunk results.  Each chunk reuses its
+// buffers for all of its queries.
+template<int DIM>
+template<typename QUERY>
+KDNeighbors KDIndex<DIM>::query(PointId begin, PointId end, unsigned threads,
+    QUERY q) const
 {
-    if (idx >= m_buf.size())
-        return 0.0;
-
-    Dimension::Id id = Dimension::Id::Unknown;
-    switch (dim)
-    {
-    case 0:
-        id = Dimension::Id::X;
-        break;
-    case 1:
-        id = Dimension::Id::Y;
-        break;
-    default:
-        throw pdal_error("kdtree_get_pt: Request for invalid dimension "
-            "from nanoflann");
-    }
-    return m_buf.getFieldAs<double>(id, idx);
+    end = (std::min)(end, (PointId)kdtree_get_point_count());
+    begin = (std::min)(begin, end);
+    if (threads == 0)
+        threads = (unsigned)TaskScheduler::instance().concurrency();
+
+    const point_count_t total = end - begin;
+    std::size_t numChunks = (threads > 1) ? threads * 4 : 1;
+    numChunks = (std::max)((point_count_t)1,
+        (std::min)((point_count_t)numChunks, total));
+    std::vector<QueryChunk> chunks(numChunks);
+
+    auto run = [this, &chunks, &q, begin, total, numChunks](std::size_t c)
+    {
+        QueryChunk& chunk = chunks[c];
+        const PointId first = begin + total * c / numChunks;
+        const PointId last = begin + total * (c + 1) / numChunks;
+        chunk.counts.reserve(last - first);
+        for (PointId idx = first; idx < last; ++idx)
+            chunk.counts.push_back(q(m_tree->coords().data() + idx * DIM,
+                chunk));
+    };
+
+    parallelFor(numChunks, threads, run);
+
+    KDNeighbors out;
+    std::size_t numIds = 0;
+    for (QueryChunk& chunk : chunks)
+        numIds += chunk.ids.size();
+    out.offsets.reserve(total + 1);
+    out.ids.reserve(numIds);
+    out.sqrDists.reserve(numIds);
+    out.offsets.push_back(0);
+    for (QueryChunk& chunk : chunks)
+    {
+        for (std::size_t count : chunk.counts)
+            out.offsets.push_back(out.offsets.back() + count);
+        out.ids.insert(out.ids.end(), chunk.ids.begin(), chunk.ids.end());
+        out.sqrDists.insert(out.sqrDists.end(), chunk.sqrDists.begin(),
+            chunk.sqrDists.end());
+        chunk = QueryChunk();
+    }
+    return out;
 }
 
-template<>
-inline
-double KDIndex<3>::kdtree_get_pt(const PointId idx, int dim) const
+template<int DIM>
+KDNeighbors KDIndex<DIM>::knnRange(PointId begin, PointId end,
+    point_count_t k, unsigned threads, double eps) const
 {
-    if (idx >= m_buf.size())
-        return 0.0;
-
-    Dimension::Id id = Dimension::Id::Unknown;
-    switch (dim)
-    {
-    case 0:
-        id = Dimension::Id::X;
-        break;
-    case 1:
-        id = Dimension::Id::Y;
-        break;
-    case 2:
-        id = Dimension::Id::Z;
-        break;
-    default:
-        throw pdal_error("kdtree_get_pt: Request for invalid dimension "
-            "from nanoflann");
-    }
-    return m_buf.getFieldAs<double>(id, idx);
-}
+    k = (std::min)((point_count_t)kdtree_get_point_count(), k);
+    end = (std::min)(end, (PointId)kdtree_get_point_count());
 
-// nanoflann hands us a vector that represents the position of p1.  We fetch
-// the position of p2 and and compute the square distance.
-template<>
-inline double KDIndex<2>::kdtree_distance(const double *p1, const PointId idx,
-    size_t /*numDims*/) const
-{
-    double d0 = p1[0] - m_buf.getFieldAs<double>(Dimension::Id::X, idx);
-    double d1 = p1[1] - m_buf.getFieldAs<double>(Dimension::Id::Y, idx);
+    // The GPU search is exact, which satisfies any eps.
+    KDNeighbors out;
+    const gpu::PointSet *pts = gpuPoints(begin, end);
+    if (pts && gpu::knn(*pts, begin, end, k, out))
+        return out;
+
+    const nanoflann::SearchParams params(32, (float)eps);
+    auto q = [this, k, &params](const double *pt, QueryChunk& chunk)
+    {
+        const std::size_t pos = chunk.ids.size();
+        chunk.ids.resize(pos + k);
+        chunk.sqrDists.resize(pos + k);
 
-    return (d0 * d0 + d1 * d1);
+        nanoflann::KNNResultSet<double, PointId, point_count_t> resultSet(k);
+        resultSet.init(chunk.ids.data() + pos, chunk.sqrDists.data() + pos);
+        m_index->findNeighbors(resultSet, pt, params);
+
+        const std::size_t count = resultSet.size();
+        chunk.ids.resize(pos + count);
+        chunk.sqrDists.resize(pos + count);
+        return count;
+    };
+    return query(begin, end, threads, q);
 }
 
-template<>
-inline double KDIndex<3>::kdtree_distance(const double *p1, const PointId idx,
-    size_t /*numDims*/) const
+template<int DIM>
+double KDIndex<DIM>::maxNearestSqrDist(const std::vector<double>& coords,
+    unsigned threads) const
 {
-    double d0 = p1[0] - m_buf.getFieldAs<double>(Dimension::Id::X, idx);
-    double d1 = p1[1] - m_buf.getFieldAs<double>(Dimension::Id::Y, idx);
-    double d2 = p1[2] - m_buf.getFieldAs<double>(Dimension::Id::Z, idx);
+    const std::size_t count = coords.size() / DIM;
+    std::atomic<double> maxDist(std::numeric_limits<double>::lowest());
+    if (count == 0 || kdtree_get_point_count() == 0)
+        return maxDist;
+    if (threads == 0)
+        threads = (unsigned)TaskScheduler::instance().concurrency();
+
+    // Each task handles every numChunks'th point so that all tasks see
+    // points spread over the whole set and the maximum grows quickly.
+    std::size_t numChunks = (threads > 1) ? threads * 4 : 1;
+    numChunks = (std::min)(numChunks, count);
+    auto run = [this, &coords, &maxDist, count, numChunks](std::size_t c)
+    {
+        const nanoflann::SearchParams params(32);
+        double localMax = maxDist.load(std::memory_order_relaxed);
+        for (std::size_t idx = c; idx < count; idx += numChunks)
+        {
+            BoundedResultSet resultSet(localMax);
+            m_index->findNeighbors(resultSet, coords.data() + idx * DIM,
+                params);
+            if (resultSet.dist() > localMax)
+            {
+                localMax = resultSet.dist();
+                double cur = maxDist.load(std::memory_order_relaxed);
+                while (localMax > cur &&
+                    !maxDist.compare_exchange_weak(cur, localMax))
+                {}
+                localMax = (std::max)(localMax, cur);
+            }
+            // Pick up increases found by other tasks now and then.
+            if ((idx / numChunks) % 1024 == 0)
+                localMax = (std::max)(localMax,
+                    maxDist.load(std::memory_order_relaxed));
+        }
+    };
 
-    return (d0 * d0 + d1 * d1 + d2 * d2);
+    parallelFor(numChunks, threads, run);
+    return maxDist;
 }
 
-template<>
-template <class BBOX>
-bool KDIndex<2>::kdtree_get_bbox(BBOX& bb) const
+template<int DIM>
+KDNeighbors KDIndex<DIM>::radiusRange(PointId begin, PointId end,
+    double r, unsigned threads) const
 {
-    if (m_buf.empty())
+    // Our distance metric is square distance, so we use the square of
+    // the radius.
+    const double r2 = r * r;
+    auto q = [this, r2](const double *pt, QueryChunk& chunk)
     {
-        bb[0].low = 0.0;
-        bb[0].high = 0.0;
-        bb[1].low = 0.0;
-        bb[1].high = 0.0;
-    }
-    else
-    {
-        BOX2D bounds;
-        calculateBounds(m_buf, bounds);
+        nanoflann::SearchParams params;
+        params.sorted = true;
 
-        bb[0].low = bounds.minx;
-        bb[0].high = bounds.maxx;
-        bb[1].low = bounds.miny;
-        bb[1].high = bounds.maxy;
-    }
-    return true;
+        const std::size_t count =
+            m_index->radiusSearch(pt, r2, chunk.matches, params);
+        for (auto& m : chunk.matches)
+        {
+            chunk.ids.push_back(m.first);
+            chunk.sqrDists.push_back(m.second);
+        }
+        return count;
+    };
+    return query(begin, end, threads, q);
 }
 
-template<>
-template <class BBOX>
-bool KDIndex<3>::kdtree_get_bbox(BBOX& bb) const
+template<int DIM>
+std::vector<point_count_t> KDIndex<DIM>::radiusCountRange(PointId begin,
+    PointId end, double r, unsigned threads) const
 {
-    if (m_buf.empty())
+    end = (std::min)(end, (PointId)kdtree_get_point_count());
+    begin = (std::min)(begin, end);
+    if (threads == 0)
+        threads = (unsigned)TaskScheduler::instance().concurrency();
+
+    std::vector<point_count_t> counts;
+    const gpu::PointSet *pts = gpuPoints(begin, end);
+    if (pts && gpu::radiusCount(*pts, begin, end, r, counts))
+        return counts;
+
+    const point_count_t total = end - begin;
+    counts.resize(total);
+    std::size_t numChunks = (threads > 1) ? threads * 4 : 1;
+    numChunks = (std::max)((point_count_t)1,
+        (std::min)((point_count_t)numChunks, total));
+
+    const double r2 = r * r;
+    auto run = [this, &counts, begin, total, numChunks, r2](std::size_t c)
     {
-        bb[0].low = 0.0;
-        bb[0].high = 0.0;
-        bb[1].low = 0.0;
-        bb[1].high = 0.0;
-        bb[2].low = 0.0;
-        bb[2].high = 0.0;
-    }
-    else
-    {
-        BOX3D bounds;
-        calculateBounds(m_buf, bounds);
+        const nanoflann::SearchParams params;
+        const PointId first = begin + total * c / numChunks;
+        const PointId last = begin + total * (c + 1) / numChunks;
+        for (PointId idx = first; idx < last; ++idx)
+        {
+            CountResultSet resultSet(r2);
+            m_index->findNeighbors(resultSet,
+                m_tree->coords().data() + idx * DIM, params);
+            counts[idx - begin] = resultSet.count();
+        }
+    };
 
-        bb[0].low = bounds.minx;
-        bb[0].high = bounds.maxx;
-        bb[1].low = bounds.miny;
-        bb[1].high = bounds.maxy;
-        bb[2].low = bounds.minz;
-        bb[2].high = bounds.maxz;
-    }
-    return true;
+    parallelFor(numChunks, threads, run);
+    return counts;
 }
 
 } // namespace pdal
@@ -35,15 +35,143 @@
 #include <pdal/Log.hpp>
 #include <pdal/PDALUtils.hpp>
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <fstream>
+#include <mutex>
 #include <ostream>
+#include <thread>
+#include <unordered_map>
 
 namespace pdal
 {
 
+namespace
+{
+
+// Stream buffer that collects the text written by each thread separately
+// and hands completed lines to a background thread that writes them to
+// another stream.  Writing text takes no lock.  Handing off a line takes
+// a lock only long enough to queue it.  Each buffer has an ID of its own
+// so that text left by a thread in a buffer that has been destroyed is
+// never taken for text of a later buffer.
+class AsyncLogBuf : public std::streambuf
+{
+public:
+    AsyncLogBuf(std::ostream& out) : m_out(out), m_id(nextId()),
+        m_done(false)
+    {
+        m_writer = std::thread([this](){ writeLines(); });
+    }
+
+    ~AsyncLogBuf()
+    {
+        sync();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_done = true;
+        }
+        m_cv.notify_one();
+        m_writer.join();
+        lines().erase(m_id);
+    }
+
+protected:
+    int overflow(int c) override
+    {
+        if (c != traits_type::eof())
+        {
+            std::string& line = lines()[m_id];
+            line += (char)c;
+            if (c == '\n')
+                queue(line);
+        }
+        return traits_type::not_eof(c);
+    }
+
+    std::streamsize xsputn(const char *s, std::streamsize n) override
+    {
+        std::string& line = lines()[m_id];
+        line.append(s, (size_t)n);
+        if (n && s[n - 1] == '\n')
+            queue(line);
+        return n;
+    }
+
+    // Flushing a stream hands off a partial line.
+    int sync() override
+    {
+        std::string& line = lines()[m_id];
+        if (line.size())
+            queue(line);
+        return 0;
+    }
+
+private:
+    // Text not yet handed off by this thread, per buffer ID.
+    static std::unordered_map<uint64_t, std::string>& lines()
+    {
+        static thread_local std::unordered_map<uint64_t, std::string> l;
+        return l;
+    }
+
+    static uint64_t nextId()
+    {
+        static std::atomic<uint64_t> id(0);
+        return id++;
+    }
+
+    void queue(std::string& line)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_queue.push_back(std::move(line));
+        }
+        line.clear();
+        m_cv.notify_one();
+    }
+
+    void writeLines()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true)
+        {
+            m_cv.wait(lock, [this](){ return m_done || m_queue.size(); });
+            std::deque<std::string> q;
+            q.swap(m_queue);
+            lock.unlock();
+            for (const std::string& line : q)
+                m_out << line;
+            m_out.flush();
+            lock.lock();
+            if (m_done && m_queue.empty())
+                break;
+        }
+    }
+
+    std::ostream& m_out;
+    uint64_t m_id;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<std::string> m_queue;
+    bool m_done;
+    std::thread m_writer;
+};
+
+class AsyncLogStream : private AsyncLogBuf, public std::ostream
+{
+public:
+    AsyncLogStream(std::ostream& out) : AsyncLogBuf(out), std::ostream(this)
+    {}
+};
+
+} // unnamed namespace
+
 Log::Log(std::string const& leaderString, std::string const& outputName,
         bool timing)
-    : m_level(LogLevel::Warning)
+    : m_syncLog(nullptr)
+    , m_level(LogLevel::Warning)
     , m_deleteStreamOnCleanup(false)
     , m_timing(timing)
 {
@@ -67,7 +195,8 @@ Log::Log(std::string const& leaderString, std::string const& outputName,
 
 
 Log::Log(std::string const& leaderString, std::ostream* v, bool timing)
-    : m_level(LogLevel::Error)
+    : m_syncLog(nullptr)
+    , m_level(LogLevel::Error)
     , m_deleteStreamOnCleanup(false)
     , m_timing(timing)
 {
@@ -93,6 +222,7 @@ LogPtr Log::makeLog(std::string const& leaderString, std::ostream* v,
 
 Log::~Log()
 {
+    setAsynchronous(false);
     if (m_deleteStreamOnCleanup)
     {
         m_log->flush();
@@ -101,6 +231,27 @@ Log::~Log()
 }
 
 
+void Log::setAsynchronous(bool async)
+{
+    if (async == (bool)m_asyncLog)
+        return;
+
+    if (async)
+    {
+        m_asyncLog.reset(new AsyncLogStream(*m_log));
+        m_asyncLog->copyfmt(*m_log);
+        m_syncLog = m_log;
+        m_log = m_asyncLog.get();
+    }
+    else
+    {
+        // Destroying the stream writes any queued messages.
+        m_log = m_syncLog;
+        m_asyncLog.reset();
+    }
+}
+
+
 void Log::floatPrecision(int level)
 {
     m_log->setf(std::ios_base::fixed, std::ios_base::floatfield);
@@ -118,9 +269,8 @@ void Log::clearFloat()
 std::ostream& Log::get(LogLevel level)
 {
     const auto incoming(Utils::toNative(level));
-    const auto stored(Utils::toNative(m_level));
     const auto nativeDebug(Utils::toNative(LogLevel::Debug));
-    if (incoming <= stored)
+    if (enabled(level))
     {
         const std::string l = leader();
 
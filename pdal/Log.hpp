@@ -41,6 +41,7 @@
 
 #include <pdal/pdal_internal.hpp>
 #include <pdal/util/NullOStream.hpp>
+#include <pdal/util/Utils.hpp>
 
 // Adapted from http://drdobbs.com/cpp/201804215
 
@@ -133,6 +134,28 @@ public:
         return m_log;
     }
 
+    /// Determine if messages at a level are written.
+    /// @param level logging level to check
+    /// @return  Whether messages logged at the level are written.
+    bool enabled(LogLevel level) const
+    {
+        return Utils::toNative(level) <= Utils::toNative(m_level);
+    }
+
+    /// Write log messages from a background thread.  Each thread collects
+    /// the text of its messages and hands each completed line to the
+    /// background thread, so threads logging at the same time don't wait
+    /// on the output or interleave their messages.  Messages are written
+    /// in order per thread.
+    /// @param async Whether to write messages asynchronously.
+    void setAsynchronous(bool async);
+
+    /// Determine whether messages are written from a background thread.
+    /// Only an asynchronous log may be written from several threads at once.
+    /// @return  Whether messages are written asynchronously.
+    bool asynchronous() const
+        { return (bool)m_asyncLog; }
+
     /// Returns the log stream given the logging level.
     /// @param level logging level to request
     /// If the logging level asked for with
@@ -149,6 +172,8 @@ protected:
     std::ostream *m_log;
 
 private:
+    std::unique_ptr<std::ostream> m_asyncLog;
+    std::ostream *m_syncLog;
     Log(const Log&) = delete;
     Log& operator =(const Log&) = delete;
     std::string now() const;
@@ -164,3 +189,11 @@ private:
 
 } // namespace pdal
 
+/// Write to a log only when the level is enabled.  Unlike Log::get(), the
+/// values streamed aren't evaluated when the level is disabled, so this
+/// can be used in loops over points or nodes:
+///
+///   PDAL_LOG(log(), LogLevel::Debug) << "Node " << key.toString() <<
+///       std::endl;
+#define PDAL_LOG(log, level) \
+    if (!(log)->enabled(level)) {} else (log)->get(level)
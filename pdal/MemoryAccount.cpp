@@ -0,0 +1,178 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/MemoryAccount.hpp>
+
+#include <pdal/pdal_types.hpp>
+
+namespace pdal
+{
+
+namespace
+{
+
+thread_local MemoryAccount *t_active = nullptr;
+std::atomic<std::size_t> s_total(0);
+std::atomic<std::size_t> s_budget(0);
+
+} // unnamed namespace
+
+
+MemoryAccount::Scope::Scope(MemoryAccount *account) : m_prev(t_active)
+{
+    t_active = account;
+}
+
+
+MemoryAccount::Scope::~Scope()
+{
+    t_active = m_prev;
+}
+
+
+MemoryAccount::MemoryAccount(const std::string& name) : m_name(name),
+    m_current(0), m_peak(0)
+{}
+
+
+MemoryAccount *MemoryAccount::active()
+{
+    return t_active;
+}
+
+
+std::size_t MemoryAccount::total()
+{
+    return s_total;
+}
+
+
+void MemoryAccount::setBudget(std::size_t bytes)
+{
+    s_budget = bytes;
+}
+
+
+std::size_t MemoryAccount::budget()
+{
+    return s_budget;
+}
+
+
+void MemoryAccount::add(MemoryAccount *account, std::size_t bytes,
+    bool check)
+{
+    std::size_t total = s_total += bytes;
+    std::size_t budget = s_budget;
+    if (check && budget && total > budget)
+    {
+        s_total -= bytes;
+        std::string who = account && account->m_name.size() ?
+            "stage '" + account->m_name + "'" : "memory outside any stage";
+        throw pdal_error("Memory budget of " + std::to_string(budget) +
+            " bytes exceeded by " + who + " allocating " +
+            std::to_string(bytes) + " bytes (" +
+            std::to_string(total - bytes) + " bytes in use" +
+            (account ? ", " + std::to_string(account->m_current) +
+                " held by the stage" : std::string()) + ").");
+    }
+
+    if (account)
+    {
+        std::size_t current = account->m_current += bytes;
+        std::size_t peak = account->m_peak;
+        while (current > peak &&
+            !account->m_peak.compare_exchange_weak(peak, current))
+        {}
+    }
+}
+
+
+void MemoryAccount::remove(MemoryAccount *account, std::size_t bytes)
+{
+    s_total -= bytes;
+    if (account)
+        account->m_current -= bytes;
+}
+
+
+MemoryCharge::~MemoryCharge()
+{
+    MemoryAccount::remove(m_account.get(), m_bytes);
+}
+
+
+MemoryCharge::MemoryCharge(MemoryCharge&& other) :
+    m_account(std::move(other.m_account)), m_bytes(other.m_bytes)
+{
+    other.m_bytes = 0;
+}
+
+
+MemoryCharge& MemoryCharge::operator=(MemoryCharge&& other)
+{
+    if (this != &other)
+    {
+        MemoryAccount::remove(m_account.get(), m_bytes);
+        m_account = std::move(other.m_account);
+        m_bytes = other.m_bytes;
+        other.m_bytes = 0;
+    }
+    return *this;
+}
+
+
+void MemoryCharge::set(std::size_t bytes)
+{
+    MemoryAccount *active = MemoryAccount::active();
+    if (bytes == m_bytes && active == m_account.get())
+        return;
+
+    // Release the old charge first so that moving a charge doesn't count
+    // it twice.  Restore it if the new charge fails.
+    MemoryAccount::remove(m_account.get(), m_bytes);
+    try
+    {
+        MemoryAccount::add(active, bytes, bytes > m_bytes);
+    }
+    catch (...)
+    {
+        MemoryAccount::add(m_account.get(), m_bytes, false);
+        throw;
+    }
+    m_account = active ? active->shared_from_this() : nullptr;
+    m_bytes = bytes;
+}
+
+} // namespace pdal
@@ -0,0 +1,161 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include <pdal/pdal_internal.hpp>
+
+namespace pdal
+{
+
+/**
+  Bytes of memory held on behalf of a stage: point storage, view indexes,
+  meshes, KD-trees and artifacts.  Memory is charged with a MemoryCharge to
+  the account that is active on the calling thread, which is the account
+  of the stage being run.  The total over all accounts can be limited with
+  setBudget().  Accounts must be owned by a std::shared_ptr, since charges
+  keep their account alive.
+*/
+class PDAL_DLL MemoryAccount :
+    public std::enable_shared_from_this<MemoryAccount>
+{
+public:
+    /**
+      Make the account the active account of the calling thread for the
+      lifetime of the scope.  A null account leaves memory unattributed.
+    */
+    class PDAL_DLL Scope
+    {
+    public:
+        Scope(MemoryAccount *account);
+        ~Scope();
+
+    private:
+        MemoryAccount *m_prev;
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+    MemoryAccount(const std::string& name = "");
+
+    void setName(const std::string& name)
+        { m_name = name; }
+    const std::string& name() const
+        { return m_name; }
+
+    /**
+      Number of bytes currently charged to the account.
+    */
+    std::size_t current() const
+        { return m_current; }
+
+    /**
+      Largest number of bytes charged to the account at once.
+    */
+    std::size_t peak() const
+        { return m_peak; }
+
+    /**
+      Get the active account of the calling thread.
+
+      \return  Active account, or null if no account is active.
+    */
+    static MemoryAccount *active();
+
+    /**
+      Number of bytes charged, whether attributed to an account or not.
+    */
+    static std::size_t total();
+
+    /**
+      Limit the total number of bytes that can be charged.  A charge that
+      would exceed the budget throws pdal_error naming the active account.
+
+      \param bytes  Budget in bytes.  Zero means no limit.
+    */
+    static void setBudget(std::size_t bytes);
+    static std::size_t budget();
+
+private:
+    friend class MemoryCharge;
+
+    static void add(MemoryAccount *account, std::size_t bytes, bool check);
+    static void remove(MemoryAccount *account, std::size_t bytes);
+
+    std::string m_name;
+    std::atomic<std::size_t> m_current;
+    std::atomic<std::size_t> m_peak;
+};
+
+/**
+  Memory charged to an account.  The charge is returned to the account
+  when the charge is destroyed, so an object that allocates memory holds a
+  charge for it.  Setting the size of a charge moves it to the account
+  active at the time, so memory is attributed to the stage that last
+  resized it.
+*/
+class PDAL_DLL MemoryCharge
+{
+public:
+    MemoryCharge() : m_bytes(0)
+    {}
+    ~MemoryCharge();
+    MemoryCharge(MemoryCharge&& other);
+    MemoryCharge& operator=(MemoryCharge&& other);
+
+    /**
+      Set the number of bytes charged.  Throws pdal_error if the memory
+      budget would be exceeded, in which case the charge is unchanged.
+
+      \param bytes  Number of bytes to charge.
+    */
+    void set(std::size_t bytes);
+    std::size_t bytes() const
+        { return m_bytes; }
+
+private:
+    std::shared_ptr<MemoryAccount> m_account;
+    std::size_t m_bytes;
+
+    MemoryCharge(const MemoryCharge&) = delete;
+    MemoryCharge& operator=(const MemoryCharge&) = delete;
+};
+
+} // namespace pdal
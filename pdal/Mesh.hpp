@@ -34,8 +34,13 @@
 
 #pragma once
 
+#include <algorithm>
 #include <array>
-#include <deque>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <vector>
 
 namespace pdal
 {
@@ -71,29 +76,176 @@ class Mesh
 
 
 /**
-  A mesh where the faces are triangles.
+  A mesh where the faces are triangles.  The vertex indices of the faces
+  are stored contiguously, three per face.  They're stored as 32-bit
+  values until a face refers to a point whose index doesn't fit.
 */
 class TriangularMesh : public Mesh
 {
 public:
-    using const_iterator = std::deque<Triangle>::const_iterator;
+    class const_iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Triangle;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Triangle *;
+        using reference = Triangle;
 
-    PDAL_DLL TriangularMesh()
+        const_iterator(const TriangularMesh *mesh, size_t id) :
+            m_mesh(mesh), m_id(id)
+        {}
+
+        Triangle operator*() const
+            { return (*m_mesh)[m_id]; }
+        const_iterator& operator++()
+            { m_id++; return *this; }
+        const_iterator operator++(int)
+            { const_iterator it(*this); m_id++; return it; }
+        bool operator==(const const_iterator& other) const
+            { return m_id == other.m_id; }
+        bool operator!=(const const_iterator& other) const
+            { return m_id != other.m_id; }
+
+    private:
+        const TriangularMesh *m_mesh;
+        size_t m_id;
+    };
+
+    PDAL_DLL TriangularMesh() : m_wide(false)
     {}
 
     size_t PDAL_DLL size() const
-        { return m_index.size(); }
+        { return (m_wide ? m_index64.size() : m_index32.size()) / 3; }
     void PDAL_DLL add(PointId a, PointId b, PointId c)
-        { m_index.emplace_back(a, b, c); }
-    const PDAL_DLL Triangle& operator[](PointId id) const
-        { return m_index[id]; }
+    {
+        if (!m_wide && (std::max)((std::max)(a, b), c) > MaxNarrow)
+            widen();
+        if (m_wide)
+            m_index64.insert(m_index64.end(), { a, b, c });
+        else
+            m_index32.insert(m_index32.end(),
+                { (uint32_t)a, (uint32_t)b, (uint32_t)c });
+    }
+
+    /**
+      Add faces from an array of vertex indices, three per face.
+
+      \param indices  Vertex indices of the faces.
+      \param count  Number of indices (three times the number of faces).
+    */
+    template<typename T>
+    void append(const T *indices, size_t count)
+    {
+        if (!m_wide)
+            for (size_t i = 0; i < count; ++i)
+                if ((uint64_t)indices[i] > MaxNarrow)
+                {
+                    widen();
+                    break;
+                }
+        if (m_wide)
+            m_index64.insert(m_index64.end(), indices, indices + count);
+        else
+            m_index32.insert(m_index32.end(), indices, indices + count);
+    }
+
+    /**
+      Reserve space for faces that will be added.
+
+      \param faces  Total number of faces.
+    */
+    void reserve(size_t faces)
+    {
+        if (m_wide)
+            m_index64.reserve(faces * 3);
+        else
+            m_index32.reserve(faces * 3);
+    }
+
+    Triangle operator[](PointId id) const
+    {
+        id *= 3;
+        if (m_wide)
+            return Triangle(m_index64[id], m_index64[id + 1],
+                m_index64[id + 2]);
+        return Triangle(m_index32[id], m_index32[id + 1], m_index32[id + 2]);
+    }
     const_iterator begin() const
-        { return m_index.begin(); }
+        { return const_iterator(this, 0); }
     const_iterator end() const
-        { return m_index.end(); }
+        { return const_iterator(this, size()); }
+
+    /**
+      Call a function with the vertex indices of each face, in order.
+
+      \param f  Function called with the three vertex indices of a face.
+    */
+    template<typename FUNC>
+    void forEach(FUNC f) const
+    {
+        if (m_wide)
+            visit(m_index64, f);
+        else
+            visit(m_index32, f);
+    }
+
+    /**
+      Copy the vertex indices of a range of faces, three per face.
+
+      \param first  Index of the first face to copy.
+      \param count  Number of faces to copy.
+      \param dst  Destination of 3 * count indices.
+      \param offset  Value added to each index.
+    */
+    template<typename T>
+    void copyIndices(size_t first, size_t count, T *dst,
+        PointId offset = 0) const
+    {
+        if (m_wide)
+            copy(m_index64, first, count, dst, offset);
+        else
+            copy(m_index32, first, count, dst, offset);
+    }
+
+    std::size_t memoryUsed() const
+    {
+        return m_index32.capacity() * sizeof(uint32_t) +
+            m_index64.capacity() * sizeof(PointId);
+    }
 
 protected:
-    std::deque<Triangle> m_index;
+    static constexpr PointId MaxNarrow =
+        (std::numeric_limits<uint32_t>::max)();
+
+    void widen()
+    {
+        m_index64.assign(m_index32.begin(), m_index32.end());
+        m_index32.clear();
+        m_index32.shrink_to_fit();
+        m_wide = true;
+    }
+
+    template<typename I, typename FUNC>
+    static void visit(const std::vector<I>& index, FUNC& f)
+    {
+        for (size_t i = 0; i < index.size(); i += 3)
+            f((PointId)index[i], (PointId)index[i + 1],
+                (PointId)index[i + 2]);
+    }
+
+    template<typename I, typename T>
+    static void copy(const std::vector<I>& index, size_t first,
+        size_t count, T *dst, PointId offset)
+    {
+        const I *src = index.data() + first * 3;
+        for (size_t i = 0; i < count * 3; ++i)
+            *dst++ = (T)(src[i] + offset);
+    }
+
+    std::vector<uint32_t> m_index32;
+    std::vector<PointId> m_index64;
+    bool m_wide;
 };
 
 } // namespace pdal
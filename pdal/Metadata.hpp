@@ -40,6 +40,7 @@
 #include <pdal/util/Utils.hpp>
 #include <pdal/util/Uuid.hpp>
 
+#include <functional>
 #include <map>
 #include <memory>
 #include <vector>
@@ -135,7 +136,7 @@ private:
     bool operator == (const MetadataNodeImpl& m) const
     {
         if (m_name != m.m_name || m_descrip != m.m_descrip ||
-            m_type != m.m_type || m_value != m.m_value)
+            m_type != m.m_type || value() != m.value())
             return false;
         if (m_subnodes.size() != m.m_subnodes.size())
             return false;
@@ -173,6 +174,17 @@ private:
 
     void setValue(const double& d, size_t precision);
 
+    // The value, computed now if it was added lazily.
+    const std::string& value() const
+    {
+        if (m_lazyValue)
+        {
+            m_value = m_lazyValue();
+            m_lazyValue = nullptr;
+        }
+        return m_value;
+    }
+
     MetadataImplList& subnodes(const std::string &name)
     {
         auto si = m_subnodes.find(name);
@@ -203,7 +215,8 @@ private:
     std::string m_name;
     std::string m_descrip;
     std::string m_type;
-    std::string m_value;
+    mutable std::string m_value;
+    mutable std::function<std::string()> m_lazyValue;
     MetadataType m_kind;
     MetadataSubnodes m_subnodes;
 };
@@ -447,6 +460,46 @@ public:
         return MetadataNode(impl);
     }
 
+    /**
+      Add a node whose value is encoded when it's first read.  Metadata
+      that's often never read, like the content of file headers, can be
+      added without the cost of encoding it.
+
+      \param name  Name of the node.
+      \param buf  Data to encode.
+      \param descrip  Description of the node.
+      \return  The new node.
+    */
+    MetadataNode addEncoded(const std::string& name,
+        std::vector<uint8_t> buf, const std::string& descrip = std::string())
+    {
+        auto data = std::make_shared<std::vector<uint8_t>>(std::move(buf));
+        return addLazy(name, "base64Binary", [data]()
+            { return Utils::base64_encode(data->data(), data->size()); },
+            descrip);
+    }
+
+    /**
+      Add a node whose value is computed when it's first read.
+
+      \param name  Name of the node.
+      \param type  Type of the value.
+      \param value  Function that computes the value.  It must not depend
+        on state that may change before the value is read.
+      \param descrip  Description of the node.
+      \return  The new node.
+    */
+    MetadataNode addLazy(const std::string& name, const std::string& type,
+        std::function<std::string()> value,
+        const std::string& descrip = std::string())
+    {
+        MetadataNodeImplPtr impl = m_impl->add(name);
+        impl->m_type = type;
+        impl->m_lazyValue = value;
+        impl->m_descrip = descrip;
+        return MetadataNode(impl);
+    }
+
     MetadataNode addWithType(const std::string& name, const std::string& value,
         const std::string& type, const std::string& descrip)
     {
@@ -554,14 +607,14 @@ public:
 
         try
         {
-            t = MetadataDetail::value<T>(m_impl->m_type, m_impl->m_value);
+            t = MetadataDetail::value<T>(m_impl->m_type, m_impl->value());
         }
         catch (MetadataDetail::value_error&)
         {
             // Reset in case the fromString conversion messed it up.
             t = T();
             std::cerr << "Error converting metadata [" << name() <<
-                "] = " << m_impl->m_value << " to type " <<
+                "] = " << m_impl->value() << " to type " <<
                 Utils::typeidName<T>() << " -- return default initialized.";
         }
         return t;
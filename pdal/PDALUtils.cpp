@@ -41,6 +41,7 @@
 #include <pdal/PointView.hpp>
 #include <pdal/Options.hpp>
 #include <pdal/util/FileUtils.hpp>
+#include <pdal/private/MultipartOutStream.hpp>
 
 using namespace std;
 
@@ -255,8 +256,12 @@ std::ostream *createFile(const std::string& path, bool asBinary)
     {
         try
         {
-            ofs = new ArbiterOutStream(tempFilename(path), path,
-                asBinary ? ios::out | ios::binary : ios::out);
+            // Upload in parts as data is written where the storage allows
+            // it.  Otherwise stage the data in a local file.
+            ofs = MultipartOutStream::create(path);
+            if (!ofs)
+                ofs = new ArbiterOutStream(tempFilename(path), path,
+                    asBinary ? ios::out | ios::binary : ios::out);
         }
         catch (arbiter::ArbiterError&)
         {}
@@ -313,12 +318,27 @@ std::istream *openFile(const std::string& path, bool asBinary)
 }
 
 /**
-  Close an output stream.
+  Close an output stream.  Throws pdal_error if data written to remote
+  storage can't be uploaded.
 
   \param out  Stream to close.
 */
 void closeFile(std::ostream *out)
 {
+    // A multipart upload can fail as it completes.
+    MultipartOutStream *mos = dynamic_cast<MultipartOutStream *>(out);
+    if (mos)
+    {
+        try
+        {
+            mos->finish();
+        }
+        catch (...)
+        {
+            delete mos;
+            throw;
+        }
+    }
     FileUtils::closeFile(out);
 }
 
@@ -352,40 +372,21 @@ bool fileExists(const std::string& path)
     return FileUtils::fileExists(path);
 }
 
-double computeHausdorff(PointViewPtr srcView, PointViewPtr candView)
+double computeHausdorff(PointViewPtr srcView, PointViewPtr candView,
+    unsigned threads)
 {
-    using namespace Dimension;
-
     KD3Index srcIndex(*srcView);
     srcIndex.build();
 
     KD3Index candIndex(*candView);
     candIndex.build();
 
-    double maxDistSrcToCand = std::numeric_limits<double>::lowest();
-    double maxDistCandToSrc = std::numeric_limits<double>::lowest();
-
-    for (PointId i = 0; i < srcView->size(); ++i)
-    {
-        PointIdList indices(1);
-        std::vector<double> sqr_dists(1);
-        PointRef srcPoint = srcView->point(i);
-        candIndex.knnSearch(srcPoint, 1, &indices, &sqr_dists);
-
-        if (sqr_dists[0] > maxDistSrcToCand)
-            maxDistSrcToCand = sqr_dists[0];
-    }
-
-    for (PointId i = 0; i < candView->size(); ++i)
-    {
-        PointIdList indices(1);
-        std::vector<double> sqr_dists(1);
-        PointRef candPoint = candView->point(i);
-        srcIndex.knnSearch(candPoint, 1, &indices, &sqr_dists);
-
-        if (sqr_dists[0] > maxDistCandToSrc)
-            maxDistCandToSrc = sqr_dists[0];
-    }
+    // Each index holds the packed coordinates of its points, which serve
+    // as the query points for the other index.
+    double maxDistSrcToCand =
+        candIndex.maxNearestSqrDist(srcIndex.coords(), threads);
+    double maxDistCandToSrc =
+        srcIndex.maxNearestSqrDist(candIndex.coords(), threads);
 
     maxDistSrcToCand = std::sqrt(maxDistSrcToCand);
     maxDistCandToSrc = std::sqrt(maxDistCandToSrc);
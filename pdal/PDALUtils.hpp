@@ -272,7 +272,17 @@ std::string PDAL_DLL fetchRemote(const std::string& path);
 bool PDAL_DLL isRemote(const std::string& path);
 bool PDAL_DLL fileExists(const std::string& path);
 std::vector<std::string> PDAL_DLL maybeGlob(const std::string& path);
-double PDAL_DLL computeHausdorff(PointViewPtr srcView, PointViewPtr candView);
+
+/**
+  Compute the Hausdorff distance between two sets of points.
+
+  \param srcView  Source points.
+  \param candView  Candidate points.
+  \param threads  Number of threads used to find nearest neighbors.
+  \return  Hausdorff distance.
+*/
+double PDAL_DLL computeHausdorff(PointViewPtr srcView, PointViewPtr candView,
+    unsigned threads = 1);
 
 } // namespace Utils
 } // namespace pdal
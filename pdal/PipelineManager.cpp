@@ -36,9 +36,15 @@
 #include <pdal/StageFactory.hpp>
 #include <pdal/PipelineReaderJSON.hpp>
 #include <pdal/PDALUtils.hpp>
+#include <pdal/Reader.hpp>
 #include <pdal/util/Algorithm.hpp>
 #include <pdal/util/FileUtils.hpp>
 
+#include "private/StageCache.hpp"
+
+#include <chrono>
+#include <ctime>
+
 #pragma GCC diagnostic ignored "-Wmissing-field-initializers"
 
 namespace pdal
@@ -46,10 +52,12 @@ namespace pdal
 
 PipelineManager::PipelineManager(point_count_t streamLimit) :
     m_factory(new StageFactory),
-    m_tablePtr(new PointTable()), m_table(*m_tablePtr),
+    m_tablePtr(new PointTable()),
     m_streamTablePtr(new FixedPointTable(streamLimit)),
     m_streamTable(*m_streamTablePtr),
-    m_progressFd(-1), m_input(nullptr)
+    m_progressFd(-1), m_progressInterval(0), m_threads(1), m_forwardMetadata(true),
+    m_profiling(false),
+    m_profileWallTime(0), m_profileCpuTime(0), m_input(nullptr)
 {}
 
 
@@ -59,6 +67,50 @@ PipelineManager::~PipelineManager()
 }
 
 
+void PipelineManager::setColumnTable()
+{
+    m_tablePtr.reset(new ColumnPointTable());
+}
+
+
+void PipelineManager::setAlignedTable()
+{
+    m_tablePtr.reset(new PointTable());
+    m_tablePtr->layout()->setAligned(true);
+}
+
+
+void PipelineManager::setStreamBatch(point_count_t count)
+{
+    if (count)
+        m_streamTablePtr->setCapacity(count);
+    else
+        m_streamTablePtr->setAdaptive();
+}
+
+
+void PipelineManager::setMappedTable(const std::string& dir,
+    std::size_t residentLimit)
+{
+    m_tablePtr.reset(new MappedPointTable(dir, residentLimit));
+}
+
+
+void PipelineManager::setCompressedTable()
+{
+    m_tablePtr.reset(new CompressedPointTable());
+}
+
+
+void PipelineManager::setCache(const std::string& dir, uint64_t maxSize)
+{
+    if (dir.empty())
+        m_cache.reset();
+    else
+        m_cache.reset(new StageCache(dir, maxSize));
+}
+
+
 void PipelineManager::readPipeline(std::istream& input)
 {
     std::istreambuf_iterator<char> eos;
@@ -100,6 +152,40 @@ void PipelineManager::readPipeline(const std::string& filename)
 namespace
 {
 
+// Report the progress of an execution for the lifetime of the object.
+class ProgressScope
+{
+public:
+    ProgressScope(const std::vector<Stage *>& stages, double interval,
+            int fd, Progress::Callback cb) : m_stages(stages)
+    {
+        if (interval <= 0 || (fd < 0 && !cb))
+            return;
+
+        m_progress.reset(new Progress(interval, fd, cb));
+        for (Stage *s : m_stages)
+        {
+            s->setProgress(m_progress.get());
+            if (dynamic_cast<Reader *>(s))
+                m_progress->addSource(s);
+        }
+        m_progress->start();
+    }
+
+    ~ProgressScope()
+    {
+        if (!m_progress)
+            return;
+        m_progress->stop();
+        for (Stage *s : m_stages)
+            s->setProgress(nullptr);
+    }
+
+private:
+    const std::vector<Stage *>& m_stages;
+    std::unique_ptr<Progress> m_progress;
+};
+
 pdal_error stageError(const std::string& cls, const std::string& type)
 {
     std::ostringstream ss;
@@ -199,18 +285,63 @@ QuickInfo PipelineManager::preview() const
 }
 
 
+// Set up a table before the pipeline is prepared with it.
+void PipelineManager::prepareTable(BasePointTable& table) const
+{
+    bool forward = m_forwardMetadata;
+
+    // The LAS writer is the only stage that uses forwarded metadata.  An
+    // option file may specify that it should.
+    for (Stage *s : m_stages)
+        if (s->getName() == "writers.las")
+        {
+            const Options& opts = s->getOptions();
+            if (opts.getValues("forward").size() ||
+                    opts.getValues("option_file").size())
+                forward = true;
+        }
+    table.setForwardMetadata(forward);
+}
+
+
 void PipelineManager::prepare() const
 {
     validateStageOptions();
     Stage *s = getStage();
     if (s)
-       s->prepare(m_table);
+    {
+        prepareTable(*m_tablePtr);
+        s->prepare(*m_tablePtr);
+    }
 }
 
 
 PipelineManager::ExecResult PipelineManager::execute(ExecMode mode)
+{
+    ProgressScope progress(m_stages, m_progressInterval, m_progressFd,
+        m_progressCb);
+    if (!m_profiling)
+        return executeStages(mode);
+
+    for (Stage *s : m_stages)
+        s->enableProfiling();
+    auto wallStart = std::chrono::steady_clock::now();
+    std::clock_t cpuStart = std::clock();
+
+    m_profileResult = executeStages(mode);
+
+    std::chrono::duration<double> wall =
+        std::chrono::steady_clock::now() - wallStart;
+    m_profileWallTime = wall.count();
+    m_profileCpuTime = (double)(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+    return m_profileResult;
+}
+
+
+PipelineManager::ExecResult PipelineManager::executeStages(ExecMode mode)
 {
     ExecResult result;
+    bool hybrid = false;
 
     validateStageOptions();
     Stage *s = getStage();
@@ -219,6 +350,11 @@ PipelineManager::ExecResult PipelineManager::execute(ExecMode mode)
                 
     if (mode == ExecMode::PreferStream)
     {
+        // A pipeline that can't be streamed is run in standard mode, but
+        // the streamable stages that follow its readers are streamed so
+        // that only the points that they keep are stored.
+        hybrid = true;
+
         // If a pipeline isn't streamable before being prepared, it's not
         // going to become streamable, so just run it or fail.
         if (!s->pipelineStreamable())
@@ -229,6 +365,7 @@ PipelineManager::ExecResult PipelineManager::execute(ExecMode mode)
 
         // After prepare a pipeline that was streamable might become
         // non-streamable due to some options.
+        prepareTable(m_streamTable);
         s->prepare(m_streamTable);
         if (!s->pipelineStreamable())
         {
@@ -239,7 +376,7 @@ PipelineManager::ExecResult PipelineManager::execute(ExecMode mode)
             goto next;
         }
         // We can stream.
-        s->execute(m_streamTable);
+        s->execute(m_streamTable, m_threads);
         result.m_mode = ExecMode::Stream;
         return result;
     }
@@ -249,15 +386,18 @@ PipelineManager::ExecResult PipelineManager::execute(ExecMode mode)
     {
         if (s->pipelineStreamable())
         {
+            prepareTable(m_streamTable);
             s->prepare(m_streamTable);
-            s->execute(m_streamTable);
+            s->execute(m_streamTable, m_threads);
             result.m_mode = ExecMode::Stream;
         }
     }
     else if (mode == ExecMode::Standard)
     {
-        s->prepare(m_table);
-        m_viewSet = s->execute(m_table);
+        prepareTable(*m_tablePtr);
+        s->prepare(*m_tablePtr);
+        m_viewSet = s->executeStandard(*m_tablePtr, m_threads, hybrid,
+            m_cache.get());
         point_count_t cnt = 0;
         for (auto pi = m_viewSet.begin(); pi != m_viewSet.end(); ++pi)
         {
@@ -283,6 +423,9 @@ void PipelineManager::executeStream(StreamPointTable& table)
     if (!s)
         return;
 
+    ProgressScope progress(m_stages, m_progressInterval, m_progressFd,
+        m_progressCb);
+    prepareTable(table);
     s->prepare(table);
     s->execute(table);
 }
@@ -300,6 +443,46 @@ MetadataNode PipelineManager::getMetadata() const
 }
 
 
+MetadataNode PipelineManager::getProfile() const
+{
+    MetadataNode root("profile");
+
+    std::string mode;
+    if (m_profileResult.m_mode == ExecMode::Stream)
+        mode = "stream";
+    else if (m_profileResult.m_mode == ExecMode::Standard)
+        mode = "standard";
+    root.add("mode", mode);
+
+    // Stream execution doesn't count points, so use the number that
+    // reached the end of the pipeline.
+    point_count_t count = m_profileResult.m_count;
+    Stage *leaf = getStage();
+    if (m_profileResult.m_mode == ExecMode::Stream && leaf && leaf->profile())
+        count = leaf->profile()->pointsOut();
+    root.add("points", count);
+    root.add("wall_time", m_profileWallTime);
+    root.add("cpu_time", m_profileCpuTime);
+
+    std::size_t peak = 0;
+    for (Stage *s : m_stages)
+    {
+        StageProfile *profile = s->profile();
+        if (!profile)
+            continue;
+        MetadataNode node = root.addList("stages");
+        node.add("name", s->getName());
+        node.add("tag", s->tag());
+        profile->toMetadata(node);
+        node.add("memory_current", s->memoryAccount().current());
+        node.add("memory_peak", s->memoryAccount().peak());
+        peak = (std::max)(peak, profile->peakMemory());
+    }
+    root.add("peak_table_memory", peak);
+    return root;
+}
+
+
 Stage& PipelineManager::makeReader(const std::string& inputFile,
     std::string driver)
 {
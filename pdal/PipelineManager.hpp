@@ -38,6 +38,7 @@
 #include <pdal/PointView.hpp>
 #include <pdal/Options.hpp>
 #include <pdal/Log.hpp>
+#include <pdal/Progress.hpp>
 
 #include <vector>
 #include <string>
@@ -47,6 +48,7 @@ namespace pdal
 
 struct QuickInfo;
 class Stage;
+class StageCache;
 class StageFactory;
 
 struct StageCreationOptions
@@ -80,6 +82,74 @@ public:
     void setProgressFd(int fd)
         { m_progressFd = fd; }
 
+    // Periodically report the points read, the throughput and, when the
+    // readers know how many points they'll read, an estimate of the time
+    // remaining while the pipeline executes.  Reports are written to the
+    // progress descriptor as "PROGRESS:" lines of JSON and passed to the
+    // progress callback.  Zero seconds, the default, disables reporting.
+    void setProgressInterval(double seconds)
+        { m_progressInterval = seconds; }
+    void setProgressCallback(Progress::Callback cb)
+        { m_progressCb = cb; }
+
+    // Set the number of threads used to run point views through re-entrant
+    // stages in standard mode or to run groups of stages concurrently when
+    // executing with the manager's stream table.
+    void setThreads(std::size_t threads)
+        { m_threads = threads; }
+    std::size_t threads() const
+        { return m_threads; }
+
+    // Set whether readers store metadata that's only forwarded to writers
+    // (such as LAS header fields and VLRs).  Even if not set, such metadata
+    // is stored when a stage in the pipeline forwards it.
+    void setForwardMetadata(bool forward)
+        { m_forwardMetadata = forward; }
+
+    // Fail with an error naming the stage responsible when the memory held
+    // for point storage, view indexes, meshes, KD-trees and artifacts
+    // exceeds a number of bytes.  The budget is process-wide
+    // (see MemoryAccount::setBudget()).  Zero means no limit.
+    void setMemoryBudget(std::size_t bytes)
+        { MemoryAccount::setBudget(bytes); }
+
+    // Record the time spent by each stage and the points that it handles
+    // when the pipeline is executed.  See getProfile().
+    void setProfiling(bool profiling)
+        { m_profiling = profiling; }
+
+    // Store point data for standard mode in a ColumnPointTable rather than
+    // a PointTable.  Must be called before the pipeline is prepared.
+    void setColumnTable();
+
+    // Store point data for standard mode in a PointTable whose point
+    // records are aligned (see PointLayout::setAligned()).  Must be called
+    // before the pipeline is prepared.
+    void setAlignedTable();
+
+    // Set the number of points that stream mode processes at a time.  Zero
+    // chooses the number when the pipeline is executed so that a batch of
+    // points occupies about FixedPointTable::DefaultFootprint bytes (see
+    // FixedPointTable::setAdaptive()).  Must be called before the pipeline
+    // is prepared.
+    void setStreamBatch(point_count_t count);
+
+    // Store point data for standard mode in a MappedPointTable.  Must be
+    // called before the pipeline is prepared.
+    void setMappedTable(const std::string& dir = "",
+        std::size_t residentLimit = 0);
+
+    // Store point data for standard mode in a CompressedPointTable.  Must
+    // be called before the pipeline is prepared.
+    void setCompressedTable();
+
+    // Cache the output of stages run in standard mode in a directory that
+    // holds at most 'maxSize' bytes of entries, and load the output of
+    // stages that were cached when the pipeline was last run rather than
+    // running them again (see StageCache).  An empty directory turns the
+    // cache off.
+    void setCache(const std::string& dir, uint64_t maxSize);
+
     void readPipeline(std::istream& input);
     void readPipeline(const std::string& filename);
 
@@ -136,9 +206,11 @@ public:
 
     // Get the point table data.
     PointTableRef pointTable() const
-        { return m_table; }
+        { return *m_tablePtr; }
 
     MetadataNode getMetadata() const;
+    // Get the profile of the last execution when profiling is enabled.
+    MetadataNode getProfile() const;
     Options& commonOptions()
         { return m_commonOptions; }
     OptionsMap& stageOptions()
@@ -152,19 +224,29 @@ public:
     void destroyStage(Stage *s = nullptr);
 
 private:
+    ExecResult executeStages(ExecMode mode);
+    void prepareTable(BasePointTable& table) const;
     void setOptions(Stage& stage, const Options& addOps);
     Options stageOptions(Stage& stage);
 
     std::unique_ptr<StageFactory> m_factory;
-    std::unique_ptr<PointTable> m_tablePtr;
-    PointTableRef m_table;
+    std::unique_ptr<BasePointTable> m_tablePtr;
     std::unique_ptr<FixedPointTable> m_streamTablePtr;
+    std::unique_ptr<StageCache> m_cache;
     StreamPointTable& m_streamTable;
     Options m_commonOptions;
     OptionsMap m_stageOptions;
     PointViewSet m_viewSet;
     std::vector<Stage*> m_stages; // stage observer, never owner
     int m_progressFd;
+    double m_progressInterval;
+    Progress::Callback m_progressCb;
+    std::size_t m_threads;
+    bool m_forwardMetadata;
+    bool m_profiling;
+    ExecResult m_profileResult;
+    double m_profileWallTime;
+    double m_profileCpuTime;
     std::istream *m_input;
     LogPtr m_log;
 
@@ -157,7 +157,54 @@ void PipelineReaderJSON::readPipeline(std::istream& input)
 
     auto it = root.find("pipeline");
     if (root.is_object() && it != root.end())
+    {
+        auto ti = root.find("threads");
+        if (ti != root.end())
+        {
+            if (!ti->is_number_unsigned() || ti->get<uint64_t>() == 0)
+                throw pdal_error("JSON pipeline: 'threads' must be "
+                    "specified as a positive integer.");
+            m_manager.setThreads(ti->get<size_t>());
+        }
+        ti = root.find("table");
+        if (ti != root.end())
+        {
+            std::string table = ti->is_string() ?
+                ti->get<std::string>() : std::string();
+            if (table == "column")
+                m_manager.setColumnTable();
+            else if (table == "mapped")
+                m_manager.setMappedTable();
+            else if (table == "aligned")
+                m_manager.setAlignedTable();
+            else if (table == "compressed")
+                m_manager.setCompressedTable();
+            else if (table != "row")
+                throw pdal_error("JSON pipeline: 'table' must be "
+                    "specified as \"row\", \"aligned\", \"column\", "
+                    "\"mapped\" or \"compressed\".");
+        }
+        ti = root.find("stream_batch");
+        if (ti != root.end())
+        {
+            if (ti->is_string() && ti->get<std::string>() == "auto")
+                m_manager.setStreamBatch(0);
+            else if (ti->is_number_unsigned() && ti->get<uint64_t>() > 0)
+                m_manager.setStreamBatch(ti->get<point_count_t>());
+            else
+                throw pdal_error("JSON pipeline: 'stream_batch' must be "
+                    "specified as a positive integer or \"auto\".");
+        }
+        ti = root.find("forward_metadata");
+        if (ti != root.end())
+        {
+            if (!ti->is_boolean())
+                throw pdal_error("JSON pipeline: 'forward_metadata' must be "
+                    "specified as true or false.");
+            m_manager.setForwardMetadata(ti->get<bool>());
+        }
         parsePipeline(*it);
+    }
     else if (root.is_array())
         parsePipeline(root);
     else
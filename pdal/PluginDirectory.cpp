@@ -137,6 +137,11 @@ PluginDirectory::PluginDirectory()
     }
 }
 
+StringList PluginDirectory::searchPaths()
+{
+    return pluginSearchPaths();
+}
+
 StringList PluginDirectory::test_pluginSearchPaths()
 {
     return pluginSearchPaths();
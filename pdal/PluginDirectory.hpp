@@ -64,6 +64,9 @@ public:
         return instance;
     }
 
+    // Directories searched for plugin libraries, in search order.
+    static StringList searchPaths();
+
     std::map<std::string, std::string> m_kernels;
     std::map<std::string, std::string> m_drivers;
 
@@ -46,6 +46,7 @@
 #include <pdal/util/Utils.hpp>
 
 #include "private/DynamicLibrary.hpp"
+#include "private/PluginManifest.hpp"
 
 #include <memory>
 #include <sstream>
@@ -118,7 +119,7 @@ void PluginManager<Stage>::l_loadAll()
 {
     PluginDirectory& dir = PluginDirectory::get();
     for (auto& di: dir.m_drivers)
-        l_loadDynamic(di.first);
+        loadOrDescribe(di.second);
 }
 
 
@@ -127,7 +128,51 @@ void PluginManager<Kernel>::l_loadAll()
 {
     PluginDirectory& dir = PluginDirectory::get();
     for (auto& di: dir.m_kernels)
-        l_loadDynamic(di.first);
+        loadOrDescribe(di.second);
+}
+
+
+/**
+  Register the plugins of a library as described by the plugin manifest,
+  so that they can be listed without loading the library.  The library
+  is loaded when one of its plugins is created.  Libraries that aren't
+  in the manifest or have changed are loaded now.
+
+  \param path  Path to plugin library.
+*/
+template <typename T>
+void PluginManager<T>::loadOrDescribe(const std::string& path)
+{
+    if (libraryLoaded(path))
+        return;
+
+    PluginManifest::PluginList plugins;
+    if (!PluginManifest::get().plugins(path, plugins))
+    {
+        loadByPath(path);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_pluginMutex);
+    for (const PluginManifest::Plugin& p : plugins)
+    {
+        Info info { p.m_name, p.m_link, p.m_description, nullptr };
+        m_plugins.insert(std::make_pair(p.m_name, info));
+    }
+}
+
+
+// Names of the plugins that can be created.
+template <typename T>
+StringList PluginManager<T>::loadedNames()
+{
+    StringList l;
+
+    std::lock_guard<std::mutex> lock(m_pluginMutex);
+    for (auto& p : m_plugins)
+        if (p.second.create)
+            l.push_back(p.first);
+    return l;
 }
 
 
@@ -273,9 +318,16 @@ bool PluginManager<T>::loadDynamic(const std::string& driverName)
 template <typename T>
 bool PluginManager<T>::l_loadDynamic(const std::string& driverName)
 {
+    // The manifest finds a library without scanning the plugin
+    // directories.
+    std::string path = PluginManifest::get().library(driverName,
+        PluginDirectory::searchPaths());
+    if (path.size() && loadByPath(path))
+        return true;
+
     // If the library pointer is already in the map, we've already loaded
     // the library.
-    std::string path = getPath(driverName);
+    path = getPath(driverName);
     if (path.empty())
     {
         m_log->get(LogLevel::Debug) << "No plugin file found for driver '" <<
@@ -318,10 +370,18 @@ bool PluginManager<T>::loadByPath(const std::string& path)
             "in plugin '" << path << "'." << std::endl;
         return false;
     }
+    StringList before = loadedNames();
     initFunc();
     m_log->get(LogLevel::Debug) << "Initialized plugin '" <<
         path << "'." << std::endl;
 
+    // Record the plugins the library registered in the manifest.
+    PluginManifest::PluginList plugins;
+    for (const std::string& name : loadedNames())
+        if (!Utils::contains(before, name))
+            plugins.push_back({ name, l_description(name), l_link(name) });
+    PluginManifest::get().record(FileUtils::toAbsolutePath(path), plugins);
+
     return true;
 }
 
@@ -340,7 +400,8 @@ T *PluginManager<T>::l_createObject(const std::string& objectType)
     auto find([this, &objectType]()->bool
     {
         std::lock_guard<std::mutex> lock(m_pluginMutex);
-        return m_plugins.count(objectType);
+        auto it = m_plugins.find(objectType);
+        return it != m_plugins.end() && it->second.create;
     });
 
     if (find() || (l_loadDynamic(objectType) && find()))
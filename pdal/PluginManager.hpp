@@ -103,6 +103,8 @@ private:
     std::string getPath(const std::string& driver);
     void shutdown();
     bool loadByPath(const std::string & path);
+    void loadOrDescribe(const std::string& path);
+    StringList loadedNames();
     bool l_loadDynamic(const std::string& driverName);
     DynamicLibrary *libraryLoaded(const std::string& path);
     DynamicLibrary *loadLibrary(const std::string& path);
@@ -117,7 +119,11 @@ private:
         };
         Info info {pi.name, pi.link, pi.description, f};
         std::lock_guard<std::mutex> lock(m_pluginMutex);
-        m_plugins.insert(std::make_pair(pi.name, info));
+        // Replace any entry described by the plugin manifest but not
+        // yet loaded.
+        auto it = m_plugins.find(pi.name);
+        if (it == m_plugins.end() || !it->second.create)
+            m_plugins[pi.name] = info;
         return true;
     }
     template <class C>
@@ -0,0 +1,296 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+#include <pdal/pdal_types.hpp>
+
+namespace pdal
+{
+
+/**
+  Map of the point IDs of a point view to the IDs of points in its table.
+
+  A view that refers to a contiguous range of table points, as is the case
+  for views filled by readers, is represented by the start and the length
+  of the range.  Appending other ranges, as when views are merged, adds
+  segments to the index rather than copying point IDs, so that a view
+  made of a few ranges is still represented by a list of ranges.  The
+  index is converted to an explicit list of point IDs the first time that
+  the view is reordered or it would need more than MaxSegments segments.
+*/
+class PDAL_DLL PointIdIndex
+{
+    struct Segment
+    {
+        PointId offset;  // Index of the first entry of the segment.
+        PointId start;   // Table ID of the first entry of the segment.
+    };
+
+public:
+    static const std::size_t MaxSegments = 1024;
+
+    PointIdIndex() : m_start(0), m_count(0), m_identity(true)
+    {}
+
+    PointId operator[](PointId idx) const
+    {
+        if (m_identity)
+            return m_start + idx;
+        if (m_segments.empty())
+            return m_ids[idx];
+        return lookup(idx);
+    }
+
+    PointId at(PointId idx) const
+    {
+        if (idx >= size())
+            throw std::out_of_range("Point index out of range.");
+        return (*this)[idx];
+    }
+
+    point_count_t size() const
+        { return explicitIds() ? m_ids.size() : m_count; }
+
+    /**
+      Determine whether the index is represented as a range of table IDs.
+
+      \return  Whether the index is a range of table IDs.
+    */
+    bool isRange() const
+        { return m_identity; }
+
+    /**
+      Determine whether the index is represented as one or more ranges
+      of table IDs.
+
+      \return  Whether the index is a list of ranges of table IDs.
+    */
+    bool isSegmented() const
+        { return !explicitIds(); }
+
+    /**
+      Get the number of bytes allocated for explicit point IDs and
+      segments.
+
+      \return  Number of bytes allocated.
+    */
+    std::size_t memoryUsed() const
+    {
+        return m_ids.capacity() * sizeof(PointId) +
+            m_segments.capacity() * sizeof(Segment);
+    }
+
+    /**
+      Call a function for each range of consecutive table IDs in the index,
+      in index order.  An index of explicit IDs is visited an ID at a time.
+
+      \param f  Function called with the first table ID and the length of
+        each range.
+    */
+    template<typename F>
+    void forEachRange(F f) const
+    {
+        if (m_identity)
+        {
+            if (m_count)
+                f(m_start, m_count);
+        }
+        else if (m_segments.size())
+        {
+            for (std::size_t i = 0; i < m_segments.size(); ++i)
+                f(m_segments[i].start, segmentEnd(i) - m_segments[i].offset);
+        }
+        else
+            for (PointId id : m_ids)
+                f(id, (point_count_t)1);
+    }
+
+    void push_back(PointId id)
+        { appendRange(id, 1); }
+
+    void set(PointId idx, PointId id)
+    {
+        if (!explicitIds())
+        {
+            if (id == (*this)[idx])
+                return;
+            makeExplicit();
+        }
+        m_ids[idx] = id;
+    }
+
+    void swap(PointId idx1, PointId idx2)
+    {
+        if (idx1 == idx2)
+            return;
+        makeExplicit();
+        std::swap(m_ids[idx1], m_ids[idx2]);
+    }
+
+    /**
+      Shrink the index.
+
+      \param count  New size of the index.  Must be no greater than the
+        current size.
+    */
+    void truncate(point_count_t count)
+    {
+        if (explicitIds())
+        {
+            m_ids.resize(count);
+            return;
+        }
+        m_count = count;
+        if (m_identity)
+            return;
+        while (m_segments.size() && m_segments.back().offset >= count)
+            m_segments.pop_back();
+        if (m_segments.size() <= 1)
+        {
+            m_start = m_segments.size() ? m_segments.front().start : 0;
+            m_segments.clear();
+            m_identity = true;
+        }
+    }
+
+    /**
+      Append the first entries of another index.  Ranges of the other
+      index are appended as segments, without copying point IDs.
+
+      \param other  Index whose entries should be appended.
+      \param count  Number of entries of \a other to append.
+    */
+    void append(const PointIdIndex& other, point_count_t count)
+    {
+        if (count == 0)
+            return;
+        if (other.explicitIds())
+        {
+            makeExplicit();
+            m_ids.insert(m_ids.end(), other.m_ids.begin(),
+                other.m_ids.begin() + count);
+            return;
+        }
+        other.forEachRange([this, &count](PointId start, point_count_t n)
+        {
+            n = (std::min)(n, count);
+            if (n)
+                appendRange(start, n);
+            count -= n;
+        });
+    }
+
+private:
+    bool explicitIds() const
+        { return !m_identity && m_segments.empty(); }
+
+    PointId segmentEnd(std::size_t i) const
+    {
+        return i + 1 < m_segments.size() ?
+            m_segments[i + 1].offset : (PointId)m_count;
+    }
+
+    PointId lookup(PointId idx) const
+    {
+        auto it = std::upper_bound(m_segments.begin(), m_segments.end(), idx,
+            [](PointId i, const Segment& s){ return i < s.offset; });
+        --it;
+        return it->start + (idx - it->offset);
+    }
+
+    void appendRange(PointId start, point_count_t count)
+    {
+        if (m_identity)
+        {
+            if (m_count == 0)
+                m_start = start;
+            if (start == m_start + m_count)
+            {
+                m_count += count;
+                return;
+            }
+            m_segments.push_back({ 0, m_start });
+            m_identity = false;
+        }
+        if (m_segments.size())
+        {
+            const Segment& last = m_segments.back();
+            if (start == last.start + (m_count - last.offset))
+            {
+                m_count += count;
+                return;
+            }
+            if (m_segments.size() < MaxSegments)
+            {
+                m_segments.push_back({ m_count, start });
+                m_count += count;
+                return;
+            }
+            makeExplicit();
+        }
+        m_ids.resize(m_ids.size() + count);
+        std::iota(m_ids.end() - count, m_ids.end(), start);
+    }
+
+    void makeExplicit()
+    {
+        if (m_identity)
+        {
+            m_ids.resize(m_count);
+            std::iota(m_ids.begin(), m_ids.end(), m_start);
+            m_identity = false;
+        }
+        else if (m_segments.size())
+        {
+            m_ids.resize(m_count);
+            for (std::size_t i = 0; i < m_segments.size(); ++i)
+                std::iota(m_ids.begin() + m_segments[i].offset,
+                    m_ids.begin() + segmentEnd(i), m_segments[i].start);
+            std::vector<Segment>().swap(m_segments);
+        }
+    }
+
+    PointId m_start;
+    point_count_t m_count;
+    bool m_identity;
+    std::vector<Segment> m_segments;
+    std::vector<PointId> m_ids;
+};
+
+} // namespace pdal
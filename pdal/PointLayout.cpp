@@ -35,6 +35,8 @@
 #include <pdal/PointLayout.hpp>
 #include <pdal/util/Algorithm.hpp>
 
+#include <limits>
+
 namespace pdal
 {
 
@@ -44,6 +46,9 @@ PointLayout::PointLayout()
     , m_propIds()
     , m_nextFree(Dimension::PROPRIETARY)
     , m_pointSize(0)
+    , m_quantSavings(0)
+    , m_padding(0)
+    , m_aligned(false)
     , m_finalized(false)
 {
     int id = 0;
@@ -61,6 +66,35 @@ void PointLayout::finalize()
 }
 
 
+void PointLayout::setAligned(bool aligned)
+{
+    if (m_finalized)
+        throw pdal_error("Can't change alignment of a finalized layout.");
+    m_aligned = aligned;
+    relayout();
+}
+
+
+void PointLayout::setDimPriority(Dimension::Id id, int priority)
+{
+    if (m_finalized)
+        throw pdal_error("Can't change dimension priority of a finalized "
+            "layout.");
+    m_priorities[id] = priority;
+    if (hasDim(id))
+        relayout();
+}
+
+
+// Recompute the offsets of the dimensions of the layout.
+void PointLayout::relayout()
+{
+    if (m_used.size())
+        update(m_detail[Utils::toNative(m_used.front())],
+            dimName(m_used.front()));
+}
+
+
 void PointLayout::registerDims(std::vector<Dimension::Id> ids)
 {
     for (auto ii = ids.begin(); ii != ids.end(); ++ii)
@@ -135,6 +169,30 @@ Dimension::Id PointLayout::registerOrAssignDim(const std::string name,
 }
 
 
+void PointLayout::quantizeDim(Dimension::Id id, double scale, double offset)
+{
+    Dimension::Detail dd = m_detail[Utils::toNative(id)];
+    if (dd.type() != Dimension::Type::Double)
+        throw pdal_error("Can't quantize dimension '" + dimName(id) +
+            "', which isn't stored as a double.");
+    if (scale <= 0)
+        throw pdal_error("Can't quantize dimension '" + dimName(id) +
+            "' with a scale that isn't positive.");
+    if (Utils::contains(m_unquantized, id))
+        return;
+
+    if (dd.quantized() &&
+        (dd.scale() != scale || dd.quantOffset() != offset))
+    {
+        m_unquantized.push_back(id);
+        dd.setQuantization(0, 0);
+    }
+    else
+        dd.setQuantization(scale, offset);
+    update(dd, dimName(id));
+}
+
+
 DimTypeList PointLayout::dimTypes() const
 {
     DimTypeList dimTypes;
@@ -220,6 +278,12 @@ size_t PointLayout::pointSize() const
 }
 
 
+size_t PointLayout::storageSize() const
+{
+    return m_pointSize - m_quantSavings + m_padding;
+}
+
+
 // Update the point layout given dimension detail and the dimension's name.
 bool PointLayout::update(Dimension::Detail dd, const std::string& name)
 {
@@ -249,28 +313,55 @@ bool PointLayout::update(Dimension::Detail dd, const std::string& name)
     Dimension::Detail *cur = &(*di);
 
     {
-        auto sorter = [](const Dimension::Detail& d1,
+        auto priority = [this](Dimension::Id id)
+        {
+            using namespace Dimension;
+
+            if (id == Id::X || id == Id::Y || id == Id::Z)
+                return (std::numeric_limits<int>::max)();
+            auto pi = m_priorities.find(id);
+            return pi == m_priorities.end() ? 0 : pi->second;
+        };
+        auto sorter = [&priority](const Dimension::Detail& d1,
                 const Dimension::Detail& d2) -> bool
         {
-            if (d1.size() > d2.size())
+            if (d1.storageSize() > d2.storageSize())
                 return true;
-            if (d1.size() < d2.size())
+            if (d1.storageSize() < d2.storageSize())
                 return false;
+            const int p1 = priority(d1.id());
+            const int p2 = priority(d2.id());
+            if (p1 != p2)
+                return p1 > p2;
             return d1.id() < d2.id();
         };
 
-        // Sort dimensions based on size and then on ID.
+        // Sort dimensions based on size, then on priority and then on ID.
+        // Sizes are powers of two, so each dimension is aligned to its size
+        // within the record.
         int offset = 0;
+        std::size_t size = 0;
         std::sort(detail.begin(), detail.end(), sorter);
         for (auto& d : detail)
         {
             d.setOffset(offset);
-            offset += (int)d.size();
+            offset += (int)d.storageSize();
+            size += d.size();
         }
         //NOTE - I tried forcing all points to be aligned on 8-byte boundaries
         // in case this would matter to the optimized memcpy, but it made
         // no difference.  No sense wasting space for no difference.
-        m_pointSize = (size_t)offset;
+        m_pointSize = size;
+        m_quantSavings = size - (size_t)offset;
+
+        // The first dimension is the largest, so padding records to its
+        // size aligns every dimension of every record.
+        m_padding = 0;
+        if (m_aligned && detail.size())
+        {
+            const size_t align = detail.front().storageSize();
+            m_padding = (align - (size_t)offset % align) % align;
+        }
     }
 
     if (!used)
@@ -334,6 +425,12 @@ MetadataNode PointLayout::toMetadata() const
         Dimension::Type t = dimType(id);
         dim.add("type", Dimension::toName(Dimension::base(t)));
         dim.add("size", dimSize(id));
+        const Dimension::Detail *dd = dimDetail(id);
+        if (dd->quantized())
+        {
+            dim.add("scale", dd->scale());
+            dim.add("offset", dd->quantOffset());
+        }
         root.addList(dim);
     }
 
@@ -69,6 +69,37 @@ public:
     PDAL_DLL bool finalized() const
         { return m_finalized; }
 
+    /**
+      Set whether stored point records are padded so that every dimension
+      of every point in a packed point table is aligned to its size.
+      Dimensions are always placed in order of decreasing size, so this only
+      pads the end of each record.  Must be called before the layout is
+      finalized.
+
+      \param aligned  Whether records should be aligned.
+    */
+    PDAL_DLL void setAligned(bool aligned);
+
+    /**
+      Determine whether stored point records are aligned (see setAligned()).
+
+      \return  Whether records are aligned.
+    */
+    PDAL_DLL bool aligned() const
+        { return m_aligned; }
+
+    /**
+      Set the priority of a dimension.  Among dimensions of the same size,
+      those with a higher priority are placed first in a point record, so
+      that dimensions that are accessed together share cache lines.  X, Y
+      and Z always come first.  Must be called before the layout is
+      finalized.
+
+      \param id  ID of the dimension.
+      \param priority  Priority of the dimension.  The default is 0.
+    */
+    PDAL_DLL void setDimPriority(Dimension::Id id, int priority);
+
     /**
       Register a vector of dimensions.
 
@@ -130,6 +161,21 @@ public:
     PDAL_DLL Dimension::Id registerOrAssignDim(const std::string name,
         Dimension::Type type);
 
+    /**
+      Store the values of a registered double dimension as 32-bit integers
+      (value - offset) / scale rather than as doubles.  Values are still
+      read and written as doubles, but a value that can't be represented
+      with the scale and offset can't be stored.  If the dimension is
+      quantized again with a different scale or offset, as when readers of
+      differently scaled files share a layout, its values are stored as
+      doubles.
+
+      \param id  ID of the dimension to quantize.
+      \param scale  Scale of the stored values.
+      \param offset  Offset of the stored values.
+    */
+    PDAL_DLL void quantizeDim(Dimension::Id id, double scale, double offset);
+
     /**
       Get a list of DimType objects that define the layout.
 
@@ -218,6 +264,15 @@ public:
     */
     PDAL_DLL size_t pointSize() const;
 
+    /**
+      Get the number of bytes used to store a point in a point table.  This
+      is less than pointSize() when dimensions are quantized (see
+      quantizeDim()).
+
+      \return  Size of a stored point in bytes.
+    */
+    PDAL_DLL size_t storageSize() const;
+
     /**
       Get a pointer to a dimension's detail information.
 
@@ -238,6 +293,7 @@ public:
 
 private:
     PDAL_DLL virtual bool update(Dimension::Detail dd, const std::string& name);
+    void relayout();
 
     Dimension::Type resolveType( Dimension::Type t1,
         Dimension::Type t2);
@@ -248,6 +304,14 @@ protected:
     std::map<std::string, Dimension::Id> m_propIds;
     int m_nextFree;
     std::size_t m_pointSize;
+    // Bytes saved per point by quantized dimensions.
+    std::size_t m_quantSavings;
+    // Dimensions that can't be quantized because of conflicting requests.
+    Dimension::IdList m_unquantized;
+    // Bytes added to the end of each stored point to align records.
+    std::size_t m_padding;
+    std::map<Dimension::Id, int> m_priorities;
+    bool m_aligned;
     bool m_finalized;
 };
 
@@ -34,12 +34,21 @@
 
 #include <pdal/ArtifactManager.hpp>
 #include <pdal/PointTable.hpp>
+#include <pdal/PointView.hpp>
+#include <pdal/pdal_features.hpp>
+#include <pdal/compression/DeltaCompression.hpp>
+#ifdef PDAL_HAVE_LZ4
+#include <pdal/compression/Lz4Compression.hpp>
+#endif
+
+#include <cstring>
 
 namespace pdal
 {
 
 BasePointTable::BasePointTable(PointLayout& layout) :
-    m_metadata(new Metadata()), m_layoutRef(layout)
+    m_metadata(new Metadata()), m_layoutRef(layout), m_forwardMetadata(true),
+    m_viewList(new ViewList), m_memoryCharged(0)
 {}
 
 
@@ -47,6 +56,19 @@ BasePointTable::~BasePointTable()
 {}
 
 
+void BasePointTable::chargeMemory()
+{
+    std::size_t used = memoryUsed();
+    if (used <= m_memoryCharged)
+        return;
+
+    MemoryCharge charge;
+    charge.set(used - m_memoryCharged);
+    m_memoryCharges.push_back(std::move(charge));
+    m_memoryCharged = used;
+}
+
+
 MetadataNode BasePointTable::privateMetadata(const std::string& name)
 {
     MetadataNode mp = m_metadata->m_private;
@@ -79,13 +101,38 @@ ArtifactManager& BasePointTable::artifactManager()
 }
 
 
+namespace
+{
+
+// Convert a double to the stored value of a quantized dimension and back.
+void quantize(const Dimension::Detail *d, const void *value, char *dst)
+{
+    double v;
+    std::memcpy(&v, value, sizeof(v));
+    int32_t i = d->toStored(v);
+    std::memcpy(dst, &i, sizeof(i));
+}
+
+void unquantize(const Dimension::Detail *d, const char *src, void *value)
+{
+    int32_t i;
+    std::memcpy(&i, src, sizeof(i));
+    double v = d->fromStored(i);
+    std::memcpy(value, &v, sizeof(v));
+}
+
+} // unnamed namespace
+
 void SimplePointTable::setFieldInternal(Dimension::Id id, PointId idx,
     const void *value)
 {
     const Dimension::Detail *d = m_layoutRef.dimDetail(id);
     const char *src  = (const char *)value;
     char *dst = getDimension(d, idx);
-    std::copy(src, src + d->size(), dst);
+    if (d->quantized())
+        quantize(d, value, dst);
+    else
+        std::copy(src, src + d->size(), dst);
 }
 
 
@@ -95,29 +142,106 @@ void SimplePointTable::getFieldInternal(Dimension::Id id, PointId idx,
     const Dimension::Detail *d = m_layoutRef.dimDetail(id);
     const char *src = getDimension(d, idx);
     char *dst = (char *)value;
-    std::copy(src, src + d->size(), dst);
+    if (d->quantized())
+        unquantize(d, src, value);
+    else
+        std::copy(src, src + d->size(), dst);
+}
+
+
+void SimplePointTable::getStoredFieldInternal(Dimension::Id id, PointId idx,
+    void *value) const
+{
+    const Dimension::Detail *d = m_layoutRef.dimDetail(id);
+    const char *src = getDimension(d, idx);
+    std::copy(src, src + d->storageSize(), (char *)value);
+}
+
+
+PointTable::PointTable() : SimplePointTable(m_layout), m_numPts(0),
+    m_blockPtCnt(DefaultBlockPointCount),
+    m_allocator(new HeapBlockAllocator), m_memoryUsed(0), m_memoryLimit(0)
+{}
+
+
+PointTable::PointTable(point_count_t blockPtCnt, BlockAllocatorPtr allocator) :
+    SimplePointTable(m_layout), m_numPts(0), m_blockPtCnt(blockPtCnt),
+    m_allocator(allocator), m_memoryUsed(0), m_memoryLimit(0)
+{
+    if (m_blockPtCnt == 0)
+        throw pdal_error("PointTable block size must be greater than 0.");
+    if (!m_allocator)
+        m_allocator.reset(new HeapBlockAllocator);
 }
 
 
 PointTable::~PointTable()
 {
-    for (auto vi = m_blocks.begin(); vi != m_blocks.end(); ++vi)
-        delete [] *vi;
+    for (size_t i = 0; i < m_blocks.size(); ++i)
+        if (m_blocks[i])
+            m_allocator->deallocate(m_blocks[i], m_blockSizes[i]);
 }
 
+// Each block is charged separately so that the charge can be released when
+// the block is freed.
 PointId PointTable::addPoint()
 {
     if (m_numPts % m_blockPtCnt == 0)
     {
         size_t size = pointsToBytes(m_blockPtCnt);
-        char *buf = new char[size];
-        memset(buf, 0, size);
-        m_blocks.push_back(buf);
+        if (m_memoryLimit && m_memoryUsed + size > m_memoryLimit)
+            throw pdal_error("Point table memory limit of " +
+                std::to_string(m_memoryLimit) + " bytes exceeded.");
+        MemoryCharge charge;
+        if (!m_allocator->fileBacked())
+            charge.set(size);
+        m_blocks.push_back(m_allocator->allocate(size));
+        m_blockSizes.push_back(size);
+        m_blockCharges.push_back(std::move(charge));
+        m_memoryUsed += size;
     }
     return m_numPts++;
 }
 
 
+// The block being filled is always kept, as points are still added to it.
+std::size_t PointTable::releaseUnreferenced()
+{
+    if (m_blocks.size() < 2)
+        return 0;
+
+    std::vector<char> used(m_blocks.size());
+    used.back() = 1;
+    {
+        std::lock_guard<std::mutex> lock(m_viewList->m_mutex);
+        for (const PointView *v : m_viewList->m_views)
+        {
+            v->m_index.forEachRange([this, &used](PointId start,
+                point_count_t count)
+            {
+                const size_t first = start / m_blockPtCnt;
+                const size_t last = (start + count - 1) / m_blockPtCnt;
+                std::fill(used.begin() + first, used.begin() + last + 1, 1);
+            });
+        }
+    }
+
+    std::size_t freed = 0;
+    for (size_t i = 0; i < m_blocks.size(); ++i)
+    {
+        if (used[i] || !m_blocks[i])
+            continue;
+        m_allocator->deallocate(m_blocks[i], m_blockSizes[i]);
+        m_blocks[i] = nullptr;
+        m_blockCharges[i] = MemoryCharge();
+        freed += m_blockSizes[i];
+        m_blockSizes[i] = 0;
+    }
+    m_memoryUsed -= freed;
+    return freed;
+}
+
+
 char *PointTable::getPoint(PointId idx)
 {
     char *buf = m_blocks[idx / m_blockPtCnt];
@@ -125,13 +249,276 @@ char *PointTable::getPoint(PointId idx)
 }
 
 
+CompressedPointTable::CompressedPointTable(Codec codec,
+        std::size_t hotBlocks, point_count_t blockPtCnt) :
+    SimplePointTable(m_layout), m_codec(codec),
+    m_hotBlocks((std::max)(hotBlocks, (std::size_t)2)),
+    m_blockPtCnt(blockPtCnt), m_numPts(0), m_memoryUsed(0)
+{
+    if (m_blockPtCnt == 0)
+        throw pdal_error("CompressedPointTable block size must be greater "
+            "than 0.");
+#ifndef PDAL_HAVE_LZ4
+    if (m_codec == Codec::Lz4)
+        throw pdal_error("CompressedPointTable LZ4 compression requires "
+            "PDAL to be built with LZ4 support.");
+#endif
+}
+
+
+CompressedPointTable::~CompressedPointTable()
+{}
+
+
+CompressedPointTable::Codec CompressedPointTable::defaultCodec()
+{
+#ifdef PDAL_HAVE_LZ4
+    return Codec::Lz4;
+#else
+    return Codec::Delta;
+#endif
+}
+
+
+// The dimensions of a record, as stored, in the order of the columnar
+// codec.
+DimTypeList CompressedPointTable::dimTypes() const
+{
+    DimTypeList dims;
+    for (Dimension::Id id : m_layoutRef.dims())
+    {
+        const Dimension::Detail *d = m_layoutRef.dimDetail(id);
+        dims.emplace_back(id, d->quantized() ?
+            Dimension::Type::Signed32 : d->type());
+    }
+    return dims;
+}
+
+
+std::size_t CompressedPointTable::memoryUsed() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_memoryUsed;
+}
+
+
+PointId CompressedPointTable::addPoint()
+{
+    bool added = false;
+    PointId id;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_numPts % m_blockPtCnt == 0)
+        {
+            m_blocks.emplace_back();
+            added = true;
+        }
+        id = m_numPts++;
+    }
+    if (added)
+        chargeMemory();
+    return id;
+}
+
+
+char *CompressedPointTable::getPoint(PointId idx)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return point(idx, true);
+}
+
+
+void CompressedPointTable::setFieldInternal(Dimension::Id id, PointId idx,
+    const void *value)
+{
+    const Dimension::Detail *d = m_layoutRef.dimDetail(id);
+    const char *src  = (const char *)value;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    char *dst = point(idx, true) + d->offset();
+    if (d->quantized())
+        quantize(d, value, dst);
+    else
+        std::copy(src, src + d->size(), dst);
+}
+
+
+void CompressedPointTable::getFieldInternal(Dimension::Id id, PointId idx,
+    void *value) const
+{
+    CompressedPointTable *ncThis = const_cast<CompressedPointTable *>(this);
+    const Dimension::Detail *d = m_layoutRef.dimDetail(id);
+    char *dst = (char *)value;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const char *src = ncThis->point(idx, false) + d->offset();
+    if (d->quantized())
+        unquantize(d, src, value);
+    else
+        std::copy(src, src + d->size(), dst);
+}
+
+
+void CompressedPointTable::getStoredFieldInternal(Dimension::Id id,
+    PointId idx, void *value) const
+{
+    CompressedPointTable *ncThis = const_cast<CompressedPointTable *>(this);
+    const Dimension::Detail *d = m_layoutRef.dimDetail(id);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const char *src = ncThis->point(idx, false) + d->offset();
+    std::copy(src, src + d->storageSize(), (char *)value);
+}
+
+
+// Find a point, decompressing its block if it isn't hot.  Blocks that may
+// be written are compressed again when they're evicted.  Called with the
+// mutex locked.
+char *CompressedPointTable::point(PointId idx, bool write)
+{
+    const std::size_t block = idx / m_blockPtCnt;
+
+    auto it = m_hot.begin();
+    while (it != m_hot.end() && it->m_block != block)
+        ++it;
+    if (it == m_hot.end())
+    {
+        if (m_hot.size() >= m_hotBlocks)
+            evict();
+
+        HotBlock hot;
+        hot.m_block = block;
+        hot.m_dirty = false;
+        hot.m_buf.resize(pointsToBytes(m_blockPtCnt));
+        if (m_blocks[block].size())
+            decompress(m_blocks[block], hot.m_buf);
+        m_memoryUsed += hot.m_buf.size();
+        m_hot.push_front(std::move(hot));
+    }
+    else if (it != m_hot.begin())
+        m_hot.splice(m_hot.begin(), m_hot, it);
+
+    HotBlock& hot = m_hot.front();
+    if (write)
+        hot.m_dirty = true;
+    return hot.m_buf.data() + pointsToBytes(idx % m_blockPtCnt);
+}
+
+
+void CompressedPointTable::evict()
+{
+    HotBlock& hot = m_hot.back();
+    if (hot.m_dirty)
+    {
+        std::vector<char>& data = m_blocks[hot.m_block];
+        m_memoryUsed -= data.size();
+        data = compress(hot.m_buf);
+        m_memoryUsed += data.size();
+    }
+    m_memoryUsed -= hot.m_buf.size();
+    m_hot.pop_back();
+}
+
+
+std::vector<char> CompressedPointTable::compress(
+    const std::vector<char>& buf) const
+{
+    std::vector<char> data;
+    auto cb = [&data](char *b, size_t size)
+        { data.insert(data.end(), b, b + size); };
+
+    if (m_codec == Codec::Delta)
+    {
+        // Gather the records' values in the order of the codec.
+        const DimTypeList dims = dimTypes();
+        std::vector<char> packed(buf.size());
+        char *dst = packed.data();
+        for (std::size_t pos = 0; pos < buf.size();
+                pos += m_layoutRef.storageSize())
+            for (const DimType& dt : dims)
+            {
+                const Dimension::Detail *d = m_layoutRef.dimDetail(dt.m_id);
+                std::memcpy(dst, buf.data() + pos + d->offset(),
+                    d->storageSize());
+                dst += d->storageSize();
+            }
+
+        DeltaCompressor comp(cb, dims);
+        comp.compress(packed.data(), dst - packed.data());
+        comp.done();
+    }
+#ifdef PDAL_HAVE_LZ4
+    else
+    {
+        Lz4Compressor comp(cb);
+        comp.compress(buf.data(), buf.size());
+        comp.done();
+    }
+#endif
+    data.shrink_to_fit();
+    return data;
+}
+
+
+void CompressedPointTable::decompress(const std::vector<char>& data,
+    std::vector<char>& buf) const
+{
+    std::size_t pos = 0;
+    if (m_codec == Codec::Delta)
+    {
+        // Scatter the values of each decoded record to their offsets.
+        const DimTypeList dims = dimTypes();
+        auto cb = [this, &dims, &buf, &pos](char *b, size_t size)
+        {
+            const char *src = b;
+            const char *end = b + size;
+            while (src < end && pos < buf.size())
+            {
+                for (const DimType& dt : dims)
+                {
+                    const Dimension::Detail *d =
+                        m_layoutRef.dimDetail(dt.m_id);
+                    std::memcpy(buf.data() + pos + d->offset(), src,
+                        d->storageSize());
+                    src += d->storageSize();
+                }
+                pos += m_layoutRef.storageSize();
+            }
+        };
+        DeltaDecompressor decomp(cb, dims);
+        decomp.decompress(data.data(), data.size());
+        decomp.done();
+    }
+#ifdef PDAL_HAVE_LZ4
+    else
+    {
+        auto cb = [&buf, &pos](char *b, size_t size)
+        {
+            size = (std::min)(size, buf.size() - pos);
+            std::memcpy(buf.data() + pos, b, size);
+            pos += size;
+        };
+        Lz4Decompressor decomp(cb);
+        decomp.decompress(data.data(), data.size());
+        decomp.done();
+    }
+#endif
+    if (pos != buf.size())
+        throw pdal_error("CompressedPointTable block couldn't be "
+            "decompressed.");
+}
+
+
 ContiguousPointTable::~ContiguousPointTable()
 {}
 
 
 PointId ContiguousPointTable::addPoint()
 {
+    size_t capacity = m_buf.capacity();
     m_buf.resize(pointsToBytes(m_numPts + 1));
+    if (m_buf.capacity() != capacity)
+        chargeMemory();
     return m_numPts++;
 }
 
@@ -142,6 +529,113 @@ char *ContiguousPointTable::getPoint(PointId idx)
 }
 
 
+ColumnPointTable::~ColumnPointTable()
+{}
+
+
+PointId ColumnPointTable::addPoint()
+{
+    if (m_numPts == m_capacity)
+    {
+        m_capacity = (std::max)((point_count_t)m_minCapacity, m_capacity * 2);
+        allocate();
+        chargeMemory();
+    }
+    return m_numPts++;
+}
+
+
+std::size_t ColumnPointTable::memoryUsed() const
+{
+    std::size_t total = 0;
+    for (const std::vector<char>& c : m_columns)
+        total += c.capacity();
+    return total;
+}
+
+
+char *ColumnPointTable::getPoint(PointId idx)
+{
+    throw pdal_error("ColumnPointTable doesn't support access to packed "
+        "point data.");
+}
+
+
+void ColumnPointTable::finalize()
+{
+    BasePointTable::finalize();
+    allocate();
+}
+
+
+// Allocate the column of each dimension to the table's capacity.  Columns
+// are only allocated here, as the layout is finalized and as points are
+// added, so that reading and writing fields never changes the columns and
+// views of the table can be run concurrently.
+void ColumnPointTable::allocate()
+{
+    for (Dimension::Id id : m_layoutRef.dims())
+    {
+        const Dimension::Detail *d = m_layoutRef.dimDetail(id);
+        size_t pos = Utils::toNative(id);
+        if (pos >= m_columns.size())
+            m_columns.resize(pos + 1);
+
+        std::vector<char>& col = m_columns[pos];
+        size_t size = m_capacity * d->storageSize();
+        if (col.size() < size)
+            col.resize(size);
+    }
+}
+
+
+char *ColumnPointTable::column(const Dimension::Detail *d)
+{
+    return m_columns[Utils::toNative(d->id())].data();
+}
+
+
+const char *ColumnPointTable::column(const Dimension::Detail *d) const
+{
+    return m_columns[Utils::toNative(d->id())].data();
+}
+
+
+void ColumnPointTable::setFieldInternal(Dimension::Id id, PointId idx,
+    const void *value)
+{
+    const Dimension::Detail *d = m_layoutRef.dimDetail(id);
+    const char *src  = (const char *)value;
+    char *dst = column(d) + idx * d->storageSize();
+    if (d->quantized())
+        quantize(d, value, dst);
+    else
+        std::copy(src, src + d->size(), dst);
+}
+
+
+void ColumnPointTable::getFieldInternal(Dimension::Id id, PointId idx,
+    void *value) const
+{
+    const Dimension::Detail *d = m_layoutRef.dimDetail(id);
+    const char *src = column(d) + idx * d->storageSize();
+    char *dst = (char *)value;
+    if (d->quantized())
+        unquantize(d, src, value);
+    else
+        std::copy(src, src + d->size(), dst);
+}
+
+
+void ColumnPointTable::getStoredFieldInternal(Dimension::Id id, PointId idx,
+    void *value) const
+{
+    const Dimension::Detail *d = m_layoutRef.dimDetail(id);
+    const char *src = column(d) + idx * d->storageSize();
+    std::copy(src, src + d->storageSize(), (char *)value);
+}
+
+
 MetadataNode BasePointTable::toMetadata() const
 {
     return layout()->toMetadata();
@@ -36,10 +36,17 @@
 
 #include <algorithm>
 #include <list>
+#include <mutex>
+#include <numeric>
+#include <set>
+#include <type_traits>
 #include <vector>
 
 #include "pdal/SpatialReference.hpp"
+#include "pdal/BlockAllocator.hpp"
 #include "pdal/Dimension.hpp"
+#include "pdal/DimType.hpp"
+#include "pdal/MemoryAccount.hpp"
 #include "pdal/PointContainer.hpp"
 #include "pdal/PointLayout.hpp"
 #include "pdal/Metadata.hpp"
@@ -48,6 +55,7 @@ namespace pdal
 {
 
 class ArtifactManager;
+class PointView;
 
 class PDAL_DLL BasePointTable : public PointContainer
 {
@@ -91,22 +99,136 @@ public:
     }
     virtual bool supportsView() const
         { return false; }
+
+    /**
+      Determine whether points are stored as packed records that stay in
+      place, so that they can be accessed directly through getPoint() and
+      the dimension offsets of the layout.
+
+      \return  Whether points are stored as packed records.
+    */
+    virtual bool packedPoints() const
+        { return true; }
+
+    /**
+      Determine whether the values of each dimension are stored in an
+      array of their own, which can be accessed with dimensionData().
+
+      \return  Whether dimensions are stored as arrays.
+    */
+    virtual bool columnData() const
+        { return false; }
+
+    /**
+      Determine whether releaseUnreferenced() can free storage.
+
+      \return  Whether unreferenced storage can be freed.
+    */
+    virtual bool releasableStorage() const
+        { return false; }
+
+    /**
+      Get a pointer to the array storing the values of a dimension of a
+      table that stores dimensions as arrays (see columnData()).  The array
+      is indexed by table point ID (see PointView::tableIndex()).  The
+      pointer is invalidated when points are added to the table.
+
+      \param id  ID of the dimension.
+      \return  Pointer to the dimension's values.
+    */
+    template<typename T>
+    T *dimensionData(Dimension::Id id)
+    {
+        const Dimension::Detail *d = m_layoutRef.dimDetail(id);
+        const Dimension::BaseType base =
+            std::is_floating_point<T>::value ? Dimension::BaseType::Floating :
+            std::is_signed<T>::value ? Dimension::BaseType::Signed :
+            Dimension::BaseType::Unsigned;
+        if (d->quantized() || d->size() != sizeof(T) ||
+                Dimension::base(d->type()) != base)
+            throw pdal_error("Requested type doesn't match storage type of "
+                "dimension '" + m_layoutRef.dimName(id) + "'.");
+        return reinterpret_cast<T *>(column(d));
+    }
+
+    /**
+      Get the number of bytes of storage allocated for point data.
+
+      \return  Number of bytes allocated for point data.
+    */
+    virtual std::size_t memoryUsed() const
+        { return 0; }
     MetadataNode privateMetadata(const std::string& name);
     MetadataNode toMetadata() const;
+
+    /**
+      Set whether readers should store metadata that's only forwarded to
+      writers through private metadata (see privateMetadata()).
+
+      \param forward  Whether forward-only metadata is stored.
+    */
+    void setForwardMetadata(bool forward)
+        { m_forwardMetadata = forward; }
+    bool forwardMetadata() const
+        { return m_forwardMetadata; }
     ArtifactManager& artifactManager();
 
+    /**
+      Free storage that holds no point referenced by a point view, such as
+      the storage of points that were filtered out or whose views were
+      compacted (see PointView::compact()).  Only tables for which
+      releasableStorage() is true free storage.
+
+      \return  Number of bytes freed.
+    */
+    virtual std::size_t releaseUnreferenced()
+        { return 0; }
+
 private:
     // Point data operations.
     virtual PointId addPoint() = 0;
+    // Copy the value of a dimension as stored, which for a quantized
+    // dimension is the scaled integer (see PointLayout::quantizeDim()).
+    virtual void getStoredFieldInternal(Dimension::Id id, PointId idx,
+        void *value) const
+    {
+        throw pdal_error("Point table doesn't support access to stored "
+            "values.");
+    }
 
 protected:
     virtual char *getPoint(PointId idx) = 0;
 
+    // Get the array storing the values of a dimension.  Only tables for
+    // which columnData() is true store dimensions as arrays.
+    virtual char *column(const Dimension::Detail * /*d*/)
+    {
+        throw pdal_error("Point table doesn't store dimensions as arrays.");
+    }
+
+    // Charge growth of memoryUsed() since the last call to the active
+    // memory account.  Throws pdal_error if the memory budget is exceeded.
+    void chargeMemory();
+
 protected:
+    // The views of a table.  Shared by the table and its views so that a
+    // view may outlive its table.
+    struct ViewList
+    {
+        std::mutex m_mutex;
+        std::set<const PointView *> m_views;
+    };
+
     MetadataPtr m_metadata;
     std::list<SpatialReference> m_spatialRefs;
     PointLayout& m_layoutRef;
     std::unique_ptr<ArtifactManager> m_artifactManager;
+    bool m_forwardMetadata;
+    std::shared_ptr<ViewList> m_viewList;
+
+private:
+    std::vector<MemoryCharge> m_memoryCharges;
+    std::size_t m_memoryCharged;
 };
 typedef BasePointTable& PointTableRef;
 typedef BasePointTable const & ConstPointTableRef;
@@ -120,13 +242,15 @@ protected:
 
 protected:
     std::size_t pointsToBytes(point_count_t numPts) const
-        { return m_layoutRef.pointSize() * numPts; }
+        { return m_layoutRef.storageSize() * numPts; }
 
 private:
     virtual void setFieldInternal(Dimension::Id id, PointId idx,
         const void *value);
     virtual void getFieldInternal(Dimension::Id id, PointId idx,
         void *value) const;
+    virtual void getStoredFieldInternal(Dimension::Id id, PointId idx,
+        void *value) const;
 
     // The number of points in each memory block.
     char *getDimension(const Dimension::Detail *d, PointId idx)
@@ -146,15 +270,51 @@ class PDAL_DLL PointTable : public SimplePointTable
 private:
     // Point storage.
     std::vector<char *> m_blocks;
+    std::vector<std::size_t> m_blockSizes;
+    std::vector<MemoryCharge> m_blockCharges;
     point_count_t m_numPts;
-    static const point_count_t m_blockPtCnt = 65536;
+    point_count_t m_blockPtCnt;
+    BlockAllocatorPtr m_allocator;
+    std::size_t m_memoryUsed;
+    std::size_t m_memoryLimit;
 
 public:
-    PointTable() : SimplePointTable(m_layout), m_numPts(0)
-        {}
+    static const point_count_t DefaultBlockPointCount = 65536;
+
+    PointTable();
+
+    /**
+      Create a point table with control over point storage.
+
+      \param blockPtCnt  Number of points in each block of storage.
+      \param allocator  Source of storage blocks.
+    */
+    PointTable(point_count_t blockPtCnt, BlockAllocatorPtr allocator);
     virtual ~PointTable();
     virtual bool supportsView() const
         { return true; }
+    virtual bool releasableStorage() const
+        { return true; }
+
+    /**
+      Limit the memory used for point storage.  Adding a point that would
+      require a block beyond the limit throws pdal_error.
+
+      \param bytes  Maximum number of bytes of point storage.  Zero means
+        no limit.
+    */
+    void setMemoryLimit(std::size_t bytes)
+        { m_memoryLimit = bytes; }
+
+    /**
+      Get the number of bytes allocated for point storage.
+
+      \return  Number of bytes allocated for point storage.
+    */
+    virtual std::size_t memoryUsed() const
+        { return m_memoryUsed; }
+
+    virtual std::size_t releaseUnreferenced();
 
 protected:
     virtual char *getPoint(PointId idx);
@@ -166,6 +326,111 @@ private:
     PointLayout m_layout;
 };
 
+/// A PointTable whose blocks are mapped from a scratch file.  This allows
+/// stages that need all points in memory at once to process more points
+/// than fit in memory.
+class PDAL_DLL MappedPointTable : public PointTable
+{
+public:
+    /// \param dir  Directory in which to create the scratch file.  If
+    ///   empty, a temporary directory is used.
+    /// \param residentLimit  Maximum number of bytes of point data to keep
+    ///   in memory.  Zero means no limit, leaving paging to the system.
+    MappedPointTable(const std::string& dir = "",
+            std::size_t residentLimit = 0) :
+        PointTable(DefaultBlockPointCount,
+            BlockAllocatorPtr(new FileBlockAllocator(dir, residentLimit)))
+    {}
+};
+
+/// A table that keeps blocks of point records compressed in memory, so
+/// that several times more points fit in memory than in a PointTable.  The
+/// most recently used blocks are kept decompressed.  A block is decompressed
+/// when one of its points is accessed and, if it was changed, compressed
+/// again when it's evicted, so access that moves through the points in
+/// order is much faster than random access.  Fields may be accessed from
+/// several threads.  A pointer returned by getPoint() is only valid until
+/// points in other blocks are accessed.
+class PDAL_DLL CompressedPointTable : public SimplePointTable
+{
+public:
+    enum class Codec
+    {
+        Lz4,    ///< LZ4.  Only available when PDAL is built with LZ4.
+        Delta   ///< The columnar codec of DeltaCompressor.
+    };
+
+    static const point_count_t DefaultBlockPointCount = 65536;
+    static const std::size_t DefaultHotBlocks = 8;
+
+    /**
+      \param codec  Codec used to compress blocks.
+      \param hotBlocks  Number of blocks kept decompressed.  At least two
+        are kept.
+      \param blockPtCnt  Number of points in each block.
+    */
+    CompressedPointTable(Codec codec = defaultCodec(),
+        std::size_t hotBlocks = DefaultHotBlocks,
+        point_count_t blockPtCnt = DefaultBlockPointCount);
+    virtual ~CompressedPointTable();
+
+    /**
+      Get the codec used when none is specified: LZ4 when it's available
+      and the columnar codec otherwise.
+    */
+    static Codec defaultCodec();
+
+    virtual bool supportsView() const
+        { return true; }
+    virtual bool packedPoints() const
+        { return false; }
+
+    /**
+      Get the number of bytes of compressed blocks and decompressed blocks.
+    */
+    virtual std::size_t memoryUsed() const;
+
+protected:
+    virtual char *getPoint(PointId idx);
+
+private:
+    struct HotBlock
+    {
+        std::size_t m_block;
+        std::vector<char> m_buf;
+        bool m_dirty;
+    };
+
+    virtual PointId addPoint();
+    virtual void setFieldInternal(Dimension::Id id, PointId idx,
+        const void *value);
+    virtual void getFieldInternal(Dimension::Id id, PointId idx,
+        void *value) const;
+    virtual void getStoredFieldInternal(Dimension::Id id, PointId idx,
+        void *value) const;
+
+    char *point(PointId idx, bool write);
+    void evict();
+    DimTypeList dimTypes() const;
+    std::vector<char> compress(const std::vector<char>& buf) const;
+    void decompress(const std::vector<char>& data,
+        std::vector<char>& buf) const;
+
+    Codec m_codec;
+    std::size_t m_hotBlocks;
+    point_count_t m_blockPtCnt;
+    point_count_t m_numPts;
+    // Compressed blocks.  A block that's empty has never been compressed
+    // and is all zero.
+    std::vector<std::vector<char>> m_blocks;
+    // Decompressed blocks, most recently used first.
+    std::list<HotBlock> m_hot;
+    std::size_t m_memoryUsed;
+    mutable std::mutex m_mutex;
+
+    PointLayout m_layout;
+};
+
 class PDAL_DLL ContiguousPointTable : public SimplePointTable
 {
 private:
@@ -178,6 +443,8 @@ public:
     virtual ~ContiguousPointTable();
     virtual bool supportsView() const
         { return true; }
+    virtual std::size_t memoryUsed() const
+        { return m_buf.capacity(); }
 
 protected:
     virtual char *getPoint(PointId idx);
@@ -188,6 +455,49 @@ private:
     PointLayout m_layout;
 };
 
+/// A ColumnPointTable stores each dimension in its own contiguous array
+/// (struct-of-arrays) rather than storing packed point records.  Stages that
+/// operate on a few dimensions of many points can access the arrays directly
+/// with dimensionData().  Packed point access through getPoint() isn't
+/// supported.
+class PDAL_DLL ColumnPointTable : public BasePointTable
+{
+public:
+    ColumnPointTable() : BasePointTable(m_layout), m_numPts(0), m_capacity(0)
+        {}
+    virtual ~ColumnPointTable();
+    virtual bool supportsView() const
+        { return true; }
+    virtual bool packedPoints() const
+        { return false; }
+    virtual bool columnData() const
+        { return true; }
+    virtual std::size_t memoryUsed() const;
+    virtual void finalize();
+
+protected:
+    virtual char *getPoint(PointId idx);
+    virtual char *column(const Dimension::Detail *d);
+
+private:
+    virtual PointId addPoint();
+    virtual void setFieldInternal(Dimension::Id id, PointId idx,
+        const void *value);
+    virtual void getFieldInternal(Dimension::Id id, PointId idx,
+        void *value) const;
+    virtual void getStoredFieldInternal(Dimension::Id id, PointId idx,
+        void *value) const;
+
+    void allocate();
+    const char *column(const Dimension::Detail *d) const;
+
+    std::vector<std::vector<char>> m_columns;
+    point_count_t m_numPts;
+    point_count_t m_capacity;
+    static const point_count_t m_minCapacity = 65536;
+    PointLayout m_layout;
+};
+
 /// A StreamPointTable must provide storage for point data up to its capacity.
 /// It must implement getPoint() which returns a pointer to a buffer of
 /// sufficient size to contain a point's data.  The minimum size required
@@ -201,9 +511,35 @@ protected:
         , m_capacity(capacity)
         , m_numPoints(0)
         , m_skips(m_capacity, false)
-    {}
+        , m_active(m_capacity)
+        , m_compact(false)
+    {
+        std::iota(m_active.begin(), m_active.end(), 0);
+    }
 
 public:
+    /// A range of IDs of points that haven't been skipped.
+    class IdRange
+    {
+    public:
+        IdRange(const PointId *begin, const PointId *end)
+            : m_begin(begin), m_end(end)
+        {}
+
+        const PointId *begin() const
+            { return m_begin; }
+        const PointId *end() const
+            { return m_end; }
+        std::size_t size() const
+            { return m_end - m_begin; }
+        bool empty() const
+            { return m_begin == m_end; }
+
+    private:
+        const PointId *m_begin;
+        const PointId *m_end;
+    };
+
     /// Called when a new point should be added.  Probably a no-op for
     /// streaming.
     virtual PointId addPoint()
@@ -216,6 +552,13 @@ public:
 
     void clear(point_count_t count)
     {
+        // The active list is only rebuilt if points were dropped from it.
+        if (m_compact || m_active.size() != m_capacity)
+        {
+            m_active.resize(m_capacity);
+            std::iota(m_active.begin(), m_active.end(), 0);
+            m_compact = false;
+        }
         if (!count)
             return;
 
@@ -229,11 +572,51 @@ public:
     bool skip(PointId n) const
         { return m_skips[n]; }
     void setSkip(PointId n)
-        { m_skips[n] = true; }
+    {
+        m_skips[n] = true;
+        m_compact = true;
+    }
+
+    /// Get the IDs of the points in [begin, begin + count) that haven't
+    /// been skipped, in increasing order.  The list is compacted after
+    /// each stage processes a batch, so while a stage runs it still holds
+    /// the points that the stage itself has skipped.
+    IdRange activeIds(PointId begin, point_count_t count) const
+    {
+        const PointId *first = m_active.data();
+        const PointId *last = first + m_active.size();
+        if (begin)
+            first = std::lower_bound(first, last, begin);
+        if (count < m_capacity - begin)
+            last = std::lower_bound(first, last, begin + count);
+        return IdRange(first, last);
+    }
+
+    /// Limit the active points to the first \a count points of the
+    /// table.  Called once a reader has filled the table.
+    void setActiveCount(point_count_t count)
+    {
+        if (count < m_active.size())
+            m_active.resize(count);
+    }
+
+    /// Remove the points skipped since the last call from the active list.
+    /// Only the active points are visited.
+    void compactActive()
+    {
+        if (!m_compact)
+            return;
+        m_active.erase(std::remove_if(m_active.begin(), m_active.end(),
+            [this](PointId idx){ return m_skips[idx]; }), m_active.end());
+        m_compact = false;
+    }
 
     point_count_t capacity() const
         { return m_capacity; }
 
+    virtual std::size_t memoryUsed() const
+        { return pointsToBytes(m_capacity); }
+
     /// During a given call to reset(), this indicates the number of points
     /// populated in the table.  This value will always be less then or equal
     /// to capacity(), and also includes skipped points.
@@ -246,24 +629,79 @@ protected:
     virtual void reset()
     {}
 
+    /// Change the number of points the table holds.  Only valid before
+    /// points are processed, typically from finalize().
+    void setCapacity(point_count_t capacity)
+    {
+        m_capacity = capacity;
+        m_skips.assign(m_capacity, false);
+        m_active.resize(m_capacity);
+        std::iota(m_active.begin(), m_active.end(), 0);
+        m_compact = false;
+    }
+
 private:
     point_count_t m_capacity;
     point_count_t m_numPoints;
     std::vector<bool> m_skips;
+    std::vector<PointId> m_active;
+    bool m_compact;
 };
 
 class PDAL_DLL FixedPointTable : public StreamPointTable
 {
 public:
+    /// Default number of bytes of point data in an adaptive table.  A
+    /// batch of this size stays in a core's share of cache as it passes
+    /// from stage to stage.
+    static const std::size_t DefaultFootprint = 2 << 20;
+    /// Limits on the capacity chosen by an adaptive table.
+    static const point_count_t MinAdaptiveCapacity = 4096;
+    static const point_count_t MaxAdaptiveCapacity = 1 << 20;
+
+    /// \param capacity  Number of points in the table.  If zero, the
+    ///   capacity is chosen from the point size as with setAdaptive().
     FixedPointTable(point_count_t capacity)
-        : StreamPointTable(m_layout, capacity)
+        : StreamPointTable(m_layout, capacity),
+        m_footprint(capacity ? 0 : std::size_t(DefaultFootprint))
     {}
 
+    /// Set the number of points in the table.  Must be called before the
+    /// table is finalized.
+    void setCapacity(point_count_t capacity)
+    {
+        m_footprint = 0;
+        StreamPointTable::setCapacity(capacity);
+    }
+
+    /// Choose the capacity when the table is finalized, so that the
+    /// points of a batch occupy about \a footprint bytes.  Small batches
+    /// spend proportionally more time in per-batch work, while batches
+    /// larger than the cache are evicted before the last stage reaches
+    /// them.  Must be called before the table is finalized.
+    ///
+    /// \param footprint  Target size of the table's point data in bytes.
+    void setAdaptive(std::size_t footprint = DefaultFootprint)
+        { m_footprint = footprint ? footprint : DefaultFootprint; }
+
+    /// Determine whether the capacity is chosen from the point size.
+    bool adaptive() const
+        { return m_footprint != 0; }
+
     virtual void finalize()
     {
         if (!m_layout.finalized())
         {
             BasePointTable::finalize();
+            if (m_footprint)
+            {
+                point_count_t count = m_footprint /
+                    (std::max)(pointsToBytes(1), std::size_t(1));
+                const point_count_t minCount = MinAdaptiveCapacity;
+                const point_count_t maxCount = MaxAdaptiveCapacity;
+                count = (std::min)((std::max)(count, minCount), maxCount);
+                StreamPointTable::setCapacity(count);
+            }
             m_buf.resize(pointsToBytes(capacity() + 1));
         }
     }
@@ -278,6 +716,7 @@ protected:
 private:
     std::vector<char> m_buf;
     PointLayout m_layout;
+    std::size_t m_footprint;
 };
 
 } //namespace
@@ -32,8 +32,12 @@
 * OF SUCH DAMAGE.
 ****************************************************************************/
 
+#include <algorithm>
+#include <cstring>
 #include <iomanip>
+#include <type_traits>
 
+#include <pdal/DimSummary.hpp>
 #include <pdal/EigenUtils.hpp>
 #include <pdal/KDIndex.hpp>
 #include <pdal/PointView.hpp>
@@ -42,23 +46,119 @@
 namespace pdal
 {
 
-int PointView::m_lastId = 0;
+namespace
+{
+
+// Copy values of a dimension stored as type S to one stored as type D.
+// Values that don't convert are left to setField(), which reports them.
+template<typename S>
+struct FieldCopy
+{
+    typedef void result_type;
+
+    PointView& m_view;
+    BasePointTable *m_table;
+    Dimension::Id m_dst;
+    Dimension::Id m_src;
+
+    FieldCopy(PointView& view, BasePointTable *table, Dimension::Id dst,
+            Dimension::Id src) :
+        m_view(view), m_table(table), m_dst(dst), m_src(src)
+    {}
+
+    template<typename D>
+    void operator()(D)
+    {
+        PointLayoutPtr layout = m_view.layout();
+        const size_t srcOffset = layout->dimOffset(m_src);
+        const size_t dstOffset = layout->dimOffset(m_dst);
+        S *srcColumn = m_table ? m_table->dimensionData<S>(m_src) : nullptr;
+        D *dstColumn = m_table ? m_table->dimensionData<D>(m_dst) : nullptr;
+
+        const point_count_t size = m_view.size();
+        for (PointId idx = 0; idx < size; ++idx)
+        {
+            const char *spos;
+            char *dpos;
+            if (m_table)
+            {
+                const PointId t = m_view.tableIndex(idx);
+                spos = reinterpret_cast<const char *>(srcColumn + t);
+                dpos = reinterpret_cast<char *>(dstColumn + t);
+            }
+            else
+            {
+                char *p = m_view.getPoint(idx);
+                spos = p + srcOffset;
+                dpos = p + dstOffset;
+            }
+
+            if (std::is_same<S, D>::value)
+            {
+                std::memcpy(dpos, spos, sizeof(S));
+                continue;
+            }
+            S s;
+            D d;
+            std::memcpy(&s, spos, sizeof(S));
+            if (Utils::numericCast(s, d))
+                std::memcpy(dpos, &d, sizeof(D));
+            else
+                m_view.setField(m_dst, idx, s);
+        }
+    }
+};
+
+// Find the storage type of the source dimension and copy its values.
+struct FieldCopySource
+{
+    typedef void result_type;
+
+    PointView& m_view;
+    BasePointTable *m_table;
+    Dimension::Id m_dst;
+    Dimension::Id m_src;
+
+    FieldCopySource(PointView& view, BasePointTable *table,
+            Dimension::Id dst, Dimension::Id src) :
+        m_view(view), m_table(table), m_dst(dst), m_src(src)
+    {}
+
+    template<typename S>
+    void operator()(S)
+    {
+        Dimension::visit(m_view.layout()->dimType(m_dst),
+            FieldCopy<S>(m_view, m_table, m_dst, m_src));
+    }
+};
+
+} // unnamed namespace
+
+std::atomic<int> PointView::m_lastId(0);
 
 PointView::PointView(PointTableRef pointTable) : m_pointTable(pointTable),
-m_size(0), m_id(0)
+m_size(0), m_id(0), m_viewList(pointTable.m_viewList)
 {
 	m_id = ++m_lastId;
+    std::lock_guard<std::mutex> lock(m_viewList->m_mutex);
+    m_viewList->m_views.insert(this);
 }
 
 PointView::PointView(PointTableRef pointTable, const SpatialReference& srs) :
-	m_pointTable(pointTable), m_size(0), m_id(0), m_spatialReference(srs)
+	m_pointTable(pointTable), m_size(0), m_id(0), m_spatialReference(srs),
+    m_viewList(pointTable.m_viewList)
 {
 	m_id = ++m_lastId;
+    std::lock_guard<std::mutex> lock(m_viewList->m_mutex);
+    m_viewList->m_views.insert(this);
 }
 
 
 PointView::~PointView()
-{}
+{
+    std::lock_guard<std::mutex> lock(m_viewList->m_mutex);
+    m_viewList->m_views.erase(this);
+}
 
 
 PointViewIter PointView::begin()
@@ -92,21 +192,50 @@ void PointView::setFieldInternal(Dimension::Id dim, PointId idx,
     }
     else
     {
+        detach();
         rawId = m_index[idx];
     }
     m_pointTable.setFieldInternal(dim, rawId, buf);
 }
 
 
+// The bounds are grown with the extremes of each dimension, which has the
+// same result as growing them with every point.
 void PointView::calculateBounds(BOX2D& output) const
 {
-    pdal::calculateBounds(*this, output);
+    using namespace Dimension;
+
+    DimSummaryList s = summarizeDims(*this, { Id::X, Id::Y });
+    output.grow(BOX2D(s[0].minimum, s[1].minimum, s[0].maximum,
+        s[1].maximum));
 }
 
 
 void PointView::calculateBounds(BOX3D& output) const
 {
-    pdal::calculateBounds(*this, output);
+    using namespace Dimension;
+
+    // With columnar storage of double X/Y/Z the bounds can be computed by
+    // scanning the dimension arrays directly.
+    PointLayoutPtr l = layout();
+    if (m_pointTable.columnData() && l->hasDim(Id::X) && l->hasDim(Id::Y) &&
+        l->hasDim(Id::Z) && l->dimType(Id::X) == Type::Double &&
+        l->dimType(Id::Y) == Type::Double && l->dimType(Id::Z) == Type::Double)
+    {
+        const double *x = m_pointTable.dimensionData<double>(Id::X);
+        const double *y = m_pointTable.dimensionData<double>(Id::Y);
+        const double *z = m_pointTable.dimensionData<double>(Id::Z);
+        for (PointId idx = 0; idx < size(); idx++)
+        {
+            PointId pos = m_index[idx];
+            output.grow(x[pos], y[pos], z[pos]);
+        }
+        return;
+    }
+
+    DimSummaryList s = summarizeDims(*this, { Id::X, Id::Y, Id::Z });
+    output.grow(BOX3D(s[0].minimum, s[1].minimum, s[2].minimum,
+        s[0].maximum, s[1].maximum, s[2].maximum));
 }
 
 
@@ -152,6 +281,47 @@ TriangularMesh *PointView::mesh(const std::string& name)
 }
 
 
+void PointView::reorder(const PointIdList& order)
+{
+    if (order.size() != size())
+        throw pdal_error("Can't reorder a view with a list of " +
+            Utils::toString(order.size()) + " IDs.  The view has " +
+            Utils::toString(size()) + " points.");
+
+    PointIdIndex index;
+    for (PointId id : order)
+        index.push_back(m_index[id]);
+    m_index = std::move(index);
+    clearTemps();
+    invalidateProducts();
+}
+
+
+// Quantized dimensions are stored as integers that aren't the values
+// themselves, so they're copied through getFieldAs() and setField().
+void PointView::copyField(Dimension::Id dst, Dimension::Id src)
+{
+    if (dst == src || !size())
+        return;
+
+    PointLayoutPtr layout = m_pointTable.layout();
+    detach();
+    if (!layout->hasDim(src) || !layout->hasDim(dst) ||
+        layout->dimDetail(src)->quantized() ||
+        layout->dimDetail(dst)->quantized())
+    {
+        for (PointId idx = 0; idx < size(); ++idx)
+            setField(dst, idx, getFieldAs<double>(src, idx));
+        return;
+    }
+
+    BasePointTable *table =
+        m_pointTable.columnData() ? &m_pointTable : nullptr;
+    Dimension::visit(layout->dimType(src),
+        FieldCopySource(*this, table, dst, src));
+}
+
+
 void PointView::invalidateProducts()
 {
     m_index2.reset();
@@ -160,6 +330,92 @@ void PointView::invalidateProducts()
 }
 
 
+void PointView::compact()
+{
+    clearTemps();
+    m_index.truncate(m_size);
+    copyPoints();
+    m_shared.clear();
+}
+
+
+PointViewPtr PointView::makeShared()
+{
+    if (m_shared.empty())
+        m_shared.emplace_back(new int(0));
+
+    PointViewPtr view(makeNew());
+    view->m_index = m_index;
+    view->m_size = m_size;
+    view->m_temps = m_temps;
+    for (auto& m : m_meshes)
+        view->m_meshes[m.first].reset(new TriangularMesh(*m.second));
+    view->m_shared = m_shared;
+    view->chargeMemory();
+    return view;
+}
+
+
+// Temporary points are copied as well, as their index entries follow
+// the points of the view.
+void PointView::unshare()
+{
+    bool shared = false;
+    for (auto& token : m_shared)
+        shared |= (token.use_count() > 1);
+    if (shared)
+        copyPoints();
+    m_shared.clear();
+}
+
+
+// Copy the points of the index to new points of the table and refer to
+// the copies.  Points are copied a dimension at a time so that any table
+// can be used.
+void PointView::copyPoints()
+{
+    PointLayoutPtr layout = m_pointTable.layout();
+    const Dimension::IdList& dims = layout->dims();
+    std::vector<char> buf(layout->pointSize());
+
+    PointIdIndex index;
+    for (PointId i = 0; i < m_index.size(); ++i)
+    {
+        const PointId src = m_index[i];
+        const PointId dst = m_pointTable.addPoint();
+        for (Dimension::Id dim : dims)
+        {
+            m_pointTable.getFieldInternal(dim, src, buf.data());
+            m_pointTable.setFieldInternal(dim, dst, buf.data());
+        }
+        index.push_back(dst);
+    }
+    m_index = std::move(index);
+    chargeMemory();
+}
+
+
+void PointView::shareWith(const PointView& other)
+{
+    for (auto& token : other.m_shared)
+        if (std::find(m_shared.begin(), m_shared.end(), token) ==
+                m_shared.end())
+            m_shared.push_back(token);
+}
+
+
+void PointView::chargeMemory()
+{
+    std::size_t bytes = m_index.memoryUsed();
+    for (auto& m : m_meshes)
+        bytes += m.second->memoryUsed();
+    m_memory.set(bytes);
+}
+
+
+// Trees are shared through the table's cache, so a view whose points have
+// the same positions as another's, such as a copy made by a filter, doesn't
+// rebuild its tree.
 KD3Index& PointView::build3dIndex()
 {
     //ABELL
@@ -168,7 +424,7 @@ KD3Index& PointView::build3dIndex()
     if (!m_index3)
     {
         m_index3.reset(new KD3Index(*this));
-        m_index3->build();
+        m_index3->build(KDTreeCache<3>::get(table()));
     }
     return *m_index3.get();
 }
@@ -182,7 +438,7 @@ KD2Index& PointView::build2dIndex()
     if (!m_index2)
     {
         m_index2.reset(new KD2Index(*this));
-        m_index2->build();
+        m_index2->build(KDTreeCache<2>::get(table()));
     }
     return *m_index2.get();
 }
@@ -36,16 +36,18 @@
 
 #include <pdal/DimDetail.hpp>
 #include <pdal/DimType.hpp>
+#include <pdal/MemoryAccount.hpp>
 #include <pdal/Mesh.hpp>
 #include <pdal/PointContainer.hpp>
+#include <pdal/PointIdIndex.hpp>
 #include <pdal/PointLayout.hpp>
 #include <pdal/PointTable.hpp>
 #include <pdal/PointRef.hpp>
 
+#include <atomic>
 #include <memory>
 #include <queue>
 #include <set>
-#include <deque>
 
 //#pragma warning(disable: 4244)  // conversion from 'type1' to 'type2', possible loss of data
 
@@ -71,6 +73,7 @@ class PDAL_DLL PointView : public PointContainer
 {
     FRIEND_TEST(VoxelTest, center);
     friend class Stage;
+    friend class PointTable;
     friend class plang::Invocation;
     friend class PointIdxRef;
     friend struct PointViewLess;
@@ -99,11 +102,64 @@ public:
         // We use size() instead of the index end because temp points
         // might have been placed at the end of the buffer.
         // We're essentially ditching temp points.
-        auto thisEnd = m_index.begin() + size();
-        auto bufEnd = buf.m_index.begin() + buf.size();
-        m_index.insert(thisEnd, buf.m_index.begin(), bufEnd);
+        m_index.truncate(size());
+        m_index.append(buf.m_index, buf.size());
         m_size += buf.size();
         clearTemps();
+        if (buf.m_shared.size())
+            shareWith(buf);
+    }
+
+    /**
+      Put the points of the view in a new order.
+
+      \param order  IDs of the points of the view in their new order.
+        Each ID of the view must appear once.
+    */
+    void reorder(const PointIdList& order);
+
+    /**
+      Copy the values of one dimension to another for every point of the
+      view.  Values are converted to the type of the destination as with
+      setField().  Values are copied straight from the packed point data
+      or the columns of a ColumnPointTable, examining the dimension types
+      once rather than once per point.
+
+      \param dst  ID of the dimension to which values are copied.
+      \param src  ID of the dimension from which values are copied.
+    */
+    void copyField(Dimension::Id dst, Dimension::Id src);
+
+    /**
+      Copy the points of the view to new points at the end of its table,
+      so that they're stored together, and refer to the copies.  The
+      storage of the original points can then be freed with
+      BasePointTable::releaseUnreferenced() once no other view refers to
+      it.  Points are copied a dimension at a time, so any table can be
+      used, though only some tables free unreferenced storage.
+    */
+    void compact();
+
+    /**
+      Make a view that shares the points of this view.  The views have the
+      same points and meshes, but the points are only copied once a point
+      value is changed through one of the views (copy-on-write), so that
+      pipeline branches can share the output of a stage.
+
+      \return  A new view sharing the points of this view.
+    */
+    PointViewPtr makeShared();
+
+    /**
+      Copy the points of the view if it shares them with another view (see
+      makeShared()), so that changes to point values aren't seen by the
+      other view.  Called before a point value is changed.  Functions that
+      change point values through getPoint() must call this first.
+    */
+    void detach()
+    {
+        if (m_shared.size())
+            unshare();
     }
 
     /// Return a new point view with the same point table as this
@@ -244,6 +300,21 @@ public:
         }
     }
 
+    /// Get the value of a quantized dimension (see
+    /// PointLayout::quantizeDim()) as stored: the integer to which the
+    /// scale and offset are applied.
+    int32_t getQuantized(Dimension::Id dim, PointId idx) const
+    {
+        int32_t i;
+        m_pointTable.getStoredFieldInternal(dim, m_index[idx], &i);
+        return i;
+    }
+
+    /// Get the ID of a point in the underlying point table.  This is the
+    /// index to use with arrays returned by BasePointTable::dimensionData().
+    PointId tableIndex(PointId id) const
+        { return m_index[id]; }
+
     /// Provides access to the memory storing the point data.  Though this
     /// function is public, other access methods are safer and preferred.
     char *getPoint(PointId id)
@@ -295,9 +366,15 @@ public:
     KD3Index& build3dIndex();
     KD2Index& build2dIndex();
 
+    /**
+      Charge the memory used by the view's index and meshes to the active
+      memory account, replacing any earlier charge.  See MemoryAccount.
+    */
+    void chargeMemory();
+
 protected:
     PointTableRef m_pointTable;
-    std::deque<PointId> m_index;
+    PointIdIndex m_index;
     // The index might be larger than the size to support temporary point
     // references.
     point_count_t m_size;
@@ -307,9 +384,19 @@ protected:
     std::map<std::string, std::unique_ptr<TriangularMesh>> m_meshes;
     std::unique_ptr<KD3Index> m_index3;
     std::unique_ptr<KD2Index> m_index2;
+    MemoryCharge m_memory;
+    std::shared_ptr<BasePointTable::ViewList> m_viewList;
+    // Tokens held by the views that share points (see makeShared()).  A
+    // view made from the points of views that share points holds their
+    // tokens too.
+    std::vector<std::shared_ptr<int>> m_shared;
 
 private:
-    static int m_lastId;
+    static std::atomic<int> m_lastId;
+
+    void unshare();
+    void copyPoints();
+    void shareWith(const PointView& other);
 
     template<typename T_IN, typename T_OUT>
     bool convertAndSet(Dimension::Id dim, PointId idx, T_IN in);
@@ -321,13 +408,11 @@ private:
         { m_pointTable.getFieldInternal(dim, m_index[idx], buf); }
     virtual void swapItems(PointId id1, PointId id2)
     {
-        PointId temp = m_index[id2];
-        m_index[id2] = m_index[id1];
-        m_index[id1] = temp;
+        m_index.swap(id1, id2);
     }
     virtual void setItem(PointId dst, PointId src)
     {
-        m_index[dst] = m_index[src];
+        m_index.set(dst, m_index[src]);
     }
 
     template<class T>
@@ -590,6 +675,8 @@ inline void PointView::appendPoint(const PointView& buffer, PointId id)
     m_index.push_back(rawId);
     m_size++;
     assert(m_temps.empty());
+    if (buffer.m_shared.size())
+        shareWith(buffer);
 }
 
 
@@ -601,7 +688,7 @@ inline PointId PointView::getTemp(PointId id)
     {
         newid = m_temps.front();
         m_temps.pop();
-        m_index[newid] = m_index[id];
+        m_index.set(newid, m_index[id]);
     }
     else
     {
@@ -32,6 +32,8 @@
 * OF SUCH DAMAGE.
 ****************************************************************************/
 
+#include <mutex>
+
 #include <pdal/GDALUtils.hpp>
 #include <pdal/Polygon.hpp>
 
@@ -40,9 +42,47 @@
 namespace pdal
 {
 
+// Prepared geometries index the polygon's edges so that repeated
+// intersection and containment tests don't rescan them.
+#if defined(GDAL_VERSION_NUM) && GDAL_VERSION_NUM >= 2030000
+#define PDAL_PREPARED_GEOMETRY
+#endif
+
 struct Polygon::PrivateData
 {
     std::vector<GridPnp> m_grids;
+
+#ifdef PDAL_PREPARED_GEOMETRY
+    ~PrivateData()
+        { reset(); }
+
+    // Create the prepared geometry on first use.  Returns null if GDAL
+    // can't prepare geometries.
+    const OGRPreparedGeometry *prepared(const OGRGeometry *geom)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_isPrepared)
+        {
+            if (OGRHasPreparedGeometrySupport())
+                m_prepared = OGRCreatePreparedGeometry(geom);
+            m_isPrepared = true;
+        }
+        return m_prepared;
+    }
+
+    void reset()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_prepared)
+            OGRDestroyPreparedGeometry(m_prepared);
+        m_prepared = nullptr;
+        m_isPrepared = false;
+    }
+
+    std::mutex m_mutex;
+    bool m_isPrepared = false;
+    OGRPreparedGeometry *m_prepared = nullptr;
+#endif
 };
 
 
@@ -142,6 +182,9 @@ Polygon& Polygon::operator=(const Polygon& src)
 void Polygon::modified()
 {
     m_pd->m_grids.clear();
+#ifdef PDAL_PREPARED_GEOMETRY
+    m_pd->reset();
+#endif
 }
 
 
@@ -262,6 +305,10 @@ bool Polygon::contains(const Polygon& p) const
 {
     throwNoGeos();
 
+#ifdef PDAL_PREPARED_GEOMETRY
+    if (const OGRPreparedGeometry *prep = m_pd->prepared(m_geom.get()))
+        return OGRPreparedGeometryContains(prep, p.m_geom.get());
+#endif
     return m_geom->Contains(p.m_geom.get());
 }
 
@@ -269,6 +316,10 @@ bool Polygon::disjoint(const Polygon& p) const
 {
     throwNoGeos();
 
+#ifdef PDAL_PREPARED_GEOMETRY
+    if (const OGRPreparedGeometry *prep = m_pd->prepared(m_geom.get()))
+        return !OGRPreparedGeometryIntersects(prep, p.m_geom.get());
+#endif
     return m_geom->Disjoint(p.m_geom.get());
 }
 
@@ -276,6 +327,10 @@ bool Polygon::intersects(const Polygon& p) const
 {
     throwNoGeos();
 
+#ifdef PDAL_PREPARED_GEOMETRY
+    if (const OGRPreparedGeometry *prep = m_pd->prepared(m_geom.get()))
+        return OGRPreparedGeometryIntersects(prep, p.m_geom.get());
+#endif
     return m_geom->Intersects(p.m_geom.get());
 }
 
@@ -0,0 +1,200 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/Progress.hpp>
+#include <pdal/PDALUtils.hpp>
+
+#include <nlohmann/json.hpp>
+
+namespace pdal
+{
+
+std::string Progress::Status::toJSON() const
+{
+    NL::json j;
+    j["elapsed"] = m_elapsed;
+    j["points"] = m_points;
+    j["points_per_second"] = m_pointsPerSec;
+    j["bytes"] = m_bytes;
+    if (m_total)
+        j["total"] = m_total;
+    if (m_eta >= 0)
+        j["eta"] = m_eta;
+    j["done"] = m_done;
+    return j.dump();
+}
+
+
+Progress::Progress(double interval, int fd, Callback cb) :
+    m_interval(interval), m_fd(fd), m_cb(cb), m_bytes(0),
+    m_start(Clock::now()), m_lastElapsed(0), m_lastPoints(0),
+    m_running(false)
+{}
+
+
+Progress::~Progress()
+{
+    stop();
+}
+
+
+void Progress::addSource(const Stage *s)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_sources[s];
+}
+
+
+void Progress::setTotal(const Stage *s, point_count_t total)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Source& src = m_sources[s];
+    src.m_total = total;
+    src.m_hasTotal = true;
+}
+
+
+void Progress::add(const Stage *s, point_count_t points, uint64_t bytes)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_sources[s].m_added += points;
+    m_bytes += bytes;
+}
+
+
+void Progress::count(const Stage *s, point_count_t points)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_sources[s].m_counted += points;
+}
+
+
+void Progress::start()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_running)
+        return;
+    m_start = Clock::now();
+    m_lastElapsed = 0;
+    m_lastPoints = 0;
+    m_running = true;
+    m_thread = std::thread(&Progress::reporter, this);
+}
+
+
+void Progress::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_running)
+            return;
+        m_running = false;
+    }
+    m_cv.notify_one();
+    m_thread.join();
+    report(true);
+}
+
+
+Progress::Status Progress::status() const
+{
+    Status status;
+    std::chrono::duration<double> elapsed(Clock::now() - m_start);
+    status.m_elapsed = elapsed.count();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    bool allTotals = !m_sources.empty();
+    for (auto& p : m_sources)
+    {
+        const Source& src = p.second;
+
+        // A reader that reports as it goes may report source points that
+        // don't all make it into the output, so take the larger count.
+        status.m_points += (std::max)(src.m_added, src.m_counted);
+        status.m_total += src.m_total;
+        allTotals = allTotals && src.m_hasTotal;
+    }
+    status.m_bytes = m_bytes;
+    if (!allTotals)
+        status.m_total = 0;
+    if (status.m_points && status.m_total && status.m_elapsed > 0)
+    {
+        point_count_t remaining = status.m_total > status.m_points ?
+            status.m_total - status.m_points : 0;
+        status.m_eta = remaining * status.m_elapsed / status.m_points;
+    }
+    return status;
+}
+
+
+void Progress::report(bool done)
+{
+    Status status = this->status();
+    status.m_done = done;
+    if (done)
+        status.m_eta = 0;
+
+    double interval = status.m_elapsed - m_lastElapsed;
+    if (interval > 0)
+        status.m_pointsPerSec =
+            (status.m_points - m_lastPoints) / interval;
+    if (done && status.m_elapsed > 0)
+        status.m_pointsPerSec = status.m_points / status.m_elapsed;
+    m_lastElapsed = status.m_elapsed;
+    m_lastPoints = status.m_points;
+
+    if (m_cb)
+        m_cb(status);
+    Utils::writeProgress(m_fd, "PROGRESS", status.toJSON());
+}
+
+
+void Progress::reporter()
+{
+    const auto interval = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(m_interval));
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true)
+    {
+        m_cv.wait_for(lock, interval, [this](){ return !m_running; });
+        if (!m_running)
+            break;
+        lock.unlock();
+        report(false);
+        lock.lock();
+    }
+}
+
+} // namespace pdal
@@ -0,0 +1,161 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <pdal/pdal_internal.hpp>
+
+namespace pdal
+{
+
+class Stage;
+
+/**
+  Structured progress of a pipeline execution.  Readers report the points
+  and bytes that they've read and, when known, the number of points that
+  they'll read.  A reporter thread periodically sends the totals, the
+  throughput and an estimate of the time remaining to a callback and/or
+  a progress file descriptor as a "PROGRESS" line of JSON.
+
+  Updates are made per block, batch or node of points, never per point.
+*/
+class PDAL_DLL Progress
+{
+public:
+    struct Status
+    {
+        Status() : m_elapsed(0), m_points(0), m_bytes(0), m_total(0),
+            m_pointsPerSec(0), m_eta(-1), m_done(false)
+        {}
+
+        double m_elapsed;           ///< Seconds since execution started.
+        point_count_t m_points;     ///< Points read.
+        uint64_t m_bytes;           ///< Bytes of point data read.
+        point_count_t m_total;      ///< Points to be read, 0 if unknown.
+        double m_pointsPerSec;      ///< Rate since the previous report.
+        double m_eta;               ///< Seconds remaining, -1 if unknown.
+        bool m_done;                ///< Whether execution has finished.
+
+        std::string toJSON() const;
+    };
+    typedef std::function<void(const Status&)> Callback;
+
+    /**
+      \param interval  Seconds between reports.
+      \param fd  Descriptor to which reports are written, or -1.
+      \param cb  Function called with each report, may be empty.
+    */
+    Progress(double interval, int fd, Callback cb);
+    ~Progress();
+
+    /**
+      Register a reader whose points are counted.  An ETA is only
+      estimated once every registered reader has set its total.
+    */
+    void addSource(const Stage *s);
+
+    /**
+      Set the number of points that a reader expects to read.
+    */
+    void setTotal(const Stage *s, point_count_t total);
+
+    /**
+      Add points and bytes that a reader has read.
+    */
+    void add(const Stage *s, point_count_t points, uint64_t bytes = 0);
+
+    /**
+      Count the points of a completed read or stream batch.  Points that
+      the reader has already reported with add() aren't counted twice.
+    */
+    void count(const Stage *s, point_count_t points);
+
+    /**
+      Start the reporter thread.
+    */
+    void start();
+
+    /**
+      Stop the reporter thread and send a final report.
+    */
+    void stop();
+
+    /**
+      Get the current status.
+    */
+    Status status() const;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Source
+    {
+        Source() : m_added(0), m_counted(0), m_total(0), m_hasTotal(false)
+        {}
+
+        point_count_t m_added;
+        point_count_t m_counted;
+        point_count_t m_total;
+        bool m_hasTotal;
+    };
+
+    void report(bool done);
+    void reporter();
+
+    double m_interval;
+    int m_fd;
+    Callback m_cb;
+    std::map<const Stage *, Source> m_sources;
+    uint64_t m_bytes;
+    Clock::time_point m_start;
+    double m_lastElapsed;
+    point_count_t m_lastPoints;
+    bool m_running;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::thread m_thread;
+
+    Progress(const Progress&) = delete;
+    Progress& operator=(const Progress&) = delete;
+};
+
+} // namespace pdal
@@ -32,12 +32,15 @@
 * OF SUCH DAMAGE.
 ****************************************************************************/
 
+#include <algorithm>
 #include <limits>
 #include <cmath>
 #include <memory>
 
+#include <pdal/DimAccessor.hpp>
 #include <pdal/PointView.hpp>
 #include <pdal/QuadIndex.hpp>
+#include <pdal/util/TaskScheduler.hpp>
 #include <pdal/util/Utils.hpp>
 
 namespace
@@ -106,36 +109,149 @@ namespace
         BBox& operator=(const BBox&); // not implemented
     };
 
+    // Number of children of a quadtree node with the given quadrant mask.
+    int childCount(uint8_t mask)
+    {
+        int count = 0;
+        for (; mask; mask >>= 1)
+            count += (mask & 1);
+        return count;
+    }
+
 } // anonymous namespace
 
 namespace pdal
 {
 
-// Recursive quadtree implementation.
-struct Tree
+// The quadtree is stored in flat arrays.  Each node holds the point closest
+// to the center of its box, and the remaining points of the box are divided
+// among the node's quadrants.  Building the tree partitions the points by
+// quadrant at each level, which leaves them sorted in Morton order, with the
+// points of each subtree contiguous.  The children of a node are stored
+// contiguously, in the order nw, ne, se, sw, so a node only records its
+// first child and which quadrants are present.  Boxes aren't stored;
+// they're computed while descending the tree.
+struct QuadIndex::QImpl
 {
-    Tree(BBox bbox, const QuadPointRef* data = 0)
-        : bbox(bbox)
-        , data(data)
-        , nw()
-        , ne()
-        , se()
-        , sw()
-    { }
+    QImpl(const PointView& view, std::size_t topLevel);
+    QImpl(
+            const PointView& view,
+            double xMin,
+            double yMin,
+            double xMax,
+            double yMax,
+            std::size_t topLevel);
+    QImpl(
+            const std::vector<std::shared_ptr<QuadPointRef> >& points,
+            double xMin,
+            double yMin,
+            double xMax,
+            double yMax,
+            std::size_t topLevel);
 
-    void getFills(std::vector<std::size_t>& fills, std::size_t level = 0) const;
+    void getBounds(
+            double& xMin,
+            double& yMin,
+            double& xMax,
+            double& yMax) const;
+
+    std::size_t getDepth() const;
 
-    // Returns depth resulting from the insertion of this point.
-    std::size_t addPoint(const QuadPointRef* toAdd, std::size_t curDepth = 0);
+    std::vector<std::size_t> getFills();
+
+    PointIdList getPoints(
+            std::size_t depthBegin,
+            std::size_t depthEnd) const;
+
+    PointIdList getPoints(
+            std::size_t rasterize,
+            double& xBegin,
+            double& xEnd,
+            double& xStep,
+            double& yBegin,
+            double& yEnd,
+            double& yStep) const;
+
+    PointIdList getPoints(
+            double xBegin,
+            double xEnd,
+            double xStep,
+            double yBegin,
+            double yEnd,
+            double yStep) const;
+
+    PointIdList getPoints(
+            double xMin,
+            double yMin,
+            double xMax,
+            double yMax,
+            std::size_t depthBegin,
+            std::size_t depthEnd) const;
+
+private:
+    enum Quadrant
+    {
+        Nw,
+        Ne,
+        Se,
+        Sw
+    };
+
+    struct Pt
+    {
+        double x;
+        double y;
+        PointId pbIndex;
+        // Order in which the point reaches the node being built.
+        std::size_t seq;
+    };
+
+    struct Node
+    {
+        std::size_t point;
+        std::size_t firstChild;
+        uint8_t mask;
+    };
+    typedef std::vector<Node> NodeList;
+
+    // A subtree whose construction was deferred so that it can be built
+    // on another thread.
+    struct Subtree
+    {
+        Subtree(std::size_t slot, std::size_t begin, std::size_t end,
+                const BBox& bbox, std::size_t depth)
+            : slot(slot), begin(begin), end(end), bbox(bbox), depth(depth),
+              maxDepth(0)
+        {}
+
+        std::size_t slot;
+        std::size_t begin;
+        std::size_t end;
+        BBox bbox;
+        std::size_t depth;
+        NodeList nodes;
+        std::size_t maxDepth;
+    };
+
+    void build();
+    void divide(NodeList& nodes, std::size_t slot, std::size_t begin,
+            std::size_t end, const BBox& bbox, std::size_t depth,
+            std::size_t& maxDepth, std::vector<Subtree> *deferred,
+            std::size_t deferDepth);
+    static BBox childBox(const BBox& bbox, int quadrant);
+    static int quadrant(const BBox& bbox, const Pt& p);
 
     void getPoints(
             PointIdList& results,
+            std::size_t node,
             std::size_t depthBegin,
             std::size_t depthEnd,
             std::size_t curDepth) const;
 
     void getPoints(
             PointIdList& results,
+            std::size_t node,
+            const BBox& bbox,
             std::size_t rasterize,
             double xBegin,
             double xEnd,
@@ -147,6 +263,8 @@ struct Tree
 
     void getPoints(
             PointIdList& results,
+            std::size_t node,
+            const BBox& bbox,
             double xBegin,
             double xEnd,
             double xStep,
@@ -156,155 +274,300 @@ struct Tree
 
     void getPoints(
             PointIdList& results,
+            std::size_t node,
+            const BBox& bbox,
             const BBox& query,
             std::size_t depthBegin,
             std::size_t depthEnd,
             std::size_t curDepth) const;
 
-    const BBox bbox;
-    const QuadPointRef* data;
+    void readView(const PointView& view);
 
-    std::unique_ptr<Tree> nw;
-    std::unique_ptr<Tree> ne;
-    std::unique_ptr<Tree> se;
-    std::unique_ptr<Tree> sw;
+    std::size_t m_topLevel;
+    std::vector<Pt> m_points;
+    NodeList m_nodes;
+    std::unique_ptr<BBox> m_bbox;
+    std::size_t m_depth;
+    std::vector<std::size_t> m_fills;
 };
 
-std::size_t Tree::addPoint(const QuadPointRef* toAdd, const std::size_t curDepth)
+QuadIndex::QImpl::QImpl(const PointView& view, std::size_t topLevel)
+    : m_topLevel(topLevel)
+    , m_depth(0)
 {
-    if (data)
+    readView(view);
+
+    double xMin((std::numeric_limits<double>::max)());
+    double yMin((std::numeric_limits<double>::max)());
+    double xMax((std::numeric_limits<double>::min)());
+    double yMax((std::numeric_limits<double>::min)());
+
+    for (const Pt& p : m_points)
     {
-        const Point& center(bbox.center);
+        if (p.x < xMin) xMin = p.x;
+        if (p.x > xMax) xMax = p.x;
+        if (p.y < yMin) yMin = p.y;
+        if (p.y > yMax) yMax = p.y;
+    }
 
-        if (toAdd->point.sqDist(center) < data->point.sqDist(center))
-        {
-            std::swap(data, toAdd);
-        }
+    m_bbox.reset(new BBox(Point(xMin, yMin), Point(xMax, yMax)));
+    build();
+}
+
+QuadIndex::QImpl::QImpl(
+        const PointView& view,
+        double xMin,
+        double yMin,
+        double xMax,
+        double yMax,
+        std::size_t topLevel)
+    : m_topLevel(topLevel)
+    , m_depth(0)
+{
+    readView(view);
+    m_bbox.reset(new BBox(Point(xMin, yMin), Point(xMax, yMax)));
+    build();
+}
 
-        const std::size_t nextDepth(curDepth + 1);
+QuadIndex::QImpl::QImpl(
+        const std::vector<std::shared_ptr<QuadPointRef> >& points,
+        double xMin,
+        double yMin,
+        double xMax,
+        double yMax,
+        std::size_t topLevel)
+    : m_topLevel(topLevel)
+    , m_depth(0)
+{
+    m_points.resize(points.size());
+    for (std::size_t i = 0; i < points.size(); ++i)
+    {
+        const QuadPointRef& ref(*points[i]);
+        m_points[i] = Pt { ref.point.x, ref.point.y, ref.pbIndex, i };
+    }
+    m_bbox.reset(new BBox(Point(xMin, yMin), Point(xMax, yMax)));
+    build();
+}
 
-        if (toAdd->point.x < center.x)
+void QuadIndex::QImpl::readView(const PointView& view)
+{
+    m_points.resize(view.size());
+    for (std::size_t i = 0; i < m_points.size(); ++i)
+        m_points[i].pbIndex = m_points[i].seq = i;
+    DimAccessor<double>(view, Dimension::Id::X).forEach(
+        [this](PointId idx, double d){ m_points[idx].x = d; });
+    DimAccessor<double>(view, Dimension::Id::Y).forEach(
+        [this](PointId idx, double d){ m_points[idx].y = d; });
+}
+
+BBox QuadIndex::QImpl::childBox(const BBox& bbox, int quadrant)
+{
+    const Point& center(bbox.center);
+
+    switch (quadrant)
+    {
+    case Nw:
+        return BBox(Point(bbox.minimum.x, center.y),
+            Point(center.x, bbox.maximum.y));
+    case Ne:
+        return BBox(Point(center.x, center.y),
+            Point(bbox.maximum.x, bbox.maximum.y));
+    case Se:
+        return BBox(Point(center.x, bbox.minimum.y),
+            Point(bbox.maximum.x, center.y));
+    default:
+        return BBox(Point(bbox.minimum.x, bbox.minimum.y),
+            Point(center.x, center.y));
+    }
+}
+
+int QuadIndex::QImpl::quadrant(const BBox& bbox, const Pt& p)
+{
+    if (p.x < bbox.center.x)
+        return (p.y < bbox.center.y) ? Sw : Nw;
+    return (p.y < bbox.center.y) ? Se : Ne;
+}
+
+// Build the node for the points in [begin, end), which is stored at 'slot',
+// and then its children.  Subtrees at deferDepth are recorded in 'deferred'
+// rather than built, if it's provided.
+void QuadIndex::QImpl::divide(NodeList& nodes, std::size_t slot,
+        std::size_t begin, std::size_t end, const BBox& bbox,
+        std::size_t depth, std::size_t& maxDepth,
+        std::vector<Subtree> *deferred, std::size_t deferDepth)
+{
+    maxDepth = (std::max)(maxDepth, depth);
+
+    // The points of the range are in the order they reach the node.  The
+    // node keeps the point closest to the center, the earliest to arrive
+    // of any that are equally close.  The other points move on to the
+    // node's children, either on arrival or when a closer point displaces
+    // them, which sets the order they reach the children.
+    const Point& center(bbox.center);
+    std::size_t best = begin;
+    double bestDist = Point(m_points[begin].x, m_points[begin].y).sqDist(
+        center);
+    for (std::size_t i = begin + 1; i < end; ++i)
+    {
+        Pt& p(m_points[i]);
+        double dist = Point(p.x, p.y).sqDist(center);
+        if (dist < bestDist)
         {
-            if (toAdd->point.y < center.y)
-            {
-                if (sw)
-                {
-                    return sw->addPoint(toAdd, nextDepth);
-                }
-                else
-                {
-                    sw.reset(new Tree(
-                            BBox(
-                                Point(bbox.minimum.x, bbox.minimum.y),
-                                Point(center.x, center.y)),
-                            toAdd));
-
-                    return nextDepth;
-                }
-            }
-            else
-            {
-                if (nw)
-                {
-                    return nw->addPoint(toAdd, nextDepth);
-                }
-                else
-                {
-                    nw.reset(new Tree(
-                            BBox(
-                                Point(bbox.minimum.x, center.y),
-                                Point(center.x, bbox.maximum.y)),
-                            toAdd));
-
-                    return nextDepth;
-                }
-            }
+            m_points[best].seq = p.seq;
+            best = i;
+            bestDist = dist;
         }
+    }
+    std::swap(m_points[begin], m_points[best]);
+
+    // Partition the rest of the points by quadrant.
+    std::size_t bounds[5];
+    bounds[0] = begin + 1;
+    for (int q = 0; q < 4; ++q)
+    {
+        auto it = std::partition(m_points.begin() + bounds[q],
+            m_points.begin() + end,
+            [&bbox, q](const Pt& p){ return quadrant(bbox, p) == q; });
+        bounds[q + 1] = it - m_points.begin();
+        std::sort(m_points.begin() + bounds[q], it,
+            [](const Pt& a, const Pt& b){ return a.seq < b.seq; });
+    }
+
+    uint8_t mask = 0;
+    for (int q = 0; q < 4; ++q)
+        if (bounds[q + 1] > bounds[q])
+            mask |= (1 << q);
+
+    std::size_t child = nodes.size();
+    nodes[slot] = Node { begin, child, mask };
+    nodes.resize(child + childCount(mask));
+    for (int q = 0; q < 4; ++q)
+    {
+        if (bounds[q + 1] == bounds[q])
+            continue;
+
+        const BBox box(childBox(bbox, q));
+        if (deferred && depth + 1 == deferDepth)
+            deferred->emplace_back(child, bounds[q], bounds[q + 1], box,
+                depth + 1);
         else
-        {
-            if (toAdd->point.y < center.y)
-            {
-                if (se)
-                {
-                    return se->addPoint(toAdd, nextDepth);
-                }
-                else
-                {
-                    se.reset(new Tree(
-                            BBox(
-                                Point(center.x, bbox.minimum.y),
-                                Point(bbox.maximum.x, center.y)),
-                            toAdd));
-
-                    return nextDepth;
-                }
-            }
-            else
+            divide(nodes, child, bounds[q], bounds[q + 1], box, depth + 1,
+                maxDepth, deferred, deferDepth);
+        child++;
+    }
+}
+
+// The first levels of the tree are built on this thread.  The subtrees
+// below them are built in parallel, each into its own node list, and then
+// appended to the tree.
+void QuadIndex::QImpl::build()
+{
+    if (m_points.empty())
+        return;
+
+    const std::size_t numThreads =
+        (m_points.size() < 100000) ? 1 :
+        TaskScheduler::instance().concurrency();
+    std::size_t deferDepth = 0;
+    while (numThreads > 1 && deferDepth < 4 &&
+            ((std::size_t)1 << (2 * deferDepth)) < numThreads * 2)
+        deferDepth++;
+
+    std::vector<Subtree> deferred;
+    m_nodes.resize(1);
+    divide(m_nodes, 0, 0, m_points.size(), *m_bbox, 0, m_depth,
+        deferDepth ? &deferred : nullptr, deferDepth);
+
+    if (deferred.size())
+    {
+        parallelFor(deferred.size(), numThreads, [this, &deferred](size_t i)
             {
-                if (ne)
-                {
-                    return ne->addPoint(toAdd, nextDepth);
-                }
-                else
-                {
-                    ne.reset(new Tree(
-                            BBox(
-                                Point(center.x, center.y),
-                                Point(bbox.maximum.x, bbox.maximum.y)),
-                            toAdd));
-
-                    return nextDepth;
-                }
-            }
-        }
+                Subtree& t = deferred[i];
+                t.nodes.resize(1);
+                divide(t.nodes, 0, t.begin, t.end, t.bbox, t.depth,
+                    t.maxDepth, nullptr, 0);
+            });
     }
-    else
+
+    // Local node j > 0 of a subtree goes to base + j - 1.
+    for (Subtree& t : deferred)
     {
-        data = toAdd;
-        return curDepth;
+        const std::size_t base = m_nodes.size();
+        for (Node& n : t.nodes)
+            n.firstChild = base + n.firstChild - 1;
+        m_nodes[t.slot] = t.nodes[0];
+        m_nodes.insert(m_nodes.end(), t.nodes.begin() + 1, t.nodes.end());
+        m_depth = (std::max)(m_depth, t.maxDepth);
+        NodeList().swap(t.nodes);
     }
 }
 
-// Fills are a count of the number of points at each level of the quad tree.
-void Tree::getFills(std::vector<std::size_t>& fills, std::size_t level) const
+void QuadIndex::QImpl::getBounds(
+        double& xMin,
+        double& yMin,
+        double& xMax,
+        double& yMax) const
 {
-    if (data)
+    if (m_bbox)
     {
-        if (level >= fills.size())
-            fills.resize(level + 1);
-        (fills[level])++;
+        xMin = m_bbox->minimum.x;
+        yMin = m_bbox->minimum.y;
+        xMax = m_bbox->maximum.x;
+        yMax = m_bbox->maximum.y;
     }
+}
 
-    ++level;
-    if (nw) nw->getFills(fills, level);
-    if (ne) ne->getFills(fills, level);
-    if (sw) sw->getFills(fills, level);
-    if (se) se->getFills(fills, level);
+std::size_t QuadIndex::QImpl::getDepth() const
+{
+    return m_depth;
 }
 
+// Fills are a count of the number of points at each level of the quad tree.
+std::vector<std::size_t> QuadIndex::QImpl::getFills()
+{
+    if (m_nodes.size() && !m_fills.size())
+    {
+        std::vector<std::pair<std::size_t, std::size_t>> stack;
+        stack.emplace_back(0, 0);
+        while (stack.size())
+        {
+            const std::size_t node = stack.back().first;
+            const std::size_t level = stack.back().second;
+            stack.pop_back();
+
+            if (level >= m_fills.size())
+                m_fills.resize(level + 1);
+            (m_fills[level])++;
+            const Node& n(m_nodes[node]);
+            for (int c = 0; c < childCount(n.mask); ++c)
+                stack.emplace_back(n.firstChild + c, level + 1);
+        }
+    }
+
+    return m_fills;
+}
 
-void Tree::getPoints(
+void QuadIndex::QImpl::getPoints(
         PointIdList& results,
+        const std::size_t node,
         const std::size_t depthBegin,
         const std::size_t depthEnd,
         std::size_t curDepth) const
 {
-    if (data && curDepth >= depthBegin)
-    {
-        results.push_back(data->pbIndex);
-    }
+    const Node& n(m_nodes[node]);
+    if (curDepth >= depthBegin)
+        results.push_back(m_points[n.point].pbIndex);
 
     if (++curDepth < depthEnd || depthEnd == 0)
-    {
-        if (nw) nw->getPoints(results, depthBegin, depthEnd, curDepth);
-        if (ne) ne->getPoints(results, depthBegin, depthEnd, curDepth);
-        if (se) se->getPoints(results, depthBegin, depthEnd, curDepth);
-        if (sw) sw->getPoints(results, depthBegin, depthEnd, curDepth);
-    }
+        for (int c = 0; c < childCount(n.mask); ++c)
+            getPoints(results, n.firstChild + c, depthBegin, depthEnd,
+                curDepth);
 }
 
-void Tree::getPoints(
+void QuadIndex::QImpl::getPoints(
         PointIdList& results,
+        const std::size_t node,
+        const BBox& bbox,
         const std::size_t rasterize,
         const double xBegin,
         const double xEnd,
@@ -314,71 +577,33 @@ void Tree::getPoints(
         const double yStep,
         std::size_t curDepth) const
 {
+    const Node& n(m_nodes[node]);
     if (curDepth == rasterize)
     {
-        if (data)
-        {
-            double xOffset(Utils::sround((bbox.center.x - xBegin) / xStep));
-            double yOffset(Utils::sround((bbox.center.y - yBegin) / yStep));
+        double xOffset(Utils::sround((bbox.center.x - xBegin) / xStep));
+        double yOffset(Utils::sround((bbox.center.y - yBegin) / yStep));
 
-            const std::size_t index(
-                static_cast<size_t>(
-                    Utils::sround(yOffset * (xEnd - xBegin) / xStep +
-                        xOffset)));
+        const std::size_t index(
+            static_cast<size_t>(
+                Utils::sround(yOffset * (xEnd - xBegin) / xStep +
+                    xOffset)));
 
-            results.at(index) = data->pbIndex;
-        }
+        results.at(index) = m_points[n.point].pbIndex;
     }
     else if (++curDepth <= rasterize)
     {
-        if (nw) nw->getPoints(
-                results,
-                rasterize,
-                xBegin,
-                xEnd,
-                xStep,
-                yBegin,
-                yEnd,
-                yStep,
-                curDepth);
-
-        if (ne) ne->getPoints(
-                results,
-                rasterize,
-                xBegin,
-                xEnd,
-                xStep,
-                yBegin,
-                yEnd,
-                yStep,
-                curDepth);
-
-        if (se) se->getPoints(
-                results,
-                rasterize,
-                xBegin,
-                xEnd,
-                xStep,
-                yBegin,
-                yEnd,
-                yStep,
-                curDepth);
-
-        if (sw) sw->getPoints(
-                results,
-                rasterize,
-                xBegin,
-                xEnd,
-                xStep,
-                yBegin,
-                yEnd,
-                yStep,
-                curDepth);
+        std::size_t child = n.firstChild;
+        for (int q = 0; q < 4; ++q)
+            if (n.mask & (1 << q))
+                getPoints(results, child++, childBox(bbox, q), rasterize,
+                    xBegin, xEnd, xStep, yBegin, yEnd, yStep, curDepth);
     }
 }
 
-void Tree::getPoints(
+void QuadIndex::QImpl::getPoints(
         PointIdList& results,
+        const std::size_t node,
+        const BBox& bbox,
         const double xBegin,
         const double xEnd,
         const double xStep,
@@ -391,52 +616,23 @@ void Tree::getPoints(
         return;
     }
 
-    if (nw) nw->getPoints(
-            results,
-            xBegin,
-            xEnd,
-            xStep,
-            yBegin,
-            yEnd,
-            yStep);
-
-    if (ne) ne->getPoints(
-            results,
-            xBegin,
-            xEnd,
-            xStep,
-            yBegin,
-            yEnd,
-            yStep);
-
-    if (se) se->getPoints(
-            results,
-            xBegin,
-            xEnd,
-            xStep,
-            yBegin,
-            yEnd,
-            yStep);
-
-    if (sw) sw->getPoints(
-            results,
-            xBegin,
-            xEnd,
-            xStep,
-            yBegin,
-            yEnd,
-            yStep);
+    const Node& n(m_nodes[node]);
+    std::size_t child = n.firstChild;
+    for (int q = 0; q < 4; ++q)
+        if (n.mask & (1 << q))
+            getPoints(results, child++, childBox(bbox, q), xBegin, xEnd,
+                xStep, yBegin, yEnd, yStep);
 
     // Add data after calling child nodes so we prefer upper levels of the tree.
+    const Pt& p(m_points[n.point]);
     if (
-            data &&
-            data->point.x >= xBegin &&
-            data->point.y >= yBegin &&
-            data->point.x < xEnd - xStep &&
-            data->point.y < yEnd - yStep)
+            p.x >= xBegin &&
+            p.y >= yBegin &&
+            p.x < xEnd - xStep &&
+            p.y < yEnd - yStep)
     {
-        double xOffset(Utils::sround((data->point.x - xBegin) / xStep));
-        double yOffset(Utils::sround((data->point.y - yBegin) / yStep));
+        double xOffset(Utils::sround((p.x - xBegin) / xStep));
+        double yOffset(Utils::sround((p.y - yBegin) / yStep));
 
         std::size_t index(
             static_cast<size_t>(
@@ -444,13 +640,15 @@ void Tree::getPoints(
 
         if (index < results.size())
         {
-            results.at(index) = data->pbIndex;
+            results.at(index) = p.pbIndex;
         }
     }
 }
 
-void Tree::getPoints(
+void QuadIndex::QImpl::getPoints(
         PointIdList& results,
+        const std::size_t node,
+        const BBox& bbox,
         const BBox& query,
         const std::size_t depthBegin,
         const std::size_t depthEnd,
@@ -461,219 +659,34 @@ void Tree::getPoints(
         return;
     }
 
-    if (data &&
-        query.contains(data->point) &&
+    const Node& n(m_nodes[node]);
+    const Pt& p(m_points[n.point]);
+    if (query.contains(Point(p.x, p.y)) &&
         curDepth >= depthBegin &&
         (curDepth < depthEnd || depthEnd == 0))
     {
-        results.push_back(data->pbIndex);
+        results.push_back(p.pbIndex);
     }
 
     if (++curDepth < depthEnd || depthEnd == 0)
     {
-        if (nw) nw->getPoints(results, query, depthBegin, depthEnd, curDepth);
-        if (ne) ne->getPoints(results, query, depthBegin, depthEnd, curDepth);
-        if (se) se->getPoints(results, query, depthBegin, depthEnd, curDepth);
-        if (sw) sw->getPoints(results, query, depthBegin, depthEnd, curDepth);
+        std::size_t child = n.firstChild;
+        for (int q = 0; q < 4; ++q)
+            if (n.mask & (1 << q))
+                getPoints(results, child++, childBox(bbox, q), query,
+                    depthBegin, depthEnd, curDepth);
     }
 }
 
-struct QuadIndex::QImpl
-{
-    QImpl(const PointView& view, std::size_t topLevel);
-    QImpl(
-            const PointView& view,
-            double xMin,
-            double yMin,
-            double xMax,
-            double yMax,
-            std::size_t topLevel);
-    QImpl(
-            const std::vector<std::shared_ptr<QuadPointRef> >& points,
-            double xMin,
-            double yMin,
-            double xMax,
-            double yMax,
-            std::size_t topLevel);
-
-    void getBounds(
-            double& xMin,
-            double& yMin,
-            double& xMax,
-            double& yMax) const;
-
-    std::size_t getDepth() const;
-
-    std::vector<std::size_t> getFills();
-
-    PointIdList getPoints(
-            std::size_t depthBegin,
-            std::size_t depthEnd) const;
-
-    PointIdList getPoints(
-            std::size_t rasterize,
-            double& xBegin,
-            double& xEnd,
-            double& xStep,
-            double& yBegin,
-            double& yEnd,
-            double& yStep) const;
-
-    PointIdList getPoints(
-            double xBegin,
-            double xEnd,
-            double xStep,
-            double yBegin,
-            double yEnd,
-            double yStep) const;
-
-    PointIdList getPoints(
-            double xMin,
-            double yMin,
-            double xMax,
-            double yMax,
-            std::size_t depthBegin,
-            std::size_t depthEnd) const;
-
-    std::size_t m_topLevel;
-    std::vector<std::shared_ptr<QuadPointRef> > m_pointRefVec;
-    std::unique_ptr<Tree> m_tree;
-    std::size_t m_depth;
-    std::vector<std::size_t> m_fills;
-};
-
-QuadIndex::QImpl::QImpl(const PointView& view, std::size_t topLevel)
-    : m_topLevel(topLevel)
-    , m_pointRefVec()
-    , m_tree()
-    , m_depth(0)
-    , m_fills()
-{
-    m_pointRefVec.resize(view.size());
-
-    double xMin((std::numeric_limits<double>::max)());
-    double yMin((std::numeric_limits<double>::max)());
-    double xMax((std::numeric_limits<double>::min)());
-    double yMax((std::numeric_limits<double>::min)());
-
-    for (PointId i(0); i < view.size(); ++i)
-    {
-        m_pointRefVec[i].reset(
-                new QuadPointRef(
-                    Point(
-                        view.getFieldAs<double>(Dimension::Id::X, i),
-                        view.getFieldAs<double>(Dimension::Id::Y, i)),
-                i));
-
-        const QuadPointRef* pointRef(m_pointRefVec[i].get());
-        if (pointRef->point.x < xMin) xMin = pointRef->point.x;
-        if (pointRef->point.x > xMax) xMax = pointRef->point.x;
-        if (pointRef->point.y < yMin) yMin = pointRef->point.y;
-        if (pointRef->point.y > yMax) yMax = pointRef->point.y;
-    }
-
-    m_tree.reset(new Tree(BBox(Point(xMin, yMin), Point(xMax, yMax))));
-
-    for (std::size_t i = 0; i < m_pointRefVec.size(); ++i)
-    {
-        m_depth = (std::max)(m_tree->addPoint(m_pointRefVec[i].get()), m_depth);
-    }
-}
-
-QuadIndex::QImpl::QImpl(
-        const PointView& view,
-        double xMin,
-        double yMin,
-        double xMax,
-        double yMax,
-        std::size_t topLevel)
-    : m_topLevel(topLevel)
-    , m_pointRefVec()
-    , m_tree()
-    , m_depth(0)
-    , m_fills()
-{
-    m_pointRefVec.resize(view.size());
-
-    for (PointId i(0); i < view.size(); ++i)
-    {
-        m_pointRefVec[i].reset(
-                new QuadPointRef(
-                    Point(
-                        view.getFieldAs<double>(Dimension::Id::X, i),
-                        view.getFieldAs<double>(Dimension::Id::Y, i)),
-                i));
-    }
-
-    m_tree.reset(new Tree(BBox(Point(xMin, yMin), Point(xMax, yMax))));
-
-    for (std::size_t i = 0; i < m_pointRefVec.size(); ++i)
-    {
-        m_depth = (std::max)(m_tree->addPoint(m_pointRefVec[i].get()), m_depth);
-    }
-}
-
-QuadIndex::QImpl::QImpl(
-        const std::vector<std::shared_ptr<QuadPointRef> >& points,
-        double xMin,
-        double yMin,
-        double xMax,
-        double yMax,
-        std::size_t topLevel)
-    : m_topLevel(topLevel)
-    , m_pointRefVec(points.size())
-    , m_tree()
-    , m_depth(0)
-    , m_fills()
-{
-    m_tree.reset(new Tree(BBox(Point(xMin, yMin), Point(xMax, yMax))));
-
-    for (std::size_t i = 0; i < points.size(); ++i)
-    {
-        m_pointRefVec[i] = points[i];
-        m_depth = (std::max)(m_tree->addPoint(m_pointRefVec[i].get()), m_depth);
-    }
-}
-
-void QuadIndex::QImpl::getBounds(
-        double& xMin,
-        double& yMin,
-        double& xMax,
-        double& yMax) const
-{
-    if (m_tree)
-    {
-        xMin = m_tree->bbox.minimum.x;
-        yMin = m_tree->bbox.minimum.y;
-        xMax = m_tree->bbox.maximum.x;
-        yMax = m_tree->bbox.maximum.y;
-    }
-}
-
-std::size_t QuadIndex::QImpl::getDepth() const
-{
-    return m_depth;
-}
-
-std::vector<std::size_t> QuadIndex::QImpl::getFills()
-{
-    if (m_tree && !m_fills.size())
-    {
-        m_tree->getFills(m_fills);
-    }
-
-    return m_fills;
-}
-
 PointIdList QuadIndex::QImpl::getPoints(
         const std::size_t minDepth,
         const std::size_t maxDepth) const
 {
     PointIdList results;
 
-    if (m_tree)
+    if (m_nodes.size())
     {
-        m_tree->getPoints(results, minDepth, maxDepth, m_topLevel);
+        getPoints(results, 0, minDepth, maxDepth, m_topLevel);
     }
 
     return results;
@@ -690,32 +703,35 @@ PointIdList QuadIndex::QImpl::getPoints(
 {
     PointIdList results;
 
-    if (m_tree)
+    if (m_bbox)
     {
         const size_t exp(static_cast<size_t>(std::pow(2, rasterize)));
-        const double xWidth(m_tree->bbox.maximum.x - m_tree->bbox.minimum.x);
-        const double yWidth(m_tree->bbox.maximum.y - m_tree->bbox.minimum.y);
+        const double xWidth(m_bbox->maximum.x - m_bbox->minimum.x);
+        const double yWidth(m_bbox->maximum.y - m_bbox->minimum.y);
 
         xStep = xWidth / exp;
         yStep = yWidth / exp;
-        xBegin =    m_tree->bbox.minimum.x + (xStep / 2);
-        yBegin =    m_tree->bbox.minimum.y + (yStep / 2);
+        xBegin =    m_bbox->minimum.x + (xStep / 2);
+        yBegin =    m_bbox->minimum.y + (yStep / 2);
         // One tick past the end.
-        xEnd =      m_tree->bbox.maximum.x + (xStep / 2);
-        yEnd =      m_tree->bbox.maximum.y + (yStep / 2);
+        xEnd =      m_bbox->maximum.x + (xStep / 2);
+        yEnd =      m_bbox->maximum.y + (yStep / 2);
 
         results.resize(exp * exp, (std::numeric_limits<PointId>::max)());
 
-        m_tree->getPoints(
-                results,
-                rasterize,
-                xBegin,
-                xEnd,
-                xStep,
-                yBegin,
-                yEnd,
-                yStep,
-                m_topLevel);
+        if (m_nodes.size())
+            getPoints(
+                    results,
+                    0,
+                    *m_bbox,
+                    rasterize,
+                    xBegin,
+                    xEnd,
+                    xStep,
+                    yBegin,
+                    yEnd,
+                    yStep,
+                    m_topLevel);
     }
 
     return results;
@@ -731,7 +747,7 @@ PointIdList QuadIndex::QImpl::getPoints(
 {
     PointIdList results;
 
-    if (m_tree)
+    if (m_bbox)
     {
         size_t width(
             static_cast<size_t>(Utils::sround((xEnd - xBegin) / xStep)));
@@ -739,14 +755,17 @@ PointIdList QuadIndex::QImpl::getPoints(
             static_cast<size_t>(Utils::sround((yEnd - yBegin) / yStep)));
         results.resize(width * height, (std::numeric_limits<PointId>::max)());
 
-        m_tree->getPoints(
-                results,
-                xBegin,
-                xEnd,
-                xStep,
-                yBegin,
-                yEnd,
-                yStep);
+        if (m_nodes.size())
+            getPoints(
+                    results,
+                    0,
+                    *m_bbox,
+                    xBegin,
+                    xEnd,
+                    xStep,
+                    yBegin,
+                    yEnd,
+                    yStep);
     }
 
     return results;
@@ -763,10 +782,12 @@ PointIdList QuadIndex::QImpl::getPoints(
     PointIdList results;
 
     // Making BBox from external parameters here, so do some light validation.
-    if (m_tree)
+    if (m_nodes.size())
     {
-        m_tree->getPoints(
+        getPoints(
                 results,
+                0,
+                *m_bbox,
                 BBox(
                     Point((std::min)(xMin, xMax), (std::min)(yMin, yMax)),
                     Point((std::max)(xMin, xMax), (std::max)(yMin, yMax))),
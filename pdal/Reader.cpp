@@ -33,6 +33,7 @@
 ****************************************************************************/
 
 #include <pdal/Reader.hpp>
+#include <pdal/Progress.hpp>
 #include <pdal/util/ProgramArgs.hpp>
 
 namespace pdal
@@ -76,6 +77,50 @@ void Reader::setSpatialReference(MetadataNode& m, const SpatialReference& srs)
 }
 
 
+// Points can only be skipped if the source is read to its end.  Otherwise
+// the last points read aren't the last points of the source.
+point_count_t Reader::pointsToSkip(point_count_t numPoints) const
+{
+    point_count_t last = pointLimit().m_last;
+    if (m_count < numPoints || last >= numPoints)
+        return 0;
+    return numPoints - last;
+}
+
+
+// A stride can't be read if the source isn't read in full or if points
+// are skipped at its start, since the points read wouldn't be those of the
+// stride.
+bool Reader::readStride(point_count_t numPoints)
+{
+    const PointLimit& limit = pointLimit();
+    m_strided = limit.m_step > 1 && m_count >= numPoints &&
+        limit.m_last >= numPoints;
+    return m_strided;
+}
+
+
+void Reader::setProgressTotal(point_count_t total) const
+{
+    if (m_progress)
+        m_progress->setTotal(this, total);
+}
+
+
+void Reader::addProgress(point_count_t points, uint64_t bytes) const
+{
+    if (m_progress)
+        m_progress->add(this, points, bytes);
+}
+
+
+void Reader::countProgress(point_count_t count) const
+{
+    if (m_progress)
+        m_progress->count(this, count);
+}
+
+
 void Reader::readerInitialize(PointTableRef)
 {
     if (m_overrideSrs.valid() && m_defaultSrs.valid())
@@ -37,6 +37,7 @@
 #include <pdal/Stage.hpp>
 #include <pdal/Options.hpp>
 
+#include <algorithm>
 #include <functional>
 
 namespace pdal
@@ -49,13 +50,22 @@ class PDAL_DLL Reader : public virtual Stage
 public:
     typedef std::function<void(PointView&, PointId)> PointReadFunc;
 
-    Reader()
+    Reader() : m_strided(false)
     {}
 
     void setReadCb(PointReadFunc cb)
         { m_cb = cb; }
     point_count_t count() const
         { return m_count; }
+    /**
+      Determine whether the reader reads only the points of the stride
+      asked for by the stages that follow it (see PointLimit).  Those
+      stages must not apply the stride again.  Only valid after ready().
+
+      \return  Whether only the points of the stride are read.
+    */
+    bool strided() const
+        { return m_strided; }
 
     using Stage::setSpatialReference;
 
@@ -72,16 +82,68 @@ protected:
     virtual void setSpatialReference(MetadataNode& m,
             const SpatialReference& srs);
 
+    /**
+      Get the number of points at the start of a source that can be
+      skipped because no stage that follows reads them.  Readers that can
+      seek may start reading after these points.
+
+      \param numPoints  Number of points in the source.
+      \return  Number of points that can be skipped.
+    */
+    point_count_t pointsToSkip(point_count_t numPoints) const;
+
+    /**
+      Determine whether the points of the stride asked for by the stages
+      that follow can be read alone.  Readers that can seek may call this
+      from ready() and, if it returns true, read only the points at
+      pointLimit().m_offset + k * pointLimit().m_step that are before
+      pointLimit().m_first.
+
+      \param numPoints  Number of points in the source.
+      \return  Whether only the points of the stride are to be read.
+    */
+    bool readStride(point_count_t numPoints);
+
+    /**
+      Set the number of points that the reader expects to read, used to
+      estimate the time remaining.  Call from ready().
+
+      \param total  Expected number of points.
+    */
+    void setProgressTotal(point_count_t total) const;
+
+    /**
+      Report points and bytes read as they're read.  Readers that don't
+      report points have the points of each read or stream batch counted
+      when it completes.  Call no more often than once per block of points.
+
+      \param points  Number of points read.
+      \param bytes  Number of bytes of point data read.
+    */
+    void addProgress(point_count_t points, uint64_t bytes = 0) const;
+
 private:
     virtual PointViewSet run(PointViewPtr view)
     {
         PointViewSet viewSet;
 
         view->clearTemps();
-        read(view, m_count);
+        point_count_t count =
+            read(view, (std::min)(m_count, pointLimit().m_first));
+        countProgress(count);
         viewSet.insert(view);
         return viewSet;
     }
+    friend class Streamable;
+
+    bool m_strided;
+
+    // Count the points of a completed read or stream batch.
+    void countProgress(point_count_t count) const;
+    virtual bool readerFillsBatch() const
+        { return true; }
+    virtual void readerBatchRead(point_count_t count) const
+        { countProgress(count); }
     virtual void readerInitialize(PointTableRef);
     virtual void readerAddArgs(ProgramArgs& args);
     virtual point_count_t read(PointViewPtr /*view*/, point_count_t /*num*/)
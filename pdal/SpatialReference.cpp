@@ -33,6 +33,8 @@
  ****************************************************************************/
 
 #include <memory>
+#include <mutex>
+#include <unordered_map>
 
 #include <pdal/Metadata.hpp>
 #include <pdal/PDALUtils.hpp>
@@ -71,6 +73,143 @@ OGRScopedSpatialReference ogrCreateSrs(std::string s = "")
             OSRNewSpatialReference(s.size() ? s.c_str() : nullptr)));
 }
 
+// Properties derived from the WKT of a spatial reference.
+struct SrsProperties
+{
+    bool m_valid;
+    bool m_geographic;
+    bool m_geocentric;
+    bool m_projected;
+    std::string m_horizontal;
+    std::string m_horizontalUnits;
+    std::string m_vertical;
+    std::string m_verticalUnits;
+};
+using SrsPropertiesPtr = std::shared_ptr<const SrsProperties>;
+
+SrsPropertiesPtr computeProperties(const std::string& wkt)
+{
+    std::shared_ptr<SrsProperties> p(new SrsProperties {});
+
+    OGRScopedSpatialReference srs = ogrCreateSrs(wkt);
+    if (!srs)
+        return p;
+
+    p->m_valid = (OSRValidate(srs.get()) == OGRERR_NONE);
+    p->m_geographic = OSRIsGeographic(srs.get());
+    p->m_geocentric = OSRIsGeocentric(srs.get());
+    p->m_projected = OSRIsProjected(srs.get());
+
+    // The returned units remain internal to the OGRSpatialReference
+    // and should not be freed, or modified. They may be invalidated on
+    // the next OGRSpatialReference call.
+    char *units(nullptr);
+    srs->GetLinearUnits(&units);
+    if (units)
+        p->m_horizontalUnits = units;
+    pdal::Utils::trim(p->m_horizontalUnits);
+
+    char *pszWKT(nullptr);
+    OGR_SRSNode* node = srs->GetAttrNode("VERT_CS");
+    if (node)
+    {
+        p->m_verticalUnits = p->m_horizontalUnits;
+        node->exportToWkt(&pszWKT);
+        p->m_vertical = pszWKT;
+        CPLFree(pszWKT);
+    }
+
+    srs->StripVertical();
+    srs->exportToWkt(&pszWKT);
+    p->m_horizontal = pszWKT;
+    CPLFree(pszWKT);
+    return p;
+}
+
+// Process-wide memo of the WKT for user SRS definitions, of the properties
+// of each SRS, keyed by WKT, and of the result of comparing pairs of SRSs
+// whose WKT differs.  Streaming compares the SRS of each batch at each
+// stage, so parsing the WKT every time is costly.
+class SrsCache
+{
+public:
+    bool findWkt(const std::string& input, std::string& wkt)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_wkt.find(input);
+        if (it == m_wkt.end())
+            return false;
+        wkt = it->second;
+        return true;
+    }
+
+    void addWkt(const std::string& input, const std::string& wkt)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_wkt.size() >= MaxEntries)
+            m_wkt.clear();
+        m_wkt[input] = wkt;
+    }
+
+    SrsPropertiesPtr properties(const std::string& wkt)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_properties.find(wkt);
+            if (it != m_properties.end())
+                return it->second;
+        }
+
+        // Compute without holding the lock.  If two threads compute the
+        // same properties, the results are the same.
+        SrsPropertiesPtr p = computeProperties(wkt);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_properties.size() >= MaxEntries)
+            m_properties.clear();
+        m_properties.insert(std::make_pair(wkt, p));
+        return p;
+    }
+
+    bool equals(const std::string& wkt1, const std::string& wkt2)
+    {
+        const std::string key = (wkt1 < wkt2) ?
+            wkt1 + '\n' + wkt2 : wkt2 + '\n' + wkt1;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_equal.find(key);
+            if (it != m_equal.end())
+                return it->second;
+        }
+
+        OGRScopedSpatialReference current = ogrCreateSrs(wkt1);
+        OGRScopedSpatialReference other = ogrCreateSrs(wkt2);
+        bool same = current && other &&
+            (OSRIsSame(current.get(), other.get()) == 1);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_equal.size() >= MaxEntries)
+            m_equal.clear();
+        m_equal[key] = same;
+        return same;
+    }
+
+private:
+    static const size_t MaxEntries = 256;
+
+    std::mutex m_mutex;
+    std::unordered_map<std::string, std::string> m_wkt;
+    std::unordered_map<std::string, SrsPropertiesPtr> m_properties;
+    std::unordered_map<std::string, bool> m_equal;
+};
+
+// Never destroyed, so that it can be used by static objects at exit.
+SrsCache& srsCache()
+{
+    static SrsCache *c = new SrsCache;
+    return *c;
+}
+
 }
 
 namespace pdal
@@ -90,12 +229,7 @@ bool SpatialReference::empty() const
 
 bool SpatialReference::valid() const
 {
-    OGRScopedSpatialReference current(ogrCreateSrs(m_wkt));
-    if (!current)
-        return false;
-
-    OGRErr err = OSRValidate(current.get());
-    return err == OGRERR_NONE;
+    return srsCache().properties(m_wkt)->m_valid;
 }
 
 
@@ -141,7 +275,6 @@ void SpatialReference::parse(const std::string& s, std::string::size_type& pos)
 
 void SpatialReference::set(std::string v)
 {
-    m_horizontalWkt.clear();
     if (v.empty())
     {
         m_wkt.clear();
@@ -154,6 +287,11 @@ void SpatialReference::set(std::string v)
         return;
     }
 
+    // A filename isn't memoized since the file may change.
+    const bool isFile = FileUtils::fileExists(v);
+    if (!isFile && srsCache().findWkt(v, m_wkt))
+        return;
+
     OGRSpatialReference srs(NULL);
 
     CPLErrorReset();
@@ -174,6 +312,8 @@ void SpatialReference::set(std::string v)
     srs.exportToWkt(&poWKT);
     m_wkt = poWKT;
     CPLFree(poWKT);
+    if (!isFile)
+        srsCache().addWkt(v, m_wkt);
 }
 
 
@@ -199,88 +339,25 @@ std::string SpatialReference::getProj4() const
 
 std::string SpatialReference::getVertical() const
 {
-    std::string tmp;
-
-    OGRScopedSpatialReference poSRS = ogrCreateSrs(m_wkt);
-
-    // Above can fail if m_wkt is bad.
-    if (!poSRS)
-        return tmp;
-
-    char *pszWKT = NULL;
-
-    OGR_SRSNode* node = poSRS->GetAttrNode("VERT_CS");
-    if (node && poSRS)
-    {
-        node->exportToWkt(&pszWKT);
-        tmp = pszWKT;
-        CPLFree(pszWKT);
-    }
-
-    return tmp;
+    return srsCache().properties(m_wkt)->m_vertical;
 }
 
 
 std::string SpatialReference::getVerticalUnits() const
 {
-    std::string tmp;
-
-    OGRScopedSpatialReference poSRS = ogrCreateSrs(m_wkt);
-    if (poSRS)
-    {
-        OGR_SRSNode* node = poSRS->GetAttrNode("VERT_CS");
-        if (node)
-        {
-            char* units(nullptr);
-
-            // 'units' remains internal to the OGRSpatialReference
-            // and should not be freed, or modified. It may be invalidated
-            // on the next OGRSpatialReference call.
-            (void)poSRS->GetLinearUnits(&units);
-            tmp = units;
-            Utils::trim(tmp);
-        }
-    }
-
-    return tmp;
+    return srsCache().properties(m_wkt)->m_verticalUnits;
 }
 
 
 std::string SpatialReference::getHorizontal() const
 {
-    if (m_horizontalWkt.empty())
-    {
-        OGRScopedSpatialReference poSRS = ogrCreateSrs(m_wkt);
-
-        if (poSRS)
-        {
-            char *pszWKT(nullptr);
-            poSRS->StripVertical();
-            poSRS->exportToWkt(&pszWKT);
-            m_horizontalWkt = pszWKT;
-            CPLFree(pszWKT);
-        }
-    }
-    return m_horizontalWkt;
+    return srsCache().properties(m_wkt)->m_horizontal;
 }
 
 
 std::string SpatialReference::getHorizontalUnits() const
 {
-    OGRScopedSpatialReference poSRS = ogrCreateSrs(m_wkt);
-
-    if (!poSRS)
-        return std::string();
-
-    char* units(nullptr);
-
-    // The returned value remains internal to the OGRSpatialReference
-    // and should not be freed, or modified. It may be invalidated on
-    // the next OGRSpatialReference call.
-    double u = poSRS->GetLinearUnits(&units);
-    std::string tmp(units);
-    Utils::trim(tmp);
-    return tmp;
+    return srsCache().properties(m_wkt)->m_horizontalUnits;
 }
 
 
@@ -289,15 +366,7 @@ bool SpatialReference::equals(const SpatialReference& input) const
     if (getWKT() == input.getWKT())
         return true;
 
-    OGRScopedSpatialReference current = ogrCreateSrs(getWKT());
-    OGRScopedSpatialReference other = ogrCreateSrs(input.getWKT());
-
-    if (!current || !other)
-        return false;
-
-    int output = OSRIsSame(current.get(), other.get());
-
-    return (output == 1);
+    return srsCache().equals(getWKT(), input.getWKT());
 }
 
 
@@ -322,34 +391,19 @@ const std::string& SpatialReference::getName() const
 
 bool SpatialReference::isGeographic() const
 {
-    OGRScopedSpatialReference current = ogrCreateSrs(m_wkt);
-    if (!current)
-        return false;
-
-    bool output = OSRIsGeographic(current.get());
-    return output;
+    return srsCache().properties(m_wkt)->m_geographic;
 }
 
 
 bool SpatialReference::isGeocentric() const
 {
-    OGRScopedSpatialReference current = ogrCreateSrs(m_wkt);
-    if (!current)
-        return false;
-
-    bool output = OSRIsGeocentric(current.get());
-    return output;
+    return srsCache().properties(m_wkt)->m_geocentric;
 }
 
 
 bool SpatialReference::isProjected() const
 {
-    OGRScopedSpatialReference current = ogrCreateSrs(m_wkt);
-    if (!current)
-        return false;
-
-    bool output = OSRIsProjected(current.get());
-    return output;
+    return srsCache().properties(m_wkt)->m_projected;
 }
 
 std::vector<int> SpatialReference::getAxisOrdering() const
@@ -469,6 +523,31 @@ std::string SpatialReference::getWKT1() const
 }
 
 
+std::string SpatialReference::getPROJJSON() const
+{
+    std::string json;
+#if GDAL_VERSION_MAJOR > 3 || \
+    (GDAL_VERSION_MAJOR == 3 && GDAL_VERSION_MINOR >= 1)
+    std::string wkt = getWKT();
+    if (wkt.empty())
+        return json;
+
+    OGRScopedSpatialReference srs = ogrCreateSrs(wkt);
+    if (srs)
+    {
+        char *buf = nullptr;
+        srs->exportToPROJJSON(&buf, nullptr);
+        if (buf)
+        {
+            json = buf;
+            CPLFree(buf);
+        }
+    }
+#endif
+    return json;
+}
+
+
 int SpatialReference::getUTMZone() const
 {
     OGRScopedSpatialReference current = ogrCreateSrs(m_wkt);
@@ -512,11 +591,15 @@ MetadataNode SpatialReference::toMetadata() const
     root.add("vertical", getVertical());
     root.add("isgeographic", isGeographic());
     root.add("isgeocentric", isGeocentric());
-    root.add("proj4", getProj4());
-    root.add("prettywkt", prettyWkt(getHorizontal()));
+    // Conversions that are costly and rarely read are done when read.
+    SpatialReference srs(*this);
+    root.addLazy("proj4", "string", [srs](){ return srs.getProj4(); });
+    root.addLazy("prettywkt", "string",
+        [srs](){ return prettyWkt(srs.getHorizontal()); });
     root.add("wkt", getHorizontal());
     root.add("compoundwkt", getWKT());
-    root.add("prettycompoundwkt", prettyWkt(m_wkt));
+    root.addLazy("prettycompoundwkt", "string",
+        [srs](){ return prettyWkt(srs.getWKT()); });
 
     MetadataNode units = root.add("units");
     units.add("vertical", getVerticalUnits());
@@ -118,6 +118,11 @@ public:
     std::string getWKT() const;
     std::string getWKT1() const;
 
+    /// Get the SRS as PROJJSON.
+    /// \return  PROJJSON text, or an empty string if the SRS is empty or
+    ///    GDAL is older than 3.1.
+    std::string getPROJJSON() const;
+
     /// Parse the string starting at position `pos` as a spatial reference.
     /// \param s    String to parse.
     /// \param pos  Position to start parsing string.
@@ -168,7 +173,6 @@ public:
 
 private:
     std::string m_wkt;
-    mutable std::string m_horizontalWkt;
     friend PDAL_DLL std::ostream& operator<<(std::ostream& ostr,
         const SpatialReference& srs);
     friend PDAL_DLL std::istream& operator>>(std::istream& istr,
@@ -34,22 +34,59 @@
 
 #include <pdal/GDALUtils.hpp>
 #include <pdal/PipelineManager.hpp>
+#include <pdal/Reader.hpp>
 #include <pdal/Stage.hpp>
+#include <pdal/Streamable.hpp>
+#include <pdal/Writer.hpp>
 #include <pdal/SpatialReference.hpp>
+#include <pdal/Trace.hpp>
 #include <pdal/PDALUtils.hpp>
 #include <pdal/util/Algorithm.hpp>
 #include <pdal/util/ProgramArgs.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
+#include "private/StageCache.hpp"
 #include "private/StageRunner.hpp"
 
 #include <iterator>
+#include <map>
 #include <memory>
+#include <set>
+#include <stack>
 
 namespace pdal
 {
 
-Stage::Stage() : m_progressFd(-1), m_verbose(0), m_pointCount(0),
-    m_faceCount(0)
+namespace
+{
+
+// Stream table whose points are a window onto the points of a view.  Fused
+// stages run on a view through this table in standard mode.
+class ViewStreamTable : public StreamPointTable
+{
+public:
+    ViewStreamTable(PointView& view, point_count_t capacity) :
+        StreamPointTable(*view.layout(), capacity), m_view(view), m_base(0)
+    {}
+
+    // Make the window start at a point of the view.
+    void setBase(PointId base)
+        { m_base = base; }
+
+protected:
+    virtual char *getPoint(PointId idx)
+        { return m_view.getPoint(m_base + idx); }
+
+private:
+    PointView& m_view;
+    PointId m_base;
+};
+
+} // unnamed namespace
+
+Stage::Stage() : m_progressFd(-1), m_progress(nullptr), m_verbose(0),
+    m_pointCount(0), m_faceCount(0), m_allDimsRequired(true),
+    m_consumer(nullptr), m_consumerCount(0), m_memory(new MemoryAccount)
 {}
 
 
@@ -147,6 +184,7 @@ void Stage::prepare(PointTableRef table)
         prev->prepare(table);
     }
     handleOptions();
+    m_memory->setName(tag());
     startLogging();
     l_initialize(table);
     initialize(table);
@@ -158,74 +196,228 @@ void Stage::prepare(PointTableRef table)
 
 PointViewSet Stage::execute(PointTableRef table)
 {
-    table.finalize();
-
-    // We store stage instances instead of stages because a stage may get
-    // executed more than once.  A stage instance is created for each
-    // execution of a stage in a pipeline.  This properly builds out
-    // diamond-shaped pipelines.
-    int stageInstanceId = 1;
-    struct StageInstance
-    {
-        Stage *m_stage;
-        int m_id;
+    return execute(table, 1);
+}
 
-        StageInstance(Stage *s, int id) : m_stage(s), m_id(id)
-        {}
-        StageInstance() : m_stage(nullptr), m_id(0)
-        {}
 
-        bool operator<(const StageInstance& other) const
-        { return m_id < other.m_id; }
-    };
+PointViewSet Stage::execute(PointTableRef table, std::size_t threads)
+{
+    return executeStandard(table, threads, false);
+}
 
-    std::stack<StageInstance> stages;
-    std::stack<StageInstance> pending;
-    std::map<StageInstance, StageInstance> children;
 
-    m_log->get(LogLevel::Debug) << "Executing pipeline in standard mode." <<
-        std::endl;
+PointViewSet Stage::executeHybrid(PointTableRef table, std::size_t threads)
+{
+    return executeStandard(table, threads, true);
+}
 
-    pending.push(StageInstance(this, stageInstanceId++));
 
-    // Linearize stage execution.
+PointViewSet Stage::executeStandard(PointTableRef table, std::size_t threads,
+    bool hybrid, StageCache *cache)
+{
+    findRequiredDims(table.layout());
+    if (table.layout()->aligned() && !table.layout()->finalized())
+        prioritizeDims(table.layout());
+    table.finalize();
+    findPointLimits();
+
+    std::unique_ptr<ThreadPool> pool;
+    if (threads > 1)
+        pool.reset(new ThreadPool(threads, -1, false));
+
+    // A stage that is the input of several stages is executed once.  The
+    // first stage that uses it gets its output views and the others get
+    // views that share the points of the output (see
+    // PointView::makeShared()), so that branches of a diamond-shaped
+    // pipeline don't see each other's changes.
+    std::vector<Stage *> stages;
+    std::map<Stage *, std::vector<Stage *>> children;
+    std::set<Stage *> visited;
+    std::stack<std::pair<Stage *, bool>> pending;
+    std::map<Stage *, std::string> keys;
+    std::map<Stage *, PointViewSet> cached;
+
+    m_log->get(LogLevel::Debug) << "Executing pipeline in " <<
+        (hybrid ? "hybrid" : "standard") << " mode." << std::endl;
+    if (pool)
+        m_log->get(LogLevel::Debug) << "Running re-entrant stages with " <<
+            threads << " threads." << std::endl;
+
+    // Linearize stage execution.  Inputs are executed in order, each
+    // before the stages that use it.
+    pending.push(std::make_pair(this, false));
     while (pending.size())
     {
-        StageInstance si = pending.top();
+        Stage *s = pending.top().first;
+        bool expanded = pending.top().second;
         pending.pop();
-        stages.push(si);
-        for (Stage *in : si.m_stage->m_inputs)
+        if (expanded)
+        {
+            stages.push_back(s);
+            continue;
+        }
+        if (!visited.insert(s).second)
+            continue;
+        pending.push(std::make_pair(s, true));
+        // The output of a cached stage is loaded, so nothing upstream of
+        // it is run.
+        if (cache)
         {
-            StageInstance parent(in, stageInstanceId++);
-            pending.push(parent);
-            children[parent] = si;
+            std::string& key = keys[s];
+            key = cache->key(*s);
+            if (key.size() && cache->load(key, table, cached[s]))
+            {
+                m_log->get(LogLevel::Debug) << "Loaded output of '" <<
+                    s->tag() << "' from cache." << std::endl;
+                continue;
+            }
+            cached.erase(s);
         }
+        for (auto it = s->m_inputs.rbegin(); it != s->m_inputs.rend(); ++it)
+            pending.push(std::make_pair(*it, false));
+        for (Stage *in : s->m_inputs)
+            children[in].push_back(s);
     }
 
+    // Consecutive fusable stages, each the only input of the next, are
+    // executed together (see Streamable::fusable()).  The views of a
+    // column table don't have packed points and views that are run
+    // concurrently aren't fused.
+    auto fusedRun = [&](size_t first)
+    {
+        std::vector<Streamable *> run;
+        if (pool || table.columnData())
+            return run;
+        for (size_t i = first; i < stages.size(); ++i)
+        {
+            Stage *s = stages[i];
+            Streamable *f = dynamic_cast<Streamable *>(s);
+            if (!f || !f->fusable() || f->profile() || cached.count(s))
+                break;
+            if (i > first && (s->m_inputs.size() != 1 ||
+                    s->m_inputs.front() != stages[i - 1] ||
+                    children[stages[i - 1]].size() != 1))
+                break;
+            run.push_back(f);
+        }
+        return run;
+    };
+
+    // In hybrid execution, a reader and the streamable stages that follow
+    // it, each the only input of the next, are streamed and only the
+    // points that remain are stored in the table.  Points are copied from
+    // the stream buffer to the table as whole records, so the table must
+    // store points in rows.
+    auto streamedRun = [&](size_t first)
+    {
+        std::vector<Streamable *> run;
+        if (!hybrid || table.columnData())
+            return run;
+        if (stages[first]->m_inputs.size() ||
+                !dynamic_cast<Reader *>(stages[first]))
+            return run;
+        for (size_t i = first; i < stages.size(); ++i)
+        {
+            Stage *s = stages[i];
+            Streamable *f = dynamic_cast<Streamable *>(s);
+            if (!f || !s->pipelineStreamable() || cached.count(s))
+                break;
+            if (i > first && (s->m_inputs.size() != 1 ||
+                    s->m_inputs.front() != stages[i - 1] ||
+                    children[stages[i - 1]].size() != 1))
+                break;
+            run.push_back(f);
+        }
+        return run;
+    };
+
     // Go through the stages in order, executing
     PointViewSet outViews;
-    std::map<StageInstance, PointViewSet> sets;
-    while (stages.size())
+    std::map<Stage *, PointViewSet> sets;
+    std::map<Stage *, std::vector<PointViewPtr>> shared;
+    for (size_t i = 0; i < stages.size(); ++i)
     {
-        StageInstance si = stages.top();
-        stages.pop();
-        PointViewSet& inViews = sets[si];
+        Stage *s = stages[i];
+        PointViewSet& inViews = sets[s];
+        // Shared views get the IDs they would have had if the stage that
+        // made them had been executed again.
+        for (PointViewPtr v : shared[s])
+        {
+            v->m_id = ++PointView::m_lastId;
+            inViews.insert(v);
+        }
+        shared.erase(s);
         if (inViews.empty())
             inViews.insert(PointViewPtr(new PointView(table)));
-        outViews = si.m_stage->execute(table, inViews);
-
-        StageInstance child = children[si];
 
-        // If a stage has no child it is the terminal stage.  We're done.
-        if (child.m_stage)
-            sets[child].insert(outViews.begin(), outViews.end());
-        // Allow previous point views to be freed.
-        sets.erase(si);
+        std::vector<Streamable *> streamed;
+        std::vector<Streamable *> run;
+        auto ci = cached.find(s);
+        const bool loaded = (ci != cached.end());
+        if (!loaded)
+            streamed = streamedRun(i);
+        if (!loaded && streamed.size() < 2)
+            run = fusedRun(i);
+        if (loaded)
+        {
+            outViews = std::move(ci->second);
+            cached.erase(ci);
+        }
+        else if (streamed.size() > 1)
+        {
+            PointViewPtr view = streamed.back()->streamToView(table,
+                streamed);
+            SpatialReference srs;
+            for (Streamable *f : streamed)
+                if (!f->getSpatialReference().empty())
+                    srs = f->getSpatialReference();
+            view->setSpatialReference(srs);
+            outViews.clear();
+            outViews.insert(view);
+            sets.erase(s);
+            i += streamed.size() - 1;
+            s = stages[i];
+        }
+        else if (run.size() > 1)
+        {
+            outViews = executeFused(run, table, inViews);
+            sets.erase(s);
+            i += run.size() - 1;
+            s = stages[i];
+        }
+        else
+            outViews = s->execute(table, inViews, pool.get());
+
+        // Only the output of the last stage of a streamed or fused run is
+        // stored.
+        if (cache && !loaded && keys[s].size() &&
+                cache->store(keys[s], outViews))
+            m_log->get(LogLevel::Debug) << "Stored output of '" <<
+                s->tag() << "' in cache." << std::endl;
+
+        // If a stage has no children it is the terminal stage.  We're done.
+        const std::vector<Stage *>& consumers = children[s];
+        for (size_t c = 0; c < consumers.size(); ++c)
+            for (PointViewPtr v : outViews)
+                if (c == 0)
+                    sets[consumers[c]].insert(v);
+                else
+                    shared[consumers[c]].push_back(v->makeShared());
+
+        // Allow previous point views to be freed, and with them the point
+        // storage that no remaining view refers to.
+        sets.erase(s);
+        std::size_t freed = table.releaseUnreferenced();
+        if (freed)
+            PDAL_LOG(m_log, LogLevel::Debug) << "Released " << freed <<
+                " bytes of point storage after running '" <<
+                s->tag() << "'." << std::endl;
     }
     return outViews;
 }
 
-PointViewSet Stage::execute(PointTableRef table, PointViewSet& views)
+PointViewSet Stage::execute(PointTableRef table, PointViewSet& views,
+    ThreadPool *pool)
 {
 
     PointViewSet outViews;
@@ -259,17 +451,47 @@ PointViewSet Stage::execute(PointTableRef table, PointViewSet& views)
     }
     // Do the ready operation and then start running all the views
     // through the stage.
-    ready(table);
+    {
+        PDAL_TRACE_SCOPE("stage", tag() + " ready");
+        MemoryAccount::Scope memory(m_memory.get());
+        StageProfile::Timer timer(profile(), StageProfile::Phase::Ready);
+        ready(table);
+    }
     prerun(views);
+
+    // Views are only run concurrently if the stage allows it.  View IDs
+    // are handed out as views are created, so note the last ID so that views
+    // created while running can be renumbered in a deterministic order.
+    bool concurrent = pool && reentrant() && views.size() > 1;
+    int lastId = PointView::m_lastId;
+
+    // Detaching a view that shares points adds points to the table, which
+    // can't be done concurrently, so views are detached before they're run.
+    if (concurrent)
+        for (auto const& it : views)
+            it->detach();
+
+    // Only an asynchronous log can be written from several threads, so the
+    // log is made asynchronous while views are run concurrently.
+    const bool syncLog = concurrent && !log()->asynchronous();
+    if (syncLog)
+        log()->setAsynchronous(true);
     for (auto const& it : views)
     {
         StageRunnerPtr runner(new StageRunner(this, it));
         runners.push_back(runner);
-        runner->run();
+        if (concurrent)
+            runner->run(*pool);
+        else
+            runner->run();
     }
+    if (concurrent)
+        pool->await();
+    if (syncLog)
+        log()->setAsynchronous(false);
 
-    // As the stages complete (synchronously at this time), propagate the
-    // spatial reference and merge the output views.
+    // As the stages complete, propagate the spatial reference and merge
+    // the output views.
     srs = getSpatialReference();
     for (auto const& it : runners)
     {
@@ -281,9 +503,32 @@ PointViewSet Stage::execute(PointTableRef table, PointViewSet& views)
         if (!srs.empty())
             for (PointViewPtr v : temp)
                 v->setSpatialReference(srs);
+
+        // Give new views the IDs they would have had if the input views
+        // had been run one after another.
+        if (concurrent)
+            for (PointViewPtr v : temp)
+                if (v->m_id > lastId)
+                    v->m_id = ++PointView::m_lastId;
         outViews.insert(temp.begin(), temp.end());
     }
-    done(table);
+    {
+        PDAL_TRACE_SCOPE("stage", tag() + " done");
+        MemoryAccount::Scope memory(m_memory.get());
+        StageProfile::Timer timer(profile(), StageProfile::Phase::Done);
+        done(table);
+    }
+    if (m_profile)
+    {
+        point_count_t outCount = 0;
+        for (auto const& v : outViews)
+            outCount += v->size();
+        m_profile->addPoints(m_pointCount, outCount);
+        m_profile->sampleMemory(table.memoryUsed());
+    }
+    PDAL_LOG(log(), LogLevel::Debug) << "Memory held: " <<
+        m_memory->current() << " bytes (peak " << m_memory->peak() <<
+        " bytes)" << std::endl;
     stopLogging();
     m_pointCount = 0;
     m_faceCount = 0;
@@ -291,6 +536,221 @@ PointViewSet Stage::execute(PointTableRef table, PointViewSet& views)
 }
 
 
+// Execute fused stages.  As when streaming, the stages are all readied
+// before any points are processed and are done after all the views have
+// been processed.  A view keeps its points unless a stage filters some
+// out, in which case the points that remain are placed in a new view.
+PointViewSet Stage::executeFused(const std::vector<Streamable *>& run,
+    PointTableRef table, PointViewSet& views)
+{
+    point_count_t count = 0;
+    for (auto const& v : views)
+        count += v->size();
+
+    // Each stage sees the spatial reference set by the stages before it.
+    SpatialReference srs;
+    for (Streamable *s : run)
+    {
+        s->startLogging();
+        table.clearSpatialReferences();
+        if (!srs.empty())
+            table.addSpatialReference(srs);
+        else
+            for (auto it = views.rbegin(); it != views.rend(); it++)
+                table.addSpatialReference((*it)->spatialReference());
+        s->m_pointCount = count;
+        {
+            PDAL_TRACE_SCOPE("stage", s->tag() + " ready");
+            MemoryAccount::Scope memory(s->m_memory.get());
+            s->ready(table);
+        }
+        s->prerun(views);
+        s->stopLogging();
+        const SpatialReference& tempSrs = s->getSpatialReference();
+        if (!tempSrs.empty())
+            srs = tempSrs;
+    }
+
+    const point_count_t capacity = 65536;
+    PointViewSet outViews;
+    for (PointViewPtr view : views)
+    {
+        SpatialReference viewSrs = view->spatialReference();
+        for (Streamable *s : run)
+        {
+            s->spatialReferenceChanged(viewSrs);
+            const SpatialReference& tempSrs = s->getSpatialReference();
+            if (!tempSrs.empty())
+                viewSrs = tempSrs;
+        }
+
+        // Stages may change the points, so the view can't share them.
+        view->detach();
+        ViewStreamTable t(*view, capacity);
+        std::vector<PointId> kept;
+        for (PointId base = 0; base < view->size(); base += capacity)
+        {
+            point_count_t n = (std::min)(capacity, view->size() - base);
+            t.setBase(base);
+            t.clear(n);
+            t.setActiveCount(n);
+            Streamable::runFused(run, t, n);
+            for (PointId idx : t.activeIds(0, n))
+                kept.push_back(base + idx);
+        }
+        view->invalidateProducts();
+
+        PointViewPtr out = view;
+        if (kept.size() != view->size())
+        {
+            out = view->makeNew();
+            for (PointId idx : kept)
+                out->appendPoint(*view, idx);
+        }
+        MemoryAccount::Scope memory(run.back()->m_memory.get());
+        out->chargeMemory();
+        if (!srs.empty())
+            out->setSpatialReference(srs);
+        outViews.insert(out);
+    }
+
+    for (Streamable *s : run)
+    {
+        s->startLogging();
+        {
+            PDAL_TRACE_SCOPE("stage", s->tag() + " done");
+            MemoryAccount::Scope memory(s->m_memory.get());
+            s->done(table);
+        }
+        PDAL_LOG(s->log(), LogLevel::Debug) << "Memory held: " <<
+            s->m_memory->current() << " bytes (peak " <<
+            s->m_memory->peak() << " bytes)" << std::endl;
+        s->stopLogging();
+        s->m_pointCount = 0;
+    }
+    return outViews;
+}
+
+
+// Place the dimensions that the most stages of the pipeline ending with this
+// stage require first in point records, so that they share cache lines.
+void Stage::prioritizeDims(PointLayoutPtr layout)
+{
+    std::map<Dimension::Id, int> counts;
+    std::set<Stage *> visited;
+    std::stack<Stage *> stages;
+    stages.push(this);
+    while (stages.size())
+    {
+        Stage *s = stages.top();
+        stages.pop();
+        if (!visited.insert(s).second)
+            continue;
+        if (!s->m_allDimsRequired)
+            for (Dimension::Id id : s->m_requiredDims)
+                counts[id]++;
+        for (Stage *in : s->m_inputs)
+            stages.push(in);
+    }
+    for (auto& c : counts)
+        layout->setDimPriority(c.first, c.second);
+}
+
+
+// Determine the dimensions required of each stage in the pipeline that
+// ends with this stage.
+void Stage::findRequiredDims(PointLayoutPtr layout)
+{
+    clearRequiredDims();
+
+    // The output of a terminal stage other than a writer is returned to
+    // the caller, which may read any dimension.
+    bool all = (dynamic_cast<Writer *>(this) == nullptr);
+    addRequiredDims(layout, Dimension::IdList(), all);
+}
+
+
+void Stage::clearRequiredDims()
+{
+    m_allDimsRequired = false;
+    m_requiredDims.clear();
+    for (Stage *s : m_inputs)
+        s->clearRequiredDims();
+}
+
+
+// Add dimensions required by a stage that follows this one.  A stage may
+// feed more than one stage, so the requirements are accumulated.
+void Stage::addRequiredDims(PointLayoutPtr layout,
+    const Dimension::IdList& dims, bool all)
+{
+    m_allDimsRequired |= all;
+    m_requiredDims.insert(dims.begin(), dims.end());
+
+    Dimension::IdList used(dims);
+    if (!addUsedDims(layout, used))
+        all = true;
+    for (Stage *s : m_inputs)
+        s->addRequiredDims(layout, used, all);
+}
+
+
+// Determine the points read from each stage in the pipeline that ends with
+// this stage, and the stages that read them.  The output of the terminal
+// stage is read in full.
+void Stage::findPointLimits()
+{
+    clearPointLimits();
+    addPointLimit(PointLimit());
+}
+
+
+void Stage::clearPointLimits()
+{
+    m_pointLimit.m_first = 0;
+    m_pointLimit.m_last = 0;
+    m_pointLimit.m_offset = 0;
+    m_pointLimit.m_step = 1;
+    m_consumer = nullptr;
+    m_consumerCount = 0;
+    for (Stage *s : m_inputs)
+        s->clearPointLimits();
+}
+
+
+// Add the points read by a stage that follows this one.  A stage may feed
+// more than one stage, so the limits are accumulated.  A stride is kept
+// only if every stage that follows asks for the same one.
+void Stage::addPointLimit(const PointLimit& limit)
+{
+    m_pointLimit.m_first = (std::max)(m_pointLimit.m_first, limit.m_first);
+    m_pointLimit.m_last = (std::max)(m_pointLimit.m_last, limit.m_last);
+    if (m_consumerCount <= 1)
+    {
+        m_pointLimit.m_offset = limit.m_offset;
+        m_pointLimit.m_step = limit.m_step;
+    }
+    else if (m_pointLimit.m_offset != limit.m_offset ||
+        m_pointLimit.m_step != limit.m_step)
+    {
+        m_pointLimit.m_offset = 0;
+        m_pointLimit.m_step = 1;
+    }
+
+    // The stride asked of this stage isn't passed on to its inputs.
+    PointLimit in(limit);
+    in.m_offset = 0;
+    in.m_step = 1;
+    inputLimit(in);
+    for (Stage *s : m_inputs)
+    {
+        s->m_consumer = this;
+        s->m_consumerCount++;
+        s->addPointLimit(in);
+    }
+}
+
+
 void Stage::l_addArgs(ProgramArgs& args)
 {
     args.add("user_data", "User JSON", m_userDataJSON);
@@ -354,7 +814,6 @@ void Stage::setSpatialReference(MetadataNode& m,
 {
     m_spatialReference = spatialRef;
 
-    MetadataNode srsMetadata = spatialRef.toMetadata();
     m.addOrUpdate(spatialRef.toMetadata());
     m.addOrUpdate("spatialreference", spatialRef.getWKT(), "SRS of this stage");
     m.addOrUpdate("comp_spatialreference", spatialRef.getWKT(),
@@ -34,11 +34,14 @@
 
 #pragma once
 
+#include <limits>
 #include <list>
+#include <set>
 
 #include <pdal/Dimension.hpp>
 #include <pdal/DimType.hpp>
 #include <pdal/Log.hpp>
+#include <pdal/MemoryAccount.hpp>
 #include <pdal/Metadata.hpp>
 #include <pdal/Options.hpp>
 #include <pdal/PipelineWriter.hpp>
@@ -48,15 +51,19 @@
 #include <pdal/PointView.hpp>
 #include <pdal/QuickInfo.hpp>
 #include <pdal/SpatialReference.hpp>
+#include <pdal/StageProfile.hpp>
 #include <pdal/util/ProgramArgs.hpp>
 
 namespace pdal
 {
 
 class ProgramArgs;
+class Progress;
+class StageCache;
 class StageRunner;
 class StageWrapper;
 class Streamable;
+class ThreadPool;
 
 /**
   A stage performs the actual processing in PDAL.  Stages may read data,
@@ -70,10 +77,38 @@ class Streamable;
 class PDAL_DLL Stage
 {
     FRIEND_TEST(OptionsTest, conditional);
+    friend class PipelineManager;
+    friend class StageCache;
     friend class StageWrapper;
     friend class StageRunner;
     friend class Streamable;
 public:
+    /**
+      The points of a stage's output that are read by the stages that
+      follow it.  A stage that only keeps some points from the start or
+      the end of its input, like filters.head or filters.tail, reduces
+      the limit seen by the stages before it.  A stage that keeps every
+      Nth point of its input, like filters.decimation, asks for a stride.
+      A stride is only asked of the stages that are immediate inputs.
+    */
+    struct PointLimit
+    {
+        PointLimit() :
+            m_first((std::numeric_limits<point_count_t>::max)()),
+            m_last((std::numeric_limits<point_count_t>::max)()),
+            m_offset(0), m_step(1)
+        {}
+
+        /// Number of points at the start of the output that are read.
+        point_count_t m_first;
+        /// Number of points at the end of the output that are read.
+        point_count_t m_last;
+        /// Index of the first point of the stride.
+        PointId m_offset;
+        /// Only the points at m_offset + k * m_step are read.
+        point_count_t m_step;
+    };
+
     Stage();
     virtual ~Stage();
 
@@ -93,6 +128,15 @@ public:
     void setProgressFd(int fd)
         { m_progressFd = fd; }
 
+    /**
+      Set the structured progress to which readers report the points they
+      read.  Set by PipelineManager for each execution.
+
+      \param progress  Progress of the execution, or nullptr.
+    */
+    void setProgress(Progress *progress)
+        { m_progress = progress; }
+
     /**
       Retrieve some basic point information without reading all data when
       possible.  Usually implemented only by Readers.
@@ -120,12 +164,44 @@ public:
     */
     PointViewSet execute(PointTableRef table);
 
+    /**
+      Execute a prepared pipeline (linked set of stages), allowing stages
+      that are re-entrant to process their input point views concurrently.
+
+      \param table  Point table being used for stage pipeline.  This must be
+        the same \ref table used in the \ref prepare function.
+      \param threads  Maximum number of point views processed at once by
+        a re-entrant stage.
+    */
+    PointViewSet execute(PointTableRef table, std::size_t threads);
+
+    /**
+      Execute a prepared pipeline in standard mode, except that the points
+      of a reader are streamed through the streamable stages that directly
+      follow it.  Only the points that remain after those stages are stored
+      in the point table, in a single view, so a pipeline that can't be
+      streamed as a whole because of a later stage holds fewer points.
+      Streaming is limited to a reader and a chain of streamable stages,
+      each the only input of the next and the only consumer of the one
+      before.  Tables that don't store points in rows (such as
+      ColumnPointTable) are executed in standard mode.
+
+      \param table  Point table being used for stage pipeline.  This must be
+        the same \ref table used in the \ref prepare function.
+      \param threads  Maximum number of point views processed at once by
+        a re-entrant stage.
+    */
+    PointViewSet executeHybrid(PointTableRef table, std::size_t threads = 1);
+
     virtual void execute(StreamPointTable& table)
     {
         throw pdal_error("Attempting to use stream mode with a non-streamable "
             "stage.");
     }
 
+    virtual void execute(StreamPointTable& table, std::size_t /*threads*/)
+        { execute(table); }
+
     /**
       Determine if a pipeline with this stage as a sink is streamable.
 
@@ -253,6 +329,30 @@ public:
     bool isDebug() const
         { return m_log && m_log->getLevel() > LogLevel::Debug; }
 
+    /**
+      Start recording the time spent and points handled by the stage when
+      it is executed.  Any previously recorded profile is discarded.
+    */
+    void enableProfiling()
+        { m_profile.reset(new StageProfile); }
+
+    /**
+      Get the stage's profile.
+
+      \return  The stage's profile, or nullptr if profiling isn't enabled.
+    */
+    StageProfile *profile() const
+        { return m_profile.get(); }
+
+    /**
+      Get the account of the memory held on behalf of the stage.  Memory
+      allocated while the stage runs is charged to the account.
+
+      \return  The stage's memory account.
+    */
+    MemoryAccount& memoryAccount() const
+        { return *m_memory; }
+
     /**
       Return the name of a stage.
 
@@ -325,6 +425,7 @@ protected:
     Options m_options;          ///< Stage's options.
     MetadataNode m_metadata;    ///< Stage's metadata.
     int m_progressFd;           ///< Descriptor for progress info.
+    Progress *m_progress;       ///< Structured progress, may be null.
 
     virtual void setSpatialReference(MetadataNode& m, SpatialReference const&);
     void throwError(const std::string& s) const;
@@ -344,6 +445,36 @@ protected:
     */
     point_count_t faceCount() const
         { return m_faceCount; }
+    /**
+      Determine whether a dimension is used by a stage that follows this
+      one in the pipeline.  Readers can use this to avoid decoding
+      dimensions that are never read.  Only valid during execute().
+
+      \param id  ID of the dimension to check.
+      \return  Whether the dimension is required of this stage.
+    */
+    bool dimRequired(Dimension::Id id) const
+        { return m_allDimsRequired || m_requiredDims.count(id); }
+    /**
+      Get the points of the output of this stage that are read by stages
+      that follow it in the pipeline.  Readers can use this to stop early
+      or to skip points that are never read.  Only valid during execute().
+
+      \return  Limit on the points read from this stage.
+    */
+    const PointLimit& pointLimit() const
+        { return m_pointLimit; }
+    /**
+      Get the stage that reads the output of this stage in the pipeline
+      being executed, if there is exactly one.  Stages can use this to
+      safely hand work to the stage that follows.  Only valid during
+      execute().
+
+      \return  The stage that reads this stage's output, or nullptr if
+        there are none or several.
+    */
+    const Stage *soleConsumer() const
+        { return m_consumerCount == 1 ? m_consumer : nullptr; }
 
 private:
     uint32_t m_verbose;
@@ -360,6 +491,13 @@ private:
     std::string m_userDataJSON;
     point_count_t m_pointCount;
     point_count_t m_faceCount;
+    bool m_allDimsRequired;
+    std::set<Dimension::Id> m_requiredDims;
+    PointLimit m_pointLimit;
+    const Stage *m_consumer;
+    int m_consumerCount;
+    std::unique_ptr<StageProfile> m_profile;
+    std::shared_ptr<MemoryAccount> m_memory;
     // This is never used, but we want something to bind to the argument
     // we stick in ProgramArgs so that it shows up in help and an options list.
     std::string m_optionFile;
@@ -377,8 +515,22 @@ private:
         {}
     virtual void writerInitialize(PointTableRef /*table*/)
         {}
+    // Readers fill the points of a streaming batch, where other stages
+    // process the active points.  Overridden by Reader.
+    virtual bool readerFillsBatch() const
+        { return false; }
+    virtual void readerBatchRead(point_count_t /*count*/) const
+        {}
 
     void l_initialize(PointTableRef table);
+    void findRequiredDims(PointLayoutPtr layout);
+    void prioritizeDims(PointLayoutPtr layout);
+    void clearRequiredDims();
+    void addRequiredDims(PointLayoutPtr layout, const Dimension::IdList& dims,
+        bool all);
+    void findPointLimits();
+    void clearPointLimits();
+    void addPointLimit(const PointLimit& limit);
 
     /**
       Get basic metadata (avoids reading points).  Implement in subclass.
@@ -430,14 +582,72 @@ private:
     virtual void addDimensions(PointLayoutPtr /*layout*/)
         {}
 
+    /**
+      Add the dimensions that this stage reads from its input to a list.
+      Implement in subclass if the stage reads a known set of dimensions.
+      Called at the start of execution, after all stages have been prepared.
+
+      \param layout  Point layout.
+      \param dims  List to which the IDs of dimensions read should be added.
+      \return  Whether 'dims' holds every dimension read by the stage.
+        If false, the stage may read any dimension.
+    */
+    virtual bool addUsedDims(PointLayoutPtr /*layout*/,
+            Dimension::IdList& /*dims*/) const
+        { return false; }
+
+    /**
+      Determine the points of its input that this stage reads given the
+      points of its output that are read.  Implement in subclass if the
+      stage only needs some points from the start or end of its input.
+      Called at the start of execution, after all stages have been prepared.
+
+      \param limit  On input, the points of the output read by the stages
+        that follow.  On output, the points of the input that are read.
+        By default, all points of the input are read.
+    */
+    virtual void inputLimit(PointLimit& limit) const
+        { limit = PointLimit(); }
+
     /**
       Execute a single stage.
 
       \param table  PointTable
       \param pvSet  Input PointViewSet
+      \param pool  Thread pool used to run the views of a re-entrant stage.
+        Views are run in the calling thread if null.
       \return  Output PointViewSet
     */
-    PointViewSet execute(PointTableRef table, PointViewSet& pvSet);
+    PointViewSet execute(PointTableRef table, PointViewSet& pvSet,
+        ThreadPool *pool);
+
+    /**
+      Execute consecutive fusable stages together (see
+      Streamable::fusable()).  The points of each view are processed
+      a tile at a time by each stage in turn.
+
+      \param run  Stages to execute, each the only input of the next.
+      \param table  PointTable
+      \param views  Input PointViewSet of the first stage.
+      \return  Output PointViewSet of the last stage.
+    */
+    PointViewSet executeFused(const std::vector<Streamable *>& run,
+        PointTableRef table, PointViewSet& views);
+
+    /**
+      Execute a prepared pipeline in standard mode.
+
+      \param table  PointTable
+      \param threads  Maximum number of point views processed at once by
+        a re-entrant stage.
+      \param hybrid  Whether to stream readers through the streamable
+        stages that follow them (see \ref executeHybrid).
+      \param cache  Cache from which the output of stages is loaded and in
+        which it's stored, or null.
+      \return  Output PointViewSet of this stage.
+    */
+    PointViewSet executeStandard(PointTableRef table, std::size_t threads,
+        bool hybrid, StageCache *cache = nullptr);
 
     /**
       Functions called after dimensions have been added.  Implement in
@@ -477,6 +687,19 @@ private:
         return PointViewSet();
     }
 
+    /**
+      Determine whether \ref run may be called for different point views
+      at the same time from different threads.  A re-entrant stage must not
+      modify its own state or metadata, or add points to the point table,
+      from \ref run.  The stage's log is asynchronous while views are run
+      concurrently, so it may be written from \ref run.  Implement in
+      subclass.
+
+      \return  Whether the stage is re-entrant.
+    */
+    virtual bool reentrant() const
+        { return false; }
+
     /**
       Called after all point views have been processed.  Implement in subclass.
 
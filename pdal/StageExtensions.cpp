@@ -50,6 +50,7 @@ using Extensions = std::map<std::string, StringList>;
 
 static const Extensions readerExtensions =
 {
+  { "readers.arrow", { "feather", "arrow", "parquet", "geoparquet" } },
   {"readers.icebridge", { "icebridge", "h5" } },
   { "readers.matlab", { "mat" } },
   { "readers.numpy", { "npy", "py" } },
@@ -67,6 +68,7 @@ static const Extensions readerExtensions =
 
 static const Extensions writerExtensions =
 {
+  { "writers.arrow", { "feather", "arrow", "parquet", "geoparquet" } },
   { "writers.matlab", { "mat" } },
   { "writers.nitf", { "nitf", "nsf", "ntf" } },
   { "writers.pcd", { "pcd" } },
@@ -0,0 +1,135 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/StageProfile.hpp>
+
+#include <ctime>
+
+namespace pdal
+{
+
+StageProfile::Timer::Timer(StageProfile *profile, Phase phase) :
+    m_profile(profile), m_phase(phase), m_cpuStart(0)
+{
+    if (m_profile)
+    {
+        m_wallStart = std::chrono::steady_clock::now();
+        m_cpuStart = threadCpuTime();
+    }
+}
+
+
+StageProfile::Timer::~Timer()
+{
+    if (m_profile)
+    {
+        std::chrono::duration<double> wall =
+            std::chrono::steady_clock::now() - m_wallStart;
+        m_profile->add(m_phase, wall.count(), threadCpuTime() - m_cpuStart);
+    }
+}
+
+
+StageProfile::StageProfile() : m_pointsIn(0), m_pointsOut(0), m_peakMemory(0)
+{}
+
+
+void StageProfile::add(Phase phase, double wall, double cpu)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Timing& t = m_timings[index(phase)];
+    t.m_wall += wall;
+    t.m_cpu += cpu;
+}
+
+
+void StageProfile::addPoints(point_count_t in, point_count_t out)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pointsIn += in;
+    m_pointsOut += out;
+}
+
+
+void StageProfile::sampleMemory(std::size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_peakMemory = (std::max)(m_peakMemory, bytes);
+}
+
+
+double StageProfile::wallTime() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    double total = 0;
+    for (const Timing& t : m_timings)
+        total += t.m_wall;
+    return total;
+}
+
+
+void StageProfile::toMetadata(MetadataNode& node) const
+{
+    static const char *phaseNames[] =
+        { "ready", "run", "process", "done" };
+
+    double wall = wallTime();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (std::size_t i = 0; i < m_timings.size(); ++i)
+    {
+        MetadataNode phase = node.add(phaseNames[i]);
+        phase.add("wall_time", m_timings[i].m_wall);
+        phase.add("cpu_time", m_timings[i].m_cpu);
+    }
+    node.add("points_in", m_pointsIn);
+    node.add("points_out", m_pointsOut);
+    node.add("points_per_second",
+        wall > 0 ? (std::max)(m_pointsIn, m_pointsOut) / wall : 0.0);
+    node.add("peak_table_memory", m_peakMemory);
+}
+
+
+double StageProfile::threadCpuTime()
+{
+#ifdef _WIN32
+    return (double)std::clock() / CLOCKS_PER_SEC;
+#else
+    timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0)
+        return 0;
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+#endif
+}
+
+} // namespace pdal
@@ -0,0 +1,161 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+
+#include <pdal/Metadata.hpp>
+#include <pdal/pdal_internal.hpp>
+
+namespace pdal
+{
+
+/**
+  Time spent and points handled by a stage while executing a pipeline.
+  Times are recorded by the phase of execution.  Wall and CPU time are
+  summed over all threads that run the stage, so CPU time may exceed wall
+  time when views run concurrently.
+*/
+class PDAL_DLL StageProfile
+{
+public:
+    enum class Phase
+    {
+        Ready,      ///< The stage's ready() function.
+        Run,        ///< Running point views (standard mode).
+        ProcessOne, ///< Processing points (stream mode).
+        Done        ///< The stage's done() function.
+    };
+
+    struct Timing
+    {
+        Timing() : m_wall(0), m_cpu(0)
+        {}
+
+        double m_wall;  ///< Wall clock time in seconds.
+        double m_cpu;   ///< CPU time in seconds.
+    };
+
+    /**
+      Record the time between construction and destruction against
+      a phase of a stage profile.  Nothing is recorded if the profile is
+      null, so a timer can be placed unconditionally.
+    */
+    class PDAL_DLL Timer
+    {
+    public:
+        Timer(StageProfile *profile, Phase phase);
+        ~Timer();
+
+    private:
+        StageProfile *m_profile;
+        Phase m_phase;
+        std::chrono::steady_clock::time_point m_wallStart;
+        double m_cpuStart;
+
+        Timer(const Timer&) = delete;
+        Timer& operator=(const Timer&) = delete;
+    };
+
+    StageProfile();
+
+    /**
+      Add time to a phase.
+
+      \param phase  Phase of execution.
+      \param wall  Wall clock time in seconds.
+      \param cpu  CPU time in seconds.
+    */
+    void add(Phase phase, double wall, double cpu);
+
+    /**
+      Add to the counts of points that entered and left the stage.
+
+      \param in  Number of points passed to the stage.
+      \param out  Number of points produced by the stage.
+    */
+    void addPoints(point_count_t in, point_count_t out);
+
+    /**
+      Note the memory used by the point table.  The largest value is kept.
+
+      \param bytes  Number of bytes of point storage in use.
+    */
+    void sampleMemory(std::size_t bytes);
+
+    const Timing& timing(Phase phase) const
+        { return m_timings[index(phase)]; }
+    point_count_t pointsIn() const
+        { return m_pointsIn; }
+    point_count_t pointsOut() const
+        { return m_pointsOut; }
+    std::size_t peakMemory() const
+        { return m_peakMemory; }
+
+    /**
+      Total wall clock time of all phases.
+
+      \return  Wall clock time in seconds.
+    */
+    double wallTime() const;
+
+    /**
+      Add the profile to a metadata node.
+
+      \param node  Node to which the profile should be added.
+    */
+    void toMetadata(MetadataNode& node) const;
+
+    /**
+      Get the CPU time used by the calling thread.
+
+      \return  CPU time in seconds.
+    */
+    static double threadCpuTime();
+
+private:
+    static std::size_t index(Phase phase)
+        { return static_cast<std::size_t>(phase); }
+
+    std::array<Timing, 4> m_timings;
+    point_count_t m_pointsIn;
+    point_count_t m_pointsOut;
+    std::size_t m_peakMemory;
+    mutable std::mutex m_mutex;
+};
+
+} // namespace pdal
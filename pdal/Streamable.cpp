@@ -34,12 +34,209 @@
 
 #include <iterator>
 
+#include <atomic>
+#include <cstring>
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+#include <thread>
+
 #include <pdal/Streamable.hpp>
 #include <pdal/Reader.hpp>
+#include <pdal/Trace.hpp>
 
 namespace pdal
 {
 
+namespace
+{
+
+// Number of points that each stage of a fused run processes before the
+// next stage takes them.  Small enough that the data of a tile's points
+// stays in cache.
+const point_count_t FusedTileSize = 1024;
+
+// Stream table that shares the layout of the table passed to execute().
+// These tables are passed between threads in pipelined stream execution.
+class BufferPointTable : public StreamPointTable
+{
+public:
+    BufferPointTable(PointLayout& layout, point_count_t capacity) :
+        StreamPointTable(layout, capacity),
+        m_buf(pointsToBytes(capacity + 1))
+    {}
+
+    virtual void finalize()
+    {}
+
+protected:
+    virtual void reset()
+        { std::fill(m_buf.begin(), m_buf.end(), 0); }
+
+    virtual char *getPoint(PointId idx)
+        { return m_buf.data() + pointsToBytes(idx); }
+
+private:
+    std::vector<char> m_buf;
+};
+
+
+// Stream table whose points are appended to a view of a standard table
+// each time the table is cleared.  Points that were skipped aren't copied.
+// The view's table must have the same layout and store points in rows.
+class ViewSinkTable : public StreamPointTable
+{
+public:
+    ViewSinkTable(PointView& view, point_count_t capacity) :
+        StreamPointTable(*view.layout(), capacity), m_view(view),
+        m_buf(pointsToBytes(capacity + 1))
+    {}
+
+    virtual void finalize()
+    {}
+
+protected:
+    virtual void reset()
+    {
+        const std::size_t size = pointsToBytes(1);
+        for (PointId idx = 0; idx < numPoints(); ++idx)
+            if (!skip(idx))
+                std::memcpy(m_view.getOrAddPoint(m_view.size()),
+                    getPoint(idx), size);
+        std::fill(m_buf.begin(), m_buf.end(), 0);
+    }
+
+    virtual char *getPoint(PointId idx)
+        { return m_buf.data() + pointsToBytes(idx); }
+
+private:
+    PointView& m_view;
+    std::vector<char> m_buf;
+};
+
+
+// Points read into a buffer table along with the spatial reference that
+// applies to them.  When branches run in parallel, the batch also records
+// the path it was read on and the worker to which the buffer belongs.
+struct Batch
+{
+    BufferPointTable *m_table;
+    point_count_t m_count;
+    SpatialReference m_srs;
+    bool m_last;
+    size_t m_path;
+    size_t m_worker;
+};
+
+
+class BatchQueue
+{
+public:
+    BatchQueue() : m_closed(false)
+    {}
+
+    void push(const Batch& batch)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_batches.push(batch);
+        m_cv.notify_one();
+    }
+
+    // Wait for a batch.  Returns false if the queue has been closed.
+    bool pop(Batch& batch)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait(lock, [this](){ return m_closed || !m_batches.empty(); });
+        if (m_closed)
+            return false;
+        batch = m_batches.front();
+        m_batches.pop();
+        return true;
+    }
+
+    void close()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_closed = true;
+        m_cv.notify_all();
+    }
+
+private:
+    std::queue<Batch> m_batches;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_closed;
+};
+
+
+// Find the number of stages at the start of each path that aren't part of
+// any other path.  Returns an empty list if any path has no such stages,
+// in which case the paths can't be run independently.
+std::vector<size_t> branchLengths(
+    const std::vector<std::list<Streamable *>>& paths)
+{
+    std::map<Streamable *, size_t> uses;
+    for (auto& path : paths)
+        for (Streamable *s : path)
+            uses[s]++;
+
+    std::vector<size_t> lengths;
+    for (auto& path : paths)
+    {
+        size_t len = 0;
+        for (Streamable *s : path)
+        {
+            if (uses[s] > 1)
+                break;
+            len++;
+        }
+        if (len == 0)
+            return std::vector<size_t>();
+        lengths.push_back(len);
+    }
+    return lengths;
+}
+
+
+using StageRun = std::vector<Streamable *>;
+
+// Divide a sequence of stages into runs of consecutive fusable stages.
+// Stages that aren't fusable, or that are being profiled, are each in a
+// run of their own.
+template<typename IT>
+std::vector<StageRun> fuseStages(IT begin, IT end)
+{
+    std::vector<StageRun> runs;
+    bool fusing = false;
+    for (IT it = begin; it != end; ++it)
+    {
+        Streamable *s = *it;
+        bool fusable = s->fusable() && !s->profile();
+        if (!fusable || !fusing)
+            runs.push_back(StageRun());
+        runs.back().push_back(s);
+        fusing = fusable;
+    }
+    return runs;
+}
+
+
+void logFusion(LogPtr log, const std::vector<StageRun>& runs)
+{
+    for (const StageRun& run : runs)
+    {
+        if (run.size() < 2)
+            continue;
+        auto& out = log->get(LogLevel::Debug);
+        out << "Fusing stages";
+        for (size_t i = 0; i < run.size(); ++i)
+            out << (i ? ", '" : " '") << run[i]->tag() << "'";
+        out << "." << std::endl;
+    }
+}
+
+} // unnamed namespace
+
 Streamable::Streamable()
 {}
 
@@ -70,8 +267,19 @@ const Stage *Streamable::findNonstreamable() const
 // Streamed execution.
 void Streamable::execute(StreamPointTable& table)
 {
+    execute(table, 1);
+}
+
+
+void Streamable::execute(StreamPointTable& table, std::size_t threads)
+{
+    findRequiredDims(table.layout());
+    findPointLimits();
     m_log->get(LogLevel::Debug) << "Executing pipeline in stream mode." <<
         std::endl;
+    if (threads > 1)
+        m_log->get(LogLevel::Debug) << "Running stages on up to " <<
+            threads << " threads." << std::endl;
     struct StreamableList : public std::list<Streamable *>
     {
         StreamableList operator - (const StreamableList& other) const
@@ -91,27 +299,10 @@ void Streamable::execute(StreamPointTable& table)
         };
 
         void ready(PointTableRef& table)
-        {
-            for (auto s : *this)
-            {
-                s->startLogging();
-                s->ready(table);
-                s->stopLogging();
-                SpatialReference srs = s->getSpatialReference();
-                if (!srs.empty())
-                    table.setSpatialReference(srs);
-            }
-        }
+            { readyStages(*this, table); }
 
         void done(PointTableRef& table)
-        {
-            for (auto s : *this)
-            {
-                s->startLogging();
-                s->done(table);
-                s->stopLogging();
-            }
-        }
+            { doneStages(*this, table); }
     };
 
     const Stage *nonstreaming = findNonstreamable();
@@ -119,19 +310,21 @@ void Streamable::execute(StreamPointTable& table)
         nonstreaming->throwError("Attempting to use stream mode with a "
             "stage that doesn't support streaming.");
 
-    SpatialReference srs;
     std::list<StreamableList> lists;
+    std::vector<StreamableList> paths;
     StreamableList stages;
     StreamableList lastRunStages;
 
     table.finalize();
+    m_log->get(LogLevel::Debug) << "Processing up to " << table.capacity() <<
+        " points at a time." << std::endl;
 
     // Walk from the current stage backwards.  As we add each input, copy
     // the list of stages and push it on a list.  We then pull a list from the
     // back of list and keep going.  Pushing on the front and pulling from the
     // back insures that the stages will be executed in the order that they
-    // were added.  If we hit stage with no previous stages, we execute
-    // the stage list.
+    // were added.  If we hit stage with no previous stages, we've found a
+    // complete path from a reader to this stage.
     // All this often amounts to a bunch of list copying for
     // no reason, but it's more simple than what we might otherwise do and
     // this should be a nit in the grand scheme of execution time.
@@ -139,21 +332,12 @@ void Streamable::execute(StreamPointTable& table)
     // As an example, if there are four paths from the end stage (writer) to
     // reader stages, there will be four stage lists and execute(table, stages)
     // will be called four times.
-    SrsMap srsMap;
     Streamable *s = this;
     stages.push_front(s);
     while (true)
     {
         if (s->m_inputs.empty())
-        {
-            // Call done on all the stages we ran last time and aren't
-            // using this time.
-            (lastRunStages - stages).done(table);
-            // Call ready on all the stages we didn't run last time.
-            (stages - lastRunStages).ready(table);
-            execute(table, stages, srsMap);
-            lastRunStages = stages;
-        }
+            paths.push_back(stages);
         else
         {
             for (auto bi = s->m_inputs.rbegin(); bi != s->m_inputs.rend(); bi++)
@@ -164,14 +348,132 @@ void Streamable::execute(StreamPointTable& table)
             }
         }
         if (lists.empty())
-        {
-            lastRunStages.done(table);
             break;
-        }
         stages = lists.front();
         lists.pop_front();
         s = stages.front();
     }
+
+    SrsMap srsMap;
+    std::vector<std::list<Streamable *>> branches;
+    std::vector<size_t> lengths;
+    if (threads > 1 && paths.size() > 1)
+    {
+        branches.assign(paths.begin(), paths.end());
+        lengths = branchLengths(branches);
+    }
+
+    // When the paths are independent up to the stages that they share,
+    // every stage is readied before the branches start and done after they
+    // all finish.  The calls are made in the same order as when the paths
+    // are run one after the other.
+    if (lengths.size())
+    {
+        m_log->get(LogLevel::Debug) << "Running " << paths.size() <<
+            " branches in parallel." << std::endl;
+        for (StreamableList& stages : paths)
+        {
+            (stages - lastRunStages).ready(table);
+            lastRunStages = stages;
+        }
+        executeBranches(table, branches, lengths, srsMap, threads);
+        lastRunStages.clear();
+        for (StreamableList& stages : paths)
+        {
+            (lastRunStages - stages).done(table);
+            lastRunStages = stages;
+        }
+        lastRunStages.done(table);
+        return;
+    }
+
+    for (StreamableList& stages : paths)
+    {
+        // Call done on all the stages we ran last time and aren't
+        // using this time.
+        (lastRunStages - stages).done(table);
+        // Call ready on all the stages we didn't run last time.
+        (stages - lastRunStages).ready(table);
+        if (threads > 1 && stages.size() > 1)
+            execute(table, stages, srsMap, threads);
+        else
+            execute(table, stages, srsMap);
+        lastRunStages = stages;
+    }
+    lastRunStages.done(table);
+}
+
+
+void Streamable::readyStages(const std::list<Streamable *>& stages,
+    PointTableRef table)
+{
+    for (auto s : stages)
+    {
+        s->startLogging();
+        {
+            PDAL_TRACE_SCOPE("stage", s->tag() + " ready");
+            MemoryAccount::Scope memory(&s->memoryAccount());
+            StageProfile::Timer timer(s->profile(),
+                StageProfile::Phase::Ready);
+            s->ready(table);
+        }
+        s->stopLogging();
+        SpatialReference srs = s->getSpatialReference();
+        if (!srs.empty())
+            table.setSpatialReference(srs);
+    }
+}
+
+
+void Streamable::doneStages(const std::list<Streamable *>& stages,
+    PointTableRef table)
+{
+    for (auto s : stages)
+    {
+        s->startLogging();
+        {
+            PDAL_TRACE_SCOPE("stage", s->tag() + " done");
+            MemoryAccount::Scope memory(&s->memoryAccount());
+            StageProfile::Timer timer(s->profile(),
+                StageProfile::Phase::Done);
+            s->done(table);
+        }
+        if (s->profile())
+            s->profile()->sampleMemory(table.memoryUsed());
+        PDAL_LOG(s->log(), LogLevel::Debug) << "Memory held: " <<
+            s->memoryAccount().current() << " bytes (peak " <<
+            s->memoryAccount().peak() << " bytes)" << std::endl;
+        s->stopLogging();
+    }
+}
+
+
+// Stream the points of a reader through the stages that follow it and
+// keep the points that remain in a view of a standard table.  This stage
+// is the last of the stages.
+PointViewPtr Streamable::streamToView(PointTableRef table,
+    const std::vector<Streamable *>& stages)
+{
+    const point_count_t capacity = 65536;
+
+    PointViewPtr view(new PointView(table));
+    ViewSinkTable sink(*view, capacity);
+    std::list<Streamable *> list(stages.begin(), stages.end());
+    SrsMap srsMap;
+
+    auto& out = m_log->get(LogLevel::Debug);
+    out << "Streaming stages";
+    for (size_t i = 0; i < stages.size(); ++i)
+        out << (i ? ", '" : " '") << stages[i]->tag() << "'";
+    out << " into a point view." << std::endl;
+
+    readyStages(list, sink);
+    execute(sink, list, srsMap);
+    doneStages(list, sink);
+
+    MemoryAccount::Scope memory(&memoryAccount());
+    view->chargeMemory();
+    return view;
 }
 
 
@@ -187,13 +489,16 @@ void Streamable::execute(StreamPointTable& table,
     // We may be limited in the number of points requested.
     point_count_t count = (std::numeric_limits<point_count_t>::max)();
     if (Reader *r = dynamic_cast<Reader *>(reader))
-        count = r->count();
+        count = (std::min)(r->count(), r->pointLimit().m_first);
 
     // Build a list of all stages except the first.  We may have a writer in
     // this list in addition to filters, but we treat them in the same way.
     auto begin = stages.begin();
     begin++;
     std::copy(begin, stages.end(), std::back_inserter(filters));
+    std::vector<StageRun> runs = fuseStages(filters.begin(), filters.end());
+    logFusion(m_log, runs);
+    std::mutex srsMutex;
 
     // Loop until we're finished.  We handle the number of points up to
     // the capacity of the StreamPointTable that we've been provided.
@@ -203,23 +508,20 @@ void Streamable::execute(StreamPointTable& table,
     {
         // Clear the spatial reference when processing starts.
         table.clearSpatialReferences();
-        PointId idx = 0;
-        PointRef point(table, idx);
         point_count_t pointLimit = (std::min)(count, table.capacity());
 
         reader->startLogging();
-        // When we get false back from a reader, we're done, so set
+        // When a reader reads fewer points than requested, we're done, so set
         // the point limit to the number of points processed in this loop
         // of the table.
         if (!pointLimit)
             finished = true;
 
-        for (PointId idx = 0; idx < pointLimit; idx++)
+        point_count_t numRead = reader->runBatch(table, pointLimit);
+        if (numRead < pointLimit)
         {
-            point.setPointId(idx);
-            finished = !reader->processOne(point);
-            if (finished)
-                pointLimit = idx;
+            finished = true;
+            pointLimit = numRead;
         }
         count -= pointLimit;
 
@@ -228,11 +530,16 @@ void Streamable::execute(StreamPointTable& table,
         if (!srs.empty())
             table.setSpatialReference(srs);
 
-        // When we get a false back from a filter, we're filtering out a
-        // point, so add it to the list of skips so that it doesn't get
-        // processed by subsequent filters.
-        for (Streamable *s : filters)
+        // Filters mark points that are filtered out as skipped so that
+        // they don't get processed by subsequent filters.
+        for (StageRun& run : runs)
         {
+            if (run.size() > 1)
+            {
+                processRun(run, table, pointLimit, srs, srsMap, srsMutex);
+                continue;
+            }
+            Streamable *s = run.front();
             auto si = srsMap.find(s);
             if (si == srsMap.end() || si->second != srs)
             {
@@ -240,14 +547,7 @@ void Streamable::execute(StreamPointTable& table,
                 srsMap[s] = srs;
             }
             s->startLogging();
-            for (PointId idx = 0; idx < pointLimit; idx++)
-            {
-                if (table.skip(idx))
-                    continue;
-                point.setPointId(idx);
-                if (!s->processOne(point))
-                    table.setSkip(idx);
-            }
+            s->runBatch(table, pointLimit);
             const SpatialReference& tempSrs = s->getSpatialReference();
             if (!tempSrs.empty())
             {
@@ -261,5 +561,483 @@ void Streamable::execute(StreamPointTable& table,
     }
 }
 
+
+// Pipelined execution.  The stages are divided into groups that each run on
+// a thread.  Each group takes a batch of points from its input queue,
+// runs its stages over the batch and passes the batch to the next group.
+// The last group returns the buffer to the first queue, from which the
+// reader's group takes buffers to fill.
+void Streamable::execute(StreamPointTable& table,
+    std::list<Streamable *>& stages, SrsMap& srsMap, std::size_t threads)
+{
+    using StageGroup = std::vector<Streamable *>;
+
+    std::vector<StageGroup> groups((std::min)(threads, stages.size()));
+    size_t pos = 0;
+    for (Streamable *s : stages)
+        groups[pos++ * groups.size() / stages.size()].push_back(s);
+
+    Streamable *reader = stages.front();
+
+    // The stages of each group after the reader, as runs of fused stages.
+    std::vector<std::vector<StageRun>> runs;
+    for (size_t g = 0; g < groups.size(); ++g)
+    {
+        auto begin = groups[g].begin();
+        if (g == 0)
+            begin++;
+        runs.push_back(fuseStages(begin, groups[g].end()));
+        logFusion(m_log, runs.back());
+    }
+
+    // We may be limited in the number of points requested.
+    point_count_t count = (std::numeric_limits<point_count_t>::max)();
+    if (Reader *r = dynamic_cast<Reader *>(reader))
+        count = (std::min)(r->count(), r->pointLimit().m_first);
+
+    // One more buffer than groups so that the reader rarely waits.
+    std::vector<BatchQueue> queues(groups.size());
+    std::vector<std::unique_ptr<BufferPointTable>> tables;
+    for (size_t i = 0; i <= groups.size(); ++i)
+    {
+        tables.emplace_back(
+            new BufferPointTable(*table.layout(), table.capacity()));
+        queues[0].push({ tables.back().get(), 0, SpatialReference(), false,
+            0, 0 });
+    }
+
+    std::mutex srsMutex;
+    std::mutex errorMutex;
+    std::exception_ptr error;
+    SpatialReference lastSrs;
+
+    auto fail = [&]()
+    {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        if (!error)
+            error = std::current_exception();
+        for (BatchQueue& q : queues)
+            q.close();
+    };
+
+    auto process = [&srsMap, &srsMutex](StageRun& run, Batch& batch)
+    {
+        processRun(run, *batch.m_table, batch.m_count, batch.m_srs,
+            srsMap, srsMutex);
+    };
+
+    auto readGroup = [&]()
+    {
+        try
+        {
+            Batch batch;
+            while (queues[0].pop(batch))
+            {
+                BufferPointTable& t = *batch.m_table;
+                t.clearSpatialReferences();
+                point_count_t pointLimit = (std::min)(count, t.capacity());
+                batch.m_count = pointLimit ?
+                    reader->runBatch(t, pointLimit) : 0;
+                batch.m_last = (batch.m_count < pointLimit || !pointLimit);
+                count -= batch.m_count;
+
+                batch.m_srs = reader->getSpatialReference();
+                if (!batch.m_srs.empty())
+                    t.setSpatialReference(batch.m_srs);
+                for (StageRun& run : runs[0])
+                    process(run, batch);
+                queues[1].push(batch);
+                if (batch.m_last)
+                    break;
+            }
+        }
+        catch (...)
+        {
+            fail();
+        }
+    };
+
+    auto filterGroup = [&](size_t g)
+    {
+        try
+        {
+            Batch batch;
+            while (queues[g].pop(batch))
+            {
+                for (StageRun& run : runs[g])
+                    process(run, batch);
+                bool last = batch.m_last;
+                if (g == groups.size() - 1)
+                {
+                    lastSrs = batch.m_srs;
+                    batch.m_table->clear(batch.m_count);
+                    queues[0].push(batch);
+                }
+                else
+                    queues[g + 1].push(batch);
+                if (last)
+                    break;
+            }
+        }
+        catch (...)
+        {
+            fail();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    workers.emplace_back(readGroup);
+    for (size_t g = 1; g < groups.size(); ++g)
+        workers.emplace_back(filterGroup, g);
+    for (std::thread& t : workers)
+        t.join();
+
+    if (error)
+        std::rethrow_exception(error);
+    if (!lastSrs.empty())
+        table.setSpatialReference(lastSrs);
+}
+
+
+// Branch-parallel execution.  The stages at the start of each path that
+// no other path uses run on a worker thread, which fills its own buffers.
+// Filled buffers are passed to the calling thread, which runs the stages
+// that the paths share and returns each buffer to the worker that filled it.
+// Since each worker has a fixed number of buffers, a slow downstream stage
+// holds up the workers rather than letting points pile up.  Paths whose
+// readers have different spatial references are run a group at a time so
+// that the shared stages don't see their points interleaved.
+void Streamable::executeBranches(StreamPointTable& table,
+    std::vector<std::list<Streamable *>>& paths,
+    const std::vector<size_t>& lengths, SrsMap& srsMap, std::size_t threads)
+{
+    using StageGroup = std::vector<Streamable *>;
+
+    std::vector<StageGroup> local(paths.size());
+    std::vector<StageGroup> shared(paths.size());
+    for (size_t p = 0; p < paths.size(); ++p)
+    {
+        size_t pos = 0;
+        for (Streamable *s : paths[p])
+            (pos++ < lengths[p] ? local[p] : shared[p]).push_back(s);
+    }
+
+    // The stages after each reader and the shared stages of each path,
+    // as runs of fused stages.
+    std::vector<std::vector<StageRun>> localRuns;
+    std::vector<std::vector<StageRun>> sharedRuns;
+    for (size_t p = 0; p < paths.size(); ++p)
+    {
+        localRuns.push_back(fuseStages(local[p].begin() + 1, local[p].end()));
+        sharedRuns.push_back(fuseStages(shared[p].begin(), shared[p].end()));
+        logFusion(m_log, localRuns.back());
+    }
+    logFusion(m_log, sharedRuns.front());
+
+    // Two buffers per worker so that a worker can fill one while the
+    // other is being processed by the shared stages.
+    const size_t numWorkers = (std::min)(threads, paths.size());
+    std::vector<BatchQueue> freeQueues(numWorkers);
+    BatchQueue filled;
+    std::vector<std::unique_ptr<BufferPointTable>> tables;
+    for (size_t w = 0; w < numWorkers; ++w)
+        for (size_t i = 0; i < 2; ++i)
+        {
+            tables.emplace_back(
+                new BufferPointTable(*table.layout(), table.capacity()));
+            freeQueues[w].push({ tables.back().get(), 0, SpatialReference(),
+                false, 0, w });
+        }
+
+    // Group the paths by the spatial reference of their readers, in the
+    // order that the spatial references first appear.
+    std::vector<std::vector<size_t>> groups;
+    std::vector<SpatialReference> groupSrs;
+    for (size_t p = 0; p < paths.size(); ++p)
+    {
+        const SpatialReference& srs = local[p].front()->getSpatialReference();
+        size_t g = 0;
+        while (g < groups.size() && groupSrs[g] != srs)
+            g++;
+        if (g == groups.size())
+        {
+            groups.emplace_back();
+            groupSrs.push_back(srs);
+        }
+        groups[g].push_back(p);
+    }
+
+    const std::vector<size_t> *group;
+    std::atomic<size_t> nextPath(0);
+    std::mutex srsMutex;
+    std::mutex errorMutex;
+    std::exception_ptr error;
+    SpatialReference lastSrs;
+
+    auto fail = [&]()
+    {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        if (!error)
+            error = std::current_exception();
+        for (BatchQueue& q : freeQueues)
+            q.close();
+        filled.close();
+    };
+
+    // Each worker runs paths until there are none left, then sends an
+    // empty batch marked as the last to say that it's finished.
+    auto branch = [&](size_t w)
+    {
+        try
+        {
+            size_t i;
+            while ((i = nextPath++) < group->size())
+            {
+                const size_t p = (*group)[i];
+                Streamable *reader = local[p].front();
+
+                point_count_t count =
+                    (std::numeric_limits<point_count_t>::max)();
+                if (Reader *r = dynamic_cast<Reader *>(reader))
+                    count = (std::min)(r->count(), r->pointLimit().m_first);
+
+                bool finished = false;
+                while (!finished)
+                {
+                    Batch batch;
+                    if (!freeQueues[w].pop(batch))
+                        return;
+                    BufferPointTable& t = *batch.m_table;
+                    t.clearSpatialReferences();
+                    point_count_t pointLimit =
+                        (std::min)(count, t.capacity());
+                    batch.m_count = pointLimit ?
+                        reader->runBatch(t, pointLimit) : 0;
+                    finished = (batch.m_count < pointLimit || !pointLimit);
+                    count -= batch.m_count;
+
+                    batch.m_srs = reader->getSpatialReference();
+                    if (!batch.m_srs.empty())
+                        t.setSpatialReference(batch.m_srs);
+                    for (StageRun& run : localRuns[p])
+                        processRun(run, t, batch.m_count, batch.m_srs,
+                            srsMap, srsMutex);
+                    batch.m_path = p;
+                    filled.push(batch);
+                }
+            }
+            filled.push({ nullptr, 0, SpatialReference(), true, 0, w });
+        }
+        catch (...)
+        {
+            fail();
+        }
+    };
+
+    // Every buffer is back in its worker's queue when a group is finished,
+    // so the buffers are used again for the next group.
+    for (const std::vector<size_t>& g : groups)
+    {
+        group = &g;
+        nextPath = 0;
+        std::vector<std::thread> workers;
+        for (size_t w = 0; w < (std::min)(numWorkers, g.size()); ++w)
+            workers.emplace_back(branch, w);
+
+        try
+        {
+            size_t running = workers.size();
+            Batch batch;
+            while (running && filled.pop(batch))
+            {
+                if (batch.m_last)
+                {
+                    running--;
+                    continue;
+                }
+                for (StageRun& run : sharedRuns[batch.m_path])
+                    processRun(run, *batch.m_table, batch.m_count,
+                        batch.m_srs, srsMap, srsMutex);
+                lastSrs = batch.m_srs;
+                batch.m_table->clear(batch.m_count);
+                freeQueues[batch.m_worker].push(batch);
+            }
+        }
+        catch (...)
+        {
+            fail();
+        }
+
+        for (std::thread& t : workers)
+            t.join();
+
+        if (error)
+            std::rethrow_exception(error);
+    }
+    if (!lastSrs.empty())
+        table.setSpatialReference(lastSrs);
+}
+
+
+// Stages that aren't the reader ignore skipped points and mark the
+// points that they filter out.  The SRS map may be shared by threads.
+void Streamable::processStage(Streamable *s, StreamPointTable& table,
+    point_count_t count, SpatialReference& srs, SrsMap& srsMap,
+    std::mutex& srsMutex)
+{
+    bool changed = false;
+    {
+        std::lock_guard<std::mutex> lock(srsMutex);
+        auto si = srsMap.find(s);
+        if (si == srsMap.end() || si->second != srs)
+        {
+            srsMap[s] = srs;
+            changed = true;
+        }
+    }
+    if (changed)
+        s->spatialReferenceChanged(srs);
+    s->runBatch(table, count);
+    const SpatialReference& tempSrs = s->getSpatialReference();
+    if (!tempSrs.empty())
+    {
+        srs = tempSrs;
+        table.setSpatialReference(tempSrs);
+    }
+}
+
+
+// Fused stages process the points of the table a tile at a time, each
+// stage in turn, so that the points of a tile are still in cache when the
+// next stage gets them.  The spatial reference that a fusable stage sets
+// doesn't depend on its points, so each stage is told of the spatial
+// reference that it will see before any points are processed.
+void Streamable::processRun(const std::vector<Streamable *>& run,
+    StreamPointTable& table, point_count_t count, SpatialReference& srs,
+    SrsMap& srsMap, std::mutex& srsMutex)
+{
+    if (run.size() == 1)
+    {
+        processStage(run.front(), table, count, srs, srsMap, srsMutex);
+        return;
+    }
+
+    bool srsSet = false;
+    for (Streamable *s : run)
+    {
+        bool changed = false;
+        {
+            std::lock_guard<std::mutex> lock(srsMutex);
+            auto si = srsMap.find(s);
+            if (si == srsMap.end() || si->second != srs)
+            {
+                srsMap[s] = srs;
+                changed = true;
+            }
+        }
+        if (changed)
+            s->spatialReferenceChanged(srs);
+        const SpatialReference& tempSrs = s->getSpatialReference();
+        if (!tempSrs.empty())
+        {
+            srs = tempSrs;
+            srsSet = true;
+        }
+    }
+    runFused(run, table, count);
+    if (srsSet)
+        table.setSpatialReference(srs);
+}
+
+
+// Run fused stages over the first 'count' points of a table.  Points that
+// a stage skips stay on the active list until the whole run has processed
+// the tile, so the stages check table.skip().
+void Streamable::runFused(const std::vector<Streamable *>& run,
+    StreamPointTable& table, point_count_t count)
+{
+    PDAL_TRACE_SCOPE("batch", run.front()->tag() + " (fused)");
+    for (PointId begin = 0; begin < count; begin += FusedTileSize)
+    {
+        const point_count_t tile = (std::min)(FusedTileSize, count - begin);
+        for (Streamable *s : run)
+        {
+            if (table.activeIds(begin, tile).empty())
+                break;
+            s->startLogging();
+            {
+                MemoryAccount::Scope memory(&s->memoryAccount());
+                s->processBatch(table, begin, tile);
+            }
+            s->stopLogging();
+        }
+    }
+    table.compactActive();
+}
+
+
+// Process the points in a table, timing the stage and counting the points
+// that pass through it when it's being profiled.  The points read by a
+// reader are counted toward the pipeline's progress.
+point_count_t Streamable::runBatch(StreamPointTable& table,
+    point_count_t count)
+{
+    PDAL_TRACE_SCOPE("batch", tag());
+    MemoryAccount::Scope memory(&memoryAccount());
+    const bool reader = readerFillsBatch();
+    StageProfile *profile = this->profile();
+    point_count_t in = (profile && !reader) ?
+        table.activeIds(0, count).size() : 0;
+    point_count_t result;
+    {
+        StageProfile::Timer timer(profile, StageProfile::Phase::ProcessOne);
+        result = processBatch(table, 0, count);
+    }
+
+    // Drop the points that the stage skipped from the table's active list
+    // so that later stages don't visit them.
+    if (reader)
+    {
+        table.setActiveCount(result);
+        readerBatchRead(result);
+    }
+    else
+        table.compactActive();
+
+    if (profile)
+        profile->addPoints(in, reader ? result :
+            table.activeIds(0, count).size());
+    return result;
+}
+
+
+point_count_t Streamable::processBatch(StreamPointTable& table,
+    PointId begin, point_count_t count)
+{
+    PointRef point(table, begin);
+    const PointId end = begin + count;
+
+    if (readerFillsBatch())
+    {
+        for (PointId idx = begin; idx < end; idx++)
+        {
+            point.setPointId(idx);
+            if (!processOne(point))
+                return idx - begin;
+        }
+        return count;
+    }
+
+    for (PointId idx : table.activeIds(begin, count))
+    {
+        if (table.skip(idx))
+            continue;
+        point.setPointId(idx);
+        if (!processOne(point))
+            table.setSkip(idx);
+    }
+    return count;
+}
+
 } // namespace pdal
 
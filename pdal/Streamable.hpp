@@ -34,6 +34,8 @@
 
 #pragma once
 
+#include <mutex>
+
 #include <pdal/pdal_internal.hpp>
 #include <pdal/Stage.hpp>
 
@@ -44,6 +46,7 @@ class StreamableWrapper;
 
 class PDAL_DLL Streamable : public virtual Stage
 {
+    friend class Stage;
     friend class StreamableWrapper;
 public:
     Streamable();
@@ -65,6 +68,36 @@ public:
 
     */
     virtual void execute(StreamPointTable& table);
+
+    /**
+      Execute a prepared pipeline in streaming mode, overlapping the
+      processing of stages.
+
+      When \a threads is greater than one, the stages between a reader and
+      the sink are divided into up to \a threads groups, each run on its
+      own thread.  Buffers of points, each with the layout and capacity of
+      \a table, are passed from one group to the next so that, for example,
+      reading, filtering and writing happen at the same time.  Each stage
+      still sees the points in order and is only ever called from one
+      thread at a time.
+
+      When the pipeline has more than one reader and each reader's path
+      has stages that no other path uses (as when many readers feed a
+      single writer), the paths are instead run in parallel on up to
+      \a threads threads, each with its own buffers.  The stages that the
+      paths share are run on the calling thread.  Points from a single
+      reader reach the shared stages in order, but points from different
+      readers may be interleaved.  Paths whose readers have different
+      spatial references are run one group after another, so points of
+      different spatial references are never interleaved.  All stages are
+      readied before any points are processed and are done after all paths
+      are complete.
+
+      \param table  Streaming point table used for stage pipeline.  This must
+        be the same \ref table used in the \ref prepare function.
+      \param threads  Maximum number of threads used to run the stages.
+    */
+    virtual void execute(StreamPointTable& table, std::size_t threads);
     using Stage::execute;
 
     /**
@@ -74,6 +107,23 @@ public:
     */
     virtual bool pipelineStreamable() const;
 
+    /**
+      Determine whether the stage can be fused with the fusable stages
+      next to it in a pipeline.  Fused stages take turns processing a
+      small tile of points, so a point's data is still in cache when the
+      next stage reads it, rather than each stage making its own pass
+      over the points.
+
+      A fusable stage processes each point without regard to the others,
+      through \ref processBatch, and gives the same result in standard
+      mode as when streaming.  Its spatial reference must not depend on
+      the points that it processes.
+
+      \return  Whether the stage can be fused.
+    */
+    virtual bool fusable() const
+        { return false; }
+
 protected:
     Streamable& operator=(const Streamable&) = delete;
     Streamable(const Streamable&); // not implemented
@@ -82,6 +132,27 @@ protected:
 
     void execute(StreamPointTable& table, std::list<Streamable *>& stages,
         SrsMap& srsMap);
+    void execute(StreamPointTable& table, std::list<Streamable *>& stages,
+        SrsMap& srsMap, std::size_t threads);
+    void executeBranches(StreamPointTable& table,
+        std::vector<std::list<Streamable *>>& paths,
+        const std::vector<size_t>& lengths, SrsMap& srsMap,
+        std::size_t threads);
+    static void processStage(Streamable *s, StreamPointTable& table,
+        point_count_t count, SpatialReference& srs, SrsMap& srsMap,
+        std::mutex& srsMutex);
+    static void processRun(const std::vector<Streamable *>& run,
+        StreamPointTable& table, point_count_t count, SpatialReference& srs,
+        SrsMap& srsMap, std::mutex& srsMutex);
+    static void runFused(const std::vector<Streamable *>& run,
+        StreamPointTable& table, point_count_t count);
+    static void readyStages(const std::list<Streamable *>& stages,
+        PointTableRef table);
+    static void doneStages(const std::list<Streamable *>& stages,
+        PointTableRef table);
+    PointViewPtr streamToView(PointTableRef table,
+        const std::vector<Streamable *>& stages);
+    point_count_t runBatch(StreamPointTable& table, point_count_t count);
 
     /**
       Process a single point (streaming mode).  Implement in subclass.
@@ -92,6 +163,29 @@ protected:
         to subsequent stages).
     */
     virtual bool processOne(PointRef& /*point*/) = 0;
+
+    /**
+      Process a contiguous range of points in a streaming table (streaming
+      mode).  The default implementation calls \ref processOne for each
+      point.  Override when a stage can handle many points at once more
+      efficiently than through individual calls.
+
+      When called for a reader, the points in the range are to be filled
+      with data.  Otherwise, only the points listed by table.activeIds()
+      are to be processed (points for which table.skip() is true must be
+      ignored) and points that are filtered out must be marked with
+      table.setSkip().  When the stage is fused (see \ref fusable), the
+      active points may include points skipped by the stages before it.
+
+      \param table  Table containing the points to process.
+      \param begin  ID of the first point in the range.
+      \param count  Number of points in the range.
+      \return  Readers return the number of points read.  Processing is
+        finished when fewer than \a count points are read.  Others return
+        \a count.
+    */
+    virtual point_count_t processBatch(StreamPointTable& table, PointId begin,
+        point_count_t count);
     /**
     {
         throwStreamingError();
@@ -0,0 +1,203 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/Trace.hpp>
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <pdal/pdal_types.hpp>
+#include <pdal/util/FileUtils.hpp>
+#include <pdal/util/Utils.hpp>
+
+namespace pdal
+{
+
+std::atomic<bool> Trace::s_enabled(false);
+
+namespace
+{
+
+struct Event
+{
+    const char *m_category;
+    std::string m_name;
+    Trace::Clock::time_point m_start;
+    Trace::Clock::time_point m_end;
+};
+
+// Events are buffered per thread so that recording threads don't contend.
+// The buffer's mutex is only contended while events are written.
+struct ThreadEvents
+{
+    ThreadEvents(int id) : m_id(id)
+    {}
+
+    int m_id;
+    std::mutex m_mutex;
+    std::vector<Event> m_events;
+};
+
+struct Registry
+{
+    Registry() : m_epoch(Trace::Clock::now())
+    {}
+
+    std::mutex m_mutex;
+    std::vector<std::shared_ptr<ThreadEvents>> m_threads;
+    Trace::Clock::time_point m_epoch;
+};
+
+// Intentionally leaked so that it outlives threads that record events
+// during static destruction.
+Registry& registry()
+{
+    static Registry *r = new Registry;
+    return *r;
+}
+
+ThreadEvents& threadEvents()
+{
+    thread_local std::shared_ptr<ThreadEvents> events;
+
+    if (!events)
+    {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.m_mutex);
+        events.reset(new ThreadEvents((int)r.m_threads.size() + 1));
+        r.m_threads.push_back(events);
+    }
+    return *events;
+}
+
+} // unnamed namespace
+
+
+Trace::Scope::Scope(const char *category, std::string name) :
+    m_active(Trace::enabled()), m_category(category)
+{
+    if (m_active)
+    {
+        m_name = std::move(name);
+        m_start = Clock::now();
+    }
+}
+
+
+Trace::Scope::~Scope()
+{
+    if (m_active)
+        Trace::record(m_category, m_name, m_start, Clock::now());
+}
+
+
+void Trace::start()
+{
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.m_mutex);
+    for (auto& t : r.m_threads)
+    {
+        std::lock_guard<std::mutex> tlock(t->m_mutex);
+        t->m_events.clear();
+    }
+    r.m_epoch = Clock::now();
+    s_enabled = true;
+}
+
+
+void Trace::stop()
+{
+    s_enabled = false;
+}
+
+
+void Trace::record(const char *category, const std::string& name,
+    Clock::time_point start, Clock::time_point end)
+{
+    ThreadEvents& t = threadEvents();
+    std::lock_guard<std::mutex> lock(t.m_mutex);
+    t.m_events.push_back({ category, name, start, end });
+}
+
+
+void Trace::write(std::ostream& out)
+{
+    auto micros = [](Clock::duration d)
+    {
+        return (long long)
+            std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+    };
+
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.m_mutex);
+
+    out << "{\"traceEvents\":[";
+    bool first = true;
+    for (auto& t : r.m_threads)
+    {
+        std::lock_guard<std::mutex> tlock(t->m_mutex);
+        if (t->m_events.empty())
+            continue;
+
+        if (!first)
+            out << ",";
+        first = false;
+        out << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+            "\"tid\":" << t->m_id << ",\"args\":{\"name\":\"thread " <<
+            t->m_id << "\"}}";
+        for (const Event& e : t->m_events)
+        {
+            out << ",\n{\"name\":\"" << Utils::escapeJSON(e.m_name) <<
+                "\",\"cat\":\"" << e.m_category << "\",\"ph\":\"X\","
+                "\"ts\":" << micros(e.m_start - r.m_epoch) <<
+                ",\"dur\":" << micros(e.m_end - e.m_start) <<
+                ",\"pid\":1,\"tid\":" << t->m_id << "}";
+        }
+    }
+    out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+
+void Trace::write(const std::string& filename)
+{
+    std::ostream *out = FileUtils::createFile(filename, false);
+    if (!out)
+        throw pdal_error("Can't open file '" + filename +
+            "' for trace output.");
+    write(*out);
+    FileUtils::closeFile(out);
+}
+
+} // namespace pdal
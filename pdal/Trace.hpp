@@ -0,0 +1,135 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <ostream>
+#include <string>
+
+#include <pdal/pdal_internal.hpp>
+
+namespace pdal
+{
+
+/**
+  Process-wide recorder of timed events, written as a Chrome trace-event
+  file that can be loaded in chrome://tracing or Perfetto.  Recording is
+  off by default.  When off, a trace scope costs a single atomic load.
+*/
+class PDAL_DLL Trace
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+      Record the time between construction and destruction as an event on
+      the calling thread.  Nothing is recorded if tracing was off when the
+      scope was created.
+    */
+    class PDAL_DLL Scope
+    {
+    public:
+        Scope(const char *category, std::string name);
+        ~Scope();
+
+    private:
+        bool m_active;
+        const char *m_category;
+        std::string m_name;
+        Clock::time_point m_start;
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+    /**
+      Start recording events.  Any previously recorded events are
+      discarded.
+    */
+    static void start();
+
+    /**
+      Stop recording events.
+    */
+    static void stop();
+
+    /**
+      Determine if events are being recorded.
+    */
+    static bool enabled()
+        { return s_enabled.load(std::memory_order_relaxed); }
+
+    /**
+      Record an event on the calling thread.
+
+      \param category  Category of the event.
+      \param name  Name of the event.
+      \param start  Start time of the event.
+      \param end  End time of the event.
+    */
+    static void record(const char *category, const std::string& name,
+        Clock::time_point start, Clock::time_point end);
+
+    /**
+      Write the recorded events in Chrome trace-event JSON format.
+
+      \param out  Output stream.
+    */
+    static void write(std::ostream& out);
+
+    /**
+      Write the recorded events in Chrome trace-event JSON format.
+
+      \param filename  Name of output file.
+    */
+    static void write(const std::string& filename);
+
+private:
+    static std::atomic<bool> s_enabled;
+};
+
+} // namespace pdal
+
+#define PDAL_TRACE_CONCAT_(a, b) a ## b
+#define PDAL_TRACE_CONCAT(a, b) PDAL_TRACE_CONCAT_(a, b)
+
+/**
+  Trace the rest of the enclosing block.  \a name is only evaluated when
+  tracing is on.
+*/
+#define PDAL_TRACE_SCOPE(category, name) \
+    pdal::Trace::Scope PDAL_TRACE_CONCAT(pdal_trace_scope_, __LINE__)( \
+        category, pdal::Trace::enabled() ? std::string(name) : std::string())
@@ -0,0 +1,186 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include "BlockCompression.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+
+#include <pdal/Trace.hpp>
+#include <pdal/util/TaskScheduler.hpp>
+
+namespace pdal
+{
+
+namespace
+{
+
+// Wait for a frame to be coded, running pending tasks in the meantime so
+// that the frame is coded even if every worker is busy.
+void await(std::future<std::vector<char>>& f)
+{
+    TaskScheduler& scheduler = TaskScheduler::instance();
+    while (f.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        if (!scheduler.runOne())
+            f.wait_for(std::chrono::milliseconds(1));
+}
+
+} // unnamed namespace
+
+
+BlockCoder::BlockCoder(BlockCb cb, Coder coder) : m_cb(cb),
+    m_maxPending(2 * threads())
+{
+    m_coder = [coder](const char *buf, size_t bufsize)
+    {
+        PDAL_TRACE_SCOPE("compression", "block");
+        return coder(buf, bufsize);
+    };
+}
+
+
+BlockCoder::~BlockCoder()
+{
+    // Queued tasks refer to m_coder, so wait for any still in flight.
+    for (auto& f : m_pending)
+        if (f.valid())
+            await(f);
+}
+
+
+size_t BlockCoder::threads()
+{
+    return TaskScheduler::instance().concurrency();
+}
+
+
+void BlockCoder::add(std::vector<char> frame)
+{
+    if (threads() == 1)
+    {
+        emit(m_coder(frame.data(), frame.size()));
+        return;
+    }
+
+    using Task = std::packaged_task<std::vector<char>()>;
+    Coder& coder = m_coder;
+    auto data = std::make_shared<std::vector<char>>(std::move(frame));
+    auto task = std::make_shared<Task>([&coder, data]()
+        { return coder(data->data(), data->size()); });
+    m_pending.push_back(task->get_future());
+    TaskScheduler::instance().submit([task](){ (*task)(); });
+
+    emit(false);
+    while (m_pending.size() > m_maxPending)
+    {
+        await(m_pending.front());
+        emit(false);
+    }
+}
+
+
+void BlockCoder::last(std::vector<char> frame)
+{
+    if (m_pending.empty())
+        emit(m_coder(frame.data(), frame.size()));
+    else
+        add(std::move(frame));
+    done();
+}
+
+
+void BlockCoder::done()
+{
+    emit(true);
+}
+
+
+void BlockCoder::emit(bool wait)
+{
+    while (m_pending.size())
+    {
+        std::future<std::vector<char>>& f = m_pending.front();
+        if (!wait &&
+            f.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            break;
+        await(f);
+        std::vector<char> coded = f.get();
+        m_pending.pop_front();
+        emit(std::move(coded));
+    }
+}
+
+
+void BlockCoder::emit(std::vector<char> coded)
+{
+    if (coded.size())
+        m_cb(coded.data(), coded.size());
+}
+
+
+BlockCompressor::BlockCompressor(BlockCb cb, BlockCoder::Coder coder,
+        size_t frameSize) : m_coder(cb, coder), m_frameSize(frameSize)
+{
+    m_frame.reserve(m_frameSize);
+}
+
+
+void BlockCompressor::compress(const char *buf, size_t bufsize)
+{
+    while (bufsize)
+    {
+        size_t count = (std::min)(bufsize, m_frameSize - m_frame.size());
+        m_frame.insert(m_frame.end(), buf, buf + count);
+        buf += count;
+        bufsize -= count;
+        if (m_frame.size() == m_frameSize)
+        {
+            m_coder.add(std::move(m_frame));
+            m_frame = std::vector<char>();
+            m_frame.reserve(m_frameSize);
+        }
+    }
+}
+
+
+void BlockCompressor::done()
+{
+    if (m_frame.size())
+        m_coder.last(std::move(m_frame));
+    else
+        m_coder.done();
+    m_frame = std::vector<char>();
+}
+
+} // namespace pdal
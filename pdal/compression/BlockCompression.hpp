@@ -0,0 +1,122 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include "Compression.hpp"
+
+#include <deque>
+#include <future>
+#include <vector>
+
+namespace pdal
+{
+
+/**
+  Code independent frames on the TaskScheduler and hand the results to a
+  block callback in the order the frames were added.
+*/
+class PDAL_DLL BlockCoder
+{
+public:
+    using Coder = std::function<std::vector<char>(const char *buf,
+        size_t bufsize)>;
+
+    /**
+      \param cb  Callback invoked (on the calling thread) with each coded
+        frame, in order.
+      \param coder  Function that codes one frame.  It is run concurrently
+        and must not depend on other frames.
+    */
+    BlockCoder(BlockCb cb, Coder coder);
+    ~BlockCoder();
+
+    /**
+      Queue a frame for coding.  Frames that have completed are passed to
+      the callback.  Blocks when too many frames are in flight.
+
+      \param frame  Frame to code.
+    */
+    void add(std::vector<char> frame);
+
+    /**
+      Code the final frame and wait for all frames to be emitted.  If no
+      other frame is outstanding the frame is coded on the calling thread.
+
+      \param frame  Final frame to code.
+    */
+    void last(std::vector<char> frame);
+
+    /**
+      Wait for all queued frames to be coded and passed to the callback.
+    */
+    void done();
+
+    /**
+      Number of frames that can be coded at once (the TaskScheduler's
+      concurrency).
+    */
+    static size_t threads();
+
+private:
+    void emit(bool wait);
+    void emit(std::vector<char> coded);
+
+    BlockCb m_cb;
+    Coder m_coder;
+    std::deque<std::future<std::vector<char>>> m_pending;
+    size_t m_maxPending;
+};
+
+
+/**
+  Compressor that splits its input into CHUNKSIZE frames and compresses
+  each frame independently with a BlockCoder.  The output is the
+  concatenation of the compressed frames.
+*/
+class PDAL_DLL BlockCompressor : public Compressor
+{
+public:
+    BlockCompressor(BlockCb cb, BlockCoder::Coder coder,
+        size_t frameSize = CHUNKSIZE);
+
+    void compress(const char *buf, size_t bufsize);
+    void done();
+
+private:
+    BlockCoder m_coder;
+    size_t m_frameSize;
+    std::vector<char> m_frame;
+};
+
+} // namespace pdal
@@ -45,6 +45,7 @@ enum class CompressionType
 //    Ght = 1,   -- Removed compression type
     Dimensional = 2,
     Lazperf = 3,
+    Delta = 4,
     Unknown = 256
 };
 
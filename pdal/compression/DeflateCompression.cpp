@@ -42,12 +42,15 @@ namespace pdal
 class DeflateCompressorImpl
 {
 public:
-    DeflateCompressorImpl(BlockCb cb) : m_cb(cb)
+    DeflateCompressorImpl(BlockCb cb, bool gzip) : m_cb(cb)
     {
         m_strm.zalloc = Z_NULL;
         m_strm.zfree = Z_NULL;
         m_strm.opaque = Z_NULL;
-        switch (deflateInit(&m_strm, Z_DEFAULT_COMPRESSION))
+        // Adding 16 to the window bits selects the gzip wrapper.
+        int windowBits = gzip ? MAX_WBITS + 16 : MAX_WBITS;
+        switch (deflateInit2(&m_strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+            windowBits, 8, Z_DEFAULT_STRATEGY))
         {
         case Z_OK:
             return;
@@ -126,7 +129,12 @@ private:
 
 
 DeflateCompressor::DeflateCompressor(BlockCb cb) :
-    m_impl(new DeflateCompressorImpl(cb))
+    m_impl(new DeflateCompressorImpl(cb, false))
+{}
+
+
+DeflateCompressor::DeflateCompressor(BlockCb cb, bool gzip) :
+    m_impl(new DeflateCompressorImpl(cb, gzip))
 {}
 
 
@@ -44,6 +44,9 @@ class DeflateCompressor : public Compressor
 {
 public:
     PDAL_DLL DeflateCompressor(BlockCb cb);
+    // Write a gzip header and trailer instead of the zlib wrapper if
+    // 'gzip' is true.
+    PDAL_DLL DeflateCompressor(BlockCb cb, bool gzip);
     PDAL_DLL ~DeflateCompressor();
 
     PDAL_DLL void compress(const char *buf, size_t bufsize);
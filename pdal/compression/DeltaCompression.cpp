@@ -0,0 +1,444 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include "DeltaCompression.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace pdal
+{
+
+namespace
+{
+
+// Points per encoded block.  Each block carries its own bit widths, so
+// smaller blocks adapt better to local variation at a small cost in
+// header bytes.
+const size_t BlockPoints = 1024;
+
+struct Field
+{
+    size_t offset;
+    size_t size;
+    bool floating;
+    bool isSigned;
+};
+
+std::vector<Field> fields(const DimTypeList& dims, size_t& pointSize)
+{
+    std::vector<Field> out;
+    pointSize = 0;
+    for (const DimType& dt : dims)
+    {
+        Field f;
+        f.offset = pointSize;
+        f.size = Dimension::size(dt.m_type);
+        f.floating = Dimension::base(dt.m_type) == Dimension::BaseType::Floating;
+        f.isSigned = Dimension::base(dt.m_type) == Dimension::BaseType::Signed;
+        if (f.size == 0 || f.size > sizeof(uint64_t))
+            throw compression_error("Invalid dimension type for delta "
+                "compression.");
+        pointSize += f.size;
+        out.push_back(f);
+    }
+    if (out.empty())
+        throw compression_error("No dimensions for delta compression.");
+    return out;
+}
+
+// Read a value as 64 bits, sign-extending signed integers so that deltas
+// across zero stay small.
+inline uint64_t load(const char *p, const Field& f)
+{
+    uint64_t v = 0;
+    memcpy(&v, p, f.size);
+    if (f.isSigned && f.size < sizeof(uint64_t))
+    {
+        const int shift = (int)(64 - 8 * f.size);
+        v = (uint64_t)((int64_t)(v << shift) >> shift);
+    }
+    return v;
+}
+
+inline void store(char *p, uint64_t v, const Field& f)
+{
+    memcpy(p, &v, f.size);
+}
+
+inline uint64_t zigzag(uint64_t d)
+{
+    return (d << 1) ^ (uint64_t)((int64_t)d >> 63);
+}
+
+inline uint64_t unzigzag(uint64_t z)
+{
+    return (z >> 1) ^ (0 - (z & 1));
+}
+
+inline int bitWidth(uint64_t v)
+{
+    int w = 0;
+    while (v)
+    {
+        w++;
+        v >>= 1;
+    }
+    return w;
+}
+
+inline size_t packedSize(size_t count, int width)
+{
+    return (count * width + 7) / 8;
+}
+
+template<typename T>
+void put(std::vector<char>& out, T v)
+{
+    const char *p = reinterpret_cast<const char *>(&v);
+    out.insert(out.end(), p, p + sizeof(T));
+}
+
+template<typename T>
+T get(const char *p)
+{
+    T v;
+    memcpy(&v, p, sizeof(T));
+    return v;
+}
+
+// Pack the low 'width' bits of each value, least significant bits first.
+void pack(const uint64_t *vals, size_t count, int width,
+    std::vector<char>& out)
+{
+    if (width == 0)
+        return;
+
+    const size_t start = out.size();
+    out.resize(start + packedSize(count, width) + sizeof(uint64_t));
+    char *p = out.data() + start;
+
+    uint64_t acc = 0;
+    int bits = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const uint64_t v = vals[i];
+        acc |= v << bits;
+        if (bits + width >= 64)
+        {
+            memcpy(p, &acc, sizeof(acc));
+            p += sizeof(acc);
+            acc = bits ? v >> (64 - bits) : 0;
+            bits = bits + width - 64;
+        }
+        else
+            bits += width;
+    }
+    memcpy(p, &acc, sizeof(acc));
+    out.resize(start + packedSize(count, width));
+}
+
+// Reads values written by pack().
+class BitReader
+{
+public:
+    BitReader(const char *buf, size_t size) : m_pos(buf), m_end(buf + size),
+        m_acc(0), m_bits(0)
+    {}
+
+    uint64_t get(int width)
+    {
+        if (m_bits >= width)
+        {
+            const uint64_t v = m_acc & mask(width);
+            m_acc = width == 64 ? 0 : m_acc >> width;
+            m_bits -= width;
+            return v;
+        }
+
+        uint64_t v = m_acc;
+        const int got = m_bits;
+        refill();
+        const int need = width - got;
+        v |= (m_acc & mask(need)) << got;
+        m_acc = need == 64 ? 0 : m_acc >> need;
+        m_bits -= need;
+        return v;
+    }
+
+private:
+    static uint64_t mask(int width)
+        { return width == 64 ? ~(uint64_t)0 : ((uint64_t)1 << width) - 1; }
+
+    void refill()
+    {
+        const size_t avail = (std::min)((size_t)(m_end - m_pos),
+            sizeof(uint64_t));
+        m_acc = 0;
+        memcpy(&m_acc, m_pos, avail);
+        m_pos += avail;
+        m_bits = 64;
+    }
+
+    const char *m_pos;
+    const char *m_end;
+    uint64_t m_acc;
+    int m_bits;
+};
+
+} // unnamed namespace
+
+
+// Each block is written as:
+//   uint32 byte count of the rest of the block
+//   uint32 number of points
+//   for each dimension:
+//     uint8 bit width of the residuals
+//     the first value, as stored in the point
+//     the packed residuals of the remaining points
+class DeltaCompressorImpl
+{
+public:
+    DeltaCompressorImpl(BlockCb cb, const DimTypeList& dims) : m_cb(cb),
+        m_fields(fields(dims, m_pointSize))
+    {
+        m_buf.reserve(BlockPoints * m_pointSize);
+        m_residuals.resize(BlockPoints);
+    }
+
+    void compress(const char *buf, size_t bufsize)
+    {
+        const size_t blockSize = BlockPoints * m_pointSize;
+        while (bufsize)
+        {
+            size_t count = (std::min)(bufsize, blockSize - m_buf.size());
+            m_buf.insert(m_buf.end(), buf, buf + count);
+            buf += count;
+            bufsize -= count;
+            if (m_buf.size() == blockSize)
+                encode();
+        }
+    }
+
+    void done()
+    {
+        if (m_buf.size() % m_pointSize)
+            throw compression_error("Delta compression input is not a "
+                "whole number of points.");
+        if (m_buf.size())
+            encode();
+    }
+
+private:
+    void encode()
+    {
+        const size_t numPoints = m_buf.size() / m_pointSize;
+        const char *pts = m_buf.data();
+
+        m_out.clear();
+        put<uint32_t>(m_out, 0);
+        put<uint32_t>(m_out, (uint32_t)numPoints);
+        for (const Field& f : m_fields)
+        {
+            const char *p = pts + f.offset;
+            uint64_t prev = load(p, f);
+            uint64_t all = 0;
+            for (size_t i = 1; i < numPoints; ++i)
+            {
+                p += m_pointSize;
+                const uint64_t v = load(p, f);
+                const uint64_t r = f.floating ? v ^ prev : zigzag(v - prev);
+                m_residuals[i - 1] = r;
+                all |= r;
+                prev = v;
+            }
+            const int width = bitWidth(all);
+            m_out.push_back((char)width);
+            m_out.insert(m_out.end(), pts + f.offset,
+                pts + f.offset + f.size);
+            pack(m_residuals.data(), numPoints - 1, width, m_out);
+        }
+        const uint32_t blockBytes = (uint32_t)(m_out.size() - sizeof(uint32_t));
+        memcpy(m_out.data(), &blockBytes, sizeof(blockBytes));
+
+        m_cb(m_out.data(), m_out.size());
+        m_buf.clear();
+    }
+
+    BlockCb m_cb;
+    size_t m_pointSize;
+    std::vector<Field> m_fields;
+    std::vector<char> m_buf;
+    std::vector<char> m_out;
+    std::vector<uint64_t> m_residuals;
+};
+
+
+DeltaCompressor::DeltaCompressor(BlockCb cb, const DimTypeList& dims) :
+    m_impl(new DeltaCompressorImpl(cb, dims))
+{}
+
+
+DeltaCompressor::~DeltaCompressor()
+{}
+
+
+void DeltaCompressor::compress(const char *buf, size_t bufsize)
+{
+    m_impl->compress(buf, bufsize);
+}
+
+
+void DeltaCompressor::done()
+{
+    m_impl->done();
+}
+
+
+class DeltaDecompressorImpl
+{
+public:
+    DeltaDecompressorImpl(BlockCb cb, const DimTypeList& dims) : m_cb(cb),
+        m_fields(fields(dims, m_pointSize))
+    {}
+
+    void decompress(const char *buf, size_t bufsize)
+    {
+        // Decode whole blocks straight from the caller's buffer and keep
+        // any partial block until the rest arrives.
+        if (m_in.size())
+        {
+            m_in.insert(m_in.end(), buf, buf + bufsize);
+            size_t used = decodeBlocks(m_in.data(), m_in.size());
+            m_in.erase(m_in.begin(), m_in.begin() + used);
+        }
+        else
+        {
+            size_t used = decodeBlocks(buf, bufsize);
+            m_in.assign(buf + used, buf + bufsize);
+        }
+    }
+
+    void done()
+    {
+        if (m_in.size())
+            throw compression_error("Delta compressed data is truncated.");
+    }
+
+private:
+    size_t decodeBlocks(const char *buf, size_t bufsize)
+    {
+        size_t pos = 0;
+        while (bufsize - pos >= sizeof(uint32_t))
+        {
+            const size_t blockBytes = get<uint32_t>(buf + pos);
+            if (bufsize - pos - sizeof(uint32_t) < blockBytes)
+                break;
+            pos += sizeof(uint32_t);
+            decode(buf + pos, blockBytes);
+            pos += blockBytes;
+        }
+        return pos;
+    }
+
+    void decode(const char *buf, size_t size)
+    {
+        const char *end = buf + size;
+        auto need = [&buf, end](size_t count)
+        {
+            if ((size_t)(end - buf) < count)
+                throw compression_error("Invalid delta compressed block.");
+        };
+
+        need(sizeof(uint32_t));
+        const size_t numPoints = get<uint32_t>(buf);
+        buf += sizeof(uint32_t);
+        if (numPoints == 0)
+            throw compression_error("Invalid delta compressed block.");
+
+        m_out.resize(numPoints * m_pointSize);
+        for (const Field& f : m_fields)
+        {
+            need(1 + f.size);
+            const int width = (uint8_t)*buf++;
+            if (width > 64)
+                throw compression_error("Invalid delta compressed block.");
+            char *p = m_out.data() + f.offset;
+            memcpy(p, buf, f.size);
+            uint64_t prev = load(buf, f);
+            buf += f.size;
+
+            const size_t packed = packedSize(numPoints - 1, width);
+            need(packed);
+            BitReader reader(buf, packed);
+            for (size_t i = 1; i < numPoints; ++i)
+            {
+                p += m_pointSize;
+                const uint64_t r = width ? reader.get(width) : 0;
+                prev = f.floating ? prev ^ r : prev + unzigzag(r);
+                store(p, prev, f);
+            }
+            buf += packed;
+        }
+        m_cb(m_out.data(), m_out.size());
+    }
+
+    BlockCb m_cb;
+    size_t m_pointSize;
+    std::vector<Field> m_fields;
+    std::vector<char> m_in;
+    std::vector<char> m_out;
+};
+
+
+DeltaDecompressor::DeltaDecompressor(BlockCb cb, const DimTypeList& dims) :
+    m_impl(new DeltaDecompressorImpl(cb, dims))
+{}
+
+
+DeltaDecompressor::~DeltaDecompressor()
+{}
+
+
+void DeltaDecompressor::decompress(const char *buf, size_t bufsize)
+{
+    m_impl->decompress(buf, bufsize);
+}
+
+
+void DeltaDecompressor::done()
+{
+    m_impl->done();
+}
+
+} // namespace pdal
@@ -54,6 +54,14 @@
 #pragma pop_macro("max")
 #pragma pop_macro("min")
 
+#include <deque>
+#include <future>
+#include <limits>
+#include <sstream>
+
+#include <pdal/pdal_types.hpp>
+#include <pdal/util/IStream.hpp>
+
 #include "LazPerfVlrCompression.hpp"
 
 namespace pdal
@@ -78,15 +86,15 @@ class LazPerfVlrCompressorImpl
 
 public:
     LazPerfVlrCompressorImpl(std::ostream& stream, const Schema& schema,
-            uint32_t chunksize) :
+            uint32_t chunksize, int threads) :
         m_stream(stream), m_outputStream(stream), m_schema(schema),
         m_chunksize(chunksize), m_chunkPointsWritten(0), m_chunkInfoPos(0),
-        m_chunkOffset(0)
+        m_chunkOffset(0), m_threads(threads), m_started(false)
     {}
 
     ~LazPerfVlrCompressorImpl()
     {
-        if (m_encoder)
+        if (m_encoder || m_pending.size())
             std::cerr << "LazPerfVlrCompressor destroyed without a call "
                "to done()";
     }
@@ -94,14 +102,16 @@ public:
 
     void compress(const char *inbuf)
     {
+        if (m_threads > 1)
+        {
+            queuePoint(inbuf);
+            return;
+        }
+
         // First time through.
         if (!m_encoder || !m_compressor)
         {
-            // Get the position
-            m_chunkInfoPos = m_stream.tellp();
-            // Seek over the chunk info offset value
-            m_stream.seekp(sizeof(uint64_t), std::ios::cur);
-            m_chunkOffset = m_stream.tellp();
+            start();
             resetCompressor();
         }
         else if (m_chunkPointsWritten == m_chunksize)
@@ -115,11 +125,23 @@ public:
 
     void done()
     {
-        // Close and clear the point encoder.
-        m_encoder->done();
-        m_encoder.reset();
+        if (m_threads > 1)
+        {
+            if (!m_started)
+                start();
+            if (m_chunkPointsWritten)
+                queueChunk();
+            while (m_pending.size())
+                writeChunk();
+        }
+        else
+        {
+            // Close and clear the point encoder.
+            m_encoder->done();
+            m_encoder.reset();
 
-        newChunk();
+            newChunk();
+        }
 
         // Save our current position.  Go to the location where we need
         // to write the chunk table offset at the beginning of the point data.
@@ -152,6 +174,72 @@ public:
     }
 
 private:
+    void start()
+    {
+        // Get the position
+        m_chunkInfoPos = m_stream.tellp();
+        // Seek over the chunk info offset value
+        m_stream.seekp(sizeof(uint64_t), std::ios::cur);
+        m_chunkOffset = m_stream.tellp();
+        m_started = true;
+    }
+
+    // When compressing with more than one thread, points are collected
+    // into chunks and each chunk is compressed into its own buffer by a
+    // separate task.  Since every chunk starts with a fresh encoder, the
+    // bytes are the same as those written by the serial path.  Finished
+    // chunks are written to the stream in order and at most 'threads'
+    // chunks are in flight at once.
+    void queuePoint(const char *inbuf)
+    {
+        if (!m_started)
+            start();
+
+        size_t pointSize = (size_t)m_schema.size_in_bytes();
+        if (m_chunkPointsWritten == 0)
+            m_chunkBuf.reserve(pointSize * m_chunksize);
+        m_chunkBuf.insert(m_chunkBuf.end(), inbuf, inbuf + pointSize);
+        if (++m_chunkPointsWritten == m_chunksize)
+            queueChunk();
+    }
+
+    void queueChunk()
+    {
+        while (m_pending.size() >= (size_t)m_threads)
+            writeChunk();
+
+        std::vector<char> buf;
+        buf.swap(m_chunkBuf);
+        m_pending.push_back(std::async(std::launch::async,
+            &LazPerfVlrCompressorImpl::compressChunk, this, std::move(buf)));
+        m_chunkPointsWritten = 0;
+    }
+
+    std::string compressChunk(std::vector<char> buf) const
+    {
+        std::ostringstream oss;
+        OutputStream outputStream(oss);
+        Encoder encoder(outputStream);
+        Compressor::ptr compressor =
+            laszip::factory::build_compressor(encoder, m_schema);
+
+        size_t pointSize = (size_t)m_schema.size_in_bytes();
+        for (const char *pos = buf.data(); pos < buf.data() + buf.size();
+                pos += pointSize)
+            compressor->compress(pos);
+        encoder.done();
+        return oss.str();
+    }
+
+    void writeChunk()
+    {
+        std::string chunk = m_pending.front().get();
+        m_pending.pop_front();
+        m_stream.write(chunk.data(), chunk.size());
+        m_chunkTable.push_back((uint32_t)chunk.size());
+        m_chunkOffset = m_stream.tellp();
+    }
+
     void resetCompressor()
     {
         if (m_encoder)
@@ -178,12 +266,16 @@ private:
     std::streampos m_chunkInfoPos;
     std::streampos m_chunkOffset;
     std::vector<uint32_t> m_chunkTable;
+    int m_threads;
+    bool m_started;
+    std::vector<char> m_chunkBuf;
+    std::deque<std::future<std::string>> m_pending;
 };
 
 
 LazPerfVlrCompressor::LazPerfVlrCompressor(std::ostream& stream,
-        const Schema& schema, uint32_t chunksize) :
-    m_impl(new LazPerfVlrCompressorImpl(stream, schema, chunksize))
+        const Schema& schema, uint32_t chunksize, int threads) :
+    m_impl(new LazPerfVlrCompressorImpl(stream, schema, chunksize, threads))
 {}
 
 
@@ -203,6 +295,42 @@ void LazPerfVlrCompressor::done()
 }
 
 
+void writeLazChunkTable(std::ostream& stream,
+    const std::vector<uint32_t>& sizes, const std::vector<uint32_t>& counts)
+{
+    typedef laszip::io::__ofstream_wrapper<std::ostream> OutputStream;
+    typedef laszip::encoders::arithmetic<OutputStream> Encoder;
+
+    if (counts.size() && counts.size() != sizes.size())
+        throw pdal_error("Mismatched LAZ chunk table entries.");
+
+    OLeStream out(&stream);
+    out << (uint32_t)0;  // Version
+    out << (uint32_t)sizes.size();
+
+    OutputStream outputStream(stream);
+    Encoder encoder(outputStream);
+    laszip::compressors::integer compressor(32, 2);
+    compressor.init();
+
+    // Each entry is predicted from the previous one.  Point counts use
+    // context 0 and byte sizes use context 1.
+    uint32_t countPredictor = 0;
+    uint32_t sizePredictor = 0;
+    for (size_t i = 0; i < sizes.size(); ++i)
+    {
+        if (counts.size())
+        {
+            compressor.compress(encoder, countPredictor, counts[i], 0);
+            countPredictor = counts[i];
+        }
+        compressor.compress(encoder, sizePredictor, sizes[i], 1);
+        sizePredictor = sizes[i];
+    }
+    encoder.done();
+}
+
+
 class LazPerfVlrDecompressorImpl
 {
 public:
@@ -274,5 +402,144 @@ void LazPerfVlrDecompressor::decompress(char *outbuf)
     m_impl->decompress(outbuf);
 }
 
+
+class LazPerfVlrChunkDecompressorImpl
+{
+    typedef laszip::io::__ifstream_wrapper<std::istream> InputStream;
+    typedef laszip::decoders::arithmetic<InputStream> Decoder;
+    typedef laszip::formats::dynamic_decompressor Decompressor;
+    typedef laszip::factory::record_schema Schema;
+
+public:
+    LazPerfVlrChunkDecompressorImpl(std::istream& stream,
+            const char *vlrData, std::streamoff pointOffset,
+            uint64_t numPoints) : m_numPoints(numPoints)
+    {
+        laszip::io::laz_vlr zipvlr(vlrData);
+        m_chunksize = zipvlr.chunk_size;
+        m_schema = laszip::io::laz_vlr::to_schema(zipvlr);
+        if (m_chunksize == 0 ||
+                m_chunksize == (std::numeric_limits<uint32_t>::max)())
+            throw pdal_error("Can't decompress variable-sized LAZ chunks "
+                "independently.");
+
+        ILeStream in(&stream);
+        int64_t tableOffset;
+
+        stream.seekg(pointOffset);
+        in >> tableOffset;
+        if (!stream || tableOffset == -1)
+            throw pdal_error("LAZ file has no chunk table.");
+
+        uint32_t version;
+        uint32_t count;
+
+        stream.seekg(tableOffset);
+        in >> version >> count;
+        if (!stream || version != 0)
+            throw pdal_error("Invalid LAZ chunk table.");
+        if (count < (m_numPoints + m_chunksize - 1) / m_chunksize)
+            throw pdal_error("LAZ chunk table doesn't cover all points.");
+
+        // Chunk sizes are stored compressed, each predicted from the
+        // previous one.
+        InputStream inputStream(stream);
+        Decoder decoder(inputStream);
+        decoder.readInitBytes();
+        laszip::decompressors::integer decomp(32, 2);
+        decomp.init();
+
+        std::streamoff start = pointOffset + sizeof(int64_t);
+        int32_t predictor = 0;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            m_chunkStarts.push_back(start);
+            predictor = decomp.decompress(decoder, predictor, 1);
+            start += (uint32_t)predictor;
+        }
+        if (!stream)
+            throw pdal_error("Unable to read LAZ chunk table.");
+    }
+
+    size_t pointSize() const
+        { return (size_t)m_schema.size_in_bytes(); }
+
+    uint64_t chunkSize() const
+        { return m_chunksize; }
+
+    size_t chunkCount() const
+        { return (size_t)((m_numPoints + m_chunksize - 1) / m_chunksize); }
+
+    void decompress(size_t chunk, std::istream& stream,
+        std::vector<char>& outbuf) const
+    {
+        if (chunk >= chunkCount())
+            throw pdal_error("Invalid LAZ chunk requested.");
+
+        uint64_t first = chunk * m_chunksize;
+        uint64_t count = (std::min)((uint64_t)m_chunksize,
+            m_numPoints - first);
+        size_t size = pointSize();
+
+        outbuf.resize((size_t)count * size);
+        stream.seekg(m_chunkStarts[chunk]);
+
+        InputStream inputStream(stream);
+        Decoder decoder(inputStream);
+        Decompressor::ptr decompressor =
+            laszip::factory::build_decompressor(decoder, m_schema);
+        char *pos = outbuf.data();
+        for (uint64_t i = 0; i < count; ++i)
+        {
+            decompressor->decompress(pos);
+            pos += size;
+        }
+        if (!stream)
+            throw pdal_error("Unable to read LAZ chunk.");
+    }
+
+private:
+    uint64_t m_numPoints;
+    uint32_t m_chunksize;
+    Schema m_schema;
+    std::vector<std::streamoff> m_chunkStarts;
+};
+
+LazPerfVlrChunkDecompressor::LazPerfVlrChunkDecompressor(
+        std::istream& stream, const char *vlrData, std::streamoff pointOffset,
+        uint64_t numPoints) :
+    m_impl(new LazPerfVlrChunkDecompressorImpl(stream, vlrData, pointOffset,
+        numPoints))
+{}
+
+
+LazPerfVlrChunkDecompressor::~LazPerfVlrChunkDecompressor()
+{}
+
+
+size_t LazPerfVlrChunkDecompressor::pointSize() const
+{
+    return m_impl->pointSize();
+}
+
+
+uint64_t LazPerfVlrChunkDecompressor::chunkSize() const
+{
+    return m_impl->chunkSize();
+}
+
+
+size_t LazPerfVlrChunkDecompressor::chunkCount() const
+{
+    return m_impl->chunkCount();
+}
+
+
+void LazPerfVlrChunkDecompressor::decompress(size_t chunk,
+    std::istream& stream, std::vector<char>& outbuf) const
+{
+    m_impl->decompress(chunk, stream, outbuf);
+}
+
 } // namespace pdal
 
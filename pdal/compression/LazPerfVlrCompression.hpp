@@ -34,6 +34,7 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 #include <pdal/util/OStream.hpp>
 
 namespace laszip
@@ -58,13 +59,15 @@ namespace pdal
 // The compressor uses the schema of the point data in order to compress
 // the point stream.  The schema is also stored in a VLR that isn't
 // handled as part of the compression process itself.
+// When 'threads' is greater than one, chunks are compressed concurrently
+// and written in order.  The output is identical to single-threaded output.
 class LazPerfVlrCompressor
 {
     typedef laszip::factory::record_schema Schema;
 
 public:
     PDAL_DLL LazPerfVlrCompressor(std::ostream& stream, const Schema& schema,
-        uint32_t chunksize);
+        uint32_t chunksize, int threads = 1);
     PDAL_DLL ~LazPerfVlrCompressor();
 
     PDAL_DLL void compress(const char *inbuf);
@@ -75,6 +78,15 @@ private:
 };
 
 
+// Write a LAZ chunk table at the current position of the stream.  'sizes'
+// holds the size in bytes of each chunk.  For files with variable-sized
+// chunks, 'counts' holds the number of points in each chunk.  For files
+// with fixed-sized chunks it should be empty.
+PDAL_DLL void writeLazChunkTable(std::ostream& stream,
+    const std::vector<uint32_t>& sizes,
+    const std::vector<uint32_t>& counts = std::vector<uint32_t>());
+
+
 class LazPerfVlrDecompressorImpl;
 
 class LazPerfVlrDecompressor
@@ -91,5 +103,30 @@ private:
     std::unique_ptr<LazPerfVlrDecompressorImpl> m_impl;
 };
 
+
+class LazPerfVlrChunkDecompressorImpl;
+
+// This decompressor reads the chunk table written by LazPerfVlrCompressor
+// (or LASzip) and decompresses any chunk independently of the others.
+// The caller supplies the stream to read for each chunk, so several chunks
+// can be decompressed at once from different threads, each with its own
+// stream.  Only files with a fixed chunk size are supported.
+class LazPerfVlrChunkDecompressor
+{
+public:
+    PDAL_DLL LazPerfVlrChunkDecompressor(std::istream& stream,
+        const char *vlrData, std::streamoff pointOffset, uint64_t numPoints);
+    PDAL_DLL ~LazPerfVlrChunkDecompressor();
+
+    PDAL_DLL size_t pointSize() const;
+    PDAL_DLL uint64_t chunkSize() const;
+    PDAL_DLL size_t chunkCount() const;
+    PDAL_DLL void decompress(size_t chunk, std::istream& stream,
+        std::vector<char>& outbuf) const;
+
+private:
+    std::unique_ptr<LazPerfVlrChunkDecompressorImpl> m_impl;
+};
+
 } // namespace pdal
 
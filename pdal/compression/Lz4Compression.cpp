@@ -0,0 +1,206 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include "Lz4Compression.hpp"
+
+#include <algorithm>
+#include <vector>
+
+#include <lz4frame.h>
+
+namespace pdal
+{
+
+namespace
+{
+
+size_t check(size_t ret)
+{
+    if (LZ4F_isError(ret))
+        throw compression_error(LZ4F_getErrorName(ret));
+    return ret;
+}
+
+} // unnamed namespace
+
+class Lz4CompressorImpl
+{
+public:
+    Lz4CompressorImpl(BlockCb cb) : m_cb(cb), m_started(false)
+    {
+        check(LZ4F_createCompressionContext(&m_ctx, LZ4F_VERSION));
+        m_prefs = LZ4F_preferences_t();
+        m_prefs.frameInfo.blockSizeID = LZ4F_max4MB;
+        m_prefs.frameInfo.contentChecksumFlag = LZ4F_contentChecksumEnabled;
+    }
+
+    ~Lz4CompressorImpl()
+    {
+        LZ4F_freeCompressionContext(m_ctx);
+    }
+
+    void compress(const char *buf, size_t bufsize)
+    {
+        start();
+        while (bufsize)
+        {
+            size_t count = (std::min)(bufsize, CHUNKSIZE);
+            size_t written = check(LZ4F_compressUpdate(m_ctx, m_tmpbuf.data(),
+                m_tmpbuf.size(), buf, count, nullptr));
+            if (written)
+                m_cb(m_tmpbuf.data(), written);
+            buf += count;
+            bufsize -= count;
+        }
+    }
+
+    void done()
+    {
+        start();
+        size_t written = check(LZ4F_compressEnd(m_ctx, m_tmpbuf.data(),
+            m_tmpbuf.size(), nullptr));
+        if (written)
+            m_cb(m_tmpbuf.data(), written);
+        m_started = false;
+    }
+
+private:
+    // Write the frame header.  This also sizes the output buffer to hold
+    // the result of compressing CHUNKSIZE bytes.
+    void start()
+    {
+        if (m_started)
+            return;
+        m_tmpbuf.resize((std::max)(LZ4F_compressBound(CHUNKSIZE, &m_prefs),
+            (size_t)LZ4F_HEADER_SIZE_MAX));
+        size_t written = check(LZ4F_compressBegin(m_ctx, m_tmpbuf.data(),
+            m_tmpbuf.size(), &m_prefs));
+        m_cb(m_tmpbuf.data(), written);
+        m_started = true;
+    }
+
+    BlockCb m_cb;
+    bool m_started;
+    LZ4F_cctx *m_ctx;
+    LZ4F_preferences_t m_prefs;
+    std::vector<char> m_tmpbuf;
+};
+
+
+Lz4Compressor::Lz4Compressor(BlockCb cb) : m_impl(new Lz4CompressorImpl(cb))
+{}
+
+
+Lz4Compressor::~Lz4Compressor()
+{}
+
+
+void Lz4Compressor::compress(const char *buf, size_t bufsize)
+{
+    m_impl->compress(buf, bufsize);
+}
+
+
+void Lz4Compressor::done()
+{
+    m_impl->done();
+}
+
+
+class Lz4DecompressorImpl
+{
+public:
+    Lz4DecompressorImpl(BlockCb cb) : m_cb(cb), m_tmpbuf(CHUNKSIZE),
+        m_pending(0)
+    {
+        check(LZ4F_createDecompressionContext(&m_ctx, LZ4F_VERSION));
+    }
+
+    ~Lz4DecompressorImpl()
+    {
+        LZ4F_freeDecompressionContext(m_ctx);
+    }
+
+    void decompress(const char *buf, size_t bufsize)
+    {
+        // Keep going while there's input or the decoder has buffered output.
+        do
+        {
+            size_t outSize = m_tmpbuf.size();
+            size_t inSize = bufsize;
+            m_pending = check(LZ4F_decompress(m_ctx, m_tmpbuf.data(),
+                &outSize, buf, &inSize, nullptr));
+            if (outSize)
+                m_cb(m_tmpbuf.data(), outSize);
+            buf += inSize;
+            bufsize -= inSize;
+            if (!inSize && !outSize)
+                break;
+        } while (bufsize || m_pending);
+    }
+
+    void done()
+    {
+        if (m_pending)
+            throw compression_error("LZ4 compressed data is truncated.");
+    }
+
+private:
+    BlockCb m_cb;
+    LZ4F_dctx *m_ctx;
+    std::vector<char> m_tmpbuf;
+    size_t m_pending;
+};
+
+
+Lz4Decompressor::Lz4Decompressor(BlockCb cb) :
+    m_impl(new Lz4DecompressorImpl(cb))
+{}
+
+
+Lz4Decompressor::~Lz4Decompressor()
+{}
+
+
+void Lz4Decompressor::decompress(const char *buf, size_t bufsize)
+{
+    m_impl->decompress(buf, bufsize);
+}
+
+
+void Lz4Decompressor::done()
+{
+    m_impl->done();
+}
+
+} // namespace pdal
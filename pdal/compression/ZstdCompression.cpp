@@ -33,62 +33,102 @@
 ****************************************************************************/
 
 #include "ZstdCompression.hpp"
+#include "BlockCompression.hpp"
 
 #include <zstd.h>
 
 namespace pdal
 {
 
-class ZstdCompressorImpl
+namespace
 {
-public:
-    ZSTD_CStream *m_strm;
-    ZSTD_inBuffer m_inBuf;
-    char m_tmpbuf[CHUNKSIZE];
-    BlockCb m_cb;
 
-    ZstdCompressorImpl(BlockCb cb, int compressionLevel) : m_cb(cb)
+// Contexts are reused by each thread that codes frames.
+struct CCtxDeleter
+{
+    void operator()(ZSTD_CCtx *ctx) const
+        { ZSTD_freeCCtx(ctx); }
+};
+
+struct DCtxDeleter
+{
+    void operator()(ZSTD_DCtx *ctx) const
+        { ZSTD_freeDCtx(ctx); }
+};
+
+std::vector<char> compressFrame(const char *buf, size_t bufsize, int level)
+{
+    thread_local std::unique_ptr<ZSTD_CCtx, CCtxDeleter>
+        ctx(ZSTD_createCCtx());
+
+    std::vector<char> out(ZSTD_compressBound(bufsize));
+    size_t ret = ZSTD_compressCCtx(ctx.get(), out.data(), out.size(),
+        buf, bufsize, level);
+    if (ZSTD_isError(ret))
+        throw compression_error(ZSTD_getErrorName(ret));
+    out.resize(ret);
+    return out;
+}
+
+#if ZSTD_VERSION_NUMBER >= 10400
+std::vector<char> decompressFrame(const char *buf, size_t bufsize)
+{
+    thread_local std::unique_ptr<ZSTD_DCtx, DCtxDeleter>
+        ctx(ZSTD_createDCtx());
+
+    std::vector<char> out;
+    unsigned long long size = ZSTD_getFrameContentSize(buf, bufsize);
+    if (size != ZSTD_CONTENTSIZE_UNKNOWN && size != ZSTD_CONTENTSIZE_ERROR)
     {
-        m_strm = ZSTD_createCStream();
-        ZSTD_initCStream(m_strm, compressionLevel);
+        out.resize((size_t)size);
+        size_t ret = ZSTD_decompressDCtx(ctx.get(), out.data(), out.size(),
+            buf, bufsize);
+        if (ZSTD_isError(ret))
+            throw compression_error(ZSTD_getErrorName(ret));
+        out.resize(ret);
+        return out;
     }
 
-    ~ZstdCompressorImpl()
-    { ZSTD_freeCStream(m_strm); }
+    // Frame written without its content size - stream it.
+    ZSTD_DCtx_reset(ctx.get(), ZSTD_reset_session_only);
+    ZSTD_inBuffer inBuf { buf, bufsize, 0 };
+    std::vector<char> tmpbuf(CHUNKSIZE);
+    size_t ret;
+    do
+    {
+        ZSTD_outBuffer outBuf { tmpbuf.data(), tmpbuf.size(), 0 };
+        ret = ZSTD_decompressStream(ctx.get(), &outBuf, &inBuf);
+        if (ZSTD_isError(ret))
+            throw compression_error(ZSTD_getErrorName(ret));
+        out.insert(out.end(), tmpbuf.data(), tmpbuf.data() + outBuf.pos);
+    } while (inBuf.pos != inBuf.size);
+    return out;
+}
+#endif
+
+} // unnamed namespace
+
+class ZstdCompressorImpl
+{
+public:
+    ZstdCompressorImpl(BlockCb cb, int compressionLevel) :
+        m_block(cb, [compressionLevel](const char *buf, size_t bufsize)
+            { return compressFrame(buf, bufsize, compressionLevel); })
+    {}
 
     void compress(const char *buf, size_t bufsize)
     {
-        m_inBuf.src = reinterpret_cast<const void *>(buf);
-        m_inBuf.size = bufsize;
-        m_inBuf.pos = 0;
-
-        size_t ret;
-        do
-        {
-            ZSTD_outBuffer outBuf
-            { reinterpret_cast<void *>(m_tmpbuf), CHUNKSIZE, 0 };
-            ret = ZSTD_compressStream(m_strm, &outBuf, &m_inBuf);
-            if (ZSTD_isError(ret))
-                break;
-            if (outBuf.pos)
-                m_cb(m_tmpbuf, outBuf.pos);
-        } while (m_inBuf.pos != m_inBuf.size);
+        m_block.compress(buf, bufsize);
     }
 
     void done()
     {
-        size_t ret;
-        do
-        {
-            ZSTD_outBuffer outBuf
-                { reinterpret_cast<void *>(m_tmpbuf), CHUNKSIZE, 0 };
-            ret = ZSTD_endStream(m_strm, &outBuf);
-            if (ZSTD_isError(ret))
-                break;
-            if (outBuf.pos)
-                m_cb(m_tmpbuf, outBuf.pos);
-        } while (ret);
+        m_block.done();
     }
+
+private:
+    // Each CHUNKSIZE block of input is written as its own zstd frame.
+    BlockCompressor m_block;
 };
 
 ZstdCompressor::ZstdCompressor(BlockCb cb) :
@@ -120,7 +160,7 @@ void ZstdCompressor::done()
 class ZstdDecompressorImpl
 {
 public:
-    ZstdDecompressorImpl(BlockCb cb) : m_cb(cb)
+    ZstdDecompressorImpl(BlockCb cb) : m_cb(cb), m_streaming(false)
     {
         m_strm = ZSTD_createDStream();
         ZSTD_initDStream(m_strm);
@@ -133,6 +173,43 @@ public:
 
     void decompress(const char *buf, size_t bufsize)
     {
+#if ZSTD_VERSION_NUMBER >= 10400
+        // When the input starts on a frame boundary, decode the complete
+        // frames it contains concurrently.  Anything left over is streamed.
+        if (!m_streaming)
+        {
+            std::vector<size_t> frames;
+            size_t pos = 0;
+            while (pos < bufsize)
+            {
+                size_t size =
+                    ZSTD_findFrameCompressedSize(buf + pos, bufsize - pos);
+                if (ZSTD_isError(size))
+                    break;
+                frames.push_back(size);
+                pos += size;
+            }
+            if (frames.size() > 1)
+            {
+                BlockCoder coder(m_cb, decompressFrame);
+                for (size_t size : frames)
+                {
+                    coder.add(std::vector<char>(buf, buf + size));
+                    buf += size;
+                }
+                coder.done();
+                bufsize -= pos;
+            }
+        }
+#endif
+        if (bufsize)
+            stream(buf, bufsize);
+    }
+
+private:
+    void stream(const char *buf, size_t bufsize)
+    {
+        m_streaming = true;
         m_inBuf.src = reinterpret_cast<const void *>(buf);
         m_inBuf.size = bufsize;
         m_inBuf.pos = 0;
@@ -150,8 +227,8 @@ public:
         } while (m_inBuf.pos != m_inBuf.size);
     }
 
-private:
     BlockCb m_cb;
+    bool m_streaming;
 
     ZSTD_DStream *m_strm;
     ZSTD_inBuffer m_inBuf;
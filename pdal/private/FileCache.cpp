@@ -0,0 +1,271 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include "FileCache.hpp"
+
+#include <algorithm>
+#include <ctime>
+#include <iterator>
+#include <sstream>
+
+#include <arbiter/arbiter.hpp>
+
+#include <pdal/pdal_types.hpp>
+#include <pdal/util/FileUtils.hpp>
+#include <pdal/util/Utils.hpp>
+
+namespace pdal
+{
+
+namespace
+{
+
+const std::string tempExt(".tmp");
+
+// Temporary files older than this were left by a writer that died and
+// are removed when the cache is scanned.
+const std::time_t staleTempAge = 3600;
+
+} // unnamed namespace
+
+
+FileCache::FileCache(const std::string& dir, uint64_t maxSize,
+        const std::string& ext) :
+    m_dir(dir), m_ext(ext), m_maxSize(maxSize), m_size(0), m_added(0)
+{
+    if (!FileUtils::directoryExists(m_dir) &&
+            !FileUtils::createDirectories(m_dir))
+        throw pdal_error("Unable to create cache directory '" + m_dir +
+            "'.");
+
+    std::random_device rd;
+    m_random.seed(((uint64_t)rd() << 32) ^ rd() ^
+        (uint64_t)std::time(nullptr));
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    scan();
+}
+
+
+std::string FileCache::filename(const std::string& key) const
+{
+    return m_dir + "/" +
+        arbiter::crypto::encodeAsHex(arbiter::crypto::sha256(key)) + m_ext;
+}
+
+
+std::string FileCache::file(const std::string& key)
+{
+    // Touching the entry both marks it as recently used and tells us that
+    // it exists.
+    std::string name = filename(key);
+    if (!FileUtils::touchFile(name))
+        return std::string();
+    return name;
+}
+
+
+bool FileCache::get(const std::string& key, std::vector<char>& data)
+{
+    std::string name = file(key);
+    if (name.empty())
+        return false;
+
+    // The entry may have been evicted by another reader since it was
+    // touched.
+    std::istream *in = FileUtils::openFile(name);
+    if (!in)
+        return false;
+    data.assign(std::istreambuf_iterator<char>(*in),
+        std::istreambuf_iterator<char>());
+    bool ok = !in->bad();
+    FileUtils::closeFile(in);
+    return ok;
+}
+
+
+void FileCache::put(const std::string& key, const std::vector<char>& data)
+{
+    if (data.size() > m_maxSize)
+        return;
+
+    put(key, [&data](std::ostream& out)
+    {
+        out.write(data.data(), data.size());
+        return true;
+    });
+}
+
+
+bool FileCache::put(const std::string& key,
+    const std::function<bool(std::ostream&)>& write)
+{
+    const std::string name = filename(key);
+    std::string temp;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::ostringstream oss;
+        oss << name << "." << std::hex << m_random() << tempExt;
+        temp = oss.str();
+    }
+
+    std::ostream *out = FileUtils::createFile(temp);
+    if (!out)
+        return false;
+    bool ok;
+    try
+    {
+        ok = write(*out) && out->good();
+    }
+    catch (...)
+    {
+        FileUtils::closeFile(out);
+        FileUtils::deleteFile(temp);
+        throw;
+    }
+    FileUtils::closeFile(out);
+
+    uintmax_t size = 0;
+    try
+    {
+        if (ok)
+            size = FileUtils::fileSize(temp);
+        // An entry larger than the cache would only evict everything else.
+        if (ok && size <= m_maxSize)
+            FileUtils::renameFile(name, temp);
+        else
+        {
+            ok = false;
+            FileUtils::deleteFile(temp);
+        }
+    }
+    catch (const std::exception&)
+    {
+        ok = false;
+        try
+        {
+            FileUtils::deleteFile(temp);
+        }
+        catch (const std::exception&)
+        {}
+    }
+    if (!ok)
+        return false;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_size += size;
+    m_added += size;
+
+    // Other readers sharing the directory add entries that we don't see,
+    // so rescan periodically as well as when we think we're over the limit.
+    if (m_size > m_maxSize || m_added > m_maxSize / 10)
+        scan();
+    return true;
+}
+
+
+// Total the size of the entries in the cache directory and, if the total
+// exceeds the size limit, remove the least recently used
+// entries until the cache is at 90% of the limit.  Must be called with
+// m_mutex held.
+void FileCache::scan()
+{
+    struct Entry
+    {
+        std::string m_name;
+        uintmax_t m_size;
+        std::time_t m_time;
+    };
+
+    std::vector<Entry> entries;
+    const std::time_t now = std::time(nullptr);
+
+    m_size = 0;
+    m_added = 0;
+    for (const std::string& name : FileUtils::directoryList(m_dir))
+    {
+        std::time_t t = FileUtils::lastWriteTime(name);
+        if (Utils::endsWith(name, tempExt))
+        {
+            if (t && now - t > staleTempAge)
+            {
+                try
+                {
+                    FileUtils::deleteFile(name);
+                }
+                catch (const std::exception&)
+                {}
+            }
+            continue;
+        }
+        if (!Utils::endsWith(name, m_ext))
+            continue;
+
+        uintmax_t size;
+        try
+        {
+            size = FileUtils::fileSize(name);
+        }
+        catch (const std::exception&)
+        {
+            // Removed by another reader.
+            continue;
+        }
+        entries.push_back({ name, size, t });
+        m_size += size;
+    }
+
+    if (m_size <= m_maxSize)
+        return;
+
+    std::sort(entries.begin(), entries.end(),
+        [](const Entry& e1, const Entry& e2){ return e1.m_time < e2.m_time; });
+
+    const uint64_t target = m_maxSize - m_maxSize / 10;
+    for (const Entry& e : entries)
+    {
+        if (m_size <= target)
+            break;
+        try
+        {
+            // An entry that someone else has already removed is no longer
+            // counted either way.
+            FileUtils::deleteFile(e.m_name);
+        }
+        catch (const std::exception&)
+        {}
+        m_size -= e.m_size;
+    }
+}
+
+} // namespace pdal
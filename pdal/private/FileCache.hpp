@@ -0,0 +1,97 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <pdal/pdal_internal.hpp>
+
+namespace pdal
+{
+
+// A size-bounded, least-recently-used cache of data stored as files in a
+// local directory.  Entries are written to a temporary file and renamed
+// into place, so a cache directory may be shared by any number of readers,
+// in this process or others, without locking.  File modification times
+// track use and the least recently used entries are removed when the
+// directory grows beyond its size limit.
+class PDAL_DLL FileCache
+{
+public:
+    // Entries are stored in files whose names end with 'ext'.  Only such
+    // files count toward the size limit and are evicted.
+    FileCache(const std::string& dir, uint64_t maxSize,
+        const std::string& ext);
+
+    // Fill 'data' with the entry stored for 'key'.  Returns false if there
+    // is no such entry.
+    bool get(const std::string& key, std::vector<char>& data);
+
+    // Return the name of the file holding the entry for 'key' or an empty
+    // string if there is no such entry.
+    std::string file(const std::string& key);
+
+    // Store 'data' as the entry for 'key'.  Failure to write the entry isn't
+    // an error - the data just isn't cached.
+    void put(const std::string& key, const std::vector<char>& data);
+
+    // Store the data written by 'write' as the entry for 'key'.  If 'write'
+    // returns false or throws, nothing is stored.  Returns whether the
+    // entry was stored.
+    bool put(const std::string& key,
+        const std::function<bool(std::ostream&)>& write);
+
+    uint64_t maxSize() const
+        { return m_maxSize; }
+
+private:
+    std::string filename(const std::string& key) const;
+    void scan();
+
+    std::string m_dir;
+    std::string m_ext;
+    uint64_t m_maxSize;
+    uint64_t m_size;
+    uint64_t m_added;
+    std::mt19937_64 m_random;
+    std::mutex m_mutex;
+};
+
+} // namespace pdal
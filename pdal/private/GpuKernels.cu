@@ -0,0 +1,621 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include "GpuKernels.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <vector>
+
+#include <cuda_runtime.h>
+
+namespace pdal
+{
+namespace gpu
+{
+namespace cuda
+{
+
+namespace
+{
+
+// Average number of points in a cell of the grid.
+const double PointsPerCell = 4.0;
+
+// Number of threads in a block of a kernel launch.
+const int BlockSize = 128;
+
+// Device memory that's freed when it goes out of scope.  Resizing only
+// reallocates when the buffer grows.
+template<typename T>
+class DeviceBuffer
+{
+public:
+    DeviceBuffer() : m_data(nullptr), m_size(0)
+    {}
+
+    ~DeviceBuffer()
+    {
+        if (m_data)
+            cudaFree(m_data);
+    }
+
+    bool resize(std::size_t size)
+    {
+        if (size <= m_size)
+            return true;
+        if (m_data)
+            cudaFree(m_data);
+        m_data = nullptr;
+        m_size = 0;
+        if (cudaMalloc(&m_data, size * sizeof(T)) != cudaSuccess)
+        {
+            m_data = nullptr;
+            return false;
+        }
+        m_size = size;
+        return true;
+    }
+
+    bool upload(const T *src, std::size_t count)
+    {
+        return resize(count) && cudaMemcpy(m_data, src, count * sizeof(T),
+            cudaMemcpyHostToDevice) == cudaSuccess;
+    }
+
+    bool download(T *dst, std::size_t count) const
+    {
+        return cudaMemcpy(dst, m_data, count * sizeof(T),
+            cudaMemcpyDeviceToHost) == cudaSuccess;
+    }
+
+    T *data() const
+        { return m_data; }
+
+private:
+    T *m_data;
+    std::size_t m_size;
+
+    DeviceBuffer(const DeviceBuffer&);
+    DeviceBuffer& operator=(const DeviceBuffer&);
+};
+
+// Buffers of the results of the queries of a host thread, kept between
+// queries so that memory isn't allocated for each batch.
+struct Scratch
+{
+    DeviceBuffer<uint64_t> ids;
+    DeviceBuffer<double> dists;
+    DeviceBuffer<std::size_t> offsets;
+    DeviceBuffer<double> results;
+    DeviceBuffer<uint8_t> valid;
+};
+
+thread_local Scratch scratch;
+
+// Uniform grid of cubic cells over a set of points.  Unused axes of 2D
+// points have a single cell.
+struct Grid
+{
+    int dim;
+    double min[3];
+    double cellSize;
+    double invCellSize;
+    int cells[3];
+};
+
+__host__ __device__ inline int cellPos(const Grid& g, double v, int axis)
+{
+    int c = (int)floor((v - g.min[axis]) * g.invCellSize);
+    return c < 0 ? 0 : (c >= g.cells[axis] ? g.cells[axis] - 1 : c);
+}
+
+__host__ __device__ inline std::size_t cellIndex(const Grid& g, const int *c)
+{
+    return ((std::size_t)c[2] * g.cells[1] + c[1]) * g.cells[0] + c[0];
+}
+
+__host__ __device__ inline std::size_t numBlocks(std::size_t count)
+{
+    return (count + BlockSize - 1) / BlockSize;
+}
+
+// Find the k nearest neighbors of a query point by searching rings of
+// cells of growing size around the query point's cell.  The search stops
+// once no point outside the searched cells can be closer than the k'th
+// nearest neighbor found.
+__global__ void knnKernel(Grid g, const double *coords, const double *sorted,
+    const uint64_t *sortedIds, const uint64_t *cellStart, std::size_t begin,
+    std::size_t count, int k, uint64_t *outIds, double *outDists)
+{
+    const std::size_t t = blockIdx.x * (std::size_t)blockDim.x + threadIdx.x;
+    if (t >= count)
+        return;
+
+    const int dim = g.dim;
+    double q[3] = { 0, 0, 0 };
+    int c[3] = { 0, 0, 0 };
+    for (int a = 0; a < dim; ++a)
+    {
+        q[a] = coords[(begin + t) * dim + a];
+        c[a] = cellPos(g, q[a], a);
+    }
+
+    double bestDist[maxK];
+    uint64_t bestId[maxK];
+    int found = 0;
+
+    int maxRing = 0;
+    for (int a = 0; a < dim; ++a)
+        maxRing = max(maxRing, max(c[a], g.cells[a] - 1 - c[a]));
+    for (int r = 0; r <= maxRing; ++r)
+    {
+        const int zr = (dim == 3) ? r : 0;
+        for (int dz = -zr; dz <= zr; ++dz)
+            for (int dy = -r; dy <= r; ++dy)
+            {
+                // The cells inside the previous ring have been searched, so
+                // a row that isn't on a face of the ring only has new cells
+                // at its ends.
+                const bool face = abs(dy) == r || (dim == 3 && abs(dz) == r);
+                const int step = (face || r == 0) ? 1 : 2 * r;
+                for (int dx = -r; dx <= r; dx += step)
+                {
+                    const int cc[3] = { c[0] + dx, c[1] + dy, c[2] + dz };
+                    if (cc[0] < 0 || cc[0] >= g.cells[0] ||
+                        cc[1] < 0 || cc[1] >= g.cells[1] ||
+                        cc[2] < 0 || cc[2] >= g.cells[2])
+                        continue;
+
+                    const std::size_t cell = cellIndex(g, cc);
+                    for (uint64_t p = cellStart[cell];
+                        p < cellStart[cell + 1]; ++p)
+                    {
+                        double d = 0;
+                        for (int a = 0; a < dim; ++a)
+                        {
+                            const double diff = sorted[p * dim + a] - q[a];
+                            d += diff * diff;
+                        }
+
+                        int pos;
+                        if (found < k)
+                            pos = found++;
+                        else if (d < bestDist[k - 1])
+                            pos = k - 1;
+                        else
+                            continue;
+                        while (pos > 0 && bestDist[pos - 1] > d)
+                        {
+                            bestDist[pos] = bestDist[pos - 1];
+                            bestId[pos] = bestId[pos - 1];
+                            pos--;
+                        }
+                        bestDist[pos] = d;
+                        bestId[pos] = sortedIds[p];
+                    }
+                }
+            }
+
+        if (found < k)
+            continue;
+
+        // Points that haven't been searched are outside the cube of cells
+        // searched so far.  Sides of the cube on the edge of the grid have
+        // no points beyond them.  The margin covers rounding in the
+        // assignment of points to cells.
+        double gap = DBL_MAX;
+        for (int a = 0; a < dim; ++a)
+        {
+            if (c[a] - r > 0)
+                gap = fmin(gap, q[a] - (g.min[a] + (c[a] - r) * g.cellSize));
+            if (c[a] + r < g.cells[a] - 1)
+                gap = fmin(gap,
+                    g.min[a] + (c[a] + r + 1) * g.cellSize - q[a]);
+        }
+        gap -= g.cellSize * 1e-9;
+        if (gap > 0 && gap * gap >= bestDist[k - 1])
+            break;
+    }
+
+    for (int i = 0; i < found; ++i)
+    {
+        outIds[t * k + i] = bestId[i];
+        outDists[t * k + i] = bestDist[i];
+    }
+}
+
+// Count the points closer than a radius to a query point, searching the
+// cells within 'reach' cells of the query point's cell.
+__global__ void radiusCountKernel(Grid g, const double *coords,
+    const double *sorted, const uint64_t *cellStart, std::size_t begin,
+    std::size_t count, double r2, int reach, uint64_t *counts)
+{
+    const std::size_t t = blockIdx.x * (std::size_t)blockDim.x + threadIdx.x;
+    if (t >= count)
+        return;
+
+    const int dim = g.dim;
+    double q[3] = { 0, 0, 0 };
+    int lo[3] = { 0, 0, 0 };
+    int hi[3] = { 0, 0, 0 };
+    for (int a = 0; a < dim; ++a)
+    {
+        q[a] = coords[(begin + t) * dim + a];
+        const int c = cellPos(g, q[a], a);
+        lo[a] = max(c - reach, 0);
+        hi[a] = min(c + reach, g.cells[a] - 1);
+    }
+
+    uint64_t n = 0;
+    int cc[3];
+    for (cc[2] = lo[2]; cc[2] <= hi[2]; ++cc[2])
+        for (cc[1] = lo[1]; cc[1] <= hi[1]; ++cc[1])
+            for (cc[0] = lo[0]; cc[0] <= hi[0]; ++cc[0])
+            {
+                const std::size_t cell = cellIndex(g, cc);
+                for (uint64_t p = cellStart[cell];
+                    p < cellStart[cell + 1]; ++p)
+                {
+                    double d = 0;
+                    for (int a = 0; a < dim; ++a)
+                    {
+                        const double diff = sorted[p * dim + a] - q[a];
+                        d += diff * diff;
+                    }
+                    if (d < r2)
+                        n++;
+                }
+            }
+    counts[t] = n;
+}
+
+// Cyclic Jacobi diagonalization of a symmetric 3x3 matrix, as
+// pdal::computeEigen3().  On return the diagonal of 'a' holds the
+// eigenvalues and the columns of 'v' the eigenvectors, unsorted.
+__device__ bool jacobi3(double a[3][3], double v[3][3])
+{
+    for (int r = 0; r < 3; ++r)
+        for (int c = 0; c < 3; ++c)
+        {
+            if (!isfinite(a[r][c]))
+                return false;
+            v[r][c] = (r == c) ? 1.0 : 0.0;
+        }
+
+    const int pairs[3][2] = { { 0, 1 }, { 0, 2 }, { 1, 2 } };
+    for (int sweep = 0; sweep < 32; ++sweep)
+    {
+        const double off = a[0][1] * a[0][1] + a[0][2] * a[0][2] +
+            a[1][2] * a[1][2];
+        const double diag = a[0][0] * a[0][0] + a[1][1] * a[1][1] +
+            a[2][2] * a[2][2];
+        if (off <= DBL_EPSILON * DBL_EPSILON * diag)
+            break;
+
+        for (int i = 0; i < 3; ++i)
+        {
+            const int p = pairs[i][0];
+            const int q = pairs[i][1];
+            const int r = 3 - p - q;
+            const double apq = a[p][q];
+            if (apq == 0.0)
+                continue;
+
+            const double theta = (a[q][q] - a[p][p]) / (2.0 * apq);
+            double t = 1.0 / (fabs(theta) + sqrt(theta * theta + 1.0));
+            if (theta < 0.0)
+                t = -t;
+            const double c = 1.0 / sqrt(t * t + 1.0);
+            const double s = t * c;
+
+            a[p][p] -= t * apq;
+            a[q][q] += t * apq;
+            a[p][q] = a[q][p] = 0.0;
+            const double arp = a[r][p];
+            const double arq = a[r][q];
+            a[r][p] = a[p][r] = c * arp - s * arq;
+            a[r][q] = a[q][r] = s * arp + c * arq;
+            for (int k = 0; k < 3; ++k)
+            {
+                const double vkp = v[k][p];
+                const double vkq = v[k][q];
+                v[k][p] = c * vkp - s * vkq;
+                v[k][q] = s * vkp + c * vkq;
+            }
+        }
+    }
+    return true;
+}
+
+__device__ inline void swapInt(int& a, int& b)
+{
+    const int t = a;
+    a = b;
+    b = t;
+}
+
+// Centroid, covariance and eigen decomposition of a neighborhood, as
+// pdal::computeCovarianceEigen().
+__global__ void covarianceEigenKernel(const double *coords,
+    const std::size_t *offsets, std::size_t count, const uint64_t *ids,
+    std::size_t skip, double *results, uint8_t *valid)
+{
+    const std::size_t t = blockIdx.x * (std::size_t)blockDim.x + threadIdx.x;
+    if (t >= count)
+        return;
+
+    const std::size_t size = offsets[t + 1] - offsets[t];
+    const std::size_t first = offsets[t] + (skip < size ? skip : size);
+    const std::size_t last = offsets[t + 1];
+    const std::size_t n = last - first;
+
+    double m[3] = { 0, 0, 0 };
+    for (std::size_t i = first; i < last; ++i)
+        for (int a = 0; a < 3; ++a)
+            m[a] += coords[ids[i] * 3 + a];
+    if (n)
+        for (int a = 0; a < 3; ++a)
+            m[a] /= n;
+
+    double s[3][3] = { { 0, 0, 0 }, { 0, 0, 0 }, { 0, 0, 0 } };
+    for (std::size_t i = first; i < last; ++i)
+    {
+        const double *p = coords + ids[i] * 3;
+        const double d[3] = { p[0] - m[0], p[1] - m[1], p[2] - m[2] };
+        for (int r = 0; r < 3; ++r)
+            for (int c = r; c < 3; ++c)
+                s[r][c] += d[r] * d[c];
+    }
+
+    // A single point has no spread.
+    const double div = (n > 1) ? (double)(n - 1) : 1.0;
+    double a[3][3];
+    for (int r = 0; r < 3; ++r)
+        for (int c = r; c < 3; ++c)
+            a[r][c] = a[c][r] = s[r][c] / div;
+
+    double *out = results + t * 15;
+    for (int i = 0; i < 3; ++i)
+        out[i] = m[i];
+
+    double v[3][3];
+    if (!jacobi3(a, v))
+    {
+        valid[t] = 0;
+        return;
+    }
+
+    int order[3] = { 0, 1, 2 };
+    if (a[order[1]][order[1]] < a[order[0]][order[0]])
+        swapInt(order[0], order[1]);
+    if (a[order[2]][order[2]] < a[order[1]][order[1]])
+        swapInt(order[1], order[2]);
+    if (a[order[1]][order[1]] < a[order[0]][order[0]])
+        swapInt(order[0], order[1]);
+    for (int i = 0; i < 3; ++i)
+    {
+        out[3 + i] = a[order[i]][order[i]];
+        for (int k = 0; k < 3; ++k)
+            out[6 + i * 3 + k] = v[k][order[i]];
+    }
+    valid[t] = 1;
+}
+
+} // unnamed namespace
+
+struct Points
+{
+    Grid grid;
+    std::size_t count;
+    DeviceBuffer<double> coords;      // Coordinates in point order.
+    DeviceBuffer<double> sorted;      // Coordinates in cell order.
+    DeviceBuffer<uint64_t> sortedIds; // Point IDs in cell order.
+    DeviceBuffer<uint64_t> cellStart; // Position of each cell's first point.
+};
+
+int deviceCount()
+{
+    int count;
+    if (cudaGetDeviceCount(&count) != cudaSuccess)
+        return 0;
+    return count;
+}
+
+Points *upload(const double *coords, std::size_t count, int dim)
+{
+    if (count == 0 || (dim != 2 && dim != 3))
+        return nullptr;
+
+    Grid g;
+    g.dim = dim;
+    double max[3];
+    for (int a = 0; a < 3; ++a)
+    {
+        g.min[a] = max[a] = (a < dim) ? coords[a] : 0.0;
+        g.cells[a] = 1;
+    }
+    for (std::size_t i = 0; i < count; ++i)
+        for (int a = 0; a < dim; ++a)
+        {
+            g.min[a] = (std::min)(g.min[a], coords[i * dim + a]);
+            max[a] = (std::max)(max[a], coords[i * dim + a]);
+        }
+
+    // Size the cells for about PointsPerCell points per cell over the axes
+    // along which the points are spread.  Points that are nearly flat
+    // along an axis can still make for too many cells, so the cells are
+    // grown until there are no more of them than points.
+    double volume = 1.0;
+    int spread = 0;
+    for (int a = 0; a < dim; ++a)
+        if (max[a] > g.min[a])
+        {
+            volume *= max[a] - g.min[a];
+            spread++;
+        }
+    g.cellSize = spread ?
+        std::pow(volume * PointsPerCell / count, 1.0 / spread) : 1.0;
+    if (!(g.cellSize > 0) || !std::isfinite(g.cellSize))
+        g.cellSize = 1.0;
+    double numCells;
+    while (true)
+    {
+        numCells = 1.0;
+        for (int a = 0; a < dim; ++a)
+            numCells *= std::floor((max[a] - g.min[a]) / g.cellSize) + 1;
+        if (numCells <= 2.0 * count + 1)
+            break;
+        g.cellSize *= 2;
+    }
+    g.invCellSize = 1.0 / g.cellSize;
+    for (int a = 0; a < dim; ++a)
+        g.cells[a] = (int)std::floor((max[a] - g.min[a]) / g.cellSize) + 1;
+
+    // Counting sort of the points by cell.
+    std::vector<uint64_t> start((std::size_t)numCells + 1, 0);
+    std::vector<std::size_t> cellOf(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        int c[3] = { 0, 0, 0 };
+        for (int a = 0; a < dim; ++a)
+            c[a] = cellPos(g, coords[i * dim + a], a);
+        cellOf[i] = cellIndex(g, c);
+        start[cellOf[i] + 1]++;
+    }
+    for (std::size_t i = 1; i < start.size(); ++i)
+        start[i] += start[i - 1];
+
+    std::vector<uint64_t> next(start.begin(), start.end() - 1);
+    std::vector<double> sorted(count * dim);
+    std::vector<uint64_t> ids(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const uint64_t pos = next[cellOf[i]]++;
+        ids[pos] = i;
+        std::copy(coords + i * dim, coords + (i + 1) * dim,
+            sorted.begin() + pos * dim);
+    }
+
+    Points *pts = new Points;
+    pts->grid = g;
+    pts->count = count;
+    if (!pts->coords.upload(coords, count * dim) ||
+        !pts->sorted.upload(sorted.data(), sorted.size()) ||
+        !pts->sortedIds.upload(ids.data(), ids.size()) ||
+        !pts->cellStart.upload(start.data(), start.size()))
+    {
+        delete pts;
+        return nullptr;
+    }
+    return pts;
+}
+
+void release(Points *pts)
+{
+    delete pts;
+}
+
+bool knn(const Points *pts, std::size_t begin, std::size_t end,
+    std::size_t k, uint64_t *ids, double *sqrDists)
+{
+    if (k == 0 || k > maxK || k > pts->count || end > pts->count ||
+        begin >= end)
+        return false;
+
+    const std::size_t count = end - begin;
+    if (!scratch.ids.resize(count * k) || !scratch.dists.resize(count * k))
+        return false;
+
+    knnKernel<<<numBlocks(count), BlockSize>>>(pts->grid,
+        pts->coords.data(), pts->sorted.data(), pts->sortedIds.data(),
+        pts->cellStart.data(), begin, count, (int)k, scratch.ids.data(),
+        scratch.dists.data());
+    if (cudaGetLastError() != cudaSuccess)
+        return false;
+    return scratch.ids.download(ids, count * k) &&
+        scratch.dists.download(sqrDists, count * k);
+}
+
+bool radiusCount(const Points *pts, std::size_t begin, std::size_t end,
+    double r, uint64_t *counts)
+{
+    if (end > pts->count || begin >= end || !(r >= 0))
+        return false;
+
+    const Grid& g = pts->grid;
+    const int maxCells = (std::max)(g.cells[0], (std::max)(g.cells[1],
+        g.cells[2]));
+    const int reach = (int)(std::min)(std::floor(r * g.invCellSize) + 1,
+        (double)maxCells);
+
+    const std::size_t count = end - begin;
+    if (!scratch.ids.resize(count))
+        return false;
+
+    radiusCountKernel<<<numBlocks(count), BlockSize>>>(g,
+        pts->coords.data(), pts->sorted.data(), pts->cellStart.data(),
+        begin, count, r * r, reach, scratch.ids.data());
+    if (cudaGetLastError() != cudaSuccess)
+        return false;
+    return scratch.ids.download(counts, count);
+}
+
+bool covarianceEigen(const Points *pts, const std::size_t *offsets,
+    std::size_t count, const uint64_t *ids, std::size_t skip,
+    double *results, uint8_t *valid)
+{
+    if (pts->grid.dim != 3 || count == 0)
+        return false;
+
+    const std::size_t numIds = offsets[count];
+    if (!scratch.offsets.upload(offsets, count + 1) ||
+        (numIds && !scratch.ids.upload(ids, numIds)) ||
+        !scratch.results.resize(count * 15) ||
+        !scratch.valid.resize(count))
+        return false;
+
+    covarianceEigenKernel<<<numBlocks(count), BlockSize>>>(
+        pts->coords.data(), scratch.offsets.data(), count,
+        scratch.ids.data(), skip, scratch.results.data(),
+        scratch.valid.data());
+    if (cudaGetLastError() != cudaSuccess)
+        return false;
+    return scratch.results.download(results, count * 15) &&
+        scratch.valid.download(valid, count);
+}
+
+} // namespace cuda
+} // namespace gpu
+} // namespace pdal
@@ -0,0 +1,82 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Interface to the CUDA kernels of the GPU backend.  It uses only plain
+// types so that it can be included both by nvcc and by the C++ compiler.
+
+namespace pdal
+{
+namespace gpu
+{
+namespace cuda
+{
+
+// Device copy of a set of points and a uniform grid over them.
+struct Points;
+
+// Number of CUDA devices, or 0 if the runtime can't be used.
+int deviceCount();
+
+// Copy points (dim coordinates each) to the device and build their grid.
+// Returns null on failure.
+Points *upload(const double *coords, std::size_t count, int dim);
+void release(Points *pts);
+
+// Find the k nearest neighbors of the points [begin, end), nearest first.
+// Every query point has exactly k neighbors, so the results of query i
+// are at ids[i * k] and sqrDists[i * k].  k must be no more than maxK.
+bool knn(const Points *pts, std::size_t begin, std::size_t end,
+    std::size_t k, uint64_t *ids, double *sqrDists);
+const std::size_t maxK = 64;
+
+// Count the points closer than r to each of the points [begin, end).
+bool radiusCount(const Points *pts, std::size_t begin, std::size_t end,
+    double r, uint64_t *counts);
+
+// Compute the centroid, eigenvalues and eigenvectors of the covariance of
+// neighborhoods of 3D points.  The neighbors of neighborhood i are
+// ids[offsets[i]] through ids[offsets[i + 1] - 1], of which the first
+// skip are left out.  Each result is 15 values: the centroid, the
+// eigenvalues in increasing order and the eigenvectors, column by column.
+bool covarianceEigen(const Points *pts, const std::size_t *offsets,
+    std::size_t count, const uint64_t *ids, std::size_t skip,
+    double *results, uint8_t *valid);
+
+} // namespace cuda
+} // namespace gpu
+} // namespace pdal
@@ -0,0 +1,374 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include "MultipartOutStream.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include <arbiter/arbiter.hpp>
+
+#include <pdal/PDALUtils.hpp>
+#include <pdal/pdal_types.hpp>
+
+namespace pdal
+{
+
+namespace
+{
+
+// S3 allows at most 10000 parts, so the part size grows as parts are
+// written to allow objects of any size while keeping small objects'
+// parts small.
+const std::size_t partsPerSize = 1000;
+
+class S3Uploader : public MultipartUploader
+{
+public:
+    S3Uploader(const std::string& path) : m_path(arbiter::stripProtocol(path))
+    {
+        m_s3 = dynamic_cast<const arbiter::drivers::S3 *>(
+            &m_arbiter.getDriver(path));
+    }
+
+    bool valid() const
+        { return m_s3; }
+
+    void put(const std::vector<char>& data) override
+        { m_s3->put(m_path, data, {}, {}); }
+
+    void start() override
+        { m_uploadId = m_s3->startMultipart(m_path); }
+
+    std::string putPart(std::size_t partNumber,
+        const std::vector<char>& data) override
+        { return m_s3->putPart(m_path, m_uploadId, partNumber, data); }
+
+    void complete(const std::vector<std::string>& etags) override
+        { m_s3->completeMultipart(m_path, m_uploadId, etags); }
+
+    void abort() override
+        { m_s3->abortMultipart(m_path, m_uploadId); }
+
+private:
+    arbiter::Arbiter m_arbiter;
+    const arbiter::drivers::S3 *m_s3;
+    std::string m_path;
+    std::string m_uploadId;
+};
+
+} // unnamed namespace
+
+
+MultipartBuf::MultipartBuf(std::unique_ptr<MultipartUploader> uploader,
+        std::size_t partSize, std::size_t threads) :
+    m_uploader(std::move(uploader)), m_basePartSize(partSize),
+    m_pool(threads, 1, false), m_partNumber(2), m_partStart(partSize),
+    m_pos(0), m_finished(false)
+{
+    m_head.reserve(m_basePartSize);
+}
+
+
+MultipartBuf::~MultipartBuf()
+{
+    // Parts being uploaded refer to members.
+    m_pool.join();
+    if (!m_finished)
+    {
+        std::string err;
+        abort(err);
+    }
+}
+
+
+std::size_t MultipartBuf::partSize(std::size_t partNumber) const
+{
+    return m_basePartSize << ((partNumber - 1) / partsPerSize);
+}
+
+
+void MultipartBuf::failed(const std::string& err)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_error.empty())
+        m_error = err;
+}
+
+
+std::string MultipartBuf::error()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_error;
+}
+
+
+// Abort the multipart upload, if one was started, so that the storage of
+// its parts is freed.  A failure to abort is added to 'err'.
+void MultipartBuf::abort(std::string& err)
+{
+    if (m_partNumber == 2)
+        return;
+    try
+    {
+        m_uploader->abort();
+    }
+    catch (const std::exception& e)
+    {
+        err += std::string(err.size() ? "; " : "") +
+            "unable to abort upload: " + e.what();
+    }
+}
+
+
+// Queue the current part for upload and start the next one.
+void MultipartBuf::putPart()
+{
+    if (m_partNumber == 2)
+        m_uploader->start();
+
+    const std::size_t partNumber(m_partNumber);
+    std::shared_ptr<std::vector<char>> data(new std::vector<char>());
+    data->swap(m_part);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_etags.resize(partNumber);
+    }
+    m_pool.add([this, partNumber, data]()
+    {
+        try
+        {
+            std::string etag(m_uploader->putPart(partNumber, *data));
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_etags[partNumber - 1] = etag;
+        }
+        catch (const std::exception& err)
+        {
+            failed(err.what());
+        }
+    });
+
+    m_partStart += data->size();
+    m_partNumber++;
+    m_part.reserve(partSize(m_partNumber));
+}
+
+
+std::streamsize MultipartBuf::xsputn(const char *s, std::streamsize n)
+{
+    if (m_finished || error().size())
+        return 0;
+
+    std::streamsize written(0);
+    try
+    {
+        while (written < n)
+        {
+            std::vector<char> *buf;
+            std::size_t offset;
+            std::size_t cap;
+            if (m_pos < m_basePartSize)
+            {
+                buf = &m_head;
+                offset = m_pos;
+                cap = m_basePartSize;
+            }
+            else
+            {
+                offset = m_pos - m_partStart;
+                cap = partSize(m_partNumber);
+                if (offset == cap)
+                {
+                    putPart();
+                    continue;
+                }
+                buf = &m_part;
+            }
+
+            std::size_t count =
+                (std::min)((std::size_t)(n - written), cap - offset);
+            if (buf->size() < offset + count)
+                buf->resize(offset + count);
+            std::memcpy(buf->data() + offset, s + written, count);
+            written += count;
+            m_pos += count;
+        }
+    }
+    catch (const std::exception& err)
+    {
+        failed(err.what());
+    }
+    return written;
+}
+
+
+MultipartBuf::int_type MultipartBuf::overflow(int_type c)
+{
+    if (traits_type::eq_int_type(c, traits_type::eof()))
+        return traits_type::not_eof(c);
+    char ch = traits_type::to_char_type(c);
+    return xsputn(&ch, 1) == 1 ? c : traits_type::eof();
+}
+
+
+MultipartBuf::pos_type MultipartBuf::seekoff(off_type off,
+    std::ios::seekdir dir, std::ios::openmode which)
+{
+    off_type base;
+    if (dir == std::ios::beg)
+        base = 0;
+    else if (dir == std::ios::cur)
+        base = m_pos;
+    else
+        base = m_head.size() < m_basePartSize ? m_head.size() :
+            m_partStart + m_part.size();
+    return seekpos(pos_type(base + off), which);
+}
+
+
+MultipartBuf::pos_type MultipartBuf::seekpos(pos_type pos,
+    std::ios::openmode which)
+{
+    const pos_type bad(off_type(-1));
+    if (!(which & std::ios::out) || pos < 0)
+        return bad;
+
+    const std::size_t p = (std::size_t)(off_type)pos;
+    bool ok;
+    if (p < m_basePartSize)
+        ok = (p <= m_head.size());
+    else
+        ok = (m_head.size() == m_basePartSize && p >= m_partStart &&
+            p <= m_partStart + m_part.size());
+    if (!ok)
+        return bad;
+    m_pos = p;
+    return pos;
+}
+
+
+void MultipartBuf::finish()
+{
+    if (m_finished)
+        return;
+    m_finished = true;
+
+    std::string err(error());
+    try
+    {
+        if (err.empty())
+        {
+            // Small objects are stored with a single request.
+            if (m_partNumber == 2)
+            {
+                m_head.insert(m_head.end(), m_part.begin(), m_part.end());
+                m_uploader->put(m_head);
+            }
+            else
+            {
+                if (m_part.size())
+                    putPart();
+                m_pool.join();
+                err = error();
+                if (err.empty())
+                {
+                    m_etags[0] = m_uploader->putPart(1, m_head);
+                    m_uploader->complete(m_etags);
+                }
+            }
+        }
+    }
+    catch (const std::exception& e)
+    {
+        err = e.what();
+    }
+    m_pool.join();
+    m_head.clear();
+    m_part.clear();
+
+    if (err.size())
+    {
+        abort(err);
+        throw pdal_error("Unable to upload data: " + err);
+    }
+}
+
+
+MultipartOutStream::MultipartOutStream(
+        std::unique_ptr<MultipartUploader> uploader, std::size_t partSize) :
+    m_buf(std::move(uploader), partSize)
+{
+    std::ios::rdbuf(&m_buf);
+}
+
+
+MultipartOutStream::~MultipartOutStream()
+{
+    // Streams are usually finished by Utils::closeFile(), which reports
+    // errors.  Complete the object for owners that just delete the stream.
+    // A failed upload has been aborted, but a destructor can't throw, so
+    // the error is only reported.
+    try
+    {
+        m_buf.finish();
+    }
+    catch (const pdal_error& err)
+    {
+        Utils::printError(err.what());
+    }
+}
+
+
+MultipartOutStream *MultipartOutStream::create(const std::string& path)
+{
+    std::unique_ptr<S3Uploader> uploader(new S3Uploader(path));
+    if (!uploader->valid())
+        return nullptr;
+    return new MultipartOutStream(std::move(uploader));
+}
+
+
+void MultipartOutStream::finish()
+{
+    try
+    {
+        m_buf.finish();
+    }
+    catch (...)
+    {
+        setstate(std::ios::badbit);
+        throw;
+    }
+}
+
+} // namespace pdal
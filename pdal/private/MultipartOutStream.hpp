@@ -0,0 +1,142 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include <pdal/pdal_internal.hpp>
+#include <pdal/util/ThreadPool.hpp>
+
+namespace pdal
+{
+
+// The requests that store an object in parts.  Parts are numbered from 1
+// and putPart() may be called concurrently.
+class PDAL_DLL MultipartUploader
+{
+public:
+    virtual ~MultipartUploader()
+        {}
+
+    // Store the whole object with a single request.
+    virtual void put(const std::vector<char>& data) = 0;
+
+    virtual void start() = 0;
+    virtual std::string putPart(std::size_t partNumber,
+        const std::vector<char>& data) = 0;
+    virtual void complete(const std::vector<std::string>& etags) = 0;
+    // Discard an upload that was started so that its parts aren't kept.
+    virtual void abort() = 0;
+};
+
+
+// Stream buffer that uploads its data in parts as it's written rather than
+// staging the whole object on disk.  Full parts are uploaded in parallel
+// while writing continues.  The first part is held until the end so that
+// a header at the start of the object can be rewritten after the data
+// that follows it.  Seeking is allowed only within the first part or the
+// part currently being filled.
+class PDAL_DLL MultipartBuf : public std::streambuf
+{
+public:
+    static const std::size_t DefaultPartSize = 8 * 1024 * 1024;
+
+    MultipartBuf(std::unique_ptr<MultipartUploader> uploader,
+        std::size_t partSize = DefaultPartSize, std::size_t threads = 4);
+    ~MultipartBuf();
+
+    // Upload the remaining data and complete the object.  On failure the
+    // upload is aborted and pdal_error is thrown.
+    void finish();
+
+    bool finished() const
+        { return m_finished; }
+
+protected:
+    int_type overflow(int_type c) override;
+    std::streamsize xsputn(const char *s, std::streamsize n) override;
+    pos_type seekoff(off_type off, std::ios::seekdir dir,
+        std::ios::openmode which) override;
+    pos_type seekpos(pos_type pos, std::ios::openmode which) override;
+
+private:
+    void putPart();
+    void abort(std::string& err);
+    std::size_t partSize(std::size_t partNumber) const;
+    void failed(const std::string& err);
+    std::string error();
+
+    std::unique_ptr<MultipartUploader> m_uploader;
+    std::size_t m_basePartSize;
+    ThreadPool m_pool;
+    std::vector<char> m_head;
+    std::vector<char> m_part;
+    std::size_t m_partNumber;
+    std::size_t m_partStart;
+    std::size_t m_pos;
+    std::vector<std::string> m_etags;
+    std::string m_error;
+    bool m_finished;
+    std::mutex m_mutex;
+};
+
+
+// Output stream for an object on remote storage that's uploaded in parts
+// as it's written.  It's an ofstream so that it's closed and deleted like
+// one, but no local file is opened.
+class PDAL_DLL MultipartOutStream : public std::ofstream
+{
+public:
+    MultipartOutStream(std::unique_ptr<MultipartUploader> uploader,
+        std::size_t partSize = MultipartBuf::DefaultPartSize);
+    ~MultipartOutStream();
+
+    // Return a stream for 'path' or nullptr if its storage doesn't support
+    // multipart upload.
+    static MultipartOutStream *create(const std::string& path);
+
+    // Complete the upload.  Throws pdal_error on failure.
+    void finish();
+
+private:
+    MultipartBuf m_buf;
+};
+
+} // namespace pdal
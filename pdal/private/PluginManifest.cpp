@@ -0,0 +1,211 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include "PluginManifest.hpp"
+
+#include <ctime>
+
+#include <nlohmann/json.hpp>
+
+#include <pdal/util/FileUtils.hpp>
+#include <pdal/util/Utils.hpp>
+
+namespace pdal
+{
+
+namespace
+{
+
+std::string manifestFilename()
+{
+    std::string filename;
+    if (Utils::getenv("PDAL_PLUGIN_MANIFEST", filename) == 0)
+        return filename;
+
+    std::string home;
+    if (Utils::getenv("HOME", home) != 0 &&
+        Utils::getenv("USERPROFILE", home) != 0)
+        return std::string();
+    return FileUtils::toAbsolutePath(".pdal/plugin_manifest.json", home);
+}
+
+// Directory of a path with no trailing separator, so that directories can
+// be compared.
+std::string directory(const std::string& path)
+{
+    std::string dir = FileUtils::toAbsolutePath(path);
+    while (dir.size() > 1 && (dir.back() == '/' || dir.back() == '\\'))
+        dir.pop_back();
+    return dir;
+}
+
+} // unnamed namespace
+
+
+PluginManifest::PluginManifest(const std::string& filename) :
+    m_filename(filename)
+{
+    read();
+}
+
+
+PluginManifest& PluginManifest::get()
+{
+    static PluginManifest manifest(manifestFilename());
+
+    return manifest;
+}
+
+
+// Size and modification time of a library, or an empty string if it
+// can't be found.
+std::string PluginManifest::fileStamp(const std::string& path)
+{
+    if (!FileUtils::fileExists(path))
+        return std::string();
+    return std::to_string(FileUtils::fileSize(path)) + "/" +
+        std::to_string((long long)FileUtils::lastWriteTime(path));
+}
+
+
+bool PluginManifest::plugins(const std::string& path, PluginList& plugins)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto it = m_entries.find(path);
+    if (it == m_entries.end() || it->second.m_stamp != fileStamp(path))
+        return false;
+    plugins = it->second.m_plugins;
+    return true;
+}
+
+
+std::string PluginManifest::library(const std::string& name,
+    const StringList& dirs)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    for (const std::string& dir : dirs)
+    {
+        const std::string d = directory(dir);
+        for (auto& it : m_entries)
+        {
+            const std::string& path = it.first;
+            if (directory(FileUtils::getDirectory(path)) != d)
+                continue;
+            for (const Plugin& p : it.second.m_plugins)
+                if (p.m_name == name && it.second.m_stamp == fileStamp(path))
+                    return path;
+        }
+    }
+    return std::string();
+}
+
+
+void PluginManifest::record(const std::string& path,
+    const PluginList& plugins)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    Entry& entry = m_entries[path];
+    entry.m_stamp = fileStamp(path);
+    entry.m_plugins = plugins;
+    write();
+}
+
+
+void PluginManifest::read()
+{
+    m_entries.clear();
+    if (m_filename.empty() || !FileUtils::fileExists(m_filename))
+        return;
+
+    try
+    {
+        NL::json j =
+            NL::json::parse(FileUtils::readFileIntoString(m_filename));
+        for (auto& it : j.at("libraries").items())
+        {
+            const NL::json& lib = it.value();
+            Entry entry;
+            entry.m_stamp = lib.at("stamp").get<std::string>();
+            for (const NL::json& p : lib.at("plugins"))
+                entry.m_plugins.push_back({ p.at("name").get<std::string>(),
+                    p.at("description").get<std::string>(),
+                    p.at("link").get<std::string>() });
+            m_entries[it.key()] = entry;
+        }
+    }
+    catch (const std::exception&)
+    {
+        // A damaged manifest means libraries get loaded to find their
+        // plugins, as if there were no manifest.
+        m_entries.clear();
+    }
+}
+
+
+// Failing to write the manifest only means that libraries get loaded
+// again next time, so errors are ignored.
+void PluginManifest::write()
+{
+    if (m_filename.empty())
+        return;
+
+    NL::json libraries = NL::json::object();
+    for (auto& it : m_entries)
+    {
+        NL::json plugins = NL::json::array();
+        for (const Plugin& p : it.second.m_plugins)
+            plugins.push_back({ { "name", p.m_name },
+                { "description", p.m_description },
+                { "link", p.m_link } });
+        libraries[it.first] = { { "stamp", it.second.m_stamp },
+            { "plugins", plugins } };
+    }
+    NL::json j { { "libraries", libraries } };
+
+    // Write to a temporary file and rename so that a concurrent reader
+    // of the manifest never sees a partial file.
+    FileUtils::createDirectories(FileUtils::getDirectory(m_filename));
+    std::string tmpFile = m_filename + ".tmp";
+    std::ostream *out = FileUtils::createFile(tmpFile, false);
+    if (!out)
+        return;
+    *out << j.dump(1);
+    FileUtils::closeFile(out);
+    FileUtils::renameFile(m_filename, tmpFile);
+}
+
+} // namespace pdal
@@ -0,0 +1,123 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <pdal/pdal_internal.hpp>
+
+namespace pdal
+{
+
+/**
+  Record of the plugins registered by each plugin library, so that plugins
+  can be listed, and the library holding a plugin found, without loading
+  any library.  Libraries are recorded by path along with their size and
+  modification time.  A library that has changed since it was recorded is
+  ignored until it's recorded again.
+*/
+class PDAL_DLL PluginManifest
+{
+public:
+    struct Plugin
+    {
+        std::string m_name;
+        std::string m_description;
+        std::string m_link;
+    };
+    using PluginList = std::vector<Plugin>;
+
+    /**
+      Manifest read from and written to a file.
+
+      \param filename  Manifest filename.  If empty, nothing is read or
+        written.
+    */
+    PluginManifest(const std::string& filename);
+
+    /**
+      The manifest shared by the plugin managers.  Its file is named by the
+      PDAL_PLUGIN_MANIFEST environment variable or is
+      .pdal/plugin_manifest.json in the user's home directory.
+    */
+    static PluginManifest& get();
+
+    /**
+      Find the plugins of a library.
+
+      \param path  Path of the library.
+      \param plugins  Set to the plugins of the library.
+      \return  Whether the library is recorded and unchanged.
+    */
+    bool plugins(const std::string& path, PluginList& plugins);
+
+    /**
+      Find the library holding a plugin.
+
+      \param name  Plugin name.
+      \param dirs  Directories searched for the library, in order.
+      \return  Path of the first unchanged library in the directories that
+        holds the plugin, or an empty string if there is none.
+    */
+    std::string library(const std::string& name, const StringList& dirs);
+
+    /**
+      Record the plugins of a library and write the manifest.
+
+      \param path  Path of the library.
+      \param plugins  Plugins registered by the library.
+    */
+    void record(const std::string& path, const PluginList& plugins);
+
+private:
+    struct Entry
+    {
+        std::string m_stamp;
+        PluginList m_plugins;
+    };
+
+    void read();
+    void write();
+    static std::string fileStamp(const std::string& path);
+
+    std::string m_filename;
+    std::mutex m_mutex;
+    std::map<std::string, Entry> m_entries;
+};
+
+} // namespace pdal
@@ -31,14 +31,107 @@
 #include "SrsTransform.hpp"
 #include <pdal/SpatialReference.hpp>
 
+#include <list>
+#include <mutex>
+#include <thread>
+
 #include <ogr_spatialref.h>
 
 namespace pdal
 {
 
+namespace
+{
+
+// Transforms of destroyed SrsTransforms, most recently released first.
+// The oldest are dropped once the cache is full.
+//
+// PROJ objects are tied to the PROJ context of the thread that created
+// them, so an idle transform is handed out as-is only to the thread that
+// released it.  Another thread gets a clone, which is created in its own
+// context and is much cheaper than creating the transform from the
+// spatial references (no operation search or grid lookup).
+class TransformCache
+{
+public:
+    using TransformPtr = std::unique_ptr<OGRCoordinateTransformation>;
+
+    TransformPtr take(const std::string& key)
+    {
+        const std::thread::id thread = std::this_thread::get_id();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto other = m_idle.end();
+        for (auto it = m_idle.begin(); it != m_idle.end(); ++it)
+        {
+            if (it->m_key != key)
+                continue;
+            if (it->m_thread == thread)
+            {
+                TransformPtr t(std::move(it->m_transform));
+                m_idle.erase(it);
+                return t;
+            }
+            if (other == m_idle.end())
+                other = it;
+        }
+#if (GDAL_VERSION_MAJOR > 3) || \
+    (GDAL_VERSION_MAJOR == 3 && GDAL_VERSION_MINOR >= 1)
+        if (other != m_idle.end())
+            return TransformPtr(other->m_transform->Clone());
+#endif
+        return TransformPtr();
+    }
+
+    void give(const std::string& key, TransformPtr t)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_idle.push_front({ key, std::this_thread::get_id(), std::move(t) });
+        if (m_idle.size() > MaxIdle)
+            m_idle.pop_back();
+    }
+
+private:
+    struct Idle
+    {
+        std::string m_key;
+        std::thread::id m_thread;
+        TransformPtr m_transform;
+    };
+
+    static const size_t MaxIdle = 32;
+
+    std::mutex m_mutex;
+    std::list<Idle> m_idle;
+};
+
+// The cache is never destroyed so that no transform is destroyed after
+// GDAL and PROJ have been torn down at exit.
+TransformCache& cache()
+{
+    static TransformCache *c = new TransformCache;
+    return *c;
+}
+
+std::string orderKey(const std::vector<int>& order)
+{
+    std::string s;
+    for (int i : order)
+        s += std::to_string(i) + ",";
+    return s;
+}
+
+} // unnamed namespace
+
+
 SrsTransform::SrsTransform(const SpatialReference& src,
     const SpatialReference& dst)
 {
+    m_key = "gis\n" + src.getWKT() + "\n" + dst.getWKT();
+    m_transform = cache().take(m_key);
+    if (m_transform)
+        return;
+
     OGRSpatialReference srcRef(src.getWKT().data());
     OGRSpatialReference dstRef(dst.getWKT().data());
 
@@ -63,6 +156,12 @@ SrsTransform::SrsTransform(const SpatialReference& src,
                            const SpatialReference& dst,
                            std::vector<int> dstOrder)
 {
+    m_key = orderKey(srcOrder) + "\n" + src.getWKT() + "\n" +
+        orderKey(dstOrder) + "\n" + dst.getWKT();
+    m_transform = cache().take(m_key);
+    if (m_transform)
+        return;
+
     OGRSpatialReference srcRef(src.getWKT().data());
     OGRSpatialReference dstRef(dst.getWKT().data());
 
@@ -84,7 +183,10 @@ SrsTransform::SrsTransform(const SpatialReference& src,
 }
 
 SrsTransform::~SrsTransform()
-{}
+{
+    if (m_transform)
+        cache().give(m_key, std::move(m_transform));
+}
 
 
 OGRCoordinateTransformation *SrsTransform::get() const
@@ -109,4 +211,16 @@ bool SrsTransform::transform(std::vector<double>& x, std::vector<double>& y,
     return (err == OGRERR_NONE);
 }
 
+
+bool SrsTransform::transform(std::vector<double>& x, std::vector<double>& y,
+    std::vector<double>& z, std::vector<int>& success)
+{
+    if (x.size() != y.size() || y.size() != z.size())
+        throw pdal_error("SrsTransform::called with vectors of different "
+            "sizes.");
+    success.assign(x.size(), 0);
+    return m_transform && m_transform->Transform((int)x.size(), x.data(),
+        y.data(), z.data(), success.data());
+}
+
 } // namespace pdal
@@ -31,6 +31,10 @@
 
 #include <pdal/pdal_internal.hpp>
 
+#include <memory>
+#include <string>
+#include <vector>
+
 class OGRCoordinateTransformation;
 
 namespace pdal
@@ -38,6 +42,12 @@ namespace pdal
 
 class SpatialReference;
 
+/// Transforms are costly to create, so the underlying transform of a
+/// destroyed SrsTransform is kept and handed to the next SrsTransform
+/// between the same spatial references and axis orders.  A transform is
+/// used by only one SrsTransform at a time, and a transform released by
+/// one thread is cloned rather than shared when another thread needs it,
+/// so SrsTransforms may be created and used on any thread.
 class PDAL_DLL SrsTransform
 {
 public:
@@ -69,7 +79,18 @@ public:
     bool transform(std::vector<double>& x, std::vector<double>& y,
         std::vector<double>& z);
 
+    /// Transform a set of points in place, noting which points were
+    /// transformed.
+    /// \param x  X coordinates
+    /// \param y  Y coordinates
+    /// \param z  Z coordinates
+    /// \param success  Set to non-zero for each point that was transformed.
+    /// \return  True if any of the points were transformed.
+    bool transform(std::vector<double>& x, std::vector<double>& y,
+        std::vector<double>& z, std::vector<int>& success);
+
 private:
+    std::string m_key;
     std::unique_ptr<OGRCoordinateTransformation> m_transform;
 };
 
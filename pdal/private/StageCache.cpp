@@ -0,0 +1,258 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include "StageCache.hpp"
+
+#include <sstream>
+
+#include <arbiter/arbiter.hpp>
+
+#include <pdal/PDALUtils.hpp>
+#include <pdal/Reader.hpp>
+#include <pdal/Stage.hpp>
+#include <pdal/Writer.hpp>
+#include <pdal/util/FileUtils.hpp>
+#include <pdal/util/IStream.hpp>
+#include <pdal/util/OStream.hpp>
+
+namespace pdal
+{
+
+namespace
+{
+
+const std::string magic("PDALVIEW");
+const uint32_t version(1);
+const std::string entryExt(".view");
+
+// Number of points read or written at a time.
+const point_count_t chunkSize(65536);
+
+} // unnamed namespace
+
+
+StageCache::StageCache(const std::string& dir, uint64_t maxSize) :
+    m_files(dir, maxSize, entryExt)
+{}
+
+
+std::string StageCache::key(const Stage& stage) const
+{
+    if (dynamic_cast<const Writer *>(&stage))
+        return std::string();
+
+    std::ostringstream oss;
+    oss << magic << " " << version << "\n";
+    oss << stage.getName() << "\n";
+
+    // Options are ordered by name, so equal options give equal keys.
+    bool hasFile = false;
+    for (const Option& o : stage.getOptions().getOptions())
+    {
+        const std::string& value = o.getValue();
+        oss << o.getName() << "=" << value << "\n";
+        if (o.getName() == "filename")
+        {
+            // We can't tell whether remote data has changed.
+            if (Utils::isRemote(value))
+                return std::string();
+            hasFile = true;
+        }
+        if (FileUtils::fileExists(value) && !FileUtils::isDirectory(value))
+            oss << "file " << FileUtils::toAbsolutePath(value) << " " <<
+                FileUtils::fileSize(value) << " " <<
+                FileUtils::lastWriteTime(value) << "\n";
+    }
+
+    // A reader without a file reads data that we can't identify.
+    if (dynamic_cast<const Reader *>(&stage) && !hasFile)
+        return std::string();
+
+    // The points and dimensions asked of the stage by the stages that
+    // follow it can narrow its output (see findPointLimits() and
+    // findRequiredDims()).
+    const Stage::PointLimit& limit = stage.pointLimit();
+    oss << "limit " << limit.m_first << " " << limit.m_last << " " <<
+        limit.m_offset << " " << limit.m_step << "\n";
+    if (stage.m_allDimsRequired)
+        oss << "dims all\n";
+    else
+    {
+        oss << "dims";
+        for (Dimension::Id id : stage.m_requiredDims)
+            oss << " " << (int)id;
+        oss << "\n";
+    }
+
+    for (const Stage *in : stage.m_inputs)
+    {
+        std::string inKey = key(*in);
+        if (inKey.empty())
+            return std::string();
+        oss << "input " << inKey << "\n";
+    }
+    return arbiter::crypto::encodeAsHex(arbiter::crypto::sha256(oss.str()));
+}
+
+
+// An entry holds the dimensions of the layout of the views as name/type
+// pairs, followed by each view's spatial reference and points, packed in
+// the order of the dimensions.
+bool StageCache::store(const std::string& key, const PointViewSet& views)
+{
+    if (views.empty())
+        return false;
+
+    PointLayoutPtr layout = (*views.begin())->table().layout();
+    DimTypeList dims = layout->dimTypes();
+    const size_t pointSize = layout->pointSize();
+
+    return m_files.put(key, [&](std::ostream& s)
+    {
+        OLeStream out(&s);
+
+        out.put(magic);
+        out << version;
+        out << (uint32_t)dims.size();
+        for (const DimType& d : dims)
+        {
+            std::string name = layout->dimName(d.m_id);
+            out << (uint32_t)name.size();
+            out.put(name);
+            out << (uint32_t)d.m_type;
+        }
+
+        std::vector<char> buf(chunkSize * pointSize);
+        out << (uint32_t)views.size();
+        for (const PointViewPtr& v : views)
+        {
+            std::string wkt = v->spatialReference().getWKT();
+            out << (uint32_t)wkt.size();
+            out.put(wkt);
+            out << (uint64_t)v->size();
+            for (PointId idx = 0; idx < v->size() && out; idx += chunkSize)
+            {
+                point_count_t count = (std::min)(chunkSize, v->size() - idx);
+                char *p = buf.data();
+                for (PointId i = idx; i < idx + count; ++i)
+                {
+                    v->getPackedPoint(dims, i, p);
+                    p += pointSize;
+                }
+                out.put(buf.data(), count * pointSize);
+            }
+        }
+        return (bool)out;
+    });
+}
+
+
+bool StageCache::load(const std::string& key, PointTableRef table,
+    PointViewSet& views)
+{
+    const std::string filename = m_files.file(key);
+    if (filename.empty())
+        return false;
+
+    ILeStream in(filename);
+    if (!in)
+        return false;
+
+    std::string s;
+    uint32_t v;
+    in.get(s, magic.size());
+    in >> v;
+    if (!in || s != magic || v != version)
+        return false;
+
+    // Dimensions that aren't in the table's layout are skipped.
+    struct Field
+    {
+        Dimension::Id m_id;
+        Dimension::Type m_type;
+        size_t m_offset;
+    };
+    std::vector<Field> fields;
+    size_t pointSize = 0;
+    uint32_t numDims;
+    in >> numDims;
+    for (uint32_t i = 0; i < numDims && in; ++i)
+    {
+        uint32_t len;
+        uint32_t type;
+        in >> len;
+        in.get(s, len);
+        in >> type;
+        Dimension::Id id = table.layout()->findDim(s);
+        if (id != Dimension::Id::Unknown)
+            fields.push_back({ id, (Dimension::Type)type, pointSize });
+        pointSize += Dimension::size((Dimension::Type)type);
+    }
+    if (!in)
+        return false;
+
+    PointViewSet loaded;
+    std::vector<char> buf;
+    uint32_t numViews;
+    in >> numViews;
+    for (uint32_t i = 0; i < numViews && in; ++i)
+    {
+        uint32_t len;
+        uint64_t size;
+        in >> len;
+        in.get(s, len);
+        in >> size;
+        PointViewPtr view(new PointView(table, SpatialReference(s)));
+        for (PointId idx = 0; idx < size && in; idx += chunkSize)
+        {
+            point_count_t count = (std::min)((uint64_t)chunkSize, size - idx);
+            buf.resize(count * pointSize);
+            in.get(buf.data(), buf.size());
+            const char *p = buf.data();
+            for (PointId pi = idx; pi < idx + count; ++pi)
+            {
+                for (const Field& f : fields)
+                    view->setField(f.m_id, f.m_type, pi, p + f.m_offset);
+                p += pointSize;
+            }
+        }
+        loaded.insert(view);
+    }
+    if (!in)
+        return false;
+
+    views.insert(loaded.begin(), loaded.end());
+    return true;
+}
+
+} // namespace pdal
@@ -0,0 +1,79 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include <pdal/PointTable.hpp>
+#include <pdal/PointView.hpp>
+#include <pdal/private/FileCache.hpp>
+
+namespace pdal
+{
+
+class Stage;
+
+// A cache of the point views produced by stages in standard mode, stored
+// in a size-bounded directory (see FileCache).  An entry is keyed by a
+// hash of the stage and everything upstream of it: the stage types, their
+// options, the size and modification time of the local files that the
+// options name and the points and dimensions that the stages that follow
+// ask of each stage.  When a pipeline is executed again, the output of a cached
+// stage is loaded rather than running the stage and its inputs.
+class PDAL_DLL StageCache
+{
+public:
+    StageCache(const std::string& dir, uint64_t maxSize);
+
+    // Return the key for the output of 'stage' or an empty string if its
+    // output can't be cached.  Writers and stages whose output depends on
+    // something other than their options and input files, such as readers
+    // of remote or in-memory data, aren't cached.
+    std::string key(const Stage& stage) const;
+
+    // Load the views stored for 'key' into 'views'.  Returns false if
+    // there is no usable entry for 'key'.
+    bool load(const std::string& key, PointTableRef table,
+        PointViewSet& views);
+
+    // Store 'views' as the entry for 'key'.  Returns whether the entry
+    // was stored.
+    bool store(const std::string& key, const PointViewSet& views);
+
+private:
+    FileCache m_files;
+};
+
+} // namespace pdal
@@ -34,9 +34,12 @@
 
 #pragma once
 
+#include <exception>
 #include <memory>
 
 #include <pdal/Stage.hpp>
+#include <pdal/Trace.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
 namespace pdal
 {
@@ -48,19 +51,63 @@ public:
         m_stage(s), m_view(view)
     {}
 
-    // For now this is all synchronous
+    // Run the stage on the view in the calling thread.
     void run()
-        { m_viewSet = m_stage->run(m_view); }
+    {
+        PDAL_TRACE_SCOPE("stage", m_stage->tag() + " run");
+        MemoryAccount::Scope memory(&m_stage->memoryAccount());
+        StageProfile::Timer timer(m_stage->profile(),
+            StageProfile::Phase::Run);
+        m_viewSet = m_stage->run(m_view);
+        chargeViews();
+    }
 
+    // Queue the stage run on the view to the pool.  Any exception is
+    // captured and rethrown from wait().
+    void run(ThreadPool& pool)
+    {
+        pool.add([this]()
+        {
+            try
+            {
+                PDAL_TRACE_SCOPE("stage", m_stage->tag() + " run");
+                MemoryAccount::Scope memory(&m_stage->memoryAccount());
+                StageProfile::Timer timer(m_stage->profile(),
+                    StageProfile::Phase::Run);
+                m_viewSet = m_stage->run(m_view);
+                chargeViews();
+            }
+            catch (...)
+            {
+                m_error = std::current_exception();
+            }
+        });
+    }
+
+    // When running on a pool, the pool must have been awaited before
+    // calling.
     PointViewSet wait()
-        { return m_viewSet; }
+    {
+        if (m_error)
+            std::rethrow_exception(m_error);
+        return m_viewSet;
+    }
 
 private:
+    // Charge the indexes and meshes of the views that the stage produced
+    // or changed to the stage.
+    void chargeViews()
+    {
+        m_view->chargeMemory();
+        for (PointViewPtr v : m_viewSet)
+            v->chargeMemory();
+    }
+
     Stage *m_stage;
     PointViewPtr m_view;
     PointViewSet m_viewSet;
+    std::exception_ptr m_error;
 };
 typedef std::shared_ptr<StageRunner> StageRunnerPtr;
 
 } // namespace pdal
-
@@ -0,0 +1,238 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#else
+#include <codecvt>
+#include <locale>
+#include <Windows.h>
+#endif
+
+#include "AsyncReader.hpp"
+
+namespace pdal
+{
+
+#ifdef _WIN32
+namespace
+{
+
+std::wstring toNative(std::string const& in)
+{
+    std::wstring_convert<std::codecvt_utf8_utf16<unsigned short>,
+        unsigned short> convert;
+    auto s = convert.from_bytes(in);
+    auto p = reinterpret_cast<wchar_t const*>(s.data());
+    return std::wstring(p, p + s.size());
+}
+
+} // unnamed namespace
+#endif
+
+AsyncReader::AsyncReader(std::size_t depth) :
+    m_depth((std::max)(depth, (std::size_t)1)),
+#ifdef _WIN32
+    m_handle(nullptr)
+#else
+    m_fd(-1)
+#endif
+{}
+
+
+AsyncReader::~AsyncReader()
+{
+    close();
+}
+
+
+bool AsyncReader::open(const std::string& filename)
+{
+    close();
+    m_error.clear();
+#ifdef _WIN32
+    HANDLE h = CreateFileW(toNative(filename).c_str(), GENERIC_READ,
+        FILE_SHARE_READ, NULL, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (h == INVALID_HANDLE_VALUE)
+    {
+        m_error = "Unable to open '" + filename + "'.";
+        return false;
+    }
+    m_handle = h;
+#else
+    m_fd = ::open(filename.c_str(), O_RDONLY);
+    if (m_fd == -1)
+    {
+        m_error = "Unable to open '" + filename + "': " +
+            std::strerror(errno);
+        return false;
+    }
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise(m_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+#endif
+    m_pool.reset(new ThreadPool(m_depth, -1, false));
+    return true;
+}
+
+
+void AsyncReader::close()
+{
+    clear();
+    m_pool.reset();
+#ifdef _WIN32
+    if (m_handle)
+        CloseHandle((HANDLE)m_handle);
+    m_handle = nullptr;
+#else
+    if (m_fd != -1)
+        ::close(m_fd);
+    m_fd = -1;
+#endif
+}
+
+
+void AsyncReader::request(uint64_t offset, uint64_t size,
+    std::size_t blockSize)
+{
+    if (size == 0)
+        return;
+    m_pending.push_back({ offset, offset + size,
+        (std::max)(blockSize, (std::size_t)1) });
+    fill();
+}
+
+
+std::vector<char> AsyncReader::next()
+{
+    fill();
+    if (m_inflight.empty())
+        return std::vector<char>();
+
+    std::future<std::vector<char>> f(std::move(m_inflight.front()));
+    m_inflight.pop_front();
+
+    // Start the next read before waiting on this one so that the queue
+    // stays full.
+    fill();
+    return f.get();
+}
+
+
+void AsyncReader::clear()
+{
+    m_pending.clear();
+    for (auto& f : m_inflight)
+        f.wait();
+    m_inflight.clear();
+}
+
+
+void AsyncReader::fill()
+{
+    if (!m_pool)
+    {
+        m_pending.clear();
+        return;
+    }
+
+    while (m_inflight.size() < m_depth && m_pending.size())
+    {
+        Range& r = m_pending.front();
+        uint64_t offset = r.m_offset;
+        std::size_t size = (std::size_t)(std::min)((uint64_t)r.m_blockSize,
+            r.m_end - r.m_offset);
+        r.m_offset += size;
+        if (r.m_offset >= r.m_end)
+            m_pending.pop_front();
+
+        // ThreadPool tasks must be copyable, so the task is shared.
+        auto task = std::make_shared<std::packaged_task<std::vector<char>()>>(
+            [this, offset, size]() { return readBlock(offset, size); });
+        m_inflight.push_back(task->get_future());
+        m_pool->add([task]() { (*task)(); });
+    }
+}
+
+
+std::vector<char> AsyncReader::readBlock(uint64_t offset,
+    std::size_t size) const
+{
+    std::vector<char> buf(size);
+    std::size_t total = 0;
+
+    while (total < size)
+    {
+#ifdef _WIN32
+        OVERLAPPED ov {};
+        uint64_t pos = offset + total;
+        ov.Offset = (DWORD)(pos & 0xFFFFFFFF);
+        ov.OffsetHigh = (DWORD)(pos >> 32);
+        DWORD want = (DWORD)(std::min)(size - total,
+            (std::size_t)(1 << 30));
+        DWORD cnt = 0;
+        if (!ReadFile((HANDLE)m_handle, buf.data() + total, want, &cnt, &ov))
+        {
+            if (GetLastError() == ERROR_HANDLE_EOF)
+                break;
+            throw std::runtime_error("Unable to read file block.");
+        }
+#else
+        ssize_t cnt = ::pread(m_fd, buf.data() + total, size - total,
+            (off_t)(offset + total));
+        if (cnt < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            throw std::runtime_error(std::string("Unable to read file "
+                "block: ") + std::strerror(errno));
+        }
+#endif
+        // End of file.
+        if (cnt == 0)
+            break;
+        total += (std::size_t)cnt;
+    }
+    buf.resize(total);
+    return buf;
+}
+
+} // namespace pdal
@@ -0,0 +1,146 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "pdal_util_export.hpp"
+#include "ThreadPool.hpp"
+
+namespace pdal
+{
+
+/**
+  Reads blocks of a local file ahead of their use.  Ranges of the file
+  are requested up front and split into blocks.  Up to 'depth' blocks are
+  read concurrently with positional reads on a pool of threads, so the
+  caller can decode one block while the following ones are being read.
+  Blocks are returned in the order they were requested.
+*/
+class PDAL_DLL AsyncReader
+{
+public:
+    /**
+      Create a reader.
+
+      \param depth  Maximum number of blocks being read at once.
+    */
+    AsyncReader(std::size_t depth = 4);
+    ~AsyncReader();
+
+    /**
+      Open a file for reading.
+
+      \param filename  Name of the file to open.
+      \return  Whether the file was opened.  error() describes the
+        failure, if any.
+    */
+    bool open(const std::string& filename);
+
+    /**
+      Discard outstanding requests and close the file.
+    */
+    void close();
+
+    /**
+      Description of the error if open() failed.
+    */
+    const std::string& error() const
+        { return m_error; }
+
+    /**
+      Queue the read of a range of the file.  The range is read as
+      consecutive blocks of at most 'blockSize' bytes.
+
+      \param offset  File position of the start of the range.
+      \param size  Number of bytes in the range.
+      \param blockSize  Maximum number of bytes in a block.
+    */
+    void request(uint64_t offset, uint64_t size, std::size_t blockSize);
+
+    /**
+      Return the next requested block, waiting for it to be read if
+      necessary.  A block is short if the end of the file was reached.
+      Throws std::runtime_error if the read failed.
+
+      \return  Next block, or an empty block if nothing is outstanding.
+    */
+    std::vector<char> next();
+
+    /**
+      Discard outstanding requests.  Reads in progress are waited for.
+    */
+    void clear();
+
+    /**
+      Whether no requested blocks remain to be returned.
+    */
+    bool empty() const
+        { return m_inflight.empty() && m_pending.empty(); }
+
+private:
+    struct Range
+    {
+        uint64_t m_offset;
+        uint64_t m_end;
+        std::size_t m_blockSize;
+    };
+
+    // Start reads of pending blocks until 'depth' are in progress.
+    void fill();
+    std::vector<char> readBlock(uint64_t offset, std::size_t size) const;
+
+    std::size_t m_depth;
+    std::string m_error;
+#ifdef _WIN32
+    void *m_handle;
+#else
+    int m_fd;
+#endif
+    std::deque<Range> m_pending;
+    std::deque<std::future<std::vector<char>>> m_inflight;
+    std::unique_ptr<ThreadPool> m_pool;
+
+    AsyncReader(const AsyncReader&) = delete;
+    AsyncReader& operator=(const AsyncReader&) = delete;
+};
+
+} // namespace pdal
@@ -37,7 +37,10 @@
 #include <iostream>
 #include <sstream>
 #ifndef _WIN32
+#include <fcntl.h>
 #include <glob.h>
+#include <sys/mman.h>
+#include <unistd.h>
 #else
 #include <codecvt>
 #include <Windows.h>
@@ -257,6 +260,23 @@ uintmax_t fileSize(const std::string& file)
 }
 
 
+std::time_t lastWriteTime(const std::string& file)
+{
+    pdalboost::system::error_code ec;
+    std::time_t t = pdalboost::filesystem::last_write_time(toNative(file), ec);
+    return ec ? 0 : t;
+}
+
+
+bool touchFile(const std::string& file)
+{
+    pdalboost::system::error_code ec;
+    pdalboost::filesystem::last_write_time(toNative(file), std::time(nullptr),
+        ec);
+    return !ec;
+}
+
+
 std::string readFileIntoString(const std::string& filename)
 {
     std::string str;
@@ -444,6 +464,127 @@ std::vector<std::string> glob(std::string path)
     return filenames;
 }
 
+
+MapContext mapFile(const std::string& filename, bool readOnly,
+    uintmax_t pos, uintmax_t size)
+{
+    MapContext ctx;
+
+#ifndef _WIN32
+    ctx.m_fd = ::open(filename.c_str(), readOnly ? O_RDONLY : O_RDWR);
+    if (ctx.m_fd == -1)
+    {
+        ctx.m_error = "Mapping couldn't open file.";
+        return ctx;
+    }
+
+    struct stat sbuf;
+    if (fstat(ctx.m_fd, &sbuf) != 0)
+    {
+        ctx.m_error = "Mapping couldn't determine file size.";
+        return unmapFile(ctx);
+    }
+    uintmax_t fileSize = (uintmax_t)sbuf.st_size;
+    uintmax_t granularity = (uintmax_t)sysconf(_SC_PAGESIZE);
+#else
+    ctx.m_handle = CreateFileW(toNative(filename).c_str(),
+        readOnly ? GENERIC_READ : GENERIC_READ | GENERIC_WRITE,
+        FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (ctx.m_handle == INVALID_HANDLE_VALUE)
+    {
+        ctx.m_handle = nullptr;
+        ctx.m_error = "Mapping couldn't open file.";
+        return ctx;
+    }
+
+    LARGE_INTEGER li;
+    if (!GetFileSizeEx(ctx.m_handle, &li))
+    {
+        ctx.m_error = "Mapping couldn't determine file size.";
+        return unmapFile(ctx);
+    }
+    uintmax_t fileSize = (uintmax_t)li.QuadPart;
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    uintmax_t granularity = (uintmax_t)info.dwAllocationGranularity;
+#endif
+
+    if (pos > fileSize)
+    {
+        ctx.m_error = "Mapping position is past the end of the file.";
+        return unmapFile(ctx);
+    }
+    if (size == 0)
+        size = fileSize - pos;
+    if (size == 0 || pos + size > fileSize)
+    {
+        ctx.m_error = "File too small to map requested region.";
+        return unmapFile(ctx);
+    }
+
+    // The mapping must start on a page (allocation granularity) boundary.
+    uintmax_t start = pos - (pos % granularity);
+    ctx.m_mapSize = size + (pos - start);
+
+#ifndef _WIN32
+    void *addr = ::mmap(0, ctx.m_mapSize,
+        readOnly ? PROT_READ : (PROT_READ | PROT_WRITE), MAP_SHARED,
+        ctx.m_fd, (off_t)start);
+    if (addr == MAP_FAILED)
+    {
+        ctx.m_error = "Couldn't map file.";
+        return unmapFile(ctx);
+    }
+#else
+    HANDLE map = CreateFileMapping(ctx.m_handle, NULL,
+        readOnly ? PAGE_READONLY : PAGE_READWRITE, 0, 0, NULL);
+    if (map == NULL)
+    {
+        ctx.m_error = "Couldn't create file mapping.";
+        return unmapFile(ctx);
+    }
+    void *addr = MapViewOfFile(map,
+        readOnly ? FILE_MAP_READ : FILE_MAP_READ | FILE_MAP_WRITE,
+        (DWORD)(start >> 32), (DWORD)(start & 0xFFFFFFFF),
+        (SIZE_T)ctx.m_mapSize);
+    // The view keeps the mapping object alive.
+    CloseHandle(map);
+    if (addr == NULL)
+    {
+        ctx.m_error = "Couldn't map file.";
+        return unmapFile(ctx);
+    }
+#endif
+
+    ctx.m_mapAddr = addr;
+    ctx.m_addr = static_cast<char *>(addr) + (pos - start);
+    ctx.m_size = size;
+    return ctx;
+}
+
+
+MapContext unmapFile(MapContext ctx)
+{
+#ifndef _WIN32
+    if (ctx.m_mapAddr && ::munmap(ctx.m_mapAddr, ctx.m_mapSize) == -1)
+        ctx.m_error = "Couldn't unmap file.";
+    if (ctx.m_fd != -1)
+        ::close(ctx.m_fd);
+    ctx.m_fd = -1;
+#else
+    if (ctx.m_mapAddr && !UnmapViewOfFile(ctx.m_mapAddr))
+        ctx.m_error = "Couldn't unmap file.";
+    if (ctx.m_handle)
+        CloseHandle(ctx.m_handle);
+    ctx.m_handle = nullptr;
+#endif
+    ctx.m_mapAddr = nullptr;
+    ctx.m_mapSize = 0;
+    ctx.m_addr = nullptr;
+    ctx.m_size = 0;
+    return ctx;
+}
+
 } // namespace FileUtils
 
 } // namespace pdal
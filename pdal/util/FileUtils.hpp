@@ -37,6 +37,7 @@
 #include <cassert>
 #include <cmath>
 #include <cstdint>
+#include <ctime>
 #include <istream>
 #include <ostream>
 #include <stdexcept>
@@ -50,6 +51,44 @@ namespace pdal
 
 namespace FileUtils
 {
+    /**
+      Description of a file region mapped into memory with mapFile().
+    */
+    struct MapContext
+    {
+    public:
+        MapContext() : m_fd(-1), m_handle(nullptr), m_addr(nullptr),
+            m_size(0), m_mapAddr(nullptr), m_mapSize(0)
+        {}
+
+        /**
+          Address of the first byte of the requested region, or nullptr
+          if the mapping failed.
+        */
+        void *addr() const
+            { return m_addr; }
+
+        /**
+          Number of bytes of the requested region that were mapped.
+        */
+        uintmax_t size() const
+            { return m_size; }
+
+        /**
+          Description of the error if the mapping failed.
+        */
+        std::string what() const
+            { return m_error; }
+
+        int m_fd;
+        void *m_handle;
+        void *m_addr;
+        uintmax_t m_size;
+        void *m_mapAddr;
+        uintmax_t m_mapSize;
+        std::string m_error;
+    };
+
     /**
       Open an existing file for reading.
 
@@ -155,6 +194,22 @@ namespace FileUtils
     */
     PDAL_DLL uintmax_t fileSize(const std::string& filename);
 
+    /**
+      Get the last modification time of a file.
+
+      \param filename  Filename.
+      \return  Modification time of the file or 0 if it can't be determined.
+    */
+    PDAL_DLL std::time_t lastWriteTime(const std::string& filename);
+
+    /**
+      Set the modification time of a file to the current time.
+
+      \param filename  Filename.
+      \return  \c true if successful, \c false otherwise
+    */
+    PDAL_DLL bool touchFile(const std::string& filename);
+
     /**
       Read a file into a string.
 
@@ -258,6 +313,28 @@ namespace FileUtils
       \return  List of files that correspond to provided file specification.
     */
     PDAL_DLL std::vector<std::string> glob(std::string filespec);
+
+    /**
+      Map a region of a file into memory.  The region need not start on a
+      page boundary.
+
+      \param filename  Name of file to map.
+      \param readOnly  Whether the region should be mapped read-only.
+      \param pos  Offset of the start of the region in the file.
+      \param size  Size of the region.  0 maps to the end of the file.
+      \return  Mapped context.  addr() is nullptr on error and what()
+        describes the error.
+    */
+    PDAL_DLL MapContext mapFile(const std::string& filename,
+        bool readOnly = true, uintmax_t pos = 0, uintmax_t size = 0);
+
+    /**
+      Unmap a region mapped with mapFile() and close the file.
+
+      \param ctx  Mapped context to unmap.
+      \return  Unmapped context.  what() describes an error, if any.
+    */
+    PDAL_DLL MapContext unmapFile(MapContext ctx);
 }
 
 } // namespace pdal
@@ -0,0 +1,102 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+
+namespace pdal
+{
+namespace Utils
+{
+
+/**
+  SplitMix64 finalizer.  Maps a 64-bit value to a well-mixed 64-bit value.
+
+  \param v  Value to mix.
+  \return  Mixed value.
+*/
+inline uint64_t mix64(uint64_t v)
+{
+    v += 0x9E3779B97F4A7C15ULL;
+    v = (v ^ (v >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    v = (v ^ (v >> 27)) * 0x94D049BB133111EBULL;
+    return v ^ (v >> 31);
+}
+
+/**
+  Counter-based random number generator.  A value is a hash of the seed,
+  a counter and a stream number rather than the next value of a generator
+  with state, so the values for any counter can be made on any thread and
+  in any order.  Results depend only on the seed, never on how the work is
+  split across threads.
+*/
+class CounterRandom
+{
+public:
+    /**
+      Create a generator.
+
+      \param seed  Random seed.
+    */
+    CounterRandom(uint64_t seed) : m_seed(mix64(seed))
+    {}
+
+    /**
+      Get a random value.
+
+      \param counter  Counter (typically a point or item number).
+      \param stream  Number of one of several values for a counter.
+        Only the low eight bits are significant.
+      \return  Random value.
+    */
+    uint64_t operator()(uint64_t counter, uint64_t stream = 0) const
+        { return mix64(m_seed ^ mix64(counter ^ (stream << 56))); }
+
+    /**
+      Get a random value in [0, 1).
+
+      \param counter  Counter (typically a point or item number).
+      \param stream  Number of one of several values for a counter.
+      \return  Random value.
+    */
+    double unit(uint64_t counter, uint64_t stream = 0) const
+        { return ((*this)(counter, stream) >> 11) *
+            (1.0 / 9007199254740992.0); }
+
+private:
+    uint64_t m_seed;
+};
+
+} // namespace Utils
+} // namespace pdal
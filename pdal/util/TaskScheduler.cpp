@@ -0,0 +1,367 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <algorithm>
+#include <chrono>
+
+#include "TaskScheduler.hpp"
+
+namespace pdal
+{
+
+namespace
+{
+
+// Scheduler and index of the worker running on this thread, if any.
+thread_local const TaskScheduler *tlsScheduler = nullptr;
+thread_local int tlsIndex = -1;
+
+} // unnamed namespace
+
+
+TaskScheduler::TaskScheduler() : m_queued(0), m_concurrency(1), m_stop(false)
+{
+    start(0);
+}
+
+
+TaskScheduler::~TaskScheduler()
+{
+    stop();
+}
+
+
+TaskScheduler& TaskScheduler::instance()
+{
+    static TaskScheduler scheduler;
+    return scheduler;
+}
+
+
+void TaskScheduler::setConcurrency(std::size_t concurrency)
+{
+    if (concurrency == 0)
+        concurrency = std::thread::hardware_concurrency();
+    if (concurrency == m_concurrency)
+        return;
+    stop();
+    start(concurrency);
+}
+
+
+std::size_t TaskScheduler::concurrency() const
+{
+    return m_concurrency;
+}
+
+
+void TaskScheduler::start(std::size_t concurrency)
+{
+    if (concurrency == 0)
+        concurrency = std::thread::hardware_concurrency();
+    if (concurrency == 0)
+        concurrency = 1;
+    m_concurrency = concurrency;
+
+    m_stop = false;
+    for (std::size_t i = 0; i < concurrency - 1; ++i)
+        m_workers.emplace_back(new Worker);
+    for (std::size_t i = 0; i < m_workers.size(); ++i)
+        m_workers[i]->thread = std::thread([this, i](){ work(i); });
+}
+
+
+void TaskScheduler::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    for (auto& w : m_workers)
+        w->thread.join();
+
+    // Keep tasks that haven't been run so that they run on the new workers.
+    std::lock_guard<std::mutex> lock(m_injectedMutex);
+    for (auto& w : m_workers)
+        for (Task& t : w->tasks)
+            m_injected.push_back(std::move(t));
+    m_workers.clear();
+}
+
+
+int TaskScheduler::workerIndex() const
+{
+    return tlsScheduler == this ? tlsIndex : -1;
+}
+
+
+void TaskScheduler::submit(Task task)
+{
+    int index = workerIndex();
+    if (index >= 0)
+    {
+        Worker& w = *m_workers[index];
+        std::lock_guard<std::mutex> lock(w.mutex);
+        w.tasks.push_back(std::move(task));
+    }
+    else
+    {
+        std::lock_guard<std::mutex> lock(m_injectedMutex);
+        m_injected.push_back(std::move(task));
+    }
+
+    // Count the task under the lock that idle workers wait on so that
+    // a worker can't miss the notification.
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queued++;
+    }
+    m_cv.notify_one();
+}
+
+
+// Take the newest task from our own deque, then the oldest shared task,
+// then steal the oldest task from another worker.
+bool TaskScheduler::take(int index, Task& task)
+{
+    if (index >= 0)
+    {
+        Worker& w = *m_workers[index];
+        std::lock_guard<std::mutex> lock(w.mutex);
+        if (w.tasks.size())
+        {
+            task = std::move(w.tasks.back());
+            w.tasks.pop_back();
+            m_queued--;
+            return true;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_injectedMutex);
+        if (m_injected.size())
+        {
+            task = std::move(m_injected.front());
+            m_injected.pop_front();
+            m_queued--;
+            return true;
+        }
+    }
+
+    const std::size_t numWorkers = m_workers.size();
+    for (std::size_t i = 1; i <= numWorkers; ++i)
+    {
+        std::size_t victim = (index + i) % numWorkers;
+        if ((int)victim == index)
+            continue;
+        Worker& w = *m_workers[victim];
+        std::lock_guard<std::mutex> lock(w.mutex);
+        if (w.tasks.size())
+        {
+            task = std::move(w.tasks.front());
+            w.tasks.pop_front();
+            m_queued--;
+            return true;
+        }
+    }
+    return false;
+}
+
+
+bool TaskScheduler::runOne()
+{
+    Task task;
+    if (!take(workerIndex(), task))
+        return false;
+    task();
+    return true;
+}
+
+
+void TaskScheduler::work(std::size_t index)
+{
+    tlsScheduler = this;
+    tlsIndex = (int)index;
+
+    Task task;
+    while (true)
+    {
+        if (take((int)index, task))
+        {
+            task();
+            task = nullptr;
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait(lock, [this](){ return m_stop || m_queued > 0; });
+        if (m_stop)
+            break;
+    }
+    tlsScheduler = nullptr;
+    tlsIndex = -1;
+}
+
+
+TaskGroup::TaskGroup(TaskScheduler& scheduler) :
+    m_scheduler(scheduler), m_state(new State)
+{}
+
+
+TaskGroup::~TaskGroup()
+{
+    try
+    {
+        wait();
+    }
+    catch (...)
+    {}
+}
+
+
+void TaskGroup::run(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        m_state->pending++;
+    }
+
+    std::shared_ptr<State> state(m_state);
+    m_scheduler.submit([state, task]()
+    {
+        std::exception_ptr error;
+        try
+        {
+            task();
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if (error && !state->error)
+            state->error = error;
+        if (--state->pending == 0)
+            state->cv.notify_all();
+    });
+}
+
+
+void TaskGroup::wait()
+{
+    State& s = *m_state;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(s.mutex);
+            if (s.pending == 0)
+                break;
+        }
+
+        // Help out rather than block.  When there's nothing to run, the
+        // group's remaining tasks are running on other threads, though
+        // those tasks may add more work, so check back now and then.
+        if (!m_scheduler.runOne())
+        {
+            std::unique_lock<std::mutex> lock(s.mutex);
+            s.cv.wait_for(lock, std::chrono::milliseconds(1),
+                [&s](){ return s.pending == 0; });
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(s.mutex);
+    if (s.error)
+    {
+        std::exception_ptr error(s.error);
+        s.error = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+
+void parallelFor(std::size_t count, std::size_t maxThreads,
+    const std::function<void(std::size_t)>& fn)
+{
+    TaskScheduler& scheduler = TaskScheduler::instance();
+    if (maxThreads == 0)
+        maxThreads = scheduler.concurrency();
+    const std::size_t numTasks = (std::min)(count, maxThreads);
+    if (numTasks <= 1)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+            fn(i);
+        return;
+    }
+
+    std::atomic<std::size_t> next(0);
+    std::atomic<bool> failed(false);
+    auto body = [&next, &failed, &fn, count]()
+    {
+        try
+        {
+            for (std::size_t i = next++; i < count && !failed; i = next++)
+                fn(i);
+        }
+        catch (...)
+        {
+            failed = true;
+            throw;
+        }
+    };
+
+    TaskGroup group(scheduler);
+    for (std::size_t i = 1; i < numTasks; ++i)
+        group.run(body);
+
+    // The calling thread takes a share of the work too.  The group must
+    // be finished before leaving, since its tasks refer to locals.
+    try
+    {
+        body();
+    }
+    catch (...)
+    {
+        try
+        {
+            group.wait();
+        }
+        catch (...)
+        {}
+        throw;
+    }
+    group.wait();
+}
+
+} // namespace pdal
@@ -0,0 +1,207 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "pdal_util_export.hpp"
+
+namespace pdal
+{
+
+/**
+  Process-wide work-stealing task scheduler.
+
+  The scheduler owns one less worker thread than its concurrency; the
+  thread that waits on a TaskGroup runs tasks as well, so the concurrency
+  is the number of tasks that can run at once.  Each worker has its own
+  deque: tasks added from a worker go to the back of its deque and are
+  run from the back, while idle workers steal from the front of other
+  workers' deques.  Tasks added from other threads go to a shared queue.
+
+  Since all parallel loops share the one set of workers, nested parallel
+  work (a parallel query inside a parallel stage, for instance) doesn't
+  multiply the number of threads.
+*/
+class PDAL_DLL TaskScheduler
+{
+public:
+    typedef std::function<void()> Task;
+
+    ~TaskScheduler();
+
+    /**
+      Get the process-wide scheduler.
+
+      \return  The scheduler.
+    */
+    static TaskScheduler& instance();
+
+    /**
+      Set the number of tasks that can run at once.  The workers are
+      restarted, so this is meant to be called once by an application
+      before any tasks run, not by stages or pipelines.  Pending tasks are
+      kept.  Does nothing if the concurrency is unchanged; otherwise must
+      not be called while tasks are running.
+
+      \param concurrency  Number of tasks that can run at once.  When 0,
+        one per core is used.
+    */
+    void setConcurrency(std::size_t concurrency);
+
+    /**
+      Get the number of tasks that can run at once.
+
+      \return  The number of tasks that can run at once.
+    */
+    std::size_t concurrency() const;
+
+    /**
+      Add a task to be run by a worker (or a thread waiting on a task
+      group).
+
+      \param task  Task to add.
+    */
+    void submit(Task task);
+
+    /**
+      Run one pending task on the calling thread, if there is one.
+
+      \return  Whether a task was run.
+    */
+    bool runOne();
+
+private:
+    struct Worker
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+        std::thread thread;
+    };
+
+    TaskScheduler();
+    TaskScheduler(const TaskScheduler&);
+    TaskScheduler& operator=(const TaskScheduler&);
+
+    void start(std::size_t concurrency);
+    void stop();
+    void work(std::size_t index);
+    bool take(int index, Task& task);
+    int workerIndex() const;
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::deque<Task> m_injected;
+    std::mutex m_injectedMutex;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::atomic<int64_t> m_queued;
+    std::atomic<std::size_t> m_concurrency;
+    bool m_stop;
+};
+
+/**
+  A set of tasks run by the TaskScheduler that can be waited on together.
+*/
+class PDAL_DLL TaskGroup
+{
+public:
+    /**
+      Create a task group.
+
+      \param scheduler  Scheduler that runs the tasks.
+    */
+    TaskGroup(TaskScheduler& scheduler = TaskScheduler::instance());
+
+    /**
+      Wait for the tasks of the group.  Errors are discarded; call wait()
+      to see them.
+    */
+    ~TaskGroup();
+
+    /**
+      Add a task to the group.
+
+      \param task  Task to run.
+    */
+    void run(std::function<void()> task);
+
+    /**
+      Wait for all tasks of the group to finish, running pending tasks
+      on the calling thread in the meantime.  If a task threw, the first
+      exception is rethrown once all tasks are done.
+    */
+    void wait();
+
+private:
+    struct State
+    {
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::size_t pending;
+        std::exception_ptr error;
+
+        State() : pending(0)
+        {}
+    };
+
+    TaskScheduler& m_scheduler;
+    std::shared_ptr<State> m_state;
+};
+
+/**
+  Call a function for each index in [0, count) using the TaskScheduler.
+  Indices are handed out one at a time, so callers should make each index
+  a reasonably sized chunk of work.  Calls may be made concurrently.  If
+  a call throws, remaining indices are skipped and the first exception is
+  rethrown.
+
+  \param count  Number of indices.
+  \param maxThreads  Maximum number of calls made at once.  When 0, the
+    scheduler's concurrency is used.
+  \param fn  Function to call with each index.
+*/
+PDAL_DLL void parallelFor(std::size_t count, std::size_t maxThreads,
+    const std::function<void(std::size_t)>& fn);
+
+} // namespace pdal
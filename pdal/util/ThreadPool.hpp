@@ -0,0 +1,175 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "pdal_util_export.hpp"
+
+namespace pdal
+{
+
+/**
+  A simple fixed-size pool of worker threads that run queued tasks.
+*/
+class PDAL_DLL ThreadPool
+{
+public:
+    /**
+      Create a thread pool and start the worker threads.
+
+      After numThreads tasks are actively running and queueSize tasks have
+      been enqueued to wait for an available worker thread, subsequent
+      calls to add() will block until an enqueued task has been popped from
+      the queue.  A negative queueSize allows an unbounded queue.
+
+      \param numThreads  Number of worker threads.
+      \param queueSize  Maximum number of queued tasks.
+      \param verbose  Whether to write task errors to std::cerr.
+    */
+    ThreadPool(std::size_t numThreads, int64_t queueSize = -1,
+            bool verbose = true) :
+        m_queueSize(queueSize), m_numThreads(std::max<size_t>(numThreads, 1)),
+        m_verbose(verbose), m_outstanding(0), m_running(false)
+    {
+        go();
+    }
+
+    ~ThreadPool()
+        { join(); }
+
+    /**
+      Start the worker threads.
+    */
+    void go();
+
+    /**
+      Disallow the addition of new tasks and wait for all currently running
+      tasks to complete.
+    */
+    void join();
+
+    /**
+      Wait for all current tasks to complete.  As opposed to join(), tasks
+      may continue to be added while a thread is waiting for the queue to
+      empty.
+    */
+    void await();
+
+    /**
+      Join and restart.
+    */
+    void cycle()
+        { join(); go(); }
+
+    /**
+      Change the number of threads.  Current threads will be joined.
+
+      \param numThreads  New number of worker threads.
+    */
+    void resize(std::size_t numThreads)
+    {
+        join();
+        m_numThreads = std::max<size_t>(numThreads, 1);
+        go();
+    }
+
+    /**
+      Return the error messages of tasks that threw an exception.
+      Not thread-safe - the pool should be awaited or joined before calling.
+
+      \return  List of error messages.
+    */
+    const std::vector<std::string>& errors() const
+        { return m_errors; }
+
+    /**
+      Add a task to the queue, blocking until a spot in the queue is
+      available.
+
+      \param task  Task to run.
+    */
+    void add(std::function<void()> task)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (!m_running)
+            throw std::runtime_error("Attempted to add a task to a stopped "
+                "thread pool.");
+
+        m_produceCv.wait(lock, [this]()
+            { return m_queueSize < 0 || m_tasks.size() < (size_t)m_queueSize; });
+
+        m_tasks.emplace(task);
+
+        // Notify a worker that a task is available.
+        lock.unlock();
+        m_consumeCv.notify_all();
+    }
+
+    std::size_t numThreads() const
+        { return m_numThreads; }
+
+private:
+    // Worker thread function.  Wait for a task and run it - or if join() is
+    // called, complete any outstanding task and return.
+    void work();
+
+    int64_t m_queueSize;
+    std::size_t m_numThreads;
+    bool m_verbose;
+    std::vector<std::thread> m_threads;
+    std::queue<std::function<void()>> m_tasks;
+    std::vector<std::string> m_errors;
+    std::size_t m_outstanding;
+    bool m_running;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_produceCv;
+    std::condition_variable m_consumeCv;
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+};
+
+} // namespace pdal
@@ -0,0 +1,176 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <string>
+
+#include <arrow/api.h>
+
+#include <pdal/Dimension.hpp>
+#include <pdal/util/FileUtils.hpp>
+#include <pdal/util/Utils.hpp>
+
+namespace pdal
+{
+namespace arrowplugin
+{
+
+/// Name of the WKB point column written to GeoParquet files.
+const std::string GeometryColumn = "geometry";
+
+/// Key of the GeoParquet file metadata.
+const std::string GeoMetadataKey = "geo";
+
+/// Key of the schema metadata holding the WKT of the points' SRS.
+const std::string SrsMetadataKey = "pdal:srs";
+
+enum class Format
+{
+    Unknown,
+    Feather,
+    GeoParquet
+};
+
+/// Get the Arrow type that stores values of a dimension type.
+/// \return  Arrow type, or nullptr if there's no matching type.
+inline std::shared_ptr<arrow::DataType> arrowType(Dimension::Type t)
+{
+    using Type = Dimension::Type;
+
+    switch (t)
+    {
+    case Type::Signed8:
+        return arrow::int8();
+    case Type::Signed16:
+        return arrow::int16();
+    case Type::Signed32:
+        return arrow::int32();
+    case Type::Signed64:
+        return arrow::int64();
+    case Type::Unsigned8:
+        return arrow::uint8();
+    case Type::Unsigned16:
+        return arrow::uint16();
+    case Type::Unsigned32:
+        return arrow::uint32();
+    case Type::Unsigned64:
+        return arrow::uint64();
+    case Type::Float:
+        return arrow::float32();
+    case Type::Double:
+        return arrow::float64();
+    default:
+        return nullptr;
+    }
+}
+
+/// Get the dimension type that stores values of an Arrow type.
+/// \return  Dimension type, or Type::None if the Arrow type isn't a
+///   fixed-width number.
+inline Dimension::Type pdalType(const arrow::DataType& t)
+{
+    using Type = Dimension::Type;
+
+    switch (t.id())
+    {
+    case arrow::Type::INT8:
+        return Type::Signed8;
+    case arrow::Type::INT16:
+        return Type::Signed16;
+    case arrow::Type::INT32:
+        return Type::Signed32;
+    case arrow::Type::INT64:
+        return Type::Signed64;
+    case arrow::Type::UINT8:
+        return Type::Unsigned8;
+    case arrow::Type::UINT16:
+        return Type::Unsigned16;
+    case arrow::Type::UINT32:
+        return Type::Unsigned32;
+    case arrow::Type::UINT64:
+        return Type::Unsigned64;
+    case arrow::Type::FLOAT:
+        return Type::Float;
+    case arrow::Type::DOUBLE:
+        return Type::Double;
+    default:
+        return Type::None;
+    }
+}
+
+/// Get the format of a file from its extension.
+inline Format formatFromFilename(const std::string& filename)
+{
+    std::string ext = Utils::tolower(FileUtils::extension(filename));
+    if (ext == ".parquet" || ext == ".geoparquet")
+        return Format::GeoParquet;
+    return Format::Feather;
+}
+
+inline std::istream& operator>>(std::istream& in, Format& f)
+{
+    std::string s;
+    in >> s;
+    s = Utils::tolower(s);
+    if (s == "feather" || s == "arrow" || s == "ipc")
+        f = Format::Feather;
+    else if (s == "geoparquet" || s == "parquet")
+        f = Format::GeoParquet;
+    else
+        in.setstate(std::ios_base::failbit);
+    return in;
+}
+
+inline std::ostream& operator<<(std::ostream& out, const Format& f)
+{
+    switch (f)
+    {
+    case Format::Feather:
+        out << "feather";
+        break;
+    case Format::GeoParquet:
+        out << "geoparquet";
+        break;
+    default:
+        break;
+    }
+    return out;
+}
+
+} // namespace arrowplugin
+} // namespace pdal
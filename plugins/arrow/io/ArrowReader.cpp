@@ -0,0 +1,485 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <algorithm>
+#include <limits>
+
+#include <arrow/io/file.h>
+#include <arrow/ipc/reader.h>
+#include <arrow/util/key_value_metadata.h>
+#include <arrow/util/thread_pool.h>
+#include <parquet/arrow/reader.h>
+#include <parquet/arrow/schema.h>
+#include <parquet/file_reader.h>
+#include <parquet/metadata.h>
+#include <parquet/statistics.h>
+
+#include <nlohmann/json.hpp>
+
+#include <pdal/util/FileUtils.hpp>
+
+#include "ArrowReader.hpp"
+
+namespace pdal
+{
+
+static PluginInfo const s_info
+{
+    "readers.arrow",
+    "Read points from Arrow IPC (Feather) or GeoParquet files.",
+    "http://pdal.io/stages/readers.arrow.html"
+};
+
+CREATE_SHARED_STAGE(ArrowReader, s_info)
+
+using namespace arrowplugin;
+
+namespace
+{
+
+template<typename T>
+void statsRange(const parquet::Statistics& stats, double& min, double& max)
+{
+    auto& s = static_cast<const parquet::TypedStatistics<T>&>(stats);
+    min = (double)s.min();
+    max = (double)s.max();
+}
+
+// Get the range of the values of a column chunk from its statistics.
+// \return  Whether the chunk has usable statistics.
+bool chunkRange(const parquet::ColumnChunkMetaData& chunk, double& min,
+    double& max)
+{
+    if (!chunk.is_stats_set())
+        return false;
+    std::shared_ptr<parquet::Statistics> stats = chunk.statistics();
+    if (!stats || !stats->HasMinMax())
+        return false;
+
+    // Unsigned integers are stored as signed physical types.
+    const bool isSigned =
+        (chunk.descr()->sort_order() == parquet::SortOrder::SIGNED);
+    switch (stats->physical_type())
+    {
+    case parquet::Type::DOUBLE:
+        statsRange<parquet::DoubleType>(*stats, min, max);
+        return true;
+    case parquet::Type::FLOAT:
+        statsRange<parquet::FloatType>(*stats, min, max);
+        return true;
+    case parquet::Type::INT32:
+        if (!isSigned)
+            return false;
+        statsRange<parquet::Int32Type>(*stats, min, max);
+        return true;
+    case parquet::Type::INT64:
+        if (!isSigned)
+            return false;
+        statsRange<parquet::Int64Type>(*stats, min, max);
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool contains(const StringList& names, const std::string& name)
+{
+    return std::find(names.begin(), names.end(), name) != names.end();
+}
+
+} // unnamed namespace
+
+struct ArrowReader::Args
+{
+    Format m_format;
+    StringList m_dimNames;
+    Bounds m_bounds;
+    int m_threads;
+};
+
+
+ArrowReader::ArrowReader() : m_args(new ArrowReader::Args),
+    m_format(Format::Unknown), m_query(false), m_featherBatch(0), m_row(0)
+{}
+
+
+ArrowReader::~ArrowReader()
+{}
+
+
+std::string ArrowReader::getName() const
+{
+    return s_info.name;
+}
+
+
+void ArrowReader::check(const arrow::Status& status) const
+{
+    if (!status.ok())
+        throwError(status.ToString());
+}
+
+
+template<typename T>
+T ArrowReader::check(arrow::Result<T> result) const
+{
+    check(result.status());
+    return result.MoveValueUnsafe();
+}
+
+
+void ArrowReader::addArgs(ProgramArgs& args)
+{
+    args.add("format", "Input format ('feather' or 'geoparquet').  "
+        "Determined from the file contents if not set", m_args->m_format,
+        Format::Unknown);
+    args.add("dimensions", "Columns to read.  All numeric columns are read "
+        "if not set", m_args->m_dimNames);
+    args.add("bounds", "Bounds of points to read.  GeoParquet row groups "
+        "that don't overlap are skipped", m_args->m_bounds);
+    args.add("threads", "Number of threads used to decode columns",
+        m_args->m_threads, 1);
+}
+
+
+void ArrowReader::initialize()
+{
+    if (m_args->m_threads < 1)
+        throwError("Option 'threads' must be at least 1.");
+
+    m_format = m_args->m_format;
+    if (m_format == Format::Unknown)
+    {
+        std::istream *in = FileUtils::openFile(m_filename);
+        if (!in)
+            throwError("Unable to open file '" + m_filename + "'.");
+        char magic[6] {};
+        in->read(magic, sizeof(magic));
+        FileUtils::closeFile(in);
+        if (std::equal(magic, magic + 4, "PAR1"))
+            m_format = Format::GeoParquet;
+        else if (std::equal(magic, magic + 6, "ARROW1"))
+            m_format = Format::Feather;
+        else
+            throwError("File '" + m_filename + "' isn't an Arrow IPC "
+                "or Parquet file.");
+    }
+
+    m_file = check(arrow::io::ReadableFile::Open(m_filename));
+    if (m_format == Format::Feather)
+    {
+        m_feather = check(arrow::ipc::RecordBatchFileReader::Open(m_file));
+        m_schema = m_feather->schema();
+    }
+    else
+    {
+        parquet::ArrowReaderProperties properties;
+        properties.set_use_threads(m_args->m_threads > 1);
+
+        parquet::arrow::FileReaderBuilder builder;
+        check(builder.Open(m_file));
+        check(builder.properties(properties)->Build(&m_parquet));
+        check(m_parquet->GetSchema(&m_schema));
+    }
+    readSpatialReference();
+    selectColumns();
+}
+
+
+// The SRS is taken from GeoParquet metadata, if there is any, and from
+// the WKT stored by writers.arrow otherwise.
+void ArrowReader::readSpatialReference()
+{
+    std::shared_ptr<const arrow::KeyValueMetadata> metadata =
+        m_schema->metadata();
+    if (!metadata)
+        return;
+
+    int pos = metadata->FindKey(GeoMetadataKey);
+    if (pos >= 0)
+    {
+        try
+        {
+            NL::json geo = NL::json::parse(metadata->value(pos));
+            std::string primary = geo.at("primary_column").get<std::string>();
+            const NL::json& crs = geo.at("columns").at(primary).value("crs",
+                NL::json());
+            if (crs.is_object())
+            {
+                setSpatialReference(SpatialReference(crs.dump()));
+                return;
+            }
+        }
+        catch (const NL::json::exception& err)
+        {
+            log()->get(LogLevel::Warning) << getName() << ": Invalid "
+                "GeoParquet metadata: " << err.what() << std::endl;
+        }
+    }
+
+    pos = metadata->FindKey(SrsMetadataKey);
+    if (pos >= 0)
+        setSpatialReference(SpatialReference(metadata->value(pos)));
+}
+
+
+// Choose the columns to read.  Columns that aren't numbers, such as the
+// GeoParquet geometry, can't be stored as dimensions.
+void ArrowReader::selectColumns()
+{
+    StringList names = m_args->m_dimNames;
+    for (std::string& name : names)
+        if (m_schema->GetFieldIndex(name) < 0)
+            throwError("Column '" + name + "' doesn't exist.");
+
+    // Points can only be tested against the bounds if their position is
+    // read.
+    m_query = m_args->m_bounds.to2d().valid();
+    if (m_query && names.size())
+        for (std::string name : { "X", "Y", "Z" })
+            if (!contains(names, name) &&
+                    m_schema->GetFieldIndex(name) >= 0)
+                names.push_back(name);
+
+    m_columns.clear();
+    for (int i = 0; i < m_schema->num_fields(); ++i)
+    {
+        const arrow::Field& field = *m_schema->field(i);
+        if (names.size() && !contains(names, field.name()))
+            continue;
+
+        Dimension::Type type = pdalType(*field.type());
+        if (type == Dimension::Type::None)
+        {
+            if (names.size())
+                throwError("Column '" + field.name() + "' of type '" +
+                    field.type()->ToString() + "' can't be read.");
+            log()->get(LogLevel::Debug) << getName() << ": Skipping column '"
+                << field.name() << "' of type '" <<
+                field.type()->ToString() << "'." << std::endl;
+            continue;
+        }
+        m_columns.emplace_back(field.name(), type, i);
+        m_columns.back().m_batchIndex = (int)m_columns.size() - 1;
+    }
+}
+
+
+void ArrowReader::addDimensions(PointLayoutPtr layout)
+{
+    for (Column& c : m_columns)
+        c.m_id = layout->registerOrAssignDim(c.m_name, c.m_type);
+}
+
+
+void ArrowReader::ready(PointTableRef table)
+{
+    if (m_query)
+    {
+        const double lowest = std::numeric_limits<double>::lowest();
+        const double highest = (std::numeric_limits<double>::max)();
+
+        if (m_args->m_bounds.is3d())
+            m_queryBounds = m_args->m_bounds.to3d();
+        else
+        {
+            BOX2D box = m_args->m_bounds.to2d();
+            m_queryBounds = BOX3D(box.minx, box.miny, lowest,
+                box.maxx, box.maxy, highest);
+        }
+    }
+
+    // Arrow decodes columns on its shared CPU thread pool.
+    if (m_args->m_threads > 1)
+        check(arrow::SetCpuThreadPoolCapacity(m_args->m_threads));
+
+    std::vector<int> fields;
+    for (Column& c : m_columns)
+        fields.push_back(c.m_field);
+
+    if (m_format == Format::Feather)
+    {
+        arrow::ipc::IpcReadOptions options =
+            arrow::ipc::IpcReadOptions::Defaults();
+        options.included_fields = fields;
+        options.use_threads = (m_args->m_threads > 1);
+        m_feather = check(arrow::ipc::RecordBatchFileReader::Open(m_file,
+            options));
+        m_featherBatch = 0;
+    }
+    else
+    {
+        // Parquet readers select leaf columns rather than fields.
+        const parquet::arrow::SchemaManifest& manifest = m_parquet->manifest();
+        std::vector<int> leaves;
+        for (int field : fields)
+            leaves.push_back(manifest.schema_fields[field].column_index);
+        check(m_parquet->GetRecordBatchReader(selectRowGroups(), leaves,
+            &m_batches));
+    }
+    m_batch.reset();
+    m_row = 0;
+}
+
+
+std::vector<int> ArrowReader::selectRowGroups() const
+{
+    std::shared_ptr<parquet::FileMetaData> metadata =
+        m_parquet->parquet_reader()->metadata();
+
+    std::vector<int> rowGroups;
+    for (int i = 0; i < metadata->num_row_groups(); ++i)
+        if (!m_query || overlaps(*metadata->RowGroup(i)))
+            rowGroups.push_back(i);
+    if (m_query)
+        log()->get(LogLevel::Debug) << getName() << ": Skipping " <<
+            (metadata->num_row_groups() - rowGroups.size()) << " of " <<
+            metadata->num_row_groups() << " row groups outside of "
+            "bounds." << std::endl;
+    return rowGroups;
+}
+
+
+// Determine whether a row group may have points within the bounds
+// using the statistics of its position columns.
+bool ArrowReader::overlaps(const parquet::RowGroupMetaData& rowGroup) const
+{
+    const BOX3D& b = m_queryBounds;
+    const double low[] = { b.minx, b.miny, b.minz };
+    const double high[] = { b.maxx, b.maxy, b.maxz };
+    const char *names[] = { "X", "Y", "Z" };
+
+    for (int i = 0; i < 3; ++i)
+    {
+        int col = rowGroup.schema()->ColumnIndex(names[i]);
+        if (col < 0)
+            continue;
+
+        double min, max;
+        if (chunkRange(*rowGroup.ColumnChunk(col), min, max) &&
+                (max < low[i] || min > high[i]))
+            return false;
+    }
+    return true;
+}
+
+
+// Read the next non-empty record batch.
+// \return  Whether there was a batch to read.
+bool ArrowReader::nextBatch()
+{
+    m_row = 0;
+    do
+    {
+        if (m_feather)
+        {
+            if (m_featherBatch == m_feather->num_record_batches())
+                return false;
+            m_batch = check(m_feather->ReadRecordBatch(m_featherBatch++));
+        }
+        else
+        {
+            check(m_batches->ReadNext(&m_batch));
+            if (!m_batch)
+                return false;
+        }
+    } while (m_batch->num_rows() == 0);
+
+    for (Column& c : m_columns)
+    {
+        c.m_array = m_batch->column(c.m_batchIndex);
+        const arrow::ArrayData& data = *c.m_array->data();
+        c.m_data = data.buffers[1]->data() +
+            data.offset * Dimension::size(c.m_type);
+    }
+    return true;
+}
+
+
+bool ArrowReader::processOne(PointRef& point)
+{
+    const uint64_t zero = 0;
+
+    while (true)
+    {
+        if (!m_batch || m_row == m_batch->num_rows())
+            if (!nextBatch())
+                return false;
+
+        for (Column& c : m_columns)
+        {
+            if (c.m_array->IsNull(m_row))
+                point.setField(c.m_id, c.m_type, &zero);
+            else
+                point.setField(c.m_id, c.m_type,
+                    c.m_data + m_row * Dimension::size(c.m_type));
+        }
+        m_row++;
+
+        if (!m_query || m_queryBounds.contains(
+                point.getFieldAs<double>(Dimension::Id::X),
+                point.getFieldAs<double>(Dimension::Id::Y),
+                point.getFieldAs<double>(Dimension::Id::Z)))
+            return true;
+    }
+}
+
+
+point_count_t ArrowReader::read(PointViewPtr view, point_count_t count)
+{
+    PointId start = view->size();
+    PointRef point = view->point(start);
+    point_count_t cnt;
+    for (cnt = 0; cnt < count; ++cnt)
+    {
+        point.setPointId(start + cnt);
+        if (!processOne(point))
+            break;
+    }
+    return cnt;
+}
+
+
+void ArrowReader::done(PointTableRef table)
+{
+    for (Column& c : m_columns)
+    {
+        c.m_array.reset();
+        c.m_data = nullptr;
+    }
+    m_batch.reset();
+    m_batches.reset();
+}
+
+} // namespace pdal
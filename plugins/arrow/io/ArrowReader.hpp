@@ -0,0 +1,129 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <pdal/Reader.hpp>
+#include <pdal/Streamable.hpp>
+
+#include "ArrowCommon.hpp"
+
+namespace arrow
+{
+namespace io
+{
+    class RandomAccessFile;
+}
+namespace ipc
+{
+    class RecordBatchFileReader;
+}
+}
+
+namespace parquet
+{
+    class RowGroupMetaData;
+namespace arrow
+{
+    class FileReader;
+}
+}
+
+namespace pdal
+{
+
+class PDAL_DLL ArrowReader : public Reader, public Streamable
+{
+public:
+    // A file column that is read into a dimension.
+    struct Column
+    {
+        std::string m_name;
+        Dimension::Type m_type;
+        Dimension::Id m_id;
+        int m_field;  // Index of the field in the file schema.
+        int m_batchIndex;  // Index of the column in the record batches.
+        std::shared_ptr<arrow::Array> m_array;  // Column of current batch.
+        const uint8_t *m_data;  // Values of the current batch.
+
+        Column(const std::string& name, Dimension::Type type, int field) :
+            m_name(name), m_type(type), m_id(Dimension::Id::Unknown),
+            m_field(field), m_batchIndex(-1), m_data(nullptr)
+        {}
+    };
+
+    ArrowReader();
+    ~ArrowReader();
+    std::string getName() const;
+
+private:
+    virtual void addArgs(ProgramArgs& args);
+    virtual void initialize();
+    virtual void addDimensions(PointLayoutPtr layout);
+    virtual void ready(PointTableRef table);
+    virtual bool processOne(PointRef& point);
+    virtual point_count_t read(PointViewPtr view, point_count_t count);
+    virtual void done(PointTableRef table);
+
+    void readSpatialReference();
+    void selectColumns();
+    std::vector<int> selectRowGroups() const;
+    bool overlaps(const parquet::RowGroupMetaData& rowGroup) const;
+    bool nextBatch();
+    void check(const arrow::Status& status) const;
+    template<typename T>
+    T check(arrow::Result<T> result) const;
+
+    struct Args;
+    std::unique_ptr<Args> m_args;
+
+    arrowplugin::Format m_format;
+    std::shared_ptr<arrow::io::RandomAccessFile> m_file;
+    std::shared_ptr<arrow::Schema> m_schema;
+    std::vector<Column> m_columns;
+    bool m_query;
+    BOX3D m_queryBounds;
+
+    std::shared_ptr<arrow::ipc::RecordBatchFileReader> m_feather;
+    int m_featherBatch;  // Index of the next record batch to read.
+    std::unique_ptr<parquet::arrow::FileReader> m_parquet;
+    std::unique_ptr<arrow::RecordBatchReader> m_batches;
+    std::shared_ptr<arrow::RecordBatch> m_batch;
+    int64_t m_row;  // Index of the next row of the current batch.
+
+    ArrowReader(const ArrowReader&) = delete;
+    ArrowReader& operator=(const ArrowReader&) = delete;
+};
+
+} // namespace pdal
@@ -0,0 +1,475 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <algorithm>
+#include <limits>
+
+#include <arrow/io/file.h>
+#include <arrow/ipc/writer.h>
+#include <arrow/util/compression.h>
+#include <arrow/util/key_value_metadata.h>
+#include <arrow/util/thread_pool.h>
+#include <parquet/arrow/writer.h>
+#include <parquet/properties.h>
+
+#include <nlohmann/json.hpp>
+
+#include "ArrowWriter.hpp"
+
+namespace pdal
+{
+
+static PluginInfo const s_info
+{
+    "writers.arrow",
+    "Write points to Arrow IPC (Feather) or GeoParquet files.",
+    "http://pdal.io/stages/writers.arrow.html"
+};
+
+CREATE_SHARED_STAGE(ArrowWriter, s_info)
+
+using namespace arrowplugin;
+
+namespace
+{
+
+// Size of a little-endian WKB Point Z: byte order, geometry type and
+// three doubles.
+const int32_t WkbPointSize = 1 + 4 + 3 * 8;
+
+bool compressionType(std::string name, Format format,
+    arrow::Compression::type& type)
+{
+    name = Utils::tolower(name);
+    if (name.empty())
+        name = (format == Format::GeoParquet ? "snappy" : "none");
+
+    if (name == "none")
+        type = arrow::Compression::UNCOMPRESSED;
+    else if (name == "zstd")
+        type = arrow::Compression::ZSTD;
+    else if (name == "lz4")
+        type = (format == Format::GeoParquet ?
+            arrow::Compression::LZ4 : arrow::Compression::LZ4_FRAME);
+    else if (name == "snappy" && format == Format::GeoParquet)
+        type = arrow::Compression::SNAPPY;
+    else if (name == "gzip" && format == Format::GeoParquet)
+        type = arrow::Compression::GZIP;
+    else
+        return false;
+    return true;
+}
+
+// Get a pointer to the storage of a dimension of a column table, or
+// nullptr if the dimension isn't stored as its own type.
+struct ColumnData
+{
+    typedef const uint8_t *result_type;
+
+    BasePointTable& m_table;
+    Dimension::Id m_id;
+
+    ColumnData(BasePointTable& table, Dimension::Id id) :
+        m_table(table), m_id(id)
+    {}
+
+    template<typename T>
+    const uint8_t *operator()(T)
+    {
+        try
+        {
+            return reinterpret_cast<const uint8_t *>(
+                m_table.dimensionData<T>(m_id));
+        }
+        catch (const pdal_error&)
+        {
+            return nullptr;
+        }
+    }
+};
+
+} // unnamed namespace
+
+struct ArrowWriter::Args
+{
+    std::string m_filename;
+    Format m_format;
+    point_count_t m_batchSize;
+    std::string m_compression;
+    arrow::Compression::type m_compressionType;
+    int m_threads;
+    bool m_geometry;
+};
+
+
+ArrowWriter::ArrowWriter() : m_args(new ArrowWriter::Args), m_count(0)
+{}
+
+
+ArrowWriter::~ArrowWriter()
+{}
+
+
+std::string ArrowWriter::getName() const
+{
+    return s_info.name;
+}
+
+
+void ArrowWriter::check(const arrow::Status& status) const
+{
+    if (!status.ok())
+        throwError(status.ToString());
+}
+
+
+template<typename T>
+T ArrowWriter::check(arrow::Result<T> result) const
+{
+    check(result.status());
+    return result.MoveValueUnsafe();
+}
+
+
+void ArrowWriter::addArgs(ProgramArgs& args)
+{
+    args.add("filename", "Output filename", m_args->m_filename).
+        setPositional();
+    args.add("format", "Output format ('feather' or 'geoparquet').  "
+        "Determined from the filename extension if not set",
+        m_args->m_format, Format::Unknown);
+    args.add("batch_size", "Number of points written in each record batch "
+        "or row group", m_args->m_batchSize, point_count_t(65536));
+    args.add("compression", "Compression of column data ('none', 'lz4', "
+        "'zstd' and, for GeoParquet, 'snappy' or 'gzip')",
+        m_args->m_compression);
+    args.add("threads", "Number of threads used to encode columns",
+        m_args->m_threads, 1);
+    args.add("geometry", "Write a WKB point column and GeoParquet metadata",
+        m_args->m_geometry, true);
+}
+
+
+void ArrowWriter::initialize()
+{
+    if (m_args->m_format == Format::Unknown)
+        m_args->m_format = formatFromFilename(m_args->m_filename);
+    if (!compressionType(m_args->m_compression, m_args->m_format,
+            m_args->m_compressionType))
+        throwError("Invalid compression '" + m_args->m_compression +
+            "' for format '" + Utils::toString(m_args->m_format) + "'.");
+    if (m_args->m_batchSize == 0)
+        throwError("Option 'batch_size' must be greater than 0.");
+    // Offsets into the WKB data of a batch are 32-bit.
+    if (m_args->m_batchSize >
+            (point_count_t)(std::numeric_limits<int32_t>::max)() /
+            WkbPointSize)
+        throwError("Option 'batch_size' is too large.");
+    if (m_args->m_threads < 1)
+        throwError("Option 'threads' must be at least 1.");
+    if (m_args->m_format != Format::GeoParquet)
+        m_args->m_geometry = false;
+}
+
+
+void ArrowWriter::ready(PointTableRef table)
+{
+    PointLayoutPtr layout = table.layout();
+
+    arrow::FieldVector fields;
+    m_columns.clear();
+    for (Dimension::Id id : layout->dims())
+    {
+        Dimension::Type type = layout->dimType(id);
+        fields.push_back(arrow::field(layout->dimName(id), arrowType(type),
+            false));
+        m_columns.emplace_back(id, type);
+        m_columns.back().m_buffer.resize(
+            m_args->m_batchSize * Dimension::size(type));
+    }
+    if (m_args->m_geometry)
+    {
+        using namespace Dimension;
+
+        if (!layout->hasDim(Id::X) || !layout->hasDim(Id::Y) ||
+                !layout->hasDim(Id::Z))
+            throwError("Can't write geometry for points without X, Y "
+                "and Z.");
+        fields.push_back(arrow::field(GeometryColumn, arrow::binary(),
+            false));
+        m_wkb.reserve(m_args->m_batchSize * WkbPointSize);
+        m_offsets.reserve(m_args->m_batchSize + 1);
+    }
+    m_offsets.assign(1, 0);
+    m_wkb.clear();
+    m_count = 0;
+    m_bounds.clear();
+
+    m_srs = getSpatialReference();
+    if (m_srs.empty())
+        m_srs = table.anySpatialReference();
+    std::shared_ptr<arrow::KeyValueMetadata> metadata;
+    if (!m_srs.empty())
+        metadata = arrow::key_value_metadata({ SrsMetadataKey },
+            { m_srs.getWKT() });
+    m_schema = arrow::schema(fields, metadata);
+
+    // Arrow encodes columns on its shared CPU thread pool.
+    if (m_args->m_threads > 1)
+        check(arrow::SetCpuThreadPoolCapacity(m_args->m_threads));
+
+    m_file = check(arrow::io::FileOutputStream::Open(m_args->m_filename));
+    if (m_args->m_format == Format::Feather)
+    {
+        arrow::ipc::IpcWriteOptions options =
+            arrow::ipc::IpcWriteOptions::Defaults();
+        options.use_threads = (m_args->m_threads > 1);
+        if (m_args->m_compressionType != arrow::Compression::UNCOMPRESSED)
+            options.codec =
+                check(arrow::util::Codec::Create(m_args->m_compressionType));
+        m_feather = check(arrow::ipc::MakeFileWriter(m_file, m_schema,
+            options));
+    }
+    else
+    {
+        parquet::WriterProperties::Builder builder;
+        builder.compression(m_args->m_compressionType);
+        builder.max_row_group_length(m_args->m_batchSize);
+        builder.enable_statistics();
+
+        parquet::ArrowWriterProperties::Builder arrowBuilder;
+        arrowBuilder.store_schema();
+        arrowBuilder.set_use_threads(m_args->m_threads > 1);
+
+        m_parquet = check(parquet::arrow::FileWriter::Open(*m_schema,
+            arrow::default_memory_pool(), m_file, builder.build(),
+            arrowBuilder.build()));
+    }
+}
+
+
+bool ArrowWriter::processOne(PointRef& point)
+{
+    for (Column& c : m_columns)
+    {
+        char *pos = reinterpret_cast<char *>(c.m_buffer.data()) +
+            m_count * Dimension::size(c.m_type);
+        point.getField(pos, c.m_id, c.m_type);
+    }
+    if (m_args->m_geometry)
+        addGeometry(point.getFieldAs<double>(Dimension::Id::X),
+            point.getFieldAs<double>(Dimension::Id::Y),
+            point.getFieldAs<double>(Dimension::Id::Z));
+    if (++m_count == m_args->m_batchSize)
+        flushBatch();
+    return true;
+}
+
+
+void ArrowWriter::write(const PointViewPtr view)
+{
+    PointRef point(*view, 0);
+    PointId idx = 0;
+    while (idx < view->size())
+    {
+        point_count_t n =
+            (std::min)(m_args->m_batchSize, view->size() - idx);
+        if (m_count == 0 && writeColumns(*view, idx, n))
+        {
+            idx += n;
+            continue;
+        }
+        point.setPointId(idx++);
+        processOne(point);
+    }
+}
+
+
+// Write a batch of points directly from the columns of a column table.
+// This is only possible when the points are consecutive in the table.
+// \return  Whether the points were written.
+bool ArrowWriter::writeColumns(const PointView& view, PointId start,
+    point_count_t n)
+{
+    BasePointTable& table = view.table();
+    if (!table.columnData())
+        return false;
+
+    const PointId base = view.tableIndex(start);
+    for (PointId i = 1; i < n; ++i)
+        if (view.tableIndex(start + i) != base + i)
+            return false;
+
+    arrow::BufferVector buffers;
+    for (Column& c : m_columns)
+    {
+        const uint8_t *data =
+            Dimension::visit(c.m_type, ColumnData(table, c.m_id));
+        if (!data)
+            return false;
+        const size_t size = Dimension::size(c.m_type);
+        buffers.push_back(std::make_shared<arrow::Buffer>(data + base * size,
+            n * size));
+    }
+
+    if (m_args->m_geometry)
+        for (PointId idx = start; idx < start + n; ++idx)
+            addGeometry(view.getFieldAs<double>(Dimension::Id::X, idx),
+                view.getFieldAs<double>(Dimension::Id::Y, idx),
+                view.getFieldAs<double>(Dimension::Id::Z, idx));
+    writeBatch(buffers, n);
+    return true;
+}
+
+
+void ArrowWriter::addGeometry(double x, double y, double z)
+{
+    const uint8_t byteOrder = 1;  // Little-endian
+    const uint32_t pointZ = 1001;
+
+    size_t pos = m_wkb.size();
+    m_wkb.resize(pos + WkbPointSize);
+    uint8_t *p = m_wkb.data() + pos;
+    *p++ = byteOrder;
+    p = std::copy_n((const uint8_t *)&pointZ, sizeof(pointZ), p);
+    for (double d : { x, y, z })
+        p = std::copy_n((const uint8_t *)&d, sizeof(d), p);
+    m_offsets.push_back((int32_t)m_wkb.size());
+    m_bounds.grow(x, y, z);
+}
+
+
+void ArrowWriter::flushBatch()
+{
+    arrow::BufferVector buffers;
+    for (Column& c : m_columns)
+        buffers.push_back(std::make_shared<arrow::Buffer>(c.m_buffer.data(),
+            m_count * Dimension::size(c.m_type)));
+    writeBatch(buffers, m_count);
+    m_count = 0;
+}
+
+
+// The buffers aren't owned by the arrays.  They're only used until the
+// batch has been written.
+void ArrowWriter::writeBatch(const arrow::BufferVector& buffers,
+    point_count_t n)
+{
+    arrow::ArrayVector arrays;
+    for (size_t i = 0; i < buffers.size(); ++i)
+    {
+        std::shared_ptr<arrow::DataType> type =
+            m_schema->field((int)i)->type();
+        arrays.push_back(arrow::MakeArray(
+            arrow::ArrayData::Make(type, n, { nullptr, buffers[i] }, 0)));
+    }
+    if (m_args->m_geometry)
+    {
+        std::shared_ptr<arrow::Buffer> offsets =
+            std::make_shared<arrow::Buffer>(
+                (const uint8_t *)m_offsets.data(),
+                m_offsets.size() * sizeof(int32_t));
+        std::shared_ptr<arrow::Buffer> wkb =
+            std::make_shared<arrow::Buffer>(m_wkb.data(), m_wkb.size());
+        arrays.push_back(arrow::MakeArray(arrow::ArrayData::Make(
+            arrow::binary(), n, { nullptr, offsets, wkb }, 0)));
+    }
+
+    std::shared_ptr<arrow::RecordBatch> batch =
+        arrow::RecordBatch::Make(m_schema, n, arrays);
+    if (m_feather)
+        check(m_feather->WriteRecordBatch(*batch));
+    else
+    {
+        // Each batch is its own row group so that readers can skip
+        // row groups using their statistics.
+        check(m_parquet->NewBufferedRowGroup());
+        check(m_parquet->WriteRecordBatch(*batch));
+    }
+    m_offsets.assign(1, 0);
+    m_wkb.clear();
+}
+
+
+std::string ArrowWriter::geoMetadata() const
+{
+    NL::json column;
+    column["encoding"] = "WKB";
+    column["geometry_types"] = { "Point Z" };
+    if (!m_bounds.empty())
+        column["bbox"] = { m_bounds.minx, m_bounds.miny, m_bounds.minz,
+            m_bounds.maxx, m_bounds.maxy, m_bounds.maxz };
+
+    // A missing CRS means OGC:CRS84 to readers, so an unknown CRS is
+    // written as null.
+    column["crs"] = nullptr;
+    std::string projjson = m_srs.getPROJJSON();
+    if (!projjson.empty())
+        column["crs"] = NL::json::parse(projjson);
+    else if (!m_srs.empty())
+        log()->get(LogLevel::Warning) << getName() << ": Can't convert "
+            "spatial reference to PROJJSON.  CRS of GeoParquet file '" <<
+            m_args->m_filename << "' is unknown." << std::endl;
+
+    NL::json geo;
+    geo["version"] = "1.0.0";
+    geo["primary_column"] = GeometryColumn;
+    geo["columns"][GeometryColumn] = column;
+    return geo.dump();
+}
+
+
+void ArrowWriter::done(PointTableRef table)
+{
+    if (m_count)
+        flushBatch();
+
+    if (m_feather)
+        check(m_feather->Close());
+    else
+    {
+        if (m_args->m_geometry)
+            check(m_parquet->AddKeyValueMetadata(arrow::key_value_metadata(
+                { GeoMetadataKey }, { geoMetadata() })));
+        check(m_parquet->Close());
+    }
+    check(m_file->Close());
+
+    m_feather.reset();
+    m_parquet.reset();
+    m_file.reset();
+    getMetadata().addList("filename", m_args->m_filename);
+}
+
+} // namespace pdal
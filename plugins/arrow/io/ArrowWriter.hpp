@@ -0,0 +1,119 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <pdal/Streamable.hpp>
+#include <pdal/Writer.hpp>
+
+#include "ArrowCommon.hpp"
+
+namespace arrow
+{
+namespace io
+{
+    class FileOutputStream;
+}
+namespace ipc
+{
+    class RecordBatchWriter;
+}
+}
+
+namespace parquet
+{
+namespace arrow
+{
+    class FileWriter;
+}
+}
+
+namespace pdal
+{
+
+class PDAL_DLL ArrowWriter : public Writer, public Streamable
+{
+public:
+    // Values of a dimension for the points of the batch being built.
+    struct Column
+    {
+        Dimension::Id m_id;
+        Dimension::Type m_type;
+        std::vector<uint8_t> m_buffer;
+
+        Column(Dimension::Id id, Dimension::Type type) : m_id(id),
+            m_type(type)
+        {}
+    };
+
+    ArrowWriter();
+    ~ArrowWriter();
+    std::string getName() const;
+
+private:
+    virtual void addArgs(ProgramArgs& args);
+    virtual void initialize();
+    virtual void ready(PointTableRef table);
+    virtual bool processOne(PointRef& point);
+    virtual void write(const PointViewPtr view);
+    virtual void done(PointTableRef table);
+
+    bool writeColumns(const PointView& view, PointId start, point_count_t n);
+    void addGeometry(double x, double y, double z);
+    void flushBatch();
+    void writeBatch(const arrow::BufferVector& buffers, point_count_t n);
+    std::string geoMetadata() const;
+    void check(const arrow::Status& status) const;
+    template<typename T>
+    T check(arrow::Result<T> result) const;
+
+    struct Args;
+    std::unique_ptr<Args> m_args;
+
+    SpatialReference m_srs;
+    std::shared_ptr<arrow::Schema> m_schema;
+    std::vector<Column> m_columns;
+    std::vector<uint8_t> m_wkb;
+    std::vector<int32_t> m_offsets;
+    point_count_t m_count;  // Number of points in the batch being built.
+    BOX3D m_bounds;
+    std::shared_ptr<arrow::io::FileOutputStream> m_file;
+    std::shared_ptr<arrow::ipc::RecordBatchWriter> m_feather;
+    std::unique_ptr<parquet::arrow::FileWriter> m_parquet;
+
+    ArrowWriter(const ArrowWriter&) = delete;
+    ArrowWriter& operator=(const ArrowWriter&) = delete;
+};
+
+} // namespace pdal
@@ -0,0 +1,227 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <io/FauxReader.hpp>
+#include <pdal/PointView.hpp>
+#include <pdal/StageFactory.hpp>
+
+#include "Support.hpp"
+#include "../io/ArrowReader.hpp"
+#include "../io/ArrowWriter.hpp"
+
+namespace pdal
+{
+
+namespace
+{
+
+const point_count_t NumPoints = 1000;
+
+// Write ramp points with X, Y and Z from 0 to 999.
+void writeFile(const std::string& filename, BasePointTable& table,
+    Options writerOps = Options())
+{
+    Options readerOps;
+    readerOps.add("mode", "ramp");
+    readerOps.add("count", NumPoints);
+    readerOps.add("bounds", "([0, 999], [0, 999], [0, 999])");
+    readerOps.add("number_of_returns", 3);
+    readerOps.add("override_srs", "EPSG:26910");
+
+    FauxReader reader;
+    reader.setOptions(readerOps);
+
+    writerOps.add("filename", filename);
+    writerOps.add("batch_size", 300);
+
+    ArrowWriter writer;
+    writer.setOptions(writerOps);
+    writer.setInput(reader);
+
+    writer.prepare(table);
+    writer.execute(table);
+}
+
+PointViewPtr readFile(const std::string& filename,
+    Options readerOps = Options())
+{
+    readerOps.add("filename", filename);
+
+    ArrowReader reader;
+    reader.setOptions(readerOps);
+
+    PointTable table;
+    reader.prepare(table);
+    PointViewSet s = reader.execute(table);
+    EXPECT_FALSE(reader.getSpatialReference().empty());
+    return *s.begin();
+}
+
+void checkPoints(const PointView& v)
+{
+    using namespace Dimension;
+
+    ASSERT_EQ(v.size(), NumPoints);
+    for (PointId i = 0; i < v.size(); ++i)
+    {
+        EXPECT_EQ(v.getFieldAs<double>(Id::X, i), (double)i);
+        EXPECT_EQ(v.getFieldAs<double>(Id::Y, i), (double)i);
+        EXPECT_EQ(v.getFieldAs<double>(Id::Z, i), (double)i);
+        EXPECT_EQ(v.getFieldAs<int>(Id::ReturnNumber, i), (int)(i % 3) + 1);
+        EXPECT_EQ(v.getFieldAs<int>(Id::NumberOfReturns, i), 3);
+    }
+}
+
+} // unnamed namespace
+
+TEST(ArrowTest, findStage)
+{
+    StageFactory factory;
+
+    Stage *reader(factory.createStage("readers.arrow"));
+    ASSERT_TRUE(reader);
+    EXPECT_TRUE(reader->pipelineStreamable());
+
+    Stage *writer(factory.createStage("writers.arrow"));
+    ASSERT_TRUE(writer);
+    EXPECT_TRUE(writer->pipelineStreamable());
+}
+
+TEST(ArrowTest, roundTrip)
+{
+    for (std::string ext : { ".feather", ".parquet" })
+    {
+        std::string filename = Support::temppath("arrow" + ext);
+        FileUtils::deleteFile(filename);
+
+        PointTable table;
+        writeFile(filename, table);
+        checkPoints(*readFile(filename));
+    }
+}
+
+// Points written from a stream table and from a column table, whose
+// columns are written without copying them, are the same.
+TEST(ArrowTest, tables)
+{
+    for (std::string ext : { ".feather", ".parquet" })
+    {
+        std::string filename = Support::temppath("arrow" + ext);
+
+        FileUtils::deleteFile(filename);
+        FixedPointTable streamTable(128);
+        writeFile(filename, streamTable);
+        checkPoints(*readFile(filename));
+
+        FileUtils::deleteFile(filename);
+        ColumnPointTable columnTable;
+        writeFile(filename, columnTable);
+        checkPoints(*readFile(filename));
+    }
+}
+
+TEST(ArrowTest, compression)
+{
+    Options ops;
+    ops.add("compression", "zstd");
+    ops.add("threads", 2);
+
+    std::string filename = Support::temppath("arrow.parquet");
+    FileUtils::deleteFile(filename);
+    PointTable table;
+    writeFile(filename, table, ops);
+    checkPoints(*readFile(filename));
+
+    Options bad;
+    bad.add("compression", "snappy");
+    filename = Support::temppath("arrow.feather");
+    PointTable badTable;
+    EXPECT_THROW(writeFile(filename, badTable, bad), pdal_error);
+}
+
+TEST(ArrowTest, projection)
+{
+    using namespace Dimension;
+
+    std::string filename = Support::temppath("arrow.parquet");
+    FileUtils::deleteFile(filename);
+    PointTable table;
+    writeFile(filename, table);
+
+    Options ops;
+    ops.add("dimensions", "X, ReturnNumber");
+    PointViewPtr v = readFile(filename, ops);
+    ASSERT_EQ(v->size(), NumPoints);
+    EXPECT_TRUE(v->hasDim(Id::X));
+    EXPECT_TRUE(v->hasDim(Id::ReturnNumber));
+    EXPECT_FALSE(v->hasDim(Id::Y));
+    EXPECT_FALSE(v->hasDim(Id::NumberOfReturns));
+    EXPECT_EQ(v->getFieldAs<double>(Id::X, 10), 10.0);
+
+    // The geometry column isn't a dimension.
+    Options geom;
+    geom.add("dimensions", "geometry");
+    EXPECT_THROW(readFile(filename, geom), pdal_error);
+}
+
+// Row groups (or record batches) of 300 points are skipped or read, and
+// the points of the row groups that are read are filtered.
+TEST(ArrowTest, bounds)
+{
+    using namespace Dimension;
+
+    for (std::string ext : { ".feather", ".parquet" })
+    {
+        std::string filename = Support::temppath("arrow" + ext);
+        FileUtils::deleteFile(filename);
+        PointTable table;
+        writeFile(filename, table);
+
+        Options ops;
+        ops.add("bounds", "([350, 649.5], [0, 1000])");
+        PointViewPtr v = readFile(filename, ops);
+        ASSERT_EQ(v->size(), 300u);
+        EXPECT_EQ(v->getFieldAs<double>(Id::X, 0), 350.0);
+        EXPECT_EQ(v->getFieldAs<double>(Id::X, 299), 649.0);
+
+        Options ops3d;
+        ops3d.add("dimensions", "ReturnNumber");
+        ops3d.add("bounds", "([0, 1000], [0, 1000], [2000, 3000])");
+        EXPECT_EQ(readFile(filename, ops3d)->size(), 0u);
+    }
+}
+
+} // namespace pdal
@@ -38,10 +38,65 @@
 #include <filters/CpdFilter.hpp>
 #include <pdal/EigenUtils.hpp>
 
+#include <array>
+#include <cmath>
+#include <numeric>
+#include <unordered_set>
+
 namespace pdal
 {
 namespace
 {
+struct VoxelHash
+{
+    size_t operator()(const std::array<int64_t, 3>& v) const
+    {
+        return (size_t)((uint64_t)v[0] * 0x9E3779B97F4A7C15ULL ^
+            (uint64_t)v[1] * 0xC2B2AE3D27D4EB4FULL ^
+            (uint64_t)v[2] * 0x165667B19E3779F9ULL);
+    }
+};
+
+// Make a matrix of the first point of a view in each voxel.  A voxel size
+// of 0 keeps all points.
+cpd::Matrix sample(const PointView& view, double voxelSize)
+{
+    if (voxelSize <= 0)
+        return pointViewToEigen(view);
+
+    std::unordered_set<std::array<int64_t, 3>, VoxelHash> voxels;
+    PointIdList ids;
+    for (PointId i = 0; i < view.size(); ++i)
+    {
+        std::array<int64_t, 3> voxel {
+            (int64_t)std::floor(
+                view.getFieldAs<double>(Dimension::Id::X, i) / voxelSize),
+            (int64_t)std::floor(
+                view.getFieldAs<double>(Dimension::Id::Y, i) / voxelSize),
+            (int64_t)std::floor(
+                view.getFieldAs<double>(Dimension::Id::Z, i) / voxelSize) };
+        if (voxels.insert(voxel).second)
+            ids.push_back(i);
+    }
+    return pointViewToEigen(view, ids);
+}
+
+// Apply a homogeneous transformation matrix to all points of a view.
+void transformPoints(PointViewPtr moving, const cpd::Matrix& matrix)
+{
+    for (PointId i = 0; i < moving->size(); ++i)
+    {
+        Eigen::Vector3d p(moving->getFieldAs<double>(Dimension::Id::X, i),
+                          moving->getFieldAs<double>(Dimension::Id::Y, i),
+                          moving->getFieldAs<double>(Dimension::Id::Z, i));
+        Eigen::Vector3d q = matrix.topLeftCorner(3, 3) * p +
+                            matrix.topRightCorner(3, 1);
+        moving->setField(Dimension::Id::X, i, q(0));
+        moving->setField(Dimension::Id::Y, i, q(1));
+        moving->setField(Dimension::Id::Z, i, q(2));
+    }
+}
+
 void movePoints(PointViewPtr moving, const cpd::Matrix& result)
 {
     assert(moving->size() == (point_count_t)result.rows());
@@ -80,6 +135,21 @@ void CpdFilter::addArgs(ProgramArgs& args)
 {
     args.add("method", "CPD method (rigid, nonrigid, or affine)", m_method,
              "rigid");
+    args.add("voxel_size", "Register the first point in each voxel of this "
+             "size (0 = all points)", m_voxelSize, 0.0);
+    m_maxIterationsArg = &args.add("max_iterations",
+        "Maximum number of iterations", m_maxIterations);
+    m_toleranceArg = &args.add("tolerance",
+        "Change in the objective at which to stop iterating", m_tolerance);
+}
+
+template <typename T>
+void CpdFilter::configure(T& transform) const
+{
+    if (m_maxIterationsArg->set())
+        transform.max_iterations(m_maxIterations);
+    if (m_toleranceArg->set())
+        transform.tolerance(m_tolerance);
 }
 
 std::string CpdFilter::defaultMethod()
@@ -149,10 +219,14 @@ PointViewPtr CpdFilter::change(PointViewPtr fixed, PointViewPtr moving)
 
 void CpdFilter::cpd_rigid(PointViewPtr fixed, PointViewPtr moving)
 {
-    cpd::Matrix fixedMatrix = pointViewToEigen(*fixed);
-    cpd::Matrix movingMatrix = pointViewToEigen(*moving);
-    cpd::RigidResult result = cpd::rigid(fixedMatrix, movingMatrix);
-    movePoints(moving, result.points);
+    cpd::Rigid rigid;
+    configure(rigid);
+    cpd::RigidResult result = rigid.run(sample(*fixed, m_voxelSize),
+                                        sample(*moving, m_voxelSize));
+    if (m_voxelSize > 0)
+        transformPoints(moving, result.matrix());
+    else
+        movePoints(moving, result.points);
     addMetadata(this, static_cast<cpd::Result>(result));
     MetadataNode root = getMetadata();
     root.add("transform", result.matrix());
@@ -160,19 +234,29 @@ void CpdFilter::cpd_rigid(PointViewPtr fixed, PointViewPtr moving)
 
 void CpdFilter::cpd_affine(PointViewPtr fixed, PointViewPtr moving)
 {
-    cpd::Matrix fixedMatrix = pointViewToEigen(*fixed);
-    cpd::Matrix movingMatrix = pointViewToEigen(*moving);
-    cpd::AffineResult result = cpd::affine(fixedMatrix, movingMatrix);
-    movePoints(moving, result.points);
+    cpd::Affine affine;
+    configure(affine);
+    cpd::AffineResult result = affine.run(sample(*fixed, m_voxelSize),
+                                          sample(*moving, m_voxelSize));
+    if (m_voxelSize > 0)
+        transformPoints(moving, result.matrix());
+    else
+        movePoints(moving, result.points);
     MetadataNode root = getMetadata();
     root.add("transform", result.matrix());
 }
 
 void CpdFilter::cpd_nonrigid(PointViewPtr fixed, PointViewPtr moving)
 {
-    cpd::Matrix fixedMatrix = pointViewToEigen(*fixed);
-    cpd::Matrix movingMatrix = pointViewToEigen(*moving);
-    cpd::NonrigidResult result = cpd::nonrigid(fixedMatrix, movingMatrix);
+    // A nonrigid result only moves the points it was computed from.
+    if (m_voxelSize > 0)
+        throw pdal_error(
+            "filters.cpd option 'voxel_size' can't be used with the "
+            "nonrigid method");
+    cpd::Nonrigid nonrigid;
+    configure(nonrigid);
+    cpd::NonrigidResult result =
+        nonrigid.run(pointViewToEigen(*fixed), pointViewToEigen(*moving));
     movePoints(moving, result.points);
 }
 }
@@ -35,6 +35,7 @@
 #pragma once
 
 #include <pdal/Filter.hpp>
+#include <pdal/util/ProgramArgs.hpp>
 
 namespace pdal
 {
@@ -44,7 +45,8 @@ class PDAL_DLL CpdFilter : public Filter
   public:
     static std::string defaultMethod();
 
-    CpdFilter() : Filter(), m_fixed(nullptr), m_method(""), m_complete(false)
+    CpdFilter() : Filter(), m_fixed(nullptr), m_method(""), m_complete(false),
+        m_maxIterationsArg(nullptr), m_toleranceArg(nullptr)
     {
     }
     std::string getName() const;
@@ -59,10 +61,17 @@ class PDAL_DLL CpdFilter : public Filter
     void cpd_rigid(PointViewPtr fixed, PointViewPtr moving);
     void cpd_affine(PointViewPtr fixed, PointViewPtr moving);
     void cpd_nonrigid(PointViewPtr fixed, PointViewPtr moving);
+    template <typename T>
+    void configure(T& transform) const;
 
     PointViewPtr m_fixed;
     std::string m_method;
     bool m_complete;
+    double m_voxelSize;
+    size_t m_maxIterations;
+    double m_tolerance;
+    Arg *m_maxIterationsArg;
+    Arg *m_toleranceArg;
 
     CpdFilter& operator=(const CpdFilter&); // not implemented
     CpdFilter(const CpdFilter&);            // not implemented
@@ -159,6 +159,59 @@ TEST(CpdFilterTest, RecoverTranslation)
     checkPointsEqualReader(pointViewSet, tolerance);
 }
 
+TEST(CpdFilterTest, RecoverTranslationVoxelSize)
+{
+    auto reader1 = newReader();
+    auto reader2 = newReader();
+    TransformationFilter transformationFilter;
+    Options transformationOptions;
+    transformationOptions.add("matrix", "1 0 0 1\n0 1 0 2\n0 0 1 3\n0 0 0 1");
+    transformationFilter.setOptions(transformationOptions);
+    transformationFilter.setInput(*reader2);
+
+    // The points are sparse enough that each is in its own voxel, but the
+    // transformation is applied to the moving points rather than taken
+    // from the registered sample.
+    auto filter = newFilter();
+    Options options;
+    options.add("voxel_size", 0.01);
+    options.add("max_iterations", 200);
+    filter->setOptions(options);
+    filter->setInput(*reader1);
+    filter->setInput(transformationFilter);
+
+    PointTable table;
+    filter->prepare(table);
+    PointViewSet pointViewSet = filter->execute(table);
+
+    MetadataNode root = filter->getMetadata();
+    Eigen::MatrixXd transform =
+        root.findChild("transform").value<Eigen::MatrixXd>();
+    double tolerance = 1e-4;
+    EXPECT_NEAR(-1.0, transform(0, 3), tolerance);
+    EXPECT_NEAR(-2.0, transform(1, 3), tolerance);
+    EXPECT_NEAR(-3.0, transform(2, 3), tolerance);
+    checkPointsEqualReader(pointViewSet, tolerance);
+}
+
+TEST(CpdFilterTest, NonrigidVoxelSize)
+{
+    auto reader1 = newReader();
+    auto reader2 = newReader();
+    auto filter = newFilter();
+    filter->setInput(*reader1);
+    filter->setInput(*reader2);
+
+    Options options;
+    options.add("method", "nonrigid");
+    options.add("voxel_size", 1.0);
+    filter->setOptions(options);
+
+    PointTable table;
+    filter->prepare(table);
+    ASSERT_THROW(filter->execute(table), pdal_error);
+}
+
 TEST(CpdFilterTest, TooFewInputs)
 {
     auto reader = newReader();
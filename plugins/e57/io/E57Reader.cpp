@@ -37,6 +37,9 @@
 #include "arbiter/arbiter.hpp"
 #include <pdal/util/Algorithm.hpp>
 
+#include <mutex>
+#include <thread>
+
 namespace pdal
 {
 using namespace e57;
@@ -54,8 +57,102 @@ std::string E57Reader::getName() const
     return s_info.name;
 }
 
+E57Reader::ScanReader::ScanReader(e57::ImageFile& imf,
+                                  const e57::StructureNode& scanNode,
+                                  e57plugin::ExtraDims& extraDims,
+                                  point_count_t chunkSize)
+    : m_scan(scanNode), m_x(nullptr), m_y(nullptr), m_z(nullptr)
+{
+    StructureNode prototype(m_scan.getPointPrototype());
+    std::vector<std::string> names;
+
+    // Initialize for supported dimensions.
+    for (auto& dimension : e57plugin::supportedE57Types())
+        if (prototype.isDefined(dimension))
+            names.push_back(dimension);
+
+    // Initialize for extra dimensions.
+    for (auto i = extraDims.begin(); i != extraDims.end(); ++i)
+        if (prototype.isDefined(i->m_name) && !Utils::contains(names, i->m_name))
+            names.push_back(i->m_name);
+
+    // Columns are sized before linking them to destination buffers so that
+    // their data doesn't move.
+    m_columns.resize(names.size());
+    for (size_t i = 0; i < names.size(); ++i)
+    {
+        Column& c = m_columns[i];
+        c.m_id = e57plugin::e57ToPdal(names[i]);
+        c.m_scale = 1.0;
+        if (c.m_id != Dimension::Id::Unknown)
+            c.m_scale = m_scan.rescaleFactor(c.m_id);
+        else
+        {
+            auto dim = extraDims.findDim(names[i]);
+            if (dim != extraDims.end())
+                c.m_id = dim->m_id;
+        }
+        c.m_data.resize(chunkSize);
+
+        if (c.m_id == Dimension::Id::X)
+            m_x = c.m_data.data();
+        else if (c.m_id == Dimension::Id::Y)
+            m_y = c.m_data.data();
+        else if (c.m_id == Dimension::Id::Z)
+            m_z = c.m_data.data();
+
+        m_destBuffers.emplace_back(imf, names[i], c.m_data.data(),
+            chunkSize, true,
+            (prototype.get(names[i]).type() == e57::E57_SCALED_INTEGER));
+    }
+    m_reader.reset(new CompressedVectorReader(
+        m_scan.getPoints().reader(m_destBuffers)));
+}
+
+E57Reader::ScanReader::~ScanReader()
+{
+    try
+    {
+        if (m_reader)
+            m_reader->close();
+    }
+    catch (...)
+    {}
+}
+
+point_count_t E57Reader::ScanReader::read()
+{
+    point_count_t count = m_reader->read(m_destBuffers);
+
+    // Rescale and transform a column at a time rather than a point at
+    // a time.
+    for (Column& c : m_columns)
+        if (c.m_scale != 1.0)
+        {
+            double *d = c.m_data.data();
+            for (point_count_t i = 0; i < count; ++i)
+                d[i] *= c.m_scale;
+        }
+    if (m_scan.hasPose() && m_x && m_y && m_z)
+        m_scan.transformPoints(m_x, m_y, m_z, count);
+    return count;
+}
+
+void E57Reader::ScanReader::fillPoint(PointRef& point,
+                                      point_count_t idx) const
+{
+    for (const Column& c : m_columns)
+        if (c.m_id != Dimension::Id::Unknown)
+            point.setField(c.m_id, c.m_data[idx]);
+}
+
+
 E57Reader::E57Reader()
-    : Reader(), Streamable()
+    : Reader(), Streamable(), m_chunkSize(100000), m_threads(1)
+{
+}
+
+E57Reader::~E57Reader()
 {
 }
 
@@ -63,44 +160,23 @@ void E57Reader::addArgs(ProgramArgs& args)
 {
     args.add("extra_dims", "Extra dimensions to read from E57 point cloud.",
              m_extraDimsSpec);
+    args.add("chunk_size", "Number of points read from a scan at once.",
+             m_chunkSize, (point_count_t)100000);
+    args.add("threads", "Number of scans read at once.", m_threads, 1);
 }
 
-void E57Reader::initializeBuffers()
+e57::ImageFile *E57Reader::openFile(const std::string& filename)
 {
-    m_doubleBuffers.clear();
-    m_destBuffers.clear();
-    m_e57PointPrototype.reset(new StructureNode(m_scan->getPointPrototype()));
+    std::unique_ptr<ImageFile> imf(new ImageFile(filename, "r"));
 
-    // Initialize for supported dimensions.
-    auto supportedFields = e57plugin::supportedE57Types();
-    for (auto& dimension : supportedFields)
-    {
-        if (m_e57PointPrototype->isDefined(dimension))
-        {
-            m_doubleBuffers[dimension] =
-                std::vector<double>(m_defaultChunkSize, 0);
-        }
-    }
+    const e57::ustring normalsExtension(
+        "http://www.libe57.org/E57_NOR_surface_normals.txt");
+    e57::ustring _normalsExtension;
 
-    // Initialize for extra dimensions.
-    for (auto i = m_extraDims->begin(); i != m_extraDims->end(); ++i)
-    {
-        if (m_e57PointPrototype->isDefined(i->m_name))
-        {
-            m_doubleBuffers[i->m_name] =
-                std::vector<double>(m_defaultChunkSize, 0);
-        }
-    }
-
-    // Link to destination buffers.
-    for (auto& keyValue : m_doubleBuffers)
-    {
-        m_destBuffers.emplace_back(
-            *m_imf, keyValue.first, keyValue.second.data(), m_defaultChunkSize,
-            true,
-            (m_e57PointPrototype->get(keyValue.first).type() ==
-             e57::E57_SCALED_INTEGER));
-    }
+    // the extension may already be registered
+    if (!imf->extensionsLookupPrefix("nor", _normalsExtension))
+        imf->extensionsAdd("nor", normalsExtension);
+    return imf.release();
 }
 
 void E57Reader::addDimensions(PointLayoutPtr layout)
@@ -165,11 +241,18 @@ void E57Reader::addDimensions(PointLayoutPtr layout)
 
 void E57Reader::initialize()
 {
+    if (m_threads < 1)
+        throwError("Option 'threads' must be at least 1.");
+    if (m_chunkSize < 1)
+        throwError("Option 'chunk_size' must be at least 1.");
+
     try
     {
+        // The local handle is kept so that threads can open the file.
         arbiter::Arbiter arb;
-        arbiter::LocalHandle fileHandle = arb.getLocalHandle(m_filename);
-        m_imf.reset(new ImageFile(fileHandle.localPath(), "r"));
+        m_fileHandle.reset(
+            new arbiter::LocalHandle(arb.getLocalHandle(m_filename)));
+        m_imf.reset(openFile(m_fileHandle->localPath()));
         StructureNode root = m_imf->root();
 
         if (!root.isDefined("/data3D"))
@@ -177,14 +260,6 @@ void E57Reader::initialize()
             throwError("File doesn't contain 3D data");
         }
 
-        const e57::ustring normalsExtension(
-            "http://www.libe57.org/E57_NOR_surface_normals.txt");
-        e57::ustring _normalsExtension;
-
-        // the extension may already be registered
-        if (!m_imf->extensionsLookupPrefix("nor", _normalsExtension))
-            m_imf->extensionsAdd("nor", normalsExtension);
-
         m_data3D.reset(new VectorNode(root.get("/data3D")));
 
     }
@@ -204,9 +279,24 @@ void E57Reader::ready(PointTableRef& ref)
     
     m_currentIndex = 0;
     m_pointsInCurrentBatch = 0;
-    m_defaultChunkSize = 10000;
     m_currentScan = -1;
-    
+    m_scanReader.reset();
+
+    // E57 files can't be shared between threads, so each thread after the
+    // first reads scans through its own copy of the file.  Files are
+    // opened here because opening a file isn't thread safe.
+    m_threadFiles.clear();
+    int threads = (int)(std::min)((int64_t)m_threads, m_data3D->childCount());
+    try
+    {
+        for (int i = 1; i < threads; ++i)
+            m_threadFiles.emplace_back(openFile(m_fileHandle->localPath()));
+    }
+    catch (E57Exception& e)
+    {
+        throwError(std::to_string(e.errorCode()) + " : " + e.context());
+    }
+
     // Initial reader setup.
     setupReader();
 }
@@ -237,16 +327,17 @@ QuickInfo E57Reader::inspect()
 /// Setup reader to read next scan if available.
 void E57Reader::setupReader()
 {
+    m_scanReader.reset();
+
     // Are we done with reading all scans?
     if (++m_currentScan >= m_data3D->childCount())
         return;
 
     try
     {
-        m_scan.reset(new Scan((StructureNode)m_data3D->get(m_currentScan)));
-        initializeBuffers();
-        m_reader.reset(new CompressedVectorReader(
-                           m_scan->getPoints().reader(m_destBuffers)));
+        m_scanReader.reset(new ScanReader(*m_imf,
+            (StructureNode)m_data3D->get(m_currentScan), *m_extraDims,
+            m_chunkSize));
     }
     catch (E57Exception& e)
     {
@@ -258,7 +349,7 @@ void E57Reader::setupReader()
     }
 }
 
-/// Read the next batch of m_defaultChunkSize.
+/// Read the next batch of m_chunkSize.
 /// This returns number of points aquired.
 /// Returns 0 after finished reading of all scans.
 point_count_t E57Reader::readNextBatch()
@@ -266,21 +357,17 @@ point_count_t E57Reader::readNextBatch()
     m_currentIndex = 0;
 
     // Are we done with reading all scans?
-    if (m_currentScan >= m_data3D->childCount())
-        return 0;
-
-    point_count_t gotPoints = m_reader->read(m_destBuffers);
-
-    if (!gotPoints)
+    while (m_scanReader)
     {
+        point_count_t gotPoints = m_scanReader->read();
+        if (gotPoints)
+            return gotPoints;
+
         // Finished reading all points in current scan.
         // Its time to setup reader at next scan.
-        m_reader->close();
         setupReader();
-        return readNextBatch();
     }
-
-    return gotPoints;
+    return 0;
 }
 
 /// Fill the point information.
@@ -299,42 +386,118 @@ bool E57Reader::fillPoint(PointRef& point)
         return false;
     }
 
-    for (auto& keyValue : m_doubleBuffers)
+    m_scanReader->fillPoint(point, m_currentIndex);
+    ++m_currentIndex;
+    return true;
+}
+
+/// Read whole scans on several threads, each into its own range of points
+/// of the view, starting at 'start'.  The points must already exist.
+void E57Reader::readScans(PointView& view, PointId start)
+{
+    std::vector<e57::ImageFile *> files { m_imf.get() };
+    for (auto& f : m_threadFiles)
+        files.push_back(f.get());
+
+    const int64_t numScans = m_data3D->childCount();
+    std::vector<PointId> offsets;
+    for (int64_t i = 0; i < numScans; ++i)
     {
-        auto dim = e57plugin::e57ToPdal(keyValue.first);
+        offsets.push_back(start);
+        Scan scan((StructureNode)m_data3D->get(i));
+        start += scan.getNumPoints();
+    }
 
-        if (dim != Dimension::Id::Unknown)
-        {
-            point.setField(dim, m_scan->rescale(dim, keyValue.second[m_currentIndex]));
-        }
-        else
+    std::mutex mutex;
+    int64_t nextScan = 0;
+    std::string error;
+    auto readFn = [&](e57::ImageFile *imf)
+    {
+        try
         {
-            auto dim = m_extraDims->findDim(keyValue.first);
-            if (dim != m_extraDims->end())
+            VectorNode data3D(imf->root().get("/data3D"));
+            while (true)
             {
-                point.setField(dim->m_id, keyValue.second[m_currentIndex]);
+                int64_t scanNum;
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (nextScan == numScans || error.size())
+                        return;
+                    scanNum = nextScan++;
+                }
+
+                ScanReader reader(*imf, (StructureNode)data3D.get(scanNum),
+                    *m_extraDims, m_chunkSize);
+                PointId idx = offsets[scanNum];
+                PointRef point(view, idx);
+                point_count_t count;
+                point_count_t total = 0;
+                while ((count = reader.read()))
+                {
+                    total += count;
+                    if (total > reader.numPoints())
+                        throw pdal_error("Scan " + std::to_string(scanNum) +
+                            " has more points than its header notes.");
+                    for (point_count_t i = 0; i < count; ++i)
+                    {
+                        point.setPointId(idx++);
+                        reader.fillPoint(point, i);
+                    }
+                }
             }
         }
-    }
-
-    if (m_scan->hasPose())
-        m_scan->transformPoint(point);
-
-    ++m_currentIndex;
-    return true;
+        catch (E57Exception& e)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            error = std::to_string(e.errorCode()) + " : " + e.context();
+        }
+        catch (std::exception& e)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            error = e.what();
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (e57::ImageFile *imf : files)
+        pool.emplace_back(readFn, imf);
+    for (std::thread& t : pool)
+        t.join();
+    if (error.size())
+        throwError(error);
 }
 
 point_count_t E57Reader::read(PointViewPtr view, point_count_t count)
 {
     point_count_t numPoints = e57plugin::numPoints(*m_data3D);
-    for (PointId counter = 0, nextId = view->size(); counter < numPoints;
-            ++counter, ++nextId)
+
+    // Scans are read in parallel into points added beforehand, so that
+    // threads never add points to the table.
+    if (m_threadFiles.size() && count >= numPoints && m_currentScan == 0 &&
+        m_currentIndex == 0 && m_pointsInCurrentBatch == 0)
     {
-        PointRef point(view->point(nextId));
-        fillPoint(point);
+        m_scanReader.reset();
+        PointId start = view->size();
+        PointRef point(*view, start);
+        for (PointId idx = start; idx < start + numPoints; ++idx)
+        {
+            point.setPointId(idx);
+            point.setField(Dimension::Id::X, 0.0);
+        }
+        readScans(*view, start);
+        m_currentScan = (int)m_data3D->childCount();
+        return numPoints;
     }
 
-    return view->size();
+    PointId nextId = view->size();
+    point_count_t counter = 0;
+    for (; counter < count; ++counter, ++nextId)
+    {
+        PointRef point(view->point(nextId));
+        if (!fillPoint(point))
+            break;
+    }
+    return counter;
 }
 
 bool E57Reader::processOne(PointRef& point)
@@ -344,6 +507,10 @@ bool E57Reader::processOne(PointRef& point)
 
 void E57Reader::done(PointTableRef table)
 {
+    m_scanReader.reset();
+    for (auto& f : m_threadFiles)
+        f->close();
+    m_threadFiles.clear();
     m_imf->close();
 }
 
@@ -41,10 +41,55 @@
 
 namespace pdal
 {
+namespace arbiter
+{
+    class LocalHandle;
+}
+
 class PDAL_DLL E57Reader : public Reader, public Streamable
 {
+    /// Reads the points of a scan a chunk at a time, rescaled and with the
+    /// scan's pose applied.
+    class PDAL_DLL ScanReader
+    {
+    public:
+        ScanReader(e57::ImageFile& imf, const e57::StructureNode& scanNode,
+                   e57plugin::ExtraDims& extraDims,
+                   point_count_t chunkSize);
+        ~ScanReader();
+
+        point_count_t numPoints() const
+        {
+            return m_scan.getNumPoints();
+        }
+
+        /// Read the next chunk of points.  Returns 0 when all points have
+        /// been read.
+        point_count_t read();
+
+        /// Set the fields of a point from point 'idx' of the current chunk.
+        void fillPoint(PointRef& point, point_count_t idx) const;
+
+    private:
+        struct Column
+        {
+            Dimension::Id m_id;
+            double m_scale;
+            std::vector<double> m_data;
+        };
+
+        e57::Scan m_scan;
+        std::vector<Column> m_columns;
+        std::vector<e57::SourceDestBuffer> m_destBuffers;
+        std::unique_ptr<e57::CompressedVectorReader> m_reader;
+        double *m_x;
+        double *m_y;
+        double *m_z;
+    };
+
 public:
     E57Reader();
+    ~E57Reader();
     std::string getName() const override;
 
 private:
@@ -62,20 +107,21 @@ private:
     bool fillPoint(PointRef& point);
     point_count_t readNextBatch();
     void setupReader();
-    void initializeBuffers();
+    e57::ImageFile *openFile(const std::string& filename);
+    void readScans(PointView& view, PointId start);
 
+    std::unique_ptr<arbiter::LocalHandle> m_fileHandle;
     std::unique_ptr<e57::ImageFile> m_imf;
     std::unique_ptr<e57::VectorNode> m_data3D;
-    std::unique_ptr<e57::CompressedVectorReader> m_reader;
-    std::unique_ptr<e57::StructureNode> m_e57PointPrototype;
-    std::shared_ptr<e57::Scan> m_scan;
+    std::unique_ptr<ScanReader> m_scanReader;
 
-    std::map<std::string, std::vector<double>> m_doubleBuffers;
-    std::vector<e57::SourceDestBuffer> m_destBuffers;
+    // Files opened for threads other than the first.
+    std::vector<std::unique_ptr<e57::ImageFile>> m_threadFiles;
 
     point_count_t m_currentIndex;
     point_count_t m_pointsInCurrentBatch;
-    point_count_t m_defaultChunkSize;
+    point_count_t m_chunkSize;
+    int m_threads;
     signed int m_currentScan;
 
     pdal::StringList m_extraDimsSpec;
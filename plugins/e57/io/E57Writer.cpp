@@ -52,18 +52,41 @@ CREATE_SHARED_STAGE(E57Writer, s_info)
 
 E57Writer::ChunkWriter::ChunkWriter
 (const std::vector<std::string>& dimensionsToWrite,
- e57::CompressedVectorNode& vectorNode)
+ e57::CompressedVectorNode& vectorNode, e57plugin::ExtraDims& extraDims)
     : m_defaultChunkSize(1 << 20), m_currentIndex(0), m_colorLimit(256),
       m_intensityLimit(1)
 {
-    // Initialise the write buffers
+    using DimId = pdal::Dimension::Id;
+
+    // Initialise the write buffers.  The PDAL dimension of each is looked
+    // up once here rather than for every point.
+    std::vector<std::string> names;
     for (auto& e57dim: dimensionsToWrite)
-        if (!e57dim.empty())
-            m_doubleBuffers[e57dim].resize(m_defaultChunkSize);
+        if (!e57dim.empty() && !Utils::contains(names, e57dim))
+            names.push_back(e57dim);
 
-    for (auto& keyValue : m_doubleBuffers)
-        m_e57buffers.emplace_back(vectorNode.destImageFile(), keyValue.first,
-                                  keyValue.second.data(), m_defaultChunkSize, true, true);
+    m_columns.resize(names.size());
+    for (size_t i = 0; i < names.size(); ++i)
+    {
+        Column& c = m_columns[i];
+        c.m_id = pdal::e57plugin::e57ToPdal(names[i]);
+        c.m_color = (c.m_id == DimId::Red || c.m_id == DimId::Green ||
+            c.m_id == DimId::Blue);
+        c.m_intensity = (c.m_id == DimId::Intensity);
+        c.m_extraDim = nullptr;
+        if (c.m_id == DimId::Unknown)
+        {
+            auto dim = extraDims.findDim(names[i]);
+            if (dim != extraDims.end())
+            {
+                c.m_extraDim = &(*dim);
+                c.m_id = dim->m_id;
+            }
+        }
+        c.m_data.resize(m_defaultChunkSize);
+        m_e57buffers.emplace_back(vectorNode.destImageFile(), names[i],
+                                  c.m_data.data(), m_defaultChunkSize, true, true);
+    }
 
     // Setup the writer
     m_dataWriter.reset(
@@ -71,7 +94,19 @@ E57Writer::ChunkWriter::ChunkWriter
 
 }
 
-void E57Writer::ChunkWriter::write(pdal::PointRef& pt, std::unique_ptr<e57plugin::ExtraDims>& extraDims)
+void E57Writer::ChunkWriter::add(Column& c, double val,
+                                 pdal::point_count_t idx)
+{
+    if (c.m_color && val > m_colorLimit)
+        m_colorLimit = m_colorLimit << 8;  // Increase color bytes.
+    else if (c.m_intensity && val > m_intensityLimit)
+        m_intensityLimit = m_intensityLimit << 8;
+    else if (c.m_extraDim)
+        c.m_extraDim->grow(val);
+    c.m_data[idx] = val;
+}
+
+void E57Writer::ChunkWriter::write(pdal::PointRef& pt)
 {
 // If buffer full, write to disk and reinitialise buffer
 
@@ -82,38 +117,37 @@ void E57Writer::ChunkWriter::write(pdal::PointRef& pt, std::unique_ptr<e57plugin
     }
 
     // Add point to buffer and increase index
-    using DimId = pdal::Dimension::Id;
-    for (auto& keyValue: m_doubleBuffers)
+    for (Column& c : m_columns)
+        if (c.m_id != pdal::Dimension::Id::Unknown)
+            add(c, pt.getFieldAs<double>(c.m_id), m_currentIndex);
+    m_currentIndex++;
+}
+
+void E57Writer::ChunkWriter::write(const pdal::PointView& view)
+{
+    // Fill the buffers a column at a time.
+    pdal::PointId idx = 0;
+    while (idx < view.size())
     {
-        auto pdaldim = pdal::e57plugin::e57ToPdal(keyValue.first);
-        if (pdaldim != DimId::Unknown)
+        if (m_currentIndex == m_defaultChunkSize)
         {
-            auto val = pt.getFieldAs<double>(pdaldim);
-            if ((pdaldim == DimId::Red || pdaldim == DimId::Green ||
-                    pdaldim == DimId::Blue) &&
-                    val > m_colorLimit)
-            {
-                m_colorLimit = m_colorLimit << 8;  // Increase color bytes.
-            }
-
-            if (pdaldim == DimId::Intensity && val > m_intensityLimit)
-            {
-                m_intensityLimit = m_intensityLimit << 8;
-            }
-            keyValue.second[m_currentIndex] = val;
+            m_dataWriter->write(m_defaultChunkSize);
+            m_currentIndex = 0;
         }
-        else
+
+        pdal::point_count_t count = (std::min)(
+            m_defaultChunkSize - m_currentIndex, view.size() - idx);
+        for (Column& c : m_columns)
         {
-            auto dim = extraDims->findDim(keyValue.first);
-            if (dim!=extraDims->end())
-            {
-                auto val = pt.getFieldAs<double>(dim->m_id);
-                keyValue.second[m_currentIndex] = val;
-                dim->grow(val);
-            }
+            if (c.m_id == pdal::Dimension::Id::Unknown)
+                continue;
+            for (pdal::point_count_t i = 0; i < count; ++i)
+                add(c, view.getFieldAs<double>(c.m_id, idx + i),
+                    m_currentIndex + i);
         }
+        m_currentIndex += count;
+        idx += count;
     }
-    m_currentIndex++;
 }
 
 void E57Writer::ChunkWriter::finalise()
@@ -220,11 +254,12 @@ void E57Writer::ready(PointTableRef table)
 
 void E57Writer::write(const PointViewPtr view)
 {
-    for (PointId id = 0; id < view->size(); ++id)
-    {
-        PointRef point = view->point(id);
-        processOne(point);
-    }
+    BOX3D bounds;
+    view->calculateBounds(bounds);
+    if (view->size())
+        m_bbox.grow(bounds);
+
+    m_chunkWriter->write(*view);
 }
 
 bool E57Writer::processOne(PointRef& point)
@@ -235,7 +270,7 @@ bool E57Writer::processOne(PointRef& point)
                 point.getFieldAs<double>(Dimension::Id::Z));
 
     // Write point
-    m_chunkWriter->write(point, m_extraDims);
+    m_chunkWriter->write(point);
 
     return true;
 }
@@ -404,7 +439,8 @@ void E57Writer::setupWriter()
     // Instantiate writer
     try
     {
-        m_chunkWriter.reset(new ChunkWriter(m_dimensionsToWrite, points));
+        m_chunkWriter.reset(
+            new ChunkWriter(m_dimensionsToWrite, points, *m_extraDims));
     }
     catch (e57::E57Exception &e)
     {
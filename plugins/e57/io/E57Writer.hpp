@@ -48,10 +48,11 @@ class PDAL_DLL E57Writer : public pdal::Writer, public pdal::Streamable
     {
     public:
         ChunkWriter(const std::vector<std::string>& dimensionsToWrite,
-                    e57::CompressedVectorNode& vectorNode);
+                    e57::CompressedVectorNode& vectorNode,
+                    e57plugin::ExtraDims& extraDims);
 
-        void write(pdal::PointRef& point,
-                   std::unique_ptr<e57plugin::ExtraDims>& extraDims);
+        void write(pdal::PointRef& point);
+        void write(const pdal::PointView& view);
 
         void finalise();
 
@@ -70,9 +71,20 @@ class PDAL_DLL E57Writer : public pdal::Writer, public pdal::Streamable
         }
 
     private:
+        struct Column
+        {
+            pdal::Dimension::Id m_id;
+            bool m_color;
+            bool m_intensity;
+            e57plugin::Dim *m_extraDim;
+            std::vector<double> m_data;
+        };
+
+        void add(Column& column, double val, pdal::point_count_t idx);
+
         const pdal::point_count_t m_defaultChunkSize;
         pdal::point_count_t m_currentIndex;
-        std::map<std::string, std::vector<double>> m_doubleBuffers;
+        std::vector<Column> m_columns;
         std::vector<e57::SourceDestBuffer> m_e57buffers;
         std::unique_ptr<e57::CompressedVectorWriter> m_dataWriter;
         uint64_t m_colorLimit;
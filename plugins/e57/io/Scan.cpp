@@ -76,6 +76,30 @@ void Scan::transformPoint(pdal::PointRef pt) const
     pt.setField(pdal::Dimension::Id::Z,  x*m_rotation[2][0] + y*m_rotation[2][1] + z*m_rotation[2][2]  + m_translation[2]);
 }
 
+void Scan::transformPoints(double *x, double *y, double *z,
+    pdal::point_count_t count) const
+{
+    // Copy the pose to locals so that the loop can be vectorized.
+    const double r00 = m_rotation[0][0], r01 = m_rotation[0][1],
+        r02 = m_rotation[0][2];
+    const double r10 = m_rotation[1][0], r11 = m_rotation[1][1],
+        r12 = m_rotation[1][2];
+    const double r20 = m_rotation[2][0], r21 = m_rotation[2][1],
+        r22 = m_rotation[2][2];
+    const double tx = m_translation[0], ty = m_translation[1],
+        tz = m_translation[2];
+
+    for (pdal::point_count_t i = 0; i < count; ++i)
+    {
+        const double px = x[i];
+        const double py = y[i];
+        const double pz = z[i];
+        x[i] = px * r00 + py * r01 + pz * r02 + tx;
+        y[i] = px * r10 + py * r11 + pz * r12 + ty;
+        z[i] = px * r20 + py * r21 + pz * r22 + tz;
+    }
+}
+
 std::array<double,3>
 Scan::transformPoint(const std::array<double,3> &originalPoint) const
 {
@@ -233,6 +257,11 @@ double Scan::rescale(pdal::Dimension::Id dim, double value)
     return m_rescaleFactors[(int)dim] * value;
 }
 
+double Scan::rescaleFactor(pdal::Dimension::Id dim) const
+{
+    return m_rescaleFactors[(int)dim];
+}
+
 StructureNode Scan::getPointPrototype()
 {
     return StructureNode(getPoints().prototype());
@@ -54,8 +54,13 @@ public:
     e57::CompressedVectorNode getPoints() const;
     bool hasPose() const;
     void transformPoint(pdal::PointRef pt) const;
+
+    /// Apply the pose to arrays of coordinates in place.
+    void transformPoints(double *x, double *y, double *z,
+        pdal::point_count_t count) const;
     pdal::BOX3D getBoundingBox() const;
     double rescale(pdal::Dimension::Id dim, double value);
+    double rescaleFactor(pdal::Dimension::Id dim) const;
     StructureNode getPointPrototype();
 
 private:
@@ -39,6 +39,7 @@
 #include "plugins/e57/io/Utils.hpp"
 #include "io/LasWriter.hpp"
 #include "io/LasReader.hpp"
+#include "filters/StreamCallbackFilter.hpp"
 
 using namespace pdal;
 
@@ -295,3 +296,63 @@ TEST(E57Reader, testScansWithDifferentDimensions)
 
     remove(outfile.c_str());
 }
+
+TEST(E57Reader, testThreads)
+{
+    auto read = [](const std::string& filename, int threads,
+        int chunkSize, PointTableRef table)
+    {
+        Options ops;
+        ops.add("filename", filename);
+        ops.add("threads", threads);
+        ops.add("chunk_size", chunkSize);
+        E57Reader reader;
+        reader.setOptions(ops);
+        reader.prepare(table);
+        PointViewSet viewSet = reader.execute(table);
+        EXPECT_EQ(viewSet.size(), 1u);
+        return *viewSet.begin();
+    };
+
+    for (std::string file : { "e57/A_B.e57", "e57/A_moved_B.e57",
+        "e57/A_B_different_dims.e57" })
+    {
+        const std::string filename(Support::datapath(file));
+        PointTable table;
+        PointViewPtr expected = read(filename, 1, 100000, table);
+
+        PointTable threadTable;
+        PointViewPtr actual = read(filename, 2, 1, threadTable);
+        ASSERT_EQ(actual->size(), expected->size());
+
+        Dimension::IdList dims = table.layout()->dims();
+        for (PointId idx = 0; idx < expected->size(); ++idx)
+            for (Dimension::Id dim : dims)
+                EXPECT_DOUBLE_EQ(actual->getFieldAs<double>(dim, idx),
+                    expected->getFieldAs<double>(dim, idx));
+
+        // Points stream in the same order, with small chunks.
+        Options ops;
+        ops.add("filename", filename);
+        ops.add("chunk_size", 1);
+        E57Reader reader;
+        reader.setOptions(ops);
+
+        PointId idx = 0;
+        StreamCallbackFilter f;
+        f.setCallback([&expected, &idx, &dims](PointRef& point)
+        {
+            for (Dimension::Id dim : dims)
+                EXPECT_DOUBLE_EQ(point.getFieldAs<double>(dim),
+                    expected->getFieldAs<double>(dim, idx));
+            idx++;
+            return true;
+        });
+        f.setInput(reader);
+
+        FixedPointTable streamTable(2);
+        f.prepare(streamTable);
+        f.execute(streamTable);
+        EXPECT_EQ(idx, expected->size());
+    }
+}
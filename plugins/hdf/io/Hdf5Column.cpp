@@ -0,0 +1,122 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#include "Hdf5Column.hpp"
+
+#include <algorithm>
+
+#include <pdal/pdal_types.hpp>
+
+namespace pdal
+{
+
+namespace hdf5
+{
+
+namespace
+{
+
+// Reads aren't aligned to the least common multiple of the columns' chunk
+// lengths once it grows beyond this.
+const hsize_t MaxAlignedLength = 1 << 22;
+
+hsize_t gcd(hsize_t a, hsize_t b)
+{
+    while (b)
+    {
+        hsize_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+} // unnamed namespace
+
+
+Column::Column(H5::H5File& file, const std::string& datasetName) :
+    m_dset(file.openDataSet(datasetName)), m_numEntries(0), m_chunkLength(0)
+{
+    H5::DataSpace dspace = m_dset.getSpace();
+    if (dspace.getSimpleExtentNdims() != 1)
+        throw pdal_error("Dataset '" + datasetName + "' isn't "
+            "1-dimensional. Only 1-dimensional arrays are supported.");
+    dspace.getSimpleExtentDims(&m_numEntries);
+
+    H5::DSetCreatPropList plist = m_dset.getCreatePlist();
+    if (plist.getLayout() == H5D_CHUNKED)
+        plist.getChunk(1, &m_chunkLength);
+}
+
+
+void Column::read(void *data, const H5::DataType& memType, hsize_t offset,
+    hsize_t count) const
+{
+    // A dataspace is made for each read so that columns can be read
+    // without sharing selection state.
+    H5::DataSpace fileSpace = m_dset.getSpace();
+    fileSpace.selectHyperslab(H5S_SELECT_SET, &count, &offset);
+
+    H5::DataSpace memSpace(1, &count);
+    m_dset.read(data, memType, memSpace, fileSpace);
+}
+
+
+hsize_t Column::blockLength(const std::vector<const Column *>& columns,
+    hsize_t minLength)
+{
+    // Reading whole chunks keeps HDF5 from decompressing a chunk more than
+    // once for the parts that fall into different reads.
+    hsize_t length = 1;
+    hsize_t maxChunk = 1;
+    for (const Column *c : columns)
+    {
+        hsize_t chunk = c->chunkLength();
+        if (chunk == 0)
+            continue;
+        maxChunk = (std::max)(maxChunk, chunk);
+        if (length <= MaxAlignedLength)
+            length = length / gcd(length, chunk) * chunk;
+    }
+    // Chunk lengths that don't share factors would make for huge reads.
+    // Align to the largest chunks instead.
+    if (length > MaxAlignedLength)
+        length = maxChunk;
+    return ((std::max)(minLength, (hsize_t)1) + length - 1) / length * length;
+}
+
+} // namespace hdf5
+
+} // namespace pdal
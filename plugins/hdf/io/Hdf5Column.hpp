@@ -0,0 +1,85 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#pragma once
+
+#include "H5Cpp.h"
+
+#include <string>
+#include <vector>
+
+namespace pdal
+{
+
+namespace hdf5
+{
+
+// A one-dimensional HDF5 dataset that is read in ranges of entries.
+// Shared by readers.hdf and readers.icebridge.
+class Column
+{
+public:
+    Column(H5::H5File& file, const std::string& datasetName);
+
+    const H5::DataSet& dataset() const
+        { return m_dset; }
+
+    hsize_t numEntries() const
+        { return m_numEntries; }
+
+    // Number of entries in each of the dataset's chunks, or 0 if the
+    // dataset isn't chunked.
+    hsize_t chunkLength() const
+        { return m_chunkLength; }
+
+    // Read 'count' entries starting at entry 'offset' into 'data',
+    // converting them to 'memType'.
+    void read(void *data, const H5::DataType& memType, hsize_t offset,
+        hsize_t count) const;
+
+    // Length of a read that starts and ends on chunk boundaries of all
+    // the columns and is at least 'minLength' entries.
+    static hsize_t blockLength(const std::vector<const Column *>& columns,
+        hsize_t minLength);
+
+private:
+    H5::DataSet m_dset;
+    hsize_t m_numEntries;
+    hsize_t m_chunkLength;
+};
+
+} // namespace hdf5
+
+} // namespace pdal
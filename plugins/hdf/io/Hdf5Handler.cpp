@@ -42,6 +42,15 @@ namespace pdal
 
 using namespace hdf5;
 
+namespace
+{
+
+// Minimum number of points read at once.
+const hsize_t MinBlockLength = 65536;
+
+} // unnamed namespace
+
+
 void Handler::setLog(pdal::LogPtr log) {
     m_logger = log;
 }
@@ -74,6 +83,14 @@ void Handler::initialize(
             throw pdal_error("All given datasets must have the same length");
         }
     }
+
+    std::vector<const Column *> columns;
+    for (const DimInfo& info : m_dimInfos)
+        columns.push_back(&info.getColumn());
+    m_blockLength = Column::blockLength(columns, MinBlockLength);
+    if (m_logger)
+        m_logger->get(LogLevel::Debug) << "Reading blocks of " <<
+            m_blockLength << " points." << std::endl;
 }
 
 
@@ -83,67 +100,52 @@ void Handler::close()
 }
 
 
-uint8_t *DimInfo::getValue(pdal::point_count_t pointIndex) {
-    if(pointIndex < chunkLowerBound || pointIndex >= chunkUpperBound) {
-        // load new chunk
-        H5::DataSpace dspace = m_dset.getSpace();
-
-        chunkLowerBound = (pointIndex / m_chunkSize) * m_chunkSize;
-        chunkUpperBound = std::min(chunkLowerBound + m_chunkSize, m_numPoints);
-
-        hsize_t selectionSize = chunkUpperBound - chunkLowerBound;
+hsize_t Handler::getNumPoints() const
+{
+    return m_numPoints;
+}
 
-        H5::DataSpace memspace(1, &selectionSize);
-        dspace.selectHyperslab(H5S_SELECT_SET, &selectionSize, &chunkLowerBound);
-        m_dset.read(m_buffer.data(),
-                    m_dset.getDataType(),
-                    memspace,
-                    dspace );
 
-    }
-    hsize_t pointOffsetWithinChunk = pointIndex - chunkLowerBound;
-    return m_buffer.data() + pointOffsetWithinChunk * m_size;
+hsize_t Handler::getBlockLength() const
+{
+    return m_blockLength;
 }
 
 
-hsize_t Handler::getNumPoints() const
+void Handler::readBlock(Block& block, hsize_t start, hsize_t count) const
 {
-    return m_numPoints;
+    // The HDF5 library serializes calls unless built thread-safe (and
+    // then only allows one call at a time), so datasets are read in turn.
+    block.m_data.resize(m_dimInfos.size());
+    for (size_t i = 0; i < m_dimInfos.size(); ++i)
+    {
+        const DimInfo& info = m_dimInfos[i];
+        const Column& column = info.getColumn();
+        std::vector<uint8_t>& buf = block.m_data[i];
+
+        buf.resize(count * info.getSize());
+        column.read(buf.data(), column.dataset().getDataType(), start, count);
+    }
+    block.m_start = start;
+    block.m_count = count;
 }
 
+
 DimInfo::DimInfo(
     const std::string& dimName,
     const std::string& datasetName,
     H5::H5File *file
     )
     : m_name(dimName)
-    , m_dset(file->openDataSet(datasetName))
+    , m_column(*file, datasetName)  // Throws if the dataset doesn't exist.
     {
-        // Will throw if dataset doesn't exists. Gives adequate error message
-        H5::DataSpace dspace = m_dset.getSpace();
-
-        // Sanity check before we cast from signed to unsigned
-        if(dspace.getSelectNpoints() < 0)
-            throw pdal_error("Selection had a negative number of points. "
-                "this should never happen, and it's probably a PDAL bug.");     
-        m_numPoints = (hsize_t) dspace.getSelectNpoints();
-
-        // check if dataset is 'chunked'
-        H5::DSetCreatPropList plist = m_dset.getCreatePlist();
-        if(plist.getLayout() == H5D_CHUNKED) {
-            int dimensionality = plist.getChunk(1, &m_chunkSize); //modifies m_chunkSize
-            if(dimensionality != 1)
-                throw pdal_error("Only 1-dimensional arrays are supported.");
-        } else {
-            //if dataset is not chunked, use an arbitrary number for buffer size
-            m_chunkSize = 1024; // completely arbitrary number
-        }
+        const H5::DataSet& dset = m_column.dataset();
 
         // populate fields base on HDF type
-        H5T_class_t vague_type = m_dset.getDataType().getClass();
+        H5T_class_t vague_type = dset.getDataType().getClass();
 
         if(vague_type == H5T_INTEGER) {
-            H5::IntType int_type = m_dset.getIntType();
+            H5::IntType int_type = dset.getIntType();
             H5T_sign_t sign = int_type.getSign();
             m_size = int_type.getSize();
             if(sign == H5T_SGN_2)
@@ -152,7 +154,7 @@ DimInfo::DimInfo(
                 m_pdalType = Dimension::Type(unsigned(Dimension::BaseType::Unsigned) | int_type.getSize());
         }
         else if(vague_type == H5T_FLOAT) {
-            H5::FloatType float_type = m_dset.getFloatType();
+            H5::FloatType float_type = dset.getFloatType();
             m_size = float_type.getSize();
             m_pdalType = Dimension::Type(unsigned(Dimension::BaseType::Floating) | float_type.getSize());
         }
@@ -160,9 +162,6 @@ DimInfo::DimInfo(
             throw pdal_error("Dataset '" + datasetName + "' has an " +
                 "unsupported type. Only integer and float types are supported.");
         }
-
-        //allocate buffer for getValue() to write into
-        m_buffer.resize(m_chunkSize*m_size);
     }
 
 
@@ -176,24 +175,33 @@ void DimInfo::setId(Dimension::Id id) {
 }
 
 
-Dimension::Id DimInfo::getId() {
+Dimension::Id DimInfo::getId() const {
     return m_pdalId;
 }
 
 
-Dimension::Type DimInfo::getPdalType() {
+Dimension::Type DimInfo::getPdalType() const {
     return m_pdalType;
 }
 
 
-std::string DimInfo::getName() {
+std::string DimInfo::getName() const {
     return m_name;
 }
 
 
-hsize_t DimInfo::getNumPoints() {
-    return m_numPoints;
+hsize_t DimInfo::getNumPoints() const {
+    return m_column.numEntries();
+}
+
+
+size_t DimInfo::getSize() const {
+    return m_size;
 }
 
-} // namespace pdal
 
+const Column& DimInfo::getColumn() const {
+    return m_column;
+}
+
+} // namespace pdal
@@ -38,7 +38,7 @@
 #include <pdal/Dimension.hpp>
 #include <pdal/Log.hpp>
 #include "H5Cpp.h"
-#include <nlohmann/json.hpp>
+#include "Hdf5Column.hpp"
 
 #include <memory>
 #include <vector>
@@ -59,28 +59,35 @@ public:
         const std::string& datasetName,
         H5::H5File *file);
 
-    uint8_t *getValue(pdal::point_count_t pointIndex);
     //setters
     void setId(Dimension::Id id);
     //getters
-    Dimension::Id getId();
-    Dimension::Type getPdalType();
-    std::string getName();
-    hsize_t getNumPoints();
+    Dimension::Id getId() const;
+    Dimension::Type getPdalType() const;
+    std::string getName() const;
+    hsize_t getNumPoints() const;
+    size_t getSize() const;
+    const Column& getColumn() const;
 
 private:
-    std::vector<uint8_t> m_buffer;
     std::string m_name;
     Dimension::Type m_pdalType;
     Dimension::Id m_pdalId = Dimension::Id::Unknown;
-    hsize_t chunkUpperBound = 0,
-            chunkLowerBound = 0,
-            m_numPoints = 0,
-            m_chunkSize;
-    H5::DataSet m_dset;
+    Column m_column;
     size_t m_size;
 };
 
+// Values of every dimension for a range of points.
+struct Block
+{
+    hsize_t m_start = 0;
+    hsize_t m_count = 0;
+    std::vector<std::vector<uint8_t>> m_data;  // One buffer per dimension.
+
+    bool contains(hsize_t pointIndex) const
+        { return pointIndex >= m_start && pointIndex < m_start + m_count; }
+};
+
 class Handler
 {
 public:
@@ -92,6 +99,13 @@ public:
     hsize_t getNumPoints() const;
     std::vector<pdal::hdf5::DimInfo>& getDimensions();
 
+    // Number of points read into each block.  Blocks end on chunk
+    // boundaries of the datasets.
+    hsize_t getBlockLength() const;
+
+    // Read the values of points [start, start + count) into 'block'.
+    void readBlock(Block& block, hsize_t start, hsize_t count) const;
+
     void setLog(pdal::LogPtr log);
 
 private:
@@ -101,9 +115,9 @@ private:
 
     std::unique_ptr<H5::H5File> m_h5File;
     hsize_t m_numPoints = 0;
+    hsize_t m_blockLength = 0;
 };
 
 } //namespace hdf5
 
 } // namespace pdal
-
@@ -37,7 +37,6 @@
 #include <pdal/pdal_types.hpp>
 #include <pdal/PointView.hpp>
 #include <pdal/util/ProgramArgs.hpp>
-#include "Hdf5Handler.hpp"
 
 #include <map>
 
@@ -77,6 +76,50 @@ void HdfReader::addDimensions(PointLayoutPtr layout)
 void HdfReader::ready(PointTableRef table)
 {
     m_index = 0;
+    m_current = 0;
+    m_blocks[0] = hdf5::Block();
+    readAhead();
+}
+
+
+// Start reading the block that follows the current one.
+void HdfReader::readAhead()
+{
+    const hdf5::Block& cur = m_blocks[m_current];
+    hsize_t start = cur.m_start + cur.m_count;
+    hsize_t numPoints = m_hdf5Handler->getNumPoints();
+    if (start >= numPoints)
+        return;
+
+    hsize_t count = (std::min)(m_hdf5Handler->getBlockLength(),
+        numPoints - start);
+    hdf5::Block& next = m_blocks[1 - m_current];
+    const hdf5::Handler *handler = m_hdf5Handler.get();
+    m_pending = std::async(std::launch::async, [handler, &next, start, count]()
+    {
+        handler->readBlock(next, start, count);
+    });
+}
+
+
+// Return the block holding the point at m_index, switching to the block
+// read ahead if necessary.
+const hdf5::Block& HdfReader::currentBlock()
+{
+    if (!m_blocks[m_current].contains(m_index) && m_pending.valid())
+    {
+        try
+        {
+            m_pending.get();
+        }
+        catch (const H5::Exception& err)
+        {
+            throwError("Unable to read HDF5 data: " + err.getDetailMsg());
+        }
+        m_current = 1 - m_current;
+        readAhead();
+    }
+    return m_blocks[m_current];
 }
 
 
@@ -87,13 +130,28 @@ point_count_t HdfReader::read(PointViewPtr view, point_count_t count)
     count = (std::min)(count, remaining);
     PointId nextId = startId;
 
-    for(uint64_t pi = 0; pi < m_hdf5Handler->getNumPoints(); pi++) {
-        for(hdf5::DimInfo& dim : m_hdf5Handler->getDimensions()) {
-            uint8_t *p = dim.getValue(pi);
-            view->setField(dim.getId(), dim.getPdalType(), nextId, (void*) p);
+    std::vector<hdf5::DimInfo>& dims = m_hdf5Handler->getDimensions();
+    point_count_t total = 0;
+    while (total < count)
+    {
+        const hdf5::Block& block = currentBlock();
+        hsize_t offset = m_index - block.m_start;
+        point_count_t cnt = (std::min)(count - total,
+            (point_count_t)(block.m_count - offset));
+
+        // Fill a dimension at a time.
+        for (size_t d = 0; d < dims.size(); ++d)
+        {
+            const hdf5::DimInfo& dim = dims[d];
+            const size_t size = dim.getSize();
+            const uint8_t *p = block.m_data[d].data() + offset * size;
+            for (PointId i = 0; i < cnt; ++i, p += size)
+                view->setField(dim.getId(), dim.getPdalType(), nextId + i,
+                    (const void *)p);
         }
-        m_index++;
-        nextId++;
+        m_index += cnt;
+        nextId += cnt;
+        total += cnt;
     }
 
     return count;
@@ -102,13 +160,21 @@ point_count_t HdfReader::read(PointViewPtr view, point_count_t count)
 
 bool HdfReader::processOne(PointRef& point)
 {
-    for(hdf5::DimInfo& dim : m_hdf5Handler-> getDimensions()) {
-        uint8_t *p = dim.getValue(m_index);
-        point.setField(dim.getId(), dim.getPdalType(), p);
+    if (m_index >= m_hdf5Handler->getNumPoints())
+        return false;
+
+    const hdf5::Block& block = currentBlock();
+    hsize_t offset = m_index - block.m_start;
+    std::vector<hdf5::DimInfo>& dims = m_hdf5Handler->getDimensions();
+    for (size_t d = 0; d < dims.size(); ++d)
+    {
+        const hdf5::DimInfo& dim = dims[d];
+        point.setField(dim.getId(), dim.getPdalType(),
+            block.m_data[d].data() + offset * dim.getSize());
     }
 
     m_index++;
-    return m_index <= m_hdf5Handler->getNumPoints();
+    return true;
 }
 
 void HdfReader::addArgs(ProgramArgs& args)
@@ -151,6 +217,9 @@ void HdfReader::parseDimensions()
 
 void HdfReader::done(PointTableRef table)
 {
+    // Don't close the file under a read that's still running.
+    if (m_pending.valid())
+        m_pending.wait();
     m_hdf5Handler->close();
 }
 
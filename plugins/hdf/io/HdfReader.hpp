@@ -42,16 +42,13 @@
 #include <pdal/StageFactory.hpp>
 #include <nlohmann/json.hpp>
 
+#include <future>
 #include <vector>
 
-namespace pdal
-{
+#include "Hdf5Handler.hpp"
 
-namespace hdf5
+namespace pdal
 {
-    class Handler;
-    class DimInfo;
-}
 
 class PDAL_DLL HdfReader : public pdal::Reader, public pdal::Streamable
 {
@@ -63,6 +60,11 @@ private:
     std::unique_ptr<hdf5::Handler> m_hdf5Handler;
     point_count_t m_index;
 
+    // Points are converted from one block while the next one is read.
+    hdf5::Block m_blocks[2];
+    size_t m_current;
+    std::future<void> m_pending;
+
     virtual void addDimensions(PointLayoutPtr layout) override;
     virtual void addArgs(ProgramArgs& args) override;
     virtual void initialize() override;
@@ -75,6 +77,8 @@ private:
     std::map<std::string,std::string> m_pathDimMap;
     Dimension::IdList m_idlist;
     void parseDimensions();
+    void readAhead();
+    const hdf5::Block& currentBlock();
 
     HdfReader& operator=(const HdfReader&);   // Not implemented.
     HdfReader(const HdfReader&);              // Not implemented.
@@ -40,6 +40,7 @@
 #include <pdal/StageFactory.hpp>
 #include <pdal/util/FileUtils.hpp>
 #include <nlohmann/json.hpp>
+#include <filters/StreamCallbackFilter.hpp>
 #include "Support.hpp"
 
 using namespace pdal;
@@ -96,6 +97,50 @@ TEST(HdfReaderTest, testRead)
          246504.03026135918, 50, 65, 65);
 }
 
+TEST(HdfReaderTest, testStream)
+{
+    StageFactory f;
+    Stage* reader(f.createStage("readers.hdf"));
+    EXPECT_TRUE(reader);
+
+    NL::json j = {
+        {"X", "autzen/X"},
+        {"Y", "autzen/Y"},
+        {"Z", "autzen/Z"},
+        {"Intensity", "autzen/Intensity"}
+    };
+
+    Options options;
+    options.add("filename", getFilePath());
+    options.add("dimensions", j.dump());
+    reader->setOptions(options);
+
+    point_count_t count = 0;
+    auto cb = [&count](PointRef& point)
+    {
+        if (count == 99)
+        {
+            EXPECT_NEAR(point.getFieldAs<double>(Dimension::Id::X),
+                636699.44, .01);
+            EXPECT_NEAR(point.getFieldAs<double>(Dimension::Id::Y),
+                849829.23, .01);
+            EXPECT_NEAR(point.getFieldAs<double>(Dimension::Id::Z),
+                420.8, .01);
+        }
+        count++;
+        return true;
+    };
+
+    StreamCallbackFilter filter;
+    filter.setCallback(cb);
+    filter.setInput(*reader);
+
+    FixedPointTable table(100);
+    filter.prepare(table);
+    filter.execute(table);
+    EXPECT_EQ(count, 1065u);
+}
+
 TEST(HdfReaderTest, testOptions)
 {
     StageFactory f;
@@ -36,12 +36,12 @@
 
 #include <Eigen/Geometry>
 #include <pdal/private/SrsTransform.hpp>
+#include <pdal/util/TaskScheduler.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
 #include "../lepcc/src/include/lepcc_types.h"
 
 #include "EsriUtil.hpp"
-#include "pool.hpp"
-#include "SlpkExtractor.hpp"
 
 
 namespace pdal
@@ -355,25 +355,38 @@ point_count_t EsriReader::read(PointViewPtr view, point_count_t count)
     log()->get(LogLevel::Debug) << "Traversing metadata" << std::endl;
     traverseTree(initJson, 0, nodes, 0, 0);
 
-    // Create view with overlapping nodes at desired depth
-    // Will create a thread pool on the createview class and iterate
-    // through the node list for the nodes to be pulled.
+    // Fetching and decoding run in separate pools so that decoding doesn't
+    // hold up requests.  Each fetched node is handed to the decode pool,
+    // which blocks fetching when decoding falls behind.
     log()->get(LogLevel::Debug) << "Fetching binaries" << std::endl;
-    Pool p(m_args.threads);
+    ThreadPool decodePool(TaskScheduler::instance().concurrency(),
+        m_args.threads, false);
+    ThreadPool fetchPool(m_args.threads, 1, false);
     for (std::size_t i = 0; i < nodes.size(); i++)
     {
         log()->get(LogLevel::Debug) << "\r" << i << "/" << nodes.size();
         std::string localUrl;
 
         localUrl = m_filename + "/nodes/" + std::to_string(nodes[i]);
-        int nodeIndex(nodes[i]);
 
-        p.add([localUrl, nodeIndex, this, &view]()
+        fetchPool.add([localUrl, this, &decodePool, &view]()
         {
-            createView(localUrl, nodeIndex, *view);
+            std::shared_ptr<NodeData> data(
+                new NodeData(fetchNode(localUrl)));
+            decodePool.add([data, this, &view]()
+            {
+                createView(*data, *view);
+            });
         });
     }
-    p.await();
+    fetchPool.join();
+    decodePool.join();
+
+    std::vector<std::string> errors(fetchPool.errors());
+    errors.insert(errors.end(), decodePool.errors().begin(),
+        decodePool.errors().end());
+    if (errors.size())
+        throwError(errors.front());
     return view->size();
 }
 
@@ -499,16 +512,38 @@ BOX3D EsriReader::createCube(const NL::json& base)
 }
 
 
-void EsriReader::createView(std::string localUrl, int nodeIndex,
-    PointView& view)
+EsriReader::NodeData EsriReader::fetchNode(const std::string& localUrl) const
 {
+    NodeData data;
+
     // pull the geometries to start
     const std::string geomUrl = localUrl + "/geometries/";
-    auto xyzFetch = fetchBinary(geomUrl, "0", ".bin.pccxyz");
+    data.xyz = fetchBinary(geomUrl, "0", ".bin.pccxyz");
+
+    //the extensions seen in this part correspond with slpk
+    const std::string attrUrl = localUrl + "/attributes/";
+    for (const auto& dimEntry : m_dimMap)
+    {
+        const Dimension::Id dimId(dimEntry.first);
+        const std::string key(std::to_string(dimEntry.second.key));
+
+        std::string ext(".bin.gz");
+        if (dimId == Dimension::Id::Red)
+            ext = ".bin.pccrgb";
+        else if (dimId == Dimension::Id::Intensity)
+            ext = ".bin.pccint";
+        data.attributes[dimId] = fetchBinary(attrUrl, key, ext);
+    }
+    return data;
+}
+
+
+void EsriReader::createView(NodeData& node, PointView& view)
+{
     std::vector<lepcc::Point3D> xyz;
     try
     {
-        xyz = EsriUtil::decompressXYZ(&xyzFetch);
+        xyz = EsriUtil::decompressXYZ(&node.xyz);
     }
     catch (const EsriUtil::decompression_error& e)
     {
@@ -540,20 +575,14 @@ void EsriReader::createView(std::string localUrl, int nodeIndex,
         }
     }
 
-    const std::string attrUrl = localUrl + "/attributes/";
-
-    //the extensions seen in this part correspond with slpk
     for (const auto& dimEntry : m_dimMap)
     {
         const Dimension::Id dimId(dimEntry.first);
         const Dimension::Type dimType(dimEntry.second.dimType);
-        const uint64_t key(dimEntry.second.key);
-        const std::string name(dimEntry.second.name);
+        std::vector<char>& data = node.attributes.at(dimId);
 
         if (dimId == Dimension::Id::Red)
         {
-            auto data = fetchBinary(
-                    attrUrl, std::to_string(key), ".bin.pccrgb");
             std::vector<lepcc::RGB_t> rgbPoints;
             try
             {
@@ -584,9 +613,6 @@ void EsriReader::createView(std::string localUrl, int nodeIndex,
         }
         else if (dimId == Dimension::Id::Intensity)
         {
-            auto data = fetchBinary(attrUrl, std::to_string(key),
-                    ".bin.pccint");
-
             std::vector<uint16_t> intensity;
             try
             {
@@ -612,10 +638,6 @@ void EsriReader::createView(std::string localUrl, int nodeIndex,
         }
         else if (dimId == Dimension::Id::NumberOfReturns)
         {
-
-            const std::vector<char> data = fetchBinary(
-                    attrUrl, std::to_string(key), ".bin.gz");
-
             const uint8_t* returnData =
                 reinterpret_cast<const uint8_t*> (data.data());
 
@@ -640,9 +662,6 @@ void EsriReader::createView(std::string localUrl, int nodeIndex,
         }
         else
         {
-            const auto data = fetchBinary(
-                    attrUrl, std::to_string(key), ".bin.gz");
-
             std::size_t dimSize = Dimension::size(dimType);
 
             if (data.size() != xyz.size() * dimSize)
@@ -175,7 +175,15 @@ protected:
     virtual void ready(PointTableRef table) override;
     virtual point_count_t read(PointViewPtr view, point_count_t count) override;
     virtual void done(PointTableRef table) override;
-    void createView(std::string localUrl, int nodeIndex,  PointView& view);
+    // Compressed resources of a node, fetched before being decoded.
+    struct NodeData
+    {
+        std::vector<char> xyz;
+        std::map<Dimension::Id, std::vector<char>> attributes;
+    };
+
+    NodeData fetchNode(const std::string& localUrl) const;
+    void createView(NodeData& node, PointView& view);
     BOX3D createCube(const NL::json& base);
     BOX3D parseBox(const NL::json& base);
     void traverseTree(NL::json page, int index, std::vector<int>& nodes,
@@ -36,6 +36,8 @@
 #include "EsriUtil.hpp"
 #include <thread>
 
+#include <pdal/private/FileCache.hpp>
+
 namespace pdal
 {
 
@@ -48,13 +50,44 @@ static PluginInfo const i3sInfo
 
 CREATE_SHARED_STAGE(I3SReader, i3sInfo)
 
+I3SReader::I3SReader()
+{}
+
+
+I3SReader::~I3SReader()
+{}
+
+
 std::string I3SReader::getName() const { return i3sInfo.name; }
 
+void I3SReader::addArgs(ProgramArgs& args)
+{
+    EsriReader::addArgs(args);
+    args.add("cache_dir", "Directory in which to cache fetched node data",
+        m_cacheDir);
+    args.add("cache_size", "Maximum size of the cache in megabytes",
+        m_cacheSize, (uint64_t)1024);
+}
+
+
 void I3SReader::initInfo()
 {
     try
     {
-        m_info = EsriUtil::parse(m_arbiter->get(m_filename));
+        std::string info(m_arbiter->get(m_filename));
+        m_info = EsriUtil::parse(info);
+
+        // Cached node data is keyed by the content of the layer info so
+        // that a rebuilt service is never read from stale entries.
+        if (!m_cacheDir.empty())
+        {
+            m_cache.reset(new FileCache(m_cacheDir,
+                m_cacheSize * 1024 * 1024, ".ept"));
+            m_cacheVersion =
+                arbiter::crypto::encodeAsHex(arbiter::crypto::sha256(info));
+            log()->get(LogLevel::Debug) << "Caching in '" << m_cacheDir <<
+                "' with version " << m_cacheVersion << std::endl;
+        }
 
         if (m_info.empty())
             throwError(std::string("Incorrect Json object"));
@@ -86,6 +119,12 @@ std::vector<char> I3SReader::fetchBinary(std::string url,
 
     // For the REST I3S endpoint there are no file extensions.
     std::vector<char> result;
+    const std::string key(url + attNum + "\n" + m_cacheVersion);
+    if (m_cache && m_cache->get(key, result))
+        return result;
+
+    // Requests go through arbiter's pool of HTTP handles, which keeps
+    // connections to the server open between fetches.
     while (true)
     {
         auto data = m_arbiter->tryGetBinary(url + attNum);
@@ -98,6 +137,8 @@ std::vector<char> I3SReader::fetchBinary(std::string url,
             throwError(std::string("Failed to fetch: " + url + attNum));
         std::this_thread::sleep_for(std::chrono::milliseconds(250));
     }
+    if (m_cache)
+        m_cache->put(key, result);
     return result;
 }
 
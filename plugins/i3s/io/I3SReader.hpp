@@ -38,16 +38,28 @@
 namespace pdal
 {
 
+class FileCache;
+
 class PDAL_DLL I3SReader : public EsriReader
 {
 public:
+    I3SReader();
+    ~I3SReader();
+
     std::string getName() const override;
 
 protected:
+    virtual void addArgs(ProgramArgs& args) override;
     virtual void initInfo() override;
     virtual std::vector<char> fetchBinary(std::string url, std::string attNum,
         std::string ext) const override;
     virtual NL::json fetchJson(std::string) override;
+
+private:
+    std::string m_cacheDir;
+    uint64_t m_cacheSize;
+    std::unique_ptr<FileCache> m_cache;
+    std::string m_cacheVersion;
 };
 
 } // namespace pdal
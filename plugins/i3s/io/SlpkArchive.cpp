@@ -0,0 +1,139 @@
+/******************************************************************************
+* Copyright (c) 2018, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include "SlpkArchive.hpp"
+
+#include <cstring>
+
+#include <pdal/util/Extractor.hpp>
+
+namespace pdal
+{
+
+namespace
+{
+
+const uint32_t LocalHeaderMagic = 0x04034b50;
+const size_t LocalHeaderSize = 30;
+
+} // unnamed namespace
+
+
+SlpkArchive::SlpkArchive(const std::string& filename)
+{
+    m_ctx = FileUtils::mapFile(filename);
+    if (!m_ctx.addr())
+        throw slpk_error("Couldn't map slpk archive '" + filename + "': " +
+            m_ctx.what());
+    try
+    {
+        index();
+    }
+    catch (...)
+    {
+        FileUtils::unmapFile(m_ctx);
+        throw;
+    }
+}
+
+
+SlpkArchive::~SlpkArchive()
+{
+    FileUtils::unmapFile(m_ctx);
+}
+
+
+// Walk the local file headers, recording where each entry's data starts.
+void SlpkArchive::index()
+{
+    const char *start = reinterpret_cast<const char *>(m_ctx.addr());
+    const size_t size = m_ctx.size();
+    size_t pos = 0;
+
+    while (size - pos >= LocalHeaderSize)
+    {
+        LeExtractor in(start + pos, LocalHeaderSize);
+
+        uint32_t magic;
+        uint16_t version;
+        uint16_t purpose;
+        uint16_t compression;
+        uint32_t time;
+        uint32_t crc;
+        uint32_t compressedSize;
+        uint32_t uncompressedSize;
+        uint16_t nameLen;
+        uint16_t extraLen;
+
+        in >> magic;
+        if (magic != LocalHeaderMagic)
+            break;
+        in >> version >> purpose >> compression >> time >> crc >>
+            compressedSize >> uncompressedSize >> nameLen >> extraLen;
+
+        if (compression != 0)
+            throw slpk_error("Found compressed file in slpk archive.");
+        if (compressedSize != uncompressedSize)
+            throw slpk_error("Compressed and uncompressed sizes don't match "
+                "in slpk archive.");
+
+        pos += LocalHeaderSize;
+        if (size - pos < (size_t)nameLen + extraLen + compressedSize)
+            throw slpk_error("Truncated slpk archive.");
+
+        std::string name(start + pos, nameLen);
+        pos += nameLen + extraLen;
+        m_entries[name] = { start + pos, compressedSize };
+        pos += compressedSize;
+    }
+}
+
+
+bool SlpkArchive::exists(const std::string& name) const
+{
+    return m_entries.find(name) != m_entries.end();
+}
+
+
+std::vector<char> SlpkArchive::get(const std::string& name) const
+{
+    auto it = m_entries.find(name);
+    if (it == m_entries.end())
+        throw slpk_error("File '" + name + "' not found in slpk archive.");
+
+    const Entry& e = it->second;
+    return std::vector<char>(e.m_data, e.m_data + e.m_size);
+}
+
+} //namespace pdal
@@ -0,0 +1,89 @@
+/******************************************************************************
+* Copyright (c) 2018, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <pdal/util/FileUtils.hpp>
+
+namespace pdal
+{
+
+class slpk_error
+{
+public:
+    slpk_error(const std::string& error) : m_error(error)
+    {}
+
+    std::string what() const
+        { return m_error; }
+
+    std::string m_error;
+};
+
+// Read access to the files stored in an SLPK (zip) archive.  The archive
+// is memory-mapped and its entries are read in place rather than being
+// extracted to disk.  Entries may be read from any number of threads.
+class SlpkArchive
+{
+public:
+    SlpkArchive(const std::string& filename);
+    ~SlpkArchive();
+
+    // Whether the archive contains an entry named 'name'.
+    bool exists(const std::string& name) const;
+
+    // Return the contents of the entry named 'name'.
+    std::vector<char> get(const std::string& name) const;
+
+private:
+    struct Entry
+    {
+        const char *m_data;
+        size_t m_size;
+    };
+
+    FileUtils::MapContext m_ctx;
+    std::map<std::string, Entry> m_entries;
+
+    void index();
+
+    SlpkArchive(const SlpkArchive&) = delete;
+    SlpkArchive& operator=(const SlpkArchive&) = delete;
+};
+
+} // namespace pdal
@@ -35,9 +35,8 @@
 #include "SlpkReader.hpp"
 #include <pdal/util/FileUtils.hpp>
 
-#include "pool.hpp"
 #include "EsriUtil.hpp"
-#include "SlpkExtractor.hpp"
+#include "SlpkArchive.hpp"
 
 namespace pdal
 {
@@ -51,27 +50,30 @@ static PluginInfo const slpkInfo
 
 CREATE_SHARED_STAGE(SlpkReader, slpkInfo)
 
+SlpkReader::SlpkReader()
+{}
+
+
+SlpkReader::~SlpkReader()
+{}
+
+
 std::string SlpkReader::getName() const { return slpkInfo.name; }
 
 void SlpkReader::initInfo()
 {
-    // create temp path
-    std::string path = arbiter::getTempPath();
-
-    // use arbiter to create new directory if doesn't already exist
-    std::string fullPath(path + FileUtils::stem(
-        FileUtils::getFilename(m_filename)));
-    arbiter::mkdirp(fullPath);
-
-    // un-archive the slpk archive
-    SlpkExtractor slpk(m_filename, fullPath);
-    slpk.extract();
-    m_filename = fullPath;
-    log()->get(LogLevel::Debug) << "Making directory at: " <<
-        fullPath << std::endl;
-
-    // unarchive and decompress the 3dscenelayer and create json info object
-    auto compressed = m_arbiter->get(m_filename + "/3dSceneLayer.json.gz");
+    // Resources are read straight from the memory-mapped archive.
+    try
+    {
+        m_archive.reset(new SlpkArchive(m_filename));
+    }
+    catch (const slpk_error& err)
+    {
+        throwError(err.what());
+    }
+
+    // decompress the 3dscenelayer and create json info object
+    std::vector<char> compressed = get(m_filename + "/3dSceneLayer.json.gz");
     std::string jsonString;
 
     m_decomp.decompress(jsonString, compressed.data(), compressed.size());
@@ -81,23 +83,44 @@ void SlpkReader::initInfo()
 }
 
 
+// Paths are built relative to the archive filename.  Strip it to get the
+// name of the entry in the archive.
+std::vector<char> SlpkReader::get(const std::string& path) const
+{
+    std::string name(path);
+    const std::string prefix(m_filename + "/");
+    if (Utils::startsWith(name, prefix))
+        name = name.substr(prefix.size());
+
+    try
+    {
+        return m_archive->get(name);
+    }
+    catch (const slpk_error& err)
+    {
+        throwError(err.what());
+    }
+    return std::vector<char>();
+}
+
+
 NL::json SlpkReader::fetchJson(std::string filepath)
 {
     std::string output;
-    auto compressed = m_arbiter->get(filepath + ".json.gz");
+    std::vector<char> compressed = get(filepath + ".json.gz");
     m_decomp.decompress<std::string>(output, compressed.data(),
         compressed.size());
     return EsriUtil::parse(output);
 
 }
 
-// fetch data using arbiter to get a char vector
+// fetch data from the archive to get a char vector
 std::vector<char> SlpkReader::fetchBinary(std::string url, std::string attNum,
     std::string ext) const
 {
     url += attNum + ext;
 
-    auto data(m_arbiter->getBinary(url));
+    std::vector<char> data(get(url));
 
     if (FileUtils::extension(url) != ".gz")
         return data;
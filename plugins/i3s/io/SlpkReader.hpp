@@ -38,9 +38,15 @@
 
 namespace pdal
 {
+
+class SlpkArchive;
+
 class PDAL_DLL SlpkReader : public EsriReader
 {
 public:
+    SlpkReader();
+    ~SlpkReader();
+
     std::string getName() const override;
 
 protected:
@@ -49,6 +55,10 @@ protected:
             std::string ext) const override;
     virtual NL::json fetchJson(std::string) override;
 
+private:
+    std::vector<char> get(const std::string& path) const;
+
+    std::unique_ptr<SlpkArchive> m_archive;
 };
 
 } // namespace pdal
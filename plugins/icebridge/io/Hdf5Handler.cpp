@@ -36,6 +36,8 @@
 #include <pdal/util/FileUtils.hpp>
 #include <pdal/pdal_types.hpp>
 
+#include <tuple>
+
 namespace pdal
 {
 
@@ -66,22 +68,24 @@ void Hdf5Handler::initialize(
         {
             const std::string dataSetName = col.name;
             const H5::PredType predType = col.predType;
-            const H5::DataSet dataSet = m_h5File->openDataSet(dataSetName);
-            const H5::DataSpace dataSpace = dataSet.getSpace();
 
-            m_columnDataMap.insert(std::make_pair(
-                        dataSetName,
-                        ColumnData(predType, dataSet, dataSpace)));
+            auto it = m_columnDataMap.emplace(std::piecewise_construct,
+                std::forward_as_tuple(dataSetName),
+                std::forward_as_tuple(predType, *m_h5File, dataSetName));
 
             // Does not check whether all the columns are the same length.
-            m_numPoints = (std::max)((uint64_t)getColumnNumEntries(dataSetName),
-                m_numPoints);
+            m_numPoints = (std::max)(
+                (uint64_t)it.first->second.column.numEntries(), m_numPoints);
         }
     }
     catch (const H5::Exception&)
     {
         throw error("Could not initialize data set information.");
     }
+    catch (const pdal_error& err)
+    {
+        throw error(err.what());
+    }
 }
 
 void Hdf5Handler::close()
@@ -104,20 +108,8 @@ void Hdf5Handler::getColumnEntries(
     {
         const ColumnData& columnData(getColumnData(dataSetName));
 
-        columnData.dataSpace.selectHyperslab(
-                H5S_SELECT_SET,
-                &numEntries,
-                &offset);
-
-        const hsize_t outOffset = 0;
-        const H5::DataSpace outSpace(1, &numEntries);
-        outSpace.selectHyperslab(H5S_SELECT_SET, &numEntries, &outOffset);
-
-        columnData.dataSet.read(
-                data,
-                columnData.predType,
-                outSpace,
-                columnData.dataSpace);
+        columnData.column.read(data, columnData.predType, offset,
+            numEntries);
     }
     catch (const H5::Exception&)
     {
@@ -125,16 +117,6 @@ void Hdf5Handler::getColumnEntries(
     }
 }
 
-hsize_t
-Hdf5Handler::getColumnNumEntries(const std::string& dataSetName) const
-{
-    hsize_t entries = 0;
-
-    getColumnData(dataSetName).dataSpace.getSimpleExtentDims(&entries);
-
-    return entries;
-}
-
 const Hdf5Handler::ColumnData&
 Hdf5Handler::getColumnData(const std::string& dataSetName) const
 {
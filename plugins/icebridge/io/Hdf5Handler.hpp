@@ -36,6 +36,7 @@
 
 #include <pdal/pdal_export.hpp>  // Suppresses windows 4251 messages
 #include "H5Cpp.h"
+#include <plugins/hdf/io/Hdf5Column.hpp>
 
 #include <memory>
 #include <vector>
@@ -89,25 +90,16 @@ private:
     {
         ColumnData(
                 H5::PredType predType,
-                H5::DataSet dataSet,
-                H5::DataSpace dataSpace)
+                H5::H5File& file,
+                const std::string& dataSetName)
             : predType(predType)
-            , dataSet(dataSet)
-            , dataSpace(dataSpace)
-        { }
-
-        ColumnData(H5::PredType predType)
-            : predType(predType)
-            , dataSet()
-            , dataSpace()
+            , column(file, dataSetName)
         { }
 
         H5::PredType predType;
-        H5::DataSet dataSet;
-        H5::DataSpace dataSpace;
+        hdf5::Column column;
     };
 
-    hsize_t getColumnNumEntries(const std::string& dataSetName) const;
     const ColumnData& getColumnData(const std::string& dataSetName) const;
 
     std::unique_ptr<H5::H5File> m_h5File;
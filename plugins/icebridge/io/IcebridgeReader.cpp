@@ -186,6 +186,7 @@ point_count_t IcebridgeReader::read(PointViewPtr view, point_count_t count)
             throwError(err.what());
         }
     }
+    m_index += count;
     return count;
 }
 
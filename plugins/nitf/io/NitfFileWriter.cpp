@@ -302,5 +302,16 @@ void NitfFileWriter::wrapData(const std::string& filename)
     m_source.reset(new nitf::SegmentFileSource(*m_inputHandle, 0, 0));
 }
 
+
+void NitfFileWriter::clearData()
+{
+    m_source.reset();
+    if (m_inputHandle)
+    {
+        m_inputHandle->close();
+        m_inputHandle.reset();
+    }
+}
+
 } // namespace pdal
 
@@ -76,6 +76,7 @@ public:
         { m_filename = filename; }
     void wrapData(const char *buf, size_t size);
     void wrapData(const std::string& filename);
+    void clearData();
     void addArgs(ProgramArgs& args);
     void setBounds(const BOX3D& bounds);
     void write();
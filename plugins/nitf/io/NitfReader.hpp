@@ -137,6 +137,12 @@ protected:
         m_streamIf.reset(new NitfStreamIf(m_filename, m_offset));
     }
 
+    virtual LasStreamIf *openStream()
+        { return new NitfStreamIf(m_filename, m_offset); }
+
+    virtual uint64_t fileOffset() const
+        { return m_offset; }
+
 private:
     uint64_t m_offset;
     uint64_t m_length;
@@ -39,6 +39,7 @@
 
 #include <pdal/GDALUtils.hpp>
 #include <pdal/PointView.hpp>
+#include <pdal/util/FileUtils.hpp>
 
 #ifndef IMPORT_NITRO_API
 #define IMPORT_NITRO_API
@@ -80,7 +81,7 @@ BOX3D NitfWriter::reprojectBoxToDD(const SpatialReference& reference,
 }
 
 
-NitfWriter::NitfWriter()
+NitfWriter::NitfWriter() : m_stream(false), m_tempStream(nullptr)
 {
     try
     {
@@ -93,10 +94,25 @@ NitfWriter::NitfWriter()
 }
 
 
+NitfWriter::~NitfWriter()
+{
+    // Remove the temporary file if writing stopped between readyFile()
+    // and doneFile().
+    try
+    {
+        cleanup();
+    }
+    catch (...)
+    {}
+}
+
+
 void NitfWriter::addArgs(ProgramArgs& args)
 {
     LasWriter::addArgs(args);
     m_nitf.addArgs(args);
+    args.add("stream", "Write the LAS segment to a temporary file beside "
+        "the output instead of holding it in memory", m_stream);
 }
 
 
@@ -112,31 +128,85 @@ void NitfWriter::readyFile(const std::string& filename,
     m_nitf.setFilename(filename);
 
     Utils::writeProgress(m_progressFd, "READYFILE", filename);
-    prepOutput(&m_oss, srs);
+    if (m_stream)
+    {
+        // The NITF header needs the segment length, so the LAS data is
+        // written to disk first and copied into the NITF file when done.
+        m_tempFilename = filename + ".las.tmp";
+        m_tempStream = FileUtils::createFile(m_tempFilename, true);
+        if (!m_tempStream)
+            throwError("Couldn't open temporary file '" + m_tempFilename +
+                "' for output.");
+        prepOutput(m_tempStream, srs);
+    }
+    else
+        prepOutput(&m_oss, srs);
 }
 
 
 void NitfWriter::doneFile()
 {
-    finishOutput();
+    // Release the LAS data and remove the temporary file however the
+    // write ends.
+    struct Guard
+    {
+        NitfWriter& m_writer;
+        ~Guard()
+        {
+            try
+            {
+                m_writer.cleanup();
+            }
+            catch (...)
+            {}
+        }
+    } guard { *this };
 
-    std::streambuf *buf = m_oss.rdbuf();
-    std::streamoff size = buf->pubseekoff(0, m_oss.end);
-    buf->pubseekoff(0, m_oss.beg);
+    finishOutput();
 
-    std::vector<char> bytes(size);
-    buf->sgetn(bytes.data(), size);
-    m_oss.clear();
-    m_nitf.wrapData(bytes.data(), size);
+    std::vector<char> bytes;
+    if (m_stream)
+    {
+        FileUtils::closeFile(m_tempStream);
+        m_tempStream = nullptr;
+        m_nitf.wrapData(m_tempFilename);
+    }
+    else
+    {
+        std::streambuf *buf = m_oss.rdbuf();
+        std::streamoff size = buf->pubseekoff(0, m_oss.end);
+        buf->pubseekoff(0, m_oss.beg);
+
+        bytes.resize(size);
+        buf->sgetn(bytes.data(), size);
+        m_oss.clear();
+        m_nitf.wrapData(bytes.data(), size);
+    }
     m_nitf.setBounds(reprojectBoxToDD(m_srs, m_lasHeader.getBounds()));
 
     try
     {
         m_nitf.write();
     }
-    catch (const NitfFileWriter::error& err)
+    catch (const NitfFileWriter::error& e)
     {
-        throwError(err.what());
+        throwError(e.what());
+    }
+}
+
+
+void NitfWriter::cleanup()
+{
+    m_nitf.clearData();
+    if (m_tempStream)
+    {
+        FileUtils::closeFile(m_tempStream);
+        m_tempStream = nullptr;
+    }
+    if (m_tempFilename.size())
+    {
+        FileUtils::deleteFile(m_tempFilename);
+        m_tempFilename.clear();
     }
 }
 
@@ -47,17 +47,22 @@ class PDAL_DLL NitfWriter : public LasWriter
 {
 public:
     NitfWriter();
+    ~NitfWriter();
     std::string getName() const;
 
 private:
     NitfFileWriter m_nitf;
     std::stringstream m_oss;
     BOX3D m_bounds;
+    bool m_stream;
+    std::string m_tempFilename;
+    std::ostream *m_tempStream;
 
     virtual void addArgs(ProgramArgs& args);
     virtual void readyFile(const std::string& filename,
         const SpatialReference& srs);
     virtual void doneFile();
+    void cleanup();
     virtual void writeView(const PointViewPtr view);
     BOX3D reprojectBoxToDD(const SpatialReference& reference, const BOX3D& box);
 
@@ -185,6 +185,57 @@ TEST(NitfWriterTest, test1)
     FileUtils::deleteFile(Support::temppath(nitf_output));
 }
 
+// Test that a NITF written through a temporary LAS file has the same
+// contents, and that the temporary file is removed whether or not the write
+// succeeds.
+TEST(NitfWriterTest, stream)
+{
+    StageFactory f;
+
+    const std::string las_input(Support::datapath("las/1.2-with-color.las"));
+    const std::string nitf_output(Support::temppath("temp_nitf_stream.ntf"));
+    const std::string temp_file(nitf_output + ".las.tmp");
+
+    FileUtils::deleteFile(nitf_output);
+
+    auto write = [&](const std::string& ftitle)
+    {
+        Options reader_opts;
+        reader_opts.add("filename", las_input);
+
+        Options writer_opts;
+        writer_opts.add("filename", nitf_output);
+        writer_opts.add("stream", true);
+        writer_opts.add("idatim", "20110516183337");
+        writer_opts.add("fsclas", "S");
+        writer_opts.add("ophone", "5155554628");
+        writer_opts.add("oname", "Howard Butler");
+        writer_opts.add("ftitle", ftitle);
+
+        Stage* reader(f.createStage("readers.las"));
+        reader->setOptions(reader_opts);
+
+        Stage* writer(f.createStage("writers.nitf"));
+        writer->setOptions(writer_opts);
+        writer->setInput(*reader);
+
+        PointTable table;
+        writer->prepare(table);
+        writer->execute(table);
+    };
+
+    write("LiDAR from somewhere");
+    EXPECT_FALSE(FileUtils::fileExists(temp_file));
+    compare_contents(las_input, nitf_output);
+    FileUtils::deleteFile(nitf_output);
+
+    // The title is too long for the FTITLE field, so the NITF write fails
+    // after the LAS data has been spooled.
+    EXPECT_THROW(write(std::string(100, 'a')), pdal_error);
+    EXPECT_FALSE(FileUtils::fileExists(temp_file));
+    FileUtils::deleteFile(nitf_output);
+}
+
 // Test that data from three input views gets written to separate output files.
 TEST(NitfWriterTest, flex)
 {
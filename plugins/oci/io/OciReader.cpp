@@ -63,6 +63,8 @@ void OciReader::addArgs(ProgramArgs& args)
     args.add("connection", "Connection string", m_connSpec);
     args.add("populate_pointsourceid", "Set point source ID",
         m_updatePointSourceId);
+    args.add("prefetch", "Number of block rows to prefetch with each "
+        "round trip to the database", m_prefetch, 16);
 }
 
 
@@ -78,12 +80,19 @@ void OciReader::initialize()
         throwError(err.what());
     }
     m_block = BlockPtr(new Block(m_connection));
+    m_current = BlockPtr(new Block(m_connection));
+    m_next = BlockPtr(new Block(m_connection));
+    m_nextSchema = nullptr;
 
     gdal::registerDrivers();
     if (m_query.empty())
         throwError("'query' statement is empty. No data can be read.");
 
+    if (m_prefetch < 1)
+        throwError("Option 'prefetch' must be at least 1.");
+
     m_stmt = Statement(m_connection->CreateStatement(m_query.c_str()));
+    m_stmt->SetPrefetch(m_prefetch);
     m_stmt->Execute(0);
 
     validateQuery();
@@ -252,23 +261,29 @@ point_count_t OciReader::read(PointViewPtr view, point_count_t count)
     point_count_t totalNumRead = 0;
     while (totalNumRead < count)
     {
-        if (m_block->numRemaining() == 0)
-            if (!readOci(m_stmt, m_block))
+        if (m_current->numRemaining() == 0)
+            if (!readOci())
                 return totalNumRead;
-        PointId bufBegin = view->size();
 
         point_count_t numRead = 0;
         if (orientation() == Orientation::DimensionMajor)
-            numRead = readDimMajor(*view, m_block, count - totalNumRead);
+            numRead = readDimMajor(*view, m_current, count - totalNumRead);
         else if (orientation() == Orientation::PointMajor)
-            numRead = readPointMajor(*view, m_block, count - totalNumRead);
-        PointId bufEnd = bufBegin + numRead;
+            numRead = readPointMajor(*view, m_current, count - totalNumRead);
         totalNumRead += numRead;
     }
     return totalNumRead;
 }
 
 
+void OciReader::done(PointTableRef table)
+{
+    // Don't leave a fetch running against the statement.
+    if (m_pending.valid())
+        m_pending.wait();
+}
+
+
 point_count_t OciReader::readDimMajor(PointView& view, BlockPtr block,
     point_count_t numPts)
 {
@@ -368,27 +383,58 @@ char *OciReader::seekPointMajor(BlockPtr block)
 }
 
 
-// Read a block (set of points) from the database.
-bool OciReader::readOci(Statement stmt, BlockPtr block)
+// Make the next block (set of points) from the database current.  The
+// following block is fetched in the background while this one is decoded.
+bool OciReader::readOci()
 {
-    if (!block->fetched())
+    if (!m_pending.valid())
+        startFetch();
+    if (!m_pending.get())
     {
-        if (!stmt->Fetch())
-        {
-            m_atEnd = true;
-            return false;
-        }
-        block->setFetched();
+        m_atEnd = true;
+        return false;
     }
-    // Read the points from the blob in the row.
-    readBlob(stmt, block);
-    XMLSchema *s = findSchema(stmt, block);
+    std::swap(m_current, m_next);
+
+    XMLSchema *s = m_nextSchema;
     updateSchema(*s);
     MetadataNode comp = s->getMetadata().findChild("compression");
     m_compression = (comp.value() == "lazperf");
+    m_current->reset();
 
-    block->reset();
-    block->clearFetched();
+    startFetch();
+    return true;
+}
+
+
+void OciReader::startFetch()
+{
+    BlockPtr dst = m_next;
+    m_pending = std::async(std::launch::async,
+        [this, dst](){ return fetchBlock(dst); });
+}
+
+
+// Fetch a row and read its blob into 'dst'.  All database access during
+// reading happens here, so only one thread talks to OCI at a time.
+bool OciReader::fetchBlock(BlockPtr dst)
+{
+    if (!m_block->fetched())
+    {
+        if (!m_stmt->Fetch())
+            return false;
+        m_block->setFetched();
+    }
+    // Read the points from the blob in the row.
+    readBlob(m_stmt, m_block);
+    m_nextSchema = findSchema(m_stmt, m_block);
+
+    // The defined columns are overwritten by the next fetch, so copy out
+    // what's needed to decode the block.
+    dst->chunk.swap(m_block->chunk);
+    dst->obj_id = m_block->obj_id;
+    dst->num_points = m_block->num_points;
+    m_block->clearFetched();
     return true;
 }
 
@@ -34,6 +34,7 @@
 
 #pragma once
 
+#include <future>
 #include <vector>
 
 #include <pdal/DbReader.hpp>
@@ -60,6 +61,7 @@ private:
     virtual void ready(PointTableRef table)
         { m_atEnd = false; }
     virtual point_count_t read(PointViewPtr view, point_count_t);
+    virtual void done(PointTableRef table);
     virtual bool eof()
         { return m_atEnd; }
 
@@ -75,12 +77,19 @@ private:
         point_count_t numPts);
     char *seekDimMajor(const DimType& d, BlockPtr block);
     char *seekPointMajor(BlockPtr block);
-    bool readOci(Statement stmt, BlockPtr block);
+    bool readOci();
+    void startFetch();
+    bool fetchBlock(BlockPtr dst);
     XMLSchema *findSchema(Statement stmt, BlockPtr block);
 
     Connection m_connection;
     Statement m_stmt;
-    BlockPtr m_block;
+    BlockPtr m_block;    // Target of the statement's column defines.
+    BlockPtr m_current;  // Block being decoded.
+    BlockPtr m_next;     // Block being fetched in the background.
+    XMLSchema *m_nextSchema;
+    std::future<bool> m_pending;
+    int m_prefetch;
     std::string m_query;
     std::string m_schemaFile;
     std::string m_connSpec;
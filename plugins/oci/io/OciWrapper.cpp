@@ -702,6 +702,29 @@ bool OWStatement::Fetch(int nRows)
 }
 
 
+bool OWStatement::SetPrefetch(int nRows, int nMemory)
+{
+    ub4 nPrefetchRows = (ub4) nRows;
+    ub4 nPrefetchMemory = (ub4) nMemory;
+
+    if (CheckError(OCIAttrSet((dvoid*) hStmt, (ub4) OCI_HTYPE_STMT,
+        (dvoid*) &nPrefetchRows, (ub4) 0,
+        (ub4) OCI_ATTR_PREFETCH_ROWS, hError), hError))
+    {
+        return false;
+    }
+
+    if (CheckError(OCIAttrSet((dvoid*) hStmt, (ub4) OCI_HTYPE_STMT,
+        (dvoid*) &nPrefetchMemory, (ub4) 0,
+        (ub4) OCI_ATTR_PREFETCH_MEMORY, hError), hError))
+    {
+        return false;
+    }
+
+    return true;
+}
+
+
 bool OWStatement::GetNextField(
     int nIndex,
     char* pszName,
@@ -405,6 +405,7 @@ public:
 
     bool                Execute( int nRows = 1 );
     bool                Fetch( int nRows = 1 );
+    bool                SetPrefetch( int nRows, int nMemory = 0 );
     unsigned int        nFetchCount;
 
     bool                GetNextField(
@@ -684,6 +684,7 @@ void OciWriter::done(PointTableRef table)
     if (!m_connection)
         return;
 
+    waitForInsert();
     m_connection->Commit();
     if (m_createIndex && m_bDidCreateBlockTable)
     {
@@ -807,6 +808,44 @@ void OciWriter::writeDimMajor(PointViewPtr view, std::vector<char>& outbuf)
 
 
 void OciWriter::writeTile(const PointViewPtr view)
+{
+    // Pack and compress this block while the previous one is being
+    // inserted.
+    Tile tile;
+    tile.m_blockId = ++m_lastBlockId;
+    tile.m_numPoints = static_cast<long>(view->size());
+
+    //NOTE: packed point size is guaranteed to be of sufficient size to hold
+    // a point's data, but it may be larger than the actual size of a point
+    // if location scaling is being used.
+    tile.m_data.resize(packedPointSize() * view->size());
+    if (m_orientation == Orientation::DimensionMajor)
+        writeDimMajor(view, tile.m_data);
+    else if (m_orientation == Orientation::PointMajor)
+        writePointMajor(view, tile.m_data);
+
+    calculateBounds(*view, tile.m_bounds);
+    // Cumulate a total bounds for the file.
+    m_pcExtent.grow(tile.m_bounds);
+
+    waitForInsert();
+    std::swap(m_tile, tile);
+    m_pending = std::async(std::launch::async,
+        [this](){ insertTile(m_tile); });
+}
+
+
+void OciWriter::waitForInsert()
+{
+    // get() rethrows any error raised by the insert.
+    if (m_pending.valid())
+        m_pending.get();
+}
+
+
+// All database access while writing blocks happens here, so only one
+// thread talks to OCI at a time.
+void OciWriter::insertTile(Tile& tile)
 {
     bool usePartition = (m_blockTablePartitionColumn.size() != 0);
 
@@ -830,30 +869,17 @@ void OciWriter::writeTile(const PointViewPtr view)
     log()->get(LogLevel::Debug4) << "Block obj_id " << m_pc_id << std::endl;
 
     // :2
-    statement->Bind(&m_lastBlockId);
-    m_lastBlockId++;
+    statement->Bind(&tile.m_blockId);
     log()->get(LogLevel::Debug4) << "Last BlockId " <<
-        m_lastBlockId << std::endl;
+        tile.m_blockId << std::endl;
 
     // :3
-    long long_num_points = static_cast<long>(view->size());
-    statement->Bind(&long_num_points);
+    statement->Bind(&tile.m_numPoints);
     log()->get(LogLevel::Debug4) << "Num points " <<
-        long_num_points << std::endl;
+        tile.m_numPoints << std::endl;
 
     // :4
-
-    //NOTE: packed point size is guaranteed to be of sufficient size to hold
-    // a point's data, but it may be larger than the actual size of a point
-    // if location scaling is being used.
-    std::vector<char> outbuf(packedPointSize() * view->size());
-    size_t totalSize = 0;
-    if (m_orientation == Orientation::DimensionMajor)
-        writeDimMajor(view, outbuf);
-    else if (m_orientation == Orientation::PointMajor)
-        writePointMajor(view, outbuf);
-
-
+    std::vector<char>& outbuf = tile.m_data;
     log()->get(LogLevel::Debug4) << "Blob size " << outbuf.size() << std::endl;
     OCILobLocator* locator;
     if (m_streamChunks)
@@ -890,14 +916,9 @@ void OciWriter::writeTile(const PointViewPtr view)
     OCIArray* sdo_ordinates = 0;
     m_connection->CreateType(&sdo_ordinates, m_connection->GetOrdinateType());
 
-    BOX3D bounds;
-    calculateBounds(*view, bounds);
-    // Cumulate a total bounds for the file.
-    m_pcExtent.grow(bounds);
-
-    setOrdinates(statement, sdo_ordinates, bounds);
+    setOrdinates(statement, sdo_ordinates, tile.m_bounds);
     statement->Bind(&sdo_ordinates, m_connection->GetOrdinateType());
-    log()->get(LogLevel::Debug4) << "Bounds " << bounds << std::endl;
+    log()->get(LogLevel::Debug4) << "Bounds " << tile.m_bounds << std::endl;
 
     // :9
     if (usePartition)
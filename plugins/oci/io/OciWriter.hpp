@@ -34,6 +34,8 @@
 
 #pragma once
 
+#include <future>
+
 #include <pdal/DbWriter.hpp>
 
 pdal::Writer* createOciWriter();
@@ -45,6 +47,15 @@ namespace pdal
 
 class PDAL_DLL OciWriter : public DbWriter
 {
+    // Packed block waiting to be inserted into the block table.
+    struct Tile
+    {
+        long m_blockId;
+        long m_numPoints;
+        BOX3D m_bounds;
+        std::vector<char> m_data;
+    };
+
 public:
     OciWriter();
     std::string getName() const;
@@ -57,6 +68,8 @@ private:
     virtual void done(PointTableRef table);
     void writeInit();
     void writeTile(const PointViewPtr view);
+    void insertTile(Tile& tile);
+    void waitForInsert();
 
     void runCommand(std::ostringstream const& command);
     void wipeBlockTable();
@@ -121,6 +134,8 @@ private:
     std::string m_preSql;
     std::string m_postBlockSql;
     double m_tolerance;
+    Tile m_tile;
+    std::future<void> m_pending;
 
     OciWriter& operator=(const OciWriter&); // not implemented
     OciWriter(const OciWriter&); // not implemented
@@ -36,8 +36,10 @@
 #include "PgReader.hpp"
 #include <pdal/PointView.hpp>
 #include <pdal/XMLSchema.hpp>
+#include <pdal/util/portable_endian.hpp>
 #include <pdal/util/ProgramArgs.hpp>
 
+#include <cstring>
 #include <iostream>
 
 namespace pdal
@@ -55,13 +57,15 @@ CREATE_SHARED_STAGE(PgReader, s_info)
 
 std::string PgReader::getName() const { return s_info.name; }
 
-PgReader::PgReader() : m_session(NULL), m_pcid(0), m_cached_point_count(0),
-    m_cached_max_points(0)
+PgReader::PgReader() : m_session(NULL), m_fetchSize(100), m_pcid(0),
+    m_cached_point_count(0), m_cached_max_points(0), m_atEnd(false),
+    m_fetchDone(false), m_stopFetch(false)
 {}
 
 
 PgReader::~PgReader()
 {
+    stopFetching();
     //ABELL - Do bad things happen if we don't do this?  Already in done().
     if (m_session)
         PQfinish(m_session);
@@ -75,6 +79,8 @@ void PgReader::addArgs(ProgramArgs& args)
     args.add("column", "Column name", m_column_name, "pa");
     args.add("schema", "Schema name", m_schema_name);
     args.add("where", "Where clause for selection", m_where);
+    args.add("fetch_size", "Number of patches fetched from the database "
+        "at once", m_fetchSize, 100);
 }
 
 
@@ -108,9 +114,11 @@ point_count_t PgReader::getNumPoints() const
 
 std::string PgReader::getDataQuery() const
 {
+    // The patch is decoded from hex on the server so that it can be
+    // fetched in binary form.
     std::ostringstream oss;
-    oss << "SELECT text(PC_Uncompress(" << pg_quote_identifier(m_column_name) <<
-        ")) AS pa, ";
+    oss << "SELECT decode(text(PC_Uncompress(" <<
+        pg_quote_identifier(m_column_name) << ")), 'hex') AS pa, ";
     oss << "PC_NumPoints(" << pg_quote_identifier(m_column_name) <<
         ") AS npoints FROM ";
     if (!m_schema_name.empty())
@@ -228,26 +236,27 @@ pdal::SpatialReference PgReader::fetchSpatialReference() const
 void PgReader::ready(PointTableRef /*table*/)
 {
     m_atEnd = false;
-    m_cur_row = 0;
-    m_cur_nrows = 0;
-    m_cur_result = NULL;
+    m_patch = Patch();
 
     CursorSetup();
+    startFetching();
 }
 
 
 void PgReader::done(PointTableRef /*table*/)
 {
+    stopFetching();
     CursorTeardown();
     if (m_session)
         PQfinish(m_session);
     m_session = NULL;
-    if (m_cur_result)
-        PQclear(m_cur_result);
 }
 
 void PgReader::initialize()
 {
+    if (m_fetchSize < 1)
+        throwError("Option 'fetch_size' must be at least 1.");
+
     // First thing we do, is set up a connection
     if (!m_session)
         m_session = pg_connect(m_connection);
@@ -260,7 +269,7 @@ void PgReader::initialize()
 void PgReader::CursorSetup()
 {
     std::ostringstream oss;
-    oss << "DECLARE cur CURSOR FOR " << getDataQuery();
+    oss << "DECLARE cur BINARY CURSOR FOR " << getDataQuery();
     pg_begin(m_session);
     pg_execute(m_session, oss.str());
 
@@ -284,7 +293,7 @@ point_count_t PgReader::readPgPatch(PointViewPtr view, point_count_t numPts)
     point_count_t numRead = 0;
 
     size_t offset = (m_patch.count - m_patch.remaining) * packedPointSize();
-    char *pos = (char *)(m_patch.binary.data() + offset);
+    const char *pos = m_patch.binary.data() + offset;
 
     while (numRead < numPts && numRemaining > 0)
     {
@@ -299,35 +308,124 @@ point_count_t PgReader::readPgPatch(PointViewPtr view, point_count_t numPts)
 }
 
 
+void PgReader::startFetching()
+{
+    m_patches.clear();
+    m_fetchDone = false;
+    m_stopFetch = false;
+    m_fetchError.clear();
+    m_fetcher = std::thread(&PgReader::fetch, this);
+    log()->get(LogLevel::Debug) << "Fetching " << m_fetchSize <<
+        " patches at a time." << std::endl;
+}
+
+
+void PgReader::stopFetching()
+{
+    if (!m_fetcher.joinable())
+        return;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopFetch = true;
+    }
+    m_patchTaken.notify_all();
+    m_fetcher.join();
+    m_patches.clear();
+}
+
+
+// Add a patch to the queue, waiting while two fetches worth of patches
+// are waiting to be read.
+bool PgReader::queuePatch(Patch& patch)
+{
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_patchTaken.wait(lock, [this]()
+            { return m_patches.size() < 2 * (size_t)m_fetchSize ||
+                m_stopFetch; });
+        if (m_stopFetch)
+            return false;
+        m_patches.push_back(std::move(patch));
+    }
+    m_patchReady.notify_one();
+    return true;
+}
+
+
+// Fetch patches from the cursor while points are being read from those
+// already fetched.  The cursor is binary, so the patch is raw bytes and
+// the point count is a big-endian integer.
+void PgReader::fetch()
+{
+    const std::string sql = "FETCH " + std::to_string(m_fetchSize) +
+        " FROM cur";
+    try
+    {
+        int rows;
+        do
+        {
+            PGresult *result = pg_query_result(m_session, sql);
+            rows = PQntuples(result);
+            for (int row = 0; row < rows; ++row)
+            {
+                Patch patch;
+                uint32_t count;
+                std::memcpy(&count, PQgetvalue(result, row, 1), sizeof(count));
+                patch.count = be32toh(count);
+                patch.remaining = patch.count;
+
+                const char *data = PQgetvalue(result, row, 0);
+                size_t size = PQgetlength(result, row, 0);
+                if (size < Patch::header)
+                {
+                    PQclear(result);
+                    throw pdal_error("Invalid patch fetched from database.");
+                }
+                patch.binary.assign(data + Patch::header, data + size);
+                if (!queuePatch(patch))
+                {
+                    rows = 0;
+                    break;
+                }
+            }
+            PQclear(result);
+        } while (rows == m_fetchSize);
+    }
+    catch (const pdal_error& err)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_fetchError = err.what();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_fetchDone = true;
+    }
+    m_patchReady.notify_all();
+}
+
+
 bool PgReader::NextBuffer()
 {
-    if (m_cur_row >= m_cur_nrows || !m_cur_result)
     {
-        static std::string fetch = "FETCH 2 FROM cur";
-        if (m_cur_result)
-            PQclear(m_cur_result);
-        m_cur_result = pg_query_result(m_session, fetch);
-        bool logOutput = (log()->getLevel() > LogLevel::Debug3);
-        if (logOutput)
-            log()->get(LogLevel::Debug3) << "SQL: " << fetch << std::endl;
-        if ((PQresultStatus(m_cur_result) != PGRES_TUPLES_OK) ||
-            (PQntuples(m_cur_result) == 0))
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_patchReady.wait(lock, [this]()
+            { return m_patches.size() || m_fetchDone; });
+        if (m_patches.empty())
         {
-            PQclear(m_cur_result);
-            m_cur_result = NULL;
+            if (m_fetchError.size())
+                throwError(m_fetchError);
             m_atEnd = true;
             return false;
         }
-
-        m_cur_row = 0;
-        m_cur_nrows = PQntuples(m_cur_result);
+        m_patch = std::move(m_patches.front());
+        m_patches.pop_front();
     }
-    m_patch.hex = PQgetvalue(m_cur_result, m_cur_row, 0);
-    m_patch.count = atoi(PQgetvalue(m_cur_result, m_cur_row, 1));
-    m_patch.remaining = m_patch.count;
-    m_patch.update_binary();
+    m_patchTaken.notify_one();
 
-    m_cur_row++;
+    if (m_patch.binary.size() < m_patch.count * packedPointSize())
+        throwError("Patch data is smaller than expected for " +
+            std::to_string(m_patch.count) + " points.");
     return true;
 }
 
@@ -347,12 +445,23 @@ point_count_t PgReader::read(PointViewPtr view, point_count_t count)
         if (m_patch.remaining == 0)
             if (!NextBuffer())
                 return totalNumRead;
-        PointId bufBegin = view->size();
         point_count_t numRead = readPgPatch(view, count - totalNumRead);
-        PointId bufEnd = bufBegin + numRead;
         totalNumRead += numRead;
     }
     return totalNumRead;
 }
 
+
+bool PgReader::processOne(PointRef& point)
+{
+    if (m_patch.remaining == 0)
+        if (!NextBuffer())
+            return false;
+
+    size_t offset = (m_patch.count - m_patch.remaining) * packedPointSize();
+    writePoint(point, m_patch.binary.data() + offset);
+    m_patch.remaining--;
+    return true;
+}
+
 } // pdal
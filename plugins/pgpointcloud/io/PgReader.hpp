@@ -37,16 +37,21 @@
 #include <pdal/DbReader.hpp>
 #include <pdal/PointView.hpp>
 #include <pdal/StageFactory.hpp>
+#include <pdal/Streamable.hpp>
 #include <pdal/XMLSchema.hpp>
 
 #include "PgCommon.hpp"
 
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 namespace pdal
 {
 
-class PDAL_DLL PgReader : public DbReader
+class PDAL_DLL PgReader : public DbReader, public Streamable
 {
     class Patch
     {
@@ -56,29 +61,10 @@ class PDAL_DLL PgReader : public DbReader
 
         point_count_t count;
         point_count_t remaining;
-        std::string hex;
 
-        std::vector<uint8_t> binary;
-        static const uint32_t trim = 26;
-
-#define _base(x) ((x >= '0' && x <= '9') ? '0' : \
-             (x >= 'a' && x <= 'f') ? 'a' - 10 : \
-             (x >= 'A' && x <= 'F') ? 'A' - 10 : \
-                '\255')
-#define HEXOF(x) (x - _base(x))
-
-        inline void update_binary()
-        {
-            // http://stackoverflow.com/questions/8197838/convert-a-long-hex-string-in-to-int-array-with-sscanf
-            binary.resize((hex.size() - trim)/2);
-
-            char const* source = hex.c_str() + trim;
-            char const* p = 0;
-
-            for (p = source; p && *p; p += 2)
-                binary[(p - source) >> 1] =
-                    ((HEXOF(*p)) << 4) + HEXOF(*(p + 1));
-        }
+        // Point data of an uncompressed patch, without the WKB header.
+        std::vector<char> binary;
+        static const size_t header = 13;
     };
 
 public:
@@ -100,6 +86,7 @@ private:
     virtual void ready(PointTableRef table);
     virtual void initialize();
     virtual point_count_t read(PointViewPtr view, point_count_t count);
+    virtual bool processOne(PointRef& point);
     virtual void done(PointTableRef table);
     virtual bool eof()
         { return m_atEnd; }
@@ -113,22 +100,35 @@ private:
     void CursorTeardown();
     bool NextBuffer();
 
+    // Patches are fetched from the cursor on a separate thread.
+    void startFetching();
+    void stopFetching();
+    void fetch();
+    bool queuePatch(Patch& patch);
+
     PGconn* m_session;
     std::string m_connection;
     std::string m_table_name;
     std::string m_schema_name;
     std::string m_column_name;
     std::string m_where;
+    int m_fetchSize;
     mutable uint32_t m_pcid;
     mutable point_count_t m_cached_point_count;
     mutable point_count_t m_cached_max_points;
 
     bool m_atEnd;
-    uint32_t m_cur_row;
-    uint32_t m_cur_nrows;
-    PGresult* m_cur_result;
     Patch m_patch;
 
+    std::thread m_fetcher;
+    std::deque<Patch> m_patches;
+    std::mutex m_mutex;
+    std::condition_variable m_patchReady;
+    std::condition_variable m_patchTaken;
+    bool m_fetchDone;
+    bool m_stopFetch;
+    std::string m_fetchError;
+
     PgReader& operator=(const PgReader&); // not implemented
     PgReader(const PgReader&); // not implemented
 };
@@ -35,6 +35,8 @@
 
 #include "PgWriter.hpp"
 
+#include <cstring>
+
 #include <pdal/PointView.hpp>
 #include <pdal/XMLSchema.hpp>
 #include <pdal/util/FileUtils.hpp>
@@ -55,9 +57,28 @@ CREATE_SHARED_STAGE(PgWriter, s_info)
 
 std::string PgWriter::getName() const { return s_info.name; }
 
+namespace
+{
+
+// Size at which a batch of COPY rows is handed to a sending thread.
+const size_t CopyBatchSize = 4 * 1024 * 1024;
+
+// Batches that may wait to be sent, per connection.
+const size_t QueuedBatches = 2;
+
+void appendHex(std::string& out, const char *buf, size_t size)
+{
+    static const char syms[] = "0123456789ABCDEF";
+    for (size_t i = 0; i != size; i++)
+    {
+        out.push_back(syms[((buf[i] >> 4) & 0xf)]);
+        out.push_back(syms[buf[i] & 0xf]);
+    }
+}
+
+} // unnamed namespace
+
 // TO DO:
-// - change INSERT into COPY
-//
 // - PCID / Schema consistency. If a PCID is specified,
 // must it be consistent with the buffer schema? Or should
 // the writer shove the data into the database schema as best
@@ -73,12 +94,18 @@ PgWriter::PgWriter()
     , m_srid(0)
     , m_pcid(0)
     , m_overwrite(true)
+    , m_copy(true)
+    , m_connections(1)
     , m_schema_is_initialized(false)
+    , m_copyDone(false)
 {}
 
 
 PgWriter::~PgWriter()
 {
+    finishCopy();
+    for (PGconn *session : m_copySessions)
+        PQfinish(session);
     if (m_session)
         PQfinish(m_session);
 }
@@ -98,11 +125,19 @@ void PgWriter::addArgs(ProgramArgs& args)
     args.add("pcid", "PCID", m_pcid);
     args.add("pre_sql", "SQL to execute before query", m_pre_sql);
     args.add("post_sql", "SQL to execute after query", m_post_sql);
+    args.add("copy", "Load patches with COPY rather than INSERT", m_copy,
+        true);
+    args.add("connections", "Number of connections used to load patches "
+        "with COPY", m_connections, 1);
 }
 
 
 void PgWriter::initialize()
 {
+    if (m_connections < 1)
+        throwError("Option 'connections' must be at least 1.");
+    if (m_connections > 1 && !m_copy)
+        throwError("Option 'connections' requires 'copy'.");
     m_patch_compression_type = getCompressionType(m_compressionSpec);
     m_session = pg_connect(m_connection);
 }
@@ -150,12 +185,25 @@ void PgWriter::writeInit()
     }
 
     m_schema_is_initialized = true;
+
+    if (m_copy)
+        startCopy();
 }
 
 void PgWriter::write(const PointViewPtr view)
 {
     writeInit();
-    writeTile(view);
+    if (!m_copy)
+    {
+        writeTile(view);
+        return;
+    }
+
+    // Each patch is a row of hex-encoded WKB.
+    appendPatch(*view, m_batch);
+    m_batch.push_back('\n');
+    if (m_batch.size() >= CopyBatchSize)
+        queueBatch();
 }
 
 
@@ -163,6 +211,20 @@ void PgWriter::done(PointTableRef /*table*/)
 {
     //CreateIndex(m_schema_name, m_table_name, m_column_name);
 
+    if (m_senders.size())
+    {
+        if (m_batch.size())
+            queueBatch();
+        finishCopy();
+        if (m_copyError.size())
+            throwError(m_copyError);
+
+        // Loading on the other connections is committed only once all
+        // connections have finished without error.
+        for (PGconn *session : m_copySessions)
+            pg_commit(session);
+    }
+
     if (m_post_sql.size())
     {
         std::string sql = FileUtils::readFileIntoString(m_post_sql);
@@ -412,73 +474,181 @@ void PgWriter::CreateIndex(std::string const& schema_name,
 }
 
 
-void PgWriter::writeTile(const PointViewPtr view)
+std::string PgWriter::qualifiedTableName() const
 {
-    std::vector<char> storage(packedPointSize());
-    std::string hexrep;
-    size_t maxHexrepSize = packedPointSize() * view->size() * 2;
-    hexrep.reserve(maxHexrepSize);
+    std::string name;
+    if (m_schema_name.size())
+        name = pg_quote_identifier(m_schema_name) + ".";
+    return name + pg_quote_identifier(m_table_name);
+}
+
+
+// Append a patch of the view's points as hex-encoded WKB.
+void PgWriter::appendPatch(const PointView& view, std::string& out)
+{
+    if (view.size() > (std::numeric_limits<uint32_t>::max)())
+        throwError("Too many points for tile.");
+
+    /* We are always getting uncompressed bytes off the block_data */
+    /* so we always used compression type 0 (uncompressed) in writing */
+    /* our WKB.  Values are in machine byte order, as noted by the */
+    /* first byte. */
+    char header[13];
+#if BYTE_ORDER == LITTLE_ENDIAN
+    header[0] = 1;
+#elif BYTE_ORDER == BIG_ENDIAN
+    header[0] = 0;
+#endif
+    uint32_t pcid = m_pcid;
+    uint32_t compression = static_cast<uint32_t>(CompressionType::None);
+    uint32_t num_points = static_cast<uint32_t>(view.size());
+    std::memcpy(header + 1, &pcid, 4);
+    std::memcpy(header + 5, &compression, 4);
+    std::memcpy(header + 9, &num_points, 4);
 
-    m_insert.clear();
-    m_insert.reserve(maxHexrepSize + 3000);
+    out.reserve(out.size() +
+        (sizeof(header) + packedPointSize() * view.size()) * 2);
+    appendHex(out, header, sizeof(header));
 
-    for (PointId idx = 0; idx < view->size(); ++idx)
+    std::vector<char> storage(packedPointSize());
+    for (PointId idx = 0; idx < view.size(); ++idx)
     {
-        size_t size = readPoint(*view.get(), idx, storage.data());
+        size_t size = readPoint(view, idx, storage.data());
+        appendHex(out, storage.data(), size);
+    }
+}
+
+
+void PgWriter::writeTile(const PointViewPtr view)
+{
+    m_insert = "INSERT INTO " + qualifiedTableName() + " (" +
+        pg_quote_identifier(m_column_name) + ") VALUES ('";
+    appendPatch(*view, m_insert);
+    m_insert.append("')");
 
-        /* We are always getting uncompressed bytes off the block_data */
-        /* so we always used compression type 0 (uncompressed) in writing */
-        /* our WKB */
-        static char syms[] = "0123456789ABCDEF";
-        for (size_t i = 0; i != size; i++)
+    pg_execute(m_session, m_insert);
+}
+
+
+// Start a thread for each connection to send rows with COPY.  Rows
+// are only ordered when there is a single connection.
+void PgWriter::startCopy()
+{
+    std::vector<PGconn*> sessions { m_session };
+    if (m_connections > 1)
+    {
+        // Other connections can't see the table until its creation is
+        // committed.
+        pg_commit(m_session);
+        pg_begin(m_session);
+        for (int i = 1; i < m_connections; ++i)
         {
-            hexrep.push_back(syms[((storage[i] >> 4) & 0xf)]);
-            hexrep.push_back(syms[storage[i] & 0xf]);
+            m_copySessions.push_back(pg_connect(m_connection));
+            pg_begin(m_copySessions.back());
+            sessions.push_back(m_copySessions.back());
         }
     }
 
-    std::string insert_into("INSERT INTO ");
-    std::string values(" (" + pg_quote_identifier(m_column_name) +
-                       ") VALUES ('");
+    m_copyDone = false;
+    m_copyError.clear();
+    for (PGconn *session : sessions)
+        m_senders.emplace_back(&PgWriter::copy, this, session);
+}
 
-    m_insert.append(insert_into);
 
-    if (m_schema_name.size())
+// Hand the current batch to the sending threads, waiting if too many
+// batches are already waiting to be sent.
+void PgWriter::queueBatch()
+{
+    bool failed;
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_batchTaken.wait(lock, [this]()
+            { return m_batches.size() < QueuedBatches * m_senders.size() ||
+                m_copyError.size(); });
+        failed = m_copyError.size();
+        if (!failed)
+        {
+            m_batches.push_back(std::move(m_batch));
+            m_batch.clear();
+        }
+    }
+    if (failed)
     {
-        m_insert.append(pg_quote_identifier(m_schema_name));
-        m_insert.append(".");
+        finishCopy();
+        throwError(m_copyError);
     }
+    m_batchReady.notify_one();
+}
 
-    m_insert.append(pg_quote_identifier(m_table_name));
-    m_insert.append(values);
 
-    std::ostringstream options;
+// Let the sending threads finish sending queued batches and wait for them.
+void PgWriter::finishCopy()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_copyDone = true;
+    }
+    m_batchReady.notify_all();
+    for (std::thread& t : m_senders)
+        t.join();
+    m_senders.clear();
+}
 
-    if (view->size() > (std::numeric_limits<uint32_t>::max)())
-        throwError("Too many points for tile.");
-    uint32_t num_points = htobe32(static_cast<uint32_t>(view->size()));
-    int32_t pcid = htobe32(m_pcid);
-    CompressionType compression_v = CompressionType::None;
-    uint32_t compression = htobe32(static_cast<uint32_t>(compression_v));
 
-#if BYTE_ORDER == LITTLE_ENDIAN
-    options << "01";
-#elif BYTE_ORDER == BIG_ENDIAN
-    options << "00";
-#endif
+void PgWriter::copy(PGconn *session)
+{
+    try
+    {
+        std::string sql = "COPY " + qualifiedTableName() + " (" +
+            pg_quote_identifier(m_column_name) + ") FROM STDIN";
+        PGresult *result = PQexec(session, sql.c_str());
+        bool ok = (result && PQresultStatus(result) == PGRES_COPY_IN);
+        PQclear(result);
+        if (!ok)
+            throw pdal_error(PQerrorMessage(session));
 
-    // needs to be 4 bytes
-    options << std::hex << std::setfill('0') << std::setw(8) << pcid;
-    // needs to be 4 bytes
-    options << std::hex << std::setfill('0') << std::setw(8) << compression;
-    // needs to be 4 bytes
-    options << std::hex << std::setfill('0') << std::setw(8) << num_points;
+        while (true)
+        {
+            std::string batch;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_batchReady.wait(lock, [this]()
+                    { return m_batches.size() || m_copyDone; });
+                if (m_batches.empty())
+                    break;
+                batch = std::move(m_batches.front());
+                m_batches.pop_front();
+            }
+            m_batchTaken.notify_one();
 
-    m_insert.append(options.str());
-    m_insert.append(hexrep);
-    m_insert.append("')");
+            if (batch.size() > (size_t)(std::numeric_limits<int>::max)())
+                throw pdal_error("Patch too large to load with COPY.");
+            if (PQputCopyData(session, batch.data(), (int)batch.size()) != 1)
+                throw pdal_error(PQerrorMessage(session));
+        }
 
-    pg_execute(m_session, m_insert);
+        if (PQputCopyEnd(session, nullptr) != 1)
+            throw pdal_error(PQerrorMessage(session));
+        std::string err;
+        while ((result = PQgetResult(session)))
+        {
+            if (PQresultStatus(result) != PGRES_COMMAND_OK && err.empty())
+                err = PQresultErrorMessage(result);
+            PQclear(result);
+        }
+        if (err.size())
+            throw pdal_error(err);
+    }
+    catch (const pdal_error& err)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_copyError.empty())
+                m_copyError = err.what();
+        }
+        m_batchTaken.notify_all();
+    }
 }
 
 } // namespace pdal
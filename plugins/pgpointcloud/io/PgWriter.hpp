@@ -35,6 +35,11 @@
 
 #pragma once
 
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
 #include <pdal/DbWriter.hpp>
 #include <pdal/StageFactory.hpp>
 #include "PgCommon.hpp"
@@ -60,6 +65,13 @@ private:
 
     void writeInit();
     void writeTile(const PointViewPtr view);
+    void appendPatch(const PointView& view, std::string& out);
+    std::string qualifiedTableName() const;
+
+    void startCopy();
+    void queueBatch();
+    void finishCopy();
+    void copy(PGconn* session);
 
     bool CheckTableExists(std::string const& name);
     bool CheckPointCloudExists();
@@ -93,12 +105,26 @@ private:
     uint32_t m_pcid;
     bool m_overwrite;
     std::string m_insert;
+    bool m_copy;
+    int m_connections;
     Orientation m_orientation;
     std::string m_pre_sql;
     std::string m_post_sql;
 
     // lose this
     bool m_schema_is_initialized;
+
+    // COPY loading.  Patches are gathered into batches of rows that are
+    // sent by a thread for each connection.
+    std::vector<PGconn*> m_copySessions;
+    std::vector<std::thread> m_senders;
+    std::deque<std::string> m_batches;
+    std::string m_batch;
+    std::mutex m_mutex;
+    std::condition_variable m_batchReady;
+    std::condition_variable m_batchTaken;
+    bool m_copyDone;
+    std::string m_copyError;
 };
 
 } // namespace pdal
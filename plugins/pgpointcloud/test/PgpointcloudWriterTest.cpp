@@ -36,6 +36,7 @@
 
 #include <pdal/Writer.hpp>
 #include <pdal/StageFactory.hpp>
+#include <filters/StreamCallbackFilter.hpp>
 #include <pdal/util/Algorithm.hpp>
 
 #include "Support.hpp"
@@ -136,6 +137,11 @@ protected:
         pg_execute(m_testConnection, sql);
     }
 
+    std::string queryTestDb(const std::string& sql)
+    {
+        return pg_query_once(m_testConnection, sql);
+    }
+
     virtual void TearDown()
     {
         if (!m_testConnection || !m_masterConnection) return;
@@ -365,3 +371,91 @@ TEST_F(PgpointcloudWriterTest, selectExistingSchema)
     EXPECT_TRUE(srs.valid());
     EXPECT_EQ(std::string("25832"), srs.identifyHorizontalEPSG());
 }
+
+TEST_F(PgpointcloudWriterTest, writeConnections)
+{
+    if (shouldSkipTests())
+    {
+        return;
+    }
+
+    auto check = [this](const Options& writerOps)
+    {
+        StageFactory f;
+        Stage* reader(f.createStage("readers.las"));
+        Options options;
+        options.add("filename", Support::datapath("las/1.2-with-color.las"));
+        reader->setOptions(options);
+
+        Stage* chipper(f.createStage("filters.chipper"));
+        Options chipperOps;
+        chipperOps.add("capacity", 100);
+        chipper->setOptions(chipperOps);
+        chipper->setInput(*reader);
+
+        Stage* writer(f.createStage("writers.pgpointcloud"));
+        writer->setOptions(writerOps);
+        writer->setInput(*chipper);
+
+        PointTable table;
+        writer->prepare(table);
+        writer->execute(table);
+
+        const std::string name("\"4dal-\"\"test\"\"-table\"");
+        EXPECT_EQ(queryTestDb("SELECT Sum(PC_NumPoints(pa)) FROM " + name),
+            "1065");
+        EXPECT_GT(std::stoi(queryTestDb("SELECT Count(*) FROM " + name)), 1);
+    };
+
+    Options ops = getDbOptions();
+    ops.add("overwrite", true);
+    ops.add("connections", 3);
+    check(ops);
+
+    ops = getDbOptions();
+    ops.add("overwrite", true);
+    ops.add("copy", false);
+    check(ops);
+}
+
+TEST_F(PgpointcloudWriterTest, readStream)
+{
+    if (shouldSkipTests())
+    {
+        return;
+    }
+
+    optionsWrite(getDbOptions());
+
+    StageFactory factory;
+    Stage* reader(factory.createStage("readers.pgpointcloud"));
+    Options rops = getDbOptions();
+    rops.add("fetch_size", 1);
+    reader->setOptions(rops);
+
+    PointTable table;
+    reader->prepare(table);
+    PointViewSet views = reader->execute(table);
+    PointViewPtr view = *views.begin();
+    EXPECT_EQ(view->size(), 1065U);
+
+    Stage* streamReader(factory.createStage("readers.pgpointcloud"));
+    streamReader->setOptions(rops);
+
+    FixedPointTable streamTable(100);
+    PointId idx = 0;
+    StreamCallbackFilter f;
+    f.setCallback([&view, &idx](PointRef& point)
+    {
+        EXPECT_EQ(point.getFieldAs<double>(Dimension::Id::X),
+            view->getFieldAs<double>(Dimension::Id::X, idx));
+        EXPECT_EQ(point.getFieldAs<int>(Dimension::Id::Red),
+            view->getFieldAs<int>(Dimension::Id::Red, idx));
+        idx++;
+        return true;
+    });
+    f.setInput(*streamReader);
+    f.prepare(streamTable);
+    f.execute(streamTable);
+    EXPECT_EQ(idx, 1065U);
+}
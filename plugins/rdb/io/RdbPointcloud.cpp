@@ -32,8 +32,10 @@
 * OF SUCH DAMAGE.
  ****************************************************************************/
 
+#include <algorithm>
 #include <sstream>
 #include <array>
+#include <limits>
 #include <nlohmann/json.hpp>
 #include "RdbPointcloud.hpp"
 
@@ -48,12 +50,17 @@ RdbPointcloud::AttributeBuffer::AttributeBuffer(
     const pdal::Dimension::Id   id,
     const pdal::Dimension::Type type,
     const std::string           name,
+    const std::string           attribute,
+    const riegl::rdb::pointcloud::DataType attributeType,
     const size_t                size
 ):
     id  (id),
     type(type),
     name(name),
+    attribute(attribute),
+    attributeType(attributeType),
     data(), // see resize()
+    next(), // see resize()
     m_typeSize(typeSize(type))
 {
     resize(size);
@@ -63,6 +70,7 @@ RdbPointcloud::AttributeBuffer::AttributeBuffer(
 void RdbPointcloud::AttributeBuffer::resize(const size_t size)
 {
     data.resize(m_typeSize * size);
+    next.resize(m_typeSize * size);
 }
 
 
@@ -72,6 +80,25 @@ void* RdbPointcloud::AttributeBuffer::at(const size_t index)
 }
 
 
+void* RdbPointcloud::AttributeBuffer::nextAt(const size_t index)
+{
+    return &next[m_typeSize * index];
+}
+
+
+void RdbPointcloud::AttributeBuffer::moveNext(
+    const size_t from,
+    const size_t to
+)
+{
+    std::copy_n(
+        next.begin() + m_typeSize * from,
+        m_typeSize,
+        next.begin() + m_typeSize * to
+    );
+}
+
+
 size_t RdbPointcloud::AttributeBuffer::typeSize(
     const pdal::Dimension::Type type
 )
@@ -146,7 +173,8 @@ pdal::Dimension::Type RdbPointcloud::AttributeBuffer::typePDAL(
 RdbPointcloud::RdbPointcloud(
     const std::string& location,
     const std::string& filter,
-    const bool         extras
+    const bool         extras,
+    const Bounds&      bounds
 ):
     m_context(),
     m_pointcloud(m_context),
@@ -163,7 +191,11 @@ RdbPointcloud::RdbPointcloud(
     m_buffer_pz(),
     m_buffer_nx(),
     m_buffer_ny(),
-    m_buffer_nz()
+    m_buffer_nz(),
+    m_pending(),
+    m_clip(false),
+    m_clip3d(false),
+    m_clip_box()
 {
     using namespace pdal::Dimension;
     using namespace riegl::rdb::pointcloud;
@@ -210,8 +242,37 @@ RdbPointcloud::RdbPointcloud(
         {}
     }
 
+    // push the query box down into the filter, so points outside of it are
+    // skipped by the library instead of being read and cropped later
+    std::string query(filter);
+    if (bounds.to2d().valid())
+    {
+        Eigen::Vector4d minimum, maximum;
+        if (!getBoundingBox(minimum, maximum))
+        {
+            throw pdal_error("Can't use bounds with a database that "
+                "doesn't contain coordinates.");
+        }
+        m_clip = true;
+        m_clip3d = bounds.is3d();
+        if (m_clip3d)
+        {
+            m_clip_box = bounds.to3d();
+        }
+        else // take the height range from the database
+        {
+            const BOX2D box = bounds.to2d();
+            m_clip_box = BOX3D(
+                box.minx, box.miny, minimum[2],
+                box.maxx, box.maxy, maximum[2]
+            );
+        }
+        const std::string clause = boundsFilter(m_clip_box, m_clip3d);
+        query = query.empty() ? clause : "(" + query + ") && " + clause;
+    }
+
     // setup read query and attribute buffers
-    m_select_query = m_pointcloud.select(filter);
+    m_select_query = m_pointcloud.select(query);
     const auto attributes = m_pointcloud.pointAttribute().list();
     for (const auto& attribute: attributes)
     {
@@ -220,16 +281,14 @@ RdbPointcloud::RdbPointcloud(
             const std::string&        name // rdb attribute name
         ) -> AttributeBuffer::Ptr
         {
+            const auto type = pdal::Dimension::defaultType(id);
             const auto buffer = std::make_shared<AttributeBuffer>(
                 id,
-                pdal::Dimension::defaultType(id),
+                type,
                 pdal::Dimension::name(id),
-                m_buffer_size
-            );
-            this->m_select_query.bind(
                 name,
-                AttributeBuffer::typeRDB(buffer->type),
-                buffer->data.data()
+                AttributeBuffer::typeRDB(type),
+                m_buffer_size
             );
             m_select_buffer.push_back(buffer);
             return buffer;
@@ -334,12 +393,9 @@ RdbPointcloud::RdbPointcloud(
                     pdal::Dimension::Id::Unknown, // see addDimensions()
                     typePDAL,
                     namePDAL.str(),
-                    m_buffer_size
-                );
-                m_select_query.bind(
                     nameRDB.str(),
                     typeRDB,
-                    buffer->data.data()
+                    m_buffer_size
                 );
                 m_select_buffer.push_back(buffer);
             }
@@ -350,6 +406,10 @@ RdbPointcloud::RdbPointcloud(
 
 RdbPointcloud::~RdbPointcloud()
 {
+    if (m_pending.valid()) // don't close the query under a running read
+    {
+        m_pending.wait();
+    }
     m_select_query.close();
     m_pointcloud  .close();
 }
@@ -456,64 +516,187 @@ point_count_t RdbPointcloud::readPoints(
     point_count_t index = target.size();
     while (total < count) // copy points from our buffer to the PDAL-view
     {
-        if (m_select_index >= m_select_count) // then read next block
+        if (m_select_index >= m_select_count) // then take the next block
         {
+            if (!m_pending.valid())
+            {
+                startFetch();
+            }
             m_select_index = 0; // rewind internal buffer
-            m_select_count = m_select_query.next(m_buffer_size);
+            m_select_count = m_pending.get();
             if (m_select_count == 0) // then we reached end-of-file
             {
                 return total;
             }
-            if (m_crs_pose) // then transform points
+            for (auto& buffer: m_select_buffer)
             {
-                const auto transform = [&](
-                    const AttributeBuffer::Ptr& x,
-                    const AttributeBuffer::Ptr& y,
-                    const AttributeBuffer::Ptr& z,
-                    const double                w
-                )
-                {
-                    auto px = static_cast<double*>(x->at(0));
-                    auto py = static_cast<double*>(y->at(0));
-                    auto pz = static_cast<double*>(z->at(0));
-                    const auto end = px + m_select_count;
-                    for (; px < end; ++px, ++py, ++pz)
-                    {
-                        const Eigen::Vector4d xyz(
-                            *m_crs_pose * Eigen::Vector4d(*px, *py, *pz, w)
-                        );
-                        *px = xyz[0];
-                        *py = xyz[1];
-                        *pz = xyz[2];
-                    }
-                };
-                if (m_buffer_px && m_buffer_py && m_buffer_pz) // coordinates
-                {
-                    transform(m_buffer_px, m_buffer_py, m_buffer_pz, 1.0);
-                }
-                if (m_buffer_nx && m_buffer_ny && m_buffer_nz) // normals
-                {
-                    transform(m_buffer_nx, m_buffer_ny, m_buffer_nz, 0.0);
-                }
+                buffer->data.swap(buffer->next);
             }
+            startFetch(); // read ahead while this block is copied
         }
-        while ((total < count) && (m_select_index < m_select_count))
+
+        // copy attribute by attribute rather than point by point
+        const point_count_t n = (std::min)(
+            count - total,
+            point_count_t(m_select_count - m_select_index)
+        );
+        for (const auto& buffer: m_select_buffer)
         {
-            for (const auto& buffer: m_select_buffer)
+            for (point_count_t i = 0; i < n; ++i)
             {
                 target.setField(
                     buffer->id,
                     buffer->type,
-                    index,
-                    buffer->at(m_select_index)
+                    index + i,
+                    buffer->at(m_select_index + i)
                 );
             }
-            m_select_index++;
-            index++;
-            total++;
         }
+        m_select_index += n;
+        index += n;
+        total += n;
     }
     return total;
 }
 
+
+std::string RdbPointcloud::boundsFilter(
+    const BOX3D& box,
+    const bool   is3d
+) const
+{
+    // the filter is evaluated on the stored coordinates, so transform the
+    // box into the database's own coordinate system
+    BOX3D local;
+    if (m_crs_pose)
+    {
+        const Eigen::Matrix4d inverse = m_crs_pose->inverse();
+        for (int i = 0; i < 8; ++i)
+        {
+            const Eigen::Vector4d corner = inverse * Eigen::Vector4d(
+                (i & 1) ? box.maxx : box.minx,
+                (i & 2) ? box.maxy : box.miny,
+                (i & 4) ? box.maxz : box.minz,
+                1.0
+            );
+            local.grow(corner[0], corner[1], corner[2]);
+        }
+    }
+    else
+    {
+        local = box;
+    }
+
+    std::ostringstream filter;
+    filter.precision(std::numeric_limits<double>::max_digits10);
+    filter << "(riegl.xyz[0] >= " << local.minx << ") && "
+           << "(riegl.xyz[0] <= " << local.maxx << ") && "
+           << "(riegl.xyz[1] >= " << local.miny << ") && "
+           << "(riegl.xyz[1] <= " << local.maxy << ")";
+    if (is3d || m_crs_pose) // a rotated box constrains all three axes
+    {
+        filter << " && "
+               << "(riegl.xyz[2] >= " << local.minz << ") && "
+               << "(riegl.xyz[2] <= " << local.maxz << ")";
+    }
+    return filter.str();
+}
+
+
+void RdbPointcloud::startFetch()
+{
+    m_pending = std::async(std::launch::async, [this]()
+    {
+        return fetch();
+    });
+}
+
+
+uint32_t RdbPointcloud::fetch()
+{
+    uint32_t count = 0;
+    while (count == 0)
+    {
+        for (const auto& buffer: m_select_buffer)
+        {
+            m_select_query.bind(
+                buffer->attribute,
+                buffer->attributeType,
+                buffer->next.data()
+            );
+        }
+        count = m_select_query.next(m_buffer_size);
+        if (count == 0) // then we reached end-of-file
+        {
+            return 0;
+        }
+        if (m_crs_pose) // then transform points
+        {
+            const auto transform = [&](
+                const AttributeBuffer::Ptr& x,
+                const AttributeBuffer::Ptr& y,
+                const AttributeBuffer::Ptr& z,
+                const double                w
+            )
+            {
+                auto px = static_cast<double*>(x->nextAt(0));
+                auto py = static_cast<double*>(y->nextAt(0));
+                auto pz = static_cast<double*>(z->nextAt(0));
+                const auto end = px + count;
+                for (; px < end; ++px, ++py, ++pz)
+                {
+                    const Eigen::Vector4d xyz(
+                        *m_crs_pose * Eigen::Vector4d(*px, *py, *pz, w)
+                    );
+                    *px = xyz[0];
+                    *py = xyz[1];
+                    *pz = xyz[2];
+                }
+            };
+            if (m_buffer_px && m_buffer_py && m_buffer_pz) // coordinates
+            {
+                transform(m_buffer_px, m_buffer_py, m_buffer_pz, 1.0);
+            }
+            if (m_buffer_nx && m_buffer_ny && m_buffer_nz) // normals
+            {
+                transform(m_buffer_nx, m_buffer_ny, m_buffer_nz, 0.0);
+            }
+            if (m_clip) // the filter box was widened by the pose
+            {
+                count = clip(count); // try next block if nothing is left
+            }
+        }
+    }
+    return count;
+}
+
+
+uint32_t RdbPointcloud::clip(const uint32_t count) const
+{
+    const auto px = static_cast<double*>(m_buffer_px->nextAt(0));
+    const auto py = static_cast<double*>(m_buffer_py->nextAt(0));
+    const auto pz = static_cast<double*>(m_buffer_pz->nextAt(0));
+
+    uint32_t kept = 0;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const bool inside = m_clip3d ?
+            m_clip_box.contains(px[i], py[i], pz[i]) :
+            m_clip_box.to2d().contains(px[i], py[i]);
+        if (!inside)
+        {
+            continue;
+        }
+        if (kept != i)
+        {
+            for (const auto& buffer: m_select_buffer)
+            {
+                buffer->moveNext(i, kept);
+            }
+        }
+        kept++;
+    }
+    return kept;
+}
+
 }
@@ -34,10 +34,12 @@
 
 #pragma once
 
+#include <future>
 #include <vector>
 #include <Eigen/Dense>
 #include <pdal/PointTable.hpp>
 #include <pdal/PointView.hpp>
+#include <pdal/util/Bounds.hpp>
 #include <riegl/rdb.hpp>
 
 namespace pdal
@@ -53,7 +55,8 @@ public:
     RdbPointcloud(
         const std::string& location, //!< database filename
         const std::string& filter,   //!< optional filter string
-        const bool         extras    //!< true: all, false: PDAL attributes only
+        const bool         extras,   //!< true: all, false: PDAL attributes only
+        const Bounds&      bounds = Bounds() //!< optional query box
     );
     virtual ~RdbPointcloud();
 
@@ -108,12 +111,17 @@ private:
         pdal::Dimension::Id   id;   //!< PDAL dimension ID
         pdal::Dimension::Type type; //!< PDAL dimension type
         std::string           name; //!< PDAL dimension name
-        std::vector<uint8_t>  data; //!< attribute data buffer
+        std::string           attribute; //!< RDB attribute name
+        riegl::rdb::pointcloud::DataType attributeType; //!< RDB data type
+        std::vector<uint8_t>  data; //!< attribute data being consumed
+        std::vector<uint8_t>  next; //!< attribute data being read
 
         AttributeBuffer(
             const pdal::Dimension::Id   id,   //!< PDAL dimension ID
             const pdal::Dimension::Type type, //!< PDAL dimension type
             const std::string           name, //!< PDAL dimension name
+            const std::string           attribute, //!< RDB attribute name
+            const riegl::rdb::pointcloud::DataType attributeType,
             const size_t                size  //!< number of points
         );
 
@@ -121,6 +129,10 @@ private:
 
         inline void* at(const size_t index);
 
+        inline void* nextAt(const size_t index);
+
+        inline void moveNext(const size_t from, const size_t to);
+
         static size_t typeSize(
             const pdal::Dimension::Type type
         );
@@ -144,6 +156,14 @@ private:
         const point_count_t count
     );
 
+    // build the query filter for a box given in the pose's coordinates
+    std::string boundsFilter(const BOX3D& box, const bool is3d) const;
+
+    // read the next block into the 'next' attribute buffers
+    void startFetch();
+    uint32_t fetch();
+    uint32_t clip(const uint32_t count) const;
+
 private:
     riegl::rdb::Context                 m_context;
     riegl::rdb::Pointcloud              m_pointcloud;
@@ -155,6 +175,10 @@ private:
     uint32_t                            m_select_index;
     uint32_t                            m_select_count;
     const uint32_t                      m_buffer_size;
+    std::future<uint32_t>               m_pending;
+    bool                                m_clip;
+    bool                                m_clip3d;
+    BOX3D                               m_clip_box;
     AttributeBuffer::Ptr                m_buffer_px;
     AttributeBuffer::Ptr                m_buffer_py;
     AttributeBuffer::Ptr                m_buffer_pz;
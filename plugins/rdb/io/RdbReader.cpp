@@ -63,7 +63,8 @@ RdbReader::RdbReader():
     pdal::Streamable(),
     m_pointcloud(),
     m_filter(),
-    m_extras(false)
+    m_extras(false),
+    m_bounds()
 {
 }
 
@@ -143,6 +144,12 @@ void RdbReader::addArgs(ProgramArgs& args)
         m_extras,
         false
     );
+    args.add(
+        "bounds",
+        "Optional box of points to read, pushed down into the query "
+        "so that points outside of it are not read",
+        m_bounds
+    );
 }
 
 
@@ -151,7 +158,9 @@ void RdbReader::initialize()
     if (pdal::Utils::isRemote(m_filename))
         m_filename = pdal::Utils::fetchRemote(m_filename);
 
-    m_pointcloud.reset(new RdbPointcloud(m_filename, m_filter, m_extras));
+    m_pointcloud.reset(
+        new RdbPointcloud(m_filename, m_filter, m_extras, m_bounds)
+    );
     // Set spatial reference form source if not overridden.
     if (getSpatialReference().empty())
         setSpatialReference(getSpatialReferenceSystem(*m_pointcloud));
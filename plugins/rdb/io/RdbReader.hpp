@@ -72,6 +72,7 @@ private:
     std::unique_ptr<RdbPointcloud> m_pointcloud;
     std::string                    m_filter;
     bool                           m_extras;
+    Bounds                         m_bounds;
 };
 
 } // namespace pdal
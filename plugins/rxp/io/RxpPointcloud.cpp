@@ -45,6 +45,14 @@
 namespace pdal
 {
 
+namespace
+{
+
+// Number of points decoded ahead of the reader.
+const size_t BatchSize = 64 * 1024;
+
+} // unnamed namespace
+
 
 Dimension::Id getTimeDimensionId(bool syncToPps)
 {
@@ -75,45 +83,65 @@ RxpPointcloud::RxpPointcloud(
     , m_rc(scanlib::basic_rconnection::create(uri))
     , m_dec(m_rc)
     , m_edge(false)
-{}
+    , m_batchIndex(0)
+{
+    m_points.reserve(BatchSize);
+    m_batch.reserve(BatchSize);
+}
 
 
 RxpPointcloud::~RxpPointcloud()
 {
+    // Don't close the connection under a running decode.
+    if (m_pending.valid())
+        m_pending.wait();
     m_rc->close();
 }
 
 
 bool RxpPointcloud::readOne(PointRef& point)
 {
-    if (readSavedPoint(point)) {
-        return true;
-    }
-    savePoints();
-    return readSavedPoint(point);
+    if (m_batchIndex >= m_batch.size() && !nextBatch())
+        return false;
+    copyPoint(m_batch[m_batchIndex++], point);
+    return true;
 }
 
 
-bool RxpPointcloud::readSavedPoint(PointRef& point)
+// Take the points decoded in the background and start decoding the next
+// batch while they're copied out.
+bool RxpPointcloud::nextBatch()
 {
-    if (!m_points.empty()) {
-        copyPoint(m_points.front(), point);
-        m_points.pop_front();
-        return true;
-    } else {
+    if (!m_pending.valid())
+        startDecode();
+    m_pending.get();
+
+    m_batch.clear();
+    std::swap(m_batch, m_points);
+    m_batchIndex = 0;
+    if (m_batch.empty())
         return false;
-    }
-};
+    startDecode();
+    return true;
+}
 
 
-void RxpPointcloud::savePoints() {
-    if (endOfInput()) {
-        return;
-    }
-    for (m_dec.get(m_rxpbuf); !m_dec.eoi(); m_dec.get(m_rxpbuf))
+void RxpPointcloud::startDecode()
+{
+    m_pending = std::async(std::launch::async, [this](){ decodeBatch(); });
+}
+
+
+// Dispatch packets until a batch of points has been collected or the
+// input is exhausted.
+void RxpPointcloud::decodeBatch()
+{
+    while (m_points.size() < BatchSize && !m_dec.eoi())
     {
+        m_dec.get(m_rxpbuf);
+        if (m_dec.eoi())
+            break;
         dispatch(m_rxpbuf.begin(), m_rxpbuf.end());
-        if (!m_points.empty()) return;
     }
 }
 
@@ -149,12 +177,6 @@ void RxpPointcloud::copyPoint(const Point& from, PointRef& to) const {
 }
 
 
-bool RxpPointcloud::endOfInput() const
-{
-    return m_dec.eoi();
-}
-
-
 void RxpPointcloud::on_echo_transformed(echo_type echo)
 {
     if (!(scanlib::pointcloud::single == echo || scanlib::pointcloud::last == echo))
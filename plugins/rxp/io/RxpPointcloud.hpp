@@ -41,6 +41,9 @@
 
 #pragma once
 
+#include <future>
+#include <vector>
+
 #include <pdal/Dimension.hpp>
 #include <pdal/PointRef.hpp>
 #include <pdal/PointTable.hpp>
@@ -75,7 +78,6 @@ public:
             PointTableRef table);
     virtual ~RxpPointcloud();
 
-    bool endOfInput() const;
     bool readOne(PointRef& point);
 
     inline bool isSyncToPps() const
@@ -89,9 +91,10 @@ protected:
     void on_line_start_dn(const scanlib::line_start_dn<iterator_type> & arg);
 
 private:
-    bool readSavedPoint(PointRef& point);
+    bool nextBatch();
+    void startDecode();
+    void decodeBatch();
     void copyPoint(const Point& from, PointRef& to) const;
-    void savePoints();
 
     bool m_syncToPps;
     bool m_edge;
@@ -101,7 +104,10 @@ private:
     std::shared_ptr<scanlib::basic_rconnection> m_rc;
     scanlib::decoder_rxpmarker m_dec;
     scanlib::buffer m_rxpbuf;
-    std::deque<Point> m_points;
+    std::vector<Point> m_points;  // Filled by the decoder.
+    std::vector<Point> m_batch;   // Being copied out to PDAL.
+    size_t m_batchIndex;
+    std::future<void> m_pending;
 
 };
 
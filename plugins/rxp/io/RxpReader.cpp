@@ -117,10 +117,13 @@ void RxpReader::ready(PointTableRef table)
 point_count_t RxpReader::read(PointViewPtr view, point_count_t num)
 {
     point_count_t numRead = 0;
-    PointRef point(view->point(0));
-    while (numRead < num && !m_pointcloud->endOfInput()) {
-        point.setPointId(numRead);
-        processOne(point);
+    PointId idx = view->size();
+    PointRef point(view->point(idx));
+    while (numRead < num) {
+        point.setPointId(idx);
+        if (!processOne(point))
+            break;
+        ++idx;
         ++numRead;
     }
     return numRead;
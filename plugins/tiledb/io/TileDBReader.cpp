@@ -33,6 +33,8 @@
 ****************************************************************************/
 
 #include <algorithm>
+#include <cmath>
+#include <limits>
 
 #include <nlohmann/json.hpp>
 
@@ -105,6 +107,8 @@ void TileDBReader::addArgs(ProgramArgs& args)
     args.add("stats", "Dump TileDB query stats to stdout", m_stats, false);
     args.add("bbox3d", "Bounding box subarray to read from TileDB in format "
         "([minx, maxx], [miny, maxy], [minz, maxz])", m_bbox);
+    args.add("threads", "Number of queries to run concurrently. The subarray "
+        "is split into this many slabs along X", m_threads, 1);
 }
 
 void TileDBReader::prepared(PointTableRef table)
@@ -117,6 +121,9 @@ void TileDBReader::prepared(PointTableRef table)
 
 void TileDBReader::initialize()
 {
+    if (m_threads < 1)
+        throwError("Option 'threads' must be at least 1.");
+
     if (!m_cfgFileName.empty())
     {
         tiledb::Config cfg(m_cfgFileName);
@@ -181,44 +188,46 @@ void TileDBReader::addDimensions(PointLayoutPtr layout)
 }
 
 template <typename T>
-void TileDBReader::setQueryBuffer(const DimInfo& di)
+void TileDBReader::setQueryBuffer(tiledb::Query& q, const DimInfo& di,
+    Buffer& buf)
 {
-    m_query->set_buffer(di.m_name, di.m_buffer->get<T>(), di.m_buffer->count());
+    q.set_buffer(di.m_name, buf.get<T>(), buf.count());
 }
 
-void TileDBReader::setQueryBuffer(const DimInfo& di)
+void TileDBReader::setQueryBuffer(tiledb::Query& q, const DimInfo& di,
+    Buffer& buf)
 {
     switch(di.m_tileType)
     {
     case TILEDB_INT8:
-        setQueryBuffer<int8_t>(di);
+        setQueryBuffer<int8_t>(q, di, buf);
         break;
     case TILEDB_UINT8:
-        setQueryBuffer<uint8_t>(di);
+        setQueryBuffer<uint8_t>(q, di, buf);
         break;
     case TILEDB_INT16:
-        setQueryBuffer<int16_t>(di);
+        setQueryBuffer<int16_t>(q, di, buf);
         break;
     case TILEDB_UINT16:
-        setQueryBuffer<uint16_t>(di);
+        setQueryBuffer<uint16_t>(q, di, buf);
         break;
     case TILEDB_INT32:
-        setQueryBuffer<int32_t>(di);
+        setQueryBuffer<int32_t>(q, di, buf);
         break;
     case TILEDB_UINT32:
-        setQueryBuffer<uint32_t>(di);
+        setQueryBuffer<uint32_t>(q, di, buf);
         break;
     case TILEDB_INT64:
-        setQueryBuffer<int64_t>(di);
+        setQueryBuffer<int64_t>(q, di, buf);
         break;
     case TILEDB_UINT64:
-        setQueryBuffer<uint64_t>(di);
+        setQueryBuffer<uint64_t>(q, di, buf);
         break;
     case TILEDB_FLOAT32:
-        setQueryBuffer<float>(di);
+        setQueryBuffer<float>(q, di, buf);
         break;
     case TILEDB_FLOAT64:
-        setQueryBuffer<double>(di);
+        setQueryBuffer<double>(q, di, buf);
         break;
     default:
         throwError("TileDB dimension '" + di.m_name + "' can't be mapped "
@@ -241,55 +250,35 @@ void TileDBReader::ready(PointTableRef)
 
 void TileDBReader::localReady()
 {
-    int numDims = m_array->schema().domain().dimensions().size();
-
-    m_query.reset(new tiledb::Query(*m_ctx, *m_array));
-
-    // Build the buffer for the dimensions.
-    auto it = std::find_if(m_dims.begin(), m_dims.end(),
-        [](DimInfo& di){ return di.m_dimCategory == DimCategory::Dimension; });
-
-    DimInfo& di = *it;
-    Buffer *dimBuf = new Buffer(di.m_tileType, m_chunkSize * numDims);
-    m_query->set_coordinates(dimBuf->get<double>(), dimBuf->count());
-    m_buffers.push_back(std::unique_ptr<Buffer>(dimBuf));
-
-    for (DimInfo& di : m_dims)
-    {
-        // All dimensions use the same buffer.
-        if (di.m_dimCategory == DimCategory::Dimension)
-            di.m_buffer = dimBuf;
-        else
-        {
-            std::unique_ptr<Buffer> dimBuf(
-                new Buffer(di.m_tileType, m_chunkSize));
-            di.m_buffer = dimBuf.get();
-            m_buffers.push_back(std::move(dimBuf));
-            setQueryBuffer(di);
-        }
-    }
+    m_numDims = m_array->schema().domain().dimensions().size();
 
     // Set the extent of the query.
+    std::vector<double> subarray;
     if (!m_bbox.empty())
     {
-        if (numDims == 2)
-            m_query->set_subarray({m_bbox.minx, m_bbox.maxx,
-                m_bbox.miny, m_bbox.maxy});
+        if (m_numDims == 2)
+            subarray = { m_bbox.minx, m_bbox.maxx, m_bbox.miny, m_bbox.maxy };
         else
-            m_query->set_subarray({m_bbox.minx, m_bbox.maxx,
-                m_bbox.miny, m_bbox.maxy, m_bbox.minz, m_bbox.maxz});
+            subarray = { m_bbox.minx, m_bbox.maxx, m_bbox.miny, m_bbox.maxy,
+                m_bbox.minz, m_bbox.maxz };
     }
     else
     {
         // get extents
-        std::vector<double> subarray;
         auto domain = m_array->non_empty_domain<double>();
         for (const auto& kv : domain)
         {
             subarray.push_back(kv.second.first);
             subarray.push_back(kv.second.second);
         }
-        m_query->set_subarray(subarray);
+    }
+
+    m_queries.clear();
+    for (const std::vector<double>& sub : splitSubarray(subarray))
+    {
+        std::unique_ptr<SubQuery> q(new SubQuery);
+        q->m_subarray = sub;
+        m_queries.push_back(std::move(q));
     }
 
     // read spatial reference
@@ -332,20 +321,148 @@ void TileDBReader::localReady()
 
     // initialize read buffer variables
     m_offset = 0;
-    m_resultSize = 0;
-    m_complete = false;
+    m_queryIdx = 0;
+
+    if (m_stats)
+        tiledb::Stats::enable();
+
+    // Start the first queries.  Each following query is started when one
+    // finishes so that no more than 'threads' are running at once.
+    size_t running = (std::min)((size_t)m_threads, m_queries.size());
+    for (size_t i = 0; i < running; ++i)
+        startQuery(*m_queries[i]);
+}
+
+
+std::vector<std::vector<double>> TileDBReader::splitSubarray(
+    const std::vector<double>& subarray) const
+{
+    std::vector<std::vector<double>> subs;
+
+    const double minx = subarray[0];
+    const double maxx = subarray[1];
+    const double step = (maxx - minx) / m_threads;
+
+    // Subarray ranges are inclusive, so each slab starts just above the
+    // end of the previous one to keep points from being read twice.
+    double lo = minx;
+    for (int i = 0; i < m_threads; ++i)
+    {
+        double hi = (i == m_threads - 1) ? maxx : minx + step * (i + 1);
+        if (lo > hi)
+            break;
+
+        std::vector<double> sub(subarray);
+        sub[0] = lo;
+        sub[1] = hi;
+        subs.push_back(sub);
+        lo = std::nextafter(hi, (std::numeric_limits<double>::max)());
+    }
+    return subs;
+}
+
+
+point_count_t TileDBReader::estimatePoints(tiledb::Query& q) const
+{
+    point_count_t count = m_chunkSize;
+
+#if TILEDB_VERSION_MAJOR > 1 || TILEDB_VERSION_MINOR >= 6
+    // The estimate is in bytes of coordinates.  Buffers are sized to the
+    // estimate so that small reads don't allocate a whole chunk.
+    uint64_t bytes = q.est_result_size(TILEDB_COORDS);
+    count = (std::min)(count,
+        (point_count_t)(bytes / (m_numDims * sizeof(double))) + 1);
+#endif
+    return count;
+}
+
+
+void TileDBReader::allocateBuffers(SubQuery& q, point_count_t count)
+{
+    auto it = std::find_if(m_dims.begin(), m_dims.end(),
+        [](DimInfo& di){ return di.m_dimCategory == DimCategory::Dimension; });
+
+    for (BufferSet& set : q.m_sets)
+    {
+        set = BufferSet();
+
+        // All dimensions use the same buffer.
+        Buffer *dimBuf = new Buffer(it->m_tileType, count * m_numDims);
+        set.m_buffers.push_back(std::unique_ptr<Buffer>(dimBuf));
+        for (DimInfo& di : m_dims)
+        {
+            Buffer *buf = nullptr;
+            if (di.m_dimCategory == DimCategory::Dimension)
+                buf = dimBuf;
+            // Attributes that aren't used downstream aren't fetched.
+            else if (dimRequired(di.m_id))
+            {
+                buf = new Buffer(di.m_tileType, count);
+                set.m_buffers.push_back(std::unique_ptr<Buffer>(buf));
+            }
+            set.m_dimBuffers.push_back(buf);
+        }
+    }
+    q.m_capacity = count;
+}
+
+
+void TileDBReader::startQuery(SubQuery& q)
+{
+    q.m_query.reset(new tiledb::Query(*m_ctx, *m_array));
+    q.m_query->set_subarray(q.m_subarray);
+    allocateBuffers(q, estimatePoints(*q.m_query));
+
+    // Nothing has been read into set 1, so reading starts by switching to
+    // set 0 once the first submission is done.
+    q.m_current = 1;
+    submit(q, 0);
+}
+
+
+// Point the query at a buffer set and submit it asynchronously.  The
+// submission is waited on in processPoint() before the set is read.
+void TileDBReader::submit(SubQuery& q, size_t set)
+{
+    BufferSet& bs = q.m_sets[set];
+    tiledb::Query& query = *q.m_query;
+
+    Buffer& coords = *bs.m_buffers.front();
+    query.set_coordinates(coords.get<double>(), coords.count());
+    for (size_t i = 0; i < m_dims.size(); ++i)
+    {
+        const DimInfo& di = m_dims[i];
+        if (di.m_dimCategory == DimCategory::Attribute && bs.m_dimBuffers[i])
+            setQueryBuffer(query, di, *bs.m_dimBuffers[i]);
+    }
+
+    bs.m_size = 0;
+    q.m_pending = std::async(std::launch::async, [this, &q, &bs]()
+    {
+        q.m_query->submit();
+
+        // The result buffer count represents the total number of items
+        // returned by the query for dimensions.  So if there are three
+        // dimensions, the number of points returned is the buffer count
+        // divided by the number of dimensions.
+        bs.m_size =
+            q.m_query->result_buffer_elements()[TILEDB_COORDS].second /
+            m_numDims;
+        q.m_complete =
+            (q.m_query->query_status() == tiledb::Query::Status::COMPLETE);
+    });
 }
 
 namespace
 {
 
-bool setField(PointRef& point, TileDBReader::DimInfo di, size_t bufOffset)
+bool setField(PointRef& point, const TileDBReader::DimInfo& di,
+    TileDBReader::Buffer& buf, size_t bufOffset)
 {
     // Span is a count of the number of elements in each set of data, so
     // offset is a count of item types.  We're doing pointer arithmetic
     // below, so the size of the type is accounted for.
     bufOffset = bufOffset * di.m_span + di.m_offset;
-    TileDBReader::Buffer& buf = *di.m_buffer;
     switch (di.m_type)
     {
     case Dimension::Type::Signed8:
@@ -403,75 +520,85 @@ bool TileDBReader::processOne(PointRef& point)
 
 bool TileDBReader::processPoint(PointRef& point)
 {
-    if (m_offset == m_resultSize)
+    while (m_queryIdx < m_queries.size())
     {
-        if (m_complete)
+        SubQuery& q = *m_queries[m_queryIdx];
+        BufferSet& set = q.m_sets[q.m_current];
+
+        if (m_offset < set.m_size)
         {
-            return false;
+            for (size_t i = 0; i < m_dims.size(); ++i)
+            {
+                Buffer *buf = set.m_dimBuffers[i];
+                if (buf && !setField(point, m_dims[i], *buf, m_offset))
+                    throwError("Invalid dimension type when setting data.");
+            }
+            ++m_offset;
+            return true;
         }
-        else
+        m_offset = 0;
+
+        // The current set has been read.  Switch to the set that TileDB
+        // has been filling and, if the query isn't done, have it refill
+        // the set that was just read.
+        if (q.m_pending.valid())
         {
-            tiledb::Query::Status status;
-            if (m_stats)
-                tiledb::Stats::enable();
-            m_query->submit();
-            if (m_stats)
+            q.m_pending.get();
+            q.m_current = 1 - q.m_current;
+            if (q.m_sets[q.m_current].m_size == 0 && !q.m_complete)
             {
-                tiledb::Stats::dump(stdout);
-                tiledb::Stats::disable();
+                // The buffers sized from the estimate couldn't hold
+                // any results.
+                if (q.m_capacity >= m_chunkSize)
+                    throwError("Need to increase chunk_size for reader.");
+                allocateBuffers(q, m_chunkSize);
             }
+            if (!q.m_complete)
+                submit(q, 1 - q.m_current);
+            continue;
+        }
 
-            status = m_query->query_status();
-
-            // The result buffer count represents the total number of items
-            // returned by the query for dimensions.  So if there are three
-            // dimensions, the number of points returned is the buffer count
-            // divided by the number of dimensions.
-            m_resultSize =
-                (int)m_query->result_buffer_elements()[TILEDB_COORDS].second /
-                m_array->schema().domain().dimensions().size();
-
-            if (status == tiledb::Query::Status::INCOMPLETE &&
-                    m_resultSize == 0)
-                throwError("Need to increase chunk_size for reader.");
-
-            if (status == tiledb::Query::Status::COMPLETE)
-                m_complete = true;
-
-            m_offset = 0;
-        }     
-    }
-
-    if (m_resultSize > 0)
-    {
-        for (DimInfo& dim : m_dims)
-            if (!setField(point, dim, m_offset))
-                throwError("Invalid dimension type when setting data.");
-
-        ++m_offset;
-        return true;
-    }
-    else
-    {
-        return false;
+        // The query is done.  Free its buffers and start the next waiting
+        // query.
+        q.m_query.reset();
+        q.m_sets[0] = BufferSet();
+        q.m_sets[1] = BufferSet();
+        size_t next = m_queryIdx + m_threads;
+        if (next < m_queries.size())
+            startQuery(*m_queries[next]);
+        m_queryIdx++;
     }
+    return false;
 }
 
 point_count_t TileDBReader::read(PointViewPtr view, point_count_t count)
 {
-    PointRef point = view->point(0);
-    PointId id;
-    for (id = 0; id < count; ++id)
+    PointId start = view->size();
+    PointRef point = view->point(start);
+    point_count_t cnt;
+    for (cnt = 0; cnt < count; ++cnt)
     {
-        point.setPointId(id);
+        point.setPointId(start + cnt);
         if (!processOne(point))
             break;
     }
-    return id;   
+    return cnt;
 }
 
 void TileDBReader::done(pdal::BasePointTable &table)
 {
+    // Wait for any submissions still running, as when a read is stopped
+    // early.
+    for (auto& q : m_queries)
+        if (q->m_pending.valid())
+            q->m_pending.wait();
+    m_queries.clear();
+
+    if (m_stats)
+    {
+        tiledb::Stats::dump(stdout);
+        tiledb::Stats::disable();
+    }
     m_array->close();
 }
 
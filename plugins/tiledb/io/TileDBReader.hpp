@@ -36,6 +36,7 @@
 
 #define NOMINMAX
 
+#include <future>
 #include <iostream>
 
 #include <pdal/Reader.hpp>
@@ -72,7 +73,6 @@ public:
 
     struct DimInfo
     {
-        Buffer *m_buffer;
         DimCategory m_dimCategory;
         size_t m_span;
         size_t m_offset;
@@ -82,6 +82,33 @@ public:
         std::string m_name;
     };
 
+    // One set of result buffers for a query.  Each query has two sets so
+    // that TileDB can fill one while points are read from the other.
+    struct BufferSet
+    {
+        std::vector<std::unique_ptr<Buffer>> m_buffers;
+        std::vector<Buffer *> m_dimBuffers;  // Buffer for each of m_dims.
+        point_count_t m_size;  // Number of points in the buffers.
+
+        BufferSet() : m_size(0)
+        {}
+    };
+
+    // A query for a slab of the subarray being read.
+    struct SubQuery
+    {
+        std::vector<double> m_subarray;
+        std::unique_ptr<tiledb::Query> m_query;
+        BufferSet m_sets[2];
+        point_count_t m_capacity;  // Number of points each set can hold.
+        size_t m_current;  // Index of the set being read.
+        bool m_complete;
+        std::future<void> m_pending;  // Submission filling the other set.
+
+        SubQuery() : m_capacity(0), m_current(0), m_complete(false)
+        {}
+    };
+
     TileDBReader() = default;
     std::string getName() const;
 private:
@@ -95,27 +122,33 @@ private:
     virtual void done(PointTableRef table);
     void localReady();
     bool processPoint(PointRef& point);
+    std::vector<std::vector<double>> splitSubarray(
+        const std::vector<double>& subarray) const;
+    void startQuery(SubQuery& q);
+    void allocateBuffers(SubQuery& q, point_count_t count);
+    void submit(SubQuery& q, size_t set);
+    point_count_t estimatePoints(tiledb::Query& q) const;
 
     std::string m_cfgFileName;
     point_count_t m_chunkSize;
     point_count_t m_offset;
-    point_count_t m_resultSize;
-    bool m_complete;
+    size_t m_numDims;
     bool m_stats;
+    int m_threads;
     BOX3D m_bbox;
-    std::vector<std::unique_ptr<Buffer>> m_buffers;
     std::vector<DimInfo> m_dims;
+    std::vector<std::unique_ptr<SubQuery>> m_queries;
+    size_t m_queryIdx;  // Index of the query being read.
 
     std::unique_ptr<tiledb::Context> m_ctx;
     std::unique_ptr<tiledb::Array> m_array;
-    std::unique_ptr<tiledb::Query> m_query;
 
     TileDBReader(const TileDBReader&) = delete;
     TileDBReader& operator=(const TileDBReader&) = delete;
 
     template<typename T>
-    void setQueryBuffer(const DimInfo& di);
-    void setQueryBuffer(const DimInfo& di);
+    void setQueryBuffer(tiledb::Query& q, const DimInfo& di, Buffer& buf);
+    void setQueryBuffer(tiledb::Query& q, const DimInfo& di, Buffer& buf);
 };
 
 } // namespace pdal
@@ -74,6 +74,8 @@ struct TileDBWriter::Args
     NL::json m_filters;
     NL::json m_defaults;
     bool m_append;
+    bool m_globalOrder;
+    bool m_consolidate;
 };
 
 std::string attributeDefaults(R"(
@@ -290,6 +292,11 @@ void TileDBWriter::addArgs(ProgramArgs& args)
         m_args->m_filters, NL::json({}));
     args.add("append", "Append to existing TileDB array",
         m_args->m_append, false);
+    args.add("global_order", "Write points in the array's global order. "
+        "Input must already be sorted in that order", m_args->m_globalOrder,
+        false);
+    args.add("consolidate", "Consolidate fragments when done",
+        m_args->m_consolidate, false);
 }
 
 
@@ -371,6 +378,8 @@ void TileDBWriter::ready(pdal::BasePointTable &table)
             TILEDB_WRITE));
     }
 
+    std::vector<DimBuffer>& attrs = m_chunks[0].m_attrs;
+    attrs.clear();
     for (const auto& d : all)
     {
         std::string dimName = layout->dimName(d);
@@ -413,12 +422,15 @@ void TileDBWriter::ready(pdal::BasePointTable &table)
                         " does not exist in original array.");
             }
             
-            m_attrs.emplace_back(dimName, d, type);
+            attrs.emplace_back(dimName, d, type);
             // Size the buffers.
-            m_attrs.back().m_buffer.resize(
+            attrs.back().m_buffer.resize(
                 m_args->m_cache_size * Dimension::size(type));
         }
     }
+    m_chunks[1].m_attrs = attrs;
+    for (Chunk& chunk : m_chunks)
+        chunk.m_coords.reserve(m_args->m_cache_size * 3);
 
     if (!m_args->m_append)
     {
@@ -428,8 +440,13 @@ void TileDBWriter::ready(pdal::BasePointTable &table)
     }
 
     m_query.reset(new tiledb::Query(*m_ctx, *m_array));
-    m_query->set_layout(TILEDB_UNORDERED);
+    m_query->set_layout(m_args->m_globalOrder ?
+        TILEDB_GLOBAL_ORDER : TILEDB_UNORDERED);
     m_current_idx = 0;
+    m_fill = 0;
+
+    if (m_args->m_stats)
+        tiledb::Stats::enable();
 }
 
 
@@ -439,12 +456,13 @@ bool TileDBWriter::processOne(PointRef& point)
     double y = point.getFieldAs<double>(Dimension::Id::Y);
     double z = point.getFieldAs<double>(Dimension::Id::Z);
 
-    for (auto& a : m_attrs)
+    Chunk& chunk = m_chunks[m_fill];
+    for (auto& a : chunk.m_attrs)
         writeAttributeValue(a, point, m_current_idx);
 
-    m_coords.push_back(x);
-    m_coords.push_back(y);
-    m_coords.push_back(z);
+    chunk.m_coords.push_back(x);
+    chunk.m_coords.push_back(y);
+    chunk.m_coords.push_back(z);
 
     if (++m_current_idx == m_args->m_cache_size)
     {
@@ -471,7 +489,28 @@ void TileDBWriter::write(const PointViewPtr view)
 
 void TileDBWriter::done(PointTableRef table)
 {
-    if (flushCache(m_current_idx))
+    bool ok = flushCache(m_current_idx) && waitForWrite();
+    if (ok && m_args->m_globalOrder)
+    {
+        try
+        {
+            // Global order writes build a single fragment that is only
+            // written once the query is finalized.
+            m_query->finalize();
+        }
+        catch (const tiledb::TileDBError& err)
+        {
+            throwError(std::string("TileDB Error: ") + err.what());
+        }
+    }
+
+    if (m_args->m_stats)
+    {
+        tiledb::Stats::dump(stdout);
+        tiledb::Stats::disable();
+    }
+
+    if (ok)
     {
         if (!m_args->m_append)
         {
@@ -515,6 +554,21 @@ void TileDBWriter::done(PointTableRef table)
 #endif
         }
         m_array->close();
+
+        if (m_args->m_consolidate)
+        {
+            try
+            {
+                tiledb::Array::consolidate(*m_ctx, m_args->m_arrayName);
+#if TILEDB_VERSION_MAJOR >= 2
+                tiledb::Array::vacuum(*m_ctx, m_args->m_arrayName);
+#endif
+            }
+            catch (const tiledb::TileDBError& err)
+            {
+                throwError(std::string("TileDB Error: ") + err.what());
+            }
+        }
     }
     else{
         throwError("Unable to flush points to TileDB array");
@@ -522,12 +576,22 @@ void TileDBWriter::done(PointTableRef table)
 }
 
 
+// Start writing the cached points and switch to caching in the other
+// chunk.  Returns false if the previous write failed.
 bool TileDBWriter::flushCache(size_t size)
 {
-    m_query->set_coordinates(m_coords);
+    // The query can only run one write at a time, and the chunk about to
+    // be filled must no longer be in use.
+    if (!waitForWrite())
+        return false;
+    if (size == 0)
+        return true;
+
+    Chunk& chunk = m_chunks[m_fill];
+    m_query->set_coordinates(chunk.m_coords);
 
     // set tiledb buffers
-    for (const auto& a : m_attrs)
+    for (const auto& a : chunk.m_attrs)
     {
         uint8_t *buf = const_cast<uint8_t *>(a.m_buffer.data());
         switch (a.m_type)
@@ -578,24 +642,34 @@ bool TileDBWriter::flushCache(size_t size)
         }
     }
 
-    if (m_args->m_stats)
-        tiledb::Stats::enable();
-
-    tiledb::Query::Status status = m_query->submit();
-
-    if (m_args->m_stats)
-    {
-        tiledb::Stats::dump(stdout);
-        tiledb::Stats::disable();
-    }
+    tiledb::Query *query = m_query.get();
+    m_pending = std::async(std::launch::async,
+        [query](){ return query->submit(); });
 
+    m_fill = 1 - m_fill;
+    m_chunks[m_fill].m_coords.clear();
     m_current_idx = 0;
-    m_coords.clear();
+    return true;
+}
 
-    if (status == tiledb::Query::Status::FAILED)
-        return false;
-    else
+
+// Wait for the write in progress, if any.  Returns false if it failed.
+bool TileDBWriter::waitForWrite()
+{
+    if (!m_pending.valid())
         return true;
+
+    tiledb::Query::Status status = tiledb::Query::Status::FAILED;
+    try
+    {
+        status = m_pending.get();
+    }
+    catch (const tiledb::TileDBError& err)
+    {
+        throwError(std::string("TileDB Error: ") + err.what());
+    }
+    return status != tiledb::Query::Status::FAILED;
 }
 
+
 } // namespace pdal
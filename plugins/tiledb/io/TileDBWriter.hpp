@@ -36,6 +36,8 @@
 
 #define NOMINMAX
 
+#include <future>
+
 #include <pdal/Streamable.hpp>
 #include <pdal/Writer.hpp>
 
@@ -59,6 +61,13 @@ public:
         {}
     };
 
+    // Points are cached in one chunk while the other is written.
+    struct Chunk
+    {
+        std::vector<DimBuffer> m_attrs;
+        std::vector<double> m_coords;
+    };
+
     TileDBWriter();
     ~TileDBWriter();
     std::string getName() const;
@@ -71,6 +80,7 @@ private:
     virtual void done(PointTableRef table);
 
     bool flushCache(size_t size);
+    bool waitForWrite();
 
     struct Args;
     std::unique_ptr<TileDBWriter::Args> m_args;
@@ -81,8 +91,9 @@ private:
     std::unique_ptr<tiledb::ArraySchema> m_schema;
     std::unique_ptr<tiledb::Array> m_array;
     std::unique_ptr<tiledb::Query> m_query;
-    std::vector<DimBuffer> m_attrs;
-    std::vector<double> m_coords;
+    Chunk m_chunks[2];
+    size_t m_fill;  // Index of the chunk being filled.
+    std::future<tiledb::Query::Status> m_pending;
 
     TileDBWriter(const TileDBWriter&) = delete;
     TileDBWriter& operator=(const TileDBWriter&) = delete;
@@ -34,6 +34,8 @@
 
 #define NOMINMAX
 
+#include <set>
+
 #include <pdal/Filter.hpp>
 #include <pdal/pdal_test_main.hpp>
 
@@ -110,6 +112,80 @@ class TileDBReaderTest : public ::testing::Test
         EXPECT_EQ(table.numPoints(), 0);
     }
 
+    TEST_F(TileDBReaderTest, read_threads)
+    {
+        std::string pth(Support::datapath("tiledb/array"));
+        Options options;
+        options.add("array_name", pth);
+        options.add("bbox3d", "([0, 0.5], [0, 0.5], [0, 0.5])");
+        options.add("chunk_size", 7);
+        options.add("threads", 3);
+
+        TileDBReader reader;
+        reader.setOptions(options);
+
+        PointTable table;
+        reader.prepare(table);
+        PointViewSet s = reader.execute(table);
+        PointViewPtr view = *s.begin();
+        EXPECT_EQ(view->size(), 50u);
+
+        // Points on the boundaries of the slabs must be read once.
+        std::set<double> xs;
+        for (PointId i = 0; i < view->size(); ++i)
+            xs.insert(view->getFieldAs<double>(Dimension::Id::X, i));
+        EXPECT_EQ(xs.size(), 50u);
+    }
+
+    TEST_F(TileDBReaderTest, read_global_order)
+    {
+        tiledb::Context ctx;
+        tiledb::VFS vfs(ctx);
+        std::string pth = Support::temppath("tiledb_test_global_order");
+
+        // Ramp points are already in global order, and the small chunk size
+        // makes a write run while the next chunk fills.
+        Options options;
+        options.add("array_name", pth);
+        options.add("chunk_size", 7);
+        options.add("global_order", true);
+        options.add("consolidate", true);
+
+        if (vfs.is_dir(pth))
+        {
+            vfs.remove_dir(pth);
+        }
+
+        FauxReader reader;
+        Options reader_options;
+        reader_options.add("mode", "ramp");
+        reader_options.add("count", 50);
+        reader.addOptions(reader_options);
+
+        TileDBWriter writer;
+        writer.setOptions(options);
+        writer.setInput(reader);
+
+        FixedPointTable table(100);
+        writer.prepare(table);
+        writer.execute(table);
+
+        Options rdrOptions;
+        rdrOptions.add("array_name", pth);
+
+        TileDBReader rdr;
+        rdr.setOptions(rdrOptions);
+
+        PointTable table2;
+        rdr.prepare(table2);
+        PointViewSet s = rdr.execute(table2);
+        PointViewPtr view = *s.begin();
+        ASSERT_EQ(view->size(), 50u);
+        for (PointId i = 1; i < view->size(); ++i)
+            EXPECT_LT(view->getFieldAs<double>(Dimension::Id::X, i - 1),
+                view->getFieldAs<double>(Dimension::Id::X, i));
+    }
+
     TEST_F(TileDBReaderTest, read)
     {
         class Checker : public Filter, public Streamable
@@ -0,0 +1,76 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include "BenchSupport.hpp"
+
+#include <io/FauxReader.hpp>
+#include <pdal/util/FileUtils.hpp>
+
+namespace pdal
+{
+namespace bench
+{
+
+Options fauxOptions(point_count_t count)
+{
+    Options opts;
+    opts.add("mode", "uniform");
+    opts.add("count", count);
+    opts.add("bounds", BOX3D(0, 0, 0, 1000, 1000, 100));
+    opts.add("number_of_returns", 3);
+    opts.add("seed", Seed);
+    return opts;
+}
+
+
+PointViewPtr fauxView(PointTableRef table, point_count_t count)
+{
+    FauxReader reader;
+    reader.setOptions(fauxOptions(count));
+    reader.prepare(table);
+    PointViewSet s = reader.execute(table);
+    return *s.begin();
+}
+
+
+std::string tempFile(const std::string& name)
+{
+    std::string dir;
+    if (Utils::getenv("TMPDIR", dir) != 0 || dir.empty())
+        dir = "/tmp";
+    return FileUtils::toAbsolutePath("pdal_bench_" + name, dir);
+}
+
+} // namespace bench
+} // namespace pdal
@@ -0,0 +1,210 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#include <benchmark/benchmark.h>
+
+#include <pdal/PointTable.hpp>
+#include <pdal/pdal_features.hpp>
+#include <pdal/compression/DeltaCompression.hpp>
+#ifdef PDAL_HAVE_ZLIB
+#include <pdal/compression/DeflateCompression.hpp>
+#endif
+#ifdef PDAL_HAVE_LAZPERF
+#include <pdal/compression/LazPerfCompression.hpp>
+#endif
+#ifdef PDAL_HAVE_LZ4
+#include <pdal/compression/Lz4Compression.hpp>
+#endif
+#ifdef PDAL_HAVE_LZMA
+#include <pdal/compression/LzmaCompression.hpp>
+#endif
+#ifdef PDAL_HAVE_ZSTD
+#include <pdal/compression/ZstdCompression.hpp>
+#endif
+
+#include "BenchSupport.hpp"
+
+using namespace pdal;
+
+namespace
+{
+
+const point_count_t NumPoints = 250000;
+
+// Faux points packed as they would be written to a file.
+struct PackedPoints
+{
+    PackedPoints()
+    {
+        PointTable table;
+        PointViewPtr view = bench::fauxView(table, NumPoints);
+        m_dims = view->dimTypes();
+        m_pointSize = view->pointSize();
+        m_data.resize(m_pointSize * view->size());
+        char *pos = m_data.data();
+        for (PointId i = 0; i < view->size(); ++i)
+        {
+            view->getPackedPoint(m_dims, i, pos);
+            pos += m_pointSize;
+        }
+    }
+
+    DimTypeList m_dims;
+    size_t m_pointSize;
+    std::vector<char> m_data;
+};
+
+
+const PackedPoints& points()
+{
+    static PackedPoints p;
+    return p;
+}
+
+
+template <typename Compressor>
+std::vector<char> compress(const std::function<Compressor *(BlockCb)>& make)
+{
+    const PackedPoints& p = points();
+    std::vector<char> out;
+    std::unique_ptr<Compressor> c(make([&out](char *buf, size_t bufsize)
+        { out.insert(out.end(), buf, buf + bufsize); }));
+    c->compress(p.m_data.data(), p.m_data.size());
+    c->done();
+    return out;
+}
+
+
+template <typename Compressor, typename Decompressor>
+void run(benchmark::State& state,
+    const std::function<Compressor *(BlockCb)>& makeCompressor,
+    const std::function<Decompressor *(BlockCb)>& makeDecompressor)
+{
+    const PackedPoints& p = points();
+    const bool decode = state.range(0);
+    std::vector<char> compressed = compress(makeCompressor);
+
+    for (auto _ : state)
+    {
+        if (decode)
+        {
+            size_t total = 0;
+            std::unique_ptr<Decompressor> d(makeDecompressor(
+                [&total](char *, size_t bufsize){ total += bufsize; }));
+            d->decompress(compressed.data(), compressed.size());
+            d->done();
+            benchmark::DoNotOptimize(total);
+        }
+        else
+            benchmark::DoNotOptimize(compress(makeCompressor));
+    }
+    state.SetBytesProcessed(state.iterations() * p.m_data.size());
+    state.counters["ratio"] = (double)p.m_data.size() / compressed.size();
+}
+
+
+void BM_Delta(benchmark::State& state)
+{
+    const DimTypeList& dims = points().m_dims;
+    run<DeltaCompressor, DeltaDecompressor>(state,
+        [&dims](BlockCb cb){ return new DeltaCompressor(cb, dims); },
+        [&dims](BlockCb cb){ return new DeltaDecompressor(cb, dims); });
+}
+BENCHMARK(BM_Delta)->ArgName("decode")->Arg(0)->Arg(1)->
+    Unit(benchmark::kMillisecond);
+
+
+#ifdef PDAL_HAVE_ZLIB
+void BM_Deflate(benchmark::State& state)
+{
+    run<DeflateCompressor, DeflateDecompressor>(state,
+        [](BlockCb cb){ return new DeflateCompressor(cb); },
+        [](BlockCb cb){ return new DeflateDecompressor(cb); });
+}
+BENCHMARK(BM_Deflate)->ArgName("decode")->Arg(0)->Arg(1)->
+    Unit(benchmark::kMillisecond);
+#endif
+
+
+#ifdef PDAL_HAVE_LAZPERF
+void BM_LazPerf(benchmark::State& state)
+{
+    const DimTypeList& dims = points().m_dims;
+    run<LazPerfCompressor, LazPerfDecompressor>(state,
+        [&dims](BlockCb cb){ return new LazPerfCompressor(cb, dims); },
+        [&dims](BlockCb cb)
+            { return new LazPerfDecompressor(cb, dims, NumPoints); });
+}
+BENCHMARK(BM_LazPerf)->ArgName("decode")->Arg(0)->Arg(1)->
+    Unit(benchmark::kMillisecond);
+#endif
+
+
+#ifdef PDAL_HAVE_LZ4
+void BM_Lz4(benchmark::State& state)
+{
+    run<Lz4Compressor, Lz4Decompressor>(state,
+        [](BlockCb cb){ return new Lz4Compressor(cb); },
+        [](BlockCb cb){ return new Lz4Decompressor(cb); });
+}
+BENCHMARK(BM_Lz4)->ArgName("decode")->Arg(0)->Arg(1)->
+    Unit(benchmark::kMillisecond);
+#endif
+
+
+#ifdef PDAL_HAVE_LZMA
+void BM_Lzma(benchmark::State& state)
+{
+    run<LzmaCompressor, LzmaDecompressor>(state,
+        [](BlockCb cb){ return new LzmaCompressor(cb); },
+        [](BlockCb cb){ return new LzmaDecompressor(cb); });
+}
+BENCHMARK(BM_Lzma)->ArgName("decode")->Arg(0)->Arg(1)->
+    Unit(benchmark::kMillisecond);
+#endif
+
+
+#ifdef PDAL_HAVE_ZSTD
+void BM_Zstd(benchmark::State& state)
+{
+    run<ZstdCompressor, ZstdDecompressor>(state,
+        [](BlockCb cb){ return new ZstdCompressor(cb); },
+        [](BlockCb cb){ return new ZstdDecompressor(cb); });
+}
+BENCHMARK(BM_Zstd)->ArgName("decode")->Arg(0)->Arg(1)->
+    Unit(benchmark::kMillisecond);
+#endif
+
+} // unnamed namespace
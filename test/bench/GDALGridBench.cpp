@@ -0,0 +1,112 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+
+#include <io/private/GDALGrid.hpp>
+
+#include "BenchSupport.hpp"
+
+using namespace pdal;
+
+namespace
+{
+
+const size_t NumPoints = 1000000;
+const size_t GridSize = 1000;
+
+void makeCoords(std::vector<double>& x, std::vector<double>& y,
+    std::vector<double>& z)
+{
+    std::mt19937 gen(bench::Seed);
+    std::uniform_real_distribution<double> xy(0.0, (double)GridSize);
+    std::uniform_real_distribution<double> elev(0.0, 100.0);
+
+    x.resize(NumPoints);
+    y.resize(NumPoints);
+    z.resize(NumPoints);
+    for (size_t i = 0; i < NumPoints; ++i)
+    {
+        x[i] = xy(gen);
+        y[i] = xy(gen);
+        z[i] = elev(gen);
+    }
+}
+
+
+// The radius (in cells) is the benchmark argument, since it determines
+// how many cells each point touches.
+void BM_GDALGridAddPoint(benchmark::State& state)
+{
+    std::vector<double> x, y, z;
+    makeCoords(x, y, z);
+    const double radius = (double)state.range(0);
+
+    for (auto _ : state)
+    {
+        GDALGrid grid(GridSize, GridSize, 1.0, radius, GDALGrid::statMin |
+            GDALGrid::statMax | GDALGrid::statMean | GDALGrid::statIdw,
+            0, 1.0);
+        for (size_t i = 0; i < NumPoints; ++i)
+            grid.addPoint(x[i], y[i], z[i]);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * NumPoints);
+}
+BENCHMARK(BM_GDALGridAddPoint)->Arg(1)->Arg(3)->
+    Unit(benchmark::kMillisecond);
+
+
+void BM_GDALGridAddPoints(benchmark::State& state)
+{
+    std::vector<double> x, y, z;
+    makeCoords(x, y, z);
+
+    for (auto _ : state)
+    {
+        GDALGrid grid(GridSize, GridSize, 1.0, 1.0, GDALGrid::statMin |
+            GDALGrid::statMax | GDALGrid::statMean | GDALGrid::statIdw,
+            0, 1.0);
+        grid.addPoints(x, y, z, (int)state.range(0));
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * NumPoints);
+}
+BENCHMARK(BM_GDALGridAddPoints)->ArgName("threads")->Arg(1)->Arg(4)->
+    Unit(benchmark::kMillisecond)->UseRealTime();
+
+} // unnamed namespace
@@ -0,0 +1,117 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#include <benchmark/benchmark.h>
+
+#include <pdal/KDIndex.hpp>
+#include <pdal/PointTable.hpp>
+
+#include "BenchSupport.hpp"
+
+using namespace pdal;
+
+namespace
+{
+
+void BM_KD3IndexBuild(benchmark::State& state)
+{
+    PointTable table;
+    PointViewPtr view = bench::fauxView(table, state.range(0));
+
+    for (auto _ : state)
+    {
+        KD3Index index(*view);
+        index.build();
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * view->size());
+}
+BENCHMARK(BM_KD3IndexBuild)->Arg(100000)->Arg(1000000)->
+    Unit(benchmark::kMillisecond);
+
+
+void BM_KD3IndexKnn(benchmark::State& state)
+{
+    PointTable table;
+    PointViewPtr view = bench::fauxView(table, 100000);
+    KD3Index index(*view);
+    index.build();
+    const point_count_t k = (point_count_t)state.range(0);
+
+    PointId idx = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(index.neighbors(idx, k));
+        idx = (idx + 1) % view->size();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_KD3IndexKnn)->Arg(8)->Arg(64);
+
+
+// Batch k-nearest-neighbor query of every indexed point.
+void BM_KD3IndexKnnAll(benchmark::State& state)
+{
+    PointTable table;
+    PointViewPtr view = bench::fauxView(table, 100000);
+    KD3Index index(*view);
+    index.build();
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(index.knnAll(8));
+    state.SetItemsProcessed(state.iterations() * view->size());
+}
+BENCHMARK(BM_KD3IndexKnnAll)->Unit(benchmark::kMillisecond);
+
+
+void BM_KD3IndexRadius(benchmark::State& state)
+{
+    PointTable table;
+    PointViewPtr view = bench::fauxView(table, 100000);
+    KD3Index index(*view);
+    index.build();
+    const double r = (double)state.range(0);
+
+    PointId idx = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(index.radius(idx, r));
+        idx = (idx + 1) % view->size();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_KD3IndexRadius)->Arg(5)->Arg(20);
+
+} // unnamed namespace
@@ -0,0 +1,252 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#include <benchmark/benchmark.h>
+
+#include <io/BufferReader.hpp>
+#include <io/LasReader.hpp>
+#include <io/LasWriter.hpp>
+#include <pdal/PointTable.hpp>
+#include <pdal/pdal_features.hpp>
+#include <pdal/util/FileUtils.hpp>
+
+#include "BenchSupport.hpp"
+
+using namespace pdal;
+
+namespace pdal
+{
+
+// Decodes points from a buffer with the reader's point-at-a-time and batch
+// decoders, which are private.
+class LasDecodeBench
+{
+public:
+    static void loadPoint(LasReader& reader, PointView& view,
+        const char *buf, point_count_t count)
+    {
+        const size_t pointLen = reader.header().pointLen();
+        for (PointId i = 0; i < count; ++i)
+        {
+            PointRef point(view, i);
+            reader.loadPoint(point, const_cast<char *>(buf + i * pointLen),
+                pointLen);
+        }
+    }
+
+    static void loadPoints(LasReader& reader, PointView& view,
+        const char *buf, point_count_t count)
+    {
+        reader.loadPoints(view, buf, count);
+    }
+};
+
+} // namespace pdal
+
+namespace
+{
+
+const point_count_t NumPoints = 1000000;
+
+void write(PointViewPtr view, const std::string& filename,
+    const std::string& compression, int format = 3)
+{
+    BufferReader reader;
+    reader.addView(view);
+
+    Options opts;
+    opts.add("filename", filename);
+    opts.add("compression", compression);
+    opts.add("scale_x", .01);
+    opts.add("scale_y", .01);
+    opts.add("scale_z", .01);
+    opts.add("dataformat_id", format);
+    if (format >= 6)
+        opts.add("minor_version", 4);
+
+    LasWriter writer;
+    writer.setOptions(opts);
+    writer.setInput(reader);
+
+    PointTable table;
+    writer.prepare(table);
+    writer.execute(table);
+}
+
+
+void encode(benchmark::State& state, const std::string& name,
+    const std::string& compression)
+{
+    PointTable table;
+    PointViewPtr view = bench::fauxView(table, NumPoints);
+    std::string filename = bench::tempFile(name);
+
+    for (auto _ : state)
+        write(view, filename, compression);
+    state.SetItemsProcessed(state.iterations() * NumPoints);
+    FileUtils::deleteFile(filename);
+}
+
+
+void decode(benchmark::State& state, const std::string& name,
+    const std::string& compression)
+{
+    std::string filename = bench::tempFile(name);
+    {
+        PointTable table;
+        write(bench::fauxView(table, NumPoints), filename, compression);
+    }
+
+    for (auto _ : state)
+    {
+        Options opts;
+        opts.add("filename", filename);
+
+        LasReader reader;
+        reader.setOptions(opts);
+
+        PointTable table;
+        reader.prepare(table);
+        benchmark::DoNotOptimize(reader.execute(table));
+    }
+    state.SetItemsProcessed(state.iterations() * NumPoints);
+    FileUtils::deleteFile(filename);
+}
+
+
+void BM_LasEncode(benchmark::State& state)
+{
+    encode(state, "encode.las", "none");
+}
+BENCHMARK(BM_LasEncode)->Unit(benchmark::kMillisecond);
+
+
+void BM_LasDecode(benchmark::State& state)
+{
+    decode(state, "decode.las", "none");
+}
+BENCHMARK(BM_LasDecode)->Unit(benchmark::kMillisecond);
+
+
+// Decode the points of an uncompressed file of the point format given by
+// the benchmark's argument from memory, without file I/O, either a point
+// at a time or in one batch.
+void loadPoints(benchmark::State& state, bool batch)
+{
+    const int format = (int)state.range(0);
+    std::string filename =
+        bench::tempFile("load" + std::to_string(format) + ".las");
+    {
+        PointTable table;
+        write(bench::fauxView(table, NumPoints), filename, "none", format);
+    }
+
+    Options opts;
+    opts.add("filename", filename);
+    LasReader reader;
+    reader.setOptions(opts);
+    PointTable table;
+    reader.prepare(table);
+
+    const LasHeader& h = reader.header();
+    std::string data = FileUtils::readFileIntoString(filename);
+    const char *buf = data.data() + h.pointOffset();
+    const point_count_t count = h.pointCount();
+
+    for (auto _ : state)
+    {
+        {
+            PointView view(table);
+            if (batch)
+                LasDecodeBench::loadPoints(reader, view, buf, count);
+            else
+                LasDecodeBench::loadPoint(reader, view, buf, count);
+            benchmark::DoNotOptimize(view.size());
+        }
+        // Free the points of the run so that each run fills new storage.
+        state.PauseTiming();
+        table.releaseUnreferenced();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+    FileUtils::deleteFile(filename);
+}
+
+
+void BM_LasLoadPoint(benchmark::State& state)
+{
+    loadPoints(state, false);
+}
+BENCHMARK(BM_LasLoadPoint)->Arg(3)->Arg(6)->Unit(benchmark::kMillisecond);
+
+
+void BM_LasLoadPoints(benchmark::State& state)
+{
+    loadPoints(state, true);
+}
+BENCHMARK(BM_LasLoadPoints)->Arg(3)->Arg(6)->Unit(benchmark::kMillisecond);
+
+
+#ifdef PDAL_HAVE_LAZPERF
+void BM_LazPerfEncode(benchmark::State& state)
+{
+    encode(state, "encode_lazperf.laz", "lazperf");
+}
+BENCHMARK(BM_LazPerfEncode)->Unit(benchmark::kMillisecond);
+
+
+void BM_LazPerfDecode(benchmark::State& state)
+{
+    decode(state, "decode_lazperf.laz", "lazperf");
+}
+BENCHMARK(BM_LazPerfDecode)->Unit(benchmark::kMillisecond);
+#endif
+
+#ifdef PDAL_HAVE_LASZIP
+void BM_LaszipEncode(benchmark::State& state)
+{
+    encode(state, "encode_laszip.laz", "laszip");
+}
+BENCHMARK(BM_LaszipEncode)->Unit(benchmark::kMillisecond);
+
+
+void BM_LaszipDecode(benchmark::State& state)
+{
+    decode(state, "decode_laszip.laz", "laszip");
+}
+BENCHMARK(BM_LaszipDecode)->Unit(benchmark::kMillisecond);
+#endif
+
+} // unnamed namespace
@@ -0,0 +1,188 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#include <benchmark/benchmark.h>
+
+#include <pdal/PointTable.hpp>
+#include <pdal/PointView.hpp>
+
+#include "BenchSupport.hpp"
+
+using namespace pdal;
+
+namespace
+{
+
+const point_count_t NumPoints = 1000000;
+
+template <typename T>
+void getField(benchmark::State& state, Dimension::Id dim)
+{
+    PointTable table;
+    PointViewPtr view = bench::fauxView(table, NumPoints);
+
+    for (auto _ : state)
+    {
+        T sum(0);
+        for (PointId i = 0; i < view->size(); ++i)
+            sum += view->getFieldAs<T>(dim, i);
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * view->size());
+}
+
+
+template <typename T>
+void setField(benchmark::State& state, Dimension::Id dim)
+{
+    PointTable table;
+    PointViewPtr view = bench::fauxView(table, NumPoints);
+
+    for (auto _ : state)
+    {
+        for (PointId i = 0; i < view->size(); ++i)
+            view->setField(dim, i, (T)(i % 100));
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * view->size());
+}
+
+
+// Values stored as double, read as the same type.
+void BM_PointViewGetDouble(benchmark::State& state)
+{
+    getField<double>(state, Dimension::Id::X);
+}
+BENCHMARK(BM_PointViewGetDouble);
+
+
+// Values stored as uint8_t, read as the same type.
+void BM_PointViewGetUint8(benchmark::State& state)
+{
+    getField<uint8_t>(state, Dimension::Id::ReturnNumber);
+}
+BENCHMARK(BM_PointViewGetUint8);
+
+
+// Values stored as uint8_t, converted to double.
+void BM_PointViewGetUint8AsDouble(benchmark::State& state)
+{
+    getField<double>(state, Dimension::Id::ReturnNumber);
+}
+BENCHMARK(BM_PointViewGetUint8AsDouble);
+
+
+// Values stored as double, converted to int32_t with a range check.
+void BM_PointViewGetDoubleAsInt(benchmark::State& state)
+{
+    getField<int32_t>(state, Dimension::Id::Z);
+}
+BENCHMARK(BM_PointViewGetDoubleAsInt);
+
+
+void BM_PointViewSetDouble(benchmark::State& state)
+{
+    setField<double>(state, Dimension::Id::X);
+}
+BENCHMARK(BM_PointViewSetDouble);
+
+
+void BM_PointViewSetUint8(benchmark::State& state)
+{
+    setField<uint8_t>(state, Dimension::Id::ReturnNumber);
+}
+BENCHMARK(BM_PointViewSetUint8);
+
+
+// Access through a PointRef, which looks up the point in the table for
+// each field.
+void BM_PointRefGetXYZ(benchmark::State& state)
+{
+    PointTable table;
+    PointViewPtr view = bench::fauxView(table, NumPoints);
+    PointRef point(*view, 0);
+
+    for (auto _ : state)
+    {
+        double sum(0);
+        for (PointId i = 0; i < view->size(); ++i)
+        {
+            point.setPointId(i);
+            sum += point.getFieldAs<double>(Dimension::Id::X) +
+                point.getFieldAs<double>(Dimension::Id::Y) +
+                point.getFieldAs<double>(Dimension::Id::Z);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * view->size());
+}
+BENCHMARK(BM_PointRefGetXYZ);
+
+
+// Raw point lookup in the table.
+void BM_PointTableGetPoint(benchmark::State& state)
+{
+    PointTable table;
+    PointViewPtr view = bench::fauxView(table, NumPoints);
+
+    for (auto _ : state)
+    {
+        for (PointId i = 0; i < view->size(); ++i)
+            benchmark::DoNotOptimize(view->getPoint(i));
+    }
+    state.SetItemsProcessed(state.iterations() * view->size());
+}
+BENCHMARK(BM_PointTableGetPoint);
+
+
+// Copy of all dimensions of each point into a packed buffer.
+void BM_PointViewGetPackedPoint(benchmark::State& state)
+{
+    PointTable table;
+    PointViewPtr view = bench::fauxView(table, NumPoints);
+    DimTypeList dims = view->dimTypes();
+    std::vector<char> buf(view->pointSize());
+
+    for (auto _ : state)
+    {
+        for (PointId i = 0; i < view->size(); ++i)
+            view->getPackedPoint(dims, i, buf.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * view->size());
+}
+BENCHMARK(BM_PointViewGetPackedPoint);
+
+} // unnamed namespace
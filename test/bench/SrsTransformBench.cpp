@@ -0,0 +1,116 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+
+#include <pdal/SpatialReference.hpp>
+#include <pdal/private/SrsTransform.hpp>
+
+#include "BenchSupport.hpp"
+
+using namespace pdal;
+
+namespace
+{
+
+const size_t NumPoints = 100000;
+
+void makeCoords(std::vector<double>& x, std::vector<double>& y,
+    std::vector<double>& z)
+{
+    std::mt19937 gen(bench::Seed);
+    std::uniform_real_distribution<double> lon(-84.0, -78.0);
+    std::uniform_real_distribution<double> lat(0.0, 80.0);
+    std::uniform_real_distribution<double> elev(0.0, 1000.0);
+
+    x.resize(NumPoints);
+    y.resize(NumPoints);
+    z.resize(NumPoints);
+    for (size_t i = 0; i < NumPoints; ++i)
+    {
+        x[i] = lon(gen);
+        y[i] = lat(gen);
+        z[i] = elev(gen);
+    }
+}
+
+
+// One call per point, as a filter working point-by-point does.
+void BM_SrsTransformSingle(benchmark::State& state)
+{
+    SrsTransform xform(SpatialReference("EPSG:4326"),
+        SpatialReference("EPSG:32617"));
+    std::vector<double> x, y, z;
+    makeCoords(x, y, z);
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        std::vector<double> xs(x), ys(y), zs(z);
+        state.ResumeTiming();
+
+        for (size_t i = 0; i < NumPoints; ++i)
+            xform.transform(xs[i], ys[i], zs[i]);
+        benchmark::DoNotOptimize(xs.data());
+    }
+    state.SetItemsProcessed(state.iterations() * NumPoints);
+}
+BENCHMARK(BM_SrsTransformSingle)->Unit(benchmark::kMillisecond);
+
+
+// One call for all points.
+void BM_SrsTransformBatch(benchmark::State& state)
+{
+    SrsTransform xform(SpatialReference("EPSG:4326"),
+        SpatialReference("EPSG:32617"));
+    std::vector<double> x, y, z;
+    makeCoords(x, y, z);
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        std::vector<double> xs(x), ys(y), zs(z);
+        state.ResumeTiming();
+
+        xform.transform(xs, ys, zs);
+        benchmark::DoNotOptimize(xs.data());
+    }
+    state.SetItemsProcessed(state.iterations() * NumPoints);
+}
+BENCHMARK(BM_SrsTransformBatch)->Unit(benchmark::kMillisecond);
+
+} // unnamed namespace
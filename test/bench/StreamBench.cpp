@@ -0,0 +1,117 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#include <benchmark/benchmark.h>
+
+#include <list>
+
+#include <filters/StreamCallbackFilter.hpp>
+#include <io/FauxReader.hpp>
+#include <pdal/PointTable.hpp>
+
+#include "BenchSupport.hpp"
+
+using namespace pdal;
+
+namespace
+{
+
+const point_count_t NumPoints = 1000000;
+
+// Build a reader followed by a chain of state.range(0) trivial filters.
+Stage& makeChain(FauxReader& reader, std::list<StreamCallbackFilter>& filters,
+    int count, double& sum)
+{
+    reader.setOptions(bench::fauxOptions(NumPoints));
+
+    Stage *last = &reader;
+    for (int i = 0; i < count; ++i)
+    {
+        filters.emplace_back();
+        StreamCallbackFilter& f = filters.back();
+        f.setCallback([&sum](PointRef& p)
+            {
+                sum += p.getFieldAs<double>(Dimension::Id::X);
+                return true;
+            });
+        f.setInput(*last);
+        last = &f;
+    }
+    return *last;
+}
+
+
+// Per-point cost of streaming through a chain of filters.
+void BM_StreamFilterChain(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        double sum(0);
+        FauxReader reader;
+        std::list<StreamCallbackFilter> filters;
+        Stage& last = makeChain(reader, filters, (int)state.range(0), sum);
+
+        FixedPointTable table(10000);
+        last.prepare(table);
+        last.execute(table);
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * NumPoints);
+}
+BENCHMARK(BM_StreamFilterChain)->Arg(1)->Arg(4)->Arg(16)->
+    Unit(benchmark::kMillisecond);
+
+
+// The same chain run in standard mode, for comparison.
+void BM_StandardFilterChain(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        double sum(0);
+        FauxReader reader;
+        std::list<StreamCallbackFilter> filters;
+        Stage& last = makeChain(reader, filters, (int)state.range(0), sum);
+
+        PointTable table;
+        last.prepare(table);
+        last.execute(table);
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * NumPoints);
+}
+BENCHMARK(BM_StandardFilterChain)->Arg(1)->Arg(4)->Arg(16)->
+    Unit(benchmark::kMillisecond);
+
+} // unnamed namespace
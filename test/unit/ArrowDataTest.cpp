@@ -0,0 +1,217 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <pdal/ArrowData.hpp>
+#include <pdal/PointTable.hpp>
+#include <io/ArrowDataReader.hpp>
+
+namespace pdal
+{
+
+namespace
+{
+
+const point_count_t NumPoints = 100;
+
+PointViewPtr makeView(BasePointTable& table)
+{
+    using namespace Dimension;
+
+    table.layout()->registerDim(Id::X);
+    table.layout()->registerDim(Id::Intensity);
+    table.layout()->registerDim(Id::Classification);
+    table.finalize();
+
+    PointViewPtr view(new PointView(table));
+    for (PointId idx = 0; idx < NumPoints; ++idx)
+    {
+        view->setField(Id::X, idx, idx * 1.5);
+        view->setField(Id::Intensity, idx, idx * 10);
+        view->setField(Id::Classification, idx, idx % 7);
+    }
+    return view;
+}
+
+void checkArray(const ArrowSchema& schema, const ArrowArray& array,
+    point_count_t count)
+{
+    ASSERT_STREQ(schema.format, "+s");
+    ASSERT_EQ(schema.n_children, 3);
+    EXPECT_STREQ(schema.children[0]->name, "X");
+    EXPECT_STREQ(schema.children[0]->format, "g");
+    EXPECT_STREQ(schema.children[1]->name, "Intensity");
+    EXPECT_STREQ(schema.children[1]->format, "S");
+    EXPECT_STREQ(schema.children[2]->name, "Classification");
+    EXPECT_STREQ(schema.children[2]->format, "C");
+
+    ASSERT_EQ(array.length, (int64_t)count);
+    ASSERT_EQ(array.n_children, 3);
+    const double *x =
+        static_cast<const double *>(array.children[0]->buffers[1]);
+    const uint16_t *intensity =
+        static_cast<const uint16_t *>(array.children[1]->buffers[1]);
+    for (PointId idx = 0; idx < count; ++idx)
+    {
+        EXPECT_EQ(x[idx], idx * 1.5);
+        EXPECT_EQ(intensity[idx], idx * 10);
+    }
+}
+
+} // unnamed namespace
+
+TEST(ArrowDataTest, exportView)
+{
+    PointTable table;
+    PointViewPtr view = makeView(table);
+
+    ArrowSchema schema;
+    ArrowArray array;
+    arrowdata::exportView(view, &schema, &array);
+    checkArray(schema, array, NumPoints);
+
+    schema.release(&schema);
+    array.release(&array);
+    EXPECT_EQ(schema.release, nullptr);
+    EXPECT_EQ(array.release, nullptr);
+}
+
+// The arrays of a column table's view refer to the table's columns and
+// keep the view alive.
+TEST(ArrowDataTest, exportColumns)
+{
+    using namespace Dimension;
+
+    ColumnPointTable table;
+    PointViewPtr view = makeView(table);
+    const double *x = table.dimensionData<double>(Id::X);
+
+    ArrowSchema schema;
+    ArrowArray array;
+    arrowdata::exportView(view, &schema, &array);
+    view.reset();
+    checkArray(schema, array, NumPoints);
+    EXPECT_EQ(array.children[0]->buffers[1], x);
+
+    // A child can be moved out of its parent and outlive it.
+    ArrowArray child = *array.children[1];
+    array.children[1]->release = nullptr;
+    array.release(&array);
+    schema.release(&schema);
+    EXPECT_EQ(static_cast<const uint16_t *>(child.buffers[1])[5], 50);
+    child.release(&child);
+}
+
+TEST(ArrowDataTest, exportTable)
+{
+    using namespace Dimension;
+
+    FixedPointTable table(10);
+    table.layout()->registerDim(Id::X);
+    table.layout()->registerDim(Id::Intensity);
+    table.layout()->registerDim(Id::Classification);
+    table.finalize();
+    table.clear(5);
+    for (PointId idx = 0; idx < 5; ++idx)
+    {
+        PointRef point(table, idx);
+        point.setField(Id::X, idx * 1.5);
+        point.setField(Id::Intensity, idx * 10);
+    }
+    table.setSkip(4);
+
+    ArrowSchema schema;
+    ArrowArray array;
+    arrowdata::exportTable(table, &schema, &array);
+    checkArray(schema, array, 4);
+    schema.release(&schema);
+    array.release(&array);
+}
+
+TEST(ArrowDataTest, read)
+{
+    using namespace Dimension;
+
+    ArrowDataReader reader;
+    for (int i = 0; i < 2; ++i)
+    {
+        PointTable table;
+        PointViewPtr view = makeView(table);
+
+        ArrowSchema schema;
+        ArrowArray array;
+        arrowdata::exportView(view, &schema, &array);
+        reader.addBatch(&schema, &array);
+        EXPECT_EQ(schema.release, nullptr);
+        EXPECT_EQ(array.release, nullptr);
+    }
+
+    PointTable table;
+    reader.prepare(table);
+    PointViewSet s = reader.execute(table);
+    PointViewPtr view = *s.begin();
+    ASSERT_EQ(view->size(), 2 * NumPoints);
+    for (PointId idx = 0; idx < view->size(); ++idx)
+    {
+        PointId i = idx % NumPoints;
+        EXPECT_EQ(view->getFieldAs<double>(Id::X, idx), i * 1.5);
+        EXPECT_EQ(view->getFieldAs<int>(Id::Intensity, idx), (int)i * 10);
+        EXPECT_EQ(view->getFieldAs<int>(Id::Classification, idx),
+            (int)i % 7);
+    }
+}
+
+TEST(ArrowDataTest, readMismatch)
+{
+    PointTable table1;
+    ArrowSchema schema;
+    ArrowArray array;
+    arrowdata::exportView(makeView(table1), &schema, &array);
+
+    ArrowDataReader reader;
+    reader.addBatch(&schema, &array);
+
+    PointTable table2;
+    table2.layout()->registerDim(Dimension::Id::Y);
+    table2.finalize();
+    PointViewPtr view(new PointView(table2));
+    view->setField(Dimension::Id::Y, 0, 1.0);
+    arrowdata::exportView(view, &schema, &array);
+    EXPECT_THROW(reader.addBatch(&schema, &array), pdal_error);
+    EXPECT_EQ(schema.release, nullptr);
+    EXPECT_EQ(array.release, nullptr);
+}
+
+} // namespace pdal
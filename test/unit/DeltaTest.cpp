@@ -0,0 +1,170 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <random>
+
+#include <pdal/compression/DeltaCompression.hpp>
+
+using namespace pdal;
+
+namespace
+{
+
+// Ordered so that the struct has no padding and matches the packed layout.
+struct Point
+{
+    double gpsTime;
+    int64_t big;
+    int32_t x;
+    int32_t y;
+    int32_t z;
+    uint16_t intensity;
+    int8_t scanAngle;
+    uint8_t classification;
+};
+
+DimTypeList dims()
+{
+    using namespace Dimension;
+
+    return DimTypeList {
+        { Id::GpsTime, Type::Double },
+        { Id::OffsetTime, Type::Signed64 },
+        { Id::X, Type::Signed32 },
+        { Id::Y, Type::Signed32 },
+        { Id::Z, Type::Signed32 },
+        { Id::Intensity, Type::Unsigned16 },
+        { Id::ScanAngleRank, Type::Signed8 },
+        { Id::Classification, Type::Unsigned8 }
+    };
+}
+
+std::vector<char> roundTrip(const std::vector<Point>& points,
+    size_t& compressedSize, size_t pieceSize)
+{
+    std::vector<char> compressed;
+    DeltaCompressor compressor([&compressed](char *buf, size_t bufsize)
+        { compressed.insert(compressed.end(), buf, buf + bufsize); },
+        dims());
+
+    const char *sp = reinterpret_cast<const char *>(points.data());
+    const size_t s = points.size() * sizeof(Point);
+    for (size_t pos = 0; pos < s; pos += pieceSize)
+        compressor.compress(sp + pos, (std::min)(pieceSize, s - pos));
+    compressor.done();
+    compressedSize = compressed.size();
+
+    std::vector<char> out;
+    DeltaDecompressor decompressor([&out](char *buf, size_t bufsize)
+        { out.insert(out.end(), buf, buf + bufsize); },
+        dims());
+    for (size_t pos = 0; pos < compressed.size(); pos += pieceSize)
+        decompressor.decompress(compressed.data() + pos,
+            (std::min)(pieceSize, compressed.size() - pos));
+    decompressor.done();
+    return out;
+}
+
+} // unnamed namespace
+
+TEST(Compression, delta)
+{
+    std::default_random_engine generator;
+    std::uniform_int_distribution<int> step(-50, 50);
+    std::uniform_int_distribution<int64_t> any(
+        (std::numeric_limits<int64_t>::min)());
+
+    // Spatially coherent points with a few noisy dimensions.
+    std::vector<Point> points(100357);
+    Point p { 300000.0, 0, 1000, -1000, 0, 0, 0, 0 };
+    for (Point& pt : points)
+    {
+        p.x += step(generator);
+        p.y += step(generator);
+        p.z += step(generator);
+        p.intensity = (uint16_t)(p.intensity + step(generator));
+        p.scanAngle = (int8_t)step(generator);
+        p.classification = (uint8_t)(step(generator) > 40 ? 6 : 2);
+        p.gpsTime += .0001;
+        p.big = any(generator);
+        pt = p;
+    }
+
+    const char *sp = reinterpret_cast<const char *>(points.data());
+    const size_t s = points.size() * sizeof(Point);
+    for (size_t pieceSize : { (size_t)s, (size_t)3333 })
+    {
+        size_t compressedSize;
+        std::vector<char> out = roundTrip(points, compressedSize, pieceSize);
+        ASSERT_EQ(out.size(), s);
+        EXPECT_EQ(memcmp(out.data(), sp, s), 0);
+        EXPECT_LT(compressedSize, s);
+    }
+}
+
+TEST(Compression, deltaConstant)
+{
+    // Constant dimensions pack to nothing but the block headers.
+    std::vector<Point> points(5000);
+    for (Point& p : points)
+        p = { 1.0, 2, 3, 4, 5, 6, 7, 8 };
+
+    size_t compressedSize;
+    std::vector<char> out = roundTrip(points, compressedSize, 1000);
+    ASSERT_EQ(out.size(), points.size() * sizeof(Point));
+    EXPECT_EQ(memcmp(out.data(), points.data(), out.size()), 0);
+    EXPECT_LT(compressedSize, 500u);
+}
+
+TEST(Compression, deltaTruncated)
+{
+    std::vector<Point> points(10);
+    std::vector<char> compressed;
+    DeltaCompressor compressor([&compressed](char *buf, size_t bufsize)
+        { compressed.insert(compressed.end(), buf, buf + bufsize); },
+        dims());
+    compressor.compress(reinterpret_cast<const char *>(points.data()),
+        points.size() * sizeof(Point));
+    compressor.done();
+
+    DeltaDecompressor decompressor([](char *, size_t){}, dims());
+    decompressor.decompress(compressed.data(), compressed.size() - 1);
+    EXPECT_THROW(decompressor.done(), compression_error);
+
+    DeltaCompressor partial([](char *, size_t){}, dims());
+    partial.compress(compressed.data(), 3);
+    EXPECT_THROW(partial.done(), compression_error);
+}
@@ -0,0 +1,165 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <cmath>
+#include <limits>
+
+#include <pdal/DimSummary.hpp>
+#include <pdal/PointView.hpp>
+
+using namespace pdal;
+
+namespace
+{
+
+void fill(PointView& view, point_count_t count)
+{
+    uint32_t seed = 97531;
+    auto next = [&seed]()
+    {
+        seed = seed * 1664525 + 1013904223;
+        return (seed >> 8);
+    };
+    for (PointId i = 0; i < count; ++i)
+    {
+        view.setField(Dimension::Id::X, i, next() / 1000.0 - 5000.0);
+        view.setField(Dimension::Id::Y, i, next() / 100.0);
+        view.setField(Dimension::Id::Intensity, i, next() & 0xFFFF);
+    }
+}
+
+} // unnamed namespace
+
+TEST(DimSummaryTest, summary)
+{
+    using namespace Dimension;
+
+    PointTable table;
+    table.layout()->registerDims({ Id::X, Id::Y, Id::Intensity });
+    PointView view(table);
+    fill(view, 1000);
+
+    DimSummaryList s = summarizeDims(view, { Id::Intensity, Id::X, Id::Z });
+    ASSERT_EQ(s.size(), 3u);
+
+    DimSummary intensity;
+    DimSummary x;
+    for (PointId i = 0; i < view.size(); ++i)
+    {
+        intensity.add(view.getFieldAs<double>(Id::Intensity, i));
+        x.add(view.getFieldAs<double>(Id::X, i));
+    }
+    EXPECT_EQ(s[0].minimum, intensity.minimum);
+    EXPECT_EQ(s[0].maximum, intensity.maximum);
+    EXPECT_EQ(s[0].sum, intensity.sum);
+    EXPECT_EQ(s[0].sumSq, intensity.sumSq);
+    EXPECT_EQ(s[0].count, 1000u);
+    EXPECT_EQ(s[1].minimum, x.minimum);
+    EXPECT_EQ(s[1].maximum, x.maximum);
+    EXPECT_DOUBLE_EQ(s[1].mean(), x.mean());
+
+    // A dimension that the view doesn't have reads as 0.
+    EXPECT_EQ(s[2].minimum, 0);
+    EXPECT_EQ(s[2].maximum, 0);
+    EXPECT_EQ(s[2].count, 1000u);
+
+    // An empty view.
+    PointView empty(table);
+    DimSummaryList e = summarizeDims(empty, { Id::X });
+    EXPECT_EQ(e[0].count, 0u);
+    BOX3D box;
+    empty.calculateBounds(box);
+    EXPECT_TRUE(box.empty());
+}
+
+TEST(DimSummaryTest, nan)
+{
+    using namespace Dimension;
+
+    PointTable table;
+    table.layout()->registerDims({ Id::X, Id::Y, Id::Z });
+    PointView view(table);
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    view.setField(Id::X, 0, nan);
+    view.setField(Id::Y, 0, 2.0);
+    view.setField(Id::Z, 0, nan);
+    view.setField(Id::X, 1, 1.0);
+    view.setField(Id::Y, 1, nan);
+    view.setField(Id::Z, 1, nan);
+
+    // NaN values are ignored by the bounds, as with BOX3D::grow().
+    BOX3D box;
+    view.calculateBounds(box);
+    BOX3D expected;
+    expected.grow(nan, 2.0, nan);
+    expected.grow(1.0, nan, nan);
+    EXPECT_EQ(box.minx, expected.minx);
+    EXPECT_EQ(box.maxx, expected.maxx);
+    EXPECT_EQ(box.miny, expected.miny);
+    EXPECT_EQ(box.maxy, expected.maxy);
+    EXPECT_EQ(box.minz, expected.minz);
+    EXPECT_EQ(box.maxz, expected.maxz);
+}
+
+TEST(DimSummaryTest, threaded)
+{
+    using namespace Dimension;
+
+    PointTable table;
+    table.layout()->registerDims({ Id::X, Id::Y, Id::Intensity });
+    PointView view(table);
+    fill(view, 2500000);
+
+    DimSummaryList single = summarizeDims(view, { Id::X, Id::Intensity }, 1);
+    DimSummaryList threaded =
+        summarizeDims(view, { Id::X, Id::Intensity }, 4);
+    for (size_t d = 0; d < 2; ++d)
+    {
+        EXPECT_EQ(single[d].minimum, threaded[d].minimum);
+        EXPECT_EQ(single[d].maximum, threaded[d].maximum);
+        EXPECT_EQ(single[d].count, threaded[d].count);
+        EXPECT_NEAR(single[d].sum, threaded[d].sum,
+            std::fabs(single[d].sum) * 1e-12);
+        EXPECT_NEAR(single[d].sumSq, threaded[d].sumSq,
+            single[d].sumSq * 1e-12);
+    }
+    // Integer values are summed exactly.
+    EXPECT_EQ(single[1].sum, threaded[1].sum);
+
+    BOX2D box;
+    view.calculateBounds(box);
+    EXPECT_EQ(box.minx, single[0].minimum);
+    EXPECT_EQ(box.maxx, single[0].maximum);
+}
@@ -41,6 +41,7 @@
 
 #include <limits>
 #include <numeric>
+#include <random>
 
 using namespace pdal;
 
@@ -162,6 +163,53 @@ TEST(EigenTest, Morphological)
     EXPECT_EQ(0, Fv2[12]);
 }
 
+TEST(EigenTest, MorphologicalFast)
+{
+    std::mt19937 gen(13);
+    std::uniform_real_distribution<double> dist(0.0, 100.0);
+
+    auto check = [&](size_t rows, size_t cols, int radius, unsigned threads)
+    {
+        std::vector<double> data(rows * cols);
+        for (double& d : data)
+            d = dist(gen);
+
+        EXPECT_EQ(dilateDiamond(data, rows, cols, radius),
+            dilateDiamondFast(data, rows, cols, radius, threads));
+        EXPECT_EQ(erodeDiamond(data, rows, cols, radius),
+            erodeDiamondFast(data, rows, cols, radius, threads));
+
+        std::vector<double> dilated = dilateSquare(data, rows, cols, radius,
+            threads);
+        std::vector<double> eroded = erodeSquare(data, rows, cols, radius,
+            threads);
+        for (int c = 0; c < (int)cols; ++c)
+            for (int r = 0; r < (int)rows; ++r)
+            {
+                double hi = std::numeric_limits<double>::lowest();
+                double lo = (std::numeric_limits<double>::max)();
+                for (int cc = (std::max)(0, c - radius);
+                        cc <= (std::min)((int)cols - 1, c + radius); ++cc)
+                    for (int rr = (std::max)(0, r - radius);
+                            rr <= (std::min)((int)rows - 1, r + radius); ++rr)
+                    {
+                        hi = (std::max)(hi, data[cc * rows + rr]);
+                        lo = (std::min)(lo, data[cc * rows + rr]);
+                    }
+                EXPECT_EQ(hi, dilated[c * rows + r]);
+                EXPECT_EQ(lo, eroded[c * rows + r]);
+            }
+    };
+
+    for (int radius = 0; radius <= 6; ++radius)
+    {
+        check(17, 23, radius, 1);
+        check(1, 12, radius, 1);
+        check(9, 1, radius, 1);
+    }
+    check(300, 250, 5, 3);
+}
+
 TEST(EigenTest, RoundtripString)
 {
     Eigen::MatrixXd identity = Eigen::MatrixXd::Identity(4, 4);
@@ -235,3 +283,66 @@ TEST(EigenTest, computeCentroid)
     EXPECT_EQ(80, centroid.x());
     EXPECT_EQ(800, centroid.y());
 }
+
+TEST(EigenTest, computeEigen3)
+{
+    using namespace Eigen;
+
+    std::mt19937 gen(3);
+    std::normal_distribution<double> dist(0.0, 1.0);
+
+    // Covariances of random neighborhoods, some of them flat.
+    for (int t = 0; t < 1000; ++t)
+    {
+        const point_count_t count = 3 + t % 20;
+        std::vector<double> coords(count * 3);
+        PointIdList ids(count);
+        std::iota(ids.begin(), ids.end(), 0);
+        const double zscale = (t % 3) ? 1.0 : 0.0;
+        for (PointId i = 0; i < count; ++i)
+        {
+            coords[i * 3] = 1000.0 + 10.0 * dist(gen);
+            coords[i * 3 + 1] = 5.0 * dist(gen);
+            coords[i * 3 + 2] = zscale * dist(gen) + 0.3 * coords[i * 3];
+        }
+
+        Vector3d centroid;
+        Matrix3d B = computeCovariance(coords.data(), ids.data(), count,
+            &centroid);
+        double mx = 0;
+        for (PointId i = 0; i < count; ++i)
+            mx += coords[i * 3];
+        EXPECT_NEAR(centroid.x(), mx / count, 1e-9);
+
+        Vector3d values;
+        Matrix3d vectors;
+        ASSERT_TRUE(computeEigen3(B, values, vectors));
+
+        SelfAdjointEigenSolver<Matrix3d> solver(B);
+        const double scale = solver.eigenvalues().cwiseAbs().maxCoeff();
+        for (int i = 0; i < 3; ++i)
+            EXPECT_NEAR(values[i], solver.eigenvalues()[i], 1e-12 * scale);
+        EXPECT_LE(values[0], values[1]);
+        EXPECT_LE(values[1], values[2]);
+        EXPECT_NEAR((B * vectors - vectors * values.asDiagonal()).norm(), 0,
+            1e-12 * scale);
+        EXPECT_NEAR((vectors.transpose() * vectors -
+            Matrix3d::Identity()).norm(), 0, 1e-12);
+    }
+
+    // A diagonal matrix has the axes as eigenvectors.
+    Matrix3d D;
+    D << 2, 0, 0,
+         0, 0, 0,
+         0, 0, 3;
+    Vector3d values;
+    Matrix3d vectors;
+    EXPECT_TRUE(computeEigen3(D, values, vectors));
+    EXPECT_EQ(values, Vector3d(0, 2, 3));
+    EXPECT_EQ(vectors.col(0), Vector3d(0, 1, 0));
+    EXPECT_EQ(vectors.col(1), Vector3d(1, 0, 0));
+    EXPECT_EQ(vectors.col(2), Vector3d(0, 0, 1));
+
+    D(0, 0) = std::numeric_limits<double>::quiet_NaN();
+    EXPECT_FALSE(computeEigen3(D, values, vectors));
+}
@@ -0,0 +1,114 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <pdal/PointView.hpp>
+#include <filters/private/ExternalSort.hpp>
+
+using namespace pdal;
+
+namespace
+{
+
+// Sort points whose keys repeat so that stability can be checked.  The
+// X value of a point is its insertion index.
+void checkSort(point_count_t count, uint64_t memory,
+    std::size_t expectedRuns)
+{
+    PointTable table;
+    table.layout()->registerDim(Dimension::Id::X);
+    table.layout()->registerDim(Dimension::Id::Intensity);
+    table.finalize();
+    PointView view(table);
+
+    auto keyOf = [](PointId idx){ return (idx * 7919) % 1000; };
+
+    ExternalSort sort(table.layout(), memory);
+    for (PointId idx = 0; idx < count; ++idx)
+    {
+        view.setField(Dimension::Id::X, idx, idx);
+        view.setField(Dimension::Id::Intensity, idx, keyOf(idx));
+        sort.add(view.point(idx), keyOf(idx));
+    }
+
+    PointView out(table);
+    PointId idx = 0;
+    PointRef point(out, 0);
+    while (true)
+    {
+        point.setPointId(idx);
+        if (!sort.next(point))
+            break;
+        idx++;
+    }
+    EXPECT_EQ(sort.runCount(), expectedRuns);
+    ASSERT_EQ(out.size(), count);
+
+    for (PointId i = 1; i < count; ++i)
+    {
+        uint64_t k1 = out.getFieldAs<uint64_t>(Dimension::Id::Intensity, i - 1);
+        uint64_t k2 = out.getFieldAs<uint64_t>(Dimension::Id::Intensity, i);
+        double x1 = out.getFieldAs<double>(Dimension::Id::X, i - 1);
+        double x2 = out.getFieldAs<double>(Dimension::Id::X, i);
+        EXPECT_LE(k1, k2);
+        if (k1 == k2)
+            EXPECT_LT(x1, x2);
+        EXPECT_EQ(keyOf((PointId)x2), k2);
+    }
+}
+
+} // unnamed namespace
+
+TEST(ExternalSortTest, inMemory)
+{
+    checkSort(10000, 100 * 1024 * 1024, 0);
+}
+
+TEST(ExternalSortTest, runs)
+{
+    // Each record is 18 bytes and takes 50 bytes while held, so runs are
+    // 1000 points.
+    checkSort(10500, 50000, 11);
+}
+
+TEST(ExternalSortTest, mergePasses)
+{
+    // 200 runs need more than one merge pass.
+    checkSort(20000, 5000, 200 + 4);
+}
+
+TEST(ExternalSortTest, empty)
+{
+    checkSort(0, 50000, 0);
+}
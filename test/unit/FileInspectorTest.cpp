@@ -0,0 +1,94 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <pdal/FileInspector.hpp>
+#include <pdal/util/FileUtils.hpp>
+
+#include "Support.hpp"
+
+using namespace pdal;
+
+TEST(FileInspectorTest, inspect)
+{
+    StringList files {
+        Support::datapath("las/simple.las"),
+        Support::datapath("las/autzen_trim.las"),
+        Support::datapath("las/nonexistent.las"),
+        Support::datapath("las/4_6.las")
+    };
+
+    std::string cacheFile(Support::temppath("inspect_cache.json"));
+    FileUtils::deleteFile(cacheFile);
+
+    FileInspector inspector;
+    inspector.setThreads(3);
+    inspector.setCacheFile(cacheFile);
+
+    FileInspector::Results results = inspector.inspect(files);
+    ASSERT_EQ(results.size(), files.size());
+    for (size_t i = 0; i < files.size(); ++i)
+    {
+        EXPECT_EQ(results[i].m_filename, files[i]);
+        EXPECT_FALSE(results[i].m_cached);
+    }
+    EXPECT_TRUE(results[0].valid());
+    EXPECT_EQ(results[0].m_info.m_pointCount, 1065u);
+    EXPECT_TRUE(results[1].valid());
+    EXPECT_EQ(results[1].m_info.m_pointCount, 110000u);
+    EXPECT_FALSE(results[2].valid());
+    EXPECT_FALSE(results[2].m_error.empty());
+    EXPECT_TRUE(results[3].valid());
+    EXPECT_TRUE(FileUtils::fileExists(cacheFile));
+
+    // A second run reads valid results from the cache.
+    FileInspector::Results cached = inspector.inspect(files);
+    ASSERT_EQ(cached.size(), files.size());
+    for (size_t i : { 0, 1, 3 })
+    {
+        const QuickInfo& q1 = results[i].m_info;
+        const QuickInfo& q2 = cached[i].m_info;
+
+        EXPECT_TRUE(cached[i].m_cached);
+        EXPECT_TRUE(cached[i].valid());
+        EXPECT_EQ(q1.m_pointCount, q2.m_pointCount);
+        EXPECT_EQ(q1.m_bounds, q2.m_bounds);
+        EXPECT_EQ(q1.m_dimNames, q2.m_dimNames);
+        EXPECT_EQ(q1.m_srs.getWKT(), q2.m_srs.getWKT());
+    }
+    EXPECT_FALSE(cached[2].m_cached);
+    EXPECT_FALSE(cached[2].valid());
+
+    FileUtils::deleteFile(cacheFile);
+}
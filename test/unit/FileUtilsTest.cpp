@@ -82,6 +82,47 @@ TEST(FileUtilsTest, test_file_ops)
     EXPECT_NO_THROW(FileUtils::openFile("foo~1.glob"));
 }
 
+TEST(FileUtilsTest, mapFile)
+{
+    std::string tmp(Support::temppath("unittestmap.tmp"));
+    FileUtils::deleteFile(tmp);
+
+    std::string data;
+    for (size_t i = 0; i < 10000; ++i)
+        data += (char)('a' + i % 26);
+    std::ostream* ostr = FileUtils::createFile(tmp);
+    *ostr << data;
+    FileUtils::closeFile(ostr);
+
+    // Whole file.
+    FileUtils::MapContext ctx = FileUtils::mapFile(tmp);
+    ASSERT_NE(ctx.addr(), nullptr);
+    EXPECT_EQ(ctx.size(), data.size());
+    EXPECT_EQ(memcmp(ctx.addr(), data.data(), data.size()), 0);
+    ctx = FileUtils::unmapFile(ctx);
+    EXPECT_EQ(ctx.addr(), nullptr);
+    EXPECT_EQ(ctx.what(), "");
+
+    // Region not starting on a page boundary.
+    ctx = FileUtils::mapFile(tmp, true, 5001, 100);
+    ASSERT_NE(ctx.addr(), nullptr);
+    EXPECT_EQ(ctx.size(), 100U);
+    EXPECT_EQ(memcmp(ctx.addr(), data.data() + 5001, 100), 0);
+    FileUtils::unmapFile(ctx);
+
+    // Region past the end of the file.
+    ctx = FileUtils::mapFile(tmp, true, 9000, 2000);
+    EXPECT_EQ(ctx.addr(), nullptr);
+    EXPECT_NE(ctx.what(), "");
+
+    ctx = FileUtils::mapFile(Support::temppath("doesnotexist.tmp"));
+    EXPECT_EQ(ctx.addr(), nullptr);
+    EXPECT_NE(ctx.what(), "");
+
+    FileUtils::deleteFile(tmp);
+}
+
+
 TEST(FileUtilsTest, test_readFileIntoString)
 {
     const std::string filename = Support::datapath("text/text.txt");
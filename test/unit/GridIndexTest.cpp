@@ -0,0 +1,165 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <algorithm>
+
+#include <pdal/GridIndex.hpp>
+#include <pdal/KDIndex.hpp>
+
+using namespace pdal;
+
+namespace
+{
+
+void fill(PointView& view, point_count_t count)
+{
+    uint32_t seed = 2468;
+    auto next = [&seed]()
+    {
+        seed = seed * 1664525 + 1013904223;
+        return (seed >> 16) / 100.0 - 100.0;
+    };
+    for (PointId i = 0; i < count; ++i)
+    {
+        view.setField(Dimension::Id::X, i, next());
+        view.setField(Dimension::Id::Y, i, next());
+        view.setField(Dimension::Id::Z, i, next() / 10);
+    }
+}
+
+PointIdList sorted(PointIdList ids)
+{
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+} // unnamed namespace
+
+TEST(GridIndex, radius)
+{
+    PointTable table;
+    table.layout()->registerDims(
+        {Dimension::Id::X, Dimension::Id::Y, Dimension::Id::Z});
+    PointView view(table);
+    fill(view, 3000);
+
+    KD3Index kd(view);
+    kd.build();
+
+    // Cells smaller than, equal to and larger than the radius.
+    for (double cellSize : { 5.0, 20.0, 80.0 })
+    {
+        GridIndex grid(view, cellSize);
+        grid.build();
+        for (PointId i = 0; i < view.size(); i += 7)
+        {
+            PointIdList g = grid.radius(i, 20.0);
+            PointIdList k = kd.radius(i, 20.0);
+            EXPECT_EQ(sorted(g), sorted(k));
+            ASSERT_FALSE(g.empty());
+            EXPECT_EQ(g[0], i);
+        }
+    }
+
+    GridIndex grid(view, 20.0);
+    grid.build();
+    EXPECT_EQ(sorted(grid.radius(0.0, 0.0, 0.0, 30.0)),
+        sorted(kd.radius(0.0, 0.0, 0.0, 30.0)));
+    EXPECT_TRUE(grid.radius(1e6, 1e6, 1e6, 30.0).empty());
+
+    // A radius covering every point.
+    EXPECT_EQ(grid.radius(0.0, 0.0, 0.0, 1e4).size(), view.size());
+}
+
+TEST(GridIndex, radiusRange)
+{
+    PointTable table;
+    table.layout()->registerDims(
+        {Dimension::Id::X, Dimension::Id::Y, Dimension::Id::Z});
+    PointView view(table);
+    fill(view, 3000);
+
+    GridIndex grid(view, 15.0);
+    grid.build();
+
+    for (unsigned threads : { 1, 4 })
+    {
+        KDNeighbors all = grid.radiusAll(15.0, threads);
+        ASSERT_EQ(all.size(), view.size());
+        for (PointId i = 0; i < view.size(); ++i)
+        {
+            PointIdList ids(all.neighbors(i), all.neighbors(i) +
+                all.count(i));
+            EXPECT_EQ(ids, grid.radius(i, 15.0));
+            for (size_t j = 1; j < all.count(i); ++j)
+                EXPECT_LE(all.distances(i)[j - 1], all.distances(i)[j]);
+        }
+    }
+
+    KDNeighbors part = grid.radiusRange(2990, 5000, 15.0);
+    EXPECT_EQ(part.size(), 10u);
+
+    // Counts match the number of neighbors found.
+    KDNeighbors all = grid.radiusAll(15.0, 1);
+    for (unsigned threads : { 1, 4 })
+    {
+        std::vector<point_count_t> counts =
+            grid.radiusCountRange(0, view.size(), 15.0, threads);
+        ASSERT_EQ(counts.size(), view.size());
+        for (PointId i = 0; i < view.size(); ++i)
+            EXPECT_EQ(counts[i], all.count(i));
+    }
+    EXPECT_EQ(grid.radiusCountRange(2990, 5000, 15.0).size(), 10u);
+}
+
+TEST(GridIndex, errors)
+{
+    PointTable table;
+    table.layout()->registerDims({Dimension::Id::X, Dimension::Id::Y});
+    PointView view(table);
+
+    EXPECT_THROW(GridIndex(view, 1.0), pdal_error);
+
+    PointTable table2;
+    table2.layout()->registerDims(
+        {Dimension::Id::X, Dimension::Id::Y, Dimension::Id::Z});
+    PointView view2(table2);
+    EXPECT_THROW(GridIndex(view2, 0.0), pdal_error);
+
+    GridIndex empty(view2, 1.0);
+    empty.build();
+    EXPECT_TRUE(empty.radius(0.0, 0.0, 0.0, 1.0).empty());
+    EXPECT_EQ(empty.radiusAll(1.0).size(), 0u);
+}
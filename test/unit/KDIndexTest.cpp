@@ -33,6 +33,8 @@
 
 #include <pdal/pdal_test_main.hpp>
 
+#include <pdal/EigenUtils.hpp>
+#include <pdal/Gpu.hpp>
 #include <pdal/KDIndex.hpp>
 
 using namespace pdal;
@@ -378,3 +380,244 @@ TEST(KDIndex, radius3D)
     EXPECT_EQ(ids[2], 2u);
 }
 
+
+TEST(KDIndex, threadedBuild)
+{
+    PointTable table;
+    PointLayoutPtr layout = table.layout();
+    layout->registerDim(Dimension::Id::X);
+    layout->registerDim(Dimension::Id::Y);
+    layout->registerDim(Dimension::Id::Z);
+    PointView view(table);
+
+    // A deterministic scatter of points, large enough to split the tree
+    // across several threads.
+    uint32_t seed = 12345;
+    auto next = [&seed]()
+    {
+        seed = seed * 1664525 + 1013904223;
+        return (seed >> 8) / 1000.0;
+    };
+    for (PointId i = 0; i < 20000; ++i)
+    {
+        view.setField(Dimension::Id::X, i, next());
+        view.setField(Dimension::Id::Y, i, next());
+        view.setField(Dimension::Id::Z, i, next());
+    }
+
+    KD3Index single(view);
+    single.build(1);
+    KD3Index threaded(view);
+    threaded.build(4);
+
+    KD2Index single2(view);
+    single2.build(1);
+    KD2Index threaded2(view);
+    threaded2.build(4);
+
+    for (PointId i = 0; i < view.size(); i += 97)
+    {
+        EXPECT_EQ(single.neighbors(i, 8), threaded.neighbors(i, 8));
+        EXPECT_EQ(single.radius(i, 2000), threaded.radius(i, 2000));
+        EXPECT_EQ(single2.neighbors(i, 8), threaded2.neighbors(i, 8));
+    }
+}
+
+TEST(KDIndex, bulkQueries)
+{
+    PointTable table;
+    PointLayoutPtr layout = table.layout();
+    layout->registerDim(Dimension::Id::X);
+    layout->registerDim(Dimension::Id::Y);
+    layout->registerDim(Dimension::Id::Z);
+    PointView view(table);
+
+    uint32_t seed = 54321;
+    auto next = [&seed]()
+    {
+        seed = seed * 1664525 + 1013904223;
+        return (seed >> 16) / 100.0;
+    };
+    for (PointId i = 0; i < 2000; ++i)
+    {
+        view.setField(Dimension::Id::X, i, next());
+        view.setField(Dimension::Id::Y, i, next());
+        view.setField(Dimension::Id::Z, i, next());
+    }
+
+    KD3Index index(view);
+    index.build();
+
+    for (unsigned threads : { 1, 4 })
+    {
+        KDNeighbors knn = index.knnAll(6, threads);
+        ASSERT_EQ(knn.size(), view.size());
+        for (PointId i = 0; i < view.size(); ++i)
+        {
+            PointIdList ids(6);
+            std::vector<double> dists(6);
+            index.knnSearch(i, 6, &ids, &dists);
+            ASSERT_EQ(knn.count(i), 6u);
+            EXPECT_EQ(PointIdList(knn.neighbors(i), knn.neighbors(i) + 6),
+                ids);
+            EXPECT_EQ(std::vector<double>(knn.distances(i),
+                knn.distances(i) + 6), dists);
+        }
+
+        KDNeighbors rad = index.radiusRange(100, 300, 40.0, threads);
+        ASSERT_EQ(rad.size(), 200u);
+        for (PointId i = 100; i < 300; ++i)
+        {
+            PointIdList ids = index.radius(i, 40.0);
+            EXPECT_EQ(PointIdList(rad.neighbors(i - 100),
+                rad.neighbors(i - 100) + rad.count(i - 100)), ids);
+        }
+
+        std::vector<point_count_t> counts =
+            index.radiusCountRange(100, 300, 40.0, threads);
+        ASSERT_EQ(counts.size(), 200u);
+        for (PointId i = 100; i < 300; ++i)
+            EXPECT_EQ(counts[i - 100], rad.count(i - 100));
+    }
+
+    // Ranges past the end of the index are clamped.
+    EXPECT_EQ(index.knnRange(1990, 3000, 4).size(), 10u);
+    EXPECT_EQ(index.radiusAll(1.0).size(), view.size());
+
+    // More neighbors than points.
+    PointView small(table);
+    small.appendPoint(view, 0);
+    small.appendPoint(view, 1);
+    KD3Index smallIndex(small);
+    smallIndex.build();
+    KDNeighbors all = smallIndex.knnAll(5);
+    EXPECT_EQ(all.count(0), 2u);
+    EXPECT_EQ(all.count(1), 2u);
+
+    // Approximate searches still return k neighbors, none farther than
+    // (1 + eps) times the true k-th nearest squared distance.
+    const double eps = 1.0;
+    KDNeighbors approx = index.knnAll(6, 4, eps);
+    KDNeighbors exact = index.knnAll(6, 1);
+    for (PointId i = 0; i < view.size(); ++i)
+    {
+        ASSERT_EQ(approx.count(i), 6u);
+        EXPECT_EQ(approx.neighbors(i)[0], i);
+        EXPECT_LE(approx.distances(i)[5],
+            exact.distances(i)[5] * (1 + eps) + 1e-9);
+    }
+    EXPECT_EQ(index.approxNeighbors(5, 6, eps).size(), 6u);
+}
+
+// Queries give the same results whether or not they're run on the GPU.
+// Without a device both runs are on the CPU.
+TEST(KDIndex, gpu)
+{
+    PointTable table;
+    PointLayoutPtr layout = table.layout();
+    layout->registerDim(Dimension::Id::X);
+    layout->registerDim(Dimension::Id::Y);
+    layout->registerDim(Dimension::Id::Z);
+    PointView view(table);
+
+    uint32_t seed = 12345;
+    auto next = [&seed]()
+    {
+        seed = seed * 1664525 + 1013904223;
+        return (seed >> 8) / 10000.0;
+    };
+    for (PointId i = 0; i < 5000; ++i)
+    {
+        view.setField(Dimension::Id::X, i, next());
+        view.setField(Dimension::Id::Y, i, next());
+        view.setField(Dimension::Id::Z, i, next() / 10);
+    }
+
+    KD3Index index(view);
+    index.build();
+    const double *coords = index.coords().data();
+
+    auto run = [&](KDNeighbors& knn, std::vector<point_count_t>& counts,
+        std::vector<CovarianceEigen>& eigens)
+    {
+        knn = index.knnRange(0, 5000, 12);
+        counts = index.radiusCountRange(0, 5000, 20.0);
+        computeCovarianceEigen(coords, knn, eigens, 1);
+    };
+
+    KDNeighbors cpuKnn, gpuKnn;
+    std::vector<point_count_t> cpuCounts, gpuCounts;
+    std::vector<CovarianceEigen> cpuEigens, gpuEigens;
+    gpu::setEnabled(false);
+    EXPECT_FALSE(gpu::enabled());
+    run(cpuKnn, cpuCounts, cpuEigens);
+    gpu::setEnabled(true);
+    run(gpuKnn, gpuCounts, gpuEigens);
+
+    EXPECT_EQ(cpuKnn.offsets, gpuKnn.offsets);
+    EXPECT_EQ(cpuKnn.ids, gpuKnn.ids);
+    EXPECT_EQ(cpuKnn.sqrDists, gpuKnn.sqrDists);
+    EXPECT_EQ(cpuCounts, gpuCounts);
+    ASSERT_EQ(cpuEigens.size(), gpuEigens.size());
+    for (std::size_t i = 0; i < cpuEigens.size(); ++i)
+    {
+        EXPECT_TRUE(gpuEigens[i].valid);
+        EXPECT_TRUE(cpuEigens[i].centroid.isApprox(gpuEigens[i].centroid));
+        EXPECT_TRUE(cpuEigens[i].values.isApprox(gpuEigens[i].values));
+    }
+}
+
+TEST(KDIndex, sharedTrees)
+{
+    PointTable table;
+    PointLayoutPtr layout = table.layout();
+    layout->registerDim(Dimension::Id::X);
+    layout->registerDim(Dimension::Id::Y);
+    layout->registerDim(Dimension::Id::Z);
+    PointViewPtr view(new PointView(table));
+
+    std::vector<double> coords;
+    for (PointId i = 0; i < 100; ++i)
+    {
+        view->setField(Dimension::Id::X, i, i);
+        view->setField(Dimension::Id::Y, i, i % 10);
+        view->setField(Dimension::Id::Z, i, 0);
+        coords.insert(coords.end(), { double(i), double(i % 10), 0.0 });
+    }
+
+    KDTreeCache<3>& cache = KDTreeCache<3>::get(table);
+    EXPECT_EQ(&cache, &KDTreeCache<3>::get(table));
+    EXPECT_FALSE(cache.find(coords));
+
+    KD3Index& index = view->build3dIndex();
+    auto tree = cache.find(coords);
+    ASSERT_TRUE(!!tree);
+
+    // A copy of the view shares the tree.
+    PointViewPtr copy = view->makeNew();
+    for (PointId i = 0; i < view->size(); ++i)
+        copy->appendPoint(*view, i);
+    KD3Index& copyIndex = copy->build3dIndex();
+    EXPECT_EQ(tree, cache.find(coords));
+    EXPECT_EQ(index.neighbors(55, 5), copyIndex.neighbors(55, 5));
+
+    // Moving a point gives a view a new tree.
+    PointViewPtr moved = view->makeNew();
+    for (PointId i = 0; i < view->size(); ++i)
+        for (Dimension::Id dim : view->dims())
+            moved->setField(dim, i, view->getFieldAs<double>(dim, i));
+    moved->setField(Dimension::Id::X, 99, 1000);
+    moved->setField(Dimension::Id::Y, 99, 1000);
+    moved->setField(Dimension::Id::Z, 99, 1000);
+    KD3Index& movedIndex = moved->build3dIndex();
+    EXPECT_EQ(movedIndex.neighbor(1000, 1000, 1000), 99u);
+    EXPECT_EQ(movedIndex.radius(1000, 1000, 1000, 10).size(), 1u);
+    EXPECT_EQ(index.radius(1000, 1000, 1000, 10).size(), 0u);
+    EXPECT_EQ(tree, cache.find(coords));
+
+    // The cache doesn't keep trees once the views that use them are gone.
+    tree.reset();
+    view.reset();
+    copy.reset();
+    EXPECT_FALSE(cache.find(coords));
+}
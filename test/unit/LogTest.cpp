@@ -37,6 +37,10 @@
 #include <pdal/util/FileUtils.hpp>
 #include "Support.hpp"
 
+#include <cstdio>
+#include <sstream>
+#include <thread>
+
 namespace pdal
 {
 
@@ -86,4 +90,68 @@ TEST(Log, t2)
     FileUtils::deleteFile(out);
 }
 
+// Values logged below the active level aren't evaluated.
+TEST(Log, lazy)
+{
+    std::ostringstream out;
+    LogPtr l(Log::makeLog("", &out));
+    l->setLevel(LogLevel::Info);
+
+    int count = 0;
+    auto value = [&count]()
+    {
+        return ++count;
+    };
+
+    PDAL_LOG(l, LogLevel::Debug) << "debug " << value() << "\n";
+    EXPECT_EQ(count, 0);
+    EXPECT_TRUE(out.str().empty());
+    PDAL_LOG(l, LogLevel::Info) << "info " << value() << "\n";
+    EXPECT_EQ(count, 1);
+    EXPECT_EQ(out.str(), "(Info) info 1\n");
+    EXPECT_TRUE(l->enabled(LogLevel::Warning));
+    EXPECT_FALSE(l->enabled(LogLevel::Debug));
+}
+
+// Lines logged by several threads are written whole and in order per
+// thread.
+TEST(Log, async)
+{
+    std::ostringstream out;
+    const int NumThreads = 4;
+    const int NumLines = 100;
+    {
+        LogPtr l(Log::makeLog("", &out));
+        l->setLevel(LogLevel::Info);
+        l->setAsynchronous(true);
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < NumThreads; ++t)
+            threads.emplace_back([&l, t]()
+            {
+                for (int i = 0; i < NumLines; ++i)
+                    l->get(LogLevel::Info) << t << " " << i << std::endl;
+            });
+        for (std::thread& t : threads)
+            t.join();
+        l->setAsynchronous(false);
+        EXPECT_EQ(l->getLogStream(), &out);
+    }
+
+    std::istringstream in(out.str());
+    std::vector<int> next(NumThreads);
+    std::string line;
+    int lines = 0;
+    while (std::getline(in, line))
+    {
+        int t, i;
+        ASSERT_EQ(std::sscanf(line.data(), "(Info) %d %d", &t, &i), 2) <<
+            line;
+        ASSERT_TRUE(t >= 0 && t < NumThreads);
+        EXPECT_EQ(i, next[t]++);
+        lines++;
+    }
+    EXPECT_EQ(lines, NumThreads * NumLines);
+}
+
 }
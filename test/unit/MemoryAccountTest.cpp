@@ -0,0 +1,154 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <sstream>
+
+#include <pdal/MemoryAccount.hpp>
+#include <pdal/PipelineManager.hpp>
+
+using namespace pdal;
+
+TEST(MemoryAccountTest, charge)
+{
+    auto a = std::make_shared<MemoryAccount>("a");
+    auto b = std::make_shared<MemoryAccount>("b");
+    std::size_t total = MemoryAccount::total();
+
+    {
+        MemoryCharge c;
+        {
+            MemoryAccount::Scope scope(a.get());
+            EXPECT_EQ(MemoryAccount::active(), a.get());
+            c.set(100);
+            c.set(50);
+        }
+        EXPECT_EQ(MemoryAccount::active(), nullptr);
+        EXPECT_EQ(a->current(), 50u);
+        EXPECT_EQ(a->peak(), 100u);
+        EXPECT_EQ(MemoryAccount::total(), total + 50);
+
+        // Resizing under another account moves the charge.
+        {
+            MemoryAccount::Scope scope(b.get());
+            c.set(70);
+        }
+        EXPECT_EQ(a->current(), 0u);
+        EXPECT_EQ(b->current(), 70u);
+
+        MemoryCharge d(std::move(c));
+        EXPECT_EQ(d.bytes(), 70u);
+        EXPECT_EQ(b->current(), 70u);
+    }
+    EXPECT_EQ(b->current(), 0u);
+    EXPECT_EQ(b->peak(), 70u);
+    EXPECT_EQ(MemoryAccount::total(), total);
+}
+
+TEST(MemoryAccountTest, budget)
+{
+    auto a = std::make_shared<MemoryAccount>("filters.big");
+    MemoryAccount::Scope scope(a.get());
+
+    MemoryCharge c;
+    c.set(1000);
+    MemoryAccount::setBudget(MemoryAccount::total() + 500);
+    try
+    {
+        c.set(2000);
+        FAIL() << "Expected budget error.";
+    }
+    catch (const pdal_error& err)
+    {
+        EXPECT_NE(std::string(err.what()).find("'filters.big'"),
+            std::string::npos);
+    }
+    // A failed charge leaves the old charge in place.
+    EXPECT_EQ(c.bytes(), 1000u);
+    EXPECT_EQ(a->current(), 1000u);
+
+    // Shrinking is always allowed.
+    EXPECT_NO_THROW(c.set(10));
+    MemoryAccount::setBudget(0);
+    EXPECT_NO_THROW(c.set(1000000));
+}
+
+TEST(MemoryAccountTest, pipeline)
+{
+    std::string pipeline(R"([
+        { "type": "readers.faux", "count": 100000, "mode": "ramp",
+          "tag": "faux" },
+        { "type": "filters.sort", "dimension": "Z", "order": "DESC",
+          "tag": "sort" }
+    ])");
+
+    {
+        PipelineManager mgr;
+        std::istringstream in(pipeline);
+        mgr.readPipeline(in);
+        mgr.setProfiling(true);
+        mgr.execute(ExecMode::Standard);
+
+        MetadataNode profile = mgr.getProfile();
+        for (MetadataNode stage : profile.children("stages"))
+        {
+            // The reader holds the point table blocks and the sort filter
+            // the reordered view index.
+            std::string tag = stage.findChild("tag").value();
+            EXPECT_GT(stage.findChild("memory_current").value<size_t>(), 0u)
+                << tag;
+            EXPECT_GE(stage.findChild("memory_peak").value<size_t>(),
+                stage.findChild("memory_current").value<size_t>()) << tag;
+        }
+    }
+
+    {
+        PipelineManager mgr;
+        std::istringstream in(pipeline);
+        mgr.readPipeline(in);
+        mgr.setMemoryBudget(MemoryAccount::total() + 10000);
+        try
+        {
+            mgr.execute(ExecMode::Standard);
+            FAIL() << "Expected budget error.";
+        }
+        catch (const pdal_error& err)
+        {
+            EXPECT_NE(std::string(err.what()).find("'faux'"),
+                std::string::npos) << err.what();
+        }
+        mgr.setMemoryBudget(0);
+    }
+}
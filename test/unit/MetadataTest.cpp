@@ -359,3 +359,28 @@ TEST(MetadataTest, update)
     root2.add(c);
     EXPECT_THROW(root2.addOrUpdate(c), pdal_error);
 }
+
+TEST(MetadataTest, lazy)
+{
+    MetadataNode m;
+
+    int calls = 0;
+    MetadataNode l = m.addLazy("lazy", "string", [&calls]()
+        {
+            calls++;
+            return std::string("value");
+        }, "A lazy node");
+    EXPECT_EQ(calls, 0);
+    EXPECT_EQ(l.type(), "string");
+    EXPECT_EQ(l.description(), "A lazy node");
+    EXPECT_EQ(l.value(), "value");
+    EXPECT_EQ(m.findChild("lazy").value(), "value");
+    EXPECT_EQ(calls, 1);
+
+    std::vector<uint8_t> v { 1, 2, 3, 4 };
+    MetadataNode e1 = m.addEncoded("encoded", v.data(), v.size());
+    MetadataNode e2 = m.addEncoded("encoded2", v);
+    EXPECT_EQ(e2.type(), "base64Binary");
+    EXPECT_EQ(e1.value(), e2.value());
+    EXPECT_EQ(e1.jsonValue(), e2.jsonValue());
+}
@@ -0,0 +1,204 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <pdal/private/MultipartOutStream.hpp>
+
+using namespace pdal;
+
+namespace
+{
+
+// Assemble the uploaded object in memory.
+struct Uploads
+{
+    std::vector<char> object;
+    std::map<std::size_t, std::vector<char>> parts;
+    std::size_t puts = 0;
+    std::size_t starts = 0;
+    std::size_t aborts = 0;
+    std::size_t failPart = 0;
+    bool failComplete = false;
+    std::mutex mutex;
+};
+
+class FakeUploader : public MultipartUploader
+{
+public:
+    FakeUploader(Uploads& uploads) : m_uploads(uploads)
+        {}
+
+    void put(const std::vector<char>& data) override
+    {
+        m_uploads.object = data;
+        m_uploads.puts++;
+    }
+
+    void start() override
+        { m_uploads.starts++; }
+
+    std::string putPart(std::size_t partNumber,
+        const std::vector<char>& data) override
+    {
+        if (partNumber == m_uploads.failPart)
+            throw std::runtime_error("Part failed");
+        std::lock_guard<std::mutex> lock(m_uploads.mutex);
+        m_uploads.parts[partNumber] = data;
+        return std::to_string(partNumber);
+    }
+
+    void complete(const std::vector<std::string>& etags) override
+    {
+        if (m_uploads.failComplete)
+            throw std::runtime_error("Complete failed");
+        for (std::size_t i = 0; i < etags.size(); ++i)
+        {
+            EXPECT_EQ(etags[i], std::to_string(i + 1));
+            const std::vector<char>& part = m_uploads.parts.at(i + 1);
+            m_uploads.object.insert(m_uploads.object.end(), part.begin(),
+                part.end());
+        }
+    }
+
+    void abort() override
+        { m_uploads.aborts++; }
+
+private:
+    Uploads& m_uploads;
+};
+
+std::unique_ptr<MultipartUploader> uploader(Uploads& uploads)
+{
+    return std::unique_ptr<MultipartUploader>(new FakeUploader(uploads));
+}
+
+} // unnamed namespace
+
+TEST(MultipartOutStreamTest, small)
+{
+    Uploads uploads;
+    MultipartOutStream out(uploader(uploads), 16);
+    out << "0123456789";
+    EXPECT_EQ(out.tellp(), 10);
+    out.seekp(2);
+    out << "ab";
+    out.finish();
+
+    EXPECT_EQ(uploads.puts, 1U);
+    EXPECT_EQ(uploads.starts, 0U);
+    EXPECT_EQ(std::string(uploads.object.begin(), uploads.object.end()),
+        "01ab456789");
+}
+
+TEST(MultipartOutStreamTest, parts)
+{
+    Uploads uploads;
+    std::string expected;
+    {
+        MultipartOutStream out(uploader(uploads), 16);
+        for (int i = 0; i < 100; ++i)
+        {
+            std::string s(std::to_string(i) + ",");
+            out << s;
+            expected += s;
+        }
+
+        // Rewrite the head, as a writer patches its header.
+        out.seekp(0);
+        out << "HEAD";
+        expected.replace(0, 4, "HEAD");
+
+        // Data in parts that have been uploaded can't be rewritten.
+        out.seekp(20);
+        EXPECT_FALSE(out.good());
+        out.clear();
+        out.seekp(0, std::ios::end);
+        EXPECT_EQ(out.tellp(), (std::streamoff)expected.size());
+        out.finish();
+    }
+
+    EXPECT_EQ(uploads.puts, 0U);
+    EXPECT_EQ(uploads.starts, 1U);
+    EXPECT_EQ(uploads.aborts, 0U);
+    EXPECT_EQ(std::string(uploads.object.begin(), uploads.object.end()),
+        expected);
+}
+
+TEST(MultipartOutStreamTest, failure)
+{
+    Uploads uploads;
+    uploads.failPart = 2;
+    MultipartOutStream out(uploader(uploads), 16);
+    out << std::string(200, 'x');
+    EXPECT_THROW(out.finish(), pdal_error);
+    EXPECT_FALSE(out.good());
+    EXPECT_EQ(uploads.aborts, 1U);
+}
+
+// A failed completion and an upload whose stream is deleted with a failed
+// part are aborted too.
+TEST(MultipartOutStreamTest, abort)
+{
+    Uploads uploads;
+    uploads.failComplete = true;
+    {
+        MultipartOutStream out(uploader(uploads), 16);
+        out << std::string(200, 'x');
+        EXPECT_THROW(out.finish(), pdal_error);
+    }
+    EXPECT_EQ(uploads.aborts, 1U);
+
+    Uploads deleted;
+    deleted.failPart = 3;
+    {
+        MultipartOutStream out(uploader(deleted), 16);
+        out << std::string(200, 'x');
+    }
+    EXPECT_EQ(deleted.aborts, 1U);
+
+    // Nothing is aborted when no multipart upload was started.
+    Uploads small;
+    {
+        MultipartOutStream out(uploader(small), 16);
+        out << "0123";
+    }
+    EXPECT_EQ(small.puts, 1U);
+    EXPECT_EQ(small.aborts, 0U);
+}
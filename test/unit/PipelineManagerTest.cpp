@@ -238,3 +238,313 @@ TEST(PipelineManagerTest, replace)
     EXPECT_EQ(w2->getInputs().size(), 1U);
     EXPECT_EQ(w2->getInputs().front(), f2);
 }
+
+// Make sure that running views through a re-entrant stage on several
+// threads gives the same views, in the same order, as running them serially.
+TEST(PipelineManagerTest, threads)
+{
+    auto run = [](const std::string& threads, std::vector<point_count_t>& cnts)
+    {
+        std::string json = "{ \"threads\": " + threads + ", \"pipeline\": ["
+            "{ \"type\": \"readers.faux\", \"mode\": \"ramp\", "
+            "\"count\": 1000, \"bounds\": \"([0, 99], [0, 99], [0, 99])\" }, "
+            "{ \"type\": \"filters.splitter\", \"length\": 10 }, "
+            "{ \"type\": \"filters.range\", \"limits\": \"Z[0:50]\" } ] }";
+
+        std::istringstream iss(json);
+        PipelineManager mgr;
+        mgr.readPipeline(iss);
+        EXPECT_EQ(mgr.threads(), (size_t)std::stoi(threads));
+        mgr.execute();
+
+        for (PointViewPtr v : mgr.views())
+            cnts.push_back(v->size());
+    };
+
+    std::vector<point_count_t> serial;
+    std::vector<point_count_t> parallel;
+    run("1", serial);
+    run("4", parallel);
+    EXPECT_EQ(serial.size(), 10U);
+    EXPECT_EQ(serial, parallel);
+
+    std::istringstream iss("{ \"threads\": 0, \"pipeline\": "
+        "[ { \"type\": \"readers.faux\" } ] }");
+    PipelineManager mgr;
+    EXPECT_THROW(mgr.readPipeline(iss), pdal_error);
+}
+
+// A pipeline that can't be streamed because of filters.sort streams the
+// reader through filters.range when stream mode is preferred, so only the
+// points that pass the range filter are stored.
+TEST(PipelineManagerTest, hybrid)
+{
+    auto run = [](ExecMode mode, std::vector<double>& z, std::size_t& mem)
+    {
+        std::string json = "{ \"pipeline\": ["
+            "{ \"type\": \"readers.faux\", \"mode\": \"ramp\", "
+            "\"count\": 100000, "
+            "\"bounds\": \"([0, 99], [0, 99], [0, 99])\" }, "
+            "{ \"type\": \"filters.range\", \"limits\": \"Z[0:10]\" }, "
+            "{ \"type\": \"filters.sort\", \"dimension\": \"Z\", "
+            "\"order\": \"DESC\" } ] }";
+
+        std::istringstream iss(json);
+        PipelineManager mgr;
+        mgr.readPipeline(iss);
+        EXPECT_EQ(mgr.execute(mode).m_mode, ExecMode::Standard);
+        mem = mgr.pointTable().memoryUsed();
+
+        const PointViewSet& views = mgr.views();
+        EXPECT_EQ(views.size(), 1u);
+        PointViewPtr v = *views.begin();
+        for (PointId idx = 0; idx < v->size(); ++idx)
+            z.push_back(v->getFieldAs<double>(Dimension::Id::Z, idx));
+    };
+
+    std::vector<double> standard;
+    std::vector<double> hybrid;
+    std::size_t standardMem;
+    std::size_t hybridMem;
+    run(ExecMode::Standard, standard, standardMem);
+    run(ExecMode::PreferStream, hybrid, hybridMem);
+    EXPECT_GT(standard.size(), 0u);
+    EXPECT_LT(standard.size(), 100000u);
+    EXPECT_EQ(standard, hybrid);
+    EXPECT_LT(hybridMem, standardMem);
+}
+
+TEST(PipelineManagerTest, columnTable)
+{
+    auto run = [](const std::string& table)
+    {
+        std::string json = "{ \"table\": \"" + table + "\", \"pipeline\": ["
+            "{ \"type\": \"readers.faux\", \"mode\": \"ramp\", "
+            "\"count\": 1000, \"bounds\": \"([0, 99], [0, 99], [0, 99])\" }, "
+            "{ \"type\": \"filters.range\", \"limits\": \"Z[0:50]\" } ] }";
+
+        std::istringstream iss(json);
+        PipelineManager mgr;
+        mgr.readPipeline(iss);
+        return mgr.execute();
+    };
+
+    EXPECT_EQ(run("row"), run("column"));
+    EXPECT_EQ(run("row"), run("mapped"));
+    EXPECT_EQ(run("row"), run("aligned"));
+    EXPECT_EQ(run("row"), run("compressed"));
+    EXPECT_THROW(run("diagonal"), pdal_error);
+    PipelineManager mgr;
+    mgr.setColumnTable();
+    EXPECT_NE(dynamic_cast<ColumnPointTable *>(&mgr.pointTable()), nullptr);
+    mgr.setAlignedTable();
+    EXPECT_TRUE(mgr.pointTable().layout()->aligned());
+}
+
+TEST(PipelineManagerTest, streamBatch)
+{
+    auto run = [](const std::string& batch)
+    {
+        std::string json = "{ \"stream_batch\": " + batch + ", "
+            "\"pipeline\": ["
+            "{ \"type\": \"readers.faux\", \"mode\": \"ramp\", "
+            "\"count\": 1000, \"bounds\": \"([0, 99], [0, 99], [0, 99])\" }, "
+            "{ \"type\": \"filters.range\", \"limits\": \"Z[0:50]\" } ] }";
+
+        std::istringstream iss(json);
+        PipelineManager mgr;
+        mgr.readPipeline(iss);
+        return mgr.execute(ExecMode::Stream).m_mode;
+    };
+
+    EXPECT_EQ(run("\"auto\""), ExecMode::Stream);
+    EXPECT_EQ(run("17"), ExecMode::Stream);
+    EXPECT_THROW(run("0"), pdal_error);
+    EXPECT_THROW(run("\"big\""), pdal_error);
+}
+
+TEST(PipelineManagerTest, profile)
+{
+    auto run = [](ExecMode mode)
+    {
+        std::string json = "{ \"pipeline\": ["
+            "{ \"type\": \"readers.faux\", \"mode\": \"ramp\", "
+            "\"count\": 1000, \"bounds\": \"([0, 99], [0, 99], [0, 99])\" }, "
+            "{ \"type\": \"filters.range\", \"limits\": \"Z[0:50]\" } ] }";
+
+        std::istringstream iss(json);
+        PipelineManager mgr;
+        mgr.readPipeline(iss);
+        mgr.setProfiling(true);
+        EXPECT_EQ(mgr.execute(mode).m_mode, mode);
+
+        MetadataNode profile = mgr.getProfile();
+        EXPECT_EQ(profile.findChild("mode").value(),
+            mode == ExecMode::Stream ? "stream" : "standard");
+        MetadataNodeList stages = profile.children("stages");
+        EXPECT_EQ(stages.size(), 2u);
+
+        point_count_t filtered = 0;
+        for (MetadataNode& s : stages)
+        {
+            std::string name = s.findChild("name").value();
+            point_count_t in = s.findChild("points_in").value<point_count_t>();
+            point_count_t out =
+                s.findChild("points_out").value<point_count_t>();
+            EXPECT_GE(s.findChild("ready:wall_time").value<double>(), 0.0);
+            if (name == "readers.faux")
+                EXPECT_EQ(out, 1000u);
+            else
+            {
+                EXPECT_EQ(in, 1000u);
+                EXPECT_LT(out, in);
+                filtered = out;
+            }
+            EXPECT_GT(s.findChild("peak_table_memory").value<size_t>(), 0u);
+        }
+        EXPECT_EQ(profile.findChild("points").value<point_count_t>(),
+            filtered);
+        return filtered;
+    };
+
+    EXPECT_EQ(run(ExecMode::Standard), run(ExecMode::Stream));
+}
+
+TEST(PipelineManagerTest, forwardMetadata)
+{
+    const std::string in(Support::datapath("las/simple.las"));
+    const std::string out(Support::temppath("forward.las"));
+
+    auto run = [&](const std::string& forward, const std::string& writer)
+    {
+        std::string json = "{ " + forward + " \"pipeline\": [ \"" + in +
+            "\", " + writer + " ] }";
+
+        std::istringstream iss(json);
+        PipelineManager mgr;
+        mgr.readPipeline(iss);
+        mgr.execute();
+        return mgr.pointTable().privateMetadata("lasforward").
+            children().size();
+    };
+
+    const std::string las("{ \"type\": \"writers.las\", \"filename\": \"" +
+        out + "\", \"forward\": \"all\" }");
+    const std::string text("{ \"type\": \"writers.text\", "
+        "\"filename\": \"" + Support::temppath("forward.txt") + "\" }");
+
+    EXPECT_NE(run("", text), 0u);
+    EXPECT_EQ(run("\"forward_metadata\": false,", text), 0u);
+    EXPECT_NE(run("\"forward_metadata\": false,", las), 0u);
+    EXPECT_THROW(run("\"forward_metadata\": 0,", text), pdal_error);
+
+    FileUtils::deleteFile(out);
+    FileUtils::deleteFile(Support::temppath("forward.txt"));
+}
+
+TEST(PipelineManagerTest, cache)
+{
+    const std::string dir(Support::temppath("stagecache"));
+    FileUtils::deleteDirectory(dir);
+
+    auto run = [&dir](const std::string& limits, std::string& log)
+    {
+        std::string json = "{ \"pipeline\": [ \"" +
+            Support::datapath("las/simple.las") + "\", "
+            "{ \"type\": \"filters.range\", \"limits\": \"" + limits +
+            "\" }, { \"type\": \"filters.sort\", \"dimension\": \"Z\" } ] }";
+
+        std::ostringstream out;
+        LogPtr l(Log::makeLog("", &out));
+        l->setLevel(LogLevel::Debug);
+
+        std::istringstream iss(json);
+        PipelineManager mgr;
+        mgr.setLog(l);
+        mgr.setCache(dir, 100 * 1024 * 1024);
+        mgr.readPipeline(iss);
+        mgr.execute();
+        log = out.str();
+
+        std::vector<double> z;
+        for (PointViewPtr v : mgr.views())
+            for (PointId idx = 0; idx < v->size(); ++idx)
+                z.push_back(v->getFieldAs<double>(Dimension::Id::Z, idx));
+        return z;
+    };
+
+    auto loaded = [](const std::string& log)
+        { return log.find("Loaded output") != std::string::npos; };
+    auto stored = [](const std::string& log)
+        { return log.find("Stored output") != std::string::npos; };
+
+    std::string log;
+    std::vector<double> first = run("Classification[2:2]", log);
+    EXPECT_GT(first.size(), 0u);
+    EXPECT_FALSE(loaded(log));
+    EXPECT_TRUE(stored(log));
+
+    // Nothing is run again.
+    EXPECT_EQ(run("Classification[2:2]", log), first);
+    EXPECT_TRUE(loaded(log));
+    EXPECT_FALSE(stored(log));
+
+    // The reader's output is loaded and the filters are run.
+    std::vector<double> other = run("Classification[1:1]", log);
+    EXPECT_GT(other.size(), 0u);
+    EXPECT_NE(other, first);
+    EXPECT_TRUE(loaded(log));
+    EXPECT_TRUE(stored(log));
+
+    FileUtils::deleteDirectory(dir);
+}
+
+// A reader whose output was limited by the stages that follow it isn't
+// loaded for a pipeline that reads more of it.
+TEST(PipelineManagerTest, cacheLimits)
+{
+    const std::string dir(Support::temppath("stagecache"));
+    FileUtils::deleteDirectory(dir);
+
+    auto run = [&dir](const std::string& filter, std::string& log)
+    {
+        std::string json = "{ \"pipeline\": [ \"" +
+            Support::datapath("las/simple.las") + "\"" + filter + " ] }";
+
+        std::ostringstream out;
+        LogPtr l(Log::makeLog("", &out));
+        l->setLevel(LogLevel::Debug);
+
+        std::istringstream iss(json);
+        PipelineManager mgr;
+        mgr.setLog(l);
+        mgr.setCache(dir, 100 * 1024 * 1024);
+        mgr.readPipeline(iss);
+        mgr.execute();
+        log = out.str();
+
+        point_count_t count = 0;
+        for (PointViewPtr v : mgr.views())
+            count += v->size();
+        return count;
+    };
+
+    auto loaded = [](const std::string& log)
+        { return log.find("Loaded output") != std::string::npos; };
+
+    const std::string head(", { \"type\": \"filters.head\", "
+        "\"count\": 10 }");
+    std::string log;
+    EXPECT_EQ(run(head, log), 10u);
+    EXPECT_FALSE(loaded(log));
+
+    EXPECT_EQ(run("", log), 1065u);
+    EXPECT_FALSE(loaded(log));
+
+    EXPECT_EQ(run(head, log), 10u);
+    EXPECT_TRUE(loaded(log));
+    EXPECT_EQ(run("", log), 1065u);
+    EXPECT_TRUE(loaded(log));
+
+    FileUtils::deleteDirectory(dir);
+}
@@ -40,6 +40,8 @@
 #include <pdal/pdal_config.hpp>
 #include <pdal/Filter.hpp>
 #include <pdal/util/Algorithm.hpp>
+#include <pdal/util/FileUtils.hpp>
+#include <pdal/private/PluginManifest.hpp>
 
 #include "Support.hpp"
 
@@ -171,5 +173,51 @@ TEST(PluginManagerTest, validnames)
 
 }
 
+TEST(PluginManagerTest, Manifest)
+{
+    std::string dir = Support::temppath("manifest");
+    std::string manifestFile = Support::temppath("plugin_manifest.json");
+    std::string lib = FileUtils::toAbsolutePath(
+        dir + "/libpdal_plugin_filter_fake" + Utils::dynamicLibExtension);
+    FileUtils::deleteFile(manifestFile);
+    FileUtils::createDirectory(dir);
+    {
+        std::ostream *out = FileUtils::createFile(lib);
+        *out << "not really a library";
+        FileUtils::closeFile(out);
+    }
+
+    PluginManifest::PluginList plugins;
+    {
+        PluginManifest manifest(manifestFile);
+        EXPECT_FALSE(manifest.plugins(lib, plugins));
+        manifest.record(lib,
+            { { "filters.fake", "A fake filter", "http://somewhere" } });
+    }
+
+    // A new manifest reads what was recorded.
+    PluginManifest manifest(manifestFile);
+    EXPECT_TRUE(manifest.plugins(lib, plugins));
+    ASSERT_EQ(plugins.size(), 1u);
+    EXPECT_EQ(plugins[0].m_name, "filters.fake");
+    EXPECT_EQ(plugins[0].m_description, "A fake filter");
+    EXPECT_EQ(plugins[0].m_link, "http://somewhere");
+    EXPECT_EQ(manifest.library("filters.fake", { "/nowhere", dir }), lib);
+    EXPECT_EQ(manifest.library("filters.fake", { "/nowhere" }), "");
+    EXPECT_EQ(manifest.library("filters.other", { dir }), "");
+
+    // A changed library isn't described by the manifest.
+    {
+        std::ostream *out = FileUtils::createFile(lib);
+        *out << "still not really a library";
+        FileUtils::closeFile(out);
+    }
+    EXPECT_FALSE(manifest.plugins(lib, plugins));
+    EXPECT_EQ(manifest.library("filters.fake", { dir }), "");
+
+    FileUtils::deleteFile(lib);
+    FileUtils::deleteFile(manifestFile);
+}
+
 } // namespace pdal
 
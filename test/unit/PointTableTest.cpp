@@ -34,7 +34,10 @@
 
 #include <pdal/pdal_test_main.hpp>
 
+#include <pdal/pdal_features.hpp>
 #include <pdal/PointTable.hpp>
+#include <filters/RangeFilter.hpp>
+#include <io/FauxReader.hpp>
 #include <io/LasReader.hpp>
 #include "Support.hpp"
 
@@ -255,6 +258,303 @@ TEST(PointTable, simple)
 
     ContiguousPointTable t2;
     simpleTest(t2);
+
+    ColumnPointTable t3;
+    simpleTest(t3);
+}
+
+
+TEST(PointTable, allocator)
+{
+    PointTable t1(1000, BlockAllocatorPtr(new HeapBlockAllocator));
+    simpleTest(t1);
+
+    PointTable t2(1000, BlockAllocatorPtr(new MappedBlockAllocator));
+    simpleTest(t2);
+
+    PointTable t3(100000, BlockAllocatorPtr(new MappedBlockAllocator(true)));
+    simpleTest(t3);
+
+    EXPECT_THROW(PointTable(0, BlockAllocatorPtr()), pdal_error);
+}
+
+
+TEST(PointTable, mapped)
+{
+    MappedPointTable t1(Support::temppath());
+    simpleTest(t1);
+
+    // Limit the resident data to less than a block so that blocks are
+    // released and read back.
+    PointTable t2(1000,
+        BlockAllocatorPtr(new FileBlockAllocator(Support::temppath(), 1)));
+    simpleTest(t2);
+
+#ifndef _WIN32
+    EXPECT_THROW(FileBlockAllocator("/nonexistent/directory"), pdal_error);
+#endif
+}
+
+
+TEST(PointTable, compressed)
+{
+    // Small blocks with two kept decompressed, so that blocks are
+    // compressed and decompressed many times.
+    CompressedPointTable t1(CompressedPointTable::Codec::Delta, 2, 1000);
+    simpleTest(t1);
+
+#ifdef PDAL_HAVE_LZ4
+    CompressedPointTable t2(CompressedPointTable::Codec::Lz4, 2, 1000);
+    simpleTest(t2);
+#else
+    EXPECT_THROW(CompressedPointTable(CompressedPointTable::Codec::Lz4),
+        pdal_error);
+#endif
+
+    // Compressed points take less memory than decompressed ones.
+    CompressedPointTable t3(CompressedPointTable::defaultCodec(), 2, 1000);
+    t3.layout()->registerDim(Dimension::Id::X);
+    PointView v(t3);
+    for (PointId id = 0; id < 100000; id++)
+        v.setField(Dimension::Id::X, id, id);
+    EXPECT_LT(t3.memoryUsed(), 8u * 100000 / 2);
+    for (PointId id = 0; id < 100000; id += 997)
+        EXPECT_EQ(v.getFieldAs<PointId>(Dimension::Id::X, id), id);
+
+    EXPECT_THROW(CompressedPointTable(CompressedPointTable::Codec::Delta, 2,
+        0), pdal_error);
+}
+
+
+TEST(PointTable, memoryLimit)
+{
+    PointTable table(1000, BlockAllocatorPtr());
+    PointLayoutPtr layout = table.layout();
+    layout->registerDim(Dimension::Id::X);
+
+    // Each block holds 1000 8-byte values.
+    table.setMemoryLimit(8000 * 3);
+    PointView v(table);
+    for (PointId id = 0; id < 3000; id++)
+        v.setField(Dimension::Id::X, id, id);
+    EXPECT_EQ(table.memoryUsed(), 8000u * 3);
+    EXPECT_THROW(v.setField(Dimension::Id::X, 3000, 3000), pdal_error);
+}
+
+
+// Blocks that hold only points dropped by a filter are released once the
+// views upstream of the filter are freed.
+TEST(PointTable, releaseUpstream)
+{
+    Options readerOps;
+    readerOps.add("bounds", BOX3D(1, 1, 1, 10000, 10000, 10000));
+    readerOps.add("mode", "ramp");
+    readerOps.add("count", 10000);
+    FauxReader r;
+    r.setOptions(readerOps);
+
+    Options rangeOps;
+    rangeOps.add("limits", "X[1:1500]");
+    RangeFilter f;
+    f.setOptions(rangeOps);
+    f.setInput(r);
+
+    PointTable table(1000, BlockAllocatorPtr());
+    f.prepare(table);
+    const std::size_t pointSize = table.layout()->pointSize();
+
+    PointViewSet s = f.execute(table);
+    PointViewPtr v = *s.begin();
+    EXPECT_EQ(v->size(), 1500u);
+    EXPECT_DOUBLE_EQ(v->getFieldAs<double>(Dimension::Id::X, 1499), 1500);
+
+    // The first two blocks hold the kept points and the last block is
+    // always kept.
+    EXPECT_EQ(table.memoryUsed(), 3000 * pointSize);
+    EXPECT_EQ(table.releaseUnreferenced(), 0u);
+}
+
+TEST(PointTable, quantize)
+{
+    using namespace Dimension;
+
+    auto check = [](PointTableRef table)
+    {
+        PointLayoutPtr layout = table.layout();
+        layout->registerDim(Id::X);
+        layout->registerDim(Id::Y);
+        layout->quantizeDim(Id::X, .01, 100);
+        EXPECT_THROW(layout->quantizeDim(Id::Intensity, .01, 0), pdal_error);
+        layout->registerDim(Id::Intensity);
+        EXPECT_EQ(layout->pointSize(), 18u);
+        EXPECT_EQ(layout->storageSize(), 14u);
+
+        PointView v(table);
+        v.setField(Id::X, 0, 123.456);
+        v.setField(Id::Y, 0, 123.456);
+        EXPECT_DOUBLE_EQ(v.getFieldAs<double>(Id::X, 0), 123.46);
+        EXPECT_DOUBLE_EQ(v.getFieldAs<double>(Id::Y, 0), 123.456);
+        EXPECT_EQ(v.getQuantized(Id::X, 0), 2346);
+
+        // Values outside the range of the stored integers can't be set.
+        EXPECT_THROW(v.setField(Id::X, 0, 1e10), pdal_error);
+    };
+
+    PointTable table;
+    check(table);
+    ColumnPointTable colTable;
+    check(colTable);
+
+    // Conflicting scales turn quantization off.
+    PointLayout layout;
+    layout.registerDim(Id::X);
+    layout.quantizeDim(Id::X, .01, 0);
+    layout.quantizeDim(Id::X, .01, 0);
+    EXPECT_TRUE(layout.dimDetail(Id::X)->quantized());
+    layout.quantizeDim(Id::X, .001, 0);
+    EXPECT_FALSE(layout.dimDetail(Id::X)->quantized());
+    layout.quantizeDim(Id::X, .01, 0);
+    EXPECT_FALSE(layout.dimDetail(Id::X)->quantized());
+    EXPECT_EQ(layout.storageSize(), 8u);
+}
+
+TEST(PointTable, aligned)
+{
+    using namespace Dimension;
+
+    PointTable table;
+    PointLayoutPtr layout = table.layout();
+    layout->registerDim(Id::Intensity);
+    layout->registerDim(Id::PointSourceId);
+    layout->registerDim(Id::Classification);
+    layout->registerDim(Id::GpsTime);
+    layout->registerDim(Id::X);
+    EXPECT_EQ(layout->storageSize(), 21u);
+
+    layout->setAligned(true);
+    EXPECT_EQ(layout->pointSize(), 21u);
+    EXPECT_EQ(layout->storageSize(), 24u);
+    for (Id id : layout->dims())
+        EXPECT_EQ(layout->dimOffset(id) % layout->dimSize(id), 0u);
+
+    // X comes first, and priority orders dimensions of the same size.
+    EXPECT_EQ(layout->dimOffset(Id::X), 0u);
+    EXPECT_LT(layout->dimOffset(Id::Intensity),
+        layout->dimOffset(Id::PointSourceId));
+    layout->setDimPriority(Id::PointSourceId, 2);
+    EXPECT_LT(layout->dimOffset(Id::PointSourceId),
+        layout->dimOffset(Id::Intensity));
+
+    PointView v(table);
+    for (PointId i = 0; i < 10; ++i)
+    {
+        v.setField(Id::X, i, i * 1.5);
+        v.setField(Id::Intensity, i, i);
+    }
+    for (PointId i = 0; i < 10; ++i)
+    {
+        EXPECT_EQ(v.getFieldAs<double>(Id::X, i), i * 1.5);
+        EXPECT_EQ(v.getFieldAs<uint16_t>(Id::Intensity, i), i);
+        EXPECT_EQ((uintptr_t)v.getPoint(i) % 8, 0u);
+    }
+
+    table.finalize();
+    EXPECT_THROW(layout->setAligned(false), pdal_error);
+}
+
+TEST(PointTable, adaptiveStream)
+{
+    using namespace Dimension;
+
+    auto capacity = [](FixedPointTable& table)
+    {
+        PointLayoutPtr layout = table.layout();
+        layout->registerDim(Id::X);
+        layout->registerDim(Id::Y);
+        layout->registerDim(Id::Z);
+        table.finalize();
+        return table.capacity();
+    };
+
+    // Three doubles per point.
+    const point_count_t footprint = FixedPointTable::DefaultFootprint;
+    FixedPointTable t1(0);
+    EXPECT_TRUE(t1.adaptive());
+    EXPECT_EQ(capacity(t1), footprint / 24);
+
+    const point_count_t minCapacity = FixedPointTable::MinAdaptiveCapacity;
+    FixedPointTable t2(100);
+    EXPECT_FALSE(t2.adaptive());
+    t2.setAdaptive(1000);
+    EXPECT_EQ(capacity(t2), minCapacity);
+
+    FixedPointTable t3(0);
+    t3.setCapacity(100);
+    EXPECT_FALSE(t3.adaptive());
+    EXPECT_EQ(capacity(t3), 100u);
+}
+
+TEST(PointTable, column)
+{
+    using namespace Dimension;
+
+    ColumnPointTable table;
+    PointLayoutPtr layout = table.layout();
+    layout->registerDim(Id::X);
+    layout->registerDim(Id::Y);
+    layout->registerDim(Id::Z);
+    layout->registerDim(Id::Intensity);
+
+    // Fill past the initial capacity so that the columns must grow.
+    const point_count_t count = 100000;
+    PointView v(table);
+    for (PointId id = 0; id < count; id++)
+    {
+        v.setField(Id::X, id, id);
+        v.setField(Id::Y, id, -(double)id);
+        v.setField(Id::Z, id, id / 2.0);
+        v.setField(Id::Intensity, id, id % 1000);
+    }
+
+    const double *x = table.dimensionData<double>(Id::X);
+    const uint16_t *intensity = table.dimensionData<uint16_t>(Id::Intensity);
+    for (PointId id = 0; id < count; id++)
+    {
+        EXPECT_EQ(x[v.tableIndex(id)], (double)id);
+        EXPECT_EQ(intensity[v.tableIndex(id)], id % 1000);
+    }
+
+    BOX3D bounds;
+    v.calculateBounds(bounds);
+    EXPECT_EQ(bounds, BOX3D(0, -(double)(count - 1), 0,
+        count - 1, 0, (count - 1) / 2.0));
+
+    EXPECT_THROW(table.dimensionData<float>(Id::X), pdal_error);
+    EXPECT_THROW(table.dimensionData<int16_t>(Id::Intensity), pdal_error);
+    EXPECT_THROW(v.getPoint(0), pdal_error);
+}
+
+TEST(PointTable, capabilities)
+{
+    PointTable rows;
+    EXPECT_TRUE(rows.packedPoints());
+    EXPECT_FALSE(rows.columnData());
+    EXPECT_TRUE(rows.releasableStorage());
+
+    ColumnPointTable columns;
+    EXPECT_FALSE(columns.packedPoints());
+    EXPECT_TRUE(columns.columnData());
+    EXPECT_FALSE(columns.releasableStorage());
+
+    CompressedPointTable compressed;
+    EXPECT_FALSE(compressed.packedPoints());
+    EXPECT_FALSE(compressed.columnData());
+    EXPECT_FALSE(compressed.releasableStorage());
+
+    FixedPointTable fixed(100);
+    EXPECT_TRUE(fixed.packedPoints());
+    EXPECT_FALSE(fixed.columnData());
+    EXPECT_THROW(fixed.dimensionData<double>(Dimension::Id::X), pdal_error);
 }
 
 } // namespace
@@ -37,6 +37,7 @@
 #include <array>
 #include <random>
 
+#include <pdal/DimAccessor.hpp>
 #include <pdal/EigenUtils.hpp>
 #include <pdal/PointView.hpp>
 #include <pdal/PDALUtils.hpp>
@@ -290,6 +291,301 @@ TEST(PointViewTest, getFloatNan)
     EXPECT_NO_THROW(view->getFieldAs<float>(Dimension::Id::ScanAngleRank, 0));
 }
 
+TEST(PointViewTest, idIndex)
+{
+    PointIdIndex index;
+    for (PointId id = 10; id < 20; ++id)
+        index.push_back(id);
+    EXPECT_TRUE(index.isRange());
+    EXPECT_EQ(index.size(), 10u);
+    EXPECT_EQ(index[3], 13u);
+
+    // Appending an adjacent range keeps the range representation.
+    PointIdIndex other;
+    for (PointId id = 20; id < 25; ++id)
+        other.push_back(id);
+    index.append(other, other.size());
+    EXPECT_TRUE(index.isRange());
+    EXPECT_EQ(index.size(), 15u);
+    EXPECT_EQ(index[14], 24u);
+
+    // Setting an entry to its existing value doesn't change anything.
+    index.set(2, 12);
+    EXPECT_TRUE(index.isRange());
+
+    index.swap(0, 14);
+    EXPECT_FALSE(index.isRange());
+    EXPECT_EQ(index[0], 24u);
+    EXPECT_EQ(index[14], 10u);
+    EXPECT_EQ(index[7], 17u);
+    EXPECT_THROW(index.at(15), std::out_of_range);
+
+    index.truncate(5);
+    EXPECT_EQ(index.size(), 5u);
+    index.push_back(3);
+    EXPECT_EQ(index[5], 3u);
+
+    // Appending ranges that aren't adjacent adds segments.
+    PointIdIndex merged;
+    merged.append(other, other.size());
+    PointIdIndex low;
+    for (PointId id = 0; id < 10; ++id)
+        low.push_back(id);
+    merged.append(low, 8);
+    merged.append(other, 2);
+    EXPECT_FALSE(merged.isRange());
+    EXPECT_TRUE(merged.isSegmented());
+    EXPECT_EQ(merged.size(), 15u);
+    EXPECT_EQ(merged.memoryUsed() % sizeof(PointId), 0u);
+    std::vector<PointId> ids { 20, 21, 22, 23, 24, 0, 1, 2, 3, 4, 5, 6, 7,
+        20, 21 };
+    for (PointId i = 0; i < ids.size(); ++i)
+        EXPECT_EQ(merged[i], ids[i]);
+    size_t ranges = 0;
+    merged.forEachRange([&ranges](PointId, point_count_t){ ranges++; });
+    EXPECT_EQ(ranges, 3u);
+
+    // Truncating back into the first segment restores the range.
+    merged.truncate(7);
+    EXPECT_EQ(merged[6], 1u);
+    merged.truncate(4);
+    EXPECT_TRUE(merged.isRange());
+    EXPECT_EQ(merged[3], 23u);
+
+    merged.append(low, 10);
+    merged.swap(0, 1);
+    EXPECT_FALSE(merged.isSegmented());
+    EXPECT_EQ(merged[0], 21u);
+    EXPECT_EQ(merged[13], 9u);
+
+    // Check views converted to explicit IDs by subsetting and sorting.
+    PointTable table;
+    PointViewPtr view = makeTestView(table, 100);
+
+    PointViewPtr even = view->makeNew();
+    for (PointId id = 0; id < view->size(); id += 2)
+        even->appendPoint(*view, id);
+    EXPECT_EQ(even->tableIndex(10), 20u);
+
+    // Sort in descending order of X.
+    auto cmp = [](const PointRef& p1, const PointRef& p2)
+        { return p2.compare(Dimension::Id::X, p1); };
+    std::sort(view->begin(), view->end(), cmp);
+    for (PointId id = 1; id < view->size(); ++id)
+        EXPECT_GT(view->getFieldAs<double>(Dimension::Id::X, id - 1),
+            view->getFieldAs<double>(Dimension::Id::X, id));
+}
+
+TEST(PointViewTest, dimAccessor)
+{
+    using namespace Dimension;
+
+    auto check = [](PointTableRef table, bool direct)
+    {
+        PointViewPtr view = makeTestView(table, 100);
+
+        // X is stored as a double.
+        DimAccessor<double> x(*view, Id::X);
+        EXPECT_EQ(x.direct(), direct);
+        DimAccessor<int> xi(*view, Id::X);
+        EXPECT_FALSE(xi.direct());
+        for (PointId i = 0; i < view->size(); ++i)
+        {
+            EXPECT_EQ(x.get(i), i * 10.0);
+            EXPECT_EQ(xi.get(i), (int)i * 10);
+        }
+
+        x.set(5, 3.5);
+        EXPECT_EQ(view->getFieldAs<double>(Id::X, 5), 3.5);
+        xi.set(6, 7);
+        EXPECT_EQ(view->getFieldAs<double>(Id::X, 6), 7.0);
+
+        // Setting the point past the end adds a point.
+        x.set(view->size(), 1.0);
+        EXPECT_EQ(view->size(), 101u);
+
+        double sum = 0;
+        x.forEach([&sum](PointId, double d){ sum += d; });
+        EXPECT_EQ(sum, 49500.0 - 50 - 60 + 3.5 + 7 + 1);
+
+        // Values are converted by forEach() the same way as by get().
+        PointId count = 0;
+        xi.forEach([&xi, &count](PointId idx, int i)
+        {
+            EXPECT_EQ(i, xi.get(idx));
+            count++;
+        });
+        EXPECT_EQ(count, view->size());
+
+        // Conversions that don't fit in the requested type throw.
+        DimAccessor<uint8_t> x8(*view, Id::X);
+        EXPECT_THROW(x8.get(99), pdal_error);
+    };
+
+    PointTable table;
+    check(table, true);
+    ColumnPointTable colTable;
+    check(colTable, false);
+}
+
+TEST(PointViewTest, copyField)
+{
+    using namespace Dimension;
+
+    auto check = [](PointTableRef table)
+    {
+        PointLayoutPtr layout(table.layout());
+        Id big = layout->assignDim("Big", Type::Signed64);
+        Id bigCopy = layout->assignDim("BigCopy", Type::Signed64);
+        Id small = layout->assignDim("Small", Type::Unsigned8);
+        Id xCopy = layout->assignDim("XCopy", Type::Float);
+        PointViewPtr view = makeTestView(table, 100);
+
+        // Values too large to be exact as doubles are copied exactly.
+        const int64_t base = (int64_t)1 << 60;
+        for (PointId i = 0; i < view->size(); ++i)
+            view->setField(big, i, base + (int64_t)i);
+        view->copyField(bigCopy, big);
+        view->copyField(small, Id::Classification);
+        view->copyField(xCopy, Id::X);
+        for (PointId i = 0; i < view->size(); ++i)
+        {
+            EXPECT_EQ(view->getFieldAs<int64_t>(bigCopy, i),
+                base + (int64_t)i);
+            EXPECT_EQ(view->getFieldAs<int>(small, i), (int)i + 1);
+            EXPECT_EQ(view->getFieldAs<float>(xCopy, i), i * 10.0f);
+        }
+
+        // Values that don't fit the destination type throw.
+        EXPECT_THROW(view->copyField(small, Id::X), pdal_error);
+    };
+
+    PointTable table;
+    check(table);
+    ColumnPointTable colTable;
+    check(colTable);
+}
+
+namespace
+{
+
+struct Sizer
+{
+    typedef size_t result_type;
+
+    template<typename T>
+    size_t operator()(T) const
+        { return sizeof(T); }
+};
+
+} // unnamed namespace
+
+TEST(PointViewTest, typeVisit)
+{
+    using namespace Dimension;
+
+    EXPECT_EQ(visit(Type::Signed16, Sizer()), 2u);
+    EXPECT_EQ(visit(Type::Double, Sizer()), 8u);
+    EXPECT_THROW(visit(Type::None, Sizer()), pdal_error);
+
+    static_assert(Traits<Id::X>::type == Type::Double, "X type");
+    static_assert(std::is_same<Traits<Id::Intensity>::value_type,
+        uint16_t>::value, "Intensity type");
+}
+
+// Compaction copies points through the table's field access, so tables
+// without packed points can be used.
+TEST(PointViewTest, compact)
+{
+    auto check = [](PointTableRef table)
+    {
+        PointViewPtr view = makeTestView(table);
+        PointId id = view->tableIndex(0);
+        view->compact();
+        EXPECT_NE(view->tableIndex(0), id);
+        verifyTestView(*view);
+    };
+
+    PointTable table;
+    check(table);
+    ColumnPointTable colTable;
+    check(colTable);
+}
+
+TEST(PointViewTest, makeShared)
+{
+    using namespace Dimension;
+
+    PointTable table;
+    PointViewPtr view = makeTestView(table);
+    PointViewPtr shared = view->makeShared();
+    PointViewPtr other = view->makeShared();
+    EXPECT_EQ(shared->size(), view->size());
+    verifyTestView(*shared);
+
+    // Changing a point copies the points of the view that's changed only.
+    shared->setField(Id::X, 3, 1000);
+    EXPECT_NE(shared->tableIndex(3), view->tableIndex(3));
+    EXPECT_EQ(shared->getFieldAs<double>(Id::X, 3), 1000.0);
+    verifyTestView(*view);
+    verifyTestView(*other);
+
+    // A view made from the points of a shared view shares them too.
+    PointViewPtr sub = other->makeNew();
+    sub->appendPoint(*other, 4);
+    DimAccessor<double> x(*sub, Id::X);
+    x.set(0, 2000);
+    EXPECT_EQ(sub->getFieldAs<double>(Id::X, 0), 2000.0);
+    verifyTestView(*view);
+    verifyTestView(*other);
+
+    // Once no other view shares the points, they're changed in place.
+    sub.reset();
+    other.reset();
+    PointId id = view->tableIndex(5);
+    view->setField(Id::X, 5, 3000);
+    EXPECT_EQ(view->tableIndex(5), id);
+    EXPECT_EQ(view->getFieldAs<double>(Id::X, 5), 3000.0);
+}
+
+TEST(PointViewTest, mesh)
+{
+    PointTable table;
+    PointViewPtr view = makeTestView(table);
+    TriangularMesh *mesh = view->createMesh("test");
+    ASSERT_NE(mesh, nullptr);
+    EXPECT_EQ(view->createMesh("test"), nullptr);
+
+    mesh->add(0, 1, 2);
+    std::vector<size_t> indices { 1, 2, 3, 2, 3, 4 };
+    mesh->append(indices.data(), indices.size());
+    EXPECT_EQ(mesh->size(), 3u);
+    EXPECT_EQ((*mesh)[1], Triangle(1, 2, 3));
+    EXPECT_EQ(mesh->memoryUsed() / mesh->size() / 3, sizeof(uint32_t));
+
+    std::vector<uint32_t> copied(6);
+    mesh->copyIndices(1, 2, copied.data(), 10);
+    EXPECT_EQ(copied, std::vector<uint32_t>({ 11, 12, 13, 12, 13, 14 }));
+
+    // Indices that don't fit in 32 bits widen the storage.
+    const PointId big = (PointId)(std::numeric_limits<uint32_t>::max)() + 1;
+    mesh->add(big, 1, 2);
+    EXPECT_EQ(mesh->size(), 4u);
+    EXPECT_EQ((*mesh)[0], Triangle(0, 1, 2));
+    EXPECT_EQ((*mesh)[3].m_a, big);
+
+    std::vector<Triangle> faces;
+    mesh->forEach([&faces](PointId a, PointId b, PointId c)
+        { faces.emplace_back(a, b, c); });
+    std::vector<Triangle> iterated(mesh->begin(), mesh->end());
+    ASSERT_EQ(faces.size(), 4u);
+    for (size_t i = 0; i < faces.size(); ++i)
+    {
+        EXPECT_EQ(faces[i], (*mesh)[i]);
+        EXPECT_EQ(iterated[i], (*mesh)[i]);
+    }
+}
+
 // Per discussions with @abellgithub (https://github.com/gadomski/PDAL/commit/c1d54e56e2de841d37f2a1b1c218ed723053f6a9#commitcomment-14415138)
 // we only do bounds checking on `PointView`s when in debug mode.
 #ifndef NDEBUG
@@ -0,0 +1,149 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <sstream>
+
+#include <nlohmann/json.hpp>
+
+#include <pdal/PipelineManager.hpp>
+#include <pdal/Progress.hpp>
+#include <pdal/StageFactory.hpp>
+#include "Support.hpp"
+
+using namespace pdal;
+
+namespace
+{
+
+std::vector<Progress::Status> run(const std::string& pipeline,
+    ExecMode mode)
+{
+    std::vector<Progress::Status> reports;
+
+    PipelineManager mgr;
+    std::istringstream in(pipeline);
+    mgr.readPipeline(in);
+    mgr.setProgressInterval(.001);
+    mgr.setProgressCallback([&reports](const Progress::Status& status)
+        { reports.push_back(status); });
+    mgr.execute(mode);
+    return reports;
+}
+
+} // unnamed namespace
+
+TEST(ProgressTest, status)
+{
+    StageFactory f;
+    Stage *a = f.createStage("readers.faux");
+    Stage *b = f.createStage("readers.faux");
+
+    Progress p(1, -1, Progress::Callback());
+    p.addSource(a);
+    p.addSource(b);
+    p.setTotal(a, 100);
+    p.add(a, 40, 400);
+
+    // Points counted at the end of a read aren't added to those reported.
+    p.count(a, 30);
+    p.count(b, 10);
+
+    Progress::Status status = p.status();
+    EXPECT_EQ(status.m_points, 50u);
+    EXPECT_EQ(status.m_bytes, 400u);
+
+    // No estimate is made until every reader has a total.
+    EXPECT_EQ(status.m_total, 0u);
+    EXPECT_LT(status.m_eta, 0);
+
+    p.setTotal(b, 100);
+    status = p.status();
+    EXPECT_EQ(status.m_total, 200u);
+    EXPECT_GE(status.m_eta, 0);
+}
+
+TEST(ProgressTest, las)
+{
+    NL::json j;
+    j["pipeline"] = { Support::datapath("las/simple.las") };
+    std::string pipeline = j.dump();
+
+    for (ExecMode mode : { ExecMode::Standard, ExecMode::Stream })
+    {
+        std::vector<Progress::Status> reports = run(pipeline, mode);
+        ASSERT_GE(reports.size(), 1u);
+
+        const Progress::Status& last = reports.back();
+        EXPECT_TRUE(last.m_done);
+        EXPECT_EQ(last.m_points, 1065u);
+        EXPECT_EQ(last.m_total, 1065u);
+        EXPECT_EQ(last.m_bytes, 1065u * 34);
+        EXPECT_EQ(last.m_eta, 0);
+        for (size_t i = 1; i < reports.size(); ++i)
+            EXPECT_GE(reports[i].m_points, reports[i - 1].m_points);
+    }
+}
+
+TEST(ProgressTest, unknownTotal)
+{
+    std::string pipeline(R"([
+        { "type": "readers.faux", "count": 5000, "mode": "ramp" },
+        { "type": "filters.range", "limits": "X[:0.5]" }
+    ])");
+
+    for (ExecMode mode : { ExecMode::Standard, ExecMode::Stream })
+    {
+        std::vector<Progress::Status> reports = run(pipeline, mode);
+        ASSERT_GE(reports.size(), 1u);
+
+        // The points read are counted, not the points kept by the filter.
+        const Progress::Status& last = reports.back();
+        EXPECT_TRUE(last.m_done);
+        EXPECT_EQ(last.m_points, 5000u);
+        EXPECT_EQ(last.m_total, 0u);
+    }
+}
+
+TEST(ProgressTest, json)
+{
+    Progress::Status status;
+    status.m_points = 10;
+    NL::json j = NL::json::parse(status.toJSON());
+    EXPECT_EQ(j["points"].get<int>(), 10);
+    EXPECT_FALSE(j.contains("total"));
+    EXPECT_FALSE(j.contains("eta"));
+    EXPECT_FALSE(j["done"].get<bool>());
+}
@@ -0,0 +1,150 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <algorithm>
+#include <limits>
+
+#include <pdal/PointView.hpp>
+#include <pdal/QuadIndex.hpp>
+
+using namespace pdal;
+
+namespace
+{
+
+void fill(PointView& view, point_count_t count)
+{
+    uint32_t seed = 1357;
+    auto next = [&seed]()
+    {
+        seed = seed * 1664525 + 1013904223;
+        return (seed >> 16) / 100.0;
+    };
+    for (PointId i = 0; i < count; ++i)
+    {
+        view.setField(Dimension::Id::X, i, next());
+        view.setField(Dimension::Id::Y, i, next());
+    }
+}
+
+} // unnamed namespace
+
+TEST(QuadIndexTest, allPoints)
+{
+    PointTable table;
+    table.layout()->registerDim(Dimension::Id::X);
+    table.layout()->registerDim(Dimension::Id::Y);
+    PointView view(table);
+    fill(view, 20000);
+
+    QuadIndex idx(view);
+
+    PointIdList ids = idx.getPoints();
+    std::sort(ids.begin(), ids.end());
+    ASSERT_EQ(ids.size(), view.size());
+    for (PointId i = 0; i < ids.size(); ++i)
+        EXPECT_EQ(ids[i], i);
+
+    std::vector<std::size_t> fills = idx.getFills();
+    ASSERT_GT(fills.size(), 3u);
+    EXPECT_EQ(fills[0], 1u);
+    std::size_t total = 0;
+    for (std::size_t f : fills)
+        total += f;
+    EXPECT_EQ(total, view.size());
+
+    // Levels partition the points.
+    PointIdList top = idx.getPoints(3);
+    PointIdList rest = idx.getPoints(3, 0);
+    EXPECT_EQ(top.size(), fills[0] + fills[1] + fills[2]);
+    EXPECT_EQ(top.size() + rest.size(), view.size());
+}
+
+TEST(QuadIndexTest, boundsQuery)
+{
+    PointTable table;
+    table.layout()->registerDim(Dimension::Id::X);
+    table.layout()->registerDim(Dimension::Id::Y);
+    PointView view(table);
+    fill(view, 20000);
+
+    QuadIndex idx(view);
+
+    const double xMin(100), yMin(200), xMax(250), yMax(300);
+    PointIdList ids = idx.getPoints(xMin, yMin, xMax, yMax);
+    std::sort(ids.begin(), ids.end());
+
+    PointIdList expected;
+    for (PointId i = 0; i < view.size(); ++i)
+    {
+        double x = view.getFieldAs<double>(Dimension::Id::X, i);
+        double y = view.getFieldAs<double>(Dimension::Id::Y, i);
+        if (x >= xMin && x < xMax && y >= yMin && y < yMax)
+            expected.push_back(i);
+    }
+    EXPECT_GT(expected.size(), 0u);
+    EXPECT_TRUE(ids == expected);
+}
+
+TEST(QuadIndexTest, rasterize)
+{
+    PointTable table;
+    table.layout()->registerDim(Dimension::Id::X);
+    table.layout()->registerDim(Dimension::Id::Y);
+    PointView view(table);
+    fill(view, 20000);
+
+    QuadIndex idx(view);
+
+    double xBegin, xEnd, xStep, yBegin, yEnd, yStep;
+    PointIdList ids = idx.getPoints(4, xBegin, xEnd, xStep,
+        yBegin, yEnd, yStep);
+    ASSERT_EQ(ids.size(), 16u * 16u);
+
+    // Each filled cell holds a point that lies in that cell.
+    const double halfX(xStep / 2);
+    const double halfY(yStep / 2);
+    for (std::size_t row = 0; row < 16; ++row)
+        for (std::size_t col = 0; col < 16; ++col)
+        {
+            PointId id = ids[row * 16 + col];
+            if (id == (std::numeric_limits<PointId>::max)())
+                continue;
+            double x = view.getFieldAs<double>(Dimension::Id::X, id);
+            double y = view.getFieldAs<double>(Dimension::Id::Y, id);
+            EXPECT_NEAR(x, xBegin + col * xStep, halfX);
+            EXPECT_NEAR(y, yBegin + row * yStep, halfY);
+        }
+}
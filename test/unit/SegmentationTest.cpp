@@ -95,6 +95,38 @@ TEST(SegmentationTest, BasicClustering)
     EXPECT_EQ(1u, clusters[0].size());
 }
 
+TEST(SegmentationTest, ClusteringThreads)
+{
+    using namespace Segmentation;
+
+    PointTable table;
+    PointLayoutPtr layout(table.layout());
+
+    layout->registerDim(Dimension::Id::X);
+    layout->registerDim(Dimension::Id::Y);
+    layout->registerDim(Dimension::Id::Z);
+
+    PointViewPtr src(new PointView(table));
+
+    // Rows of points one apart, the rows three apart, so that each row is
+    // a cluster.  Points are added in a scattered order.
+    const PointId count = 10000;
+    for (PointId i = 0; i < count; ++i)
+    {
+        PointId j = (i * 7919) % count;
+        src->setField(Dimension::Id::X, i, (double)(j % 100));
+        src->setField(Dimension::Id::Y, i, 3.0 * (j / 100));
+        src->setField(Dimension::Id::Z, i, 0.0);
+    }
+
+    std::vector<PointIdList> one = extractClusters(*src, 1, 1000, 1.5, 1);
+    std::vector<PointIdList> three = extractClusters(*src, 1, 1000, 1.5, 3);
+    EXPECT_EQ(100u, one.size());
+    EXPECT_EQ(one, three);
+    for (std::size_t c = 1; c < one.size(); ++c)
+        EXPECT_LT(one[c - 1][0], one[c][0]);
+}
+
 TEST(SegmentationTest, SegmentReturns)
 {
     using namespace Segmentation;
@@ -459,6 +459,39 @@ TEST(SpatialReferenceTest, identifyEPSG)
     EXPECT_EQ(web.identifyVerticalEPSG(), "");
 }
 
+// Properties and comparisons are memoized.  Make sure repeated calls
+// give the same answers.
+TEST(SpatialReferenceTest, memoized)
+{
+    SpatialReference geo("EPSG:4326");
+    SpatialReference geo2("EPSG:4326");
+    SpatialReference utm("EPSG:26916");
+    EXPECT_EQ(geo.getWKT(), geo2.getWKT());
+
+    for (int i = 0; i < 2; ++i)
+    {
+        EXPECT_TRUE(geo.isGeographic());
+        EXPECT_FALSE(geo.isProjected());
+        EXPECT_TRUE(utm.isProjected());
+        EXPECT_FALSE(utm.isGeographic());
+        EXPECT_EQ(utm.getHorizontalUnits(), "metre");
+        EXPECT_TRUE(geo.getVertical().empty());
+        EXPECT_NE(geo, utm);
+        EXPECT_NE(utm, geo);
+        EXPECT_EQ(geo, geo2);
+    }
+
+    // An SRS with different WKT can still be the same.
+    SpatialReference pretty(SpatialReference::prettyWkt(geo.getWKT()));
+    EXPECT_NE(geo.getWKT(), pretty.getWKT());
+    EXPECT_EQ(geo, pretty);
+    EXPECT_EQ(pretty, geo);
+
+    SpatialReference empty;
+    EXPECT_FALSE(empty.isGeographic());
+    EXPECT_TRUE(empty.getHorizontal().empty());
+}
+
 // Make sure we get positive, negative and 0 back for UTM zones.
 TEST(SpatialReferenceTest, issue_1989)
 {
@@ -36,8 +36,14 @@
 #include <pdal/Filter.hpp>
 #include <pdal/PointTable.hpp>
 #include <io/FauxReader.hpp>
+#include <io/LasReader.hpp>
+#include <io/LasWriter.hpp>
 #include <pdal/StageFactory.hpp>
+#include <pdal/util/FileUtils.hpp>
+#include <filters/AssignFilter.hpp>
+#include <filters/FerryFilter.hpp>
 #include <filters/MergeFilter.hpp>
+#include <filters/RangeFilter.hpp>
 #include <filters/StreamCallbackFilter.hpp>
 #include "Support.hpp"
 
@@ -528,3 +534,429 @@ R"(
         EXPECT_NE(output.find("DBDCA"), std::string::npos);
     }
 }
+
+// Check that the batch processing done by the LAS reader and writer and
+// filters.range gives the same result as standard mode, including when the
+// table capacity doesn't evenly divide the number of points.
+TEST(Streaming, batch)
+{
+    auto run = [](bool stream, const std::string& filename)
+    {
+        Options ro;
+        ro.add("filename", Support::datapath("las/1.2-with-color.las"));
+        LasReader r;
+        r.setOptions(ro);
+
+        Options fo;
+        fo.add("limits", "Classification[2:2]");
+        RangeFilter f;
+        f.setOptions(fo);
+        f.setInput(r);
+
+        Options wo;
+        wo.add("filename", filename);
+        LasWriter w;
+        w.setOptions(wo);
+        w.setInput(f);
+
+        if (stream)
+        {
+            FixedPointTable t(100);
+            w.prepare(t);
+            w.execute(t);
+        }
+        else
+        {
+            PointTable t;
+            w.prepare(t);
+            w.execute(t);
+        }
+    };
+
+    std::string streamFile(Support::temppath("batch_stream.las"));
+    std::string standardFile(Support::temppath("batch_standard.las"));
+    run(true, streamFile);
+    run(false, standardFile);
+
+    auto read = [](const std::string& filename, PointTable& t)
+    {
+        Options ro;
+        ro.add("filename", filename);
+        LasReader r;
+        r.setOptions(ro);
+        r.prepare(t);
+        PointViewSet s = r.execute(t);
+        return *s.begin();
+    };
+
+    PointTable t1;
+    PointTable t2;
+    PointViewPtr v1 = read(streamFile, t1);
+    PointViewPtr v2 = read(standardFile, t2);
+    ASSERT_GT(v1->size(), 0u);
+    ASSERT_EQ(v1->size(), v2->size());
+    for (PointId i = 0; i < v1->size(); ++i)
+    {
+        EXPECT_EQ(v1->getFieldAs<double>(Dimension::Id::X, i),
+            v2->getFieldAs<double>(Dimension::Id::X, i));
+        EXPECT_EQ(v1->getFieldAs<int>(Dimension::Id::Classification, i), 2);
+    }
+    FileUtils::deleteFile(streamFile);
+    FileUtils::deleteFile(standardFile);
+}
+
+TEST(Streaming, activeIds)
+{
+    FixedPointTable t(10);
+    t.layout()->registerDim(Dimension::Id::X);
+    t.finalize();
+
+    auto ids = [&t](PointId begin, point_count_t count)
+    {
+        StreamPointTable::IdRange r = t.activeIds(begin, count);
+        return std::vector<PointId>(r.begin(), r.end());
+    };
+
+    t.setActiveCount(8);
+    EXPECT_EQ(ids(0, 8), std::vector<PointId>({ 0, 1, 2, 3, 4, 5, 6, 7 }));
+
+    // Skipped points stay listed until the list is compacted.
+    t.setSkip(1);
+    t.setSkip(4);
+    t.setSkip(5);
+    EXPECT_EQ(ids(0, 8).size(), 8u);
+    t.compactActive();
+    EXPECT_EQ(ids(0, 8), std::vector<PointId>({ 0, 2, 3, 6, 7 }));
+    EXPECT_EQ(ids(2, 4), std::vector<PointId>({ 2, 3 }));
+    EXPECT_EQ(ids(4, 2).size(), 0u);
+
+    t.clear(8);
+    EXPECT_EQ(ids(0, 10).size(), 10u);
+    EXPECT_FALSE(t.skip(4));
+}
+
+// Points dropped by one filter aren't seen by the next.
+TEST(Streaming, chainedFilters)
+{
+    Options ro;
+    ro.add("mode", "ramp");
+    ro.add("bounds", BOX3D(0, 0, 0, 999, 999, 999));
+    ro.add("count", 1000);
+    FauxReader r;
+    r.setOptions(ro);
+
+    Options fo1;
+    fo1.add("limits", "X[100:899]");
+    RangeFilter f1;
+    f1.setOptions(fo1);
+    f1.setInput(r);
+
+    Options fo2;
+    fo2.add("limits", "Y[:199],Y[800:]");
+    RangeFilter f2;
+    f2.setOptions(fo2);
+    f2.setInput(f1);
+
+    point_count_t seen = 0;
+    StreamCallbackFilter f3;
+    f3.setCallback([&seen](PointRef& point)
+    {
+        double x = point.getFieldAs<double>(Dimension::Id::X);
+        double y = point.getFieldAs<double>(Dimension::Id::Y);
+        EXPECT_TRUE(x >= 100 && x <= 899);
+        EXPECT_TRUE(y <= 199 || y >= 800);
+        seen++;
+        return true;
+    });
+    f3.setInput(f2);
+
+    FixedPointTable t(64);
+    f3.prepare(t);
+    f3.execute(t);
+    EXPECT_EQ(seen, 200u);
+}
+
+// Run stages on separate threads and make sure that points arrive at the
+// end of the pipeline in order.
+TEST(Streaming, pipelined)
+{
+    auto run = [](std::size_t threads)
+    {
+        Options ro;
+        ro.add("bounds", BOX3D(0, 0, 0, 999, 999, 999));
+        ro.add("mode", "ramp");
+        ro.add("count", 1000);
+        FauxReader r;
+        r.setOptions(ro);
+
+        Options fo;
+        fo.add("limits", "X[100:799]");
+        RangeFilter f;
+        f.setOptions(fo);
+        f.setInput(r);
+
+        StreamCallbackFilter c;
+        int cnt = 0;
+        int x = 100;
+        auto cb = [&cnt, &x](PointRef& point)
+        {
+            EXPECT_EQ(point.getFieldAs<int>(Dimension::Id::X), x++);
+            cnt++;
+            return true;
+        };
+        c.setCallback(cb);
+        c.setInput(f);
+
+        FixedPointTable t(17);
+        c.prepare(t);
+        c.execute(t, threads);
+        EXPECT_EQ(cnt, 700);
+    };
+
+    run(1);
+    run(2);
+    run(3);
+    run(10);
+}
+
+// Run independent reader branches in parallel and make sure that all points
+// reach the shared stage and that the points of each branch are in order.
+TEST(Streaming, branches)
+{
+    auto run = [](std::size_t threads)
+    {
+        const int numBranches = 5;
+        std::vector<std::unique_ptr<FauxReader>> readers;
+        std::vector<std::unique_ptr<RangeFilter>> filters;
+
+        StreamCallbackFilter c;
+        for (int i = 0; i < numBranches; ++i)
+        {
+            double start = i * 1000;
+            Options ro;
+            ro.add("bounds", BOX3D(start, 0, 0, start + 999, 999, 999));
+            ro.add("mode", "ramp");
+            ro.add("count", 1000);
+            readers.emplace_back(new FauxReader);
+            readers.back()->setOptions(ro);
+
+            Options fo;
+            fo.add("limits", "Y[100:799]");
+            filters.emplace_back(new RangeFilter);
+            filters.back()->setOptions(fo);
+            filters.back()->setInput(*readers.back());
+            c.setInput(*filters.back());
+        }
+
+        int cnt = 0;
+        std::vector<int> next(numBranches, -1);
+        auto cb = [&cnt, &next](PointRef& point)
+        {
+            int x = point.getFieldAs<int>(Dimension::Id::X);
+            int branch = x / 1000;
+            EXPECT_GT(x, next[branch]);
+            next[branch] = x;
+            cnt++;
+            return true;
+        };
+        c.setCallback(cb);
+
+        FixedPointTable t(17);
+        c.prepare(t);
+        c.execute(t, threads);
+        EXPECT_EQ(cnt, 700 * numBranches);
+    };
+
+    run(1);
+    run(2);
+    run(5);
+    run(10);
+}
+
+namespace
+{
+
+class SrsCountFilter : public StreamCallbackFilter
+{
+public:
+    int m_changes = 0;
+
+private:
+    virtual void spatialReferenceChanged(const SpatialReference&)
+        { m_changes++; }
+};
+
+} // unnamed namespace
+
+// Branches whose readers have different spatial references must not have
+// their points interleaved at the shared stage.
+TEST(Streaming, branchesSrs)
+{
+    auto run = [](std::size_t threads)
+    {
+        const int numBranches = 6;
+        std::vector<std::unique_ptr<FauxReader>> readers;
+
+        SrsCountFilter c;
+        for (int i = 0; i < numBranches; ++i)
+        {
+            Options ro;
+            ro.add("bounds", BOX3D(0, 0, 0, 999, 999, 999));
+            ro.add("mode", "ramp");
+            ro.add("count", 1000);
+            ro.add("override_srs",
+                i < numBranches / 2 ? "EPSG:4326" : "EPSG:3857");
+            readers.emplace_back(new FauxReader);
+            readers.back()->setOptions(ro);
+            c.setInput(*readers.back());
+        }
+
+        int cnt = 0;
+        c.setCallback([&cnt](PointRef&){ cnt++; return true; });
+
+        FixedPointTable t(17);
+        c.prepare(t);
+        c.execute(t, threads);
+        EXPECT_EQ(cnt, 1000 * numBranches);
+        EXPECT_EQ(c.m_changes, 2);
+    };
+
+    run(1);
+    run(2);
+    run(6);
+}
+
+// Consecutive fusable filters process the points a tile at a time.  Each
+// filter must see the changes made by the filters before it and skip
+// the points that they filtered out, whatever the mode of execution.
+TEST(Streaming, fused)
+{
+    auto run = [](int threads)
+    {
+        Options ro;
+        ro.add("bounds", BOX3D(0, 0, 0, 4999, 4999, 4999));
+        ro.add("mode", "ramp");
+        ro.add("count", 5000);
+        FauxReader r;
+        r.setOptions(ro);
+
+        Options fo1;
+        fo1.add("limits", "X[100:3999]");
+        RangeFilter f1;
+        f1.setOptions(fo1);
+        f1.setInput(r);
+
+        Options fo2;
+        fo2.add("assignment", "Z[:]=0");
+        AssignFilter f2;
+        f2.setOptions(fo2);
+        f2.setInput(f1);
+
+        Options fo3;
+        fo3.add("limits", "Y[:1999],Y[3000:]");
+        fo3.add("limits", "Z[0:0]");
+        RangeFilter f3;
+        f3.setOptions(fo3);
+        f3.setInput(f2);
+
+        Options fo4;
+        fo4.add("dimensions", "X=>Original");
+        FerryFilter f4;
+        f4.setOptions(fo4);
+        f4.setInput(f3);
+
+        int cnt = 0;
+        Dimension::Id original = Dimension::Id::Unknown;
+        auto check = [&cnt, &original](PointRef& point)
+        {
+            double x = point.getFieldAs<double>(Dimension::Id::X);
+            EXPECT_TRUE((x >= 100 && x <= 1999) || (x >= 3000 && x <= 3999));
+            EXPECT_EQ(point.getFieldAs<double>(Dimension::Id::Z), 0);
+            EXPECT_EQ(point.getFieldAs<double>(original), x);
+            cnt++;
+            return true;
+        };
+
+        if (threads)
+        {
+            StreamCallbackFilter c;
+            c.setCallback(check);
+            c.setInput(f4);
+
+            FixedPointTable t(3000);
+            c.prepare(t);
+            original = t.layout()->findDim("Original");
+            c.execute(t, threads);
+        }
+        else
+        {
+            PointTable t;
+            f4.prepare(t);
+            original = t.layout()->findDim("Original");
+            PointViewSet s = f4.execute(t);
+            ASSERT_EQ(s.size(), 1u);
+            PointViewPtr v = *s.begin();
+            PointRef point(*v, 0);
+            for (PointId idx = 0; idx < v->size(); ++idx)
+            {
+                point.setPointId(idx);
+                check(point);
+            }
+        }
+        EXPECT_EQ(cnt, 2900);
+    };
+
+    run(0);
+    run(1);
+    run(3);
+}
+
+TEST(Streaming, batchCallback)
+{
+    Options ro;
+    ro.add("bounds", BOX3D(0, 0, 0, 999, 999, 999));
+    ro.add("mode", "ramp");
+    ro.add("count", 1000);
+    FauxReader r;
+    r.setOptions(ro);
+
+    // Drop the points with odd X in batches.
+    StreamCallbackFilter batch;
+    point_count_t batchPoints = 0;
+    batch.setBatchCallback([&batchPoints](PointContainer& c,
+        const PointIdList& ids, std::vector<char>& keep)
+    {
+        PointRef point(c);
+        for (size_t i = 0; i < ids.size(); ++i)
+        {
+            point.setPointId(ids[i]);
+            keep[i] = point.getFieldAs<int>(Dimension::Id::X) % 2 == 0;
+        }
+        batchPoints += ids.size();
+    });
+    batch.setInput(r);
+
+    StreamCallbackFilter f;
+    point_count_t cnt = 0;
+    f.setCallback([&cnt](PointRef& point)
+    {
+        EXPECT_EQ(point.getFieldAs<int>(Dimension::Id::X) % 2, 0);
+        cnt++;
+        return true;
+    });
+    f.setInput(batch);
+
+    FixedPointTable t(64);
+    f.prepare(t);
+    f.execute(t);
+    EXPECT_EQ(batchPoints, 1000u);
+    EXPECT_EQ(cnt, 500u);
+
+    // In standard mode, every point is seen and none are dropped.
+    batchPoints = 0;
+    PointTable table;
+    batch.prepare(table);
+    PointViewSet s = batch.execute(table);
+    EXPECT_EQ(batchPoints, 1000u);
+    EXPECT_EQ((*s.begin())->size(), 1000u);
+}
@@ -0,0 +1,132 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+#include <pdal/util/TaskScheduler.hpp>
+
+using namespace pdal;
+
+namespace
+{
+
+// Restore the default concurrency when a test is done.
+class ConcurrencyGuard
+{
+public:
+    ConcurrencyGuard(std::size_t concurrency)
+        { TaskScheduler::instance().setConcurrency(concurrency); }
+    ~ConcurrencyGuard()
+        { TaskScheduler::instance().setConcurrency(0); }
+};
+
+} // unnamed namespace
+
+TEST(TaskSchedulerTest, parallelFor)
+{
+    for (std::size_t concurrency : { 1, 2, 8 })
+    {
+        ConcurrencyGuard guard(concurrency);
+        EXPECT_EQ(TaskScheduler::instance().concurrency(), concurrency);
+
+        std::vector<int> hits(1000, 0);
+        parallelFor(hits.size(), 0, [&hits](std::size_t i){ hits[i]++; });
+        for (int h : hits)
+            EXPECT_EQ(h, 1);
+    }
+}
+
+TEST(TaskSchedulerTest, nested)
+{
+    ConcurrencyGuard guard(4);
+
+    // Nested loops share the workers rather than each starting threads,
+    // and waiting loops help run the inner tasks so that nothing stalls.
+    std::atomic<uint64_t> sum(0);
+    parallelFor(100, 0, [&sum](std::size_t i)
+    {
+        parallelFor(100, 0, [&sum, i](std::size_t j)
+            { sum += i * j; });
+    });
+    EXPECT_EQ(sum, 4950u * 4950u);
+}
+
+TEST(TaskSchedulerTest, maxThreads)
+{
+    ConcurrencyGuard guard(8);
+
+    std::atomic<int> running(0);
+    std::atomic<int> maxRunning(0);
+    parallelFor(200, 2, [&running, &maxRunning](std::size_t)
+    {
+        int cur = ++running;
+        int prev = maxRunning;
+        while (cur > prev && !maxRunning.compare_exchange_weak(prev, cur))
+        {}
+        --running;
+    });
+    EXPECT_LE(maxRunning, 2);
+}
+
+TEST(TaskSchedulerTest, errors)
+{
+    for (std::size_t concurrency : { 1, 4 })
+    {
+        ConcurrencyGuard guard(concurrency);
+
+        EXPECT_THROW(parallelFor(100, 0, [](std::size_t i)
+            {
+                if (i == 17)
+                    throw std::runtime_error("Task failed");
+            }), std::runtime_error);
+
+        TaskGroup group;
+        std::atomic<int> count(0);
+        for (int i = 0; i < 10; ++i)
+            group.run([&count, i]()
+            {
+                ++count;
+                if (i == 3)
+                    throw std::runtime_error("Task failed");
+            });
+        EXPECT_THROW(group.wait(), std::runtime_error);
+        EXPECT_EQ(count, 10);
+
+        // The error is reported once.
+        group.wait();
+    }
+}
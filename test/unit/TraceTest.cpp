@@ -0,0 +1,144 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <set>
+#include <sstream>
+#include <thread>
+
+#include <nlohmann/json.hpp>
+
+#include <pdal/PipelineManager.hpp>
+#include <pdal/Trace.hpp>
+
+using namespace pdal;
+
+namespace
+{
+
+NL::json traceEvents()
+{
+    std::stringstream ss;
+    Trace::write(ss);
+    return NL::json::parse(ss.str())["traceEvents"];
+}
+
+std::set<std::string> names(const NL::json& events, const std::string& cat)
+{
+    std::set<std::string> out;
+    for (auto& e : events)
+        if (e["ph"] == "X" && e["cat"] == cat)
+            out.insert(e["name"].get<std::string>());
+    return out;
+}
+
+} // unnamed namespace
+
+TEST(TraceTest, disabled)
+{
+    Trace::start();
+    Trace::stop();
+    {
+        PDAL_TRACE_SCOPE("test", "ignored");
+    }
+    EXPECT_EQ(traceEvents().size(), 0u);
+}
+
+TEST(TraceTest, threads)
+{
+    Trace::start();
+    {
+        PDAL_TRACE_SCOPE("test", "main");
+        std::thread t1([](){ PDAL_TRACE_SCOPE("test", "t1"); });
+        std::thread t2([](){ PDAL_TRACE_SCOPE("test", "t2"); });
+        t1.join();
+        t2.join();
+    }
+    Trace::stop();
+
+    NL::json events = traceEvents();
+    std::set<int> tids;
+    for (auto& e : events)
+        if (e["ph"] == "X")
+        {
+            EXPECT_GE(e["dur"].get<long long>(), 0);
+            tids.insert(e["tid"].get<int>());
+        }
+    EXPECT_EQ(tids.size(), 3u);
+    EXPECT_EQ(names(events, "test"),
+        std::set<std::string>({ "main", "t1", "t2" }));
+
+    // Restarting discards earlier events.
+    Trace::start();
+    Trace::stop();
+    EXPECT_EQ(traceEvents().size(), 0u);
+}
+
+TEST(TraceTest, pipeline)
+{
+    std::string pipeline(R"([
+        { "type": "readers.faux", "count": 2500, "mode": "ramp",
+          "tag": "faux" },
+        { "type": "writers.null", "tag": "null" }
+    ])");
+
+    for (ExecMode mode : { ExecMode::Standard, ExecMode::Stream })
+    {
+        PipelineManager mgr(1000);
+        std::istringstream in(pipeline);
+        mgr.readPipeline(in);
+
+        Trace::start();
+        mgr.execute(mode);
+        Trace::stop();
+
+        NL::json events = traceEvents();
+        std::set<std::string> stages = names(events, "stage");
+        EXPECT_TRUE(stages.count("faux ready"));
+        EXPECT_TRUE(stages.count("null done"));
+        if (mode == ExecMode::Standard)
+            EXPECT_TRUE(stages.count("faux run"));
+        else
+        {
+            // At least three batches of up to 1000 points.
+            size_t batches = 0;
+            for (auto& e : events)
+                if (e["ph"] == "X" && e["cat"] == "batch" &&
+                        e["name"] == "faux")
+                    batches++;
+            EXPECT_GE(batches, 3u);
+        }
+    }
+}
@@ -81,3 +81,60 @@ TEST(Compression, zstd)
     decompressor.done();
 }
 
+
+// Input spanning several CHUNKSIZE blocks is compressed as independent
+// frames, which may be fed to the decompressor whole or in pieces.
+TEST(Compression, zstdFrames)
+{
+    std::default_random_engine generator;
+    std::uniform_int_distribution<int> dist((std::numeric_limits<int>::min)());
+
+    std::vector<int> orig(2500123);
+    int val = dist(generator);
+    for (size_t i = 0; i < orig.size(); ++i)
+    {
+        orig[i] = val++;
+        if (i % 100 == 0)
+            val = dist(generator);
+    }
+
+    std::vector<char> compressed;
+    auto cb = [&compressed](char *buf, size_t bufsize)
+    {
+        compressed.insert(compressed.end(), buf, buf + bufsize);
+    };
+
+    size_t s = orig.size() * sizeof(int);
+    const char *sp = reinterpret_cast<const char *>(orig.data());
+    ZstdCompressor compressor(cb);
+    // Feed the compressor in uneven pieces.
+    for (size_t pos = 0; pos < s; pos += 777777)
+        compressor.compress(sp + pos, (std::min)(s - pos, (size_t)777777));
+    compressor.done();
+
+    std::vector<char> out;
+    auto verifier = [&out](char *buf, size_t bufsize)
+    {
+        out.insert(out.end(), buf, buf + bufsize);
+    };
+
+    {
+        ZstdDecompressor decompressor(verifier);
+        decompressor.decompress(compressed.data(), compressed.size());
+        decompressor.done();
+        ASSERT_EQ(out.size(), s);
+        EXPECT_EQ(memcmp(out.data(), sp, s), 0);
+    }
+
+    out.clear();
+    {
+        ZstdDecompressor decompressor(verifier);
+        size_t half = compressed.size() / 2;
+        decompressor.decompress(compressed.data(), half);
+        decompressor.decompress(compressed.data() + half,
+            compressed.size() - half);
+        decompressor.done();
+        ASSERT_EQ(out.size(), s);
+        EXPECT_EQ(memcmp(out.data(), sp, s), 0);
+    }
+}
@@ -0,0 +1,113 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <nlohmann/json.hpp>
+
+#include <pdal/util/FileUtils.hpp>
+#include <pdal/util/Utils.hpp>
+
+#include "Support.hpp"
+
+using namespace pdal;
+
+namespace
+{
+
+NL::json runBenchmark(const std::string& args)
+{
+    std::string outfile(Support::temppath("benchmark.json"));
+    FileUtils::deleteFile(outfile);
+
+    const std::string cmd = Support::binpath("pdal") + " benchmark " +
+        args + " --output=" + outfile;
+
+    std::string output;
+    EXPECT_EQ(Utils::run_shell_command(cmd, output), 0);
+    NL::json j = NL::json::parse(FileUtils::readFileIntoString(outfile));
+    FileUtils::deleteFile(outfile);
+    return j;
+}
+
+} // unnamed namespace
+
+TEST(Benchmark, canned)
+{
+    NL::json j = runBenchmark("--count=1000 --runs=3 --warmup=0");
+
+    EXPECT_EQ(j["pipeline"].get<std::string>(), "filter");
+    EXPECT_EQ(j["runs"].get<int>(), 3);
+    ASSERT_EQ(j["modes"].size(), 2u);
+    EXPECT_EQ(j["modes"][0]["mode"].get<std::string>(), "stream");
+    EXPECT_EQ(j["modes"][1]["mode"].get<std::string>(), "standard");
+
+    for (auto& mode : j["modes"])
+    {
+        EXPECT_TRUE(mode["executed"].get<bool>());
+        // Half of the points are removed by the range filter.
+        EXPECT_GT(mode["points"].get<int>(), 0);
+        EXPECT_LT(mode["points"].get<int>(), 1000);
+        EXPECT_EQ(mode["run_wall_times"].size(), 3u);
+
+        NL::json& wall = mode["wall_time"];
+        EXPECT_LE(wall["min"].get<double>(), wall["p50"].get<double>());
+        EXPECT_LE(wall["p50"].get<double>(), wall["p90"].get<double>());
+        EXPECT_LE(wall["p90"].get<double>(), wall["max"].get<double>());
+
+        ASSERT_EQ(mode["stages"].size(), 4u);
+        EXPECT_EQ(mode["stages"][0]["name"].get<std::string>(),
+            "readers.faux");
+        EXPECT_EQ(mode["stages"][0]["points_out"].get<int>(), 1000);
+    }
+}
+
+// A pipeline that can't stream is reported as not executed in stream mode.
+TEST(Benchmark, pipeline)
+{
+    std::string pipeline(Support::temppath("benchmark_pipeline.json"));
+    std::ostream *out = FileUtils::createFile(pipeline);
+    *out << R"([
+        { "type": "readers.faux", "count": 100, "mode": "ramp" },
+        { "type": "filters.sort", "dimension": "X" }
+    ])";
+    FileUtils::closeFile(out);
+
+    NL::json j = runBenchmark(pipeline + " --runs=2");
+    ASSERT_EQ(j["modes"].size(), 2u);
+    EXPECT_FALSE(j["modes"][0]["executed"].get<bool>());
+    EXPECT_TRUE(j["modes"][1]["executed"].get<bool>());
+    EXPECT_EQ(j["modes"][1]["points"].get<int>(), 100);
+    FileUtils::deleteFile(pipeline);
+}
@@ -0,0 +1,133 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <io/LasReader.hpp>
+#include <pdal/util/FileUtils.hpp>
+
+#include "Support.hpp"
+
+using namespace pdal;
+
+// Split an EPT dataset into cells run by two local workers and check that
+// every point is written to exactly one cell.  Workers are processes
+// started through the shell, which isn't supported on Windows.
+#ifndef _WIN32
+TEST(Dispatch, cells)
+{
+    std::string pipeline(Support::temppath("dispatch.json"));
+    std::string outTemplate(Support::temppath("dispatch_#.las"));
+
+    std::ostream *out = FileUtils::createFile(pipeline);
+    *out << "[ { \"type\": \"readers.ept\", \"filename\": \"" <<
+        Support::datapath("ept/1.2-with-color/ept.json") << "\" }, "
+        "{ \"type\": \"writers.las\", \"filename\": \"unused.las\" } ]";
+    FileUtils::closeFile(out);
+
+    std::string worker = Support::binpath("pdal") + " serve";
+    std::string cmd = Support::binpath("pdal") + " dispatch " + pipeline +
+        " " + outTemplate + " --length=2000 --buffer=50 " +
+        "--worker=\"" + worker + "\" --worker=\"" + worker + "\"";
+    std::string output;
+    EXPECT_EQ(Utils::run_shell_command(cmd, output), 0);
+    EXPECT_EQ(output.find("\"status\":\"error\""), std::string::npos);
+
+    StringList files = FileUtils::glob(Support::temppath("dispatch_*.las"));
+    EXPECT_GT(files.size(), 1u);
+    point_count_t total = 0;
+    for (const std::string& filename : files)
+    {
+        Options opts;
+        opts.add("filename", filename);
+        LasReader r;
+        r.setOptions(opts);
+        total += r.preview().m_pointCount;
+        FileUtils::deleteFile(filename);
+    }
+    EXPECT_EQ(total, 1065u);
+    FileUtils::deleteFile(pipeline);
+    FileUtils::deleteFile(pipeline + ".dispatch.json");
+    FileUtils::deleteFile(pipeline + ".dispatch.state");
+}
+
+// Only the cells whose inputs or outputs changed are run again.
+TEST(Dispatch, incremental)
+{
+    std::string pipeline(Support::temppath("dispatch_inc.json"));
+    std::string outTemplate(Support::temppath("dispatch_inc_#.las"));
+
+    std::ostream *out = FileUtils::createFile(pipeline);
+    *out << "[ { \"type\": \"readers.ept\", \"filename\": \"" <<
+        Support::datapath("ept/1.2-with-color/ept.json") << "\" }, "
+        "{ \"type\": \"writers.las\", \"filename\": \"unused.las\" } ]";
+    FileUtils::closeFile(out);
+
+    auto count = [](const std::string& output, const std::string& status)
+    {
+        size_t count = 0;
+        const std::string s = "\"status\":\"" + status + "\"";
+        for (size_t pos = output.find(s); pos != std::string::npos;
+                pos = output.find(s, pos + 1))
+            count++;
+        return count;
+    };
+
+    std::string cmd = Support::binpath("pdal") + " dispatch " + pipeline +
+        " " + outTemplate + " --length=2000 --buffer=50 --incremental " +
+        "--worker=\"" + Support::binpath("pdal") + " serve\"";
+    std::string output;
+    EXPECT_EQ(Utils::run_shell_command(cmd, output), 0);
+    size_t cells = count(output, "ok");
+    EXPECT_GT(cells, 1u);
+    EXPECT_EQ(count(output, "unchanged"), 0u);
+
+    // A cell with no points may not write a file, so it's run again.
+    StringList files = FileUtils::glob(Support::temppath("dispatch_inc_*.las"));
+    ASSERT_GT(files.size(), 1u);
+    EXPECT_EQ(Utils::run_shell_command(cmd, output), 0);
+    EXPECT_EQ(count(output, "ok"), cells - files.size());
+    EXPECT_EQ(count(output, "unchanged"), files.size());
+
+    FileUtils::deleteFile(files.front());
+    EXPECT_EQ(Utils::run_shell_command(cmd, output), 0);
+    EXPECT_EQ(count(output, "ok"), cells - files.size() + 1);
+    EXPECT_EQ(count(output, "unchanged"), files.size() - 1);
+
+    for (const std::string& filename : files)
+        FileUtils::deleteFile(filename);
+    FileUtils::deleteFile(pipeline);
+    FileUtils::deleteFile(pipeline + ".dispatch.json");
+    FileUtils::deleteFile(pipeline + ".dispatch.state");
+}
+#endif
@@ -32,6 +32,7 @@
 * OF SUCH DAMAGE.
 ****************************************************************************/
 
+#include <random>
 #include <string>
 
 #include <pdal/pdal_test_main.hpp>
@@ -92,3 +93,59 @@ TEST(Hausdorff, distance)
 
     EXPECT_EQ(std::sqrt(6.0), Utils::computeHausdorff(src, cand));
 }
+
+TEST(Hausdorff, threads)
+{
+    PointTable table;
+    PointLayoutPtr layout(table.layout());
+
+    layout->registerDim(Dimension::Id::X);
+    layout->registerDim(Dimension::Id::Y);
+    layout->registerDim(Dimension::Id::Z);
+
+    std::default_random_engine generator;
+    std::uniform_real_distribution<double> coord(0, 100);
+
+    PointViewPtr src(new PointView(table));
+    PointViewPtr cand(new PointView(table));
+    for (PointId i = 0; i < 2000; ++i)
+    {
+        src->setField(Dimension::Id::X, i, coord(generator));
+        src->setField(Dimension::Id::Y, i, coord(generator));
+        src->setField(Dimension::Id::Z, i, coord(generator));
+    }
+    for (PointId i = 0; i < 1500; ++i)
+    {
+        cand->setField(Dimension::Id::X, i, coord(generator));
+        cand->setField(Dimension::Id::Y, i, coord(generator));
+        cand->setField(Dimension::Id::Z, i, coord(generator) / 2);
+    }
+
+    // Brute force.
+    auto directed = [](PointViewPtr a, PointViewPtr b)
+    {
+        double maxDist = 0;
+        for (PointId i = 0; i < a->size(); ++i)
+        {
+            double minDist = (std::numeric_limits<double>::max)();
+            for (PointId j = 0; j < b->size(); ++j)
+            {
+                double dx = a->getFieldAs<double>(Dimension::Id::X, i) -
+                    b->getFieldAs<double>(Dimension::Id::X, j);
+                double dy = a->getFieldAs<double>(Dimension::Id::Y, i) -
+                    b->getFieldAs<double>(Dimension::Id::Y, j);
+                double dz = a->getFieldAs<double>(Dimension::Id::Z, i) -
+                    b->getFieldAs<double>(Dimension::Id::Z, j);
+                minDist = (std::min)(minDist, dx * dx + dy * dy + dz * dz);
+            }
+            maxDist = (std::max)(maxDist, minDist);
+        }
+        return maxDist;
+    };
+    double expected = std::sqrt((std::max)(directed(src, cand),
+        directed(cand, src)));
+
+    EXPECT_DOUBLE_EQ(expected, Utils::computeHausdorff(src, cand));
+    EXPECT_DOUBLE_EQ(expected, Utils::computeHausdorff(src, cand, 4));
+    EXPECT_DOUBLE_EQ(expected, Utils::computeHausdorff(cand, src, 3));
+}
@@ -203,3 +203,21 @@ std::string r = R"foo(
 )foo";
     test("--all", r);
 }
+
+TEST(Info, glob)
+{
+    std::string cmd = appName() + " --stats --threads 2 \"" +
+        Support::datapath("las/1.2-with-color*.las") + "\" 2>&1";
+
+    std::string output;
+    EXPECT_EQ(Utils::run_shell_command(cmd, output), 0);
+
+    // Both files are reported, in glob order, each with its statistics.
+    size_t clipped = output.find("1.2-with-color-clipped.las");
+    size_t full = output.find("1.2-with-color.las\"");
+    EXPECT_NE(clipped, std::string::npos);
+    EXPECT_NE(full, std::string::npos);
+    EXPECT_LT(clipped, full);
+    EXPECT_NE(output.find("\"files\""), std::string::npos);
+    EXPECT_NE(output.find("\"count\": 1065"), std::string::npos);
+}
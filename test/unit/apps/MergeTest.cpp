@@ -35,6 +35,8 @@
 #include <string>
 
 #include <pdal/pdal_test_main.hpp>
+
+#include <io/LasReader.hpp>
 #include <pdal/util/FileUtils.hpp>
 #include <pdal/util/Utils.hpp>
 
@@ -108,3 +110,40 @@ TEST(Merge, Args)
     FileUtils::deleteFile(outfile);
 }
 
+
+TEST(Merge, sorted)
+{
+    std::string infile(Support::datapath("las/1.2-with-color.las"));
+    std::string sortfile(Support::temppath("merge_sorted_in.las"));
+    std::string outfile(Support::temppath("merge_sorted_out.las"));
+
+    std::string output;
+    std::string cmd = Support::binpath("pdal sort") + " --dimension=GpsTime " +
+        infile + " " + sortfile;
+    EXPECT_EQ(Utils::run_shell_command(cmd, output), 0);
+
+    cmd = appName() + " --sorted --dimension=GpsTime " + sortfile + " " +
+        sortfile + " " + outfile;
+    EXPECT_EQ(Utils::run_shell_command(cmd, output), 0);
+
+    Options opts;
+    opts.add("filename", outfile);
+    LasReader r;
+    r.setOptions(opts);
+    PointTable table;
+    r.prepare(table);
+    PointViewSet s = r.execute(table);
+    PointViewPtr v = *s.begin();
+    EXPECT_EQ(v->size(), 2130u);
+    for (PointId i = 1; i < v->size(); ++i)
+        EXPECT_LE(v->getFieldAs<double>(Dimension::Id::GpsTime, i - 1),
+            v->getFieldAs<double>(Dimension::Id::GpsTime, i));
+
+    // Inputs that aren't in the requested order are an error.
+    cmd = appName() + " --sorted --dimension=GpsTime --order=DESC " +
+        sortfile + " " + sortfile + " " + outfile + " 2>&1";
+    EXPECT_NE(Utils::run_shell_command(cmd, output), 0);
+
+    FileUtils::deleteFile(sortfile);
+    FileUtils::deleteFile(outfile);
+}
@@ -0,0 +1,89 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <io/LasReader.hpp>
+#include <pdal/util/FileUtils.hpp>
+
+#include "Support.hpp"
+
+using namespace pdal;
+
+// Run two jobs through one pipeline with different output files, plus a
+// job that isn't valid JSON, and check that each is reported.
+TEST(Serve, jobs)
+{
+    std::string pipeline(Support::temppath("serve.json"));
+    std::string jobs(Support::temppath("serve_jobs.txt"));
+    std::string out1(Support::temppath("serve_1.las"));
+    std::string out2(Support::temppath("serve_2.las"));
+
+    std::ostream *out = FileUtils::createFile(pipeline);
+    *out << "[ \"" << Support::datapath("las/1.2-with-color.las") << "\", "
+        "{ \"type\": \"writers.las\", \"tag\": \"out\", "
+        "\"filename\": \"unused.las\" } ]";
+    FileUtils::closeFile(out);
+
+    out = FileUtils::createFile(jobs);
+    *out << "{ \"id\": \"one\", \"options\": "
+        "{ \"stage.out\": { \"filename\": \"" << out1 << "\" } } }\n";
+    *out << "{ \"id\": \"two\", \"options\": "
+        "{ \"writers.las\": { \"filename\": \"" << out2 << "\" } } }\n";
+    *out << "not json\n";
+    FileUtils::closeFile(out);
+
+    std::string cmd = Support::binpath("pdal") + " serve " + pipeline +
+        " --jobs=" + jobs + " --threads=2 --nostream";
+    std::string output;
+    EXPECT_EQ(Utils::run_shell_command(cmd, output), 0);
+    EXPECT_NE(output.find("\"id\":\"one\""), std::string::npos);
+    EXPECT_NE(output.find("\"id\":\"two\""), std::string::npos);
+    EXPECT_NE(output.find("\"id\":3"), std::string::npos);
+    EXPECT_NE(output.find("\"points\":1065"), std::string::npos);
+    EXPECT_NE(output.find("\"status\":\"error\""), std::string::npos);
+
+    for (const std::string& filename : { out1, out2 })
+    {
+        Options opts;
+        opts.add("filename", filename);
+        LasReader r;
+        r.setOptions(opts);
+        EXPECT_EQ(r.preview().m_pointCount, 1065u);
+        FileUtils::deleteFile(filename);
+    }
+    FileUtils::deleteFile(pipeline);
+    FileUtils::deleteFile(jobs);
+}
@@ -0,0 +1,97 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <string>
+
+#include <pdal/pdal_test_main.hpp>
+#include <pdal/PointView.hpp>
+#include <pdal/util/Utils.hpp>
+#include <io/LasReader.hpp>
+
+#include "Support.hpp"
+
+using namespace pdal;
+
+namespace
+{
+
+PointViewPtr readLas(const std::string& filename, PointTable& table)
+{
+    LasReader r;
+    Options o;
+    o.add("filename", filename);
+    r.setOptions(o);
+    r.prepare(table);
+    return *r.execute(table).begin();
+}
+
+// Sort in memory and with a memory limit that forces temporary runs and
+// check that the results are the same.
+void compareSorts(const std::string& args)
+{
+    const std::string in(Support::datapath("las/autzen_trim.las"));
+    const std::string memFile(Support::temppath("sort_mem.las"));
+    const std::string extFile(Support::temppath("sort_ext.las"));
+    const std::string baseCmd(Support::binpath("pdal") + " sort " + in +
+        " " + args + " ");
+
+    std::string output;
+    EXPECT_EQ(Utils::run_shell_command(baseCmd + memFile, output), 0);
+    EXPECT_EQ(Utils::run_shell_command(baseCmd + extFile +
+        " --memory_limit=1 --tmp_dir=" + Support::temppath(), output), 0);
+
+    PointTable memTable;
+    PointTable extTable;
+    PointViewPtr memView = readLas(memFile, memTable);
+    PointViewPtr extView = readLas(extFile, extTable);
+    ASSERT_EQ(memView->size(), 110000u);
+    ASSERT_EQ(memView->size(), extView->size());
+    for (PointId i = 0; i < memView->size(); ++i)
+        for (Dimension::Id dim : { Dimension::Id::X, Dimension::Id::Y,
+                Dimension::Id::GpsTime, Dimension::Id::Intensity })
+            ASSERT_EQ(memView->getFieldAs<double>(dim, i),
+                extView->getFieldAs<double>(dim, i));
+}
+
+} // unnamed namespace
+
+TEST(Sort, morton)
+{
+    compareSorts("");
+}
+
+TEST(Sort, dimension)
+{
+    compareSorts("--dimension=GpsTime");
+    compareSorts("--dimension=Intensity --order=DESC");
+}
@@ -0,0 +1,85 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <io/LasReader.hpp>
+#include <pdal/util/FileUtils.hpp>
+
+#include "Support.hpp"
+
+using namespace pdal;
+
+// Split by length streams points through temporary files.  Check that
+// every point lands in one output file and that each file holds only the
+// points of one cell.
+TEST(Split, streamLength)
+{
+    std::string outDir(Support::temppath("split"));
+    FileUtils::deleteDirectory(outDir);
+    FileUtils::createDirectory(outDir);
+
+    std::string cmd = Support::binpath("pdal") + " split " +
+        Support::datapath("las/1.2-with-color.las") + " " +
+        outDir + "/out.las --length=300 --threads=2 --max_open_files=1";
+    std::string output;
+    EXPECT_EQ(Utils::run_shell_command(cmd, output), 0);
+
+    StringList files = FileUtils::directoryList(outDir);
+    EXPECT_GT(files.size(), 1U);
+
+    point_count_t total(0);
+    for (size_t i = 1; i <= files.size(); ++i)
+    {
+        std::string filename(outDir + "/out_" + std::to_string(i) + ".las");
+        EXPECT_TRUE(FileUtils::fileExists(filename)) << filename;
+
+        Options opts;
+        opts.add("filename", filename);
+        LasReader r;
+        r.setOptions(opts);
+        PointTable table;
+        r.prepare(table);
+        PointViewSet s = r.execute(table);
+        ASSERT_EQ(s.size(), 1U);
+        PointViewPtr v = *s.begin();
+        total += v->size();
+
+        BOX2D bounds;
+        v->calculateBounds(bounds);
+        EXPECT_LE(bounds.maxx - bounds.minx, 300);
+        EXPECT_LE(bounds.maxy - bounds.miny, 300);
+    }
+    EXPECT_EQ(total, 1065U);
+}
@@ -37,6 +37,8 @@
 #include <pdal/pdal_test_main.hpp>
 
 #include <pdal/util/FileUtils.hpp>
+#include <io/TextWriter.hpp>
+#include <io/TIndexReader.hpp>
 
 #include "Support.hpp"
 
@@ -147,3 +149,57 @@ TEST(TIndex, test3)
 #endif
 }
 
+
+// Member files read on several threads come out in the same order as
+// when they're read one at a time, in standard and stream mode.
+TEST(TIndex, threads)
+{
+    std::string inSpec(Support::datapath("tindex/*.txt"));
+    std::string outSpec(Support::temppath("tindex.out"));
+    std::string outPoints(Support::temppath("points.txt"));
+
+    std::string cmd = Support::binpath("pdal") + " tindex create " +
+        outSpec + " \"" + inSpec + "\"";
+
+    FileUtils::deleteDirectory(outSpec);
+
+    std::string output;
+    Utils::run_shell_command(cmd, output);
+
+    auto run = [&outSpec, &outPoints](int threads, bool stream)
+    {
+        Options ro;
+        ro.add("filename", outSpec);
+        ro.add("bounds", "([1.25, 3],[1.25, 3])");
+        ro.add("threads", threads);
+        TIndexReader r;
+        r.setOptions(ro);
+
+        Options wo;
+        wo.add("filename", outPoints);
+        TextWriter w;
+        w.setOptions(wo);
+        w.setInput(r);
+
+        FileUtils::deleteFile(outPoints);
+        if (stream)
+        {
+            FixedPointTable t(7);
+            w.prepare(t);
+            w.execute(t);
+        }
+        else
+        {
+            PointTable t;
+            w.prepare(t);
+            w.execute(t);
+        }
+        return FileUtils::readFileIntoString(outPoints);
+    };
+
+    std::string points = run(1, false);
+    EXPECT_GT(std::count(points.begin(), points.end(), '\n'), 1);
+    EXPECT_EQ(points, run(3, false));
+    EXPECT_EQ(points, run(1, true));
+    EXPECT_EQ(points, run(2, true));
+}
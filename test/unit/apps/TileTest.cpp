@@ -118,3 +118,37 @@ TEST(Tile, test2)
     checkFile(2, 1, 3);
     checkFile(2, 2, 2);
 }
+
+
+// Same as test2, but tiled in parallel through spill files, with fewer
+// spill files allowed open than there are tiles.
+TEST(Tile, parallel)
+{
+    std::string inSpec(Support::datapath("las/tile/*"));
+    std::string outSpec(Support::temppath("tile/out#.txt"));
+
+    std::string baseCmd = Support::binpath("pdal") + " tile \"" +
+        inSpec + "\" \"" + outSpec + "\" ";
+
+    FileUtils::deleteDirectory(Support::temppath("tile"));
+    FileUtils::createDirectory(Support::temppath("tile"));
+
+    std::string output;
+    std::string cmd = baseCmd + " --origin_x=0 --origin_y=0 --length=10 "
+        "--out_srs=EPSG:2029 --writers.text.order=X,Y,Z "
+        "--writers.text.keep_unspecified=false --threads=3 "
+        "--max_open_files=2";
+    Utils::run_shell_command(cmd, output);
+
+    EXPECT_EQ(FileUtils::directoryList(Support::temppath("tile")).size(), 10U);
+    checkFile(-1, 0, 1);
+    checkFile(0, 0, 3);
+    checkFile(0, 1, 4);
+    checkFile(0, 2, 4);
+    checkFile(1, 0, 3);
+    checkFile(1, 1, 2);
+    checkFile(1, 2, 3);
+    checkFile(2, 0, 2);
+    checkFile(2, 1, 3);
+    checkFile(2, 2, 2);
+}
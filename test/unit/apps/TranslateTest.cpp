@@ -39,6 +39,7 @@
 #include <pdal/util/Utils.hpp>
 #include "Support.hpp"
 
+#include <fstream>
 #include <iostream>
 #include <sstream>
 #include <string>
@@ -244,3 +245,48 @@ TEST(TranslateTest, issue2835)
     EXPECT_EQ(runTranslate(in + " " + "devnull", output), 0);
     EXPECT_FALSE(FileUtils::fileExists("devnull"));
 }
+
+TEST(TranslateTest, batch)
+{
+    std::string output;
+    std::string in = Support::datapath("las/autzen_trim.las");
+    std::string dir = Support::temppath("batch");
+    std::string outDir = Support::temppath("batch_out");
+    FileUtils::createDirectories(dir);
+    FileUtils::createDirectories(outDir);
+
+    auto copy = [&in](const std::string& filename)
+    {
+        std::ifstream src(in, std::ios::binary);
+        std::ofstream dst(filename, std::ios::binary);
+        dst << src.rdbuf();
+    };
+    copy(dir + "/a.las");
+    copy(dir + "/b.las");
+    FileUtils::deleteFile(outDir + "/a.las");
+    FileUtils::deleteFile(outDir + "/b.las");
+
+    // The output must have a placeholder.
+    EXPECT_NE(runTranslate("\"" + dir + "/*.las\" " + outDir + "/out.las",
+        output), 0);
+
+    EXPECT_EQ(runTranslate("\"" + dir + "/*.las\" " + outDir + "/#.las "
+        "--threads=2", output), 0);
+    EXPECT_TRUE(FileUtils::fileExists(outDir + "/a.las"));
+    EXPECT_TRUE(FileUtils::fileExists(outDir + "/b.las"));
+
+    // A bad file fails the run but doesn't stop the others.
+    FileUtils::deleteFile(outDir + "/a.las");
+    FileUtils::deleteFile(outDir + "/b.las");
+    std::ofstream(dir + "/c.las") << "Not a LAS file.";
+    EXPECT_NE(runTranslate("\"" + dir + "/*.las\" " + outDir + "/#.las "
+        "--threads=2", output), 0);
+    EXPECT_TRUE(FileUtils::fileExists(outDir + "/a.las"));
+    EXPECT_TRUE(FileUtils::fileExists(outDir + "/b.las"));
+
+    for (const std::string& f : { "a", "b", "c" })
+    {
+        FileUtils::deleteFile(dir + "/" + f + ".las");
+        FileUtils::deleteFile(outDir + "/" + f + ".las");
+    }
+}
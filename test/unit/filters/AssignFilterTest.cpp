@@ -36,6 +36,7 @@
 
 #include <pdal/StageFactory.hpp>
 #include <pdal/util/FileUtils.hpp>
+#include <io/BufferReader.hpp>
 
 #include "Support.hpp"
 
@@ -177,3 +178,45 @@ TEST(AssignFilterTest, test_condition)
     EXPECT_EQ(v->size(), 10u);
     EXPECT_EQ(ielse, 7);
 }
+
+// Assignments are applied in order, so later ones see the values set by
+// earlier ones, across many batches of points.
+TEST(AssignFilterTest, chained)
+{
+    using namespace Dimension;
+
+    PointTable table;
+    table.layout()->registerDim(Id::X);
+    table.layout()->registerDim(Id::Classification);
+
+    PointViewPtr view(new PointView(table));
+    for (PointId i = 0; i < 10000; ++i)
+    {
+        view->setField(Id::X, i, i);
+        view->setField(Id::Classification, i, i % 3);
+    }
+
+    BufferReader r;
+    r.addView(view);
+
+    StageFactory factory;
+    Stage& f = *factory.createStage("filters.assign");
+    Options fo;
+    fo.add("assignment", "Classification[0:0]=1");
+    fo.add("assignment", "Classification[1:1]=2");
+    fo.add("condition", "X[1000:8999]");
+    f.setInput(r);
+    f.setOptions(fo);
+
+    f.prepare(table);
+    PointViewSet s = f.execute(table);
+    PointViewPtr v = *s.begin();
+    ASSERT_EQ(v->size(), 10000u);
+    for (PointId i = 0; i < v->size(); ++i)
+    {
+        int expected = i % 3;
+        if (i >= 1000 && i <= 8999)
+            expected = 2;
+        EXPECT_EQ(v->getFieldAs<int>(Id::Classification, i), expected);
+    }
+}
@@ -64,3 +64,56 @@ TEST(CSFilterTest, emptyView)
     PointViewSet s = filter->execute(table);
     EXPECT_EQ(s.size(), 0u);
 }
+
+namespace
+{
+
+std::vector<uint8_t> csfClasses(int threads)
+{
+    StageFactory factory;
+
+    Stage *r = factory.createStage("readers.las");
+    Options rOpts;
+    rOpts.add("filename", Support::datapath("las/1.2-with-color.las"));
+    r->setOptions(rOpts);
+
+    Stage *f = factory.createStage("filters.csf");
+    Options fOpts;
+    fOpts.add("resolution", 10.0);
+    fOpts.add("iterations", 100);
+    fOpts.add("threads", threads);
+    f->setOptions(fOpts);
+    f->setInput(*r);
+
+    PointTable t;
+    f->prepare(t);
+    PointViewSet s = f->execute(t);
+    EXPECT_EQ(s.size(), 1U);
+    PointViewPtr v = *s.begin();
+
+    std::vector<uint8_t> classes;
+    for (PointId idx = 0; idx < v->size(); ++idx)
+        classes.push_back(
+            v->getFieldAs<uint8_t>(Dimension::Id::Classification, idx));
+    return classes;
+}
+
+} // unnamed namespace
+
+TEST(CSFilterTest, threads)
+{
+    std::vector<uint8_t> one = csfClasses(1);
+    std::vector<uint8_t> two = csfClasses(2);
+    std::vector<uint8_t> three = csfClasses(3);
+
+    // The constraint order with several threads doesn't depend on their
+    // number.
+    EXPECT_EQ(two, three);
+
+    ASSERT_EQ(one.size(), three.size());
+    size_t same = 0;
+    for (size_t i = 0; i < one.size(); ++i)
+        if (one[i] == three[i])
+            same++;
+    EXPECT_GT(same, one.size() * 95 / 100);
+}
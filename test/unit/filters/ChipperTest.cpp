@@ -145,3 +145,42 @@ TEST(ChipperTest, empty_buffer)
     EXPECT_EQ(viewSet.size(), 0u);
 }
 
+
+// Chips made with several threads are the same as those made with one.
+TEST(ChipperTest, threads)
+{
+    auto chip = [](PointTableRef table, int threads)
+    {
+        Options rOpts;
+        rOpts.add("filename", Support::datapath("las/autzen_trim.las"));
+        LasReader reader;
+        reader.setOptions(rOpts);
+
+        Options ops;
+        ops.add("capacity", 100);
+        ops.add("threads", threads);
+        ChipperFilter chipper;
+        chipper.setInput(reader);
+        chipper.setOptions(ops);
+        chipper.prepare(table);
+        PointViewSet s = chipper.execute(table);
+        return std::vector<PointViewPtr>(s.begin(), s.end());
+    };
+
+    PointTable t1;
+    std::vector<PointViewPtr> views1 = chip(t1, 1);
+    PointTable t4;
+    std::vector<PointViewPtr> views4 = chip(t4, 4);
+    ASSERT_EQ(views1.size(), views4.size());
+    for (size_t i = 0; i < views1.size(); ++i)
+    {
+        ASSERT_EQ(views1[i]->size(), views4[i]->size());
+        for (PointId idx = 0; idx < views1[i]->size(); ++idx)
+        {
+            EXPECT_EQ(views1[i]->getFieldAs<double>(Dimension::Id::X, idx),
+                views4[i]->getFieldAs<double>(Dimension::Id::X, idx));
+            EXPECT_EQ(views1[i]->getFieldAs<double>(Dimension::Id::Y, idx),
+                views4[i]->getFieldAs<double>(Dimension::Id::Y, idx));
+        }
+    }
+}
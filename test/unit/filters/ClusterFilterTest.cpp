@@ -0,0 +1,148 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <algorithm>
+
+#include <pdal/PointView.hpp>
+#include <filters/ClusterFilter.hpp>
+#include <io/BufferReader.hpp>
+#include <io/LasReader.hpp>
+
+#include "Support.hpp"
+
+using namespace pdal;
+
+namespace
+{
+
+// Run the cluster filter on four clusters whose points are interleaved:
+// A and C have two points, B and D four.  The first points of the clusters
+// are in the order A, B, C, D.
+std::vector<uint64_t> clusterIds(const std::string& order, int threads)
+{
+    using namespace Dimension;
+
+    const std::vector<double> xs { 0, 100, 200, 100.5, 300, 101, 0.5, 300.5,
+        101.5, 200.5, 301, 301.5 };
+
+    PointTable table;
+    table.layout()->registerDims({Id::X, Id::Y, Id::Z});
+
+    BufferReader reader;
+    PointViewPtr view(new PointView(table));
+    for (PointId i = 0; i < xs.size(); ++i)
+    {
+        view->setField(Id::X, i, xs[i]);
+        view->setField(Id::Y, i, 0);
+        view->setField(Id::Z, i, 0);
+    }
+    reader.addView(view);
+
+    Options opts;
+    opts.add("order", order);
+    opts.add("threads", threads);
+    ClusterFilter filter;
+    filter.setOptions(opts);
+    filter.setInput(reader);
+    filter.prepare(table);
+    PointViewSet s = filter.execute(table);
+    PointViewPtr out = *s.begin();
+
+    std::vector<uint64_t> ids;
+    for (PointId i = 0; i < out->size(); ++i)
+        ids.push_back(out->getFieldAs<uint64_t>(Id::ClusterID, i));
+    return ids;
+}
+
+} // unnamed namespace
+
+TEST(ClusterFilterTest, pointOrder)
+{
+    const std::vector<uint64_t> expected { 1, 2, 3, 2, 4, 2, 1, 4, 2, 3, 4, 4 };
+    EXPECT_EQ(clusterIds("point", 1), expected);
+    EXPECT_EQ(clusterIds("point", 3), expected);
+}
+
+// Clusters are numbered largest first.  B and D, and A and C, are the same
+// size, so they keep the order of their first points.
+TEST(ClusterFilterTest, sizeOrder)
+{
+    const std::vector<uint64_t> expected { 3, 1, 4, 1, 2, 1, 3, 2, 1, 4, 2, 2 };
+    EXPECT_EQ(clusterIds("size", 1), expected);
+    EXPECT_EQ(clusterIds("SIZE", 3), expected);
+}
+
+TEST(ClusterFilterTest, badOrder)
+{
+    EXPECT_THROW(clusterIds("largest", 1), pdal_error);
+}
+
+// Running on several threads assigns the same cluster IDs as running on one.
+TEST(ClusterFilterTest, threads)
+{
+    auto cluster = [](const std::string& order, int threads)
+    {
+        Options readerOpts;
+        readerOpts.add("filename", Support::datapath("las/1.2-with-color.las"));
+        LasReader reader;
+        reader.setOptions(readerOpts);
+
+        Options opts;
+        opts.add("tolerance", 5);
+        opts.add("order", order);
+        opts.add("threads", threads);
+        ClusterFilter filter;
+        filter.setOptions(opts);
+        filter.setInput(reader);
+
+        PointTable table;
+        filter.prepare(table);
+        PointViewSet s = filter.execute(table);
+        PointViewPtr v = *s.begin();
+
+        std::vector<uint64_t> ids;
+        for (PointId i = 0; i < v->size(); ++i)
+            ids.push_back(
+                v->getFieldAs<uint64_t>(Dimension::Id::ClusterID, i));
+        return ids;
+    };
+
+    for (const std::string order : { "point", "size" })
+    {
+        std::vector<uint64_t> ids = cluster(order, 1);
+        EXPECT_GT(*std::max_element(ids.begin(), ids.end()), 1u);
+        EXPECT_EQ(cluster(order, 4), ids);
+    }
+}
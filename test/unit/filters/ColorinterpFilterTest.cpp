@@ -242,6 +242,25 @@ TEST(ColorinterpFilterTest, autorange)
     standardTest(coptions, test);
 }
 
+TEST(ColorinterpFilterTest, invert)
+{
+    Options coptions;
+
+    coptions.add("ramp", makeColor());
+    coptions.add("invert", true);
+
+    auto test = [](int z, int r)
+    {
+        if (z < 99)
+            return (4 - (int)(z / 25) == r);
+        else if (z == 99 && r == 0)
+            return true;
+        return false;
+    };
+
+    standardTest(coptions, test);
+}
+
 TEST(ColorinterpFilterTest, k)
 {
     Options coptions;
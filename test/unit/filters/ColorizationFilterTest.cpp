@@ -188,3 +188,19 @@ TEST(ColorizationFilterTest, test4)
 }
 
 
+
+// Check that bands can be assigned in any order.
+TEST(ColorizationFilterTest, bandOrder)
+{
+    Options options;
+
+    options.add("dimensions", "Red:3, Green:2, Blue:1");
+    options.add("raster", Support::datapath("autzen/autzen.jpg"));
+
+    StringList dims;
+    dims.push_back("Red");
+    dims.push_back("Green");
+    dims.push_back("Blue");
+    testFile(options, dims, 185, 205, 210);
+    testFileStreamed(options, dims, 185, 205, 210);
+}
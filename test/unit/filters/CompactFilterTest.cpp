@@ -0,0 +1,136 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <filters/CompactFilter.hpp>
+#include <filters/RangeFilter.hpp>
+#include <io/FauxReader.hpp>
+
+using namespace pdal;
+
+namespace
+{
+
+void setupReader(FauxReader& r, point_count_t count)
+{
+    Options opts;
+    opts.add("bounds", BOX3D(1, 1, 1, (double)count, (double)count,
+        (double)count));
+    opts.add("mode", "ramp");
+    opts.add("count", count);
+    r.setOptions(opts);
+}
+
+} // unnamed namespace
+
+TEST(CompactFilterTest, freesStorage)
+{
+    FauxReader r;
+    setupReader(r, 10000);
+
+    Options rangeOpts;
+    rangeOpts.add("limits", "X[5001:5010]");
+    RangeFilter range;
+    range.setOptions(rangeOpts);
+    range.setInput(r);
+
+    CompactFilter f;
+    f.setInput(range);
+
+    PointTable t(1000, BlockAllocatorPtr());
+    f.prepare(t);
+    const std::size_t pointSize = t.layout()->pointSize();
+    PointViewSet s = f.execute(t);
+
+    EXPECT_EQ(s.size(), 1u);
+    PointViewPtr v = *s.begin();
+    EXPECT_EQ(v->size(), 10u);
+    for (PointId i = 0; i < v->size(); ++i)
+    {
+        EXPECT_DOUBLE_EQ(v->getFieldAs<double>(Dimension::Id::X, i),
+            5001.0 + i);
+        EXPECT_DOUBLE_EQ(v->getFieldAs<double>(Dimension::Id::Y, i),
+            5001.0 + i);
+    }
+
+    // The points were copied into the last block, so the original blocks
+    // were all freed.
+    EXPECT_EQ(t.memoryUsed(), 1000 * pointSize);
+}
+
+TEST(CompactFilterTest, threshold)
+{
+    FauxReader r;
+    setupReader(r, 10000);
+
+    Options rangeOpts;
+    rangeOpts.add("limits", "X[1:6000]");
+    RangeFilter range;
+    range.setOptions(rangeOpts);
+    range.setInput(r);
+
+    Options opts;
+    opts.add("threshold", 0.5);
+    CompactFilter f;
+    f.setOptions(opts);
+    f.setInput(range);
+
+    PointTable t(1000, BlockAllocatorPtr());
+    f.prepare(t);
+    const std::size_t pointSize = t.layout()->pointSize();
+    PointViewSet s = f.execute(t);
+
+    // The blocks of the points dropped by the range filter were released
+    // once the reader's view was freed.  More than half of the remaining
+    // points were kept, so nothing was compacted.
+    PointViewPtr v = *s.begin();
+    EXPECT_EQ(v->size(), 6000u);
+    EXPECT_EQ(t.memoryUsed(), 7000 * pointSize);
+}
+
+TEST(CompactFilterTest, badThreshold)
+{
+    FauxReader r;
+    setupReader(r, 10);
+
+    Options opts;
+    opts.add("threshold", 1.5);
+    CompactFilter f;
+    f.setOptions(opts);
+    f.setInput(r);
+
+    PointTable t;
+    EXPECT_THROW(f.prepare(t), pdal_error);
+}
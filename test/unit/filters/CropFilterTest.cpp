@@ -616,3 +616,77 @@ TEST(CropFilterTest, bounds_inside_outside)
     // Expect 1026 points when cropping to the outside of the bounds.
     EXPECT_EQ(nStreamPoints, 1026U);
 }
+
+TEST(CropFilterTest, manyPolygons)
+{
+    using namespace Dimension;
+
+    auto run = [](bool outside)
+    {
+        PointTable table;
+        table.layout()->registerDim(Id::X);
+        table.layout()->registerDim(Id::Y);
+        table.layout()->registerDim(Id::Z);
+
+        PointViewPtr view(new PointView(table));
+        PointId id = 0;
+        for (int x = 0; x < 100; ++x)
+            for (int y = 0; y < 100; ++y)
+            {
+                view->setField(Id::X, id, x + .5);
+                view->setField(Id::Y, id, y + .5);
+                view->setField(Id::Z, id, 0);
+                id++;
+            }
+
+        BufferReader r;
+        r.addView(view);
+
+        // A 10x10 arrangement of small squares, each containing nine
+        // points, plus one polygon that covers all the points.
+        Options o;
+        for (int i = 0; i < 10; ++i)
+            for (int j = 0; j < 10; ++j)
+            {
+                std::string x0 = std::to_string(10 * i + 1);
+                std::string x1 = std::to_string(10 * i + 4);
+                std::string y0 = std::to_string(10 * j + 1);
+                std::string y1 = std::to_string(10 * j + 4);
+                o.add("polygon", "POLYGON ((" + x0 + " " + y0 + ", " +
+                    x1 + " " + y0 + ", " + x1 + " " + y1 + ", " +
+                    x0 + " " + y1 + ", " + x0 + " " + y0 + "))");
+            }
+        o.add("polygon", "POLYGON ((-1 -1, 101 -1, 101 101, -1 101, -1 -1))");
+        o.add("outside", outside);
+
+        CropFilter crop;
+        crop.setInput(r);
+        crop.setOptions(o);
+        crop.prepare(table);
+        return crop.execute(table);
+    };
+
+    PointViewSet s = run(false);
+    EXPECT_EQ(s.size(), 101u);
+    point_count_t total = 0;
+    for (auto v : s)
+    {
+        if (v->size() == 10000)
+            continue;
+        EXPECT_EQ(v->size(), 9u);
+        double x = v->getFieldAs<double>(Id::X, 0);
+        double y = v->getFieldAs<double>(Id::Y, 0);
+        for (PointId i = 0; i < v->size(); ++i)
+        {
+            EXPECT_LT(std::abs(v->getFieldAs<double>(Id::X, i) - x), 3);
+            EXPECT_LT(std::abs(v->getFieldAs<double>(Id::Y, i) - y), 3);
+        }
+        total += v->size();
+    }
+    EXPECT_EQ(total, 900u);
+
+    s = run(true);
+    EXPECT_EQ(s.size(), 101u);
+    for (auto v : s)
+        EXPECT_TRUE(v->size() == 0 || v->size() == 10000 - 9);
+}
@@ -40,6 +40,8 @@
 #include <filters/DecimationFilter.hpp>
 #include <filters/StreamCallbackFilter.hpp>
 
+#include "Support.hpp"
+
 using namespace pdal;
 
 TEST(DecimationFilterTest, create)
@@ -126,3 +128,79 @@ TEST(DecimationFilterTest, stream)
     filter.execute(t);
 }
 
+
+// Readers that can seek only read the points that decimation keeps.
+void testPushdown(const std::string& filename, bool stream)
+{
+    StageFactory fac;
+
+    Options ro;
+    ro.add("filename", filename);
+
+    Stage& r1 = *(fac.createStage(fac.inferReaderDriver(filename)));
+    r1.setOptions(ro);
+    PointTable t1;
+    r1.prepare(t1);
+    PointViewPtr all = *r1.execute(t1).begin();
+    ASSERT_GT(all->size(), 100u);
+
+    Stage& r2 = *(fac.createStage(fac.inferReaderDriver(filename)));
+    r2.setOptions(ro);
+    point_count_t numRead = 0;
+    dynamic_cast<Reader&>(r2).setReadCb(
+        [&numRead](PointView&, PointId){ numRead++; });
+
+    Options fo;
+    fo.add("step", 7);
+    fo.add("offset", 3);
+    Stage& f = *(fac.createStage("filters.decimation"));
+    f.setOptions(fo);
+    f.setInput(r2);
+
+    const point_count_t expected = (all->size() - 3 + 6) / 7;
+    std::vector<double> xs;
+    std::vector<double> zs;
+    if (stream)
+    {
+        StreamCallbackFilter c;
+        c.setCallback([&xs, &zs](PointRef& point)
+        {
+            xs.push_back(point.getFieldAs<double>(Dimension::Id::X));
+            zs.push_back(point.getFieldAs<double>(Dimension::Id::Z));
+            return true;
+        });
+        c.setInput(f);
+
+        FixedPointTable t2(100);
+        c.prepare(t2);
+        c.execute(t2);
+    }
+    else
+    {
+        PointTable t2;
+        f.prepare(t2);
+        PointViewPtr v = *f.execute(t2).begin();
+        EXPECT_EQ(numRead, expected);
+        for (PointId i = 0; i < v->size(); ++i)
+        {
+            xs.push_back(v->getFieldAs<double>(Dimension::Id::X, i));
+            zs.push_back(v->getFieldAs<double>(Dimension::Id::Z, i));
+        }
+    }
+    ASSERT_EQ(xs.size(), expected);
+    for (PointId i = 0; i < xs.size(); ++i)
+    {
+        EXPECT_EQ(xs[i], all->getFieldAs<double>(Dimension::Id::X, 3 + i * 7));
+        EXPECT_EQ(zs[i], all->getFieldAs<double>(Dimension::Id::Z, 3 + i * 7));
+    }
+}
+
+TEST(DecimationFilterTest, pushdown)
+{
+    testPushdown(Support::datapath("las/simple.las"), false);
+    testPushdown(Support::datapath("las/simple.las"), true);
+    testPushdown(Support::datapath("laz/simple.laz"), false);
+    testPushdown(Support::datapath("laz/simple.laz"), true);
+    testPushdown(Support::datapath("bpf/autzen-dd.bpf"), false);
+    testPushdown(Support::datapath("bpf/autzen-dd.bpf"), true);
+}
@@ -36,9 +36,12 @@
 #include <pdal/pdal_test_main.hpp>
 
 #include <pdal/PointView.hpp>
+#include <io/BufferReader.hpp>
 #include <io/TextReader.hpp>
 #include <filters/DelaunayFilter.hpp>
 
+#include <array>
+#include <random>
 #include <vector>
 #include <algorithm> // for rotate_copy
 
@@ -99,3 +102,58 @@ TEST(DelaunayFilterTest, test1)
     EXPECT_EQ(expectedTriangles.size(), (size_t)0);
 }
 
+
+namespace
+{
+
+// Triangles of the triangulation of a fixed set of random points, each
+// starting at its smallest vertex, in sorted order.
+std::vector<std::array<PointId, 3>> randomTriangles(int threads)
+{
+    PointTable table;
+    table.layout()->registerDims({Dimension::Id::X, Dimension::Id::Y});
+    PointViewPtr view(new PointView(table));
+
+    std::mt19937 gen(12345);
+    std::uniform_real_distribution<double> dist(0, 1000);
+    for (PointId i = 0; i < 20000; ++i)
+    {
+        view->setField(Dimension::Id::X, i, dist(gen));
+        view->setField(Dimension::Id::Y, i, dist(gen));
+    }
+
+    BufferReader reader;
+    reader.addView(view);
+
+    Options opts;
+    opts.add("threads", threads);
+    DelaunayFilter filter;
+    filter.setOptions(opts);
+    filter.setInput(reader);
+    filter.prepare(table);
+    PointViewSet viewSet = filter.execute(table);
+    TriangularMesh *mesh = (*viewSet.begin())->mesh("delaunay2d");
+
+    std::vector<std::array<PointId, 3>> triangles;
+    for (const Triangle& t : *mesh)
+    {
+        std::array<PointId, 3> a { {t.m_a, t.m_b, t.m_c} };
+        std::rotate(a.begin(), std::min_element(a.begin(), a.end()),
+            a.end());
+        triangles.push_back(a);
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+} // unnamed namespace
+
+TEST(DelaunayFilterTest, threads)
+{
+    std::vector<std::array<PointId, 3>> serial = randomTriangles(1);
+    std::vector<std::array<PointId, 3>> parallel = randomTriangles(4);
+
+    // Every point is a vertex and the hull of random points is small.
+    EXPECT_GT(serial.size(), 39900u);
+    EXPECT_EQ(serial, parallel);
+}
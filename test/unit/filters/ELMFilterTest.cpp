@@ -36,6 +36,7 @@
 #include <io/BufferReader.hpp>
 #include <io/TextReader.hpp>
 #include <filters/ELMFilter.hpp>
+#include <filters/StreamCallbackFilter.hpp>
 #include <pdal/StageFactory.hpp>
 
 #include "Support.hpp"
@@ -121,3 +122,74 @@ TEST(ELMFilterTest, emptyView)
     PointViewPtr v = *s.begin();
     EXPECT_EQ(v->size(), 0u);
 }
+
+TEST(ELMFilterTest, threads)
+{
+    auto classify = [](int threads)
+    {
+        Options readerOps;
+        readerOps.add("filename",
+            Support::datapath("filters/elm2.txt"));
+
+        TextReader reader;
+        reader.setOptions(readerOps);
+
+        Options ops;
+        ops.add("threads", threads);
+        ops.add("cell", 1.0);
+
+        ELMFilter filter;
+        filter.setOptions(ops);
+        filter.setInput(reader);
+
+        PointTable table;
+        filter.prepare(table);
+        PointViewSet viewSet = filter.execute(table);
+        PointViewPtr view = *viewSet.begin();
+        std::vector<uint8_t> classes;
+        for (PointId i = 0; i < view->size(); ++i)
+            classes.push_back(view->getFieldAs<uint8_t>(
+                Dimension::Id::Classification, i));
+        return classes;
+    };
+
+    std::vector<uint8_t> classes = classify(1);
+    EXPECT_EQ(std::count(classes.begin(), classes.end(),
+        (uint8_t)ClassLabel::LowPoint), 8);
+    EXPECT_EQ(classify(4), classes);
+}
+
+TEST(ELMFilterTest, stream)
+{
+    auto count = [](const std::string& file)
+    {
+        Options readerOps;
+        readerOps.add("filename", Support::datapath(file));
+
+        TextReader reader;
+        reader.setOptions(readerOps);
+
+        ELMFilter elm;
+        elm.setInput(reader);
+
+        int noise(0);
+        StreamCallbackFilter filter;
+        filter.setCallback([&noise](PointRef& point)
+            {
+                uint8_t c = point.getFieldAs<uint8_t>(
+                    Dimension::Id::Classification);
+                if (c == ClassLabel::LowPoint)
+                    noise++;
+                return true;
+            });
+        filter.setInput(elm);
+
+        FixedPointTable t(100);
+        filter.prepare(t);
+        filter.execute(t);
+        return noise;
+    };
+
+    EXPECT_EQ(count("filters/elm1.txt"), 2);
+    EXPECT_EQ(count("filters/elm2.txt"), 7);
+}
@@ -0,0 +1,117 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <pdal/PointView.hpp>
+#include <pdal/StageFactory.hpp>
+#include <io/FauxReader.hpp>
+#include <filters/FarthestPointSamplingFilter.hpp>
+
+using namespace pdal;
+
+namespace
+{
+
+PointViewPtr sample(int threads, bool prune)
+{
+    Options ro;
+    ro.add("bounds", BOX3D(0, 0, 0, 1000, 1000, 50));
+    ro.add("mode", "random");
+    ro.add("count", 70000);
+    ro.add("seed", 7);
+    FauxReader reader;
+    reader.setOptions(ro);
+
+    Options fo;
+    fo.add("count", 100);
+    fo.add("threads", threads);
+    fo.add("prune", prune);
+    FarthestPointSamplingFilter filter;
+    filter.setOptions(fo);
+    filter.setInput(reader);
+
+    PointTable table;
+    filter.prepare(table);
+    PointViewSet s = filter.execute(table);
+    EXPECT_EQ(s.size(), 1u);
+    return *s.begin();
+}
+
+} // unnamed namespace
+
+TEST(FarthestPointSamplingFilterTest, create)
+{
+    StageFactory f;
+    Stage* filter(f.createStage("filters.fps"));
+    EXPECT_TRUE(filter);
+}
+
+TEST(FarthestPointSamplingFilterTest, sample)
+{
+    using namespace Dimension;
+
+    PointViewPtr v = sample(1, false);
+    ASSERT_EQ(v->size(), 100u);
+
+    // Each sample is farther from the samples before it than any later
+    // sample is.
+    double last = (std::numeric_limits<double>::max)();
+    for (PointId i = 1; i < v->size(); ++i)
+    {
+        double nearest = (std::numeric_limits<double>::max)();
+        for (PointId j = 0; j < i; ++j)
+        {
+            double dx = v->getFieldAs<double>(Id::X, i) -
+                v->getFieldAs<double>(Id::X, j);
+            double dy = v->getFieldAs<double>(Id::Y, i) -
+                v->getFieldAs<double>(Id::Y, j);
+            double dz = v->getFieldAs<double>(Id::Z, i) -
+                v->getFieldAs<double>(Id::Z, j);
+            nearest = (std::min)(nearest, dx * dx + dy * dy + dz * dz);
+        }
+        EXPECT_LE(nearest, last);
+        last = nearest;
+    }
+
+    // Threads and pruning don't change the samples.
+    for (int threads : { 1, 3 })
+        for (bool prune : { false, true })
+        {
+            PointViewPtr v2 = sample(threads, prune);
+            ASSERT_EQ(v2->size(), v->size());
+            for (PointId i = 0; i < v->size(); ++i)
+                EXPECT_EQ(v->getFieldAs<uint64_t>(Id::OffsetTime, i),
+                    v2->getFieldAs<uint64_t>(Id::OffsetTime, i));
+        }
+}
@@ -35,6 +35,7 @@
 #include <pdal/pdal_test_main.hpp>
 
 #include <pdal/StageFactory.hpp>
+#include <filters/StreamCallbackFilter.hpp>
 
 #include "Support.hpp"
 
@@ -191,6 +192,79 @@ TEST(HAGFilterTest, closest)
     }
 }
 
+// Heights computed against the ground points of a separate file, in stream
+// mode, match those computed from the input's own ground points.
+TEST(HAGFilterTest, groundStream)
+{
+    StageFactory factory;
+
+    Options ro;
+    ro.add("filename", Support::datapath("filters/hagtest.txt"));
+    Options fo;
+    fo.add("count", 2);
+
+    Stage& r = *(factory.createStage("readers.text"));
+    r.setOptions(ro);
+    Stage& f = *(factory.createStage("filters.hag_nn"));
+    f.setOptions(fo);
+    f.setInput(r);
+
+    PointTable t1;
+    f.prepare(t1);
+    PointViewSet s = f.execute(t1);
+    PointViewPtr v = *s.begin();
+    std::vector<double> standard;
+    for (PointId i = 0; i < v->size(); ++i)
+        standard.push_back(
+            v->getFieldAs<double>(Dimension::Id::HeightAboveGround, i));
+
+    fo.add("ground", Support::datapath("filters/hagtest.txt"));
+    fo.add("threads", 2);
+    Stage& r2 = *(factory.createStage("readers.text"));
+    r2.setOptions(ro);
+    Stage& f2 = *(factory.createStage("filters.hag_nn"));
+    f2.setOptions(fo);
+    f2.setInput(r2);
+
+    std::vector<double> stream;
+    StreamCallbackFilter cb;
+    cb.setCallback([&stream](PointRef& point)
+    {
+        stream.push_back(
+            point.getFieldAs<double>(Dimension::Id::HeightAboveGround));
+        return true;
+    });
+    cb.setInput(f2);
+
+    FixedPointTable t2(3);
+    cb.prepare(t2);
+    EXPECT_TRUE(cb.pipelineStreamable());
+    cb.execute(t2);
+    EXPECT_EQ(stream, standard);
+
+    // Without a ground file, the filter can't be streamed.
+    Stage& r3 = *(factory.createStage("readers.text"));
+    r3.setOptions(ro);
+    Stage& f3 = *(factory.createStage("filters.hag_nn"));
+    f3.setInput(r3);
+    EXPECT_FALSE(f3.pipelineStreamable());
+
+    // Standard mode with a ground file and several threads matches too.
+    Stage& r4 = *(factory.createStage("readers.text"));
+    r4.setOptions(ro);
+    Stage& f4 = *(factory.createStage("filters.hag_nn"));
+    f4.setOptions(fo);
+    f4.setInput(r4);
+
+    PointTable t4;
+    f4.prepare(t4);
+    s = f4.execute(t4);
+    v = *s.begin();
+    for (PointId i = 0; i < v->size(); ++i)
+        EXPECT_EQ(v->getFieldAs<double>(Dimension::Id::HeightAboveGround, i),
+            standard[i]);
+}
+
 // Should add tests for exact match in neighbors case and for
 // max_distance in neighbors case.
 
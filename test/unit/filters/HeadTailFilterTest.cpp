@@ -94,3 +94,83 @@ TEST(HeadTailFilterTest, t1)
     testFilter(false, false);
 }
 
+
+// Readers only read the points that head and tail filters keep.
+void testPushdown(const std::string& filename, bool head)
+{
+    StageFactory fac;
+
+    Options ro;
+    ro.add("filename", filename);
+
+    Stage& r1 = *(fac.createStage(fac.inferReaderDriver(filename)));
+    r1.setOptions(ro);
+    PointTable t1;
+    r1.prepare(t1);
+    PointViewPtr all = *r1.execute(t1).begin();
+    ASSERT_GT(all->size(), 10u);
+
+    Stage& r2 = *(fac.createStage(fac.inferReaderDriver(filename)));
+    r2.setOptions(ro);
+    point_count_t numRead = 0;
+    dynamic_cast<Reader&>(r2).setReadCb(
+        [&numRead](PointView&, PointId){ numRead++; });
+
+    Options fo;
+    fo.add("count", 10);
+    Stage& f = *(fac.createStage(head ? "filters.head" : "filters.tail"));
+    f.setOptions(fo);
+    f.setInput(r2);
+
+    PointTable t2;
+    f.prepare(t2);
+    PointViewPtr v = *f.execute(t2).begin();
+    EXPECT_EQ(numRead, 10u);
+    ASSERT_EQ(v->size(), 10u);
+
+    PointId start = head ? 0 : all->size() - 10;
+    for (PointId i = 0; i < v->size(); ++i)
+    {
+        EXPECT_EQ(v->getFieldAs<double>(Dimension::Id::X, i),
+            all->getFieldAs<double>(Dimension::Id::X, start + i));
+        EXPECT_EQ(v->getFieldAs<double>(Dimension::Id::Z, i),
+            all->getFieldAs<double>(Dimension::Id::Z, start + i));
+    }
+}
+
+TEST(HeadTailFilterTest, pushdown)
+{
+    testPushdown(Support::datapath("las/simple.las"), true);
+    testPushdown(Support::datapath("las/simple.las"), false);
+    testPushdown(Support::datapath("bpf/autzen-dd.bpf"), true);
+    testPushdown(Support::datapath("bpf/autzen-dd.bpf"), false);
+}
+
+// Head filters can run in stream mode.
+TEST(HeadTailFilterTest, stream)
+{
+    StageFactory fac;
+
+    Options ro;
+    ro.add("filename", Support::datapath("las/simple.las"));
+    Stage& r = *(fac.createStage("readers.las"));
+    r.setOptions(ro);
+
+    Options fo;
+    fo.add("count", 10);
+    Stage& f = *(fac.createStage("filters.head"));
+    f.setOptions(fo);
+    f.setInput(r);
+
+    Stage& s = *(fac.createStage("filters.stats"));
+    s.setInput(f);
+
+    EXPECT_TRUE(s.pipelineStreamable());
+
+    FixedPointTable t(100);
+    s.prepare(t);
+    s.execute(t);
+
+    MetadataNode stats = s.getMetadata().findChild("statistic");
+    EXPECT_EQ(stats.findChild("count").value<point_count_t>(), 10u);
+}
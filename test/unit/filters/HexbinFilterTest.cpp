@@ -132,3 +132,38 @@ TEST(HexbinFilterTest, issue_2507)
     EXPECT_EQ(s, test);
 }
 
+
+// Binning on several threads and merging the counts must produce the same
+// boundary as binning serially.
+TEST(HexbinFilterTest, threads)
+{
+    auto run = [](int threads)
+    {
+        StageFactory f;
+
+        Options readerOps;
+        readerOps.add("filename", Support::datapath("las/autzen_trim.las"));
+        Stage* reader(f.createStage("readers.las"));
+        reader->setOptions(readerOps);
+
+        Options hexOps;
+        hexOps.add("threads", threads);
+        Stage* hexbin(f.createStage("filters.hexbin"));
+        hexbin->setOptions(hexOps);
+        hexbin->setInput(*reader);
+
+        PointTable table;
+        hexbin->prepare(table);
+        hexbin->execute(table);
+        return hexbin->getMetadata();
+    };
+
+    MetadataNode serial = run(1);
+    MetadataNode parallel = run(4);
+    EXPECT_EQ(serial.findChild("boundary").value(),
+        parallel.findChild("boundary").value());
+    EXPECT_EQ(serial.findChild("estimated_edge").value(),
+        parallel.findChild("estimated_edge").value());
+    EXPECT_EQ(serial.findChild("avg_pt_per_sq_unit").value(),
+        parallel.findChild("avg_pt_per_sq_unit").value());
+}
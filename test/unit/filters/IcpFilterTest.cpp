@@ -136,6 +136,39 @@ TEST(IcpFilterTest, RecoverTranslation)
     checkPointsEqualReader(pointViewSet, tolerance);
 }
 
+TEST(IcpFilterTest, RecoverTranslationThreadedCoarseToFine)
+{
+    auto reader1 = newReader();
+    auto reader2 = newReader();
+    TransformationFilter transformationFilter;
+    Options transformationOptions;
+    transformationOptions.add("matrix", "1 0 0 1\n0 1 0 2\n0 0 1 3\n0 0 0 1");
+    transformationFilter.setOptions(transformationOptions);
+    transformationFilter.setInput(*reader2);
+
+    auto filter = newFilter();
+    Options filterOptions;
+    filterOptions.add("threads", 3);
+    filterOptions.add("voxel_sizes", 20.0);
+    filterOptions.add("voxel_sizes", 0.0);
+    filter->setOptions(filterOptions);
+    filter->setInput(*reader1);
+    filter->setInput(transformationFilter);
+
+    PointTable table;
+    filter->prepare(table);
+    PointViewSet pointViewSet = filter->execute(table);
+
+    MetadataNode root = filter->getMetadata();
+    Eigen::MatrixXd transform =
+        root.findChild("transform").value<Eigen::MatrixXd>();
+    double tolerance = 1.5;
+    EXPECT_NEAR(-1.0, transform(0, 3), tolerance);
+    EXPECT_NEAR(-2.0, transform(1, 3), tolerance);
+    EXPECT_NEAR(-3.0, transform(2, 3), tolerance);
+    checkPointsEqualReader(pointViewSet, tolerance);
+}
+
 TEST(IcpFilterTest, TooFewInputs)
 {
     auto reader = newReader();
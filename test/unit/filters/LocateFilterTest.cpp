@@ -36,6 +36,7 @@
 
 #include <pdal/Options.hpp>
 #include <filters/LocateFilter.hpp>
+#include <filters/StreamCallbackFilter.hpp>
 #include <io/LasReader.hpp>
 
 #include "Support.hpp"
@@ -93,3 +94,81 @@ TEST(LocateTest, locate_min)
     
     EXPECT_NEAR(406.59, view->getFieldAs<double>(Dimension::Id::Z, 0), 0.0001);
 }
+
+TEST(LocateTest, threads)
+{
+    auto locate = [](std::string minmax, int threads)
+    {
+        PointTable table;
+
+        Options ro;
+        ro.add("filename", Support::datapath("las/1.2-with-color.las"));
+        LasReader r;
+        r.setOptions(ro);
+
+        Options fo;
+        fo.add("dimension", "Z");
+        fo.add("minmax", minmax);
+        fo.add("threads", threads);
+
+        LocateFilter f;
+        f.setInput(r);
+        f.setOptions(fo);
+        f.prepare(table);
+        PointViewSet viewSet = f.execute(table);
+        EXPECT_EQ(1u, viewSet.size());
+
+        PointViewPtr view = *viewSet.begin();
+        EXPECT_EQ(1u, view->size());
+        return view->getFieldAs<double>(Dimension::Id::Z, 0);
+    };
+
+    EXPECT_NEAR(586.38, locate("max", 5), 0.0001);
+    EXPECT_NEAR(406.59, locate("min", 3), 0.0001);
+}
+
+TEST(LocateTest, stream)
+{
+    Options ro;
+    ro.add("filename", Support::datapath("las/1.2-with-color.las"));
+    LasReader r;
+    r.setOptions(ro);
+
+    Options fo;
+    fo.add("dimension", "Z");
+    fo.add("minmax", "min");
+
+    LocateFilter f;
+    f.setInput(r);
+    f.setOptions(fo);
+
+    // Each point passed is lower than those before it.  The last is the
+    // minimum.
+    double last = (std::numeric_limits<double>::max)();
+    StreamCallbackFilter callback;
+    callback.setCallback([&last](PointRef& point)
+        {
+            double z = point.getFieldAs<double>(Dimension::Id::Z);
+            EXPECT_LT(z, last);
+            last = z;
+            return true;
+        });
+    callback.setInput(f);
+
+    FixedPointTable t(100);
+    callback.prepare(t);
+    callback.execute(t);
+    EXPECT_NEAR(406.59, last, 0.0001);
+}
+
+TEST(LocateTest, badMinmax)
+{
+    Options fo;
+    fo.add("dimension", "Z");
+    fo.add("minmax", "median");
+
+    LocateFilter f;
+    f.setOptions(fo);
+    PointTable table;
+    EXPECT_THROW(f.prepare(table), pdal_error);
+}
@@ -0,0 +1,133 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <pdal/PointView.hpp>
+#include <pdal/StageFactory.hpp>
+#include <io/BufferReader.hpp>
+#include <io/FauxReader.hpp>
+#include <filters/MADFilter.hpp>
+#include <filters/StreamCallbackFilter.hpp>
+
+using namespace pdal;
+
+namespace
+{
+
+// Filter Z values 0 through 99 with an outlier at either end.
+PointViewPtr filterRange(const Options& ops)
+{
+    PointTable table;
+    table.layout()->registerDim(Dimension::Id::Z);
+
+    PointViewPtr view(new PointView(table));
+    for (PointId i = 0; i < 100; ++i)
+        view->setField(Dimension::Id::Z, i, (double)i);
+    view->setField(Dimension::Id::Z, 100, 1000.0);
+    view->setField(Dimension::Id::Z, 101, -1000.0);
+
+    BufferReader reader;
+    reader.addView(view);
+
+    MADFilter filter;
+    filter.setOptions(ops);
+    filter.setInput(reader);
+    filter.prepare(table);
+    PointViewSet s = filter.execute(table);
+    EXPECT_EQ(s.size(), 1u);
+    return *s.begin();
+}
+
+} // unnamed namespace
+
+TEST(MADFilterTest, create)
+{
+    StageFactory f;
+    Stage* filter(f.createStage("filters.mad"));
+    EXPECT_TRUE(filter);
+}
+
+TEST(MADFilterTest, outliers)
+{
+    Options ops;
+    ops.add("dimension", "Z");
+
+    PointViewPtr out = filterRange(ops);
+    EXPECT_EQ(out->size(), 100u);
+    for (PointId i = 0; i < out->size(); ++i)
+        EXPECT_EQ(out->getFieldAs<double>(Dimension::Id::Z, i), (double)i);
+
+    ops.add("threads", 4);
+    EXPECT_EQ(filterRange(ops)->size(), 100u);
+
+    // Medians of few values are exact even when approximated.
+    ops.add("approximate", true);
+    EXPECT_EQ(filterRange(ops)->size(), 100u);
+}
+
+TEST(MADFilterTest, stream)
+{
+    Options ops;
+    ops.add("dimension", "Z");
+
+    MADFilter mad;
+    mad.setOptions(ops);
+    EXPECT_FALSE(mad.pipelineStreamable());
+
+    ops.add("approximate", true);
+    mad.setOptions(ops);
+    EXPECT_TRUE(mad.pipelineStreamable());
+
+    Options readerOps;
+    readerOps.add("bounds", BOX3D(0, 0, 0, 10, 10, 10));
+    readerOps.add("mode", "random");
+    readerOps.add("count", 10000);
+    readerOps.add("seed", 7);
+
+    FauxReader reader;
+    reader.setOptions(readerOps);
+    mad.setInput(reader);
+
+    // Fences for uniform values lie well outside their range, so all points
+    // are kept.
+    point_count_t count = 0;
+    StreamCallbackFilter filter;
+    filter.setCallback([&count](PointRef&){ count++; return true; });
+    filter.setInput(mad);
+
+    FixedPointTable t(100);
+    filter.prepare(t);
+    filter.execute(t);
+    EXPECT_EQ(count, 10000u);
+}
@@ -36,6 +36,8 @@
 
 #include <pdal/PipelineManager.hpp>
 
+#include <sstream>
+
 #include "Support.hpp"
 
 
@@ -94,3 +96,116 @@ TEST(MergeTest, test6)
     PointViewPtr view = *viewSet.begin();
     EXPECT_EQ(2130u, view->size());
 }
+
+// A stage whose output feeds several branches is executed once, and the
+// branches don't see each other's changes.
+TEST(MergeTest, branches)
+{
+    using namespace pdal;
+
+    std::string pipeline(R"json(
+    {
+        "pipeline" : [
+            {
+                "type": "readers.faux",
+                "mode": "ramp",
+                "count": 100,
+                "bounds": "([1, 100], [1, 100], [1, 100])",
+                "tag": "reader"
+            },
+            {
+                "type": "filters.assign",
+                "assignment": "X[:]=0",
+                "inputs": "reader",
+                "tag": "assign"
+            },
+            {
+                "type": "filters.range",
+                "limits": "X[51:100]",
+                "inputs": "reader",
+                "tag": "range"
+            },
+            {
+                "type": "filters.merge",
+                "inputs": [ "assign", "range" ]
+            }
+        ]
+    })json");
+
+    PipelineManager mgr;
+    std::istringstream iss(pipeline);
+    mgr.readPipeline(iss);
+    mgr.execute();
+
+    PointViewSet viewSet = mgr.views();
+    EXPECT_EQ(1u, viewSet.size());
+    PointViewPtr view = *viewSet.begin();
+    EXPECT_EQ(150u, view->size());
+    for (PointId i = 0; i < 100; ++i)
+        EXPECT_EQ(view->getFieldAs<double>(Dimension::Id::X, i), 0);
+    for (PointId i = 100; i < 150; ++i)
+        EXPECT_EQ(view->getFieldAs<double>(Dimension::Id::X, i), i - 49.0);
+}
+
+// Branches whose views are run concurrently copy the points they share
+// without interfering with each other.
+TEST(MergeTest, branchesThreads)
+{
+    using namespace pdal;
+
+    std::string pipeline(R"json(
+    {
+        "threads": 4,
+        "pipeline" : [
+            {
+                "type": "readers.faux",
+                "mode": "ramp",
+                "count": 10000,
+                "bounds": "([1, 1000], [1, 1000], [1, 1000])"
+            },
+            {
+                "type": "filters.splitter",
+                "length": 100,
+                "tag": "split"
+            },
+            {
+                "type": "filters.assign",
+                "assignment": "X[:]=0",
+                "inputs": "split",
+                "tag": "x"
+            },
+            {
+                "type": "filters.assign",
+                "assignment": "Z[:]=0",
+                "inputs": "split",
+                "tag": "z"
+            },
+            {
+                "type": "filters.merge",
+                "inputs": [ "x", "z" ]
+            }
+        ]
+    })json");
+
+    PipelineManager mgr;
+    std::istringstream iss(pipeline);
+    mgr.readPipeline(iss);
+    mgr.execute();
+
+    point_count_t total = 0;
+    point_count_t xZero = 0;
+    point_count_t zZero = 0;
+    for (PointViewPtr view : mgr.views())
+        for (PointId i = 0; i < view->size(); ++i)
+        {
+            total++;
+            double x = view->getFieldAs<double>(Dimension::Id::X, i);
+            double z = view->getFieldAs<double>(Dimension::Id::Z, i);
+            EXPECT_FALSE(x == 0 && z == 0);
+            xZero += (x == 0);
+            zZero += (z == 0);
+        }
+    EXPECT_EQ(total, 20000u);
+    EXPECT_EQ(xZero, 10000u);
+    EXPECT_EQ(zZero, 10000u);
+}
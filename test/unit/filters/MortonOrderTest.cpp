@@ -113,3 +113,117 @@ TEST(MortonOrderTest, test_code)
     EXPECT_EQ(outView->getFieldAs<double>(Dimension::Id::X, 5), 3);
     EXPECT_EQ(outView->getFieldAs<double>(Dimension::Id::Y, 5), 2);
 }
+
+TEST(MortonOrderTest, hilbert)
+{
+    PointTable table;
+    table.layout()->registerDim(Dimension::Id::X);
+    table.layout()->registerDim(Dimension::Id::Y);
+
+    PointViewPtr view(new PointView(table));
+
+    int n = 0;
+    for (int i = 0; i < 8; i++)
+        for (int j = 0; j < 8; j++)
+        {
+            view->setField(Dimension::Id::X, n, j);
+            view->setField(Dimension::Id::Y, n, i);
+            n += 1;
+        }
+
+    BufferReader r;
+    r.addView(view);
+
+    MortonOrderFilter filter;
+    Options o;
+    o.add("curve", "hilbert");
+    filter.setInput(r);
+    filter.setOptions(o);
+
+    filter.prepare(table);
+    PointViewSet s = filter.execute(table);
+    PointViewPtr outView = *s.begin();
+    ASSERT_EQ(outView->size(), 64u);
+
+    // The curve starts in a corner and each point is next to the previous.
+    EXPECT_EQ(outView->getFieldAs<int>(Dimension::Id::X, 0), 0);
+    EXPECT_EQ(outView->getFieldAs<int>(Dimension::Id::Y, 0), 0);
+    for (PointId i = 1; i < outView->size(); ++i)
+    {
+        int dx = outView->getFieldAs<int>(Dimension::Id::X, i) -
+            outView->getFieldAs<int>(Dimension::Id::X, i - 1);
+        int dy = outView->getFieldAs<int>(Dimension::Id::Y, i) -
+            outView->getFieldAs<int>(Dimension::Id::Y, i - 1);
+        EXPECT_EQ(std::abs(dx) + std::abs(dy), 1);
+    }
+}
+
+TEST(MortonOrderTest, threads)
+{
+    PointTable table;
+    table.layout()->registerDim(Dimension::Id::X);
+    table.layout()->registerDim(Dimension::Id::Y);
+    table.layout()->registerDim(Dimension::Id::GpsTime);
+
+    PointViewPtr view(new PointView(table));
+
+    uint32_t seed = 1234;
+    auto next = [&seed]()
+    {
+        seed = seed * 1664525 + 1013904223;
+        return (seed >> 8) / 1000.0;
+    };
+    for (PointId i = 0; i < 100000; ++i)
+    {
+        view->setField(Dimension::Id::X, i, next());
+        view->setField(Dimension::Id::Y, i, next());
+        view->setField(Dimension::Id::GpsTime, i, i);
+    }
+
+    auto order = [&table, view](const std::string& curve, unsigned threads)
+    {
+        BufferReader r;
+        r.addView(view);
+
+        MortonOrderFilter filter;
+        Options o;
+        o.add("curve", curve);
+        o.add("threads", threads);
+        filter.setInput(r);
+        filter.setOptions(o);
+
+        filter.prepare(table);
+        PointViewSet s = filter.execute(table);
+        PointViewPtr outView = *s.begin();
+
+        std::vector<PointId> ids;
+        for (PointId i = 0; i < outView->size(); ++i)
+            ids.push_back(
+                outView->getFieldAs<PointId>(Dimension::Id::GpsTime, i));
+        return ids;
+    };
+
+    std::vector<PointId> morton = order("morton", 1);
+    ASSERT_EQ(morton.size(), view->size());
+    EXPECT_TRUE(morton == order("morton", 4));
+    EXPECT_TRUE(order("hilbert", 1) == order("hilbert", 4));
+    EXPECT_FALSE(morton == order("hilbert", 1));
+}
+
+TEST(MortonOrderTest, badOptions)
+{
+    PointTable table;
+
+    MortonOrderFilter f1;
+    Options o1;
+    o1.add("curve", "peano");
+    f1.setOptions(o1);
+    EXPECT_THROW(f1.prepare(table), pdal_error);
+
+    MortonOrderFilter f2;
+    Options o2;
+    o2.add("curve", "hilbert");
+    o2.add("reverse", true);
+    f2.setOptions(o2);
+    EXPECT_THROW(f2.prepare(table), pdal_error);
+}
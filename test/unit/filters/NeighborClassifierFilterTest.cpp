@@ -167,6 +167,46 @@ TEST(NeighborClassifierFilterTest, multipleRange)
     }
 }
 
+TEST(NeighborClassifierFilterTest, threads)
+{
+    StageFactory factory;
+    Options ro;
+    ro.add("filename", Support::datapath("las/sample_c.las"));
+
+    auto classify = [&factory, &ro](int threads)
+    {
+        Stage& r = *(factory.createStage("readers.las"));
+        r.setOptions(ro);
+
+        Options fo;
+        fo.add("domain", "Classification[1:6]");
+        fo.add("k", 5);
+        fo.add("threads", threads);
+        Stage& f = *(factory.createStage("filters.neighborclassifier"));
+        f.setInput(r);
+        f.setOptions(fo);
+
+        PointTable table;
+        f.prepare(table);
+        PointViewSet viewSet = f.execute(table);
+        EXPECT_EQ(1u, viewSet.size());
+        PointViewPtr view = *viewSet.begin();
+
+        std::vector<int> classes;
+        for (PointId i = 0; i < view->size(); ++i)
+            classes.push_back(
+                view->getFieldAs<int>(Dimension::Id::Classification, i));
+        return classes;
+    };
+
+    // Votes use the original classifications, so the result doesn't
+    // depend on how points are split between threads.
+    std::vector<int> c1 = classify(1);
+    std::vector<int> c4 = classify(4);
+    EXPECT_EQ(14408u, c1.size());
+    EXPECT_TRUE(c1 == c4);
+}
+
 TEST(NeighborClassifierFilterTest, candidate)
 {
     StageFactory factory;
@@ -37,6 +37,7 @@
 #include <filters/NormalFilter.hpp>
 #include <io/BufferReader.hpp>
 #include <io/FauxReader.hpp>
+#include <io/LasReader.hpp>
 #include <pdal/PointView.hpp>
 
 #include "Support.hpp"
@@ -251,4 +252,40 @@ TEST(NormalFilterTest, RampPlane2)
     }
 }
 
+TEST(NormalFilterTest, threads)
+{
+    using namespace Dimension;
+
+    auto run = [](int threads)
+    {
+        Options readerOps;
+        readerOps.add("filename", Support::datapath("las/autzen_trim.las"));
+        LasReader reader;
+        reader.setOptions(readerOps);
+
+        Options filterOps;
+        filterOps.add("threads", threads);
+        NormalFilter filter;
+        filter.setInput(reader);
+        filter.setOptions(filterOps);
+
+        PointTable table;
+        filter.prepare(table);
+        PointViewSet viewSet = filter.execute(table);
+        PointViewPtr view = *viewSet.begin();
+
+        std::vector<double> out;
+        for (PointId i = 0; i < view->size(); ++i)
+            for (Id id : { Id::NormalX, Id::NormalY, Id::NormalZ,
+                    Id::Curvature })
+                out.push_back(view->getFieldAs<double>(id, i));
+        return out;
+    };
+
+    // Normals and their refinement don't depend on the number of threads.
+    std::vector<double> single = run(1);
+    EXPECT_EQ(single.size(), 110000u * 4);
+    EXPECT_EQ(single, run(3));
+}
+
 } // namespace pdal
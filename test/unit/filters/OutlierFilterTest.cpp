@@ -0,0 +1,119 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <algorithm>
+
+#include <pdal/PointView.hpp>
+#include <pdal/StageFactory.hpp>
+#include <filters/StreamCallbackFilter.hpp>
+
+#include "Support.hpp"
+
+using namespace pdal;
+
+TEST(OutlierFilterTest, streamRadius)
+{
+    StageFactory f;
+
+    Options rOpts;
+    rOpts.add("filename", Support::datapath("las/autzen_trim.las"));
+    Options fOpts;
+    fOpts.add("method", "radius");
+    fOpts.add("radius", 5.0);
+    fOpts.add("min_k", 4);
+    fOpts.add("class", 7);
+
+    Stage *reader(f.createStage("readers.las"));
+    reader->setOptions(rOpts);
+    Stage *filter(f.createStage("filters.outlier"));
+    filter->setOptions(fOpts);
+    filter->setInput(*reader);
+
+    PointTable table;
+    filter->prepare(table);
+    PointViewSet s = filter->execute(table);
+    PointViewPtr v = *(s.begin());
+    std::vector<int> standard;
+    for (PointId i = 0; i < v->size(); ++i)
+        standard.push_back(
+            v->getFieldAs<int>(Dimension::Id::Classification, i));
+
+    // When all the points fit in one batch, the points are classified as
+    // in standard mode.
+    Stage *reader2(f.createStage("readers.las"));
+    reader2->setOptions(rOpts);
+    Stage *filter2(f.createStage("filters.outlier"));
+    filter2->setOptions(fOpts);
+    filter2->setInput(*reader2);
+
+    std::vector<int> stream;
+    StreamCallbackFilter cb;
+    cb.setCallback([&stream](PointRef& point)
+    {
+        stream.push_back(
+            point.getFieldAs<int>(Dimension::Id::Classification));
+        return true;
+    });
+    cb.setInput(*filter2);
+
+    FixedPointTable streamTable(v->size());
+    cb.prepare(streamTable);
+    EXPECT_TRUE(cb.pipelineStreamable());
+    cb.execute(streamTable);
+    EXPECT_EQ(stream, standard);
+    EXPECT_NE(std::count(stream.begin(), stream.end(), 7), 0);
+}
+
+TEST(OutlierFilterTest, streamStatistical)
+{
+    StageFactory f;
+
+    Options rOpts;
+    rOpts.add("filename", Support::datapath("las/autzen_trim.las"));
+    Stage *reader(f.createStage("readers.las"));
+    reader->setOptions(rOpts);
+
+    // The statistical method needs all the points, so it can't stream.
+    Options fOpts;
+    fOpts.add("method", "statistical");
+    Stage *filter(f.createStage("filters.outlier"));
+    filter->setOptions(fOpts);
+    filter->setInput(*reader);
+
+    FixedPointTable table(1000);
+    filter->prepare(table);
+    EXPECT_FALSE(filter->pipelineStreamable());
+    EXPECT_THROW(filter->execute(table), pdal_error);
+}
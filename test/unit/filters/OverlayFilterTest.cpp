@@ -41,7 +41,7 @@
 
 using namespace pdal;
 
-void testOverlay(int numReaders, bool stream)
+void testOverlay(int numReaders, bool stream, bool merge = false)
 {
     Options ro;
     ro.add("filename", Support::datapath("autzen/autzen-dd.las"));
@@ -52,6 +52,8 @@ void testOverlay(int numReaders, bool stream)
     fo.add("dimension", "Classification");
     fo.add("column", "cls");
     fo.add("datasource", Support::datapath("autzen/attributes.shp"));
+    if (merge)
+        fo.add("union", true);
 
     LogPtr l(Log::makeLog("readers.las", "stderr"));
     Stage& f = *(factory.createStage("filters.overlay"));
@@ -162,3 +164,9 @@ TEST(OverlayFilterTest, stream)
 {
     testOverlay(10, true);
 }
+
+TEST(OverlayFilterTest, merged)
+{
+    testOverlay(1, false, true);
+    testOverlay(1, true, true);
+}
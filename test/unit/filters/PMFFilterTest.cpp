@@ -102,3 +102,49 @@ TEST(PMFFilterTest, classOneAndTwoOnly)
     EXPECT_EQ(v->size(), 110000u);
     EXPECT_EQ(classZero, 0u);
 }
+
+TEST(PMFFilterTest, tiled)
+{
+    StageFactory f;
+
+    Stage* reader(f.createStage("readers.las"));
+    Options rOpts;
+    rOpts.add("filename", Support::datapath("las/autzen_trim.las"));
+    reader->setOptions(rOpts);
+
+    Stage* assign(f.createStage("filters.assign"));
+    Options aOpts;
+    aOpts.add("assignment", "Classification[:]=0");
+    assign->setInput(*reader);
+    assign->setOptions(aOpts);
+
+    Stage* filter(f.createStage("filters.pmf"));
+    Options fOpts;
+    fOpts.add("returns", "first,last,intermediate,only");
+    fOpts.add("tile_size", 400.0);
+    fOpts.add("threads", 2);
+    filter->setInput(*assign);
+    filter->setOptions(fOpts);
+
+    PointTable t;
+    filter->prepare(t);
+    PointViewSet s = filter->execute(t);
+
+    EXPECT_EQ(s.size(), 1U);
+    PointViewPtr v = *s.begin();
+
+    // Every point is in the core of exactly one tile.
+    size_t classZero{0};
+    size_t ground{0};
+    for (PointId id = 0; id < v->size(); ++id)
+    {
+        uint8_t cl = v->getFieldAs<uint8_t>(Dimension::Id::Classification, id);
+        if (cl == ClassLabel::CreatedNeverClassified)
+            classZero++;
+        if (cl == ClassLabel::Ground)
+            ground++;
+    }
+    EXPECT_EQ(v->size(), 110000u);
+    EXPECT_EQ(classZero, 0u);
+    EXPECT_GT(ground, 0u);
+}
@@ -0,0 +1,165 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <pdal/PointView.hpp>
+#include <pdal/StageFactory.hpp>
+#include <filters/StreamCallbackFilter.hpp>
+
+#include "Support.hpp"
+
+using namespace pdal;
+
+namespace
+{
+
+// Densities of autzen_trim computed in standard mode.
+std::vector<double> standardDensities(const Options& fOpts)
+{
+    StageFactory f;
+    Stage *reader(f.createStage("readers.las"));
+    Stage *filter(f.createStage("filters.radialdensity"));
+
+    Options rOpts;
+    rOpts.add("filename", Support::datapath("las/autzen_trim.las"));
+    reader->setOptions(rOpts);
+    filter->setOptions(fOpts);
+    filter->setInput(*reader);
+
+    PointTable table;
+    filter->prepare(table);
+    PointViewSet s = filter->execute(table);
+    PointViewPtr v = *(s.begin());
+
+    Dimension::Id dens = table.layout()->findDim("RadialDensity");
+    std::vector<double> out;
+    for (PointId i = 0; i < v->size(); ++i)
+        out.push_back(v->getFieldAs<double>(dens, i));
+    return out;
+}
+
+// Densities of autzen_trim computed in stream mode.
+std::vector<double> streamDensities(const Options& fOpts,
+    point_count_t capacity)
+{
+    StageFactory f;
+    Stage *reader(f.createStage("readers.las"));
+    Stage *filter(f.createStage("filters.radialdensity"));
+
+    Options rOpts;
+    rOpts.add("filename", Support::datapath("las/autzen_trim.las"));
+    reader->setOptions(rOpts);
+    filter->setOptions(fOpts);
+    filter->setInput(*reader);
+
+    std::vector<double> out;
+    Dimension::Id dens;
+    StreamCallbackFilter cb;
+    cb.setCallback([&out, &dens](PointRef& point)
+    {
+        out.push_back(point.getFieldAs<double>(dens));
+        return true;
+    });
+    cb.setInput(*filter);
+
+    FixedPointTable table(capacity);
+    cb.prepare(table);
+    dens = table.layout()->findDim("RadialDensity");
+    EXPECT_TRUE(cb.pipelineStreamable());
+    cb.execute(table);
+    return out;
+}
+
+} // unnamed namespace
+
+TEST(RadialDensityFilterTest, stream)
+{
+    for (const char *index : { "kdtree", "grid" })
+    {
+        Options fOpts;
+        fOpts.add("radius", 15.0);
+        fOpts.add("index", index);
+        std::vector<double> standard = standardDensities(fOpts);
+        ASSERT_EQ(standard.size(), 110000u);
+
+        // When all the points fit in one batch, the neighborhoods are the
+        // same as in standard mode.
+        EXPECT_EQ(streamDensities(fOpts, 110000), standard);
+    }
+
+    // With small batches, neighbors in later batches are missed, but no
+    // point is given more neighbors than it has.
+    Options fOpts;
+    fOpts.add("radius", 15.0);
+    fOpts.add("halo", 20000);
+    std::vector<double> standard = standardDensities(fOpts);
+    std::vector<double> stream = streamDensities(fOpts, 10000);
+    ASSERT_EQ(stream.size(), standard.size());
+    size_t same = 0;
+    for (size_t i = 0; i < stream.size(); ++i)
+    {
+        EXPECT_LE(stream[i], standard[i]);
+        EXPECT_GT(stream[i], 0);
+        if (stream[i] == standard[i])
+            same++;
+    }
+    EXPECT_GT(same, stream.size() / 2);
+}
+
+TEST(RadialDensityFilterTest, window)
+{
+    // Without a halo, only the neighbors in a point's own batch are found.
+    Options fOpts;
+    fOpts.add("radius", 15.0);
+    fOpts.add("halo", 0);
+    std::vector<double> small = streamDensities(fOpts, 1000);
+    fOpts.replace("halo", 1000000);
+    std::vector<double> large = streamDensities(fOpts, 1000);
+    ASSERT_EQ(small.size(), large.size());
+    for (size_t i = 0; i < small.size(); ++i)
+        EXPECT_LE(small[i], large[i]);
+}
+
+TEST(RadialDensityFilterTest, threads)
+{
+    for (const char *index : { "kdtree", "grid" })
+    {
+        Options fOpts;
+        fOpts.add("radius", 15.0);
+        fOpts.add("index", index);
+        std::vector<double> serial = standardDensities(fOpts);
+        fOpts.add("threads", 4);
+        EXPECT_EQ(standardDensities(fOpts), serial);
+    }
+}
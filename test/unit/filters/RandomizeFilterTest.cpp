@@ -206,3 +206,52 @@ TEST(RandomizeFilterTest, unseeded)
     }
     EXPECT_LT(numMatches, count);
 }
+
+// The order depends on the seed, but not on the number of threads.
+TEST(RandomizeFilterTest, threads)
+{
+    point_count_t count = 100000;
+
+    Options readerOps;
+    readerOps.add("bounds",
+                  BOX3D(1, 1, 1, (double)count, (double)count, double(count)));
+    readerOps.add("mode", "ramp");
+    readerOps.add("count", count);
+
+    auto shuffle = [&readerOps](int threads)
+    {
+        FauxReader r;
+        r.setOptions(readerOps);
+
+        Options filterOps;
+        filterOps.add("seed", 42);
+        filterOps.add("threads", threads);
+
+        RandomizeFilter f;
+        f.setInput(r);
+        f.setOptions(filterOps);
+
+        PointTable t;
+        f.prepare(t);
+        PointViewPtr v = *f.execute(t).begin();
+
+        std::vector<double> vals;
+        for (PointId i = 0; i < v->size(); ++i)
+            vals.push_back(v->getFieldAs<double>(Dimension::Id::X, i));
+        return vals;
+    };
+
+    std::vector<double> vals = shuffle(1);
+    ASSERT_EQ(vals.size(), (size_t)count);
+    EXPECT_EQ(vals, shuffle(4));
+
+    // Every point appears once and the points have been moved.
+    size_t inPlace = 0;
+    for (size_t i = 0; i < vals.size(); ++i)
+        if (vals[i] == (double)(i + 1))
+            inPlace++;
+    EXPECT_LT(inPlace, (size_t)10);
+    std::sort(vals.begin(), vals.end());
+    for (size_t i = 0; i < vals.size(); ++i)
+        EXPECT_EQ(vals[i], (double)(i + 1));
+}
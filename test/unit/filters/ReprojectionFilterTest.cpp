@@ -36,9 +36,13 @@
 
 #include <pdal/SpatialReference.hpp>
 #include <pdal/PointView.hpp>
+#include <io/FauxReader.hpp>
 #include <io/LasReader.hpp>
 #include <filters/ReprojectionFilter.hpp>
 #include <filters/StreamCallbackFilter.hpp>
+#include <pdal/private/SrsTransform.hpp>
+
+#include <thread>
 
 #include "Support.hpp"
 
@@ -227,3 +231,87 @@ TEST(ReprojectionFilterTest, stream_test_2)
     f.prepare(table3);
     f.execute(table3);
 }
+
+// Results must not depend on the number of threads.
+TEST(ReprojectionFilterTest, threads)
+{
+    auto run = [](int threads)
+    {
+        Options ro;
+        ro.add("mode", "ramp");
+        ro.add("count", 50000);
+        ro.add("bounds", BOX3D(470000, 4600000, 0, 480000, 4610000, 100));
+
+        FauxReader reader;
+        reader.setOptions(ro);
+
+        Options fo;
+        fo.add("in_srs", "EPSG:26915");
+        fo.add("out_srs", "EPSG:4326");
+        fo.add("threads", threads);
+
+        ReprojectionFilter filter;
+        filter.setOptions(fo);
+        filter.setInput(reader);
+
+        PointTable table;
+        filter.prepare(table);
+        PointViewSet viewSet = filter.execute(table);
+        EXPECT_EQ(viewSet.size(), 1u);
+        return *viewSet.begin();
+    };
+
+    PointViewPtr v1 = run(1);
+    PointViewPtr v4 = run(4);
+    ASSERT_EQ(v1->size(), 50000u);
+    ASSERT_EQ(v4->size(), v1->size());
+    for (PointId i = 0; i < v1->size(); ++i)
+    {
+        EXPECT_EQ(v1->getFieldAs<double>(Dimension::Id::X, i),
+            v4->getFieldAs<double>(Dimension::Id::X, i));
+        EXPECT_EQ(v1->getFieldAs<double>(Dimension::Id::Y, i),
+            v4->getFieldAs<double>(Dimension::Id::Y, i));
+        EXPECT_EQ(v1->getFieldAs<double>(Dimension::Id::Z, i),
+            v4->getFieldAs<double>(Dimension::Id::Z, i));
+    }
+    EXPECT_NEAR(v1->getFieldAs<double>(Dimension::Id::X, 0), -93.3, .2);
+}
+
+// Transforms released on one thread are reused or cloned by transforms
+// created on others.  The results must not change.
+TEST(ReprojectionFilterTest, cachedTransforms)
+{
+    SpatialReference src("EPSG:4326");
+    SpatialReference dst("EPSG:26915");
+
+    double x0(-93.35), y0(44.9), z0(0);
+    {
+        SrsTransform t(src, dst);
+        ASSERT_TRUE(t.transform(x0, y0, z0));
+    }
+
+    std::vector<std::thread> threads;
+    std::vector<double> xs(4), ys(4);
+    std::vector<int> ok(4);
+    for (size_t i = 0; i < 4; ++i)
+        threads.emplace_back([&, i]()
+        {
+            for (int j = 0; j < 10; ++j)
+            {
+                SrsTransform t(src, dst);
+                double x(-93.35), y(44.9), z(0);
+                ok[i] = t.transform(x, y, z);
+                xs[i] = x;
+                ys[i] = y;
+            }
+        });
+    for (std::thread& t : threads)
+        t.join();
+
+    for (size_t i = 0; i < 4; ++i)
+    {
+        EXPECT_TRUE(ok[i]);
+        EXPECT_DOUBLE_EQ(xs[i], x0);
+        EXPECT_DOUBLE_EQ(ys[i], y0);
+    }
+}
@@ -37,6 +37,7 @@
 #include <pdal/PointView.hpp>
 #include <pdal/StageFactory.hpp>
 #include <pdal/PipelineManager.hpp>
+#include <filters/StreamCallbackFilter.hpp>
 #include "Support.hpp"
 
 using namespace pdal;
@@ -87,3 +88,44 @@ TEST(ReturnsFilterTest, t1)
     }
 }
 
+TEST(ReturnsFilterTest, stream)
+{
+    StageFactory f;
+
+    Stage *reader(f.createStage("readers.las"));
+    Options rOpts;
+    rOpts.add("filename", Support::datapath("las/autzen_trim.las"));
+    reader->setOptions(rOpts);
+
+    Stage* filter(f.createStage("filters.returns"));
+    Options fOpts;
+    fOpts.add("groups", "last, first");
+    filter->setOptions(fOpts);
+    filter->setInput(*reader);
+
+    // The points of both groups are passed on together.
+    point_count_t first = 0;
+    point_count_t last = 0;
+    StreamCallbackFilter callback;
+    callback.setCallback([&first, &last](PointRef& point)
+        {
+            uint8_t rn = point.getFieldAs<uint8_t>(Dimension::Id::ReturnNumber);
+            uint8_t nr =
+                point.getFieldAs<uint8_t>(Dimension::Id::NumberOfReturns);
+            EXPECT_NE(nr, 1);
+            if (rn == 1)
+                first++;
+            else if (rn == nr)
+                last++;
+            else
+                ADD_FAILURE() << "Unexpected return " << (int)rn;
+            return true;
+        });
+    callback.setInput(*filter);
+
+    FixedPointTable t(1000);
+    callback.prepare(t);
+    callback.execute(t);
+    EXPECT_EQ(first, 9036U);
+    EXPECT_EQ(last, 9015U);
+}
@@ -94,3 +94,59 @@ TEST(SMRFFilterTest, noreturns)
     EXPECT_EQ(classCount.size(), 1U);
     EXPECT_EQ(classCount[ClassLabel::Ground], 10);
 }
+
+namespace
+{
+
+std::vector<uint8_t> smrfClasses(const Options& smrfOpts)
+{
+    StageFactory factory;
+
+    Stage *r = factory.createStage("readers.las");
+    Options rOpts;
+    rOpts.add("filename", Support::datapath("las/autzen_trim.las"));
+    r->setOptions(rOpts);
+
+    Stage *f = factory.createStage("filters.smrf");
+    f->setOptions(smrfOpts);
+    f->setInput(*r);
+
+    PointTable t;
+    f->prepare(t);
+    PointViewSet s = f->execute(t);
+    EXPECT_EQ(s.size(), 1U);
+    PointViewPtr v = *s.begin();
+
+    std::vector<uint8_t> classes;
+    for (PointId idx = 0; idx < v->size(); ++idx)
+        classes.push_back(
+            v->getFieldAs<uint8_t>(Dimension::Id::Classification, idx));
+    return classes;
+}
+
+} // unnamed namespace
+
+TEST(SMRFilterTest, tiled)
+{
+    std::vector<uint8_t> whole = smrfClasses(Options());
+
+    // With a buffer covering the whole extent, every tile sees all of the
+    // points and the classification is unchanged.
+    Options opts;
+    opts.add("tile_size", 600.0);
+    opts.add("buffer", 10000.0);
+    opts.add("threads", 3);
+    EXPECT_EQ(whole, smrfClasses(opts));
+
+    // With the default buffer, results match away from the tile edges.
+    Options tiled;
+    tiled.add("tile_size", 300.0);
+    tiled.add("threads", 3);
+    std::vector<uint8_t> tileClasses = smrfClasses(tiled);
+    ASSERT_EQ(whole.size(), tileClasses.size());
+    size_t same = 0;
+    for (size_t i = 0; i < whole.size(); ++i)
+        if (whole[i] == tileClasses[i])
+            same++;
+    EXPECT_GT(same, whole.size() * 99 / 100);
+}
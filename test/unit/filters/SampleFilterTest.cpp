@@ -0,0 +1,190 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <pdal/PointView.hpp>
+#include <pdal/StageFactory.hpp>
+#include <io/FauxReader.hpp>
+#include <filters/SampleFilter.hpp>
+#include <filters/StreamCallbackFilter.hpp>
+
+using namespace pdal;
+
+namespace
+{
+
+Options readerOptions()
+{
+    Options ops;
+    ops.add("bounds", BOX3D(0, 0, 0, 100, 100, 10));
+    ops.add("mode", "random");
+    ops.add("count", 5000);
+    ops.add("seed", 12);
+    return ops;
+}
+
+PointViewPtr sample(const Options& filterOps)
+{
+    FauxReader reader;
+    reader.setOptions(readerOptions());
+
+    SampleFilter filter;
+    filter.setOptions(filterOps);
+    filter.setInput(reader);
+
+    PointTable table;
+    filter.prepare(table);
+    PointViewSet s = filter.execute(table);
+    EXPECT_EQ(s.size(), 1u);
+    return *s.begin();
+}
+
+double dist2(const PointView& a, PointId i, const PointView& b, PointId j)
+{
+    using namespace Dimension;
+
+    double dx = a.getFieldAs<double>(Id::X, i) - b.getFieldAs<double>(Id::X, j);
+    double dy = a.getFieldAs<double>(Id::Y, i) - b.getFieldAs<double>(Id::Y, j);
+    double dz = a.getFieldAs<double>(Id::Z, i) - b.getFieldAs<double>(Id::Z, j);
+    return dx * dx + dy * dy + dz * dz;
+}
+
+// Check that samples are at least 'radius' apart and that every input point
+// is closer than 'radius' to some sample.
+void checkSamples(const PointView& in, const PointView& out, double radius)
+{
+    const double r2 = radius * radius;
+    for (PointId i = 0; i < out.size(); ++i)
+        for (PointId j = i + 1; j < out.size(); ++j)
+            ASSERT_GE(dist2(out, i, out, j), r2);
+
+    for (PointId i = 0; i < in.size(); ++i)
+    {
+        bool covered = false;
+        for (PointId j = 0; !covered && j < out.size(); ++j)
+            covered = dist2(in, i, out, j) < r2;
+        ASSERT_TRUE(covered);
+    }
+}
+
+} // unnamed namespace
+
+TEST(SampleFilterTest, create)
+{
+    StageFactory f;
+    Stage* filter(f.createStage("filters.sample"));
+    EXPECT_TRUE(filter);
+}
+
+TEST(SampleFilterTest, sample)
+{
+    FauxReader reader;
+    reader.setOptions(readerOptions());
+    PointTable table;
+    reader.prepare(table);
+    PointViewPtr in = *reader.execute(table).begin();
+
+    Options ops;
+    ops.add("radius", 5.0);
+    PointViewPtr out = sample(ops);
+    EXPECT_GT(out->size(), 0u);
+    EXPECT_LT(out->size(), in->size());
+    checkSamples(*in, *out, 5.0);
+
+    // Samples are the first points, in order, that are clear of the
+    // samples before them.
+    PointId j = 0;
+    for (PointId i = 0; i < in->size(); ++i)
+    {
+        bool clear = true;
+        for (PointId k = 0; clear && k < j; ++k)
+            clear = dist2(*in, i, *out, k) >= 25.0;
+        if (clear)
+        {
+            ASSERT_LT(j, out->size());
+            EXPECT_EQ(dist2(*in, i, *out, j), 0.0);
+            j++;
+        }
+    }
+    EXPECT_EQ(j, out->size());
+
+    // Phased sampling picks different points, but the same ones no matter
+    // the number of threads.
+    ops.add("threads", 2);
+    PointViewPtr out2 = sample(ops);
+    checkSamples(*in, *out2, 5.0);
+    ops.replace("threads", 5);
+    PointViewPtr out5 = sample(ops);
+    ASSERT_EQ(out2->size(), out5->size());
+    for (PointId i = 0; i < out2->size(); ++i)
+        EXPECT_EQ(dist2(*out2, i, *out5, i), 0.0);
+}
+
+TEST(SampleFilterTest, stream)
+{
+    Options ops;
+    ops.add("radius", 5.0);
+    PointViewPtr out = sample(ops);
+
+    FauxReader reader;
+    reader.setOptions(readerOptions());
+
+    SampleFilter sampler;
+    sampler.setOptions(ops);
+    sampler.setInput(reader);
+
+    PointId idx = 0;
+    auto cb = [&out, &idx](PointRef& point)
+    {
+        using namespace Dimension;
+
+        EXPECT_LT(idx, out->size());
+        EXPECT_EQ(point.getFieldAs<double>(Id::X),
+            out->getFieldAs<double>(Id::X, idx));
+        EXPECT_EQ(point.getFieldAs<double>(Id::Y),
+            out->getFieldAs<double>(Id::Y, idx));
+        EXPECT_EQ(point.getFieldAs<double>(Id::Z),
+            out->getFieldAs<double>(Id::Z, idx));
+        idx++;
+        return true;
+    };
+    StreamCallbackFilter filter;
+    filter.setCallback(cb);
+    filter.setInput(sampler);
+
+    FixedPointTable t(100);
+    filter.prepare(t);
+    filter.execute(t);
+    EXPECT_EQ(idx, out->size());
+}
@@ -49,13 +49,14 @@ namespace
 {
 
 void doSort(point_count_t count, Dimension::Id dim,
-    const std::string & order="")
+    const std::string & order="", unsigned threads = 1)
 {
     Options opts;
 
     opts.add("dimension", Dimension::name(dim));
     if (!order.empty())
         opts.add("order", order);
+    opts.add("threads", threads);
 
     SortFilter filter;
     filter.setOptions(opts);
@@ -169,3 +170,60 @@ TEST(SortFilterTest, issue1121_simpleSortOrderDesc)
     }
 }
 
+
+TEST(SortFilterTest, threads)
+{
+    doSort(200000, Dimension::Id::X, "ASC", 4);
+    doSort(200000, Dimension::Id::X, "DESC", 4);
+}
+
+// Integer dimensions, negative values and stability of equal values.
+TEST(SortFilterTest, integerStable)
+{
+    SortFilter filter;
+    Options opts;
+    opts.add("dimension", "PointSourceId");
+    opts.add("order", "DESC");
+    filter.setOptions(opts);
+
+    PointTable table;
+    table.layout()->registerDim(Dimension::Id::PointSourceId);
+    table.layout()->registerDim(Dimension::Id::Z);
+    table.finalize();
+    PointViewPtr view(new PointView(table));
+
+    for (PointId i = 0; i < 1000; ++i)
+    {
+        view->setField(Dimension::Id::PointSourceId, i, (i * 7919) % 13);
+        view->setField(Dimension::Id::Z, i, -(double)i);
+    }
+
+    filter.prepare(table);
+    FilterWrapper::ready(filter, table);
+    FilterWrapper::filter(filter, *view.get());
+    FilterWrapper::done(filter, table);
+
+    ASSERT_EQ(view->size(), 1000u);
+    for (PointId i = 1; i < view->size(); ++i)
+    {
+        int s1 = view->getFieldAs<int>(Dimension::Id::PointSourceId, i - 1);
+        int s2 = view->getFieldAs<int>(Dimension::Id::PointSourceId, i);
+        EXPECT_GE(s1, s2);
+        if (s1 == s2)
+            EXPECT_GT(view->getFieldAs<double>(Dimension::Id::Z, i - 1),
+                view->getFieldAs<double>(Dimension::Id::Z, i));
+    }
+
+    // Sort on a negative floating-point dimension restores input order.
+    SortFilter zFilter;
+    Options zOpts;
+    zOpts.add("dimension", "Z");
+    zOpts.add("order", "DESC");
+    zFilter.setOptions(zOpts);
+    zFilter.prepare(table);
+    FilterWrapper::ready(zFilter, table);
+    FilterWrapper::filter(zFilter, *view.get());
+    FilterWrapper::done(zFilter, table);
+    for (PointId i = 0; i < view->size(); ++i)
+        EXPECT_EQ(view->getFieldAs<double>(Dimension::Id::Z, i), -(double)i);
+}
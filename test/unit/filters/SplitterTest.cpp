@@ -211,3 +211,42 @@ TEST(SplitterTest, test_buffer2)
         EXPECT_EQ(v->size(), counts[i++]);
 }
 
+
+// Splitting on several threads gives the same views, in the same order, as
+// splitting on one.
+TEST(SplitterTest, threads)
+{
+    auto split = [](int threads)
+    {
+        Options readerOptions;
+        readerOptions.add("filename",
+            Support::datapath("las/1.2-with-color.las"));
+        LasReader reader;
+        reader.setOptions(readerOptions);
+
+        Options splitterOptions;
+        splitterOptions.add("length", 1000);
+        splitterOptions.add("buffer", 20);
+        splitterOptions.add("threads", threads);
+
+        SplitterFilter splitter;
+        splitter.setOptions(splitterOptions);
+        splitter.setInput(reader);
+
+        PointTable table;
+        splitter.prepare(table);
+        std::vector<std::vector<double>> views;
+        for (PointViewPtr v : splitter.execute(table))
+        {
+            views.emplace_back();
+            for (PointId i = 0; i < v->size(); ++i)
+                views.back().push_back(
+                    v->getFieldAs<double>(Dimension::Id::X, i));
+        }
+        return views;
+    };
+
+    std::vector<std::vector<double>> views = split(1);
+    EXPECT_EQ(views.size(), 24u);
+    EXPECT_EQ(split(3), views);
+}
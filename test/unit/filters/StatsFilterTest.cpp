@@ -435,3 +435,63 @@ TEST(Stats, global)
 	EXPECT_DOUBLE_EQ(statsZ.maximum(), 1000.0);
 
 }
+
+TEST(Stats, globalApproximate)
+{
+    BOX3D bounds(1.0, 0.0, 0.0, 10.0, 100.0, 1000.0);
+    Options ops;
+    ops.add("bounds", bounds);
+    ops.add("count", 100001);
+    ops.add("mode", "ramp");
+
+    FauxReader reader;
+    reader.setOptions(ops);
+
+    Options filterOps;
+    filterOps.add("dimensions", "Z");
+    filterOps.add("global", "Z");
+    filterOps.add("global_error", .01);
+
+    StatsFilter filter;
+    filter.setInput(reader);
+    filter.setOptions(filterOps);
+
+    FixedPointTable table(1000);
+    filter.prepare(table);
+    filter.execute(table);
+
+    const stats::Summary& statsZ = filter.getStats(Dimension::Id::Z);
+    EXPECT_NEAR(statsZ.median(), 500.0, 10.0);
+    EXPECT_NEAR(statsZ.mad(), 250.0, 10.0);
+    EXPECT_DOUBLE_EQ(statsZ.minimum(), 0.0);
+    EXPECT_DOUBLE_EQ(statsZ.maximum(), 1000.0);
+}
+
+TEST(Stats, merge)
+{
+    stats::Summary all("Z", stats::Summary::Global, true);
+    stats::Summary first("Z", stats::Summary::Global, true);
+    stats::Summary second("Z", stats::Summary::Global, true);
+    for (int i = 0; i < 1000; ++i)
+    {
+        double v = std::sqrt((double)i) + (i % 7);
+        all.insert(v);
+        if (i < 300)
+            first.insert(v);
+        else
+            second.insert(v);
+    }
+    first.merge(second);
+    all.computeGlobalStats();
+    first.computeGlobalStats();
+
+    EXPECT_EQ(first.count(), all.count());
+    EXPECT_DOUBLE_EQ(first.minimum(), all.minimum());
+    EXPECT_DOUBLE_EQ(first.maximum(), all.maximum());
+    EXPECT_NEAR(first.average(), all.average(), 1e-9);
+    EXPECT_NEAR(first.variance(), all.variance(), 1e-9);
+    EXPECT_NEAR(first.skewness(), all.skewness(), 1e-9);
+    EXPECT_NEAR(first.kurtosis(), all.kurtosis(), 1e-9);
+    EXPECT_DOUBLE_EQ(first.median(), all.median());
+    EXPECT_DOUBLE_EQ(first.mad(), all.mad());
+}
@@ -36,6 +36,7 @@
 
 #include <pdal/StageFactory.hpp>
 #include <io/FauxReader.hpp>
+#include <filters/StreamCallbackFilter.hpp>
 #include <filters/TransformationFilter.hpp>
 #include "Support.hpp"
 
@@ -247,4 +248,119 @@ TEST(TransformationMatrix, init_file_multiline)
 }
 
 
+// The batched path on several threads gives the same results as the
+// per-point path used in stream mode.
+TEST(TransformationFilter, threads)
+{
+    auto run = [](bool stream, int threads)
+    {
+        FauxReader reader;
+        Options readerOpts;
+        readerOpts.add("mode", "ramp");
+        readerOpts.add("count", 20000);
+        readerOpts.add("bounds", BOX3D(-100, -50, 10, 400, 250, 90));
+        reader.setOptions(readerOpts);
+
+        TransformationFilter filter;
+        Options filterOpts;
+        filterOpts.add("matrix",
+            "0.5 0.8 0.1 10\n-0.8 0.5 0.2 20\n0.1 -0.2 0.9 30\n0 0 0 1");
+        filterOpts.add("threads", threads);
+        filter.setOptions(filterOpts);
+        filter.setInput(reader);
+
+        std::vector<double> out;
+        auto collect = [&out](PointRef& p)
+        {
+            out.push_back(p.getFieldAs<double>(Dimension::Id::X));
+            out.push_back(p.getFieldAs<double>(Dimension::Id::Y));
+            out.push_back(p.getFieldAs<double>(Dimension::Id::Z));
+        };
+
+        if (stream)
+        {
+            FixedPointTable table(1000);
+            filter.prepare(table);
+            StreamCallbackFilter cb;
+            cb.setCallback([&collect](PointRef& p)
+                { collect(p); return true; });
+            cb.setInput(filter);
+            cb.prepare(table);
+            cb.execute(table);
+        }
+        else
+        {
+            PointTable table;
+            filter.prepare(table);
+            PointViewPtr v = *filter.execute(table).begin();
+            for (PointRef p : *v)
+                collect(p);
+        }
+        return out;
+    };
+
+    std::vector<double> expected = run(true, 1);
+    EXPECT_EQ(expected.size(), 60000u);
+    EXPECT_EQ(run(false, 1), expected);
+    EXPECT_EQ(run(false, 4), expected);
+}
+
+// A transformation followed by a reprojection is applied by the
+// reprojection.  The results are the same as when they run separately.
+TEST(TransformationFilter, fusedReprojection)
+{
+    auto run = [](bool separate)
+    {
+        StageFactory f;
+
+        Options readerOpts;
+        readerOpts.add("mode", "ramp");
+        readerOpts.add("count", 5000);
+        readerOpts.add("bounds", BOX3D(-93.5, 42.0, 0, -93.0, 42.5, 100));
+        readerOpts.add("override_srs", "EPSG:4326");
+        Stage *reader = f.createStage("readers.faux");
+        reader->setOptions(readerOpts);
+
+        Options xformOpts;
+        xformOpts.add("matrix", "1 0 0 0.01\n0 1 0 -0.02\n0 0 1 5\n0 0 0 1");
+        Stage *xform = f.createStage("filters.transformation");
+        xform->setOptions(xformOpts);
+        xform->setInput(*reader);
+
+        // Decimation with a step of one passes every point, but keeps the
+        // transformation from immediately preceding the reprojection.
+        Stage *prev = xform;
+        if (separate)
+        {
+            prev = f.createStage("filters.decimation");
+            prev->setInput(*xform);
+        }
+
+        Options reproOpts;
+        reproOpts.add("out_srs", "EPSG:26915");
+        Stage *repro = f.createStage("filters.reprojection");
+        repro->setOptions(reproOpts);
+        repro->setInput(*prev);
+
+        PointTable table;
+        repro->prepare(table);
+        PointViewPtr v = *repro->execute(table).begin();
+        EXPECT_EQ(dynamic_cast<TransformationFilter *>(xform)->fused(),
+            !separate);
+
+        std::vector<double> out;
+        for (PointRef p : *v)
+        {
+            out.push_back(p.getFieldAs<double>(Dimension::Id::X));
+            out.push_back(p.getFieldAs<double>(Dimension::Id::Y));
+            out.push_back(p.getFieldAs<double>(Dimension::Id::Z));
+        }
+        return out;
+    };
+
+    std::vector<double> fused = run(false);
+    EXPECT_EQ(fused.size(), 15000u);
+    EXPECT_EQ(fused, run(true));
+}
+
 }
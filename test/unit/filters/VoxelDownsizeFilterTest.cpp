@@ -140,6 +140,27 @@ void origin_test(std::string mode)
             id++;
         }
     }
+    else if (mode == "centroid")
+    {
+        // The first point shares its voxel with the last one.
+        PointId id = 0;
+        for (PointRef p : *v)
+        {
+            double tx = plist[id][0];
+            double ty = plist[id][1];
+            double tz = plist[id][2];
+            if (id == 0)
+            {
+                tx = 3;
+                ty = 3;
+                tz = 3;
+            }
+            EXPECT_EQ(tx, p.getFieldAs<double>(Dimension::Id::X));
+            EXPECT_EQ(ty, p.getFieldAs<double>(Dimension::Id::Y));
+            EXPECT_EQ(tz, p.getFieldAs<double>(Dimension::Id::Z));
+            id++;
+        }
+    }
 }
 
 void stream_test(std::string mode)
@@ -261,6 +282,11 @@ TEST(VoxelDownsizeFilter, voxelcenter_origin)
     origin_test("center");
 }
 
+TEST(VoxelDownsizeFilter, voxelcentroid_origin)
+{
+    origin_test("centroid");
+}
+
 TEST(VoxelDownsizeFilter, firstinvoxel_standard)
 {
     standard_test("first");
@@ -271,6 +297,11 @@ TEST(VoxelDownsizeFilter, voxelcenter_standard)
     standard_test("center");
 }
 
+TEST(VoxelDownsizeFilter, voxelcentroid_standard)
+{
+    standard_test("centroid");
+}
+
 TEST(VoxelDownsizeFilter, firstinvoxel_stream)
 {
     stream_test("first");
@@ -282,4 +313,39 @@ TEST(VoxelDownsizeFilter, voxelcenter_stream)
     stream_test("center");
 }
 
+// A voxel revisited after its region has been evicted is retained again.
+TEST(VoxelDownsizeFilter, evict)
+{
+    auto run = [](uint64_t evictAfter)
+    {
+        PointTable t;
+        t.layout()->registerDims({Id::X, Id::Y, Id::Z});
+        PointViewPtr v(new PointView(t));
+
+        PointId id = 0;
+        v->setField(Id::X, id++, 0);
+        for (int i = 0; i < 10; ++i)
+            v->setField(Id::X, id++, 1000 + i);
+        v->setField(Id::X, id++, 0.1);
+
+        BufferReader r;
+        r.addView(v);
+
+        VoxelDownsizeFilter f;
+        Options o;
+        o.add("cell", 1);
+        o.add("mode", "first");
+        o.add("evict_after", evictAfter);
+        f.setOptions(o);
+        f.setInput(r);
+
+        f.prepare(t);
+        PointViewSet s = f.execute(t);
+        return (*s.begin())->size();
+    };
+
+    EXPECT_EQ(run(0), 11u);
+    EXPECT_EQ(run(5), 12u);
+}
+
 } // namespace
@@ -37,6 +37,10 @@
 #include "Support.hpp"
 #include "io/BpfSupport.hpp"
 
+#include <filters/StreamCallbackFilter.hpp>
+#include <io/FauxReader.hpp>
+#include <io/TextWriter.hpp>
+
 using namespace pdal;
 
 TEST(BpfTestBase, test_point_major)
@@ -57,6 +61,172 @@ TEST(BpfTestBase, test_byte_major)
         Support::datapath("bpf/autzen-utm-chipped-25-v3-segregated.bpf"));
 }
 
+// Reading points ahead of decoding must match reading from the stream
+// for each point layout.
+TEST(BpfTestBase, readAhead)
+{
+    auto read = [](PointTableRef table, const std::string& file, int ahead)
+    {
+        Options ops;
+        ops.add("filename", Support::datapath(file));
+        ops.add("read_ahead", ahead);
+
+        BpfReader reader;
+        reader.setOptions(ops);
+        reader.prepare(table);
+        PointViewSet s = reader.execute(table);
+        return *s.begin();
+    };
+
+    for (std::string file : { "bpf/autzen-utm-chipped-25-v3-interleaved.bpf",
+        "bpf/autzen-utm-chipped-25-v3.bpf",
+        "bpf/autzen-utm-chipped-25-v3-segregated.bpf" })
+    {
+        PointTable t1;
+        PointViewPtr view1 = read(t1, file, 0);
+        PointTable t2;
+        PointViewPtr view2 = read(t2, file, 2);
+        ASSERT_EQ(view1->size(), view2->size());
+
+        DimTypeList dims = view1->dimTypes();
+        size_t pointSize = view1->pointSize();
+        std::vector<char> buf1(pointSize);
+        std::vector<char> buf2(pointSize);
+        for (PointId i = 0; i < view1->size(); ++i)
+        {
+            view1->getPackedPoint(dims, i, buf1.data());
+            view2->getPackedPoint(dims, i, buf2.data());
+            EXPECT_EQ(memcmp(buf1.data(), buf2.data(), pointSize), 0);
+        }
+    }
+}
+
+// A query returns the points in its bounds or polygon whether or not the
+// file has a chunk bounds index, for each point layout.
+TEST(BpfTestBase, chunkBounds)
+{
+    std::string outfile(Support::temppath("chunks.bpf"));
+
+    // Grid points are ordered by row, so chunks are bands of rows.
+    auto write = [&outfile](const std::string& format, bool chunkBounds)
+    {
+        Options fauxOps;
+        fauxOps.add("mode", "grid");
+        fauxOps.add("bounds", BOX3D(0, 0, 0, 300, 100, 0));
+        FauxReader faux;
+        faux.setOptions(fauxOps);
+
+        Options ops;
+        ops.add("filename", outfile);
+        ops.add("format", format);
+        ops.add("chunk_bounds", chunkBounds);
+        BpfWriter writer;
+        writer.setOptions(ops);
+        writer.setInput(faux);
+
+        FileUtils::deleteFile(outfile);
+        PointTable table;
+        writer.prepare(table);
+        writer.execute(table);
+    };
+
+    auto check = [&outfile](const std::string& option,
+        const std::string& value)
+    {
+        Options ops;
+        ops.add("filename", outfile);
+        ops.add(option, value);
+
+        BpfReader reader;
+        reader.setOptions(ops);
+        PointTable table;
+        reader.prepare(table);
+        PointViewSet s = reader.execute(table);
+        PointViewPtr view = *s.begin();
+        EXPECT_EQ(view->size(), 9000u);
+        for (PointId i = 0; i < view->size(); ++i)
+            EXPECT_GE(view->getFieldAs<double>(Dimension::Id::Y, i), 70);
+
+        BpfReader reader2;
+        reader2.setOptions(ops);
+        StreamCallbackFilter f;
+        f.setInput(reader2);
+        point_count_t count = 0;
+        f.setCallback([&count](PointRef& point)
+        {
+            EXPECT_GE(point.getFieldAs<double>(Dimension::Id::Y), 70);
+            count++;
+            return true;
+        });
+        FixedPointTable t2(1000);
+        f.prepare(t2);
+        f.execute(t2);
+        EXPECT_EQ(count, 9000u);
+    };
+
+    for (std::string format : { "POINT", "DIMENSION", "BYTE" })
+        for (bool chunkBounds : { false, true })
+        {
+            write(format, chunkBounds);
+            check("bounds", "([0, 300], [69.5, 100])");
+            check("polygon",
+                "POLYGON ((-1 69.5, 301 69.5, 301 101, -1 101, -1 69.5))");
+        }
+}
+
+// Dimensions not used by the stages that follow the reader aren't read.
+TEST(BpfTestBase, requiredDims)
+{
+    auto run = [](const std::string& file, bool allDims)
+    {
+        Options readerOps;
+        readerOps.add("filename", Support::datapath(file));
+        BpfReader reader;
+        reader.setOptions(readerOps);
+
+        Options writerOps;
+        writerOps.add("filename", Support::temppath("required.txt"));
+        writerOps.add("order", "X,Y,Z");
+        writerOps.add("keep_unspecified", allDims);
+        TextWriter writer;
+        writer.setOptions(writerOps);
+        writer.setInput(reader);
+
+        PointTable table;
+        writer.prepare(table);
+        PointViewSet s = writer.execute(table);
+        FileUtils::deleteFile(Support::temppath("required.txt"));
+
+        PointViewPtr v = *s.begin();
+        double xyz(0);
+        double other(0);
+        for (PointId i = 0; i < v->size(); ++i)
+            for (Dimension::Id id : v->dims())
+            {
+                double d = std::fabs(v->getFieldAs<double>(id, i));
+                if (id == Dimension::Id::X || id == Dimension::Id::Y ||
+                    id == Dimension::Id::Z)
+                    xyz += d;
+                else
+                    other += d;
+            }
+        return std::make_pair(xyz, other);
+    };
+
+    for (const std::string file :
+        { "bpf/autzen-utm-chipped-25-v3-interleaved.bpf",
+          "bpf/autzen-utm-chipped-25-v3.bpf",
+          "bpf/autzen-utm-chipped-25-v3-segregated.bpf" })
+    {
+        auto all = run(file, true);
+        auto required = run(file, false);
+
+        EXPECT_DOUBLE_EQ(all.first, required.first);
+        EXPECT_NE(all.second, 0);
+        EXPECT_EQ(required.second, 0);
+    }
+}
+
 TEST(BpfTestBase, roundtrip_byte)
 {
     Options ops;
@@ -394,6 +564,72 @@ TEST(BpfTestBase, flex2)
     EXPECT_EQ(r.preview().m_pointCount, 1065u);
 }
 
+// Files for separate views are written concurrently when the pipeline has
+// threads.  They must be numbered, and their metadata listed, in the order
+// of the views, as when they're written one at a time.
+TEST(BpfTestBase, flexThreads)
+{
+    Options readerOps;
+    readerOps.add("filename",
+        Support::datapath("bpf/autzen-utm-chipped-25-v3.bpf"));
+
+    PointTable table;
+
+    BpfReader reader;
+    reader.setOptions(readerOps);
+
+    reader.prepare(table);
+    PointViewSet views = reader.execute(table);
+    PointViewPtr v = *(views.begin());
+
+    PointViewPtr v1(new PointView(table));
+    PointViewPtr v2(new PointView(table));
+    PointViewPtr v3(new PointView(table));
+    for (PointId i = 0; i < v->size(); ++i)
+        (i < 100 ? v1 : i < 400 ? v2 : v3)->appendPoint(*v, i);
+
+    auto write = [&](const std::string& pattern, std::size_t threads)
+    {
+        BufferReader r;
+        r.addView(v1);
+        r.addView(v2);
+        r.addView(v3);
+
+        Options writerOps;
+        writerOps.add("filename", Support::temppath(pattern));
+
+        BpfWriter w;
+        w.setOptions(writerOps);
+        w.setInput(r);
+
+        w.prepare(table);
+        w.execute(table, threads);
+        return w.getMetadata().children("filename");
+    };
+
+    MetadataNodeList serial = write("serial_#.bpf", 1);
+    MetadataNodeList concurrent = write("concurrent_#.bpf", 3);
+    ASSERT_EQ(concurrent.size(), 3u);
+
+    const point_count_t counts[] = { 100, 300, 665 };
+    for (size_t i = 0; i < 3; ++i)
+    {
+        std::string num = std::to_string(i + 1);
+        std::string filename = Support::temppath("concurrent_" + num + ".bpf");
+        EXPECT_EQ(concurrent[i].value(), filename);
+        EXPECT_EQ(serial[i].value(),
+            Support::temppath("serial_" + num + ".bpf"));
+        EXPECT_TRUE(Support::compare_files(serial[i].value(), filename));
+
+        Options ops;
+        ops.add("filename", filename);
+
+        BpfReader r;
+        r.setOptions(ops);
+        EXPECT_EQ(r.preview().m_pointCount, counts[i]);
+    }
+}
+
 TEST(BpfTestBase, outputdims)
 {
     Options ops;
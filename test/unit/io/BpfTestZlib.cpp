@@ -87,3 +87,42 @@ TEST(BpfTestZlib, roundtrip_point_compression)
     test_roundtrip(ops);
 }
 
+
+TEST(BpfTestZlib, roundtrip_dimension_compression_threaded)
+{
+    Options ops;
+
+    ops.add("format", "DIMENSION");
+    ops.add("compression", true);
+    ops.add("threads", 4);
+    test_roundtrip(ops);
+}
+
+TEST(BpfTestZlib, threaded_read)
+{
+    auto read = [](int threads)
+    {
+        Options ops;
+        ops.add("filename",
+            Support::datapath("bpf/autzen-utm-chipped-25-v3-deflate.bpf"));
+        ops.add("threads", threads);
+
+        std::shared_ptr<PointTable> table(new PointTable);
+        BpfReader reader;
+        reader.setOptions(ops);
+        reader.prepare(*table);
+        PointViewSet s = reader.execute(*table);
+        EXPECT_EQ(s.size(), 1u);
+        return std::make_pair(table, *s.begin());
+    };
+
+    auto single = read(1);
+    auto threaded = read(4);
+    PointViewPtr v1 = single.second;
+    PointViewPtr v4 = threaded.second;
+    ASSERT_EQ(v1->size(), v4->size());
+    for (PointId i = 0; i < v1->size(); ++i)
+        for (Dimension::Id dim : v1->dims())
+            EXPECT_EQ(v1->getFieldAs<double>(dim, i),
+                v4->getFieldAs<double>(dim, i));
+}
@@ -0,0 +1,208 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <pdal/PointView.hpp>
+#include <pdal/util/FileUtils.hpp>
+#include <filters/StreamCallbackFilter.hpp>
+#include <io/CopcReader.hpp>
+#include <io/CopcWriter.hpp>
+#include <io/LasReader.hpp>
+#include "Support.hpp"
+
+using namespace pdal;
+
+namespace
+{
+
+class CopcReaderTest : public ::testing::Test
+{
+protected:
+    static void SetUpTestCase()
+    {
+        m_file = Support::temppath("copcreader.laz");
+        FileUtils::deleteFile(m_file);
+
+        Options readerOps;
+        readerOps.add("filename", Support::datapath("las/autzen_trim.las"));
+        LasReader reader;
+        reader.setOptions(readerOps);
+
+        // Small nodes so that the tree has a few levels.
+        Options writerOps;
+        writerOps.add("filename", m_file);
+        writerOps.add("max_node_points", 10000);
+        CopcWriter writer;
+        writer.setOptions(writerOps);
+        writer.setInput(reader);
+
+        PointTable table;
+        writer.prepare(table);
+        PointViewSet s = writer.execute(table);
+        PointViewPtr view = *s.begin();
+        view->calculateBounds(m_bounds);
+
+        BOX2D box(quarter());
+        m_quarterCount = 0;
+        for (PointId id = 0; id < view->size(); ++id)
+            if (box.contains(view->getFieldAs<double>(Dimension::Id::X, id),
+                    view->getFieldAs<double>(Dimension::Id::Y, id)))
+                m_quarterCount++;
+    }
+
+    static void TearDownTestCase()
+    {
+        FileUtils::deleteFile(m_file);
+    }
+
+    // The bounds of the south-west quarter of the data.
+    static BOX2D quarter()
+    {
+        return BOX2D(m_bounds.minx, m_bounds.miny,
+            m_bounds.minx + (m_bounds.maxx - m_bounds.minx) / 2,
+            m_bounds.miny + (m_bounds.maxy - m_bounds.miny) / 2);
+    }
+
+    static std::string m_file;
+    static BOX3D m_bounds;
+    static point_count_t m_quarterCount;
+};
+
+std::string CopcReaderTest::m_file;
+BOX3D CopcReaderTest::m_bounds;
+point_count_t CopcReaderTest::m_quarterCount;
+
+} // unnamed namespace
+
+TEST_F(CopcReaderTest, read)
+{
+    Options ops;
+    ops.add("filename", m_file);
+    CopcReader reader;
+    reader.setOptions(ops);
+
+    PointTable table;
+    reader.prepare(table);
+    PointViewSet s = reader.execute(table);
+    PointViewPtr view = *s.begin();
+    ASSERT_EQ(view->size(), 110000u);
+
+    BOX3D bounds;
+    view->calculateBounds(bounds);
+    EXPECT_NEAR(bounds.minx, m_bounds.minx, .01);
+    EXPECT_NEAR(bounds.maxx, m_bounds.maxx, .01);
+    EXPECT_NEAR(bounds.miny, m_bounds.miny, .01);
+    EXPECT_NEAR(bounds.maxy, m_bounds.maxy, .01);
+    EXPECT_NEAR(bounds.minz, m_bounds.minz, .01);
+    EXPECT_NEAR(bounds.maxz, m_bounds.maxz, .01);
+
+    QuickInfo qi = reader.preview();
+    EXPECT_EQ(qi.m_pointCount, 110000u);
+}
+
+TEST_F(CopcReaderTest, bounds)
+{
+    BOX2D box(quarter());
+
+    Options ops;
+    ops.add("filename", m_file);
+    ops.add("bounds", box);
+    CopcReader reader;
+    reader.setOptions(ops);
+
+    PointTable table;
+    reader.prepare(table);
+    PointViewSet s = reader.execute(table);
+    PointViewPtr view = *s.begin();
+    EXPECT_EQ(view->size(), m_quarterCount);
+    for (PointId id = 0; id < view->size(); ++id)
+        ASSERT_TRUE(box.contains(view->getFieldAs<double>(Dimension::Id::X, id),
+            view->getFieldAs<double>(Dimension::Id::Y, id)));
+
+    // Only the overlapping nodes are counted.
+    QuickInfo qi = reader.preview();
+    EXPECT_LT(qi.m_pointCount, 110000u);
+    EXPECT_GE(qi.m_pointCount, view->size());
+}
+
+TEST_F(CopcReaderTest, resolution)
+{
+    auto count = [](double resolution)
+    {
+        Options ops;
+        ops.add("filename", m_file);
+        ops.add("resolution", resolution);
+        CopcReader reader;
+        reader.setOptions(ops);
+
+        PointTable table;
+        reader.prepare(table);
+        PointViewSet s = reader.execute(table);
+        return (*s.begin())->size();
+    };
+
+    point_count_t coarse = count(20);
+    point_count_t fine = count(5);
+    EXPECT_GT(coarse, 0u);
+    EXPECT_LT(coarse, fine);
+    EXPECT_LT(fine, 110000u);
+    EXPECT_EQ(count(.01), 110000u);
+}
+
+TEST_F(CopcReaderTest, stream)
+{
+    BOX2D box(quarter());
+
+    Options ops;
+    ops.add("filename", m_file);
+    ops.add("bounds", box);
+    CopcReader reader;
+    reader.setOptions(ops);
+
+    point_count_t count = 0;
+    StreamCallbackFilter f;
+    f.setInput(reader);
+    f.setCallback([&count, &box](PointRef& point)
+    {
+        EXPECT_TRUE(box.contains(point.getFieldAs<double>(Dimension::Id::X),
+            point.getFieldAs<double>(Dimension::Id::Y)));
+        count++;
+        return true;
+    });
+
+    FixedPointTable table(1000);
+    f.prepare(table);
+    f.execute(table);
+    EXPECT_EQ(count, m_quarterCount);
+}
@@ -0,0 +1,135 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <algorithm>
+#include <array>
+
+#include <pdal/PointView.hpp>
+#include <pdal/util/Extractor.hpp>
+#include <pdal/util/FileUtils.hpp>
+#include <io/CopcWriter.hpp>
+#include <io/LasReader.hpp>
+#include "Support.hpp"
+
+using namespace pdal;
+
+namespace
+{
+
+using Xyz = std::array<double, 3>;
+
+std::vector<Xyz> points(const PointView& view)
+{
+    std::vector<Xyz> pts;
+    for (PointId id = 0; id < view.size(); ++id)
+        pts.push_back({ view.getFieldAs<double>(Dimension::Id::X, id),
+            view.getFieldAs<double>(Dimension::Id::Y, id),
+            view.getFieldAs<double>(Dimension::Id::Z, id) });
+    std::sort(pts.begin(), pts.end());
+    return pts;
+}
+
+} // unnamed namespace
+
+TEST(CopcWriterTest, roundTrip)
+{
+    std::string outfile(Support::temppath("copc.laz"));
+    FileUtils::deleteFile(outfile);
+
+    Options readerOps;
+    readerOps.add("filename", Support::datapath("las/autzen_trim.las"));
+    LasReader reader;
+    reader.setOptions(readerOps);
+
+    // Small nodes so that the tree has a few levels.
+    Options writerOps;
+    writerOps.add("filename", outfile);
+    writerOps.add("max_node_points", 10000);
+    writerOps.add("threads", 4);
+    CopcWriter writer;
+    writer.setOptions(writerOps);
+    writer.setInput(reader);
+
+    PointTable t1;
+    writer.prepare(t1);
+    PointViewSet s = writer.execute(t1);
+    PointViewPtr in = *s.begin();
+
+    // The file is readable as an ordinary LAZ file and has all the points.
+    Options ops;
+    ops.add("filename", outfile);
+    ops.add("compression", "laszip");
+    LasReader r;
+    r.setOptions(ops);
+    PointTable t2;
+    r.prepare(t2);
+    s = r.execute(t2);
+    PointViewPtr out = *s.begin();
+
+    EXPECT_EQ(r.header().versionMinor(), 4);
+    EXPECT_EQ(r.header().pointFormat(), 7);
+    EXPECT_EQ(out->size(), 110000u);
+    EXPECT_TRUE(points(*in) == points(*out));
+
+    // Check the COPC info VLR and the hierarchy.
+    std::string data(FileUtils::readFileIntoString(outfile));
+    ASSERT_GT(data.size(), 375u + 54u + 160u);
+    EXPECT_EQ(data.substr(375 + 2, 4), "copc");
+
+    LeExtractor info(data.data() + 375 + 54, 160);
+    double centerX, centerY, centerZ, halfSize, spacing;
+    uint64_t hierOffset, hierSize;
+    info >> centerX >> centerY >> centerZ >> halfSize >> spacing >>
+        hierOffset >> hierSize;
+    ASSERT_EQ(hierSize % 32, 0u);
+    ASSERT_LE(hierOffset + hierSize, data.size());
+    EXPECT_GT(hierSize / 32, 1u);
+
+    LeExtractor entries(data.data() + hierOffset, (size_t)hierSize);
+    uint64_t total = 0;
+    for (uint64_t i = 0; i < hierSize / 32; ++i)
+    {
+        int32_t d, x, y, z, byteSize, pointCount;
+        uint64_t offset;
+        entries >> d >> x >> y >> z >> offset >> byteSize >> pointCount;
+        EXPECT_GE(offset, r.header().pointOffset());
+        EXPECT_LE(offset + byteSize, hierOffset);
+        EXPECT_LE(pointCount, 10000);
+        total += pointCount;
+    }
+    EXPECT_EQ(total, 110000u);
+
+    FileUtils::deleteFile(outfile);
+}
@@ -239,6 +239,96 @@ TEST(EptAddonWriterTest, boundedWrite)
     EXPECT_GT(out, 0);
 }
 
+#ifdef PDAL_HAVE_ZSTD
+TEST(EptAddonWriterTest, zstandard)
+{
+    // Write a compressed addon and make sure the EPT reader decodes it.
+    const std::string addonDir(Support::datapath("ept/addon/"));
+    FileUtils::deleteDirectory(addonDir);
+
+    {
+        EptReader reader;
+        {
+            Options o;
+            o.add("filename", eptLaszipPath);
+            reader.setOptions(o);
+        }
+
+        AssignFilter assign;
+        {
+            Options o;
+            o.add("assignment", "Classification[:]=42");
+            assign.setOptions(o);
+            assign.setInput(reader);
+        }
+
+        EptAddonWriter writer;
+        {
+            NL::json addons;
+            addons[addonDir + "zstd"] = "Classification";
+
+            Options o;
+            o.add("addons", addons);
+            o.add("data_type", "zstandard");
+            o.add("threads", 8);
+            writer.setOptions(o);
+            writer.setInput(assign);
+        }
+
+        PointTable table;
+        writer.prepare(table);
+        writer.execute(table);
+    }
+
+    const NL::json meta(NL::json::parse(FileUtils::readFileIntoString(
+        addonDir + "zstd/ept-addon.json")));
+    EXPECT_EQ(meta["dataType"].get<std::string>(), "zstandard");
+    EXPECT_TRUE(FileUtils::fileExists(addonDir + "zstd/ept-data/0-0-0-0.zst"));
+
+    EptReader reader;
+    {
+        NL::json addons;
+        addons["Classification"] = addonDir + "zstd";
+
+        Options o;
+        o.add("filename", eptLaszipPath);
+        o.add("addons", addons);
+        reader.setOptions(o);
+    }
+
+    PointTable table;
+    reader.prepare(table);
+    const auto set(reader.execute(table));
+
+    point_count_t count(0);
+    for (const PointViewPtr& view : set)
+    {
+        for (point_count_t i(0); i < view->size(); ++i)
+        {
+            ASSERT_EQ(view->getFieldAs<uint16_t>(
+                Dimension::Id::Classification, i), 42u);
+            ++count;
+        }
+    }
+    EXPECT_GT(count, 0u);
+}
+#endif
+
+TEST(EptAddonWriterTest, invalidDataType)
+{
+    EptAddonWriter writer;
+    Options o;
+    NL::json addons;
+    addons[Support::datapath("ept/addon/bad")] = "Classification";
+    o.add("addons", addons);
+    o.add("data_type", "laszip");
+    writer.setOptions(o);
+
+    PointTable table;
+    table.layout()->registerDim(Dimension::Id::Classification);
+    EXPECT_THROW(writer.prepare(table), pdal_error);
+}
+
 TEST(EptAddonWriterTest, mustDescendFromEptReader)
 {
     // Make sure the EPT writer throws if it is not used in tandem with an EPT
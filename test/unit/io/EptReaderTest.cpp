@@ -33,6 +33,8 @@
  ****************************************************************************/
 
 #include <algorithm>
+#include <chrono>
+#include <thread>
 
 #include <nlohmann/json.hpp>
 
@@ -40,7 +42,10 @@
 
 #include <io/EptReader.hpp>
 #include <io/LasReader.hpp>
+#include <pdal/private/FileCache.hpp>
+#include <io/private/EptTuner.hpp>
 #include <filters/CropFilter.hpp>
+#include <filters/StreamCallbackFilter.hpp>
 #include <filters/ReprojectionFilter.hpp>
 #include <pdal/SrsBounds.hpp>
 #include <pdal/util/FileUtils.hpp>
@@ -512,11 +517,12 @@ TEST(EptReaderTest, getCoercedType)
     EXPECT_EQ(EptReader::getCoercedTypeTest(j), Dimension::Type::None);
 }
 
-void streamTest(const std::string src)
+void streamTest(const std::string src, bool quantize = false)
 {
     Options ops;
     ops.add("filename", src);
     ops.add("resolution", 1);
+    ops.add("quantize", quantize);
 
     // Execute the reader in normal non-streaming mode.
     EptReader normalReader;
@@ -629,6 +635,60 @@ TEST(EptReaderTest, zstandardStream)
 #endif
 }
 
+// Quantized X, Y and Z are stored as scaled integers but read back as the
+// values of the unquantized read, rounded to the schema's scale.
+TEST(EptReaderTest, quantize)
+{
+    Dimension::Id nodeIdDim;
+    Dimension::Id pointIdDim;
+    auto read = [&](bool quantize, PointTable& table)
+    {
+        nodeIdDim = table.layout()->registerOrAssignDim("EptNodeId",
+            Dimension::Type::Unsigned32);
+        pointIdDim = table.layout()->registerOrAssignDim("EptPointId",
+            Dimension::Type::Unsigned32);
+        Options ops;
+        ops.add("filename", ellipsoidEptBinaryPath);
+        ops.add("quantize", quantize);
+        EptReader reader;
+        reader.setOptions(ops);
+        reader.prepare(table);
+        return *reader.execute(table).begin();
+    };
+
+    PointTable plainTable;
+    PointViewPtr plain = read(false, plainTable);
+    PointTable quantTable;
+    PointViewPtr quant = read(true, quantTable);
+
+    EXPECT_EQ(quantTable.layout()->storageSize() + 3 * sizeof(int32_t),
+        plainTable.layout()->storageSize());
+    ASSERT_EQ(plain->size(), ellipsoidNumPoints);
+    ASSERT_EQ(quant->size(), plain->size());
+
+    // Points are read asynchronously, so sort both views the same way.
+    const auto sort([&](const PointRef& a, const PointRef& b)
+    {
+        if (a.compare(nodeIdDim, b))
+            return true;
+        return !b.compare(nodeIdDim, a) && a.compare(pointIdDim, b);
+    });
+    std::stable_sort(plain->begin(), plain->end(), sort);
+    std::stable_sort(quant->begin(), quant->end(), sort);
+
+    for (PointId i = 0; i < plain->size(); ++i)
+        for (Dimension::Id id :
+            { Dimension::Id::X, Dimension::Id::Y, Dimension::Id::Z })
+            ASSERT_NEAR(plain->getFieldAs<double>(id, i),
+                quant->getFieldAs<double>(id, i), 0.005 + 1e-9);
+}
+
+// Stream mode copies quantized points from the node tables correctly.
+TEST(EptReaderTest, quantizeStream)
+{
+    streamTest(ellipsoidEptBinaryPath, true);
+}
+
 TEST(EptReaderTest, boundedCrop)
 {
     std::string wkt = FileUtils::readFileIntoString(
@@ -684,6 +744,41 @@ TEST(EptReaderTest, boundedCrop)
     EXPECT_EQ(sourceNp, 47u);
 }
 
+TEST(EptReaderTest, polygonPruning)
+{
+    auto read = [](const std::vector<std::string>& polys)
+    {
+        Options options;
+        options.add("filename", eptLaszipPath);
+        for (const std::string& poly : polys)
+            options.add("polygon", poly);
+
+        PointTable table;
+        EptReader reader;
+        reader.setOptions(options);
+        reader.prepare(table);
+        point_count_t np(0);
+        for (const PointViewPtr& view : reader.execute(table))
+            np += view->size();
+        return np;
+    };
+
+    // Every node is inside this polygon, so no point is tested.
+    EXPECT_EQ(read({ "POLYGON ((515000 4918000, 516000 4918000, "
+        "516000 4919000, 515000 4919000, 515000 4918000))" }), expNumPoints);
+
+    // Two thin corridors.  Nodes are kept if they overlap either one.
+    const std::string west("POLYGON ((515370 4918340, 515372 4918340, "
+        "515372 4918382, 515370 4918382, 515370 4918340))");
+    const std::string east("POLYGON ((515395 4918340, 515397 4918340, "
+        "515397 4918382, 515395 4918382, 515395 4918340))");
+    const point_count_t westNp(read({ west }));
+    const point_count_t eastNp(read({ east }));
+    EXPECT_GT(westNp, 0u);
+    EXPECT_GT(eastNp, 0u);
+    EXPECT_EQ(read({ west, east }), westNp + eastNp);
+}
+
 TEST(EptReaderTest, boundedCropReprojection)
 {
     std::string selection = FileUtils::readFileIntoString(
@@ -798,4 +893,240 @@ TEST(EptReaderTest, ogrCrop)
 
 
 
+TEST(EptReaderTest, cache)
+{
+    const std::string dir(Support::temppath("eptcache"));
+    FileUtils::deleteDirectory(dir);
+
+    {
+        FileCache cache(dir, 1000, ".ept");
+
+        std::vector<char> data;
+        EXPECT_FALSE(cache.get("a", data));
+        EXPECT_TRUE(cache.file("a").empty());
+
+        std::vector<char> a(400, 'a');
+        cache.put("a", a);
+        EXPECT_TRUE(cache.get("a", data));
+        EXPECT_EQ(data, a);
+        EXPECT_EQ(FileUtils::fileSize(cache.file("a")), 400u);
+
+        // Entries larger than the cache aren't stored.
+        cache.put("big", std::vector<char>(1001, 'x'));
+        EXPECT_FALSE(cache.get("big", data));
+
+        cache.put("b", std::vector<char>(400, 'b'));
+        cache.put("c", std::vector<char>(400, 'c'));
+    }
+
+    // Adding the third entry pushed the cache over its limit, so one entry
+    // was evicted.
+    auto countEntries = [&dir]()
+    {
+        size_t count = 0;
+        for (const std::string& f : FileUtils::directoryList(dir))
+            if (Utils::endsWith(f, ".ept"))
+                count++;
+        return count;
+    };
+    EXPECT_EQ(countEntries(), 2u);
+
+    // A second cache on the same directory sees the existing entries.
+    {
+        FileCache cache(dir, 1000, ".ept");
+        std::vector<char> data;
+        size_t found = 0;
+        for (const std::string key : { "a", "b", "c" })
+            if (cache.get(key, data))
+            {
+                EXPECT_EQ(data, std::vector<char>(400, key[0]));
+                found++;
+            }
+        EXPECT_EQ(found, 2u);
+    }
+
+    // A smaller limit evicts entries when the cache is opened.
+    {
+        FileCache cache(dir, 500, ".ept");
+    }
+    EXPECT_EQ(countEntries(), 1u);
+
+    // Local datasets aren't cached.
+    {
+        Options options;
+        options.add("filename", ellipsoidEptBinaryPath);
+        options.add("cache_dir", dir + "/local");
+        PointTable table;
+        EptReader reader;
+        reader.setOptions(options);
+        reader.prepare(table);
+        PointViewSet s = reader.execute(table);
+        EXPECT_EQ((*s.begin())->size(), ellipsoidNumPoints);
+        EXPECT_FALSE(FileUtils::directoryExists(dir + "/local"));
+    }
+    FileUtils::deleteDirectory(dir);
+}
+
+TEST(EptReaderTest, tuner)
+{
+    // Two cores, up to eight nodes in flight and room for two buffered
+    // nodes of 400 bytes.
+    EptTuner tuner(4, 8, 1000, 2);
+    EXPECT_EQ(tuner.window(), 4u);
+
+    // A node that spends its time waiting on the fetch opens the window
+    // as far as it goes, but read-ahead is held to the memory budget.
+    tuner.acquire();
+    {
+        EptNodeTimer timer(tuner, 400);
+        timer.fetchStart();
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        timer.fetchEnd();
+    }
+    EXPECT_EQ(tuner.window(), 8u);
+    EXPECT_EQ(tuner.readAhead(), 2u);
+
+    // Nodes that spend their time decoding close it again.
+    for (size_t i = 0; i < 20; ++i)
+    {
+        tuner.acquire();
+        EptNodeTimer timer(tuner, 400);
+        timer.fetchStart();
+        timer.fetchEnd();
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    EXPECT_LE(tuner.window(), 4u);
+
+    MetadataNode m("fetch");
+    tuner.dump(m);
+    EXPECT_EQ(m.findChild("nodes").value<int>(), 21);
+    EXPECT_EQ(m.findChild("peak_concurrency").value<int>(), 8);
+}
+
+TEST(EptReaderTest, fetchMetadata)
+{
+    Options options;
+    options.add("filename", ellipsoidEptBinaryPath);
+    PointTable table;
+    EptReader reader;
+    reader.setOptions(options);
+    reader.prepare(table);
+    reader.execute(table);
+
+    MetadataNode m = reader.getMetadata().findChild("fetch");
+    EXPECT_GT(m.findChild("nodes").value<int>(), 0);
+    EXPECT_GT(m.findChild("concurrency").value<int>(), 0);
+}
+
+namespace
+{
+    // Point counts of each depth of the laszip dataset, from its hierarchy.
+    const std::vector<point_count_t> expDepthCounts {
+        41998, 166916, 270355, 39593 };
+}
+
+TEST(EptReaderTest, progressive)
+{
+    Options options;
+    options.add("filename", eptLaszipPath);
+    options.add("progressive", true);
+
+    PointTable table;
+    EptReader reader;
+    reader.setOptions(options);
+    reader.prepare(table);
+    const auto set(reader.execute(table));
+
+    // One view per depth, coarse to fine.
+    ASSERT_EQ(set.size(), expDepthCounts.size());
+    size_t depth(0);
+    for (const PointViewPtr& view : set)
+        EXPECT_EQ(view->size(), expDepthCounts[depth++]);
+}
+
+TEST(EptReaderTest, pointBudget)
+{
+    auto read = [](point_count_t budget, bool progressive)
+    {
+        Options options;
+        options.add("filename", eptLaszipPath);
+        options.add("point_budget", budget);
+        options.add("progressive", progressive);
+
+        PointTable table;
+        EptReader reader;
+        reader.setOptions(options);
+        reader.prepare(table);
+        const auto set(reader.execute(table));
+
+        point_count_t np(0);
+        for (const PointViewPtr& view : set)
+            np += view->size();
+        return np;
+    };
+
+    // Depths 0 and 1 fit, depth 2 would exceed the budget.
+    EXPECT_EQ(read(300000, false), expDepthCounts[0] + expDepthCounts[1]);
+    EXPECT_EQ(read(300000, true), expDepthCounts[0] + expDepthCounts[1]);
+
+    // The first depth is always read.
+    EXPECT_EQ(read(1, false), expDepthCounts[0]);
+    EXPECT_EQ(read(expNumPoints, false), expNumPoints);
+}
+
+TEST(EptReaderTest, timeBudget)
+{
+    Options options;
+    options.add("filename", eptLaszipPath);
+    options.add("time_budget", 1e-9);
+
+    PointTable table;
+    EptReader reader;
+    reader.setOptions(options);
+    reader.prepare(table);
+    const auto set(reader.execute(table));
+
+    // The budget runs out before the second depth starts.
+    ASSERT_EQ(set.size(), 1u);
+    EXPECT_EQ((*set.begin())->size(), expDepthCounts[0]);
+}
+
+TEST(EptReaderTest, progressiveStream)
+{
+    Options options;
+    options.add("filename", eptLaszipPath);
+    options.add("progressive", true);
+    options.add("point_budget", 300000);
+
+    EptReader reader;
+    reader.setOptions(options);
+
+    // Node IDs follow the hierarchy order, so the root is node 1 and the
+    // five nodes of depth 1 are nodes 2 through 6.
+    FixedPointTable table(1000);
+    const Dimension::Id nodeIdDim(table.layout()->registerOrAssignDim(
+        "EptNodeId", Dimension::Type::Unsigned32));
+
+    point_count_t count(0);
+    uint64_t maxNodeId(0);
+    StreamCallbackFilter f;
+    f.setInput(reader);
+    f.setCallback([&](PointRef& point)
+    {
+        const uint64_t nodeId(point.getFieldAs<uint64_t>(nodeIdDim));
+        if (count < expDepthCounts[0])
+            EXPECT_EQ(nodeId, 1u);
+        else
+            EXPECT_GT(nodeId, 1u);
+        maxNodeId = (std::max)(maxNodeId, nodeId);
+        count++;
+        return true;
+    });
+
+    f.prepare(table);
+    f.execute(table);
+    EXPECT_EQ(count, expDepthCounts[0] + expDepthCounts[1]);
+    EXPECT_EQ(maxNodeId, 6u);
+}
+
 } // namespace pdal
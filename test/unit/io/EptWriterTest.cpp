@@ -0,0 +1,173 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <nlohmann/json.hpp>
+
+#include <pdal/util/FileUtils.hpp>
+#include <io/EptReader.hpp>
+#include <io/EptWriter.hpp>
+#include <io/FauxReader.hpp>
+#include "Support.hpp"
+
+using namespace pdal;
+
+namespace
+{
+
+struct Summary
+{
+    point_count_t m_count = 0;
+    double m_xSum = 0;
+    double m_timeSum = 0;
+};
+
+Summary summarize(const PointViewSet& views)
+{
+    Summary s;
+    for (const PointViewPtr& view : views)
+        for (PointId idx = 0; idx < view->size(); ++idx)
+        {
+            s.m_count++;
+            s.m_xSum += view->getFieldAs<double>(Dimension::Id::X, idx);
+            s.m_timeSum +=
+                view->getFieldAs<double>(Dimension::Id::OffsetTime, idx);
+        }
+    return s;
+}
+
+// Write random points with the given options and check that readers.ept
+// reads all of them back.
+void roundTrip(const std::string& dataType, Options writerOpts)
+{
+    const std::string dir(Support::temppath("eptwriter-" + dataType));
+    FileUtils::deleteDirectory(dir);
+
+    Options fauxOpts;
+    fauxOpts.add("mode", "random");
+    fauxOpts.add("count", 200000);
+    fauxOpts.add("bounds", BOX3D(0, 0, 0, 1000, 1000, 100));
+
+    Summary input;
+    {
+        FauxReader faux;
+        faux.setOptions(fauxOpts);
+
+        writerOpts.add("filename", dir);
+        writerOpts.add("data_type", dataType);
+        EptWriter writer;
+        writer.setOptions(writerOpts);
+        writer.setInput(faux);
+
+        PointTable table;
+        writer.prepare(table);
+        input = summarize(writer.execute(table));
+    }
+
+    NL::json info(NL::json::parse(
+        FileUtils::readFileIntoString(dir + "/ept.json")));
+    EXPECT_EQ(info["points"].get<point_count_t>(), input.m_count);
+    EXPECT_EQ(info["dataType"].get<std::string>(), dataType);
+
+    Options readerOpts;
+    readerOpts.add("filename", "ept://" + dir);
+    EptReader reader;
+    reader.setOptions(readerOpts);
+
+    PointTable table;
+    reader.prepare(table);
+    Summary output = summarize(reader.execute(table));
+
+    EXPECT_EQ(output.m_count, input.m_count);
+    EXPECT_NEAR(output.m_xSum, input.m_xSum, input.m_count * .005);
+    EXPECT_DOUBLE_EQ(output.m_timeSum, input.m_timeSum);
+
+    FileUtils::deleteDirectory(dir);
+}
+
+} // unnamed namespace
+
+TEST(EptWriterTest, binary)
+{
+    roundTrip("binary", Options());
+}
+
+TEST(EptWriterTest, laszip)
+{
+    roundTrip("laszip", Options());
+}
+
+#ifdef PDAL_HAVE_ZSTD
+TEST(EptWriterTest, zstandard)
+{
+    roundTrip("zstandard", Options());
+}
+#endif
+
+#ifdef PDAL_HAVE_LZ4
+TEST(EptWriterTest, lz4)
+{
+    roundTrip("lz4", Options());
+}
+#endif
+
+TEST(EptWriterTest, delta)
+{
+    roundTrip("delta", Options());
+}
+
+// A small memory allowance forces the input to be partitioned through
+// temporary files before it's indexed.
+TEST(EptWriterTest, outOfCore)
+{
+    Options opts;
+    opts.add("memory", 1);
+    opts.add("threads", 2);
+    opts.add("max_node_points", 1000);
+    opts.add("span", 16);
+    opts.add("hierarchy_step", 2);
+    roundTrip("binary", opts);
+}
+
+TEST(EptWriterTest, badOptions)
+{
+    Options opts;
+    opts.add("filename", Support::temppath("eptwriter-bad"));
+    opts.add("data_type", "png");
+
+    EptWriter writer;
+    writer.setOptions(opts);
+    PointTable table;
+    EXPECT_THROW(writer.prepare(table), pdal_error);
+}
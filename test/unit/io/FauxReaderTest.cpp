@@ -34,6 +34,7 @@
 
 #include <pdal/pdal_test_main.hpp>
 
+#include <filters/StreamCallbackFilter.hpp>
 #include <io/FauxReader.hpp>
 
 using namespace pdal;
@@ -308,3 +309,101 @@ TEST(FauxReaderTest, grid)
     testGrid(0, 3, 0);
     testGrid(0, 3, 4);
 }
+
+namespace
+{
+
+PointViewPtr readTerrain(int threads)
+{
+    Options ops;
+    ops.add("bounds", BOX3D(0, 0, 100, 1000, 500, 200));
+    ops.add("count", 50000);
+    ops.add("mode", "terrain");
+    ops.add("seed", 42);
+    ops.add("threads", threads);
+    FauxReader reader;
+    reader.setOptions(ops);
+
+    PointTable table;
+    reader.prepare(table);
+    PointViewSet s = reader.execute(table);
+    return *s.begin();
+}
+
+} // unnamed namespace
+
+TEST(FauxReaderTest, terrain)
+{
+    using namespace Dimension;
+
+    PointViewPtr v1 = readTerrain(1);
+    PointViewPtr v4 = readTerrain(4);
+    ASSERT_EQ(v1->size(), 50000u);
+    ASSERT_EQ(v4->size(), 50000u);
+
+    const IdList ids { Id::X, Id::Y, Id::Z, Id::OffsetTime, Id::GpsTime,
+        Id::ReturnNumber, Id::NumberOfReturns, Id::Classification,
+        Id::Intensity, Id::ScanAngleRank };
+
+    // Output doesn't depend on the number of threads.
+    for (PointId i = 0; i < v1->size(); ++i)
+        for (Id id : ids)
+            ASSERT_EQ(v1->getFieldAs<double>(id, i),
+                v4->getFieldAs<double>(id, i));
+
+    // Streamed output is the same as well.
+    PointId idx = 0;
+    Options ops;
+    ops.add("bounds", BOX3D(0, 0, 100, 1000, 500, 200));
+    ops.add("count", 50000);
+    ops.add("mode", "terrain");
+    ops.add("seed", 42);
+    FauxReader reader;
+    reader.setOptions(ops);
+    StreamCallbackFilter f;
+    f.setInput(reader);
+    f.setCallback([&v1, &ids, &idx](PointRef& point)
+    {
+        for (Id id : ids)
+            EXPECT_EQ(point.getFieldAs<double>(id),
+                v1->getFieldAs<double>(id, idx));
+        idx++;
+        return true;
+    });
+    FixedPointTable table(1000);
+    f.prepare(table);
+    f.execute(table);
+    EXPECT_EQ(idx, 50000u);
+
+    size_t multiple = 0;
+    double lastTime = 0;
+    for (PointId i = 0; i < v1->size(); ++i)
+    {
+        double x = v1->getFieldAs<double>(Id::X, i);
+        double y = v1->getFieldAs<double>(Id::Y, i);
+        double z = v1->getFieldAs<double>(Id::Z, i);
+        EXPECT_TRUE(x >= 0 && x <= 1000);
+        EXPECT_TRUE(y >= 0 && y <= 500);
+        EXPECT_TRUE(z >= 100 && z <= 200);
+
+        double time = v1->getFieldAs<double>(Id::GpsTime, i);
+        EXPECT_GE(time, lastTime);
+        lastTime = time;
+
+        int ret = v1->getFieldAs<int>(Id::ReturnNumber, i);
+        int numReturns = v1->getFieldAs<int>(Id::NumberOfReturns, i);
+        EXPECT_GE(ret, 1);
+        EXPECT_LE(ret, numReturns);
+        EXPECT_LE(numReturns, 4);
+        if (numReturns > 1)
+        {
+            multiple++;
+            if (ret == numReturns)
+            {
+                EXPECT_EQ(v1->getFieldAs<int>(Id::Classification, i), 2);
+            }
+        }
+    }
+    // Some pulses hit trees.
+    EXPECT_GT(multiple, 0u);
+}
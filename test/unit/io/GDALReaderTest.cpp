@@ -37,6 +37,7 @@
 
 #include <pdal/pdal_test_main.hpp>
 
+#include <pdal/GDALUtils.hpp>
 #include <io/GDALReader.hpp>
 #include "Support.hpp"
 
@@ -96,6 +97,92 @@ TEST(GDALReaderTest, simple)
     verify(715154, 734.5, 972.5, 0, 0, 0);
 }
 
+// Read a tiled raster by blocks on several threads, with and without the
+// cells that hold no data.
+TEST(GDALReaderTest, blocks)
+{
+    const int width = 300;
+    const int height = 200;
+    std::string filename(Support::temppath("blocks.tif"));
+    {
+        std::array<double, 6> pixelToPos { 0, 1, 0, height, 0, -1 };
+        gdal::Raster raster(filename, "GTiff", SpatialReference(),
+            pixelToPos);
+        ASSERT_EQ(raster.open(width, height, 2, Dimension::Type::Float,
+            -9999, { "TILED=YES", "BLOCKXSIZE=64", "BLOCKYSIZE=32" }),
+            gdal::GDALError::None);
+
+        // Band 1 has no data where (row + col) % 7 == 0.  Band 2 only where
+        // (row + col) % 14 == 0.
+        std::vector<double> b1, b2;
+        for (int row = 0; row < height; ++row)
+            for (int col = 0; col < width; ++col)
+            {
+                b1.push_back((row + col) % 7 ? row * 1000 + col : -1);
+                b2.push_back((row + col) % 14 ? col : -1);
+            }
+        EXPECT_EQ(raster.writeBand(b1.data(), -1.0, 1),
+            gdal::GDALError::None);
+        EXPECT_EQ(raster.writeBand(b2.data(), -1.0, 2),
+            gdal::GDALError::None);
+        EXPECT_EQ(raster.flush(), gdal::GDALError::None);
+    }
+
+    auto read = [&filename](int threads, bool skip)
+    {
+        Options ro;
+        ro.add("filename", filename);
+        ro.add("threads", threads);
+        ro.add("skip_nodata", skip);
+
+        GDALReader gr;
+        gr.setOptions(ro);
+        PointTable t;
+        gr.prepare(t);
+        PointViewPtr v = *gr.execute(t).begin();
+        Dimension::Id b1 = t.layout()->findDim("band-1");
+
+        std::vector<std::array<double, 3>> points;
+        for (PointId idx = 0; idx < v->size(); ++idx)
+            points.push_back({{ v->getFieldAs<double>(Dimension::Id::X, idx),
+                v->getFieldAs<double>(Dimension::Id::Y, idx),
+                v->getFieldAs<double>(b1, idx) }});
+        return points;
+    };
+
+    auto all = read(1, false);
+    EXPECT_EQ(all.size(), (size_t)(width * height));
+    EXPECT_EQ(all, read(3, false));
+
+    auto valid = read(1, true);
+    EXPECT_EQ(valid, read(4, true));
+    size_t count = 0;
+    for (int row = 0; row < height; ++row)
+        for (int col = 0; col < width; ++col)
+            if ((row + col) % 14)
+                count++;
+    ASSERT_EQ(valid.size(), count);
+
+    // Points are in block order.  The first block is 64 x 32.
+    EXPECT_DOUBLE_EQ(valid[0][0], 1.5);
+    EXPECT_DOUBLE_EQ(valid[0][1], height - .5);
+    EXPECT_DOUBLE_EQ(valid[0][2], 1);
+    for (auto& p : valid)
+    {
+        int col = (int)p[0];
+        int row = height - 1 - (int)p[1];
+        EXPECT_NE((row + col) % 14, 0);
+        if ((row + col) % 7)
+            EXPECT_DOUBLE_EQ(p[2], row * 1000 + col);
+        else
+            EXPECT_DOUBLE_EQ(p[2], -9999);
+    }
+    EXPECT_DOUBLE_EQ(valid[62][0], 63.5);
+    EXPECT_DOUBLE_EQ(valid[62][1], height - .5);
+    EXPECT_DOUBLE_EQ(valid[63][0], .5);
+    EXPECT_DOUBLE_EQ(valid[63][1], height - 1.5);
+}
+
 struct Point
 {
     double m_x;
@@ -868,4 +868,160 @@ TEST(GDALWriterTest, alternate_grid)
     }
 }
 
+// Binning on several threads and writing in tiles give the same raster
+// as binning the whole grid at once.
+TEST(GDALWriterTest, tiles)
+{
+    std::string outfile(Support::temppath("tiles.tif"));
+
+    auto run = [&outfile](int threads, int tileHeight, bool stream)
+    {
+        FileUtils::deleteFile(outfile);
+
+        Options ro;
+        ro.add("filename", Support::datapath("las/1.2-with-color.las"));
+        LasReader r;
+        r.setOptions(ro);
+
+        Options wo;
+        wo.add("filename", outfile);
+        wo.add("resolution", 50);
+        wo.add("window_size", 2);
+        wo.add("output_type", "all");
+        wo.add("threads", threads);
+        wo.add("tile_height", tileHeight);
+        GDALWriter w;
+        w.setOptions(wo);
+        w.setInput(r);
+
+        if (stream)
+        {
+            FixedPointTable t(100);
+            w.prepare(t);
+            w.execute(t);
+        }
+        else
+        {
+            PointTable t;
+            w.prepare(t);
+            w.execute(t);
+        }
+
+        gdal::registerDrivers();
+        gdal::Raster raster(outfile, "GTiff");
+        EXPECT_EQ(raster.open(), gdal::GDALError::None);
+        EXPECT_EQ(raster.bandCount(), 6);
+
+        std::vector<double> all;
+        for (int band = 1; band <= raster.bandCount(); ++band)
+        {
+            std::vector<double> data;
+            raster.readBand(data, band);
+            all.insert(all.end(), data.begin(), data.end());
+        }
+        return all;
+    };
+
+    auto same = [](const std::vector<double>& a, const std::vector<double>& b)
+    {
+        if (a.size() != b.size())
+            return false;
+        for (size_t i = 0; i < a.size(); ++i)
+            if (a[i] != b[i] && !(std::isnan(a[i]) && std::isnan(b[i])))
+                return false;
+        return true;
+    };
+
+    std::vector<double> expected = run(1, 0, false);
+    EXPECT_GT(expected.size(), 1000U);
+    EXPECT_TRUE(same(expected, run(4, 0, false)));
+    EXPECT_TRUE(same(expected, run(1, 10, false)));
+    EXPECT_TRUE(same(expected, run(3, 10, false)));
+    EXPECT_TRUE(same(expected, run(2, 10, true)));
+}
+
+// A cloud-optimized GeoTIFF has the same data as a GeoTIFF and has
+// overviews aggregated from the grid.
+TEST(GDALWriterTest, cog)
+{
+    gdal::registerDrivers();
+    if (!GetGDALDriverManager()->GetDriverByName("COG"))
+        return;
+
+    std::string outfile(Support::temppath("cog.tif"));
+
+    auto run = [&outfile](const std::string& driver)
+    {
+        FileUtils::deleteFile(outfile);
+
+        Options ro;
+        ro.add("filename", Support::datapath("las/1.2-with-color.las"));
+        LasReader r;
+        r.setOptions(ro);
+
+        Options wo;
+        wo.add("filename", outfile);
+        wo.add("resolution", 5);
+        wo.add("output_type", "count");
+        wo.add("output_type", "mean");
+        wo.add("gdaldriver", driver);
+        wo.add("threads", 2);
+        GDALWriter w;
+        w.setOptions(wo);
+        w.setInput(r);
+
+        PointTable t;
+        w.prepare(t);
+        w.execute(t);
+    };
+
+    auto sum = [](const std::vector<double>& v)
+    {
+        double total = 0;
+        for (double d : v)
+            total += d;
+        return total;
+    };
+
+    run("GTiff");
+    std::vector<double> mean;
+    std::vector<double> count;
+    {
+        gdal::Raster raster(outfile, "GTiff");
+        EXPECT_EQ(raster.open(), gdal::GDALError::None);
+        raster.readBand(mean, 1);
+        raster.readBand(count, 2);
+    }
+
+    run("COG");
+    std::vector<double> cogMean;
+    std::vector<double> cogCount;
+    {
+        gdal::Raster raster(outfile, "GTiff");
+        EXPECT_EQ(raster.open(), gdal::GDALError::None);
+        EXPECT_GT(raster.width(), 512);
+        raster.readBand(cogMean, 1);
+        raster.readBand(cogCount, 2);
+    }
+    EXPECT_EQ(count, cogCount);
+    ASSERT_EQ(mean.size(), cogMean.size());
+    for (size_t i = 0; i < mean.size(); ++i)
+        EXPECT_DOUBLE_EQ(mean[i], cogMean[i]);
+
+    // Each cell of an overview of the count band sums the counts of the
+    // cells it covers.
+    GDALDataset *ds = (GDALDataset *)GDALOpen(outfile.data(), GA_ReadOnly);
+    ASSERT_NE(ds, nullptr);
+    GDALRasterBand *band = ds->GetRasterBand(2);
+    EXPECT_EQ(band->GetOverviewCount(), 2);
+    GDALRasterBand *ov = band->GetOverview(0);
+    ASSERT_NE(ov, nullptr);
+    std::vector<double> ovCount(ov->GetXSize() * ov->GetYSize());
+    EXPECT_EQ(ov->RasterIO(GF_Read, 0, 0, ov->GetXSize(), ov->GetYSize(),
+        ovCount.data(), ov->GetXSize(), ov->GetYSize(), GDT_Float64, 0, 0),
+        CE_None);
+    EXPECT_DOUBLE_EQ(sum(ovCount), sum(count));
+    GDALClose(ds);
+}
+
 } // namespace pdal
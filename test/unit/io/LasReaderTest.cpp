@@ -40,6 +40,12 @@
 #include <pdal/StageFactory.hpp>
 #include <pdal/Streamable.hpp>
 #include <io/LasReader.hpp>
+#include <filters/RangeFilter.hpp>
+#include <filters/SortFilter.hpp>
+#include <filters/StreamCallbackFilter.hpp>
+#include <io/LasVLR.hpp>
+#include <io/LasWriter.hpp>
+#include <io/TextWriter.hpp>
 #include "Support.hpp"
 
 using namespace pdal;
@@ -398,6 +404,69 @@ TEST(LasReaderTest, lazperf)
        EXPECT_EQ(memcmp(buf1.get(), buf2.get(), pointSize), 0);
     }
 }
+
+// Chunks decompressed in parallel must come back in file order, in both
+// standard and stream mode.
+TEST(LasReaderTest, lazperfThreads)
+{
+    Options ops1;
+    ops1.add("filename", Support::datapath("las/autzen_trim.las"));
+
+    LasReader lasReader;
+    lasReader.setOptions(ops1);
+
+    PointTable t1;
+    lasReader.prepare(t1);
+    PointViewSet s = lasReader.execute(t1);
+    PointViewPtr view1 = *s.begin();
+
+    Options ops2;
+    ops2.add("filename", Support::datapath("laz/autzen_trim.laz"));
+    ops2.add("compression", "lazperf");
+    ops2.add("threads", 4);
+
+    LasReader lazReader;
+    lazReader.setOptions(ops2);
+
+    PointTable t2;
+    lazReader.prepare(t2);
+    s = lazReader.execute(t2);
+    PointViewPtr view2 = *s.begin();
+    EXPECT_EQ(view2->size(), (point_count_t)110000);
+
+    DimTypeList dims = view1->dimTypes();
+    size_t pointSize = view1->pointSize();
+    EXPECT_EQ(pointSize, view2->pointSize());
+    std::vector<char> buf1(pointSize);
+    std::vector<char> buf2(pointSize);
+    for (PointId i = 0; i < 110000; i += 100)
+    {
+       view1->getPackedPoint(dims, i, buf1.data());
+       view2->getPackedPoint(dims, i, buf2.data());
+       EXPECT_EQ(memcmp(buf1.data(), buf2.data(), pointSize), 0);
+    }
+
+    LasReader streamReader;
+    streamReader.setOptions(ops2);
+
+    PointId cnt = 0;
+    auto cb = [&](PointRef& point)
+    {
+        view1->getPackedPoint(dims, cnt++, buf1.data());
+        point.getPackedData(dims, buf2.data());
+        EXPECT_EQ(memcmp(buf1.data(), buf2.data(), pointSize), 0);
+        return true;
+    };
+
+    StreamCallbackFilter f;
+    f.setCallback(cb);
+    f.setInput(streamReader);
+
+    FixedPointTable fixed(1000);
+    f.prepare(fixed);
+    f.execute(fixed);
+    EXPECT_EQ(cnt, 110000u);
+}
 #endif
 
 void streamTest(const std::string src, const std::string compression)
@@ -475,8 +544,429 @@ TEST(LasReaderTest, stream)
 }
 
 
+// Reading from mapped point data must match reading from the stream.
+TEST(LasReaderTest, mmap)
+{
+    auto read = [](PointTableRef table, const std::string& file, bool mmap)
+    {
+        Options ops;
+        ops.add("filename", Support::datapath(file));
+        ops.add("use_mmap", mmap);
+
+        LasReader reader;
+        reader.setOptions(ops);
+        reader.prepare(table);
+        PointViewSet s = reader.execute(table);
+        return *s.begin();
+    };
+
+    PointTable t1;
+    PointViewPtr view1 = read(t1, "las/autzen_trim.las", false);
+    PointTable t2;
+    PointViewPtr view2 = read(t2, "las/autzen_trim.las", true);
+    EXPECT_EQ(view1->size(), 110000u);
+    EXPECT_EQ(view2->size(), 110000u);
+
+    DimTypeList dims = view1->dimTypes();
+    size_t pointSize = view1->pointSize();
+    std::vector<char> buf1(pointSize);
+    std::vector<char> buf2(pointSize);
+    for (PointId i = 0; i < view1->size(); ++i)
+    {
+        view1->getPackedPoint(dims, i, buf1.data());
+        view2->getPackedPoint(dims, i, buf2.data());
+        EXPECT_EQ(memcmp(buf1.data(), buf2.data(), pointSize), 0);
+    }
+
+    // Stream mode.
+    Options ops;
+    ops.add("filename", Support::datapath("las/autzen_trim.las"));
+    ops.add("use_mmap", true);
+
+    LasReader reader;
+    reader.setOptions(ops);
+
+    PointId cnt = 0;
+    auto cb = [&](PointRef& point)
+    {
+        view1->getPackedPoint(dims, cnt++, buf1.data());
+        point.getPackedData(dims, buf2.data());
+        EXPECT_EQ(memcmp(buf1.data(), buf2.data(), pointSize), 0);
+        return true;
+    };
+
+    StreamCallbackFilter f;
+    f.setCallback(cb);
+    f.setInput(reader);
+
+    FixedPointTable fixed(1000);
+    f.prepare(fixed);
+    f.execute(fixed);
+    EXPECT_EQ(cnt, 110000u);
+
+    // The header claims more points than are in the file.
+    PointTable t3;
+    PointViewPtr view3 = read(t3, "las/1.2-with-color-clipped.las", true);
+    EXPECT_EQ(view3->size(), 1064u);
+}
+
+
+// Reading points ahead of decoding must match reading from the stream.
+TEST(LasReaderTest, readAhead)
+{
+    auto read = [](PointTableRef table, const std::string& file, int ahead)
+    {
+        Options ops;
+        ops.add("filename", Support::datapath(file));
+        ops.add("read_ahead", ahead);
+
+        LasReader reader;
+        reader.setOptions(ops);
+        reader.prepare(table);
+        PointViewSet s = reader.execute(table);
+        return *s.begin();
+    };
+
+    PointTable t1;
+    PointViewPtr view1 = read(t1, "las/autzen_trim.las", 0);
+    PointTable t2;
+    PointViewPtr view2 = read(t2, "las/autzen_trim.las", 2);
+    EXPECT_EQ(view1->size(), 110000u);
+    EXPECT_EQ(view2->size(), 110000u);
+
+    DimTypeList dims = view1->dimTypes();
+    size_t pointSize = view1->pointSize();
+    std::vector<char> buf1(pointSize);
+    std::vector<char> buf2(pointSize);
+    for (PointId i = 0; i < view1->size(); ++i)
+    {
+        view1->getPackedPoint(dims, i, buf1.data());
+        view2->getPackedPoint(dims, i, buf2.data());
+        EXPECT_EQ(memcmp(buf1.data(), buf2.data(), pointSize), 0);
+    }
+
+    // Stream mode.
+    Options ops;
+    ops.add("filename", Support::datapath("las/autzen_trim.las"));
+    ops.add("read_ahead", 2);
+
+    LasReader reader;
+    reader.setOptions(ops);
+
+    PointId cnt = 0;
+    auto cb = [&](PointRef& point)
+    {
+        view1->getPackedPoint(dims, cnt++, buf1.data());
+        point.getPackedData(dims, buf2.data());
+        EXPECT_EQ(memcmp(buf1.data(), buf2.data(), pointSize), 0);
+        return true;
+    };
+
+    StreamCallbackFilter f;
+    f.setCallback(cb);
+    f.setInput(reader);
+
+    FixedPointTable fixed(1000);
+    f.prepare(fixed);
+    f.execute(fixed);
+    EXPECT_EQ(cnt, 110000u);
+
+    // The header claims more points than are in the file.
+    PointTable t3;
+    PointViewPtr view3 = read(t3, "las/1.2-with-color-clipped.las", 2);
+    EXPECT_EQ(view3->size(), 1064u);
+}
+
+
+namespace pdal
+{
+
+// Compare the batch decoder with the point-at-a-time decoder for each
+// supported point format.
+TEST(LasReaderTest, batchDecode)
+{
+    const StringList files { "las/epsg_4326.las", "las/mvk-thin.las",
+        "las/autzen_trim.las", "las/4_6.las", "las/autzen_trim_7.las",
+        "las/extrabytes.las" };
+    for (const std::string& file : files)
+    {
+        Options ops;
+        ops.add("filename", Support::datapath(file));
+        LasReader reader;
+        reader.setOptions(ops);
+        PointTable table;
+        reader.prepare(table);
+
+        const LasHeader& h = reader.header();
+        const size_t pointLen = h.pointLen();
+        std::string data =
+            FileUtils::readFileIntoString(Support::datapath(file));
+        char *buf = &data[h.pointOffset()];
+        const point_count_t count = (std::min)(h.pointCount(),
+            (point_count_t)((data.size() - h.pointOffset()) / pointLen));
+
+        PointView v1(table);
+        PointView v2(table);
+        for (PointId i = 0; i < count; ++i)
+        {
+            PointRef point(v1, i);
+            reader.loadPoint(point, buf + i * pointLen, pointLen);
+        }
+        reader.loadPoints(v2, buf, count);
+
+        ASSERT_EQ(v1.size(), count);
+        ASSERT_EQ(v2.size(), count);
+        DimTypeList dims = v1.dimTypes();
+        size_t pointSize = v1.pointSize();
+        std::vector<char> buf1(pointSize);
+        std::vector<char> buf2(pointSize);
+        for (PointId i = 0; i < count; ++i)
+        {
+            v1.getPackedPoint(dims, i, buf1.data());
+            v2.getPackedPoint(dims, i, buf2.data());
+            ASSERT_EQ(memcmp(buf1.data(), buf2.data(), pointSize), 0) <<
+                file << " point " << i;
+        }
+    }
+}
+
+} // namespace pdal
+
+// Dimensions not used by the stages that follow the reader aren't decoded.
+TEST(LasReaderTest, requiredDims)
+{
+    auto run = [](const std::string& file, bool allDims)
+    {
+        Options readerOps;
+        readerOps.add("filename", Support::datapath(file));
+        LasReader reader;
+        reader.setOptions(readerOps);
+
+        Options rangeOps;
+        rangeOps.add("limits", "Classification[1:2]");
+        RangeFilter range;
+        range.setOptions(rangeOps);
+        range.setInput(reader);
+
+        Options writerOps;
+        writerOps.add("filename", Support::temppath("required.txt"));
+        writerOps.add("order", "X,Y");
+        writerOps.add("keep_unspecified", allDims);
+        TextWriter writer;
+        writer.setOptions(writerOps);
+        writer.setInput(range);
+
+        PointTable table;
+        writer.prepare(table);
+        PointViewSet s = writer.execute(table);
+        FileUtils::deleteFile(Support::temppath("required.txt"));
+
+        PointViewPtr v = *s.begin();
+        double x(0);
+        double z(0);
+        double intensity(0);
+        double gpsTime(0);
+        for (PointId i = 0; i < v->size(); ++i)
+        {
+            x += v->getFieldAs<double>(Dimension::Id::X, i);
+            z += std::fabs(v->getFieldAs<double>(Dimension::Id::Z, i));
+            intensity += v->getFieldAs<double>(Dimension::Id::Intensity, i);
+            gpsTime += v->getFieldAs<double>(Dimension::Id::GpsTime, i);
+        }
+        return std::make_tuple(v->size(), x, z, intensity + gpsTime);
+    };
+
+    for (const std::string file : { "las/autzen_trim.las", "las/4_6.las" })
+    {
+        auto all = run(file, true);
+        auto required = run(file, false);
+
+        EXPECT_EQ(std::get<0>(all), std::get<0>(required));
+        EXPECT_DOUBLE_EQ(std::get<1>(all), std::get<1>(required));
+        EXPECT_NE(std::get<2>(all), 0);
+        EXPECT_NE(std::get<3>(all), 0);
+        EXPECT_EQ(std::get<2>(required), 0);
+        EXPECT_EQ(std::get<3>(required), 0);
+    }
+}
+
+namespace pdal
+{
+
+// Chunks of points listed in a chunk bounds VLR that don't overlap the
+// query bounds aren't read.
+TEST(LasReaderTest, chunkQuery)
+{
+    std::string filename(Support::temppath("chunks.las"));
+
+    // Sorting by X makes each chunk a slab of the file's extent.
+    {
+        Options readerOps;
+        readerOps.add("filename", Support::datapath("las/autzen_trim.las"));
+        LasReader reader;
+        reader.setOptions(readerOps);
+
+        Options sortOps;
+        sortOps.add("dimension", "X");
+        SortFilter sort;
+        sort.setOptions(sortOps);
+        sort.setInput(reader);
+
+        Options writerOps;
+        writerOps.add("filename", filename);
+        writerOps.add("minor_version", 4);
+        writerOps.add("chunk_bounds", true);
+        LasWriter writer;
+        writer.setOptions(writerOps);
+        writer.setInput(sort);
+
+        PointTable table;
+        writer.prepare(table);
+        writer.execute(table);
+    }
+
+    Options allOps;
+    allOps.add("filename", filename);
+    LasReader all;
+    all.setOptions(allOps);
+    PointTable allTable;
+    all.prepare(allTable);
+    PointViewPtr allView = *all.execute(allTable).begin();
+    ASSERT_TRUE(all.header().findVlr(PDAL_USER_ID,
+        PDAL_CHUNK_BOUNDS_RECORD_ID));
+
+    BOX3D b = all.header().getBounds();
+    BOX2D query(b.minx, b.miny, b.minx + (b.maxx - b.minx) / 5, b.maxy);
+
+    point_count_t expected = 0;
+    double sumX = 0;
+    for (PointId i = 0; i < allView->size(); ++i)
+    {
+        double x = allView->getFieldAs<double>(Dimension::Id::X, i);
+        double y = allView->getFieldAs<double>(Dimension::Id::Y, i);
+        if (query.contains(x, y))
+        {
+            expected++;
+            sumX += x;
+        }
+    }
+    ASSERT_GT(expected, 0u);
+
+    Options queryOps;
+    queryOps.add("filename", filename);
+    queryOps.add("bounds", query);
+
+    LasReader reader;
+    reader.setOptions(queryOps);
+    PointTable table;
+    reader.prepare(table);
+    PointViewPtr view = *reader.execute(table).begin();
+
+    point_count_t selected = 0;
+    for (auto& r : reader.m_ranges)
+        selected += r.second - r.first;
+    EXPECT_LT(selected, allView->size() / 2);
+
+    double viewSumX = 0;
+    for (PointId i = 0; i < view->size(); ++i)
+        viewSumX += view->getFieldAs<double>(Dimension::Id::X, i);
+    EXPECT_EQ(view->size(), expected);
+    EXPECT_DOUBLE_EQ(viewSumX, sumX);
+
+    // Stream mode.
+    LasReader streamReader;
+    streamReader.setOptions(queryOps);
+
+    point_count_t cnt = 0;
+    double streamSumX = 0;
+    auto cb = [&](PointRef& point)
+    {
+        cnt++;
+        streamSumX += point.getFieldAs<double>(Dimension::Id::X);
+        return true;
+    };
+
+    StreamCallbackFilter f;
+    f.setCallback(cb);
+    f.setInput(streamReader);
+
+    FixedPointTable fixed(1000);
+    f.prepare(fixed);
+    f.execute(fixed);
+    EXPECT_EQ(cnt, expected);
+    EXPECT_DOUBLE_EQ(streamSumX, sumX);
+
+    FileUtils::deleteFile(filename);
+}
+
+} // namespace pdal
+
 // The header of 1.2-with-color-clipped says that it has 1065 points,
 // but it really only has 1064.
+// Coordinates stored as scaled integers read back the same as doubles, and
+// are written unchanged with the same scale and offset.
+TEST(LasReaderTest, quantize)
+{
+    using namespace Dimension;
+
+    auto read = [](const std::string& filename, bool quantize,
+        PointTable& table)
+    {
+        Options ops;
+        ops.add("filename", filename);
+        ops.add("quantize", quantize);
+        LasReader reader;
+        reader.setOptions(ops);
+        reader.prepare(table);
+        return *reader.execute(table).begin();
+    };
+
+    const std::string filename(Support::datapath("las/autzen_trim.las"));
+    PointTable table;
+    PointViewPtr view = read(filename, false, table);
+    PointTable qTable;
+    PointViewPtr qView = read(filename, true, qTable);
+
+    PointLayoutPtr layout = qTable.layout();
+    EXPECT_TRUE(layout->dimDetail(Id::X)->quantized());
+    EXPECT_EQ(layout->pointSize(), table.layout()->pointSize());
+    EXPECT_EQ(layout->storageSize(), layout->pointSize() - 12);
+    ASSERT_EQ(view->size(), qView->size());
+    for (PointId i = 0; i < view->size(); ++i)
+        for (Id id : { Id::X, Id::Y, Id::Z })
+            EXPECT_EQ(view->getFieldAs<double>(id, i),
+                qView->getFieldAs<double>(id, i));
+
+    const std::string outfile(Support::temppath("quantize.las"));
+    FileUtils::deleteFile(outfile);
+    {
+        Options ops;
+        ops.add("filename", filename);
+        ops.add("quantize", true);
+        LasReader reader;
+        reader.setOptions(ops);
+
+        Options writerOps;
+        writerOps.add("filename", outfile);
+        writerOps.add("forward", "all");
+        LasWriter writer;
+        writer.setOptions(writerOps);
+        writer.setInput(reader);
+
+        PointTable t;
+        writer.prepare(t);
+        writer.execute(t);
+    }
+
+    PointTable outTable;
+    PointViewPtr outView = read(outfile, false, outTable);
+    ASSERT_EQ(view->size(), outView->size());
+    for (PointId i = 0; i < view->size(); ++i)
+        for (Id id : { Id::X, Id::Y, Id::Z })
+            EXPECT_EQ(view->getFieldAs<double>(id, i),
+                outView->getFieldAs<double>(id, i));
+}
+
 TEST(LasReaderTest, LasHeaderIncorrentPointcount)
 {
     PointTable table;
@@ -727,6 +727,112 @@ TEST(LasWriterTest, lazperf)
 }
 #endif
 
+#if defined(PDAL_HAVE_LAZPERF)
+// Chunks compressed in parallel must produce the same file as serial
+// compression, in both standard and stream mode.
+TEST(LasWriterTest, lazperfThreads)
+{
+    auto write = [](const std::string& filename, int threads, bool stream)
+    {
+        Options readerOps;
+        readerOps.add("filename", Support::datapath("las/autzen_trim.las"));
+
+        LasReader reader;
+        reader.setOptions(readerOps);
+
+        FileUtils::deleteFile(filename);
+
+        Options writerOps;
+        writerOps.add("filename", filename);
+        writerOps.add("compression", "lazperf");
+        writerOps.add("threads", threads);
+
+        LasWriter writer;
+        writer.setOptions(writerOps);
+        writer.setInput(reader);
+
+        if (stream)
+        {
+            FixedPointTable t(1000);
+            writer.prepare(t);
+            writer.execute(t);
+        }
+        else
+        {
+            PointTable t;
+            writer.prepare(t);
+            writer.execute(t);
+        }
+    };
+
+    std::string serial(Support::temppath("serial.laz"));
+    std::string parallel(Support::temppath("parallel.laz"));
+
+    write(serial, 1, false);
+    write(parallel, 4, false);
+    EXPECT_TRUE(Support::compare_files(serial, parallel));
+
+    write(serial, 1, true);
+    write(parallel, 3, true);
+    EXPECT_TRUE(Support::compare_files(serial, parallel));
+
+    FileUtils::deleteFile(serial);
+    FileUtils::deleteFile(parallel);
+}
+#endif
+
+// Points encoded in parallel must produce the same file as serial encoding
+// and as the point-at-a-time encoding used in stream mode.
+TEST(LasWriterTest, encodeThreads)
+{
+    auto write = [](const std::string& filename, int threads, bool stream)
+    {
+        Options readerOps;
+        readerOps.add("filename", Support::datapath("las/autzen_trim.las"));
+
+        LasReader reader;
+        reader.setOptions(readerOps);
+
+        FileUtils::deleteFile(filename);
+
+        Options writerOps;
+        writerOps.add("filename", filename);
+        writerOps.add("forward", "all");
+        writerOps.add("threads", threads);
+
+        LasWriter writer;
+        writer.setOptions(writerOps);
+        writer.setInput(reader);
+
+        if (stream)
+        {
+            FixedPointTable t(1000);
+            writer.prepare(t);
+            writer.execute(t);
+        }
+        else
+        {
+            PointTable t;
+            writer.prepare(t);
+            writer.execute(t);
+        }
+    };
+
+    std::string serial(Support::temppath("serial.las"));
+    std::string parallel(Support::temppath("parallel.las"));
+    std::string streamed(Support::temppath("streamed.las"));
+
+    write(serial, 1, false);
+    write(parallel, 4, false);
+    write(streamed, 1, true);
+    EXPECT_TRUE(Support::compare_files(serial, parallel));
+    EXPECT_TRUE(Support::compare_files(serial, streamed));
+
+    FileUtils::deleteFile(serial);
+    FileUtils::deleteFile(parallel);
+    FileUtils::deleteFile(streamed);
+}
+
 #if defined(PDAL_HAVE_LASZIP)
 // LAZ files are normally written in chunks of 50,000, so a file of size
 // 110,000 ensures we read some whole chunks and a partial.
@@ -1541,6 +1647,76 @@ TEST(LasWriterTest, issue2320)
 }
 #endif
 
+// Points are written in the order requested and spatial orders write
+// chunk bounds when the version allows.
+TEST(LasWriterTest, order)
+{
+    auto write = [](const std::string& order, int minorVersion)
+    {
+        std::string filename(Support::temppath("ordered.las"));
+
+        Options readerOps;
+        readerOps.add("filename", Support::datapath("las/autzen_trim.las"));
+        LasReader reader;
+        reader.setOptions(readerOps);
+
+        Options writerOps;
+        writerOps.add("filename", filename);
+        writerOps.add("minor_version", minorVersion);
+        writerOps.add("order", order);
+        writerOps.add("threads", 2);
+        LasWriter writer;
+        writer.setOptions(writerOps);
+        writer.setInput(reader);
+
+        PointTable table;
+        writer.prepare(table);
+        writer.execute(table);
+        return filename;
+    };
+
+    auto read = [](const std::string& filename, PointTable& table,
+        bool& hasChunkBounds)
+    {
+        Options readerOps;
+        readerOps.add("filename", filename);
+        LasReader reader;
+        reader.setOptions(readerOps);
+        reader.prepare(table);
+        PointViewPtr view = *reader.execute(table).begin();
+        hasChunkBounds = (bool)reader.header().findVlr(PDAL_USER_ID,
+            PDAL_CHUNK_BOUNDS_RECORD_ID);
+        return view;
+    };
+
+    bool hasChunkBounds;
+    {
+        PointTable table;
+        PointViewPtr view = read(write("GpsTime", 4), table, hasChunkBounds);
+        EXPECT_EQ(view->size(), 110000u);
+        EXPECT_FALSE(hasChunkBounds);
+        for (PointId i = 1; i < view->size(); ++i)
+            ASSERT_LE(view->getFieldAs<double>(Dimension::Id::GpsTime, i - 1),
+                view->getFieldAs<double>(Dimension::Id::GpsTime, i));
+    }
+    {
+        PointTable table;
+        PointViewPtr view = read(write("hilbert", 4), table, hasChunkBounds);
+        EXPECT_EQ(view->size(), 110000u);
+        EXPECT_TRUE(hasChunkBounds);
+    }
+    {
+        PointTable table;
+        PointViewPtr view = read(write("morton", 2), table, hasChunkBounds);
+        EXPECT_EQ(view->size(), 110000u);
+        EXPECT_FALSE(hasChunkBounds);
+    }
+
+    EXPECT_THROW(write("random", 4), pdal_error);
+    FileUtils::deleteFile(Support::temppath("ordered.las"));
+}
+
+
 TEST(LasWriterTest, synthetic_points)
 {
     using namespace Dimension;
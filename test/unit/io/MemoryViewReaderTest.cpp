@@ -0,0 +1,172 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <pdal/PointView.hpp>
+#include <filters/StreamCallbackFilter.hpp>
+#include <io/MemoryViewReader.hpp>
+
+using namespace pdal;
+
+namespace
+{
+
+const point_count_t NumPoints = 1000;
+const point_count_t BatchSize = 300;
+
+// Column data.  X and Z aren't stored as doubles, so they're converted.
+struct Columns
+{
+    std::vector<float> x;
+    std::vector<double> y;
+    std::vector<int32_t> z;
+    std::vector<uint16_t> intensity;
+
+    Columns()
+    {
+        for (point_count_t i = 0; i < NumPoints; ++i)
+        {
+            x.push_back(i * .5f);
+            y.push_back(i * 2.0);
+            z.push_back(-(int32_t)i);
+            intensity.push_back((uint16_t)(i % 65536));
+        }
+    }
+};
+
+void setup(MemoryViewReader& r, Columns& c)
+{
+    using Type = Dimension::Type;
+
+    r.pushField({"X", Type::Float, 0});
+    r.pushField({"Y", Type::Double, 0});
+    r.pushField({"Z", Type::Signed32, 0});
+    r.pushField({"Intensity", Type::Unsigned16, 0});
+
+    r.setColumnIncrementer([&c](PointId id, std::vector<char *>& cols)
+        -> point_count_t
+    {
+        if (id >= NumPoints)
+            return 0;
+        cols.push_back((char *)(c.x.data() + id));
+        cols.push_back((char *)(c.y.data() + id));
+        cols.push_back((char *)(c.z.data() + id));
+        cols.push_back((char *)(c.intensity.data() + id));
+        return (std::min)(NumPoints - id, BatchSize);
+    });
+}
+
+void check(PointRef& point, PointId i)
+{
+    using Id = Dimension::Id;
+
+    EXPECT_DOUBLE_EQ(point.getFieldAs<double>(Id::X), i * .5);
+    EXPECT_DOUBLE_EQ(point.getFieldAs<double>(Id::Y), i * 2.0);
+    EXPECT_DOUBLE_EQ(point.getFieldAs<double>(Id::Z), -(double)i);
+    EXPECT_EQ(point.getFieldAs<uint16_t>(Id::Intensity), i);
+}
+
+void checkView(BasePointTable& table)
+{
+    Columns c;
+    MemoryViewReader r;
+    setup(r, c);
+
+    r.prepare(table);
+    PointViewSet s = r.execute(table);
+    ASSERT_EQ(s.size(), 1u);
+    PointViewPtr v = *s.begin();
+    ASSERT_EQ(v->size(), NumPoints);
+    for (PointId i = 0; i < v->size(); ++i)
+    {
+        PointRef point(*v, i);
+        check(point, i);
+    }
+}
+
+} // unnamed namespace
+
+TEST(MemoryViewReaderTest, columns)
+{
+    PointTable table;
+    checkView(table);
+}
+
+TEST(MemoryViewReaderTest, columnTable)
+{
+    ColumnPointTable table;
+    checkView(table);
+}
+
+TEST(MemoryViewReaderTest, columnStream)
+{
+    Columns c;
+    MemoryViewReader r;
+    setup(r, c);
+
+    PointId cnt = 0;
+    auto cb = [&cnt](PointRef& point)
+    {
+        check(point, cnt++);
+        return true;
+    };
+    StreamCallbackFilter f;
+    f.setCallback(cb);
+    f.setInput(r);
+
+    FixedPointTable table(64);
+    f.prepare(table);
+    f.execute(table);
+    EXPECT_EQ(cnt, NumPoints);
+}
+
+TEST(MemoryViewReaderTest, columnCount)
+{
+    Columns c;
+    MemoryViewReader r;
+    r.pushField({"X", Dimension::Type::Float, 0});
+    r.pushField({"Y", Dimension::Type::Double, 0});
+    r.pushField({"Z", Dimension::Type::Signed32, 0});
+    r.setColumnIncrementer([&c](PointId, std::vector<char *>& cols)
+        -> point_count_t
+    {
+        cols.push_back((char *)c.x.data());
+        return NumPoints;
+    });
+
+    ColumnPointTable table;
+    r.prepare(table);
+    EXPECT_THROW(r.execute(table), pdal_error);
+}
@@ -0,0 +1,202 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <filters/StreamCallbackFilter.hpp>
+#include <io/LasReader.hpp>
+#include <io/MultiReader.hpp>
+#include <pdal/util/FileUtils.hpp>
+
+#include "Support.hpp"
+
+using namespace pdal;
+
+namespace
+{
+
+StringList lasFiles()
+{
+    return { Support::datapath("las/simple.las"),
+        Support::datapath("las/1.2-with-color.las"),
+        Support::datapath("las/100-points.las"),
+        Support::datapath("las/4_1.las") };
+}
+
+} // unnamed namespace
+
+TEST(MultiReaderTest, files)
+{
+    using namespace Dimension;
+
+    auto read = [](int threads, bool viewPerFile)
+    {
+        Options o;
+        for (const std::string& filename : lasFiles())
+            o.add("files", filename);
+        o.add("threads", threads);
+        o.add("view_per_file", viewPerFile);
+        MultiReader r;
+        r.setOptions(o);
+        std::unique_ptr<PointTable> t(new PointTable);
+        r.prepare(*t);
+        PointViewSet s = r.execute(*t);
+        return std::make_pair(std::move(t), s);
+    };
+
+    std::vector<PointViewPtr> expected;
+    std::vector<std::unique_ptr<PointTable>> tables;
+    for (const std::string& filename : lasFiles())
+    {
+        Options o;
+        o.add("filename", filename);
+        LasReader r;
+        r.setOptions(o);
+        tables.emplace_back(new PointTable);
+        r.prepare(*tables.back());
+        expected.push_back(*r.execute(*tables.back()).begin());
+    }
+
+    auto check = [&expected](const std::vector<PointViewPtr>& views)
+    {
+        size_t vi = 0;
+        PointId idx = 0;
+        for (const PointViewPtr& e : expected)
+            for (PointId i = 0; i < e->size(); ++i)
+            {
+                while (idx == views[vi]->size())
+                {
+                    vi++;
+                    idx = 0;
+                }
+                const PointViewPtr& v = views[vi];
+                EXPECT_DOUBLE_EQ(v->getFieldAs<double>(Id::X, idx),
+                    e->getFieldAs<double>(Id::X, i));
+                EXPECT_DOUBLE_EQ(v->getFieldAs<double>(Id::Y, idx),
+                    e->getFieldAs<double>(Id::Y, i));
+                EXPECT_DOUBLE_EQ(v->getFieldAs<double>(Id::Z, idx),
+                    e->getFieldAs<double>(Id::Z, i));
+                EXPECT_EQ(v->getFieldAs<int>(Id::Intensity, idx),
+                    e->getFieldAs<int>(Id::Intensity, i));
+                idx++;
+            }
+    };
+
+    point_count_t total = 0;
+    for (const PointViewPtr& e : expected)
+        total += e->size();
+
+    for (int threads : { 1, 3 })
+    {
+        auto single = read(threads, false);
+        ASSERT_EQ(single.second.size(), 1U);
+        PointViewPtr v = *single.second.begin();
+        EXPECT_EQ(v->size(), total);
+        check({ v });
+
+        auto perFile = read(threads, true);
+        ASSERT_EQ(perFile.second.size(), expected.size());
+        std::vector<PointViewPtr> views(perFile.second.begin(),
+            perFile.second.end());
+        for (size_t i = 0; i < views.size(); ++i)
+            EXPECT_EQ(views[i]->size(), expected[i]->size());
+        check(views);
+
+        // The red, green and blue of the files without color are zero.
+        EXPECT_TRUE(single.first->layout()->hasDim(Id::Red));
+    }
+}
+
+TEST(MultiReaderTest, glob)
+{
+    std::string pattern(Support::datapath("las/autzen_trim*.las"));
+    StringList files = FileUtils::glob(pattern);
+    ASSERT_EQ(files.size(), 2U);
+
+    point_count_t expected = 0;
+    for (const std::string& filename : files)
+    {
+        Options o;
+        o.add("filename", filename);
+        LasReader r;
+        r.setOptions(o);
+        expected += r.preview().m_pointCount;
+    }
+
+    Options o;
+    o.add("filename", pattern);
+    o.add("threads", 2);
+
+    MultiReader r;
+    r.setOptions(o);
+    QuickInfo qi = r.preview();
+    EXPECT_EQ(qi.m_pointCount, expected);
+
+    PointTable t;
+    r.prepare(t);
+    PointViewSet s = r.execute(t);
+    EXPECT_EQ((*s.begin())->size(), expected);
+
+    // Stream the files through a small table.
+    for (int threads : { 1, 2 })
+    {
+        Options so;
+        so.add("filename", pattern);
+        so.add("threads", threads);
+        MultiReader sr;
+        sr.setOptions(so);
+
+        point_count_t count = 0;
+        StreamCallbackFilter f;
+        f.setCallback([&count](PointRef&){ count++; return true; });
+        f.setInput(sr);
+
+        FixedPointTable ft(100);
+        f.prepare(ft);
+        f.execute(ft);
+        EXPECT_EQ(count, expected);
+    }
+}
+
+TEST(MultiReaderTest, noFiles)
+{
+    Options o;
+    o.add("filename", Support::datapath("las/nothing-here-*.las"));
+    MultiReader r;
+    r.setOptions(o);
+
+    PointTable t;
+    EXPECT_THROW(r.prepare(t), pdal_error);
+}
@@ -0,0 +1,115 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <io/FauxReader.hpp>
+#include <io/NullWriter.hpp>
+
+using namespace pdal;
+
+namespace
+{
+
+void checkBenchmark(NullWriter& w, point_count_t count)
+{
+    MetadataNode m = w.getMetadata();
+    EXPECT_EQ(m.findChild("points").value<point_count_t>(), count);
+    size_t pointSize = m.findChild("point_size").value<size_t>();
+    EXPECT_GT(pointSize, 0u);
+    EXPECT_EQ(m.findChild("bytes").value<size_t>(), count * pointSize);
+    EXPECT_GE(m.findChild("seconds").value<double>(), 0.0);
+}
+
+} // unnamed namespace
+
+TEST(NullWriterTest, benchmark)
+{
+    Options ro;
+    ro.add("count", 1000);
+    ro.add("mode", "ramp");
+    FauxReader r;
+    r.setOptions(ro);
+
+    Options wo;
+    wo.add("benchmark", true);
+    NullWriter w;
+    w.setInput(r);
+    w.setOptions(wo);
+
+    PointTable t;
+    w.prepare(t);
+    w.execute(t);
+    checkBenchmark(w, 1000);
+    EXPECT_EQ(w.getMetadata().children("view").size(), 1u);
+    EXPECT_TRUE(w.getMetadata().findChild("checksum").empty());
+}
+
+TEST(NullWriterTest, benchmarkStream)
+{
+    Options ro;
+    ro.add("count", 1000);
+    ro.add("mode", "ramp");
+    FauxReader r;
+    r.setOptions(ro);
+
+    Options wo;
+    wo.add("touch", true);
+    NullWriter w;
+    w.setInput(r);
+    w.setOptions(wo);
+
+    FixedPointTable t(100);
+    w.prepare(t);
+    w.execute(t);
+    checkBenchmark(w, 1000);
+    EXPECT_GE(w.getMetadata().findChild("batches").value<size_t>(), 10u);
+    EXPECT_FALSE(w.getMetadata().findChild("checksum").empty());
+}
+
+TEST(NullWriterTest, noBenchmark)
+{
+    Options ro;
+    ro.add("count", 1000);
+    FauxReader r;
+    r.setOptions(ro);
+
+    NullWriter w;
+    w.setInput(r);
+
+    PointTable t;
+    w.prepare(t);
+    w.execute(t);
+    EXPECT_TRUE(w.getMetadata().findChild("points").empty());
+}
@@ -39,6 +39,7 @@
 #include <io/LasReader.hpp>
 #include <io/LasWriter.hpp>
 #include <io/PcdReader.hpp>
+#include <pdal/util/OStream.hpp>
 #include <pdal/util/FileUtils.hpp>
 
 using namespace pdal;
@@ -198,3 +199,50 @@ TEST(PcdReaderTest, throwMissingHeader)
     PointTable tt;
     EXPECT_THROW(t.prepare(tt), pdal_error);
 }
+
+// Binary fields of all sizes, including a field with several values, of
+// which only the first is kept.
+TEST(PcdReaderTest, binaryFieldSizes)
+{
+    using namespace Dimension;
+
+    std::string filename(Support::temppath("sizes.pcd"));
+    {
+        OLeStream out(filename);
+        out.put("VERSION 0.7\n"
+            "FIELDS x y z intensity classification normal\n"
+            "SIZE 8 4 2 2 1 4\n"
+            "TYPE F F I U U F\n"
+            "COUNT 1 1 1 1 1 3\n"
+            "WIDTH 3\n"
+            "HEIGHT 1\n"
+            "POINTS 3\n"
+            "DATA binary\n");
+        for (int i = 0; i < 3; ++i)
+        {
+            out << (double)(i + .5) << (float)(i * 2) << (int16_t)(-i) <<
+                (uint16_t)(1000 + i) << (uint8_t)(i + 1);
+            out << (float)(i + .25) << (float)100 << (float)200;
+        }
+    }
+
+    PcdReader r;
+    Options o;
+    o.add("filename", filename);
+    r.setOptions(o);
+    PointTable t;
+    r.prepare(t);
+    PointViewPtr v = *r.execute(t).begin();
+
+    Id normal = t.layout()->findDim("NORMAL");
+    ASSERT_EQ(v->size(), 3U);
+    for (PointId i = 0; i < 3; ++i)
+    {
+        EXPECT_DOUBLE_EQ(v->getFieldAs<double>(Id::X, i), i + .5);
+        EXPECT_DOUBLE_EQ(v->getFieldAs<double>(Id::Y, i), i * 2);
+        EXPECT_EQ(v->getFieldAs<int>(Id::Z, i), -(int)i);
+        EXPECT_EQ(v->getFieldAs<int>(Id::Intensity, i), 1000 + (int)i);
+        EXPECT_EQ(v->getFieldAs<int>(Id::Classification, i), (int)i + 1);
+        EXPECT_FLOAT_EQ(v->getFieldAs<float>(normal, i), i + .25f);
+    }
+}
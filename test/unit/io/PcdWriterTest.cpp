@@ -333,3 +333,99 @@ TEST(PcdWriterTest, binaryPdalTypes)
     EXPECT_NEAR(3.33, v->getFieldAs<float>(Dimension::Id::Z, 2), 0.0001);
     EXPECT_EQ(3, v->getFieldAs<int>(Dimension::Id::Intensity, 2));
 }
+
+TEST(PcdWriterTest, compressed)
+{
+    using namespace Dimension;
+
+    std::string infile(Support::datapath("las/autzen_trim.las"));
+
+    auto write = [&infile](const std::string& compression, int threads,
+        bool stream)
+    {
+        std::string outfile(Support::temppath("compressed.pcd"));
+        FileUtils::deleteFile(outfile);
+
+        LasReader r;
+        Options ro;
+        ro.add("filename", infile);
+        r.setOptions(ro);
+
+        PcdWriter w;
+        Options wo;
+        wo.add("filename", outfile);
+        wo.add("compression", compression);
+        wo.add("order", "X=Double,Y=Double,Z=Float,Intensity=Unsigned16,"
+            "Classification=Unsigned8,PointSourceId=Signed32");
+        wo.add("keep_unspecified", false);
+        wo.add("threads", threads);
+        w.setOptions(wo);
+        w.setInput(r);
+
+        if (stream)
+        {
+            FixedPointTable t(1000);
+            w.prepare(t);
+            w.execute(t);
+        }
+        else
+        {
+            PointTable t;
+            w.prepare(t);
+            w.execute(t);
+        }
+        return outfile;
+    };
+
+    LasReader l;
+    Options lo;
+    lo.add("filename", infile);
+    l.setOptions(lo);
+    PointTable lt;
+    l.prepare(lt);
+    PointViewPtr lv = *l.execute(lt).begin();
+    ASSERT_EQ(lv->size(), 110000U);
+
+    auto check = [&lv](const std::string& filename, int threads)
+    {
+        PcdReader r;
+        Options ro;
+        ro.add("filename", filename);
+        ro.add("threads", threads);
+        r.setOptions(ro);
+        PointTable t;
+        r.prepare(t);
+        PointViewPtr v = *r.execute(t).begin();
+
+        ASSERT_EQ(v->size(), lv->size());
+        for (PointId i = 0; i < v->size(); ++i)
+        {
+            EXPECT_DOUBLE_EQ(v->getFieldAs<double>(Id::X, i),
+                lv->getFieldAs<double>(Id::X, i));
+            EXPECT_DOUBLE_EQ(v->getFieldAs<double>(Id::Y, i),
+                lv->getFieldAs<double>(Id::Y, i));
+            EXPECT_FLOAT_EQ(v->getFieldAs<float>(Id::Z, i),
+                lv->getFieldAs<float>(Id::Z, i));
+            EXPECT_EQ(v->getFieldAs<int>(Id::Intensity, i),
+                lv->getFieldAs<int>(Id::Intensity, i));
+            EXPECT_EQ(v->getFieldAs<int>(Id::Classification, i),
+                lv->getFieldAs<int>(Id::Classification, i));
+            EXPECT_EQ(v->getFieldAs<int>(Id::PointSourceId, i),
+                lv->getFieldAs<int>(Id::PointSourceId, i));
+        }
+    };
+
+    std::string outfile = write("compressed", 1, false);
+    std::string data = FileUtils::readFileIntoString(outfile);
+    check(outfile, 1);
+    check(outfile, 4);
+
+    // Compressing with several threads gives the same file.
+    write("compressed", 4, false);
+    EXPECT_EQ(data, FileUtils::readFileIntoString(outfile));
+
+    // The point count isn't known ahead of time when streaming.
+    check(write("compressed", 3, true), 2);
+    check(write("binary", 1, true), 1);
+    check(write("binary", 1, false), 1);
+}
@@ -35,7 +35,10 @@
 #include <pdal/Filter.hpp>
 #include <pdal/pdal_test_main.hpp>
 
+#include <io/BufferReader.hpp>
 #include <io/PlyReader.hpp>
+#include <io/PlyWriter.hpp>
+#include <pdal/util/FileUtils.hpp>
 #include "Support.hpp"
 
 namespace pdal
@@ -199,4 +202,104 @@ TEST(PlyReader, NoVertex)
     EXPECT_THROW(reader.prepare(table), pdal_error);
 }
 
+
+TEST(PlyReader, ReadFaces)
+{
+    PlyReader reader;
+    Options options;
+    options.add("filename", Support::datapath("ply/mesh.ply"));
+    reader.setOptions(options);
+
+    PointTable table;
+    reader.prepare(table);
+    PointViewSet viewSet = reader.execute(table);
+    PointViewPtr view = *viewSet.begin();
+    EXPECT_EQ(view->size(), 4u);
+
+    TriangularMesh *mesh = view->mesh();
+    ASSERT_TRUE(mesh);
+    ASSERT_EQ(mesh->size(), 2u);
+    EXPECT_EQ((*mesh)[0].m_a, 0u);
+    EXPECT_EQ((*mesh)[0].m_b, 1u);
+    EXPECT_EQ((*mesh)[0].m_c, 2u);
+    EXPECT_EQ((*mesh)[1].m_a, 1u);
+    EXPECT_EQ((*mesh)[1].m_b, 2u);
+    EXPECT_EQ((*mesh)[1].m_c, 3u);
 }
+
+
+// Binary files are read in blocks.  Write enough points and faces in both
+// byte orders to span several blocks and make sure they come back intact.
+TEST(PlyReader, ReadBinaryBlocks)
+{
+    using namespace Dimension;
+
+    const PointId count = 200000;
+
+    PointTable table;
+    table.layout()->registerDims({ Id::X, Id::Y, Id::Z, Id::Intensity,
+        Id::Classification });
+    PointViewPtr view(new PointView(table));
+    for (PointId i = 0; i < count; ++i)
+    {
+        view->setField(Id::X, i, i * .25);
+        view->setField(Id::Y, i, -(double)i);
+        view->setField(Id::Z, i, i / 3.0);
+        view->setField(Id::Intensity, i, i % 65536);
+        view->setField(Id::Classification, i, i % 32);
+    }
+    TriangularMesh *mesh = view->createMesh("test");
+    for (PointId i = 0; i + 2 < count; i += 2)
+        mesh->add(i, i + 1, i + 2);
+
+    std::string filename(Support::temppath("blocks.ply"));
+    for (std::string format : { "binary_little_endian", "binary_big_endian" })
+    {
+        FileUtils::deleteFile(filename);
+
+        BufferReader br;
+        br.addView(view);
+
+        Options wo;
+        wo.add("filename", filename);
+        wo.add("storage_mode", format);
+        wo.add("faces", true);
+        PlyWriter w;
+        w.setOptions(wo);
+        w.setInput(br);
+        w.prepare(table);
+        w.execute(table);
+
+        Options ro;
+        ro.add("filename", filename);
+        PlyReader r;
+        r.setOptions(ro);
+
+        PointTable t2;
+        r.prepare(t2);
+        PointViewSet s = r.execute(t2);
+        PointViewPtr v = *s.begin();
+        ASSERT_EQ(v->size(), count);
+        for (PointId i = 0; i < count; ++i)
+        {
+            EXPECT_EQ(v->getFieldAs<double>(Id::X, i), i * .25);
+            EXPECT_EQ(v->getFieldAs<double>(Id::Y, i), -(double)i);
+            EXPECT_EQ(v->getFieldAs<double>(Id::Z, i), i / 3.0);
+            EXPECT_EQ(v->getFieldAs<int>(Id::Intensity, i), (int)(i % 65536));
+            EXPECT_EQ(v->getFieldAs<int>(Id::Classification, i),
+                (int)(i % 32));
+        }
+
+        TriangularMesh *m = v->mesh();
+        ASSERT_TRUE(m);
+        ASSERT_EQ(m->size(), mesh->size());
+        for (size_t i = 0; i < m->size(); ++i)
+        {
+            EXPECT_EQ((*m)[i].m_a, (*mesh)[i].m_a);
+            EXPECT_EQ((*m)[i].m_b, (*mesh)[i].m_b);
+            EXPECT_EQ((*m)[i].m_c, (*mesh)[i].m_c);
+        }
+    }
+}
+
+} // namespace pdal
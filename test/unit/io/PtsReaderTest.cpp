@@ -32,8 +32,11 @@
 * OF SUCH DAMAGE.
 ****************************************************************************/
 
+#include <fstream>
+
 #include <pdal/pdal_test_main.hpp>
 #include <pdal/StageFactory.hpp>
+#include <pdal/util/FileUtils.hpp>
 #include <io/PtsReader.hpp>
 #include "Support.hpp"
 
@@ -115,4 +118,54 @@ TEST(PtsReader, ReadPtsFourDims)
     EXPECT_DOUBLE_EQ(view->getFieldAs<double>(Dimension::Id::Intensity, 0), -255 + 2048);
 }
 
+// Parsing on several threads must yield the points in file order.
+TEST(PtsReader, Threads)
+{
+    std::string filename(Support::temppath("threads.pts"));
+    const point_count_t count = 20000;
+    {
+        std::ofstream out(filename);
+        out << count << "\n";
+        for (point_count_t i = 0; i < count; ++i)
+            out << i << " " << (i * .5) << " " << -(double)i << " " <<
+                ((int)(i % 4096) - 2048) << "\n";
+    }
+
+    auto read = [&filename](PointTableRef table, int threads,
+        point_count_t limit)
+    {
+        Options options;
+        options.add("filename", filename);
+        options.add("threads", threads);
+        if (limit)
+            options.add("count", limit);
+
+        PtsReader reader;
+        reader.setOptions(options);
+        reader.prepare(table);
+        PointViewSet viewSet = reader.execute(table);
+        return *viewSet.begin();
+    };
+
+    for (point_count_t limit : { (point_count_t)0, (point_count_t)12345 })
+    {
+        PointTable table;
+        PointViewPtr view = read(table, 3, limit);
+        point_count_t expected = limit ? limit : count;
+        ASSERT_EQ(view->size(), expected);
+        for (PointId i = 0; i < view->size(); ++i)
+        {
+            EXPECT_DOUBLE_EQ(view->getFieldAs<double>(Dimension::Id::X, i),
+                (double)i);
+            EXPECT_DOUBLE_EQ(view->getFieldAs<double>(Dimension::Id::Y, i),
+                i * .5);
+            EXPECT_DOUBLE_EQ(view->getFieldAs<double>(Dimension::Id::Z, i),
+                -(double)i);
+            EXPECT_EQ(view->getFieldAs<int>(Dimension::Id::Intensity, i),
+                (int)(i % 4096));
+        }
+    }
+    FileUtils::deleteFile(filename);
+}
+
 }
@@ -0,0 +1,148 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <thread>
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <pdal/PointView.hpp>
+#include <io/FauxReader.hpp>
+#include <io/ShmReader.hpp>
+#include <io/ShmWriter.hpp>
+
+using namespace pdal;
+
+namespace
+{
+
+Options fauxOptions()
+{
+    Options o;
+    o.add("count", 10000);
+    o.add("mode", "ramp");
+    o.add("bounds", BOX3D(1, 2, 3, 1000, 2000, 3000));
+    return o;
+}
+
+PointViewPtr expected(PointTable& table)
+{
+    FauxReader r;
+    r.setOptions(fauxOptions());
+    r.prepare(table);
+    PointViewSet s = r.execute(table);
+    return *s.begin();
+}
+
+// Write faux points to shared memory.  In stream mode the reader gets
+// batches while the writer is still running.
+void write(const std::string& name, bool stream)
+{
+    FauxReader r;
+    r.setOptions(fauxOptions());
+
+    Options o;
+    o.add("name", name);
+    o.add("batch_size", 100);
+    o.add("slots", 2);
+    o.add("timeout", 30);
+    ShmWriter w;
+    w.setOptions(o);
+    w.setInput(r);
+
+    if (stream)
+    {
+        FixedPointTable t(1000);
+        w.prepare(t);
+        w.execute(t);
+    }
+    else
+    {
+        PointTable t;
+        w.prepare(t);
+        w.execute(t);
+    }
+}
+
+void transport(const std::string& name, bool stream)
+{
+    std::thread writer(write, name, stream);
+
+    Options o;
+    o.add("name", name);
+    o.add("timeout", 30);
+    ShmReader r;
+    r.setOptions(o);
+
+    PointTable t;
+    r.prepare(t);
+    PointViewSet s = r.execute(t);
+    writer.join();
+    ASSERT_EQ(s.size(), 1u);
+    PointViewPtr v = *s.begin();
+
+    PointTable et;
+    PointViewPtr ev = expected(et);
+    ASSERT_EQ(v->size(), ev->size());
+    for (Dimension::Id id : et.layout()->dims())
+    {
+        ASSERT_TRUE(t.layout()->hasDim(id));
+        for (PointId idx = 0; idx < v->size(); ++idx)
+            EXPECT_EQ(v->getFieldAs<double>(id, idx),
+                ev->getFieldAs<double>(id, idx));
+    }
+}
+
+} // unnamed namespace
+
+TEST(ShmTest, stream)
+{
+    transport("pdal_shm_test_stream", true);
+}
+
+TEST(ShmTest, standard)
+{
+    transport("pdal_shm_test_standard", false);
+}
+
+TEST(ShmTest, timeout)
+{
+    Options o;
+    o.add("name", "pdal_shm_test_missing");
+    o.add("timeout", .05);
+    ShmReader r;
+    r.setOptions(o);
+
+    PointTable t;
+    EXPECT_THROW(r.prepare(t), pdal_error);
+}
@@ -39,8 +39,12 @@
 #include <io/LasReader.hpp>
 #include <io/LasWriter.hpp>
 #include <io/TextReader.hpp>
+#include <filters/StreamCallbackFilter.hpp>
 #include <pdal/util/FileUtils.hpp>
 
+#include <fstream>
+#include <sstream>
+
 using namespace pdal;
 
 void compareTextLas(const std::string& textFilename,
@@ -334,3 +338,78 @@ TEST(TextReaderTest, quotedHeader)
         EXPECT_THROW(testme(opts), pdal_error);
     }
 }
+
+// Reading on several threads gives the same points and reports the same
+// errors as reading a line at a time.
+TEST(TextReaderTest, threads)
+{
+    std::string filename(Support::temppath("threads.txt"));
+    {
+        std::ofstream out(filename);
+        out << "X,Y,Z\n";
+        for (int i = 0; i < 20000; ++i)
+        {
+            if (i % 997 == 0)
+                out << i << "," << i << "\n";
+            else if (i % 1999 == 0)
+                out << i << ",bad," << i << "\n";
+            else if (i % 1499 == 0)
+                out << "\n";
+            else
+                out << (i * .01) << " , " << (i * -1.5e-3) << "," <<
+                    (i * 7) << "\r\n";
+        }
+        out << "1.5,2.5,3.5";
+    }
+
+    auto run = [&filename](bool stream, int threads, point_count_t count)
+    {
+        std::ostringstream log;
+        TextReader t;
+        LogPtr l(Log::makeLog("text", &log));
+        t.setLog(l);
+        Options opts;
+        opts.add("filename", filename);
+        opts.add("threads", threads);
+        if (count)
+            opts.add("count", count);
+        t.setOptions(opts);
+
+        std::vector<double> values;
+        auto collect = [&values](PointRef p)
+        {
+            values.push_back(p.getFieldAs<double>(Dimension::Id::X));
+            values.push_back(p.getFieldAs<double>(Dimension::Id::Y));
+            values.push_back(p.getFieldAs<double>(Dimension::Id::Z));
+        };
+        if (stream)
+        {
+            FixedPointTable table(1000);
+            StreamCallbackFilter f;
+            f.setCallback([&collect](PointRef& p){ collect(p); return true; });
+            f.setInput(t);
+            f.prepare(table);
+            f.execute(table);
+        }
+        else
+        {
+            PointTable table;
+            t.prepare(table);
+            PointViewPtr v = *t.execute(table).begin();
+            for (PointRef p : *v)
+                collect(p);
+        }
+        return std::make_pair(values, log.str());
+    };
+
+    auto expected = run(true, 1, 0);
+    EXPECT_GT(expected.first.size(), 50000U);
+    EXPECT_NE(expected.second.find("contains 2 fields"), std::string::npos);
+    EXPECT_NE(expected.second.find("field 'bad'"), std::string::npos);
+    EXPECT_TRUE(expected == run(false, 1, 0));
+    EXPECT_TRUE(expected == run(false, 3, 0));
+
+    auto limited = run(true, 1, 5000);
+    EXPECT_EQ(limited.first.size(), 15000U);
+    EXPECT_TRUE(limited == run(false, 4, 5000));
+}
@@ -36,10 +36,21 @@
 
 #include "Support.hpp"
 
+#include <algorithm>
+#include <iomanip>
+#include <limits>
+
+#include <nlohmann/json.hpp>
+
+#include <pdal/pdal_features.hpp>
 #include <pdal/util/FileUtils.hpp>
 #include <io/BufferReader.hpp>
+#include <io/LasReader.hpp>
 #include <io/TextReader.hpp>
 #include <io/TextWriter.hpp>
+#ifdef PDAL_HAVE_ZSTD
+#include <pdal/compression/ZstdCompression.hpp>
+#endif
 
 using namespace pdal;
 
@@ -185,3 +196,154 @@ TEST(TextWriterTest, precision)
     EXPECT_NE(out.find("3,3,3,3"), std::string::npos);
 }
 
+// Values must be written as an ostream with std::fixed would write them.
+TEST(TextWriterTest, format)
+{
+    using namespace Dimension;
+
+    std::vector<double> values { 0, -0.0, 1, -1, 0.5, 2.5, -2.5, 0.0005,
+        0.0015, 1.0 / 3, -123456.789, 1e15, 123456789012345.0, -1e15 - 2,
+        9.9995, 4294967296.0, 1e20, -1.5e300, 5e-324,
+        std::numeric_limits<double>::max(),
+        std::numeric_limits<double>::infinity(),
+        -std::numeric_limits<double>::infinity() };
+
+    PointTable table;
+    table.layout()->registerDims( { Id::X, Id::Y, Id::Z } );
+
+    PointViewPtr view(new PointView(table));
+    for (PointId i = 0; i < values.size(); ++i)
+    {
+        view->setField(Id::X, i, values[i]);
+        view->setField(Id::Y, i, values[i]);
+        view->setField(Id::Z, i, values[i]);
+    }
+
+    BufferReader r;
+    r.addView(view);
+
+    std::string outfile(Support::temppath("format.txt"));
+
+    TextWriter w;
+    Options o;
+    o.add("order", "X:0,Y:3,Z:8");
+    o.add("write_header", false);
+    o.add("filename", outfile);
+    w.setInput(r);
+    w.setOptions(o);
+
+    w.prepare(table);
+    w.execute(table);
+
+    std::ostringstream expected;
+    expected << std::fixed;
+    for (double d : values)
+        expected << std::setprecision(0) << d << "," <<
+            std::setprecision(3) << d << "," <<
+            std::setprecision(8) << d << "\n";
+    EXPECT_EQ(FileUtils::readFileIntoString(outfile), expected.str());
+}
+
+// Formatting on several threads must produce the same output as formatting
+// on one, in both standard and stream mode.
+TEST(TextWriterTest, threads)
+{
+    auto run = [](const std::string& format, int threads, bool stream)
+    {
+        std::string outfile(Support::temppath("threads.txt"));
+        FileUtils::deleteFile(outfile);
+
+        Options ro;
+        ro.add("filename", Support::datapath("las/autzen_trim.las"));
+        LasReader r;
+        r.setOptions(ro);
+
+        Options wo;
+        wo.add("filename", outfile);
+        wo.add("format", format);
+        wo.add("order", "X:2,Y:2,Z:4,Intensity");
+        wo.add("threads", threads);
+        TextWriter w;
+        w.setOptions(wo);
+        w.setInput(r);
+
+        if (stream)
+        {
+            FixedPointTable t(1000);
+            w.prepare(t);
+            w.execute(t);
+        }
+        else
+        {
+            PointTable t;
+            w.prepare(t);
+            w.execute(t);
+        }
+        return FileUtils::readFileIntoString(outfile);
+    };
+
+    std::string csv = run("csv", 1, false);
+    EXPECT_EQ(csv, run("csv", 4, false));
+    EXPECT_EQ(csv, run("csv", 3, true));
+    EXPECT_EQ(std::count(csv.begin(), csv.end(), '\n'), 110001);
+
+    std::string geojson = run("geojson", 1, false);
+    EXPECT_EQ(geojson, run("geojson", 4, false));
+    EXPECT_EQ(geojson, run("geojson", 1, true));
+
+    NL::json j = NL::json::parse(geojson);
+    EXPECT_EQ(j["features"].size(), 110000u);
+}
+
+TEST(TextWriterTest, compression)
+{
+    auto run = [](const std::string& compression)
+    {
+        std::string outfile(Support::temppath("compressed.txt"));
+        FileUtils::deleteFile(outfile);
+
+        Options ro;
+        ro.add("filename", Support::datapath("las/1.2-with-color.las"));
+        LasReader r;
+        r.setOptions(ro);
+
+        Options wo;
+        wo.add("filename", outfile);
+        wo.add("compression", compression);
+        TextWriter w;
+        w.setOptions(wo);
+        w.setInput(r);
+
+        PointTable t;
+        w.prepare(t);
+        w.execute(t);
+        return FileUtils::readFileIntoString(outfile);
+    };
+
+    std::string plain = run("none");
+
+#ifdef PDAL_HAVE_ZLIB
+    std::string gzip = run("gzip");
+    ASSERT_GT(gzip.size(), 2u);
+    EXPECT_EQ((uint8_t)gzip[0], 0x1f);
+    EXPECT_EQ((uint8_t)gzip[1], 0x8b);
+    EXPECT_LT(gzip.size(), plain.size());
+#else
+    EXPECT_THROW(run("gzip"), pdal_error);
+#endif
+
+#ifdef PDAL_HAVE_ZSTD
+    std::string zstd = run("zstd");
+    std::string decompressed;
+    auto cb = [&decompressed](char *buf, size_t size)
+        { decompressed.append(buf, size); };
+    ZstdDecompressor decompressor(cb);
+    decompressor.decompress(zstd.data(), zstd.size());
+    decompressor.done();
+    EXPECT_EQ(decompressed, plain);
+#else
+    EXPECT_THROW(run("zstd"), pdal_error);
+#endif
+
+    EXPECT_THROW(run("bzip2"), pdal_error);
+}